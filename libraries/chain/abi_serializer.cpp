@@ -1,9 +1,11 @@
 #include <eosio/chain/abi_serializer.hpp>
 #include <eosio/chain/asset.hpp>
 #include <eosio/chain/exceptions.hpp>
+#include <fc/io/json.hpp>
 #include <fc/io/raw.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <fc/io/varint.hpp>
+#include <algorithm>
 
 using namespace boost;
 
@@ -72,6 +74,48 @@ namespace eosio { namespace chain {
       );
    }
 
+   template <typename T>
+   void integer_to_json( fc::datastream<const char*>& stream, std::string& out ) {
+      T value;
+      fc::raw::unpack( stream, value );
+      // fc::json quotes integers that do not fit in 32 bits, so javascript does not lose their precision
+      bool quote = false;
+      if constexpr( sizeof(T) > sizeof(uint32_t) )
+         quote = value > T(0xffffffff);
+      if( quote ) out += '"';
+      out += std::to_string( value );
+      if( quote ) out += '"';
+   }
+
+   void name_to_json( fc::datastream<const char*>& stream, std::string& out ) {
+      name value;
+      fc::raw::unpack( stream, value );
+      // the characters of a name never need escaping
+      char buf[name::max_string_size];
+      out += '"';
+      out.append( buf, value.write_as_string( buf ) );
+      out += '"';
+   }
+
+   void asset_to_json( fc::datastream<const char*>& stream, std::string& out ) {
+      asset value;
+      // unpacking validates the symbol, so the string is made of digits, '-', '.', ' ' and upper case letters
+      fc::raw::unpack( stream, value );
+      char buf[asset::max_string_size];
+      out += '"';
+      out.append( buf, value.write_as_string( buf ) );
+      out += '"';
+   }
+
+   template <typename T>
+   void checksum_to_json( fc::datastream<const char*>& stream, std::string& out ) {
+      T value;
+      fc::raw::unpack( stream, value );
+      out += '"';
+      out += value.str();
+      out += '"';
+   }
+
    abi_serializer::abi_serializer( const abi_def& abi, const yield_function_t& yield ) {
       configure_built_in_types();
       set_abi(abi, yield);
@@ -80,6 +124,24 @@ namespace eosio { namespace chain {
    void abi_serializer::add_specialized_unpack_pack( const string& name,
                                                      std::pair<abi_serializer::unpack_function, abi_serializer::pack_function> unpack_pack ) {
       built_in_types[name] = std::move( unpack_pack );
+      // the JSON must come from the specialized unpack function now
+      built_in_json.erase( name );
+      compile_types();
+   }
+
+   abi_serializer& abi_serializer::operator=( const abi_serializer& other ) {
+      typedefs       = other.typedefs;
+      structs        = other.structs;
+      actions        = other.actions;
+      tables         = other.tables;
+      kv_tables      = other.kv_tables;
+      error_messages = other.error_messages;
+      variants       = other.variants;
+      action_results = other.action_results;
+      built_in_types = other.built_in_types;
+      built_in_json  = other.built_in_json;
+      compile_types();
+      return *this;
    }
 
    void abi_serializer::configure_built_in_types() {
@@ -123,6 +185,21 @@ namespace eosio { namespace chain {
       built_in_types.emplace("symbol_code",               pack_unpack<symbol_code>());
       built_in_types.emplace("asset",                     pack_unpack<asset>());
       built_in_types.emplace("extended_asset",            pack_unpack<extended_asset>());
+
+      // the types of most table rows, whose JSON does not depend on their content being valid
+      built_in_json.emplace("int16",                      integer_to_json<int16_t>);
+      built_in_json.emplace("uint16",                     integer_to_json<uint16_t>);
+      built_in_json.emplace("int32",                      integer_to_json<int32_t>);
+      built_in_json.emplace("uint32",                     integer_to_json<uint32_t>);
+      built_in_json.emplace("int64",                      integer_to_json<int64_t>);
+      built_in_json.emplace("uint64",                     integer_to_json<uint64_t>);
+      built_in_json.emplace("name",                       name_to_json);
+      built_in_json.emplace("asset",                      asset_to_json);
+      built_in_json.emplace("checksum160",                checksum_to_json<checksum160_type>);
+      built_in_json.emplace("checksum256",                checksum_to_json<checksum256_type>);
+      built_in_json.emplace("checksum512",                checksum_to_json<checksum512_type>);
+
+      compile_types();
    }
 
    void abi_serializer::set_abi(const abi_def& abi, const yield_function_t& yield) {
@@ -180,6 +257,7 @@ namespace eosio { namespace chain {
       EOS_ASSERT( action_results.size() == abi.action_results.value.size(), duplicate_abi_action_results_def_exception, "duplicate action results definition detected" );
 
       validate(ctx);
+      compile_types();
    }
 
    bool abi_serializer::is_builtin_type(const std::string_view& type)const {
@@ -331,6 +409,85 @@ namespace eosio { namespace chain {
       return type;
    }
 
+   abi_serializer::resolved_type abi_serializer::make_resolved_type( const std::string_view& type )const {
+      resolved_type result;
+      result.rtype    = resolve_type(type);
+      result.ftype    = fundamental_type(result.rtype);
+      result.array    = is_array(result.rtype);
+      result.optional = is_optional(result.rtype);
+      if( auto itr = built_in_types.find(result.ftype); itr != built_in_types.end() )
+         result.built_in = &itr->second;
+      if( auto itr = built_in_json.find(result.ftype); itr != built_in_json.end() )
+         result.built_in_to_json = itr->second;
+      if( auto itr = variants.find(result.rtype); itr != variants.end() )
+         result.variant_itr = itr;
+      if( auto itr = structs.find(result.rtype); itr != structs.end() )
+         result.struct_itr = itr;
+      if( !kv_tables.empty() && is_string_valid_name(result.rtype) ) {
+         if( auto itr = kv_tables.find(name(result.rtype)); itr != kv_tables.end() )
+            result.kv_table = &itr->second;
+      }
+      return result;
+   }
+
+   void abi_serializer::compile_types() {
+      resolved_types.clear();
+
+      std::vector<std::string_view> pending;
+      for( const auto& b : built_in_types )
+         pending.push_back(b.first);
+      for( const auto& t : typedefs ) {
+         pending.push_back(t.first);
+         pending.push_back(t.second);
+      }
+      for( const auto& st : structs ) {
+         pending.push_back(st.first);
+         if( st.second.base != type_name() )
+            pending.push_back(st.second.base);
+         for( const auto& field : st.second.fields )
+            pending.push_back(_remove_bin_extension(field.type));
+      }
+      for( const auto& v : variants ) {
+         pending.push_back(v.first);
+         for( const auto& type : v.second.types )
+            pending.push_back(type);
+      }
+      for( const auto& a : actions )
+         pending.push_back(a.second);
+      for( const auto& t : tables )
+         pending.push_back(t.second);
+      for( const auto& r : action_results )
+         pending.push_back(r.second);
+      std::vector<type_name> kv_table_names;
+      for( const auto& kt : kv_tables ) {
+         kv_table_names.push_back(kt.first.to_string());
+         pending.push_back(kt.second.type);
+      }
+      for( const auto& kt : kv_table_names )
+         pending.push_back(kt);
+
+      while( !pending.empty() ) {
+         const auto type = pending.back();
+         pending.pop_back();
+         if( resolved_types.find(type) != resolved_types.end() )
+            continue;
+         // resolve the copy of the name owned by resolved_types, so the string_views stay valid
+         auto itr = resolved_types.emplace(type_name(type), resolved_type{}).first;
+         itr->second = make_resolved_type(itr->first);
+         if( itr->second.rtype != itr->first )
+            pending.push_back(itr->second.rtype);
+         if( itr->second.ftype != itr->second.rtype )
+            pending.push_back(itr->second.ftype);
+      }
+   }
+
+   const abi_serializer::resolved_type& abi_serializer::get_resolved_type( const std::string_view& type, resolved_type& scratch )const {
+      if( auto itr = resolved_types.find(type); itr != resolved_types.end() )
+         return itr->second;
+      scratch = make_resolved_type(type);
+      return scratch;
+   }
+
    void abi_serializer::_binary_to_variant( const std::string_view& type, fc::datastream<const char *>& stream,
                                             fc::mutable_variant_object& obj, impl::binary_to_variant_context& ctx )const
    {
@@ -360,7 +517,7 @@ namespace eosio { namespace chain {
 
          }
          auto h1 = ctx.push_to_path( impl::field_path_item{ .parent_struct_itr = s_itr, .field_ordinal = i } );
-         obj( field.name, _binary_to_variant(resolve_type( extension ? _remove_bin_extension(field.type) : field.type ), stream, ctx) );
+         obj( field.name, _binary_to_variant(extension ? _remove_bin_extension(field.type) : std::string_view(field.type), stream, ctx) );
       }
    }
 
@@ -368,17 +525,18 @@ namespace eosio { namespace chain {
                                                    impl::binary_to_variant_context& ctx )const
    {
       auto h = ctx.enter_scope();
-      auto rtype = resolve_type(type);
-      auto ftype = fundamental_type(rtype);
-      auto btype = built_in_types.find(ftype );
-      if( btype != built_in_types.end() ) {
+      resolved_type scratch;
+      const auto& resolved = get_resolved_type(type, scratch);
+      auto rtype = resolved.rtype;
+      auto ftype = resolved.ftype;
+      if( resolved.built_in ) {
          try {
-            return btype->second.first(stream, is_array(rtype), is_optional(rtype), ctx.get_yield_function());
+            return resolved.built_in->first(stream, resolved.array, resolved.optional, ctx.get_yield_function());
          } EOS_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack ${class} type '${type}' while processing '${p}'",
-                                   ("class", is_array(rtype) ? "array of built-in" : is_optional(rtype) ? "optional of built-in" : "built-in")
+                                   ("class", resolved.array ? "array of built-in" : resolved.optional ? "optional of built-in" : "built-in")
                                    ("type", impl::limit_size(ftype))("p", ctx.get_path_string()) )
       }
-      if ( is_array(rtype) ) {
+      if ( resolved.array ) {
          ctx.hint_array_type_if_in_array();
          fc::unsigned_int size;
          try {
@@ -401,15 +559,15 @@ namespace eosio { namespace chain {
                      "packed size does not match unpacked array size, packed size ${p} actual size ${a}",
                      ("p", size)("a", vars.size()) );
          return fc::variant( std::move(vars) );
-      } else if ( is_optional(rtype) ) {
+      } else if ( resolved.optional ) {
          char flag;
          try {
             fc::raw::unpack(stream, flag);
          } EOS_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack presence flag of optional '${p}'", ("p", ctx.get_path_string()) )
          return flag ? _binary_to_variant(ftype, stream, ctx) : fc::variant();
       } else {
-         auto v_itr = variants.find(rtype);
-         if( v_itr != variants.end() ) {
+         if( resolved.variant_itr ) {
+            auto v_itr = *resolved.variant_itr;
             ctx.hint_variant_type_if_in_array(v_itr);
             fc::unsigned_int select;
             try {
@@ -421,11 +579,8 @@ namespace eosio { namespace chain {
             return vector<fc::variant>{v_itr->second.types[select], _binary_to_variant(v_itr->second.types[select], stream, ctx)};
          }
 
-         if( !kv_tables.empty() && is_string_valid_name(rtype) ) {
-            if( auto kv_itr = kv_tables.find(name(rtype)); kv_itr != kv_tables.end() ) {
-               auto &kv_table = kv_itr->second;
-               return _binary_to_variant(kv_table.type, stream, ctx);
-            }
+         if( resolved.kv_table ) {
+            return _binary_to_variant(resolved.kv_table->type, stream, ctx);
          }
       }
 
@@ -455,18 +610,188 @@ namespace eosio { namespace chain {
       return _binary_to_variant(type, binary, ctx);
    }
 
+   void abi_serializer::_binary_to_json( const std::string_view& type, fc::datastream<const char *>& stream, std::string& out,
+                                         std::vector<std::tuple<std::string_view, size_t, size_t>>& fields,
+                                         impl::binary_to_variant_context& ctx )const
+   {
+      auto h = ctx.enter_scope();
+      auto s_itr = structs.find(type);
+      EOS_ASSERT( s_itr != structs.end(), invalid_type_inside_abi, "Unknown type ${type}", ("type",ctx.maybe_shorten(type)) );
+      ctx.hint_struct_type_if_in_array( s_itr );
+      const auto& st = s_itr->second;
+      if( st.base != type_name() ) {
+         _binary_to_json(resolve_type(st.base), stream, out, fields, ctx);
+      }
+      bool encountered_extension = false;
+      for( uint32_t i = 0; i < st.fields.size(); ++i ) {
+         const auto& field = st.fields[i];
+         bool extension = ends_with(field.type, "$");
+         encountered_extension |= extension;
+         if( !stream.remaining() ) {
+            if( extension ) {
+               continue;
+            }
+            if( encountered_extension ) {
+               EOS_THROW( abi_exception, "Encountered field '${f}' without binary extension designation while processing struct '${p}'",
+                          ("f", ctx.maybe_shorten(field.name))("p", ctx.get_path_string()) );
+            }
+            EOS_THROW( unpack_exception, "Stream unexpectedly ended; unable to unpack field '${f}' of struct '${p}'",
+                       ("f", ctx.maybe_shorten(field.name))("p", ctx.get_path_string()) );
+
+         }
+         auto h1 = ctx.push_to_path( impl::field_path_item{ .parent_struct_itr = s_itr, .field_ordinal = i } );
+         const std::string_view ftype = extension ? _remove_bin_extension(field.type) : std::string_view(field.type);
+         auto dup = std::find_if( fields.begin(), fields.end(), [&field]( const auto& f ) { return std::get<0>(f) == field.name; } );
+         if( dup == fields.end() ) {
+            if( !fields.empty() ) out += ',';
+            out += fc::json::to_string( fc::variant(field.name), fc::time_point::maximum() );
+            out += ':';
+            const size_t begin = out.size();
+            _binary_to_json(ftype, stream, out, ctx);
+            fields.emplace_back( field.name, begin, out.size() );
+         } else {
+            // as with the mutable_variant_object of _binary_to_variant, a field of a derived struct replaces the
+            // value of the base struct field of the same name
+            const size_t begin = out.size();
+            _binary_to_json(ftype, stream, out, ctx);
+            const std::string value = out.substr( begin );
+            out.resize( begin );
+            auto& [name, value_begin, value_end] = *dup;
+            out.replace( value_begin, value_end - value_begin, value );
+            const size_t old_size = value_end - value_begin;
+            value_end = value_begin + value.size();
+            for( auto itr = std::next( dup ); itr != fields.end(); ++itr ) {
+               std::get<1>(*itr) = std::get<1>(*itr) + value.size() - old_size;
+               std::get<2>(*itr) = std::get<2>(*itr) + value.size() - old_size;
+            }
+         }
+      }
+   }
+
+   void abi_serializer::_binary_to_json( const std::string_view& type, fc::datastream<const char *>& stream,
+                                         std::string& out, impl::binary_to_variant_context& ctx )const
+   {
+      auto h = ctx.enter_scope();
+      resolved_type scratch;
+      const auto& resolved = get_resolved_type(type, scratch);
+      auto rtype = resolved.rtype;
+      auto ftype = resolved.ftype;
+      if( resolved.built_in ) {
+         fc::variant v;
+         try {
+            if( resolved.built_in_to_json ) {
+               if( resolved.array ) {
+                  fc::unsigned_int size;
+                  fc::raw::unpack(stream, size);
+                  out += '[';
+                  for( decltype(size.value) i = 0; i < size; ++i ) {
+                     if( i > 0 ) out += ',';
+                     resolved.built_in_to_json(stream, out);
+                  }
+                  out += ']';
+               } else if( resolved.optional ) {
+                  bool present;
+                  fc::raw::unpack(stream, present);
+                  if( present )
+                     resolved.built_in_to_json(stream, out);
+                  else
+                     out += "null";
+               } else {
+                  resolved.built_in_to_json(stream, out);
+               }
+               return;
+            }
+            v = resolved.built_in->first(stream, resolved.array, resolved.optional, ctx.get_yield_function());
+         } EOS_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack ${class} type '${type}' while processing '${p}'",
+                                   ("class", resolved.array ? "array of built-in" : resolved.optional ? "optional of built-in" : "built-in")
+                                   ("type", impl::limit_size(ftype))("p", ctx.get_path_string()) )
+         out += fc::json::to_string( v, fc::time_point::maximum() );
+         return;
+      }
+      if ( resolved.array ) {
+         ctx.hint_array_type_if_in_array();
+         fc::unsigned_int size;
+         try {
+            fc::raw::unpack(stream, size);
+         } EOS_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack size of array '${p}'", ("p", ctx.get_path_string()) )
+         auto h1 = ctx.push_to_path( impl::array_index_path_item{} );
+         out += '[';
+         for( decltype(size.value) i = 0; i < size; ++i ) {
+            ctx.set_array_index_of_path_back(i);
+            if( i > 0 ) out += ',';
+            const auto start = out.size();
+            _binary_to_json(ftype, stream, out, ctx);
+            // same restriction as _binary_to_variant, which does not allow null elements
+            EOS_ASSERT( out.compare(start, std::string::npos, "null") != 0, unpack_exception, "Invalid packed array '${p}'", ("p", ctx.get_path_string()) );
+         }
+         out += ']';
+         return;
+      } else if ( resolved.optional ) {
+         char flag;
+         try {
+            fc::raw::unpack(stream, flag);
+         } EOS_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack presence flag of optional '${p}'", ("p", ctx.get_path_string()) )
+         if( flag ) {
+            _binary_to_json(ftype, stream, out, ctx);
+         } else {
+            out += "null";
+         }
+         return;
+      } else {
+         if( resolved.variant_itr ) {
+            auto v_itr = *resolved.variant_itr;
+            ctx.hint_variant_type_if_in_array(v_itr);
+            fc::unsigned_int select;
+            try {
+               fc::raw::unpack(stream, select);
+            } EOS_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack tag of variant '${p}'", ("p", ctx.get_path_string()) )
+            EOS_ASSERT( (size_t)select < v_itr->second.types.size(), unpack_exception,
+                        "Unpacked invalid tag (${select}) for variant '${p}'", ("select", select.value)("p",ctx.get_path_string()) );
+            auto h1 = ctx.push_to_path( impl::variant_path_item{ .variant_itr = v_itr, .variant_ordinal = static_cast<uint32_t>(select) } );
+            out += '[';
+            out += fc::json::to_string( fc::variant(v_itr->second.types[select]), fc::time_point::maximum() );
+            out += ',';
+            _binary_to_json(v_itr->second.types[select], stream, out, ctx);
+            out += ']';
+            return;
+         }
+
+         if( resolved.kv_table ) {
+            _binary_to_json(resolved.kv_table->type, stream, out, ctx);
+            return;
+         }
+      }
+
+      std::vector<std::tuple<std::string_view, size_t, size_t>> fields;
+      out += '{';
+      _binary_to_json(rtype, stream, out, fields, ctx);
+      EOS_ASSERT( !fields.empty(), unpack_exception, "Unable to unpack '${p}' from stream", ("p", ctx.get_path_string()) );
+      out += '}';
+   }
+
+   std::string abi_serializer::binary_to_json( const std::string_view& type, const bytes& binary, const yield_function_t& yield, bool short_path )const {
+      fc::datastream<const char*> ds( binary.data(), binary.size() );
+      std::string out;
+      binary_to_json(type, ds, out, yield, short_path);
+      return out;
+   }
+
+   void abi_serializer::binary_to_json( const std::string_view& type, fc::datastream<const char*>& binary, std::string& out, const yield_function_t& yield, bool short_path )const {
+      impl::binary_to_variant_context ctx(*this, yield, type);
+      ctx.short_path = short_path;
+      _binary_to_json(type, binary, out, ctx);
+   }
+
    void abi_serializer::_variant_to_binary( const std::string_view& type, const fc::variant& var, fc::datastream<char *>& ds, impl::variant_to_binary_context& ctx )const
    { try {
       auto h = ctx.enter_scope();
-      auto rtype = resolve_type(type);
-
-      auto v_itr = variants.end();
-      auto s_itr = structs.end();
+      resolved_type scratch;
+      const auto& resolved = get_resolved_type(type, scratch);
+      auto rtype = resolved.rtype;
 
-      auto btype = built_in_types.find(fundamental_type(rtype));
-      if( btype != built_in_types.end() ) {
-         btype->second.second(var, ds, is_array(rtype), is_optional(rtype), ctx.get_yield_function());
-      } else if ( is_array(rtype) ) {
+      if( resolved.built_in ) {
+         resolved.built_in->second(var, ds, resolved.array, resolved.optional, ctx.get_yield_function());
+      } else if ( resolved.array ) {
          ctx.hint_array_type_if_in_array();
          vector<fc::variant> vars = var.get_array();
          fc::raw::pack(ds, (fc::unsigned_int)vars.size());
@@ -477,16 +802,17 @@ namespace eosio { namespace chain {
          int64_t i = 0;
          for (const auto& var : vars) {
             ctx.set_array_index_of_path_back(i);
-           _variant_to_binary(fundamental_type(rtype), var, ds, ctx);
+           _variant_to_binary(resolved.ftype, var, ds, ctx);
            ++i;
          }
-      } else if( is_optional(rtype) ) {
+      } else if( resolved.optional ) {
          char flag = !var.is_null();
          fc::raw::pack(ds, flag);
          if( flag ) {
-            _variant_to_binary(fundamental_type(rtype), var, ds, ctx);
+            _variant_to_binary(resolved.ftype, var, ds, ctx);
          }
-      } else if( (v_itr = variants.find(rtype)) != variants.end() ) {
+      } else if( resolved.variant_itr ) {
+         auto v_itr = *resolved.variant_itr;
          ctx.hint_variant_type_if_in_array( v_itr );
          auto& v = v_itr->second;
          EOS_ASSERT( var.is_array() && var.size() == 2, pack_exception,
@@ -501,7 +827,8 @@ namespace eosio { namespace chain {
          fc::raw::pack(ds, fc::unsigned_int(it - v.types.begin()));
          auto h1 = ctx.push_to_path( impl::variant_path_item{ .variant_itr = v_itr, .variant_ordinal = static_cast<uint32_t>(it - v.types.begin()) } );
          _variant_to_binary( *it, var[size_t(1)], ds, ctx );
-      } else if( (s_itr = structs.find(rtype)) != structs.end() ) {
+      } else if( resolved.struct_itr ) {
+         auto s_itr = *resolved.struct_itr;
          ctx.hint_struct_type_if_in_array( s_itr );
          const auto& st = s_itr->second;
 
@@ -0,0 +1,65 @@
+#include <eosio/chain/abi_serializer_cache.hpp>
+#include <eosio/chain/account_object.hpp>
+
+#include <string_view>
+
+namespace eosio { namespace chain {
+
+   std::shared_ptr<const abi_serializer> abi_serializer_cache::get( const chainbase::database& db, account_name n,
+                                                                    const abi_serializer::yield_function_t& yield ) {
+      const auto* accnt = db.find<account_object, by_name>( n );
+      const auto* meta  = db.find<account_metadata_object, by_name>( n );
+      if( accnt == nullptr || meta == nullptr || abi_serializer::is_empty_abi( accnt->abi ) )
+         return {};
+
+      const std::string_view abi_bytes( accnt->abi.data(), accnt->abi.size() );
+      {
+         std::lock_guard g( mtx );
+         auto itr = entries.find( n );
+         if( itr != entries.end() ) {
+            if( itr->second.abi_sequence == meta->abi_sequence && itr->second.abi == abi_bytes ) {
+               lru.splice( lru.begin(), lru, itr->second.lru_itr );
+               return itr->second.serializer;
+            }
+            lru.erase( itr->second.lru_itr );
+            entries.erase( itr );
+         }
+      }
+
+      // parse without holding the lock, a concurrent lookup of the same ABI at worst parses it twice
+      abi_def abi;
+      abi_serializer::to_abi( accnt->abi, abi );
+      auto serializer = std::make_shared<const abi_serializer>( abi, yield );
+
+      std::lock_guard g( mtx );
+      auto itr = entries.find( n );
+      if( itr == entries.end() ) {
+         lru.push_front( n );
+         itr = entries.emplace( n, entry{} ).first;
+         itr->second.lru_itr = lru.begin();
+      } else {
+         lru.splice( lru.begin(), lru, itr->second.lru_itr );
+      }
+      itr->second.abi_sequence = meta->abi_sequence;
+      itr->second.abi.assign( abi_bytes.data(), abi_bytes.size() );
+      itr->second.serializer = serializer;
+
+      while( entries.size() > max_entries ) {
+         entries.erase( lru.back() );
+         lru.pop_back();
+      }
+      return serializer;
+   }
+
+   void abi_serializer_cache::clear() {
+      std::lock_guard g( mtx );
+      entries.clear();
+      lru.clear();
+   }
+
+   size_t abi_serializer_cache::size() const {
+      std::lock_guard g( mtx );
+      return entries.size();
+   }
+
+} } // eosio::chain
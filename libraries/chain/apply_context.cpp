@@ -12,6 +12,7 @@
 #include <eosio/chain/global_property_object.hpp>
 #include <boost/container/flat_set.hpp>
 #include <eosio/chain/kv_chainbase_objects.hpp>
+#include <fc/scoped_exit.hpp>
 
 using boost::container::flat_set;
 
@@ -33,6 +34,36 @@ static inline void print_debug(account_name receiver, const action_trace& ar) {
    }
 }
 
+namespace {
+   // enough for the deepest nesting of inline actions with room to spare
+   constexpr size_t max_pooled_scratch            = 16;
+   // scratch that grew beyond this many elements (huge notification fan out) is freed instead of pooled
+   constexpr size_t max_retained_scratch_capacity = 1024;
+
+   thread_local std::vector<std::unique_ptr<apply_context_scratch>> scratch_free_list;
+}
+
+apply_context_scratch::ptr apply_context_scratch::acquire() {
+   if( scratch_free_list.empty() )
+      return ptr( new apply_context_scratch );
+   ptr result( scratch_free_list.back().release() );
+   scratch_free_list.pop_back();
+   return result;
+}
+
+void apply_context_scratch::deleter::operator()( apply_context_scratch* s )const {
+   std::unique_ptr<apply_context_scratch> p( s );
+   if( scratch_free_list.size() >= max_pooled_scratch
+       || s->notified.capacity() > max_retained_scratch_capacity
+       || s->inline_actions.capacity() > max_retained_scratch_capacity
+       || s->cfa_inline_actions.capacity() > max_retained_scratch_capacity )
+      return;
+   s->notified.clear();
+   s->inline_actions.clear();
+   s->cfa_inline_actions.clear();
+   scratch_free_list.emplace_back( std::move( p ) );
+}
+
 apply_context::apply_context(controller& con, transaction_context& trx_ctx, uint32_t action_ordinal, uint32_t depth)
 :control(con)
 ,db(con.mutable_db())
@@ -40,11 +71,15 @@ apply_context::apply_context(controller& con, transaction_context& trx_ctx, uint
 ,recurse_depth(depth)
 ,first_receiver_action_ordinal(action_ordinal)
 ,action_ordinal(action_ordinal)
+,_scratch(apply_context_scratch::acquire())
 ,idx64(*this)
 ,idx128(*this)
 ,idx256(*this)
 ,idx_double(*this)
 ,idx_long_double(*this)
+,_notified(_scratch->notified)
+,_inline_actions(_scratch->inline_actions)
+,_cfa_inline_actions(_scratch->cfa_inline_actions)
 {
    kv_iterators.emplace_back(); // the iterator handle with value 0 is reserved
    action_trace& trace = trx_ctx.get_action_trace(action_ordinal);
@@ -107,6 +142,10 @@ void apply_context::exec_one()
             kv_backing_store = control.kv_db().create_kv_context(receiver, create_kv_resource_manager(*this), control.get_global_properties().kv_configuration);
         }
          receiver_account = &db.get<account_metadata_object,by_name>( receiver );
+         if( trx_context.access_set ) {
+            trx_context.access_set->add_read( act->account );
+            if( !context_free ) trx_context.access_set->add_write( receiver );
+         }
          if( !(context_free && control.skip_trx_checks()) ) {
             privileged = receiver_account->is_privileged();
             auto native = control.find_apply_handler( receiver, act->account, act->name );
@@ -285,7 +324,7 @@ void apply_context::require_recipient( account_name recipient ) {
    if( !has_recipient(recipient) ) {
       _notified.emplace_back(
          recipient,
-         schedule_action( action_ordinal, recipient, false )
+         schedule_action( first_receiver_action_ordinal, recipient, false )
       );
 
       if (auto dm_logger = control.get_deep_mind_logger()) {
@@ -356,9 +395,13 @@ void apply_context::execute_inline( action&& a ) {
    }
    // No need to check authorization if replaying irreversible blocks or contract is privileged
    if( !control.skip_auth_check() && !privileged ) {
+      // check_authorization takes a vector; move the action in and back out rather than copying its payload
+      vector<action> actions_to_check;
+      actions_to_check.emplace_back( std::move(a) );
+      auto restore_action = fc::make_scoped_exit( [&]() { a = std::move( actions_to_check.front() ); } );
       try {
          control.get_authorization_manager()
-                .check_authorization( {a},
+                .check_authorization( actions_to_check,
                                       {},
                                       {{receiver, config::eosio_code_name}},
                                       control.pending_block_time() - trx_context.published,
@@ -702,7 +745,8 @@ uint32_t apply_context::schedule_action( uint32_t ordinal_of_action_to_schedule,
                                                                     receiver, context_free,
                                                                     action_ordinal, first_receiver_action_ordinal );
 
-   act = &trx_context.get_action_trace( action_ordinal ).act;
+   // notifications may not carry the action payload in their trace, see transaction_context::trace_notification_payloads
+   act = &trx_context.get_action_trace( first_receiver_action_ordinal ).act;
    return scheduled_action_ordinal;
 }
 
@@ -712,17 +756,29 @@ uint32_t apply_context::schedule_action( action&& act_to_schedule, account_name
                                                                     receiver, context_free,
                                                                     action_ordinal, first_receiver_action_ordinal );
 
-   act = &trx_context.get_action_trace( action_ordinal ).act;
+   // notifications may not carry the action payload in their trace, see transaction_context::trace_notification_payloads
+   act = &trx_context.get_action_trace( first_receiver_action_ordinal ).act;
    return scheduled_action_ordinal;
 }
 
 const table_id_object* apply_context::find_table( name code, name scope, name table ) {
-   return db.find<table_id_object, by_code_scope_table>(boost::make_tuple(code, scope, table));
+   if( trx_context.access_set ) trx_context.access_set->add_read( code );
+   const auto key = std::make_tuple(code, scope, table);
+   auto itr = _table_lookups.lower_bound( key );
+   if( itr == _table_lookups.end() || itr->first != key ) {
+      itr = _table_lookups.emplace_hint( itr, key, db.find<table_id_object, by_code_scope_table>(boost::make_tuple(code, scope, table)) );
+   }
+   return itr->second;
 }
 
 const table_id_object& apply_context::find_or_create_table( name code, name scope, name table, const account_name &payer ) {
+   auto& cached_tid = _table_lookups[std::make_tuple(code, scope, table)];
+   if (cached_tid != nullptr) {
+      return *cached_tid;
+   }
    const auto* existing_tid =  db.find<table_id_object, by_code_scope_table>(boost::make_tuple(code, scope, table));
    if (existing_tid != nullptr) {
+      cached_tid = existing_tid;
       return *existing_tid;
    }
 
@@ -733,7 +789,7 @@ const table_id_object& apply_context::find_or_create_table( name code, name scop
 
    update_db_usage(payer, config::billable_size_v<table_id_object>, db_context::add_table_trace(get_action_id(), std::move(event_id)));
 
-   return db.create<table_id_object>([&](table_id_object &t_id){
+   const auto& tid = db.create<table_id_object>([&](table_id_object &t_id){
       t_id.code = code;
       t_id.scope = scope;
       t_id.table = table;
@@ -743,6 +799,8 @@ const table_id_object& apply_context::find_or_create_table( name code, name scop
          db_context::log_insert_table(*dm_logger, get_action_id(), code, scope, table, payer);
       }
    });
+   cached_tid = &tid;
+   return tid;
 }
 
 void apply_context::remove_table( const table_id_object& tid ) {
@@ -757,6 +815,7 @@ void apply_context::remove_table( const table_id_object& tid ) {
       db_context::log_remove_table(*dm_logger, get_action_id(), tid.code, tid.scope, tid.table, tid.payer);
    }
 
+   _table_lookups.erase( std::make_tuple(tid.code, tid.scope, tid.table) );
    db.remove(tid);
 }
 
@@ -1076,6 +1135,7 @@ int64_t apply_context::kv_set(uint64_t contract, const char* key, uint32_t key_s
 }
 
 bool apply_context::kv_get(uint64_t contract, const char* key, uint32_t key_size, uint32_t& value_size) {
+   if( trx_context.access_set ) trx_context.access_set->add_read( name(contract) );
    return kv_get_backing_store().kv_get(contract, key, key_size, value_size);
 }
 
@@ -1084,6 +1144,7 @@ uint32_t apply_context::kv_get_data(uint32_t offset, char* data, uint32_t data_s
 }
 
 uint32_t apply_context::kv_it_create(uint64_t contract, const char* prefix, uint32_t size) {
+   if( trx_context.access_set ) trx_context.access_set->add_read( name(contract) );
    uint32_t itr;
    if (!kv_destroyed_iterators.empty()) {
       itr = kv_destroyed_iterators.back();
@@ -17,15 +17,33 @@ int64_t asset::precision()const {
 }
 
 string asset::to_string()const {
-   string sign = amount < 0 ? "-" : "";
-   int64_t abs_amount = std::abs(amount);
-   string result = fc::to_string( static_cast<int64_t>(abs_amount) / precision());
-   if( decimals() )
-   {
-      auto fract = static_cast<int64_t>(abs_amount) % precision();
-      result += "." + fc::to_string(precision() + fract).erase(0,1);
+   char buf[max_string_size];
+   return string(buf, write_as_string(buf));
+}
+
+size_t asset::write_as_string(char* buf)const {
+   const uint64_t abs_amount = amount < 0 ? 0 - static_cast<uint64_t>(amount) : static_cast<uint64_t>(amount);
+   const uint8_t  p          = decimals();
+
+   // digits from the last one, with at least one digit before the decimal point
+   char   digits[20];
+   size_t n = 0;
+   for( uint64_t v = abs_amount; v > 0 || n <= p; v /= 10 )
+      digits[n++] = '0' + v % 10;
+
+   char* out = buf;
+   if( amount < 0 )
+      *out++ = '-';
+   while( n > p )
+      *out++ = digits[--n];
+   if( p ) {
+      *out++ = '.';
+      while( n > 0 )
+         *out++ = digits[--n];
    }
-   return sign + result + " " + symbol_name();
+   *out++ = ' ';
+   out += sym.write_name(out);
+   return out - buf;
 }
 
 asset asset::from_string(const string& from)
@@ -20,6 +20,11 @@ namespace eosio { namespace chain {
       permission_link_index
    >;
 
+   namespace {
+      // bounds the memory held by the block scoped lookup cache; hitting it simply starts the cache over
+      constexpr size_t max_cached_lookups = 8192;
+   }
+
    authorization_manager::authorization_manager(controller& c, database& d)
    :_control(c),_db(d){}
 
@@ -101,7 +106,7 @@ namespace eosio { namespace chain {
             return;
          }
 
-         snapshot->write_section<section_t>([this]( auto& section ){
+         snapshot->write_section_async<section_t>([this]( auto& section ){
             decltype(utils)::walk(_db, [this, &section]( const auto &row ) {
                section.add_row(row, _db);
             });
@@ -127,6 +132,7 @@ namespace eosio { namespace chain {
             }
          });
       });
+      reset_lookup_cache();
    }
 
    const permission_object& authorization_manager::create_permission( account_name account,
@@ -141,6 +147,8 @@ namespace eosio { namespace chain {
          EOS_ASSERT(static_cast<uint32_t>(k.key.which()) < _db.get<protocol_state_object>().num_supported_key_types, unactivated_key_type,
            "Unactivated key type used when creating permission");
 
+      reset_lookup_cache( true );
+
       auto creation_time = initial_creation_time;
       if( creation_time == time_point() ) {
          creation_time = _control.pending_block_time();
@@ -181,6 +189,8 @@ namespace eosio { namespace chain {
          EOS_ASSERT(static_cast<uint32_t>(k.key.which()) < _db.get<protocol_state_object>().num_supported_key_types, unactivated_key_type,
            "Unactivated key type used when creating permission");
 
+      reset_lookup_cache( true );
+
       auto creation_time = initial_creation_time;
       if( creation_time == time_point() ) {
          creation_time = _control.pending_block_time();
@@ -214,6 +224,8 @@ namespace eosio { namespace chain {
          EOS_ASSERT(static_cast<uint32_t>(k.key.which()) < _db.get<protocol_state_object>().num_supported_key_types, unactivated_key_type,
            "Unactivated key type used when modifying permission");
 
+      reset_lookup_cache( true );
+
       _db.modify( permission, [&](permission_object& po) {
          auto dm_logger = _control.get_deep_mind_logger();
 
@@ -244,6 +256,8 @@ namespace eosio { namespace chain {
       EOS_ASSERT( range.first == range.second, action_validate_exception,
                   "Cannot remove a permission which has children. Remove the children first.");
 
+      reset_lookup_cache( true );
+
       _db.get_mutable_index<permission_usage_index>().remove_object( permission.usage_id._id );
 
       if (auto dm_logger = _control.get_deep_mind_logger()) {
@@ -280,12 +294,42 @@ namespace eosio { namespace chain {
       return _db.get<permission_object, by_owner>( boost::make_tuple(level.actor,level.permission) );
    } EOS_RETHROW_EXCEPTIONS( chain::permission_query_exception, "Failed to retrieve permission: ${level}", ("level", level) ) }
 
+   void authorization_manager::reset_lookup_cache( bool disable )const {
+      _lookup_cache.permissions.clear();
+      _lookup_cache.links.clear();
+      _lookup_cache.disabled = disable;
+   }
+
+   const permission_object& authorization_manager::get_cached_permission( const permission_level& level )const {
+      if( _lookup_cache.disabled )
+         return get_permission( level );
+
+      auto itr = _lookup_cache.permissions.find( level );
+      if( itr != _lookup_cache.permissions.end() )
+         return *itr->second;
+
+      // only successful lookups are cached; a missing permission throws from get_permission as before
+      const auto& perm = get_permission( level );
+      if( _lookup_cache.permissions.size() >= max_cached_lookups )
+         _lookup_cache.permissions.clear();
+      _lookup_cache.permissions.emplace( level, &perm );
+      return perm;
+   }
+
    std::optional<permission_name> authorization_manager::lookup_linked_permission( account_name authorizer_account,
                                                                                    account_name scope,
                                                                                    action_name act_name
                                                                                  )const
    {
       try {
+         std::optional<link_key_type> cache_key;
+         if( !_lookup_cache.disabled ) {
+            cache_key.emplace( authorizer_account, scope, act_name );
+            auto itr = _lookup_cache.links.find( *cache_key );
+            if( itr != _lookup_cache.links.end() )
+               return itr->second;
+         }
+
          // First look up a specific link for this message act_name
          auto key = boost::make_tuple(authorizer_account, scope, act_name);
          auto link = _db.find<permission_link_object, by_action_name>(key);
@@ -296,10 +340,17 @@ namespace eosio { namespace chain {
          }
 
          // If no specific or default link found, use active permission
+         std::optional<permission_name> result;
          if (link != nullptr) {
-            return link->required_permission;
+            result = link->required_permission;
+         }
+
+         if( cache_key ) {
+            if( _lookup_cache.links.size() >= max_cached_lookups )
+               _lookup_cache.links.clear();
+            _lookup_cache.links.emplace( std::move(*cache_key), result );
          }
-         return std::optional<permission_name>();
+         return result;
       } FC_CAPTURE_AND_RETHROW((authorizer_account)(scope)(act_name))
    }
 
@@ -496,7 +547,7 @@ namespace eosio { namespace chain {
 
       auto effective_provided_delay =  (provided_delay >= delay_max_limit) ? fc::microseconds::maximum() : provided_delay;
 
-      auto checker = make_auth_checker( [&](const permission_level& p){ return get_permission(p).auth; },
+      auto checker = make_auth_checker( [&](const permission_level& p) -> const shared_authority& { return get_cached_permission(p).auth; },
                                         _control.get_global_properties().configuration.max_authority_depth,
                                         provided_keys,
                                         provided_permissions,
@@ -535,8 +586,8 @@ namespace eosio { namespace chain {
             if( !special_case ) {
                auto min_permission_name = lookup_minimum_permission(declared_auth.actor, act.account, act.name);
                if( min_permission_name ) { // since special cases were already handled, it should only be false if the permission is eosio.any
-                  const auto& min_permission = get_permission({declared_auth.actor, *min_permission_name});
-                  EOS_ASSERT( get_permission(declared_auth).satisfies( min_permission,
+                  const auto& min_permission = get_cached_permission({declared_auth.actor, *min_permission_name});
+                  EOS_ASSERT( get_cached_permission(declared_auth).satisfies( min_permission,
                                                                        _db.get_index<permission_index>().indices() ),
                               irrelevant_auth_exception,
                               "action declares irrelevant authority '${auth}'; minimum authority is ${min}",
@@ -597,7 +648,7 @@ namespace eosio { namespace chain {
 
       auto delay_max_limit = fc::seconds( _control.get_global_properties().configuration.max_transaction_delay );
 
-      auto checker = make_auth_checker( [&](const permission_level& p){ return get_permission(p).auth; },
+      auto checker = make_auth_checker( [&](const permission_level& p) -> const shared_authority& { return get_cached_permission(p).auth; },
                                         _control.get_global_properties().configuration.max_authority_depth,
                                         provided_keys,
                                         provided_permissions,
@@ -628,7 +679,7 @@ namespace eosio { namespace chain {
                                                                        fc::microseconds provided_delay
                                                                      )const
    {
-      auto checker = make_auth_checker( [&](const permission_level& p){ return get_permission(p).auth; },
+      auto checker = make_auth_checker( [&](const permission_level& p) -> const shared_authority& { return get_cached_permission(p).auth; },
                                         _control.get_global_properties().configuration.max_authority_depth,
                                         candidate_keys,
                                         {},
@@ -636,8 +687,12 @@ namespace eosio { namespace chain {
                                         _noop_checktime
                                       );
 
+      // wallets commonly declare the same authority on every action, checking it again only marks the same keys
+      flat_set<permission_level> checked_auths;
       for (const auto& act : trx.actions ) {
          for (const auto& declared_auth : act.authorization) {
+            if( !checked_auths.insert( declared_auth ).second )
+               continue;
             EOS_ASSERT( checker.satisfied(declared_auth), unsatisfied_authorization,
                         "transaction declares authority '${auth}', but does not have signatures for it.",
                         ("auth", declared_auth) );
@@ -83,6 +83,11 @@ namespace eosio { namespace chain { namespace backing_store { namespace db_key_v
          return { std::get<0>(intermittent), std::get<1>(intermittent), key_loc, kt };
       }
 
+      char contract_db_type() {
+         static const char db_type_prefix = make_rocksdb_contract_db_prefix();
+         return db_type_prefix;
+      }
+
       // NOTE: very limited use till redesign
       constexpr uint64_t db_type_and_code_size = detail::prefix_size<eosio::session::shared_bytes>() - detail::prefix_size<b1::chain_kv::bytes>(); // 1 (db type) + 8 (contract)
       static_assert(db_type_and_code_size == sizeof(char) + sizeof(name), "Some assumptions on formatting have been broken");
@@ -168,12 +173,7 @@ namespace eosio { namespace chain { namespace backing_store { namespace db_key_v
       if (comp != 0) {
          return false;
       }
-      auto start_offset = full_key.data() + sec_prefix_size;
-      const b1::chain_kv::bytes composite_primary_key {start_offset, start_offset + sizeof(primary_key)};
-      auto composite_loc = composite_primary_key.cbegin();
-      EOS_ASSERT(b1::chain_kv::extract_key(composite_loc, composite_primary_key.cend(), primary_key), bad_composite_key_exception,
-                 "DB intrinsic key-value store invariant has changed, extract_key should only fail if the string size is"
-                 " less than the sizeof(uint64_t)");
+      primary_key = detail::read_key<uint64_t>(full_key.data() + sec_prefix_size);
       return true;
    }
 
@@ -212,9 +212,11 @@ namespace eosio { namespace chain { namespace backing_store { namespace db_key_v
    }
 
    eosio::session::shared_bytes create_full_key(const b1::chain_kv::bytes& composite_key, name code) {
-      static const char db_type_prefix = make_rocksdb_contract_db_prefix();
-      b1::chain_kv::bytes code_as_bytes;
-      b1::chain_kv::append_key(code_as_bytes, code.to_uint64_t());
+      const char db_type_prefix = detail::contract_db_type();
+      std::array<char, sizeof(uint64_t)> code_as_bytes;
+      const uint64_t code_value = code.to_uint64_t();
+      for (std::size_t i = 0; i < code_as_bytes.size(); ++i)
+         code_as_bytes[i] = static_cast<char>(code_value >> (8 * (code_as_bytes.size() - 1 - i)));
       auto ret = eosio::session::make_shared_bytes<std::string_view, 3>({std::string_view{&db_type_prefix, 1},
                                                                      std::string_view{code_as_bytes.data(),
                                                                                       code_as_bytes.size()},
@@ -256,16 +258,8 @@ namespace eosio { namespace chain { namespace backing_store { namespace db_key_v
       const std::size_t db_type_and_contract_size = db_type_size + sizeof(name);
       EOS_ASSERT( full_key.size() >= db_type_and_contract_size, db_rocksdb_invalid_operation_exception,
                   "parse_full_key was passed a key with a db type and erroneous data trailing.");
-      const b1::chain_kv::bytes composite_contract_key {offset, offset + sizeof(name)};
+      data.contract = name{detail::read_key<uint64_t>(offset)};
       offset += sizeof(name);
-      auto composite_loc = composite_contract_key.cbegin();
-      uint64_t contract;
-      EOS_ASSERT(b1::chain_kv::extract_key(composite_loc, composite_contract_key.cend(), contract), bad_composite_key_exception,
-                 "DB intrinsic key-value store invariant has changed, extract_key should only fail if the string size is"
-                 " less than the sizeof(uint64_t), which was verified that it was not");
-      EOS_ASSERT( composite_loc == composite_contract_key.cend(), db_rocksdb_invalid_operation_exception,
-                  "bytes constructed to extract contract was constructed incorrectly.");
-      data.contract = name{contract};
       const auto remaining = full_key.size() - db_type_and_contract_size;
       if (!remaining) {
          return data;
@@ -282,12 +276,13 @@ namespace eosio { namespace chain { namespace backing_store { namespace db_key_v
    }
 
    eosio::session::shared_bytes create_full_primary_key(name code, name scope, name table, uint64_t primary_key) {
-      bytes composite_key = create_primary_key(scope, table, primary_key);
-      return create_full_key(composite_key, code);
+      return detail::full_key_builder(code, scope, table).append_type(key_type::primary).append_key(primary_key).finish();
    }
 
    eosio::session::shared_bytes create_full_prefix_key(name code, name scope, name table, std::optional<key_type> kt) {
-      bytes composite_key = kt ? create_prefix_type_key(scope, table, *kt) : create_prefix_key(scope, table);
-      return create_full_key(composite_key, code);
+      detail::full_key_builder builder(code, scope, table);
+      if (kt)
+         builder.append_type(*kt);
+      return builder.finish();
    }
 }}}} // namespace eosio::chain::backing_store::db_key_value_format
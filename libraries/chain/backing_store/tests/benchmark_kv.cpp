@@ -8,9 +8,21 @@
 #include <b1/session/rocks_session.hpp>
 #include <b1/session/session.hpp>
 
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include <rocksdb/cache.h>
+
 #include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
 
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <thread>
+
 using namespace eosio;
 using namespace eosio::chain;
 
@@ -30,6 +42,12 @@ struct cmd_args {
    uint32_t value_size = 1024;
    uint64_t num_runs = 1000000;
    uint32_t state_size_multiples = 1; // For Chainbase. Multiples of 1GB 
+   uint32_t session_depth = 1; // nested undo sessions the operations run in, e.g. 3 for block, transaction and action
+   uint32_t scan_length = 100; // For it_scan. Keys visited by each scan
+   uint32_t write_percent = 10; // For mix. Share of sets among the operations
+   uint32_t num_threads = 1; // For get, it_scan and secondary. Threads reading concurrently
+   uint64_t block_cache_mb = 0; // For RocksDB. 0 uses the RocksDB default
+   std::string output_format = "text";
 };
 
 struct measurement_t {
@@ -40,6 +58,8 @@ struct measurement_t {
    uint32_t major_faults;
    uint32_t blocks_in;
    uint32_t blocks_out;
+   double wall_duration_us_total;
+   double ops_per_sec;
 };
 
 struct dummy_control {
@@ -127,6 +147,12 @@ std::vector<std::string> load_workset(const cmd_args& args, uint32_t& workset_si
    return workset;
 }
 
+// The key of the index entry of key for "secondary". Reversing the key orders
+// the index differently from the primary keys, like a secondary index
+std::string secondary_key(const std::string& key) {
+   return "~" + std::string(key.rbegin(), key.rend());
+}
+
 // Read keys from key file and create key-values pairs 
 // on backing store.
 void create_key_values(const cmd_args& args, const std::unique_ptr<kv_context>& kv_context_ptr, uint32_t& num_keys) {
@@ -142,6 +168,10 @@ void create_key_values(const cmd_args& args, const std::unique_ptr<kv_context>&
    num_keys = 0;
    while (getline(key_file, key)) {
       kv_context_ptr->kv_set(contract, key.c_str(), key.size(), value.c_str(), value.size(), payer);
+      if (args.operation == "secondary") {
+         const auto index_key = secondary_key(key);
+         kv_context_ptr->kv_set(contract, index_key.c_str(), index_key.size(), key.c_str(), key.size(), payer);
+      }
       ++num_keys;
    }
 
@@ -166,7 +196,9 @@ double time_diff_us(const timeval& start, const timeval& end) {
 }
 
 // Returns calculated measurement based on raw data
-measurement_t calculated_measurement(const uint64_t actual_num_runs, const rusage& usage_start, const rusage& usage_end) {
+measurement_t calculated_measurement(const uint64_t actual_num_runs, const rusage& usage_start, const rusage& usage_end,
+                                     const std::chrono::steady_clock::time_point& wall_start) {
+   const auto wall_end = std::chrono::steady_clock::now();
    measurement_t m;
 
    m.actual_num_runs = actual_num_runs;
@@ -176,6 +208,8 @@ measurement_t calculated_measurement(const uint64_t actual_num_runs, const rusag
    m.major_faults = uint64_t(usage_end.ru_majflt  - usage_start.ru_majflt);
    m.blocks_in = uint64_t(usage_end.ru_inblock - usage_start.ru_inblock);
    m.blocks_out = uint64_t(usage_end.ru_oublock - usage_start.ru_oublock);
+   m.wall_duration_us_total = std::chrono::duration<double, std::micro>(wall_end - wall_start).count();
+   m.ops_per_sec = m.wall_duration_us_total > 0 ? actual_num_runs * 1e6 / m.wall_duration_us_total : 0;
 
    return m;
 }
@@ -186,6 +220,7 @@ measurement_t benchmark_get(const cmd_args& args, const std::unique_ptr<kv_conte
    rusage usage_start, usage_end;
 
    getrusage(RUSAGE_SELF, &usage_start);
+   const auto wall_start = std::chrono::steady_clock::now();
    for (auto i = 0U; i < num_loops; ++i) {
       for (auto& key: workset) {
          uint32_t actual_value_size;
@@ -194,7 +229,7 @@ measurement_t benchmark_get(const cmd_args& args, const std::unique_ptr<kv_conte
    }
    getrusage(RUSAGE_SELF, &usage_end);
 
-   return calculated_measurement(num_loops*workset.size(), usage_start, usage_end);
+   return calculated_measurement(num_loops*workset.size(), usage_start, usage_end, wall_start);
 }
 
 // Benchmark "get_data" operation
@@ -204,6 +239,7 @@ measurement_t benchmark_get_data(const cmd_args& args, const std::unique_ptr<kv_
    rusage usage_start, usage_end;
 
    getrusage(RUSAGE_SELF, &usage_start);
+   const auto wall_start = std::chrono::steady_clock::now();
    for (auto i = 0U; i < num_loops; ++i) {
       for (auto& key: workset) {
          kv_context_ptr->kv_get_data(0, data, args.value_size);
@@ -211,7 +247,7 @@ measurement_t benchmark_get_data(const cmd_args& args, const std::unique_ptr<kv_
    }
    getrusage(RUSAGE_SELF, &usage_end);
 
-   return calculated_measurement(num_loops*workset.size(), usage_start, usage_end);
+   return calculated_measurement(num_loops*workset.size(), usage_start, usage_end, wall_start);
 }
 
 // Benchmark "set" operation
@@ -221,6 +257,7 @@ measurement_t benchmark_set(const cmd_args& args, const std::unique_ptr<kv_conte
    rusage usage_start, usage_end;
 
    getrusage(RUSAGE_SELF, &usage_start);
+   const auto wall_start = std::chrono::steady_clock::now();
    for (auto i = 0U; i < num_loops; ++i) {
       for (auto& key: workset) {
          kv_context_ptr->kv_set(contract, key.c_str(), key.size(), value.c_str(), value.size(), payer);
@@ -228,7 +265,7 @@ measurement_t benchmark_set(const cmd_args& args, const std::unique_ptr<kv_conte
    }
    getrusage(RUSAGE_SELF, &usage_end);
 
-   return calculated_measurement(num_loops*workset.size(), usage_start, usage_end);
+   return calculated_measurement(num_loops*workset.size(), usage_start, usage_end, wall_start);
 }
 
 // Benchmark "create" operation
@@ -239,12 +276,13 @@ measurement_t benchmark_create(const cmd_args& args, const std::unique_ptr<kv_co
    rusage usage_start, usage_end;
 
    getrusage(RUSAGE_SELF, &usage_start);
+   const auto wall_start = std::chrono::steady_clock::now();
    for (auto& key: keys) {
       kv_context_ptr->kv_set(contract, key.c_str(), key.size(), value.c_str(), value.size(), payer);
    }
    getrusage(RUSAGE_SELF, &usage_end);
 
-   return calculated_measurement(keys.size(), usage_start, usage_end);
+   return calculated_measurement(keys.size(), usage_start, usage_end, wall_start);
 }
 
 // Benchmark "erase" operation
@@ -258,18 +296,20 @@ measurement_t benchmark_erase(const cmd_args& args, const std::unique_ptr<kv_con
 
    rusage usage_start, usage_end;
    getrusage(RUSAGE_SELF, &usage_start);
+   const auto wall_start = std::chrono::steady_clock::now();
    for (auto& key: keys) {
       kv_context_ptr->kv_erase(contract, key.c_str(), key.size());
    }
    getrusage(RUSAGE_SELF, &usage_end);
 
-   return calculated_measurement(keys.size(), usage_start, usage_end);
+   return calculated_measurement(keys.size(), usage_start, usage_end, wall_start);
 }
 
 // Benchmark "it_create" operation
 measurement_t benchmark_it_create(const cmd_args& args, const std::unique_ptr<kv_context>& kv_context_ptr) {
    rusage usage_start, usage_end;
    getrusage(RUSAGE_SELF, &usage_start);
+   const auto wall_start = std::chrono::steady_clock::now();
    auto i = 0U;
    std::string prefix = "a";
    while (i < args.num_runs) {
@@ -278,7 +318,7 @@ measurement_t benchmark_it_create(const cmd_args& args, const std::unique_ptr<kv
    }
    getrusage(RUSAGE_SELF, &usage_end);
 
-   return calculated_measurement(args.num_runs, usage_start, usage_end);
+   return calculated_measurement(args.num_runs, usage_start, usage_end, wall_start);
 }
 
 // Benchmark "it_next" operation
@@ -289,6 +329,7 @@ measurement_t benchmark_it_next(const cmd_args& args, const std::unique_ptr<kv_c
 
    rusage usage_start, usage_end;
    getrusage(RUSAGE_SELF, &usage_start);
+   const auto wall_start = std::chrono::steady_clock::now();
    while (it->kv_it_status() != kv_it_stat::iterator_end) {
       it->kv_it_next(&found_key_size, &found_value_size);
    }
@@ -296,7 +337,7 @@ measurement_t benchmark_it_next(const cmd_args& args, const std::unique_ptr<kv_c
 
    // As we are iterate the whole set of the keys, the number of runs
    // is num_keys.
-   return calculated_measurement(num_keys, usage_start, usage_end);
+   return calculated_measurement(num_keys, usage_start, usage_end, wall_start);
 }
 
 // Benchmark "it_key" operation
@@ -311,6 +352,7 @@ measurement_t benchmark_it_key(const cmd_args& args, const std::unique_ptr<kv_co
 
    rusage usage_start, usage_end;
    getrusage(RUSAGE_SELF, &usage_start);
+   const auto wall_start = std::chrono::steady_clock::now();
    while (it->kv_it_status() != kv_it_stat::iterator_end) {
       it->kv_it_key(offset, dest, found_key_size, actual_size);
       it->kv_it_next(&found_key_size, &found_value_size);
@@ -319,7 +361,7 @@ measurement_t benchmark_it_key(const cmd_args& args, const std::unique_ptr<kv_co
 
    // As we are iterate the whole set of the keys, the number of runs
    // is num_keys.
-   return calculated_measurement(num_keys, usage_start, usage_end);
+   return calculated_measurement(num_keys, usage_start, usage_end, wall_start);
 }
 
 // Benchmark "it_value" operation
@@ -334,6 +376,7 @@ measurement_t benchmark_it_value(const cmd_args& args, const std::unique_ptr<kv_
 
    rusage usage_start, usage_end;
    getrusage(RUSAGE_SELF, &usage_start);
+   const auto wall_start = std::chrono::steady_clock::now();
    while (it->kv_it_status() != kv_it_stat::iterator_end) {
       it->kv_it_value(offset, dest, found_value_size, actual_size);
       it->kv_it_next(&found_key_size, &found_value_size);
@@ -342,11 +385,133 @@ measurement_t benchmark_it_value(const cmd_args& args, const std::unique_ptr<kv_
 
    // As we are iterate the whole set of the keys, the number of runs
    // is num_keys.
-   return calculated_measurement(num_keys, usage_start, usage_end);
+   return calculated_measurement(num_keys, usage_start, usage_end, wall_start);
+}
+
+// "get" without measuring, for running on several threads
+uint64_t run_get(const cmd_args& args, kv_context& ctx, const std::vector<std::string>& workset) {
+   uint32_t num_loops = get_num_loops(args.num_runs, workset.size());
+   for (auto i = 0U; i < num_loops; ++i) {
+      for (auto& key: workset) {
+         uint32_t actual_value_size;
+         ctx.kv_get(contract, key.c_str(), key.size(), actual_value_size);
+      }
+   }
+   return uint64_t(num_loops) * workset.size();
+}
+
+// "it_scan": read the values of scan_length keys from the lower bound of
+// each workset key, like a contract reading a range of a table
+uint64_t run_it_scan(const cmd_args& args, kv_context& ctx, const std::vector<std::string>& workset) {
+   std::vector<char> dest(args.value_size);
+   uint32_t num_loops = get_num_loops(args.num_runs, workset.size());
+   uint32_t actual_size;
+   uint32_t found_key_size, found_value_size;
+   for (auto i = 0U; i < num_loops; ++i) {
+      for (auto& key: workset) {
+         auto it = ctx.kv_it_create(contract, "", 0);
+         it->kv_it_lower_bound(key.c_str(), key.size(), &found_key_size, &found_value_size);
+         for (auto n = 0U; n < args.scan_length && it->kv_it_status() == kv_it_stat::iterator_ok; ++n) {
+            it->kv_it_value(0, dest.data(), dest.size(), actual_size);
+            it->kv_it_next(&found_key_size, &found_value_size);
+         }
+      }
+   }
+   return uint64_t(num_loops) * workset.size();
+}
+
+// "secondary": find the primary key in the index entry of each workset key,
+// then get the primary row, like a lookup through a secondary index
+uint64_t run_secondary(const cmd_args& args, kv_context& ctx, const std::vector<std::string>& workset) {
+   std::vector<char> primary;
+   uint32_t num_loops = get_num_loops(args.num_runs, workset.size());
+   for (auto i = 0U; i < num_loops; ++i) {
+      for (auto& key: workset) {
+         const auto index_key = secondary_key(key);
+         uint32_t size;
+         if (ctx.kv_get(contract, index_key.c_str(), index_key.size(), size)) {
+            primary.resize(size);
+            ctx.kv_get_data(0, primary.data(), size);
+            ctx.kv_get(contract, primary.data(), size, size);
+         }
+      }
+   }
+   return uint64_t(num_loops) * workset.size();
+}
+
+// Run work concurrently, one thread per reader, and measure all of it
+// together. CPU times are of the process, so they add up over the threads
+measurement_t benchmark_threads(const std::vector<kv_context*>& readers, const std::function<uint64_t(kv_context&)>& work) {
+   std::vector<uint64_t> runs(readers.size());
+   std::vector<std::thread> threads;
+   rusage usage_start, usage_end;
+
+   getrusage(RUSAGE_SELF, &usage_start);
+   const auto wall_start = std::chrono::steady_clock::now();
+   for (size_t i = 0; i < readers.size(); ++i) {
+      threads.emplace_back([&, i]() { runs[i] = work(*readers[i]); });
+   }
+   for (auto& t: threads) {
+      t.join();
+   }
+   getrusage(RUSAGE_SELF, &usage_end);
+
+   return calculated_measurement(std::accumulate(runs.begin(), runs.end(), uint64_t(0)), usage_start, usage_end, wall_start);
+}
+
+// Benchmark "mix" operation: sets with a probability of write_percent,
+// gets otherwise, over the workset
+measurement_t benchmark_mix(const cmd_args& args, const std::unique_ptr<kv_context>& kv_context_ptr, const std::vector<std::string>& workset) {
+   std::string value(args.value_size, 'c');
+   std::minstd_rand gen(1); // the same sequence for every run
+   std::uniform_int_distribution<uint32_t> percent(0, 99);
+   uint32_t num_loops = get_num_loops(args.num_runs, workset.size());
+   rusage usage_start, usage_end;
+
+   getrusage(RUSAGE_SELF, &usage_start);
+   const auto wall_start = std::chrono::steady_clock::now();
+   for (auto i = 0U; i < num_loops; ++i) {
+      for (auto& key: workset) {
+         if (percent(gen) < args.write_percent) {
+            kv_context_ptr->kv_set(contract, key.c_str(), key.size(), value.c_str(), value.size(), payer);
+         } else {
+            uint32_t actual_value_size;
+            kv_context_ptr->kv_get(contract, key.c_str(), key.size(), actual_value_size);
+         }
+      }
+   }
+   getrusage(RUSAGE_SELF, &usage_end);
+
+   return calculated_measurement(num_loops*workset.size(), usage_start, usage_end, wall_start);
 }
 
 // Print out benchmarking results
 void print_results(const cmd_args& args, const uint32_t num_keys, const uint32_t workset_size, const measurement_t& m) {
+   if (args.output_format == "json") {
+      std::cout << fc::json::to_string(fc::mutable_variant_object()
+            ("backing_store", args.backing_store)
+            ("operation", args.operation)
+            ("key_file", args.key_file)
+            ("num_keys", num_keys)
+            ("workset_file", args.workset_file)
+            ("workset_size", workset_size)
+            ("value_size", args.value_size)
+            ("session_depth", args.session_depth)
+            ("scan_length", args.scan_length)
+            ("write_percent", args.write_percent)
+            ("num_threads", args.num_threads)
+            ("block_cache_mb", args.block_cache_mb)
+            ("num_runs", m.actual_num_runs)
+            ("user_cpu_us_avg", m.user_duration_us_avg)
+            ("system_cpu_us_avg", m.system_duration_us_avg)
+            ("wall_us_total", m.wall_duration_us_total)
+            ("ops_per_sec", m.ops_per_sec)
+            ("minor_faults_total", m.minor_faults)
+            ("major_faults_total", m.major_faults)
+            ("blocks_in_total", m.blocks_in)
+            ("blocks_out_total", m.blocks_out), fc::time_point::maximum()) << std::endl;
+      return;
+   }
    std::cout 
       << "backing_store: " << args.backing_store
       << ", operation: " << args.operation
@@ -362,11 +527,19 @@ void print_results(const cmd_args& args, const uint32_t num_keys, const uint32_t
       << ", major_faults_total: " << m.major_faults 
       << ", blocks_in_total: " << m.blocks_in  
       << ", blocks_out_total: " << m.blocks_out 
+      << ", session_depth: " << args.session_depth
+      << ", num_threads: " << args.num_threads
+      << ", wall_us_total: " << m.wall_duration_us_total
+      << ", ops_per_sec: " << m.ops_per_sec
       << std::endl;
 }
 
+// Returns the contexts of num_threads concurrent readers of what was
+// created through the context of the operation
+using make_readers_t = std::function<std::vector<kv_context*>()>;
+
 // Dispatcher to benchmark individual operation
-void benchmark_operation(const cmd_args& args, const std::unique_ptr<kv_context>& kv_context_ptr) {
+void benchmark_operation(const cmd_args& args, const std::unique_ptr<kv_context>& kv_context_ptr, const make_readers_t& make_readers) {
    measurement_t m;
    uint32_t num_keys {0}, workset_size {0};
 
@@ -376,10 +549,17 @@ void benchmark_operation(const cmd_args& args, const std::unique_ptr<kv_context>
       create_key_values(args, kv_context_ptr, num_keys);
    }
 
-   if (args.operation == "get" || args.operation == "get_data" || args.operation == "set") {
+   if (args.operation == "get" || args.operation == "get_data" || args.operation == "set" ||
+       args.operation == "it_scan" || args.operation == "secondary" || args.operation == "mix") {
       std::vector<std::string> workset = load_workset(args, workset_size);
       
-      if (args.operation == "get" ) {
+      if (args.num_threads > 1 || args.operation == "it_scan" || args.operation == "secondary") {
+         auto run = args.operation == "get" ? run_get : args.operation == "it_scan" ? run_it_scan : run_secondary;
+         const auto readers = args.num_threads > 1 ? make_readers() : std::vector<kv_context*>{ kv_context_ptr.get() };
+         m = benchmark_threads(readers, [&](kv_context& ctx) { return run(args, ctx, workset); });
+      } else if (args.operation == "mix" ) {
+         m = benchmark_mix(args, std::move(kv_context_ptr), workset);
+      } else if (args.operation == "get" ) {
          m = benchmark_get(args, std::move(kv_context_ptr), workset);
       } else if (args.operation == "get_data" ) {
          m = benchmark_get_data(args, std::move(kv_context_ptr), workset);
@@ -409,7 +589,7 @@ void benchmark_operation(const cmd_args& args, const std::unique_ptr<kv_context>
    print_results(args, num_keys, workset_size, m);
 }
 
-inline std::shared_ptr<rocksdb::DB> make_rocks_db(const std::string& name) {
+inline std::shared_ptr<rocksdb::DB> make_rocks_db(const std::string& name, uint64_t block_cache_mb) {
     rocksdb::DB* cache_ptr{ nullptr };
     auto         cache = std::shared_ptr<rocksdb::DB>{};
 
@@ -478,6 +658,12 @@ inline std::shared_ptr<rocksdb::DB> make_rocks_db(const std::string& name) {
     table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(15, false));
     table_options.index_type = rocksdb::BlockBasedTableOptions::kBinarySearch;
 
+    // A block cache smaller than the key values makes reads go to the
+    // files, to model a working set larger than the cache
+    if (block_cache_mb > 0) {
+       table_options.block_cache = rocksdb::NewLRUCache(block_cache_mb * 1024 * 1024);
+    }
+
     // Incorporates the Table options into options
     options.table_factory.reset(NewBlockBasedTableFactory(table_options));
 
@@ -495,18 +681,62 @@ void benchmark(const cmd_args& args) {
       boost::filesystem::remove_all(chain::config::default_state_dir_name);
 
       constexpr size_t max_rocks_iterators = 1024;
-      auto rocks_session = eosio::session::make_session(make_rocks_db("kvrdb-tmp"), max_rocks_iterators);
-      auto session = eosio::session::session<decltype(rocks_session)>{rocks_session};
+      auto db = make_rocks_db("kvrdb-tmp", args.block_cache_mb);
+      auto rocks_session = eosio::session::make_session(db, max_rocks_iterators);
+      using session_type = eosio::session::session<decltype(rocks_session)>;
+
+      // nested like the block, transaction and action sessions of the controller
+      std::deque<session_type> sessions;
+      sessions.emplace_back(rocks_session);
+      for (auto i = 1U; i < args.session_depth; ++i) {
+         sessions.emplace_back(sessions.back(), nullptr);
+      }
 
-      std::unique_ptr<kv_context> kv_context_ptr = create_kv_rocksdb_context<decltype(session), mock_resource_manager>(session, receiver, resource_manager, limits); 
-      benchmark_operation(args, std::move(kv_context_ptr)); // kv_context_ptr must be in the same scope as kv_db and usage_start, since they are references in create_kv_rocksdb_context
+      // the readers read through sessions of their own, as sessions are not
+      // thread safe, so what was created is committed to RocksDB first
+      std::deque<decltype(rocks_session)> reader_rocks_sessions;
+      std::deque<session_type> reader_sessions;
+      std::vector<std::unique_ptr<kv_context>> readers;
+      auto make_readers = [&]() {
+         for (auto itr = sessions.rbegin(); itr != sessions.rend(); ++itr) {
+            itr->commit();
+         }
+         std::vector<kv_context*> result;
+         for (auto i = 0U; i < args.num_threads; ++i) {
+            reader_rocks_sessions.emplace_back(eosio::session::make_session(db, max_rocks_iterators));
+            reader_sessions.emplace_back(reader_rocks_sessions.back());
+            readers.push_back(create_kv_rocksdb_context<session_type, mock_resource_manager>(reader_sessions.back(), receiver, resource_manager, limits));
+            result.push_back(readers.back().get());
+         }
+         return result;
+      };
+
+      std::unique_ptr<kv_context> kv_context_ptr = create_kv_rocksdb_context<session_type, mock_resource_manager>(sessions.back(), receiver, resource_manager, limits); 
+      benchmark_operation(args, std::move(kv_context_ptr), make_readers); // kv_context_ptr must be in the same scope as kv_db and usage_start, since they are references in create_kv_rocksdb_context
    } else {
       boost::filesystem::remove_all(chain::config::default_state_dir_name);  // Use a clean Chainbase
       chainbase::database chainbase_db(chain::config::default_state_dir_name, database::read_write, args.state_size_multiples * chain::config::default_state_size); // Default is 1024*1024*1024ll == 1073741824
       chainbase_db.add_index<kv_index >();
 
+      // nested like the block, transaction and action sessions of the controller
+      std::vector<chainbase::database::session> sessions;
+      for (auto i = 0U; i < args.session_depth; ++i) {
+         sessions.push_back(chainbase_db.start_undo_session(true));
+      }
+
+      // chainbase can be read from several threads as long as nothing writes
+      std::vector<std::unique_ptr<kv_context>> readers;
+      auto make_readers = [&]() {
+         std::vector<kv_context*> result;
+         for (auto i = 0U; i < args.num_threads; ++i) {
+            readers.push_back(create_kv_chainbase_context<mock_resource_manager>(chainbase_db, receiver, resource_manager, limits));
+            result.push_back(readers.back().get());
+         }
+         return result;
+      };
+
       std::unique_ptr<kv_context> kv_context_ptr = create_kv_chainbase_context<mock_resource_manager>(chainbase_db, receiver, resource_manager, limits);
-      benchmark_operation(args, std::move(kv_context_ptr));
+      benchmark_operation(args, std::move(kv_context_ptr), make_readers);
    }
 }
 } // namespace kv_benchmark
@@ -525,12 +755,18 @@ int main(int argc, char* argv[]) {
    cli.add_options()
      ("key-file,k", bpo::value<string>()->required(), "the file storing all the keys, mandatory")
      ("workset,w", bpo::value<string>(), "the file storing workset keys, which must be constructed from key-file and be random; the operation is repeatedly run against the workset; mandatory for get, get_data, and set")
-     ("operation,o", bpo::value<string>()->required(), "operation to be benchmarked: get, get_data, set, create, erase, it_create, it_next, it_key, or it_value, mandatory")
+     ("operation,o", bpo::value<string>()->required(), "operation to be benchmarked: get, get_data, set, create, erase, it_create, it_next, it_key, it_value, it_scan, secondary, or mix, mandatory")
      ("backing-store,b", bpo::value<string>()->required(), "the database where kay vlaues are stored, rocksdb or chainbase, mandatory")
      ("value-size,v", bpo::value<uint32_t>(), "value size for the keys")
      ("state-size-multiples,s", bpo::value<uint32_t>(), "multiples of 1GB for Chainbase state storage")
      ("num-runs,n", bpo::value<uint64_t>(), "minimum number of runs of the benchmarked operation")
-     ("help,h","microbenchmarks KV operations get, get_data, set, create (set to a new key), erase, it_create, it_next, it_key, and it_value against chainbase and rocksdb. Please note: numbers in it_key and it_value include those in it_next");
+     ("session-depth,d", bpo::value<uint32_t>(), "number of nested undo sessions the operations run in, 3 models the block, transaction and action sessions; default 1")
+     ("scan-length", bpo::value<uint32_t>(), "number of keys each it_scan reads from the lower bound of a workset key; default 100")
+     ("write-percent", bpo::value<uint32_t>(), "percentage of sets among the operations of mix; default 10")
+     ("threads,t", bpo::value<uint32_t>(), "number of threads reading concurrently, each through its own context, for get, it_scan and secondary; default 1")
+     ("block-cache-mb", bpo::value<uint64_t>(), "size of the RocksDB block cache in MiB, smaller than the key values to benchmark a working set larger than the cache; default is the RocksDB default")
+     ("output-format", bpo::value<string>(), "text or json, one line per run; default text")
+     ("help,h","microbenchmarks KV operations get, get_data, set, create (set to a new key), erase, it_create, it_next, it_key, it_value, it_scan (range reads), secondary (lookups through an index) and mix (gets and sets) against chainbase and rocksdb. Please note: numbers in it_key and it_value include those in it_next");
 
    try {
       bpo::store(bpo::parse_command_line(argc, argv, cli), vmap);
@@ -549,8 +785,8 @@ int main(int argc, char* argv[]) {
       }
       if (vmap.count("operation") > 0) {
          args.operation = vmap["operation"].as<std::string>();
-         if (args.operation != "get" && args.operation != "get_data" && args.operation != "set" && args.operation != "create" && args.operation != "erase" && args.operation != "it_create" && args.operation != "it_next" && args.operation != "it_key" && args.operation != "it_value") {
-            std::cerr << "\'--operation\' must be get, get_data, set, create, erase, it_create, it_next, it_key, or it_value" << std::endl;
+         if (args.operation != "get" && args.operation != "get_data" && args.operation != "set" && args.operation != "create" && args.operation != "erase" && args.operation != "it_create" && args.operation != "it_next" && args.operation != "it_key" && args.operation != "it_value" && args.operation != "it_scan" && args.operation != "secondary" && args.operation != "mix") {
+            std::cerr << "\'--operation\' must be get, get_data, set, create, erase, it_create, it_next, it_key, it_value, it_scan, secondary, or mix" << std::endl;
             return 1;
          }
       }
@@ -563,6 +799,40 @@ int main(int argc, char* argv[]) {
       if (vmap.count("num-runs") > 0) {
          args.num_runs = vmap["num-runs"].as<uint64_t>();
       }
+      if (vmap.count("session-depth") > 0) {
+         args.session_depth = vmap["session-depth"].as<uint32_t>();
+         if (args.session_depth == 0) {
+            std::cerr << "\'--session-depth\' must be at least 1" << std::endl;
+            return 1;
+         }
+      }
+      if (vmap.count("scan-length") > 0) {
+         args.scan_length = vmap["scan-length"].as<uint32_t>();
+      }
+      if (vmap.count("write-percent") > 0) {
+         args.write_percent = vmap["write-percent"].as<uint32_t>();
+         if (args.write_percent > 100) {
+            std::cerr << "\'--write-percent\' must be at most 100" << std::endl;
+            return 1;
+         }
+      }
+      if (vmap.count("threads") > 0) {
+         args.num_threads = vmap["threads"].as<uint32_t>();
+         if (args.num_threads == 0) {
+            std::cerr << "\'--threads\' must be at least 1" << std::endl;
+            return 1;
+         }
+      }
+      if (vmap.count("block-cache-mb") > 0) {
+         args.block_cache_mb = vmap["block-cache-mb"].as<uint64_t>();
+      }
+      if (vmap.count("output-format") > 0) {
+         args.output_format = vmap["output-format"].as<std::string>();
+         if (args.output_format != "text" && args.output_format != "json") {
+            std::cerr << "\'--output-format\' must be text or json" << std::endl;
+            return 1;
+         }
+      }
       if (vmap.count("backing-store") > 0) {
          args.backing_store = vmap["backing-store"].as<std::string>();
 
@@ -587,12 +857,18 @@ int main(int argc, char* argv[]) {
       return 1;
    }
 
-   if ((args.operation == "get" || args.operation == "get_data" || args.operation == "set") && args.workset_file.empty()) {
-      std::cerr << "\'--workset\' is required for get, get_data, and set" << std::endl;
+   if ((args.operation == "get" || args.operation == "get_data" || args.operation == "set" ||
+        args.operation == "it_scan" || args.operation == "secondary" || args.operation == "mix") && args.workset_file.empty()) {
+      std::cerr << "\'--workset\' is required for get, get_data, set, it_scan, secondary, and mix" << std::endl;
       cli.print(std::cerr);
       return 1;
    }
 
+   if (args.num_threads > 1 && args.operation != "get" && args.operation != "it_scan" && args.operation != "secondary") {
+      std::cerr << "\'--threads\' only applies to get, it_scan, and secondary" << std::endl;
+      return 1;
+   }
+
    kv_benchmark::benchmark(args);
 
    return 0;
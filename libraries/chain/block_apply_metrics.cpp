@@ -0,0 +1,37 @@
+#include <eosio/chain/block_apply_metrics.hpp>
+
+#include <algorithm>
+
+namespace eosio { namespace chain {
+
+   void block_apply_metrics::record( stage s, fc::microseconds d ) {
+      auto& h = histograms[static_cast<size_t>(s)];
+      const uint64_t us = std::max<int64_t>( d.count(), 0 );
+      const auto bucket = std::lower_bound( bounds_us.begin(), bounds_us.end(), us ) - bounds_us.begin();
+      h.counts[bucket].fetch_add( 1, std::memory_order_relaxed );
+      h.total_us.fetch_add( us, std::memory_order_relaxed );
+   }
+
+   std::vector<block_stage_latency> block_apply_metrics::snapshot() const {
+      // in stage order
+      static constexpr std::array<const char*, static_cast<size_t>(stage::num_stages)> stage_names = {
+         "header_validation", "fork_database", "start_block", "recover_keys", "transactions", "finalize_block",
+         "commit_block", "signals", "apply_block"
+      };
+      std::vector<block_stage_latency> result;
+      result.reserve( histograms.size() );
+      for( size_t i = 0; i < histograms.size(); ++i ) {
+         block_stage_latency l;
+         l.stage = stage_names[i];
+         l.bucket_bounds_us.assign( bounds_us.begin(), bounds_us.end() );
+         l.counts.reserve( histograms[i].counts.size() );
+         for( const auto& c : histograms[i].counts ) {
+            l.counts.push_back( c.load( std::memory_order_relaxed ) );
+         }
+         l.total_us = histograms[i].total_us.load( std::memory_order_relaxed );
+         result.push_back( std::move( l ) );
+      }
+      return result;
+   }
+
+} } // eosio::chain
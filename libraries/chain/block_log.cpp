@@ -7,8 +7,17 @@
 #include <eosio/chain/thread_utils.hpp>
 #include <fc/bitutil.hpp>
 #include <fc/io/raw.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <cstring>
 #include <future>
+#include <mutex>
 #include <regex>
+#include <thread>
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace eosio { namespace chain {
 
@@ -21,17 +30,20 @@ namespace eosio { namespace chain {
     *            from block 1
     * Version 4: changes the block entry from the serialization of signed_block to a tuple of offset to next entry,
     *            compression_status and pruned_block.
+    * Version 5: a compression_status of zlib means the block following its signed_block_header is stored as a
+    *            32 bit size followed by the zlib compression of the rest of the block serialization.
     */
 
    enum versions {
       initial_version = 1,
       block_x_start_version = 2,
       genesis_state_or_chain_id_version = 3,
-      pruned_transaction_version = 4
+      pruned_transaction_version = 4,
+      compressed_block_version = 5
    };
 
    const uint32_t block_log::min_supported_version = initial_version;
-   const uint32_t block_log::max_supported_version = pruned_transaction_version;
+   const uint32_t block_log::max_supported_version = compressed_block_version;
 
    struct block_log_preamble {
       uint32_t version         = 0;
@@ -116,6 +128,8 @@ namespace eosio { namespace chain {
          //    1. An uint32_t size for number of bytes from the start of this log entry to the start of the next log entry.
          //    2. An uint8_t indicating the compression status for the serialization of the pruned_block following this.
          //    3. The serialization of a signed_block representation of the block for the entry including padding.
+         // From version 5, a zlib compression status replaces 3. with the serialization of the signed_block_header,
+         // an uint32_t size and the zlib compressed serialization of the rest of the signed_block.
 
          struct metadata_type {
             packed_transaction::cf_compression_type compression = packed_transaction::cf_compression_type::none;
@@ -128,6 +142,20 @@ namespace eosio { namespace chain {
 
    namespace {
 
+      /// logs smaller than this are scanned by a single thread when rebuilding the index or repairing
+      uint64_t parallel_scan_min_bytes = 256 * 1024 * 1024;
+      constexpr size_t max_parallel_scan_ranges = 16;
+      /// the furthest a range boundary is searched for past its split point
+      constexpr uint64_t max_entry_boundary_scan = 64 * 1024 * 1024;
+      /// the number of blocks pruned in the background at a time
+      constexpr uint32_t prune_range_blocks = 1000;
+
+      size_t parallel_scan_ranges(uint64_t bytes) {
+         if (bytes < parallel_scan_min_bytes)
+            return 1;
+         return std::clamp<size_t>(std::thread::hardware_concurrency(), 1, max_parallel_scan_ranges);
+      }
+
       template <typename T>
       T read_buffer(const char* buf) {
          T result;
@@ -135,6 +163,60 @@ namespace eosio { namespace chain {
          return result;
       }
 
+      std::vector<char> zlib_compress(const char* data, size_t size) {
+         namespace bio = boost::iostreams;
+         std::vector<char>      out;
+         bio::filtering_ostream comp;
+         comp.push(bio::zlib_compressor(bio::zlib::best_compression));
+         comp.push(bio::back_inserter(out));
+         bio::write(comp, data, size);
+         bio::close(comp);
+         return out;
+      }
+
+      std::vector<char> zlib_decompress(const char* data, size_t size) {
+         namespace bio = boost::iostreams;
+         try {
+            std::vector<char>      out;
+            bio::filtering_ostream decomp;
+            decomp.push(bio::zlib_decompressor());
+            decomp.push(bio::back_inserter(out));
+            bio::write(decomp, data, size);
+            bio::close(decomp);
+            return out;
+         } catch (const bio::zlib_error& e) {
+            EOS_THROW(block_log_exception, "Unable to decompress block log entry: ${e}", ("e", e.what()));
+         }
+      }
+
+      /// serialization of block following the compression status of a compressed entry
+      std::vector<char> pack_compressed_block(const signed_block& block) {
+         const std::vector<char> packed      = fc::raw::pack(block);
+         const size_t            header_size = fc::raw::pack_size(static_cast<const signed_block_header&>(block));
+         const std::vector<char> compressed  = zlib_compress(packed.data() + header_size, packed.size() - header_size);
+
+         std::vector<char>     buffer(header_size + sizeof(uint32_t) + compressed.size());
+         fc::datastream<char*> stream(buffer.data(), buffer.size());
+         stream.write(packed.data(), header_size);
+         fc::raw::pack(stream, static_cast<uint32_t>(compressed.size()));
+         stream.write(compressed.data(), compressed.size());
+         return buffer;
+      }
+
+      template <typename Stream>
+      void unpack_compressed_block(Stream& ds, signed_block& block) {
+         fc::raw::unpack(ds, static_cast<signed_block_header&>(block));
+         uint32_t compressed_size;
+         fc::raw::unpack(ds, compressed_size);
+         std::vector<char> compressed(compressed_size);
+         ds.read(compressed.data(), compressed.size());
+         const std::vector<char>     rest = zlib_decompress(compressed.data(), compressed.size());
+         fc::datastream<const char*> rest_ds(rest.data(), rest.size());
+         fc::raw::unpack(rest_ds, block.prune_state);
+         fc::raw::unpack(rest_ds, block.transactions);
+         fc::raw::unpack(rest_ds, block.block_extensions);
+      }
+
       /// calculate the offset from the start of serialized block entry to block start
       constexpr int offset_to_block_start(uint32_t version) { 
          return version >= pruned_transaction_version ? sizeof(uint32_t) + 1 : 0;
@@ -150,9 +232,10 @@ namespace eosio { namespace chain {
          EOS_ASSERT(compression < static_cast<uint8_t>(packed_transaction::cf_compression_type::COMPRESSION_TYPE_COUNT), block_log_exception, 
                   "Unknown compression_type");
          meta.compression = static_cast<packed_transaction::cf_compression_type>(compression);
-         EOS_ASSERT(meta.compression == packed_transaction::cf_compression_type::none, block_log_exception,
-                  "Only support compression_type none");         
-         block.unpack(ds, meta.compression);
+         if (meta.compression == packed_transaction::cf_compression_type::zlib)
+            unpack_compressed_block(ds, block);
+         else
+            block.unpack(ds, meta.compression);
          const uint64_t current_stream_offset = ds.tellp() - start_pos;
          // For a block which contains CFD (context free data) and the CFD is pruned afterwards, the entry.size may
          // be the size before the CFD has been pruned while the actual serialized block does not have the CFD anymore.
@@ -170,10 +253,44 @@ namespace eosio { namespace chain {
          entry.meta = unpack(ds, entry.block);
       }
 
+      /// the block with all of its transactions pruned, as the background pruner leaves it
+      signed_block fully_pruned(const signed_block& block) {
+         signed_block result = block;
+         bool         pruned = false;
+         for (auto& receipt : result.transactions) {
+            if (auto* ptx = std::get_if<packed_transaction>(&receipt.trx)) {
+               if (!std::holds_alternative<packed_transaction::prunable_data_type::none>(ptx->get_prunable_data().prunable_data)) {
+                  ptx->prune_all();
+                  pruned = true;
+               }
+            }
+         }
+         if (pruned)
+            result.prune_state = signed_block::prune_state_type::incomplete;
+         return result;
+      }
+
+      std::vector<char> pack_compressed(const signed_block& block) {
+         static_assert( block_log::max_supported_version == compressed_block_version,
+                     "Code was written to support format of version 5, need to update this code for latest format." );
+         const std::vector<char> packed_block = pack_compressed_block(block);
+         // the compression of the pruned block can be larger than that of the block, the entry is padded so the
+         // block can be pruned in place
+         const size_t padded_size = std::max(packed_block.size(), pack_compressed_block(fully_pruned(block)).size());
+         std::vector<char>       buffer(padded_size + offset_to_block_start(block_log::max_supported_version));
+         fc::datastream<char*>   stream(buffer.data(), buffer.size());
+
+         const uint32_t size = buffer.size() + sizeof(uint64_t);
+         stream.write((char*)&size, sizeof(size));
+         fc::raw::pack(stream, static_cast<uint8_t>(packed_transaction::cf_compression_type::zlib));
+         stream.write(packed_block.data(), packed_block.size());
+         return buffer;
+      }
+
       std::vector<char> pack(const signed_block& block, packed_transaction::cf_compression_type compression) {
          const std::size_t padded_size = block.maximum_pruned_pack_size(compression);
-         static_assert( block_log::max_supported_version == pruned_transaction_version,
-                     "Code was written to support format of version 4, need to update this code for latest format." );
+         static_assert( block_log::max_supported_version == compressed_block_version,
+                     "Code was written to support format of version 5, need to update this code for latest format." );
          std::vector<char>     buffer(padded_size + offset_to_block_start(block_log::max_supported_version));
          fc::datastream<char*> stream(buffer.data(), buffer.size());
 
@@ -221,6 +338,9 @@ namespace eosio { namespace chain {
          memcpy(index.data() + current_offset, &pos, sizeof(pos));
       }
 
+      /// writes the position of the n-th block, independent of the positions written by write()
+      void write_at(uint32_t n, uint64_t pos) { memcpy(index.data() + n * sizeof(pos), &pos, sizeof(pos)); }
+
       void close() { index.close(); }
 
     private:
@@ -232,6 +352,61 @@ namespace eosio { namespace chain {
       std::exception_ptr inner;
    };
 
+   /// Read only memory map of a file that is only appended to while it is mapped. Address space is reserved past the
+   /// end of the file so that appended data is readable without remapping, and reads do not seek the file handle
+   /// used for writing.
+   class append_only_file_view {
+    public:
+      append_only_file_view() = default;
+      append_only_file_view(const append_only_file_view&) = delete;
+      append_only_file_view& operator=(const append_only_file_view&) = delete;
+      ~append_only_file_view() { close(); }
+
+      void open(const fc::path& path) {
+         close();
+         fd = ::open(path.generic_string().c_str(), O_RDONLY | O_CLOEXEC);
+         EOS_ASSERT(fd != -1, block_log_exception, "Unable to open ${path} for reading: ${e}",
+                    ("path", path.generic_string())("e", strerror(errno)));
+      }
+
+      void close() {
+         unmap();
+         if (fd != -1)
+            ::close(fd);
+         fd = -1;
+      }
+
+      /// @pre [pos, pos + size) has been written to the file and flushed
+      const char* data_at(uint64_t pos, uint64_t size) {
+         if (pos + size > mapped_size)
+            map(pos + size);
+         return addr + pos;
+      }
+
+    private:
+      void map(uint64_t size) {
+         unmap();
+         const uint64_t reserve = std::max(size * 2, min_reserve);
+         void* p = ::mmap(nullptr, reserve, PROT_READ, MAP_SHARED, fd, 0);
+         EOS_ASSERT(p != MAP_FAILED, block_log_exception, "Unable to map block log file: ${e}", ("e", strerror(errno)));
+         addr        = static_cast<const char*>(p);
+         mapped_size = reserve;
+      }
+
+      void unmap() {
+         if (addr)
+            ::munmap(const_cast<char*>(addr), mapped_size);
+         addr        = nullptr;
+         mapped_size = 0;
+      }
+
+      static constexpr uint64_t min_reserve = 1ull << 30;
+
+      int         fd          = -1;
+      const char* addr        = nullptr;
+      uint64_t    mapped_size = 0;
+   };
+
    template <typename Stream>
    std::unique_ptr<signed_block> read_block(Stream&& ds, uint32_t version, uint32_t expect_block_num = 0) {
       std::unique_ptr<signed_block> block;
@@ -259,8 +434,10 @@ namespace eosio { namespace chain {
          uint8_t  compression;
          fc::raw::unpack(ds, size);
          fc::raw::unpack(ds, compression);
-         EOS_ASSERT(compression == static_cast<uint8_t>(packed_transaction::cf_compression_type::none),
-                     block_log_exception, "Only \"none\" compression type is supported.");
+         // the header of a compressed block is not compressed
+         EOS_ASSERT(compression == static_cast<uint8_t>(packed_transaction::cf_compression_type::none) ||
+                    compression == static_cast<uint8_t>(packed_transaction::cf_compression_type::zlib),
+                     block_log_exception, "Unknown compression_type");
       }
       block_header bh;
       fc::raw::unpack(ds, bh);
@@ -314,12 +491,105 @@ namespace eosio { namespace chain {
 
          EOS_ASSERT(position <= size(), block_log_exception, "Invalid block position ${position}", ("position", position));
 
-         int blknum_offset = 14;
-         blknum_offset += offset_to_block_start(version());
-         uint32_t prev_block_num = read_buffer<uint32_t>(data() + position + blknum_offset);
+         uint32_t prev_block_num = read_buffer<uint32_t>(data() + position + block_num_offset());
          return fc::endian_reverse_u32(prev_block_num) + 1;
       }
 
+      uint64_t block_num_offset() const { return 14 + offset_to_block_start(version()); }
+
+      /**
+       *  Check whether the 8 bytes at marker look like the position stored at the end of a block entry, i.e. they
+       *  point back to an entry that ends at marker and the next entry, if any, holds the next block number.
+       **/
+      bool is_entry_end(uint64_t marker) const {
+         if (marker + sizeof(uint64_t) > size())
+            return false;
+         const uint64_t pos = read_buffer<uint64_t>(data() + marker);
+         if (pos < first_block_pos || pos + block_num_offset() + sizeof(uint32_t) > marker)
+            return false;
+         if (version() >= pruned_transaction_version &&
+             read_buffer<uint32_t>(data() + pos) != marker + sizeof(uint64_t) - pos)
+            return false;
+         const uint64_t next = marker + sizeof(uint64_t);
+         if (next == size())
+            return true;
+         if (next + block_num_offset() + sizeof(uint32_t) > size())
+            return false;
+         return block_num_at(next) == block_num_at(pos) + 1;
+      }
+
+      /**
+       *  Split the block entries into about equally sized ranges by searching forward from evenly spaced offsets
+       *  for the end of an entry. A boundary that only looks like the end of an entry is caught by the users of the
+       *  ranges, which fall back to a sequential scan.
+       *
+       *  @returns the start positions of the ranges followed by the end of the file
+       **/
+      std::vector<uint64_t> find_entry_boundaries(size_t ranges) const {
+         std::vector<uint64_t> boundaries{first_block_pos};
+         const uint64_t        range_size = (size() - first_block_pos) / ranges;
+         for (size_t i = 1; i < ranges; ++i) {
+            uint64_t       marker = std::max(first_block_pos + i * range_size, boundaries.back());
+            const uint64_t limit  = std::min(marker + max_entry_boundary_scan, size());
+            while (marker < limit && !is_entry_end(marker))
+               ++marker;
+            if (marker < limit && marker + sizeof(uint64_t) < size())
+               boundaries.push_back(marker + sizeof(uint64_t));
+         }
+         boundaries.push_back(size());
+         return boundaries;
+      }
+
+      /**
+       *  Write the index entries of the blocks in [begin, end) by following the block positions backward from end.
+       *
+       *  @returns the number of blocks in the range, or nothing if the positions do not lead back to begin through
+       *  consecutive block numbers
+       **/
+      std::optional<uint32_t> construct_index_range(index_writer& index, uint64_t begin, uint64_t end) const {
+         const uint32_t num_blocks = this->num_blocks();
+         uint32_t       count      = 0;
+         uint32_t       next_n     = 0;
+         uint64_t       marker     = end - sizeof(uint64_t);
+         while (true) {
+            const uint64_t pos = read_buffer<uint64_t>(data() + marker);
+            if (pos < begin || pos + block_num_offset() + sizeof(uint32_t) > marker)
+               return {};
+            const uint32_t block_num = block_num_at(pos);
+            if (block_num < first_block_num() || block_num - first_block_num() >= num_blocks)
+               return {};
+            const uint32_t n = block_num - first_block_num();
+            if (count > 0 && n + 1 != next_n)
+               return {};
+            index.write_at(n, pos);
+            ++count;
+            if (pos == begin)
+               return count;
+            next_n = n;
+            marker = pos - sizeof(uint64_t);
+         }
+      }
+
+      /// @returns true if the index was written by scanning the ranges between boundaries concurrently
+      bool construct_index_parallel(index_writer& index, const std::vector<uint64_t>& boundaries) const {
+         std::vector<std::future<std::optional<uint32_t>>> scans;
+         for (size_t i = 0; i + 1 < boundaries.size(); ++i) {
+            scans.emplace_back(std::async(std::launch::async, [this, &index, begin = boundaries[i], end = boundaries[i + 1]]() {
+               return construct_index_range(index, begin, end);
+            }));
+         }
+         bool     consistent   = true;
+         uint64_t blocks_found = 0;
+         for (auto& scan : scans) {
+            const auto count = scan.get();
+            if (count)
+               blocks_found += *count;
+            else
+               consistent = false;
+         }
+         return consistent && blocks_found == num_blocks();
+      }
+
       std::pair<fc::datastream<const char*>,uint32_t> ro_stream_at(uint64_t pos) {
          return std::make_pair(fc::datastream<const char*>(file.const_data() + pos, file.size() - pos), version());
       }
@@ -387,6 +657,76 @@ namespace eosio { namespace chain {
          return std::make_tuple(block_num, id);
       }
 
+      /**
+       *  Fully validate the blocks in the ranges between boundaries concurrently, continuing from the block
+       *  previous_block_num with id previous_block_id.
+       *
+       *  @returns the position after the leading ranges whose blocks all validated and link to each other, along
+       *  with the number and id of the last block in those ranges
+       **/
+      std::tuple<uint64_t, uint32_t, block_id_type>
+      full_validate_ranges(const std::vector<uint64_t>& boundaries, uint32_t truncate_at_block,
+                           uint32_t previous_block_num, const block_id_type& previous_block_id) const {
+         struct range_result {
+            bool          complete = false;
+            uint32_t      first_block_num = 0;
+            block_id_type first_previous_id;
+            uint32_t      last_block_num = 0;
+            block_id_type last_block_id;
+         };
+
+         std::vector<std::future<range_result>> scans;
+         for (size_t i = 0; i + 1 < boundaries.size(); ++i) {
+            scans.emplace_back(std::async(std::launch::async, [this, truncate_at_block, begin = boundaries[i], end = boundaries[i + 1]]() {
+               range_result result;
+               try {
+                  // positions stored in the entries are relative to the start of the file
+                  fc::datastream<const char*> ds(data(), end);
+                  ds.skip(begin);
+
+                  log_entry entry;
+                  if (version() < pruned_transaction_version) {
+                     entry.emplace<signed_block_v0>();
+                  }
+
+                  uint32_t      block_num = block_num_at(begin) - 1;
+                  block_id_type block_id;
+                  while (ds.remaining() > 0 && block_num < truncate_at_block) {
+                     std::tie(block_num, block_id) = full_validate_block_entry(ds, block_num, block_id, entry);
+                     if (result.first_block_num == 0) {
+                        result.first_block_num   = block_num;
+                        result.first_previous_id = get_block_header(entry).previous;
+                     }
+                     if (block_num % 1000 == 0)
+                        ilog("Verified block ${num}", ("num", block_num));
+                  }
+                  result.complete       = ds.remaining() == 0 && block_num < truncate_at_block;
+                  result.last_block_num = block_num;
+                  result.last_block_id  = block_id;
+               } catch (...) {
+                  // the range is validated again sequentially, which reports the error
+               }
+               return result;
+            }));
+         }
+
+         uint64_t      pos       = first_block_pos;
+         uint32_t      block_num = previous_block_num;
+         block_id_type block_id  = previous_block_id;
+         bool          accepting = true;
+         for (size_t i = 0; i < scans.size(); ++i) {
+            const auto result = scans[i].get();
+            accepting = accepting && result.complete && result.first_block_num == block_num + 1 &&
+                        (block_id == block_id_type() || block_id == result.first_previous_id);
+            if (accepting) {
+               pos       = boundaries[i + 1];
+               block_num = result.last_block_num;
+               block_id  = result.last_block_id;
+            }
+         }
+         return std::make_tuple(pos, block_num, block_id);
+      }
+
       void construct_index(const fc::path& index_file_name);
    };
 
@@ -474,6 +814,14 @@ namespace eosio { namespace chain {
            ("first", this->first_block_num())("last", (this->last_block_num())));
 
       index_writer index(index_file_path, num_blocks);
+
+      const auto boundaries = find_entry_boundaries(parallel_scan_ranges(this->size() - first_block_pos));
+      if (boundaries.size() > 2) {
+         if (construct_index_parallel(index, boundaries))
+            return;
+         wlog("Block log entries could not be split into ranges, writing ${file} sequentially", ("file", index_file_name));
+      }
+
       uint32_t     blocks_found = 0;
 
       for (auto iter = make_reverse_block_position_iterator(*this);
@@ -505,6 +853,71 @@ namespace eosio { namespace chain {
    };
    using block_log_catalog = eosio::chain::log_catalog<block_log_data, block_log_index, block_log_verifier>;
 
+   /// Write the blocks from first_block_num to last_block_num of a block log to a new block log and index, the
+   /// block positions at the end of the entries are adjusted to the new file.
+   void write_block_range(const block_log_data& log_data, const block_log_index& log_index, uint32_t first_block_num,
+                          uint32_t last_block_num, const fc::path& block_file_name, const fc::path& index_file_name) {
+      static_assert( block_log::max_supported_version == compressed_block_version,
+                     "Code was written to support format of version 5 or lower, need to update this code for latest format." );
+
+      block_log_preamble preamble = log_data.get_preamble();
+      if (first_block_num != preamble.first_block_num) {
+         // version 4 or above have different log entry format; therefore version 1 to 3 can only be upgrade up to version 3 format.
+         preamble.version         = log_data.version() < pruned_transaction_version ? genesis_state_or_chain_id_version : log_data.version();
+         preamble.first_block_num = first_block_num;
+         preamble.chain_context   = log_data.chain_id();
+      }
+      fc::datastream<size_t> preamble_sizer;
+      preamble.write_to(preamble_sizer);
+      const uint64_t preamble_size = preamble_sizer.tellp();
+
+      const uint32_t first_index   = first_block_num - log_data.first_block_num();
+      const uint64_t first_pos     = log_index.nth_block_position(first_index);
+      const uint64_t end_pos       = last_block_num == log_data.last_block_num()
+                                         ? log_data.size()
+                                         : log_index.nth_block_position(last_block_num + 1 - log_data.first_block_num());
+      const uint64_t new_file_size = preamble_size + end_pos - first_pos;
+
+      boost::iostreams::mapped_file_sink new_block_file;
+      create_mapped_file(new_block_file, block_file_name.generic_string(), new_file_size);
+      fc::datastream<char*> ds(new_block_file.data(), new_block_file.size());
+      preamble.write_to(ds);
+
+      memcpy(new_block_file.data() + preamble_size, log_data.data() + first_pos, end_pos - first_pos);
+
+      const uint32_t num_blocks = last_block_num - first_block_num + 1;
+      index_writer   index(index_file_name, num_blocks);
+
+      // take the entries from the old index and move the block position at the end of each entry to the new file,
+      // the entries are split into ranges of blocks updated concurrently
+      const size_t num_ranges = std::min<size_t>(parallel_scan_ranges(end_pos - first_pos), num_blocks);
+      std::vector<std::future<void>> moves;
+      for (size_t r = 0; r < num_ranges; ++r) {
+         const uint32_t begin = num_blocks * r / num_ranges;
+         const uint32_t end   = num_blocks * (r + 1) / num_ranges;
+         moves.emplace_back(std::async(std::launch::async, [&, begin, end]() {
+            for (uint32_t i = begin; i < end; ++i) {
+               const uint64_t old_pos = log_index.nth_block_position(first_index + i);
+               const uint64_t old_end = i + 1 < num_blocks ? log_index.nth_block_position(first_index + i + 1) : end_pos;
+               EOS_ASSERT(old_pos + sizeof(uint64_t) <= old_end && old_end <= end_pos &&
+                              read_buffer<uint64_t>(log_data.data() + old_end - sizeof(uint64_t)) == old_pos,
+                          block_log_exception, "the block position for block ${num} at the end of a block entry is incorrect",
+                          ("num", first_block_num + i));
+               const uint64_t new_pos = old_pos - first_pos + preamble_size;
+               memcpy(new_block_file.data() + new_pos + (old_end - old_pos) - sizeof(new_pos), &new_pos, sizeof(new_pos));
+               index.write_at(i, new_pos);
+            }
+         }));
+      }
+      for (auto& m : moves)
+         m.wait();
+      for (auto& m : moves)
+         m.get();
+
+      index.close();
+      new_block_file.close();
+   }
+
    
    namespace detail {
 
@@ -521,13 +934,48 @@ namespace eosio { namespace chain {
          block_log_catalog         catalog;
          fc::datastream<fc::cfile> block_file;
          fc::datastream<fc::cfile> index_file;
+         append_only_file_view     block_view;
+         append_only_file_view     index_view;
+         uint64_t                  block_file_size = 0;
          bool                      genesis_written_to_block_log = false;
          block_log_preamble        preamble;
          uint32_t                  future_version;
          const size_t              stride;
+         const bool                compress_blocks;
+         bool                      background_split;
+         std::mutex                mtx; ///< guards the files, views and catalog so blocks can be read on another thread
          static uint32_t           default_version;
 
+         /// version of the block log files created, version 5 is only needed for compressed entries
+         uint32_t new_file_version() const {
+            return std::min(default_version, compress_blocks ? uint32_t(compressed_block_version) : uint32_t(pruned_transaction_version));
+         }
+
+         /// the retained block file being split into one file per stride and the files it is split into
+         struct split_result {
+            uint32_t                                              first_block_num = 0;
+            uint32_t                                              last_block_num  = 0;
+            fc::path                                              filename_base;
+            std::vector<std::tuple<uint32_t, uint32_t, fc::path>> pieces; ///< first and last block num and name of each file
+         };
+         std::future<split_result> pending_split;
+
+         uint32_t                  prune_older_than;
+         uint32_t                  pruned_block_num = 0; ///< the blocks up to this number are pruned in the background
+
+         /// the log entries of a range of blocks pruned in the background, they are written by the appending thread
+         struct prune_result {
+            uint32_t                                            last_block_num = 0;
+            fc::path                                            block_file; ///< the file holding the entries
+            std::vector<std::pair<uint64_t, std::vector<char>>> entries;    ///< position and pruned contents of each entry
+         };
+         std::future<prune_result> pending_prune;
+
          explicit block_log_impl(const block_log::config_type& config);
+         ~block_log_impl() {
+            finish_background_split(true);
+            finish_background_prune(true);
+         }
 
          static void ensure_file_exists(fc::cfile& f) {
             if (fc::exists(f.get_file_path()))
@@ -538,6 +986,17 @@ namespace eosio { namespace chain {
 
          uint64_t get_block_pos(uint32_t block_num);
 
+         // reads of the active files go through the views, reopen them whenever the files are recreated
+         void open_views() {
+            block_view.open(block_file.get_file_path());
+            index_view.open(index_file.get_file_path());
+            block_file_size = fc::file_size(block_file.get_file_path());
+         }
+
+         fc::datastream<const char*> block_stream_at(uint64_t pos) {
+            return fc::datastream<const char*>(block_view.data_at(pos, block_file_size - pos), block_file_size - pos);
+         }
+
          void reset(uint32_t first_block_num, std::variant<genesis_state, chain_id_type>&& chain_context);
 
          void flush();
@@ -553,6 +1012,34 @@ namespace eosio { namespace chain {
          uint64_t write_log_entry(const std::vector<char>& block_buffer);
 
          void split_log();
+
+         // retained files spanning several strides come from logs written with a larger stride, e.g. a blocks.log
+         // that was never split; they are split without blocking appends and replace the file in the catalog
+         void start_background_split();
+         void finish_background_split(bool wait);
+         void poll_background_split() {
+            finish_background_split(false);
+            start_background_split();
+         }
+
+         // the transactions of blocks at least prune_older_than blocks behind the head are pruned one range of blocks at a
+         // time; the pruned entries are computed from a separate mapping of the file and written between appends, so
+         // readers never see a partially written entry. At most one of a split or a prune is pending.
+         void start_background_prune();
+         void finish_background_prune(bool wait);
+         void poll_background_prune() {
+            finish_background_prune(false);
+            start_background_split();
+            start_background_prune();
+         }
+
+         static void remove_split_pieces(const split_result& split) {
+            for (const auto& [first, last, path] : split.pieces) {
+               fc::remove(path.string() + ".log.split");
+               fc::remove(path.string() + ".index.split");
+            }
+         }
+
          bool recover_from_incomplete_block_head(block_log_data& log_data, block_log_index& index);
 
          block_id_type                 read_block_id_by_num(uint32_t block_num);
@@ -569,15 +1056,20 @@ namespace eosio { namespace chain {
 
 
    void block_log::set_version(uint32_t ver) { detail::block_log_impl::default_version = ver; }
+   void block_log::set_parallel_scan_threshold(uint64_t bytes) { parallel_scan_min_bytes = bytes; }
    uint32_t block_log::version() const { return my->preamble.version; }
 
    detail::block_log_impl::block_log_impl(const block_log::config_type& config)
    : stride( config.stride )
+   , compress_blocks( config.compress_blocks )
+   , background_split( config.background_split )
+   , prune_older_than( config.prune_blocks_older_than )
    {
 
       if (!fc::is_directory(config.log_dir))
          fc::create_directories(config.log_dir);
       
+      catalog.remote_archive = config.remote_archive;
       catalog.open(config.log_dir, config.retained_dir, config.archive_dir, "blocks");
       
       catalog.max_retained_files = config.max_retained_files;
@@ -656,14 +1148,22 @@ namespace eosio { namespace chain {
 
       block_file.open(fc::cfile::update_rw_mode);
       index_file.open(fc::cfile::update_rw_mode);
+      open_views();
       if (log_size)
          read_head();
+      start_background_split();
+      start_background_prune();
    }
 
-   std::vector<char> create_block_buffer( const signed_block& b, uint32_t version, packed_transaction::cf_compression_type segment_compression ) {
+   std::vector<char> create_block_buffer( const signed_block& b, uint32_t version, packed_transaction::cf_compression_type segment_compression,
+                                          bool compress ) {
       std::vector<char> buffer;
 
-      if (version >= pruned_transaction_version)  {
+      if (version >= compressed_block_version && compress) {
+         EOS_ASSERT(segment_compression == packed_transaction::cf_compression_type::none, block_log_append_fail,
+                    "the compression must be \"none\" for compressed blocks");
+         buffer = pack_compressed(b);
+      } else if (version >= pruned_transaction_version)  {
          buffer = pack(b, segment_compression);
       } else {
          auto block_ptr = b.to_signed_block_v0();
@@ -683,10 +1183,12 @@ namespace eosio { namespace chain {
       block_file.write((char*)&pos, sizeof(pos));
       index_file.write((char*)&pos, sizeof(pos));
       flush();
+      block_file_size = pos + block_buffer.size() + sizeof(pos);
       return pos;
    }
 
    uint64_t block_log::append(const signed_block_ptr& b, packed_transaction::cf_compression_type segment_compression) {
+      std::lock_guard<std::mutex> g(my->mtx);
       return my->append(b, segment_compression);
    }
 
@@ -702,11 +1204,15 @@ namespace eosio { namespace chain {
                    ("position", (uint64_t) index_file.tellp())
                    ("expected", (b->block_num() - preamble.first_block_num) * sizeof(uint64_t)));
 
-         std::vector<char> buffer = create_block_buffer( *b, preamble.version, segment_compression );
+         std::vector<char> buffer = create_block_buffer( *b, preamble.version, segment_compression, compress_blocks );
          auto pos = write_log_entry(buffer);
          head     = b;
          if (b->block_num() % stride == 0) {
             split_log();
+         } else if (pending_split.valid()) {
+            poll_background_split();
+         } else {
+            poll_background_prune();
          }
          return pos;
       }
@@ -730,6 +1236,10 @@ namespace eosio { namespace chain {
          head     = b;
          if (b->block_num() % stride == 0) {
             split_log();
+         } else if (pending_split.valid()) {
+            poll_background_split();
+         } else {
+            poll_background_prune();
          }
          return pos;
       }
@@ -743,19 +1253,22 @@ namespace eosio { namespace chain {
 
    std::future<std::tuple<signed_block_ptr, std::vector<char>>>
    detail::block_log_impl::create_append_future(boost::asio::io_context& thread_pool, const signed_block_ptr& b, packed_transaction::cf_compression_type segment_compression) {
-      future_version = (b->block_num() % stride == 0) ? block_log::max_supported_version : future_version;
+      future_version = (b->block_num() % stride == 0) ? new_file_version() : future_version;
       std::promise<std::tuple<signed_block_ptr, std::vector<char>>> p;
       std::future<std::tuple<signed_block_ptr, std::vector<char>>> f = p.get_future();
-      return async_thread_pool( thread_pool, [b, version=future_version, segment_compression]() {
-         return std::make_tuple(b, create_block_buffer(*b, version, segment_compression));
+      return async_thread_pool( thread_pool, [b, version=future_version, segment_compression, compress=compress_blocks]() {
+         return std::make_tuple(b, create_block_buffer(*b, version, segment_compression, compress));
       } );
    }
 
    uint64_t block_log::append(std::future<std::tuple<signed_block_ptr, std::vector<char>>> f) {
+      std::lock_guard<std::mutex> g(my->mtx);
       return my->append( std::move( f ) );
    }
 
    void detail::block_log_impl::split_log() {
+      // the entries pruned in the background may be in the file that is moved
+      finish_background_prune(true);
       block_file.close();
       index_file.close();
       
@@ -763,11 +1276,95 @@ namespace eosio { namespace chain {
       
       block_file.open(fc::cfile::truncate_rw_mode);
       index_file.open(fc::cfile::truncate_rw_mode);
-      preamble.version         = block_log::max_supported_version;
+      preamble.version         = new_file_version();
       preamble.chain_context   = preamble.chain_id();
       preamble.first_block_num = this->head->block_num() + 1;
       preamble.write_to(block_file);
       flush();
+      open_views();
+      poll_background_split();
+      start_background_prune();
+   }
+
+   void detail::block_log_impl::start_background_split() {
+      if (!background_split || pending_split.valid() || pending_prune.valid())
+         return;
+
+      const auto oversized = std::find_if(catalog.collection.begin(), catalog.collection.end(), [this](const auto& item) {
+         return (item.first - 1) / stride != (item.second.last_block_num - 1) / stride;
+      });
+      if (oversized == catalog.collection.end())
+         return;
+
+      ilog("Splitting ${name}.log into one block file per ${stride} blocks in the background",
+           ("name", oversized->second.filename_base.string())("stride", stride));
+
+      split_result split{oversized->first, oversized->second.last_block_num, oversized->second.filename_base, {}};
+      pending_split = std::async(std::launch::async, [split = std::move(split), stride = stride,
+                                                     dir = catalog.retained_dir]() mutable {
+         auto name = split.filename_base;
+         block_log_data  log_data(name.replace_extension("log"));
+         block_log_index log_index(name.replace_extension("index"));
+
+         // pieces are written under names the catalog does not pick up until all of them are complete
+         try {
+            for (uint64_t first = split.first_block_num; first <= split.last_block_num;) {
+               const uint32_t last = std::min<uint64_t>(((first - 1) / stride + 1) * stride, split.last_block_num);
+               const int      bufsize = 64;
+               char           buf[bufsize];
+               snprintf(buf, bufsize, "blocks-%u-%u", static_cast<uint32_t>(first), last);
+               const fc::path path = dir / buf;
+               split.pieces.emplace_back(first, last, path);
+               write_block_range(log_data, log_index, first, last, path.string() + ".log.split", path.string() + ".index.split");
+               first = uint64_t(last) + 1;
+            }
+         } catch (...) {
+            remove_split_pieces(split);
+            throw;
+         }
+         return split;
+      });
+   }
+
+   void detail::block_log_impl::finish_background_split(bool wait) {
+      if (!pending_split.valid())
+         return;
+      if (!wait && pending_split.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+         return;
+
+      try {
+         auto split = pending_split.get();
+         auto it    = catalog.collection.find(split.first_block_num);
+         if (it == catalog.collection.end() || it->second.last_block_num != split.last_block_num) {
+            ilog("${name}.log left the catalog while it was being split, discarding the split files",
+                 ("name", split.filename_base.string()));
+            remove_split_pieces(split);
+            return;
+         }
+
+         auto name = split.filename_base;
+         fc::remove(name.replace_extension("log"));
+         fc::remove(name.replace_extension("index"));
+         catalog.collection.erase(it);
+         for (const auto& [first, last, path] : split.pieces) {
+            auto piece = path;
+            fc::rename(path.string() + ".log.split", piece.replace_extension("log"));
+            fc::rename(path.string() + ".index.split", piece.replace_extension("index"));
+            catalog.collection.emplace(first, block_log_catalog::mapped_type{last, path});
+         }
+         // the positions in the collection moved
+         catalog.active_index = block_log_catalog::npos;
+
+         ilog("Split ${name}.log into ${n} block files", ("name", split.filename_base.string())("n", split.pieces.size()));
+      } catch (const fc::exception& e) {
+         background_split = false;
+         wlog("Failed to split block file in the background, no further files will be split: ${details}",
+              ("details", e.to_detail_string()));
+      } catch (const std::exception& e) {
+         background_split = false;
+         wlog("Failed to split block file in the background, no further files will be split: ${details}",
+              ("details", e.what()));
+      }
    }
 
    void detail::block_log_impl::flush() {
@@ -776,23 +1373,28 @@ namespace eosio { namespace chain {
    }
 
    void detail::block_log_impl::reset(uint32_t first_bnum, std::variant<genesis_state, chain_id_type>&& chain_context) {
+      finish_background_prune(true);
 
       block_file.open(fc::cfile::truncate_rw_mode);
       index_file.open(fc::cfile::truncate_rw_mode);
 
-      future_version           = block_log_impl::default_version;
-      preamble.version         = block_log_impl::default_version; 
+      future_version           = new_file_version();
+      preamble.version         = new_file_version();
       preamble.first_block_num = first_bnum;
       preamble.chain_context   = std::move(chain_context);
       preamble.write_to(block_file);
 
       flush();
+      open_views();
       genesis_written_to_block_log = true;
       static_assert( block_log::max_supported_version > 0, "a version number of zero is not supported" );
    }
 
    void block_log::reset( const genesis_state& gs, const signed_block_ptr& first_block, packed_transaction::cf_compression_type segment_compression ) {
-      my->reset(1, gs);
+      {
+         std::lock_guard<std::mutex> g(my->mtx);
+         my->reset(1, gs);
+      }
       append(first_block, segment_compression);
    }
 
@@ -803,6 +1405,7 @@ namespace eosio { namespace chain {
       EOS_ASSERT(my->catalog.verifier.chain_id.empty() || chain_id == my->catalog.verifier.chain_id, block_log_exception,
                  "Trying to reset to the chain to a different chain id");
 
+      std::lock_guard<std::mutex> g(my->mtx);
       my->reset(first_block_num, chain_id);
       my->head.reset();
    }
@@ -810,8 +1413,7 @@ namespace eosio { namespace chain {
    std::unique_ptr<signed_block> detail::block_log_impl::read_block_by_num(uint32_t block_num) {
       uint64_t pos = get_block_pos(block_num);
       if (pos != block_log::npos) {
-         block_file.seek(pos);
-         return read_block(block_file, preamble.version, block_num);
+         return read_block(block_stream_at(pos), preamble.version, block_num);
       } else {
          auto [ds, version] = catalog.ro_stream_for_block(block_num);
          if (ds.remaining())
@@ -823,8 +1425,7 @@ namespace eosio { namespace chain {
    block_id_type detail::block_log_impl::read_block_id_by_num(uint32_t block_num) {
       uint64_t pos = get_block_pos(block_num);
       if (pos != block_log::npos) {
-         block_file.seek(pos);
-         return read_block_id(block_file, preamble.version, block_num);
+         return read_block_id(block_stream_at(pos), preamble.version, block_num);
       } else {
          auto [ds, version] = catalog.ro_stream_for_block(block_num);
          if (ds.remaining())
@@ -834,20 +1435,19 @@ namespace eosio { namespace chain {
    }
 
    std::unique_ptr<signed_block> block_log::read_signed_block_by_num(uint32_t block_num) const {
+      std::lock_guard<std::mutex> g(my->mtx);
       return my->read_block_by_num(block_num);
    }
 
    block_id_type block_log::read_block_id_by_num(uint32_t block_num) const {
+      std::lock_guard<std::mutex> g(my->mtx);
       return my->read_block_id_by_num(block_num);
    }
 
    uint64_t detail::block_log_impl::get_block_pos(uint32_t block_num) {
       if (!(head && block_num <= head->block_num() && block_num >= preamble.first_block_num))
          return block_log::npos;
-      index_file.seek(sizeof(uint64_t) * (block_num - preamble.first_block_num));
-      uint64_t pos;
-      index_file.read((char*)&pos, sizeof(pos));
-      return pos;
+      return read_buffer<uint64_t>(index_view.data_at(sizeof(uint64_t) * (block_num - preamble.first_block_num), sizeof(uint64_t)));
    }
 
    void detail::block_log_impl::read_head() {
@@ -974,6 +1574,17 @@ namespace eosio { namespace chain {
          entry.emplace<signed_block_v0>();
       }
 
+      const auto boundaries = log_data.find_entry_boundaries(parallel_scan_ranges(log_data.size() - pos));
+      if (boundaries.size() > 2) {
+         // the sequential scan below continues after the ranges that validated concurrently, so that damaged
+         // entries are handled and reported exactly as without the concurrent scan
+         uint64_t validated_pos = 0;
+         std::tie(validated_pos, block_num, block_id) =
+             log_data.full_validate_ranges(boundaries, truncate_at_block, block_num, block_id);
+         ds.skip(validated_pos - pos);
+         pos = validated_pos;
+      }
+
       try {
          try {
             while (ds.remaining() > 0 && block_num < truncate_at_block) {
@@ -1023,7 +1634,9 @@ namespace eosio { namespace chain {
       return block_log_data(data_dir / "blocks.log").chain_id();
    }
 
-   size_t prune_trxs(fc::datastream<char*> strm, uint32_t block_num, std::vector<transaction_id_type>& ids, uint32_t version) {
+   /// prune the transactions of the log entry in strm for which should_prune returns true and rewrite the entry in place
+   template <typename ShouldPrune>
+   size_t prune_entry(fc::datastream<char*> strm, uint32_t block_num, uint32_t version, ShouldPrune&& should_prune) {
 
       EOS_ASSERT(version >= pruned_transaction_version, block_log_exception,
                     "The block log version ${version} does not support transaction pruning.", ("version", version));
@@ -1036,12 +1649,9 @@ namespace eosio { namespace chain {
                      "Wrong block was read from block log.");
 
       auto pruner = overloaded{[](transaction_id_type&) { return false; },
-                               [&ids](packed_transaction& ptx) {
-                                  auto it = std::find(ids.begin(), ids.end(), ptx.id());
-                                  if (it != ids.end()) {
+                               [&should_prune](packed_transaction& ptx) {
+                                  if (should_prune(ptx)) {
                                      ptx.prune_all();
-                                     // remove the found entry from ids
-                                     ids.erase(it);
                                      return true;
                                   }
                                   return false;
@@ -1055,11 +1665,125 @@ namespace eosio { namespace chain {
          entry.block.prune_state = signed_block::prune_state_type::incomplete;
       }
       strm.skip(offset_to_block_start(version));
-      entry.block.pack(strm, entry.meta.compression);
+      if (entry.meta.compression == packed_transaction::cf_compression_type::zlib) {
+         // the pruned block is recompressed in place, the entry keeps its size and the remaining bytes are skipped;
+         // entries are padded for their fully pruned block, only pruning some of their transactions may not fit
+         const std::vector<char> packed_block = pack_compressed_block(entry.block);
+         EOS_ASSERT(packed_block.size() <= entry.meta.size - offset_to_block_start(version) - sizeof(uint64_t), block_log_exception,
+                    "Pruned block ${block_num} does not fit in its compressed block log entry", ("block_num", block_num));
+         strm.write(packed_block.data(), packed_block.size());
+      } else {
+         entry.block.pack(strm, entry.meta.compression);
+      }
       return num_trx_pruned;
    }
 
+   size_t prune_trxs(fc::datastream<char*> strm, uint32_t block_num, std::vector<transaction_id_type>& ids, uint32_t version) {
+      return prune_entry(strm, block_num, version, [&ids](const packed_transaction& ptx) {
+         auto it = std::find(ids.begin(), ids.end(), ptx.id());
+         if (it == ids.end())
+            return false;
+         // remove the found entry from ids
+         ids.erase(it);
+         return true;
+      });
+   }
+
+   bool is_pruned(const packed_transaction& ptx) {
+      return std::holds_alternative<packed_transaction::prunable_data_type::none>(ptx.get_prunable_data().prunable_data);
+   }
+
+   void detail::block_log_impl::start_background_prune() {
+      if (prune_older_than == 0 || pending_prune.valid() || pending_split.valid() || !head ||
+          head->block_num() <= prune_older_than)
+         return;
+
+      const uint32_t prune_up_to = head->block_num() - prune_older_than;
+      const uint32_t first_block_num = catalog.collection.empty() ? preamble.first_block_num : catalog.collection.begin()->first;
+      const uint32_t first = std::max(pruned_block_num + 1, first_block_num);
+      if (first > prune_up_to)
+         return;
+
+      uint32_t last = std::min<uint64_t>(prune_up_to, uint64_t(first) + prune_range_blocks - 1);
+      fc::path filename_base;
+      if (first >= preamble.first_block_num) {
+         filename_base = block_file.get_file_path();
+         filename_base.replace_extension();
+      } else {
+         auto it = --catalog.collection.upper_bound(first);
+         if (it->second.last_block_num < first) {
+            // the blocks in between are not in the catalog
+            const auto next = std::next(it);
+            pruned_block_num = (next == catalog.collection.end() ? preamble.first_block_num : next->first) - 1;
+            return;
+         }
+         last          = std::min(last, it->second.last_block_num);
+         filename_base = it->second.filename_base;
+      }
+
+      pending_prune = std::async(std::launch::async, [first, last, filename_base]() {
+         auto            name = filename_base;
+         prune_result    result{last, name.replace_extension("log"), {}};
+         block_log_data  log_data(result.block_file);
+         if (log_data.version() < pruned_transaction_version)
+            return result;
+         block_log_index log_index(name.replace_extension("index"));
+
+         for (uint32_t block_num = first; block_num <= last; ++block_num) {
+            const uint64_t pos  = log_index.nth_block_position(block_num - log_data.first_block_num());
+            const uint32_t size = read_buffer<uint32_t>(log_data.data() + pos);
+            // the position at the end of the entry is left as is
+            std::vector<char> entry(log_data.data() + pos, log_data.data() + pos + size - sizeof(uint64_t));
+            const auto num_pruned = prune_entry(fc::datastream<char*>(entry.data(), entry.size()), block_num,
+                                                log_data.version(), [](const packed_transaction& ptx) { return !is_pruned(ptx); });
+            if (num_pruned > 0)
+               result.entries.emplace_back(pos, std::move(entry));
+         }
+         return result;
+      });
+   }
+
+   void detail::block_log_impl::finish_background_prune(bool wait) {
+      if (!pending_prune.valid())
+         return;
+      if (!wait && pending_prune.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+         return;
+
+      try {
+         auto result = pending_prune.get();
+         if (result.entries.size()) {
+            if (result.block_file == block_file.get_file_path()) {
+               for (const auto& [pos, entry] : result.entries) {
+                  block_file.seek(pos);
+                  block_file.write(entry.data(), entry.size());
+               }
+               block_file.flush();
+            } else {
+               using boost::iostreams::mapped_file_sink;
+               mapped_file_sink sink(result.block_file.string(), mapped_file_sink::max_length, 0);
+               for (const auto& [pos, entry] : result.entries)
+                  memcpy(sink.data() + pos, entry.data(), entry.size());
+            }
+            dlog("Pruned the transactions of ${n} blocks up to block ${last} in ${file}",
+                 ("n", result.entries.size())("last", result.last_block_num)("file", result.block_file.string()));
+         }
+         pruned_block_num = result.last_block_num;
+      } catch (const fc::exception& e) {
+         prune_older_than = 0;
+         wlog("Failed to prune blocks in the background, no further blocks will be pruned: ${details}",
+              ("details", e.to_detail_string()));
+      } catch (const std::exception& e) {
+         prune_older_than = 0;
+         wlog("Failed to prune blocks in the background, no further blocks will be pruned: ${details}",
+              ("details", e.what()));
+      }
+   }
+
    size_t block_log::prune_transactions(uint32_t block_num, std::vector<transaction_id_type>& ids) {
+      std::lock_guard<std::mutex> g(my->mtx);
+      // a retained file being split is copied as is, prune the blocks in the files it is split into
+      my->finish_background_split(true);
+      my->finish_background_prune(true);
 
       auto [strm, version] = my->catalog.rw_stream_for_block(block_num);
       if (strm.remaining()) {       
@@ -1105,45 +1829,12 @@ namespace eosio { namespace chain {
          return false;
       }
 
-      // ****** create the new block log file and write out the header for the file
+      // ****** create the new block log file and index in temp_dir
       fc::create_directories(temp_dir);
       fc::path new_block_filename = temp_dir / "blocks.log";
-   
-      static_assert( block_log::max_supported_version == pruned_transaction_version,
-                     "Code was written to support format of version 4 or lower, need to update this code for latest format." );
-      
-      const auto     preamble_size           = block_log_preamble::nbytes_with_chain_id;
-      const auto     num_blocks_to_truncate  = truncate_at_block - log_bundle.log_data.first_block_num();
-      const uint64_t first_kept_block_pos    = log_bundle.log_index.nth_block_position(num_blocks_to_truncate);
-      const uint64_t nbytes_to_trim          = first_kept_block_pos - preamble_size;
-      const auto     new_block_file_size     = log_bundle.log_data.size() - nbytes_to_trim;
-
-      boost::iostreams::mapped_file_sink new_block_file;
-      create_mapped_file(new_block_file, new_block_filename.generic_string(), new_block_file_size);
-      fc::datastream<char*> ds(new_block_file.data(), new_block_file.size());
-
-      block_log_preamble preamble;
-      // version 4 or above have different log entry format; therefore version 1 to 3 can only be upgrade up to version 3 format.
-      preamble.version         = log_bundle.log_data.version() < pruned_transaction_version ? genesis_state_or_chain_id_version : block_log::max_supported_version;
-      preamble.first_block_num = truncate_at_block;
-      preamble.chain_context   = log_bundle.log_data.chain_id();
-      preamble.write_to(ds);
-
-      memcpy(new_block_file.data() + preamble_size, log_bundle.log_data.data() + first_kept_block_pos, new_block_file_size - preamble_size);
-
       fc::path new_index_filename = temp_dir / "blocks.index";
-      index_writer index(new_index_filename, log_bundle.log_index.num_blocks() - num_blocks_to_truncate);
-
-      // walk along the block position of each block entry and decrement its value by nbytes_to_trim
-      for (auto itr = make_reverse_block_position_iterator(new_block_file, preamble_size);
-            itr.get_value() != block_log::npos; ++itr) {
-         auto new_pos = itr.get_value() - nbytes_to_trim;
-         index.write(new_pos);
-         itr.set_value(new_pos);
-      }
-
-      index.close();
-      new_block_file.close();
+      write_block_range(log_bundle.log_data, log_bundle.log_index, truncate_at_block, log_bundle.log_data.last_block_num(),
+                        new_block_filename, new_index_filename);
 
       fc::path old_log = temp_dir / "old.log";
       rename(log_bundle.block_file_name, old_log);
@@ -1198,6 +1889,84 @@ namespace eosio { namespace chain {
       }
    }
 
+   void block_log::verify(fc::path block_dir) {
+      block_log_bundle log_bundle(block_dir);
+      const auto&      log_data   = log_bundle.log_data;
+      const auto&      log_index  = log_bundle.log_index;
+      const uint32_t   num_blocks = log_index.num_blocks();
+      if (num_blocks == 0)
+         return;
+
+      EOS_ASSERT(log_index.nth_block_position(0) == log_data.first_block_position(), block_log_exception,
+                 "${index_file_name} does not start at the first block of ${block_file_name}",
+                 ("index_file_name", log_bundle.index_file_name)("block_file_name", log_bundle.block_file_name));
+
+      struct range_result {
+         block_id_type first_previous_id;
+         block_id_type last_block_id;
+      };
+
+      // each range is validated on its own, the links between the ranges are checked once they are all done
+      const size_t num_ranges = std::min<size_t>(parallel_scan_ranges(log_data.size() - log_data.first_block_position()), num_blocks);
+      std::vector<std::future<range_result>> scans;
+      for (size_t r = 0; r < num_ranges; ++r) {
+         const uint32_t begin = num_blocks * r / num_ranges;
+         const uint32_t end   = num_blocks * (r + 1) / num_ranges;
+         scans.emplace_back(std::async(std::launch::async, [&log_data, &log_index, num_blocks, begin, end]() {
+            const uint64_t end_pos = end < num_blocks ? log_index.nth_block_position(end) : log_data.size();
+            EOS_ASSERT(end_pos <= log_data.size(), block_log_exception,
+                       "the index position of block ${num} is past the end of the block log",
+                       ("num", log_data.first_block_num() + end));
+            fc::datastream<const char*> ds(log_data.data(), end_pos);
+            ds.skip(log_index.nth_block_position(begin));
+
+            log_entry entry;
+            if (log_data.version() < pruned_transaction_version) {
+               entry.emplace<signed_block_v0>();
+            }
+
+            range_result  result;
+            uint32_t      block_num = log_data.first_block_num() + begin - 1;
+            block_id_type block_id;
+            for (uint32_t i = begin; i < end; ++i) {
+               const uint32_t expected_block_num = log_data.first_block_num() + i;
+               EOS_ASSERT(log_index.nth_block_position(i) == static_cast<uint64_t>(ds.tellp()), block_log_exception,
+                          "the index position of block ${num} does not match its entry in the block log",
+                          ("num", expected_block_num));
+               try {
+                  std::tie(block_num, block_id) = block_log_data::full_validate_block_entry(ds, block_num, block_id, entry);
+               } catch (const bad_block_exception&) {
+                  EOS_THROW(block_log_exception, "the entry of block ${num} could not be deserialized", ("num", expected_block_num));
+               }
+               const auto& previous = get_block_header(entry).previous;
+               EOS_ASSERT(block_num == expected_block_num, block_log_exception,
+                          "the entry of block ${num} holds block ${actual}", ("num", expected_block_num)("actual", block_num));
+               EOS_ASSERT(i == begin || previous == result.last_block_id, block_log_exception,
+                          "block ${num} does not link back to the previous block", ("num", block_num));
+               if (i == begin)
+                  result.first_previous_id = previous;
+               result.last_block_id = block_id;
+            }
+            EOS_ASSERT(ds.remaining() == 0, block_log_exception,
+                       "the entry of block ${num} does not end at the next index position", ("num", block_num));
+            return result;
+         }));
+      }
+
+      for (auto& scan : scans)
+         scan.wait();
+
+      block_id_type block_id;
+      for (size_t r = 0; r < scans.size(); ++r) {
+         const auto result = scans[r].get();
+         EOS_ASSERT(r == 0 || result.first_previous_id == block_id, block_log_exception,
+                    "block ${num} does not link back to the previous block",
+                    ("num", log_data.first_block_num() + num_blocks * r / num_ranges));
+         block_id = result.last_block_id;
+      }
+      ilog("Verified ${n} blocks of ${block_file_name}", ("n", num_blocks)("block_file_name", log_bundle.block_file_name));
+   }
+
    bool block_log::exists(const fc::path& data_dir) {
       return fc::exists(data_dir / "blocks.log") && fc::exists(data_dir / "blocks.index");
    }
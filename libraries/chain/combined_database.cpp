@@ -6,6 +6,10 @@
 #include <eosio/chain/backing_store/db_context.hpp>
 #include <eosio/chain/backing_store/db_key_value_format.hpp>
 
+#include <rocksdb/cache.h>
+
+#include <future>
+
 namespace eosio { namespace chain {
    combined_session::combined_session(chainbase::database& cb_database, eosio::session::undo_stack<rocks_db_type>* undo_stack)
        : kv_undo_stack{ undo_stack } {
@@ -103,15 +107,47 @@ namespace eosio { namespace chain {
       });
    }
 
+   /// Writes the batches of key values restored from a snapshot on a background thread, so the next batch can be
+   /// read from the snapshot meanwhile. The database must not be used otherwise until finish().
+   class async_batch_writer {
+    public:
+      using batch_type = std::vector<std::pair<eosio::session::shared_bytes, eosio::session::shared_bytes>>;
+
+      explicit async_batch_writer(rocks_db_type& kv_database) : kv_database(kv_database) {}
+
+      ~async_batch_writer() {
+         if (pending.valid())
+            pending.wait();
+      }
+
+      /// batch is left empty
+      void write(batch_type& batch) {
+         finish();
+         pending = std::async(std::launch::async, [this, batch{std::move(batch)}]() { kv_database.write(batch); });
+         batch.clear();
+      }
+
+      /// wait for the batch being written, rethrowing its error
+      void finish() {
+         if (pending.valid())
+            pending.get();
+      }
+
+    private:
+      rocks_db_type&    kv_database;
+      std::future<void> pending;
+   };
+
    void read_kv_table_from_snapshot(const snapshot_reader_ptr& snapshot, chainbase::database& db,
                                     const std::unique_ptr<rocks_db_type>& kv_database, uint32_t version, backing_store_type backing_store ) {
       if (version < kv_object::minimum_snapshot_version)
          return;
       if (backing_store == backing_store_type::ROCKSDB) {
-         auto key_values = std::vector<std::pair<eosio::session::shared_bytes, eosio::session::shared_bytes>>{};
+         auto key_values = async_batch_writer::batch_type{};
          constexpr std::size_t batch_size = 500;
          key_values.reserve(batch_size);
-         snapshot->read_section<kv_object>([&key_values, &db, &kv_database](auto& section) {
+         async_batch_writer writer(*kv_database);
+         snapshot->read_section<kv_object>([&key_values, &db, &writer](auto& section) {
             const std::string_view prefix_key {&backing_store::rocksdb_contract_kv_prefix, 1};
             bool more = !section.empty();
             while (more) {
@@ -135,13 +171,14 @@ namespace eosio { namespace chain {
                                        final_kv_value.as_payload());
 
                if (key_values.size() >= batch_size) {
-                  kv_database->write(key_values);
-                  key_values.clear();
+                  writer.write(key_values);
+                  key_values.reserve(batch_size);
                }
             }
          });
          // write out any remaining key-values
-         kv_database->write(key_values);
+         writer.write(key_values);
+         writer.finish();
       }
       else {
          snapshot->read_section<kv_object>([&db](auto& section) {
@@ -157,6 +194,41 @@ namespace eosio { namespace chain {
                                         uint32_t snapshot_batch_threashold)
        : backing_store(backing_store_type::CHAINBASE), db(chain_db), kv_snapshot_batch_threashold(snapshot_batch_threashold * 1024 * 1024) {}
 
+   // Full and partitioned filters in the block-based table
+   // use an improved Bloom filter implementation, enabled
+   // with format_version 5 (or above) because previous
+   // releases cannot read this filter. This replacement is
+   // faster and more accurate, especially for high bits
+   // per key or millions of keys in a single (full) filter.
+   static rocksdb::BlockBasedTableOptions make_table_options(uint32_t bloom_bits_per_key) {
+      rocksdb::BlockBasedTableOptions table_options;
+      table_options.format_version               = 5;
+      table_options.index_block_restart_interval = 16;
+
+      // Sets the bloom filter - Given an arbitrary key,
+      // this bit array may be used to determine if the key
+      // may exist or definitely does not exist in the key set.
+      table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(bloom_bits_per_key, false));
+      table_options.index_type = rocksdb::BlockBasedTableOptions::kBinarySearch;
+      return table_options;
+   }
+
+   static std::string hot_contract_column_family_name(name contract) {
+      return "contract." + contract.to_string();
+   }
+
+   // All keys of a contract, from both the KV and the DB API, start with one of these
+   static std::vector<eosio::session::shared_bytes> hot_contract_prefixes(name contract) {
+      b1::chain_kv::bytes contract_as_bytes;
+      b1::chain_kv::append_key(contract_as_bytes, contract.to_uint64_t());
+      std::vector<eosio::session::shared_bytes> prefixes;
+      for (char type_prefix : { backing_store::rocksdb_contract_kv_prefix, backing_store::rocksdb_contract_db_prefix }) {
+         prefixes.push_back(eosio::session::make_shared_bytes<std::string_view, 2>(
+               { std::string_view{ &type_prefix, 1 }, std::string_view{ contract_as_bytes.data(), contract_as_bytes.size() } }));
+      }
+      return prefixes;
+   }
+
    combined_database::combined_database(chainbase::database& chain_db,
                                         const controller::config& cfg)
        : backing_store(backing_store_type::ROCKSDB), db(chain_db), kv_database{ [&]() {
@@ -206,34 +278,60 @@ namespace eosio { namespace chain {
             // smaller ones that are run simultaneously.
             options.max_subcompactions = cfg.persistent_storage_num_threads;
 
-            // Full and partitioned filters in the block-based table
-            // use an improved Bloom filter implementation, enabled
-            // with format_version 5 (or above) because previous
-            // releases cannot read this filter. This replacement is
-            // faster and more accurate, especially for high bits
-            // per key or millions of keys in a single (full) filter.
-            rocksdb::BlockBasedTableOptions table_options;
-            table_options.format_version               = 5;
-            table_options.index_block_restart_interval = 16;
-
-            // Sets the bloom filter - Given an arbitrary key, 
-            // this bit array may be used to determine if the key 
-            // may exist or definitely does not exist in the key set.
-	          table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(15, false));
-	          table_options.index_type = rocksdb::BlockBasedTableOptions::kBinarySearch;
-
             // Incorporates the Table options into options
-            options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+            options.table_factory.reset(NewBlockBasedTableFactory(make_table_options(config::default_persistent_storage_bloom_bits_per_key)));
+
+            // Hot contracts get their own column family so their flushes and compactions
+            // do not stall everybody else, optionally with a block cache of their own.
+            rocksdb::ColumnFamilyOptions hot_options{ options };
+            hot_options.write_buffer_size         = cfg.persistent_storage_hot_contract_write_buffer_size;
+            hot_options.max_bytes_for_level_base  = hot_options.write_buffer_size * hot_options.min_write_buffer_number_to_merge * hot_options.level0_file_num_compaction_trigger;
+            hot_options.target_file_size_base     = hot_options.max_bytes_for_level_base / 10;
+            auto hot_table_options = make_table_options(cfg.persistent_storage_hot_contract_bloom_bits);
+            if (cfg.persistent_storage_hot_contract_cache_size > 0)
+               hot_table_options.block_cache = rocksdb::NewLRUCache(cfg.persistent_storage_hot_contract_cache_size);
+            hot_options.table_factory.reset(NewBlockBasedTableFactory(hot_table_options));
+
+            const auto db_path = (cfg.state_dir / "chain-kv").string();
+            std::vector<rocksdb::ColumnFamilyDescriptor> descriptors{ { rocksdb::kDefaultColumnFamilyName, options } };
+            for (auto contract : cfg.persistent_storage_hot_contracts)
+               descriptors.emplace_back(hot_contract_column_family_name(contract), hot_options);
+
+            // Moving a contract in or out of its own column family would need its existing keys moved as well
+            std::vector<std::string> existing;
+            if (rocksdb::DB::ListColumnFamilies(options, db_path, &existing).ok()) {
+               std::sort(existing.begin(), existing.end());
+               std::vector<std::string> configured;
+               for (const auto& d : descriptors) configured.push_back(d.name);
+               std::sort(configured.begin(), configured.end());
+               EOS_ASSERT(existing == configured, database_exception,
+                          "Existing state was created with a different persistent-storage-hot-contract setting; "
+                          "use resync, replay, or restore from snapshot to change hot contracts");
+            }
+            options.create_missing_column_families = true;
 
             rocksdb::DB* p;
-            auto         status = rocksdb::DB::Open(options, (cfg.state_dir / "chain-kv").string(), &p);
+            std::vector<rocksdb::ColumnFamilyHandle*> handles;
+            auto         status = rocksdb::DB::Open(options, db_path, descriptors, &handles, &p);
             if (!status.ok())
                throw std::runtime_error(std::string{ "database::database: rocksdb::DB::Open: " } + status.ToString());
             auto rdb        = std::shared_ptr<rocksdb::DB>{ p };
-            return std::make_unique<rocks_db_type>(eosio::session::make_session(std::move(rdb), 1024));
+
+            std::vector<rocks_db_type::column_family_prefix> prefixes;
+            auto handle = handles.begin();
+            delete *handle++; // default column family
+            for (auto contract : cfg.persistent_storage_hot_contracts) {
+               auto column_family = std::shared_ptr<rocksdb::ColumnFamilyHandle>{ *handle++ };
+               for (auto& prefix : hot_contract_prefixes(contract))
+                  prefixes.push_back({ std::move(prefix), column_family });
+               ilog("storing contract ${c} in its own rocksdb column family", ("c", contract));
+            }
+            return std::make_unique<rocks_db_type>(eosio::session::make_session(std::move(rdb), 1024, std::move(prefixes)));
          }() },
          kv_undo_stack(std::make_unique<eosio::session::undo_stack<rocks_db_type>>(*kv_database, cfg.state_dir)),
-         kv_snapshot_batch_threashold(cfg.persistent_storage_mbytes_batch * 1024 * 1024)  {}
+         kv_snapshot_batch_threashold(cfg.persistent_storage_mbytes_batch * 1024 * 1024)  {
+      kv_undo_stack->write_commits_in_background(cfg.persistent_storage_max_pending_commits);
+   }
 
    void combined_database::check_backing_store_setting(bool clean_startup) {
       if (backing_store != db.get<kv_db_config_object>().backing_store) {   
@@ -318,6 +416,7 @@ namespace eosio { namespace chain {
       if (backing_store == backing_store_type::ROCKSDB) {
          try {
             try {
+               kv_undo_stack->wait_for_pending_writes();
                kv_database->flush();
             }
             FC_LOG_AND_RETHROW()
@@ -326,6 +425,16 @@ namespace eosio { namespace chain {
       }
    }
 
+   std::vector<subsystem_memory> combined_database::memory_usage() const {
+      std::vector<subsystem_memory> result;
+      if (backing_store == backing_store_type::ROCKSDB && kv_database) {
+         result.push_back({ "rocksdb.memtables", kv_database->aggregated_int_property(rocksdb::DB::Properties::kSizeAllMemTables) });
+         result.push_back({ "rocksdb.block_cache", kv_database->aggregated_int_property(rocksdb::DB::Properties::kBlockCacheUsage) });
+         result.push_back({ "rocksdb.table_readers", kv_database->aggregated_int_property(rocksdb::DB::Properties::kEstimateTableReadersMem) });
+      }
+      return result;
+   }
+
    std::unique_ptr<kv_context> combined_database::create_kv_context(name receiver, kv_resource_manager resource_manager,
                                                                     const kv_database_config& limits) const {
       switch (backing_store) {
@@ -361,10 +470,11 @@ namespace eosio { namespace chain {
       snapshot->write_section<block_state>(
             [this, &head](auto& section) { section.template add_row<block_header_state>(head, db); });
 
+      // the sections which only read chainbase are packed in parallel when the snapshot writer has a thread pool
       eosio::chain::controller_index_set::walk_indices([this, &snapshot](auto utils) {
          using value_t = typename decltype(utils)::index_t::value_type;
 
-         snapshot->write_section<value_t>([utils, this](auto& section) {
+         snapshot->write_section_async<value_t>([utils, this](auto& section) {
             walk_index(utils, db, [this, &section](const auto& row) { section.add_row(row, db); });
          });
       });
@@ -374,6 +484,7 @@ namespace eosio { namespace chain {
 
       authorization.add_to_snapshot(snapshot);
       resource_limits.add_to_snapshot(snapshot);
+      snapshot->flush_sections();
    }
 
    void combined_database::read_from_snapshot(const snapshot_reader_ptr& snapshot,
@@ -516,8 +627,13 @@ namespace eosio { namespace chain {
    }
 
    template <typename Section>
-   void chainbase_add_contract_tables_to_snapshot(const chainbase::database& db, Section& section) {
-      index_utils<table_id_multi_index>::walk(db, [&db, &section](const table_id_object& table_row) {
+   void chainbase_add_contract_tables_to_snapshot(const chainbase::database& db, Section& section,
+                                                  table_id_object::id_type                begin = {},
+                                                  std::optional<table_id_object::id_type> end   = {}) {
+      const auto& tables = db.get_index<table_id_multi_index>().indices();
+      auto        first  = tables.lower_bound(begin);
+      auto        last   = end ? tables.lower_bound(*end) : tables.end();
+      std::for_each(first, last, [&db, &section](const table_id_object& table_row) {
          // add a row for the table
          section.add_row(table_row, db);
 
@@ -541,21 +657,40 @@ namespace eosio { namespace chain {
    }
 
    void combined_database::add_contract_tables_to_snapshot(const snapshot_writer_ptr& snapshot) const {
-      snapshot->write_section("contract_tables", [this](auto& section) {
-         if (kv_undo_stack && db.get<kv_db_config_object>().backing_store == backing_store_type::ROCKSDB) {
-            using add_database_section_receiver = backing_store::add_database_receiver<std::decay_t < decltype(section)>>;
-            using table_collector = backing_store::rocksdb_whole_db_table_collector<add_database_section_receiver>;
-
-            add_database_section_receiver add_db_receiver(section, db);
-            table_collector table_collector_receiver(add_db_receiver);
-            backing_store::rocksdb_contract_db_table_writer<table_collector> writer(table_collector_receiver);
-            const auto begin_key = eosio::session::shared_bytes(&backing_store::rocksdb_contract_db_prefix, 1);
-            const auto end_key = begin_key.next();
-            backing_store::walk_rocksdb_entries_with_prefix(kv_undo_stack, begin_key, end_key, writer);
+      if (!kv_undo_stack || db.get<kv_db_config_object>().backing_store != backing_store_type::ROCKSDB) {
+         // split the section into parts of consecutive tables, which are packed in parallel
+         constexpr size_t                      tables_per_part = 1000;
+         std::vector<table_id_object::id_type> part_begins;
+         size_t                                num_tables = 0;
+         index_utils<table_id_multi_index>::walk(db, [&](const table_id_object& table_row) {
+            if (num_tables++ % tables_per_part == 0)
+               part_begins.push_back(table_row.id);
+         });
+         if (part_begins.empty()) {
+            snapshot->write_section("contract_tables", [](auto&) {});
+            return;
          }
-         else {
-            chainbase_add_contract_tables_to_snapshot(db, section);
+         for (size_t i = 0; i < part_begins.size(); ++i) {
+            const bool last  = i + 1 == part_begins.size();
+            const auto begin = part_begins[i];
+            const auto end   = last ? std::optional<table_id_object::id_type>{} : part_begins[i + 1];
+            snapshot->write_section_async(
+                  "contract_tables",
+                  [this, begin, end](auto& section) { chainbase_add_contract_tables_to_snapshot(db, section, begin, end); },
+                  !last);
          }
+         return;
+      }
+      snapshot->write_section("contract_tables", [this](auto& section) {
+         using add_database_section_receiver = backing_store::add_database_receiver<std::decay_t < decltype(section)>>;
+         using table_collector = backing_store::rocksdb_whole_db_table_collector<add_database_section_receiver>;
+
+         add_database_section_receiver add_db_receiver(section, db);
+         table_collector table_collector_receiver(add_db_receiver);
+         backing_store::rocksdb_contract_db_table_writer<table_collector> writer(table_collector_receiver);
+         const auto begin_key = eosio::session::shared_bytes(&backing_store::rocksdb_contract_db_prefix, 1);
+         const auto end_key = begin_key.next();
+         backing_store::walk_rocksdb_entries_with_prefix(kv_undo_stack, begin_key, end_key, writer);
       });
    }
 
@@ -591,7 +726,8 @@ namespace eosio { namespace chain {
    template <typename Section>
    void rocksdb_read_contract_tables_from_snapshot(rocks_db_type& kv_database, chainbase::database& db,
                                                    Section& section, uint64_t snapshot_batch_threashold) {
-      std::vector<std::pair<eosio::session::shared_bytes, eosio::session::shared_bytes>> batch;
+      async_batch_writer::batch_type batch;
+      async_batch_writer  writer(kv_database);
       bool                more     = !section.empty();
       auto                read_row = [&section, &more, &db](auto& row) { more = section.read_row(row, db); };
       uint64_t            batch_mem_size = 0;
@@ -600,7 +736,7 @@ namespace eosio { namespace chain {
          // read the row for the table
          backing_store::table_id_object_view table_obj;
          read_row(table_obj);
-         auto put = [&batch, &table_obj, &batch_mem_size, &kv_database, snapshot_batch_threashold]
+         auto put = [&batch, &table_obj, &batch_mem_size, &writer, snapshot_batch_threashold]
                (auto&& value, auto create_fun, auto&&... args) {
             auto composite_key = create_fun(table_obj.scope, table_obj.table, std::forward<decltype(args)>(args)...);
             batch.emplace_back(backing_store::db_key_value_format::create_full_key(composite_key, table_obj.code),
@@ -609,9 +745,8 @@ namespace eosio { namespace chain {
             const auto& back = batch.back();
             const auto size = back.first.size() + back.second.size();
             if (size >= snapshot_batch_threashold || snapshot_batch_threashold - size < batch_mem_size) {
-               kv_database.write(batch);
+               writer.write(batch);
                batch_mem_size = 0;
-               batch.clear();
             }
             else {
                batch_mem_size += size;
@@ -654,7 +789,8 @@ namespace eosio { namespace chain {
          put(pp.as_payload(), create_table_key);
 
       }
-      kv_database.write(batch);
+      writer.write(batch);
+      writer.finish();
    }
 
    void combined_database::read_contract_tables_from_snapshot(const snapshot_reader_ptr& snapshot) {
@@ -12,6 +12,9 @@
 #include <eosio/chain/resource_limits.hpp>
 #include <eosio/chain/thread_utils.hpp>
 #include <eosio/chain/platform_timer.hpp>
+#include <eosio/chain/startup_metrics.hpp>
+#include <eosio/chain/transaction_access_set.hpp>
+#include <eosio/chain/transaction_id_filter.hpp>
 
 #include <chainbase/chainbase.hpp>
 #include <fc/io/json.hpp>
@@ -21,6 +24,11 @@
 #include <b1/chain_kv/chain_kv.hpp>
 
 #include <new>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <unordered_map>
+#include <thread>
 
 #if defined(EOSIO_EOS_VM_RUNTIME_ENABLED) || defined(EOSIO_EOS_VM_JIT_RUNTIME_ENABLED)
 #include <eosio/vm/allocator.hpp>
@@ -48,6 +56,7 @@ struct building_block {
    deque<transaction_receipt>                 _pending_trx_receipts; // boost deque in 1.71 with 1024 elements performs better
    std::variant<checksum256_type, digests_t>  _trx_mroot_or_receipt_digests;
    digests_t                                  _action_receipt_digests;
+   vector<transaction_access_set>             _trx_access_sets; // only populated when profiling transaction parallelism
 };
 
 struct assembled_block {
@@ -139,6 +148,91 @@ struct pending_state {
    }
 };
 
+/// Reads a range of blocks from the block log on its own thread, at most max_blocks ahead of the blocks taken by
+/// next(), so that reading and unpacking blocks, which includes computing their transaction ids, overlaps with
+/// applying them. The block log serializes the reads with the main thread's use of it.
+class block_read_ahead {
+public:
+   block_read_ahead( const block_log& blog, uint32_t first_block_num, uint32_t last_block_num, uint32_t max_blocks,
+                     std::function<void(const signed_block_ptr&)> prepare )
+   :blog(blog)
+   ,max_blocks(max_blocks)
+   ,prepare(std::move(prepare))
+   ,reader([this, first_block_num, last_block_num]() { read( first_block_num, last_block_num ); })
+   {}
+
+   ~block_read_ahead() {
+      {
+         std::lock_guard<std::mutex> g( mtx );
+         stopped = true;
+      }
+      cv.notify_all();
+      reader.join();
+   }
+
+   /// @return the next block of the range, or nullptr once the range or the block log is exhausted
+   signed_block_ptr next() {
+      std::unique_lock<std::mutex> g( mtx );
+      cv.wait( g, [this]() { return !blocks.empty() || done; } );
+      if( blocks.empty() ) {
+         if( except ) std::rethrow_exception( except );
+         return {};
+      }
+      signed_block_ptr b = std::move( blocks.front() );
+      blocks.pop_front();
+      cv.notify_all();
+      return b;
+   }
+
+private:
+   void read( uint32_t first_block_num, uint32_t last_block_num ) {
+      fc::set_os_thread_name( "replay-read" );
+      std::exception_ptr e;
+      try {
+         for( uint32_t block_num = first_block_num; block_num <= last_block_num; ++block_num ) {
+            signed_block_ptr b = blog.read_signed_block_by_num( block_num );
+            if( !b ) break;
+            if( prepare ) prepare( b );
+
+            std::unique_lock<std::mutex> g( mtx );
+            cv.wait( g, [this]() { return blocks.size() < max_blocks || stopped; } );
+            if( stopped ) return;
+            blocks.push_back( std::move( b ) );
+            cv.notify_all();
+         }
+      } catch( ... ) {
+         e = std::current_exception();
+      }
+      std::lock_guard<std::mutex> g( mtx );
+      except = e;
+      done = true;
+      cv.notify_all();
+   }
+
+   const block_log&                             blog;
+   const size_t                                 max_blocks;
+   std::function<void(const signed_block_ptr&)> prepare;
+   std::mutex                                   mtx;
+   std::condition_variable                      cv;
+   std::deque<signed_block_ptr>                 blocks;      ///< guarded by mtx
+   std::exception_ptr                           except;      ///< guarded by mtx
+   bool                                         done = false;    ///< guarded by mtx
+   bool                                         stopped = false; ///< guarded by mtx
+   std::thread                                  reader; // last, started once the members above are constructed
+};
+
+/**
+ * Records the time since the previous mark as a phase of startup; placed between the members of controller_impl to
+ * time their construction, which opens the state, the block log and the code cache.
+ */
+struct startup_mark {
+   startup_mark( startup_metrics& m, fc::time_point& last, const char* phase ) {
+      const auto now = fc::time_point::now();
+      m.record( phase, now - last );
+      last = now;
+   }
+};
+
 struct controller_impl {
 
    // LLVM sets the new handler, we need to reset this to throw a bad_alloc exception so we can possibly exit cleanly
@@ -150,14 +244,22 @@ struct controller_impl {
    reset_new_handler                   rnh; // placed here to allow for this to be set before constructing the other fields
    controller&                         self;
    std::function<void()>               shutdown;
+   startup_metrics                     startup_times;
+   fc::time_point                      last_startup_mark = fc::time_point::now();
    chainbase::database                 db;
    chainbase::database                 reversible_blocks; ///< a special database to persist blocks that have successfully been applied but are still reversible
+   startup_mark                        chainbase_opened{ startup_times, last_startup_mark, "controller.chainbase_open" };
    combined_database                   kv_db;
+   startup_mark                        kv_opened{ startup_times, last_startup_mark, "controller.kv_database_open" };
    block_log                           blog;
+   startup_mark                        block_log_opened{ startup_times, last_startup_mark, "controller.block_log_open" };
    std::optional<pending_state>        pending;
    block_state_ptr                     head;
    fork_database                       fork_db;
    wasm_interface                      wasmif;
+   startup_mark                        wasm_opened{ startup_times, last_startup_mark, "controller.wasm_interface_open" };
+   mutable abi_serializer_cache        abi_cache;
+   block_apply_metrics                 block_metrics;
    resource_limits_manager             resource_limits;
    authorization_manager               authorization;
    protocol_feature_manager            protocol_features;
@@ -176,32 +278,50 @@ struct controller_impl {
    vm::wasm_allocator               wasm_alloc;
 #endif
 
+   /// signature recovery started by prepare_block() ahead of apply_block()
+   struct prepared_block {
+      signed_block_ptr                   block;
+      std::vector<recover_keys_future>   trx_metas; ///< one per packed_transaction receipt of block, in order
+   };
+   std::mutex                                 prepared_blocks_mtx;
+   std::map<block_id_type, prepared_block>    prepared_blocks; ///< guarded by prepared_blocks_mtx
+
+   /// ids of recorded input transactions, loaded from transaction_multi_index on first use
+   transaction_id_filter                      trx_id_filter;
+   bool                                       trx_id_filter_loaded = false;
+
    typedef pair<scope_name,action_name>                   handler_key;
    map< account_name, map<handler_key, apply_handler> >   apply_handlers;
    unordered_map< builtin_protocol_feature_t, std::function<void(controller_impl&)>, enum_hash<builtin_protocol_feature_t> > protocol_feature_activation_handlers;
 
-   void pop_block() {
-      auto prev = fork_db.get_block( head->header.previous );
+   /// pop count blocks off head, the caches depending on the state are only reset once after all the undos
+   void pop_blocks( size_t count ) {
+      if( count == 0 )
+         return;
+      for( size_t i = 0; i < count; ++i ) {
+         auto prev = fork_db.get_block( head->header.previous );
 
-      if( !prev ) {
-         EOS_ASSERT( fork_db.root()->id == head->header.previous, block_validate_exception, "attempt to pop beyond last irreversible block" );
-         prev = fork_db.root();
-      }
+         if( !prev ) {
+            EOS_ASSERT( fork_db.root()->id == head->header.previous, block_validate_exception, "attempt to pop beyond last irreversible block" );
+            prev = fork_db.root();
+         }
 
-      if( const auto* b = reversible_blocks.find<reversible_block_object,by_num>(head->block_num) )
-      {
-         reversible_blocks.remove( *b );
-      }
+         if( const auto* b = reversible_blocks.find<reversible_block_object,by_num>(head->block_num) )
+         {
+            reversible_blocks.remove( *b );
+         }
 
-      if ( read_mode == db_read_mode::SPECULATIVE ) {
-         EOS_ASSERT( head->block, block_validate_exception, "attempting to pop a block that was sparsely loaded from a snapshot");
-      }
+         if ( read_mode == db_read_mode::SPECULATIVE ) {
+            EOS_ASSERT( head->block, block_validate_exception, "attempting to pop a block that was sparsely loaded from a snapshot");
+         }
 
-      head = prev;
+         head = prev;
 
-      kv_db.undo();
+         kv_db.undo();
+      }
+      authorization.reset_lookup_cache();
 
-      protocol_features.popped_blocks_to( prev->block_num );
+      protocol_features.popped_blocks_to( head->block_num );
    }
 
    template<builtin_protocol_feature_t F>
@@ -244,13 +364,16 @@ struct controller_impl {
     conf( cfg ),
     chain_id( chain_id ),
     read_mode( cfg.read_mode ),
-    thread_pool( "chain", cfg.thread_pool_size )
+    thread_pool( "chain", cfg.thread_pool_size, cfg.thread_pool_cpus )
    {
-      fork_db.open( [this]( block_timestamp_type timestamp,
-                            const flat_set<digest_type>& cur_features,
-                            const vector<digest_type>& new_features )
-                           { check_protocol_features( timestamp, cur_features, new_features ); }
-      );
+      {
+         startup_metrics::scoped_timer t( "controller.fork_database_open", startup_times );
+         fork_db.open( [this]( block_timestamp_type timestamp,
+                               const flat_set<digest_type>& cur_features,
+                               const vector<digest_type>& new_features )
+                              { check_protocol_features( timestamp, cur_features, new_features ); }
+         );
+      }
 
       set_activation_handler<builtin_protocol_feature_t::preactivate_feature>();
       set_activation_handler<builtin_protocol_feature_t::replace_deferred>();
@@ -261,6 +384,7 @@ struct controller_impl {
       set_activation_handler<builtin_protocol_feature_t::kv_database>();
       set_activation_handler<builtin_protocol_feature_t::configurable_wasm_limits>();
       set_activation_handler<builtin_protocol_feature_t::blockchain_parameters>();
+      set_activation_handler<builtin_protocol_feature_t::batched_db_reads>();
 
       self.irreversible_block.connect([this](const block_state_ptr& bsp) {
          wasmif.current_lib(bsp->block_num);
@@ -317,6 +441,13 @@ struct controller_impl {
       }
    }
 
+   /// emit a signal of block progress, timing its handlers
+   template<typename Signal, typename Arg>
+   void emit_block_signal( const Signal& s, Arg&& a ) {
+      block_apply_metrics::scoped_timer t( block_metrics, block_apply_metrics::stage::signals );
+      emit( s, std::forward<Arg>( a ) );
+   }
+
    void log_irreversible() {
       EOS_ASSERT( fork_db.root(), fork_database_exception, "fork database not properly initialized" );
 
@@ -358,7 +489,7 @@ struct controller_impl {
                fork_db.mark_valid( head );
             }
 
-            emit( self.irreversible_block, *bitr );
+            emit_block_signal( self.irreversible_block, *bitr );
 
             // blog.append could fail due to failures like running out of space.
             // Do it before commit so that in case it throws, DB can be rolled back.
@@ -429,9 +560,22 @@ struct controller_impl {
          ilog( "existing block log, attempting to replay from ${s} to ${n} blocks",
                ("s", start_block_num)("n", blog_head->block_num()) );
          try {
-            while( std::unique_ptr<signed_block> next = blog.read_signed_block_by_num( head->block_num + 1 ) ) {
+            std::optional<block_read_ahead> read_ahead;
+            if( conf.replay_read_ahead_blocks > 0 ) {
+               std::function<void(const signed_block_ptr&)> prepare;
+               if( conf.force_all_checks ) {
+                  // start recovering the signatures that are checked
+                  prepare = [this]( const signed_block_ptr& b ) { prepare_block( b->calculate_id(), b ); };
+               }
+               read_ahead.emplace( blog, start_block_num, blog_head->block_num(), conf.replay_read_ahead_blocks, std::move(prepare) );
+            }
+            auto read_next = [&]() -> signed_block_ptr {
+               if( read_ahead ) return read_ahead->next();
+               return blog.read_signed_block_by_num( head->block_num + 1 );
+            };
+            while( signed_block_ptr next = read_next() ) {
                auto block_num = next->block_num();
-               replay_push_block( std::move(next), controller::block_status::irreversible );
+               replay_push_block( next, controller::block_status::irreversible );
                if( check_shutdown() ) break;
                if( block_num % 500 == 0 ) {
                   ilog( "${n} of ${head}", ("n", block_num)("head", blog_head->block_num()) );
@@ -492,7 +636,11 @@ struct controller_impl {
       this->shutdown = shutdown;
       ilog( "Starting initialization from snapshot, this may take a significant amount of time" );
       try {
-         snapshot->validate();
+         {
+            startup_metrics::scoped_timer t( "snapshot.validate", startup_times );
+            snapshot->validate();
+         }
+         const size_t sections_before = snapshot->get_section_times().size();
          if( blog.head() ) {
             kv_db.read_from_snapshot( snapshot, blog.first_block_num(), blog.head()->block_num(),
                                       authorization, resource_limits,
@@ -507,7 +655,13 @@ struct controller_impl {
                         "Snapshot is invalid." );
             blog.reset( chain_id, lib_num + 1 );
          }
+         const auto& section_times = snapshot->get_section_times();
+         for( size_t i = sections_before; i < section_times.size(); ++i )
+            startup_times.record( "snapshot.section." + section_times[i].first, section_times[i].second );
+
+         const auto hash_start = fc::time_point::now();
          const auto hash = calculate_integrity_hash();
+         startup_times.record( "snapshot.integrity_hash", fc::time_point::now() - hash_start );
          ilog( "database initialized with hash: ${hash}", ("hash", hash) );
 
          init(check_shutdown, true);
@@ -538,7 +692,10 @@ struct controller_impl {
       } else {
          wlog( "No existing chain state or fork database. Initializing fresh blockchain state and resetting fork database.");
       }
-      initialize_blockchain_state(genesis); // sets head to genesis state
+      {
+         startup_metrics::scoped_timer t( "controller.initialize_blockchain_state", startup_times );
+         initialize_blockchain_state(genesis); // sets head to genesis state
+      }
 
       if( !fork_db.head() ) {
          fork_db.reset( *head );
@@ -635,12 +792,16 @@ struct controller_impl {
                "attempting to undo pending changes",
                ("db",db.revision())("head",head->block_num) );
       }
-      while( db.revision() > head->block_num ) {
-         kv_db.undo();
+      {
+         startup_metrics::scoped_timer t( "controller.undo_pending", startup_times );
+         while( db.revision() > head->block_num ) {
+            kv_db.undo();
+         }
       }
 
       protocol_features.init( db );
 
+      const auto reversible_start = fc::time_point::now();
       const auto& rbi = reversible_blocks.get_index<reversible_block_index,by_num>();
       auto last_block_num = lib_num;
 
@@ -701,6 +862,7 @@ struct controller_impl {
          }
          // else no checks needed since fork_db will be completely reset on replay anyway
       }
+      startup_times.record( "controller.reversible_blocks", fc::time_point::now() - reversible_start );
 
       if (auto dm_logger = get_deep_mind_logger()) {
          // FIXME: We should probably feed that from CMake directly somehow ...
@@ -722,7 +884,13 @@ struct controller_impl {
          fc_dlog(*dm_logger, "ABIDUMP END");
       }
 
+      {
+         startup_metrics::scoped_timer t( "controller.wasm_warm_up", startup_times );
+         wasmif.warm_up(conf.wasm_runtime_warmup_contracts);
+      }
+
       if( last_block_num > head->block_num ) {
+         startup_metrics::scoped_timer t( "controller.replay", startup_times );
          replay( check_shutdown ); // replay any irreversible and reversible blocks ahead of current head
       }
 
@@ -760,9 +928,10 @@ struct controller_impl {
       resource_limits.add_indices();
    }
 
-   sha256 calculate_integrity_hash() const {
+   sha256 calculate_integrity_hash() {
       sha256::encoder enc;
       auto hash_writer = std::make_shared<integrity_hash_snapshot_writer>(enc);
+      hash_writer->set_thread_pool( thread_pool.get_executor(), 2 * conf.thread_pool_size );
       kv_db.add_to_snapshot(hash_writer, *fork_db.head(), authorization, resource_limits);
       hash_writer->finalize();
 
@@ -927,6 +1096,7 @@ struct controller_impl {
       transaction_checktime_timer trx_timer(timer);
       const packed_transaction trx( std::move( etrx ), true );
       transaction_context trx_context( self, trx, std::move(trx_timer), start );
+      trx_context.trace_notification_payloads = trace_notification_payloads();
       trx_context.deadline = deadline;
       trx_context.explicit_billed_cpu_time = explicit_billed_cpu_time;
       trx_context.billed_cpu_time_us = billed_cpu_time_us;
@@ -1072,6 +1242,7 @@ struct controller_impl {
 
       transaction_checktime_timer trx_timer(timer);
       transaction_context trx_context( self, *trx->packed_trx(), std::move(trx_timer) );
+      trx_context.trace_notification_payloads = trace_notification_payloads();
       trx_context.leeway =  fc::microseconds(0); // avoid stealing cpu resource
       trx_context.deadline = deadline;
       trx_context.explicit_billed_cpu_time = explicit_billed_cpu_time;
@@ -1212,6 +1383,17 @@ struct controller_impl {
    } FC_CAPTURE_AND_RETHROW() } /// push_scheduled_transaction
 
 
+   /**
+    *  Notification traces only drop their action payloads while validating blocks on a node configured with
+    *  minimal_validation_traces; speculative and produced transactions keep full traces for the API callers.
+    */
+   bool trace_notification_payloads()const {
+      return !conf.minimal_validation_traces
+             || pending->_block_status == controller::block_status::incomplete
+             || conf.contracts_console
+             || get_deep_mind_logger() != nullptr;
+   }
+
    /**
     *  Adds the transaction receipt to the pending block and returns it.
     */
@@ -1249,7 +1431,7 @@ struct controller_impl {
       transaction_trace_ptr trace;
       try {
          auto start = fc::time_point::now();
-         const bool check_auth = !self.skip_auth_check() && !trx->implicit;
+         const bool check_auth = !self.skip_auth_check() && !trx->implicit && !trx->dry_run;
          const fc::microseconds sig_cpu_usage = trx->signature_cpu_usage();
 
          if( !explicit_billed_cpu_time ) {
@@ -1264,6 +1446,7 @@ struct controller_impl {
 
          transaction_checktime_timer trx_timer(timer);
          transaction_context trx_context(self, *trx->packed_trx(), std::move(trx_timer), start);
+         trx_context.trace_notification_payloads = trace_notification_payloads();
          if ((bool)subjective_cpu_leeway && pending->_block_status == controller::block_status::incomplete) {
             trx_context.leeway = *subjective_cpu_leeway;
          }
@@ -1271,6 +1454,11 @@ struct controller_impl {
          trx_context.explicit_billed_cpu_time = explicit_billed_cpu_time;
          trx_context.billed_cpu_time_us = billed_cpu_time_us;
          trx_context.subjective_cpu_bill_us = subjective_cpu_bill_us;
+         if( conf.profile_trx_parallelism && !trx->dry_run && pending->_block_status != controller::block_status::incomplete ) {
+            trx_context.access_set.emplace();
+            // legacy db reads against the rocksdb backing store do not pass through apply_context::find_table
+            trx_context.access_set->opaque = ( conf.backing_store != backing_store_type::CHAINBASE );
+         }
          trace = trx_context.trace;
 
          auto handle_exception =[&](const auto& e)
@@ -1288,7 +1476,7 @@ struct controller_impl {
                trx_context.init_for_implicit_trx();
                trx_context.enforce_whiteblacklist = false;
             } else {
-               bool skip_recording = replay_head_time && (time_point(trn.expiration) <= *replay_head_time);
+               bool skip_recording = trx->dry_run || (replay_head_time && (time_point(trn.expiration) <= *replay_head_time));
                if( explicit_net_usage_words ) {
                   trx_context.init_for_input_trx_with_explicit_net( *explicit_net_usage_words, skip_recording );
                } else {
@@ -1299,6 +1487,8 @@ struct controller_impl {
             }
 
             trx_context.delay = fc::seconds(trn.delay_sec);
+            EOS_ASSERT( !trx->dry_run || trx_context.delay == fc::microseconds(), transaction_exception,
+                        "dry-run transactions cannot be delayed" );
 
             if( check_auth ) {
                authorization.check_authorization(
@@ -1313,6 +1503,12 @@ struct controller_impl {
             trx_context.exec();
             trx_context.finalize(); // Automatically rounds up network and CPU usage in trace and bills payers if successful
 
+            if( trx->dry_run ) {
+               // no receipt, no signals and nothing of the transaction's effects survive
+               trx_context.undo();
+               return trace;
+            }
+
             auto restore = make_block_restore_point();
 
             if (!trx->implicit) {
@@ -1333,6 +1529,13 @@ struct controller_impl {
             fc::move_append( std::get<building_block>(pending->_block_stage)._action_receipt_digests,
                              std::move(trx_context.executed_action_receipt_digests) );
 
+            if( trx_context.access_set ) {
+               for( const auto& a : trx_context.bill_to_accounts ) {
+                  trx_context.access_set->add_write( a );
+               }
+               std::get<building_block>(pending->_block_stage)._trx_access_sets.emplace_back( std::move(*trx_context.access_set) );
+            }
+
             // call the accept signal but only once for this transaction
             if (!trx->accepted) {
                trx->accepted = true;
@@ -1364,8 +1567,10 @@ struct controller_impl {
            handle_exception(wrapper);
          }
 
-         emit( self.accepted_transaction, trx );
-         emit( self.applied_transaction, std::tie(trace, trx->packed_trx()) );
+         if( !trx->dry_run ) {
+            emit( self.accepted_transaction, trx );
+            emit( self.applied_transaction, std::tie(trace, trx->packed_trx()) );
+         }
 
          return trace;
       } FC_CAPTURE_AND_RETHROW((trace))
@@ -1403,6 +1608,8 @@ struct controller_impl {
       pending->_block_status = s;
       pending->_producer_block_id = producer_block_id;
 
+      authorization.reset_lookup_cache();
+
       auto& bb = std::get<building_block>(pending->_block_stage);
       const auto& pbhs = bb._pending_block_header_state;
 
@@ -1478,7 +1685,7 @@ struct controller_impl {
 
          if( gpo.proposed_schedule_block_num && // if there is a proposed schedule that was proposed in a block ...
              ( *gpo.proposed_schedule_block_num <= pbhs.dpos_irreversible_blocknum ) && // ... that has now become irreversible ...
-             pbhs.prev_pending_schedule.schedule.producers.size() == 0 // ... and there was room for a new pending schedule prior to any possible promotion
+             pbhs.prev_pending_schedule.schedule->producers.size() == 0 // ... and there was room for a new pending schedule prior to any possible promotion
          )
          {
             // Promote proposed schedule to pending schedule.
@@ -1526,6 +1733,8 @@ struct controller_impl {
          }
 
          clear_expired_input_transactions();
+         // removals of transactions that expired before the last irreversible block can no longer be undone
+         trx_id_filter.prune( fc::time_point_sec( self.last_irreversible_block_time() ) );
          update_producers_authority();
       }
 
@@ -1537,6 +1746,7 @@ struct controller_impl {
       EOS_ASSERT( pending, block_validate_exception, "it is not valid to finalize when there is no pending block");
       EOS_ASSERT( std::holds_alternative<building_block>(pending->_block_stage), block_validate_exception, "already called finalize_block");
 
+      block_apply_metrics::scoped_timer finalize_timer( block_metrics, block_apply_metrics::stage::finalize_block );
       try {
 
       auto& pbhs = pending->get_pending_block_header_state();
@@ -1609,6 +1819,7 @@ struct controller_impl {
     * @post regardless of the success of commit block there is no active pending block
     */
    void commit_block( bool add_to_fork_db ) {
+      block_apply_metrics::scoped_timer commit_timer( block_metrics, block_apply_metrics::stage::commit_block );
       auto reset_pending_on_exit = fc::make_scoped_exit([this]{
          pending.reset();
       });
@@ -1622,7 +1833,7 @@ struct controller_impl {
          if( add_to_fork_db ) {
             fork_db.add( bsp );
             fork_db.mark_valid( bsp );
-            emit( self.accepted_block_header, bsp );
+            emit_block_signal( self.accepted_block_header, bsp );
             head = fork_db.head();
             EOS_ASSERT( bsp == head, fork_database_exception, "committed block did not become the new head in fork database");
          }
@@ -1634,7 +1845,7 @@ struct controller_impl {
             });
          }
 
-         emit( self.accepted_block, bsp );
+         emit_block_signal( self.accepted_block, bsp );
 
          if( add_to_fork_db ) {
             log_irreversible();
@@ -1713,12 +1924,16 @@ struct controller_impl {
 
    void apply_block( const block_state_ptr& bsp, controller::block_status s, const trx_meta_cache_lookup& trx_lookup )
    { try {
+      block_apply_metrics::scoped_timer apply_timer( block_metrics, block_apply_metrics::stage::apply_block );
       try {
          const signed_block_ptr& b = bsp->block;
          const auto& new_protocol_feature_activations = bsp->get_new_protocol_feature_activations();
 
          auto producer_block_id = bsp->id;
-         start_block( b->timestamp, b->confirmed, new_protocol_feature_activations, s, producer_block_id);
+         {
+            block_apply_metrics::scoped_timer t( block_metrics, block_apply_metrics::stage::start_block );
+            start_block( b->timestamp, b->confirmed, new_protocol_feature_activations, s, producer_block_id);
+         }
 
          // validated in create_block_state_future()
          std::get<building_block>(pending->_block_stage)._trx_mroot_or_receipt_digests = b->transaction_mroot;
@@ -1728,10 +1943,15 @@ struct controller_impl {
          const bool skip_auth_checks = self.skip_auth_check();
          std::vector<std::tuple<transaction_metadata_ptr, recover_keys_future>> trx_metas;
          bool use_bsp_cached = false;
+         std::optional<prepared_block> prepared = take_prepared_block( bsp->id, b );
          if( pub_keys_recovered || (skip_auth_checks && existing_trxs_metas) ) {
             use_bsp_cached = true;
          } else {
             trx_metas.reserve( b->transactions.size() );
+            // the transactions which were not prepared and whose keys are not known, recovered together below
+            std::vector<size_t> to_recover;
+            std::vector<packed_transaction_ptr> to_recover_trxs;
+            size_t prepared_idx = 0;
             for( const auto& receipt : b->transactions ) {
                if( std::holds_alternative<packed_transaction>(receipt.trx)) {
                   const auto& pt = std::get<packed_transaction>(receipt.trx);
@@ -1744,14 +1964,21 @@ struct controller_impl {
                      trx_metas.emplace_back(
                            transaction_metadata::create_no_recover_keys( std::move(ptrx), transaction_metadata::trx_type::input ),
                            recover_keys_future{} );
+                  } else if( prepared && prepared_idx < prepared->trx_metas.size() ) {
+                     trx_metas.emplace_back( transaction_metadata_ptr{}, std::move( prepared->trx_metas[prepared_idx] ) );
                   } else {
-                     packed_transaction_ptr ptrx( b, &pt ); // alias signed_block_ptr
-                     auto fut = transaction_metadata::start_recover_keys(
-                           std::move( ptrx ), thread_pool.get_executor(), chain_id, microseconds::maximum() );
-                     trx_metas.emplace_back( transaction_metadata_ptr{}, std::move( fut ) );
+                     to_recover.push_back( trx_metas.size() );
+                     to_recover_trxs.emplace_back( b, &pt ); // alias signed_block_ptr
+                     trx_metas.emplace_back( transaction_metadata_ptr{}, recover_keys_future{} );
                   }
+                  ++prepared_idx;
                }
             }
+            auto futures = transaction_metadata::start_recover_keys( std::move( to_recover_trxs ), thread_pool.get_executor(),
+                                                                     chain_id, microseconds::maximum(), 2 * conf.thread_pool_size );
+            for( size_t i = 0; i < to_recover.size(); ++i ) {
+               std::get<recover_keys_future>( trx_metas[to_recover[i]] ) = std::move( futures[i] );
+            }
          }
 
          transaction_trace_ptr trace;
@@ -1760,13 +1987,21 @@ struct controller_impl {
 
          size_t packed_idx = 0;
          const auto& trx_receipts = std::get<building_block>(pending->_block_stage)._pending_trx_receipts;
+         const auto trxs_start = fc::time_point::now();
+         fc::microseconds recover_keys_wait;
          for( const auto& receipt : b->transactions ) {
             auto num_pending_receipts = trx_receipts.size();
             if( std::holds_alternative<packed_transaction>(receipt.trx) ) {
-               const auto& trx_meta = ( use_bsp_cached ? bsp->trxs_metas().at( packed_idx )
-                                                       : ( !!std::get<0>( trx_metas.at( packed_idx ) ) ?
-                                                             std::get<0>( trx_metas.at( packed_idx ) )
-                                                             : std::get<1>( trx_metas.at( packed_idx ) ).get() ) );
+               transaction_metadata_ptr trx_meta;
+               if( use_bsp_cached ) {
+                  trx_meta = bsp->trxs_metas().at( packed_idx );
+               } else if( std::get<0>( trx_metas.at( packed_idx ) ) ) {
+                  trx_meta = std::get<0>( trx_metas.at( packed_idx ) );
+               } else {
+                  const auto wait_start = fc::time_point::now();
+                  trx_meta = std::get<1>( trx_metas.at( packed_idx ) ).get();
+                  recover_keys_wait += fc::time_point::now() - wait_start;
+               }
                std::optional<uint32_t> explicit_net_usage_words;
                if( explicit_net ) {
                   explicit_net_usage_words = receipt.net_usage_words.value;
@@ -1775,6 +2010,12 @@ struct controller_impl {
                ++packed_idx;
             } else if( std::holds_alternative<transaction_id_type>(receipt.trx) ) {
                trace = push_scheduled_transaction( std::get<transaction_id_type>(receipt.trx), fc::time_point::maximum(), receipt.cpu_usage_us, true );
+               if( conf.profile_trx_parallelism ) {
+                  // deferred transactions are not tracked, treat them as a barrier
+                  transaction_access_set barrier;
+                  barrier.opaque = true;
+                  std::get<building_block>(pending->_block_stage)._trx_access_sets.emplace_back( std::move(barrier) );
+               }
             } else {
                EOS_ASSERT( false, block_validate_exception, "encountered unexpected receipt type" );
             }
@@ -1800,6 +2041,13 @@ struct controller_impl {
                         ("producer_receipt", static_cast<const transaction_receipt_header&>(receipt))("validator_receipt", r) );
          }
 
+         block_metrics.record( block_apply_metrics::stage::recover_keys, recover_keys_wait );
+         block_metrics.record( block_apply_metrics::stage::transactions, fc::time_point::now() - trxs_start - recover_keys_wait );
+
+         if( conf.profile_trx_parallelism ) {
+            log_trx_parallelism( b->block_num(), std::get<building_block>(pending->_block_stage)._trx_access_sets );
+         }
+
          finalize_block();
 
          auto& ab = std::get<assembled_block>(pending->_block_stage);
@@ -1831,6 +2079,53 @@ struct controller_impl {
       }
    } FC_CAPTURE_AND_RETHROW() } /// apply_block
 
+   void log_trx_parallelism( uint32_t block_num, const vector<transaction_access_set>& access_sets ) {
+      if( access_sets.empty() ) return;
+      const auto batches = schedule_conflict_free_batches( access_sets );
+      const uint32_t num_batches = *std::max_element( batches.begin(), batches.end() ) + 1;
+      dlog( "block ${n}: ${t} transactions could execute in ${b} conflict-free batches",
+            ("n", block_num)("t", access_sets.size())("b", num_batches) );
+   }
+
+   void prepare_block( const block_id_type& id, const signed_block_ptr& b ) {
+      if( conf.block_prepare_depth == 0 || conf.block_validation_mode == validation_mode::LIGHT ) return;
+      if( !b || b->transactions.empty() ) return;
+      // the authorizations of the transactions of a trusted producer are not checked, their keys are never needed
+      if( conf.trusted_producers.count( b->producer ) ) return;
+
+      std::lock_guard<std::mutex> g( prepared_blocks_mtx );
+      // keep the blocks closest to head prepared rather than evicting them for blocks further ahead
+      if( prepared_blocks.size() >= conf.block_prepare_depth || prepared_blocks.count( id ) ) return;
+
+      std::vector<packed_transaction_ptr> ptrxs;
+      ptrxs.reserve( b->transactions.size() );
+      for( const auto& receipt : b->transactions ) {
+         if( std::holds_alternative<packed_transaction>(receipt.trx) ) {
+            ptrxs.emplace_back( b, &std::get<packed_transaction>(receipt.trx) ); // alias signed_block_ptr
+         }
+      }
+      prepared_blocks.emplace( id, prepared_block{ b, transaction_metadata::start_recover_keys(
+            std::move( ptrxs ), thread_pool.get_executor(), chain_id, microseconds::maximum(), 2 * conf.thread_pool_size ) } );
+   }
+
+   /// remove the prepared state of block b if present, also discards prepared blocks that can no longer be applied
+   std::optional<prepared_block> take_prepared_block( const block_id_type& id, const signed_block_ptr& b ) {
+      std::lock_guard<std::mutex> g( prepared_blocks_mtx );
+      if( prepared_blocks.empty() ) return {};
+
+      std::optional<prepared_block> result;
+      auto itr = prepared_blocks.find( id );
+      if( itr != prepared_blocks.end() && itr->second.block == b ) {
+         result.emplace( std::move( itr->second ) );
+      }
+      const uint32_t block_num = b->block_num();
+      for( auto i = prepared_blocks.begin(); i != prepared_blocks.end(); ) {
+         if( i->second.block->block_num() <= block_num ) i = prepared_blocks.erase( i );
+         else ++i;
+      }
+      return result;
+   }
+
    std::future<block_state_ptr> create_block_state_future( const block_id_type& id, const signed_block_ptr& b ) {
       EOS_ASSERT( b, block_validate_exception, "null block" );
 
@@ -1876,7 +2171,11 @@ struct controller_impl {
          trusted_producer_light_validation = old_value;
       });
       try {
-         block_state_ptr bsp = block_state_future.get();
+         block_state_ptr bsp;
+         {
+            block_apply_metrics::scoped_timer t( block_metrics, block_apply_metrics::stage::header_validation );
+            bsp = block_state_future.get();
+         }
          const auto& b = bsp->block;
 
          if( conf.terminate_at_block > 0 && conf.terminate_at_block < b->block_num() ) {
@@ -1885,15 +2184,18 @@ struct controller_impl {
             return bsp;
          }
 
-         emit( self.pre_accepted_block, b );
+         emit_block_signal( self.pre_accepted_block, b );
 
-         fork_db.add( bsp );
+         {
+            block_apply_metrics::scoped_timer t( block_metrics, block_apply_metrics::stage::fork_database );
+            fork_db.add( bsp );
+         }
 
          if (self.is_trusted_producer(b->producer)) {
             trusted_producer_light_validation = true;
          };
 
-         emit( self.accepted_block_header, bsp );
+         emit_block_signal( self.accepted_block_header, bsp );
 
          if( read_mode != db_read_mode::IRREVERSIBLE ) {
             maybe_switch_forks( fork_db.pending_head(), s, forked_branch_cb, trx_lookup );
@@ -1922,7 +2224,7 @@ struct controller_impl {
             return;
          }
 
-         emit( self.pre_accepted_block, b );
+         emit_block_signal( self.pre_accepted_block, b );
          const bool skip_validate_signee = !conf.force_all_checks;
 
          auto bsp = std::make_shared<block_state>(
@@ -1940,7 +2242,7 @@ struct controller_impl {
             fork_db.add( bsp, true );
          }
 
-         emit( self.accepted_block_header, bsp );
+         emit_block_signal( self.accepted_block_header, bsp );
 
          if( s == controller::block_status::irreversible ) {
             apply_block( bsp, s, trx_meta_cache_lookup{} );
@@ -1948,7 +2250,7 @@ struct controller_impl {
 
             // On replay, log_irreversible is not called and so no irreversible_block signal is emitted.
             // So emit it explicitly here.
-            emit( self.irreversible_block, bsp );
+            emit_block_signal( self.irreversible_block, bsp );
 
             if (!self.skip_db_sessions(s)) {
                kv_db.commit(bsp->block_num);
@@ -1990,10 +2292,23 @@ struct controller_impl {
 
          auto branches = fork_db.fetch_branch_from( new_head->id, head->id );
 
+         // most transactions of the popped blocks are in the new branch as well, reuse their metadata and so their
+         // recovered keys instead of recovering them again
+         std::unordered_map<transaction_id_type, transaction_metadata_ptr> forked_trxs;
+         for( const auto& bsp : branches.second ) {
+            for( const auto& trx : bsp->trxs_metas() )
+               forked_trxs.emplace( trx->id(), trx );
+         }
+         const trx_meta_cache_lookup branch_trx_lookup = forked_trxs.empty() ? trx_lookup :
+            trx_meta_cache_lookup( [&forked_trxs, &trx_lookup]( const transaction_id_type& id ) {
+               auto itr = forked_trxs.find( id );
+               if( itr != forked_trxs.end() )
+                  return itr->second;
+               return trx_lookup ? trx_lookup( id ) : transaction_metadata_ptr{};
+            } );
+
          if( branches.second.size() > 0 ) {
-            for( auto itr = branches.second.begin(); itr != branches.second.end(); ++itr ) {
-               pop_block();
-            }
+            pop_blocks( branches.second.size() );
             EOS_ASSERT( self.head_block_id() == branches.second.back()->header.previous, fork_database_exception,
                      "loss of sync between fork_db and chainbase during fork switch" ); // _should_ never fail
 
@@ -2004,7 +2319,7 @@ struct controller_impl {
             auto except = std::exception_ptr{};
             try {
                apply_block( *ritr, (*ritr)->is_valid() ? controller::block_status::validated
-                                                       : controller::block_status::complete, trx_lookup );
+                                                       : controller::block_status::complete, branch_trx_lookup );
                fork_db.mark_valid( *ritr );
                head = *ritr;
             } catch ( const std::bad_alloc& ) {
@@ -2027,9 +2342,7 @@ struct controller_impl {
                // pop all blocks from the bad fork, discarding their transactions
                // ritr base is a forward itr to the last block successfully applied
                auto applied_itr = ritr.base();
-               for( auto itr = applied_itr; itr != branches.first.end(); ++itr ) {
-                  pop_block();
-               }
+               pop_blocks( std::distance( applied_itr, branches.first.end() ) );
                EOS_ASSERT( self.head_block_id() == branches.second.back()->header.previous, fork_database_exception,
                            "loss of sync between fork_db and chainbase during fork switch reversal" ); // _should_ never fail
 
@@ -2057,6 +2370,7 @@ struct controller_impl {
       if( pending ) {
          applied_trxs = pending->extract_trx_metas();
          pending.reset();
+         authorization.reset_lookup_cache();
          protocol_features.popped_blocks_to( head->block_num );
       }
       return applied_trxs;
@@ -2070,7 +2384,7 @@ struct controller_impl {
    }
 
    void update_producers_authority() {
-      const auto& producers = pending->get_pending_block_header_state().active_schedule.producers;
+      const auto& producers = pending->get_pending_block_header_state().active_schedule->producers;
 
       auto update_permission = [&]( auto& permission, auto threshold ) {
          auto auth = authority( threshold, {}, {});
@@ -2124,6 +2438,15 @@ struct controller_impl {
       }
    }
 
+   void load_trx_id_filter() {
+      trx_id_filter.clear();
+      const auto& dedupe_index = db.get_index<transaction_multi_index, by_expiration>();
+      for( const auto& t : dedupe_index ) {
+         trx_id_filter.insert( t.trx_id, t.expiration );
+      }
+      trx_id_filter_loaded = true;
+   }
+
    bool sender_avoids_whitelist_blacklist_enforcement( account_name sender )const {
       if( conf.sender_bypass_whiteblacklist.size() > 0 &&
           ( conf.sender_bypass_whiteblacklist.find( sender ) != conf.sender_bypass_whiteblacklist.end() ) )
@@ -2370,14 +2693,17 @@ void controller::add_indices() {
 }
 
 void controller::startup( std::function<void()> shutdown, std::function<bool()> check_shutdown, const snapshot_reader_ptr& snapshot ) {
+   startup_metrics::scoped_timer t( "controller.startup", my->startup_times );
    my->startup(shutdown, check_shutdown, snapshot);
 }
 
 void controller::startup( std::function<void()> shutdown, std::function<bool()> check_shutdown, const genesis_state& genesis ) {
+   startup_metrics::scoped_timer t( "controller.startup", my->startup_times );
    my->startup(shutdown, check_shutdown, genesis);
 }
 
 void controller::startup(std::function<void()> shutdown, std::function<bool()> check_shutdown) {
+   startup_metrics::scoped_timer t( "controller.startup", my->startup_times );
    my->startup(shutdown, check_shutdown);
 }
 
@@ -2601,6 +2927,10 @@ std::future<block_state_ptr> controller::create_block_state_future( const block_
    return my->create_block_state_future( id, b );
 }
 
+void controller::prepare_block( const block_id_type& id, const signed_block_ptr& b ) {
+   my->prepare_block( id, b );
+}
+
 block_state_ptr controller::push_block( std::future<block_state_ptr>& block_state_future,
                              const forked_branch_callback& forked_branch_cb, const trx_meta_cache_lookup& trx_lookup )
 {
@@ -2856,6 +3186,8 @@ sha256 controller::calculate_integrity_hash()const { try {
 
 void controller::write_snapshot( const snapshot_writer_ptr& snapshot ) const {
    EOS_ASSERT( !my->pending, block_validate_exception, "cannot take a consistent snapshot with a pending block" );
+   // the sections are packed on the chain thread pool while the main thread, which owns the state, waits here
+   snapshot->set_thread_pool( my->thread_pool.get_executor(), 2 * my->conf.thread_pool_size );
    return my->kv_db.add_to_snapshot(snapshot, *my->fork_db.head(), my->authorization, my->resource_limits);
 }
 
@@ -3034,6 +3366,28 @@ wasm_interface& controller::get_wasm_interface() {
    return my->wasmif;
 }
 
+abi_serializer_cache& controller::get_abi_serializer_cache()const {
+   return my->abi_cache;
+}
+
+const block_apply_metrics& controller::get_block_apply_metrics()const {
+   return my->block_metrics;
+}
+
+const startup_metrics& controller::get_startup_metrics()const {
+   return my->startup_times;
+}
+
+std::vector<subsystem_memory> controller::get_memory_usage()const {
+   std::vector<subsystem_memory> result;
+   result.push_back( my->fork_db.memory_usage() );
+   auto wasm = my->wasmif.memory_usage();
+   result.insert( result.end(), wasm.begin(), wasm.end() );
+   auto kv = my->kv_db.memory_usage();
+   result.insert( result.end(), kv.begin(), kv.end() );
+   return result;
+}
+
 const account_object& controller::get_account( account_name name )const
 { try {
    return my->db.get<account_object, by_name>(name);
@@ -3133,9 +3487,18 @@ bool controller::is_builtin_activated( builtin_protocol_feature_t f )const {
 }
 
 bool controller::is_known_unexpired_transaction( const transaction_id_type& id) const {
+   if( !my->trx_id_filter_loaded )
+      my->load_trx_id_filter();
+   if( !my->trx_id_filter.may_contain( id ) )
+      return false;
    return db().find<transaction_object, by_trx_id>(id);
 }
 
+void controller::record_transaction_id( const transaction_id_type& id, fc::time_point_sec expiration ) {
+   if( my->trx_id_filter_loaded )
+      my->trx_id_filter.insert( id, expiration );
+}
+
 void controller::set_subjective_cpu_leeway(fc::microseconds leeway) {
    my->subjective_cpu_leeway = leeway;
 }
@@ -3295,16 +3658,18 @@ void controller::replace_producer_keys( const public_key_type& key ) {
       gp.proposed_schedule.version = 0;
       gp.proposed_schedule.producers.clear();
    });
-   auto version = my->head->pending_schedule.schedule.version;
+   auto version = my->head->pending_schedule.schedule->version;
    my->head->pending_schedule = {};
-   my->head->pending_schedule.schedule.version = version;
-   for (auto& prod: my->head->active_schedule.producers ) {
+   my->head->pending_schedule.schedule = producer_authority_schedule( version, {} );
+   auto active_schedule = *my->head->active_schedule;
+   for (auto& prod: active_schedule.producers ) {
       ilog("${n}", ("n", prod.producer_name));
       std::visit([&](auto &auth) {
          auth.threshold = 1;
          auth.keys = {key_weight{key, 1}};
       }, prod.authority);
    }
+   my->head->active_schedule = std::move( active_schedule );
 }
 
 void controller::replace_account_keys( name account, name permission, const public_key_type& key ) {
@@ -3423,6 +3788,13 @@ void controller_impl::on_activation<builtin_protocol_feature_t::blockchain_param
    } );
 }
 
+template<>
+void controller_impl::on_activation<builtin_protocol_feature_t::batched_db_reads>() {
+   db.modify( db.get<protocol_state_object>(), [&]( auto& ps ) {
+      add_intrinsic_to_whitelist( ps.whitelisted_intrinsics, "db_get_batch_i64" );
+   } );
+}
+
 /// End of protocol feature activation handlers
 
 } } /// eosio::chain
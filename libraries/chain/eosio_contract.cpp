@@ -184,6 +184,9 @@ void apply_eosio_setcode(apply_context& context) {
             o.vm_type = act.vmtype;
             o.vm_version = act.vmversion;
          });
+         // compile new code ahead of its first execution, but not every historical contract during a replay
+         if( context.control.pending_block_time() > fc::time_point::now() - fc::minutes(5) )
+            context.control.get_wasm_interface().code_set(code_hash, act.vmtype, act.vmversion);
       }
    }
 
@@ -398,10 +401,12 @@ void apply_eosio_linkauth(apply_context& context) {
       if( link ) {
          EOS_ASSERT(link->required_permission != requirement.requirement, action_validate_exception,
                     "Attempting to update required authority, but new requirement is same as old");
+         context.control.get_authorization_manager().reset_lookup_cache( true );
          db.modify(*link, [requirement = requirement.requirement](permission_link_object& link) {
              link.required_permission = requirement;
          });
       } else {
+         context.control.get_authorization_manager().reset_lookup_cache( true );
          const auto& l =  db.create<permission_link_object>([&requirement](permission_link_object& link) {
             link.account = requirement.account;
             link.code = requirement.code;
@@ -447,6 +452,7 @@ void apply_eosio_unlinkauth(apply_context& context) {
       storage_usage_trace(context.get_action_id(), std::move(event_id), "auth_link", "remove", "unlinkauth")
    );
 
+   context.control.get_authorization_manager().reset_lookup_cache( true );
    db.remove(*link);
 }
 
@@ -36,7 +36,7 @@ namespace eosio { namespace chain {
       block_state_ptr,
       indexed_by<
          hashed_unique< tag<by_block_id>, member<block_header_state, block_id_type, &block_header_state::id>, std::hash<block_id_type>>,
-         ordered_non_unique< tag<by_prev>, const_mem_fun<block_header_state, const block_id_type&, &block_header_state::prev> >,
+         hashed_non_unique< tag<by_prev>, const_mem_fun<block_header_state, const block_id_type&, &block_header_state::prev>, std::hash<block_id_type>>,
          ordered_unique< tag<by_lib_block_num>,
             composite_key< block_state,
                global_fun<const block_state&,            bool,          &block_state_is_valid>,
@@ -70,6 +70,21 @@ namespace eosio { namespace chain {
       block_state_ptr       root; // Only uses the block_header_state portion
       block_state_ptr       head;
       fc::path              datadir;
+      uint64_t              block_bytes = 0; // estimated memory of the blocks in index, see memory_usage()
+
+      static uint64_t block_memory( const block_state_ptr& n ) {
+         return sizeof(block_state) + (n->block ? fc::raw::pack_size( *n->block ) : 0);
+      }
+
+      void erase( fork_multi_index_type::iterator itr ) {
+         block_bytes -= std::min( block_bytes, block_memory( *itr ) );
+         index.erase( itr );
+      }
+
+      void clear() {
+         index.clear();
+         block_bytes = 0;
+      }
 
       void add( const block_state_ptr& n,
                 bool ignore_duplicate, bool validate,
@@ -222,7 +237,7 @@ namespace eosio { namespace chain {
                ("filename", fork_db_dat.generic_string()) );
       }
 
-      my->index.clear();
+      my->clear();
    }
 
    fork_database::~fork_database() {
@@ -230,7 +245,7 @@ namespace eosio { namespace chain {
    }
 
    void fork_database::reset( const block_header_state& root_bhs ) {
-      my->index.clear();
+      my->clear();
       my->root = std::make_shared<block_state>();
       static_cast<block_header_state&>(*my->root) = root_bhs;
       my->root->validated = true;
@@ -268,7 +283,7 @@ namespace eosio { namespace chain {
 
       // The new root block should be erased from the fork database index individually rather than with the remove method,
       // because we do not want the blocks branching off of it to be removed from the fork database.
-      my->index.erase( my->index.find( id ) );
+      my->erase( my->index.find( id ) );
 
       // The other blocks to be removed are removed using the remove method so that orphaned branches do not remain in the fork database.
       for( const auto& block_id : blocks_to_remove ) {
@@ -326,6 +341,7 @@ namespace eosio { namespace chain {
          if( ignore_duplicate ) return;
          EOS_THROW( fork_database_exception, "duplicate block added", ("id", n->id) );
       }
+      block_bytes += block_memory( n );
 
       auto candidate = index.get<by_lib_block_num>().begin();
       if( (*candidate)->is_valid() ) {
@@ -358,9 +374,18 @@ namespace eosio { namespace chain {
       return my->head;
    }
 
+   subsystem_memory fork_database::memory_usage()const {
+      return { "fork_database", my->block_bytes, my->index.size() };
+   }
+
    branch_type fork_database::fetch_branch( const block_id_type& h, uint32_t trim_after_block_num )const {
       branch_type result;
-      for( auto s = get_block(h); s; s = get_block( s->header.previous ) ) {
+      auto s = get_block(h);
+      if( s ) {
+         // the branch holds one block per block number above the root
+         result.reserve( std::min( s->block_num, trim_after_block_num ) - std::min( my->root->block_num, trim_after_block_num ) );
+      }
+      for( ; s; s = get_block( s->header.previous ) ) {
          if( s->block_num <= trim_after_block_num )
              result.push_back( s );
       }
@@ -372,6 +397,9 @@ namespace eosio { namespace chain {
       for( auto s = get_block(h); s; s = get_block( s->header.previous ) ) {
          if( s->block_num == block_num )
              return s;
+         // block numbers decrease along the branch, there is no need to walk the rest of it down to the root
+         if( s->block_num < block_num )
+             break;
       }
 
       return {};
@@ -450,17 +478,16 @@ namespace eosio { namespace chain {
          EOS_ASSERT( remove_queue[i] != head_id, fork_database_exception,
                      "removing the block and its descendants would remove the current head block" );
 
-         auto previtr = previdx.lower_bound( remove_queue[i] );
-         while( previtr != previdx.end() && (*previtr)->header.previous == remove_queue[i] ) {
+         auto [previtr, prevend] = previdx.equal_range( remove_queue[i] );
+         for( ; previtr != prevend; ++previtr ) {
             remove_queue.push_back( (*previtr)->id );
-            ++previtr;
          }
       }
 
       for( const auto& block_id : remove_queue ) {
          auto itr = my->index.find( block_id );
          if( itr != my->index.end() )
-            my->index.erase(itr);
+            my->erase(itr);
       }
    }
 
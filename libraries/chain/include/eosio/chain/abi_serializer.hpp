@@ -35,6 +35,10 @@ struct abi_serializer {
 
    abi_serializer(){ configure_built_in_types(); }
    abi_serializer( const abi_def& abi, const yield_function_t& yield );
+   abi_serializer( const abi_serializer& other ) { *this = other; }
+   abi_serializer( abi_serializer&& other ) = default;
+   abi_serializer& operator=( const abi_serializer& other );
+   abi_serializer& operator=( abi_serializer&& other ) = default;
    void set_abi( const abi_def& abi, const yield_function_t& yield );
 
    /// @return string_view of `t` or internal string type
@@ -63,6 +67,10 @@ struct abi_serializer {
    fc::variant binary_to_variant( const std::string_view& type, const bytes& binary, const yield_function_t& yield, bool short_path = false )const;
    fc::variant binary_to_variant( const std::string_view& type, fc::datastream<const char*>& binary, const yield_function_t& yield, bool short_path = false )const;
 
+   /// Same as fc::json::to_string( binary_to_variant(...) ) but writes the JSON while unpacking, without building an fc::variant tree
+   std::string binary_to_json( const std::string_view& type, const bytes& binary, const yield_function_t& yield, bool short_path = false )const;
+   void        binary_to_json( const std::string_view& type, fc::datastream<const char*>& binary, std::string& out, const yield_function_t& yield, bool short_path = false )const;
+
    bytes       variant_to_binary( const std::string_view& type, const fc::variant& var, const yield_function_t& yield, bool short_path = false )const;
    void        variant_to_binary( const std::string_view& type, const fc::variant& var, fc::datastream<char*>& ds, const yield_function_t& yield, bool short_path = false )const;
 
@@ -128,10 +136,41 @@ private:
    map<type_name, pair<unpack_function, pack_function>, std::less<>> built_in_types;
    void configure_built_in_types();
 
+   /// writes a built-in value as JSON straight from the stream, the same JSON fc::json writes for its fc::variant
+   using to_json_function = void (*)( fc::datastream<const char*>&, std::string& );
+   map<type_name, to_json_function, std::less<>> built_in_json;
+
+   /// what a type name refers to, resolved once per ABI instead of once per value (un)packed
+   struct resolved_type {
+      std::string_view                                                        rtype; ///< typedefs resolved
+      std::string_view                                                        ftype; ///< fundamental type of rtype
+      bool                                                                    array    = false;
+      bool                                                                    optional = false;
+      const pair<unpack_function, pack_function>*                             built_in = nullptr;
+      to_json_function                                                        built_in_to_json = nullptr;
+      std::optional<map<type_name, variant_def, std::less<>>::const_iterator> variant_itr;
+      std::optional<map<type_name, struct_def, std::less<>>::const_iterator>  struct_itr;
+      const kv_table_def*                                                     kv_table = nullptr;
+   };
+
+   /// every type name of the ABI and the built-in types; the iterators and pointers refer to the maps above, which
+   /// keep their nodes when moved, so copies have to rebuild it
+   map<type_name, resolved_type, std::less<>> resolved_types;
+   void compile_types();
+   resolved_type make_resolved_type( const std::string_view& type )const;
+   /// @return the resolved type, from resolved_types or else resolved into scratch
+   const resolved_type& get_resolved_type( const std::string_view& type, resolved_type& scratch )const;
+
    fc::variant _binary_to_variant( const std::string_view& type, const bytes& binary, impl::binary_to_variant_context& ctx )const;
    fc::variant _binary_to_variant( const std::string_view& type, fc::datastream<const char*>& binary, impl::binary_to_variant_context& ctx )const;
    void        _binary_to_variant( const std::string_view& type, fc::datastream<const char*>& stream,
                                    fc::mutable_variant_object& obj, impl::binary_to_variant_context& ctx )const;
+   void        _binary_to_json( const std::string_view& type, fc::datastream<const char*>& stream,
+                                std::string& out, impl::binary_to_variant_context& ctx )const;
+   /// @param fields name and range in out of the value of each field written for the object
+   void        _binary_to_json( const std::string_view& type, fc::datastream<const char*>& stream, std::string& out,
+                                std::vector<std::tuple<std::string_view, size_t, size_t>>& fields,
+                                impl::binary_to_variant_context& ctx )const;
 
    bytes       _variant_to_binary( const std::string_view& type, const fc::variant& var, impl::variant_to_binary_context& ctx )const;
    void        _variant_to_binary( const std::string_view& type, const fc::variant& var,
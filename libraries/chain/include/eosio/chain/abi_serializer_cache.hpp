@@ -0,0 +1,56 @@
+#pragma once
+
+#include <eosio/chain/abi_serializer.hpp>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace chainbase {
+   class database;
+}
+
+namespace eosio { namespace chain {
+
+   /**
+    * The parsed ABIs of the accounts, shared by everything which turns action data and table rows into variants and
+    * back, so an ABI is parsed once per setabi instead of once per request.
+    *
+    * An entry is keyed by account and holds the abi_sequence and the bytes of the ABI it was parsed from; a lookup
+    * which finds another sequence or other bytes (a setabi, possibly on another fork) parses the ABI again. Serializers
+    * are immutable and stay valid for as long as anyone holds them, so they can be used without holding the cache.
+    */
+   class abi_serializer_cache {
+    public:
+      static constexpr size_t default_max_entries = 1024;
+
+      explicit abi_serializer_cache( size_t max_entries = default_max_entries )
+      : max_entries(max_entries) {}
+
+      /// @return the serializer of the ABI of account n, or nullptr if n does not exist or has no ABI
+      /// @throws if the ABI of n cannot be parsed within the deadline of yield
+      std::shared_ptr<const abi_serializer> get( const chainbase::database& db, account_name n,
+                                                 const abi_serializer::yield_function_t& yield );
+
+      /// drop all entries, e.g. when the state they were parsed from is replaced
+      void clear();
+
+      size_t size() const;
+
+    private:
+      struct entry {
+         uint64_t                                 abi_sequence = 0;
+         std::string                              abi;
+         std::shared_ptr<const abi_serializer>    serializer;
+         std::list<account_name>::iterator        lru_itr;
+      };
+
+      const size_t                           max_entries;
+      mutable std::mutex                     mtx;
+      std::map<account_name, entry>          entries;
+      std::list<account_name>                lru; ///< most recently used first
+   };
+
+} } // eosio::chain
@@ -18,6 +18,25 @@ namespace eosio { namespace chain {
 class controller;
 class transaction_context;
 
+/**
+ * Containers an apply_context fills while it runs. They are recycled through a per-thread free list, so that nested
+ * and subsequent actions (including those of later transactions) reuse the capacity instead of reallocating it.
+ */
+struct apply_context_scratch {
+   vector< std::pair<account_name, uint32_t> > notified;
+   vector<uint32_t>                           inline_actions;
+   vector<uint32_t>                           cfa_inline_actions;
+
+   /// returns the scratch to the free list of the calling thread
+   struct deleter {
+      void operator()( apply_context_scratch* s )const;
+   };
+   using ptr = std::unique_ptr<apply_context_scratch, deleter>;
+
+   /// not thread safe in the sense that the returned scratch must be released on the same thread
+   static ptr acquire();
+};
+
 class apply_context {
    public:
       template<typename ObjectType,
@@ -478,6 +497,7 @@ class apply_context {
       uint32_t                      action_ordinal = 0;
       bool                          privileged   = false;
       bool                          context_free = false;
+      apply_context_scratch::ptr    _scratch; ///< must be declared before the references into it below
 
    public:
       std::vector<char>             action_return_value;
@@ -494,9 +514,12 @@ class apply_context {
    private:
 
       backing_store::db_chainbase_iter_store<key_value_object> db_iter_store;
-      vector< std::pair<account_name, uint32_t> >              _notified; ///< keeps track of new accounts to be notifed of current message
-      vector<uint32_t>                                         _inline_actions; ///< action_ordinals of queued inline actions
-      vector<uint32_t>                                         _cfa_inline_actions; ///< action_ordinals of queued inline context-free actions
+      /// table lookups of this action by (code, scope, table), nullptr for tables known not to exist;
+      /// tables are only created and removed through this context so entries never go stale
+      flat_map<std::tuple<name, name, name>, const table_id_object*> _table_lookups;
+      vector< std::pair<account_name, uint32_t> >&             _notified; ///< keeps track of new accounts to be notifed of current message
+      vector<uint32_t>&                                        _inline_actions; ///< action_ordinals of queued inline actions
+      vector<uint32_t>&                                        _cfa_inline_actions; ///< action_ordinals of queued inline context-free actions
       std::string                                              _pending_console_output;
       flat_set<account_delta>                                  _account_ram_deltas; ///< flat_set of account_delta so json is an array of objects
 
@@ -37,6 +37,12 @@ struct asset : fc::reflect_init
    static asset from_string(const string& from);
    string       to_string()const;
 
+   /// sign, up to 20 digits, decimal point, space and symbol name
+   static constexpr size_t max_string_size = 1 + 20 + 1 + 1 + symbol::max_name_size;
+
+   /// write the string form of the asset to buf which holds at least max_string_size chars, @return the number of chars written
+   size_t write_as_string(char* buf)const;
+
    asset& operator += (const asset& o)
    {
       EOS_ASSERT(get_symbol() == o.get_symbol(), asset_type_exception, "addition between two different asset is not allowed");
@@ -39,6 +39,7 @@ namespace detail {
          vector<public_key_type>              provided_keys; // Making this a flat_set<public_key_type> causes runtime problems with utilities::filter_data_by_marker for some reason. TODO: Figure out why.
          flat_set<permission_level>           provided_permissions;
          vector<bool>                         _used_keys;
+         vector<uint32_t>                     _newly_used_keys; // indices of _used_keys set in the authorities being evaluated, in order
          fc::microseconds                     provided_delay;
          uint16_t                             recursion_depth_limit;
 
@@ -59,6 +60,7 @@ namespace detail {
          ,recursion_depth_limit(recursion_depth_limit)
          {
             EOS_ASSERT( static_cast<bool>(checktime), authorization_exception, "checktime cannot be empty" );
+            _newly_used_keys.reserve( _used_keys.size() );
          }
 
          enum permission_cache_status {
@@ -154,9 +156,12 @@ namespace detail {
 
          template<typename AuthorityType>
          bool satisfied( const AuthorityType& authority, permission_cache_type& cached_permissions, uint16_t depth ) {
-            // Save the current used keys; if we do not satisfy this authority, the newly used keys aren't actually used
-            auto KeyReverter = fc::make_scoped_exit([this, keys = _used_keys] () mutable {
-               _used_keys = keys;
+            // If we do not satisfy this authority, the keys it newly used aren't actually used; only those are reverted
+            // instead of saving a copy of all used keys for every nested authority
+            auto KeyReverter = fc::make_scoped_exit([this, mark = _newly_used_keys.size()] () {
+               for( auto i = mark; i < _newly_used_keys.size(); ++i )
+                  _used_keys[_newly_used_keys[i]] = false;
+               _newly_used_keys.resize( mark );
             });
 
             // Sort key permissions and account permissions together into a single set of meta_permissions
@@ -212,7 +217,11 @@ namespace detail {
             uint32_t operator()(const KeyWeight& permission) {
                auto itr = boost::range::find( checker.provided_keys, permission.key );
                if( itr != checker.provided_keys.end() ) {
-                  checker._used_keys[itr - checker.provided_keys.begin()] = true;
+                  const uint32_t i = itr - checker.provided_keys.begin();
+                  if( !checker._used_keys[i] ) {
+                     checker._used_keys[i] = true;
+                     checker._newly_used_keys.push_back( i );
+                  }
                   total_weight += permission.weight;
                }
                return total_weight;
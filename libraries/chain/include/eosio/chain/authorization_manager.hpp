@@ -6,6 +6,7 @@
 
 #include <utility>
 #include <functional>
+#include <tuple>
 
 namespace eosio { namespace chain {
 
@@ -114,12 +115,35 @@ namespace eosio { namespace chain {
                                                     )const;
 
 
+         /**
+          *  @brief Drop all cached permission and permission link lookups
+          *
+          *  The lookup cache is scoped to a block: it is reset when a block starts, aborts or is popped. Any change to a
+          *  permission or permission link also resets it and disables caching for the remainder of the block, so that
+          *  cached entries never have to survive an undo of the state they were read from.
+          *
+          *  @param disable - true if lookups should bypass the cache until the next block starts
+          */
+         void reset_lookup_cache( bool disable = false )const;
+
          static std::function<void()> _noop_checktime;
 
       private:
          const controller&    _control;
          chainbase::database& _db;
 
+         using link_key_type = std::tuple<account_name, scope_name, action_name>;
+
+         struct lookup_cache {
+            map<permission_level, const permission_object*>   permissions;
+            map<link_key_type, std::optional<permission_name>> links;
+            bool                                               disabled = false;
+         };
+
+         mutable lookup_cache _lookup_cache;
+
+         const permission_object& get_cached_permission( const permission_level& level )const;
+
          void             check_updateauth_authorization( const updateauth& update, const vector<permission_level>& auths )const;
          void             check_deleteauth_authorization( const deleteauth& del, const vector<permission_level>& auths )const;
          void             check_linkauth_authorization( const linkauth& link, const vector<permission_level>& auths )const;
@@ -3,20 +3,13 @@
 #include <eosio/chain/name.hpp>
 #include <memory>
 #include <stdint.h>
+#include <b1/session/session_fwd.hpp>
 
 namespace chainbase {
    class database;
 }
 
 namespace eosio {
-   namespace session {
-      struct rocksdb_t;
-      template<typename Parent>
-      class session;
-
-      template <typename... T>
-      class session_variant;
-   }
 namespace chain {
 
       class apply_context;
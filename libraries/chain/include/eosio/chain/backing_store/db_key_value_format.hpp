@@ -5,6 +5,7 @@
 #include <eosio/chain/exceptions.hpp>
 #include <eosio/chain/types.hpp>
 #include <b1/session/shared_bytes.hpp>
+#include <array>
 #include <memory>
 #include <stdint.h>
 
@@ -209,20 +210,10 @@ namespace chain { namespace backing_store { namespace db_key_value_format {
 
       template<typename Key, typename CharKey>
       void extract_trailing_primary_and_secondary_keys(const CharKey& key, uint64_t& primary_key, Key& sec_key) {
+         // sizes validated by the caller, decoded in place
          const auto key_offsets = locate_trailing_primary_and_secondary_keys<Key>(key);
-         const auto keys_sizes = key_offsets.first.size() + key_offsets.second.size();
-         const auto start_offset = key_offsets.first.data();
-         const b1::chain_kv::bytes composite_trailing_prim_sec_key {start_offset, start_offset + keys_sizes};
-         auto composite_loc = composite_trailing_prim_sec_key.cbegin();
-         EOS_ASSERT(b1::chain_kv::extract_key(composite_loc, composite_trailing_prim_sec_key.cend(), primary_key), bad_composite_key_exception,
-                    "DB intrinsic key-value store invariant has changed, extract_key should only fail if the remaining "
-                    "string size is less than the sizeof(uint64_t)");
-         EOS_ASSERT(b1::chain_kv::extract_key(composite_loc, composite_trailing_prim_sec_key.cend(), sec_key), bad_composite_key_exception,
-                    "DB intrinsic key-value store invariant has changed, extract_key should only fail if the remaining "
-                    "string size is less than: ${s} bytes, which was already verified", ("s", key_offsets.second.size()));
-         EOS_ASSERT(composite_loc == composite_trailing_prim_sec_key.cend(), bad_composite_key_exception,
-                    "DB intrinsic key-value store invariant has changed, calls to extract the pimary and secondary "
-                    "keys should have resulted in the passed in buffer being consumed fully");
+         primary_key = read_key<uint64_t>(key_offsets.first.data());
+         sec_key = read_key<Key>(key_offsets.second.data());
       }
 
       template<std::size_t N, typename CharKey>
@@ -242,6 +233,73 @@ namespace chain { namespace backing_store { namespace db_key_value_format {
             return key_data;
          }
       }
+
+      /// the db type prefix of the full keys of contract tables
+      char contract_db_type();
+
+      /**
+       * Encodes a full key (db type, contract, scope, table, type and the trailing keys) in a fixed buffer on the
+       * stack, so that the only allocation is the one of the shared_bytes returned.  Produces the same bytes as
+       * create_full_key applied to the composite keys created below.
+       */
+      class full_key_builder {
+      public:
+         static constexpr std::size_t max_size = prefix_size<eosio::session::shared_bytes>() + sizeof(key_type) * 2 +
+                                                 sizeof(uint64_t) + sizeof(key256_t);
+
+         full_key_builder(name code, name scope, name table) {
+            data[size++] = contract_db_type();
+            append_key(code.to_uint64_t());
+            append_key(scope.to_uint64_t());
+            append_key(table.to_uint64_t());
+         }
+
+         full_key_builder& append_type(key_type kt) {
+            data[size++] = static_cast<char>(kt);
+            return *this;
+         }
+
+         /// big-endian, as b1::chain_kv::append_key
+         template<typename Key>
+         full_key_builder& append_key(const Key& key) {
+            if constexpr (std::is_same_v<Key, key256_t>) {
+               append_uint(key[0]);
+               append_uint(key[1]);
+            } else if constexpr (std::is_same_v<Key, float64_t>) {
+               append_uint(b1::chain_kv::detail::float_to_key<uint64_t>(key));
+            } else if constexpr (std::is_same_v<Key, float128_t>) {
+               append_uint(b1::chain_kv::detail::float_to_key<eosio::chain::uint128_t>(key));
+            } else {
+               static_assert(std::is_same_v<Key, uint64_t> || std::is_same_v<Key, eosio::chain::uint128_t>);
+               append_uint(key);
+            }
+            return *this;
+         }
+
+         eosio::session::shared_bytes finish() const { return eosio::session::shared_bytes(data.data(), size); }
+
+      private:
+         template<typename UInt>
+         void append_uint(UInt value) {
+            for (std::size_t i = sizeof(UInt); i > 0; --i) {
+               data[size + i - 1] = static_cast<char>(value & 0xff);
+               value >>= 8;
+            }
+            size += sizeof(UInt);
+         }
+
+         std::array<char, max_size> data;
+         std::size_t                size = 0;
+      };
+
+      /// decode the big-endian key at the start of key_data, which has been checked to be at least sizeof(Key) long
+      template<typename Key>
+      Key read_key(const char* key_data) {
+         Key key;
+         auto loc = key_data;
+         b1::chain_kv::extract_key(loc, key_data + sizeof(Key), key);
+         return key;
+      }
    }
 
    template<typename Key>
@@ -354,15 +412,9 @@ namespace chain { namespace backing_store { namespace db_key_value_format {
       if (comp != 0) {
          return false;
       }
-      auto start_offset = full_key.data() + sec_type_prefix_size;
-      const b1::chain_kv::bytes composite_trailing_sec_prim_key {start_offset, start_offset + keys_size};
-      auto composite_loc = composite_trailing_sec_prim_key.cbegin();
-      EOS_ASSERT(b1::chain_kv::extract_key(composite_loc, composite_trailing_sec_prim_key.cend(), sec_key), bad_composite_key_exception,
-                 "DB intrinsic key-value store invariant has changed, extract_key should only fail if the remaining "
-                 "string size is less than: ${s} bytes, which was already verified", ("s", keys_size));
-      EOS_ASSERT(b1::chain_kv::extract_key(composite_loc, composite_trailing_sec_prim_key.cend(), primary_key), bad_composite_key_exception,
-                 "DB intrinsic key-value store invariant has changed, extract_key should only fail if the remaining "
-                 "string size is less than the sizeof(uint64_t)");
+      const auto start_offset = full_key.data() + sec_type_prefix_size;
+      sec_key = detail::read_key<Key>(start_offset);
+      primary_key = detail::read_key<uint64_t>(start_offset + sizeof(sec_key));
       return true;
    }
 
@@ -449,13 +501,8 @@ namespace chain { namespace backing_store { namespace db_key_value_format {
       if (!detail::verify_primary_to_sec_type<Key>(full_key, sec_type_trailing_prefix)) {
          return false;
       }
-      const auto key_size = sizeof(Key);
-      auto start_offset = full_key.data() + sec_type_trailing_prefix_size;
-      const b1::chain_kv::bytes composite_trailing_prim_sec_key {start_offset, start_offset + key_size};
-      auto composite_loc = composite_trailing_prim_sec_key.cbegin();
-      EOS_ASSERT(b1::chain_kv::extract_key(composite_loc, composite_trailing_prim_sec_key.cend(), sec_key), bad_composite_key_exception,
-                 "DB intrinsic key-value store invariant has changed, extract_key should only fail if the remaining "
-                 "string size is less than: ${s} bytes, which was already verified", ("s", key_size));
+      // the size of full_key was checked by verify_primary_to_sec_type
+      sec_key = detail::read_key<Key>(full_key.data() + sec_type_trailing_prefix_size);
       return true;
    }
 
@@ -554,12 +601,7 @@ namespace chain { namespace backing_store { namespace db_key_value_format {
                  "DB intrinsic key-value get_primary_key was passed a key that was the wrong type: ${type},"
                  " it should have been of type: ${type2}",
                  ("type", detail::to_string(actual_kt))("type2", detail::to_string(key_type::primary)));
-      auto start_offset = full_key.data() + type_prefix_size;
-      const b1::chain_kv::bytes composite_trailing_prim_key {start_offset, start_offset + key_size};
-      auto composite_loc = composite_trailing_prim_key.cbegin();
-      EOS_ASSERT(b1::chain_kv::extract_key(composite_loc, composite_trailing_prim_key.cend(), primary_key), bad_composite_key_exception,
-                 "DB intrinsic key-value get_primary_key invariant has changed, extract_key should only fail if the "
-                 "remaining string size is less than the sizeof(uint64_t)");
+      primary_key = detail::read_key<uint64_t>(full_key.data() + type_prefix_size);
       return true;
    }
 
@@ -568,14 +610,14 @@ namespace chain { namespace backing_store { namespace db_key_value_format {
 
    template<typename Key>
    eosio::session::shared_bytes create_full_secondary_key(name code, name scope, name table, const Key& sec_key, uint64_t primary_key) {
-      bytes composite_key = create_secondary_key(scope, table, sec_key, primary_key);
-      return create_full_key(composite_key, code);
+      return detail::full_key_builder(code, scope, table).append_type(detail::determine_sec_type<Key>::kt)
+                                                         .append_key(sec_key).append_key(primary_key).finish();
    }
 
    template<typename Key>
    eosio::session::shared_bytes create_full_prefix_secondary_key(name code, name scope, name table, const Key& sec_key) {
-      bytes composite_key = create_prefix_secondary_key(scope, table, sec_key);
-      return create_full_key(composite_key, code);
+      return detail::full_key_builder(code, scope, table).append_type(detail::determine_sec_type<Key>::kt)
+                                                         .append_key(sec_key).finish();
    }
 
 }}}} // ns eosio::chain::backing_store::db_key_value_format
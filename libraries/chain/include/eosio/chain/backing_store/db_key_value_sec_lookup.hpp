@@ -235,7 +235,9 @@ namespace eosio { namespace chain { namespace backing_store {
             return table_ei;
          }
 
-         const auto full_slice = db_key_value_format::extract_legacy_slice((*session_iter).first);
+         // keep the key alive, short keys are held in the returned pair itself
+         const shared_bytes found_key = (*session_iter).first;
+         const auto full_slice = db_key_value_format::extract_legacy_slice(found_key);
          const auto prefix_secondary_slice = db_key_value_format::extract_legacy_slice(secondary_key.full_key);
          const bool valid_key = db_key_value_format::get_trailing_primary_key(full_slice, prefix_secondary_slice, primary);
          EOS_ASSERT( valid_key, db_rocksdb_invalid_operation_exception,
@@ -279,6 +281,7 @@ namespace eosio { namespace chain { namespace backing_store {
          EOS_ASSERT( valid_key, db_rocksdb_invalid_operation_exception,
                      "invariant failure in db_${d}_next_secondary, since the type slice matched, the trailing "
                      "primary key should have been extracted", ("d", helper.desc()));
+         prefetch_primaries(session_iter, secondary_key.prefix_key, table);
 
          return iter_store.add({ .table_ei = key_store.table_ei, .secondary = secondary, .primary = primary,
                                  .payer = payer_payload(*(*session_iter).second).payer });
@@ -595,6 +598,7 @@ namespace eosio { namespace chain { namespace backing_store {
          // setting primary 1st and secondary 2nd to maintain the same results as chainbase
          primary = primary_ret;
          secondary = secondary_ret;
+         prefetch_primaries(session_iter, type_prefix, t);
 
          return iter_store.add({ .table_ei = table_ei, .secondary = secondary_ret, .primary = primary_ret,
                                  .payer = payer_payload(*(*session_iter).second).payer });
@@ -631,9 +635,39 @@ namespace eosio { namespace chain { namespace backing_store {
                                  .payer = std::move(std::get<fk_index::payer>(*found_keys))});
       }
 
+      // Secondary index scans usually fetch the primary row of each entry they pass.  Once a scan gets past the entries
+      // whose primary rows were read ahead, the primary rows of the next entries are read with one batch read.
+      void prefetch_primaries(session_variant_type::iterator session_iter, const shared_bytes& type_prefix,
+                              const unique_table& table) {
+         const shared_bytes key = (*session_iter).first;
+         if (prefetched_begin && prefetched_begin <= key && key < prefetched_end) {
+            return;
+         }
+
+         std::vector<shared_bytes> primary_keys;
+         primary_keys.reserve(primary_prefetch_size);
+         for (size_t i = 0; i < primary_prefetch_size && match_prefix(type_prefix, session_iter); ++i, ++session_iter) {
+            SecondaryKey secondary;
+            uint64_t primary;
+            if (!db_key_value_format::get_trailing_sec_prim_keys((*session_iter).first, type_prefix, secondary, primary)) {
+               break;
+            }
+            primary_keys.emplace_back(db_key_value_format::create_full_key(
+                  db_key_value_format::create_primary_key(table.scope, table.table, primary), table.contract));
+         }
+         prefetched_begin = key;
+         prefetched_end = match_prefix(type_prefix, session_iter) ? (*session_iter).first : type_prefix.next();
+         current_session.prefetch(primary_keys);
+      }
+
       db_key_value_iter_store<SecondaryKey> iter_store;
       using iter_obj = typename db_key_value_iter_store<SecondaryKey>::secondary_obj_type;
       secondary_helper<SecondaryKey> helper;
+      // number of secondary index entries whose primary rows are read ahead of a scan
+      static constexpr size_t primary_prefetch_size = 16;
+      // range of secondary keys whose primary rows were last read ahead
+      shared_bytes prefetched_begin;
+      shared_bytes prefetched_end;
    };
 
 }}} // ns eosio::chain::backing_store
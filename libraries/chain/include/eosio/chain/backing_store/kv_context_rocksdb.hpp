@@ -350,7 +350,7 @@ namespace eosio { namespace chain {
          try {
             try {
                auto composite_key = make_composite_key(contract, nullptr, 0, key, key_size);
-               const auto old_value = session->read(composite_key);
+               old_value          = session->read(composite_key);
                if (!old_value)
                   return 0;
                pp = backing_store::payer_payload(*old_value);
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <fc/time.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace eosio { namespace chain {
+
+   struct block_stage_latency {
+      std::string             stage;
+      std::vector<uint64_t>   bucket_bounds_us; ///< inclusive upper bound of each bucket except the last which is unbounded
+      std::vector<uint64_t>   counts;           ///< one more than bucket_bounds_us
+      uint64_t                total_us = 0;
+   };
+
+   /**
+    * Latency histograms of the stages blocks go through in the controller, so a regression of block times can be
+    * traced to the stage it comes from. apply_block contains start_block through commit_block, and the handlers of the
+    * block signals are counted in signals as well as in the stage which emits them. recover_keys is the time spent
+    * waiting for keys recovered on the thread pool and is not part of transactions.
+    *
+    * Recording is a few relaxed atomic increments; thread safe.
+    */
+   class block_apply_metrics {
+    public:
+      enum class stage {
+         header_validation, ///< waiting for the block state of a received block, validated on the thread pool
+         fork_database,     ///< adding a received block to the fork database
+         start_block,       ///< starting the pending block of a received block, including onblock
+         recover_keys,      ///< waiting for the recovered keys of the transactions of a received block
+         transactions,      ///< executing the transactions of a received block
+         finalize_block,    ///< resource limits, merkle roots and the block header
+         commit_block,      ///< fork database, reversible blocks and irreversibility of a completed block
+         signals,           ///< handlers of pre_accepted_block, accepted_block_header, accepted_block and irreversible_block
+         apply_block,       ///< all of applying a received block, start_block through commit_block
+         num_stages
+      };
+
+      void record( stage s, fc::microseconds d );
+
+      std::vector<block_stage_latency> snapshot() const;
+
+      /// records the time from construction to destruction, including when unwinding
+      class scoped_timer {
+       public:
+         scoped_timer( block_apply_metrics& m, stage s )
+         : metrics(m), s(s), start(fc::time_point::now()) {}
+         ~scoped_timer() { metrics.record( s, fc::time_point::now() - start ); }
+
+         scoped_timer( const scoped_timer& ) = delete;
+         scoped_timer& operator=( const scoped_timer& ) = delete;
+
+       private:
+         block_apply_metrics& metrics;
+         const stage          s;
+         const fc::time_point start;
+      };
+
+    private:
+      static constexpr std::array<uint64_t, 14> bounds_us = { 50, 100, 250, 500, 1'000, 2'500, 5'000, 10'000, 25'000,
+                                                              50'000, 100'000, 250'000, 500'000, 1'000'000 };
+      struct histogram {
+         std::array<std::atomic<uint64_t>, bounds_us.size() + 1> counts{};
+         std::atomic<uint64_t>                                   total_us{0};
+      };
+
+      std::array<histogram, static_cast<size_t>(stage::num_stages)> histograms;
+   };
+
+} } // eosio::chain
+
+FC_REFLECT( eosio::chain::block_stage_latency, (stage)(bucket_bounds_us)(counts)(total_us) )
@@ -47,12 +47,59 @@ using signer_callback_type = std::function<std::vector<signature_type>(const dig
 
 struct block_header_state;
 
+/**
+ *  An immutable producer schedule shared by the consecutive block header states that do not change it, which
+ *  avoids copying the schedule into the state of every block. Assigning a schedule replaces it for this state only.
+ */
+class producer_schedule_ref {
+public:
+   producer_schedule_ref() : schedule( empty_schedule() ) {}
+   producer_schedule_ref( producer_authority_schedule s )
+   :schedule( std::make_shared<const producer_authority_schedule>( std::move(s) ) )
+   {}
+
+   // copies only, a moved from schedule would be null
+   producer_schedule_ref( const producer_schedule_ref& ) = default;
+   producer_schedule_ref& operator=( const producer_schedule_ref& ) = default;
+
+   const producer_authority_schedule& operator*()const { return *schedule; }
+   const producer_authority_schedule* operator->()const { return schedule.get(); }
+   operator const producer_authority_schedule&()const { return *schedule; }
+
+   friend bool operator==( const producer_schedule_ref& lhs, const producer_schedule_ref& rhs ) {
+      return lhs.schedule == rhs.schedule || *lhs.schedule == *rhs.schedule;
+   }
+   friend bool operator!=( const producer_schedule_ref& lhs, const producer_schedule_ref& rhs ) { return !(lhs == rhs); }
+
+   template<typename DataStream>
+   friend DataStream& operator<<( DataStream& ds, const producer_schedule_ref& s ) {
+      fc::raw::pack( ds, *s.schedule );
+      return ds;
+   }
+
+   template<typename DataStream>
+   friend DataStream& operator>>( DataStream& ds, producer_schedule_ref& s ) {
+      producer_authority_schedule schedule;
+      fc::raw::unpack( ds, schedule );
+      s = std::move( schedule );
+      return ds;
+   }
+
+private:
+   static const std::shared_ptr<const producer_authority_schedule>& empty_schedule() {
+      static const auto empty = std::make_shared<const producer_authority_schedule>();
+      return empty;
+   }
+
+   std::shared_ptr<const producer_authority_schedule> schedule;
+};
+
 namespace detail {
    struct block_header_state_common {
       uint32_t                          block_num = 0;
       uint32_t                          dpos_proposed_irreversible_blocknum = 0;
       uint32_t                          dpos_irreversible_blocknum = 0;
-      producer_authority_schedule       active_schedule;
+      producer_schedule_ref             active_schedule;
       incremental_merkle                blockroot_merkle;
       flat_map<account_name,uint32_t>   producer_to_last_produced;
       flat_map<account_name,uint32_t>   producer_to_last_implied_irb;
@@ -63,7 +110,7 @@ namespace detail {
    struct schedule_info {
       uint32_t                          schedule_lib_num = 0; /// last irr block num
       digest_type                       schedule_hash;
-      producer_authority_schedule       schedule;
+      producer_schedule_ref             schedule;
    };
 
    bool is_builtin_activated( const protocol_feature_activation_set_ptr& pfa,
@@ -143,7 +190,7 @@ struct block_header_state : public detail::block_header_state_common {
                                                         const vector<digest_type>& )>& validator,
                               bool skip_validate_signee = false )const;
 
-   bool                 has_pending_producers()const { return pending_schedule.schedule.producers.size(); }
+   bool                 has_pending_producers()const { return pending_schedule.schedule->producers.size(); }
    uint32_t             calc_dpos_last_irreversible( account_name producer_of_next_block )const;
 
    producer_authority     get_scheduled_producer( block_timestamp_type t )const;
@@ -159,6 +206,17 @@ using block_header_state_ptr = std::shared_ptr<block_header_state>;
 
 } } /// namespace eosio::chain
 
+namespace fc {
+   inline void to_variant( const eosio::chain::producer_schedule_ref& s, fc::variant& v ) {
+      to_variant( *s, v );
+   }
+   inline void from_variant( const fc::variant& v, eosio::chain::producer_schedule_ref& s ) {
+      eosio::chain::producer_authority_schedule schedule;
+      from_variant( v, schedule );
+      s = std::move( schedule );
+   }
+}
+
 FC_REFLECT( eosio::chain::detail::block_header_state_common,
             (block_num)
             (dpos_proposed_irreversible_blocknum)
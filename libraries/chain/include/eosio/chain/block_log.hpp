@@ -56,6 +56,7 @@ namespace eosio { namespace chain {
          void reset( const genesis_state& gs, const signed_block_ptr& genesis_block, packed_transaction::cf_compression_type segment_compression);
          void reset( const chain_id_type& chain_id, uint32_t first_block_num );
          
+         // the reads by number may be done on another thread than the appends
          block_id_type    read_block_id_by_num(uint32_t block_num)const;
 
          std::unique_ptr<signed_block>   read_signed_block_by_num(uint32_t block_num) const;
@@ -96,6 +97,8 @@ namespace eosio { namespace chain {
 
          // used for unit test to generate older version blocklog
          static void set_version(uint32_t);
+         // used for unit test to split small blocklogs into ranges when constructing the index or repairing
+         static void set_parallel_scan_threshold(uint64_t bytes);
          uint32_t    version() const;
 
          /**
@@ -103,6 +106,12 @@ namespace eosio { namespace chain {
           */
          static void smoke_test(fc::path block_dir, uint32_t n);
 
+         /**
+          * Fully validate every block of the block log and its index: the index positions, the deserialization of
+          * the entries and the links between the blocks. Ranges of blocks are validated concurrently on large logs.
+          */
+         static void verify(fc::path block_dir);
+
    private:
          std::unique_ptr<detail::block_log_impl> my;
    };
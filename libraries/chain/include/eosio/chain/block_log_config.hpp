@@ -1,5 +1,6 @@
 #pragma once
 #include <boost/filesystem/path.hpp>
+#include <eosio/chain/log_archive.hpp>
 
 namespace eosio {
 namespace chain {
@@ -13,6 +14,10 @@ struct block_log_config {
    uint32_t  stride                  = UINT32_MAX;
    uint16_t  max_retained_files      = 10;
    bool      fix_irreversible_blocks = false;
+   bool      compress_blocks         = false; ///< zlib compress entries of block logs created with version 5 or later
+   bool      background_split        = false; ///< split retained block files spanning several strides into one file per stride
+   uint32_t  prune_blocks_older_than = 0;     ///< prune the transactions of blocks this many blocks behind the head in the background, 0 disables
+   remote_archive_config remote_archive;      ///< keep archived block files in a remote store instead of archive_dir
 };
 
 } // namespace chain
@@ -134,6 +134,9 @@ namespace eosio { namespace chain {
       auto &get_kv_undo_stack(void) const { return kv_undo_stack; }
       backing_store_type get_backing_store() const { return backing_store; }
 
+      // memtables, block caches and table readers of rocksdb, nothing for chainbase whose memory is its mapped file
+      std::vector<subsystem_memory> memory_usage() const;
+
     private:
       void add_contract_tables_to_snapshot(const snapshot_writer_ptr& snapshot) const;
       void read_contract_tables_from_snapshot(const snapshot_reader_ptr& snapshot);
@@ -85,6 +85,9 @@ const static uint16_t   default_max_auth_depth                       = 6;
 const static uint32_t   default_sig_cpu_bill_pct                     = 50 * percent_1; // billable percentage of signature recovery
 const static uint32_t   default_block_cpu_effort_pct                 = 80 * percent_1; // percentage of block time used for producing block
 const static uint16_t   default_controller_thread_pool_size          = 2;
+const static uint16_t   default_block_prepare_depth                  = 16; // number of received blocks whose signatures may be recovered ahead of apply
+const static uint32_t   default_replay_read_ahead_blocks             = 256; // number of blocks read from the block log ahead of replaying them
+const static uint32_t   default_signature_cache_size                 = 100000; // number of recovered signatures kept across transactions
 const static uint32_t   default_max_variable_signature_length        = 16384u;
 const static uint32_t   default_max_nonprivileged_inline_action_size = 4 * 1024; // 4 KB
 const static uint32_t   default_max_action_return_value_size         = 256;
@@ -93,6 +96,7 @@ const static int        default_persistent_storage_max_num_files     = -1;
 const static uint64_t   default_persistent_storage_write_buffer_size = 128 * 1024 * 1024;
 const static uint64_t   default_persistent_storage_bytes_per_sync    = 1 * 1024 * 1024;
 const static uint32_t   default_persistent_storage_mbytes_batch      = 50;
+const static uint32_t   default_persistent_storage_bloom_bits_per_key = 15;
 
 static_assert(MAX_SIZE_OF_BYTE_ARRAYS == 20*1024*1024, "Changing MAX_SIZE_OF_BYTE_ARRAYS breaks consensus. Make sure this is expected");
 
@@ -6,6 +6,10 @@
 #include <boost/signals2/signal.hpp>
 
 #include <eosio/chain/abi_serializer.hpp>
+#include <eosio/chain/abi_serializer_cache.hpp>
+#include <eosio/chain/block_apply_metrics.hpp>
+#include <eosio/chain/startup_metrics.hpp>
+#include <eosio/chain/memory_usage.hpp>
 #include <eosio/chain/account_object.hpp>
 #include <eosio/chain/protocol_feature_manager.hpp>
 #include <eosio/chain/webassembly/eos-vm-oc/config.hpp>
@@ -82,6 +86,9 @@ namespace eosio { namespace chain {
             uint64_t                 reversible_guard_size      = chain::config::default_reversible_guard_size;
             uint32_t                 sig_cpu_bill_pct           = chain::config::default_sig_cpu_bill_pct;
             uint16_t                 thread_pool_size           = chain::config::default_controller_thread_pool_size;
+            std::vector<uint16_t>    thread_pool_cpus;          ///< cpus the thread pool is pinned to, empty to inherit the affinity
+            uint16_t                 block_prepare_depth        = chain::config::default_block_prepare_depth;
+            uint32_t                 replay_read_ahead_blocks   = chain::config::default_replay_read_ahead_blocks;
             uint16_t                 max_retained_block_files   = chain::config::default_max_retained_block_files;
             uint64_t                 blocks_log_stride          = chain::config::default_blocks_log_stride;
             backing_store_type       backing_store              = backing_store_type::CHAINBASE;
@@ -90,6 +97,11 @@ namespace eosio { namespace chain {
             uint64_t                 persistent_storage_write_buffer_size = chain::config::default_persistent_storage_write_buffer_size;
             uint64_t                 persistent_storage_bytes_per_sync = chain::config::default_persistent_storage_bytes_per_sync;
             uint32_t                 persistent_storage_mbytes_batch = chain::config::default_persistent_storage_mbytes_batch;
+            flat_set<account_name>   persistent_storage_hot_contracts; // contracts stored in their own rocksdb column family
+            uint64_t                 persistent_storage_hot_contract_cache_size = 0; // 0 = share block cache with other contracts
+            uint32_t                 persistent_storage_hot_contract_bloom_bits = chain::config::default_persistent_storage_bloom_bits_per_key;
+            uint64_t                 persistent_storage_hot_contract_write_buffer_size = chain::config::default_persistent_storage_write_buffer_size;
+            uint32_t                 persistent_storage_max_pending_commits = 0; // 0 = commit to rocksdb synchronously
             fc::microseconds         abi_serializer_max_time_us = fc::microseconds(chain::config::default_abi_serializer_max_time_us);
             uint32_t   max_nonprivileged_inline_action_size =  chain::config::default_max_nonprivileged_inline_action_size;
             bool                     read_only                  = false;
@@ -97,12 +109,15 @@ namespace eosio { namespace chain {
             bool                     disable_replay_opts        = false;
             bool                     contracts_console          = false;
             bool                     allow_ram_billing_in_notify = false;
+            bool                     profile_trx_parallelism = false; //< track accounts accessed by validated transactions and log how many could run concurrently
+            bool                     minimal_validation_traces = false; //< omit action data from notification traces of validated blocks, for nodes without trace consumers
 
             uint32_t                 maximum_variable_signature_length = chain::config::default_max_variable_signature_length;
             bool                     disable_all_subjective_mitigations = false; //< for developer & testing purposes, can be configured using `disable-all-subjective-mitigations` when `EOSIO_DEVELOPER` build option is provided
             uint32_t                 terminate_at_block     = 0; //< primarily for testing purposes
 
             wasm_interface::vm_type  wasm_runtime = chain::config::default_wasm_runtime;
+            uint32_t                 wasm_runtime_warmup_contracts = 0; //< most widely deployed contracts to instantiate at startup
             eosvmoc::config          eosvmoc_config;
             bool                     eosvmoc_tierup         = false;
 
@@ -180,6 +195,15 @@ namespace eosio { namespace chain {
 
          std::future<block_state_ptr> create_block_state_future( const block_id_type& id, const signed_block_ptr& b );
 
+         /**
+          * Start the state independent validation of a received block (transaction signature recovery) on the
+          * chain thread pool so that it overlaps with the application of the blocks before it. The results are
+          * consumed when the block is applied. At most config::block_prepare_depth blocks are kept prepared, once
+          * full new blocks are not prepared so that the ones closest to head are kept. Nothing is prepared for the blocks of trusted producers, whose transaction
+          * authorizations are not checked. Thread safe, may be called from any thread.
+          */
+         void prepare_block( const block_id_type& id, const signed_block_ptr& b );
+
          /**
           * @param block_state_future provide from call to create_block_state_future
           * @param cb calls cb with forked applied transactions for each forked block
@@ -294,6 +318,8 @@ namespace eosio { namespace chain {
          bool is_builtin_activated( builtin_protocol_feature_t f )const;
 
          bool is_known_unexpired_transaction( const transaction_id_type& id) const;
+         /// called by transaction_context after recording an input transaction for duplicate detection
+         void record_transaction_id( const transaction_id_type& id, fc::time_point_sec expiration );
 
          int64_t set_proposed_producers( vector<producer_authority> producers );
 
@@ -355,16 +381,25 @@ namespace eosio { namespace chain {
          wasm_interface& get_wasm_interface();
 
 
-         std::optional<abi_serializer> get_abi_serializer( account_name n, const abi_serializer::yield_function_t& yield )const {
+         /// parsed ABIs of the accounts, shared by the plugins
+         abi_serializer_cache& get_abi_serializer_cache()const;
+
+         /// latency of the stages of pushing, applying and committing blocks
+         const block_apply_metrics& get_block_apply_metrics()const;
+
+         /// time spent in each phase of constructing and starting up the controller
+         const startup_metrics& get_startup_metrics()const;
+
+         /// memory held by the fork database, the wasm runtimes and the rocksdb backing store, not thread safe
+         std::vector<subsystem_memory> get_memory_usage()const;
+
+         std::shared_ptr<const abi_serializer> get_abi_serializer( account_name n, const abi_serializer::yield_function_t& yield )const {
             if( n.good() ) {
                try {
-                  const auto& a = get_account( n );
-                  abi_def abi;
-                  if( abi_serializer::to_abi( a.abi, abi ))
-                     return abi_serializer( abi, yield );
+                  return get_abi_serializer_cache().get( db(), n, yield );
                } FC_CAPTURE_AND_LOG((n))
             }
-            return std::optional<abi_serializer>();
+            return {};
          }
 
          template<typename T>
@@ -1,5 +1,6 @@
 #pragma once
 #include <eosio/chain/block_state.hpp>
+#include <eosio/chain/memory_usage.hpp>
 #include <boost/signals2/signal.hpp>
 
 namespace eosio { namespace chain {
@@ -59,6 +60,9 @@ namespace eosio { namespace chain {
          const block_state_ptr& head()const;
          block_state_ptr        pending_head()const;
 
+         /// blocks held and an estimate of their memory, the packed size of the blocks and their states
+         subsystem_memory memory_usage()const;
+
          /**
           *  Returns the sequence of block states resulting from trimming the branch from the
           *  root block (exclusive) to the block with an id of `h` (inclusive) by removing any
@@ -0,0 +1,228 @@
+#pragma once
+#include <boost/filesystem.hpp>
+#include <fc/log/logger.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace eosio {
+namespace chain {
+
+namespace bfs = boost::filesystem;
+
+inline void rename_if_not_exists(bfs::path old_name, bfs::path new_name) {
+   if (!bfs::exists(new_name)) {
+      bfs::rename(old_name, new_name);
+   } else {
+      bfs::remove(old_name);
+      wlog("${new_name} already exists, just removing ${old_name}",
+           ("old_name", old_name.string())("new_name", new_name.string()));
+   }
+}
+
+inline void rename_bundle(bfs::path orig_path, bfs::path new_path) {
+   rename_if_not_exists(orig_path.replace_extension(".log"), new_path.replace_extension(".log"));
+   rename_if_not_exists(orig_path.replace_extension(".index"), new_path.replace_extension(".index"));
+}
+
+/// Commands that keep the files leaving the retained dir of a log catalog in a remote store, such as an S3
+/// compatible object store. In both commands %f is replaced by the file name without extension, e.g.
+/// blocks-1-100, and %p by the local path without extension, both quoted for the shell; the commands must handle both
+/// the .log and .index file.
+struct remote_archive_config {
+   std::string store_command; ///< copies %p.log and %p.index to the remote store
+   std::string fetch_command; ///< copies %f.log and %f.index from the remote store to %p.log and %p.index
+   uint32_t    max_cached_files = 4; ///< archived files kept locally after they are stored or fetched
+
+   bool enabled() const { return !store_command.empty() && !fetch_command.empty(); }
+};
+
+/// Where the log/index bundles go when they leave the retained dir of a log catalog.
+class log_archive {
+ public:
+   virtual ~log_archive() = default;
+
+   /// Take over the bundle at filename_base, which has been removed from the catalog.
+   virtual void store(const bfs::path& filename_base) = 0;
+
+   /// @return the local filename base of the archived bundle with the given name, or nothing if its blocks cannot
+   /// be read
+   virtual std::optional<bfs::path> fetch(const std::string& name) = 0;
+
+   /// @return the names of the archived bundles whose blocks can be fetched
+   virtual std::vector<std::string> list() const = 0;
+};
+
+/// Moves the bundles to a local directory that is under the user's control; nodeos does not read them anymore.
+class dir_log_archive : public log_archive {
+ public:
+   explicit dir_log_archive(bfs::path dir)
+       : dir(std::move(dir)) {}
+
+   void store(const bfs::path& filename_base) override { rename_bundle(filename_base, dir / filename_base.filename()); }
+   std::optional<bfs::path> fetch(const std::string&) override { return {}; }
+   std::vector<std::string> list() const override { return {}; }
+
+ private:
+   bfs::path dir;
+};
+
+/// Keeps the bundles in a remote store through the commands of a remote_archive_config, using cache_dir as a read
+/// through cache of the most recently stored or fetched bundles. Bundles are stored and fetched in the background, so
+/// that the thread reading the blocks is not blocked by the commands; the names of the bundles stored successfully are
+/// recorded in cache_dir/<name>.archived.
+class command_log_archive : public log_archive {
+ public:
+   command_log_archive(bfs::path cache_dir, const std::string& name, remote_archive_config config)
+       : cache_dir(std::move(cache_dir))
+       , manifest_path(this->cache_dir / (name + ".archived"))
+       , config(std::move(config)) {
+      std::lock_guard g(mtx);
+      std::ifstream   manifest(manifest_path.string());
+      for (std::string line; std::getline(manifest, line);) {
+         if (line.empty())
+            continue;
+         archived.insert(line);
+         if (is_cached(line))
+            cached.push_back(line);
+      }
+      evict();
+   }
+
+   ~command_log_archive() override {
+      for (auto& upload : uploads)
+         upload.wait();
+      for (auto& [name, f] : fetches)
+         f.wait();
+   }
+
+   void store(const bfs::path& filename_base) override {
+      const auto name = filename_base.filename().string();
+      rename_bundle(filename_base, cache_dir / name);
+
+      uploads.erase(std::remove_if(uploads.begin(), uploads.end(),
+                                   [](auto& upload) {
+                                      return upload.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+                                   }),
+                    uploads.end());
+      uploads.push_back(std::async(std::launch::async, [this, name]() {
+         const bool stored = run(config.store_command, name);
+         std::lock_guard g(mtx);
+         if (stored) {
+            archived.insert(name);
+            std::ofstream(manifest_path.string(), std::ios::app) << name << '\n';
+            touch(name);
+            evict();
+         } else {
+            // the bundle is never evicted, so it can be stored by hand
+            wlog("Failed to store ${name} in the remote archive, it is kept in ${dir}",
+                 ("name", name)("dir", cache_dir.string()));
+         }
+      }));
+   }
+
+   /// A bundle which is not cached is fetched in the background, its blocks cannot be read until it is cached
+   std::optional<bfs::path> fetch(const std::string& name) override {
+      std::lock_guard g(mtx);
+      for (auto it = fetches.begin(); it != fetches.end();) {
+         if (it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            it = fetches.erase(it);
+         else
+            ++it;
+      }
+      // the bundle is not complete before its fetch is
+      if (fetches.count(name))
+         return {};
+      if (is_cached(name)) {
+         // bundles still being stored are not evictable yet
+         if (archived.count(name))
+            touch(name);
+         return cache_dir / name;
+      }
+      if (!archived.count(name))
+         return {};
+
+      fetches.emplace(name, std::async(std::launch::async, [this, name]() {
+         const bool fetched = run(config.fetch_command, name) && is_cached(name);
+         std::lock_guard g(mtx);
+         if (fetched) {
+            touch(name);
+            evict();
+         } else {
+            wlog("Failed to fetch ${name} from the remote archive", ("name", name));
+         }
+      }));
+      return {};
+   }
+
+   std::vector<std::string> list() const override {
+      std::lock_guard g(mtx);
+      return {archived.begin(), archived.end()};
+   }
+
+ private:
+   bool is_cached(const std::string& name) const {
+      return bfs::exists(cache_dir / (name + ".log")) && bfs::exists(cache_dir / (name + ".index"));
+   }
+
+   /// single quote s for the shell
+   static std::string shell_quote(const std::string& s) {
+      std::string quoted = "'";
+      for (char c : s) {
+         if (c == '\'')
+            quoted += "'\\''";
+         else
+            quoted += c;
+      }
+      return quoted + "'";
+   }
+
+   bool run(std::string command, const std::string& name) const {
+      const auto replace_all = [&command](const std::string& from, const std::string& to) {
+         for (auto pos = command.find(from); pos != std::string::npos; pos = command.find(from, pos + to.size()))
+            command.replace(pos, from.size(), to);
+      };
+      replace_all("%p", shell_quote((cache_dir / name).string()));
+      replace_all("%f", shell_quote(name));
+      const int status = std::system(command.c_str());
+      if (status != 0)
+         wlog("'${command}' exited with status ${status}", ("command", command)("status", status));
+      return status == 0;
+   }
+
+   /// move name to the front of the cached bundles, must hold mtx
+   void touch(const std::string& name) {
+      cached.remove(name);
+      cached.push_front(name);
+   }
+
+   /// remove the least recently used bundles beyond max_cached_files, must hold mtx
+   void evict() {
+      while (cached.size() > config.max_cached_files) {
+         const auto name = cached.back();
+         cached.pop_back();
+         bfs::remove(cache_dir / (name + ".log"));
+         bfs::remove(cache_dir / (name + ".index"));
+      }
+   }
+
+   const bfs::path                          cache_dir;
+   const bfs::path                          manifest_path;
+   const remote_archive_config              config;
+   mutable std::mutex                       mtx;
+   std::set<std::string>                    archived;
+   std::list<std::string>                   cached;
+   std::vector<std::future<void>>           uploads;
+   std::map<std::string, std::future<void>> fetches; ///< in progress or finished, by bundle name
+};
+
+} // namespace chain
+} // namespace eosio
@@ -2,9 +2,13 @@
 #include <boost/container/flat_map.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
+#include <eosio/chain/log_archive.hpp>
 #include <fc/io/cfile.hpp>
 #include <fc/io/datastream.hpp>
+#include <algorithm>
+#include <future>
 #include <regex>
+#include <thread>
 
 namespace eosio {
 namespace chain {
@@ -46,14 +50,18 @@ struct log_catalog {
 
    using mapmode = boost::iostreams::mapped_file::mapmode;
 
-   bfs::path    retained_dir;
-   bfs::path    archive_dir;
-   size_type    max_retained_files = 10;
-   collection_t collection;
-   size_type    active_index = npos;
-   LogData      log_data;
-   LogIndex     log_index;
-   LogVerifier  verifier;
+   bfs::path                    retained_dir;
+   bfs::path                    archive_dir;
+   remote_archive_config        remote_archive; ///< set before open() to keep archived files in a remote store
+   std::unique_ptr<log_archive> archive;
+   size_type                    max_retained_files = 10;
+   collection_t                 collection;
+   collection_t                 archived; ///< the archived files whose blocks can be fetched
+   size_type                    active_index = npos;
+   std::optional<block_num_t>   active_archived; ///< first block num of the archived file open in log_data
+   LogData                      log_data;
+   LogIndex                     log_index;
+   LogVerifier                  verifier;
 
    bool empty() const { return collection.empty(); }
 
@@ -81,36 +89,70 @@ struct log_catalog {
          this->archive_dir = make_abosolute_dir(log_dir, archive_dir);
       }
 
-      for_each_file_in_dir_matches(this->retained_dir, std::string(name) + suffix_pattern, [this](bfs::path path) {
-         auto log_path               = path;
-         auto index_path             = path.replace_extension("index");
-         auto path_without_extension = log_path.parent_path() / log_path.stem().string();
-
-         LogData log(log_path);
+      if (remote_archive.enabled()) {
+         // without an archive dir the fetched files are cached next to the retained files
+         archive = std::make_unique<command_log_archive>(
+             this->archive_dir.empty() ? this->retained_dir : this->archive_dir, name, remote_archive);
+      } else if (!archive_dir.empty()) {
+         archive = std::make_unique<dir_log_archive>(this->archive_dir);
+      }
 
-         verifier.verify(log, log_path);
+      if (archive) {
+         const std::regex archived_name(std::string(name) + R"(-(\d+)-(\d+))");
+         std::smatch      what;
+         for (const auto& archived_file : archive->list()) {
+            if (std::regex_match(archived_file, what, archived_name))
+               archived.insert_or_assign(std::stoul(what[1].str()),
+                                         mapped_type{static_cast<block_num_t>(std::stoul(what[2].str())), archived_file});
+         }
+      }
 
-         // check if index file matches the log file
-         if (!index_matches_data(index_path, log))
-            log.construct_index(index_path);
+      std::vector<bfs::path> log_paths;
+      for_each_file_in_dir_matches(this->retained_dir, std::string(name) + suffix_pattern,
+                                   [&log_paths](bfs::path path) { log_paths.push_back(std::move(path)); });
+
+      // the files are opened and their indices checked or rebuilt in parallel, then they are verified and added in
+      // the order of the directory
+      const size_t concurrency = std::max<size_t>(1, std::thread::hardware_concurrency());
+      for (size_t i = 0; i < log_paths.size(); i += concurrency) {
+         std::vector<std::future<LogData>> opened;
+         for (size_t j = i; j < std::min(i + concurrency, log_paths.size()); ++j) {
+            opened.push_back(std::async(std::launch::async, [this, log_path = log_paths[j]]() {
+               LogData log(log_path);
+               auto    index_path = bfs::path(log_path).replace_extension("index");
+               // check if index file matches the log file
+               if (!index_matches_data(index_path, log))
+                  log.construct_index(index_path);
+               return log;
+            }));
+         }
+         for (size_t j = 0; j < opened.size(); ++j)
+            add_retained(log_paths[i + j], opened[j].get());
+      }
+   }
 
-         auto existing_itr = collection.find(log.first_block_num());
-         if (existing_itr != collection.end()) {
-            if (log.last_block_num() <= existing_itr->second.last_block_num) {
-               wlog("${log_path} contains the overlapping range with ${existing_path}.log, dropping ${log_path} "
-                    "from catalog",
-                    ("log_path", log_path.string())("existing_path", existing_itr->second.filename_base.string()));
-               return;
-            } else {
-               wlog(
-                   "${log_path} contains the overlapping range with ${existing_path}.log, droping ${existing_path}.log "
-                   "from catelog",
-                   ("log_path", log_path.string())("existing_path", existing_itr->second.filename_base.string()));
-            }
+   /// add an opened file of the retained dir to the catalog
+   void add_retained(const bfs::path& log_path, const LogData& log) {
+      auto path_without_extension = log_path.parent_path() / log_path.stem().string();
+
+      verifier.verify(log, log_path);
+
+      auto existing_itr = collection.find(log.first_block_num());
+      if (existing_itr != collection.end()) {
+         if (log.last_block_num() <= existing_itr->second.last_block_num) {
+            wlog("${log_path} contains the overlapping range with ${existing_path}.log, dropping ${log_path} "
+                 "from catalog",
+                 ("log_path", log_path.string())("existing_path", existing_itr->second.filename_base.string()));
+            return;
+         } else {
+            wlog(
+                "${log_path} contains the overlapping range with ${existing_path}.log, droping ${existing_path}.log "
+                "from catelog",
+                ("log_path", log_path.string())("existing_path", existing_itr->second.filename_base.string()));
          }
+      }
 
-         collection.insert_or_assign(log.first_block_num(), mapped_type{log.last_block_num(), path_without_extension});
-      });
+      collection.insert_or_assign(log.first_block_num(), mapped_type{log.last_block_num(), path_without_extension});
    }
 
    bool index_matches_data(const bfs::path& index_path, const LogData& log) const {
@@ -140,8 +182,12 @@ struct log_catalog {
                return log_index.nth_block_position(block_num - log_data.first_block_num());
             }
          }
+         if (active_archived && *active_archived <= block_num &&
+             block_num <= archived.find(*active_archived)->second.last_block_num && log_data.flags() == mode) {
+            return log_index.nth_block_position(block_num - log_data.first_block_num());
+         }
          if (collection.empty() || block_num < collection.begin()->first)
-            return {};
+            return archived_block_position(block_num, mode);
 
          auto it = --collection.upper_bound(block_num);
 
@@ -149,16 +195,37 @@ struct log_catalog {
             auto name = it->second.filename_base;
             log_data.open(name.replace_extension("log"), mode);
             log_index.open(name.replace_extension("index"));
-            this->active_index = collection.index_of(it);
+            this->active_index    = collection.index_of(it);
+            this->active_archived.reset();
             return log_index.nth_block_position(block_num - log_data.first_block_num());
          }
          return {};
       } catch (...) {
          this->active_index = npos;
+         this->active_archived.reset();
          return {};
       }
    }
 
+   /// Fetch the archived file containing block_num; archived files are read only
+   std::optional<uint64_t> archived_block_position(uint32_t block_num, mapmode mode) {
+      if (!archive || mode != mapmode::readonly || archived.empty() || block_num < archived.begin()->first)
+         return {};
+
+      auto it = --archived.upper_bound(block_num);
+      if (block_num > it->second.last_block_num)
+         return {};
+
+      auto name = archive->fetch(it->second.filename_base.string());
+      if (!name)
+         return {};
+      log_data.open(name->replace_extension("log"), mode);
+      log_index.open(name->replace_extension("index"));
+      this->active_index    = npos;
+      this->active_archived = it->first;
+      return log_index.nth_block_position(block_num - log_data.first_block_num());
+   }
+
    std::pair<fc::datastream<const char*>, uint32_t> ro_stream_for_block(uint32_t block_num) {
       auto pos = get_block_position(block_num, mapmode::readonly);
       if (pos) {
@@ -183,21 +250,6 @@ struct log_catalog {
       return {};
    }
 
-   static void rename_if_not_exists(bfs::path old_name, bfs::path new_name) {
-      if (!bfs::exists(new_name)) {
-         bfs::rename(old_name, new_name);
-      } else {
-         bfs::remove(old_name);
-         wlog("${new_name} already exists, just removing ${old_name}",
-              ("old_name", old_name.string())("new_name", new_name.string()));
-      }
-   }
-
-   static void rename_bundle(bfs::path orig_path, bfs::path new_path) {
-      rename_if_not_exists(orig_path.replace_extension(".log"), new_path.replace_extension(".log"));
-      rename_if_not_exists(orig_path.replace_extension(".index"), new_path.replace_extension(".index"));
-   }
-
    /// Add a new entry into the catalog.
    ///
    /// Notice that \c start_block_num must be monotonically increasing between the invocations of this function
@@ -218,13 +270,15 @@ struct log_catalog {
              max_retained_files > 0 ? this->collection.size() - max_retained_files + 1 : this->collection.size();
          for (auto it = this->collection.begin(); it < this->collection.begin() + items_to_erase; ++it) {
             auto orig_name = it->second.filename_base;
-            if (archive_dir.empty()) {
+            if (!archive) {
                // delete the old files when no backup dir is specified
                bfs::remove(orig_name.replace_extension("log"));
                bfs::remove(orig_name.replace_extension("index"));
             } else {
-               // move the the archive dir
-               rename_bundle(orig_name, archive_dir / orig_name.filename());
+               // move to the archive dir or the remote store
+               archive->store(orig_name);
+               if (remote_archive.enabled())
+                  archived.insert_or_assign(it->first, mapped_type{it->second.last_block_num, orig_name.filename()});
             }
          }
          this->collection.erase(this->collection.begin(), this->collection.begin() + items_to_erase);
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <fc/reflect/reflect.hpp>
+
+#include <string>
+
+namespace eosio { namespace chain {
+
+   /**
+    * Memory held by a subsystem of the node outside of the chain state database, e.g. "fork_database" or
+    * "rocksdb.block_cache". bytes is what the subsystem tracks or can estimate cheaply, 0 when it only knows how many
+    * entries it holds; subsystems that track neither do not report.
+    */
+   struct subsystem_memory {
+      std::string subsystem;
+      uint64_t    bytes = 0;
+      uint64_t    entries = 0;
+   };
+
+} } // eosio::chain
+
+FC_REFLECT( eosio::chain::subsystem_memory, (subsystem)(bytes)(entries) )
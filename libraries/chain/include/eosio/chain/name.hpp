@@ -71,7 +71,13 @@ namespace eosio::chain {
       constexpr explicit name( uint64_t v ) : value(v) {}
       constexpr name() = default;
 
+      static constexpr size_t max_string_size = 13;
+
       std::string to_string()const;
+
+      /// write the string form of the name, without the trailing dots, to buf which holds at least max_string_size
+      /// chars, @return the number of chars written
+      size_t write_as_string( char* buf )const;
       constexpr uint64_t to_uint64_t()const { return value; }
 
       friend std::ostream& operator << ( std::ostream& out, const name& n ) {
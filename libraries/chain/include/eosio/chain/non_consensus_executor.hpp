@@ -0,0 +1,64 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace eosio { namespace chain {
+
+   /**
+    * Runs the tasks which take no part in consensus and neither read nor write the chain state, such as formatting
+    * API responses, traces or metrics, on a pool of threads shared by the whole process, so the plugins use several
+    * cores without each building its own threading while the main thread keeps the consensus ordered work.
+    *
+    * The tasks are ordered like the queue of the main thread: higher priority first, in posting order within a
+    * priority. Any idle thread takes the next task. Until it is started, and after it is stopped, the executor has no
+    * threads and running() is false; callers then post their tasks to the main thread instead.
+    */
+   class non_consensus_executor {
+   public:
+      non_consensus_executor() = default;
+      ~non_consensus_executor();
+
+      non_consensus_executor( const non_consensus_executor& ) = delete;
+      non_consensus_executor& operator=( const non_consensus_executor& ) = delete;
+
+      /// the executor of nodeos, started by chain_plugin with non-consensus-threads threads
+      static non_consensus_executor& shared();
+
+      void start( size_t num_threads );
+
+      /// runs the tasks queued and joins the threads
+      void stop();
+
+      bool running() const;
+
+      /// queue f, throws misc_exception if the executor is not running; exceptions thrown by f are logged
+      void post( int priority, std::function<void()> f );
+
+   private:
+      struct task {
+         int                    priority;
+         uint64_t               order;
+         std::function<void()>  f;
+
+         bool operator<( const task& o ) const {
+            return priority < o.priority || ( priority == o.priority && order > o.order );
+         }
+      };
+
+      void run();
+
+      mutable std::mutex                mtx;
+      std::condition_variable           cv;
+      std::priority_queue<task>         tasks;   ///< protected by mtx
+      uint64_t                          next_order = 0;
+      bool                              stopping = false;
+      std::vector<std::thread>          threads; ///< protected by mtx
+   };
+
+} } // eosio::chain
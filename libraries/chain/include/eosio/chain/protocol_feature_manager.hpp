@@ -26,7 +26,8 @@ enum class builtin_protocol_feature_t : uint32_t {
    action_return_value,
    kv_database,
    configurable_wasm_limits,
-   blockchain_parameters
+   blockchain_parameters,
+   batched_db_reads
 };
 
 struct protocol_feature_subjective_restrictions {
@@ -58,6 +58,13 @@ namespace eosio { namespace chain { namespace resource_limits {
       int64_t current_used = 0;  ///< current usage according to the given timestamp
    };
 
+   struct account_billing_limits {
+      int64_t net_available = 0; ///< -1 if unlimited
+      bool    net_greylisted = false;
+      int64_t cpu_available = 0; ///< -1 if unlimited
+      bool    cpu_greylisted = false;
+   };
+
    class resource_limits_manager {
       public:
 
@@ -104,6 +111,9 @@ namespace eosio { namespace chain { namespace resource_limits {
          std::pair<account_resource_limit, bool>
          get_account_net_limit_ex( const account_name& name, uint32_t greylist_limit = config::maximum_elastic_resource_multiplier, const std::optional<block_timestamp_type>& current_time={} ) const;
 
+         /// the available net and cpu of get_account_net_limit and get_account_cpu_limit, reading the objects of the account once
+         account_billing_limits get_account_billing_limits( const account_name& name, uint32_t greylist_limit = config::maximum_elastic_resource_multiplier ) const;
+
          int64_t get_account_ram_usage( const account_name& name ) const;
 
       private:
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <fc/time.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace eosio { namespace chain {
+
+   struct signal_slot_latency {
+      std::string   slot;
+      uint64_t      calls    = 0;
+      uint64_t      total_us = 0;
+      uint64_t      max_us   = 0;
+   };
+
+   /**
+    * Time spent in the handlers plugins connect to the signals of the controller, which run on the main thread and
+    * add to the time of every block and transaction. A slot is named by its plugin and signal, e.g.
+    * "history.applied_transaction"; see timed_slot.
+    *
+    * Recording is a few relaxed atomic operations on an entry looked up when the slot is connected; thread safe.
+    */
+   class signal_slot_metrics {
+    public:
+      class entry {
+       public:
+         void record( fc::microseconds d );
+
+       private:
+         friend class signal_slot_metrics;
+         std::atomic<uint64_t> calls{0};
+         std::atomic<uint64_t> total_us{0};
+         std::atomic<uint64_t> max_us{0};
+      };
+
+      /// the metrics of the process, shared by the plugins of all controllers
+      static signal_slot_metrics& shared();
+
+      /// @return the entry of slot, created on first use; entries live as long as the metrics
+      entry& get( const std::string& slot );
+
+      /// @return the slots in order of name
+      std::vector<signal_slot_latency> snapshot() const;
+
+    private:
+      mutable std::mutex                              mtx;
+      std::map<std::string, std::unique_ptr<entry>>   entries;
+   };
+
+   /// wrap f to record the time of each call, including calls which throw, in the entry of slot
+   template<typename F>
+   auto timed_slot( const std::string& slot, F&& f ) {
+      return [&e = signal_slot_metrics::shared().get( slot ), f = std::forward<F>( f )]( auto&&... args ) {
+         struct timer {
+            signal_slot_metrics::entry& e;
+            const fc::time_point         start = fc::time_point::now();
+            ~timer() { e.record( fc::time_point::now() - start ); }
+         } t{e};
+         return f( std::forward<decltype(args)>( args )... );
+      };
+   }
+
+   /**
+    * Runs the handlers of signals on a worker thread, so a subscriber which only needs the arguments of the signals
+    * does not add its work to the time of the main thread.
+    *
+    * Handlers run one at a time in the order they were posted, so they see the signals in the order the controller
+    * emitted them, but not in step with the state of the chain: by the time a handler runs, the controller may have
+    * moved on and even switched forks, so handlers must not read the chain database. Arguments have to be captured
+    * by value; the block states and traces of the signals are shared pointers which are not modified once emitted.
+    *
+    * The queue is bounded. When it is full, post blocks the main thread until the worker catches up instead of
+    * dropping signals, so a subscriber which cannot keep up still slows the node down, just later and less often.
+    */
+   class async_signal_queue {
+    public:
+      using error_handler = std::function<void( std::exception_ptr )>;
+
+      /// @param on_error called on the worker with the exception of a handler which throws; logged if empty
+      async_signal_queue( std::string thread_name, size_t max_queued, error_handler on_error = {} );
+
+      // calls stop()
+      ~async_signal_queue();
+
+      /// queue f, waiting while max_queued handlers are already queued; ignored once stopped
+      void post( std::function<void()> f );
+
+      /// run the handlers already queued, then join the worker
+      void stop();
+
+      size_t size() const;
+
+    private:
+      void run();
+
+      const size_t                        max_queued;
+      const error_handler                 on_error;
+      mutable std::mutex                  mtx;
+      std::condition_variable             not_empty;
+      std::condition_variable             not_full;
+      std::deque<std::function<void()>>   queue;
+      bool                                stopping = false;
+      std::thread                         worker;
+   };
+
+} } // eosio::chain
+
+FC_REFLECT( eosio::chain::signal_slot_latency, (slot)(calls)(total_us)(max_us) )
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <eosio/chain/types.hpp>
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+
+namespace eosio { namespace chain {
+
+   /**
+    * The public keys recovered from signatures, shared by the whole process so a signature recovered while a
+    * transaction is executed speculatively is not recovered again when the transaction comes back in a block, from
+    * another peer or after it was dropped from the unapplied queue.
+    *
+    * An entry is keyed by the hash of the digest, the packed signature and whether it was checked to be canonical, so
+    * a signature recovered by a contract without the check is never accepted for a transaction. Recovery is
+    * deterministic so an entry never has to be invalidated; the least recently used entries are dropped once there are more than max_entries.
+    */
+   class signature_cache {
+    public:
+      explicit signature_cache( size_t max_entries = 0 )
+      : max_entries(max_entries) {}
+
+      /// the cache used by transaction::get_signature_keys, disabled until its size is set
+      static signature_cache& shared();
+
+      /// @return the public key of sig over digest, recovering and remembering it if it is not cached
+      /// @throws if sig cannot be recovered, or if check_canonical and sig is not canonical
+      public_key_type recover( const signature_type& sig, const digest_type& digest, bool check_canonical = true );
+
+      /// 0 disables the cache
+      void set_max_entries( size_t n );
+
+      void clear();
+
+      size_t size() const;
+
+    private:
+      struct entry {
+         public_key_type                    key;
+         std::list<digest_type>::iterator   lru_itr;
+      };
+
+      std::optional<public_key_type> find( const digest_type& k );
+
+      std::atomic<size_t>                    max_entries;
+      mutable std::mutex                     mtx;
+      std::map<digest_type, entry>           entries;
+      std::list<digest_type>                 lru; ///< most recently used first
+   };
+
+} } // eosio::chain
@@ -2,8 +2,13 @@
 
 #include <eosio/chain/database_utils.hpp>
 #include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/thread_utils.hpp>
 #include <fc/variant_object.hpp>
 #include <boost/core/demangle.hpp>
+#include <deque>
+#include <future>
+#include <map>
+#include <optional>
 #include <ostream>
 
 namespace eosio { namespace chain {
@@ -131,8 +136,26 @@ namespace eosio { namespace chain {
                snapshot_writer& _writer;
          };
 
+         /// rows packed in memory, e.g. on a thread pool, which are copied into the snapshot as they are
+         class packed_section {
+            public:
+               template<typename T>
+               void add_row( const T& row, const chainbase::database& db ) {
+                  const auto& data = detail::snapshot_row_traits<T>::to_snapshot_row(row, db);
+                  const auto  pos  = rows.size();
+                  rows.resize(pos + fc::raw::pack_size(data));
+                  fc::datastream<char*> ds(rows.data() + pos, rows.size() - pos);
+                  fc::raw::pack(ds, data);
+                  ++row_count;
+               }
+
+               std::vector<char> rows;
+               uint64_t          row_count = 0;
+         };
+
          template<typename F>
          void write_section(const std::string section_name, F f) {
+            flush_sections();
             write_start_section(section_name);
             auto section = section_writer(*this);
             f(section);
@@ -144,12 +167,77 @@ namespace eosio { namespace chain {
             write_section(detail::snapshot_section_traits<T>::section_name(), f);
          }
 
-      virtual ~snapshot_writer(){};
+         /**
+          * Lets write_section_async pack the rows of up to max_pending sections on thread_pool while the sections
+          * before them are written. Only used by writers which support_packed_rows().
+          */
+         void set_thread_pool( boost::asio::io_context& thread_pool, size_t max_pending ) {
+            this->thread_pool = &thread_pool;
+            this->max_pending = std::max<size_t>(max_pending, 1);
+         }
+
+         /**
+          * Like write_section, but f may run later on the thread pool of set_thread_pool, so it must only capture
+          * what outlives the following flush_sections(). If continued, the rows of the next write_section_async go
+          * into the same section, which lets a large section be packed in several parts.
+          */
+         template<typename F>
+         void write_section_async(const std::string& section_name, F f, bool continued = false) {
+            const bool start = !section_open;
+            section_open     = continued;
+            if (!thread_pool || !supports_packed_rows()) {
+               if (start)
+                  write_start_section(section_name);
+               auto section = section_writer(*this);
+               f(section);
+               if (!continued)
+                  write_end_section();
+               return;
+            }
+            if (pending.size() >= max_pending)
+               write_pending_front();
+            pending.push_back({section_name, async_thread_pool(*thread_pool, [f{std::move(f)}]() {
+                                  packed_section section;
+                                  f(section);
+                                  return section;
+                               }), start, !continued});
+         }
+
+         template<typename T, typename F>
+         void write_section_async(F f) {
+            write_section_async(detail::snapshot_section_traits<T>::section_name(), std::move(f));
+         }
+
+         /// write the sections still being packed by write_section_async
+         void flush_sections();
+
+      virtual ~snapshot_writer();
 
       protected:
          virtual void write_start_section( const std::string& section_name ) = 0;
          virtual void write_row( const detail::abstract_snapshot_row_writer& row_writer ) = 0;
          virtual void write_end_section() = 0;
+
+         /// true if the writer stores the packed rows, and so can take packed_sections through write_packed_rows
+         virtual bool supports_packed_rows() const { return false; }
+         virtual void write_packed_rows( const packed_section& rows ) {
+            EOS_THROW(snapshot_exception, "This snapshot writer does not support packed rows");
+         }
+
+      private:
+         struct pending_section {
+            std::string                 name;
+            std::future<packed_section> rows;
+            bool                        start;
+            bool                        end;
+         };
+
+         void write_pending_front();
+
+         boost::asio::io_context*    thread_pool  = nullptr;
+         size_t                      max_pending  = 0;
+         std::deque<pending_section> pending;
+         bool                        section_open = false; ///< by a continued write_section_async
    };
 
    using snapshot_writer_ptr = std::shared_ptr<snapshot_writer>;
@@ -261,10 +349,12 @@ namespace eosio { namespace chain {
 
       template<typename F>
       void read_section(const std::string& section_name, F f) {
+         const auto start = fc::time_point::now();
          set_section(section_name);
          auto section = section_reader(*this);
          f(section);
          clear_section();
+         section_times.emplace_back(section_name, fc::time_point::now() - start);
       }
 
       template<typename T, typename F>
@@ -281,6 +371,11 @@ namespace eosio { namespace chain {
 
       virtual void return_to_header() = 0;
 
+      /// @return the time spent reading each section, including the rows created from it, in the order they were read
+      const std::vector<std::pair<std::string, fc::microseconds>>& get_section_times() const {
+         return section_times;
+      }
+
       virtual ~snapshot_reader(){};
 
       protected:
@@ -289,6 +384,9 @@ namespace eosio { namespace chain {
          virtual bool read_row( detail::abstract_snapshot_row_reader& row_reader ) = 0;
          virtual bool empty( ) = 0;
          virtual void clear_section() = 0;
+
+      private:
+         std::vector<std::pair<std::string, fc::microseconds>> section_times;
    };
 
    using snapshot_reader_ptr = std::shared_ptr<snapshot_reader>;
@@ -333,6 +431,8 @@ namespace eosio { namespace chain {
          void write_start_section( const std::string& section_name ) override;
          void write_row( const detail::abstract_snapshot_row_writer& row_writer ) override;
          void write_end_section( ) override;
+         bool supports_packed_rows() const override { return true; }
+         void write_packed_rows( const packed_section& rows ) override;
          void finalize();
 
          static const uint32_t magic_number = 0x30510550;
@@ -360,12 +460,30 @@ namespace eosio { namespace chain {
       private:
          bool validate_section() const;
 
+         struct section_info {
+            std::streampos rows_pos;
+            uint64_t       row_count;
+         };
+
+         /// find the sections with one pass over the section headers, instead of one pass per section
+         const std::map<std::string, section_info>& sections();
+
          std::istream&  snapshot;
          std::streampos header_pos;
          uint64_t       num_rows;
          uint64_t       cur_row;
+         std::optional<std::map<std::string, section_info>> section_index;
    };
 
+   /// @return true if the binary snapshot in the stream is gzip compressed, without consuming anything from it
+   bool is_compressed_snapshot( std::istream& snapshot );
+
+   /// gzip compress the binary snapshot read from in into out
+   void compress_snapshot( std::istream& in, std::ostream& out );
+
+   /// decompress the gzip compressed binary snapshot read from in, which may be a pipe, into out
+   void decompress_snapshot( std::istream& in, std::ostream& out );
+
    class integrity_hash_snapshot_writer : public snapshot_writer {
       public:
          explicit integrity_hash_snapshot_writer(fc::sha256::encoder&  enc);
@@ -373,6 +491,8 @@ namespace eosio { namespace chain {
          void write_start_section( const std::string& section_name ) override;
          void write_row( const detail::abstract_snapshot_row_writer& row_writer ) override;
          void write_end_section( ) override;
+         bool supports_packed_rows() const override { return true; }
+         void write_packed_rows( const packed_section& rows ) override;
          void finalize();
 
       private:
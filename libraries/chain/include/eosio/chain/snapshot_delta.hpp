@@ -0,0 +1,30 @@
+#pragma once
+
+#include <istream>
+#include <ostream>
+
+namespace eosio { namespace chain { namespace snapshot_delta {
+
+   /**
+    * A delta snapshot stores a binary snapshot as the chunks it shares with a base binary snapshot plus the bytes of
+    * the chunks it does not share. The chunk boundaries depend on the content only, so rows which are added, changed
+    * or removed in one part of the state only change the chunks around them, and a delta of a snapshot taken shortly
+    * after its base is a small fraction of its size.
+    *
+    * Layout: magic number, version, sha256 of the base, then records of a kind byte followed by either the offset and
+    * size of a range of the base (copy) or the size and the bytes of a range missing from the base (data), then an
+    * end record and the sha256 of the rebuilt snapshot.
+    */
+   static const uint32_t magic_number = 0x30510551;
+   static const uint32_t version      = 1;
+
+   /// @return true if the stream holds a delta snapshot, without consuming anything from it
+   bool is_delta( std::istream& in );
+
+   /// write the delta of snapshot against base into out; both are read once from start to end
+   void write( std::istream& base, std::istream& snapshot, std::ostream& out );
+
+   /// rebuild the snapshot of delta into out; base must be the base the delta was written against and seekable
+   void apply( std::istream& base, std::istream& delta, std::ostream& out );
+
+}}} // namespace eosio::chain::snapshot_delta
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <fc/time.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace eosio { namespace chain {
+
+   struct startup_phase {
+      std::string phase;
+      uint64_t    us = 0;
+   };
+
+   /**
+    * Time spent in each phase of starting a node: opening the state and the block log, loading the snapshot by
+    * section, replaying, and the initialization and startup of the plugins. A phase is named by its component and
+    * step, e.g. "controller.chainbase_open" or "snapshot.section.contract_tables"; phases can nest, so their times do
+    * not add up to the total.
+    *
+    * Phases are recorded once, in the order they complete, except that the chain_plugin adds the phases of the
+    * controller, which it times on its own instance, at the end of its startup; thread safe.
+    */
+   class startup_metrics {
+    public:
+      /// the metrics of the process, startup happens once per process
+      static startup_metrics& shared();
+
+      void record( std::string phase, fc::microseconds d );
+
+      /// @return the phases in the order they were recorded
+      std::vector<startup_phase> snapshot() const;
+
+      /// log each phase and its time
+      void log() const;
+
+      /// records the time from its construction to its destruction as phase, also when unwinding
+      class scoped_timer {
+       public:
+         explicit scoped_timer( std::string phase, startup_metrics& m = shared() )
+         : m( m ), phase( std::move( phase ) ) {}
+         ~scoped_timer() { m.record( std::move( phase ), fc::time_point::now() - start ); }
+
+         scoped_timer( const scoped_timer& ) = delete;
+         scoped_timer& operator=( const scoped_timer& ) = delete;
+
+       private:
+         startup_metrics&     m;
+         std::string          phase;
+         const fc::time_point start = fc::time_point::now();
+      };
+
+    private:
+      mutable std::mutex         mtx;
+      std::vector<startup_phase> phases;
+   };
+
+} } // eosio::chain
+
+FC_REFLECT( eosio::chain::startup_phase, (phase)(us) )
@@ -82,8 +82,14 @@ namespace eosio {
             uint64_t value() const { return m_value; }
             bool valid() const
             {
-               const auto& s = name();
-               return decimals() <= max_precision && valid_name(s);
+               if( decimals() > max_precision )
+                  return false;
+               for( uint64_t v = m_value >> 8; v > 0; v >>= 8 ) {
+                  const char c = v & 0xFF;
+                  if( c < 'A' || c > 'Z' )
+                     return false;
+               }
+               return true;
             }
             static bool valid_name(const string& name)
             {
@@ -103,15 +109,19 @@ namespace eosio {
             }
             string name() const
             {
-               uint64_t v = m_value;
-               v >>= 8;
-               string result;
-               while (v > 0) {
-                  char c = v & 0xFF;
-                  result += c;
-                  v >>= 8;
-               }
-               return result;
+               char buf[max_name_size];
+               return string(buf, write_name(buf));
+            }
+
+            static constexpr size_t max_name_size = 7;
+
+            /// write the name to buf which holds at least max_name_size chars, @return the number of chars written
+            size_t write_name(char* buf) const
+            {
+               size_t size = 0;
+               for( uint64_t v = m_value >> 8; v > 0; v >>= 8 )
+                  buf[size++] = v & 0xFF;
+               return size;
             }
 
             symbol_code to_symbol_code()const { return {m_value >> 8}; }
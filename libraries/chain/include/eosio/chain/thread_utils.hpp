@@ -6,6 +6,8 @@
 #include <future>
 #include <memory>
 #include <optional>
+#include <string>
+#include <vector>
 
 namespace eosio { namespace chain {
 
@@ -17,7 +19,8 @@ namespace eosio { namespace chain {
    public:
       // name_prefix is name appended with -## of thread.
       // short name_prefix (6 chars or under) is recommended as console_appender uses 9 chars for thread name
-      named_thread_pool( std::string name_prefix, size_t num_threads );
+      // threads are pinned to cpus when not empty, otherwise they inherit the affinity of the creating thread
+      named_thread_pool( std::string name_prefix, size_t num_threads, std::vector<uint16_t> cpus = {} );
 
       // calls stop()
       ~named_thread_pool();
@@ -36,6 +39,19 @@ namespace eosio { namespace chain {
    };
 
 
+   // parse a cpu list such as "0-3,8", as in /sys/devices/system/node/node#/cpulist; throws misc_exception
+   std::vector<uint16_t> parse_cpu_list( const std::string& list );
+
+   // cpus of numa node, throws misc_exception if the node does not exist
+   std::vector<uint16_t> numa_node_cpus( uint32_t node );
+
+   // pin the calling thread to cpus, the threads it creates afterwards inherit the affinity, throws misc_exception
+   void set_thread_affinity( const std::vector<uint16_t>& cpus );
+
+   // pin the calling thread to the cpus of numa node and allocate the memory it touches first on that node when
+   // possible; the threads it creates afterwards inherit both, throws misc_exception
+   void bind_thread_to_numa_node( uint32_t node );
+
    // async on thread_pool and return future
    template<typename F>
    auto async_thread_pool( boost::asio::io_context& thread_pool, F&& f ) {
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <eosio/chain/types.hpp>
+
+namespace eosio { namespace chain {
+
+   /**
+    * Accounts whose state a transaction read or wrote while it executed.
+    *
+    * Used to measure how many transactions of a block could have been executed concurrently without changing the
+    * outcome. Counters shared by every action (global and receive sequences) are deliberately not tracked; they would
+    * have to be assigned at commit time by any concurrent executor.
+    */
+   struct transaction_access_set {
+      flat_set<account_name> reads;
+      flat_set<account_name> writes;
+      bool                   opaque = false; ///< accesses could not be tracked, conflicts with every other set
+
+      void add_read( account_name n )  { reads.insert( n ); }
+      void add_write( account_name n ) { writes.insert( n ); }
+
+      bool conflicts_with( const transaction_access_set& other )const;
+   };
+
+   /**
+    * Assign each access set, in order, to the earliest batch that comes after every batch holding an earlier
+    * conflicting set. Transactions within a batch do not conflict with each other, and the relative order of
+    * conflicting transactions is preserved.
+    *
+    * @return batch index of each set, parallel to the input
+    */
+   vector<uint32_t> schedule_conflict_free_batches( const vector<transaction_access_set>& sets );
+
+} } /// eosio::chain
@@ -3,6 +3,7 @@
 #include <eosio/chain/controller.hpp>
 #include <eosio/chain/trace.hpp>
 #include <eosio/chain/platform_timer.hpp>
+#include <eosio/chain/transaction_access_set.hpp>
 #include <signal.h>
 
 namespace eosio { namespace chain {
@@ -173,6 +174,7 @@ namespace eosio { namespace chain {
          bool                          is_input           = false;
          bool                          apply_context_free = true;
          bool                          enforce_whiteblacklist = true;
+         bool                          trace_notification_payloads = true; ///< false to leave act.data empty in the action_trace of notifications
 
          fc::time_point                deadline = fc::time_point::maximum();
          fc::microseconds              leeway = fc::microseconds( config::default_subjective_cpu_leeway_us );
@@ -185,6 +187,9 @@ namespace eosio { namespace chain {
          /// kept to track ids of action_traces push via this transaction
          action_id_type                action_id;
 
+         /// accounts read and written by this transaction, only tracked when controller::config::profile_trx_parallelism
+         std::optional<transaction_access_set> access_set;
+
       private:
          bool                          is_initialized = false;
 
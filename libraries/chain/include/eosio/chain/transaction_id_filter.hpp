@@ -0,0 +1,41 @@
+#pragma once
+
+#include <eosio/chain/types.hpp>
+
+namespace eosio { namespace chain {
+
+   /**
+    * Bloom filter over the ids of recorded input transactions, kept in front of transaction_multi_index.
+    *
+    * Ids are bucketed by expiration so that the bits of expired transactions can be dropped a bucket at a time.
+    * The filter may report ids that are no longer (or never were) recorded, but never misses one that is: a
+    * negative answer means the transaction is definitely not in the deduplication index.
+    */
+   class transaction_id_filter {
+      public:
+         static constexpr uint32_t default_bucket_seconds = 300;
+         static constexpr uint32_t default_bits_per_bucket = 1u << 20;
+
+         explicit transaction_id_filter( uint32_t bucket_seconds = default_bucket_seconds,
+                                         uint32_t bits_per_bucket = default_bits_per_bucket );
+
+         void insert( const transaction_id_type& id, fc::time_point_sec expiration );
+
+         /// @return false if id was definitely never inserted into a bucket that has not been pruned
+         bool may_contain( const transaction_id_type& id )const;
+
+         /// drop every bucket whose transactions all expire before the given time
+         void prune( fc::time_point_sec expired_before );
+
+         void clear() { _buckets.clear(); }
+         size_t bucket_count()const { return _buckets.size(); }
+
+      private:
+         using bucket_type = vector<uint64_t>;
+
+         const uint32_t             _bucket_seconds;
+         const uint32_t             _bits_per_bucket;
+         std::map<uint32_t, bucket_type> _buckets; ///< keyed by expiration / bucket_seconds
+   };
+
+} } /// eosio::chain
@@ -3,6 +3,7 @@
 #include <eosio/chain/types.hpp>
 #include <boost/asio/io_context.hpp>
 #include <future>
+#include <vector>
 
 namespace boost { namespace asio {
    class thread_pool;
@@ -23,7 +24,8 @@ class transaction_metadata {
       enum class trx_type {
          input,
          implicit,
-         scheduled
+         scheduled,
+         dry_run    ///< executed against the pending state and always undone; never recorded, billed or included in a block
       };
 
    private:
@@ -34,6 +36,7 @@ class transaction_metadata {
    public:
       const bool                                                 implicit;
       const bool                                                 scheduled;
+      const bool                                                 dry_run;
       bool                                                       accepted = false;       // not thread safe
       uint32_t                                                   billed_cpu_time_us = 0; // not thread safe
 
@@ -53,12 +56,13 @@ class transaction_metadata {
       // creation of tranaction_metadata restricted to start_recover_keys and create_no_recover_keys below, public for make_shared
       explicit transaction_metadata( const private_type& pt, packed_transaction_ptr ptrx,
                                      fc::microseconds sig_cpu_usage, flat_set<public_key_type> recovered_pub_keys,
-                                     bool _implicit = false, bool _scheduled = false)
+                                     bool _implicit = false, bool _scheduled = false, bool _dry_run = false)
          : _packed_trx( std::move( ptrx ) )
          , _sig_cpu_usage( sig_cpu_usage )
          , _recovered_pub_keys( std::move( recovered_pub_keys ) )
          , implicit( _implicit )
-         , scheduled( _scheduled ) {
+         , scheduled( _scheduled )
+         , dry_run( _dry_run ) {
       }
 
       transaction_metadata() = delete;
@@ -81,11 +85,27 @@ class transaction_metadata {
                           const chain_id_type& chain_id, fc::microseconds time_limit,
                           uint32_t max_variable_sig_size = UINT32_MAX );
 
+      /// Thread safe. Recovers the keys of trxs in at most max_tasks tasks posted to thread_pool, each recovering a
+      /// contiguous run of them, so that the submission of the many transactions of a block does not contend on
+      /// the thread pool queue once per transaction.
+      /// @returns a future per trx, in the order of trxs
+      static std::vector<recover_keys_future>
+      start_recover_keys( std::vector<packed_transaction_ptr> trxs, boost::asio::io_context& thread_pool,
+                          const chain_id_type& chain_id, fc::microseconds time_limit, size_t max_tasks,
+                          uint32_t max_variable_sig_size = UINT32_MAX );
+
+      /// Thread safe. Recovers the keys on the calling thread, for callers already running on the thread pool.
+      /// @returns transaction_metadata_ptr, throws on failure
+      static transaction_metadata_ptr
+      recover_keys( packed_transaction_ptr trx, const chain_id_type& chain_id, fc::microseconds time_limit,
+                    uint32_t max_variable_sig_size = UINT32_MAX );
+
       /// @returns constructed transaction_metadata with no key recovery (sig_cpu_usage=0, recovered_pub_keys=empty)
       static transaction_metadata_ptr
       create_no_recover_keys( packed_transaction_ptr trx, trx_type t ) {
          return std::make_shared<transaction_metadata>( private_type(), std::move(trx),
-               fc::microseconds(), flat_set<public_key_type>(), t == trx_type::implicit, t == trx_type::scheduled );
+               fc::microseconds(), flat_set<public_key_type>(), t == trx_type::implicit, t == trx_type::scheduled,
+               t == trx_type::dry_run );
       }
 
 };
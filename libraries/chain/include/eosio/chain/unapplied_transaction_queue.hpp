@@ -9,6 +9,11 @@
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/member.hpp>
 
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+#include <vector>
+
 namespace fc {
   inline std::size_t hash_value( const fc::sha256& v ) {
      return v._hash[3];
@@ -47,6 +52,11 @@ struct unapplied_transaction {
 /**
  * Track unapplied transactions for persisted, forked blocks, and aborted blocks.
  * Persisted are first so that they can be applied in each block until expired.
+ *
+ * Incoming transactions are processed in arrival order unless fair incoming scheduling is enabled. Then each
+ * incoming transaction is given a virtual finish time of its first authorizer's previous finish time plus its
+ * expected cost, and next_incoming() returns the lowest finish time first. Cheap transactions are not starved
+ * behind a burst from a single heavy account, and accounts with equal cost are served round robin.
  */
 class unapplied_transaction_queue {
 private:
@@ -64,14 +74,45 @@ private:
       >
    > unapplied_trx_queue_type;
 
+   struct incoming_schedule_entry {
+      uint64_t            finish = 0; // virtual finish time, lowest first
+      uint64_t            seq = 0;    // arrival order, breaks ties
+      transaction_id_type id;
+   };
+
+   struct incoming_schedule_greater {
+      bool operator()( const incoming_schedule_entry& a, const incoming_schedule_entry& b ) const {
+         return a.finish > b.finish || (a.finish == b.finish && a.seq > b.seq);
+      }
+   };
+
+   struct incoming_schedule_class {
+      std::vector<incoming_schedule_entry>         heap;              // min-heap, entries no longer matching a trx are dropped lazily
+      std::vector<incoming_schedule_entry>         skipped;           // removed from heap by skip_incoming() until restored
+      std::unordered_map<account_name, uint64_t>   account_finish;    // last virtual finish time scheduled per first authorizer
+      uint64_t                                     virtual_time = 0;  // finish time of the last trx returned by next_incoming()
+   };
+
    unapplied_trx_queue_type queue;
    uint64_t max_transaction_queue_size = 1024*1024*1024; // enforced for incoming
+   uint64_t max_account_queue_size = 0; // enforced for incoming per first authorizer, 0 for no limit
    uint64_t size_in_bytes = 0;
    size_t incoming_count = 0;
+   std::unordered_map<account_name, uint64_t> incoming_account_bytes; // bytes of incoming trxs per first authorizer
+
+   bool                                     fair_incoming_scheduling = false;
+   std::array<incoming_schedule_class, 2>   incoming_schedule; // incoming_persisted, incoming
+   uint64_t                                 schedule_seq = 0;
 
 public:
 
    void set_max_transaction_queue_size( uint64_t v ) { max_transaction_queue_size = v; }
+   /// call before adding incoming transactions, per account usage is only tracked while a limit is set
+   void set_max_account_queue_size( uint64_t v ) { max_account_queue_size = v; }
+
+   /// only transactions added after enabling are scheduled by cost, call before adding incoming transactions
+   void set_fair_incoming_scheduling( bool v ) { fair_incoming_scheduling = v; }
+   bool is_fair_incoming_scheduling() const { return fair_incoming_scheduling; }
 
    bool empty() const {
       return queue.empty();
@@ -83,6 +124,13 @@ public:
 
    void clear() {
       queue.clear();
+      incoming_account_bytes.clear();
+      reset_incoming_schedule();
+   }
+
+   /// bytes of the transactions in the queue, as counted against max_transaction_queue_size
+   uint64_t bytes_size()const {
+      return size_in_bytes;
    }
 
    size_t incoming_size()const {
@@ -175,26 +223,34 @@ public:
          if( insert_itr.second ) added( insert_itr.first );
       } else if( itr->trx_type != trx_enum_type::persisted ) {
          if (itr->trx_type == trx_enum_type::incoming || itr->trx_type == trx_enum_type::incoming_persisted)
-            --incoming_count;
+            incoming_removed( itr->trx_meta );
          queue.get<by_trx_id>().modify( itr, [](auto& un){
             un.trx_type = trx_enum_type::persisted;
          } );
       }
    }
 
-   void add_incoming( const transaction_metadata_ptr& trx, bool persist_until_expired, next_func_t next ) {
+   /// @param expected_cpu_us estimated cost used to order the trx when fair incoming scheduling is enabled
+   void add_incoming( const transaction_metadata_ptr& trx, bool persist_until_expired, next_func_t next,
+                      uint32_t expected_cpu_us = 0 ) {
+      const trx_enum_type type = persist_until_expired ? trx_enum_type::incoming_persisted : trx_enum_type::incoming;
       auto itr = queue.get<by_trx_id>().find( trx->id() );
       if( itr == queue.get<by_trx_id>().end() ) {
+         check_incoming_limits( trx );
          fc::time_point expiry = trx->packed_trx()->expiration();
-         auto insert_itr = queue.insert(
-               { trx, expiry, persist_until_expired ? trx_enum_type::incoming_persisted : trx_enum_type::incoming, std::move( next ) } );
-         if( insert_itr.second ) added( insert_itr.first );
+         auto insert_itr = queue.insert( { trx, expiry, type, std::move( next ) } );
+         if( insert_itr.second ) {
+            added( insert_itr.first );
+            schedule_incoming( trx, type, expected_cpu_us );
+         }
       } else {
          if (itr->trx_type != trx_enum_type::incoming && itr->trx_type != trx_enum_type::incoming_persisted)
-            ++incoming_count;
+            incoming_added( itr->trx_meta );
+         if( itr->trx_type != type )
+            schedule_incoming( trx, type, expected_cpu_us );
 
-         queue.get<by_trx_id>().modify( itr, [persist_until_expired, next{std::move(next)}](auto& un) mutable {
-            un.trx_type = persist_until_expired ? trx_enum_type::incoming_persisted : trx_enum_type::incoming;
+         queue.get<by_trx_id>().modify( itr, [type, next{std::move(next)}](auto& un) mutable {
+            un.trx_type = type;
             un.next = std::move( next );
          } );
       }
@@ -215,6 +271,67 @@ public:
    iterator incoming_begin() { return queue.get<by_type>().lower_bound( trx_enum_type::incoming_persisted ); }
    iterator incoming_end() { return queue.get<by_type>().end(); } // if changed to upper_bound, verify usage performance
 
+   /// next incoming trx to process, incoming_persisted before incoming. In order of arrival unless fair incoming
+   /// scheduling is enabled. Returns incoming_end() if there are no incoming trxs.
+   iterator next_incoming() {
+      if( !fair_incoming_scheduling ) return incoming_begin();
+      if( incoming_count == 0 ) {
+         reset_incoming_schedule();
+         return incoming_end();
+      }
+      auto& idx = queue.get<by_trx_id>();
+      for( size_t i = 0; i < incoming_schedule.size(); ++i ) {
+         const trx_enum_type type = i == 0 ? trx_enum_type::incoming_persisted : trx_enum_type::incoming;
+         auto& sched = incoming_schedule[i];
+         auto& heap = sched.heap;
+         while( !heap.empty() ) {
+            const auto& top = heap.front();
+            auto itr = idx.find( top.id );
+            if( itr != idx.end() && itr->trx_type == type ) {
+               sched.virtual_time = std::max( sched.virtual_time, top.finish );
+               return queue.project<by_type>( itr );
+            }
+            // erased or changed type since scheduled
+            std::pop_heap( heap.begin(), heap.end(), incoming_schedule_greater() );
+            heap.pop_back();
+         }
+      }
+      // remaining incoming are skipped
+      return incoming_end();
+   }
+
+   /// leave itr, as returned by next_incoming(), in the queue but have next_incoming() return the following trx.
+   /// In arrival order itr moves to the back of its class; with fair incoming scheduling it is not returned again
+   /// until restore_skipped_incoming().
+   void skip_incoming( iterator itr ) {
+      if( fair_incoming_scheduling ) {
+         auto& sched = incoming_schedule[itr->trx_type == trx_enum_type::incoming_persisted ? 0 : 1];
+         if( !sched.heap.empty() && sched.heap.front().id == itr->id() ) {
+            std::pop_heap( sched.heap.begin(), sched.heap.end(), incoming_schedule_greater() );
+            sched.skipped.push_back( std::move( sched.heap.back() ) );
+            sched.heap.pop_back();
+         }
+         return;
+      }
+      next_func_t next;
+      auto& idx = queue.get<by_type>();
+      idx.modify( itr, [&next]( auto& un ) { next = std::move( un.next ); } );
+      unapplied_transaction un{ itr->trx_meta, itr->expiry, itr->trx_type, std::move( next ) };
+      idx.erase( itr );
+      // inserted after trxs of the same type
+      queue.insert( std::move( un ) );
+   }
+
+   void restore_skipped_incoming() {
+      for( auto& sched : incoming_schedule ) {
+         for( auto& e : sched.skipped ) {
+            sched.heap.push_back( std::move( e ) );
+            std::push_heap( sched.heap.begin(), sched.heap.end(), incoming_schedule_greater() );
+         }
+         sched.skipped.clear();
+      }
+   }
+
    /// caller's responsibilty to call next() if applicable
    iterator erase( iterator itr ) {
       removed( itr );
@@ -222,24 +339,75 @@ public:
    }
 
 private:
+   void schedule_incoming( const transaction_metadata_ptr& trx, trx_enum_type type, uint32_t expected_cpu_us ) {
+      if( !fair_incoming_scheduling ) return;
+      auto& sched = incoming_schedule[type == trx_enum_type::incoming_persisted ? 0 : 1];
+      auto& finish = sched.account_finish[trx->packed_trx()->get_transaction().first_authorizer()];
+      // every trx costs at least 1 so transactions without history are still round robin by account
+      finish = std::max( finish, sched.virtual_time ) + 1 + expected_cpu_us;
+      sched.heap.push_back( incoming_schedule_entry{ finish, ++schedule_seq, trx->id() } );
+      std::push_heap( sched.heap.begin(), sched.heap.end(), incoming_schedule_greater() );
+   }
+
+   void reset_incoming_schedule() {
+      for( auto& sched : incoming_schedule ) {
+         sched.heap.clear();
+         sched.skipped.clear();
+         sched.account_finish.clear();
+         sched.virtual_time = 0;
+      }
+   }
+
+   /// checked before insert so a rejected trx is not left in the queue
+   void check_incoming_limits( const transaction_metadata_ptr& trx ) const {
+      auto size = calc_size( trx );
+      EOS_ASSERT( size_in_bytes + size < max_transaction_queue_size, tx_resource_exhaustion,
+                  "Transaction ${id}, size ${s} bytes would exceed configured "
+                  "incoming-transaction-queue-size-mb ${qs}, current queue size ${cs} bytes",
+                  ("id", trx->id())("s", size)("qs", max_transaction_queue_size/(1024*1024))
+                  ("cs", size_in_bytes) );
+      if( max_account_queue_size > 0 ) {
+         const auto first_auth = trx->packed_trx()->get_transaction().first_authorizer();
+         auto aitr = incoming_account_bytes.find( first_auth );
+         const uint64_t account_bytes = aitr != incoming_account_bytes.end() ? aitr->second : 0;
+         EOS_ASSERT( account_bytes + size < max_account_queue_size, tx_resource_exhaustion,
+                     "Transaction ${id}, size ${s} bytes would exceed configured "
+                     "incoming-transaction-queue-account-size-mb ${qs} for ${a}, current account queue size ${cs} bytes",
+                     ("id", trx->id())("s", size)("qs", max_account_queue_size/(1024*1024))("a", first_auth)
+                     ("cs", account_bytes) );
+      }
+   }
+
+   void incoming_added( const transaction_metadata_ptr& trx ) {
+      ++incoming_count;
+      if( max_account_queue_size > 0 ) {
+         incoming_account_bytes[trx->packed_trx()->get_transaction().first_authorizer()] += calc_size( trx );
+      }
+   }
+
+   void incoming_removed( const transaction_metadata_ptr& trx ) {
+      --incoming_count;
+      if( max_account_queue_size > 0 ) {
+         auto aitr = incoming_account_bytes.find( trx->packed_trx()->get_transaction().first_authorizer() );
+         if( aitr != incoming_account_bytes.end() ) {
+            aitr->second -= std::min( aitr->second, calc_size( trx ) );
+            if( aitr->second == 0 ) incoming_account_bytes.erase( aitr );
+         }
+      }
+   }
+
    template<typename Itr>
    void added( Itr itr ) {
-      auto size = calc_size( itr->trx_meta );
       if( itr->trx_type == trx_enum_type::incoming || itr->trx_type == trx_enum_type::incoming_persisted ) {
-         ++incoming_count;
-         EOS_ASSERT( size_in_bytes + size < max_transaction_queue_size, tx_resource_exhaustion,
-                     "Transaction ${id}, size ${s} bytes would exceed configured "
-                     "incoming-transaction-queue-size-mb ${qs}, current queue size ${cs} bytes",
-                     ("id", itr->trx_meta->id())("s", size)("qs", max_transaction_queue_size/(1024*1024))
-                     ("cs", size_in_bytes) );
+         incoming_added( itr->trx_meta );
       }
-      size_in_bytes += size;
+      size_in_bytes += calc_size( itr->trx_meta );
    }
 
    template<typename Itr>
    void removed( Itr itr ) {
       if( itr->trx_type == trx_enum_type::incoming || itr->trx_type == trx_enum_type::incoming_persisted ) {
-         --incoming_count;
+         incoming_removed( itr->trx_meta );
       }
       size_in_bytes -= calc_size( itr->trx_meta );
    }
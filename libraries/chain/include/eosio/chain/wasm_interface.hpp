@@ -3,6 +3,7 @@
 #include <eosio/chain/types.hpp>
 #include <eosio/chain/whitelisted_intrinsics.hpp>
 #include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/memory_usage.hpp>
 #include "Runtime/Linker.h"
 #include "Runtime/Runtime.h"
 
@@ -48,7 +49,11 @@ namespace eosio { namespace chain {
          void indicate_shutting_down();
 
          //validates code -- does a WASM validation pass and checks the wasm against EOSIO specific constraints
-         static void validate(const controller& control, const bytes& code);
+         // the passes over large code run concurrently on the thread pool of control
+         static void validate(controller& control, const bytes& code);
+
+         //indicate that code was just set, queues its tier-up compile if configured so it is likely ready by its first execution
+         void code_set(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version);
 
          //indicate that a particular code probably won't be used after given block_num
          void code_block_num_last_used(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version, const uint32_t& block_num);
@@ -56,6 +61,13 @@ namespace eosio { namespace chain {
          //indicate the current LIB. evicts old cache entries
          void current_lib(const uint32_t lib);
 
+         //instantiate up to instantiate_contracts widely deployed contracts with the base runtime and queue tier-up
+         // compiles of them, if configured. call once state is loaded
+         void warm_up(uint32_t instantiate_contracts);
+
+         //instantiated modules of the base runtime, as entries only, and the EOS VM OC code cache
+         std::vector<subsystem_memory> memory_usage()const;
+
          //Calls apply or error on a given code
          void apply(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version, apply_context& context);
 
@@ -48,6 +48,10 @@ namespace eosio { namespace chain {
       struct by_last_block_num;
 
 #ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+      //only one thread may execute through the tier. A pool of executor/memory pairs per thread is not enough for
+      // concurrent execution: the descriptor returned by the code cache is only valid until the next cache call, as that
+      // call may evict it and let the compile monitor reuse its space, so concurrent executions would also need entries
+      // to be pinned while running and the cache to be synchronized
       struct eosvmoc_tier {
          eosvmoc_tier(const boost::filesystem::path& d, const eosvmoc::config& c, const chainbase::database& db)
           : cc(d, c, db), exec(cc),
@@ -154,40 +158,79 @@ namespace eosio { namespace chain {
                trx_context.resume_billing_timer();
             });
             trx_context.pause_billing_timer();
-            IR::Module module;
-            std::vector<U8> bytes = {
-                (const U8*)codeobject->code.data(),
-                (const U8*)codeobject->code.data() + codeobject->code.size()};
+            wasm_instantiation_cache.modify(it, [&](auto& c) {
+               c.module = instantiate_module(*codeobject);
+            });
+         }
+         return it->module;
+      }
+
+      std::unique_ptr<wasm_instantiated_module_interface> instantiate_module(const code_object& codeobject) {
+         if(!runtime_interface->needs_ir_module())
+            return runtime_interface->instantiate_module(codeobject.code.data(), codeobject.code.size(), {}, codeobject.code_hash, codeobject.vm_type, codeobject.vm_version);
+
+         IR::Module module;
+         std::vector<U8> bytes = {
+             (const U8*)codeobject.code.data(),
+             (const U8*)codeobject.code.data() + codeobject.code.size()};
+         try {
+            Serialization::MemoryInputStream stream((const U8*)bytes.data(),
+                                                    bytes.size());
+            WASM::scoped_skip_checks no_check;
+            WASM::serialize(stream, module);
+            module.userSections.clear();
+         } catch (const Serialization::FatalSerializationException& e) {
+            EOS_ASSERT(false, wasm_serialization_error, e.message.c_str());
+         } catch (const IR::ValidationException& e) {
+            EOS_ASSERT(false, wasm_serialization_error, e.message.c_str());
+         }
+         if (runtime_interface->inject_module(module)) {
             try {
-               Serialization::MemoryInputStream stream((const U8*)bytes.data(),
-                                                       bytes.size());
-               WASM::scoped_skip_checks no_check;
-               WASM::serialize(stream, module);
-               module.userSections.clear();
+               Serialization::ArrayOutputStream outstream;
+               WASM::serialize(outstream, module);
+               bytes = outstream.getBytes();
             } catch (const Serialization::FatalSerializationException& e) {
-               EOS_ASSERT(false, wasm_serialization_error, e.message.c_str());
+               EOS_ASSERT(false, wasm_serialization_error,
+                          e.message.c_str());
             } catch (const IR::ValidationException& e) {
-               EOS_ASSERT(false, wasm_serialization_error, e.message.c_str());
-            }
-            if (runtime_interface->inject_module(module)) {
-               try {
-                  Serialization::ArrayOutputStream outstream;
-                  WASM::serialize(outstream, module);
-                  bytes = outstream.getBytes();
-               } catch (const Serialization::FatalSerializationException& e) {
-                  EOS_ASSERT(false, wasm_serialization_error,
-                             e.message.c_str());
-               } catch (const IR::ValidationException& e) {
-                  EOS_ASSERT(false, wasm_serialization_error,
-                             e.message.c_str());
-               }
+               EOS_ASSERT(false, wasm_serialization_error,
+                          e.message.c_str());
             }
+         }
 
-            wasm_instantiation_cache.modify(it, [&](auto& c) {
-               c.module = runtime_interface->instantiate_module((const char*)bytes.data(), bytes.size(), parse_initial_memory(module), code_hash, vm_type, vm_version);
-            });
+         return runtime_interface->instantiate_module((const char*)bytes.data(), bytes.size(), parse_initial_memory(module), codeobject.code_hash, codeobject.vm_type, codeobject.vm_version);
+      }
+
+      //instantiates up to count of the most widely deployed contracts so they are not instantiated on first execution
+      void warm_up(uint32_t count) {
+         std::vector<const code_object*> codes;
+         for(const code_object& co : db.get_index<code_index>().indices())
+            if(co.vm_type == 0)
+               codes.push_back(&co);
+         count = std::min<size_t>(count, codes.size());
+         std::partial_sort(codes.begin(), codes.begin() + count, codes.end(), [](const code_object* a, const code_object* b) {
+            return std::tie(a->code_ref_count, a->first_block_used) > std::tie(b->code_ref_count, b->first_block_used);
+         });
+
+         const auto start = fc::time_point::now();
+         uint32_t instantiated = 0;
+         for(uint32_t i = 0; i < count; ++i) {
+            const code_object& co = *codes[i];
+            if(wasm_instantiation_cache.count(boost::make_tuple(co.code_hash, co.vm_type, co.vm_version)))
+               continue;
+            try {
+               wasm_instantiation_cache.emplace( wasm_interface_impl::wasm_cache_entry{
+                                                    .code_hash = co.code_hash,
+                                                    .first_block_num_used = co.first_block_used,
+                                                    .last_block_num_used = UINT32_MAX,
+                                                    .module = instantiate_module(co),
+                                                    .vm_type = co.vm_type,
+                                                    .vm_version = co.vm_version
+                                                 } );
+               ++instantiated;
+            } FC_LOG_AND_DROP(("failed to instantiate code ${c} during warm up", ("c", co.code_hash)));
          }
-         return it->module;
+         ilog("Instantiated ${n} of ${c} most deployed contracts in ${t}ms", ("n", instantiated)("c", count)("t", (fc::time_point::now() - start).count()/1000));
       }
 
       bool is_shutting_down = false;
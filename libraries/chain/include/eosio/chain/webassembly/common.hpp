@@ -7,6 +7,8 @@
 #include <eosio/vm/span.hpp>
 #include <eosio/vm/types.hpp>
 
+#include <algorithm>
+
 using namespace fc;
 
 namespace eosio { namespace chain { namespace webassembly {
@@ -68,10 +70,10 @@ namespace eosio { namespace chain {
       using base_type::elem_type;
       using base_type::get_host;
 
+      // dst must be valid even for a zero size, a single check of max(size, 1) bytes covers both
       EOS_VM_FROM_WASM(memcpy_params, (void* dst, const void* src, vm::wasm_size_t size)) {
-         validate_pointer<char>(dst, size);
+         validate_pointer<char>(dst, std::max<vm::wasm_size_t>(size, 1));
          validate_pointer<char>(src, size);
-         validate_pointer<char>(dst, 1);
          return { dst, src, size };
       }
 
@@ -82,8 +84,7 @@ namespace eosio { namespace chain {
       }
 
       EOS_VM_FROM_WASM(memset_params, (void* dst, int32_t val, vm::wasm_size_t size)) {
-         validate_pointer<char>(dst, size);
-         validate_pointer<char>(dst, 1);
+         validate_pointer<char>(dst, std::max<vm::wasm_size_t>(size, 1));
          return { dst, val, size };
       }
 
@@ -31,6 +31,7 @@ class eosvmoc_runtime : public eosio::chain::wasm_runtime_interface {
       eosvmoc_runtime(const boost::filesystem::path data_dir, const eosvmoc::config& eosvmoc_config, const chainbase::database& db);
       ~eosvmoc_runtime();
       bool inject_module(IR::Module&) override { return false; }
+      bool needs_ir_module() const override { return false; }
       std::unique_ptr<wasm_instantiated_module_interface> instantiate_module(const char* code_bytes, size_t code_size, std::vector<uint8_t> initial_memory,
                                                                              const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version) override;
 
@@ -197,10 +198,10 @@ struct eos_vm_oc_type_converter : public eosio::vm::type_converter<webassembly::
 
    EOS_VM_FROM_WASM(bool, (uint32_t value)) { return value ? 1 : 0; }
 
+   // dst must be valid even for a zero size, a single check of max(size, 1) bytes covers both
    EOS_VM_FROM_WASM(memcpy_params, (vm::wasm_ptr_t dst, vm::wasm_ptr_t src, vm::wasm_size_t size)) {
-      auto d = array_ptr_impl<char>(dst, size);
+      auto d = array_ptr_impl<char>(dst, std::max<vm::wasm_size_t>(size, 1));
       auto s = array_ptr_impl<char>(src, size);
-      array_ptr_impl<char>(dst, 1);
       return { d, s, size };
    }
 
@@ -211,8 +212,7 @@ struct eos_vm_oc_type_converter : public eosio::vm::type_converter<webassembly::
    }
 
    EOS_VM_FROM_WASM(memset_params, (vm::wasm_ptr_t dst, int32_t val, vm::wasm_size_t size)) {
-     auto d = array_ptr_impl<char>(dst, size);
-     array_ptr_impl<char>(dst, 1);
+     auto d = array_ptr_impl<char>(dst, std::max<vm::wasm_size_t>(size, 1));
      return { d, val, size };
    }
 
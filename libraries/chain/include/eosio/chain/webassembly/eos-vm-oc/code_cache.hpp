@@ -4,6 +4,7 @@
 
 #include <eosio/chain/webassembly/eos-vm-oc/eos-vm-oc.hpp>
 #include <eosio/chain/webassembly/eos-vm-oc/ipc_helpers.hpp>
+#include <eosio/chain/webassembly/eos-vm-oc/perf_map.hpp>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/sequenced_index.hpp>
@@ -24,6 +25,10 @@ namespace std {
     };
 }
 
+namespace eosio { namespace chain {
+class code_object;
+}}
+
 namespace eosio { namespace chain { namespace eosvmoc {
 
 using namespace boost::multi_index;
@@ -36,6 +41,12 @@ using allocator_t = bip::rbtree_best_fit<bip::null_mutex_family, bip::offset_ptr
 
 struct config;
 
+//uses counts executions of the code, halved each time eviction passes over the entry because it was used more than once.
+// one-off contracts are evicted before reused ones even when they ran more recently
+struct code_cache_entry : code_descriptor {
+   mutable uint32_t uses = 0;
+};
+
 class code_cache_base {
    public:
       code_cache_base(const bfs::path data_dir, const eosvmoc::config& eosvmoc_config, const chainbase::database& db);
@@ -45,15 +56,22 @@ class code_cache_base {
 
       void free_code(const digest_type& code_id, const uint8_t& vm_version);
 
+      //bytes of the cache in use as of the last compile, not counting evictions since
+      size_t used_bytes() const { return _cache_size - _free_bytes; }
+      size_t number_of_entries() const { return _cache_index.size(); }
+
+      //nullptr unless the perf map is enabled
+      eosvmoc::perf_map* perf_map() const { return _perf_map.get(); }
+
    protected:
       struct by_hash;
 
       typedef boost::multi_index_container<
-         code_descriptor,
+         code_cache_entry,
          indexed_by<
             sequenced<>,
             hashed_unique<tag<by_hash>,
-               composite_key< code_descriptor,
+               composite_key< code_cache_entry,
                   member<code_descriptor, digest_type, &code_descriptor::code_hash>,
                   member<code_descriptor, uint8_t,     &code_descriptor::vm_version>
                >
@@ -76,12 +94,27 @@ class code_cache_base {
       std::unordered_set<code_tuple> _queued_compiles;
       std::unordered_map<code_tuple, bool> _outstanding_compiles_and_poison;
 
+      //tier-up progress of code that is queued or compiling, dropped once the compile completes or the code is freed
+      struct tier_up_stats {
+         uint32_t       fallbacks = 0; //executions on the base runtime while waiting for EOS VM OC
+         fc::time_point queued;
+         fc::time_point started;
+      };
+      std::unordered_map<code_tuple, tier_up_stats> _tier_up_stats;
+
       size_t _free_bytes_eviction_threshold;
+      size_t _cache_size = 0;
+      size_t _free_bytes = 0;
       void check_eviction_threshold(size_t free_bytes);
       void run_eviction_round();
+      void record_use(code_cache_index::index<by_hash>::type::iterator it);
 
       void set_on_disk_region_dirty(bool);
 
+      std::unique_ptr<eosvmoc::perf_map> _perf_map;
+      //fills the layout of the functions of a compile from the fd the compile monitor passed on, when the perf map needs it
+      void unpack_functions(wasm_compilation_result_message& result, const std::vector<wrapped_fd>& fds) const;
+
       template <typename T>
       void serialize_cache_index(fc::datastream<T>& ds);
 };
@@ -94,15 +127,24 @@ class code_cache_async : public code_cache_base {
       //If code is in cache: returns pointer & bumps to front of MRU list
       //If code is not in cache, and not blacklisted, and not currently compiling: return nullptr and kick off compile
       //otherwise: return nullptr
+      //Once a compile thread frees up, the queued code with the most executions that fell back is compiled next
       const code_descriptor* const get_descriptor_for_code(const digest_type& code_id, const uint8_t& vm_version);
 
+      //Queues compiles of the contracts deployed on the most accounts that are not already in the cache, so
+      // they are available before they are first executed. Does nothing unless warmup_contracts is configured.
+      void warm_up();
+
    private:
+      void start_compile(const code_tuple& ct, const code_object& codeobject);
+      void queue_compile(const code_tuple& ct);
+
       std::thread _monitor_reply_thread;
       boost::lockfree::spsc_queue<wasm_compilation_result_message> _result_queue;
       void wait_on_compile_monitor_message();
       std::tuple<size_t, size_t> consume_compile_thread_queue();
       std::unordered_set<code_tuple> _blacklist;
       size_t _threads;
+      uint32_t _warmup_contracts;
 };
 
 class code_cache_sync : public code_cache_base {
@@ -13,6 +13,9 @@ namespace eosio { namespace chain { namespace eosvmoc {
 struct config {
    uint64_t cache_size = 1024u*1024u*1024u;
    uint64_t threads    = 1u;
+   uint32_t warmup_contracts = 0u; ///< number of most widely deployed contracts to compile at startup
+   boost::filesystem::path seed_cache_file; ///< cleanly closed code cache copied in when there is no code cache yet
+   bool perf_map = false; ///< write the symbols of executed code to /tmp/perf-<pid>.map for profilers
 };
 
 }}}
@@ -43,6 +43,13 @@ struct code_descriptor {
    unsigned initdata_prologue_size;
 };
 
+//where the code generated for a wasm function lies, relative to code_begin. function_index counts the imports, as in wasm
+struct wasm_function_symbol {
+   uint32_t function_index;
+   uint32_t offset;
+   uint32_t size;
+};
+
 enum eosvmoc_exitcode : int {
    EOSVMOC_EXIT_CLEAN_EXIT = 1,
    EOSVMOC_EXIT_CHECKTIME_FAIL,
@@ -56,5 +63,6 @@ FC_REFLECT(eosio::chain::eosvmoc::no_offset, );
 FC_REFLECT(eosio::chain::eosvmoc::code_offset, (offset));
 FC_REFLECT(eosio::chain::eosvmoc::intrinsic_ordinal, (ordinal));
 FC_REFLECT(eosio::chain::eosvmoc::code_descriptor, (code_hash)(vm_version)(codegen_version)(code_begin)(start)(apply_offset)(starting_memory_pages)(initdata_begin)(initdata_size)(initdata_prologue_size));
+FC_REFLECT(eosio::chain::eosvmoc::wasm_function_symbol, (function_index)(offset)(size));
 
 #define EOSVMOC_INTRINSIC_INIT_PRIORITY __attribute__((init_priority(198)))
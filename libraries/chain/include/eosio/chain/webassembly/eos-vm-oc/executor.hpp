@@ -19,6 +19,7 @@ namespace eosvmoc {
 
 class code_cache_base;
 class memory;
+class perf_map;
 struct code_descriptor;
 
 class executor {
@@ -32,6 +33,7 @@ class executor {
       uint8_t* code_mapping;
       size_t code_mapping_size;
       bool mapping_is_executable;
+      eosvmoc::perf_map* const code_perf_map;
 
       std::exception_ptr executors_exception_ptr;
       sigjmp_buf executors_sigjmp_buf;
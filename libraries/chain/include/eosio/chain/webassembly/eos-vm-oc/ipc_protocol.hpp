@@ -34,7 +34,7 @@ struct code_compilation_result_message {
    unsigned apply_offset;
    int starting_memory_pages;
    unsigned initdata_prologue_size;
-   //Two sent fds: 1) wasm code, 2) initial memory snapshot
+   //Three sent fds: 1) wasm code, 2) initial memory snapshot, 3) packed std::vector<wasm_function_symbol> of the code
 };
 
 
@@ -49,6 +49,9 @@ struct wasm_compilation_result_message {
    code_tuple code;
    wasm_compilation_result result;
    size_t cache_free_bytes;
+   //layout of the code of a successful compile. The compile monitor passes it on as a sent fd, since it can exceed the
+   // size of a message, and the code cache unpacks it here
+   std::vector<wasm_function_symbol> functions;
 };
 
 using eosvmoc_message = std::variant<initialize_message,
@@ -67,4 +70,4 @@ FC_REFLECT(eosio::chain::eosvmoc::evict_wasms_message, (codes))
 FC_REFLECT(eosio::chain::eosvmoc::code_compilation_result_message, (start)(apply_offset)(starting_memory_pages)(initdata_prologue_size))
 FC_REFLECT(eosio::chain::eosvmoc::compilation_result_unknownfailure, )
 FC_REFLECT(eosio::chain::eosvmoc::compilation_result_toofull, )
-FC_REFLECT(eosio::chain::eosvmoc::wasm_compilation_result_message, (code)(result)(cache_free_bytes))
+FC_REFLECT(eosio::chain::eosvmoc::wasm_compilation_result_message, (code)(result)(cache_free_bytes)(functions))
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <eosio/chain/webassembly/eos-vm-oc/eos-vm-oc.hpp>
+
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace eosio { namespace chain { namespace eosvmoc {
+
+/**
+ * Writes /tmp/perf-<pid>.map, the symbol map perf and other profilers read for code generated at runtime, so samples
+ * in EOS VM OC code are attributed to the contract and the wasm function instead of an anonymous address.
+ *
+ * The executor maps the code cache at an address only it knows, so the symbols of a code are written the first time
+ * it executes at a given address: one per wasm function, named "wasm:<account>:<code hash prefix>:f<function index>",
+ * when the layout of the functions is known from compiling the code in this process. Code compiled by an earlier
+ * process and loaded from the code cache only gets a single symbol for its whole code, "wasm:<account>:<code hash prefix>".
+ * The account is the first receiver the code executed for; code shared by several accounts keeps that name.
+ */
+class perf_map {
+   public:
+      perf_map();
+      ~perf_map();
+
+      perf_map(const perf_map&) = delete;
+      perf_map& operator=(const perf_map&) = delete;
+
+      /// remembers the functions of a code compiled in this process, written once the code executes
+      void add_code_layout(const digest_type& code_id, std::vector<wasm_function_symbol> functions);
+
+      /// writes the symbols of code, code_size bytes mapped at code_mapping + code.code_begin, when they were not
+      /// written for that address yet
+      void add_code(const code_descriptor& code, const uint8_t* code_mapping, size_t code_size, account_name account);
+
+   private:
+      std::mutex _mtx;
+      FILE* _file = nullptr;
+      std::map<digest_type, std::vector<wasm_function_symbol>> _layouts;
+      std::map<const uint8_t*, digest_type> _written;
+};
+
+}}}
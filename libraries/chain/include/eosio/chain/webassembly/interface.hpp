@@ -905,6 +905,21 @@ namespace webassembly {
           */
          int32_t db_end_i64(uint64_t code, uint64_t scope, uint64_t table);
 
+         /**
+          * Get the records of consecutive table rows in a primary 64-bit integer index table, starting at the referenced table row.
+          * Each record is written to the buffer as its 32-bit size followed by its data. Only whole records are copied.
+          *
+          * @ingroup database primary-index
+          * @param itr - the iterator to the first table row to retrieve.
+          * @param max_rows - the maximum number of records to retrieve.
+          * @param[out] buffer - the buffer which will be filled with the retrieved records.
+          * @param[out] rows - number of records copied into the buffer.
+          *
+          * @return iterator to the table row following the last retrieved record (or the end iterator of the table if the last table row was retrieved), or `itr` if no record was retrieved.
+          * @pre `itr` points to an existing table row in the table or is an end iterator.
+          */
+         int32_t db_get_batch_i64(int32_t itr, uint32_t max_rows, span<char> buffer, uint32_t* rows);
+
          /**
           * Store an association of a 64-bit integer secondary key to a primary key in a secondary 64-bit integer index table.
           *
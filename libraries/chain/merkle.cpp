@@ -1,8 +1,30 @@
 #include <eosio/chain/merkle.hpp>
 #include <fc/io/raw.hpp>
 
+#include <cstring>
+
 namespace eosio { namespace chain {
 
+namespace {
+
+/**
+ * same result as digest_type::hash(make_canonical_pair(l, r)); the pair is laid out in one buffer and hashed in a
+ * single call instead of going through the datastream encoder one digest at a time
+ */
+digest_type hash_canonical_pair(const digest_type& l, const digest_type& r) {
+   static_assert( sizeof(l._hash) == 4 * sizeof(uint64_t), "merkle nodes are expected to be sha256 digests" );
+
+   uint64_t buf[8];
+   std::memcpy(buf,     l._hash, sizeof(l._hash));
+   std::memcpy(buf + 4, r._hash, sizeof(r._hash));
+   buf[0] &= 0xFFFFFFFFFFFFFF7FULL;
+   buf[4] |= 0x0000000000000080ULL;
+
+   return digest_type::hash(reinterpret_cast<const char*>(buf), sizeof(buf));
+}
+
+}
+
 /**
  * in order to keep proofs concise, before hashing we set the first bit
  * of the previous hashes to 0 or 1 to indicate the side it is on
@@ -40,7 +62,7 @@ digest_type merkle(deque<digest_type> ids) {
          ids.push_back(ids.back());
 
       for (size_t i = 0; i < ids.size() / 2; i++) {
-         ids[i] = digest_type::hash(make_canonical_pair(ids[2 * i], ids[(2 * i) + 1]));
+         ids[i] = hash_canonical_pair(ids[2 * i], ids[(2 * i) + 1]);
       }
 
       ids.resize(ids.size() / 2);
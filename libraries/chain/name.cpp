@@ -1,6 +1,5 @@
 #include <eosio/chain/name.hpp>
 #include <fc/variant.hpp>
-#include <boost/algorithm/string.hpp>
 
 namespace eosio::chain {
 
@@ -10,19 +9,26 @@ namespace eosio::chain {
 
    // keep in sync with name::to_string() in contract definition for name
    std::string name::to_string()const {
-     static const char* charmap = ".12345abcdefghijklmnopqrstuvwxyz";
+      char buf[max_string_size];
+      return std::string( buf, write_as_string( buf ) );
+   }
 
-      std::string str(13,'.');
+   size_t name::write_as_string( char* buf )const {
+      static const char* charmap = ".12345abcdefghijklmnopqrstuvwxyz";
 
-      uint64_t tmp = value;
-      for( uint32_t i = 0; i <= 12; ++i ) {
-         char c = charmap[tmp & (i == 0 ? 0x0f : 0x1f)];
-         str[12-i] = c;
-         tmp >>= (i == 0 ? 4 : 5);
-      }
+      if( value == 0 )
+         return 0;
+
+      // the trailing dots are the zero bits at the low end: 4 bits for the 13th char, 5 bits for each char before it
+      const int    zeros = __builtin_ctzll( value );
+      const size_t size  = zeros < 4 ? 13 : 12 - ( zeros - 4 ) / 5;
 
-      boost::algorithm::trim_right_if( str, []( char c ){ return c == '.'; } );
-      return str;
+      // every char is taken from its own slot, so there is no dependency from one char to the next
+      for( size_t i = 0; i < size && i < 12; ++i )
+         buf[i] = charmap[( value >> ( 59 - 5 * i ) ) & 0x1f];
+      if( size == 13 )
+         buf[12] = charmap[value & 0x0f];
+      return size;
    }
 
    bool is_string_valid_name(std::string_view str)
@@ -0,0 +1,71 @@
+#include <eosio/chain/non_consensus_executor.hpp>
+#include <eosio/chain/exceptions.hpp>
+#include <fc/log/logger_config.hpp>
+
+namespace eosio { namespace chain {
+
+   non_consensus_executor& non_consensus_executor::shared() {
+      static non_consensus_executor executor;
+      return executor;
+   }
+
+   non_consensus_executor::~non_consensus_executor() {
+      stop();
+   }
+
+   void non_consensus_executor::start( size_t num_threads ) {
+      std::lock_guard g( mtx );
+      EOS_ASSERT( threads.empty(), misc_exception, "non-consensus executor already started" );
+      stopping = false;
+      for( size_t i = 0; i < num_threads; ++i ) {
+         threads.emplace_back( [this, i]() {
+            fc::set_os_thread_name( "nonc-" + std::to_string( i ) );
+            run();
+         } );
+      }
+   }
+
+   void non_consensus_executor::stop() {
+      std::vector<std::thread> joined;
+      {
+         std::lock_guard g( mtx );
+         stopping = true;
+         joined.swap( threads );
+      }
+      cv.notify_all();
+      for( auto& t : joined )
+         t.join();
+   }
+
+   bool non_consensus_executor::running() const {
+      std::lock_guard g( mtx );
+      return !threads.empty() && !stopping;
+   }
+
+   void non_consensus_executor::post( int priority, std::function<void()> f ) {
+      {
+         std::lock_guard g( mtx );
+         EOS_ASSERT( !threads.empty() && !stopping, misc_exception, "non-consensus executor is not running" );
+         tasks.push( task{ priority, next_order++, std::move( f ) } );
+      }
+      cv.notify_one();
+   }
+
+   void non_consensus_executor::run() {
+      while( true ) {
+         std::function<void()> f;
+         {
+            std::unique_lock g( mtx );
+            cv.wait( g, [this]() { return stopping || !tasks.empty(); } );
+            if( tasks.empty() )
+               return;
+            f = std::move( const_cast<task&>( tasks.top() ).f );
+            tasks.pop();
+         }
+         try {
+            f();
+         } FC_LOG_AND_DROP( ("non-consensus task") );
+      }
+   }
+
+} } // eosio::chain
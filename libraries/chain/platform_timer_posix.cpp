@@ -14,16 +14,59 @@ namespace eosio { namespace chain {
 
 static_assert(std::atomic_bool::is_always_lock_free, "Only lock-free atomics AS-safe.");
 
+/*
+ * The kernel timer is not disarmed by stop() and is only re-armed by start() when it fires after the new deadline:
+ * when it fires early it re-arms itself for the current deadline, and when it fires after stop() it is ignored. So
+ * a stream of short transactions with similar deadlines costs about one timer_settime() and one signal per deadline
+ * period instead of two timer_settime() per transaction.
+ *
+ * The signal may be handled on any thread, concurrently with start() and stop(). start() stores the deadline before
+ * it reads armed_us and the handler clears armed_us before it reads the deadline, so either start() arms the timer
+ * or the handler sees the new deadline.
+ */
 struct platform_timer::impl {
    timer_t timerid;
+   std::atomic<int64_t> deadline_us{0}; ///< since epoch, 0 when no deadline is running
+   std::atomic<int64_t> armed_us{0};    ///< when the kernel timer fires, 0 when it is not armed
+
+   static int64_t now_us() {
+      struct timespec ts;
+      clock_gettime(CLOCK_REALTIME, &ts);
+      return int64_t(ts.tv_sec) * 1'000'000 + ts.tv_nsec / 1000;
+   }
+
+   // async-signal-safe
+   bool arm(int64_t at_us) {
+      armed_us = at_us;
+      struct itimerspec enable = {{0, 0}, {time_t(at_us / 1'000'000), long(at_us % 1'000'000) * 1000}};
+      return timer_settime(timerid, TIMER_ABSTIME, &enable, NULL) == 0;
+   }
 
    static void sig_handler(int, siginfo_t* si, void*) {
       platform_timer* self = (platform_timer*)si->si_value.sival_ptr;
+      impl* i = self->my.operator->();
+      i->armed_us = 0;
+      int64_t deadline = i->deadline_us;
+      if(deadline == 0)
+         return; // stopped since it was armed
+      if(now_us() < deadline) {
+         // armed for an earlier deadline
+         i->arm(deadline);
+         // a start() for an earlier deadline may have armed the timer before the line above
+         const int64_t current = i->deadline_us;
+         if(current != 0 && current < deadline)
+            i->arm(current);
+         return;
+      }
+      if(!i->deadline_us.compare_exchange_strong(deadline, 0))
+         return; // the deadline it fired for was stopped
       self->expired = 1;
       self->call_expiration_callback();
    }
 };
 
+static_assert(std::atomic<int64_t>::is_always_lock_free, "Only lock-free atomics AS-safe.");
+
 platform_timer::platform_timer() {
    static_assert(sizeof(impl) <= fwd_size);
 
@@ -34,7 +77,8 @@ platform_timer::platform_timer() {
       struct sigaction act;
       sigemptyset(&act.sa_mask);
       act.sa_sigaction = impl::sig_handler;
-      act.sa_flags = SA_SIGINFO;
+      // the timer firing after stop() is ignored, it should not interrupt the system calls of the thread handling it
+      act.sa_flags = SA_SIGINFO | SA_RESTART;
       FC_ASSERT(sigaction(SIGRTMIN, &act, NULL) == 0, "failed to aquire SIGRTMIN signal");
       initialized = true;
    }
@@ -58,22 +102,25 @@ void platform_timer::start(fc::time_point tp) {
       expired = 0;
       return;
    }
-   fc::microseconds x = tp.time_since_epoch() - fc::time_point::now().time_since_epoch();
-   if(x.count() <= 0)
+   const int64_t at = tp.time_since_epoch().count();
+   if(at <= impl::now_us()) {
+      expired = 1;
+      return;
+   }
+   expired = 0;
+   my->deadline_us = at;
+   const int64_t armed = my->armed_us;
+   if(armed != 0 && armed <= at)
+      return; // re-arms itself for at when it fires
+   if(!my->arm(at)) {
+      my->deadline_us = 0;
       expired = 1;
-   else {
-      struct itimerspec enable = {{0, 0}, {0, (int)x.count()*1000}};
-      expired = 0;
-      if(timer_settime(my->timerid, 0, &enable, NULL) != 0)
-         expired = 1;
    }
 }
 
 void platform_timer::stop() {
-   if(expired)
-      return;
-   struct itimerspec disable = {{0, 0}, {0, 0}};
-   timer_settime(my->timerid, 0, &disable, NULL);
+   // the timer stays armed, see impl
+   my->deadline_us = 0;
    expired = 1;
 }
 
@@ -230,6 +230,17 @@ Builtin protocol feature: BLOCKCHAIN_PARAMETERS
 
 Allows privileged contracts to get and set subsets of blockchain parameters.
 */
+         (  builtin_protocol_feature_t::batched_db_reads, builtin_protocol_feature_spec{
+            "BATCHED_DB_READS",
+            fc::variant("4228a1f53f0a829ca76bf097eb271fa6bec0d2af07a759fbc3498498f26de9aa").as<digest_type>(),
+            // SHA256 hash of the raw message below within the comment delimiters (do not modify message below).
+/*
+Builtin protocol feature: BATCHED_DB_READS
+
+Allows contracts to read several consecutive rows of a primary 64-bit integer index table with a single host call.
+*/
+            {}
+         } )
    ;
 
 
@@ -0,0 +1,111 @@
+#include <eosio/chain/signal_slots.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/log/logger_config.hpp>
+#include <fc/exception/exception.hpp>
+
+namespace eosio { namespace chain {
+
+   void signal_slot_metrics::entry::record( fc::microseconds d ) {
+      const uint64_t us = d.count() > 0 ? d.count() : 0;
+      calls.fetch_add( 1, std::memory_order_relaxed );
+      total_us.fetch_add( us, std::memory_order_relaxed );
+      uint64_t max = max_us.load( std::memory_order_relaxed );
+      while( us > max && !max_us.compare_exchange_weak( max, us, std::memory_order_relaxed ) ) {}
+   }
+
+   signal_slot_metrics& signal_slot_metrics::shared() {
+      static signal_slot_metrics metrics;
+      return metrics;
+   }
+
+   signal_slot_metrics::entry& signal_slot_metrics::get( const std::string& slot ) {
+      std::lock_guard g( mtx );
+      auto& e = entries[slot];
+      if( !e )
+         e = std::make_unique<entry>();
+      return *e;
+   }
+
+   std::vector<signal_slot_latency> signal_slot_metrics::snapshot() const {
+      std::lock_guard g( mtx );
+      std::vector<signal_slot_latency> result;
+      result.reserve( entries.size() );
+      for( const auto& [slot, e] : entries ) {
+         result.push_back( { slot, e->calls.load( std::memory_order_relaxed ), e->total_us.load( std::memory_order_relaxed ),
+                             e->max_us.load( std::memory_order_relaxed ) } );
+      }
+      return result;
+   }
+
+   async_signal_queue::async_signal_queue( std::string thread_name, size_t max_queued, error_handler on_error )
+   : max_queued( std::max<size_t>( max_queued, 1 ) )
+   , on_error( std::move( on_error ) )
+   , worker( [this, thread_name{std::move( thread_name )}]() {
+        fc::set_os_thread_name( thread_name );
+        run();
+     } )
+   {}
+
+   async_signal_queue::~async_signal_queue() {
+      stop();
+   }
+
+   void async_signal_queue::post( std::function<void()> f ) {
+      std::unique_lock g( mtx );
+      not_full.wait( g, [this]() { return stopping || queue.size() < max_queued; } );
+      if( stopping )
+         return;
+      queue.push_back( std::move( f ) );
+      g.unlock();
+      not_empty.notify_one();
+   }
+
+   void async_signal_queue::stop() {
+      {
+         std::lock_guard g( mtx );
+         stopping = true;
+      }
+      not_empty.notify_all();
+      not_full.notify_all();
+      if( worker.joinable() )
+         worker.join();
+   }
+
+   size_t async_signal_queue::size() const {
+      std::lock_guard g( mtx );
+      return queue.size();
+   }
+
+   void async_signal_queue::run() {
+      while( true ) {
+         std::function<void()> f;
+         {
+            std::unique_lock g( mtx );
+            not_empty.wait( g, [this]() { return stopping || !queue.empty(); } );
+            if( queue.empty() )
+               return; // stopping, and everything posted before has run
+            f = std::move( queue.front() );
+            queue.pop_front();
+         }
+         not_full.notify_one();
+         try {
+            f();
+         } catch( ... ) {
+            if( on_error ) {
+               on_error( std::current_exception() );
+            } else {
+               try {
+                  throw;
+               } catch( const fc::exception& e ) {
+                  elog( "signal handler threw: ${e}", ("e", e.to_detail_string()) );
+               } catch( const std::exception& e ) {
+                  elog( "signal handler threw: ${e}", ("e", e.what()) );
+               } catch( ... ) {
+                  elog( "signal handler threw an unknown exception" );
+               }
+            }
+         }
+      }
+   }
+
+} } // eosio::chain
@@ -0,0 +1,67 @@
+#include <eosio/chain/signature_cache.hpp>
+#include <fc/io/raw.hpp>
+
+namespace eosio { namespace chain {
+
+   signature_cache& signature_cache::shared() {
+      static signature_cache cache;
+      return cache;
+   }
+
+   std::optional<public_key_type> signature_cache::find( const digest_type& k ) {
+      std::lock_guard g( mtx );
+      auto itr = entries.find( k );
+      if( itr == entries.end() )
+         return {};
+      lru.splice( lru.begin(), lru, itr->second.lru_itr );
+      return itr->second.key;
+   }
+
+   public_key_type signature_cache::recover( const signature_type& sig, const digest_type& digest, bool check_canonical ) {
+      if( max_entries == 0 )
+         return public_key_type( sig, digest, check_canonical );
+
+      digest_type::encoder enc;
+      fc::raw::pack( enc, digest );
+      fc::raw::pack( enc, sig );
+      fc::raw::pack( enc, check_canonical );
+      const digest_type k = enc.result();
+      if( auto key = find( k ) )
+         return *key;
+
+      // recover without holding the lock, a concurrent recovery of the same signature at worst recovers it twice
+      public_key_type key( sig, digest, check_canonical );
+
+      std::lock_guard g( mtx );
+      if( max_entries == 0 || entries.count( k ) )
+         return key;
+      lru.push_front( k );
+      entries.emplace( k, entry{ key, lru.begin() } );
+      while( entries.size() > max_entries ) {
+         entries.erase( lru.back() );
+         lru.pop_back();
+      }
+      return key;
+   }
+
+   void signature_cache::set_max_entries( size_t n ) {
+      std::lock_guard g( mtx );
+      max_entries = n;
+      while( entries.size() > max_entries ) {
+         entries.erase( lru.back() );
+         lru.pop_back();
+      }
+   }
+
+   void signature_cache::clear() {
+      std::lock_guard g( mtx );
+      entries.clear();
+      lru.clear();
+   }
+
+   size_t signature_cache::size() const {
+      std::lock_guard g( mtx );
+      return entries.size();
+   }
+
+} } // eosio::chain
@@ -1,9 +1,44 @@
 #include <eosio/chain/snapshot.hpp>
 #include <eosio/chain/exceptions.hpp>
 #include <fc/scoped_exit.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_streambuf.hpp>
 
 namespace eosio { namespace chain {
 
+snapshot_writer::~snapshot_writer() {
+   // the packing tasks may still reference the database
+   for (auto& p : pending) {
+      if (p.rows.valid())
+         p.rows.wait();
+   }
+}
+
+void snapshot_writer::write_pending_front() {
+   try {
+      auto p    = std::move(pending.front());
+      pending.pop_front();
+      auto rows = p.rows.get();
+      if (p.start)
+         write_start_section(p.name);
+      write_packed_rows(rows);
+      if (p.end)
+         write_end_section();
+   } catch (...) {
+      for (auto& p : pending)
+         p.rows.wait();
+      pending.clear();
+      section_open = false;
+      throw;
+   }
+}
+
+void snapshot_writer::flush_sections() {
+   while (!pending.empty())
+      write_pending_front();
+}
+
 variant_snapshot_writer::variant_snapshot_writer(fc::mutable_variant_object& snapshot)
 : snapshot(snapshot)
 {
@@ -164,6 +199,11 @@ void ostream_snapshot_writer::write_row( const detail::abstract_snapshot_row_wri
    row_count++;
 }
 
+void ostream_snapshot_writer::write_packed_rows( const packed_section& rows ) {
+   snapshot.write(rows.rows.data(), rows.rows.size());
+   row_count += rows.row_count;
+}
+
 void ostream_snapshot_writer::write_end_section( ) {
    auto restore = snapshot.tellp();
 
@@ -246,7 +286,10 @@ bool istream_snapshot_reader::validate_section() const {
    return true;
 }
 
-bool istream_snapshot_reader::has_section( const string& section_name ) {
+const std::map<std::string, istream_snapshot_reader::section_info>& istream_snapshot_reader::sections() {
+   if (section_index)
+      return *section_index;
+
    auto restore_pos = fc::make_scoped_exit([this,pos=snapshot.tellg()](){
       snapshot.seekg(pos);
    });
@@ -254,6 +297,7 @@ bool istream_snapshot_reader::has_section( const string& section_name ) {
    const std::streamoff header_size = sizeof(ostream_snapshot_writer::magic_number) + sizeof(current_snapshot_version);
 
    auto next_section_pos = header_pos + header_size;
+   std::map<std::string, section_info> result;
 
    while (true) {
       snapshot.seekg(next_section_pos);
@@ -265,66 +309,33 @@ bool istream_snapshot_reader::has_section( const string& section_name ) {
 
       next_section_pos = snapshot.tellg() + std::streamoff(section_size);
 
-      uint64_t ignore = 0;
-      snapshot.read((char*)&ignore,sizeof(ignore));
+      uint64_t row_count = 0;
+      snapshot.read((char*)&row_count,sizeof(row_count));
 
-      bool match = true;
-      for(auto c : section_name) {
-         if(snapshot.get() != c) {
-            match = false;
-            break;
-         }
-      }
+      std::string section_name;
+      std::getline(snapshot, section_name, '\0');
 
-      if (match && snapshot.get() == 0) {
-         return true;
-      }
+      // the first section of a name wins, as it did when the headers were searched for each section
+      result.emplace(std::move(section_name), section_info{snapshot.tellg(), row_count});
    }
 
-   return false;
+   section_index = std::move(result);
+   return *section_index;
 }
 
-void istream_snapshot_reader::set_section( const string& section_name ) {
-   auto restore_pos = fc::make_scoped_exit([this,pos=snapshot.tellg()](){
-      snapshot.seekg(pos);
-   });
-
-   const std::streamoff header_size = sizeof(ostream_snapshot_writer::magic_number) + sizeof(current_snapshot_version);
-
-   auto next_section_pos = header_pos + header_size;
-
-   while (true) {
-      snapshot.seekg(next_section_pos);
-      uint64_t section_size = 0;
-      snapshot.read((char*)&section_size,sizeof(section_size));
-      if (section_size == std::numeric_limits<uint64_t>::max()) {
-         break;
-      }
-
-      next_section_pos = snapshot.tellg() + std::streamoff(section_size);
-
-      uint64_t row_count = 0;
-      snapshot.read((char*)&row_count,sizeof(row_count));
-
-      bool match = true;
-      for(auto c : section_name) {
-         if(snapshot.get() != c) {
-            match = false;
-            break;
-         }
-      }
-
-      if (match && snapshot.get() == 0) {
-         cur_row = 0;
-         num_rows = row_count;
+bool istream_snapshot_reader::has_section( const string& section_name ) {
+   return sections().count(section_name) != 0;
+}
 
-         // leave the stream at the right point
-         restore_pos.cancel();
-         return;
-      }
-   }
+void istream_snapshot_reader::set_section( const string& section_name ) {
+   const auto& index = sections();
+   auto        itr   = index.find(section_name);
+   EOS_ASSERT(itr != index.end(), snapshot_exception, "Binary snapshot has no section named ${n}", ("n", section_name));
 
-   EOS_THROW(snapshot_exception, "Binary snapshot has no section named ${n}", ("n", section_name));
+   // leave the stream at the first row of the section
+   snapshot.seekg(itr->second.rows_pos);
+   cur_row = 0;
+   num_rows = itr->second.row_count;
 }
 
 bool istream_snapshot_reader::read_row( detail::abstract_snapshot_row_reader& row_reader ) {
@@ -346,6 +357,35 @@ void istream_snapshot_reader::return_to_header() {
    clear_section();
 }
 
+namespace bio = boost::iostreams;
+
+bool is_compressed_snapshot( std::istream& snapshot ) {
+   // the first byte of the magic number of a binary snapshot can not be mistaken for the first byte of gzip's
+   return snapshot.peek() == 0x1f;
+}
+
+void compress_snapshot( std::istream& in, std::ostream& out ) {
+   try {
+      bio::filtering_ostreambuf compressed;
+      compressed.push(bio::gzip_compressor());
+      compressed.push(out);
+      bio::copy(in, compressed);
+   } catch( const std::ios_base::failure& e ) {
+      EOS_THROW(snapshot_exception, "Unable to compress snapshot: ${what}", ("what", e.what()));
+   }
+}
+
+void decompress_snapshot( std::istream& in, std::ostream& out ) {
+   try {
+      bio::filtering_istreambuf decompressed;
+      decompressed.push(bio::gzip_decompressor());
+      decompressed.push(in);
+      bio::copy(decompressed, out);
+   } catch( const std::ios_base::failure& e ) {
+      EOS_THROW(snapshot_exception, "Unable to decompress snapshot: ${what}", ("what", e.what()));
+   }
+}
+
 integrity_hash_snapshot_writer::integrity_hash_snapshot_writer(fc::sha256::encoder& enc)
 :enc(enc)
 {
@@ -360,6 +400,10 @@ void integrity_hash_snapshot_writer::write_row( const detail::abstract_snapshot_
    row_writer.write(enc);
 }
 
+void integrity_hash_snapshot_writer::write_packed_rows( const packed_section& rows ) {
+   enc.write(rows.rows.data(), rows.rows.size());
+}
+
 void integrity_hash_snapshot_writer::write_end_section( ) {
    // no-op for structural details
 }
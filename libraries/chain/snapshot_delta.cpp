@@ -0,0 +1,213 @@
+#include <eosio/chain/snapshot_delta.hpp>
+#include <eosio/chain/exceptions.hpp>
+#include <fc/crypto/sha256.hpp>
+
+#include <array>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace eosio { namespace chain { namespace snapshot_delta {
+
+namespace {
+
+   enum record_kind : uint8_t { end_record = 0, copy_record = 1, data_record = 2 };
+
+   constexpr size_t   min_chunk_size = 16 * 1024;
+   constexpr size_t   max_chunk_size = 256 * 1024;
+   constexpr uint64_t chunk_mask     = (1ull << 16) - 1; // 64 KiB chunks on average after the minimum
+
+   /// random values of the gear hash, which only has to be the same for the base and the snapshot of one delta
+   const std::array<uint64_t, 256>& gear() {
+      static const auto table = []() {
+         std::array<uint64_t, 256> result;
+         uint64_t                  state = 0x9e3779b97f4a7c15;
+         for (auto& value : result) {
+            // splitmix64
+            uint64_t z = (state += 0x9e3779b97f4a7c15);
+            z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z          = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            value      = z ^ (z >> 31);
+         }
+         return result;
+      }();
+      return table;
+   }
+
+   /// splits a stream into content defined chunks, hashing all of it on the way
+   class chunker {
+    public:
+      explicit chunker(std::istream& in)
+          : in(*in.rdbuf()) {
+         chunk.reserve(max_chunk_size);
+      }
+
+      /// @return the next chunk, which is empty at the end of the stream
+      const std::vector<char>& next() {
+         const auto& table = gear();
+         uint64_t    hash  = 0;
+         chunk.clear();
+         while (chunk.size() < max_chunk_size) {
+            const auto c = in.sbumpc();
+            if (c == std::char_traits<char>::eof())
+               break;
+            chunk.push_back(char(c));
+            hash = (hash << 1) + table[uint8_t(c)];
+            if (chunk.size() >= min_chunk_size && (hash & chunk_mask) == 0)
+               break;
+         }
+         enc.write(chunk.data(), chunk.size());
+         return chunk;
+      }
+
+      fc::sha256 digest() { return enc.result(); }
+
+    private:
+      std::streambuf&     in;
+      std::vector<char>   chunk;
+      fc::sha256::encoder enc;
+   };
+
+   template <typename T>
+   void write_value(std::ostream& out, const T& value) {
+      out.write((const char*)&value, sizeof(value));
+   }
+
+   template <typename T>
+   T read_value(std::istream& in) {
+      T value;
+      in.read((char*)&value, sizeof(value));
+      EOS_ASSERT(in.good(), snapshot_exception, "Delta snapshot is truncated");
+      return value;
+   }
+
+   void write_digest(std::ostream& out, const fc::sha256& digest) { out.write(digest.data(), digest.data_size()); }
+
+   fc::sha256 read_digest(std::istream& in) {
+      fc::sha256 digest;
+      in.read(digest.data(), digest.data_size());
+      EOS_ASSERT(in.good(), snapshot_exception, "Delta snapshot is truncated");
+      return digest;
+   }
+
+   void copy_bytes(std::istream& in, uint64_t size, std::vector<char>& buffer, std::ostream& out,
+                   fc::sha256::encoder& enc) {
+      while (size) {
+         buffer.resize(std::min<uint64_t>(size, max_chunk_size));
+         in.read(buffer.data(), buffer.size());
+         EOS_ASSERT(in.good(), snapshot_exception, "Delta snapshot refers to missing data");
+         out.write(buffer.data(), buffer.size());
+         enc.write(buffer.data(), buffer.size());
+         size -= buffer.size();
+      }
+   }
+
+} // namespace
+
+bool is_delta( std::istream& in ) {
+   // the first byte of the magic number differs from the ones of binary snapshots and gzip
+   return in.peek() == (magic_number & 0xff);
+}
+
+void write( std::istream& base, std::istream& snapshot, std::ostream& out ) {
+   struct range {
+      uint64_t offset;
+      uint64_t size;
+   };
+
+   std::map<fc::sha256, range> base_chunks;
+   chunker                     base_chunker(base);
+   for (uint64_t offset = 0;;) {
+      const auto& chunk = base_chunker.next();
+      if (chunk.empty())
+         break;
+      base_chunks.emplace(fc::sha256::hash(chunk.data(), chunk.size()), range{offset, chunk.size()});
+      offset += chunk.size();
+   }
+
+   write_value(out, magic_number);
+   write_value(out, version);
+   write_digest(out, base_chunker.digest());
+
+   // consecutive chunks which are consecutive in the base become one copy
+   std::optional<range> pending_copy;
+   auto flush_copy = [&]() {
+      if (!pending_copy)
+         return;
+      write_value(out, copy_record);
+      write_value(out, pending_copy->offset);
+      write_value(out, pending_copy->size);
+      pending_copy.reset();
+   };
+
+   chunker snapshot_chunker(snapshot);
+   while (true) {
+      const auto& chunk = snapshot_chunker.next();
+      if (chunk.empty())
+         break;
+      auto itr = base_chunks.find(fc::sha256::hash(chunk.data(), chunk.size()));
+      if (itr != base_chunks.end()) {
+         if (pending_copy && pending_copy->offset + pending_copy->size == itr->second.offset) {
+            pending_copy->size += itr->second.size;
+         } else {
+            flush_copy();
+            pending_copy = itr->second;
+         }
+         continue;
+      }
+      flush_copy();
+      write_value(out, data_record);
+      write_value(out, uint64_t(chunk.size()));
+      out.write(chunk.data(), chunk.size());
+   }
+   flush_copy();
+
+   write_value(out, end_record);
+   write_digest(out, snapshot_chunker.digest());
+   EOS_ASSERT(out.good(), snapshot_exception, "Unable to write delta snapshot");
+}
+
+void apply( std::istream& base, std::istream& delta, std::ostream& out ) {
+   EOS_ASSERT(read_value<uint32_t>(delta) == magic_number, snapshot_exception,
+              "Delta snapshot has unexpected magic number!");
+   const auto actual_version = read_value<uint32_t>(delta);
+   EOS_ASSERT(actual_version == version, snapshot_exception,
+              "Delta snapshot is an unsuppored version.  Expected : ${expected}, Got: ${actual}",
+              ("expected", version)("actual", actual_version));
+
+   // a delta against another base rebuilds garbage, so check the base before anything is written
+   const auto base_digest = read_digest(delta);
+   {
+      fc::sha256::encoder enc;
+      std::vector<char>   buffer(max_chunk_size);
+      base.seekg(0);
+      while (base.read(buffer.data(), buffer.size()) || base.gcount())
+         enc.write(buffer.data(), base.gcount());
+      base.clear();
+      EOS_ASSERT(enc.result() == base_digest, snapshot_exception,
+                 "Delta snapshot was written against another base snapshot");
+   }
+
+   fc::sha256::encoder enc;
+   std::vector<char>   buffer;
+   while (true) {
+      const auto kind = read_value<uint8_t>(delta);
+      if (kind == end_record)
+         break;
+      if (kind == copy_record) {
+         const auto offset = read_value<uint64_t>(delta);
+         const auto size   = read_value<uint64_t>(delta);
+         base.seekg(offset);
+         copy_bytes(base, size, buffer, out, enc);
+      } else {
+         EOS_ASSERT(kind == data_record, snapshot_exception, "Delta snapshot has unknown record kind ${k}", ("k", kind));
+         copy_bytes(delta, read_value<uint64_t>(delta), buffer, out, enc);
+      }
+   }
+
+   EOS_ASSERT(enc.result() == read_digest(delta), snapshot_exception,
+              "Snapshot rebuilt from delta does not match the snapshot the delta was written from");
+   EOS_ASSERT(out.good(), snapshot_exception, "Unable to write snapshot rebuilt from delta");
+}
+
+}}} // namespace eosio::chain::snapshot_delta
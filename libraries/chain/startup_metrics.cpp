@@ -0,0 +1,26 @@
+#include <eosio/chain/startup_metrics.hpp>
+#include <fc/log/logger.hpp>
+
+namespace eosio { namespace chain {
+
+   startup_metrics& startup_metrics::shared() {
+      static startup_metrics metrics;
+      return metrics;
+   }
+
+   void startup_metrics::record( std::string phase, fc::microseconds d ) {
+      std::lock_guard g( mtx );
+      phases.push_back( { std::move( phase ), uint64_t( d.count() > 0 ? d.count() : 0 ) } );
+   }
+
+   std::vector<startup_phase> startup_metrics::snapshot() const {
+      std::lock_guard g( mtx );
+      return phases;
+   }
+
+   void startup_metrics::log() const {
+      for( const auto& p : snapshot() )
+         ilog( "startup phase ${p}: ${us} us", ("p", p.phase)("us", p.us) );
+   }
+
+} } // eosio::chain
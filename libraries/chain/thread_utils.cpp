@@ -1,21 +1,41 @@
 #include <eosio/chain/thread_utils.hpp>
+#include <eosio/chain/exceptions.hpp>
 #include <fc/log/logger_config.hpp>
 
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace eosio { namespace chain {
 
 
 //
 // named_thread_pool
 //
-named_thread_pool::named_thread_pool( std::string name_prefix, size_t num_threads )
+named_thread_pool::named_thread_pool( std::string name_prefix, size_t num_threads, std::vector<uint16_t> cpus )
 : _thread_pool( num_threads )
 , _ioc( num_threads )
 {
    _ioc_work.emplace( boost::asio::make_work_guard( _ioc ) );
    for( size_t i = 0; i < num_threads; ++i ) {
-      boost::asio::post( _thread_pool, [&ioc = _ioc, name_prefix, i]() {
+      boost::asio::post( _thread_pool, [&ioc = _ioc, name_prefix, i, cpus]() {
          std::string tn = name_prefix + "-" + std::to_string( i );
          fc::set_os_thread_name( tn );
+         if( !cpus.empty() ) {
+            try {
+               set_thread_affinity( cpus );
+            } FC_LOG_AND_DROP( (tn) );
+         }
          ioc.run();
       } );
    }
@@ -32,5 +52,75 @@ void named_thread_pool::stop() {
    _thread_pool.stop();
 }
 
+//
+// cpu and numa placement
+//
+std::vector<uint16_t> parse_cpu_list( const std::string& list ) {
+   std::vector<uint16_t> cpus;
+   std::vector<std::string> ranges;
+   boost::split( ranges, list, boost::is_any_of( "," ) );
+   for( auto& range : ranges ) {
+      boost::trim( range );
+      if( range.empty() )
+         continue;
+      // a cpu number is only digits, stoul would also take a sign, leading spaces and trailing characters
+      auto to_cpu = [&]( const std::string& s ) {
+         EOS_ASSERT( !s.empty() && std::all_of( s.begin(), s.end(), []( unsigned char c ) { return std::isdigit( c ); } ),
+                     misc_exception, "invalid cpu range ${r} in cpu list ${l}", ("r", range)("l", list) );
+         return std::stoul( s );
+      };
+      try {
+         const auto dash  = range.find( '-' );
+         EOS_ASSERT( dash == std::string::npos || range.find( '-', dash + 1 ) == std::string::npos, misc_exception,
+                     "invalid cpu range ${r} in cpu list ${l}", ("r", range)("l", list) );
+         const auto first = to_cpu( range.substr( 0, dash ) );
+         const auto last  = dash == std::string::npos ? first : to_cpu( range.substr( dash + 1 ) );
+         EOS_ASSERT( first <= last && last <= std::numeric_limits<uint16_t>::max(), misc_exception,
+                     "invalid cpu range ${r} in cpu list ${l}", ("r", range)("l", list) );
+         for( auto cpu = first; cpu <= last; ++cpu )
+            cpus.push_back( static_cast<uint16_t>( cpu ) );
+      } catch( const std::logic_error& ) {
+         EOS_THROW( misc_exception, "invalid cpu range ${r} in cpu list ${l}", ("r", range)("l", list) );
+      }
+   }
+   EOS_ASSERT( !cpus.empty(), misc_exception, "empty cpu list ${l}", ("l", list) );
+   return cpus;
+}
+
+std::vector<uint16_t> numa_node_cpus( uint32_t node ) {
+   const auto path = "/sys/devices/system/node/node" + std::to_string( node ) + "/cpulist";
+   std::ifstream in( path );
+   std::string list;
+   EOS_ASSERT( in && std::getline( in, list ), misc_exception, "numa node ${n} does not exist, ${p} can not be read",
+               ("n", node)("p", path) );
+   return parse_cpu_list( list );
+}
+
+void set_thread_affinity( const std::vector<uint16_t>& cpus ) {
+#ifdef __linux__
+   cpu_set_t set;
+   CPU_ZERO( &set );
+   for( auto cpu : cpus ) {
+      EOS_ASSERT( cpu < CPU_SETSIZE, misc_exception, "cpu ${c} is out of range", ("c", cpu) );
+      CPU_SET( cpu, &set );
+   }
+   const auto err = pthread_setaffinity_np( pthread_self(), sizeof( set ), &set );
+   EOS_ASSERT( err == 0, misc_exception, "unable to set the cpu affinity of thread: ${e}", ("e", strerror( err )) );
+#else
+   EOS_THROW( misc_exception, "cpu affinity is only supported on linux" );
+#endif
+}
+
+void bind_thread_to_numa_node( uint32_t node ) {
+   set_thread_affinity( numa_node_cpus( node ) );
+#ifdef __linux__
+   constexpr auto bits = 8 * sizeof( unsigned long );
+   std::vector<unsigned long> nodemask( node / bits + 1 );
+   nodemask[node / bits] = 1ul << ( node % bits );
+   // preferred rather than bind so that an exhausted node falls back to the others instead of failing allocations
+   EOS_ASSERT( syscall( SYS_set_mempolicy, MPOL_PREFERRED, nodemask.data(), nodemask.size() * bits + 1 ) == 0,
+               misc_exception, "unable to set the memory policy of numa node ${n}: ${e}", ("n", node)("e", strerror( errno )) );
+#endif
+}
 
 } } // eosio::chain
\ No newline at end of file
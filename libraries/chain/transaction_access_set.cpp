@@ -0,0 +1,69 @@
+#include <eosio/chain/transaction_access_set.hpp>
+
+#include <algorithm>
+
+namespace eosio { namespace chain {
+
+namespace {
+   bool intersects( const flat_set<account_name>& a, const flat_set<account_name>& b ) {
+      auto ai = a.begin();
+      auto bi = b.begin();
+      while( ai != a.end() && bi != b.end() ) {
+         if( *ai < *bi ) ++ai;
+         else if( *bi < *ai ) ++bi;
+         else return true;
+      }
+      return false;
+   }
+}
+
+bool transaction_access_set::conflicts_with( const transaction_access_set& other )const {
+   if( opaque || other.opaque ) return true;
+   return intersects( writes, other.writes ) || intersects( writes, other.reads ) || intersects( reads, other.writes );
+}
+
+vector<uint32_t> schedule_conflict_free_batches( const vector<transaction_access_set>& sets ) {
+   vector<uint32_t> result;
+   result.reserve( sets.size() );
+
+   // last batch that read or wrote each account; a write must follow both, a read only the last write
+   map<account_name, uint32_t> last_read;
+   map<account_name, uint32_t> last_write;
+   uint32_t barrier = 0;    // first batch allowed after the most recent opaque set
+   uint32_t max_batch = 0;
+
+   auto after = []( const map<account_name, uint32_t>& m, account_name n, uint32_t& batch ) {
+      auto itr = m.find( n );
+      if( itr != m.end() ) batch = std::max( batch, itr->second + 1 );
+   };
+
+   for( const auto& s : sets ) {
+      uint32_t batch = barrier;
+      if( s.opaque ) {
+         batch = result.empty() ? 0 : max_batch + 1;
+         barrier = batch + 1;
+      } else {
+         for( const auto& n : s.reads ) {
+            after( last_write, n, batch );
+         }
+         for( const auto& n : s.writes ) {
+            after( last_write, n, batch );
+            after( last_read, n, batch );
+         }
+         for( const auto& n : s.reads ) {
+            auto& b = last_read[n];
+            b = std::max( b, batch );
+         }
+         for( const auto& n : s.writes ) {
+            auto& b = last_write[n];
+            b = std::max( b, batch );
+         }
+      }
+      max_batch = std::max( max_batch, batch );
+      result.push_back( batch );
+   }
+
+   return result;
+}
+
+} } /// eosio::chain
@@ -285,6 +285,8 @@ namespace eosio { namespace chain {
       EOS_ASSERT( is_initialized, transaction_exception, "must first initialize" );
 
       const transaction& trx = packed_trx.get_transaction();
+      trace->action_traces.reserve( (apply_context_free ? trx.context_free_actions.size() : 0) +
+                                    (delay == fc::microseconds() ? trx.actions.size() : 0) );
       if( apply_context_free ) {
          for( const auto& act : trx.context_free_actions ) {
             schedule_action( act, act.account, true, 0, 0 );
@@ -522,6 +524,7 @@ namespace eosio { namespace chain {
    }
 
    void transaction_context::add_ram_usage( account_name account, int64_t ram_delta, const storage_usage_trace& trace ) {
+      if( access_set ) access_set->add_write( account );
       auto& rl = control.get_mutable_resource_limits_manager();
       rl.add_pending_ram_usage( account, ram_delta, trace );
       if( ram_delta > 0 ) {
@@ -559,15 +562,14 @@ namespace eosio { namespace chain {
                greylist_limit = specified_greylist_limit;
             }
          }
-         auto [net_limit, net_was_greylisted] = rl.get_account_net_limit(a, greylist_limit);
-         if( net_limit >= 0 ) {
-            account_net_limit = std::min( account_net_limit, net_limit );
-            greylisted_net |= net_was_greylisted;
+         const auto limits = rl.get_account_billing_limits(a, greylist_limit);
+         if( limits.net_available >= 0 ) {
+            account_net_limit = std::min( account_net_limit, limits.net_available );
+            greylisted_net |= limits.net_greylisted;
          }
-         auto [cpu_limit, cpu_was_greylisted] = rl.get_account_cpu_limit(a, greylist_limit);
-         if( cpu_limit >= 0 ) {
-            account_cpu_limit = std::min( account_cpu_limit, cpu_limit );
-            greylisted_cpu |= cpu_was_greylisted;
+         if( limits.cpu_available >= 0 ) {
+            account_cpu_limit = std::min( account_cpu_limit, limits.cpu_available );
+            greylisted_cpu |= limits.cpu_greylisted;
          }
       }
 
@@ -627,15 +629,29 @@ namespace eosio { namespace chain {
    {
       uint32_t new_action_ordinal = trace->action_traces.size() + 1;
 
-      trace->action_traces.reserve( new_action_ordinal );
+      // Grow geometrically: reserving exactly one more slot per notification reallocated and moved every
+      // action_trace on each require_recipient, which is quadratic in the notification fan-out.
+      auto& action_traces = trace->action_traces;
+      if( action_traces.size() == action_traces.capacity() ) {
+         action_traces.reserve( std::max<size_t>( 2 * action_traces.capacity(), new_action_ordinal ) );
+      }
 
       const action& provided_action = get_action_trace( action_ordinal ).act;
 
       // The reserve above is required so that the emplace_back below does not invalidate the provided_action reference.
 
-      trace->action_traces.emplace_back( *trace, provided_action, receiver, context_free,
-                                         new_action_ordinal, creator_action_ordinal,
-                                         closest_unnotified_ancestor_action_ordinal );
+      if( trace_notification_payloads ) {
+         trace->action_traces.emplace_back( *trace, provided_action, receiver, context_free,
+                                            new_action_ordinal, creator_action_ordinal,
+                                            closest_unnotified_ancestor_action_ordinal );
+      } else {
+         // apply_context reads the payload from the first receiver's trace, so only the header is copied here
+         trace->action_traces.emplace_back( *trace, action( provided_action.authorization, provided_action.account,
+                                                            provided_action.name, bytes() ),
+                                            receiver, context_free,
+                                            new_action_ordinal, creator_action_ordinal,
+                                            closest_unnotified_ancestor_action_ordinal );
+      }
 
       return new_action_ordinal;
    }
@@ -714,6 +730,7 @@ namespace eosio { namespace chain {
           EOS_ASSERT( false, tx_duplicate,
                      "duplicate transaction ${id}", ("id", id ) );
       }
+      control.record_transaction_id( id, expire );
    } /// record_transaction
 
    void transaction_context::validate_referenced_accounts( const transaction& trx, bool enforce_actor_whitelist_blacklist )const {
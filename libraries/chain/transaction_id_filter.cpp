@@ -0,0 +1,57 @@
+#include <eosio/chain/transaction_id_filter.hpp>
+#include <eosio/chain/exceptions.hpp>
+
+namespace eosio { namespace chain {
+
+namespace {
+   // transaction ids are sha256 digests, so each 64-bit word is already a well mixed hash of the id
+   constexpr size_t num_probes = 4;
+
+   template<typename F>
+   void for_each_probe( const transaction_id_type& id, uint32_t bits, F&& f ) {
+      static_assert( sizeof(id._hash) / sizeof(id._hash[0]) >= num_probes, "not enough words in transaction id" );
+      for( size_t i = 0; i < num_probes; ++i ) {
+         f( id._hash[i] % bits );
+      }
+   }
+}
+
+transaction_id_filter::transaction_id_filter( uint32_t bucket_seconds, uint32_t bits_per_bucket )
+: _bucket_seconds( bucket_seconds )
+, _bits_per_bucket( bits_per_bucket )
+{
+   EOS_ASSERT( bucket_seconds > 0, misc_exception, "transaction id filter bucket span must be positive" );
+   EOS_ASSERT( bits_per_bucket > 0 && bits_per_bucket % 64 == 0, misc_exception,
+               "transaction id filter bucket size must be a positive multiple of 64 bits" );
+}
+
+void transaction_id_filter::insert( const transaction_id_type& id, fc::time_point_sec expiration ) {
+   auto& bucket = _buckets[expiration.sec_since_epoch() / _bucket_seconds];
+   if( bucket.empty() )
+      bucket.resize( _bits_per_bucket / 64 );
+   for_each_probe( id, _bits_per_bucket, [&]( uint64_t bit ) {
+      bucket[bit / 64] |= uint64_t(1) << (bit % 64);
+   } );
+}
+
+bool transaction_id_filter::may_contain( const transaction_id_type& id )const {
+   for( const auto& b : _buckets ) {
+      const auto& bucket = b.second;
+      bool all_set = true;
+      for_each_probe( id, _bits_per_bucket, [&]( uint64_t bit ) {
+         all_set = all_set && (bucket[bit / 64] & (uint64_t(1) << (bit % 64)));
+      } );
+      if( all_set )
+         return true;
+   }
+   return false;
+}
+
+void transaction_id_filter::prune( fc::time_point_sec expired_before ) {
+   const uint64_t before = expired_before.sec_since_epoch();
+   while( !_buckets.empty() && (uint64_t(_buckets.begin()->first) + 1) * _bucket_seconds <= before ) {
+      _buckets.erase( _buckets.begin() );
+   }
+}
+
+} } /// eosio::chain
@@ -2,6 +2,8 @@
 #include <eosio/chain/thread_utils.hpp>
 #include <boost/asio/thread_pool.hpp>
 
+#include <algorithm>
+
 namespace eosio { namespace chain {
 
 recover_keys_future transaction_metadata::start_recover_keys( packed_transaction_ptr trx,
@@ -11,20 +13,65 @@ recover_keys_future transaction_metadata::start_recover_keys( packed_transaction
                                                               uint32_t max_variable_sig_size )
 {
    return async_thread_pool( thread_pool, [trx{std::move(trx)}, chain_id, time_limit, max_variable_sig_size]() mutable {
-         fc::time_point deadline = time_limit == fc::microseconds::maximum() ?
-                                   fc::time_point::maximum() : fc::time_point::now() + time_limit;
-         const vector<signature_type>& sigs = check_variable_sig_size( trx, max_variable_sig_size );
-         const vector<bytes>* context_free_data = trx->get_context_free_data();
-         EOS_ASSERT( context_free_data, tx_no_context_free_data, "context free data pruned from packed_transaction" );
-         flat_set<public_key_type> recovered_pub_keys;
-         const bool allow_duplicate_keys = false;
-         fc::microseconds cpu_usage =
-               trx->get_transaction().get_signature_keys(sigs, chain_id, deadline, *context_free_data, recovered_pub_keys, allow_duplicate_keys);
-         return std::make_shared<transaction_metadata>( private_type(), std::move( trx ), cpu_usage, std::move( recovered_pub_keys ) );
+         return recover_keys( std::move( trx ), chain_id, time_limit, max_variable_sig_size );
       }
    );
 }
 
+std::vector<recover_keys_future> transaction_metadata::start_recover_keys( std::vector<packed_transaction_ptr> trxs,
+                                                                           boost::asio::io_context& thread_pool,
+                                                                           const chain_id_type& chain_id,
+                                                                           fc::microseconds time_limit,
+                                                                           size_t max_tasks,
+                                                                           uint32_t max_variable_sig_size )
+{
+   using batch_t = std::vector<std::pair<packed_transaction_ptr, std::promise<transaction_metadata_ptr>>>;
+
+   std::vector<recover_keys_future> futures;
+   futures.reserve( trxs.size() );
+   if( trxs.empty() )
+      return futures;
+
+   const size_t tasks = std::max<size_t>( 1, std::min( max_tasks, trxs.size() ) );
+   const size_t per_task = ( trxs.size() + tasks - 1 ) / tasks;
+   for( size_t first = 0; first < trxs.size(); first += per_task ) {
+      const size_t last = std::min( first + per_task, trxs.size() );
+      auto batch = std::make_shared<batch_t>();
+      batch->reserve( last - first );
+      for( size_t i = first; i < last; ++i ) {
+         batch->emplace_back( std::move( trxs[i] ), std::promise<transaction_metadata_ptr>() );
+         futures.emplace_back( batch->back().second.get_future() );
+      }
+      boost::asio::post( thread_pool, [batch, chain_id, time_limit, max_variable_sig_size]() {
+         for( auto& [trx, promise] : *batch ) {
+            try {
+               promise.set_value( recover_keys( std::move( trx ), chain_id, time_limit, max_variable_sig_size ) );
+            } catch( ... ) {
+               promise.set_exception( std::current_exception() );
+            }
+         }
+      } );
+   }
+   return futures;
+}
+
+transaction_metadata_ptr transaction_metadata::recover_keys( packed_transaction_ptr trx,
+                                                             const chain_id_type& chain_id,
+                                                             fc::microseconds time_limit,
+                                                             uint32_t max_variable_sig_size )
+{
+   fc::time_point deadline = time_limit == fc::microseconds::maximum() ?
+                             fc::time_point::maximum() : fc::time_point::now() + time_limit;
+   const vector<signature_type>& sigs = check_variable_sig_size( trx, max_variable_sig_size );
+   const vector<bytes>* context_free_data = trx->get_context_free_data();
+   EOS_ASSERT( context_free_data, tx_no_context_free_data, "context free data pruned from packed_transaction" );
+   flat_set<public_key_type> recovered_pub_keys;
+   const bool allow_duplicate_keys = false;
+   fc::microseconds cpu_usage =
+         trx->get_transaction().get_signature_keys(sigs, chain_id, deadline, *context_free_data, recovered_pub_keys, allow_duplicate_keys);
+   return std::make_shared<transaction_metadata>( private_type(), std::move( trx ), cpu_usage, std::move( recovered_pub_keys ) );
+}
+
 uint32_t transaction_metadata::get_estimated_size() const {
    return sizeof(*this) + _recovered_pub_keys.size() * sizeof(public_key_type) + packed_trx()->get_estimated_size();
 }
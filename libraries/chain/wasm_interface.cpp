@@ -15,6 +15,7 @@
 #include <eosio/chain/global_property_object.hpp>
 #include <eosio/chain/protocol_state_object.hpp>
 #include <eosio/chain/account_object.hpp>
+#include <eosio/chain/thread_utils.hpp>
 #include <fc/exception/exception.hpp>
 #include <fc/crypto/sha256.hpp>
 #include <fc/crypto/sha1.hpp>
@@ -25,6 +26,7 @@
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
 #include <fstream>
+#include <future>
 #include <string.h>
 
 #if defined(EOSIO_EOS_VM_RUNTIME_ENABLED) || defined(EOSIO_EOS_VM_JIT_RUNTIME_ENABLED)
@@ -38,7 +40,7 @@ namespace eosio { namespace chain {
 
    wasm_interface::~wasm_interface() {}
 
-   void wasm_interface::validate(const controller& control, const bytes& code) {
+   void wasm_interface::validate(controller& control, const bytes& code) {
       const auto& pso = control.db().get<protocol_state_object>();
 
       if (control.is_builtin_activated(builtin_protocol_feature_t::configurable_wasm_limits)) {
@@ -46,25 +48,53 @@ namespace eosio { namespace chain {
          webassembly::eos_vm_runtime::validate( code, gpo.wasm_configuration, pso.whitelisted_intrinsics );
          return;
       }
-      Module module;
-      try {
-         Serialization::MemoryInputStream stream((U8*)code.data(), code.size());
-         WASM::serialize(stream, module);
-      } catch(const Serialization::FatalSerializationException& e) {
-         EOS_ASSERT(false, wasm_serialization_error, e.message.c_str());
-      } catch(const IR::ValidationException& e) {
-         EOS_ASSERT(false, wasm_serialization_error, e.message.c_str());
+
+      // the eos-vm pass does not depend on the WAVM one, so for large code it runs on the thread pool meanwhile;
+      // the errors are still reported in the order of the passes
+      constexpr size_t parallel_validation_min_code_size = 64*1024;
+      std::future<void> eos_vm_validation;
+      if (code.size() >= parallel_validation_min_code_size) {
+         eos_vm_validation = async_thread_pool( control.get_thread_pool(), [&code, &intrinsics = pso.whitelisted_intrinsics]() {
+            webassembly::eos_vm_runtime::validate( code, intrinsics );
+         } );
       }
 
-      wasm_validations::wasm_binary_validation validator(control, module);
-      validator.validate();
+      try {
+         Module module;
+         try {
+            Serialization::MemoryInputStream stream((U8*)code.data(), code.size());
+            WASM::serialize(stream, module);
+         } catch(const Serialization::FatalSerializationException& e) {
+            EOS_ASSERT(false, wasm_serialization_error, e.message.c_str());
+         } catch(const IR::ValidationException& e) {
+            EOS_ASSERT(false, wasm_serialization_error, e.message.c_str());
+         }
 
-      webassembly::eos_vm_runtime::validate( code, pso.whitelisted_intrinsics );
+         wasm_validations::wasm_binary_validation validator(control, module);
+         validator.validate();
+      } catch(...) {
+         // the eos-vm pass references code
+         if (eos_vm_validation.valid())
+            eos_vm_validation.wait();
+         throw;
+      }
 
-      //there are a couple opportunties for improvement here--
-      //Easy: Cache the Module created here so it can be reused for instantiaion
-      //Hard: Kick off instantiation in a separate thread at this location
-	 }
+      if (eos_vm_validation.valid())
+         eos_vm_validation.get();
+      else
+         webassembly::eos_vm_runtime::validate( code, pso.whitelisted_intrinsics );
+   }
+
+   void wasm_interface::code_set(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version) {
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+      if(my->eosvmoc) {
+         try {
+            // queues the compile when the code is not in the cache yet
+            my->eosvmoc->cc.get_descriptor_for_code(code_hash, vm_version);
+         } FC_LOG_AND_DROP(("EOS VM OC failed to queue the compile of new code"));
+      }
+#endif
+   }
 
    void wasm_interface::indicate_shutting_down() {
       my->is_shutting_down = true;
@@ -78,6 +108,28 @@ namespace eosio { namespace chain {
       my->current_lib(lib);
    }
 
+   void wasm_interface::warm_up(uint32_t instantiate_contracts) {
+      if(instantiate_contracts)
+         my->warm_up(instantiate_contracts);
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+      if(my->eosvmoc) {
+         try {
+            my->eosvmoc->cc.warm_up();
+         } FC_LOG_AND_DROP(("EOS VM OC warm up failed"));
+      }
+#endif
+   }
+
+   std::vector<subsystem_memory> wasm_interface::memory_usage()const {
+      std::vector<subsystem_memory> result;
+      result.push_back({"wasm_instantiation_cache", 0, my->wasm_instantiation_cache.size()});
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+      if(my->eosvmoc)
+         result.push_back({"eos_vm_oc_code_cache", my->eosvmoc->cc.used_bytes(), my->eosvmoc->cc.number_of_entries()});
+#endif
+      return result;
+   }
+
    void wasm_interface::apply( const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version, apply_context& context ) {
 #ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
       if(my->eosvmoc) {
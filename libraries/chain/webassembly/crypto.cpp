@@ -2,6 +2,7 @@
 #include <eosio/chain/protocol_state_object.hpp>
 #include <eosio/chain/transaction_context.hpp>
 #include <eosio/chain/apply_context.hpp>
+#include <eosio/chain/signature_cache.hpp>
 
 namespace eosio { namespace chain { namespace webassembly {
 
@@ -25,7 +26,7 @@ namespace eosio { namespace chain { namespace webassembly {
          EOS_ASSERT(s.variable_size() <= context.control.configured_subjective_signature_length_limit(),
                     sig_variable_size_limit_exception, "signature variable length component size greater than subjective maximum");
 
-      auto check = fc::crypto::public_key( s, *digest, false );
+      auto check = signature_cache::shared().recover( s, *digest, false );
       EOS_ASSERT( check == p, crypto_api_exception, "Error expected key different than recovered key" );
    }
 
@@ -44,7 +45,7 @@ namespace eosio { namespace chain { namespace webassembly {
                     sig_variable_size_limit_exception, "signature variable length component size greater than subjective maximum");
 
 
-      auto recovered = fc::crypto::public_key(s, *digest, false);
+      auto recovered = signature_cache::shared().recover( s, *digest, false );
 
       // the key types newer than the first 2 may be varible in length
       if (static_cast<unsigned>(s.which()) >= config::genesis_num_supported_key_types ) {
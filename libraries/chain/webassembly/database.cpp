@@ -1,6 +1,8 @@
 #include <eosio/chain/webassembly/interface.hpp>
 #include <eosio/chain/apply_context.hpp>
 
+#include <cstring>
+
 namespace eosio { namespace chain { namespace webassembly {
    /**
     * interface for primary index
@@ -35,6 +37,25 @@ namespace eosio { namespace chain { namespace webassembly {
    int32_t interface::db_end_i64( uint64_t code, uint64_t scope, uint64_t table ) {
       return context.db_get_context().db_end_i64( code, scope, table );
    }
+   int32_t interface::db_get_batch_i64( int32_t itr, uint32_t max_rows, span<char> buffer, uint32_t* rows ) {
+      auto& db_ctx = context.db_get_context();
+      uint32_t count = 0;
+      size_t   offset = 0;
+      while( count < max_rows && itr >= 0 ) {
+         const uint32_t size = db_ctx.db_get_i64( itr, nullptr, 0 );
+         if( buffer.size() - offset < sizeof(size) + size )
+            break;
+         std::memcpy( buffer.data() + offset, &size, sizeof(size) );
+         offset += sizeof(size);
+         db_ctx.db_get_i64( itr, buffer.data() + offset, size );
+         offset += size;
+         ++count;
+         uint64_t primary = 0;
+         itr = db_ctx.db_next_i64( itr, primary );
+      }
+      *rows = count;
+      return itr;
+   }
 
    /**
     * interface for uint64_t secondary
@@ -188,8 +188,10 @@ namespace LLVMJIT
 											if(symbolSection)
 												loadedAddress += (Uptr)o.getSectionLoadAddress(*symbolSection.get());
 											Uptr functionDefIndex;
-											if(getFunctionIndexFromExternalName(name->data(),functionDefIndex))
+											if(getFunctionIndexFromExternalName(name->data(),functionDefIndex)) {
 												function_to_offsets[functionDefIndex] = loadedAddress-(uintptr_t)unitmemorymanager->code->data();
+												function_to_sizes[functionDefIndex] = symbolSizePair.second;
+											}
 #if PRINT_DISASSEMBLY
 											disassembleFunction((U8*)loadedAddress, symbolSizePair.second);
 #endif
@@ -212,6 +214,7 @@ namespace LLVMJIT
 		std::shared_ptr<UnitMemoryManager> unitmemorymanager = std::make_shared<UnitMemoryManager>();
 
 		std::map<unsigned, uintptr_t> function_to_offsets;
+		std::map<unsigned, uint64_t> function_to_sizes;
 		std::vector<uint8_t> final_pic_code;
 		uintptr_t table_offset = 0;
 
@@ -326,6 +329,7 @@ namespace LLVMJIT
 		instantiated_code ret;
 		ret.code = jitModule->final_pic_code;
 		ret.function_offsets = jitModule->function_to_offsets;
+		ret.function_sizes = jitModule->function_to_sizes;
 		ret.table_offset = jitModule->table_offset;
 		return ret;
 	}
@@ -15,6 +15,7 @@ namespace eosio { namespace chain { namespace eosvmoc {
 struct instantiated_code {
    std::vector<uint8_t> code;
    std::map<unsigned, uintptr_t> function_offsets;
+   std::map<unsigned, uint64_t> function_sizes;
    uintptr_t table_offset;
 };
 
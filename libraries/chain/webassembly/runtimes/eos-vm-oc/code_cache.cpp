@@ -28,6 +28,8 @@ static constexpr size_t header_offset = 512u;
 static constexpr size_t header_size = 512u;
 static constexpr size_t total_header_size = header_offset + header_size;
 static constexpr uint64_t header_id = 0x32434f4d56534f45ULL; //"EOSVMOC2" little endian
+//marks the use counts following the serialized descriptors; caches written without counts lack it
+static constexpr uint64_t uses_section_id = 0x53455355434f4d56ULL; //"VMOCUSES" little endian
 
 struct code_cache_header {
    uint64_t id = header_id;
@@ -42,7 +44,8 @@ static_assert(sizeof(code_cache_header) <= header_size, "code_cache_header too b
 code_cache_async::code_cache_async(const bfs::path data_dir, const eosvmoc::config& eosvmoc_config, const chainbase::database& db) :
    code_cache_base(data_dir, eosvmoc_config, db),
    _result_queue(eosvmoc_config.threads * 2),
-   _threads(eosvmoc_config.threads)
+   _threads(eosvmoc_config.threads),
+   _warmup_contracts(eosvmoc_config.warmup_contracts)
 {
    FC_ASSERT(_threads, "EOS VM OC requires at least 1 compile thread");
 
@@ -74,7 +77,9 @@ void code_cache_async::wait_on_compile_monitor_message() {
          return;
       }
 
-      _result_queue.push(std::get<wasm_compilation_result_message>(message));
+      wasm_compilation_result_message& result = std::get<wasm_compilation_result_message>(message);
+      unpack_functions(result, fds);
+      _result_queue.push(std::move(result));
 
       wait_on_compile_monitor_message();
    });
@@ -85,13 +90,24 @@ void code_cache_async::wait_on_compile_monitor_message() {
 std::tuple<size_t, size_t> code_cache_async::consume_compile_thread_queue() {
    size_t bytes_remaining = 0;
    size_t gotsome = _result_queue.consume_all([&](const wasm_compilation_result_message& result) {
+      tier_up_stats stats;
+      if(auto it = _tier_up_stats.find(result.code); it != _tier_up_stats.end()) {
+         stats = it->second;
+         _tier_up_stats.erase(it);
+      }
       if(_outstanding_compiles_and_poison[result.code] == false) {
          std::visit(overloaded {
             [&](const code_descriptor& cd) {
-               _cache_index.push_front(cd);
+               _cache_index.push_front(code_cache_entry{cd});
+               if(_perf_map)
+                  _perf_map->add_code_layout(cd.code_hash, result.functions);
+               dlog("code ${c} tiered-up to EOS VM OC, compile took ${t}ms after ${w}ms queued, ${f} executions fell back, ${q} compiles queued",
+                    ("c", result.code.code_id)("t", (fc::time_point::now() - stats.started).count()/1000)
+                    ("w", stats.queued == fc::time_point() ? 0 : (stats.started - stats.queued).count()/1000)
+                    ("f", stats.fallbacks)("q", _queued_compiles.size()));
             },
             [&](const compilation_result_unknownfailure&) {
-               wlog("code ${c} failed to tier-up with EOS VM OC", ("c", result.code.code_id));
+               wlog("code ${c} failed to tier-up with EOS VM OC after ${f} executions fell back", ("c", result.code.code_id)("f", stats.fallbacks));
                _blacklist.emplace(result.code);
             },
             [&](const compilation_result_toofull&) {
@@ -115,18 +131,23 @@ const code_descriptor* const code_cache_async::get_descriptor_for_code(const dig
          check_eviction_threshold(bytes_remaining);
 
       while(count_processed && _queued_compiles.size()) {
-         auto nextup = _queued_compiles.begin();
+         auto nextup = std::max_element(_queued_compiles.begin(), _queued_compiles.end(), [&](const code_tuple& a, const code_tuple& b) {
+            return _tier_up_stats[a].fallbacks < _tier_up_stats[b].fallbacks;
+         });
 
          //it's not clear this check is required: if apply() was called for code then it existed in the code_index; and then
          // if we got notification of it no longer existing we would have removed it from queued_compiles
          const code_object* const codeobject = _db.find<code_object,by_code_hash>(boost::make_tuple(nextup->code_id, 0, nextup->vm_version));
          if(codeobject) {
             _outstanding_compiles_and_poison.emplace(*nextup, false);
+            _tier_up_stats[*nextup].started = fc::time_point::now();
             std::vector<wrapped_fd> fds_to_pass;
             fds_to_pass.emplace_back(memfd_for_bytearray(codeobject->code));
             FC_ASSERT(write_message_with_fds(_compile_monitor_write_socket, compile_wasm_message{ *nextup }, fds_to_pass), "EOS VM failed to communicate to OOP manager");
             --count_processed;
          }
+         else
+            _tier_up_stats.erase(*nextup);
          _queued_compiles.erase(nextup);
       }
    }
@@ -134,7 +155,7 @@ const code_descriptor* const code_cache_async::get_descriptor_for_code(const dig
    //check for entry in cache
    code_cache_index::index<by_hash>::type::iterator it = _cache_index.get<by_hash>().find(boost::make_tuple(code_id, vm_version));
    if(it != _cache_index.get<by_hash>().end()) {
-      _cache_index.relocate(_cache_index.begin(), _cache_index.project<0>(it));
+      record_use(it);
       return &*it;
    }
 
@@ -144,13 +165,17 @@ const code_descriptor* const code_cache_async::get_descriptor_for_code(const dig
       return nullptr;
    if(auto it = _outstanding_compiles_and_poison.find(ct); it != _outstanding_compiles_and_poison.end()) {
       it->second = false;
+      ++_tier_up_stats[ct].fallbacks;
       return nullptr;
    }
-   if(_queued_compiles.find(ct) != _queued_compiles.end())
+   if(_queued_compiles.find(ct) != _queued_compiles.end()) {
+      ++_tier_up_stats[ct].fallbacks;
       return nullptr;
+   }
 
    if(_outstanding_compiles_and_poison.size() >= _threads) {
-      _queued_compiles.emplace(ct);
+      queue_compile(ct);
+      ++_tier_up_stats[ct].fallbacks;
       return nullptr;
    }
 
@@ -158,11 +183,55 @@ const code_descriptor* const code_cache_async::get_descriptor_for_code(const dig
    if(!codeobject) //should be impossible right?
       return nullptr;
 
+   start_compile(ct, *codeobject);
+   ++_tier_up_stats[ct].fallbacks;
+   return nullptr;
+}
+
+void code_cache_async::queue_compile(const code_tuple& ct) {
+   _queued_compiles.emplace(ct);
+   _tier_up_stats[ct].queued = fc::time_point::now();
+   dlog("code ${c} queued for EOS VM OC, ${q} compiles queued and ${o} compiling",
+        ("c", ct.code_id)("q", _queued_compiles.size())("o", _outstanding_compiles_and_poison.size()));
+}
+
+void code_cache_async::start_compile(const code_tuple& ct, const code_object& codeobject) {
    _outstanding_compiles_and_poison.emplace(ct, false);
+   _tier_up_stats[ct].started = fc::time_point::now();
    std::vector<wrapped_fd> fds_to_pass;
-   fds_to_pass.emplace_back(memfd_for_bytearray(codeobject->code));
+   fds_to_pass.emplace_back(memfd_for_bytearray(codeobject.code));
    write_message_with_fds(_compile_monitor_write_socket, compile_wasm_message{ ct }, fds_to_pass);
-   return nullptr;
+}
+
+void code_cache_async::warm_up() {
+   if(!_warmup_contracts)
+      return;
+
+   //the last time a contract ran is not kept in state, the number of accounts it is deployed on is used as a
+   // proxy for how often it will run
+   std::vector<const code_object*> codes;
+   for(const code_object& co : _db.get_index<code_index>().indices())
+      if(co.vm_type == 0)
+         codes.push_back(&co);
+   const size_t count = std::min<size_t>(_warmup_contracts, codes.size());
+   std::partial_sort(codes.begin(), codes.begin() + count, codes.end(), [](const code_object* a, const code_object* b) {
+      return std::tie(a->code_ref_count, a->first_block_used) > std::tie(b->code_ref_count, b->first_block_used);
+   });
+
+   size_t queued = 0;
+   for(size_t i = 0; i < count; ++i) {
+      const code_tuple ct = code_tuple{codes[i]->code_hash, codes[i]->vm_version};
+      if(_cache_index.get<by_hash>().count(boost::make_tuple(ct.code_id, ct.vm_version)) ||
+         _blacklist.count(ct) || _outstanding_compiles_and_poison.count(ct))
+         continue;
+      //compiles beyond the thread count are started as earlier ones complete
+      if(_outstanding_compiles_and_poison.size() < _threads)
+         start_compile(ct, *codes[i]);
+      else
+         queue_compile(ct);
+      ++queued;
+   }
+   ilog("Queued ${q} of ${c} most deployed contracts for EOS VM OC compilation", ("q", queued)("c", count));
 }
 
 code_cache_sync::~code_cache_sync() {
@@ -178,7 +247,7 @@ const code_descriptor* const code_cache_sync::get_descriptor_for_code_sync(const
    //check for entry in cache
    code_cache_index::index<by_hash>::type::iterator it = _cache_index.get<by_hash>().find(boost::make_tuple(code_id, vm_version));
    if(it != _cache_index.get<by_hash>().end()) {
-      _cache_index.relocate(_cache_index.begin(), _cache_index.project<0>(it));
+      record_use(it);
       return &*it;
    }
 
@@ -196,10 +265,21 @@ const code_descriptor* const code_cache_sync::get_descriptor_for_code_sync(const
 
    wasm_compilation_result_message result = std::get<wasm_compilation_result_message>(message);
    EOS_ASSERT(std::holds_alternative<code_descriptor>(result.result), wasm_execution_error, "failed to compile wasm");
+   unpack_functions(result, fds);
+   if(_perf_map)
+      _perf_map->add_code_layout(code_id, std::move(result.functions));
 
    check_eviction_threshold(result.cache_free_bytes);
 
-   return &*_cache_index.push_front(std::move(std::get<code_descriptor>(result.result))).first;
+   return &*_cache_index.push_front(code_cache_entry{std::move(std::get<code_descriptor>(result.result))}).first;
+}
+
+void code_cache_base::unpack_functions(wasm_compilation_result_message& result, const std::vector<wrapped_fd>& fds) const {
+   if(!_perf_map || fds.empty())
+      return;
+   std::vector<uint8_t> packed = vector_for_memfd(fds[0]);
+   fc::datastream<const char*> ds((const char*)packed.data(), packed.size());
+   fc::raw::unpack(ds, result.functions);
 }
 
 code_cache_base::code_cache_base(const boost::filesystem::path data_dir, const eosvmoc::config& eosvmoc_config, const chainbase::database& db) :
@@ -210,6 +290,26 @@ code_cache_base::code_cache_base(const boost::filesystem::path data_dir, const e
 
    bfs::create_directories(data_dir);
 
+   if(!bfs::exists(_cache_file_path) && !eosvmoc_config.seed_cache_file.empty()) {
+      //machine code in the cache only depends on the contract, so a cache built by another node can be reused as is
+      const bfs::path& seed = eosvmoc_config.seed_cache_file;
+      EOS_ASSERT(bfs::exists(seed), database_exception, "EOS VM OC seed code cache ${f} does not exist", ("f", seed.generic_string()));
+      EOS_ASSERT(bfs::file_size(seed) <= eosvmoc_config.cache_size, database_exception,
+                 "EOS VM OC seed code cache ${f} is larger than the configured cache size", ("f", seed.generic_string()));
+      code_cache_header seed_header;
+      {
+         char header_buff[total_header_size];
+         std::ifstream hs(seed.generic_string(), std::ifstream::binary);
+         hs.read(header_buff, sizeof(header_buff));
+         EOS_ASSERT(!hs.fail(), bad_database_version_exception, "failed to read seed code cache header");
+         memcpy((char*)&seed_header, header_buff + header_offset, sizeof(seed_header));
+      }
+      EOS_ASSERT(seed_header.id == header_id, bad_database_version_exception, "EOS VM OC seed code cache not compatible with this version");
+      EOS_ASSERT(!seed_header.dirty, database_exception, "EOS VM OC seed code cache is in use or was not closed cleanly");
+      bfs::copy_file(seed, _cache_file_path);
+      ilog("EOS VM Optimized Compiler code cache seeded from ${f}", ("f", seed.generic_string()));
+   }
+
    if(!bfs::exists(_cache_file_path)) {
       EOS_ASSERT(eosvmoc_config.cache_size >= allocator_t::get_min_size(total_header_size), database_exception, "configured code cache size is too small");
       std::ofstream ofs(_cache_file_path.generic_string(), std::ofstream::trunc);
@@ -235,6 +335,9 @@ code_cache_base::code_cache_base(const boost::filesystem::path data_dir, const e
 
    set_on_disk_region_dirty(true);
 
+   if(eosvmoc_config.perf_map)
+      _perf_map = std::make_unique<eosvmoc::perf_map>();
+
    auto existing_file_size = bfs::file_size(_cache_file_path);
    if(eosvmoc_config.cache_size > existing_file_size) {
       bfs::resize_file(_cache_file_path, eosvmoc_config.cache_size);
@@ -259,20 +362,29 @@ code_cache_base::code_cache_base(const boost::filesystem::path data_dir, const e
       fc::datastream<const char*> ds(code_mapping + cache_header.serialized_descriptor_index, eosvmoc_config.cache_size - cache_header.serialized_descriptor_index);
       unsigned number_entries;
       fc::raw::unpack(ds, number_entries);
-      for(unsigned i = 0; i < number_entries; ++i) {
-         code_descriptor cd;
-         fc::raw::unpack(ds, cd);
-         if(cd.codegen_version != 0) {
-            allocator->deallocate(code_mapping + cd.code_begin);
-            allocator->deallocate(code_mapping + cd.initdata_begin);
+      std::vector<code_cache_entry> entries(number_entries);
+      for(code_cache_entry& entry : entries)
+         fc::raw::unpack(ds, static_cast<code_descriptor&>(entry));
+      uint64_t section_id = 0;
+      if(ds.remaining() >= sizeof(section_id))
+         fc::raw::unpack(ds, section_id);
+      if(section_id == uses_section_id)
+         for(code_cache_entry& entry : entries)
+            fc::raw::unpack(ds, entry.uses);
+      for(code_cache_entry& entry : entries) {
+         if(entry.codegen_version != 0) {
+            allocator->deallocate(code_mapping + entry.code_begin);
+            allocator->deallocate(code_mapping + entry.initdata_begin);
             continue;
          }
-         _cache_index.push_back(std::move(cd));
+         _cache_index.push_back(std::move(entry));
       }
       allocator->deallocate(code_mapping + cache_header.serialized_descriptor_index);
 
       ilog("EOS VM Optimized Compiler code cache loaded with ${c} entries; ${f} of ${t} bytes free", ("c", number_entries)("f", allocator->get_free_memory())("t", allocator->get_size()));
    }
+   _cache_size = allocator->get_size();
+   _free_bytes = allocator->get_free_memory();
    munmap(code_mapping, eosvmoc_config.cache_size);
 
    _free_bytes_eviction_threshold = eosvmoc_config.cache_size * .1;
@@ -301,6 +413,9 @@ void code_cache_base::serialize_cache_index(fc::datastream<T>& ds) {
    fc::raw::pack(ds, entries);
    for(const code_descriptor& cd : _cache_index)
       fc::raw::pack(ds, cd);
+   fc::raw::pack(ds, uses_section_id);
+   for(const code_cache_entry& entry : _cache_index)
+      fc::raw::pack(ds, entry.uses);
 }
 
 code_cache_base::~code_cache_base() {
@@ -359,6 +474,8 @@ void code_cache_base::free_code(const digest_type& code_id, const uint8_t& vm_ve
 
    //if it's in the queued list, erase it
    _queued_compiles.erase({code_id, vm_version});
+   if(!_outstanding_compiles_and_poison.count({code_id, vm_version}))
+      _tier_up_stats.erase({code_id, vm_version});
 
    //however, if it's currently being compiled there is no way to cancel the compile,
    //so instead set a poison boolean that indicates not to insert the code in to the cache
@@ -368,16 +485,33 @@ void code_cache_base::free_code(const digest_type& code_id, const uint8_t& vm_ve
       compiling_it->second = true;
 }
 
+void code_cache_base::record_use(code_cache_index::index<by_hash>::type::iterator it) {
+   if(it->uses != std::numeric_limits<uint32_t>::max())
+      ++it->uses;
+   _cache_index.relocate(_cache_index.begin(), _cache_index.project<0>(it));
+}
+
 void code_cache_base::run_eviction_round() {
    evict_wasms_message evict_msg;
-   for(unsigned int i = 0; i < 25 && _cache_index.size() > 1; ++i) {
-      evict_msg.codes.emplace_back(_cache_index.back());
+   //least recently used entries that were used more than once get another chance at the front with their uses halved,
+   // so a burst of one-off contracts does not push out the hot set. after a full pass, fall back to plain LRU
+   size_t examined = 0;
+   const size_t entries = _cache_index.size();
+   while(evict_msg.codes.size() < 25 && _cache_index.size() > 1) {
+      const code_cache_entry& lru = _cache_index.back();
+      if(examined++ < entries && lru.uses > 1) {
+         lru.uses /= 2;
+         _cache_index.relocate(_cache_index.begin(), std::prev(_cache_index.end()));
+         continue;
+      }
+      evict_msg.codes.emplace_back(lru);
       _cache_index.pop_back();
    }
    write_message_with_fds(_compile_monitor_write_socket, evict_msg);
 }
 
 void code_cache_base::check_eviction_threshold(size_t free_bytes) {
+   _free_bytes = free_bytes;
    if(free_bytes < _free_bytes_eviction_threshold)
       run_eviction_round();
 }
@@ -123,7 +123,7 @@ struct compile_monitor_session {
          void* code_ptr = nullptr;
          void* mem_ptr = nullptr;
          try {
-            if(success && std::holds_alternative<code_compilation_result_message>(message) && fds.size() == 2) {
+            if(success && std::holds_alternative<code_compilation_result_message>(message) && fds.size() >= 2) {
                code_compilation_result_message& result = std::get<code_compilation_result_message>(message);
                code_ptr = _allocator->allocate(get_size_of_fd(fds[0]));
                mem_ptr = _allocator->allocate(get_size_of_fd(fds[1]));
@@ -157,7 +157,11 @@ struct compile_monitor_session {
             _allocator->deallocate(mem_ptr);
          }
 
-         write_message_with_fds(_nodeos_instance_socket, reply);
+         //the layout of the functions is only passed on for the perf map, see code_cache_base::unpack_functions
+         std::vector<wrapped_fd> fds_to_pass;
+         if(std::holds_alternative<code_descriptor>(reply.result) && fds.size() > 2)
+            fds_to_pass.emplace_back(std::move(fds[2]));
+         write_message_with_fds(_nodeos_instance_socket, reply, fds_to_pass);
 
          //either way, we are done
          _ctx.post([this, current_compile_it]() {
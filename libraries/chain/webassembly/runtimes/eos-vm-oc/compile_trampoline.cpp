@@ -4,6 +4,8 @@
 #include <eosio/chain/webassembly/eos-vm-oc/intrinsic.hpp>
 #include <eosio/chain/wasm_eosio_injection.hpp>
 
+#include <fc/io/raw.hpp>
+
 #include <sys/prctl.h>
 #include <signal.h>
 #include <sys/resource.h>
@@ -130,9 +132,15 @@ void run_compile(wrapped_fd&& response_sock, wrapped_fd&& wasm_code) noexcept {
    std::move(prologue_it, prologue.end(), std::back_inserter(initdata_prep));
    std::move(initial_mem.begin(), initial_mem.end(), std::back_inserter(initdata_prep));
 
+   std::vector<wasm_function_symbol> functions;
+   functions.reserve(code.function_offsets.size());
+   for(const auto& [def_index, offset] : code.function_offsets)
+      functions.push_back({(uint32_t)(module.functions.imports.size() + def_index), (uint32_t)offset, (uint32_t)code.function_sizes[def_index]});
+
    std::vector<wrapped_fd> fds_to_send;
    fds_to_send.emplace_back(memfd_for_bytearray(code.code));
    fds_to_send.emplace_back(memfd_for_bytearray(initdata_prep));
+   fds_to_send.emplace_back(memfd_for_bytearray(fc::raw::pack(functions)));
    write_message_with_fds(response_sock, result_message, fds_to_send);
 }
 
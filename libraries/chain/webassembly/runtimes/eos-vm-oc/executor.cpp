@@ -1,6 +1,7 @@
 #include <eosio/chain/webassembly/eos-vm-oc/executor.hpp>
 #include <eosio/chain/webassembly/eos-vm-oc/code_cache.hpp>
 #include <eosio/chain/webassembly/eos-vm-oc/memory.hpp>
+#include <eosio/chain/webassembly/eos-vm-oc/perf_map.hpp>
 #include <eosio/chain/webassembly/eos-vm-oc/intrinsic_mapping.hpp>
 #include <eosio/chain/webassembly/eos-vm-oc/intrinsic.hpp>
 #include <eosio/chain/webassembly/eos-vm-oc/eos-vm-oc.h>
@@ -133,7 +134,7 @@ struct executor_signal_init {
    }
 };
 
-executor::executor(const code_cache_base& cc) {
+executor::executor(const code_cache_base& cc) : code_perf_map(cc.perf_map()) {
    //if we're the first executor created, go setup the signal handling. For now we'll just leave this attached forever
    static executor_signal_init the_executor_signal_init;
 
@@ -155,6 +156,12 @@ void executor::execute(const code_descriptor& code, memory& mem, apply_context&
       mapping_is_executable = true;
    }
 
+   if(code_perf_map) {
+      //the allocator of the code cache lives at the start of the mapping; it knows the size of the block of the code
+      const allocator_t* allocator = reinterpret_cast<const allocator_t*>(code_mapping);
+      code_perf_map->add_code(code, code_mapping, allocator->size(code_mapping + code.code_begin), context.get_receiver());
+   }
+
    uint64_t max_call_depth = eosio::chain::wasm_constraints::maximum_call_depth+1;
    uint64_t max_pages = eosio::chain::wasm_constraints::maximum_linear_memory/eosio::chain::wasm_constraints::wasm_page_size;
    if(context.control.is_builtin_activated(builtin_protocol_feature_t::configurable_wasm_limits)) {
@@ -173,7 +180,11 @@ void executor::execute(const code_descriptor& code, memory& mem, apply_context&
                   (code.starting_memory_pages - initial_page_offset) * eosio::chain::wasm_constraints::wasm_page_size, PROT_READ | PROT_WRITE);
       }
       arch_prctl(ARCH_SET_GS, (unsigned long*)(mem.zero_page_memory_base()+initial_page_offset*memory::stride));
-      memset(mem.full_page_memory_base(), 0, 64u*1024u*code.starting_memory_pages);
+      //the start of linear memory up to the end of the last data segment is overwritten by initdata below, only
+      // clear what follows it
+      const size_t memory_size = 64u*1024u*code.starting_memory_pages;
+      const size_t initial_data_size = std::min<size_t>(code.initdata_size - code.initdata_prologue_size, memory_size);
+      memset(mem.full_page_memory_base() + initial_data_size, 0, memory_size - initial_data_size);
    }
    else
       arch_prctl(ARCH_SET_GS, (unsigned long*)mem.zero_page_memory_base());
@@ -0,0 +1,49 @@
+#include <eosio/chain/webassembly/eos-vm-oc/perf_map.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+#include <unistd.h>
+
+namespace eosio { namespace chain { namespace eosvmoc {
+
+perf_map::perf_map() {
+   const std::string path = "/tmp/perf-" + std::to_string(getpid()) + ".map";
+   _file = fopen(path.c_str(), "w");
+   FC_ASSERT(_file, "failed to open EOS VM OC perf map ${p}", ("p", path));
+   ilog("writing symbols of EOS VM OC code to ${p}", ("p", path));
+}
+
+perf_map::~perf_map() {
+   fclose(_file);
+}
+
+void perf_map::add_code_layout(const digest_type& code_id, std::vector<wasm_function_symbol> functions) {
+   std::lock_guard g(_mtx);
+   _layouts[code_id] = std::move(functions);
+}
+
+void perf_map::add_code(const code_descriptor& code, const uint8_t* code_mapping, size_t code_size, account_name account) {
+   const uint8_t* const code_start = code_mapping + code.code_begin;
+
+   std::lock_guard g(_mtx);
+   auto [it, inserted] = _written.try_emplace(code_start, code.code_hash);
+   if(!inserted) {
+      if(it->second == code.code_hash)
+         return;
+      //the code was evicted and other code compiled to its place
+      it->second = code.code_hash;
+   }
+
+   const std::string name = "wasm:" + account.to_string() + ":" + code.code_hash.str().substr(0, 8);
+   auto layout = _layouts.find(code.code_hash);
+   if(layout != _layouts.end() && !layout->second.empty()) {
+      for(const wasm_function_symbol& f : layout->second)
+         fprintf(_file, "%lx %x %s:f%u\n", (unsigned long)(code_start + f.offset), f.size, name.c_str(), f.function_index);
+   }
+   else
+      fprintf(_file, "%lx %zx %s\n", (unsigned long)code_start, code_size, name.c_str());
+   fflush(_file);
+}
+
+}}}
@@ -407,6 +407,7 @@ REGISTER_HOST_FUNCTION(db_find_i64);
 REGISTER_HOST_FUNCTION(db_lowerbound_i64);
 REGISTER_HOST_FUNCTION(db_upperbound_i64);
 REGISTER_HOST_FUNCTION(db_end_i64);
+REGISTER_HOST_FUNCTION(db_get_batch_i64);
 
 // uint64_t secondary index api
 REGISTER_LEGACY_HOST_FUNCTION(db_idx64_store);
@@ -1,9 +1,16 @@
 #pragma once
 
 #include <fc/io/raw.hpp>
+#include <cstdio>
+#include <deque>
+#include <memory>
 #include <optional>
 #include <rocksdb/db.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/slice_transform.h>
+#include <rocksdb/sst_file_writer.h>
 #include <rocksdb/table.h>
+#include <shared_mutex>
 #include <stdexcept>
 #include <softfloat.hpp>
 #include <algorithm>
@@ -301,27 +308,17 @@ bytes create_full_key(const bytes& prefix, uint64_t contract, const T& key) {
 struct database {
    std::unique_ptr<rocksdb::DB> rdb;
 
-   database(const char* db_path, bool create_if_missing, std::optional<uint32_t> threads = {},
-            std::optional<int> max_open_files = {}) {
-
-      rocksdb::Options options;
-      options.create_if_missing                    = create_if_missing;
-      options.level_compaction_dynamic_level_bytes = true;
-      options.bytes_per_sync                       = 1048576;
-
-      if (threads)
-         options.IncreaseParallelism(*threads);
-
-      options.OptimizeLevelStyleCompaction(256ull << 20);
+   // Only for a secondary instance, which follows the database of another process. Readers hold it shared, since
+   // secondary instances don't support snapshots; catch_up holds it exclusively.
+   std::unique_ptr<std::shared_mutex> catch_up_mutex;
 
-      if (max_open_files)
-         options.max_open_files = *max_open_files;
-
-      rocksdb::BlockBasedTableOptions table_options;
-      table_options.format_version               = 4;
-      table_options.index_block_restart_interval = 16;
-      options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+   // If prefix_bloom_length is set, the first prefix_bloom_length bytes of the keys go into bloom filters, both in the
+   // SST files and in the memtable, and point lookups skip the blocks without their prefix. Iterators still see the
+   // keys in total order.
+   database(const char* db_path, bool create_if_missing, std::optional<uint32_t> threads = {},
+            std::optional<int> max_open_files = {}, std::optional<uint32_t> prefix_bloom_length = {}) {
 
+      auto options = make_options(create_if_missing, threads, max_open_files, prefix_bloom_length);
       rocksdb::DB* p;
       check(rocksdb::DB::Open(options, db_path, &p), "database::database: rocksdb::DB::Open: ");
       rdb.reset(p);
@@ -346,9 +343,30 @@ struct database {
          write(batch);
    }
 
+   // Opens a read only secondary instance of the database at db_path, which another process writes to. The secondary
+   // keeps its own info logs in secondary_path and only sees the primary's changes after catch_up.
+   database(const char* db_path, const char* secondary_path, std::optional<uint32_t> prefix_bloom_length = {})
+       : catch_up_mutex(std::make_unique<std::shared_mutex>()) {
+      auto options = make_options(false, {}, {}, prefix_bloom_length);
+      // required by secondary instances
+      options.max_open_files = -1;
+      rocksdb::DB* p;
+      check(rocksdb::DB::OpenAsSecondary(options, db_path, secondary_path, &p),
+            "database::database: rocksdb::DB::OpenAsSecondary: ");
+      rdb.reset(p);
+   }
+
    database(database&&) = default;
    database& operator=(database&&) = default;
 
+   bool is_secondary() const { return catch_up_mutex != nullptr; }
+
+   // Applies the primary's latest changes to a secondary instance. Waits until no read_snapshot is held.
+   void catch_up() {
+      std::unique_lock<std::shared_mutex> lock{ *catch_up_mutex };
+      check(rdb->TryCatchUpWithPrimary(), "database::catch_up: rocksdb::DB::TryCatchUpWithPrimary: ");
+   }
+
    void flush(bool allow_write_stall, bool wait) {
       rocksdb::FlushOptions op;
       op.allow_write_stall = allow_write_stall;
@@ -362,8 +380,56 @@ struct database {
       check(rdb->Write(opt, &batch), "database::write: rocksdb::DB::Write (batch)");
       batch.Clear();
    }
+
+ private:
+   static rocksdb::Options make_options(bool create_if_missing, std::optional<uint32_t> threads,
+                                        std::optional<int> max_open_files, std::optional<uint32_t> prefix_bloom_length) {
+      rocksdb::Options options;
+      options.create_if_missing                    = create_if_missing;
+      options.level_compaction_dynamic_level_bytes = true;
+      options.bytes_per_sync                       = 1048576;
+
+      if (threads)
+         options.IncreaseParallelism(*threads);
+
+      options.OptimizeLevelStyleCompaction(256ull << 20);
+
+      if (max_open_files)
+         options.max_open_files = *max_open_files;
+
+      rocksdb::BlockBasedTableOptions table_options;
+      table_options.format_version               = 4;
+      table_options.index_block_restart_interval = 16;
+      if (prefix_bloom_length) {
+         options.prefix_extractor.reset(rocksdb::NewFixedPrefixTransform(*prefix_bloom_length));
+         options.memtable_prefix_bloom_size_ratio = 0.1;
+         options.memtable_whole_key_filtering     = true;
+         table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, false));
+         table_options.whole_key_filtering = true;
+      }
+      options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+      return options;
+   }
 }; // database
 
+// A consistent view of the database for reads: a RocksDB snapshot, or on a secondary instance, which doesn't support
+// snapshots, a shared hold on catch_up_mutex.
+class read_snapshot {
+ public:
+   explicit read_snapshot(database& db) {
+      if (db.is_secondary())
+         lock = std::shared_lock<std::shared_mutex>{ *db.catch_up_mutex };
+      else
+         snap.emplace(db.rdb.get());
+   }
+
+   const rocksdb::Snapshot* snapshot() const { return snap ? snap->snapshot() : nullptr; }
+
+ private:
+   std::shared_lock<std::shared_mutex>     lock;
+   std::optional<rocksdb::ManagedSnapshot> snap;
+};
+
 struct key_value {
    rocksdb::Slice key   = {};
    rocksdb::Slice value = {};
@@ -421,19 +487,31 @@ void pack_undo_segment(Stream& s, const bytes& key, const bytes* old_value, cons
    pack_optional_bytes(s, new_value);
 }
 
+// The newest undo segments are kept in memory until they add up to more than memory_undo_size,
+// then the oldest of them are written to rocksdb. Undo data of short lived revisions is then
+// never written, and never needs a DeleteRange to be removed. Segments still in memory are
+// written when the undo_stack is destroyed; they are lost on a crash, like the rest of the
+// data written without a WAL.
 class undo_stack {
  private:
-   database&  db;
-   bytes      undo_prefix;
-   uint64_t   target_segment_size;
-   bytes      state_prefix;
-   bytes      segment_prefix;
-   bytes      segment_next_prefix;
-   undo_state state;
+   database&         db;
+   bytes             undo_prefix;
+   uint64_t          target_segment_size;
+   uint64_t          memory_undo_size;
+   bytes             state_prefix;
+   bytes             segment_prefix;
+   bytes             segment_next_prefix;
+   undo_state        state;
+   std::deque<bytes> memory_segments;          // newest segments, the last one is state.next_undo_segment - 1
+   uint64_t          memory_segments_size = 0;
+   uint64_t          disk_segment_begin   = 0; // segments before this were removed from rocksdb
+   uint64_t          disk_segment_end     = 0; // segments from this one on are not in rocksdb
 
  public:
-   undo_stack(database& db, const bytes& undo_prefix, uint64_t target_segment_size = 64 * 1024 * 1024)
-       : db{ db }, undo_prefix{ undo_prefix }, target_segment_size{ target_segment_size } {
+   undo_stack(database& db, const bytes& undo_prefix, uint64_t target_segment_size = 64 * 1024 * 1024,
+              uint64_t memory_undo_size = 0)
+       : db{ db }, undo_prefix{ undo_prefix }, target_segment_size{ target_segment_size },
+         memory_undo_size{ memory_undo_size } {
       if (this->undo_prefix.empty())
          throw exception("undo_prefix is empty");
 
@@ -458,6 +536,22 @@ class undo_stack {
             throw exception("invalid undo format");
          state = fc::raw::unpack<undo_state>(v.data(), v.size());
       }
+      disk_segment_end = state.next_undo_segment;
+   }
+
+   undo_stack(const undo_stack&) = delete;
+   undo_stack& operator=(const undo_stack&) = delete;
+
+   ~undo_stack() {
+      try {
+         if (!memory_segments.empty()) {
+            rocksdb::WriteBatch batch;
+            spill_segments(batch, 0);
+            db.write(batch);
+         }
+      } catch (...) {
+         // destructors must not throw; the undo data is lost as on a crash
+      }
    }
 
    int64_t revision() const { return state.revision; }
@@ -489,9 +583,9 @@ class undo_stack {
          return;
       } else if (state.undo_stack.size() == 1) {
          rocksdb::WriteBatch batch;
-         check(batch.DeleteRange(to_slice(create_segment_key(0)),
-                                 to_slice(create_segment_key(state.next_undo_segment))),
-               "undo_stack::squash: rocksdb::WriteBatch::DeleteRange: ");
+         memory_segments.clear();
+         memory_segments_size = 0;
+         delete_disk_segments(batch, state.next_undo_segment, "undo_stack::squash: rocksdb::WriteBatch::DeleteRange: ");
          state.undo_stack.clear();
          --state.revision;
          write_state(batch);
@@ -512,18 +606,8 @@ class undo_stack {
          throw exception("nothing to undo");
       rocksdb::WriteBatch batch;
 
-      std::unique_ptr<rocksdb::Iterator> rocks_it{ db.rdb->NewIterator(rocksdb::ReadOptions()) };
-      auto                               first = create_segment_key(state.next_undo_segment - state.undo_stack.back());
-      rocks_it->Seek(to_slice(segment_next_prefix));
-      if (rocks_it->Valid())
-         rocks_it->Prev();
-
-      while (rocks_it->Valid()) {
-         auto segment_key = rocks_it->key();
-         if (compare_blob(segment_key, first) < 0)
-            break;
-         write_now                           = true;
-         auto                        segment = rocks_it->value();
+      auto undo_segment = [&](const rocksdb::Slice& segment) {
+         write_now = true;
          fc::datastream<const char*> ds(segment.data(), segment.size());
          while (ds.remaining()) {
             auto [key, key_size]             = get_bytes(ds);
@@ -535,12 +619,39 @@ class undo_stack {
             else
                check(batch.Delete({ key, key_size }), "undo_stack::undo: rocksdb::WriteBatch::Delete: ");
          }
-         check(batch.Delete(segment_key), "undo_stack::undo: rocksdb::WriteBatch::Delete: ");
-         rocks_it->Prev();
+      };
+
+      // Segments are undone newest first; the newest ones are in memory
+      uint64_t first_segment  = state.next_undo_segment - state.undo_stack.back();
+      uint64_t memory_begin   = first_memory_segment();
+      for (auto n = std::min<uint64_t>(state.undo_stack.back(), memory_segments.size()); n > 0; --n) {
+         undo_segment(to_slice(memory_segments.back()));
+         memory_segments_size -= memory_segments.back().size();
+         memory_segments.pop_back();
+      }
+
+      if (std::max(first_segment, disk_segment_begin) < std::min(memory_begin, disk_segment_end)) {
+         rocksdb::ReadOptions read_options;
+         read_options.total_order_seek = true;
+         std::unique_ptr<rocksdb::Iterator> rocks_it{ db.rdb->NewIterator(read_options) };
+         auto                               first = create_segment_key(first_segment);
+         rocks_it->Seek(to_slice(segment_next_prefix));
+         if (rocks_it->Valid())
+            rocks_it->Prev();
+
+         while (rocks_it->Valid()) {
+            auto segment_key = rocks_it->key();
+            if (compare_blob(segment_key, first) < 0)
+               break;
+            undo_segment(rocks_it->value());
+            check(batch.Delete(segment_key), "undo_stack::undo: rocksdb::WriteBatch::Delete: ");
+            rocks_it->Prev();
+         }
+         check(rocks_it->status(), "undo_stack::undo: iterate rocksdb: ");
       }
-      check(rocks_it->status(), "undo_stack::undo: iterate rocksdb: ");
 
       state.next_undo_segment -= state.undo_stack.back();
+      disk_segment_end = std::min(disk_segment_end, state.next_undo_segment);
       state.undo_stack.pop_back();
       --state.revision;
       if (write_now) {
@@ -559,8 +670,11 @@ class undo_stack {
          uint64_t keep_undo_segment = state.next_undo_segment;
          for (auto n : state.undo_stack) //
             keep_undo_segment -= n;
-         check(batch.DeleteRange(to_slice(create_segment_key(0)), to_slice(create_segment_key(keep_undo_segment))),
-               "undo_stack::commit: rocksdb::WriteBatch::DeleteRange: ");
+         while (!memory_segments.empty() && first_memory_segment() < keep_undo_segment) {
+            memory_segments_size -= memory_segments.front().size();
+            memory_segments.pop_front();
+         }
+         delete_disk_segments(batch, keep_undo_segment, "undo_stack::commit: rocksdb::WriteBatch::DeleteRange: ");
          write_state(batch);
          db.write(batch);
       }
@@ -578,8 +692,10 @@ class undo_stack {
       auto write_segment = [&] {
          if (segment.empty())
             return;
-         auto key = create_segment_key(state.next_undo_segment++);
-         check(batch.Put(to_slice(key), to_slice(segment)), "undo_stack::write_changes: rocksdb::WriteBatch::Put: ");
+         // copy, segment keeps its reserved capacity
+         memory_segments.emplace_back(segment.begin(), segment.end());
+         memory_segments_size += segment.size();
+         ++state.next_undo_segment;
          ++state.undo_stack.back();
          segment.clear();
       };
@@ -613,10 +729,46 @@ class undo_stack {
       }
 
       write_segment();
+      spill_segments(batch, memory_undo_size);
       write_state(batch);
       db.write(batch);
    } // write_changes()
 
+   // Write the changes in `cache` to a sorted SST file at `sst_path` and ingest it into the database, which bypasses
+   // the memtable. Only possible while there is no undo stack since no undo segments are recorded. The cache is
+   // ordered like rocksdb, so the changes are taken from it in order rather than from the change list.
+   void ingest_changes(cache_map& cache, const std::string& sst_path) {
+      if (!state.undo_stack.empty())
+         throw exception("cannot ingest changes while there is an existing undo stack");
+
+      rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), db.rdb->GetOptions());
+      bool                   opened = false;
+      for (auto& [key, value] : cache) {
+         if (!value.in_change_list || !compare_value(value.orig_value, value.current_value))
+            continue;
+         if (!opened) {
+            check(writer.Open(sst_path), "undo_stack::ingest_changes: rocksdb::SstFileWriter::Open: ");
+            opened = true;
+         }
+         if (value.current_value)
+            check(writer.Put(to_slice(key), to_slice(*value.current_value)),
+                  "undo_stack::ingest_changes: rocksdb::SstFileWriter::Put: ");
+         else
+            check(writer.Delete(to_slice(key)), "undo_stack::ingest_changes: rocksdb::SstFileWriter::Delete: ");
+      }
+
+      if (opened) {
+         check(writer.Finish(), "undo_stack::ingest_changes: rocksdb::SstFileWriter::Finish: ");
+         rocksdb::IngestExternalFileOptions options;
+         options.move_files = true;
+         check(db.rdb->IngestExternalFile({ sst_path }, options),
+               "undo_stack::ingest_changes: rocksdb::DB::IngestExternalFile: ");
+         // left behind if rocksdb copied the file rather than linking it
+         std::remove(sst_path.c_str());
+      }
+      write_state();
+   } // ingest_changes()
+
    void write_state() {
       rocksdb::WriteBatch batch;
       write_state(batch);
@@ -629,6 +781,29 @@ class undo_stack {
             "undo_stack::write_state: rocksdb::WriteBatch::Put: ");
    }
 
+   uint64_t first_memory_segment() const { return state.next_undo_segment - memory_segments.size(); }
+
+   // Write the oldest segments in memory to rocksdb until the rest fits in max_size
+   void spill_segments(rocksdb::WriteBatch& batch, uint64_t max_size) {
+      while (memory_segments_size > max_size) {
+         auto key = create_segment_key(first_memory_segment());
+         check(batch.Put(to_slice(key), to_slice(memory_segments.front())),
+               "undo_stack::spill_segments: rocksdb::WriteBatch::Put: ");
+         memory_segments_size -= memory_segments.front().size();
+         memory_segments.pop_front();
+         disk_segment_end = first_memory_segment();
+      }
+   }
+
+   // Remove the segments before end from rocksdb, skipping the DeleteRange when none can be there
+   void delete_disk_segments(rocksdb::WriteBatch& batch, uint64_t end, const char* desc) {
+      auto disk_end = std::min(end, disk_segment_end);
+      if (disk_segment_begin < disk_end)
+         check(batch.DeleteRange(to_slice(create_segment_key(disk_segment_begin)), to_slice(create_segment_key(disk_end))),
+               desc);
+      disk_segment_begin = std::max(disk_segment_begin, disk_end);
+   }
+
    bytes create_segment_key(uint64_t segment) {
       bytes key;
       key.reserve(segment_prefix.size() + sizeof(segment));
@@ -661,6 +836,13 @@ struct write_session {
       return r;
    }
 
+   // Iterators move across prefixes, so they must not be limited to the prefix of their first seek
+   rocksdb::ReadOptions iterator_read_options() {
+      auto r             = read_options();
+      r.total_order_seek = true;
+      return r;
+   }
+
    // Add item to change_list
    void changed(cache_map::iterator it) {
       if (it->second.in_change_list)
@@ -767,6 +949,14 @@ struct write_session {
       wipe_cache();
    }
 
+   // Ingest changes in `change_list` into the database from an SST file. See undo_stack::ingest_changes.
+   //
+   // Caution: ingest_changes wipes the cache, which invalidates iterators
+   void ingest_changes(undo_stack& u, const std::string& sst_path) {
+      u.ingest_changes(cache, sst_path);
+      wipe_cache();
+   }
+
    // Wipe the cache. Invalidates iterators.
    void wipe_cache() {
       cache.clear();
@@ -803,7 +993,7 @@ class view {
           : view{ view },                                                                         //
             prefix{ create_full_key(view.prefix, contract, prefix) },                             //
             hidden_prefix_size{ view.prefix.size() + sizeof(contract) },                          //
-            rocks_it{ view.write_session.db.rdb->NewIterator(view.write_session.read_options()) } //
+            rocks_it{ view.write_session.db.rdb->NewIterator(view.write_session.iterator_read_options()) } //
       {
          next_prefix = get_next_prefix(this->prefix);
 
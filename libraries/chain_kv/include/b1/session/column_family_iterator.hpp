@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cassert>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <rocksdb/iterator.h>
+
+namespace eosio::session {
+
+/// \brief A RocksDB iterator that presents the keys of several column families as one ordered sequence.
+/// \remarks Each key is expected to live in exactly one of the column families, which is the case when keys are
+/// assigned to column families by prefix.  Positioning follows the same rules as a RocksDB iterator over a single
+/// column family, so a session can spread its keys over column families without its iterators noticing.
+class column_family_iterator : public rocksdb::Iterator {
+ public:
+   explicit column_family_iterator(std::vector<std::unique_ptr<rocksdb::Iterator>> iterators);
+
+   bool Valid() const override;
+   void SeekToFirst() override;
+   void SeekToLast() override;
+   void Seek(const rocksdb::Slice& target) override;
+   void SeekForPrev(const rocksdb::Slice& target) override;
+   void Next() override;
+   void Prev() override;
+
+   rocksdb::Slice  key() const override;
+   rocksdb::Slice  value() const override;
+   rocksdb::Status status() const override;
+   rocksdb::Status Refresh() override;
+
+ private:
+   /// \brief Selects the column family iterator with the smallest key when moving forward and the largest key when
+   /// moving backward.
+   void select_();
+
+ private:
+   static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+   std::vector<std::unique_ptr<rocksdb::Iterator>> m_iterators;
+   size_t                                           m_current{ npos };
+   bool                                             m_forward{ true };
+};
+
+inline column_family_iterator::column_family_iterator(std::vector<std::unique_ptr<rocksdb::Iterator>> iterators)
+    : m_iterators{ std::move(iterators) } {}
+
+inline bool column_family_iterator::Valid() const { return m_current != npos; }
+
+inline void column_family_iterator::SeekToFirst() {
+   for (auto& it : m_iterators) { it->SeekToFirst(); }
+   m_forward = true;
+   select_();
+}
+
+inline void column_family_iterator::SeekToLast() {
+   for (auto& it : m_iterators) { it->SeekToLast(); }
+   m_forward = false;
+   select_();
+}
+
+inline void column_family_iterator::Seek(const rocksdb::Slice& target) {
+   for (auto& it : m_iterators) { it->Seek(target); }
+   m_forward = true;
+   select_();
+}
+
+inline void column_family_iterator::SeekForPrev(const rocksdb::Slice& target) {
+   for (auto& it : m_iterators) { it->SeekForPrev(target); }
+   m_forward = false;
+   select_();
+}
+
+inline void column_family_iterator::Next() {
+   assert(Valid());
+   if (!m_forward) {
+      // The other iterators are positioned before the current key, move them past it.
+      auto current_key = m_iterators[m_current]->key();
+      for (size_t i = 0; i < m_iterators.size(); ++i) {
+         if (i != m_current) {
+            m_iterators[i]->Seek(current_key);
+         }
+      }
+      m_forward = true;
+   }
+   m_iterators[m_current]->Next();
+   select_();
+}
+
+inline void column_family_iterator::Prev() {
+   assert(Valid());
+   if (m_forward) {
+      // The other iterators are positioned after the current key, move them before it.
+      auto current_key = m_iterators[m_current]->key();
+      for (size_t i = 0; i < m_iterators.size(); ++i) {
+         if (i != m_current) {
+            m_iterators[i]->SeekForPrev(current_key);
+         }
+      }
+      m_forward = false;
+   }
+   m_iterators[m_current]->Prev();
+   select_();
+}
+
+inline rocksdb::Slice column_family_iterator::key() const {
+   assert(Valid());
+   return m_iterators[m_current]->key();
+}
+
+inline rocksdb::Slice column_family_iterator::value() const {
+   assert(Valid());
+   return m_iterators[m_current]->value();
+}
+
+inline rocksdb::Status column_family_iterator::status() const {
+   for (const auto& it : m_iterators) {
+      auto result = it->status();
+      if (!result.ok()) {
+         return result;
+      }
+   }
+   return rocksdb::Status::OK();
+}
+
+inline rocksdb::Status column_family_iterator::Refresh() {
+   m_current = npos;
+   for (auto& it : m_iterators) {
+      auto result = it->Refresh();
+      if (!result.ok()) {
+         return result;
+      }
+   }
+   return rocksdb::Status::OK();
+}
+
+inline void column_family_iterator::select_() {
+   m_current = npos;
+   for (size_t i = 0; i < m_iterators.size(); ++i) {
+      if (!m_iterators[i]->Valid()) {
+         continue;
+      }
+      if (m_current == npos) {
+         m_current = i;
+         continue;
+      }
+      auto comparison = m_iterators[i]->key().compare(m_iterators[m_current]->key());
+      if (m_forward ? comparison < 0 : comparison > 0) {
+         m_current = i;
+      }
+   }
+}
+
+} // namespace eosio::session
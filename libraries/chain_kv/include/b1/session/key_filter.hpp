@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace eosio::session {
+
+/// \brief A Bloom filter over key hashes.
+/// \remarks Used by a session to tell, without searching its cache, that a key is not in it.  Keys are only ever
+/// added, the filter is emptied with clear.  The filter does not grow by itself; add returns false once it holds more
+/// keys than it was sized for and the owner is expected to reset it to a larger size and add all of its keys again.
+class key_filter {
+ public:
+   static constexpr size_t bits_per_key = 8;
+   static constexpr size_t probes       = 4;
+   static constexpr size_t min_keys     = 128;
+
+   /// \brief Indicates if a key with the given hash may have been added.
+   /// \return False if the key was definitely not added, true if it may have been.
+   bool may_contain(size_t hash) const {
+      if (m_count == 0) {
+         return false;
+      }
+      auto h1 = hash;
+      auto h2 = rotate_(hash) | 1;
+      for (size_t i = 0; i < probes; ++i, h1 += h2) {
+         auto bit = h1 & m_mask;
+         if (!(m_words[bit / 64] & (uint64_t{ 1 } << (bit % 64)))) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   /// \brief Adds a key hash to the filter.
+   /// \return False if the filter is over capacity and should be reset with a larger capacity.
+   bool add(size_t hash) {
+      if (m_words.empty()) {
+         reset(min_keys);
+      }
+      auto h1 = hash;
+      auto h2 = rotate_(hash) | 1;
+      for (size_t i = 0; i < probes; ++i, h1 += h2) {
+         auto bit = h1 & m_mask;
+         m_words[bit / 64] |= uint64_t{ 1 } << (bit % 64);
+      }
+      return ++m_count <= (m_mask + 1) / bits_per_key;
+   }
+
+   /// \brief Empties the filter and sizes it to hold at least the given number of keys.
+   void reset(size_t keys) {
+      auto bits = size_t{ 64 };
+      while (bits < keys * bits_per_key) {
+         bits *= 2;
+      }
+      m_words.assign(bits / 64, 0);
+      m_mask  = bits - 1;
+      m_count = 0;
+   }
+
+   /// \brief Empties the filter, keeping its current size.
+   void clear() {
+      if (m_count > 0) {
+         std::fill(std::begin(m_words), std::end(m_words), 0);
+         m_count = 0;
+      }
+   }
+
+ private:
+   static size_t rotate_(size_t hash) {
+      constexpr auto half = sizeof(size_t) * 4;
+      return (hash >> half) | (hash << half);
+   }
+
+   std::vector<uint64_t> m_words;
+   size_t                m_mask{ 0 };
+   size_t                m_count{ 0 };
+};
+
+} // namespace eosio::session
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <forward_list>
 #include <iterator>
@@ -13,6 +15,7 @@
 #include <rocksdb/options.h>
 #include <rocksdb/slice_transform.h>
 
+#include <b1/session/column_family_iterator.hpp>
 #include <b1/session/session.hpp>
 #include <eosio/chain/exceptions.hpp>
 
@@ -28,7 +31,7 @@ struct rocksdb_t {};
 template <>
 class session<rocksdb_t> {
  public:
-   template <typename Parent>
+   template <typename Parent, typename Cache>
    friend class session;
 
    template <typename Iterator_traits>
@@ -79,6 +82,12 @@ class session<rocksdb_t> {
    };
    using iterator = rocks_iterator<iterator_traits>;
 
+   /// \brief Keys starting with prefix are stored in column_family instead of the session column family.
+   struct column_family_prefix {
+      shared_bytes                                 prefix;
+      std::shared_ptr<rocksdb::ColumnFamilyHandle> column_family;
+   };
+
  public:
    session()               = default;
    session(const session&) = default;
@@ -89,6 +98,13 @@ class session<rocksdb_t> {
    /// \param max_iterators This type will cache up to max_iterators RocksDB iterator instances.
    session(std::shared_ptr<rocksdb::DB> db, size_t max_iterators);
 
+   /// \brief Constructor
+   /// \param db A pointer to the RocksDB db type instance.
+   /// \param max_iterators This type will cache up to max_iterators RocksDB iterator instances.
+   /// \param prefixes Key prefixes stored in their own column families.  The prefixes must not overlap.
+   /// \remarks Iterators of this session walk the keys of all the column families in order.
+   session(std::shared_ptr<rocksdb::DB> db, size_t max_iterators, std::vector<column_family_prefix> prefixes);
+
    session& operator=(const session&) = default;
    session& operator=(session&&) = default;
 
@@ -118,6 +134,10 @@ class session<rocksdb_t> {
    template <typename Other_data_store, typename Iterable>
    void read_from(Other_data_store& ds, const Iterable& keys);
 
+   /// \brief Does nothing, reads from RocksDB are not cached in this session.
+   template <typename Iterable>
+   void prefetch(const Iterable& keys) {}
+
    iterator find(const shared_bytes& key);
    iterator begin();
    iterator end();
@@ -131,6 +151,10 @@ class session<rocksdb_t> {
 
    static void destroy(const std::string& db_name);
 
+   /// \brief Sum of an integer property over the column families of the RocksDB db instance, 0 when it is not known.
+   /// \param property The name of the property, e.g. rocksdb::DB::Properties::kBlockCacheUsage.
+   uint64_t aggregated_int_property(const rocksdb::Slice& property) const;
+
    /// \brief User specified write options that are applied when writing or erasing data from RocksDB.
    rocksdb::WriteOptions& write_options();
 
@@ -170,9 +194,19 @@ class session<rocksdb_t> {
    /// \remarks If there is no user defined column family, this method will return the RocksDB default column family.
    rocksdb::ColumnFamilyHandle* column_family_() const;
 
+   /// \brief Returns the column family the given key is stored in.
+   rocksdb::ColumnFamilyHandle* column_family_(const rocksdb::Slice& key) const;
+
+   /// \brief Returns the distinct column families of this session, starting with the session column family.
+   std::vector<rocksdb::ColumnFamilyHandle*> column_families_() const;
+
+   /// \brief Returns a new RocksDB iterator over all the column families of this session.
+   rocksdb::Iterator* new_iterator_() const;
+
  private:
    std::shared_ptr<rocksdb::DB>                 m_db;
    std::shared_ptr<rocksdb::ColumnFamilyHandle> m_column_family;
+   std::vector<column_family_prefix>            m_prefixes;
    rocksdb::ReadOptions                         m_read_options;
    rocksdb::ReadOptions                         m_iterator_read_options;
    rocksdb::WriteOptions                        m_write_options;
@@ -182,17 +216,41 @@ class session<rocksdb_t> {
 
    /// \brief A list of the available indices in the iterator cache that are available for use.
    mutable std::vector<size_t> m_free_list;
+
+   /// \brief Incremented on every write or erase.
+   /// \remarks Writes may come from another thread than reads, see undo_stack::write_commits_in_background.
+   std::shared_ptr<std::atomic<uint64_t>> m_write_generation{ std::make_shared<std::atomic<uint64_t>>(0) };
+
+   /// \brief The write generation each cached RocksDB iterator was last refreshed at.
+   /// \remarks A RocksDB iterator only sees the data written before it was created or refreshed.  Cached iterators
+   /// are reused by seeking them and are only refreshed when something was written since.
+   mutable std::vector<uint64_t> m_iterator_generations;
 };
 
 inline session<rocksdb_t> make_session(std::shared_ptr<rocksdb::DB> db, size_t max_iterators) {
    return { std::move(db), max_iterators };
 }
 
+inline session<rocksdb_t> make_session(std::shared_ptr<rocksdb::DB> db, size_t max_iterators,
+                                       std::vector<session<rocksdb_t>::column_family_prefix> prefixes) {
+   return { std::move(db), max_iterators, std::move(prefixes) };
+}
+
 inline session<rocksdb_t>::session(std::shared_ptr<rocksdb::DB> db, size_t max_iterators)
+    : session{ std::move(db), max_iterators, {} } {}
+
+inline session<rocksdb_t>::session(std::shared_ptr<rocksdb::DB> db, size_t max_iterators,
+                                   std::vector<column_family_prefix> prefixes)
     : m_db{ [&]() {
          EOS_ASSERT(db, eosio::chain::database_exception, "db parameter cannot be null");
          return std::move(db);
       }() },
+      m_prefixes{ [&]() {
+         for (const auto& p : prefixes) {
+            EOS_ASSERT(p.column_family, eosio::chain::database_exception, "column family of prefix cannot be null");
+         }
+         return std::move(prefixes);
+      }() },
       m_iterator_read_options{ [&]() {
          auto read_options                                 = rocksdb::ReadOptions{};
          read_options.verify_checksums                     = false;
@@ -204,17 +262,15 @@ inline session<rocksdb_t>::session(std::shared_ptr<rocksdb::DB> db, size_t max_i
          auto iterators = decltype(m_iterators){};
          iterators.reserve(max_iterators);
 
-         auto column_family = column_family_();
-         for (size_t i = 0; i < max_iterators; ++i) {
-            iterators.emplace_back(m_db->NewIterator(m_iterator_read_options, column_family));
-         }
+         for (size_t i = 0; i < max_iterators; ++i) { iterators.emplace_back(new_iterator_()); }
          return iterators;
       }() },
       m_free_list{ [&]() {
          auto list = decltype(m_free_list)(m_iterators.size());
          for (size_t i = 0; i < m_iterators.size(); ++i) { list[i] = i; }
          return list;
-      }() } {
+      }() },
+      m_iterator_generations(m_iterators.size(), 0) {
    m_write_options.disableWAL = true;
 }
 
@@ -231,7 +287,7 @@ inline bool session<rocksdb_t>::is_deleted(const shared_bytes& key) const { retu
 inline std::optional<shared_bytes> session<rocksdb_t>::read(const shared_bytes& key) {
    auto key_slice      = rocksdb::Slice{ key.data(), key.size() };
    auto pinnable_value = rocksdb::PinnableSlice{};
-   auto status         = m_db->Get(m_read_options, column_family_(), key_slice, &pinnable_value);
+   auto status         = m_db->Get(m_read_options, column_family_(key_slice), key_slice, &pinnable_value);
 
    if (status.code() != rocksdb::Status::Code::kOk) {
       return {};
@@ -243,18 +299,20 @@ inline std::optional<shared_bytes> session<rocksdb_t>::read(const shared_bytes&
 inline void session<rocksdb_t>::write(const shared_bytes& key, const shared_bytes& value) {
    auto key_slice   = rocksdb::Slice{ key.data(), key.size() };
    auto value_slice = rocksdb::Slice{ value.data(), value.size() };
-   auto status      = m_db->Put(m_write_options, column_family_(), key_slice, value_slice);
+   auto status      = m_db->Put(m_write_options, column_family_(key_slice), key_slice, value_slice);
+   ++*m_write_generation;
 }
 
 inline bool session<rocksdb_t>::contains(const shared_bytes& key) {
    auto key_slice = rocksdb::Slice{ key.data(), key.size() };
    auto value     = std::string{};
-   return m_db->KeyMayExist(m_read_options, column_family_(), key_slice, &value);
+   return m_db->KeyMayExist(m_read_options, column_family_(key_slice), key_slice, &value);
 }
 
 inline void session<rocksdb_t>::erase(const shared_bytes& key) {
    auto key_slice = rocksdb::Slice{ key.data(), key.size() };
-   auto status    = m_db->Delete(m_write_options, column_family_(), key_slice);
+   auto status    = m_db->Delete(m_write_options, column_family_(key_slice), key_slice);
+   ++*m_write_generation;
 }
 
 inline void session<rocksdb_t>::clear() {}
@@ -262,17 +320,19 @@ inline void session<rocksdb_t>::clear() {}
 template <typename Iterable>
 const std::pair<std::vector<std::pair<shared_bytes, shared_bytes>>, std::unordered_set<shared_bytes>>
 session<rocksdb_t>::read_(const Iterable& keys) {
-   auto not_found  = std::unordered_set<shared_bytes>{};
-   auto key_slices = std::vector<rocksdb::Slice>{};
+   auto not_found       = std::unordered_set<shared_bytes>{};
+   auto key_slices      = std::vector<rocksdb::Slice>{};
+   auto column_families = std::vector<rocksdb::ColumnFamilyHandle*>{};
 
    for (const auto& key : keys) {
       key_slices.emplace_back(key.data(), key.size());
+      column_families.emplace_back(column_family_(key_slices.back()));
       not_found.emplace(key);
    }
 
    auto values = std::vector<std::string>{};
    values.reserve(key_slices.size());
-   auto status = m_db->MultiGet(m_read_options, { key_slices.size(), column_family_() }, key_slices, &values);
+   auto status = m_db->MultiGet(m_read_options, column_families, key_slices, &values);
 
    auto kvs = std::vector<std::pair<shared_bytes, shared_bytes>>{};
    kvs.reserve(key_slices.size());
@@ -301,18 +361,21 @@ void session<rocksdb_t>::write(const Iterable& key_values) {
    auto batch = rocksdb::WriteBatch{ 1024 * 1024 };
 
    for (const auto& kv : key_values) {
-      batch.Put(column_family_(), { kv.first.data(), kv.first.size() }, { kv.second.data(), kv.second.size() });
+      auto key_slice = rocksdb::Slice{ kv.first.data(), kv.first.size() };
+      batch.Put(column_family_(key_slice), key_slice, { kv.second.data(), kv.second.size() });
    }
 
    auto status = m_db->Write(m_write_options, &batch);
+   ++*m_write_generation;
 }
 
 template <typename Iterable>
 void session<rocksdb_t>::erase(const Iterable& keys) {
    for (const auto& key : keys) {
       auto key_slice = rocksdb::Slice{ key.data(), key.size() };
-      auto status    = m_db->Delete(m_write_options, column_family_(), key_slice);
+      auto status    = m_db->Delete(m_write_options, column_family_(key_slice), key_slice);
    }
+   ++*m_write_generation;
 }
 
 template <typename Other_data_store, typename Iterable>
@@ -330,6 +393,17 @@ void session<rocksdb_t>::read_from(Other_data_store& ds, const Iterable& keys) {
 template <typename Iterator_traits>
 using rocks_iterator_alias = typename session<rocksdb_t>::template rocks_iterator<Iterator_traits>;
 
+/// \brief Moves a RocksDB iterator past the last key, which is how the end iterator is represented.
+/// \remarks Cheaper than refreshing the iterator, which also leaves it invalid.
+inline void seek_to_end(rocksdb::Iterator& it) {
+   if (it.Valid()) {
+      it.SeekToLast();
+      if (it.Valid()) {
+         it.Next();
+      }
+   }
+}
+
 template <typename Predicate>
 typename session<rocksdb_t>::iterator session<rocksdb_t>::make_iterator_(const Predicate& setup) const {
    rocksdb::Iterator* rit   = nullptr;
@@ -338,9 +412,13 @@ typename session<rocksdb_t>::iterator session<rocksdb_t>::make_iterator_(const P
       index = m_free_list.back();
       m_free_list.pop_back();
       rit = m_iterators[index].get();
-      rit->Refresh();
+      const auto write_generation = m_write_generation->load();
+      if (m_iterator_generations[index] != write_generation) {
+         rit->Refresh();
+         m_iterator_generations[index] = write_generation;
+      }
    } else {
-      rit = m_db->NewIterator(m_iterator_read_options, column_family_());
+      rit = new_iterator_();
    }
    setup(*rit);
 
@@ -353,7 +431,7 @@ inline typename session<rocksdb_t>::iterator session<rocksdb_t>::find(const shar
       it.Seek(key_slice);
       if (it.Valid() && it.key().compare(key_slice) != 0) {
          // Get an invalid iterator
-         it.Refresh();
+         seek_to_end(it);
       }
    };
    return make_iterator_(predicate);
@@ -364,7 +442,7 @@ inline typename session<rocksdb_t>::iterator session<rocksdb_t>::begin() {
 }
 
 inline typename session<rocksdb_t>::iterator session<rocksdb_t>::end() {
-   return make_iterator_([](auto& it) {});
+   return make_iterator_([](auto& it) { seek_to_end(it); });
 }
 
 inline typename session<rocksdb_t>::iterator session<rocksdb_t>::lower_bound(const shared_bytes& key) {
@@ -375,7 +453,13 @@ inline void session<rocksdb_t>::flush() {
    rocksdb::FlushOptions op;
    op.allow_write_stall = true;
    op.wait              = true;
-   m_db->Flush(op);
+   for (auto* column_family : column_families_()) { m_db->Flush(op, column_family); }
+}
+
+inline uint64_t session<rocksdb_t>::aggregated_int_property(const rocksdb::Slice& property) const {
+   uint64_t value = 0;
+   if (!m_db->GetAggregatedIntProperty(property, &value)) { return 0; }
+   return value;
 }
 
 inline void session<rocksdb_t>::destroy(const std::string& db_name) {
@@ -409,6 +493,39 @@ inline rocksdb::ColumnFamilyHandle* session<rocksdb_t>::column_family_() const {
    return nullptr;
 }
 
+inline rocksdb::ColumnFamilyHandle* session<rocksdb_t>::column_family_(const rocksdb::Slice& key) const {
+   // Only a handful of prefixes are expected, a linear scan is cheaper than anything fancier.
+   for (const auto& p : m_prefixes) {
+      if (key.starts_with(rocksdb::Slice{ p.prefix.data(), p.prefix.size() })) {
+         return p.column_family.get();
+      }
+   }
+   return column_family_();
+}
+
+inline std::vector<rocksdb::ColumnFamilyHandle*> session<rocksdb_t>::column_families_() const {
+   auto result = std::vector<rocksdb::ColumnFamilyHandle*>{ column_family_() };
+   for (const auto& p : m_prefixes) {
+      // Several prefixes can share a column family.
+      if (std::find(std::begin(result), std::end(result), p.column_family.get()) == std::end(result)) {
+         result.push_back(p.column_family.get());
+      }
+   }
+   return result;
+}
+
+inline rocksdb::Iterator* session<rocksdb_t>::new_iterator_() const {
+   if (m_prefixes.empty()) {
+      return m_db->NewIterator(m_iterator_read_options, column_family_());
+   }
+
+   auto iterators = std::vector<std::unique_ptr<rocksdb::Iterator>>{};
+   for (auto* column_family : column_families_()) {
+      iterators.emplace_back(m_db->NewIterator(m_iterator_read_options, column_family));
+   }
+   return new column_family_iterator(std::move(iterators));
+}
+
 template <typename Iterator_traits>
 session<rocksdb_t>::rocks_iterator<Iterator_traits>::rocks_iterator(const rocks_iterator& it)
     : rocks_iterator{ it.m_iterator->Valid() ? it.m_session->find(it.key()) : it.m_session->end() } {}
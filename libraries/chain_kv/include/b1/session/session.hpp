@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <optional>
 #include <queue>
 #include <set>
@@ -9,6 +10,9 @@
 #include <unordered_set>
 #include <variant>
 
+#include <b1/session/key_filter.hpp>
+#include <b1/session/session_cache.hpp>
+#include <b1/session/session_fwd.hpp>
 #include <b1/session/shared_bytes.hpp>
 
 namespace eosio::session {
@@ -22,9 +26,10 @@ overloaded(Ts...) -> overloaded<Ts...>;
 
 /// \brief Defines a session for reading/write data to a cache and persistent data store.
 /// \tparam Parent The parent type of this session
+/// \tparam Cache The cache policy for the session's key cache, refer to session_cache.hpp.
 /// \remarks Specializations of this type can be created to create new parent types that
 /// modify a different data store.  For an example refer to the rocks_session type in this folder.
-template <typename Parent>
+template <typename Parent, typename Cache>
 class session {
  public:
    struct value_state {
@@ -44,7 +49,7 @@ class session {
 
    using type                = session;
    using parent_type         = Parent;
-   using cache_type          = std::map<shared_bytes, value_state>;
+   using cache_type          = typename Cache::template type<value_state>;
    using parent_variant_type = std::variant<type*, parent_type*>;
 
    friend Parent;
@@ -170,6 +175,9 @@ class session {
    /// \brief Commits the changes in this session into its parent.
    void commit();
 
+   /// \brief Returns the changes commit would write into the parent, the updated key values and the deleted keys.
+   std::pair<std::unordered_map<shared_bytes, shared_bytes>, std::unordered_set<shared_bytes>> changes() const;
+
    std::optional<shared_bytes> read(const shared_bytes& key);
    void                        write(const shared_bytes& key, const shared_bytes& value);
    bool                        contains(const shared_bytes& key);
@@ -207,6 +215,15 @@ class session {
    template <typename Other_data_store, typename Iterable>
    void read_from(Other_data_store& ds, const Iterable& keys);
 
+   /// \brief Reads a batch of keys from the root of the session heirarchy into this session's cache, so that reading
+   /// them afterwards doesn't reach the root one key at a time.
+   /// \param keys A type that supports iteration and returns in its iterator a shared_bytes type representing the key.
+   /// \remarks Only keys that no session in the heirarchy holds are read from the root, since any other key may have
+   /// been updated or deleted on its way down and is left for read to resolve.  Prefetched keys are cached without
+   /// knowledge of their neighboring keys, which iteration resolves from the parent as it would for any other key.
+   template <typename Iterable>
+   void prefetch(const Iterable& keys);
+
    /// \brief Returns an iterator to the key, or the end iterator if the key is not in the cache or session heirarchy.
    /// \param key The key to search for.
    /// \return An iterator to the key if found, the end iterator otherwise.
@@ -258,22 +275,33 @@ class session {
    template <typename It>
    It& first_not_deleted_in_iterator_cache_(It& it, const It& end) const;
 
+   /// \brief Adds the key to the cache, if it isn't already there, and to the key filter.
+   /// \return The result of emplacing the key into the cache.
+   std::pair<typename cache_type::iterator, bool> emplace_in_cache_(const shared_bytes& key);
+
+   /// \brief Reads the key from the session heirarchy above this session.
+   /// \remarks Parent sessions whose key filter shows they don't hold the key are skipped, instead of each of them
+   /// searching its cache and then asking its own parent.
+   std::optional<shared_bytes> read_from_parent_(const shared_bytes& key);
+
  private:
    parent_variant_type m_parent{ static_cast<Parent*>(nullptr) };
    cache_type          m_cache;
+   /// Filter over the keys in m_cache, including deleted keys.
+   key_filter          m_key_filter;
 };
 
-template <typename Parent>
-typename session<Parent>::parent_variant_type session<Parent>::parent() const {
+template <typename Parent, typename Cache>
+typename session<Parent, Cache>::parent_variant_type session<Parent, Cache>::parent() const {
    return m_parent;
 }
 
-template <typename Parent>
-void session<Parent>::prime_cache_() {
+template <typename Parent, typename Cache>
+void session<Parent, Cache>::prime_cache_() {
    // Get the bounds of the parent cache and use those to
    // seed the cache of this session.
    auto update = [&](const auto& key, const auto& value) {
-      auto it = m_cache.emplace(key, value_state{});
+      auto it = emplace_in_cache_(key);
       if (it.second) {
          it.first->second.value = value;
       }
@@ -293,35 +321,39 @@ void session<Parent>::prime_cache_() {
          m_parent);
 }
 
-template <typename Parent>
-void session<Parent>::clear() {
+template <typename Parent, typename Cache>
+void session<Parent, Cache>::clear() {
    m_cache.clear();
+   m_key_filter.clear();
 }
 
-template <typename Parent>
-session<Parent>::session(Parent& parent) : m_parent{ &parent } {
+template <typename Parent, typename Cache>
+session<Parent, Cache>::session(Parent& parent) : m_parent{ &parent } {
    attach(parent);
 }
 
-template <typename Parent>
-session<Parent>::session(session& parent, std::nullptr_t) : m_parent{ &parent } {
+template <typename Parent, typename Cache>
+session<Parent, Cache>::session(session& parent, std::nullptr_t) : m_parent{ &parent } {
    attach(parent);
 }
 
-template <typename Parent>
-session<Parent>::session(session&& other) : m_parent{ std::move(other.m_parent) }, m_cache{ std::move(other.m_cache) } {
+template <typename Parent, typename Cache>
+session<Parent, Cache>::session(session&& other)
+    : m_parent{ std::move(other.m_parent) }, m_cache{ std::move(other.m_cache) },
+      m_key_filter{ std::move(other.m_key_filter) } {
    session* null_parent = nullptr;
    other.m_parent       = null_parent;
 }
 
-template <typename Parent>
-session<Parent>& session<Parent>::operator=(session&& other) {
+template <typename Parent, typename Cache>
+session<Parent, Cache>& session<Parent, Cache>::operator=(session&& other) {
    if (this == &other) {
       return *this;
    }
 
-   m_parent = std::move(other.m_parent);
-   m_cache  = std::move(other.m_cache);
+   m_parent     = std::move(other.m_parent);
+   m_cache      = std::move(other.m_cache);
+   m_key_filter = std::move(other.m_key_filter);
 
    session* null_parent = nullptr;
    other.m_parent       = null_parent;
@@ -329,26 +361,26 @@ session<Parent>& session<Parent>::operator=(session&& other) {
    return *this;
 }
 
-template <typename Parent>
-session<Parent>::~session() {
+template <typename Parent, typename Cache>
+session<Parent, Cache>::~session() {
    commit();
    undo();
 }
 
-template <typename Parent>
-void session<Parent>::undo() {
+template <typename Parent, typename Cache>
+void session<Parent, Cache>::undo() {
    detach();
    clear();
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename It, typename Parent_it>
-void session<Parent>::previous_key_(It& it, Parent_it& pit, Parent_it& pbegin, Parent_it& pend) {
+void session<Parent, Cache>::previous_key_(It& it, Parent_it& pit, Parent_it& pbegin, Parent_it& pend) {
    if (it->first) {
       if (pit != pbegin) {
          --pit;
          if (pit != pend) {
-            auto cit = m_cache.emplace(pit.key(), value_state{});
+            auto cit = emplace_in_cache_(pit.key());
             if (cit.second) {
                cit.first->second.value = *(*pit).second;
             }
@@ -365,9 +397,9 @@ void session<Parent>::previous_key_(It& it, Parent_it& pit, Parent_it& pbegin, P
    }
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename It, typename Parent_it>
-void session<Parent>::next_key_(It& it, Parent_it& pit, Parent_it& pend) {
+void session<Parent, Cache>::next_key_(It& it, Parent_it& pit, Parent_it& pend) {
    if (it->first) {
       bool decrement = false;
       if (pit.key() == it->first) {
@@ -375,7 +407,7 @@ void session<Parent>::next_key_(It& it, Parent_it& pit, Parent_it& pend) {
          decrement = true;
       }
       if (pit != pend) {
-         auto cit = m_cache.emplace(pit.key(), value_state{});
+         auto cit = emplace_in_cache_(pit.key());
          if (cit.second) {
             cit.first->second.value = *(*pit).second;
          }
@@ -393,9 +425,9 @@ void session<Parent>::next_key_(It& it, Parent_it& pit, Parent_it& pend) {
    }
 }
 
-template <typename Parent>
-typename session<Parent>::cache_type::iterator session<Parent>::update_iterator_cache_(const shared_bytes& key) {
-   auto  result = m_cache.emplace(key, value_state{});
+template <typename Parent, typename Cache>
+typename session<Parent, Cache>::cache_type::iterator session<Parent, Cache>::update_iterator_cache_(const shared_bytes& key) {
+   auto  result = emplace_in_cache_(key);
    auto& it     = result.first;
 
    if (result.second) {
@@ -444,8 +476,45 @@ typename session<Parent>::cache_type::iterator session<Parent>::update_iterator_
    return it;
 }
 
-template <typename Parent>
-std::unordered_set<shared_bytes> session<Parent>::updated_keys() const {
+template <typename Parent, typename Cache>
+std::pair<typename session<Parent, Cache>::cache_type::iterator, bool>
+session<Parent, Cache>::emplace_in_cache_(const shared_bytes& key) {
+   auto result = m_cache.emplace(key, value_state{});
+   if (result.second && !m_key_filter.add(std::hash<shared_bytes>{}(key))) {
+      // The filter is over capacity, rebuild it with room to grow.
+      m_key_filter.reset(m_cache.size() * 2);
+      for (const auto& kv : m_cache) { m_key_filter.add(std::hash<shared_bytes>{}(kv.first)); }
+   }
+   return result;
+}
+
+template <typename Parent, typename Cache>
+std::optional<shared_bytes> session<Parent, Cache>::read_from_parent_(const shared_bytes& key) {
+   const auto hash    = std::hash<shared_bytes>{}(key);
+   auto*      current = this;
+   while (auto* parent_session = std::get_if<session*>(&current->m_parent)) {
+      if (*parent_session == nullptr) {
+         return {};
+      }
+      if ((*parent_session)->m_key_filter.may_contain(hash)) {
+         return (*parent_session)->read(key);
+      }
+      current = *parent_session;
+   }
+
+   // None of the parent sessions hold the key, read it from the root.
+   return std::visit(
+         [&](auto* p) -> std::optional<shared_bytes> {
+            if (p) {
+               return p->read(key);
+            }
+            return {};
+         },
+         current->m_parent);
+}
+
+template <typename Parent, typename Cache>
+std::unordered_set<shared_bytes> session<Parent, Cache>::updated_keys() const {
    auto results = std::unordered_set<shared_bytes>{};
    for (const auto& it : m_cache) {
       if (it.second.updated) {
@@ -455,8 +524,8 @@ std::unordered_set<shared_bytes> session<Parent>::updated_keys() const {
    return results;
 }
 
-template <typename Parent>
-std::unordered_set<shared_bytes> session<Parent>::deleted_keys() const {
+template <typename Parent, typename Cache>
+std::unordered_set<shared_bytes> session<Parent, Cache>::deleted_keys() const {
    auto results = std::unordered_set<shared_bytes>{};
    for (const auto& it : m_cache) {
       if (it.second.deleted) {
@@ -466,42 +535,49 @@ std::unordered_set<shared_bytes> session<Parent>::deleted_keys() const {
    return results;
 }
 
-template <typename Parent>
-void session<Parent>::attach(Parent& parent) {
+template <typename Parent, typename Cache>
+void session<Parent, Cache>::attach(Parent& parent) {
    m_parent = &parent;
    prime_cache_();
 }
 
-template <typename Parent>
-void session<Parent>::attach(session& parent) {
+template <typename Parent, typename Cache>
+void session<Parent, Cache>::attach(session& parent) {
    m_parent = &parent;
    prime_cache_();
 }
 
-template <typename Parent>
-void session<Parent>::detach() {
+template <typename Parent, typename Cache>
+void session<Parent, Cache>::detach() {
    session* null_parent = nullptr;
    m_parent             = null_parent;
 }
 
-template <typename Parent>
-void session<Parent>::commit() {
+template <typename Parent, typename Cache>
+std::pair<std::unordered_map<shared_bytes, shared_bytes>, std::unordered_set<shared_bytes>>
+session<Parent, Cache>::changes() const {
+   auto deletes = std::unordered_set<shared_bytes>{};
+   auto updates = std::unordered_map<shared_bytes, shared_bytes>{};
+
+   for (const auto& p : m_cache) {
+      if (p.second.deleted) {
+         deletes.emplace(p.first);
+      } else if (p.second.updated) {
+         updates.emplace(p.first, p.second.value);
+      }
+   }
+   return { std::move(updates), std::move(deletes) };
+}
+
+template <typename Parent, typename Cache>
+void session<Parent, Cache>::commit() {
    if (m_cache.empty()) {
       // Nothing to commit.
       return;
    }
 
    auto write_through = [&](auto& ds) {
-      auto deletes = std::unordered_set<shared_bytes>{};
-      auto updates = std::unordered_map<shared_bytes, shared_bytes>{};
-
-      for (const auto& p : m_cache) {
-         if (p.second.deleted) {
-            deletes.emplace(p.first);
-         } else if (p.second.updated) {
-            updates.emplace(p.first, p.second.value);
-         }
-      }
+      auto [updates, deletes] = changes();
 
       if (deletes.size() > 0) {
          ds.erase(deletes);
@@ -524,8 +600,8 @@ void session<Parent>::commit() {
          m_parent);
 }
 
-template <typename Parent>
-std::optional<shared_bytes> session<Parent>::read(const shared_bytes& key) {
+template <typename Parent, typename Cache>
+std::optional<shared_bytes> session<Parent, Cache>::read(const shared_bytes& key) {
    // Find the key within the session.
    // Check this level first and then traverse up to the parent to see if this key/value
    // has been read and/or update.
@@ -539,15 +615,7 @@ std::optional<shared_bytes> session<Parent>::read(const shared_bytes& key) {
       return it->second.value;
    }
 
-   auto value = std::optional<shared_bytes>{};
-   std::visit(
-         [&](auto* p) {
-            if (p) {
-               value = p->read(key);
-            }
-         },
-         m_parent);
-
+   auto value = read_from_parent_(key);
    if (value) {
       // Update the "iterator cache".
       auto it          = update_iterator_cache_(key);
@@ -557,16 +625,16 @@ std::optional<shared_bytes> session<Parent>::read(const shared_bytes& key) {
    return value;
 }
 
-template <typename Parent>
-void session<Parent>::write(const shared_bytes& key, const shared_bytes& value) {
+template <typename Parent, typename Cache>
+void session<Parent, Cache>::write(const shared_bytes& key, const shared_bytes& value) {
    auto it            = update_iterator_cache_(key);
    it->second.value   = value;
    it->second.deleted = false;
    it->second.updated = true;
 }
 
-template <typename Parent>
-bool session<Parent>::contains(const shared_bytes& key) {
+template <typename Parent, typename Cache>
+bool session<Parent, Cache>::contains(const shared_bytes& key) {
    // Traverse the heirarchy to see if this session (and its parent session)
    // has already read the key into memory.
 
@@ -580,31 +648,27 @@ bool session<Parent>::contains(const shared_bytes& key) {
       return true;
    }
 
-   return std::visit(
-         [&](auto* p) {
-            auto value = p->read(key);
-            if (value) {
-               auto it          = update_iterator_cache_(key);
-               it->second.value = std::move(*value);
-               return true;
-            }
-            return false;
-         },
-         m_parent);
+   auto value = read_from_parent_(key);
+   if (value) {
+      auto it          = update_iterator_cache_(key);
+      it->second.value = std::move(*value);
+      return true;
+   }
+   return false;
 }
 
-template <typename Parent>
-void session<Parent>::erase(const shared_bytes& key) {
+template <typename Parent, typename Cache>
+void session<Parent, Cache>::erase(const shared_bytes& key) {
    auto it            = update_iterator_cache_(key);
    it->second.deleted = true;
    it->second.updated = false;
    ++it->second.version;
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Iterable>
 const std::pair<std::vector<std::pair<shared_bytes, shared_bytes>>, std::unordered_set<shared_bytes>>
-session<Parent>::read(const Iterable& keys) {
+session<Parent, Cache>::read(const Iterable& keys) {
    auto not_found = std::unordered_set<shared_bytes>{};
    auto kvs       = std::vector<std::pair<shared_bytes, shared_bytes>>{};
 
@@ -620,23 +684,23 @@ session<Parent>::read(const Iterable& keys) {
    return { std::move(kvs), std::move(not_found) };
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Iterable>
-void session<Parent>::write(const Iterable& key_values) {
+void session<Parent, Cache>::write(const Iterable& key_values) {
    // Currently the batch write will just iteratively call the non batch write
    for (const auto& kv : key_values) { write(kv.first, kv.second); }
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Iterable>
-void session<Parent>::erase(const Iterable& keys) {
+void session<Parent, Cache>::erase(const Iterable& keys) {
    // Currently the batch erase will just iteratively call the non batch erase
    for (const auto& key : keys) { erase(key); }
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Other_data_store, typename Iterable>
-void session<Parent>::write_to(Other_data_store& ds, const Iterable& keys) {
+void session<Parent, Cache>::write_to(Other_data_store& ds, const Iterable& keys) {
    auto results = std::vector<std::pair<shared_bytes, shared_bytes>>{};
    for (const auto& key : keys) {
       auto value = read(key);
@@ -647,15 +711,66 @@ void session<Parent>::write_to(Other_data_store& ds, const Iterable& keys) {
    ds.write(results);
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Other_data_store, typename Iterable>
-void session<Parent>::read_from(Other_data_store& ds, const Iterable& keys) {
+void session<Parent, Cache>::read_from(Other_data_store& ds, const Iterable& keys) {
    ds.write_to(*this, keys);
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
+template <typename Iterable>
+void session<Parent, Cache>::prefetch(const Iterable& keys) {
+   auto missing = std::vector<shared_bytes>{};
+   for (const auto& key : keys) {
+      if (m_cache.find(key) != std::end(m_cache)) {
+         continue;
+      }
+      const auto hash    = std::hash<shared_bytes>{}(key);
+      auto       held    = false;
+      auto*      current = this;
+      while (auto* parent_session = std::get_if<session*>(&current->m_parent)) {
+         if (*parent_session == nullptr || (*parent_session)->m_key_filter.may_contain(hash)) {
+            held = true;
+            break;
+         }
+         current = *parent_session;
+      }
+      if (!held) {
+         missing.emplace_back(key);
+      }
+   }
+   if (missing.empty()) {
+      return;
+   }
+   std::sort(std::begin(missing), std::end(missing));
+
+   auto* root = this;
+   while (auto* parent_session = std::get_if<session*>(&root->m_parent)) {
+      if (*parent_session == nullptr) {
+         return;
+      }
+      root = *parent_session;
+   }
+
+   std::visit(
+         [&](auto* p) {
+            if (!p) {
+               return;
+            }
+            auto [found, not_found] = p->read(missing);
+            for (auto& kv : found) {
+               auto result = emplace_in_cache_(kv.first);
+               if (result.second) {
+                  result.first->second.value = std::move(kv.second);
+               }
+            }
+         },
+         root->m_parent);
+}
+
+template <typename Parent, typename Cache>
 template <typename It>
-It& session<Parent>::first_not_deleted_in_iterator_cache_(It& it, const It& end, bool& previous_in_cache) const {
+It& session<Parent, Cache>::first_not_deleted_in_iterator_cache_(It& it, const It& end, bool& previous_in_cache) const {
    auto previous_known       = true;
    auto update_previous_flag = [&](auto& it) {
       if (previous_known) {
@@ -672,9 +787,9 @@ It& session<Parent>::first_not_deleted_in_iterator_cache_(It& it, const It& end,
    return it;
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename It>
-It& session<Parent>::first_not_deleted_in_iterator_cache_(It& it, const It& end) const {
+It& session<Parent, Cache>::first_not_deleted_in_iterator_cache_(It& it, const It& end) const {
    while (it != end) {
       auto find_it = m_cache.find(it.key());
       if (find_it == std::end(m_cache) || !find_it->second.deleted) {
@@ -686,8 +801,8 @@ It& session<Parent>::first_not_deleted_in_iterator_cache_(It& it, const It& end)
    return it;
 }
 
-template <typename Parent>
-typename session<Parent>::iterator session<Parent>::find(const shared_bytes& key) {
+template <typename Parent, typename Cache>
+typename session<Parent, Cache>::iterator session<Parent, Cache>::find(const shared_bytes& key) {
    auto version = uint64_t{ 0 };
    auto end     = std::end(m_cache);
    auto it      = m_cache.find(key);
@@ -697,7 +812,7 @@ typename session<Parent>::iterator session<Parent>::find(const shared_bytes& key
             [&](auto* p) {
                auto pit = p->find(key);
                if (pit != std::end(*p)) {
-                  auto result = m_cache.emplace(key, value_state{});
+                  auto result = emplace_in_cache_(key);
                   it          = result.first;
                   if (result.second) {
                      it->second.value = *(*pit).second;
@@ -716,8 +831,8 @@ typename session<Parent>::iterator session<Parent>::find(const shared_bytes& key
    return { const_cast<session*>(this), std::move(it), version };
 }
 
-template <typename Parent>
-typename session<Parent>::iterator session<Parent>::begin() {
+template <typename Parent, typename Cache>
+typename session<Parent, Cache>::iterator session<Parent, Cache>::begin() {
    auto end     = std::end(m_cache);
    auto begin   = std::begin(m_cache);
    auto it      = begin;
@@ -741,7 +856,7 @@ typename session<Parent>::iterator session<Parent>::begin() {
                auto pend = std::end(*p);
                first_not_deleted_in_iterator_cache_(pit, pend);
                if (pit != pend && pit.key() < pending_key) {
-                  auto result = m_cache.emplace(pit.key(), value_state{});
+                  auto result = emplace_in_cache_(pit.key());
                   it          = result.first;
                   if (result.second) {
                      it->second.value = *(*pit).second;
@@ -757,13 +872,13 @@ typename session<Parent>::iterator session<Parent>::begin() {
    return { const_cast<session*>(this), std::move(it), version };
 }
 
-template <typename Parent>
-typename session<Parent>::iterator session<Parent>::end() {
+template <typename Parent, typename Cache>
+typename session<Parent, Cache>::iterator session<Parent, Cache>::end() {
    return { const_cast<session*>(this), std::end(m_cache), 0 };
 }
 
-template <typename Parent>
-typename session<Parent>::iterator session<Parent>::lower_bound(const shared_bytes& key) {
+template <typename Parent, typename Cache>
+typename session<Parent, Cache>::iterator session<Parent, Cache>::lower_bound(const shared_bytes& key) {
    auto version = uint64_t{ 0 };
    auto end     = std::end(m_cache);
    auto it      = m_cache.lower_bound(key);
@@ -787,7 +902,7 @@ typename session<Parent>::iterator session<Parent>::lower_bound(const shared_byt
                first_not_deleted_in_iterator_cache_(pit, pend);
                if (pit != pend) {
                   if (!pending_key || pit.key() < pending_key) {
-                     auto result = m_cache.emplace(pit.key(), value_state{});
+                     auto result = emplace_in_cache_(pit.key());
                      it          = result.first;
                      if (result.second) {
                         it->second.value = *(*pit).second;
@@ -806,17 +921,17 @@ typename session<Parent>::iterator session<Parent>::lower_bound(const shared_byt
    return { const_cast<session*>(this), std::move(it), version };
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Iterator_traits>
-session<Parent>::session_iterator<Iterator_traits>::session_iterator(session* active_session,
+session<Parent, Cache>::session_iterator<Iterator_traits>::session_iterator(session* active_session,
                                                                      typename Iterator_traits::cache_iterator it,
                                                                      uint64_t                                 version)
     : m_iterator_version{ version }, m_active_iterator{ std::move(it) }, m_active_session{ active_session } {}
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Iterator_traits>
 template <typename Test_predicate, typename Move_predicate, typename Cache_update>
-void session<Parent>::session_iterator<Iterator_traits>::move_(const Test_predicate& test, const Move_predicate& move,
+void session<Parent, Cache>::session_iterator<Iterator_traits>::move_(const Test_predicate& test, const Move_predicate& move,
                                                                Cache_update& update_cache) {
    do {
       if (m_active_iterator != std::end(m_active_session->m_cache) && !test(m_active_iterator)) {
@@ -836,9 +951,9 @@ void session<Parent>::session_iterator<Iterator_traits>::move_(const Test_predic
    } while (true);
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Iterator_traits>
-void session<Parent>::session_iterator<Iterator_traits>::move_next_() {
+void session<Parent, Cache>::session_iterator<Iterator_traits>::move_next_() {
    auto move         = [](auto& it) { ++it; };
    auto test         = [](auto& it) { return it->second.next_in_cache; };
    auto update_cache = [&](auto& it) mutable {
@@ -874,7 +989,7 @@ void session<Parent>::session_iterator<Iterator_traits>::move_next_() {
       }
 
       if (key) {
-         auto nit                            = m_active_session->m_cache.emplace(key, value_state{});
+         auto nit                            = m_active_session->emplace_in_cache_(key);
          nit.first->second.previous_in_cache = true;
          it->second.next_in_cache            = true;
          if (nit.second) {
@@ -892,9 +1007,9 @@ void session<Parent>::session_iterator<Iterator_traits>::move_next_() {
    }
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Iterator_traits>
-void session<Parent>::session_iterator<Iterator_traits>::move_previous_() {
+void session<Parent, Cache>::session_iterator<Iterator_traits>::move_previous_() {
    auto move = [](auto& it) { --it; };
    auto test = [&](auto& it) {
       if (it != std::end(m_active_session->m_cache)) {
@@ -935,7 +1050,7 @@ void session<Parent>::session_iterator<Iterator_traits>::move_previous_() {
       }
 
       if (key) {
-         auto nit                        = m_active_session->m_cache.emplace(key, value_state{});
+         auto nit                        = m_active_session->emplace_in_cache_(key);
          nit.first->second.next_in_cache = true;
          it->second.previous_in_cache    = true;
          if (nit.second) {
@@ -953,25 +1068,25 @@ void session<Parent>::session_iterator<Iterator_traits>::move_previous_() {
    }
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Iterator_traits>
-typename session<Parent>::template session_iterator<Iterator_traits>&
-session<Parent>::session_iterator<Iterator_traits>::operator++() {
+typename session<Parent, Cache>::template session_iterator<Iterator_traits>&
+session<Parent, Cache>::session_iterator<Iterator_traits>::operator++() {
    move_next_();
    return *this;
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Iterator_traits>
-typename session<Parent>::template session_iterator<Iterator_traits>&
-session<Parent>::session_iterator<Iterator_traits>::operator--() {
+typename session<Parent, Cache>::template session_iterator<Iterator_traits>&
+session<Parent, Cache>::session_iterator<Iterator_traits>::operator--() {
    move_previous_();
    return *this;
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Iterator_traits>
-bool session<Parent>::session_iterator<Iterator_traits>::deleted() const {
+bool session<Parent, Cache>::session_iterator<Iterator_traits>::deleted() const {
    if (m_active_iterator == std::end(m_active_session->m_cache)) {
       return false;
    }
@@ -979,9 +1094,9 @@ bool session<Parent>::session_iterator<Iterator_traits>::deleted() const {
    return m_active_iterator->second.deleted || m_iterator_version != m_active_iterator->second.version;
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Iterator_traits>
-const shared_bytes& session<Parent>::session_iterator<Iterator_traits>::key() const {
+const shared_bytes& session<Parent, Cache>::session_iterator<Iterator_traits>::key() const {
    if (m_active_iterator == std::end(m_active_session->m_cache)) {
       static auto empty = shared_bytes{};
       return empty;
@@ -989,29 +1104,29 @@ const shared_bytes& session<Parent>::session_iterator<Iterator_traits>::key() co
    return m_active_iterator->first;
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Iterator_traits>
-typename session<Parent>::template session_iterator<Iterator_traits>::value_type
-session<Parent>::session_iterator<Iterator_traits>::operator*() const {
+typename session<Parent, Cache>::template session_iterator<Iterator_traits>::value_type
+session<Parent, Cache>::session_iterator<Iterator_traits>::operator*() const {
    if (m_active_iterator == std::end(m_active_session->m_cache)) {
       return std::pair{ shared_bytes{}, std::optional<shared_bytes>{} };
    }
    return std::pair{ m_active_iterator->first, m_active_iterator->second.value };
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Iterator_traits>
-typename session<Parent>::template session_iterator<Iterator_traits>::value_type
-session<Parent>::session_iterator<Iterator_traits>::operator->() const {
+typename session<Parent, Cache>::template session_iterator<Iterator_traits>::value_type
+session<Parent, Cache>::session_iterator<Iterator_traits>::operator->() const {
    if (m_active_iterator == std::end(m_active_session->m_cache)) {
       return std::pair{ shared_bytes{}, std::optional<shared_bytes>{} };
    }
    return std::pair{ m_active_iterator->first, m_active_iterator->second.value };
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Iterator_traits>
-bool session<Parent>::session_iterator<Iterator_traits>::operator==(const session_iterator& other) const {
+bool session<Parent, Cache>::session_iterator<Iterator_traits>::operator==(const session_iterator& other) const {
    auto end = std::end(m_active_session->m_cache);
    if (m_active_iterator == end && m_active_iterator == other.m_active_iterator) {
       return true;
@@ -1022,9 +1137,9 @@ bool session<Parent>::session_iterator<Iterator_traits>::operator==(const sessio
    return this->m_active_iterator == other.m_active_iterator;
 }
 
-template <typename Parent>
+template <typename Parent, typename Cache>
 template <typename Iterator_traits>
-bool session<Parent>::session_iterator<Iterator_traits>::operator!=(const session_iterator& other) const {
+bool session<Parent, Cache>::session_iterator<Iterator_traits>::operator!=(const session_iterator& other) const {
    return !(*this == other);
 }
 
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include <b1/session/shared_bytes.hpp>
+
+namespace eosio::session {
+
+/// \brief An ordered map with a hash index on its keys for point lookups.
+/// \remarks Ordered operations (lower_bound, iteration) are served by the std::map and point lookups (find, emplace
+/// of a key already present) by the hash index, so repeatedly touching the same keys does not walk the tree and
+/// compare keys at every level.  Iterators are std::map iterators and keep their stability guarantees, which the
+/// session iterators rely on since they hold cache iterators while keys are added to the cache.  Entries are never
+/// erased individually, only through clear.
+template <typename Key, typename Value>
+class indexed_map {
+ public:
+   using map_type       = std::map<Key, Value>;
+   using key_type       = typename map_type::key_type;
+   using mapped_type    = typename map_type::mapped_type;
+   using value_type     = typename map_type::value_type;
+   using iterator       = typename map_type::iterator;
+   using const_iterator = typename map_type::const_iterator;
+
+   indexed_map()                   = default;
+   indexed_map(const indexed_map&) = delete;
+   // Moving a std::map or std::unordered_map transfers their nodes, so indexed iterators remain valid.
+   indexed_map(indexed_map&&) = default;
+
+   indexed_map& operator=(const indexed_map&) = delete;
+   indexed_map& operator=(indexed_map&&) = default;
+
+   template <typename K, typename V>
+   std::pair<iterator, bool> emplace(K&& key, V&& value) {
+      auto index_it = m_index.find(key);
+      if (index_it != std::end(m_index)) {
+         return { index_it->second, false };
+      }
+      auto result = m_map.emplace(std::forward<K>(key), std::forward<V>(value));
+      m_index.emplace(result.first->first, result.first);
+      return result;
+   }
+
+   iterator find(const Key& key) {
+      auto index_it = m_index.find(key);
+      return index_it == std::end(m_index) ? std::end(m_map) : index_it->second;
+   }
+
+   const_iterator find(const Key& key) const {
+      auto index_it = m_index.find(key);
+      return index_it == std::end(m_index) ? std::end(m_map) : const_iterator{ index_it->second };
+   }
+
+   iterator       lower_bound(const Key& key) { return m_map.lower_bound(key); }
+   const_iterator lower_bound(const Key& key) const { return m_map.lower_bound(key); }
+
+   iterator       begin() { return std::begin(m_map); }
+   const_iterator begin() const { return std::begin(m_map); }
+   iterator       end() { return std::end(m_map); }
+   const_iterator end() const { return std::end(m_map); }
+
+   bool   empty() const { return m_map.empty(); }
+   size_t size() const { return m_map.size(); }
+
+   void clear() {
+      m_index.clear();
+      m_map.clear();
+   }
+
+ private:
+   map_type                          m_map;
+   std::unordered_map<Key, iterator> m_index;
+};
+
+/// \brief Session cache policy that keeps the cache in a std::map.
+struct ordered_cache {
+   template <typename Value>
+   using type = std::map<shared_bytes, Value>;
+};
+
+/// \brief Session cache policy that keeps the cache in a std::map with a hash index for point lookups.
+struct indexed_cache {
+   template <typename Value>
+   using type = indexed_map<shared_bytes, Value>;
+};
+
+} // namespace eosio::session
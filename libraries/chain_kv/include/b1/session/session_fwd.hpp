@@ -0,0 +1,17 @@
+#pragma once
+
+namespace eosio::session {
+
+struct rocksdb_t;
+struct ordered_cache;
+struct indexed_cache;
+
+/// \brief Forward declaration of session.  Refer to session.hpp for documentation.
+/// \tparam Cache The cache policy used for the session's key cache, see session_cache.hpp.
+template <typename Parent, typename Cache = indexed_cache>
+class session;
+
+template <typename... T>
+class session_variant;
+
+} // namespace eosio::session
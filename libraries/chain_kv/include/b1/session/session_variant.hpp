@@ -109,6 +109,11 @@ class session_variant {
    template <typename Other_data_store, typename Iterable>
    void read_from(Other_data_store& ds, const Iterable& keys);
 
+   /// \brief Reads a batch of keys ahead of reading them individually.
+   /// \param keys A type that supports iteration and returns in its iterator a shared_bytes type representing the key.
+   template <typename Iterable>
+   void prefetch(const Iterable& keys);
+
    /// \brief Returns an iterator to the key, or the end iterator if the key is not in the cache or session heirarchy.
    /// \param key The key to search for.
    /// \return An iterator to the key if found, the end iterator otherwise.
@@ -189,6 +194,12 @@ session_variant<T...>::read(const Iterable& keys) {
    return std::visit([&](auto* session) { return session->read(keys); }, m_holder);
 }
 
+template <typename... T>
+template <typename Iterable>
+void session_variant<T...>::prefetch(const Iterable& keys) {
+   std::visit([&](auto* session) { return session->prefetch(keys); }, m_holder);
+}
+
 template <typename... T>
 template <typename Iterable>
 void session_variant<T...>::write(const Iterable& key_values) {
@@ -24,10 +24,14 @@ template <typename StringView, std::size_t N>
 shared_bytes make_shared_bytes(std::array<StringView, N>&& data);
 
 /// \brief A structure that represents a pointer and its length.
+/// \remarks Buffers that fit in inline_capacity bytes once aligned are stored in the instance itself, so copying
+/// short keys and values neither allocates nor touches a reference count.  Longer buffers are shared between copies.
 class shared_bytes {
  public:
    using underlying_type_t = char;
 
+   static constexpr size_t inline_capacity = 3 * sizeof(uint64_t);
+
    template <typename T>
    friend struct std::hash;
 
@@ -110,11 +114,11 @@ class shared_bytes {
    shared_bytes(size_t size);
 
    shared_bytes(const shared_bytes& b) = default;
-   shared_bytes(shared_bytes&& b)      = default;
+   shared_bytes(shared_bytes&& b);
    ~shared_bytes()                     = default;
 
    shared_bytes& operator=(const shared_bytes& b) = default;
-   shared_bytes& operator=(shared_bytes&& b) = default;
+   shared_bytes& operator=(shared_bytes&& b);
 
    bool operator==(const shared_bytes& other) const;
    bool operator!=(const shared_bytes& other) const;
@@ -154,10 +158,14 @@ class shared_bytes {
    static shared_bytes from_hex_string(const std::string& str);
    static shared_bytes truncate_key(const shared_bytes &key);
 
+ private:
+   /// \brief Sets the size of this instance and returns its buffer, zero padded to the aligned size.
+   char* allocate_(size_t size);
+
  private:
    size_t                             m_size{ 0 };
-   size_t                             m_offset{ 0 };
    std::shared_ptr<underlying_type_t> m_data;
+   alignas(uint64_t) char             m_inline[inline_capacity]{};
 };
 
 namespace details {
@@ -217,13 +225,7 @@ shared_bytes make_shared_bytes(std::array<StringView, N>&& data) {
       return result;
    }
 
-   result.m_size   = length;
-   result.m_offset = details::aligned_size(length) - length;
-   result.m_data   = std::shared_ptr<shared_bytes::underlying_type_t>{
-      new shared_bytes::underlying_type_t[result.m_size + result.m_offset],
-      std::default_delete<shared_bytes::underlying_type_t[]>()
-   };
-   char* chunk_ptr = result.m_data.get();
+   char* chunk_ptr = result.allocate_(length);
    for (const auto& view : data) {
       const char* const view_ptr = view.data();
       if (!view_ptr || !view.size()) {
@@ -232,42 +234,54 @@ shared_bytes make_shared_bytes(std::array<StringView, N>&& data) {
       std::memcpy(chunk_ptr, view_ptr, view.size());
       chunk_ptr += view.size();
    }
-   std::memset(chunk_ptr, 0, result.m_offset);
 
    return result;
 }
 
 template <typename T>
-shared_bytes::shared_bytes(const T* data, size_t size)
-    : m_size{ size * sizeof(T) }, m_offset{ eosio::session::details::aligned_size(m_size) - m_size }, m_data{ [&]() {
-         if (!data || size == 0) {
-            return std::shared_ptr<char>{};
-         }
+shared_bytes::shared_bytes(const T* data, size_t size) {
+   if (!data || size == 0) {
+      return;
+   }
+   auto* buffer = allocate_(size * sizeof(T));
+   std::memcpy(buffer, reinterpret_cast<const void*>(data), m_size);
+}
 
-         // Make sure to instantiate a buffer that is aligned to the size of a uint64_t.
-         auto  actual_size = m_size + m_offset;
-         auto  result      = std::shared_ptr<underlying_type_t>{ new underlying_type_t[actual_size],
-                                                           std::default_delete<underlying_type_t[]>() };
-         auto* buffer      = result.get();
-         std::memcpy(buffer, reinterpret_cast<const void*>(data), m_size);
-         // Pad with zeros at the end.
-         std::memset(buffer + m_size, 0, m_offset);
-         return result;
-      }() } {}
-
-inline shared_bytes::shared_bytes(size_t size)
-    : m_size{ size }, m_offset{ eosio::session::details::aligned_size(m_size) - m_size }, m_data{ [&]() {
-         if (size == 0) {
-            return std::shared_ptr<char>{};
-         }
+inline shared_bytes::shared_bytes(size_t size) { allocate_(size); }
 
-         // Make sure to instantiate a buffer that is aligned to the size of a uint64_t.
-         auto actual_size = m_size + m_offset;
-         auto result      = std::shared_ptr<underlying_type_t>{ new underlying_type_t[actual_size],
-                                                           std::default_delete<underlying_type_t[]>() };
-         std::memset(result.get(), 0, actual_size);
-         return result;
-      }() } {}
+inline shared_bytes::shared_bytes(shared_bytes&& b) : m_size{ b.m_size }, m_data{ std::move(b.m_data) } {
+   std::memcpy(m_inline, b.m_inline, inline_capacity);
+   b.m_size = 0;
+}
+
+inline shared_bytes& shared_bytes::operator=(shared_bytes&& b) {
+   if (this != &b) {
+      m_size = b.m_size;
+      m_data = std::move(b.m_data);
+      std::memcpy(m_inline, b.m_inline, inline_capacity);
+      b.m_size = 0;
+   }
+   return *this;
+}
+
+inline char* shared_bytes::allocate_(size_t size) {
+   m_size = size;
+   if (size == 0) {
+      return nullptr;
+   }
+
+   // Make sure to instantiate a buffer that is aligned to the size of a uint64_t.
+   auto  actual_size = eosio::session::details::aligned_size(size);
+   char* buffer      = m_inline;
+   if (actual_size > inline_capacity) {
+      m_data = std::shared_ptr<underlying_type_t>{ new underlying_type_t[actual_size],
+                                                   std::default_delete<underlying_type_t[]>() };
+      buffer = m_data.get();
+   }
+   // Pad with zeros at the end.
+   std::memset(buffer + size, 0, actual_size - size);
+   return buffer;
+}
 
 inline shared_bytes shared_bytes::next() const {
    auto buffer = std::vector<unsigned char>{ std::begin(*this), std::end(*this) };
@@ -285,73 +299,79 @@ inline shared_bytes shared_bytes::next() const {
 
 inline size_t            shared_bytes::size() const { return m_size; }
 inline size_t            shared_bytes::aligned_size() const { return eosio::session::details::aligned_size(m_size); }
-inline char*             shared_bytes::data() { return m_data.get(); }
-inline const char* const shared_bytes::data() const { return m_data.get(); }
+inline char* shared_bytes::data() {
+   if (m_data) {
+      return m_data.get();
+   }
+   return m_size == 0 ? nullptr : m_inline;
+}
+
+inline const char* const shared_bytes::data() const { return const_cast<shared_bytes*>(this)->data(); }
 
 inline bool shared_bytes::empty() const { return m_size == 0; }
 
 inline bool shared_bytes::operator==(const shared_bytes& other) const {
-   if (m_data.get() == other.m_data.get()) {
+   if (data() == other.data()) {
       return true;
    }
    if (size() != other.size()) {
       return false;
    }
-   return details::aligned_compare(m_data.get(), m_size, other.m_data.get(), other.m_size) == 0;
+   return details::aligned_compare(data(), m_size, other.data(), other.m_size) == 0;
 }
 
 inline bool shared_bytes::operator!=(const shared_bytes& other) const {
-   if (m_data.get() == other.m_data.get()) {
+   if (data() == other.data()) {
       return false;
    }
    if (size() != other.size()) {
       return true;
    }
-   return details::aligned_compare(m_data.get(), m_size, other.m_data.get(), other.m_size) != 0;
+   return details::aligned_compare(data(), m_size, other.data(), other.m_size) != 0;
 }
 
 inline bool shared_bytes::operator<(const shared_bytes& other) const {
-   if (m_data.get() == other.m_data.get()) {
+   if (data() == other.data()) {
       return false;
    }
-   return details::aligned_compare(m_data.get(), m_size, other.m_data.get(), other.m_size) < 0;
+   return details::aligned_compare(data(), m_size, other.data(), other.m_size) < 0;
 }
 
 inline bool shared_bytes::operator<=(const shared_bytes& other) const {
-   if (m_data.get() == other.m_data.get()) {
+   if (data() == other.data()) {
       return true;
    }
-   return details::aligned_compare(m_data.get(), m_size, other.m_data.get(), other.m_size) <= 0;
+   return details::aligned_compare(data(), m_size, other.data(), other.m_size) <= 0;
 }
 
 inline bool shared_bytes::operator>(const shared_bytes& other) const {
-   if (m_data.get() == other.m_data.get()) {
+   if (data() == other.data()) {
       return false;
    }
-   return details::aligned_compare(m_data.get(), m_size, other.m_data.get(), other.m_size) > 0;
+   return details::aligned_compare(data(), m_size, other.data(), other.m_size) > 0;
 }
 
 inline bool shared_bytes::operator>=(const shared_bytes& other) const {
-   if (m_data.get() == other.m_data.get()) {
+   if (data() == other.data()) {
       return true;
    }
-   return details::aligned_compare(m_data.get(), m_size, other.m_data.get(), other.m_size) >= 0;
+   return details::aligned_compare(data(), m_size, other.data(), other.m_size) >= 0;
 }
 
 inline bool shared_bytes::operator!() const { return *this == shared_bytes{}; }
 
 inline shared_bytes::operator bool() const { return *this != shared_bytes{}; }
 
-inline shared_bytes::underlying_type_t& shared_bytes::operator[](size_t index) { return m_data.get()[index]; }
+inline shared_bytes::underlying_type_t& shared_bytes::operator[](size_t index) { return data()[index]; }
 
-inline shared_bytes::underlying_type_t shared_bytes::operator[](size_t index) const { return m_data.get()[index]; }
+inline shared_bytes::underlying_type_t shared_bytes::operator[](size_t index) const { return data()[index]; }
 
 inline shared_bytes::iterator shared_bytes::begin() const {
-   return iterator{ m_data.get(), 0, static_cast<int64_t>(m_size) - 1, m_size == 0 ? -1 : 0 };
+   return iterator{ const_cast<char*>(data()), 0, static_cast<int64_t>(m_size) - 1, m_size == 0 ? -1 : 0 };
 }
 
 inline shared_bytes::iterator shared_bytes::end() const {
-   return iterator{ m_data.get(), 0, static_cast<int64_t>(m_size) - 1, -1 };
+   return iterator{ const_cast<char*>(data()), 0, static_cast<int64_t>(m_size) - 1, -1 };
 }
 
 inline shared_bytes shared_bytes::truncate_key(const shared_bytes &key) {
@@ -551,7 +571,7 @@ struct hash<eosio::session::shared_bytes> {
       if (b.size() == 0) {
          return 0;
       }
-      return std::hash<std::string_view>{}({ b.m_data.get() + b.m_offset, b.m_size });
+      return std::hash<std::string_view>{}({ b.data(), b.m_size });
    }
 };
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <future>
 #include <queue>
 
 #include <fc/filesystem.hpp>
@@ -10,6 +11,7 @@
 #include <b1/session/session.hpp>
 #include <b1/session/session_variant.hpp>
 #include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/thread_utils.hpp>
 
 namespace eosio::session {
    constexpr uint32_t undo_stack_magic_number = 0x30510ABC;
@@ -50,6 +52,15 @@ class undo_stack {
    /// \remarks Each time a session is push onto the stack, a revision is assigned to it.
    void commit(int64_t revision);
 
+   /// \brief Writes committed sessions into the head on a background thread.
+   /// \param max_pending_writes Commit blocks once more sessions than this are being written, 0 writes synchronously.
+   /// \remarks A committed session stays below the sessions of the stack, read only, until its changes are written,
+   /// so reads keep seeing them.  The sessions are written one at a time in the order they were committed.
+   void write_commits_in_background(size_t max_pending_writes);
+
+   /// \brief Waits for all the committed sessions to be written into the head.
+   void wait_for_pending_writes();
+
    bool   empty() const;
    size_t size() const;
 
@@ -78,12 +89,25 @@ class undo_stack {
    void open();
    void close();
 
+ private:
+   /// \brief Removes the sessions at the bottom whose changes have been written into the head.
+   /// \param wait Wait for the writes in progress instead of only removing the completed ones.
+   void remove_written_(bool wait);
+
+   /// \brief Index in m_sessions of the session at the bottom of the stack.
+   size_t bottom_index_() const { return m_pending_writes.size(); }
+
  private:
    int64_t                  m_revision{ 0 };
    Session*                 m_head;
    std::deque<session_type> m_sessions; // Need a deque so pointers don't become invalidated.  The session holds a
-                                        // pointer to the parent internally.
+                                        // pointer to the parent internally.  The first m_pending_writes.size()
+                                        // sessions are committed and being written into the head.
    fc::path                 m_datadir;
+
+   std::unique_ptr<eosio::chain::named_thread_pool> m_writer;
+   std::deque<std::future<void>>                    m_pending_writes;
+   size_t                                           m_max_pending_writes{ 0 };
 };
 
 template <typename Session>
@@ -108,9 +132,13 @@ void undo_stack<Session>::push() {
 
 template <typename Session>
 void undo_stack<Session>::squash() {
-   if (m_sessions.empty()) {
+   if (empty()) {
       return;
    }
+   if (size() == 1) {
+      // The changes must reach the head, not a committed session that is already being written.
+      remove_written_(true);
+   }
    m_sessions.back().commit();
    m_sessions.back().detach();
    m_sessions.pop_back();
@@ -119,7 +147,7 @@ void undo_stack<Session>::squash() {
 
 template <typename Session>
 void undo_stack<Session>::undo() {
-   if (m_sessions.empty()) {
+   if (empty()) {
       return;
    }
    m_sessions.back().detach();
@@ -129,33 +157,88 @@ void undo_stack<Session>::undo() {
 
 template <typename Session>
 void undo_stack<Session>::commit(int64_t revision) {
-   if (m_sessions.empty()) {
+   remove_written_(false);
+   if (empty()) {
       return;
    }
 
    revision              = std::min(revision, m_revision);
-   auto initial_revision = static_cast<int64_t>(m_revision - m_sessions.size() + 1);
+   auto initial_revision = static_cast<int64_t>(m_revision - size() + 1);
    if (initial_revision > revision) {
       return;
    }
 
    const auto start_index = revision - initial_revision;
 
-   for (int64_t i = start_index; i >= 0; --i) { m_sessions[i].commit(); }
-   m_sessions.erase(std::begin(m_sessions), std::begin(m_sessions) + start_index + 1);
-   if (!m_sessions.empty()) {
-      m_sessions.front().attach(*m_head);
+   if (!m_writer) {
+      for (int64_t i = start_index; i >= 0; --i) { m_sessions[i].commit(); }
+      m_sessions.erase(std::begin(m_sessions), std::begin(m_sessions) + start_index + 1);
+      if (!m_sessions.empty()) {
+         m_sessions.front().attach(*m_head);
+      }
+      return;
+   }
+
+   for (int64_t i = 0; i <= start_index; ++i) {
+      auto changes = m_sessions[bottom_index_()].changes();
+      m_pending_writes.emplace_back(eosio::chain::async_thread_pool(
+            m_writer->get_executor(), [head = m_head, changes = std::move(changes)]() {
+               if (changes.second.size() > 0) {
+                  head->erase(changes.second);
+               }
+               if (changes.first.size() > 0) {
+                  head->write(changes.first);
+               }
+            }));
+   }
+
+   // Writes into the head through top() must not land in a session that is being written.
+   if (empty() || m_pending_writes.size() > m_max_pending_writes) {
+      remove_written_(true);
+   }
+}
+
+template <typename Session>
+void undo_stack<Session>::write_commits_in_background(size_t max_pending_writes) {
+   wait_for_pending_writes();
+   m_max_pending_writes = max_pending_writes;
+   if (max_pending_writes == 0) {
+      m_writer.reset();
+   } else if (!m_writer) {
+      m_writer = std::make_unique<eosio::chain::named_thread_pool>("kvcmt", 1);
+   }
+}
+
+template <typename Session>
+void undo_stack<Session>::wait_for_pending_writes() {
+   remove_written_(true);
+}
+
+template <typename Session>
+void undo_stack<Session>::remove_written_(bool wait) {
+   while (!m_pending_writes.empty()) {
+      auto& pending = m_pending_writes.front();
+      if (!wait && pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+         break;
+      }
+      pending.get(); // rethrows a failed write
+      m_pending_writes.pop_front();
+      m_sessions.front().detach();
+      m_sessions.pop_front();
+      if (!m_sessions.empty()) {
+         m_sessions.front().attach(*m_head);
+      }
    }
 }
 
 template <typename Session>
 bool undo_stack<Session>::empty() const {
-   return m_sessions.empty();
+   return size() == 0;
 }
 
 template <typename Session>
 size_t undo_stack<Session>::size() const {
-   return m_sessions.size();
+   return m_sessions.size() - m_pending_writes.size();
 }
 
 template <typename Session>
@@ -196,8 +279,8 @@ typename undo_stack<Session>::const_variant_type undo_stack<Session>::top() cons
 
 template <typename Session>
 typename undo_stack<Session>::variant_type undo_stack<Session>::bottom() {
-   if (!m_sessions.empty()) {
-      auto& front = m_sessions.front();
+   if (!empty()) {
+      auto& front = m_sessions[bottom_index_()];
       return { front, nullptr };
    }
    return { *m_head, nullptr };
@@ -205,8 +288,8 @@ typename undo_stack<Session>::variant_type undo_stack<Session>::bottom() {
 
 template <typename Session>
 typename undo_stack<Session>::const_variant_type undo_stack<Session>::bottom() const {
-   if (!m_sessions.empty()) {
-      auto& front = m_sessions.front();
+   if (!empty()) {
+      auto& front = m_sessions[bottom_index_()];
       return { front, nullptr };
    }
    return { *m_head, nullptr };
@@ -280,6 +363,7 @@ void undo_stack<Session>::open() {
 
 template <typename Session>
 void undo_stack<Session>::close() {
+   wait_for_pending_writes();
    if (m_datadir.empty())
       return;
 
@@ -168,8 +168,8 @@ void verify_equal(T& ds, const std::unordered_map<Key, Value>& container, string
    }
 }
 
-template <typename Data_store, typename Key, typename Value>
-void verify_equal(eosio::session::session<Data_store>& ds, const std::unordered_map<Key, Value>& container, string_t) {
+template <typename Data_store, typename Cache, typename Key, typename Value>
+void verify_equal(eosio::session::session<Data_store, Cache>& ds, const std::unordered_map<Key, Value>& container, string_t) {
    auto verify_key_value = [&](auto kv) {
       auto key = std::string{ std::begin(kv.first), std::end(kv.first) };
       auto it  = container.find(key);
@@ -256,8 +256,8 @@ void verify_equal(T& ds, const std::unordered_map<Key, Value>& container, int_t)
    }
 }
 
-template <typename Data_store, typename Key, typename Value>
-void verify_equal(eosio::session::session<Data_store>& ds, const std::unordered_map<Key, Value>& container, int_t) {
+template <typename Data_store, typename Cache, typename Key, typename Value>
+void verify_equal(eosio::session::session<Data_store, Cache>& ds, const std::unordered_map<Key, Value>& container, int_t) {
    auto verify_key_value = [&](auto kv) {
       auto buffer =
             std::vector<eosio::session::shared_bytes::underlying_type_t>{ std::begin(kv.first), std::end(kv.first) };
@@ -466,9 +466,9 @@ void verify_read_from_datastore(T& ds, U& other_ds) {
    compare_ds(other_ds, ds);
 }
 
-template <typename Data_store>
-void verify_read_from_datastore(eosio::session::session<Data_store>& ds,
-                                eosio::session::session<Data_store>& other_ds) {
+template <typename Data_store, typename Cache>
+void verify_read_from_datastore(eosio::session::session<Data_store, Cache>& ds,
+                                eosio::session::session<Data_store, Cache>& other_ds) {
    auto compare_ds = [](auto& left, auto& right) {
       // The data stores are equal if all the key_values in left are in right
       // and all the key_values in right are in left.
@@ -534,8 +534,9 @@ void verify_write_to_datastore(T& ds, U& other_ds) {
    compare_ds(other_ds, ds);
 }
 
-template <typename Data_store>
-void verify_write_to_datastore(eosio::session::session<Data_store>& ds, eosio::session::session<Data_store>& other_ds) {
+template <typename Data_store, typename Cache>
+void verify_write_to_datastore(eosio::session::session<Data_store, Cache>& ds,
+                               eosio::session::session<Data_store, Cache>& other_ds) {
    auto compare_ds = [](auto& left, auto& right) {
       // The data stores are equal if all the key_values in left are in right
       // and all the key_values in right are in left.
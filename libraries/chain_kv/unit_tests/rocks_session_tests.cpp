@@ -110,4 +110,91 @@ BOOST_AUTO_TEST_CASE(rocks_session_iterator_key_order_test) {
    }
 }
 
+BOOST_AUTO_TEST_CASE(rocks_session_column_family_prefix_test) {
+   auto make_key = [](const std::string& key) { return shared_bytes(key.data(), key.size()); };
+
+   auto db = make_rocks_db("/tmp/rocks19");
+   auto make_column_family = [&](const std::string& name) {
+      rocksdb::ColumnFamilyHandle* handle = nullptr;
+      BOOST_REQUIRE(db->CreateColumnFamily(rocksdb::ColumnFamilyOptions{}, name, &handle).ok());
+      return std::shared_ptr<rocksdb::ColumnFamilyHandle>{ handle };
+   };
+   auto hot1 = make_column_family("hot1");
+   auto hot2 = make_column_family("hot2");
+
+   auto datastore = eosio::session::make_session(
+         db, 4, { { make_key("b"), hot1 }, { make_key("d"), hot2 }, { make_key("f"), hot1 } });
+   const auto keys = std::vector<std::string>{ "a1", "b1", "b2", "c1", "d1", "e1", "f1", "g1" };
+   for (const auto& key : keys) { datastore.write(make_key(key), make_key(key + "v")); }
+   datastore.write(std::vector<std::pair<shared_bytes, shared_bytes>>{ { make_key("b3"), make_key("b3v") } });
+
+   // keys land in the column family of their prefix
+   auto value = std::string{};
+   BOOST_REQUIRE(db->Get(rocksdb::ReadOptions{}, hot1.get(), "b1", &value).ok());
+   BOOST_REQUIRE(db->Get(rocksdb::ReadOptions{}, hot1.get(), "b3", &value).ok());
+   BOOST_REQUIRE(db->Get(rocksdb::ReadOptions{}, hot1.get(), "f1", &value).ok());
+   BOOST_REQUIRE(db->Get(rocksdb::ReadOptions{}, hot2.get(), "d1", &value).ok());
+   BOOST_REQUIRE(db->Get(rocksdb::ReadOptions{}, db->DefaultColumnFamily(), "c1", &value).ok());
+   BOOST_REQUIRE(db->Get(rocksdb::ReadOptions{}, db->DefaultColumnFamily(), "b1", &value).IsNotFound());
+
+   BOOST_REQUIRE(datastore.read(make_key("d1")) == make_key("d1v"));
+   BOOST_REQUIRE(datastore.contains(make_key("f1")));
+   auto [found, not_found] = datastore.read(std::vector<shared_bytes>{ make_key("a1"), make_key("b2"), make_key("x") });
+   BOOST_REQUIRE(found.size() == 2);
+   BOOST_REQUIRE(not_found.size() == 1);
+
+   // iteration walks all column families in key order, in both directions
+   auto expected = std::vector<std::string>{ "a1", "b1", "b2", "b3", "c1", "d1", "e1", "f1", "g1" };
+   auto actual   = std::vector<std::string>{};
+   for (auto kv : datastore) { actual.emplace_back(kv.first.data(), kv.first.size()); }
+   BOOST_REQUIRE(actual == expected);
+
+   actual.clear();
+   auto it = std::end(datastore);
+   do {
+      --it;
+      auto key = it.key();
+      actual.emplace_back(key.data(), key.size());
+   } while (it != std::begin(datastore));
+   BOOST_REQUIRE(std::equal(std::begin(actual), std::end(actual), std::rbegin(expected), std::rend(expected)));
+
+   // changing direction in the middle
+   it = datastore.lower_bound(make_key("c"));
+   BOOST_REQUIRE(it.key() == make_key("c1"));
+   --it;
+   BOOST_REQUIRE(it.key() == make_key("b3"));
+   ++it;
+   ++it;
+   BOOST_REQUIRE(it.key() == make_key("d1"));
+   BOOST_REQUIRE(datastore.find(make_key("f1")) != std::end(datastore));
+   BOOST_REQUIRE(datastore.find(make_key("f2")) == std::end(datastore));
+
+   datastore.erase(make_key("b2"));
+   BOOST_REQUIRE(!datastore.read(make_key("b2")));
+}
+
+BOOST_AUTO_TEST_CASE(rocks_session_iterator_reuse_test) {
+   auto make_key = [](const std::string& key) { return shared_bytes(key.data(), key.size()); };
+
+   // a single cached iterator is reused by every lookup below
+   auto datastore = eosio::session::make_session(make_rocks_db("/tmp/rocks20"), 1);
+   datastore.write(make_key("a"), make_key("1"));
+   datastore.write(make_key("c"), make_key("3"));
+
+   BOOST_REQUIRE(datastore.lower_bound(make_key("a")).key() == make_key("a"));
+   // reused iterator left positioned on a key is still a valid end iterator
+   BOOST_REQUIRE(!std::end(datastore).key());
+   BOOST_REQUIRE(datastore.find(make_key("b")) == std::end(datastore));
+
+   // writes made after the iterator was created are seen on reuse
+   datastore.write(make_key("b"), make_key("2"));
+   BOOST_REQUIRE(datastore.lower_bound(make_key("b")).key() == make_key("b"));
+   datastore.erase(make_key("c"));
+   BOOST_REQUIRE(datastore.lower_bound(make_key("c")) == std::end(datastore));
+
+   auto keys = std::vector<shared_bytes>{};
+   for (auto kv : datastore) { keys.push_back(kv.first); }
+   BOOST_REQUIRE(keys == (std::vector<shared_bytes>{ make_key("a"), make_key("b") }));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
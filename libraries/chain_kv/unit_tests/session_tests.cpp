@@ -7,12 +7,13 @@ using namespace eosio::session_tests;
 
 namespace eosio::session_tests {
 
+template <typename Cache = eosio::session::indexed_cache>
 void perform_session_level_test(const std::string& dbpath, bool always_undo = false) {
    auto kvs_list     = std::vector<std::unordered_map<uint16_t, uint16_t>>{};
    auto ordered_list = std::vector<std::map<uint16_t, uint16_t>>{};
 
    auto root_session  = eosio::session_tests::make_session(dbpath);
-   using session_type = eosio::session::session<decltype(root_session)>;
+   using session_type = eosio::session::session<decltype(root_session), Cache>;
    kvs_list.emplace_back(generate_kvs(50));
    ordered_list.emplace_back(std::begin(kvs_list.back()), std::end(kvs_list.back()));
    write(root_session, kvs_list.back());
@@ -187,6 +188,11 @@ BOOST_AUTO_TEST_CASE(session_level_test_undo_always) {
    eosio::session_tests::perform_session_level_test("/tmp/session23", true);
 }
 
+BOOST_AUTO_TEST_CASE(session_level_test_ordered_cache) {
+   eosio::session_tests::perform_session_level_test<eosio::session::ordered_cache>("/tmp/session24");
+   eosio::session_tests::perform_session_level_test<eosio::session::ordered_cache>("/tmp/session25", true);
+}
+
 BOOST_AUTO_TEST_CASE(session_level_test_attach_detach) {
    size_t key_count      = 10;
    auto   root_session   = eosio::session_tests::make_session("/tmp/session15");
@@ -326,6 +332,71 @@ BOOST_AUTO_TEST_CASE(session_overwrite_key_in_child) {
    verify_key_value(transaction_session, 10, 2006);
 }
 
+BOOST_AUTO_TEST_CASE(session_read_through_parents) {
+   auto make_key = [](uint16_t key) { return eosio::session::shared_bytes(&key, 1); };
+
+   auto root_session  = eosio::session_tests::make_session("/tmp/session26");
+   using session_type = eosio::session::session<decltype(root_session)>;
+   auto root_session_kvs =
+         std::unordered_map<uint16_t, uint16_t>{ { 0, 100 }, { 1, 101 }, { 2, 102 }, { 3, 103 }, { 4, 104 },
+                                                 { 5, 105 }, { 6, 106 }, { 7, 107 }, { 8, 108 }, { 9, 109 } };
+   write(root_session, root_session_kvs);
+
+   auto block_session = session_type(root_session);
+   block_session.write(make_key(11), make_key(111));
+   block_session.erase(make_key(6));
+
+   // the transaction session holds no keys other than the bounds primed from the block session
+   auto transaction_session = session_type(block_session, nullptr);
+   auto action_session      = session_type(transaction_session, nullptr);
+
+   BOOST_REQUIRE(action_session.read(make_key(5)) == make_key(105));
+   BOOST_REQUIRE(action_session.read(make_key(11)) == make_key(111));
+   BOOST_REQUIRE(!action_session.read(make_key(6)));
+   BOOST_REQUIRE(!action_session.contains(make_key(6)));
+   BOOST_REQUIRE(!action_session.read(make_key(12)));
+   BOOST_REQUIRE(!action_session.contains(make_key(13)));
+   BOOST_REQUIRE(action_session.contains(make_key(2)));
+
+   auto expected_kvs = root_session_kvs;
+   expected_kvs.erase(6);
+   expected_kvs.emplace(11, 111);
+   verify_equal(action_session, expected_kvs, int_t{});
+}
+
+BOOST_AUTO_TEST_CASE(session_prefetch) {
+   auto make_key = [](uint16_t key) { return eosio::session::shared_bytes(&key, 1); };
+
+   auto root_session  = eosio::session_tests::make_session("/tmp/session27");
+   using session_type = eosio::session::session<decltype(root_session)>;
+   auto root_session_kvs =
+         std::unordered_map<uint16_t, uint16_t>{ { 0, 100 }, { 1, 101 }, { 2, 102 }, { 3, 103 }, { 4, 104 },
+                                                 { 5, 105 }, { 6, 106 }, { 7, 107 }, { 8, 108 }, { 9, 109 } };
+   write(root_session, root_session_kvs);
+
+   auto block_session = session_type(root_session);
+   block_session.erase(make_key(3));
+   block_session.write(make_key(4), make_key(204));
+
+   auto transaction_session = session_type(block_session, nullptr);
+   auto keys = std::vector<eosio::session::shared_bytes>{ make_key(6), make_key(1), make_key(3), make_key(4),
+                                                          make_key(20), make_key(7) };
+   transaction_session.prefetch(keys);
+
+   BOOST_REQUIRE(transaction_session.read(make_key(1)) == make_key(101));
+   BOOST_REQUIRE(transaction_session.read(make_key(6)) == make_key(106));
+   BOOST_REQUIRE(!transaction_session.read(make_key(3)));
+   BOOST_REQUIRE(transaction_session.read(make_key(4)) == make_key(204));
+   BOOST_REQUIRE(!transaction_session.read(make_key(20)));
+
+   // iteration finds the neighbors of prefetched keys
+   auto expected_kvs = root_session_kvs;
+   expected_kvs.erase(3);
+   expected_kvs[4] = 204;
+   verify_equal(transaction_session, expected_kvs, int_t{});
+   verify_session_key_order(transaction_session);
+}
+
 BOOST_AUTO_TEST_CASE(session_delete_key_in_child) {
    auto verify_keys_deleted = [](auto& ds, const auto& keys) {
       for (const uint16_t& key : keys) {
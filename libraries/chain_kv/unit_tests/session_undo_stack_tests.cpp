@@ -93,4 +93,49 @@ BOOST_AUTO_TEST_CASE(undo_stack_test) {
                 int_t{});
 }
 
+BOOST_AUTO_TEST_CASE(undo_stack_background_commit_test) {
+   auto data_store = eosio::session::make_session(make_rocks_db("/tmp/undo_stack2"), 16);
+   auto undo       = eosio::session::undo_stack(data_store);
+   undo.write_commits_in_background(2);
+
+   auto top = [&]() -> decltype(undo)::session_type& {
+      return *std::get<decltype(undo)::session_type*>(undo.top().holder());
+   };
+   auto make_key = [](uint16_t key) { return eosio::session::shared_bytes(&key, 1); };
+
+   auto initial_kvs = std::unordered_map<uint16_t, uint16_t>{ { 1, 100 }, { 2, 200 } };
+   write(data_store, initial_kvs);
+
+   auto session_kvs = std::vector<std::unordered_map<uint16_t, uint16_t>>{
+      { { 3, 300 }, { 4, 400 } }, { { 5, 500 } }, { { 6, 600 }, { 7, 700 } }, { { 8, 800 } }
+   };
+   for (const auto& kvs : session_kvs) {
+      undo.push();
+      write(top(), kvs);
+   }
+   top().erase(make_key(1));
+   BOOST_REQUIRE(undo.revision() == 4);
+
+   auto expected = collapse({ initial_kvs, session_kvs[0], session_kvs[1], session_kvs[2], session_kvs[3] });
+   expected.erase(1);
+
+   // committed sessions still being written are not part of the stack but remain visible
+   undo.commit(2);
+   BOOST_REQUIRE(undo.size() == 2);
+   BOOST_REQUIRE(undo.revision() == 4);
+   verify_equal(top(), expected, int_t{});
+
+   undo.push();
+   top().write(make_key(9), make_key(900));
+   undo.undo();
+   verify_equal(top(), expected, int_t{});
+
+   // committing everything waits for the writes, so the head holds all changes
+   undo.commit(4);
+   BOOST_REQUIRE(undo.empty());
+   BOOST_REQUIRE(undo.revision() == 4);
+   verify_equal(data_store, expected, int_t{});
+   BOOST_REQUIRE(!data_store.read(make_key(1)));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
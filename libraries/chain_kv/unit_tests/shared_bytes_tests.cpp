@@ -160,4 +160,33 @@ BOOST_AUTO_TEST_CASE(truncate_key_test) {
    BOOST_CHECK_THROW(shared_bytes::truncate_key(empty), eosio::chain::chain_exception);
 }
 
+BOOST_AUTO_TEST_CASE(inline_buffer_test) {
+   auto short_value = std::string(shared_bytes::inline_capacity, 'a');
+   auto long_value  = std::string(shared_bytes::inline_capacity + 1, 'b');
+
+   // short buffers are copied with the instance
+   auto small      = shared_bytes(short_value.data(), short_value.size());
+   auto small_copy = small;
+   BOOST_REQUIRE(small_copy == small);
+   BOOST_REQUIRE(small_copy.data() != small.data());
+   small_copy[0] = 'c';
+   BOOST_REQUIRE(small[0] == 'a');
+   BOOST_REQUIRE(small_copy != small);
+
+   // long buffers are shared
+   auto large      = shared_bytes(long_value.data(), long_value.size());
+   auto large_copy = large;
+   BOOST_REQUIRE(large_copy.data() == large.data());
+   BOOST_REQUIRE(std::string(std::begin(large_copy), std::end(large_copy)) == long_value);
+
+   auto moved = std::move(small);
+   BOOST_REQUIRE(std::string(std::begin(moved), std::end(moved)) == short_value);
+   BOOST_REQUIRE(small.empty());
+   BOOST_REQUIRE(small == shared_bytes{});
+
+   auto joined = make_shared_bytes<std::string_view, 2>({ std::string_view{ "abc" }, std::string_view{ "def" } });
+   BOOST_REQUIRE(joined == shared_bytes("abcdef", 6));
+   BOOST_REQUIRE(std::hash<shared_bytes>{}(joined) == std::hash<shared_bytes>{}(shared_bytes("abcdef", 6)));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -106,14 +106,15 @@ void undo_tests(bool reload_undo, uint64_t target_segment_size) {
                                               } }));
 } // undo_tests()
 
-void squash_tests(bool reload_undo, uint64_t target_segment_size) {
+void squash_tests(bool reload_undo, uint64_t target_segment_size, uint64_t memory_undo_size = 0) {
    boost::filesystem::remove_all("test-squash-db");
    chain_kv::database                    db{ "test-squash-db", true };
    std::unique_ptr<chain_kv::undo_stack> undo_stack;
 
    auto reload = [&] {
       if (!undo_stack || reload_undo)
-         undo_stack = std::make_unique<chain_kv::undo_stack>(db, bytes{ 0x10 }, target_segment_size);
+         undo_stack = std::make_unique<chain_kv::undo_stack>(db, bytes{ 0x10 }, target_segment_size,
+                                                             memory_undo_size);
    };
    reload();
 
@@ -251,14 +252,15 @@ void squash_tests(bool reload_undo, uint64_t target_segment_size) {
    // TODO: test squash with only 1 undo level
 } // squash_tests()
 
-void commit_tests(bool reload_undo, uint64_t target_segment_size) {
+void commit_tests(bool reload_undo, uint64_t target_segment_size, uint64_t memory_undo_size = 0) {
    boost::filesystem::remove_all("test-commit-db");
    chain_kv::database                    db{ "test-commit-db", true };
    std::unique_ptr<chain_kv::undo_stack> undo_stack;
 
    auto reload = [&] {
       if (!undo_stack || reload_undo)
-         undo_stack = std::make_unique<chain_kv::undo_stack>(db, bytes{ 0x10 }, target_segment_size);
+         undo_stack = std::make_unique<chain_kv::undo_stack>(db, bytes{ 0x10 }, target_segment_size,
+                                                             memory_undo_size);
    };
    reload();
 
@@ -444,6 +446,9 @@ BOOST_AUTO_TEST_CASE(test_squash) {
    squash_tests(true, 0);
    squash_tests(false, 64 * 1024 * 1024);
    squash_tests(true, 64 * 1024 * 1024);
+   squash_tests(false, 0, 64 * 1024 * 1024);
+   squash_tests(true, 0, 64 * 1024 * 1024);
+   squash_tests(false, 0, 1);
 }
 
 BOOST_AUTO_TEST_CASE(test_commit) {
@@ -451,6 +456,51 @@ BOOST_AUTO_TEST_CASE(test_commit) {
    commit_tests(true, 0);
    commit_tests(false, 64 * 1024 * 1024);
    commit_tests(true, 64 * 1024 * 1024);
+   commit_tests(false, 0, 64 * 1024 * 1024);
+   commit_tests(true, 0, 64 * 1024 * 1024);
+   commit_tests(false, 0, 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_memory_undo) {
+   boost::filesystem::remove_all("test-memory-undo-db");
+   chain_kv::database db{ "test-memory-undo-db", true };
+   auto undo_stack = std::make_unique<chain_kv::undo_stack>(db, bytes{ 0x10 }, 0, 64 * 1024 * 1024);
+   auto write = [&](const bytes& key, const bytes& value) {
+      chain_kv::write_session session{ db };
+      session.set(bytes{ key }, to_slice(value));
+      session.write_changes(*undo_stack);
+   };
+
+   write({ 0x20, 0x01 }, { 0x01 });
+   undo_stack->push();
+   write({ 0x20, 0x01 }, { 0x02 });
+   write({ 0x20, 0x02 }, { 0x02 });
+   BOOST_REQUIRE_EQUAL(get_all(db, { 0x10, (char)0x80 }), (kv_values{})); // undo segments only in memory
+   undo_stack->undo();
+   BOOST_REQUIRE_EQUAL(get_all(db, { 0x20 }), (kv_values{ { { { 0x20, 0x01 }, { 0x01 } } } }));
+
+   // undo segments in memory are written when the undo stack goes away
+   undo_stack->push();
+   write({ 0x20, 0x01 }, { 0x03 });
+   undo_stack.reset();
+   BOOST_REQUIRE_NE(get_all(db, { 0x10, (char)0x80 }), (kv_values{}));
+   undo_stack = std::make_unique<chain_kv::undo_stack>(db, bytes{ 0x10 }, 0, 64 * 1024 * 1024);
+
+   // newer segments in memory, older ones in rocksdb
+   write({ 0x20, 0x02 }, { 0x03 });
+   undo_stack->push();
+   write({ 0x20, 0x01 }, { 0x04 });
+   undo_stack->squash();
+   BOOST_REQUIRE_EQUAL(undo_stack->revision(), 1);
+   undo_stack->undo();
+   BOOST_REQUIRE_EQUAL(get_all(db, { 0x20 }), (kv_values{ { { { 0x20, 0x01 }, { 0x01 } } } }));
+   BOOST_REQUIRE_EQUAL(get_all(db, { 0x10, (char)0x80 }), (kv_values{}));
+
+   undo_stack->push();
+   write({ 0x20, 0x01 }, { 0x05 });
+   undo_stack->commit(undo_stack->revision());
+   BOOST_REQUIRE_EQUAL(get_all(db, { 0x10, (char)0x80 }), (kv_values{}));
+   BOOST_REQUIRE_EQUAL(get_all(db, { 0x20 }), (kv_values{ { { { 0x20, 0x01 }, { 0x05 } } } }));
 }
 
 BOOST_AUTO_TEST_SUITE_END();
@@ -6,7 +6,7 @@ using chain_kv::to_slice;
 
 BOOST_AUTO_TEST_SUITE(write_session_tests)
 
-void write_session_test(bool reload_session) {
+void write_session_test(bool reload_session, bool ingest = false) {
    boost::filesystem::remove_all("test-write-session-db");
    chain_kv::database                       db{ "test-write-session-db", true };
    chain_kv::undo_stack                     undo_stack{ db, { 0x10 } };
@@ -14,7 +14,10 @@ void write_session_test(bool reload_session) {
 
    auto reload = [&] {
       if (session && reload_session) {
-         session->write_changes(undo_stack);
+         if (ingest)
+            session->ingest_changes(undo_stack, "test-write-session-db.sst");
+         else
+            session->write_changes(undo_stack);
          session = nullptr;
       }
       if (!session)
@@ -68,4 +71,48 @@ BOOST_AUTO_TEST_CASE(test_write_session) {
    write_session_test(true);
 }
 
+BOOST_AUTO_TEST_CASE(test_ingest_changes) {
+   write_session_test(true, true);
+
+   boost::filesystem::remove_all("test-write-session-db");
+   chain_kv::database      db{ "test-write-session-db", true };
+   chain_kv::undo_stack    undo_stack{ db, { 0x10 } };
+   chain_kv::write_session session{ db };
+   undo_stack.push();
+   session.set({ 0x20 }, to_slice({ 0x01 }));
+   KV_REQUIRE_EXCEPTION(session.ingest_changes(undo_stack, "test-write-session-db.sst"),
+                        "cannot ingest changes while there is an existing undo stack");
+}
+
+BOOST_AUTO_TEST_CASE(test_secondary) {
+   boost::filesystem::remove_all("test-write-session-db");
+   boost::filesystem::remove_all("test-write-session-db-secondary");
+   chain_kv::database   db{ "test-write-session-db", true };
+   chain_kv::undo_stack undo_stack{ db, { 0x10 } };
+   chain_kv::database   secondary{ "test-write-session-db", "test-write-session-db-secondary" };
+   BOOST_REQUIRE(!db.is_secondary());
+   BOOST_REQUIRE(secondary.is_secondary());
+
+   auto get = [&]() -> std::optional<bytes> {
+      chain_kv::read_snapshot snapshot{ secondary };
+      BOOST_REQUIRE(!snapshot.snapshot());
+      chain_kv::write_session session{ secondary, snapshot.snapshot() };
+      auto                    value = session.get({ 0x20 });
+      if (!value)
+         return {};
+      return *value;
+   };
+
+   {
+      chain_kv::write_session session{ db };
+      session.set({ 0x20 }, to_slice({ 0x01 }));
+      session.write_changes(undo_stack);
+   }
+   // the primary doesn't write a WAL; the secondary sees the changes once they are flushed
+   db.flush(true, true);
+   BOOST_REQUIRE(!get());
+   secondary.catch_up();
+   BOOST_REQUIRE(get() == bytes{ 0x01 });
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -191,6 +191,27 @@ extern "C" rodeos_bool rodeos_write_deltas(rodeos_error* error, rodeos_db_snapsh
    });
 }
 
+extern "C" rodeos_bool rodeos_write_block(rodeos_error* error, rodeos_db_snapshot* snapshot, const char* data,
+                                          uint64_t size, rodeos_bool force_write, rodeos_bool (*shutdown)(void*),
+                                          void* shutdown_arg) {
+   return handle_exceptions(error, false, [&]() {
+      if (!snapshot)
+         return error->set("snapshot is null");
+      with_result(data, size, [&](auto& result) {
+         snapshot->start_block(result);
+         snapshot->write_block_info(result);
+         snapshot->write_deltas(result, [=]() -> bool {
+            if (shutdown)
+               return shutdown(shutdown_arg);
+            else
+               return false;
+         });
+         snapshot->end_block(result, force_write);
+      });
+      return true;
+   });
+}
+
 extern "C" rodeos_filter* rodeos_create_filter(rodeos_error* error, uint64_t name, const char* wasm_filename) {
    return handle_exceptions(error, nullptr, [&]() -> rodeos_filter* { //
       return std::make_unique<rodeos_filter>(eosio::name{ name }, wasm_filename).release();
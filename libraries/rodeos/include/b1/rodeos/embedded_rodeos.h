@@ -97,6 +97,14 @@ rodeos_bool rodeos_write_block_info(rodeos_error* error, rodeos_db_snapshot* sna
 rodeos_bool rodeos_write_deltas(rodeos_error* error, rodeos_db_snapshot* snapshot, const char* data, uint64_t size,
                                 rodeos_bool (*shutdown)(void*), void* shutdown_arg);
 
+// Write a whole block: the same as calling `rodeos_start_block`, `rodeos_write_block_info`, `rodeos_write_deltas` and
+// `rodeos_end_block` with the same `data`, but `data` is only deserialized once. This suits in-process feeds, such as
+// the block consumers of nodeos's state_history_plugin. If `rodeos_write_block` returns false, the snapshot will be
+// in an inconsistent state; call `start_block` to abandon the current write and start another. It is undefined
+// behavior if the snapshot is used between threads without synchronization.
+rodeos_bool rodeos_write_block(rodeos_error* error, rodeos_db_snapshot* snapshot, const char* data, uint64_t size,
+                               rodeos_bool force_write, rodeos_bool (*shutdown)(void*), void* shutdown_arg);
+
 // Create a filter. Returns NULL on failure.
 rodeos_filter* rodeos_create_filter(rodeos_error* error, uint64_t name, const char* wasm_filename);
 
@@ -111,6 +111,15 @@ struct snapshot {
                error, obj, data, size, [](void* f) -> rodeos_bool { return (*static_cast<F*>(f))(); }, &shutdown);
       });
    }
+
+   template <typename F>
+   void write_block(const char* data, uint64_t size, bool force_write, F shutdown) {
+      error.check([&] {
+         return rodeos_write_block(
+               error, obj, data, size, force_write,
+               [](void* f) -> rodeos_bool { return (*static_cast<F*>(f))(); }, &shutdown);
+      });
+   }
 };
 
 struct filter {
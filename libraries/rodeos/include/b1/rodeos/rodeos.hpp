@@ -2,6 +2,7 @@
 #include <b1/chain_kv/chain_kv.hpp>
 #include <b1/rodeos/filter.hpp>
 #include <b1/rodeos/wasm_ql.hpp>
+#include <eosio/chain/thread_utils.hpp>
 #include <eosio/ship_protocol.hpp>
 #include <functional>
 
@@ -49,9 +50,15 @@ struct rodeos_db_snapshot {
    eosio::checksum256                      irreversible_id = {};
    uint32_t                                first           = 0;
    std::optional<uint32_t>                 writing_block   = {};
+   std::optional<eosio::chain::named_thread_pool> decode_pool = {}; // only if decode_threads > 1
+   uint32_t                                decode_threads  = 1;
+   std::string                             bulk_load_dir   = {}; // if set, changes of irreversible blocks are ingested from SST files here
+   uint64_t                                bulk_load_files = 0;
 
    rodeos_db_snapshot(std::shared_ptr<rodeos_db_partition> partition, bool persistent);
 
+   // Decode the rows of the table deltas on this many threads; the rows are still written in order
+   void set_decode_threads(uint32_t threads);
    void refresh();
    void end_write(bool write_fill);
    void start_block(const eosio::ship_protocol::get_blocks_result_base& result);
@@ -5,6 +5,8 @@
 #include <eosio/ship_protocol.hpp>
 #include <eosio/to_key.hpp>
 
+#include <functional>
+
 namespace eosio {
 using b1::rodeos::kv_environment;
 }
@@ -206,16 +208,45 @@ struct contract_index128_kv : eosio::kv_table<contract_index128> {
    }
 };
 
+// Runs f(i) for each i in [0, n), possibly concurrently, and returns once all calls have returned. Rethrows an
+// exception thrown by f.
+using parallel_for = std::function<void(size_t n, const std::function<void(size_t)>& f)>;
+
+// Rows are decoded this many at a time when decoding is parallel
+static constexpr size_t parallel_decode_rows = 4096;
+
 template <typename Table, typename D, typename F>
-void store_delta_typed(eosio::kv_environment environment, D& delta, bool bypass_preexist_check, F f) {
+void store_delta_typed(eosio::kv_environment environment, D& delta, bool bypass_preexist_check, F f,
+                       const parallel_for* decode_for = nullptr) {
    Table table{ environment };
-   for (auto& row : delta.rows) {
-      f();
-      auto obj = eosio::from_bin<typename Table::value_type>(row.data);
-      if (row.present)
-         table.put(obj);
-      else
-         table.erase(obj);
+   if (!decode_for) {
+      for (auto& row : delta.rows) {
+         f();
+         auto obj = eosio::from_bin<typename Table::value_type>(row.data);
+         if (row.present)
+            table.put(obj);
+         else
+            table.erase(obj);
+      }
+      return;
+   }
+
+   // Decode a chunk of rows concurrently, then write them in order through the single write session
+   std::vector<typename Table::value_type> objs;
+   for (size_t begin = 0; begin < delta.rows.size(); begin += parallel_decode_rows) {
+      const size_t end = std::min(begin + parallel_decode_rows, delta.rows.size());
+      objs.clear();
+      objs.resize(end - begin);
+      (*decode_for)(end - begin, [&](size_t i) {
+         objs[i] = eosio::from_bin<typename Table::value_type>(delta.rows[begin + i].data);
+      });
+      for (size_t i = 0; i < objs.size(); ++i) {
+         f();
+         if (delta.rows[begin + i].present)
+            table.put(objs[i]);
+         else
+            table.erase(objs[i]);
+      }
    }
 }
 
@@ -237,23 +268,24 @@ void store_delta_kv(eosio::kv_environment environment, D& delta, F f) {
 }
 
 template <typename D, typename F>
-inline void store_delta(eosio::kv_environment environment, D& delta, bool bypass_preexist_check, F f) {
+inline void store_delta(eosio::kv_environment environment, D& delta, bool bypass_preexist_check, F f,
+                        const parallel_for* decode_for = nullptr) {
    if (delta.name == "global_property")
-      store_delta_typed<global_property_kv>(environment, delta, bypass_preexist_check, f);
+      store_delta_typed<global_property_kv>(environment, delta, bypass_preexist_check, f, decode_for);
    if (delta.name == "account")
-      store_delta_typed<account_kv>(environment, delta, bypass_preexist_check, f);
+      store_delta_typed<account_kv>(environment, delta, bypass_preexist_check, f, decode_for);
    if (delta.name == "account_metadata")
-      store_delta_typed<account_metadata_kv>(environment, delta, bypass_preexist_check, f);
+      store_delta_typed<account_metadata_kv>(environment, delta, bypass_preexist_check, f, decode_for);
    if (delta.name == "code")
-      store_delta_typed<code_kv>(environment, delta, bypass_preexist_check, f);
+      store_delta_typed<code_kv>(environment, delta, bypass_preexist_check, f, decode_for);
    if (delta.name == "contract_table")
-      store_delta_typed<contract_table_kv>(environment, delta, bypass_preexist_check, f);
+      store_delta_typed<contract_table_kv>(environment, delta, bypass_preexist_check, f, decode_for);
    if (delta.name == "contract_row")
-      store_delta_typed<contract_row_kv>(environment, delta, bypass_preexist_check, f);
+      store_delta_typed<contract_row_kv>(environment, delta, bypass_preexist_check, f, decode_for);
    if (delta.name == "contract_index64")
-      store_delta_typed<contract_index64_kv>(environment, delta, bypass_preexist_check, f);
+      store_delta_typed<contract_index64_kv>(environment, delta, bypass_preexist_check, f, decode_for);
    if (delta.name == "contract_index128")
-      store_delta_typed<contract_index128_kv>(environment, delta, bypass_preexist_check, f);
+      store_delta_typed<contract_index128_kv>(environment, delta, bypass_preexist_check, f, decode_for);
    if (delta.name == "key_value")
       store_delta_kv(environment, delta, f);
 }
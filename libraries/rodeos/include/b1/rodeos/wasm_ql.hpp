@@ -58,6 +58,13 @@ class thread_state_cache {
    }
 };
 
+// Compiles copies backends for each <account>.wasm in contract_dir and pins them in the backend cache, so the first
+// requests to those contracts don't pay for compilation. Pinned backends aren't evicted by wasm_cache_size.
+void preload_contracts(const wasm_ql::shared_state& shared_state, uint32_t copies);
+
+// Returns the id of the head block the queries currently read, or an empty id if there is no fill status yet
+eosio::checksum256 query_head_id(wasm_ql::thread_state& thread_state, const std::vector<char>& contract_kv_prefix);
+
 const std::vector<char>& query_get_info(wasm_ql::thread_state&   thread_state,
                                         const std::vector<char>& contract_kv_prefix);
 const std::vector<char>& query_get_block(wasm_ql::thread_state&   thread_state,
@@ -37,6 +37,13 @@ rodeos_db_snapshot::rodeos_db_snapshot(std::shared_ptr<rodeos_db_partition> part
    }
 }
 
+void rodeos_db_snapshot::set_decode_threads(uint32_t threads) {
+   decode_pool.reset();
+   decode_threads = std::max<uint32_t>(threads, 1);
+   if (decode_threads > 1)
+      decode_pool.emplace("decode", decode_threads);
+}
+
 void rodeos_db_snapshot::refresh() {
    if (undo_stack)
       throw std::runtime_error("can not refresh a persistent snapshot");
@@ -76,7 +83,11 @@ void rodeos_db_snapshot::end_write(bool write_fill) {
       throw std::runtime_error("Can only write to persistent snapshots");
    if (write_fill)
       write_fill_status();
-   write_session->write_changes(*undo_stack);
+   // without undo data to record the changes are irreversible and can skip the memtable
+   if (!bulk_load_dir.empty() && undo_stack->first_revision() == undo_stack->revision())
+      write_session->ingest_changes(*undo_stack, bulk_load_dir + "/ingest-" + std::to_string(++bulk_load_files) + ".sst");
+   else
+      write_session->write_changes(*undo_stack);
 }
 
 void rodeos_db_snapshot::start_block(const get_blocks_result_base& result) {
@@ -215,6 +226,21 @@ void rodeos_db_snapshot::write_deltas(uint32_t block_num, eosio::opaque<std::vec
    view_state.kv_disk.enable_write          = true;
    view_state.kv_disk.bypass_receiver_check = true;
    view_state.kv_state.enable_write         = true;
+
+   // splits the rows of a chunk into one contiguous range per decode thread
+   parallel_for decode_for = [this](size_t n, const std::function<void(size_t)>& f) {
+      const size_t                   per_thread = (n + decode_threads - 1) / decode_threads;
+      std::vector<std::future<void>> ranges;
+      for (size_t begin = 0; begin < n; begin += per_thread) {
+         const size_t end = std::min(begin + per_thread, n);
+         ranges.push_back(eosio::chain::async_thread_pool(decode_pool->get_executor(), [&f, begin, end]() {
+            for (size_t i = begin; i < end; ++i) f(i);
+         }));
+      }
+      for (auto& range : ranges) range.wait();
+      for (auto& range : ranges) range.get();
+   };
+
    uint32_t num = deltas.unpack_size();
    for (uint32_t i = 0; i < num; ++i) {
       ship_protocol::table_delta delta;
@@ -234,7 +260,7 @@ void rodeos_db_snapshot::write_deltas(uint32_t block_num, eosio::opaque<std::vec
                }
             }
             ++num_processed;
-         });
+         }, decode_pool ? &decode_for : nullptr);
       }, delta);
 }
 
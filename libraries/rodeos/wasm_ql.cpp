@@ -5,6 +5,7 @@
 #include <b1/rodeos/callbacks/console.hpp>
 #include <b1/rodeos/callbacks/memory.hpp>
 #include <b1/rodeos/callbacks/unimplemented.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/sequenced_index.hpp>
@@ -114,6 +115,7 @@ struct backend_entry {
    eosio::name                name; // only for wasms loaded from disk
    eosio::checksum256         hash; // only for wasms loaded from chain
    std::unique_ptr<backend_t> backend;
+   bool                       pinned = false; // preloaded from disk; never evicted
 };
 
 struct by_age;
@@ -131,6 +133,7 @@ class backend_cache {
    std::mutex                   mutex;
    const wasm_ql::shared_state& shared_state;
    backend_container            backends;
+   size_t                       num_pinned = 0;
 
  public:
    backend_cache(const wasm_ql::shared_state& shared_state) : shared_state{ shared_state } {}
@@ -138,8 +141,16 @@ class backend_cache {
    void add(backend_entry&& entry) {
       std::lock_guard<std::mutex> lock{ mutex };
       auto&                       ind = backends.get<by_age>();
+      if (entry.pinned)
+         ++num_pinned;
       ind.push_back(std::move(entry));
-      while (ind.size() > shared_state.wasm_cache_size) ind.pop_front();
+      // pinned backends don't count against wasm_cache_size
+      for (auto it = ind.begin(); ind.size() - num_pinned > shared_state.wasm_cache_size && it != ind.end();) {
+         if (it->pinned)
+            ++it;
+         else
+            it = ind.erase(it);
+      }
    }
 
    std::optional<backend_entry> get(eosio::name name) {
@@ -151,6 +162,8 @@ class backend_cache {
          return result;
       ind.modify(it, [&](auto& x) { result = std::move(x); });
       ind.erase(it);
+      if (result->pinned)
+         --num_pinned;
       return result;
    }
 
@@ -163,6 +176,8 @@ class backend_cache {
          return result;
       ind.modify(it, [&](auto& x) { result = std::move(x); });
       ind.erase(it);
+      if (result->pinned)
+         --num_pinned;
       return result;
    }
 };
@@ -172,10 +187,10 @@ shared_state::shared_state(std::shared_ptr<chain_kv::database> db)
 
 shared_state::~shared_state() {}
 
-std::optional<std::vector<uint8_t>> read_code(wasm_ql::thread_state& thread_state, eosio::name account) {
+std::optional<std::vector<uint8_t>> read_code(const wasm_ql::shared_state& shared_state, eosio::name account) {
    std::optional<std::vector<uint8_t>> code;
-   if (!thread_state.shared->contract_dir.empty()) {
-      auto          filename = thread_state.shared->contract_dir + "/" + (std::string)account + ".wasm";
+   if (!shared_state.contract_dir.empty()) {
+      auto          filename = shared_state.contract_dir + "/" + (std::string)account + ".wasm";
       std::ifstream wasm_file(filename, std::ios::binary);
       if (wasm_file.is_open()) {
          ilog("compiling ${f}", ("f", filename));
@@ -192,6 +207,39 @@ std::optional<std::vector<uint8_t>> read_code(wasm_ql::thread_state& thread_stat
    return code;
 }
 
+std::unique_ptr<backend_t> compile(std::vector<uint8_t>& code) {
+   std::call_once(registered_callbacks, register_callbacks);
+   auto backend = std::make_unique<backend_t>(code, nullptr);
+   rhf_t::resolve(backend->get_module());
+   return backend;
+}
+
+void preload_contracts(const wasm_ql::shared_state& shared_state, uint32_t copies) {
+   namespace bfs = boost::filesystem;
+   if (shared_state.contract_dir.empty() || !bfs::is_directory(shared_state.contract_dir))
+      return;
+   for (auto& file : bfs::directory_iterator(shared_state.contract_dir)) {
+      if (file.path().extension() != ".wasm")
+         continue;
+      auto        stem = file.path().stem().string();
+      eosio::name account{ stem };
+      if ((std::string)account != stem) {
+         wlog("skipping ${f}: not a valid account name", ("f", file.path().string()));
+         continue;
+      }
+      auto code = read_code(shared_state, account);
+      if (!code)
+         continue;
+      for (uint32_t i = 0; i < copies; ++i) {
+         backend_entry entry;
+         entry.name    = account;
+         entry.backend = compile(*code);
+         entry.pinned  = true;
+         shared_state.backend_cache->add(std::move(entry));
+      }
+   }
+}
+
 std::optional<eosio::checksum256> get_contract_hash(db_view_state& db_view_state, eosio::name account) {
    std::optional<eosio::checksum256> result;
    auto                              meta = get_state_row<ship_protocol::account_metadata>(
@@ -233,7 +281,7 @@ void run_action(wasm_ql::thread_state& thread_state, const std::vector<char>& co
    std::optional<backend_entry>        entry = thread_state.shared->backend_cache->get(action.account);
    std::optional<std::vector<uint8_t>> code;
    if (!entry)
-      code = read_code(thread_state, action.account);
+      code = read_code(*thread_state.shared, action.account);
    std::optional<eosio::checksum256> hash;
    if (!entry && !code) {
       hash = get_contract_hash(db_view_state, action.account);
@@ -255,9 +303,7 @@ void run_action(wasm_ql::thread_state& thread_state, const std::vector<char>& co
       else
          entry->name = action.account;
 
-      std::call_once(registered_callbacks, register_callbacks);
-      entry->backend = std::make_unique<backend_t>(*code, nullptr);
-      rhf_t::resolve(entry->backend->get_module());
+      entry->backend = compile(*code);
    }
    auto se = fc::make_scoped_exit([&] { thread_state.shared->backend_cache->add(std::move(*entry)); });
 
@@ -295,9 +341,20 @@ void run_action(wasm_ql::thread_state& thread_state, const std::vector<char>& co
    atrace.return_value = memory.back();
 } // run_action
 
+eosio::checksum256 query_head_id(wasm_ql::thread_state& thread_state, const std::vector<char>& contract_kv_prefix) {
+   chain_kv::read_snapshot  snapshot{ *thread_state.shared->db };
+   chain_kv::write_session  write_session{ *thread_state.shared->db, snapshot.snapshot() };
+   db_view_state            db_view_state{ state_account, *thread_state.shared->db, write_session, contract_kv_prefix };
+
+   fill_status_sing sing{ state_account, db_view_state, false };
+   if (!sing.exists())
+      return {};
+   return std::visit([](auto& obj) { return obj.head_id; }, sing.get());
+}
+
 const std::vector<char>& query_get_info(wasm_ql::thread_state&   thread_state,
                                         const std::vector<char>& contract_kv_prefix) {
-   rocksdb::ManagedSnapshot snapshot{ thread_state.shared->db->rdb.get() };
+   chain_kv::read_snapshot  snapshot{ *thread_state.shared->db };
    chain_kv::write_session  write_session{ *thread_state.shared->db, snapshot.snapshot() };
    db_view_state            db_view_state{ state_account, *thread_state.shared->db, write_session, contract_kv_prefix };
 
@@ -355,7 +412,7 @@ const std::vector<char>& query_get_block(wasm_ql::thread_state&   thread_state,
       throw std::runtime_error("An error occurred deserializing get_block_params: "s + e.what());
    }
 
-   rocksdb::ManagedSnapshot snapshot{ thread_state.shared->db->rdb.get() };
+   chain_kv::read_snapshot  snapshot{ *thread_state.shared->db };
    chain_kv::write_session  write_session{ *thread_state.shared->db, snapshot.snapshot() };
    db_view_state            db_view_state{ state_account, *thread_state.shared->db, write_session, contract_kv_prefix };
 
@@ -433,7 +490,7 @@ const std::vector<char>& query_get_abi(wasm_ql::thread_state& thread_state, cons
       throw std::runtime_error("An error occurred deserializing get_abi_params: "s + e.what());
    }
 
-   rocksdb::ManagedSnapshot snapshot{ thread_state.shared->db->rdb.get() };
+   chain_kv::read_snapshot  snapshot{ *thread_state.shared->db };
    chain_kv::write_session  write_session{ *thread_state.shared->db, snapshot.snapshot() };
    db_view_state            db_view_state{ state_account, *thread_state.shared->db, write_session, contract_kv_prefix };
 
@@ -555,7 +612,7 @@ const std::vector<char>& query_send_transaction(wasm_ql::thread_state&   thread_
                                                 std::move(params.signatures), params.packed_context_free_data.data } },
                                           params.packed_trx.data };
 
-   rocksdb::ManagedSnapshot snapshot{ thread_state.shared->db->rdb.get() };
+   chain_kv::read_snapshot  snapshot{ *thread_state.shared->db };
 
    std::vector<std::vector<char>> memory;
    send_transaction_results       results;
@@ -46,6 +46,83 @@ extern const char* const state_history_plugin_abi = R"({
                 { "name": "fetch_block_header", "type": "bool" }
             ]
         },
+        {
+            "name": "get_blocks_request_v2", "fields": [
+                { "name": "start_block_num", "type": "uint32" },
+                { "name": "end_block_num", "type": "uint32" },
+                { "name": "max_messages_in_flight", "type": "uint32" },
+                { "name": "have_positions", "type": "block_position[]" },
+                { "name": "irreversible_only", "type": "bool" },
+                { "name": "fetch_block", "type": "bool" },
+                { "name": "fetch_traces", "type": "bool" },
+                { "name": "fetch_deltas", "type": "bool" },
+                { "name": "fetch_block_header", "type": "bool" },
+                { "name": "compressed_deltas", "type": "bool" }
+            ]
+        },
+        {
+            "name": "action_filter", "fields": [
+                { "name": "account", "type": "name" },
+                { "name": "action", "type": "name" }
+            ]
+        },
+        {
+            "name": "table_filter", "fields": [
+                { "name": "code", "type": "name" },
+                { "name": "table", "type": "name" }
+            ]
+        },
+        {
+            "name": "get_blocks_request_v3", "fields": [
+                { "name": "start_block_num", "type": "uint32" },
+                { "name": "end_block_num", "type": "uint32" },
+                { "name": "max_messages_in_flight", "type": "uint32" },
+                { "name": "have_positions", "type": "block_position[]" },
+                { "name": "irreversible_only", "type": "bool" },
+                { "name": "fetch_block", "type": "bool" },
+                { "name": "fetch_traces", "type": "bool" },
+                { "name": "fetch_deltas", "type": "bool" },
+                { "name": "fetch_block_header", "type": "bool" },
+                { "name": "compressed_deltas", "type": "bool" },
+                { "name": "action_filters", "type": "action_filter[]" },
+                { "name": "table_filters", "type": "table_filter[]" }
+            ]
+        },
+        {
+            "name": "get_blocks_request_v4", "fields": [
+                { "name": "start_block_num", "type": "uint32" },
+                { "name": "end_block_num", "type": "uint32" },
+                { "name": "max_messages_in_flight", "type": "uint32" },
+                { "name": "have_positions", "type": "block_position[]" },
+                { "name": "irreversible_only", "type": "bool" },
+                { "name": "fetch_block", "type": "bool" },
+                { "name": "fetch_traces", "type": "bool" },
+                { "name": "fetch_deltas", "type": "bool" },
+                { "name": "fetch_block_header", "type": "bool" },
+                { "name": "compressed_deltas", "type": "bool" },
+                { "name": "action_filters", "type": "action_filter[]" },
+                { "name": "table_filters", "type": "table_filter[]" },
+                { "name": "max_batch_bytes", "type": "uint32" }
+            ]
+        },
+        {
+            "name": "get_blocks_request_v5", "fields": [
+                { "name": "start_block_num", "type": "uint32" },
+                { "name": "end_block_num", "type": "uint32" },
+                { "name": "max_messages_in_flight", "type": "uint32" },
+                { "name": "have_positions", "type": "block_position[]" },
+                { "name": "irreversible_only", "type": "bool" },
+                { "name": "fetch_block", "type": "bool" },
+                { "name": "fetch_traces", "type": "bool" },
+                { "name": "fetch_deltas", "type": "bool" },
+                { "name": "fetch_block_header", "type": "bool" },
+                { "name": "compressed_deltas", "type": "bool" },
+                { "name": "action_filters", "type": "action_filter[]" },
+                { "name": "table_filters", "type": "table_filter[]" },
+                { "name": "max_batch_bytes", "type": "uint32" },
+                { "name": "fetch_state_snapshot", "type": "bool" }
+            ]
+        },
         {
             "name": "get_blocks_ack_request_v0", "fields": [
                 { "name": "num_messages", "type": "uint32" }
@@ -85,6 +162,19 @@ extern const char* const state_history_plugin_abi = R"({
                 { "name": "deltas",        "type": "bytes" }
             ]
         },
+        {
+            "name": "get_blocks_batch_result_v0", "fields": [
+                { "name": "results", "type": "get_blocks_result_v2[]" }
+            ]
+        },
+        {
+            "name": "state_snapshot_result_v0", "fields": [
+                { "name": "head", "type": "block_position" },
+                { "name": "last_irreversible", "type": "block_position" },
+                { "name": "this_block", "type": "block_position" },
+                { "name": "deltas", "type": "bytes" }
+            ]
+        },
         {
             "name": "row_v0", "fields": [
                 { "name": "present", "type": "bool" },
@@ -652,8 +742,8 @@ extern const char* const state_history_plugin_abi = R"({
         { "new_type_name": "transaction_id", "type": "checksum256" }
     ],
     "variants": [
-        { "name": "request", "types": ["get_status_request_v0", "get_blocks_request_v0", "get_blocks_ack_request_v0", "get_blocks_request_v1"] },
-        { "name": "result", "types": ["get_status_result_v0", "get_blocks_result_v0", "get_blocks_result_v1", "get_blocks_result_v2"] },
+        { "name": "request", "types": ["get_status_request_v0", "get_blocks_request_v0", "get_blocks_ack_request_v0", "get_blocks_request_v1", "get_blocks_request_v2", "get_blocks_request_v3", "get_blocks_request_v4", "get_blocks_request_v5"] },
+        { "name": "result", "types": ["get_status_result_v0", "get_blocks_result_v0", "get_blocks_result_v1", "get_blocks_result_v2", "get_blocks_batch_result_v0", "state_snapshot_result_v0"] },
 
         { "name": "action_receipt", "types": ["action_receipt_v0"] },
         { "name": "action_trace", "types": ["action_trace_v0", "action_trace_v1"] },
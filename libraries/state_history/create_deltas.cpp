@@ -4,6 +4,13 @@
 #include <eosio/chain/backing_store/db_combined.hpp>
 #include <b1/session/rocks_session.hpp>
 
+#include <boost/asio/post.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
 namespace eosio {
 namespace state_history {
 
@@ -58,8 +65,54 @@ bool include_delta(const chain::protocol_state_object& old, const chain::protoco
    return old.activated_protocol_features != curr.activated_protocol_features;
 }
 
-std::vector<table_delta> create_deltas(const chainbase::database& db, bool full_snapshot) {
-   std::vector<table_delta>                          deltas;
+/// Runs the tasks on the thread pool and on the calling thread, which runs the tasks that no pool thread has started,
+/// so the tasks are done even if all the pool threads are busy.
+void run_tasks(boost::asio::io_context* thread_pool, std::vector<std::function<void()>> tasks) {
+   struct state_t {
+      std::vector<std::function<void()>> tasks;
+      std::atomic<size_t>                next = 0;
+      std::mutex                         mtx;
+      std::condition_variable            cv;
+      size_t                             done = 0;
+      std::exception_ptr                 error;
+
+      // the tasks are only referenced until they are all done, the state outlives run_tasks
+      void run() {
+         for (size_t i = next++; i < tasks.size(); i = next++) {
+            std::exception_ptr task_error;
+            try {
+               tasks[i]();
+            } catch (...) {
+               task_error = std::current_exception();
+            }
+            std::lock_guard g(mtx);
+            if (task_error && !error)
+               error = task_error;
+            if (++done == tasks.size())
+               cv.notify_one();
+         }
+      }
+   };
+
+   auto state   = std::make_shared<state_t>();
+   state->tasks = std::move(tasks);
+   if (thread_pool) {
+      for (size_t i = 1; i < state->tasks.size(); ++i)
+         boost::asio::post(*thread_pool, [state]() { state->run(); });
+   }
+   state->run();
+
+   std::unique_lock g(state->mtx);
+   state->cv.wait(g, [&state]() { return state->done == state->tasks.size(); });
+   if (state->error)
+      std::rethrow_exception(state->error);
+}
+
+std::vector<table_delta> create_deltas(const chainbase::database& db, bool full_snapshot,
+                                       boost::asio::io_context* thread_pool) {
+   // each table is serialized by its own task into its own slot, so the deltas keep the order of the tables
+   std::vector<std::optional<table_delta>>           table_deltas;
+   std::vector<std::function<void()>>                tasks;
    const auto&                                       table_id_index = db.get_index<chain::table_id_multi_index>();
    std::map<uint64_t, const chain::table_id_object*> removed_table_id;
    for (auto& rem : table_id_index.last_undo_session().removed_values)
@@ -79,22 +132,14 @@ std::vector<table_delta> create_deltas(const chainbase::database& db, bool full_
       return fc::raw::pack(make_history_context_wrapper(db, get_table_id(row.t_id._id), row));
    };
 
-   auto process_table = [&](auto* name, auto& index, auto& pack_row) {
+   auto process_table_rows = [&](auto* name, auto& index, auto& pack_row, std::optional<table_delta>& result) {
+      table_delta delta;
+      delta.name = name;
       if (full_snapshot) {
-         if (index.indices().empty())
-            return;
-         deltas.push_back({});
-         auto& delta = deltas.back();
-         delta.name  = name;
          for (auto& row : index.indices())
             delta.rows.obj.emplace_back(2, pack_row(row));
       } else {
          auto undo = index.last_undo_session();
-         if (undo.old_values.empty() && undo.new_values.empty() && undo.removed_values.empty())
-            return;
-         deltas.push_back({});
-         auto& delta = deltas.back();
-         delta.name  = name;
          for (auto& old : undo.old_values) {
             auto& row = index.get(old.id);
             if (include_delta(old, row))
@@ -105,11 +150,24 @@ std::vector<table_delta> create_deltas(const chainbase::database& db, bool full_
          for (auto& row : undo.new_values) {
             delta.rows.obj.emplace_back(2, pack_row(row));
          }
+      }
+      if (!delta.rows.obj.empty())
+         result = std::move(delta);
+   };
 
-         if(delta.rows.obj.empty()) {
-            deltas.pop_back();
-         }
+   auto process_table = [&](auto* name, auto& index, auto& pack_row) {
+      if (full_snapshot) {
+         if (index.indices().empty())
+            return;
+      } else {
+         auto undo = index.last_undo_session();
+         if (undo.old_values.empty() && undo.new_values.empty() && undo.removed_values.empty())
+            return;
       }
+      table_deltas.emplace_back();
+      tasks.push_back([&, name, slot = table_deltas.size() - 1]() {
+         process_table_rows(name, index, pack_row, table_deltas[slot]);
+      });
    };
 
    process_table("account", db.get_index<chain::account_index>(), pack_row);
@@ -140,6 +198,13 @@ std::vector<table_delta> create_deltas(const chainbase::database& db, bool full_
    process_table("resource_limits_config", db.get_index<chain::resource_limits::resource_limits_config_index>(),
                  pack_row);
 
+   run_tasks(thread_pool, std::move(tasks));
+
+   std::vector<table_delta> deltas;
+   for (auto& delta : table_deltas) {
+      if (delta)
+         deltas.push_back(std::move(*delta));
+   }
    return deltas;
 }
 
@@ -195,11 +260,12 @@ std::vector<table_delta> create_deltas_rocksdb(const chainbase::database& db, co
    return deltas;
 }
 
-std::vector<table_delta> create_deltas(const chain::combined_database& db, bool full_snapshot){
+std::vector<table_delta> create_deltas(const chain::combined_database& db, bool full_snapshot,
+                                       boost::asio::io_context* thread_pool) {
    auto &chainbase_db = db.get_db();
    auto &kv_undo_stack = db.get_kv_undo_stack();
 
-   std::vector<table_delta> deltas = create_deltas(chainbase_db, full_snapshot);
+   std::vector<table_delta> deltas = create_deltas(chainbase_db, full_snapshot, thread_pool);
 
    if(kv_undo_stack && chainbase_db.get<chain::kv_db_config_object>().backing_store == chain::backing_store_type::ROCKSDB) {
       auto deltas_rocksdb = create_deltas_rocksdb(chainbase_db, kv_undo_stack, full_snapshot);
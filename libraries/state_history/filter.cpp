@@ -0,0 +1,92 @@
+#include <eosio/state_history/filter.hpp>
+#include <eosio/state_history/serialization.hpp>
+
+namespace eosio {
+namespace state_history {
+
+namespace {
+
+bool matches(const action& act, const std::vector<action_filter>& filters) {
+   return std::any_of(filters.begin(), filters.end(), [&act](const action_filter& f) {
+      return f.account.to_uint64_t() == act.account &&
+             (f.action.empty() || f.action.to_uint64_t() == act.name);
+   });
+}
+
+bool matches(const transaction_trace& trace, const std::vector<action_filter>& filters) {
+   const auto& t = std::get<transaction_trace_v0>(trace);
+   for (const auto& at : t.action_traces) {
+      if (std::visit([&filters](const auto& v) { return matches(v.act, filters); }, at))
+         return true;
+   }
+   return std::any_of(t.failed_dtrx_trace.begin(), t.failed_dtrx_trace.end(),
+                      [&filters](const auto& failed) { return matches(failed.recurse, filters); });
+}
+
+// the contract tables rows start with the struct version, the code and the scope, followed by the table
+std::optional<std::pair<uint64_t, uint64_t>> contract_table_of(const std::string& table_name, const bytes& row) {
+   fc::datastream<const char*> ds(row.data(), row.size());
+   fc::unsigned_int            struct_version;
+   uint64_t                    code = 0, scope = 0, table = 0;
+   if (table_name == "key_value") {
+      fc::raw::unpack(ds, struct_version);
+      fc::raw::unpack(ds, code);
+      return std::make_pair(code, uint64_t(0));
+   }
+   if (table_name == "contract_table" || table_name == "contract_row" || table_name.rfind("contract_index", 0) == 0) {
+      fc::raw::unpack(ds, struct_version);
+      fc::raw::unpack(ds, code);
+      fc::raw::unpack(ds, scope);
+      fc::raw::unpack(ds, table);
+      return std::make_pair(code, table);
+   }
+   return {};
+}
+
+} // namespace
+
+bytes filter_traces(const bytes& traces, const std::vector<action_filter>& filters) {
+   std::vector<transaction_trace> unfiltered;
+   fc::datastream<const char*>    ds(traces.data(), traces.size());
+   fc::raw::unpack(ds, unfiltered);
+
+   std::vector<transaction_trace> result;
+   for (auto& trace : unfiltered) {
+      if (matches(trace, filters))
+         result.push_back(std::move(trace));
+   }
+   return fc::raw::pack(result);
+}
+
+bytes filter_deltas(const bytes& deltas, const std::vector<table_filter>& filters) {
+   fc::datastream<const char*> ds(deltas.data(), deltas.size());
+   fc::unsigned_int            num_tables;
+   fc::raw::unpack(ds, num_tables);
+
+   std::vector<table_delta> result;
+   for (uint32_t i = 0; i < num_tables.value; ++i) {
+      table_delta      delta;
+      fc::unsigned_int num_rows;
+      fc::raw::unpack(ds, delta.struct_version);
+      fc::raw::unpack(ds, delta.name);
+      fc::raw::unpack(ds, num_rows);
+      for (uint32_t j = 0; j < num_rows.value; ++j) {
+         std::pair<uint8_t, bytes> row;
+         fc::raw::unpack(ds, row);
+         auto table = contract_table_of(delta.name, row.second);
+         if (!table)
+            continue;
+         bool keep = std::any_of(filters.begin(), filters.end(), [&table](const table_filter& f) {
+            return f.code.to_uint64_t() == table->first && (f.table.empty() || f.table.to_uint64_t() == table->second);
+         });
+         if (keep)
+            delta.rows.obj.push_back(std::move(row));
+      }
+      if (!delta.rows.obj.empty())
+         result.push_back(std::move(delta));
+   }
+   return fc::raw::pack(result);
+}
+
+} // namespace state_history
+} // namespace eosio
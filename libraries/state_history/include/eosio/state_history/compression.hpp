@@ -44,13 +44,14 @@ bool is_empty(const std::vector<T>& obj) {
 }
 
 template <typename STREAM, typename T>
-void zlib_pack(STREAM& strm, const T& obj) {
+void zlib_pack(STREAM& strm, const T& obj, int level = bio::zlib::default_compression) {
    if (is_empty(obj)) {
       fc::raw::pack(strm, uint32_t(0));
    }
    else {
       length_writer<STREAM>     len_writer(strm);
-      fc::datastream<bio::filtering_ostreambuf> compressed_strm(bio::zlib_compressor() | fc::to_sink(strm));
+      fc::datastream<bio::filtering_ostreambuf> compressed_strm(bio::zlib_compressor(bio::zlib_params(level)) |
+                                                                fc::to_sink(strm));
       fc::raw::pack(compressed_strm, obj);
    }
 }
@@ -82,5 +83,26 @@ std::vector<char> zlib_decompress(STREAM& strm) {
    return {};
 }
 
+/// @return the zlib stream of data, as zlib_pack writes it after its length
+inline std::vector<char> zlib_compress(const std::vector<char>& data, int level = bio::zlib::default_compression) {
+   std::vector<char> result;
+   {
+      bio::filtering_ostreambuf compress_buf(bio::zlib_compressor(bio::zlib_params(level)) | bio::back_inserter(result));
+      compress_buf.sputn(data.data(), data.size());
+   }
+   return result;
+}
+
+/// @return the zlib stream written by zlib_pack, without decompressing it
+template <typename STREAM>
+std::vector<char> zlib_compressed_bytes(STREAM& strm) {
+   uint32_t          len;
+   fc::raw::unpack(strm, len);
+   std::vector<char> result(len);
+   if (len > 0)
+      strm.read(result.data(), len);
+   return result;
+}
+
 } // namespace state_history
 } // namespace eosio
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <eosio/state_history/types.hpp>
+
+namespace eosio {
+namespace state_history {
+
+/// @param traces the packed traces of a block, as returned by state_history_traces_log::get_log_entry
+/// @return the packed traces of the transactions with an action that matches one of the filters
+bytes filter_traces(const bytes& traces, const std::vector<action_filter>& filters);
+
+/// @param deltas the packed deltas of a block, as returned by state_history_chain_state_log::get_log_entry
+/// @return the packed deltas with only the contract table rows that match one of the filters
+bytes filter_deltas(const bytes& deltas, const std::vector<table_filter>& filters);
+
+} // namespace state_history
+} // namespace eosio
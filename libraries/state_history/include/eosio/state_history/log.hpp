@@ -1,7 +1,9 @@
 #pragma once
 
+#include <boost/asio/io_context.hpp>
 #include <boost/filesystem.hpp>
 #include <fstream>
+#include <mutex>
 #include <stdint.h>
 
 #include <cstddef>
@@ -113,6 +115,8 @@ struct state_history_config {
    bfs::path archive_dir;
    uint32_t  stride             = UINT32_MAX;
    uint32_t  max_retained_files = 10;
+   int       compression_level  = -1; ///< zlib level of the log entries, from 0 to 9 or -1 for the zlib default
+   chain::remote_archive_config remote_archive; ///< keep archived history files in a remote store instead of archive_dir
 };
 
 class state_history_log {
@@ -133,6 +137,12 @@ class state_history_log {
    using catalog_t = chain::log_catalog<state_history_log_data, chain::log_index<chain::state_history_exception>>;
    catalog_t catalog;
 
+   int compression_level = -1;
+
+   /// guards the log files and the catalog, the logs are written on the main thread and read by the state history
+   /// threads
+   mutable std::mutex mtx;
+
  public:
    // The type aliases below help to make it obvious about the meanings of member function return values.
    using block_num_type     = uint32_t;
@@ -143,13 +153,18 @@ class state_history_log {
    state_history_log(const char* const name, const state_history_config& conf);
 
    block_num_type begin_block() const {
+      std::lock_guard        g(mtx);
       block_num_type result = catalog.first_block_num();
       return result != 0 ? result : _begin_block;
    }
-   block_num_type end_block() const { return _end_block; }
+   block_num_type end_block() const {
+      std::lock_guard g(mtx);
+      return _end_block;
+   }
 
    template <typename F>
    void write_entry(state_history_log_header& header, const chain::block_id_type& prev_id, F write_payload) {
+      std::lock_guard g(mtx);
 
       auto [block_num, start_pos] = write_entry_header(header, prev_id);
       try {
@@ -166,12 +181,17 @@ class state_history_log {
    std::optional<chain::block_id_type> get_block_id(block_num_type block_num);
 
  protected:
+   /// @return whether block_num is in the current log file, must hold mtx
+   bool in_log(block_num_type block_num) const { return block_num >= _begin_block && block_num < _end_block; }
+
+   /// must hold mtx
    void get_entry_header(block_num_type block_num, state_history_log_header& header);
 
  private:
    void               read_header(state_history_log_header& header, bool assert_version = true);
    void               write_header(const state_history_log_header& header);
    bool               get_last_block(uint64_t size);
+   std::pair<uint32_t, uint64_t> last_indexed_entry(const bfs::path& index_filename, uint64_t size);
    void               recover_blocks(uint64_t size);
    void               open_log(bfs::path filename);
    void               open_index(bfs::path filename);
@@ -187,7 +207,7 @@ class state_history_log {
 }; // state_history_log
 
 class state_history_traces_log : public state_history_log {
-   state_history::transaction_trace_cache cache;
+   state_history::packed_trace_cache cache;
 
  public:
    bool                            trace_debug_mode = false;
@@ -197,8 +217,12 @@ class state_history_traces_log : public state_history_log {
 
    static bool exists(bfs::path state_history_dir);
 
-   void add_transaction(const chain::transaction_trace_ptr& trace, const chain::packed_transaction_ptr& transaction) {
-      cache.add_transaction(trace, transaction);
+   /// serialize the traces on a strand of thread_pool as they are added
+   void set_thread_pool(boost::asio::io_context& thread_pool) { cache.set_thread_pool(thread_pool); }
+
+   void add_transaction(const chainbase::database& db, const chain::transaction_trace_ptr& trace,
+                        const chain::packed_transaction_ptr& transaction) {
+      cache.add_transaction(db, trace, transaction, trace_debug_mode, compression);
    }
 
    chain::bytes get_log_entry(block_num_type block_num);
@@ -215,10 +239,15 @@ class state_history_traces_log : public state_history_log {
 
 class state_history_chain_state_log : public state_history_log {
  public:
+   boost::asio::io_context* thread_pool = nullptr; ///< serializes the tables of the deltas in parallel when set
+
    state_history_chain_state_log(const state_history_config& conf);
 
    chain::bytes get_log_entry(block_num_type block_num);
 
+   /// @return the zlib compressed deltas as they are stored in the log
+   chain::bytes get_compressed_log_entry(block_num_type block_num);
+
    void store(const chain::combined_database& db, const chain::block_state_ptr& block_state);
 };
 
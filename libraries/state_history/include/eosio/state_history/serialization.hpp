@@ -773,4 +773,19 @@ ST& operator<<(ST& ds, const eosio::state_history::get_blocks_result_v2& obj) {
    return ds;
 }
 
+template <typename ST>
+ST& operator<<(ST& ds, const eosio::state_history::get_blocks_batch_result_v0& obj) {
+   fc::raw::pack(ds, obj.results);
+   return ds;
+}
+
+template <typename ST>
+ST& operator<<(ST& ds, const eosio::state_history::state_snapshot_result_v0& obj) {
+   fc::raw::pack(ds, obj.head);
+   fc::raw::pack(ds, obj.last_irreversible);
+   fc::raw::pack(ds, obj.this_block);
+   fc::raw::pack(ds, obj.deltas);
+   return ds;
+}
+
 } // namespace fc
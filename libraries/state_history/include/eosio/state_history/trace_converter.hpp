@@ -181,14 +181,16 @@ struct trace_pruner {
 
 template <typename OSTREAM>
 void pack(OSTREAM&& strm, const chainbase::database& db, bool trace_debug_mode,
-          const std::vector<augmented_transaction_trace>& traces, compression_type compression) {
+          const std::vector<augmented_transaction_trace>& traces, compression_type compression,
+          int compression_level = bio::zlib::default_compression) {
 
    // In version 1 of SHiP traces log disk format, it log entry consists of 3 parts.
    //  1. a zlib compressed unprunable section contains the serialization of the vector of traces excluding
    //     the prunable_data data (i.e. signatures and context free data)
    //  2. an uint8_t tag indicating the compression mechanism for the context free data inside the prunable section.
    //  3. a prunable section contains the serialization of the vector of ondisk_prunable_data_t.
-   zlib_pack(strm, make_history_context_wrapper(db, trace_receipt_context{.debug_mode = trace_debug_mode}, traces));
+   zlib_pack(strm, make_history_context_wrapper(db, trace_receipt_context{.debug_mode = trace_debug_mode}, traces),
+             compression_level);
    fc::raw::pack(strm, static_cast<uint8_t>(compression));
    const auto pos               = strm.tellp();
    size_t     size_with_padding = 0;
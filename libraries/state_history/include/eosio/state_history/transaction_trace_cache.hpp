@@ -1,7 +1,11 @@
 #pragma once
 
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/strand.hpp>
 #include <eosio/chain/block_state.hpp>
+#include <eosio/state_history/trace_converter.hpp>
 #include <eosio/state_history/types.hpp>
+#include <exception>
 
 namespace eosio {
 namespace state_history {
@@ -21,5 +25,72 @@ struct transaction_trace_cache {
    void clear();
 };
 
+/// Serializes the traces of the pending block as they arrive into a buffer which is reused from block to block, so
+/// the traces are released right away and only their concatenation is left for the end of the block.
+class packed_trace_cache {
+ public:
+   /// the capacity the buffer keeps between blocks, a larger buffer is released after its block
+   static constexpr size_t max_reserved_bytes = 64 * 1024 * 1024;
+
+   /// serialize the traces on a strand of thread_pool instead of the thread adding them
+   void set_thread_pool(boost::asio::io_context& thread_pool) { strand.emplace(thread_pool); }
+
+   void add_transaction(const chainbase::database& db, const transaction_trace_ptr& trace,
+                        const packed_transaction_ptr& transaction, bool debug_mode, compression_type compression);
+
+   /// writes the traces of block_state in the format of trace_converter::pack() and clears the cache
+   template <typename STREAM>
+   void pack(STREAM& strm, const block_state_ptr& block_state, compression_type compression,
+             int compression_level = bio::zlib::default_compression) {
+      const auto traces = prepare_traces(block_state);
+
+      if (traces.empty()) {
+         fc::raw::pack(strm, uint32_t(0));
+      } else {
+         length_writer<STREAM>                     len_writer(strm);
+         fc::datastream<bio::filtering_ostreambuf> compressed_strm(
+             bio::zlib_compressor(bio::zlib_params(compression_level)) | fc::to_sink(strm));
+         fc::raw::pack(compressed_strm, fc::unsigned_int(traces.size()));
+         for (auto* t : traces)
+            compressed_strm.write(buffer.data() + t->trace_pos, t->trace_size);
+      }
+
+      fc::raw::pack(strm, static_cast<uint8_t>(compression));
+      const auto pos               = strm.tellp();
+      size_t     size_with_padding = 0;
+      for (auto* t : traces) {
+         strm.write(buffer.data() + t->prunable_pos, t->prunable_size);
+         size_with_padding += t->prunable_size_with_padding;
+      }
+      strm.seekp(pos + size_with_padding);
+      reset();
+   }
+
+   void clear();
+
+ private:
+   /// the location of a serialized trace and its prunable data in buffer
+   struct packed_trace {
+      size_t trace_pos                  = 0;
+      size_t trace_size                 = 0;
+      size_t prunable_pos               = 0;
+      size_t prunable_size              = 0;
+      size_t prunable_size_with_padding = 0;
+   };
+
+   /// waits for the pending serializations, @return the traces of block_state in the order they are stored
+   std::vector<const packed_trace*> prepare_traces(const block_state_ptr& block_state);
+
+   void serialize(const chainbase::database& db, const transaction_trace_ptr& trace,
+                  const packed_transaction_ptr& transaction, bool debug_mode, compression_type compression);
+   void reset();
+
+   std::optional<boost::asio::io_context::strand> strand;
+   std::vector<char>                              buffer;
+   std::map<transaction_id_type, packed_trace>    cached_traces;
+   std::optional<packed_trace>                    onblock_trace;
+   std::exception_ptr                             error; ///< the first failed serialization of the block
+};
+
 } // namespace state_history
 } // namespace eosio
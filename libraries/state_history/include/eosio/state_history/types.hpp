@@ -139,6 +139,46 @@ struct get_blocks_request_v1 : get_blocks_request_v0 {
    using response_type = get_blocks_result_v2;
 };
 
+struct get_blocks_request_v2 : get_blocks_request_v1 {
+   bool compressed_deltas = false; ///< send the deltas as the zlib stream stored in the log, without decompressing it
+   using response_type    = get_blocks_result_v2;
+};
+
+/// matches the actions of account, or only its action named action if it is not empty
+struct action_filter {
+   chain::name account;
+   chain::name action;
+};
+
+/// matches the rows of the contract tables of code, or only of its table named table if it is not empty
+struct table_filter {
+   chain::name code;
+   chain::name table;
+};
+
+struct get_blocks_request_v3 : get_blocks_request_v2 {
+   /// if not empty, only the traces of the transactions with an action matching one of the filters are sent
+   std::vector<action_filter> action_filters;
+   /// if not empty, only the rows of the contract tables (contract_table, contract_row, contract_index* and key_value)
+   /// matching one of the filters are sent in the deltas; the rows of the other tables are not sent
+   std::vector<table_filter> table_filters;
+   using response_type = get_blocks_result_v2;
+};
+
+struct get_blocks_request_v4 : get_blocks_request_v3 {
+   /// if not 0, the results are sent in get_blocks_batch_result_v0 messages of about this many bytes, each message
+   /// counts as one message in flight
+   uint32_t max_batch_bytes = 0;
+   using response_type      = get_blocks_result_v2;
+};
+
+struct get_blocks_request_v5 : get_blocks_request_v4 {
+   /// if true, a state_snapshot_result_v0 with all the tables at the next accepted block is sent first and the blocks
+   /// are sent from the following block on; start_block_num and have_positions are ignored
+   bool fetch_state_snapshot = false;
+   using response_type       = get_blocks_result_v2;
+};
+
 struct get_blocks_ack_request_v0 {
    uint32_t num_messages = 0;
 };
@@ -153,7 +193,7 @@ struct get_blocks_result_v0 {
    std::optional<bytes>          deltas;
 };
 
-using state_request = std::variant<get_status_request_v0, get_blocks_request_v0, get_blocks_ack_request_v0, get_blocks_request_v1>;
+using state_request = std::variant<get_status_request_v0, get_blocks_request_v0, get_blocks_ack_request_v0, get_blocks_request_v1, get_blocks_request_v2, get_blocks_request_v3, get_blocks_request_v4, get_blocks_request_v5>;
 
 struct account_auth_sequence {
    uint64_t account  = {};
@@ -305,7 +345,20 @@ struct get_blocks_result_v2 {
 };
 
 
-using state_result = std::variant<get_status_result_v0, get_blocks_result_v0, get_blocks_result_v1, get_blocks_result_v2>;
+struct get_blocks_batch_result_v0 {
+   std::vector<get_blocks_result_v2> results;
+};
+
+/// the full state at this_block, packed as the deltas of get_blocks_result_v2
+struct state_snapshot_result_v0 {
+   block_position                   head;
+   block_position                   last_irreversible;
+   block_position                   this_block;
+   opaque<std::vector<table_delta>> deltas;
+};
+
+using state_result = std::variant<get_status_result_v0, get_blocks_result_v0, get_blocks_result_v1, get_blocks_result_v2,
+                                  get_blocks_batch_result_v0, state_snapshot_result_v0>;
 
 } // namespace state_history
 } // namespace eosio
@@ -317,6 +370,12 @@ FC_REFLECT_EMPTY(eosio::state_history::get_status_request_v0);
 FC_REFLECT(eosio::state_history::get_status_result_v0, (head)(last_irreversible)(trace_begin_block)(trace_end_block)(chain_state_begin_block)(chain_state_end_block)(chain_id));
 FC_REFLECT(eosio::state_history::get_blocks_request_v0, (start_block_num)(end_block_num)(max_messages_in_flight)(have_positions)(irreversible_only)(fetch_block)(fetch_traces)(fetch_deltas));
 FC_REFLECT_DERIVED(eosio::state_history::get_blocks_request_v1, (eosio::state_history::get_blocks_request_v0), (fetch_block_header));
+FC_REFLECT_DERIVED(eosio::state_history::get_blocks_request_v2, (eosio::state_history::get_blocks_request_v1), (compressed_deltas));
+FC_REFLECT(eosio::state_history::action_filter, (account)(action));
+FC_REFLECT(eosio::state_history::table_filter, (code)(table));
+FC_REFLECT_DERIVED(eosio::state_history::get_blocks_request_v3, (eosio::state_history::get_blocks_request_v2), (action_filters)(table_filters));
+FC_REFLECT_DERIVED(eosio::state_history::get_blocks_request_v4, (eosio::state_history::get_blocks_request_v3), (max_batch_bytes));
+FC_REFLECT_DERIVED(eosio::state_history::get_blocks_request_v5, (eosio::state_history::get_blocks_request_v4), (fetch_state_snapshot));
 FC_REFLECT(eosio::state_history::get_blocks_ack_request_v0, (num_messages));
 
 FC_REFLECT(eosio::state_history::account_auth_sequence, (account)(sequence));
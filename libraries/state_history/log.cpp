@@ -38,9 +38,11 @@ void state_history_log_data::construct_index(const fc::path& index_file_name) co
 
 state_history_log::state_history_log(const char* const name, const state_history_config& config)
     : name(name) {
+   catalog.remote_archive = config.remote_archive;
    catalog.open(config.log_dir, config.retained_dir, config.archive_dir, name);
    catalog.max_retained_files = config.max_retained_files;
    this->stride               = config.stride;
+   this->compression_level    = config.compression_level;
    open_log(config.log_dir / (std::string(name) + ".log"));
    open_index(config.log_dir / (std::string(name) + ".index"));
 }
@@ -69,8 +71,9 @@ void state_history_log::get_entry_header(state_history_log::block_num_type block
 }
 
 std::optional<chain::block_id_type> state_history_log::get_block_id(state_history_log::block_num_type block_num) {
+   std::lock_guard g(mtx);
    auto result = catalog.id_for_block(block_num);
-   if (!result && block_num >= _begin_block && block_num < _end_block) {
+   if (!result && in_log(block_num)) {
       state_history_log_header header;
       get_entry_header(block_num, header);
       return header.block_id;
@@ -103,10 +106,45 @@ bool state_history_log::get_last_block(uint64_t size) {
    return true;
 }
 
+// returns the number of leading entries of the log which the existing index still points to and the position after
+// the last of them, so that recovery only needs to scan the tail of the log
+std::pair<uint32_t, uint64_t> state_history_log::last_indexed_entry(const bfs::path& index_filename, uint64_t size) {
+   if (!bfs::exists(index_filename))
+      return {0, 0};
+   fc::cfile old_index;
+   old_index.set_file_path(index_filename);
+   old_index.open("rb");
+   for (uint64_t i = bfs::file_size(index_filename) / sizeof(uint64_t); i > 0; --i) {
+      uint64_t pos;
+      old_index.seek((i - 1) * sizeof(pos));
+      old_index.read((char*)&pos, sizeof(pos));
+
+      state_history_log_header header;
+      if (pos + state_history_log_header_serial_size > size)
+         continue;
+      read_log.seek(pos);
+      read_header(header, false);
+      uint64_t suffix;
+      if (!is_ship(header.magic) || !is_ship_supported_version(header.magic) || header.payload_size > size ||
+          pos + state_history_log_header_serial_size + header.payload_size + sizeof(suffix) > size ||
+          chain::block_header::num_from_id(header.block_id) != _begin_block + i - 1)
+         continue;
+      read_log.seek(pos + state_history_log_header_serial_size + header.payload_size);
+      read_log.read((char*)&suffix, sizeof(suffix));
+      if (suffix == pos)
+         return {i, pos + state_history_log_header_serial_size + header.payload_size + sizeof(suffix)};
+   }
+   return {0, 0};
+}
+
 void state_history_log::recover_blocks(uint64_t size) {
    ilog("recover ${name}.log", ("name", name));
-   uint64_t pos       = 0;
-   uint32_t num_found = 0;
+   const auto index_filename  = bfs::path(read_log.get_file_path()).replace_extension("index");
+   auto [num_found, pos]      = last_indexed_entry(index_filename, size);
+   const uint32_t num_indexed = num_found;
+   std::vector<uint64_t> positions;
+   if (num_indexed)
+      ilog("${name}.index is valid for ${n} blocks, scanning the rest of ${name}.log", ("name", name)("n", num_indexed));
    while (true) {
       state_history_log_header header;
       if (pos + state_history_log_header_serial_size > size)
@@ -124,6 +162,7 @@ void state_history_log::recover_blocks(uint64_t size) {
       read_log.read((char*)&suffix, sizeof(suffix));
       if (suffix != pos)
          break;
+      positions.push_back(pos);
       pos = pos + state_history_log_header_serial_size + header.payload_size + sizeof(suffix);
       if (!(++num_found % 10000)) {
          dlog("${num_found} blocks found, log pos = ${pos}", ("num_found", num_found)("pos", pos));
@@ -133,6 +172,16 @@ void state_history_log::recover_blocks(uint64_t size) {
    boost::filesystem::resize_file(read_log.get_file_path(), pos);
    read_log.flush();
    EOS_ASSERT(get_last_block(pos), chain::state_history_exception, "recover ${name}.log failed", ("name", name));
+
+   // keep the valid part of the index and append the positions of the tail, open_index() then finds it complete
+   if (num_indexed) {
+      boost::filesystem::resize_file(index_filename, num_indexed * sizeof(uint64_t));
+      fc::cfile new_index;
+      new_index.set_file_path(index_filename);
+      new_index.open("a+b");
+      for (auto p : positions)
+         new_index.write((const char*)&p, sizeof(p));
+   }
 }
 
 void state_history_log::open_log(bfs::path log_filename) {
@@ -324,12 +373,13 @@ chain::bytes state_history_traces_log::get_log_entry(block_num_type block_num) {
       }
    };
 
+   std::lock_guard g(mtx);
    auto [ds, version] = catalog.ro_stream_for_block(block_num);
    if (ds.remaining()) {
       return get_traces_bin(ds, version, ds.remaining());
    }
 
-   if (block_num < begin_block() || block_num >= end_block())
+   if (!in_log(block_num))
       return {};
    state_history_log_header header;
    get_entry_header(block_num, header);
@@ -339,6 +389,7 @@ chain::bytes state_history_traces_log::get_log_entry(block_num_type block_num) {
 
 void state_history_traces_log::prune_transactions(state_history_log::block_num_type        block_num,
                                                   std::vector<chain::transaction_id_type>& ids) {
+   std::lock_guard g(mtx);
    auto [ds, version] = catalog.rw_stream_for_block(block_num);
 
    if (ds.remaining()) {
@@ -348,7 +399,7 @@ void state_history_traces_log::prune_transactions(state_history_log::block_num_t
       return;
    }
 
-   if (block_num < begin_block() || block_num >= end_block())
+   if (!in_log(block_num))
       return;
    state_history_log_header header;
    get_entry_header(block_num, header);
@@ -362,11 +413,9 @@ void state_history_traces_log::prune_transactions(state_history_log::block_num_t
 void state_history_traces_log::store(const chainbase::database& db, const chain::block_state_ptr& block_state) {
 
    state_history_log_header header{.magic = ship_magic(ship_current_version), .block_id = block_state->id};
-   auto                     trace = cache.prepare_traces(block_state);
 
-   this->write_entry(header, block_state->block->previous, [&](auto& stream) {
-      state_history::trace_converter::pack(stream, db, trace_debug_mode, trace, compression);
-   });
+   this->write_entry(header, block_state->block->previous,
+                     [&](auto& stream) { cache.pack(stream, block_state, compression, compression_level); });
 }
 
 bool state_history_traces_log::exists(bfs::path state_history_dir) {
@@ -379,18 +428,34 @@ state_history_chain_state_log::state_history_chain_state_log(const state_history
 
 chain::bytes state_history_chain_state_log::get_log_entry(block_num_type block_num) {
 
+   std::lock_guard g(mtx);
    auto [ds, _] = catalog.ro_stream_for_block(block_num);
    if (ds.remaining()) {
       return state_history::zlib_decompress(ds);
    }
 
-   if (block_num < begin_block() || block_num >= end_block())
+   if (!in_log(block_num))
       return {};
    state_history_log_header header;
    get_entry_header(block_num, header);
    return state_history::zlib_decompress(read_log);
 }
 
+chain::bytes state_history_chain_state_log::get_compressed_log_entry(block_num_type block_num) {
+
+   std::lock_guard g(mtx);
+   auto [ds, _] = catalog.ro_stream_for_block(block_num);
+   if (ds.remaining()) {
+      return state_history::zlib_compressed_bytes(ds);
+   }
+
+   if (!in_log(block_num))
+      return {};
+   state_history_log_header header;
+   get_entry_header(block_num, header);
+   return state_history::zlib_compressed_bytes(read_log);
+}
+
 void state_history_chain_state_log::store(const chain::combined_database& db,
                                           const chain::block_state_ptr&   block_state) {
    bool fresh = this->begin_block() == this->end_block();
@@ -398,10 +463,11 @@ void state_history_chain_state_log::store(const chain::combined_database& db,
       ilog("Placing initial state in block ${n}", ("n", block_state->block->block_num()));
 
    using namespace state_history;
-   std::vector<table_delta> deltas = create_deltas(db, fresh);
+   std::vector<table_delta> deltas = create_deltas(db, fresh, thread_pool);
    state_history_log_header header{.magic = ship_magic(ship_current_version), .block_id = block_state->id};
 
-   this->write_entry(header, block_state->block->previous, [&deltas](auto& stream) { zlib_pack(stream, deltas); });
+   this->write_entry(header, block_state->block->previous,
+                     [&deltas, this](auto& stream) { zlib_pack(stream, deltas, compression_level); });
 }
 
 } // namespace eosio
@@ -1,4 +1,6 @@
 #include "eosio/state_history/transaction_trace_cache.hpp"
+#include <cstring>
+#include <future>
 
 namespace eosio {
 namespace state_history {
@@ -56,4 +58,116 @@ void transaction_trace_cache::clear() {
    this->onblock_trace.reset();
 }
 
+namespace {
+/// a stream over a std::vector<char> which grows it as needed, so its capacity is reused
+struct buffer_stream {
+   std::vector<char>& buffer;
+   size_t             pos;
+
+   size_t tellp() const { return pos; }
+   void   seekp(size_t p) { pos = p; }
+   bool   write(const char* data, size_t size) {
+      if (pos + size > buffer.size())
+         buffer.resize(pos + size);
+      memcpy(buffer.data() + pos, data, size);
+      pos += size;
+      return true;
+   }
+   bool put(char c) { return write(&c, 1); }
+};
+} // namespace
+
+void packed_trace_cache::add_transaction(const chainbase::database& db, const transaction_trace_ptr& trace,
+                                         const packed_transaction_ptr& transaction, bool debug_mode,
+                                         compression_type compression) {
+   if (!trace->receipt)
+      return;
+   if (strand)
+      boost::asio::post(*strand, [this, &db, trace, transaction, debug_mode, compression]() {
+         serialize(db, trace, transaction, debug_mode, compression);
+      });
+   else
+      serialize(db, trace, transaction, debug_mode, compression);
+}
+
+void packed_trace_cache::serialize(const chainbase::database& db, const transaction_trace_ptr& trace,
+                                   const packed_transaction_ptr& transaction, bool debug_mode,
+                                   compression_type compression) {
+   if (error)
+      return;
+   try {
+      augmented_transaction_trace augmented{trace, transaction};
+      packed_trace                result;
+      buffer_stream               strm{buffer, buffer.size()};
+
+      result.trace_pos = strm.tellp();
+      fc::raw::pack(strm, make_history_context_wrapper(db, trace_receipt_context{.debug_mode = debug_mode}, augmented));
+      result.trace_size = strm.tellp() - result.trace_pos;
+
+      result.prunable_pos = strm.tellp();
+      trace_converter::for_each_packed_transaction(augmented, [&](const chain::packed_transaction& pt) {
+         result.prunable_size_with_padding += trace_converter::pack(strm, pt.get_prunable_data(), compression);
+      });
+      result.prunable_size = strm.tellp() - result.prunable_pos;
+
+      if (is_onblock(trace))
+         onblock_trace = result;
+      else if (trace->failed_dtrx_trace)
+         cached_traces[trace->failed_dtrx_trace->id] = result;
+      else
+         cached_traces[trace->id] = result;
+   } catch (...) {
+      error = std::current_exception();
+   }
+}
+
+std::vector<const packed_trace_cache::packed_trace*>
+packed_trace_cache::prepare_traces(const block_state_ptr& block_state) {
+   if (strand) {
+      std::promise<void> done;
+      boost::asio::post(*strand, [&done]() { done.set_value(); });
+      done.get_future().wait();
+   }
+   if (error) {
+      auto e = error;
+      reset();
+      std::rethrow_exception(e);
+   }
+
+   std::vector<const packed_trace*> traces;
+   if (onblock_trace)
+      traces.push_back(&*onblock_trace);
+   for (auto& r : block_state->block->transactions) {
+      transaction_id_type id;
+      if (std::holds_alternative<transaction_id_type>(r.trx))
+         id = std::get<transaction_id_type>(r.trx);
+      else
+         id = std::get<packed_transaction>(r.trx).id();
+      auto it = cached_traces.find(id);
+      if (it == cached_traces.end())
+         reset();
+      EOS_ASSERT(it != cached_traces.end(), state_history_exception, "missing trace for transaction ${id}",
+                 ("id", id));
+      traces.push_back(&it->second);
+   }
+   return traces;
+}
+
+void packed_trace_cache::clear() {
+   if (strand)
+      boost::asio::post(*strand, [this]() { reset(); });
+   else
+      reset();
+}
+
+// must not race with serialize(), either on the strand or when no serialization is pending
+void packed_trace_cache::reset() {
+   cached_traces.clear();
+   onblock_trace.reset();
+   error = nullptr;
+   buffer.clear();
+   if (buffer.capacity() > max_reserved_bytes)
+      buffer.shrink_to_fit();
+}
+
 }} // namespace eosio::state_history
@@ -5,10 +5,12 @@
 #include <eosio/chain/account_object.hpp>
 #include <eosio/chain/abi_serializer.hpp>
 #include <eosio/chain/unapplied_transaction_queue.hpp>
+#include <eosio/chain/thread_utils.hpp>
 #include <fc/io/json.hpp>
 #include <boost/test/unit_test.hpp>
 #include <boost/tuple/tuple_io.hpp>
 
+#include <deque>
 #include <iosfwd>
 #include <optional>
 
@@ -152,6 +154,7 @@ namespace eosio { namespace testing {
          static const uint32_t DEFAULT_BILLED_CPU_TIME_US = 2000;
          static const fc::microseconds abi_serializer_max_time;
 
+         base_tester() = default;
          virtual ~base_tester() {};
 
          void              init(const setup_policy policy = setup_policy::full,
@@ -177,6 +180,9 @@ namespace eosio { namespace testing {
          void              open( std::optional<chain_id_type> expected_chain_id = {} );
          bool              is_same_chain( base_tester& other );
 
+         /// the snapshot of the state at the head block, the pending block is aborted first; clones start from it
+         std::string       state_snapshot();
+
          virtual signed_block_ptr produce_block( fc::microseconds skip_time = fc::milliseconds(config::block_interval_ms) ) = 0;
          virtual signed_block_ptr produce_empty_block( fc::microseconds skip_time = fc::milliseconds(config::block_interval_ms) ) = 0;
          virtual signed_block_ptr finish_block() = 0;
@@ -203,6 +209,8 @@ namespace eosio { namespace testing {
 
          transaction_trace_ptr    push_transaction( const packed_transaction& trx, fc::time_point deadline = fc::time_point::maximum(), uint32_t billed_cpu_time_us = DEFAULT_BILLED_CPU_TIME_US );
          transaction_trace_ptr    push_transaction( const signed_transaction& trx, fc::time_point deadline = fc::time_point::maximum(), uint32_t billed_cpu_time_us = DEFAULT_BILLED_CPU_TIME_US, bool no_throw = false );
+         /// push the transactions into the pending block in order, their keys are recovered concurrently beforehand
+         vector<transaction_trace_ptr> push_transactions( const vector<signed_transaction>& trxs, bool no_throw = false );
 
          [[nodiscard]]
          action_result            push_action(action&& cert_act, uint64_t authorizer); // TODO/QUESTION: Is this needed?
@@ -433,6 +441,9 @@ namespace eosio { namespace testing {
          }
 
       protected:
+         /// the state and blocks of the tester are kept in a temporary directory under temp_base
+         explicit base_tester( const fc::path& temp_base ) : tempdir( temp_base ) {}
+
          signed_block_ptr _produce_block( fc::microseconds skip_time, bool skip_pending_trxs );
          signed_block_ptr _produce_block( fc::microseconds skip_time, bool skip_pending_trxs,
                                           bool no_throw, std::vector<transaction_trace_ptr>& traces );
@@ -525,6 +536,46 @@ namespace eosio { namespace testing {
       bool validate() { return true; }
    };
 
+   /**
+    * A tester for large contract test suites which trades the fidelity of the node's storage for speed. The state
+    * is kept in heap mode and the state and blocks directories are placed in a memory backed directory when the
+    * system has one. Instead of executing its setup policy, a fast_tester starts from a snapshot of the state after
+    * the setup policy, taken the first time the policy is used in the process, so the blocks produced by the setup
+    * policy are not in its block log. Use push_transactions to push many transactions into a block at once.
+    */
+   class fast_tester : public base_tester {
+   public:
+      fast_tester(setup_policy policy = setup_policy::full, db_read_mode read_mode = db_read_mode::SPECULATIVE,
+                  std::optional<backing_store_type> config_backing_store = std::optional<backing_store_type>{});
+
+      /// clone of the state of source at its head block, so several scenarios branch from one prepared state.
+      /// The pending block of source is aborted. The clone keeps its state in chainbase whatever the backing store of source.
+      explicit fast_tester(base_tester& source, db_read_mode read_mode = db_read_mode::SPECULATIVE);
+
+      using base_tester::produce_block;
+
+      signed_block_ptr produce_block( fc::microseconds skip_time = fc::milliseconds(config::block_interval_ms) )override {
+         return _produce_block(skip_time, false);
+      }
+
+      signed_block_ptr produce_empty_block( fc::microseconds skip_time = fc::milliseconds(config::block_interval_ms) )override {
+         unapplied_transactions.add_aborted( control->abort_block() );
+         return _produce_block(skip_time, true);
+      }
+
+      signed_block_ptr finish_block()override {
+         return _finish_block();
+      }
+
+      bool validate() { return true; }
+
+      /// the snapshot of the state after policy which fast_testers start from
+      static const std::string& setup_snapshot( setup_policy policy );
+
+   private:
+      void start( const std::string& snapshot, db_read_mode read_mode, std::optional<backing_store_type> config_backing_store );
+   };
+
    class validating_tester : public base_tester {
    public:
       virtual ~validating_tester() {
@@ -540,12 +591,21 @@ namespace eosio { namespace testing {
          } catch( const fc::exception& e ) {
             wdump((e.to_detail_string()));
          }
+         try {
+            wait_for_validation();
+         } catch( const fc::exception& e ) {
+            wdump((e.to_detail_string()));
+         }
       }
       controller::config vcfg;
 
       validating_tester(const flat_set<account_name>& trusted_producers = flat_set<account_name>(),
                         std::optional<backing_store_type> config_backing_store = std::optional<backing_store_type>{});
 
+      /// clone of the state of source at its head block, both the controller and the validating node of the clone start
+      /// from a snapshot of it. The pending block of source is aborted. The clone keeps its state in chainbase.
+      explicit validating_tester(validating_tester& source);
+
       void init_with_trusted_producers(const flat_set<account_name>& trusted_producers,
                                        std::pair<controller::config, genesis_state> config_state,
                                        std::optional<backing_store_type> config_backing_store);
@@ -593,10 +653,19 @@ namespace eosio { namespace testing {
 
       static backing_store_type alternate_type(backing_store_type type);
 
+      /**
+       * When enabled, the produced blocks are pushed to the validating node by a worker thread, so that the test does
+       * not wait for them to be applied twice. Failures of the validating node are rethrown by wait_for_validation,
+       * called by validate; call it before using validating_node directly.
+       */
+      void set_async_validation( bool enable );
+
+      /// wait for the blocks queued to the validating node, rethrows the first failure
+      void wait_for_validation();
+
       signed_block_ptr produce_block( fc::microseconds skip_time = fc::milliseconds(config::block_interval_ms) )override {
          auto sb = _produce_block(skip_time, false);
-         auto bsf = validating_node->create_block_state_future( sb->calculate_id(), sb );
-         validating_node->push_block( bsf, forked_branch_callback{}, trx_meta_cache_lookup{} );
+         validate_produced_block( sb );
 
          return sb;
       }
@@ -606,6 +675,7 @@ namespace eosio { namespace testing {
       }
 
       void validate_push_block(const signed_block_ptr& sb) {
+         wait_for_validation();
          auto bs = validating_node->create_block_state_future( sb->calculate_id(), sb );
          validating_node->push_block( bs, forked_branch_callback{}, trx_meta_cache_lookup{} );
       }
@@ -613,8 +683,7 @@ namespace eosio { namespace testing {
       signed_block_ptr produce_empty_block( fc::microseconds skip_time = fc::milliseconds(config::block_interval_ms) )override {
          unapplied_transactions.add_aborted( control->abort_block() );
          auto sb = _produce_block(skip_time, true);
-         auto bsf = validating_node->create_block_state_future( sb->calculate_id(), sb );
-         validating_node->push_block( bsf, forked_branch_callback{}, trx_meta_cache_lookup{} );
+         validate_produced_block( sb );
 
          return sb;
       }
@@ -624,7 +693,7 @@ namespace eosio { namespace testing {
       }
 
       bool validate() {
-
+        wait_for_validation();
 
         auto hbh = control->head_block_state()->header;
         auto vn_hbh = validating_node->head_block_state()->header;
@@ -646,6 +715,12 @@ namespace eosio { namespace testing {
       unique_ptr<controller>   validating_node;
       uint32_t                 num_blocks_to_producer_before_shutdown = 0;
       bool                     skip_validate = false;
+
+   private:
+      void validate_produced_block( const signed_block_ptr& sb );
+
+      std::deque<std::future<void>>       pending_validations;
+      std::optional<named_thread_pool>    validation_thread; ///< set by set_async_validation, declared last so it stops first
    };
 
    class rocksdb_tester : public tester {
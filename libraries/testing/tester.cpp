@@ -10,6 +10,8 @@
 #include <boost/iostreams/filter/gzip.hpp>
 
 #include <fstream>
+#include <mutex>
+#include <sstream>
 
 #include <contracts.hpp>
 
@@ -492,7 +494,7 @@ namespace eosio { namespace testing {
    void base_tester::produce_min_num_of_blocks_to_spend_time_wo_inactive_prod(const fc::microseconds target_elapsed_time) {
       fc::microseconds elapsed_time;
       while (elapsed_time < target_elapsed_time) {
-         for(uint32_t i = 0; i < control->head_block_state()->active_schedule.producers.size(); i++) {
+         for(uint32_t i = 0; i < control->head_block_state()->active_schedule->producers.size(); i++) {
             const auto time_to_skip = fc::milliseconds(config::producer_repetitions * config::block_interval_ms);
             produce_block(time_to_skip);
             elapsed_time += time_to_skip;
@@ -581,6 +583,33 @@ namespace eosio { namespace testing {
       return r;
    } FC_RETHROW_EXCEPTIONS( warn, "transaction_header: ${header}", ("header", transaction_header(trx.get_transaction()) )) }
 
+   vector<transaction_trace_ptr> base_tester::push_transactions( const vector<signed_transaction>& trxs, bool no_throw )
+   { try {
+      if( !control->is_building_block() )
+         _start_block(control->head_block_time() + fc::microseconds(config::block_interval_us));
+
+      vector<recover_keys_future> futures;
+      futures.reserve( trxs.size() );
+      for( const auto& trx : trxs ) {
+         auto c = fc::raw::pack_size(trx) > 1000 ? packed_transaction::compression_type::zlib : packed_transaction::compression_type::none;
+         auto ptrx = std::make_shared<packed_transaction>( signed_transaction(trx), true, c );
+         futures.emplace_back( transaction_metadata::start_recover_keys( std::move( ptrx ), control->get_thread_pool(),
+                                                                         control->get_chain_id(), fc::microseconds::maximum() ) );
+      }
+
+      vector<transaction_trace_ptr> traces;
+      traces.reserve( trxs.size() );
+      for( auto& f : futures ) {
+         auto r = control->push_transaction( f.get(), fc::time_point::maximum(), DEFAULT_BILLED_CPU_TIME_US, true, 0 );
+         if( !no_throw ) {
+            if( r->except_ptr ) std::rethrow_exception( r->except_ptr );
+            if( r->except ) throw *r->except;
+         }
+         traces.emplace_back( std::move( r ) );
+      }
+      return traces;
+   } FC_CAPTURE_AND_RETHROW( (trxs.size()) ) }
+
    transaction_trace_ptr base_tester::push_transaction( const signed_transaction& trx,
                                                         fc::time_point deadline,
                                                         uint32_t billed_cpu_time_us,
@@ -1209,6 +1238,55 @@ namespace eosio { namespace testing {
       execute_setup_policy(policy);
    }
 
+   namespace {
+      fc::path memory_backed_temp_path() {
+         static const fc::path shm( "/dev/shm" );
+         return fc::is_directory( shm ) ? shm : fc::temp_directory_path();
+      }
+   }
+
+   std::string base_tester::state_snapshot() {
+      unapplied_transactions.add_aborted( control->abort_block() );
+
+      std::ostringstream out;
+      auto writer = std::make_shared<ostream_snapshot_writer>( out );
+      control->write_snapshot( writer );
+      writer->finalize();
+      return out.str();
+   }
+
+   fast_tester::fast_tester(setup_policy policy, db_read_mode read_mode, std::optional<backing_store_type> config_backing_store)
+   : base_tester( memory_backed_temp_path() ) {
+      start( setup_snapshot( policy ), read_mode, config_backing_store );
+   }
+
+   fast_tester::fast_tester(base_tester& source, db_read_mode read_mode)
+   : base_tester( memory_backed_temp_path() ) {
+      start( source.state_snapshot(), read_mode, backing_store_type::CHAINBASE );
+   }
+
+   void fast_tester::start( const std::string& snapshot, db_read_mode read_mode, std::optional<backing_store_type> config_backing_store ) {
+      auto def_conf = default_config(tempdir, std::optional<uint32_t>{}, std::optional<uint32_t>{}, config_backing_store);
+      def_conf.first.read_mode   = read_mode;
+      def_conf.first.db_map_mode = pinnable_mapped_file::map_mode::heap;
+
+      std::istringstream in( snapshot );
+      init( def_conf.first, std::make_shared<istream_snapshot_reader>( in ) );
+   }
+
+   const std::string& fast_tester::setup_snapshot( setup_policy policy ) {
+      static std::mutex                              mtx;
+      static std::map<setup_policy, std::string>     snapshots;
+      std::lock_guard g( mtx );
+      auto itr = snapshots.find( policy );
+      if( itr == snapshots.end() ) {
+         tester setup( policy );
+         setup.produce_block();
+         itr = snapshots.emplace( policy, setup.state_snapshot() ).first;
+      }
+      return itr->second;
+   }
+
    validating_tester::validating_tester(const flat_set<account_name>& trusted_producers,
                                         std::optional<backing_store_type> config_backing_store) {
       auto def_conf = default_config(tempdir, std::optional<uint32_t>{}, std::optional<uint32_t>{}, config_backing_store);
@@ -1251,6 +1329,63 @@ namespace eosio { namespace testing {
       }
    }
 
+   validating_tester::validating_tester(validating_tester& source) {
+      source.wait_for_validation();
+      const auto snapshot = source.state_snapshot();
+
+      auto def_conf = default_config(tempdir, std::optional<uint32_t>{}, std::optional<uint32_t>{}, backing_store_type::CHAINBASE);
+      vcfg = def_conf.first;
+      config_validator(vcfg);
+      vcfg.trusted_producers = source.vcfg.trusted_producers;
+
+      std::istringstream vin( snapshot );
+      auto vsnapshot = std::make_shared<istream_snapshot_reader>( vin );
+      validating_node = std::make_unique<controller>(vcfg, make_protocol_feature_set(), controller::extract_chain_id( *vsnapshot ));
+      vsnapshot->return_to_header();
+      validating_node->add_indices();
+      validating_node->startup( [](){}, []() { return false; }, vsnapshot );
+
+      std::istringstream in( snapshot );
+      init( def_conf.first, std::make_shared<istream_snapshot_reader>( in ) );
+   }
+
+   void validating_tester::set_async_validation( bool enable ) {
+      wait_for_validation();
+      if( enable && !validation_thread )
+         validation_thread.emplace( "valid", 1 );
+      else if( !enable )
+         validation_thread.reset();
+   }
+
+   void validating_tester::wait_for_validation() {
+      std::exception_ptr failure;
+      while( !pending_validations.empty() ) {
+         auto done = std::move( pending_validations.front() );
+         pending_validations.pop_front();
+         try {
+            done.get();
+         } catch( ... ) {
+            if( !failure )
+               failure = std::current_exception();
+         }
+      }
+      if( failure )
+         std::rethrow_exception( failure );
+   }
+
+   void validating_tester::validate_produced_block( const signed_block_ptr& sb ) {
+      auto push = [this, sb]() {
+         auto bsf = validating_node->create_block_state_future( sb->calculate_id(), sb );
+         validating_node->push_block( bsf, forked_branch_callback{}, trx_meta_cache_lookup{} );
+      };
+      if( validation_thread ) {
+         // the single worker thread pushes the blocks in the order they are produced
+         pending_validations.push_back( async_thread_pool( validation_thread->get_executor(), std::move( push ) ) );
+      } else {
+         push();
+      }
+   }
+
    backing_store_type validating_tester::alternate_type(backing_store_type type) {
       return type == backing_store_type::CHAINBASE ? backing_store_type::ROCKSDB : backing_store_type::CHAINBASE;
    }
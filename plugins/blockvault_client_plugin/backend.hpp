@@ -1,8 +1,13 @@
 #pragma once
 #include <eosio/blockvault_client_plugin/blockvault.hpp>
 #include <eosio/chain/block_timestamp.hpp>
+#include <fc/filesystem.hpp>
+#include <fstream>
+#include <istream>
 #include <stdint.h>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace eosio {
 namespace blockvault {
@@ -12,6 +17,25 @@ class backend {
    struct sync_callback {
       virtual void on_snapshot(const char* snapshot_filename) = 0;
       virtual void on_block(std::string_view block)           = 0;
+
+      /// Receives the snapshot while it is read from the backend. By default it is stored in a temporary file for
+      /// on_snapshot(); callbacks which transform the snapshot anyway override it to avoid the extra copy.
+      virtual void on_snapshot_stream(std::istream& snapshot) {
+         fc::temp_file temp_file;
+         {
+            std::ofstream out(temp_file.path().string(), std::ios::out | std::ios::binary);
+            out << snapshot.rdbuf();
+         }
+         on_snapshot(temp_file.path().string().c_str());
+      }
+   };
+
+   struct external_block {
+      uint32_t          block_num;
+      uint32_t          lib;
+      std::vector<char> block_content;
+      std::string       block_id;
+      std::string       previous_block_id;
    };
 
    virtual ~backend() {}
@@ -21,6 +45,15 @@ class backend {
                                           std::string_view previous_block_id)                            = 0;
    virtual bool append_external_block(uint32_t block_num, uint32_t lib, const std::vector<char>& block_content,
                                       std::string_view block_id, std::string_view previous_block_id)     = 0;
+   /// Append several external blocks, in order, returning whether each one was accepted. Backends which can
+   /// store them in a single round-trip override it; by default the blocks are appended one by one.
+   virtual std::vector<bool> append_external_blocks(const std::vector<external_block>& blocks) {
+      std::vector<bool> results;
+      results.reserve(blocks.size());
+      for (const auto& b : blocks)
+         results.push_back(append_external_block(b.block_num, b.lib, b.block_content, b.block_id, b.previous_block_id));
+      return results;
+   }
    virtual bool propose_snapshot(std::pair<uint32_t, uint32_t> watermark, const char* snapshot_filename) = 0;
    virtual void sync(std::string_view block_id, sync_callback& callback)                                 = 0;
 };
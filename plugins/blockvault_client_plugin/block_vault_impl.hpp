@@ -5,7 +5,10 @@
 #include <boost/filesystem.hpp>
 #include <fc/io/datastream.hpp>
 #include <fc/scoped_exit.hpp>
+#include <algorithm>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <thread>
 
 namespace eosio {
@@ -29,6 +32,21 @@ struct transform_callback : backend::sync_callback {
          FC_THROW_EXCEPTION(chain::snapshot_decompress_exception, "Unable to decompress snapshot received from block vault");
    }
 
+   // decompresses the snapshot while it is downloaded, without storing the compressed snapshot first
+   void on_snapshot_stream(std::istream& snapshot) override {
+      fc::temp_file uncompressed_file;
+      bool          decompressed = false;
+      {
+         std::ofstream out(uncompressed_file.path().string(), std::ios::out | std::ios::binary);
+         decompressed = compressor.decompress(snapshot, out);
+      }
+
+      if (decompressed)
+         target.on_snapshot(uncompressed_file.path().string().c_str());
+      else
+         FC_THROW_EXCEPTION(chain::snapshot_decompress_exception, "Unable to decompress snapshot received from block vault");
+   }
+
    void on_block(std::string_view block) override {
       chain::signed_block_ptr     b = std::make_shared<chain::signed_block>();
       fc::datastream<const char*> ds(block.cbegin(), block.size());
@@ -37,26 +55,88 @@ struct transform_callback : backend::sync_callback {
    }
 };
 
+/// Constructed blocks are proposed on their own thread, so they never wait behind the external blocks, which
+/// are appended on a second thread in batches of up to `max_append_batch` blocks per call to the backend.
 template <typename Compressor>
 class block_vault_impl : public block_vault_interface {
+   struct pending_append {
+      uint32_t                  lib;
+      chain::signed_block_ptr   block;
+      std::function<void(bool)> handler;
+   };
+
    Compressor                           compressor;
    std::unique_ptr<blockvault::backend> backend;
 
    boost::asio::io_context                                                  ioc;
    std::thread                                                              thr;
    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work;
+   boost::asio::io_context                                                  append_ioc;
+   std::thread                                                              append_thr;
+   boost::asio::executor_work_guard<boost::asio::io_context::executor_type> append_work;
+   std::mutex                                                               append_mtx;
+   std::deque<pending_append>                                               pending_appends;
+   bool                                                                     append_scheduled = false;
+   const uint32_t                                                           max_append_batch;
    std::atomic<bool>                                                        syncing;
    fc::logger                                                               log;
 
+   void append_pending_blocks() {
+      std::vector<pending_append> batch;
+      while (true) {
+         {
+            std::lock_guard<std::mutex> lk(append_mtx);
+            if (pending_appends.empty()) {
+               append_scheduled = false;
+               return;
+            }
+            const auto n = std::min<size_t>(pending_appends.size(), max_append_batch);
+            batch.assign(std::make_move_iterator(pending_appends.begin()),
+                         std::make_move_iterator(pending_appends.begin() + n));
+            pending_appends.erase(pending_appends.begin(), pending_appends.begin() + n);
+         }
+
+         std::vector<bool> results;
+         try {
+            std::vector<backend::external_block> blocks;
+            blocks.reserve(batch.size());
+            for (const auto& p : batch) {
+               fc::datastream<std::vector<char>> stream;
+               fc::raw::pack(stream, *p.block);
+               eosio::chain::block_id_type block_id = p.block->calculate_id();
+               blocks.push_back({p.block->block_num(), p.lib, stream.storage(),
+                                 std::string{block_id.data(), block_id.data_size()},
+                                 std::string{p.block->previous.data(), p.block->previous.data_size()}});
+            }
+            results = backend->append_external_blocks(blocks);
+         } catch (std::exception& ex) {
+            fc_elog(log, ex.what());
+         }
+
+         results.resize(batch.size(), false);
+         for (size_t i = 0; i < batch.size(); ++i) {
+            fc_dlog(log, "append_external_block(block_num=${bn}, lib=${lib}) returns ${r}",
+                    ("bn", batch[i].block->block_num())("lib", batch[i].lib)("r", bool(results[i])));
+            batch[i].handler(results[i]);
+         }
+         batch.clear();
+      }
+   }
+
  public:
-   block_vault_impl(std::unique_ptr<blockvault::backend>&& be)
+   block_vault_impl(std::unique_ptr<blockvault::backend>&& be, uint32_t max_append_batch = 1)
        : backend(std::move(be))
-       , work(boost::asio::make_work_guard(ioc)) {}
+       , work(boost::asio::make_work_guard(ioc))
+       , append_work(boost::asio::make_work_guard(append_ioc))
+       , max_append_batch(std::max<uint32_t>(max_append_batch, 1)) {}
 
    ~block_vault_impl() {
       if (thr.joinable()) {
          thr.join();
       }
+      if (append_thr.joinable()) {
+         append_thr.join();
+      }
    }
 
    void async_propose_constructed_block(uint32_t lib, chain::signed_block_ptr block,
@@ -88,23 +168,10 @@ class block_vault_impl : public block_vault_interface {
       if (syncing.load())
          return;
 
-      boost::asio::post(ioc, [this, handler, lib, block]() {
-         try {
-            fc::datastream<std::vector<char>> stream;
-            fc::raw::pack(stream, *block);
-            eosio::chain::block_id_type block_id = block->calculate_id();
-
-            bool r = backend->append_external_block(block->block_num(), lib, stream.storage(),
-                                                    {block_id.data(), block_id.data_size()},
-                                                    {block->previous.data(), block->previous.data_size()});
-            fc_dlog(log, "append_external_block(block_num=${bn}, lib=${lib}) returns ${r}",
-                 ("bn", block->block_num())("lib", lib)("r", r));
-            handler(r);
-         } catch (std::exception& ex) {
-            fc_elog(log, ex.what());
-            handler(false);
-         }
-      });
+      std::lock_guard<std::mutex> lk(append_mtx);
+      pending_appends.push_back({lib, std::move(block), std::move(handler)});
+      if (!std::exchange(append_scheduled, true))
+         boost::asio::post(append_ioc, [this]() { append_pending_blocks(); });
    }
 
    bool propose_snapshot(watermark_t watermark, const char* snapshot_filename) override {
@@ -134,9 +201,16 @@ class block_vault_impl : public block_vault_interface {
          fc_ilog(log, "block vault thread started");
          ioc.run();
       });
+      append_thr = std::thread([&log = log, &append_ioc = append_ioc]() {
+         fc_ilog(log, "block vault append thread started");
+         append_ioc.run();
+      });
    }
 
-   void stop() { work.reset(); }
+   void stop() {
+      work.reset();
+      append_work.reset();
+   }
 
    void set_logger_name(const char* logger_name) {
       fc::logger::update( logger_name, log );
@@ -8,20 +8,25 @@
 namespace eosio {
 namespace blockvault {
 
-postgres_backend::postgres_backend(const std::string& options)
-    : conn(options) {
-   
-   try {
-      pqxx::work w(conn);
-      w.exec("CREATE TABLE IF NOT EXISTS BlockData (watermark_bn bigint, watermark_ts bigint, lib bigint, block_num bigint, "
-            "block_id bytea UNIQUE, previous_block_id bytea, block oid, block_size bigint);"
-            "CREATE TABLE IF NOT EXISTS SnapshotData (watermark_bn bigint, watermark_ts bigint, snapshot oid);");
-      w.commit();
-   }
-   catch (const pqxx::integrity_constraint_violation&) {
-      // this would happen when multiple clients try to create the tables at the same time. The first one client should succeed, just ignore it. 
+void postgres_backend::connection_pool::add(std::unique_ptr<pqxx::connection>&& conn) { release(std::move(conn)); }
+
+postgres_backend::connection_pool::lease postgres_backend::connection_pool::acquire() {
+   std::unique_lock<std::mutex> lk(mtx);
+   cv.wait(lk, [this] { return !idle.empty(); });
+   auto conn = std::move(idle.back());
+   idle.pop_back();
+   return lease(*this, std::move(conn));
+}
+
+void postgres_backend::connection_pool::release(std::unique_ptr<pqxx::connection>&& conn) {
+   {
+      std::lock_guard<std::mutex> lk(mtx);
+      idle.push_back(std::move(conn));
    }
-   
+   cv.notify_one();
+}
+
+static void prepare_statements(pqxx::connection& conn) {
    conn.prepare("serialize_transaction", "SET TRANSACTION ISOLATION LEVEL SERIALIZABLE;");
 
    conn.prepare(
@@ -66,37 +71,73 @@ postgres_backend::postgres_backend(const std::string& options)
                 "DELETE FROM SnapshotData WHERE watermark_bn < $1 OR watermark_ts < $2;");
 
    conn.prepare("has_block", "SELECT COUNT(*) FROM BlockData WHERE block_id = $1");
-} // namespace blockvault
+}
+
+postgres_backend::postgres_backend(const std::string& options, uint32_t num_connections) {
+   auto conn = std::make_unique<pqxx::connection>(options);
+
+   try {
+      pqxx::work w(*conn);
+      w.exec("CREATE TABLE IF NOT EXISTS BlockData (watermark_bn bigint, watermark_ts bigint, lib bigint, block_num bigint, "
+            "block_id bytea UNIQUE, previous_block_id bytea, block oid, block_size bigint);"
+            "CREATE TABLE IF NOT EXISTS SnapshotData (watermark_bn bigint, watermark_ts bigint, snapshot oid);");
+      w.commit();
+   }
+   catch (const pqxx::integrity_constraint_violation&) {
+      // this would happen when multiple clients try to create the tables at the same time. The first one client should succeed, just ignore it. 
+   }
+   
+   prepare_statements(*conn);
+   pool.add(std::move(conn));
+
+   for (uint32_t i = 1; i < num_connections; ++i) {
+      conn = std::make_unique<pqxx::connection>(options);
+      prepare_statements(*conn);
+      pool.add(std::move(conn));
+   }
+}
 
 bool postgres_backend::propose_constructed_block(std::pair<uint32_t, uint32_t> watermark, uint32_t lib,
                                                  const std::vector<char>& block_content, std::string_view block_id,
                                                  std::string_view previous_block_id) {
-   try {
-      pqxx::work w(conn);
-      w.exec_prepared0("serialize_transaction");
-      pqxx::largeobjectaccess obj(w);
-      
-      obj.write(nullptr, 0);
-      pqxx::binarystring      block_id_blob(block_id.data(), block_id.size());
-      pqxx::binarystring      previous_block_id_blob(previous_block_id.data(), previous_block_id.size());
-      w.exec_prepared0("insert_constructed_block", watermark.first, watermark.second, lib, block_id_blob,
-                       previous_block_id_blob, obj.id(), block_content.size());
-      auto r = w.exec_prepared("get_block_insertion_result", obj.id());
-      if (!r.empty()) {
-         obj.write(block_content.data(), block_content.size());
-         w.commit();
-         return true;
+   auto conn = pool.acquire();
+
+   // A serialization failure only means a concurrent transaction touched BlockData, possibly the external blocks
+   // appended through another connection of this pool; it says nothing about the block, so try again before
+   // rejecting it.
+   const int max_attempts = 3;
+   for (int attempt = 1; attempt <= max_attempts; ++attempt) {
+      try {
+         pqxx::work w(*conn);
+         w.exec_prepared0("serialize_transaction");
+         pqxx::largeobjectaccess obj(w);
+
+         obj.write(nullptr, 0);
+         pqxx::binarystring      block_id_blob(block_id.data(), block_id.size());
+         pqxx::binarystring      previous_block_id_blob(previous_block_id.data(), previous_block_id.size());
+         w.exec_prepared0("insert_constructed_block", watermark.first, watermark.second, lib, block_id_blob,
+                          previous_block_id_blob, obj.id(), block_content.size());
+         auto r = w.exec_prepared("get_block_insertion_result", obj.id());
+         if (!r.empty()) {
+            obj.write(block_content.data(), block_content.size());
+            w.commit();
+            return true;
+         }
+         return false;
+      } catch (const pqxx::serialization_failure&) {
+      } catch (const pqxx::sql_error&) {
+         return false;
       }
-   } catch (const pqxx::sql_error&) {
-   } 
+   }
 
    return false;
 }
 
 bool postgres_backend::append_external_block(uint32_t block_num, uint32_t lib, const std::vector<char>& block_content,
                                              std::string_view block_id, std::string_view previous_block_id) {
+   auto conn = pool.acquire();
    try {
-      pqxx::work w(conn);
+      pqxx::work w(*conn);
       w.exec_prepared0("serialize_transaction");
       pqxx::largeobjectaccess obj(w);
       obj.write(nullptr, 0);
@@ -115,6 +156,46 @@ bool postgres_backend::append_external_block(uint32_t block_num, uint32_t lib, c
    return false;
 }
 
+std::vector<bool> postgres_backend::append_external_blocks(const std::vector<external_block>& blocks) {
+   if (blocks.size() <= 1)
+      return backend::append_external_blocks(blocks);
+
+   std::vector<bool> results;
+   results.reserve(blocks.size());
+
+   {
+      auto conn = pool.acquire();
+      try {
+         // All the blocks go in one transaction, so the batch costs a single commit. A block which is not accepted
+         // only inserts no row, the large object reserved for it is removed again.
+         pqxx::work w(*conn);
+         w.exec_prepared0("serialize_transaction");
+         for (const auto& b : blocks) {
+            pqxx::largeobject  lo(w);
+            pqxx::binarystring block_id_blob(b.block_id.data(), b.block_id.size());
+            pqxx::binarystring previous_block_id_blob(b.previous_block_id.data(), b.previous_block_id.size());
+            w.exec_prepared0("insert_external_block", b.block_num, b.lib, block_id_blob, previous_block_id_blob,
+                             lo.id(), b.block_content.size());
+            auto r = w.exec_prepared("get_block_insertion_result", lo.id());
+            if (!r.empty()) {
+               pqxx::largeobjectaccess obj(w, lo.id(), std::ios::out | std::ios::binary);
+               obj.write(b.block_content.data(), b.block_content.size());
+            } else {
+               lo.remove(w);
+            }
+            results.push_back(!r.empty());
+         }
+         w.commit();
+         return results;
+      } catch (const pqxx::sql_error&) {
+      }
+   }
+
+   // One of the blocks failed the transaction, e.g. a block_id which is already stored; append them one by one so
+   // that it does not fail the others.
+   return backend::append_external_blocks(blocks);
+}
+
 bool postgres_backend::propose_snapshot(std::pair<uint32_t, uint32_t> watermark, const char* snapshot_filename) {
 
    try {
@@ -122,7 +203,8 @@ bool postgres_backend::propose_snapshot(std::pair<uint32_t, uint32_t> watermark,
 
       infile.open(snapshot_filename, std::ios::in);
 
-      pqxx::work              w(conn);
+      auto                    conn = pool.acquire();
+      pqxx::work              w(*conn);
       w.exec_prepared0("serialize_transaction");
       pqxx::largeobjectaccess obj(w);
       obj.write(nullptr, 0);
@@ -132,13 +214,14 @@ bool postgres_backend::propose_snapshot(std::pair<uint32_t, uint32_t> watermark,
 
       if (!r.empty()) {
 
-         const int chunk_size = 4096;
-         char      chunk[chunk_size];
+         // every write of a large object is a round-trip to the server, so write large chunks
+         const int         chunk_size = 4 * 1024 * 1024;
+         std::vector<char> chunk(chunk_size);
 
          auto sz = chunk_size;
          while (sz == chunk_size) {
-            sz = infile.sgetn(chunk, chunk_size);
-            obj.write(chunk, sz);
+            sz = infile.sgetn(chunk.data(), chunk_size);
+            obj.write(chunk.data(), sz);
          };
 
          w.exec_prepared("delete_outdated_block_lo", watermark.first, watermark.second);
@@ -172,7 +255,8 @@ void retrieve_blocks(backend::sync_callback& callback, pqxx::work& trx, pqxx::re
 }
 
 void postgres_backend::sync(std::string_view previous_block_id, backend::sync_callback& callback) {
-   pqxx::work trx(conn);
+   auto       conn = pool.acquire();
+   pqxx::work trx(*conn);
 
    if (previous_block_id.size()) {
       pqxx::binarystring blob(previous_block_id.data(), previous_block_id.size());
@@ -194,13 +278,9 @@ void postgres_backend::sync(std::string_view previous_block_id, backend::sync_ca
    auto r = trx.exec_prepared("get_latest_snapshot");
 
    if (!r.empty()) {
-      pqxx::largeobject snapshot_obj(r[0][0].as<pqxx::oid>());
-
-      fc::temp_file temp_file;
-      std::string   fname = temp_file.path().string();
-
-      snapshot_obj.to_file(trx, fname.c_str());
-      callback.on_snapshot(fname.c_str());
+      // stream the snapshot to the callback in large reads, each read of a large object is a round-trip to the server
+      pqxx::ilostream snapshot_stream(trx, r[0][0].as<pqxx::oid>(), 4 * 1024 * 1024);
+      callback.on_snapshot_stream(snapshot_stream);
    }
 
    retrieve_blocks(callback, trx, trx.exec_prepared("get_all_blocks"));
@@ -1,5 +1,8 @@
 #pragma once
 #include "backend.hpp"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <pqxx/pqxx>
 
 namespace eosio {
@@ -7,18 +10,50 @@ namespace blockvault {
 
 class postgres_backend : public backend {
  public:
-   pqxx::connection conn;
+   /// A pool of connections to the database, each with the statements of the backend prepared. A call to the backend
+   /// holds one connection for its duration, so calls from different threads do not wait on each other as long as
+   /// there are enough connections.
+   class connection_pool {
+      std::vector<std::unique_ptr<pqxx::connection>> idle;
+      std::mutex                                     mtx;
+      std::condition_variable                        cv;
 
-   postgres_backend(const std::string& options);
+    public:
+      class lease {
+         connection_pool*                  pool;
+         std::unique_ptr<pqxx::connection> conn;
+
+       public:
+         lease(connection_pool& p, std::unique_ptr<pqxx::connection>&& c)
+             : pool(&p)
+             , conn(std::move(c)) {}
+         lease(lease&&) = default;
+         ~lease() {
+            if (conn)
+               pool->release(std::move(conn));
+         }
+
+         pqxx::connection& operator*() { return *conn; }
+      };
+
+      void  add(std::unique_ptr<pqxx::connection>&& conn);
+      lease acquire();
+      void  release(std::unique_ptr<pqxx::connection>&& conn);
+   };
+
+   connection_pool pool;
+
+   postgres_backend(const std::string& options, uint32_t num_connections = 1);
 
    bool propose_constructed_block(std::pair<uint32_t, uint32_t> watermark, uint32_t lib,
                                   const std::vector<char>& block_content, std::string_view block_id,
                                   std::string_view previous_block_id) override;
    bool append_external_block(uint32_t block_num, uint32_t lib, const std::vector<char>& block_content,
                               std::string_view block_id, std::string_view previous_block_id) override;
+   std::vector<bool> append_external_blocks(const std::vector<external_block>& blocks) override;
    bool propose_snapshot(std::pair<uint32_t, uint32_t> watermark, const char* snapshot_filename) override;
    void sync(std::string_view previous_block_id, eosio::blockvault::backend::sync_callback& callback) override;
 };
 
 } // namespace blockvault
-} // namespace eosio
\ No newline at end of file
+} // namespace eosio
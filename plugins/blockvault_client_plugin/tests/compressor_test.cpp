@@ -3,6 +3,7 @@
 #include <fc/filesystem.hpp>
 #include <boost/filesystem.hpp>
 #include <fc/scoped_exit.hpp>
+#include <sstream>
 
 BOOST_AUTO_TEST_CASE(zlib_compressor_test) {
 
@@ -27,3 +28,46 @@ BOOST_AUTO_TEST_CASE(zlib_compressor_test) {
    BOOST_CHECK(std::equal(std::istreambuf_iterator<char>(strm), std::istreambuf_iterator<char>(), content.cbegin(),
                           content.cend()));
 }
+
+BOOST_AUTO_TEST_CASE(zlib_compressor_chunks_test) {
+   // several chunks, the last one partial, compressed on fewer threads than chunks
+   std::vector<char> content(2 * eosio::blockvault::zlib_compressor::chunk_size + 4096);
+   for (size_t i = 0; i < content.size(); ++i)
+      content[i] = static_cast<char>((i / 7) ^ (i % 251));
+
+   eosio::blockvault::zlib_compressor compressor;
+   compressor.num_threads = 2;
+
+   std::stringstream compressed;
+   std::stringstream in(std::string(content.begin(), content.end()));
+   compressor.compress(in, compressed);
+
+   std::stringstream decompressed;
+   BOOST_REQUIRE(compressor.decompress(compressed, decompressed));
+   std::string result = decompressed.str();
+   BOOST_CHECK(std::equal(result.begin(), result.end(), content.begin(), content.end()));
+
+   // a truncated chunk is reported instead of producing a short snapshot
+   std::string       truncated = compressed.str();
+   truncated.resize(truncated.size() - 1);
+   std::stringstream truncated_in(truncated);
+   std::stringstream truncated_out;
+   BOOST_CHECK(!compressor.decompress(truncated_in, truncated_out));
+}
+
+BOOST_AUTO_TEST_CASE(zlib_compressor_legacy_test) {
+   // snapshots compressed as a single zlib stream are still decompressed
+   std::string content = "legacy snapshot content";
+
+   std::string                                                    legacy;
+   boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
+   in.push(boost::iostreams::zlib_compressor());
+   in.push(boost::iostreams::array_source(content.data(), content.size()));
+   boost::iostreams::copy(in, boost::iostreams::back_inserter(legacy));
+
+   eosio::blockvault::zlib_compressor compressor;
+   std::stringstream                  legacy_in(legacy);
+   std::stringstream                  out;
+   BOOST_REQUIRE(compressor.decompress(legacy_in, out));
+   BOOST_CHECK_EQUAL(out.str(), content);
+}
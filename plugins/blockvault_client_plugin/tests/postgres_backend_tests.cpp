@@ -65,6 +65,17 @@ struct backend_test_fixture : backend_reset<Backend> {
                                            mock_block_id{block_num - 1, previous_block_discriminator});
    }
 
+   std::vector<bool> append_external_blocks(std::vector<std::pair<uint32_t, char>> blocks, uint32_t lib) {
+      std::vector<eosio::blockvault::backend::external_block> batch;
+      for (auto [block_num, block_discriminator] : blocks) {
+         std::vector<char> block(64);
+         block[0] = block_discriminator;
+         batch.push_back({block_num, lib, block, std::string(mock_block_id{block_num, block_discriminator}),
+                          std::string(mock_block_id{block_num - 1, 'b'})});
+      }
+      return backend.append_external_blocks(batch);
+   }
+
    bool propose_snapshot(uint32_t watermark_bn, uint32_t watermark_ts) {
       return backend.propose_snapshot({watermark_bn, watermark_ts}, tmp_file.path().string().c_str());
    }
@@ -253,3 +264,22 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(test_sync, T, test_types) {
       BOOST_REQUIRE_NO_THROW(fixture.sync(mock_block_id{14, 'g'}, callback));
    }
 }
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_append_external_blocks, T, test_types) {
+
+   backend_test_fixture<T> fixture;
+
+   BOOST_REQUIRE(fixture.propose_constructed_block(10, 1, 4)); // watermark (10, 1), max_lib 4
+
+   // blocks at or below max_lib are rejected without failing the rest of the batch
+   BOOST_CHECK(fixture.append_external_blocks({{5, 'a'}, {4, 'a'}, {6, 'a'}, {3, 'a'}}, 4) ==
+               std::vector<bool>({true, false, true, false}));
+
+   // an already stored block fails the batch transaction, the others are still appended one by one
+   BOOST_CHECK(fixture.append_external_blocks({{7, 'a'}, {5, 'a'}, {8, 'a'}}, 4) ==
+               std::vector<bool>({true, false, true}));
+
+   mock_sync_callback callback;
+   callback.reverse_expected_block_first_bytes = {'a', 'a', 'a', 'a', 'a'};
+   BOOST_REQUIRE_NO_THROW(fixture.sync(std::optional<mock_block_id>{}, callback));
+}
@@ -1,38 +1,130 @@
 #pragma once
 #include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/filter/zlib.hpp>
 #include <boost/iostreams/filtering_streambuf.hpp>
+#include <algorithm>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 namespace eosio {
 namespace blockvault {
 
+///
+/// Compresses snapshots as a sequence of independently compressed chunks, so that the chunks are compressed and
+/// decompressed on several threads. A compressed file starts with `chunked_magic`, followed by, for each chunk, its
+/// uncompressed and compressed sizes as uint32_t and the compressed bytes. Files compressed as a single zlib stream,
+/// before the chunks were introduced, are still decompressed.
+///
 struct zlib_compressor {
+   static constexpr char   chunked_magic[4] = {'E', 'B', 'V', 'Z'};
+   static constexpr size_t chunk_size       = 4 * 1024 * 1024;
 
-   template <typename Filter>
-   std::string convert(const char* input_filename, const char* output_file_suffix) {
-      using namespace std;
+   uint32_t num_threads = std::max(std::thread::hardware_concurrency(), 1u);
 
-      std::ifstream                                infile(input_filename, ios_base::in | ios_base::binary);
+   template <typename Filter>
+   static std::vector<char> convert_chunk(const std::vector<char>& input) {
+      std::vector<char>                                              output;
       boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
       in.push(Filter());
-      in.push(infile);
+      in.push(boost::iostreams::array_source(input.data(), input.size()));
+      boost::iostreams::copy(in, boost::iostreams::back_inserter(output));
+      return output;
+   }
 
-      std::string out_filename = std::string(input_filename) + output_file_suffix;
-      ofstream    outfile(out_filename, ios_base::out | ios_base::binary);
-      boost::iostreams::copy(in, outfile);
-      return out_filename;
+   template <typename Filter>
+   static std::vector<std::vector<char>> convert_chunks(const std::vector<std::vector<char>>& inputs) {
+      std::vector<std::future<std::vector<char>>> futures;
+      futures.reserve(inputs.size());
+      for (const auto& input : inputs)
+         futures.push_back(std::async(std::launch::async, &convert_chunk<Filter>, std::cref(input)));
+
+      std::vector<std::vector<char>> outputs;
+      outputs.reserve(inputs.size());
+      for (auto& f : futures)
+         outputs.push_back(f.get());
+      return outputs;
    }
 
-   std::string compress(const char* snapshot_filename) {
-      return convert<boost::iostreams::zlib_compressor>(snapshot_filename, ".z");
+   void compress(std::istream& in, std::ostream& out) const {
+      out.write(chunked_magic, sizeof(chunked_magic));
+      while (in) {
+         std::vector<std::vector<char>> chunks;
+         while (chunks.size() < num_threads && in) {
+            std::vector<char> chunk(chunk_size);
+            in.read(chunk.data(), chunk.size());
+            chunk.resize(in.gcount());
+            if (chunk.size())
+               chunks.push_back(std::move(chunk));
+         }
+
+         auto compressed = convert_chunks<boost::iostreams::zlib_compressor>(chunks);
+         for (size_t i = 0; i < chunks.size(); ++i) {
+            const uint32_t sizes[2] = {static_cast<uint32_t>(chunks[i].size()),
+                                       static_cast<uint32_t>(compressed[i].size())};
+            out.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+            out.write(compressed[i].data(), compressed[i].size());
+         }
+      }
+   }
+
+   /// returns false when the input is truncated or not a compressed snapshot
+   bool decompress(std::istream& in, std::ostream& out) const {
+      if (in.peek() != chunked_magic[0]) {
+         boost::iostreams::filtering_streambuf<boost::iostreams::input> legacy;
+         legacy.push(boost::iostreams::zlib_decompressor());
+         legacy.push(in);
+         boost::iostreams::copy(legacy, out);
+         return true;
+      }
+
+      char magic[sizeof(chunked_magic)];
+      if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), chunked_magic))
+         return false;
+
+      while (in.peek() != std::char_traits<char>::eof()) {
+         std::vector<std::vector<char>> chunks;
+         std::vector<uint32_t>          uncompressed_sizes;
+         while (chunks.size() < num_threads && in.peek() != std::char_traits<char>::eof()) {
+            uint32_t sizes[2];
+            if (!in.read(reinterpret_cast<char*>(sizes), sizeof(sizes)))
+               return false;
+            std::vector<char> chunk(sizes[1]);
+            if (!in.read(chunk.data(), chunk.size()))
+               return false;
+            uncompressed_sizes.push_back(sizes[0]);
+            chunks.push_back(std::move(chunk));
+         }
+
+         auto decompressed = convert_chunks<boost::iostreams::zlib_decompressor>(chunks);
+         for (size_t i = 0; i < chunks.size(); ++i) {
+            if (decompressed[i].size() != uncompressed_sizes[i])
+               return false;
+            out.write(decompressed[i].data(), decompressed[i].size());
+         }
+      }
+      return bool(out);
+   }
+
+   std::string compress(const char* snapshot_filename) const {
+      std::ifstream infile(snapshot_filename, std::ios_base::in | std::ios_base::binary);
+      std::string   out_filename = std::string(snapshot_filename) + ".z";
+      std::ofstream outfile(out_filename, std::ios_base::out | std::ios_base::binary);
+      compress(infile, outfile);
+      return out_filename;
    }
 
-   std::string decompress(const char* compressed_file) {
-      return convert<boost::iostreams::zlib_decompressor>(compressed_file, ".bin");
+   std::string decompress(const char* compressed_file) const {
+      std::ifstream infile(compressed_file, std::ios_base::in | std::ios_base::binary);
+      std::string   out_filename = std::string(compressed_file) + ".bin";
+      std::ofstream outfile(out_filename, std::ios_base::out | std::ios_base::binary);
+      return decompress(infile, outfile) ? out_filename : std::string{};
    }
 };
 
 } // namespace blockvault
-} // namespace eosio
\ No newline at end of file
+} // namespace eosio
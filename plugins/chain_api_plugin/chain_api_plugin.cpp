@@ -2,12 +2,119 @@
 #include <eosio/chain/exceptions.hpp>
 
 #include <fc/io/json.hpp>
+#include <fc/crypto/hex.hpp>
+#include <fc/io/raw.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace eosio::chain_api {
+   /// one read only call of /v1/chain/batch, call is the name of the chain API call, e.g. get_account
+   struct batch_call {
+      std::string call;
+      fc::variant params;
+   };
+
+   /// the http response code and body the call would have got as a separate request
+   struct batch_result {
+      uint16_t    code = 200;
+      fc::variant result;
+   };
+
+   using batch_params = std::vector<batch_call>;
+   constexpr size_t max_batch_calls = 100;
+}
+
+FC_REFLECT( eosio::chain_api::batch_call, (call)(params) )
+FC_REFLECT( eosio::chain_api::batch_result, (code)(result) )
 
 namespace eosio {
 
 static appbase::abstract_plugin& _chain_api_plugin = app().register_plugin<chain_api_plugin>();
 
 using namespace eosio;
+using boost::signals2::scoped_connection;
+
+/**
+ * Runs read only calls on the http threads in windows during which the main thread runs nothing else, so that they
+ * read a consistent chain state concurrently.  A window is opened on the main thread once calls are queued, the main
+ * thread takes part in running the calls of the window and returns to block and transaction processing when all of
+ * them are done.
+ */
+class read_window : public std::enable_shared_from_this<read_window> {
+public:
+   explicit read_window(http_plugin& http)
+      : http(http) {}
+
+   /// queue call for the next window, can be called from any thread
+   void execute(std::function<void()> call) {
+      std::lock_guard g(mtx);
+      queued.emplace_back(std::move(call));
+      if( !window_posted ) {
+         window_posted = true;
+         app().post( priority::medium_low, [self=shared_from_this()]() { self->run(); } );
+      }
+   }
+
+private:
+   struct window_calls {
+      std::vector<std::function<void()>> calls;
+      std::atomic<size_t>                next{0};
+      std::mutex                         mtx;
+      std::condition_variable            cv;
+      size_t                             running = 0;
+
+      /// run calls until all have been taken, returns false if none were left
+      bool drain() {
+         {
+            std::lock_guard g(mtx);
+            ++running;
+         }
+         bool ran = false;
+         for( size_t i = next++; i < calls.size(); i = next++ ) {
+            calls[i]();
+            ran = true;
+         }
+         std::lock_guard g(mtx);
+         if( --running == 0 )
+            cv.notify_all();
+         return ran;
+      }
+   };
+
+   void run() {
+      auto window = std::make_shared<window_calls>();
+      {
+         std::lock_guard g(mtx);
+         window->calls.swap(queued);
+         window_posted = false;
+      }
+      const size_t helpers = std::min<size_t>( window->calls.size() - 1, http.get_thread_pool_size() );
+      for( size_t i = 0; i < helpers; ++i ) {
+         http.post_http_thread_pool( [window]() { window->drain(); } );
+      }
+      window->drain();
+      // helpers that start after this point find no calls left and do not read the chain state
+      std::unique_lock g(window->mtx);
+      window->cv.wait( g, [&window]() { return window->running == 0; } );
+   }
+
+   http_plugin&                       http;
+   std::mutex                         mtx;
+   std::vector<std::function<void()>> queued;
+   bool                               window_posted = false;
+};
+
+/// @return handler queueing the calls of call_handler in window
+template<typename Handler>
+auto in_read_window(const std::shared_ptr<read_window>& window, Handler call_handler) {
+   return [window, call_handler]( auto... args ) {
+      window->execute( [call_handler, args...]() mutable {
+         call_handler( std::move(args)... );
+      } );
+   };
+}
 
 class chain_api_plugin_impl {
 public:
@@ -15,14 +122,57 @@ public:
       : db(db) {}
 
    controller& db;
+   std::shared_ptr<read_window> parallel_reads;
+
+   /// read by the cache policy of get_block on the http threads
+   std::atomic<uint32_t>            last_irreversible_block_num{0};
+   std::optional<scoped_connection> accepted_block_connection;
+   std::optional<scoped_connection> irreversible_block_connection;
 };
 
+/// @return cache policy of get_block: blocks from their ID or irreversible blocks from their number do not change
+cache_policy_function make_get_block_cache_policy(const std::atomic<uint32_t>& last_irreversible_block_num) {
+   return [&last_irreversible_block_num](const string& body) {
+      try {
+         const auto params = fc::json::from_string(body).as<chain_apis::read_only::get_block_params>();
+         std::optional<uint64_t> block_num;
+         try {
+            block_num = fc::to_uint64(params.block_num_or_id);
+         } catch( ... ) {}
+         if( !block_num || *block_num <= last_irreversible_block_num.load() )
+            return http_cache_policy::immutable;
+         return http_cache_policy::head;
+      } catch( ... ) {
+         return http_cache_policy::none;
+      }
+   };
+}
+
 
 chain_api_plugin::chain_api_plugin(){}
 chain_api_plugin::~chain_api_plugin(){}
 
-void chain_api_plugin::set_program_options(options_description&, options_description&) {}
-void chain_api_plugin::plugin_initialize(const variables_map&) {}
+void chain_api_plugin::set_program_options(options_description&, options_description& cfg) {
+   cfg.add_options()
+      ("chain-api-parallel-reads", boost::program_options::bool_switch()->default_value(false),
+       "Run the read only calls that only read the chain state, such as get_table_rows, concurrently on the http threads. "
+       "The calls are run in windows during which the main thread does not process blocks or transactions. "
+       "Not supported with backing-store = rocksdb.")
+      ;
+}
+
+void chain_api_plugin::plugin_initialize(const variables_map& options) {
+   try {
+      auto& db = app().get_plugin<chain_plugin>().chain();
+      my.reset(new chain_api_plugin_impl(db));
+      if( options.at( "chain-api-parallel-reads" ).as<bool>() ) {
+         // reads of the rocksdb backing store go through its undo session, which caches what it reads
+         EOS_ASSERT( db.get_config().backing_store != chain::backing_store_type::ROCKSDB, chain::plugin_config_exception,
+                     "chain-api-parallel-reads is not supported with backing-store = rocksdb" );
+         my->parallel_reads = std::make_shared<read_window>( app().get_plugin<http_plugin>() );
+      }
+   } FC_LOG_AND_RETHROW()
+}
 
 struct async_result_visitor : public fc::visitor<fc::variant> {
    template<typename T>
@@ -46,6 +196,21 @@ namespace {
         }
       } EOS_RETHROW_EXCEPTIONS(chain::invalid_http_request, "Unable to parse valid input from POST body");
    }
+
+   chain::packed_transaction_ptr parse_binary_transaction(const std::string& body) {
+      if (body.empty()) {
+         EOS_THROW(chain::invalid_http_request, "A Request body is required");
+      }
+
+      try {
+        try {
+           return std::make_shared<chain::packed_transaction>(
+                 fc::raw::unpack<chain::packed_transaction_v0>(body.data(), body.size()), true );
+        } catch (const chain::chain_exception& e) { // EOS_RETHROW_EXCEPTIONS does not re-type these so, re-code it
+          throw fc::exception(e);
+        }
+      } EOS_RETHROW_EXCEPTIONS(chain::invalid_http_request, "Unable to parse valid packed transaction from POST body");
+   }
 }
 
 #define CALL_WITH_400(api_name, api_handle, api_namespace, call_name, http_response_code, params_type) \
@@ -61,6 +226,47 @@ namespace {
           } \
        }}
 
+// responds with the result packed in the binary format of its ABI type, the fields in the order of the JSON response
+#define CALL_BINARY_WITH_400(api_name, api_handle, api_namespace, call_name, http_response_code, params_type) \
+{std::string("/v1/" #api_name "/" #call_name), \
+   [api_handle](string, string body, url_response_callback cb, url_binary_response_callback binary_cb) mutable { \
+          api_handle.validate(); \
+          try { \
+             auto params = parse_params<api_namespace::call_name ## _params, params_type>(body);\
+             binary_cb(http_response_code, fc::raw::pack( api_handle.call_name( std::move(params) ) )); \
+          } catch (...) { \
+             http_plugin::handle_exception(#api_name, #call_name, body, cb); \
+          } \
+       }}
+
+// responds with the JSON written by the call_name ## _json method of the api, which does not build an fc::variant of the result
+#define CALL_JSON_WITH_400(api_name, api_handle, api_namespace, call_name, http_response_code, params_type) \
+{std::string("/v1/" #api_name "/" #call_name), \
+   [api_handle, max_response_time=_http_plugin.get_max_response_time()](string, string body, url_response_callback cb, url_json_response_callback json_cb) mutable { \
+          api_handle.validate(); \
+          try { \
+             auto params = parse_params<api_namespace::call_name ## _params, params_type>(body);\
+             json_cb(http_response_code, api_handle.call_name ## _json( std::move(params), fc::time_point::now() + max_response_time )); \
+          } catch (...) { \
+             http_plugin::handle_exception(#api_name, #call_name, body, cb); \
+          } \
+       }}
+
+// a call of the batch that only parses its params from the variant of the batch_call
+#define CALL_BATCH_ENTRY(api_handle, api_namespace, call_name) \
+{std::string(#call_name), \
+   [api_handle](const fc::variant& params) mutable -> fc::variant { \
+      api_namespace::call_name ## _params p; \
+      try { \
+         try { \
+            p = params.as<api_namespace::call_name ## _params>(); \
+         } catch (const chain::chain_exception& e) { \
+            throw fc::exception(e); \
+         } \
+      } EOS_RETHROW_EXCEPTIONS(chain::invalid_http_request, "Unable to parse valid input from params of " #call_name); \
+      return fc::variant( api_handle.call_name( std::move(p) ) ); \
+   }}
+
 #define CALL_ASYNC_WITH_400(api_name, api_handle, api_namespace, call_name, call_result, http_response_code, params_type) \
 {std::string("/v1/" #api_name "/" #call_name), \
    [api_handle](string, string body, url_response_callback cb) mutable { \
@@ -85,6 +291,32 @@ namespace {
    }\
 }
 
+// a call whose request body is a packed_transaction_v0 in its binary format, which skips the JSON parsing and the ABI
+// encoding of the actions
+#define CALL_ASYNC_BINARY_TRANSACTION(api_name, api_handle, api_namespace, call_name, call_result, http_response_code) \
+{std::string("/v1/" #api_name "/" #call_name), \
+   [api_handle](string, string body, url_response_callback cb) mutable { \
+      api_handle.validate(); \
+      try { \
+         auto trx = parse_binary_transaction(body);\
+         api_handle.call_name( std::move(trx),\
+            [cb, body](const std::variant<fc::exception_ptr, call_result>& result){\
+               if (std::holds_alternative<fc::exception_ptr>(result)) {\
+                  try {\
+                     std::get<fc::exception_ptr>(result)->dynamic_rethrow_exception();\
+                  } catch (...) {\
+                     http_plugin::handle_exception(#api_name, #call_name, fc::to_hex(body.data(), body.size()), cb);\
+                  }\
+               } else {\
+                  cb(http_response_code, std::visit(async_result_visitor(), result));\
+               }\
+            });\
+      } catch (...) { \
+         http_plugin::handle_exception(#api_name, #call_name, fc::to_hex(body.data(), body.size()), cb); \
+      } \
+   }\
+}
+
 #define CHAIN_RO_CALL(call_name, http_response_code, params_type) CALL_WITH_400(chain, ro_api, chain_apis::read_only, call_name, http_response_code, params_type)
 #define CHAIN_RW_CALL(call_name, http_response_code, params_type) CALL_WITH_400(chain, rw_api, chain_apis::read_write, call_name, http_response_code, params_type)
 #define CHAIN_RO_CALL_ASYNC(call_name, call_result, http_response_code, params_type) CALL_ASYNC_WITH_400(chain, ro_api, chain_apis::read_only, call_name, call_result, http_response_code, params_type)
@@ -92,11 +324,103 @@ namespace {
 
 #define CHAIN_RO_CALL_WITH_400(call_name, http_response_code, params_type) CALL_WITH_400(chain, ro_api, chain_apis::read_only, call_name, http_response_code, params_type)
 
+#define CHAIN_RO_BINARY_CALL(call_name, http_response_code, params_type) CALL_BINARY_WITH_400(chain, ro_api, chain_apis::read_only, call_name, http_response_code, params_type)
+
+#define CHAIN_RO_JSON_CALL(call_name, http_response_code, params_type) CALL_JSON_WITH_400(chain, ro_api, chain_apis::read_only, call_name, http_response_code, params_type)
+
+#define CHAIN_RW_BINARY_TRANSACTION_CALL(call_name, call_result, http_response_code) CALL_ASYNC_BINARY_TRANSACTION(chain, rw_api, chain_apis::read_write, call_name, call_result, http_response_code)
+
+#define CHAIN_RO_BATCH_ENTRY(call_name) CALL_BATCH_ENTRY(ro_api, chain_apis::read_only, call_name)
+
+using batch_calls = std::map<std::string, std::function<fc::variant(const fc::variant&)>>;
+
+/// @return the url_handler of /v1/chain/batch, which runs all its calls in one go on the same chain state
+url_handler make_batch_handler(batch_calls calls) {
+   return [calls=std::make_shared<const batch_calls>(std::move(calls))](string, string body, url_response_callback cb) {
+      try {
+         auto params = parse_params<chain_api::batch_params, http_params_types::params_required>(body);
+         EOS_ASSERT( params.size() <= chain_api::max_batch_calls, chain::invalid_http_request,
+                     "Batch of ${n} calls exceeds the limit of ${m} calls", ("n", params.size())("m", chain_api::max_batch_calls) );
+         std::vector<chain_api::batch_result> results;
+         results.reserve( params.size() );
+         for( const auto& call : params ) {
+            auto& result = results.emplace_back();
+            try {
+               auto itr = calls->find( call.call );
+               EOS_ASSERT( itr != calls->end(), chain::invalid_http_request, "Unknown batch call ${c}", ("c", call.call) );
+               result.result = itr->second( call.params );
+            } catch (...) {
+               // the error response the call would have got on its own
+               http_plugin::handle_exception( "chain", call.call.c_str(), fc::json::to_string( call.params, fc::time_point::maximum() ),
+                                              [&result]( int code, std::optional<fc::variant> response ) {
+                                                 result.code = code;
+                                                 if( response )
+                                                    result.result = std::move( *response );
+                                              } );
+            }
+         }
+         cb( 200, fc::variant( results ) );
+      } catch (...) {
+         http_plugin::handle_exception( "chain", "batch", body, cb );
+      }
+   };
+}
+
+/// @return the resumable handler of get_table_by_scope, whose steps continue the scan from the last more until the
+/// call has limit rows, instead of returning the rows a single call found before its time limit
+url_resumable_handler make_resumable_get_table_by_scope(chain_apis::read_only ro_api) {
+   using chain_apis::read_only;
+   return [ro_api](string, string body, url_response_callback cb) mutable -> url_step {
+      ro_api.validate();
+      try {
+         auto params = std::make_shared<read_only::get_table_by_scope_params>(
+               parse_params<read_only::get_table_by_scope_params, http_params_types::params_required>(body) );
+         auto result = std::make_shared<read_only::get_table_by_scope_result>();
+         return [ro_api, params, result, body, cb](const fc::time_point& deadline, bool last) mutable {
+            try {
+               const bool reverse = params->reverse && *params->reverse;
+               do {
+                  auto p = *params;
+                  p.limit = params->limit - result->rows.size();
+                  auto found = ro_api.get_table_by_scope( p );
+
+                  // the scan resumes from the first table of the scope it stopped in, skip the rows already returned
+                  const auto resumed = result->rows.size();
+                  for( auto& row : found.rows ) {
+                     bool returned = false;
+                     for( size_t i = resumed; i > 0 && result->rows[i - 1].scope == row.scope && !returned; --i )
+                        returned = result->rows[i - 1].table == row.table;
+                     if( !returned )
+                        result->rows.push_back( std::move( row ) );
+                  }
+                  const bool stalled = result->rows.size() == resumed && found.more == result->more;
+                  result->more = std::move( found.more );
+                  if( result->more.empty() || result->rows.size() >= params->limit || stalled ) {
+                     cb( 200, fc::variant( *result ) );
+                     return resume_on::done;
+                  }
+                  (reverse ? params->upper_bound : params->lower_bound) = result->more;
+               } while( fc::time_point::now() < deadline );
+
+               if( last ) {
+                  cb( 200, fc::variant( *result ) );
+                  return resume_on::done;
+               }
+               return resume_on::app_thread;
+            } catch (...) {
+               http_plugin::handle_exception( "chain", "get_table_by_scope", body, cb );
+               return resume_on::done;
+            }
+         };
+      } catch (...) {
+         http_plugin::handle_exception( "chain", "get_table_by_scope", body, cb );
+         return {};
+      }
+   };
+}
 
-   
 void chain_api_plugin::plugin_startup() {
    ilog( "starting chain_api_plugin" );
-   my.reset(new chain_api_plugin_impl(app().get_plugin<chain_plugin>().chain()));
    auto& chain = app().get_plugin<chain_plugin>();
    auto ro_api = chain.get_read_only_api();
    auto rw_api = chain.get_read_write_api();
@@ -104,37 +428,126 @@ void chain_api_plugin::plugin_startup() {
    auto& _http_plugin = app().get_plugin<http_plugin>();
    ro_api.set_shorten_abi_errors( !_http_plugin.verbose_errors() );
 
-   _http_plugin.add_api({
-      CHAIN_RO_CALL(get_info, 200, http_params_types::no_params_required)}, appbase::priority::medium_high);
+   // get_info is answered from info published at each block, no need to queue it on the main thread
+   for( const auto& call : api_description{
+         CHAIN_RO_CALL(get_info, 200, http_params_types::no_params_required)} ) {
+      _http_plugin.add_async_handler( call.first, call.second );
+   }
    _http_plugin.add_api({
       CHAIN_RO_CALL(get_activated_protocol_features, 200, http_params_types::possible_no_params),
       CHAIN_RO_CALL(get_block, 200, http_params_types::params_required),
       CHAIN_RO_CALL(get_block_info, 200, http_params_types::params_required),
       CHAIN_RO_CALL(get_block_header_state, 200, http_params_types::params_required),
+      CHAIN_RO_CALL(get_producer_schedule, 200, http_params_types::no_params_required),
+      CHAIN_RO_CALL(get_block_apply_metrics, 200, http_params_types::no_params_required),
+      CHAIN_RO_CALL(get_scheduled_transactions, 200, http_params_types::params_required),
+      CHAIN_RW_CALL_ASYNC(push_block, chain_apis::read_write::push_block_results, 202, http_params_types::params_required),
+      CHAIN_RW_CALL_ASYNC(push_transaction, chain_apis::read_write::push_transaction_results, 202, http_params_types::params_required),
+      CHAIN_RW_CALL_ASYNC(push_transactions, chain_apis::read_write::push_transactions_results, 202, http_params_types::params_required),
+      CHAIN_RW_CALL_ASYNC(push_transaction_batch, chain_apis::read_write::push_transaction_batch_results, 202, http_params_types::params_required),
+      CHAIN_RW_CALL_ASYNC(send_transaction, chain_apis::read_write::send_transaction_results, 202, http_params_types::params_required),
+      CHAIN_RW_CALL_ASYNC(submit_transaction, chain_apis::read_write::submit_transaction_results, 202, http_params_types::params_required),
+      CHAIN_RW_CALL_ASYNC(get_transaction_status, chain_apis::read_write::get_transaction_status_results, 200, http_params_types::params_required),
+      CHAIN_RW_CALL_ASYNC(compute_transaction, chain_apis::read_write::compute_transaction_results, 200, http_params_types::params_required)
+   });
+   _http_plugin.add_binary_request_api({
+      CHAIN_RW_BINARY_TRANSACTION_CALL(push_transaction, chain_apis::read_write::push_transaction_results, 202),
+      CHAIN_RW_BINARY_TRANSACTION_CALL(send_transaction, chain_apis::read_write::send_transaction_results, 202),
+      CHAIN_RW_BINARY_TRANSACTION_CALL(compute_transaction, chain_apis::read_write::compute_transaction_results, 200)
+   });
+
+   // calls that only read the chain state, with chain-api-parallel-reads they run concurrently in read windows
+   api_description read_api{
       CHAIN_RO_CALL(get_account, 200, http_params_types::params_required),
       CHAIN_RO_CALL(get_code, 200, http_params_types::params_required),
       CHAIN_RO_CALL(get_code_hash, 200, http_params_types::params_required),
       CHAIN_RO_CALL(get_abi, 200, http_params_types::params_required),
       CHAIN_RO_CALL(get_raw_code_and_abi, 200, http_params_types::params_required),
       CHAIN_RO_CALL(get_raw_abi, 200, http_params_types::params_required),
-      CHAIN_RO_CALL(get_table_rows, 200, http_params_types::params_required),
       CHAIN_RO_CALL(get_kv_table_rows, 200, http_params_types::params_required),
       CHAIN_RO_CALL(get_table_by_scope, 200, http_params_types::params_required),
       CHAIN_RO_CALL(get_currency_balance, 200, http_params_types::params_required),
       CHAIN_RO_CALL(get_currency_stats, 200, http_params_types::params_required),
       CHAIN_RO_CALL(get_producers, 200, http_params_types::params_required),
-      CHAIN_RO_CALL(get_producer_schedule, 200, http_params_types::no_params_required),
-      CHAIN_RO_CALL(get_scheduled_transactions, 200, http_params_types::params_required),
       CHAIN_RO_CALL(abi_json_to_bin, 200, http_params_types::params_required),
       CHAIN_RO_CALL(abi_bin_to_json, 200, http_params_types::params_required),
       CHAIN_RO_CALL(get_required_keys, 200, http_params_types::params_required),
-      CHAIN_RO_CALL(get_transaction_id, 200, http_params_types::params_required),
-      CHAIN_RW_CALL_ASYNC(push_block, chain_apis::read_write::push_block_results, 202, http_params_types::params_required),
-      CHAIN_RW_CALL_ASYNC(push_transaction, chain_apis::read_write::push_transaction_results, 202, http_params_types::params_required),
-      CHAIN_RW_CALL_ASYNC(push_transactions, chain_apis::read_write::push_transactions_results, 202, http_params_types::params_required),
-      CHAIN_RW_CALL_ASYNC(send_transaction, chain_apis::read_write::send_transaction_results, 202, http_params_types::params_required)
-   });
-   
+      CHAIN_RO_CALL(get_transaction_id, 200, http_params_types::params_required)
+   };
+
+   // the rows of get_table_rows are written as JSON while they are unpacked
+   const json_api_description read_json_api{
+      CHAIN_RO_JSON_CALL(get_table_rows, 200, http_params_types::params_required)
+   };
+
+   // binary responses for the calls whose results do not hold JSON
+   for( const auto& call : binary_api_description{
+         CHAIN_RO_BINARY_CALL(get_info, 200, http_params_types::no_params_required)} ) {
+      _http_plugin.add_async_binary_handler( call.first, call.second );
+   }
+   const binary_api_description read_binary_api{
+      CHAIN_RO_BINARY_CALL(get_code_hash, 200, http_params_types::params_required),
+      CHAIN_RO_BINARY_CALL(get_raw_code_and_abi, 200, http_params_types::params_required),
+      CHAIN_RO_BINARY_CALL(get_raw_abi, 200, http_params_types::params_required),
+      CHAIN_RO_BINARY_CALL(get_table_by_scope, 200, http_params_types::params_required),
+      CHAIN_RO_BINARY_CALL(get_currency_balance, 200, http_params_types::params_required),
+      CHAIN_RO_BINARY_CALL(get_required_keys, 200, http_params_types::params_required),
+      CHAIN_RO_BINARY_CALL(get_transaction_id, 200, http_params_types::params_required)
+   };
+
+   // all calls of a batch run in the same main thread task or read window
+   read_api.emplace( "/v1/chain/batch", make_batch_handler( batch_calls{
+      CHAIN_RO_BATCH_ENTRY(get_account),
+      CHAIN_RO_BATCH_ENTRY(get_code),
+      CHAIN_RO_BATCH_ENTRY(get_code_hash),
+      CHAIN_RO_BATCH_ENTRY(get_abi),
+      CHAIN_RO_BATCH_ENTRY(get_raw_code_and_abi),
+      CHAIN_RO_BATCH_ENTRY(get_raw_abi),
+      CHAIN_RO_BATCH_ENTRY(get_table_rows),
+      CHAIN_RO_BATCH_ENTRY(get_kv_table_rows),
+      CHAIN_RO_BATCH_ENTRY(get_table_by_scope),
+      CHAIN_RO_BATCH_ENTRY(get_currency_balance),
+      CHAIN_RO_BATCH_ENTRY(get_currency_stats),
+      CHAIN_RO_BATCH_ENTRY(get_producers),
+      CHAIN_RO_BATCH_ENTRY(abi_json_to_bin),
+      CHAIN_RO_BATCH_ENTRY(abi_bin_to_json),
+      CHAIN_RO_BATCH_ENTRY(get_required_keys),
+      CHAIN_RO_BATCH_ENTRY(get_transaction_id)
+   } ) );
+
+   if( my->parallel_reads ) {
+      for( const auto& call : read_api )
+         _http_plugin.add_async_handler( call.first, in_read_window( my->parallel_reads, call.second ) );
+      for( const auto& call : read_json_api )
+         _http_plugin.add_async_json_handler( call.first, in_read_window( my->parallel_reads, call.second ) );
+      for( const auto& call : read_binary_api )
+         _http_plugin.add_async_binary_handler( call.first, in_read_window( my->parallel_reads, call.second ) );
+   } else {
+      // the scan yields to the other tasks of the main thread between its steps
+      read_api.erase( "/v1/chain/get_table_by_scope" );
+      _http_plugin.add_resumable_handler( "/v1/chain/get_table_by_scope", make_resumable_get_table_by_scope( ro_api ) );
+      _http_plugin.add_api( read_api );
+      _http_plugin.add_json_api( read_json_api );
+      _http_plugin.add_binary_api( read_binary_api );
+   }
+
+   // responses that only change with the head block, and blocks that do not change at all, can be served from the
+   // http_plugin response cache
+   for( const char* url : { "/v1/chain/get_info", "/v1/chain/get_abi", "/v1/chain/get_raw_abi", "/v1/chain/get_code",
+                            "/v1/chain/get_code_hash", "/v1/chain/get_raw_code_and_abi", "/v1/chain/get_block_header_state" } ) {
+      _http_plugin.add_cache_policy( url, []( const string& ) { return http_cache_policy::head; } );
+   }
+   _http_plugin.add_cache_policy( "/v1/chain/get_block", make_get_block_cache_policy( my->last_irreversible_block_num ) );
+   // connected after chain_plugin, which publishes the get_info of the block first
+   my->last_irreversible_block_num = my->db.last_irreversible_block_num();
+   my->accepted_block_connection.emplace( my->db.accepted_block.connect( [&_http_plugin]( const chain::block_state_ptr& ) {
+      _http_plugin.invalidate_head_cache();
+   } ) );
+   my->irreversible_block_connection.emplace( my->db.irreversible_block.connect( [this, &_http_plugin]( const chain::block_state_ptr& blk ) {
+      my->last_irreversible_block_num = blk->block_num;
+      _http_plugin.invalidate_head_cache();
+   } ) );
+
    if (chain.account_queries_enabled()) {
       _http_plugin.add_async_api({
          CHAIN_RO_CALL_WITH_400(get_accounts_by_authorizers, 200, http_params_types::params_required),
@@ -142,6 +555,9 @@ void chain_api_plugin::plugin_startup() {
    }
 }
 
-void chain_api_plugin::plugin_shutdown() {}
+void chain_api_plugin::plugin_shutdown() {
+   my->accepted_block_connection.reset();
+   my->irreversible_block_connection.reset();
+}
 
 }
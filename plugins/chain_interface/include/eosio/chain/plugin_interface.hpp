@@ -47,6 +47,8 @@ namespace eosio { namespace chain { namespace plugin_interface {
          using block_sync            = method_decl<chain_plugin_interface, bool(const signed_block_ptr&, const std::optional<block_id_type>&), first_provider_policy>;
          using blockvault_sync       = method_decl<chain_plugin_interface, bool(const signed_block_ptr&, bool), first_provider_policy>;
          using transaction_async     = method_decl<chain_plugin_interface, void(const packed_transaction_ptr&, bool, next_function<transaction_trace_ptr>), first_provider_policy>;
+         /// the transactions of a batch are validated and their keys recovered in parallel, then queued together; nexts[i] is called for trxs[i]
+         using transaction_batch_async = method_decl<chain_plugin_interface, void(const std::vector<packed_transaction_ptr>& trxs, bool, std::vector<next_function<transaction_trace_ptr>> nexts), first_provider_policy>;
       }
    }
 
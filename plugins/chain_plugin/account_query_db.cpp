@@ -3,6 +3,9 @@
 #include <eosio/chain/contract_types.hpp>
 #include <eosio/chain/controller.hpp>
 #include <eosio/chain/permission_object.hpp>
+#include <eosio/chain/thread_utils.hpp>
+
+#include <fc/io/raw.hpp>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/ordered_index.hpp>
@@ -13,6 +16,11 @@
 #include <boost/bimap/multiset_of.hpp>
 #include <boost/bimap/set_of.hpp>
 
+#include <rocksdb/db.h>
+#include <rocksdb/write_batch.h>
+
+#include <atomic>
+#include <mutex>
 #include <shared_mutex>
 
 using namespace eosio;
@@ -124,14 +132,339 @@ namespace std {
 
 }
 
+namespace eosio::chain_apis::detail {
+   /// value of the permission entries of the account_query_store
+   struct stored_permission {
+      uint32_t         last_updated_height = 0;
+      chain::authority auth;
+   };
+
+   /// value of the meta entry of the account_query_store
+   struct stored_meta {
+      fc::sha256           chain_id;
+      chain::block_id_type head_id;
+      bool                 clean = false;
+   };
+}
+
+FC_REFLECT( eosio::chain_apis::detail::stored_permission, (last_updated_height)(auth) )
+FC_REFLECT( eosio::chain_apis::detail::stored_meta, (chain_id)(head_id)(clean) )
+
+namespace eosio::chain_apis::detail {
+   /**
+    * RocksDB copy of the account query indices.  Integers in entry keys are big endian so that RocksDB orders the
+    * entries like the in memory indices:
+    *   'a' actor permission weight owner name -> threshold     authorizing accounts
+    *   'k' packed_key weight owner name       -> threshold     authorizing keys
+    *   'p' owner name                         -> stored_permission
+    *   'u' last_updated_height owner name     -> ''            roll-back support
+    *   'm'                                    -> stored_meta   block the entries are current with
+    *
+    * Writes are queued to a worker thread and applied in order, reads wait for the queued writes.  The WAL is
+    * disabled: the entries are only trusted after a clean close, otherwise they are rebuilt.
+    */
+   class account_query_store {
+   public:
+      /// authorizer entries are followed by weight, owner and name
+      static constexpr size_t authorized_suffix_size = sizeof(chain::weight_type) + 2 * sizeof(uint64_t);
+      static constexpr size_t account_entry_size = 1 + 2 * sizeof(uint64_t) + authorized_suffix_size;
+
+      explicit account_query_store( const boost::filesystem::path& dir )
+      : dir(dir)
+      , worker( "aqdb", 1 )
+      {
+         open();
+      }
+
+      ~account_query_store() {
+         worker.stop();
+      }
+
+      /**
+       * Check if the store holds the entries as of head_id, otherwise clear it.  The store is marked as not current
+       * until it is closed.
+       * @return true if the entries can be used as they are
+       */
+      bool open_current( const fc::sha256& chain_id, const chain::block_id_type& head_id ) {
+         const auto meta = get<stored_meta>( std::string(1, 'm') );
+         const bool current = meta && meta->clean && meta->chain_id == chain_id && meta->head_id == head_id;
+         if( !current ) {
+            db.reset();
+            check( rocksdb::DestroyDB( dir.string(), rocksdb::Options{} ), "destroy" );
+            open();
+         }
+         this->chain_id = chain_id;
+         write_meta( head_id, false );
+         return current;
+      }
+
+      /// wait for the queued writes and mark the entries current with head_id unless a write failed
+      void close( const chain::block_id_type& head_id ) {
+         wait();
+         write_meta( head_id, !failed );
+         check( db->Flush( rocksdb::FlushOptions() ), "flush" );
+      }
+
+      /// queue f to run after the writes queued before it
+      void post( std::function<void()> f ) {
+         auto done = chain::async_thread_pool( worker.get_executor(), [this, f=std::move(f)]() {
+            try {
+               f();
+            } catch( ... ) {
+               fail();
+               try {
+                  throw;
+               } FC_LOG_AND_DROP(("ACCOUNT DB store write ERROR"));
+            }
+         } ).share();
+         std::lock_guard g( mtx );
+         last_write = std::move( done );
+      }
+
+      /// wait for the queued writes
+      void wait() const {
+         std::shared_future<void> done;
+         {
+            std::lock_guard g( mtx );
+            done = last_write;
+         }
+         if( done.valid() )
+            done.wait();
+      }
+
+      /// keep the entries from being trusted after close
+      void fail() {
+         failed = true;
+      }
+
+      void write( rocksdb::WriteBatch& batch ) {
+         check( db->Write( write_options(), &batch ), "write" );
+      }
+
+      void put_permission( rocksdb::WriteBatch& batch, chain::name owner, chain::name name, const stored_permission& sp ) const {
+         const auto value = fc::raw::pack( sp );
+         batch.Put( permission_entry( owner, name ), rocksdb::Slice( value.data(), value.size() ) );
+         batch.Put( height_entry( sp.last_updated_height, owner, name ), rocksdb::Slice() );
+         std::string threshold;
+         append( threshold, sp.auth.threshold );
+         for( const auto& a : sp.auth.accounts ) {
+            batch.Put( account_entry( a.permission, a.weight, owner, name ), threshold );
+         }
+         for( const auto& k : sp.auth.keys ) {
+            batch.Put( key_entry( k.key, k.weight, owner, name ), threshold );
+         }
+      }
+
+      void remove_permission( rocksdb::WriteBatch& batch, chain::name owner, chain::name name, const stored_permission& sp ) const {
+         batch.Delete( permission_entry( owner, name ) );
+         batch.Delete( height_entry( sp.last_updated_height, owner, name ) );
+         for( const auto& a : sp.auth.accounts ) {
+            batch.Delete( account_entry( a.permission, a.weight, owner, name ) );
+         }
+         for( const auto& k : sp.auth.keys ) {
+            batch.Delete( key_entry( k.key, k.weight, owner, name ) );
+         }
+      }
+
+      std::optional<stored_permission> get_permission( chain::name owner, chain::name name ) const {
+         return get<stored_permission>( permission_entry( owner, name ) );
+      }
+
+      /// @return the highest last_updated_height of the permissions, if any
+      std::optional<uint32_t> max_last_updated_height() const {
+         std::unique_ptr<rocksdb::Iterator> itr( db->NewIterator( rocksdb::ReadOptions() ) );
+         itr->SeekForPrev( std::string(1, 'v') );
+         if( !itr->Valid() || itr->key().size() == 0 || itr->key()[0] != 'u' )
+            return {};
+         const char* pos = itr->key().data() + 1;
+         return read<uint32_t>( pos );
+      }
+
+      /// @return owner and name of the permissions last updated at or after height
+      std::vector<std::pair<chain::name, chain::name>> permissions_updated_since( uint32_t height ) const {
+         std::vector<std::pair<chain::name, chain::name>> result;
+         std::unique_ptr<rocksdb::Iterator> itr( db->NewIterator( rocksdb::ReadOptions() ) );
+         std::string start(1, 'u');
+         append( start, height );
+         for( itr->Seek( start ); itr->Valid() && itr->key()[0] == 'u'; itr->Next() ) {
+            const char* pos = itr->key().data() + 1 + sizeof(uint32_t);
+            const auto owner = read<uint64_t>( pos );
+            const auto name = read<uint64_t>( pos );
+            result.emplace_back( chain::name(owner), chain::name(name) );
+         }
+         check( itr->status(), "iterate" );
+         return result;
+      }
+
+      /**
+       * Call f(authorizer, weight, owner, name, threshold) for each authorizing account entry of the actor and
+       * permission of authorizer, all permissions of the actor if the permission is empty
+       */
+      template<typename F>
+      void for_each_account_entry( const chain::permission_level& authorizer, F&& f ) const {
+         std::string prefix(1, 'a');
+         append( prefix, authorizer.actor.to_uint64_t() );
+         if( !authorizer.permission.empty() )
+            append( prefix, authorizer.permission.to_uint64_t() );
+         for_each_entry( prefix, [&f]( const char* pos, size_t size, const char* value ) {
+            if( 1 + size != account_entry_size )
+               return;
+            const auto actor = read<uint64_t>( pos );
+            const auto permission = read<uint64_t>( pos );
+            const auto weight = read<chain::weight_type>( pos );
+            const auto owner = read<uint64_t>( pos );
+            const auto name = read<uint64_t>( pos );
+            f( chain::permission_level{ chain::name(actor), chain::name(permission) }, weight, chain::name(owner), chain::name(name), read<uint32_t>( value ) );
+         } );
+      }
+
+      /// Call f(weight, owner, name, threshold) for each authorizing key entry of key
+      template<typename F>
+      void for_each_key_entry( const chain::public_key_type& key, F&& f ) const {
+         std::string prefix(1, 'k');
+         const auto packed_key = fc::raw::pack( key );
+         prefix.append( packed_key.data(), packed_key.size() );
+         for_each_entry( prefix, [&f, &prefix]( const char* pos, size_t size, const char* value ) {
+            if( size != prefix.size() - 1 + authorized_suffix_size )
+               return;
+            pos += prefix.size() - 1;
+            const auto weight = read<chain::weight_type>( pos );
+            const auto owner = read<uint64_t>( pos );
+            const auto name = read<uint64_t>( pos );
+            f( weight, chain::name(owner), chain::name(name), read<uint32_t>( value ) );
+         } );
+      }
+
+   private:
+      void open() {
+         rocksdb::Options options;
+         options.create_if_missing = true;
+         options.OptimizeLevelStyleCompaction();
+         rocksdb::DB* p = nullptr;
+         check( rocksdb::DB::Open( options, dir.string(), &p ), "open" );
+         db.reset( p );
+      }
+
+      void write_meta( const chain::block_id_type& head_id, bool clean ) {
+         const auto value = fc::raw::pack( stored_meta{ chain_id, head_id, clean } );
+         check( db->Put( write_options(), std::string(1, 'm'), rocksdb::Slice( value.data(), value.size() ) ), "write" );
+      }
+
+      static rocksdb::WriteOptions write_options() {
+         rocksdb::WriteOptions options;
+         options.disableWAL = true;
+         return options;
+      }
+
+      void check( const rocksdb::Status& status, const char* what ) const {
+         EOS_ASSERT( status.ok(), chain::plugin_exception, "account query store ${dir} ${what} failed: ${status}",
+                     ("dir", dir.string())("what", what)("status", status.ToString()) );
+      }
+
+      template<typename T>
+      std::optional<T> get( const std::string& key ) const {
+         rocksdb::PinnableSlice value;
+         const auto status = db->Get( rocksdb::ReadOptions(), db->DefaultColumnFamily(), key, &value );
+         if( status.IsNotFound() )
+            return {};
+         check( status, "read" );
+         return fc::raw::unpack<T>( value.data(), value.size() );
+      }
+
+      /// call f(key after the leading byte, its size, value) for each entry starting with prefix
+      template<typename F>
+      void for_each_entry( const std::string& prefix, F&& f ) const {
+         wait();
+         std::unique_ptr<rocksdb::Iterator> itr( db->NewIterator( rocksdb::ReadOptions() ) );
+         for( itr->Seek( prefix ); itr->Valid() && itr->key().starts_with( prefix ); itr->Next() ) {
+            f( itr->key().data() + 1, itr->key().size() - 1, itr->value().data() );
+         }
+         check( itr->status(), "iterate" );
+      }
+
+      template<typename T>
+      static void append( std::string& key, T v ) {
+         static_assert( std::is_unsigned_v<T> );
+         for( int i = sizeof(T) - 1; i >= 0; --i )
+            key.push_back( static_cast<char>( v >> (i * 8) ) );
+      }
+
+      template<typename T>
+      static T read( const char*& pos ) {
+         static_assert( std::is_unsigned_v<T> );
+         T v = 0;
+         for( size_t i = 0; i < sizeof(T); ++i )
+            v = static_cast<T>( (v << 8) | static_cast<uint8_t>( *pos++ ) );
+         return v;
+      }
+
+      static std::string permission_entry( chain::name owner, chain::name name ) {
+         std::string key(1, 'p');
+         append( key, owner.to_uint64_t() );
+         append( key, name.to_uint64_t() );
+         return key;
+      }
+
+      static std::string height_entry( uint32_t height, chain::name owner, chain::name name ) {
+         std::string key(1, 'u');
+         append( key, height );
+         append( key, owner.to_uint64_t() );
+         append( key, name.to_uint64_t() );
+         return key;
+      }
+
+      static std::string account_entry( const chain::permission_level& authorizer, chain::weight_type weight, chain::name owner, chain::name name ) {
+         std::string key(1, 'a');
+         append( key, authorizer.actor.to_uint64_t() );
+         append( key, authorizer.permission.to_uint64_t() );
+         append( key, weight );
+         append( key, owner.to_uint64_t() );
+         append( key, name.to_uint64_t() );
+         return key;
+      }
+
+      static std::string key_entry( const chain::public_key_type& k, chain::weight_type weight, chain::name owner, chain::name name ) {
+         std::string key(1, 'k');
+         const auto packed_key = fc::raw::pack( k );
+         key.append( packed_key.data(), packed_key.size() );
+         append( key, weight );
+         append( key, owner.to_uint64_t() );
+         append( key, name.to_uint64_t() );
+         return key;
+      }
+
+      const boost::filesystem::path  dir;
+      std::unique_ptr<rocksdb::DB>   db;
+      fc::sha256                     chain_id;
+      chain::named_thread_pool       worker;
+      mutable std::mutex             mtx;         ///< protects last_write
+      std::shared_future<void>       last_write;
+      std::atomic<bool>              failed{false};
+   };
+}
+
 namespace eosio::chain_apis {
+   using detail::account_query_store;
+   using detail::stored_permission;
+
    /**
     * Implementation details of the account query DB
     */
    struct account_query_db_impl {
-      account_query_db_impl(const chain::controller& controller)
+      account_query_db_impl(const chain::controller& controller, const std::optional<boost::filesystem::path>& store_dir)
       :controller(controller)
-      {}
+      {
+         if (store_dir)
+            store = std::make_unique<account_query_store>(*store_dir);
+      }
+
+      ~account_query_db_impl() {
+         if (store) {
+            try {
+               store->close(last_committed_id);
+            } FC_LOG_AND_DROP(("ACCOUNT DB store close ERROR"));
+         }
+      }
 
       /**
        * Build the initial database from the chain controller by extracting the information contained in the
@@ -154,6 +487,17 @@ namespace eosio::chain_apis {
             time_to_block_num.emplace(block_p->timestamp.to_time_point(), block_num);
          }
 
+         if (store) {
+            last_committed_id = controller.head_block_id();
+            if (store->open_current(controller.get_chain_id(), last_committed_id)) {
+               ilog("Reusing account query DB store");
+            } else {
+               build_account_query_store(index);
+            }
+            store_max_height = store->max_last_updated_height();
+            return;
+         }
+
          for (const auto& po : index ) {
             uint32_t last_updated_height = last_updated_time_to_height(po.last_updated);
             const auto& pi = permission_info_index.emplace( permission_info{ po.owner, po.name, last_updated_height, po.auth.threshold } ).first;
@@ -163,6 +507,25 @@ namespace eosio::chain_apis {
          ilog("Finished building account query DB in ${sec}", ("sec", (duration.count() / 1'000'000.0 )));
       }
 
+      /**
+       * Write every permission of the chain state to the empty store
+       */
+      template<typename Index>
+      void build_account_query_store( const Index& index ) {
+         constexpr size_t permissions_per_batch = 100'000;
+         rocksdb::WriteBatch batch;
+         size_t batched = 0;
+         for (const auto& po : index) {
+            store->put_permission(batch, po.owner, po.name, stored_permission{ last_updated_time_to_height(po.last_updated), po.auth.to_authority() });
+            if (++batched == permissions_per_batch) {
+               store->write(batch);
+               batch.Clear();
+               batched = 0;
+            }
+         }
+         store->write(batch);
+      }
+
       /**
        * Add a permission to the bimaps for keys and accounts
        * @param pi - the ephemeral permission info structure being added
@@ -196,8 +559,13 @@ namespace eosio::chain_apis {
       }
 
       bool is_rollback_required( const chain::block_state_ptr& bsp ) const {
-         std::shared_lock read_lock(rw_mutex);
          const auto bnum = bsp->block->block_num();
+         if (store) {
+            // only the main thread writes store_max_height
+            return store_max_height && *store_max_height >= bnum;
+         }
+
+         std::shared_lock read_lock(rw_mutex);
          const auto& index = permission_info_index.get<by_last_updated_height>();
 
          if (index.empty()) {
@@ -239,11 +607,7 @@ namespace eosio::chain_apis {
          auto& index = permission_info_index.get<by_last_updated_height>();
          const auto& permission_by_owner = controller.db().get_index<chain::permission_index>().indices().get<chain::by_owner>();
 
-         // roll back time-map
-         auto time_iter = time_to_block_num.rbegin();
-         while (time_iter != time_to_block_num.rend() && time_iter->second >= bnum) {
-            time_iter = decltype(time_iter){time_to_block_num.erase( std::next(time_iter).base() )};
-         }
+         rollback_time_map(bnum);
 
          auto curr_iter = index.rbegin();
          while (!index.empty()) {
@@ -278,6 +642,85 @@ namespace eosio::chain_apis {
          }
       }
 
+      using permission_set_t = std::set<chain::permission_level>;
+
+      /**
+       * Remove all blocks at or after the given block number from the time map
+       */
+      void rollback_time_map( uint32_t bnum ) {
+         auto time_iter = time_to_block_num.rbegin();
+         while (time_iter != time_to_block_num.rend() && time_iter->second >= bnum) {
+            time_iter = decltype(time_iter){time_to_block_num.erase( std::next(time_iter).base() )};
+         }
+      }
+
+      /**
+       * The store equivalent of rollback_to_before, the queued writes must have completed
+       * @param bsp - the block to rollback before
+       */
+      void rollback_store_to_before( const chain::block_state_ptr& bsp ) {
+         const auto bnum = bsp->block->block_num();
+         const auto& permission_by_owner = controller.db().get_index<chain::permission_index>().indices().get<chain::by_owner>();
+
+         rollback_time_map(bnum);
+
+         rocksdb::WriteBatch batch;
+         for (const auto& [owner, name] : store->permissions_updated_since(bnum)) {
+            if (const auto sp = store->get_permission(owner, name))
+               store->remove_permission(batch, owner, name, *sp);
+
+            auto itr = permission_by_owner.find(std::make_tuple(owner, name));
+            if (itr != permission_by_owner.end()) {
+               const auto& po = *itr;
+               uint32_t last_updated_height = po.last_updated == bsp->header.timestamp ? bsp->block_num : last_updated_time_to_height(po.last_updated);
+               store->put_permission(batch, owner, name, stored_permission{ last_updated_height, po.auth.to_authority() });
+            }
+         }
+         store->write(batch);
+         store_max_height = store->max_last_updated_height();
+      }
+
+      /**
+       * The store equivalent of the locked section of commit_block.  The chain state is read here, the store is
+       * written on its worker thread.
+       */
+      void commit_block_to_store( const chain::block_state_ptr& bsp, const permission_set_t& updated, const permission_set_t& deleted, bool rollback_required ) {
+         if (rollback_required) {
+            store->wait();
+            rollback_store_to_before(bsp);
+         }
+
+         // insert this blocks time into the time map
+         time_to_block_num.emplace(bsp->header.timestamp, bsp->block_num);
+
+         const auto bnum = bsp->block_num;
+         const auto& permission_by_owner = controller.db().get_index<chain::permission_index>().indices().get<chain::by_owner>();
+
+         std::vector<std::tuple<chain::name, chain::name, stored_permission>> puts;
+         puts.reserve(updated.size());
+         for (const auto& up: updated) {
+            auto source_itr = permission_by_owner.find(std::make_tuple(up.actor, up.permission));
+            EOS_ASSERT(source_itr != permission_by_owner.end(), chain::plugin_exception, "chain data is missing");
+            puts.emplace_back(up.actor, up.permission, stored_permission{ bnum, source_itr->auth.to_authority() });
+         }
+         if (!puts.empty())
+            store_max_height = bnum;
+
+         store->post([store = store.get(), puts = std::move(puts), deleted]() {
+            rocksdb::WriteBatch batch;
+            for (const auto& [owner, name, sp] : puts) {
+               if (const auto old = store->get_permission(owner, name))
+                  store->remove_permission(batch, owner, name, *old);
+               store->put_permission(batch, owner, name, sp);
+            }
+            for (const auto& dp: deleted) {
+               if (const auto old = store->get_permission(dp.actor, dp.permission))
+                  store->remove_permission(batch, dp.actor, dp.permission, *old);
+            }
+            store->write(batch);
+         });
+      }
+
       /**
        * Store a potentially relevant transaction trace in a short lived cache so that it can be processed if its
        * committed to by a block
@@ -299,7 +742,6 @@ namespace eosio::chain_apis {
          }
       }
 
-      using permission_set_t = std::set<chain::permission_level>;
       /**
        * Pre-Commit step with const qualifier to guarantee it does not mutate
        * the thread-safe data set
@@ -367,8 +809,19 @@ namespace eosio::chain_apis {
 
          std::tie(updated, deleted, rollback_required) = commit_block_prelock(bsp);
 
-         // optimistic skip of locking section if there is nothing to do
-         if (!updated.empty() || !deleted.empty() || rollback_required) {
+         if (store) {
+            try {
+               if (!updated.empty() || !deleted.empty() || rollback_required)
+                  commit_block_to_store(bsp, updated, deleted, rollback_required);
+               last_committed_id = bsp->id;
+            } catch (...) {
+               store->fail();
+               cached_trace_map.clear();
+               onblock_trace.reset();
+               throw;
+            }
+         } else if (!updated.empty() || !deleted.empty() || rollback_required) {
+            // optimistic skip of locking section if there is nothing to do
             std::unique_lock write_lock(rw_mutex);
 
             rollback_to_before(bsp);
@@ -448,6 +901,20 @@ namespace eosio::chain_apis {
          };
 
 
+         if (store) {
+            for (const auto& a: account_set) {
+               store->for_each_account_entry(a, [&result](const auto& authorizer, auto weight, auto owner, auto name, auto threshold) {
+                  result.accounts.emplace_back(result_t::account_result{ owner, name, authorizer, {}, weight, threshold });
+               });
+            }
+            for (const auto& k: key_set) {
+               store->for_each_key_entry(k, [&result, &k](auto weight, auto owner, auto name, auto threshold) {
+                  result.accounts.emplace_back(result_t::account_result{ owner, name, {}, k, weight, threshold });
+               });
+            }
+            return result;
+         }
+
          for (const auto& a: account_set) {
             if (a.permission.empty()) {
                // empty permission is a wildcard
@@ -503,10 +970,17 @@ namespace eosio::chain_apis {
       key_bimap_t                key_bimap;                ///< many:many bimap of keys:permission_infos
 
       mutable std::shared_mutex  rw_mutex;                 ///< mutex for read/write locking on the Multi-index and bimaps
+
+      /*
+       * Used instead of the in memory structures above when the index is kept in a store
+       */
+      std::unique_ptr<account_query_store> store;
+      std::optional<uint32_t>    store_max_height;         ///< highest last_updated_height in the store
+      chain::block_id_type       last_committed_id;        ///< block the store is current with once its writes complete
    };
 
-   account_query_db::account_query_db( const chain::controller& controller )
-   :_impl(std::make_unique<account_query_db_impl>(controller))
+   account_query_db::account_query_db( const chain::controller& controller, const std::optional<boost::filesystem::path>& store_dir )
+   :_impl(std::make_unique<account_query_db_impl>(controller, store_dir))
    {
       _impl->build_account_query_map();
    }
@@ -1,5 +1,7 @@
 #include <eosio/chain_plugin/chain_plugin.hpp>
 #include <eosio/chain_plugin/blockvault_sync_strategy.hpp>
+#include <eosio/chain_plugin/database_flusher.hpp>
+#include <eosio/chain_plugin/deep_mind_writer.hpp>
 #include <eosio/chain/fork_database.hpp>
 #include <eosio/chain/block_log.hpp>
 #include <eosio/chain/exceptions.hpp>
@@ -13,6 +15,12 @@
 #include <eosio/chain/generated_transaction_object.hpp>
 #include <eosio/chain/global_property_object.hpp>
 #include <eosio/chain/snapshot.hpp>
+#include <eosio/chain/snapshot_delta.hpp>
+#include <eosio/chain/signature_cache.hpp>
+#include <eosio/chain/signal_slots.hpp>
+#include <eosio/chain/non_consensus_executor.hpp>
+#include <eosio/chain/startup_metrics.hpp>
+#include <eosio/chain/thread_utils.hpp>
 #include <eosio/chain/combined_database.hpp>
 #include <eosio/chain/backing_store/kv_context.hpp>
 #include <eosio/to_key.hpp>
@@ -32,6 +40,7 @@
 #include <fc/variant.hpp>
 #include <fc/log/trace.hpp>
 #include <signal.h>
+#include <iostream>
 #include <cstdlib>
 
 // reflect chainbase::environment for --print-build-info option
@@ -187,6 +196,7 @@ public:
    bool                             accept_transactions = false;
    bool                             api_accept_transactions = true;
    bool                             account_queries_enabled = false;
+   std::optional<bfs::path>         account_queries_dir;
 
    std::optional<fork_database>      fork_db;
    std::optional<controller::config> chain_config;
@@ -196,6 +206,9 @@ public:
    std::optional<vm_type>            wasm_runtime;
    fc::microseconds                  abi_serializer_max_time_us;
    std::optional<bfs::path>          snapshot_path;
+   std::optional<bfs::path>          snapshot_copy; ///< decompressed or piped snapshot, removed after startup
+   std::vector<bfs::path>            snapshot_deltas;
+   chain_plugin::state_checkpoint_config state_checkpoints;
 
 
    // retained references to channels for easy publication
@@ -227,6 +240,71 @@ public:
    std::optional<scoped_connection>                                   applied_transaction_connection;
 
    std::optional<chain_apis::account_query_db>                        _account_query_db;
+   // stages of the transactions of submit_transaction, unless transaction-status-max-tracked is 0
+   std::shared_ptr<chain_apis::trx_status_registry>                   status_registry;
+   // writes the deep-mind output on its own thread when deep-mind-async or deep-mind-binary is set
+   std::shared_ptr<chain_apis::deep_mind_writer>                      deep_mind_writer;
+   // writes back the dirty pages of the mapped database after irreversible blocks when database-flush-mb-per-sec is set
+   std::optional<chain_apis::database_flusher>                        db_flusher;
+   uint16_t                                                           non_consensus_threads = 0;
+
+   // get_info as of the last accepted block, read by http threads
+   chain_apis::read_only::published_info_ptr                         published_info;
+
+   /// binary snapshots which are gzip compressed or read from stdin are copied to a file first, as the reader seeks;
+   /// the snapshot_deltas are applied to the snapshot in order
+   void prepare_snapshot() {
+      const auto copy_path  = app().data_dir() / "snapshot-restore.bin";
+      const bool from_stdin = *snapshot_path == "-";
+      {
+         std::ifstream file;
+         if( !from_stdin )
+            file.open( snapshot_path->generic_string(), (std::ios::in | std::ios::binary) );
+         std::istream& in = from_stdin ? std::cin : file;
+
+         if( from_stdin || is_compressed_snapshot( in ) ) {
+            ilog( "Copying snapshot from ${from} to ${to}",
+                  ("from", from_stdin ? std::string("stdin") : snapshot_path->generic_string())("to", copy_path.generic_string()) );
+            std::ofstream out( copy_path.generic_string(), (std::ios::out | std::ios::binary | std::ios::trunc) );
+            if( is_compressed_snapshot( in ) )
+               decompress_snapshot( in, out );
+            else
+               out << in.rdbuf();
+            out.close();
+            EOS_ASSERT( out.good(), plugin_config_exception, "Unable to copy snapshot to ${path}", ("path", copy_path.generic_string()) );
+
+            snapshot_path = copy_path;
+            snapshot_copy = copy_path;
+         }
+      }
+
+      for( const auto& delta_path : snapshot_deltas ) {
+         ilog( "Applying delta snapshot ${delta} to ${base}", ("delta", delta_path.generic_string())("base", snapshot_path->generic_string()) );
+         std::ifstream delta_file( delta_path.generic_string(), (std::ios::in | std::ios::binary) );
+         EOS_ASSERT( delta_file.is_open(), plugin_config_exception, "Cannot open delta snapshot ${path}", ("path", delta_path.generic_string()) );
+         std::stringstream decompressed( std::ios::in | std::ios::out | std::ios::binary );
+         const bool compressed = is_compressed_snapshot( delta_file );
+         if( compressed )
+            decompress_snapshot( delta_file, decompressed );
+         std::istream& delta = compressed ? decompressed : delta_file;
+         EOS_ASSERT( snapshot_delta::is_delta( delta ), plugin_config_exception, "${path} is not a delta snapshot", ("path", delta_path.generic_string()) );
+
+         const auto next_path = app().data_dir() / "snapshot-restore.bin.next";
+         {
+            std::ifstream base( snapshot_path->generic_string(), (std::ios::in | std::ios::binary) );
+            std::ofstream out( next_path.generic_string(), (std::ios::out | std::ios::binary | std::ios::trunc) );
+            snapshot_delta::apply( base, delta, out );
+         }
+         bfs::rename( next_path, copy_path );
+         snapshot_path = copy_path;
+         snapshot_copy = copy_path;
+      }
+   }
+
+   void publish_info() {
+      chain_apis::read_only ro_api(*chain, _account_query_db, abi_serializer_max_time_us);
+      std::atomic_store( &published_info, std::make_shared<const chain_apis::read_only::get_info_results>( ro_api.get_info({}) ) );
+   }
 
    void do_non_snapshot_startup(std::function<void()> shutdown, std::function<bool()> check_shutdown) {
        if (genesis) {
@@ -293,9 +371,27 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
           "the location of the blocks archive directory (absolute path or relative to blocks dir).\n"
           "If the value is empty, blocks files beyond the retained limit will be deleted.\n"
           "All files in the archive directory are completely under user's control, i.e. they won't be accessed by nodeos anymore.")
+         ("blocks-archive-store-command", bpo::value<std::string>()->default_value(""),
+          "command that stores a block file leaving the retained dir in a remote store such as an S3 compatible object store,\n"
+          "%p is replaced by the local path and %f by the file name, both without the .log/.index extension and quoted for the shell.\n"
+          "Requires blocks-archive-fetch-command. The archive dir, or the retained dir if it is empty, then caches the most\n"
+          "recently stored or fetched files and the blocks in archived files can be queried.")
+         ("blocks-archive-fetch-command", bpo::value<std::string>()->default_value(""),
+          "command that fetches %f.log and %f.index from the remote store to %p.log and %p.index. It runs in the background,\n"
+          "the blocks of an archived file which is not cached are unavailable until it is fetched.")
+         ("max-cached-archive-block-files", bpo::value<uint32_t>()->default_value(4),
+          "the maximum number of archived block files cached locally when a remote store is used")
          ("fix-irreversible-blocks", bpo::value<bool>()->default_value("false"),
           "When the existing block log is inconsistent with the index, allows fixing the block log and index files automatically - that is, " 
           "it will take the highest indexed block if it is valid; otherwise it will repair the block log and reconstruct the index.")
+         ("blocks-log-compression", bpo::value<bool>()->default_value(false),
+          "zlib compress each block written to block log files of version 5 or later, new files are only created with version 5 when enabled; such files cannot be read by nodes that do not support version 5")
+         ("blocks-log-background-split", bpo::value<bool>()->default_value(false),
+          "split retained block log files spanning several strides, such as a block log written before blocks-log-stride was set,\n"
+          "into one file per stride in the background; each file is replaced in the catalog once all of its parts are written")
+         ("blocks-log-prune-older-than", bpo::value<uint32_t>()->default_value(0),
+          "prune the signatures and context free data of the transactions in blocks that are at least this many blocks\n"
+          "behind the head of the block log, in the background; 0 disables pruning. Requires block log version 4 or later")
          ("protocol-features-dir", bpo::value<bfs::path>()->default_value("protocol_features"),
           "the location of the protocol_features directory (absolute path or relative to application config dir)")
          ("checkpoint", bpo::value<vector<string>>()->composing(), "Pairs of [BLOCK_NUM,BLOCK_ID] that should be enforced as checkpoints.")
@@ -309,6 +405,8 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
 #endif
          })->default_value(eosio::chain::config::default_wasm_runtime, default_wasm_runtime_str), wasm_runtime_opt.c_str()
          )
+         ("wasm-runtime-warmup-contracts", bpo::value<uint32_t>()->default_value(0),
+          "Number of contracts, the most widely deployed first, to instantiate with the wasm runtime at startup; 0 instantiates contracts only when they first run")
          ("abi-serializer-max-time-ms", bpo::value<uint32_t>()->default_value(config::default_abi_serializer_max_time_us / 1000),
           "Override default maximum ABI serialization time allowed in ms")
          ("chain-state-db-size-mb", bpo::value<uint64_t>()->default_value(config::default_state_size / (1024  * 1024)), "Maximum size (in MiB) of the chain state database")
@@ -325,17 +423,46 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
           "Rocksdb write rate of flushes and compactions.")
          ("persistent-storage-mbytes-snapshot-batch", bpo::value<uint32_t>()->default_value(config::default_persistent_storage_mbytes_batch),
           "Rocksdb batch size threshold before writing read in snapshot data to database.")
+         ("persistent-storage-hot-contract", bpo::value<vector<string>>()->composing()->multitoken(),
+          "Contract whose state is kept in its own rocksdb column family, isolating its flushes and compactions from other contracts. "
+          "Changing this setting requires resync, replay, or restore from snapshot. (may specify multiple times)")
+         ("persistent-storage-hot-contract-cache-mb", bpo::value<uint64_t>()->default_value(0),
+          "Size of a rocksdb block cache (in MiB) dedicated to hot contracts. 0 = share block cache with other contracts")
+         ("persistent-storage-hot-contract-bloom-bits", bpo::value<uint32_t>()->default_value(config::default_persistent_storage_bloom_bits_per_key),
+          "Bits per key of the rocksdb bloom filter of hot contracts")
+         ("persistent-storage-hot-contract-write-buffer-size-mb", bpo::value<uint64_t>()->default_value(config::default_persistent_storage_write_buffer_size / (1024  * 1024)),
+          "Size of a single rocksdb memtable of hot contracts (in MiB), also scales their compaction levels")
+         ("persistent-storage-max-pending-commits", bpo::value<uint32_t>()->default_value(0),
+          "Number of committed blocks whose state may be written to rocksdb in the background while the next blocks are applied. "
+          "0 = write synchronously")
 
          ("reversible-blocks-db-size-mb", bpo::value<uint64_t>()->default_value(config::default_reversible_cache_size / (1024  * 1024)), "Maximum size (in MiB) of the reversible blocks database")
          ("reversible-blocks-db-guard-size-mb", bpo::value<uint64_t>()->default_value(config::default_reversible_guard_size / (1024  * 1024)), "Safely shut down node when free space remaining in the reverseible blocks database drops below this size (in MiB).")
          ("signature-cpu-billable-pct", bpo::value<uint32_t>()->default_value(config::default_sig_cpu_bill_pct / config::percent_1),
           "Percentage of actual signature recovery cpu to bill. Whole number percentages, e.g. 50 for 50%")
+         ("signature-cache-size", bpo::value<uint32_t>()->default_value(config::default_signature_cache_size),
+          "Number of recovered signatures kept so a transaction seen again, e.g. in a block after it was executed speculatively, does not recover them again. 0 to disable.")
          ("chain-threads", bpo::value<uint16_t>()->default_value(config::default_controller_thread_pool_size),
           "Number of worker threads in controller thread pool")
+         ("non-consensus-threads", bpo::value<uint16_t>()->default_value(0),
+          "Number of threads shared by the plugins for the tasks which take no part in consensus and do not read the chain state, "
+          "such as the net_api_plugin status calls. 0 runs them on the main thread.")
+         ("chain-threads-cpus", bpo::value<string>(),
+          "CPUs the controller thread pool is pinned to, e.g. \"2-5,8\". By default the threads inherit the affinity of the main thread.")
+         ("block-prepare-depth", bpo::value<uint16_t>()->default_value(config::default_block_prepare_depth),
+          "Maximum number of received blocks whose transaction signatures are recovered on the controller thread pool ahead of their application. 0 to disable.")
+         ("replay-read-ahead-blocks", bpo::value<uint32_t>()->default_value(config::default_replay_read_ahead_blocks),
+          "Maximum number of blocks read and unpacked from the blocks log on a separate thread ahead of replaying them. 0 to disable.")
          ("contracts-console", bpo::bool_switch()->default_value(false),
           "print contract's output to console")
          ("deep-mind", bpo::bool_switch()->default_value(false),
           "print deeper information about chain operations")
+         ("deep-mind-async", bpo::bool_switch()->default_value(false),
+          "Format and write the deep-mind output on a thread of its own instead of the main thread, ignoring the deep-mind logger of logging.json")
+         ("deep-mind-binary", bpo::bool_switch()->default_value(false),
+          "Write the deep-mind output as size prefixed binary records, with blocks and traces as raw bytes instead of hex; implies deep-mind-async")
+         ("deep-mind-queue-size", bpo::value<uint32_t>()->default_value(64*1024),
+          "Number of deep-mind messages queued for the writer thread of deep-mind-async before the main thread waits for it")
          ("telemetry-url", bpo::value<std::string>(),
           "Send Zipkin spans to url. e.g. http://127.0.0.1:9411/api/v2/spans" )
          ("telemetry-service-name", bpo::value<std::string>()->default_value("nodeos"),
@@ -370,6 +497,10 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
           "In \"light\" mode all incoming blocks headers will be fully validated; transactions in those validated blocks will be trusted \n")
          ("disable-ram-billing-notify-checks", bpo::bool_switch()->default_value(false),
           "Disable the check which subjectively fails a transaction if a contract bills more RAM to another account within the context of a notification handler (i.e. when the receiver is not the code of the action).")
+         ("profile-trx-parallelism", bpo::bool_switch()->default_value(false),
+          "Track the accounts read and written by each transaction of validated blocks and log (at debug level) how many conflict-free batches each block could be executed in.")
+         ("minimal-validation-traces", bpo::bool_switch()->default_value(false),
+          "Omit the action data from the traces of notifications while validating blocks. Only for nodes without trace consumers; incompatible with trace_api_plugin, state_history_plugin and history_plugin.")
 #ifdef EOSIO_DEVELOPER
          ("disable-all-subjective-mitigations", bpo::bool_switch()->default_value(false),
           "Disable all subjective mitigations checks in the entire codebase.")
@@ -385,6 +516,16 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
           "In \"locked\" mode database is preloaded, locked in to memory, and will use huge pages if available.\n"
 #endif
          )
+         ("database-flush-mb-per-sec", bpo::value<uint32_t>()->default_value(0),
+          "In \"mapped\" mode, MiB of the database per second a background thread syncs to its file after blocks become irreversible, "
+          "which bounds the bandwidth it writes the dirty pages with, so that the kernel writeback and the sync at shutdown have less to write. "
+          "0 leaves the dirty pages to the kernel.")
+#ifdef __linux__
+         ("database-numa-node", bpo::value<uint32_t>(),
+          "NUMA node the main thread is pinned to, and on which the memory it touches first, such as the database preloaded in \"heap\" "
+          "or \"locked\" mode and the pages of a \"mapped\" database not cached yet, is allocated when the node has free memory. "
+          "The threads created afterwards, including the controller thread pool, inherit both unless their CPUs are set.")
+#endif
 
 #ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
          ("eos-vm-oc-cache-size-mb", bpo::value<uint64_t>()->default_value(eosvmoc::config().cache_size / (1024u*1024u)), "Maximum size (in MiB) of the EOS VM OC code cache")
@@ -394,10 +535,20 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
                   EOS_ASSERT(false, plugin_exception, "");
                }
          }), "Number of threads to use for EOS VM OC tier-up")
+         ("eos-vm-oc-warmup-contracts", bpo::value<uint32_t>()->default_value(eosvmoc::config().warmup_contracts),
+          "Number of contracts, the most widely deployed first, to compile with EOS VM OC at startup; 0 compiles contracts only when they first run")
+         ("eos-vm-oc-seed-cache-file", bpo::value<bfs::path>(),
+          "Cleanly closed code_cache.bin of another node to start from when this node has no EOS VM OC code cache yet, for example of a node built from the same snapshot")
          ("eos-vm-oc-enable", bpo::bool_switch(), "Enable EOS VM OC tier-up runtime")
+         ("eos-vm-oc-perf-map", bpo::bool_switch(),
+          "Write the symbols of the contract code compiled by EOS VM OC to /tmp/perf-<pid>.map, so profilers such as perf attribute samples to the contract account and wasm function")
 #endif
          ("enable-account-queries", bpo::value<bool>()->default_value(false), "enable queries to find accounts by various metadata.")
+         ("account-queries-dir", bpo::value<bfs::path>(),
+          "the location of a RocksDB database keeping the account query indices between runs instead of in memory (absolute path or relative to application data dir)")
          ("max-nonprivileged-inline-action-size", bpo::value<uint32_t>()->default_value(config::default_max_nonprivileged_inline_action_size), "maximum allowed size (in bytes) of an inline action for a nonprivileged account")
+         ("transaction-status-max-tracked", bpo::value<uint32_t>()->default_value(100000),
+          "Maximum number of transactions of submit_transaction whose stages are tracked for get_transaction_status until they expire, 0 disables both calls.")
          ;
 
 // TODO: rate limiting
@@ -441,7 +592,20 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
           "replace reversible block database with blocks imported from specified file and then exit")
          ("export-reversible-blocks", bpo::value<bfs::path>(),
            "export reversible block database in portable format into specified file and then exit")
-         ("snapshot", bpo::value<bfs::path>(), "File to read Snapshot State from")
+         ("snapshot", bpo::value<bfs::path>(), "File to read Snapshot State from, which may be gzip compressed, or - to read it from stdin")
+         ("snapshot-delta", bpo::value<vector<bfs::path>>()->composing(),
+          "Delta snapshot to apply to the --snapshot before loading it, may be specified multiple times to apply a chain of deltas in order")
+         ;
+
+   cfg.add_options()
+         ("state-checkpoint-interval", bpo::value<uint32_t>()->default_value(0),
+          "number of blocks between the state checkpoints written by the producer plugin, 0 disables them.\n"
+          "A checkpoint is a snapshot that is kept once its block is irreversible. If the state database is dirty\n"
+          "at startup (likely due to unclean shutdown), the newest checkpoint is loaded and the blocks log is replayed from there.")
+         ("state-checkpoints-dir", bpo::value<bfs::path>()->default_value("state-checkpoints"),
+          "the location of the state checkpoints directory (absolute path or relative to application data dir)")
+         ("max-state-checkpoints", bpo::value<uint32_t>()->default_value(2),
+          "the number of the most recent state checkpoints to keep")
          ;
 
 }
@@ -707,6 +871,7 @@ chain_plugin::do_hard_replay(const variables_map& options) {
 
 void chain_plugin::plugin_initialize(const variables_map& options) {
    ilog("initializing chain plugin");
+   startup_metrics::scoped_timer initialize_timer( "chain_plugin.initialize" );
 
    try {
       try {
@@ -823,6 +988,14 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
       my->chain_config->blog.stride                  = options.at("blocks-log-stride").as<uint32_t>();
       my->chain_config->blog.max_retained_files      = options.at("max-retained-block-files").as<uint16_t>();
       my->chain_config->blog.fix_irreversible_blocks = options.at("fix-irreversible-blocks").as<bool>();
+      my->chain_config->blog.compress_blocks         = options.at("blocks-log-compression").as<bool>();
+      my->chain_config->blog.background_split        = options.at("blocks-log-background-split").as<bool>();
+      my->chain_config->blog.prune_blocks_older_than = options.at("blocks-log-prune-older-than").as<uint32_t>();
+      my->chain_config->blog.remote_archive.store_command    = options.at("blocks-archive-store-command").as<std::string>();
+      my->chain_config->blog.remote_archive.fetch_command    = options.at("blocks-archive-fetch-command").as<std::string>();
+      my->chain_config->blog.remote_archive.max_cached_files = options.at("max-cached-archive-block-files").as<uint32_t>();
+      EOS_ASSERT( my->chain_config->blog.remote_archive.store_command.empty() == my->chain_config->blog.remote_archive.fetch_command.empty(),
+                  plugin_config_exception, "blocks-archive-store-command and blocks-archive-fetch-command must be set together" );
 
       if (auto resmon_plugin = app().find_plugin<resource_monitor_plugin>()) {
         resmon_plugin->monitor_directory(my->chain_config->blog.log_dir);
@@ -865,6 +1038,16 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
       EOS_ASSERT( my->chain_config->persistent_storage_mbytes_batch > 0, plugin_config_exception,
                   "persistent-storage-mbytes-snapshot-batch ${num} must be greater than 0", ("num", my->chain_config->persistent_storage_mbytes_batch) );
 
+      LOAD_VALUE_SET( options, "persistent-storage-hot-contract", my->chain_config->persistent_storage_hot_contracts );
+      EOS_ASSERT( my->chain_config->persistent_storage_hot_contracts.empty() || my->chain_config->backing_store == backing_store_type::ROCKSDB,
+                  plugin_config_exception, "persistent-storage-hot-contract requires backing-store = rocksdb" );
+      my->chain_config->persistent_storage_hot_contract_cache_size = options.at( "persistent-storage-hot-contract-cache-mb" ).as<uint64_t>() * 1024 * 1024;
+      my->chain_config->persistent_storage_hot_contract_bloom_bits = options.at( "persistent-storage-hot-contract-bloom-bits" ).as<uint32_t>();
+      my->chain_config->persistent_storage_hot_contract_write_buffer_size = options.at( "persistent-storage-hot-contract-write-buffer-size-mb" ).as<uint64_t>() * 1024 * 1024;
+      EOS_ASSERT( my->chain_config->persistent_storage_hot_contract_write_buffer_size > 0, plugin_config_exception,
+                  "persistent-storage-hot-contract-write-buffer-size-mb ${num} must be greater than 0", ("num", my->chain_config->persistent_storage_hot_contract_write_buffer_size) );
+      my->chain_config->persistent_storage_max_pending_commits = options.at( "persistent-storage-max-pending-commits" ).as<uint32_t>();
+
       if( options.count( "reversible-blocks-db-size-mb" ))
          my->chain_config->reversible_cache_size =
                options.at( "reversible-blocks-db-size-mb" ).as<uint64_t>() * 1024 * 1024;
@@ -881,18 +1064,34 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
                      "chain-threads ${num} must be greater than 0", ("num", my->chain_config->thread_pool_size) );
       }
 
+      my->non_consensus_threads = options.at( "non-consensus-threads" ).as<uint16_t>();
+
+      if( options.count( "chain-threads-cpus" ))
+         my->chain_config->thread_pool_cpus = parse_cpu_list( options.at( "chain-threads-cpus" ).as<string>() );
+
+      if( options.count( "block-prepare-depth" ))
+         my->chain_config->block_prepare_depth = options.at( "block-prepare-depth" ).as<uint16_t>();
+
+      if( options.count( "replay-read-ahead-blocks" ))
+         my->chain_config->replay_read_ahead_blocks = options.at( "replay-read-ahead-blocks" ).as<uint32_t>();
+
       my->chain_config->sig_cpu_bill_pct = options.at("signature-cpu-billable-pct").as<uint32_t>();
       EOS_ASSERT( my->chain_config->sig_cpu_bill_pct >= 0 && my->chain_config->sig_cpu_bill_pct <= 100, plugin_config_exception,
                   "signature-cpu-billable-pct must be 0 - 100, ${pct}", ("pct", my->chain_config->sig_cpu_bill_pct) );
       my->chain_config->sig_cpu_bill_pct *= config::percent_1;
 
+      signature_cache::shared().set_max_entries( options.at( "signature-cache-size" ).as<uint32_t>() );
+
       if( my->wasm_runtime )
          my->chain_config->wasm_runtime = *my->wasm_runtime;
+      my->chain_config->wasm_runtime_warmup_contracts = options.at( "wasm-runtime-warmup-contracts" ).as<uint32_t>();
 
       my->chain_config->force_all_checks = options.at( "force-all-checks" ).as<bool>();
       my->chain_config->disable_replay_opts = options.at( "disable-replay-opts" ).as<bool>();
       my->chain_config->contracts_console = options.at( "contracts-console" ).as<bool>();
       my->chain_config->allow_ram_billing_in_notify = options.at( "disable-ram-billing-notify-checks" ).as<bool>();
+      my->chain_config->profile_trx_parallelism = options.at( "profile-trx-parallelism" ).as<bool>();
+      my->chain_config->minimal_validation_traces = options.at( "minimal-validation-traces" ).as<bool>();
 
 #ifdef EOSIO_DEVELOPER
       my->chain_config->disable_all_subjective_mitigations = options.at( "disable-all-subjective-mitigations" ).as<bool>();
@@ -1003,11 +1202,55 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
          wlog("The --import-reversible-blocks option should be used by itself.");
       }
 
-      std::optional<chain_id_type> chain_id;
-      if (options.count( "snapshot" )) {
+      {
+         auto scd = options.at( "state-checkpoints-dir" ).as<bfs::path>();
+         my->state_checkpoints.dir          = scd.is_relative() ? app().data_dir() / scd : scd;
+         my->state_checkpoints.interval     = options.at( "state-checkpoint-interval" ).as<uint32_t>();
+         my->state_checkpoints.max_retained = options.at( "max-state-checkpoints" ).as<uint32_t>();
+         EOS_ASSERT( my->state_checkpoints.interval == 0 || my->state_checkpoints.max_retained > 0, plugin_config_exception,
+                     "max-state-checkpoints must be greater than 0 when state-checkpoint-interval is set" );
+      }
+
+      if( options.count( "snapshot" )) {
          my->snapshot_path = options.at( "snapshot" ).as<bfs::path>();
-         EOS_ASSERT( fc::exists(*my->snapshot_path), plugin_config_exception,
+         EOS_ASSERT( *my->snapshot_path == "-" || fc::exists(*my->snapshot_path), plugin_config_exception,
                      "Cannot load snapshot, ${name} does not exist", ("name", my->snapshot_path->generic_string()) );
+         if( options.count( "snapshot-delta" ) )
+            my->snapshot_deltas = options.at( "snapshot-delta" ).as<vector<bfs::path>>();
+      } else if( my->state_checkpoints.interval > 0 && options.count( "genesis-json" ) == 0 &&
+                 options.count( "genesis-timestamp" ) == 0 && state_db_is_dirty( my->chain_config->state_dir ) ) {
+         // resume from the newest checkpoint plus a replay of the blocks log after it instead of a full replay
+         if( auto checkpoint = newest_state_checkpoint( my->state_checkpoints.dir ) ) {
+            // the state is only destroyed for a readable checkpoint of the chain in the blocks log
+            std::optional<chain_id_type> checkpoint_chain_id;
+            try {
+               auto infile = std::ifstream( checkpoint->generic_string(), (std::ios::in | std::ios::binary) );
+               istream_snapshot_reader reader( infile );
+               reader.validate();
+               checkpoint_chain_id = controller::extract_chain_id( reader );
+            } FC_LOG_AND_DROP();
+            std::optional<chain_id_type> block_log_chain_id;
+            if( checkpoint_chain_id && fc::is_regular_file( my->blocks_dir / "blocks.log" ) ) {
+               auto block_log_genesis = block_log::extract_genesis_state( my->blocks_dir );
+               block_log_chain_id = block_log_genesis ? block_log_genesis->compute_chain_id()
+                                                      : block_log::extract_chain_id( my->blocks_dir );
+            }
+            if( !checkpoint_chain_id || (block_log_chain_id && *block_log_chain_id != *checkpoint_chain_id) ) {
+               wlog( "Database dirty flag set (likely due to unclean shutdown): not restoring state from checkpoint ${name} "
+                     "which is unreadable or has a different chain ID than the blocks log",
+                     ("name", checkpoint->generic_string()) );
+            } else {
+               my->snapshot_path = checkpoint->generic_string();
+               wlog( "Database dirty flag set (likely due to unclean shutdown): restoring state from checkpoint ${name}",
+                     ("name", my->snapshot_path->generic_string()) );
+               eosio::chain::combined_database::destroy( my->chain_config->state_dir );
+            }
+         }
+      }
+
+      std::optional<chain_id_type> chain_id;
+      if (my->snapshot_path) {
+         my->prepare_snapshot();
 
          // recover genesis information from the snapshot
          // used for validation code below
@@ -1185,21 +1428,75 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
 
       my->chain_config->db_map_mode = options.at("database-map-mode").as<pinnable_mapped_file::map_mode>();
 
+#ifdef __linux__
+      if( options.count("database-numa-node") ) {
+         // before the controller opens the database so that its memory is allocated on the node
+         const auto node = options.at("database-numa-node").as<uint32_t>();
+         bind_thread_to_numa_node( node );
+         ilog( "main thread bound to numa node ${n}", ("n", node) );
+      }
+#endif
+
 #ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
       if( options.count("eos-vm-oc-cache-size-mb") )
          my->chain_config->eosvmoc_config.cache_size = options.at( "eos-vm-oc-cache-size-mb" ).as<uint64_t>() * 1024u * 1024u;
       if( options.count("eos-vm-oc-compile-threads") )
          my->chain_config->eosvmoc_config.threads = options.at("eos-vm-oc-compile-threads").as<uint64_t>();
+      if( options.count("eos-vm-oc-warmup-contracts") )
+         my->chain_config->eosvmoc_config.warmup_contracts = options.at("eos-vm-oc-warmup-contracts").as<uint32_t>();
+      if( options.count("eos-vm-oc-seed-cache-file") ) {
+         auto seed = options.at("eos-vm-oc-seed-cache-file").as<bfs::path>();
+         if( seed.is_relative() )
+            seed = bfs::current_path() / seed;
+         my->chain_config->eosvmoc_config.seed_cache_file = seed;
+      }
       if( options["eos-vm-oc-enable"].as<bool>() )
          my->chain_config->eosvmoc_tierup = true;
+      if( options["eos-vm-oc-perf-map"].as<bool>() )
+         my->chain_config->eosvmoc_config.perf_map = true;
 #endif
 
       my->account_queries_enabled = options.at("enable-account-queries").as<bool>();
+      if( const auto max_tracked = options.at( "transaction-status-max-tracked" ).as<uint32_t>() )
+         my->status_registry = std::make_shared<chain_apis::trx_status_registry>( max_tracked, app().get_io_service() );
+      if( options.count( "account-queries-dir" )) {
+         auto aqd = options.at( "account-queries-dir" ).as<bfs::path>();
+         if( aqd.is_relative())
+            my->account_queries_dir = app().data_dir() / aqd;
+         else
+            my->account_queries_dir = aqd;
+      }
 
-      my->chain.emplace( *my->chain_config, std::move(pfs), *chain_id );
+      {
+         startup_metrics::scoped_timer t( "chain_plugin.controller_construct" );
+         my->chain.emplace( *my->chain_config, std::move(pfs), *chain_id );
+      }
+
+      if( const auto flush_mb = options.at( "database-flush-mb-per-sec" ).as<uint32_t>(); flush_mb > 0 ) {
+         if( my->chain_config->db_map_mode == pinnable_mapped_file::map_mode::mapped ) {
+            auto* segment = const_cast<pinnable_mapped_file::segment_manager*>( my->chain->db().get_segment_manager() );
+            my->db_flusher.emplace( reinterpret_cast<char*>( segment ), segment->get_size(), uint64_t(flush_mb) * 1024 * 1024 );
+         } else {
+            wlog( "database-flush-mb-per-sec only applies to the \"mapped\" database-map-mode, ignored" );
+         }
+      }
 
       // initialize deep mind logging
-      if ( options.at( "deep-mind" ).as<bool>() ) {
+      const bool deep_mind_binary = options.at( "deep-mind-binary" ).as<bool>();
+      if ( options.at( "deep-mind" ).as<bool>() && (deep_mind_binary || options.at( "deep-mind-async" ).as<bool>()) ) {
+         // The writer replaces the appenders of the deep-mind logger and writes to stdout with retries on its own
+         my->deep_mind_writer = std::make_shared<chain_apis::deep_mind_writer>(
+               deep_mind_binary ? chain_apis::deep_mind_writer::framing::binary : chain_apis::deep_mind_writer::framing::text,
+               options.at( "deep-mind-queue-size" ).as<uint32_t>() );
+         my->deep_mind_writer->set_on_error( []() {
+            app().post( priority::highest, []() { app().quit(); } );
+         } );
+         _deep_mind_log = fc::logger();
+         _deep_mind_log.set_log_level( fc::log_level::debug );
+         _deep_mind_log.add_appender( my->deep_mind_writer );
+
+         my->chain->enable_deep_mind( &_deep_mind_log );
+      } else if ( options.at( "deep-mind" ).as<bool>() ) {
          // The actual `fc::dmlog_appender` implementation that is currently used by deep mind
          // logger is using `stdout` to prints it's log line out. Deep mind logging outputs
          // massive amount of data out of the process, which can lead under pressure to some
@@ -1273,8 +1570,12 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
                my->accepted_block_header_channel.publish( priority::medium, blk );
             } );
 
-      my->accepted_block_connection = my->chain->accepted_block.connect( [this]( const block_state_ptr& blk ) {
-         if (auto dm_logger = my->chain->get_deep_mind_logger()) {
+      my->accepted_block_connection = my->chain->accepted_block.connect( timed_slot( "chain.accepted_block", [this]( const block_state_ptr& blk ) {
+         if (my->deep_mind_writer) {
+            // an accepted block state is not modified anymore, pack it on the writer thread
+            my->deep_mind_writer->log_payload( "ACCEPTED_BLOCK " + std::to_string(blk->block_num),
+                                               [blk]() { return fc::raw::pack(*blk); } );
+         } else if (auto dm_logger = my->chain->get_deep_mind_logger()) {
             auto packed_blk = fc::raw::pack(*blk);
 
             fc_dlog(*dm_logger, "ACCEPTED_BLOCK ${num} ${blk}",
@@ -1287,10 +1588,21 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
             my->_account_query_db->commit_block(blk);
           }
 
+         if( my->status_registry ) {
+            my->status_registry->accepted_block( blk );
+            my->status_registry->expire( fc::time_point::now() );
+         }
+
+         my->publish_info();
          my->accepted_block_channel.publish( priority::high, blk );
-      } );
+      } ) );
 
       my->irreversible_block_connection = my->chain->irreversible_block.connect( [this]( const block_state_ptr& blk ) {
+         if( my->db_flusher )
+            my->db_flusher->flush();
+         if( my->status_registry )
+            my->status_registry->irreversible_block( blk );
+         my->publish_info();
          my->irreversible_block_channel.publish( priority::low, blk );
       } );
 
@@ -1299,9 +1611,14 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
                my->accepted_transaction_channel.publish( priority::low, meta );
             } );
 
-      my->applied_transaction_connection = my->chain->applied_transaction.connect(
+      my->applied_transaction_connection = my->chain->applied_transaction.connect( timed_slot( "chain.applied_transaction",
             [this]( std::tuple<const transaction_trace_ptr&, const packed_transaction_ptr&> t ) {
-               if (auto dm_logger = my->chain->get_deep_mind_logger()) {
+               if (my->deep_mind_writer) {
+                  // the trace can still change after the signal, only the hex conversion moves to the writer thread
+                  auto packed_trace = std::make_shared<std::vector<char>>( fc::raw::pack(*std::get<0>(t)) );
+                  my->deep_mind_writer->log_payload( "APPLIED_TRANSACTION " + std::to_string(my->chain->head_block_num() + 1),
+                                                     [packed_trace]() { return std::move(*packed_trace); } );
+               } else if (auto dm_logger = my->chain->get_deep_mind_logger()) {
                   auto packed_trace = fc::raw::pack(*std::get<0>(t));
 
                   fc_dlog(*dm_logger, "APPLIED_TRANSACTION ${block} ${traces}",
@@ -1313,9 +1630,13 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
                if (my->_account_query_db) {
                   my->_account_query_db->cache_transaction_trace(std::get<0>(t));
                }
+
+               if( my->status_registry ) {
+                  my->status_registry->applied( std::get<0>(t) );
+               }
                
                my->applied_transaction_channel.publish( priority::low, std::get<0>(t) );
-            } );
+            } ) );
 
       my->chain->add_indices();
    } FC_LOG_AND_RETHROW()
@@ -1325,6 +1646,10 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
 void chain_plugin::plugin_startup()
 { try {
    handle_sighup(); // Sets loggers
+   startup_metrics::scoped_timer startup_timer( "chain_plugin.startup" );
+
+   if( my->non_consensus_threads > 0 )
+      non_consensus_executor::shared().start( my->non_consensus_threads );
 
    EOS_ASSERT( my->chain_config->read_mode != db_read_mode::IRREVERSIBLE || !accept_transactions(), plugin_config_exception,
                "read-mode = irreversible. transactions should not be enabled by enable_accept_transactions" );
@@ -1341,6 +1666,8 @@ void chain_plugin::plugin_startup()
          auto reader = std::make_shared<istream_snapshot_reader>(infile);
          my->chain->startup(shutdown, check_shutdown, reader);
          infile.close();
+         if (my->snapshot_copy)
+            bfs::remove(*my->snapshot_copy);
       } else {
          my->do_non_snapshot_startup(shutdown, check_shutdown);
       }
@@ -1367,17 +1694,25 @@ void chain_plugin::plugin_startup()
   
    if (my->account_queries_enabled) {
       my->account_queries_enabled = false;
+      startup_metrics::scoped_timer t( "chain_plugin.account_queries_build" );
       try {
-         my->_account_query_db.emplace(*my->chain);
+         my->_account_query_db.emplace(*my->chain, my->account_queries_dir);
          my->account_queries_enabled = true;
       } FC_LOG_AND_DROP(("Unable to enable account queries"));
    }
 
+   // the phases of the controller, next to those of the plugins, see nodeos main
+   for( auto& p : my->chain->get_startup_metrics().snapshot() )
+      startup_metrics::shared().record( std::move( p.phase ), fc::microseconds( p.us ) );
+
+   my->publish_info();
 
 
 } FC_CAPTURE_AND_RETHROW() }
 
 void chain_plugin::plugin_shutdown() {
+   // later tasks go to the main thread, which does not run them any more while quitting
+   non_consensus_executor::shared().stop();
    my->pre_accepted_block_connection.reset();
    my->accepted_block_header_connection.reset();
    my->accepted_block_connection.reset();
@@ -1386,18 +1721,28 @@ void chain_plugin::plugin_shutdown() {
    my->applied_transaction_connection.reset();
    if(app().is_quiting())
       my->chain->get_wasm_interface().indicate_shutting_down();
+   // closes the account query store at the head it was last committed with
+   my->_account_query_db.reset();
+   // before the database is unmapped
+   my->db_flusher.reset();
    my->chain.reset();
+   if(my->deep_mind_writer)
+      my->deep_mind_writer->stop();
    zipkin_config::shutdown();
 }
 
 void chain_plugin::handle_sighup() {
-   fc::logger::update( deep_mind_logger_name, _deep_mind_log );
+   // the deep-mind writer is not configured by logging.json
+   if( !my->deep_mind_writer )
+      fc::logger::update( deep_mind_logger_name, _deep_mind_log );
 }
 
-chain_apis::read_write::read_write(controller& db, const fc::microseconds& abi_serializer_max_time, bool api_accept_transactions)
+chain_apis::read_write::read_write(controller& db, const fc::microseconds& abi_serializer_max_time, bool api_accept_transactions,
+                                   std::shared_ptr<trx_status_registry> status_registry)
 : db(db)
 , abi_serializer_max_time(abi_serializer_max_time)
 , api_accept_transactions(api_accept_transactions)
+, status_registry(std::move(status_registry))
 {
 }
 
@@ -1406,8 +1751,14 @@ void chain_apis::read_write::validate() const {
                "Not allowed, node has api-accept-transactions = false" );
 }
 
+chain_apis::read_write chain_plugin::get_read_write_api() {
+   return chain_apis::read_write(chain(), get_abi_serializer_max_time(), api_accept_transactions(), my->status_registry);
+}
+
 chain_apis::read_only chain_plugin::get_read_only_api() const {
-   return chain_apis::read_only(chain(), my->_account_query_db, get_abi_serializer_max_time());
+   chain_apis::read_only ro_api(chain(), my->_account_query_db, get_abi_serializer_max_time());
+   ro_api.set_published_info( &my->published_info );
+   return ro_api;
 }
 
   
@@ -1419,6 +1770,45 @@ void chain_plugin::accept_transaction(const chain::packed_transaction_ptr& trx,
    my->incoming_transaction_async_method(trx, false, std::move(next));
 }
 
+const chain_plugin::state_checkpoint_config& chain_plugin::state_checkpoints() const {
+   return my->state_checkpoints;
+}
+
+std::optional<fc::path> chain_plugin::newest_state_checkpoint( const fc::path& dir ) {
+   std::optional<fc::path> newest;
+   uint32_t newest_block_num = 0;
+   if( !fc::is_directory( dir ) )
+      return newest;
+   for( bfs::directory_iterator itr( dir ), end; itr != end; ++itr ) {
+      // same naming as the snapshots of producer_plugin, pending and incomplete ones start with '.'
+      const auto name = itr->path().filename().string();
+      // compressed ones end with .bin.gz
+      const auto base = itr->path().extension() == ".gz" ? itr->path().stem() : itr->path();
+      if( !bfs::is_regular_file( itr->path() ) || name.find( "snapshot-" ) != 0 || base.extension() != ".bin" )
+         continue;
+      try {
+         const auto block_num = block_header::num_from_id( block_id_type( base.stem().string().substr( 9 ) ) );
+         if( !newest || block_num > newest_block_num ) {
+            newest = itr->path();
+            newest_block_num = block_num;
+         }
+      } catch( const fc::exception& ) {
+      }
+   }
+   return newest;
+}
+
+bool chain_plugin::state_db_is_dirty( const fc::path& state_dir ) {
+   if( !fc::is_regular_file( state_dir / "shared_memory.bin" ) )
+      return false;
+   try {
+      chainbase::database db( state_dir, database::read_only );
+   } catch( const std::system_error& e ) {
+      return chainbase::db_error_code::dirty == e.code().value();
+   }
+   return false;
+}
+
 bool chain_plugin::recover_reversible_blocks( const fc::path& db_dir, uint32_t cache_size,
                                               std::optional<fc::path> new_db_dir, uint32_t truncate_at_block ) {
    try {
@@ -1705,6 +2095,10 @@ std::string itoh(I n, size_t hlen = sizeof(I)<<1) {
 }
 
 read_only::get_info_results read_only::get_info(const read_only::get_info_params&) const {
+   if( published_info ) {
+      auto info = std::atomic_load( published_info );
+      if( info ) return *info;
+   }
    const auto& rm = db.get_resource_limits_manager();
    return {
       itoh(static_cast<uint32_t>(app().version())),
@@ -1926,6 +2320,16 @@ string convert_to_string(const float128_t& source, const string& key_type, const
    } FC_RETHROW_EXCEPTIONS(warn, "Could not convert ${desc} from '${source}' to string.", ("desc", desc)("source",source) )
 }
 
+string make_table_rows_cursor(uint64_t primary_key) {
+   return fc::to_hex( reinterpret_cast<const char*>(&primary_key), sizeof(primary_key) );
+}
+
+void parse_table_rows_cursor(const string& cursor, uint64_t& primary_key) {
+   EOS_ASSERT( cursor.size() == 2 * sizeof(primary_key) && std::all_of( cursor.begin(), cursor.end(), [](char c) { return std::isxdigit(c); } ),
+               chain::contract_table_query_exception, "Invalid cursor ${c} for this index", ("c", cursor) );
+   fc::from_hex( cursor, reinterpret_cast<char*>(&primary_key), sizeof(primary_key) );
+}
+
 abi_def get_abi( const controller& db, const name& account ) {
    const auto &d = db.db();
    const account_object *code_accnt = d.find<account_object, by_name>(account);
@@ -2010,6 +2414,33 @@ read_only::get_table_rows_result read_only::get_table_rows( const read_only::get
 #pragma GCC diagnostic pop
 }
 
+std::string read_only::get_table_rows_json( const read_only::get_table_rows_params& p, const fc::time_point& deadline )const {
+   if( !p.json || (p.show_payer && *p.show_payer) || (p.keys_only && *p.keys_only) ) {
+      return fc::json::to_string( fc::variant( get_table_rows( p ) ), deadline );
+   }
+
+   read_only json_rows_api( *this );
+   json_rows_api.json_rows = true;
+   const auto result = json_rows_api.get_table_rows( p );
+
+   // same field order as FC_REFLECT of get_table_rows_result
+   std::string json = "{\"rows\":[";
+   for( size_t i = 0; i < result.rows.size(); ++i ) {
+      if( i > 0 ) json += ',';
+      json += result.rows[i].get_string();
+   }
+   json += "],\"more\":";
+   json += result.more ? "true" : "false";
+   json += ",\"next_key\":";
+   json += fc::json::to_string( fc::variant( result.next_key ), deadline );
+   json += ",\"next_key_bytes\":";
+   json += fc::json::to_string( fc::variant( result.next_key_bytes ), deadline );
+   json += ",\"next_cursor\":";
+   json += fc::json::to_string( fc::variant( result.next_cursor ), deadline );
+   json += '}';
+   return json;
+}
+
 /// short_string is intended to optimize the string equality comparison where one of the operand is
 /// no greater than 8 bytes long.
 struct short_string {
@@ -2241,10 +2672,12 @@ struct kv_table_rows_context {
    const read_only::get_kv_table_rows_params& p;
    abi_serializer::yield_function_t           yield_function;                            
    abi_def                                    abi;
-   abi_serializer                             abis;
+   std::shared_ptr<const abi_serializer>      abis;
    std::string                                index_type;
+   std::string                                primary_index_type;
    bool                                       shorten_abi_errors;
    bool                                       is_primary_idx;
+   bool                                       keys_only;
 
    kv_table_rows_context(const controller& db, const read_only::get_kv_table_rows_params& param,
                          const fc::microseconds abi_serializer_max_time, bool shorten_error)
@@ -2254,7 +2687,8 @@ struct kv_table_rows_context {
        , p(param)
        , yield_function(abi_serializer::create_yield_function(abi_serializer_max_time))
        , abi(eosio::chain_apis::get_abi(db, param.code))
-       , shorten_abi_errors(shorten_error) {
+       , shorten_abi_errors(shorten_error)
+       , keys_only(param.keys_only && *param.keys_only) {
 
       EOS_ASSERT(p.limit > 0, chain::contract_table_query_exception, "invalid limit : ${n}", ("n", p.limit));
       string tbl_name = p.table.to_string();
@@ -2272,7 +2706,31 @@ struct kv_table_rows_context {
                  ("t", p.table)("i", p.index_name));
 
       index_type = kv_tbl_def.get_index_type(p.index_name.to_string());
-      abis.set_abi(abi, yield_function);
+      primary_index_type = kv_tbl_def.get_index_type(kv_tbl_def.primary_index.name.to_string());
+      EOS_ASSERT(p.fields.empty() || p.json, chain::contract_table_query_exception, "fields requires json");
+      if (!keys_only)
+         abis = db.get_abi_serializer_cache().get(db.db(), p.code, yield_function);
+   }
+
+   /// the decoded row, or its bytes if it cannot be decoded; only the requested fields of a decoded row are kept
+   fc::variant value_to_var(std::vector<char>&& row_value) const {
+      if (p.json) {
+         try {
+            auto row = abis->binary_to_variant(p.table.to_string(), row_value, yield_function, shorten_abi_errors);
+            if (p.fields.empty() || !row.is_object())
+               return row;
+            const auto& obj = row.get_object();
+            fc::mutable_variant_object projected;
+            for (const auto& field : p.fields) {
+               auto itr = obj.find(field);
+               if (itr != obj.end())
+                  projected(field, itr->value());
+            }
+            return projected;
+         } catch (fc::exception& e) {
+         }
+      }
+      return fc::variant(std::move(row_value));
    }
 
    bool point_query() const { return p.index_value.size(); }
@@ -2341,20 +2799,40 @@ struct kv_iterator_ex {
 
    /// @pre ! is_end()
    fc::variant get_value_var() const {
-      std::vector<char> row_value = get_value();
-      if (context.p.json) {
+      return context.value_to_var(get_value());
+   }
+
+   /// the index key, and the primary key of a secondary index, without reading or decoding the row; the keys of
+   /// types which read_key cannot decode only have their bytes
+   /// @pre ! is_end()
+   fc::variant get_keys_var() const {
+      fc::mutable_variant_object result;
+      auto add_key = [&result](const char* name, const std::string& index_type, const std::string& encode_type,
+                               const std::string& key_bytes) {
          try {
-            return context.abis.binary_to_variant(context.p.table.to_string(), row_value,
-                                                  context.yield_function,
-                                                  context.shorten_abi_errors);
-         } catch (fc::exception& e) {
+            result(name, key_helper::read_key(index_type, encode_type, key_bytes));
+         } catch (chain::contract_table_query_exception&) {
          }
+         result(std::string(name) + "_bytes", key_bytes);
+      };
+      add_key("key", context.index_type, context.p.encode_type, get_key_hex_string());
+      if (!context.is_primary_idx) {
+         // the value of a secondary index is the full key of the primary row
+         std::vector<char> primary_key(value_size);
+         uint32_t          actual_size;
+         base->kv_it_value(0, primary_key.data(), value_size, actual_size);
+         std::string primary_key_bytes;
+         if (primary_key.size() > prefix_size)
+            boost::algorithm::hex(primary_key.begin() + prefix_size, primary_key.end(), std::back_inserter(primary_key_bytes));
+         add_key("primary_key", context.primary_index_type, context.p.encode_type == "bytes" ? "bytes" : "", primary_key_bytes);
       }
-      return fc::variant(row_value);
+      return result;
    }
 
    /// @pre ! is_end()
    fc::variant get_value_and_maybe_payer_var() const {
+      if (context.keys_only)
+         return get_keys_var();
       fc::variant result = get_value_var();
       if (context.p.show_payer) {
          auto maybe_payer = base->kv_it_payer();
@@ -2458,6 +2936,16 @@ read_only::get_table_rows_result read_only::get_kv_table_rows(const read_only::g
                  "specify both index_value and ranges (i.e. lower_bound/upper_bound) is not allowed");
       read_only::get_table_rows_result result;
       auto full_key = context.get_full_key(p.index_value);
+      if (context.is_primary_idx && !context.keys_only && !p.show_payer) {
+         // the row is read directly, without creating an iterator over the table
+         uint32_t value_size = 0;
+         if (context.kv_context->kv_get(p.code.to_uint64_t(), full_key.data(), full_key.size(), value_size)) {
+            std::vector<char> row_value(value_size);
+            context.kv_context->kv_get_data(0, row_value.data(), value_size);
+            result.rows.emplace_back(context.value_to_var(std::move(row_value)));
+         }
+         return result;
+      }
       kv_iterator_ex                   itr(context, full_key);
       if (!itr.is_end() && itr.key_compare(full_key) == 0) {
          result.rows.emplace_back(itr.get_value_and_maybe_payer_var());
@@ -2639,7 +3127,8 @@ read_only::get_producers_result read_only::get_producers( const read_only::get_p
    const auto producers_table = "producers"_n;
    const abi_def abi = eosio::chain_apis::get_abi(db, config::system_account_name);
    const auto table_type = get_table_type(abi, producers_table);
-   const abi_serializer abis{ abi, abi_serializer::create_yield_function( abi_serializer_max_time ) };
+   const auto abis_ptr = get_abi_serializer(config::system_account_name);
+   const abi_serializer& abis = *abis_ptr;
    EOS_ASSERT(table_type == KEYi64, chain::contract_table_query_exception, "Invalid table type ${type} for table producers", ("type",table_type));
 
    const auto& d = db.db();
@@ -2805,19 +3294,15 @@ read_only::get_producer_schedule_result read_only::get_producer_schedule( const
    return result;
 }
 
+read_only::get_block_apply_metrics_result read_only::get_block_apply_metrics( const read_only::get_block_apply_metrics_params& ) const {
+   return { db.get_block_apply_metrics().snapshot(), signal_slot_metrics::shared().snapshot() };
+}
+
 template<typename Api>
 struct resolver_factory {
    static auto make(const Api* api, abi_serializer::yield_function_t yield) {
-      return [api, yield{std::move(yield)}](const account_name &name) -> std::optional<abi_serializer> {
-         const auto* accnt = api->db.db().template find<account_object, by_name>(name);
-         if (accnt != nullptr) {
-            abi_def abi;
-            if (abi_serializer::to_abi(accnt->abi, abi)) {
-               return abi_serializer(abi, yield);
-            }
-         }
-
-         return std::optional<abi_serializer>();
+      return [api, yield{std::move(yield)}](const account_name &name) -> std::shared_ptr<const abi_serializer> {
+         return api->db.get_abi_serializer_cache().get(api->db.db(), name, yield);
       };
    }
 };
@@ -3011,6 +3496,73 @@ void read_write::push_transaction(const read_write::push_transaction_params& par
          input_trx = std::make_shared<packed_transaction>( std::move( input_trx_v0 ), true );
       } EOS_RETHROW_EXCEPTIONS(chain::packed_transaction_type_exception, "Invalid packed transaction")
 
+      push_transaction(std::move(input_trx), next);
+   } catch ( boost::interprocess::bad_alloc& ) {
+      chain_plugin::handle_db_exhaustion();
+   } catch ( const std::bad_alloc& ) {
+      chain_plugin::handle_bad_alloc();
+   } CATCH_AND_CALL(next);
+}
+
+read_write::push_transaction_results read_write::push_transaction_output(const transaction_trace_ptr& trx_trace_ptr) const {
+   fc::variant output;
+   try {
+      output = db.to_variant_with_abi( *trx_trace_ptr, abi_serializer::create_yield_function( abi_serializer_max_time ) );
+
+      // Create map of (closest_unnotified_ancestor_action_ordinal, global_sequence) with action trace
+      std::map< std::pair<uint32_t, uint64_t>, fc::mutable_variant_object > act_traces_map;
+      for( const auto& act_trace : output["action_traces"].get_array() ) {
+         if (act_trace["receipt"].is_null() && act_trace["except"].is_null()) continue;
+         auto closest_unnotified_ancestor_action_ordinal =
+               act_trace["closest_unnotified_ancestor_action_ordinal"].as<fc::unsigned_int>().value;
+         auto global_sequence = act_trace["receipt"].is_null() ?
+                                    std::numeric_limits<uint64_t>::max() :
+                                    act_trace["receipt"]["global_sequence"].as<uint64_t>();
+         act_traces_map.emplace( std::make_pair( closest_unnotified_ancestor_action_ordinal,
+                                                 global_sequence ),
+                                 act_trace.get_object() );
+      }
+
+      std::function<vector<fc::variant>(uint32_t)> convert_act_trace_to_tree_struct =
+      [&](uint32_t closest_unnotified_ancestor_action_ordinal) {
+         vector<fc::variant> restructured_act_traces;
+         auto it = act_traces_map.lower_bound(
+                     std::make_pair( closest_unnotified_ancestor_action_ordinal, 0)
+         );
+         for( ;
+            it != act_traces_map.end() && it->first.first == closest_unnotified_ancestor_action_ordinal; ++it )
+         {
+            auto& act_trace_mvo = it->second;
+
+            auto action_ordinal = act_trace_mvo["action_ordinal"].as<fc::unsigned_int>().value;
+            act_trace_mvo["inline_traces"] = convert_act_trace_to_tree_struct(action_ordinal);
+            if (act_trace_mvo["receipt"].is_null()) {
+               act_trace_mvo["receipt"] = fc::mutable_variant_object()
+                  ("abi_sequence", 0)
+                  ("act_digest", digest_type::hash(trx_trace_ptr->action_traces[action_ordinal-1].act))
+                  ("auth_sequence", flat_map<account_name,uint64_t>())
+                  ("code_sequence", 0)
+                  ("global_sequence", 0)
+                  ("receiver", act_trace_mvo["receiver"])
+                  ("recv_sequence", 0);
+            }
+            restructured_act_traces.push_back( std::move(act_trace_mvo) );
+         }
+         return restructured_act_traces;
+      };
+
+      fc::mutable_variant_object output_mvo(output);
+      output_mvo["action_traces"] = convert_act_trace_to_tree_struct(0);
+
+      output = output_mvo;
+   } catch( chain::abi_exception& ) {
+      output = *trx_trace_ptr;
+   }
+   return read_write::push_transaction_results{trx_trace_ptr->id, output};
+}
+
+void read_write::push_transaction(packed_transaction_ptr input_trx, next_function<read_write::push_transaction_results> next) {
+   try {
       auto trx_trace = fc_create_trace_with_id("Transaction", input_trx->id());
       auto trx_span = fc_create_span(trx_trace, "HTTP Received");
       fc_add_tag(trx_span, "trx_id", input_trx->id());
@@ -3041,62 +3593,7 @@ void read_write::push_transaction(const read_write::push_transaction_params& par
             }
 
             try {
-               fc::variant output;
-               try {
-                  output = db.to_variant_with_abi( *trx_trace_ptr, abi_serializer::create_yield_function( abi_serializer_max_time ) );
-
-                  // Create map of (closest_unnotified_ancestor_action_ordinal, global_sequence) with action trace
-                  std::map< std::pair<uint32_t, uint64_t>, fc::mutable_variant_object > act_traces_map;
-                  for( const auto& act_trace : output["action_traces"].get_array() ) {
-                     if (act_trace["receipt"].is_null() && act_trace["except"].is_null()) continue;
-                     auto closest_unnotified_ancestor_action_ordinal =
-                           act_trace["closest_unnotified_ancestor_action_ordinal"].as<fc::unsigned_int>().value;
-                     auto global_sequence = act_trace["receipt"].is_null() ?
-                                                std::numeric_limits<uint64_t>::max() :
-                                                act_trace["receipt"]["global_sequence"].as<uint64_t>();
-                     act_traces_map.emplace( std::make_pair( closest_unnotified_ancestor_action_ordinal,
-                                                             global_sequence ),
-                                             act_trace.get_object() );
-                  }
-
-                  std::function<vector<fc::variant>(uint32_t)> convert_act_trace_to_tree_struct =
-                  [&](uint32_t closest_unnotified_ancestor_action_ordinal) {
-                     vector<fc::variant> restructured_act_traces;
-                     auto it = act_traces_map.lower_bound(
-                                 std::make_pair( closest_unnotified_ancestor_action_ordinal, 0)
-                     );
-                     for( ;
-                        it != act_traces_map.end() && it->first.first == closest_unnotified_ancestor_action_ordinal; ++it )
-                     {
-                        auto& act_trace_mvo = it->second;
-
-                        auto action_ordinal = act_trace_mvo["action_ordinal"].as<fc::unsigned_int>().value;
-                        act_trace_mvo["inline_traces"] = convert_act_trace_to_tree_struct(action_ordinal);
-                        if (act_trace_mvo["receipt"].is_null()) {
-                           act_trace_mvo["receipt"] = fc::mutable_variant_object()
-                              ("abi_sequence", 0)
-                              ("act_digest", digest_type::hash(trx_trace_ptr->action_traces[action_ordinal-1].act))
-                              ("auth_sequence", flat_map<account_name,uint64_t>())
-                              ("code_sequence", 0)
-                              ("global_sequence", 0)
-                              ("receiver", act_trace_mvo["receiver"])
-                              ("recv_sequence", 0);
-                        }
-                        restructured_act_traces.push_back( std::move(act_trace_mvo) );
-                     }
-                     return restructured_act_traces;
-                  };
-
-                  fc::mutable_variant_object output_mvo(output);
-                  output_mvo["action_traces"] = convert_act_trace_to_tree_struct(0);
-
-                  output = output_mvo;
-               } catch( chain::abi_exception& ) {
-                  output = *trx_trace_ptr;
-               }
-
-               const chain::transaction_id_type& id = trx_trace_ptr->id;
-               next(read_write::push_transaction_results{id, output});
+               next(push_transaction_output(trx_trace_ptr));
             } CATCH_AND_CALL(next);
          }
       });
@@ -3143,8 +3640,74 @@ void read_write::push_transactions(const read_write::push_transactions_params& p
    } CATCH_AND_CALL(next);
 }
 
-void read_write::send_transaction(const read_write::send_transaction_params& params, next_function<read_write::send_transaction_results> next) {
+void read_write::push_transaction_batch(const read_write::push_transaction_batch_params& params, next_function<read_write::push_transaction_batch_results> next) {
+   try {
+      EOS_ASSERT( params.size() <= 1000, too_many_tx_at_once, "Attempt to push too many transactions at once" );
+
+      struct batch_state {
+         read_write::push_transaction_batch_results          results;
+         std::vector<fc::exception_ptr>                       errors;
+         size_t                                               remaining = 0;   ///< the nexts are called on the main thread
+      };
+      auto batch = std::make_shared<batch_state>();
+      batch->results.resize( params.size() );
+      batch->errors.resize( params.size() );
+      batch->remaining = params.size();
+
+      auto done = [batch, next]( size_t i, fc::exception_ptr e ) {
+         if( e )
+            batch->results[i] = read_write::push_transaction_results{ transaction_id_type(), fc::mutable_variant_object( "error", e->to_detail_string() ) };
+         if( --batch->remaining == 0 )
+            next( std::move( batch->results ) );
+      };
+
+      std::vector<packed_transaction_ptr> trxs;
+      std::vector<next_function<transaction_trace_ptr>> nexts;
+      trxs.reserve( params.size() );
+      nexts.reserve( params.size() );
+      auto resolver = make_resolver(this, abi_serializer::create_yield_function( abi_serializer_max_time ));
+      for( size_t i = 0; i < params.size(); ++i ) {
+         packed_transaction_ptr input_trx;
+         auto reject = [&]( fc::exception_ptr e ) { batch->errors[i] = std::move( e ); };
+         try {
+            try {
+               packed_transaction_v0 input_trx_v0;
+               abi_serializer::from_variant(params[i], input_trx_v0, resolver, abi_serializer::create_yield_function( abi_serializer_max_time ));
+               input_trx = std::make_shared<packed_transaction>( std::move( input_trx_v0 ), true );
+            } EOS_RETHROW_EXCEPTIONS(chain::packed_transaction_type_exception, "Invalid packed transaction")
+         } CATCH_AND_CALL(reject);
+         if( !input_trx )
+            continue;
 
+         trxs.push_back( std::move( input_trx ) );
+         nexts.push_back( [this, batch, i, done]( const std::variant<fc::exception_ptr, transaction_trace_ptr>& result ) {
+            if( std::holds_alternative<fc::exception_ptr>( result ) ) {
+               done( i, std::get<fc::exception_ptr>( result ) );
+               return;
+            }
+            fc::exception_ptr e;
+            auto on_error = [&e]( fc::exception_ptr ex ) { e = std::move( ex ); };
+            try {
+               batch->results[i] = push_transaction_output( std::get<transaction_trace_ptr>( result ) );
+            } CATCH_AND_CALL(on_error);
+            done( i, std::move( e ) );
+         } );
+      }
+
+      for( size_t i = 0; i < params.size(); ++i ) {
+         if( batch->errors[i] )
+            done( i, batch->errors[i] );
+      }
+      if( !trxs.empty() )
+         app().get_method<incoming::methods::transaction_batch_async>()( trxs, true, std::move( nexts ) );
+   } catch ( boost::interprocess::bad_alloc& ) {
+      chain_plugin::handle_db_exhaustion();
+   } catch ( const std::bad_alloc& ) {
+      chain_plugin::handle_bad_alloc();
+   } CATCH_AND_CALL(next);
+}
+
+void read_write::send_transaction(const read_write::send_transaction_params& params, next_function<read_write::send_transaction_results> next) {
    try {
       packed_transaction_v0 input_trx_v0;
       auto resolver = make_resolver(this, abi_serializer::create_yield_function( abi_serializer_max_time ));
@@ -3154,6 +3717,16 @@ void read_write::send_transaction(const read_write::send_transaction_params& par
          input_trx = std::make_shared<packed_transaction>( std::move( input_trx_v0 ), true );
       } EOS_RETHROW_EXCEPTIONS(chain::packed_transaction_type_exception, "Invalid packed transaction")
 
+      send_transaction(std::move(input_trx), next);
+   } catch ( boost::interprocess::bad_alloc& ) {
+      chain_plugin::handle_db_exhaustion();
+   } catch ( const std::bad_alloc& ) {
+      chain_plugin::handle_bad_alloc();
+   } CATCH_AND_CALL(next);
+}
+
+void read_write::send_transaction(packed_transaction_ptr input_trx, next_function<read_write::send_transaction_results> next) {
+   try {
       auto trx_trace = fc_create_trace_with_id("Transaction", input_trx->id());
       auto trx_span = fc_create_span(trx_trace, "HTTP Received");
       fc_add_tag(trx_span, "trx_id", input_trx->id());
@@ -3202,6 +3775,111 @@ void read_write::send_transaction(const read_write::send_transaction_params& par
    } CATCH_AND_CALL(next);
 }
 
+void read_write::submit_transaction(const read_write::submit_transaction_params& params, next_function<read_write::submit_transaction_results> next) {
+   try {
+      EOS_ASSERT( status_registry, plugin_config_exception, "submit_transaction is disabled by transaction-status-max-tracked = 0" );
+      packed_transaction_v0 input_trx_v0;
+      auto resolver = make_resolver(this, abi_serializer::create_yield_function( abi_serializer_max_time ));
+      packed_transaction_ptr input_trx;
+      try {
+         abi_serializer::from_variant(params, input_trx_v0, std::move( resolver ), abi_serializer::create_yield_function( abi_serializer_max_time ));
+         input_trx = std::make_shared<packed_transaction>( std::move( input_trx_v0 ), true );
+      } EOS_RETHROW_EXCEPTIONS(chain::packed_transaction_type_exception, "Invalid packed transaction")
+
+      const auto id = input_trx->id();
+      EOS_ASSERT( status_registry->track( id, input_trx->expiration() ), tx_resource_exhaustion,
+                  "Too many tracked transactions: ${n}, try again once some have expired", ("n", status_registry->size()) );
+
+      // acknowledged as soon as the producer has it, the stages are reported by get_transaction_status
+      app().get_method<incoming::methods::transaction_async>()(input_trx, true,
+            [registry=status_registry, id](const std::variant<fc::exception_ptr, transaction_trace_ptr>& result) {
+         if( std::holds_alternative<fc::exception_ptr>( result ) ) {
+            registry->failed( id, std::get<fc::exception_ptr>( result )->to_detail_string() );
+         } else {
+            const auto& trace = std::get<transaction_trace_ptr>( result );
+            if( trace->except )
+               registry->failed( id, trace->except->to_detail_string() );
+            else
+               registry->applied( trace );
+         }
+      });
+      next(read_write::submit_transaction_results{id});
+   } catch ( boost::interprocess::bad_alloc& ) {
+      chain_plugin::handle_db_exhaustion();
+   } catch ( const std::bad_alloc& ) {
+      chain_plugin::handle_bad_alloc();
+   } CATCH_AND_CALL(next);
+}
+
+void read_write::get_transaction_status(const read_write::get_transaction_status_params& params, next_function<read_write::get_transaction_status_results> next) {
+   try {
+      EOS_ASSERT( status_registry, plugin_config_exception, "get_transaction_status is disabled by transaction-status-max-tracked = 0" );
+      const auto wait = fc::milliseconds( std::min( params.wait_ms, max_transaction_status_wait_ms ) );
+      status_registry->wait( params.id, params.after.value_or( trx_stage::unknown ), fc::time_point::now() + wait,
+                        [rw=*this, next]( const trx_status& status ) {
+         read_write::get_transaction_status_results results{ status.id, status.stage };
+         if( status.stage >= trx_stage::in_block && status.stage <= trx_stage::irreversible ) {
+            results.block_num = status.block_num;
+            results.block_id = status.block_id;
+         }
+         if( status.stage != trx_stage::unknown )
+            results.expiration = status.expiration;
+         results.error = status.error;
+         try {
+            if( status.trace )
+               results.trace = rw.push_transaction_output( status.trace ).processed;
+         } catch( ... ) {
+            // the trace of a transaction whose ABI cannot be resolved any more
+            results.trace = fc::variant( *status.trace );
+         }
+         next( std::move( results ) );
+      });
+   } CATCH_AND_CALL(next);
+}
+
+void read_write::compute_transaction(const read_write::compute_transaction_params& params, next_function<read_write::compute_transaction_results> next) {
+   try {
+      packed_transaction_v0 input_trx_v0;
+      auto resolver = make_resolver(this, abi_serializer::create_yield_function( abi_serializer_max_time ));
+      packed_transaction_ptr input_trx;
+      try {
+         abi_serializer::from_variant(params, input_trx_v0, std::move( resolver ), abi_serializer::create_yield_function( abi_serializer_max_time ));
+         input_trx = std::make_shared<packed_transaction>( std::move( input_trx_v0 ), true );
+      } EOS_RETHROW_EXCEPTIONS(chain::packed_transaction_type_exception, "Invalid packed transaction")
+
+      compute_transaction(std::move(input_trx), next);
+   } catch ( boost::interprocess::bad_alloc& ) {
+      chain_plugin::handle_db_exhaustion();
+   } catch ( const std::bad_alloc& ) {
+      chain_plugin::handle_bad_alloc();
+   } CATCH_AND_CALL(next);
+}
+
+void read_write::compute_transaction(packed_transaction_ptr input_trx, next_function<read_write::compute_transaction_results> next) {
+   try {
+      EOS_ASSERT( db.is_building_block(), chain::block_validate_exception,
+                  "No pending block to compute transaction ${id} against", ("id", input_trx->id()) );
+
+      // objective transaction and block limits still apply inside transaction_context
+      auto trx_trace_ptr = db.push_transaction( transaction_metadata::create_no_recover_keys( input_trx, transaction_metadata::trx_type::dry_run ),
+                                                fc::time_point::maximum(), 0, false, 0 );
+
+      fc::variant output;
+      try {
+         output = db.to_variant_with_abi( *trx_trace_ptr, abi_serializer::create_yield_function( abi_serializer_max_time ) );
+      } catch( chain::abi_exception& ) {
+         output = *trx_trace_ptr;
+      }
+
+      const chain::transaction_id_type& id = trx_trace_ptr->id;
+      next(read_write::compute_transaction_results{id, output});
+   } catch ( boost::interprocess::bad_alloc& ) {
+      chain_plugin::handle_db_exhaustion();
+   } catch ( const std::bad_alloc& ) {
+      chain_plugin::handle_bad_alloc();
+   } CATCH_AND_CALL(next);
+}
+
 read_only::get_abi_results read_only::get_abi( const get_abi_params& params )const {
    get_abi_results result;
    result.account_name = params.account_name;
@@ -3333,11 +4011,8 @@ read_only::get_account_results read_only::get_account( const get_account_params&
       ++perm;
    }
 
-   const auto& code_account = db.db().get<account_object,by_name>( config::system_account_name );
-
-   abi_def abi;
-   if( abi_serializer::to_abi(code_account.abi, abi) ) {
-      abi_serializer abis( abi, abi_serializer::create_yield_function( abi_serializer_max_time ) );
+   if( const auto abis_ptr = db.get_abi_serializer_cache().get( db.db(), config::system_account_name, abi_serializer::create_yield_function( abi_serializer_max_time ) ) ) {
+      const abi_serializer& abis = *abis_ptr;
 
       const auto token_code = "eosio.token"_n;
 
@@ -3384,16 +4059,15 @@ read_only::abi_json_to_bin_result read_only::abi_json_to_bin( const read_only::a
    const auto code_account = db.db().find<account_object,by_name>( params.code );
    EOS_ASSERT(code_account != nullptr, contract_query_exception, "Contract can't be found ${contract}", ("contract", params.code));
 
-   abi_def abi;
-   if( abi_serializer::to_abi(code_account->abi, abi) ) {
-      abi_serializer abis( abi, abi_serializer::create_yield_function( abi_serializer_max_time ) );
+   if( const auto abis_ptr = db.get_abi_serializer_cache().get( db.db(), params.code, abi_serializer::create_yield_function( abi_serializer_max_time ) ) ) {
+      const abi_serializer& abis = *abis_ptr;
       auto action_type = abis.get_action_type(params.action);
       EOS_ASSERT(!action_type.empty(), action_validate_exception, "Unknown action ${action} in contract ${contract}", ("action", params.action)("contract", params.code));
       try {
          result.binargs = abis.variant_to_binary( action_type, params.args, abi_serializer::create_yield_function( abi_serializer_max_time ), shorten_abi_errors );
       } EOS_RETHROW_EXCEPTIONS(chain::invalid_action_args_exception,
                                 "'${args}' is invalid args for action '${action}' code '${code}'. expected '${proto}'",
-                                ("args", params.args)("action", params.action)("code", params.code)("proto", action_abi_to_variant(abi, action_type)))
+                                ("args", params.args)("action", params.action)("code", params.code)("proto", action_abi_to_variant(eosio::chain_apis::get_abi(db, params.code), action_type)))
    } else {
       EOS_ASSERT(false, abi_not_found_exception, "No ABI found for ${contract}", ("contract", params.code));
    }
@@ -3403,10 +4077,9 @@ read_only::abi_json_to_bin_result read_only::abi_json_to_bin( const read_only::a
 
 read_only::abi_bin_to_json_result read_only::abi_bin_to_json( const read_only::abi_bin_to_json_params& params )const {
    abi_bin_to_json_result result;
-   const auto& code_account = db.db().get<account_object,by_name>( params.code );
-   abi_def abi;
-   if( abi_serializer::to_abi(code_account.abi, abi) ) {
-      abi_serializer abis( abi, abi_serializer::create_yield_function( abi_serializer_max_time ) );
+   db.db().get<account_object,by_name>( params.code ); // throws if the account does not exist
+   if( const auto abis_ptr = db.get_abi_serializer_cache().get( db.db(), params.code, abi_serializer::create_yield_function( abi_serializer_max_time ) ) ) {
+      const abi_serializer& abis = *abis_ptr;
       result.args = abis.binary_to_variant( abis.get_action_type( params.action ), params.binargs, abi_serializer::create_yield_function( abi_serializer_max_time ), shorten_abi_errors );
    } else {
       EOS_ASSERT(false, abi_not_found_exception, "No ABI found for ${contract}", ("contract", params.code));
@@ -3461,12 +4134,15 @@ chain::symbol read_only::extract_core_symbol()const {
    return core_symbol;
 }
 
+std::shared_ptr<const abi_serializer> read_only::get_abi_serializer( name account ) const {
+   auto abis = db.get_abi_serializer_cache().get( db.db(), account, abi_serializer::create_yield_function( abi_serializer_max_time ) );
+   EOS_ASSERT( abis, abi_not_found_exception, "No ABI found for ${contract}", ("contract", account) );
+   return abis;
+}
+
 fc::variant read_only::get_primary_key(name code, name scope, name table, uint64_t primary_key, row_requirements require_table,
                                        row_requirements require_primary, const std::string_view& type, bool as_json) const {
-   const abi_def abi = eosio::chain_apis::get_abi(db, code);
-   abi_serializer abis;
-   abis.set_abi(abi, abi_serializer::create_yield_function(abi_serializer_max_time));
-   return get_primary_key(code, scope, table, primary_key, require_table, require_primary, type, abis, as_json);
+   return get_primary_key(code, scope, table, primary_key, require_table, require_primary, type, *get_abi_serializer(code), as_json);
 }
 
 fc::variant read_only::get_primary_key(name code, name scope, name table, uint64_t primary_key, row_requirements require_table,
@@ -0,0 +1,86 @@
+#include <eosio/chain_plugin/database_flusher.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/log/logger_config.hpp> //set_os_thread_name
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace eosio::chain_apis {
+
+   static constexpr size_t max_chunk_size = 16*1024*1024;
+
+   database_flusher::database_flusher( char* base, size_t size, uint64_t bytes_per_second )
+   : bytes_per_second( bytes_per_second ) {
+      FC_ASSERT( bytes_per_second > 0, "database flush bandwidth must be greater than 0" );
+      // msync requires a page aligned address
+      const size_t page = sysconf( _SC_PAGESIZE );
+      const auto misalignment = reinterpret_cast<uintptr_t>( base ) % page;
+      this->base = base - misalignment;
+      this->size = size + misalignment;
+      // about ten chunks a second so that stop does not wait long for the pace of a pass
+      chunk_size = std::clamp<uint64_t>( bytes_per_second / 10 / page * page, page, max_chunk_size );
+      thread = std::thread( [this]() {
+         fc::set_os_thread_name( "db-flush" );
+         run();
+      } );
+   }
+
+   database_flusher::~database_flusher() {
+      stop();
+   }
+
+   void database_flusher::flush() {
+      {
+         std::lock_guard g( mtx );
+         requested = true;
+      }
+      cv.notify_one();
+   }
+
+   void database_flusher::stop() {
+      {
+         std::lock_guard g( mtx );
+         if( done )
+            return;
+         done = true;
+      }
+      cv.notify_one();
+      thread.join();
+   }
+
+   void database_flusher::run() {
+      while( true ) {
+         {
+            std::unique_lock g( mtx );
+            cv.wait( g, [this]() { return requested || done; } );
+            if( done )
+               return;
+            requested = false;
+         }
+         for( size_t offset = 0; offset < size; offset += chunk_size ) {
+            if( !sync_chunk( offset ) )
+               return;
+         }
+         ++completed;
+      }
+   }
+
+   bool database_flusher::sync_chunk( size_t offset ) {
+      const auto start = std::chrono::steady_clock::now();
+      const auto len   = std::min( chunk_size, size - offset );
+      if( msync( base + offset, len, MS_SYNC ) != 0 ) {
+         elog( "database flush failed, the flusher stops: ${e}", ("e", strerror( errno )) );
+         return false;
+      }
+      const auto pace = std::chrono::microseconds( len * 1000000 / bytes_per_second );
+      std::unique_lock g( mtx );
+      return !cv.wait_until( g, start + pace, [this]() { return done; } );
+   }
+}
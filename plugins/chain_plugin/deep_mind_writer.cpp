@@ -0,0 +1,123 @@
+#include <eosio/chain_plugin/deep_mind_writer.hpp>
+
+#include <fc/crypto/hex.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/log/logger_config.hpp> //set_os_thread_name
+#include <fc/variant_object.hpp>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+namespace eosio::chain_apis {
+
+   static constexpr size_t max_buffered_bytes = 4*1024*1024;
+
+   deep_mind_writer::deep_mind_writer( framing f, size_t queue_size, int fd )
+   : frame( f ), fd( fd ), queue( queue_size ) {
+      FC_ASSERT( queue_size > 0, "deep-mind queue size must be greater than 0" );
+      buffer.reserve( max_buffered_bytes );
+      thread = std::thread( [this]() {
+         fc::set_os_thread_name( "deep-mind" );
+         run();
+      } );
+   }
+
+   deep_mind_writer::~deep_mind_writer() {
+      stop();
+   }
+
+   void deep_mind_writer::log( const fc::log_message& m ) {
+      push( record{ m, {}, {} } );
+   }
+
+   void deep_mind_writer::log_payload( std::string text, std::function<std::vector<char>()> payload ) {
+      push( record{ {}, std::move( text ), std::move( payload ) } );
+   }
+
+   void deep_mind_writer::push( record&& r ) {
+      if( done.load( std::memory_order_acquire ) ) {
+         append( r );
+         flush();
+         return;
+      }
+      while( !queue.push( r ) )
+         std::this_thread::yield(); // the writer is behind, wait for it rather than dropping output
+   }
+
+   void deep_mind_writer::stop() {
+      if( done.exchange( true ) )
+         return;
+      thread.join();
+   }
+
+   void deep_mind_writer::run() {
+      while( true ) {
+         // read done before consuming so the records pushed before stop() are all consumed
+         const bool stopping = done.load( std::memory_order_acquire );
+         const size_t consumed = queue.consume_all( [this]( const record& r ) {
+            append( r );
+            if( buffer.size() >= max_buffered_bytes )
+               flush();
+         } );
+         if( consumed == 0 ) {
+            flush();
+            if( stopping )
+               return;
+            std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+         }
+      }
+   }
+
+   void deep_mind_writer::append( const record& r ) {
+      const size_t start = buffer.size();
+      if( frame == framing::binary )
+         buffer.append( sizeof(uint32_t), '\0' ); // size of the record, filled in below
+      else
+         buffer += "DMLOG ";
+
+      if( r.message ) {
+         buffer += fc::format_string( r.message->get_format(), r.message->get_data() );
+      } else {
+         buffer += r.text;
+         const std::vector<char> payload = r.payload ? r.payload() : std::vector<char>{};
+         if( frame == framing::binary ) {
+            buffer += '\0';
+            buffer.append( payload.data(), payload.size() );
+         } else {
+            buffer += ' ';
+            buffer += fc::to_hex( payload.data(), payload.size() );
+         }
+      }
+
+      if( frame == framing::binary ) {
+         const uint32_t size = buffer.size() - start - sizeof(uint32_t);
+         for( size_t i = 0; i < sizeof(uint32_t); ++i )
+            buffer[start + i] = static_cast<char>( (size >> (8 * i)) & 0xff );
+      } else {
+         buffer += '\n';
+      }
+   }
+
+   void deep_mind_writer::flush() {
+      const char* data = buffer.data();
+      size_t remaining = buffer.size();
+      while( remaining && !failed ) {
+         const ssize_t written = ::write( fd, data, remaining );
+         if( written < 0 ) {
+            if( errno == EINTR || errno == EAGAIN )
+               continue;
+            elog( "deep-mind output failed: ${e}", ("e", strerror( errno )) );
+            failed = true;
+            if( on_error )
+               on_error();
+            break;
+         }
+         data += written;
+         remaining -= written;
+      }
+      buffer.clear();
+   }
+
+}
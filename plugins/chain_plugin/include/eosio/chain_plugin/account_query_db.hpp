@@ -3,11 +3,14 @@
 #include <eosio/chain/block_state.hpp>
 #include <eosio/chain/trace.hpp>
 
+#include <boost/filesystem/path.hpp>
+
 namespace eosio::chain_apis {
    /**
-    * This class manages the ephemeral indices and data that provide the `get_accounts_by_authorizers` RPC call
-    * There is no persistence and the indices/caches are recreated when the class is instantiated based on the
-    * current state of the chain.
+    * This class manages the indices and data that provide the `get_accounts_by_authorizers` RPC call
+    * By default there is no persistence and the indices/caches are recreated when the class is instantiated based on
+    * the current state of the chain.  With a store directory the indices are kept in a RocksDB database instead of
+    * memory, updated on a worker thread, and reused when the class is instantiated at the block they were closed at.
     */
    class account_query_db {
    public:
@@ -17,8 +20,9 @@ namespace eosio::chain_apis {
        * The caller is expected to manage lifetimes such that this controller reference does not go stale
        * for the life of the account query DB
        * @param chain - controller to read data from
+       * @param store_dir - directory of the RocksDB database holding the indices, in memory indices if not set
        */
-      account_query_db( const class eosio::chain::controller& chain );
+      account_query_db( const class eosio::chain::controller& chain, const std::optional<boost::filesystem::path>& store_dir = {} );
       ~account_query_db();
 
       /**
@@ -7,6 +7,7 @@
 #include <eosio/chain/controller.hpp>
 #include <eosio/chain/contract_table_objects.hpp>
 #include <eosio/chain/resource_limits.hpp>
+#include <eosio/chain/signal_slots.hpp>
 #include <eosio/chain/transaction.hpp>
 #include <eosio/chain/abi_serializer.hpp>
 #include <eosio/chain/plugin_interface.hpp>
@@ -23,7 +24,9 @@
 #include <boost/multiprecision/cpp_int.hpp>
 
 #include <eosio/chain_plugin/account_query_db.hpp>
+#include <eosio/chain_plugin/trx_status_registry.hpp>
 
+#include <fc/crypto/hex.hpp>
 #include <fc/static_variant.hpp>
 #include <eosio/blockvault_client_plugin/blockvault_client_plugin.hpp>
 
@@ -85,6 +88,31 @@ string convert_to_string(const chain::key256_t& source, const string& key_type,
 template<>
 string convert_to_string(const float128_t& source, const string& key_type, const string& encode_type, const string& desc);
 
+/// @return the opaque get_table_rows cursor of the row at primary_key of a primary index
+string make_table_rows_cursor(uint64_t primary_key);
+void parse_table_rows_cursor(const string& cursor, uint64_t& primary_key);
+
+/// @return the opaque get_table_rows cursor of the row at secondary_key, primary_key of a secondary index
+template<typename SecondaryKey>
+string make_table_rows_cursor(const SecondaryKey& secondary_key, uint64_t primary_key) {
+   static_assert( std::is_trivially_copyable_v<SecondaryKey> );
+   char data[sizeof(SecondaryKey) + sizeof(uint64_t)];
+   memcpy( data, &secondary_key, sizeof(SecondaryKey) );
+   memcpy( data + sizeof(SecondaryKey), &primary_key, sizeof(uint64_t) );
+   return fc::to_hex( data, sizeof(data) );
+}
+
+template<typename SecondaryKey>
+void parse_table_rows_cursor(const string& cursor, SecondaryKey& secondary_key, uint64_t& primary_key) {
+   static_assert( std::is_trivially_copyable_v<SecondaryKey> );
+   char data[sizeof(SecondaryKey) + sizeof(uint64_t)];
+   EOS_ASSERT( cursor.size() == 2 * sizeof(data) && std::all_of( cursor.begin(), cursor.end(), [](char c) { return std::isxdigit(c); } ),
+               chain::contract_table_query_exception, "Invalid cursor ${c} for this index", ("c", cursor) );
+   fc::from_hex( cursor, data, sizeof(data) );
+   memcpy( &secondary_key, data, sizeof(SecondaryKey) );
+   memcpy( &primary_key, data + sizeof(SecondaryKey), sizeof(uint64_t) );
+}
+
 
 class keep_processing {
 public:
@@ -103,6 +131,7 @@ class read_only {
    const std::optional<account_query_db>& aqdb;
    const fc::microseconds abi_serializer_max_time;
    bool  shorten_abi_errors = true;
+   bool  json_rows = false; ///< rows are unpacked to their JSON text, see get_table_rows_json
 
 public:
    static const string KEYi64;
@@ -114,8 +143,20 @@ public:
 
    void set_shorten_abi_errors( bool f ) { shorten_abi_errors = f; }
 
+   /// @return the serializer of the ABI of account from the cache of the controller
+   /// @throws abi_not_found_exception if account has no ABI
+   std::shared_ptr<const abi_serializer> get_abi_serializer( name account ) const;
+
    using get_info_params = empty;
 
+   struct get_info_results;
+   using published_info_ptr = std::shared_ptr<const get_info_results>;
+private:
+   const published_info_ptr* published_info = nullptr;
+public:
+   /// get_info returns info published with std::atomic_store, if any, instead of reading the controller
+   void set_published_info( const published_info_ptr* p ) { published_info = p; }
+
    struct get_info_results {
       string                               server_version;
       chain::chain_id_type                 chain_id;
@@ -345,6 +386,8 @@ public:
       string               encode_type{"dec"}; //dec, hex , default=dec
       std::optional<bool>  reverse;
       std::optional<bool>  show_payer; // show RAM pyer
+      string               cursor; // next_cursor of the previous page, continues right after its last row
+      std::optional<bool>  keys_only; // rows only hold the primary_key (and the secondary_key of a secondary index), no row is decoded
     };
 
    struct get_kv_table_rows_params {
@@ -359,6 +402,8 @@ public:
         uint32_t               limit = 10;            // max number of rows
         bool                   reverse = false;       // if true output rows in reverse order
         bool                   show_payer = false;
+        std::optional<bool>    keys_only;             // rows only hold the keys (key, key_bytes, and primary_key, primary_key_bytes of a secondary index), no row is read or decoded
+        vector<string>         fields;                // with json, only these fields of the decoded rows are returned
    };
 
    struct get_table_rows_result {
@@ -366,9 +411,13 @@ public:
       bool                more = false; ///< true if last element in data is not the end and sizeof data() < limit
       string              next_key; ///< fill lower_bound with this value to fetch more rows
       string              next_key_bytes; ///< fill lower_bound with this value to fetch more rows with encode-type of "bytes"
+      string              next_cursor; ///< fill cursor with this value to fetch more rows, unlike next_key it tells apart rows with the same secondary key
    };
 
    get_table_rows_result get_table_rows( const get_table_rows_params& params )const;
+   /// @return the JSON of get_table_rows, the rows are written as they are unpacked instead of as fc::variant trees
+   /// @param deadline of writing the JSON of the variant results
+   std::string get_table_rows_json( const get_table_rows_params& params, const fc::time_point& deadline )const;
 
    get_table_rows_result get_kv_table_rows( const get_kv_table_rows_params& params )const;
 
@@ -441,6 +490,16 @@ public:
 
    get_producer_schedule_result get_producer_schedule( const get_producer_schedule_params& params )const;
 
+   struct get_block_apply_metrics_params {
+   };
+
+   struct get_block_apply_metrics_result {
+      vector<chain::block_stage_latency> stages; ///< latency histograms since startup, in the order blocks go through them
+      vector<chain::signal_slot_latency> slots;  ///< time spent in the handlers of plugins to the signals, by plugin and signal
+   };
+
+   get_block_apply_metrics_result get_block_apply_metrics( const get_block_apply_metrics_params& params )const;
+
    struct get_scheduled_transactions_params {
       bool        json = false;
       string      lower_bound;  /// timestamp OR transaction ID
@@ -537,7 +596,10 @@ public:
       return [table_type=std::string{type},abis,as_json,this](fc::variant& result_var, const auto& obj) {
          vector<char> data;
          read_only::copy_inline_row(obj, data);
-         if (as_json) {
+         if (as_json && json_rows) {
+            result_var = abis.binary_to_json(table_type, data, abi_serializer::create_yield_function( abi_serializer_max_time ), shorten_abi_errors );
+         }
+         else if (as_json) {
             result_var = abis.binary_to_variant(table_type, data, abi_serializer::create_yield_function( abi_serializer_max_time ), shorten_abi_errors );
          }
          else {
@@ -647,6 +709,7 @@ public:
          if (reached_limit_ || !kp_()) {
             result_.more = true;
             result_.next_key = convert_to_string(row.secondary_key, params_.key_type, params_.encode_type, "next_key - next lower bound");
+            result_.next_cursor = make_table_rows_cursor(row.secondary_key, row.primary_key);
             done_ = true;
          }
          else {
@@ -681,8 +744,8 @@ public:
 
       name scope{ convert_to_type<uint64_t>(p.scope, "scope") };
 
-      abi_serializer abis;
-      abis.set_abi(abi, abi_serializer::create_yield_function( abi_serializer_max_time ) );
+      const auto abis_ptr = get_abi_serializer( p.code );
+      const abi_serializer& abis = *abis_ptr;
       bool primary = false;
       const uint64_t table_with_index = get_table_index_name(p, primary);
       using secondary_key_type = std::result_of_t<decltype(conv)(SecKeyType)>;
@@ -722,6 +785,16 @@ public:
          return result;
 
       const bool reverse = p.reverse && *p.reverse;
+      const bool keys_only = p.keys_only && *p.keys_only;
+      std::optional<std::pair<secondary_key_type, uint64_t>> cursor;
+      if( p.cursor.size() ) {
+         cursor.emplace();
+         parse_table_rows_cursor( p.cursor, cursor->first, cursor->second );
+      }
+      auto keys_of = [&p](const auto& row) -> fc::variant {
+         return fc::mutable_variant_object("primary_key", row.primary_key)
+                                          ("secondary_key", convert_to_string(row.secondary_key, p.key_type, p.encode_type, "secondary_key"));
+      };
       const auto db_backing_store = get_backing_store();
       auto get_prim_key_val = get_primary_key_value(p.table, abis, p.json, p.show_payer);
       if (db_backing_store == eosio::chain::backing_store_type::CHAINBASE) {
@@ -736,11 +809,25 @@ public:
             auto upper_bound_lookup_tuple = std::make_tuple( index_t_id->id._id,
                                                             secondary_key_upper,
                                                             primary_key_upper );
+            if( cursor ) {
+               // the cursor row is the first row of the page
+               auto cursor_lookup_tuple = std::make_tuple( index_t_id->id._id, cursor->first, cursor->second );
+               if( reverse ) {
+                  upper_bound_lookup_tuple = std::min( upper_bound_lookup_tuple, cursor_lookup_tuple );
+               } else {
+                  lower_bound_lookup_tuple = std::max( lower_bound_lookup_tuple, cursor_lookup_tuple );
+               }
+            }
 
             auto walk_table_row_range = [&]( auto itr, auto end_itr ) {
                keep_processing kp;
                vector<char> data;
                for( unsigned int count = 0; kp() && count < p.limit && itr != end_itr; ++itr ) {
+                  if( keys_only ) {
+                     result.rows.emplace_back( keys_of(*itr) );
+                     ++count;
+                     continue;
+                  }
                   const auto* itr2 = d.find<chain::key_value_object, chain::by_scope_primary>( boost::make_tuple(t_id->id, itr->primary_key) );
                   if( itr2 == nullptr ) continue;
 
@@ -751,6 +838,7 @@ public:
                if( itr != end_itr ) {
                   result.more = true;
                   result.next_key = convert_to_string(itr->secondary_key, p.key_type, p.encode_type, "next_key - next lower bound");
+                  result.next_cursor = make_table_rows_cursor(itr->secondary_key, itr->primary_key);
                }
             };
 
@@ -771,6 +859,14 @@ public:
          const auto context = (reverse) ? backing_store::key_context::standalone_reverse : backing_store::key_context::standalone;
          auto lower = chain::backing_store::db_key_value_format::create_full_prefix_secondary_key(p.code, scope, name(table_with_index), secondary_key_lower);
          auto upper = chain::backing_store::db_key_value_format::create_full_prefix_secondary_key(p.code, scope, name(table_with_index), secondary_key_upper);
+         if( cursor ) {
+            // the cursor row is the first row of the page
+            if( reverse && *cursor < std::make_pair(secondary_key_upper, primary_key_upper) ) {
+               upper = chain::backing_store::db_key_value_format::create_full_secondary_key(p.code, scope, name(table_with_index), cursor->first, cursor->second);
+            } else if( !reverse && *cursor > std::make_pair(secondary_key_lower, primary_key_lower) ) {
+               lower = chain::backing_store::db_key_value_format::create_full_secondary_key(p.code, scope, name(table_with_index), cursor->first, cursor->second);
+            }
+         }
          if (reverse) {
             lower = eosio::session::shared_bytes::truncate_key(lower);
          }
@@ -779,7 +875,11 @@ public:
          upper = upper.next();
          const auto& kv_database = db.kv_db();
          auto session = kv_database.get_kv_undo_stack()->top();
-         auto get_primary = [code=p.code,scope,table=p.table,&session,&get_prim_key_val](const chain::backing_store::secondary_index_view<secondary_key_type>& row, vector<fc::variant>& rows) {
+         auto get_primary = [code=p.code,scope,table=p.table,&session,&get_prim_key_val,keys_only,&keys_of](const chain::backing_store::secondary_index_view<secondary_key_type>& row, vector<fc::variant>& rows) {
+            if( keys_only ) {
+               rows.emplace_back(keys_of(row));
+               return;
+            }
             auto full_key = chain::backing_store::db_key_value_format::create_full_primary_key(code, scope, table, row.primary_key);
             auto value = session.read(full_key);
             if( !value ) return;
@@ -803,8 +903,8 @@ public:
 
       name scope { convert_to_type<uint64_t>(p.scope, "scope") };
 
-      abi_serializer abis;
-      abis.set_abi(abi, abi_serializer::create_yield_function( abi_serializer_max_time ));
+      const auto abis_ptr = get_abi_serializer( p.code );
+      const abi_serializer& abis = *abis_ptr;
 
       auto primary_lower = std::numeric_limits<uint64_t>::lowest();
       auto primary_upper = std::numeric_limits<uint64_t>::max();
@@ -829,16 +929,33 @@ public:
          }
       }
 
+      const bool reverse = p.reverse && *p.reverse;
+      if( p.cursor.size() ) {
+         // the cursor row is the first row of the page
+         uint64_t cursor_primary = 0;
+         parse_table_rows_cursor( p.cursor, cursor_primary );
+         if( reverse ) {
+            primary_upper = std::min<uint64_t>( primary_upper, cursor_primary );
+         } else {
+            primary_lower = std::max<uint64_t>( primary_lower, cursor_primary );
+         }
+      }
+
       if( primary_upper < primary_lower )
          return result;
 
-      auto get_prim_key = get_primary_key_value(p.table, abis, p.json, p.show_payer);
+      auto get_prim_val = get_primary_key_value(p.table, abis, p.json, p.show_payer);
+      auto get_prim_key = [keys_only=p.keys_only && *p.keys_only,&get_prim_val](const auto& row) -> fc::variant {
+         if( keys_only )
+            return fc::mutable_variant_object("primary_key", row.primary_key);
+         return get_prim_val(row);
+      };
       auto handle_more = [&result,&p](const auto& row) {
          result.more = true;
          result.next_key = convert_to_string(row.primary_key, p.key_type, p.encode_type, "next_key - next lower bound");
+         result.next_cursor = make_table_rows_cursor(row.primary_key);
       };
 
-      const bool reverse = p.reverse && *p.reverse;
       const auto db_backing_store = get_backing_store();
       if (db_backing_store == eosio::chain::backing_store_type::CHAINBASE) {
          const auto* t_id = d.find<chain::table_id_object, chain::by_code_scope_table>(boost::make_tuple(p.code, scope, p.table));
@@ -917,8 +1034,10 @@ class read_write {
    controller& db;
    const fc::microseconds abi_serializer_max_time;
    const bool api_accept_transactions;
+   std::shared_ptr<trx_status_registry> status_registry;
 public:
-   read_write(controller& db, const fc::microseconds& abi_serializer_max_time, bool api_accept_transactions);
+   read_write(controller& db, const fc::microseconds& abi_serializer_max_time, bool api_accept_transactions,
+              std::shared_ptr<trx_status_registry> status_registry = {});
    void validate() const;
 
    using push_block_params = chain::signed_block_v0;
@@ -937,11 +1056,59 @@ public:
    using push_transactions_results = vector<push_transaction_results>;
    void push_transactions(const push_transactions_params& params, chain::plugin_interface::next_function<push_transactions_results> next);
 
+   /// like push_transactions, but the transactions are validated and their keys recovered in parallel, then queued for
+   /// execution together instead of one after the other
+   using push_transaction_batch_params  = push_transactions_params;
+   using push_transaction_batch_results = push_transactions_results;
+   void push_transaction_batch(const push_transaction_batch_params& params, chain::plugin_interface::next_function<push_transaction_batch_results> next);
+
    using send_transaction_params = push_transaction_params;
    using send_transaction_results = push_transaction_results;
    void send_transaction(const send_transaction_params& params, chain::plugin_interface::next_function<send_transaction_results> next);
 
+   /// acknowledges the transaction once it is handed to the producer, without waiting for its execution, and tracks
+   /// its stages for get_transaction_status
+   using submit_transaction_params = push_transaction_params;
+   struct submit_transaction_results {
+      chain::transaction_id_type  transaction_id;
+   };
+   void submit_transaction(const submit_transaction_params& params, chain::plugin_interface::next_function<submit_transaction_results> next);
+
+   /// long poll: the status of a submitted transaction once its stage is past after, or after wait_ms, at most
+   /// max_transaction_status_wait_ms, with its current status
+   static constexpr uint32_t max_transaction_status_wait_ms = 60 * 1000;
+   struct get_transaction_status_params {
+      chain::transaction_id_type  id;
+      std::optional<trx_stage>    after;
+      uint32_t                    wait_ms = 0;
+   };
+   struct get_transaction_status_results {
+      chain::transaction_id_type            id;
+      trx_stage                             stage = trx_stage::unknown;
+      std::optional<uint32_t>               block_num;
+      std::optional<chain::block_id_type>   block_id;
+      std::optional<fc::time_point_sec>     expiration;
+      std::optional<fc::variant>            trace;
+      std::optional<std::string>            error;
+   };
+   void get_transaction_status(const get_transaction_status_params& params, chain::plugin_interface::next_function<get_transaction_status_results> next);
+
+   using compute_transaction_params = push_transaction_params;
+   using compute_transaction_results = push_transaction_results;
+   /// executes the transaction against the pending block state without signature checks, then discards all of its effects
+   void compute_transaction(const compute_transaction_params& params, chain::plugin_interface::next_function<compute_transaction_results> next);
+
+   /// the calls above for a transaction that is already unpacked, e.g. from a binary request body, which needs
+   /// neither JSON parsing nor ABI encoding
+   void push_transaction(chain::packed_transaction_ptr trx, chain::plugin_interface::next_function<push_transaction_results> next);
+   void send_transaction(chain::packed_transaction_ptr trx, chain::plugin_interface::next_function<send_transaction_results> next);
+   void compute_transaction(chain::packed_transaction_ptr trx, chain::plugin_interface::next_function<compute_transaction_results> next);
+
    friend resolver_factory<read_write>;
+
+private:
+   /// the result of a pushed transaction, its trace with the action traces as a tree
+   push_transaction_results push_transaction_output(const chain::transaction_trace_ptr& trx_trace_ptr) const;
 };
 
  //support for --key_types [sha256,ripemd160] and --encoding [dec/hex]
@@ -1029,7 +1196,7 @@ public:
    void plugin_shutdown();
    void handle_sighup() override;
 
-   chain_apis::read_write get_read_write_api() { return chain_apis::read_write(chain(), get_abi_serializer_max_time(), api_accept_transactions()); }
+   chain_apis::read_write get_read_write_api();
    chain_apis::read_only get_read_only_api() const;
    
    bool accept_block( const chain::signed_block_ptr& block, const chain::block_id_type& id );
@@ -1069,7 +1236,19 @@ public:
    static void handle_bad_alloc();
    
    bool account_queries_enabled() const;
+
+   /// Periodic snapshots of the state, written by producer_plugin, that a dirty state database is restored from
+   struct state_checkpoint_config {
+      fc::path dir;
+      uint32_t interval     = 0; ///< blocks between checkpoints, 0 disables writing them
+      uint32_t max_retained = 2;
+   };
+   const state_checkpoint_config& state_checkpoints() const;
+
+   /// @return the newest state checkpoint in dir, if any
+   static std::optional<fc::path> newest_state_checkpoint( const fc::path& dir );
 private:
+   static bool state_db_is_dirty( const fc::path& state_dir );
    static void log_guard_exception(const chain::guard_exception& e);
 
    unique_ptr<class chain_plugin_impl> my;
@@ -1092,10 +1271,13 @@ FC_REFLECT(eosio::chain_apis::read_only::get_block_info_params, (block_num))
 FC_REFLECT(eosio::chain_apis::read_only::get_block_header_state_params, (block_num_or_id))
 
 FC_REFLECT( eosio::chain_apis::read_write::push_transaction_results, (transaction_id)(processed) )
+FC_REFLECT( eosio::chain_apis::read_write::submit_transaction_results, (transaction_id) )
+FC_REFLECT( eosio::chain_apis::read_write::get_transaction_status_params, (id)(after)(wait_ms) )
+FC_REFLECT( eosio::chain_apis::read_write::get_transaction_status_results, (id)(stage)(block_num)(block_id)(expiration)(trace)(error) )
 
-FC_REFLECT( eosio::chain_apis::read_only::get_table_rows_params, (json)(code)(scope)(table)(table_key)(lower_bound)(upper_bound)(limit)(key_type)(index_position)(encode_type)(reverse)(show_payer) )
-FC_REFLECT( eosio::chain_apis::read_only::get_kv_table_rows_params, (json)(code)(table)(index_name)(encode_type)(index_value)(lower_bound)(upper_bound)(limit)(reverse)(show_payer) )
-FC_REFLECT( eosio::chain_apis::read_only::get_table_rows_result, (rows)(more)(next_key)(next_key_bytes) );
+FC_REFLECT( eosio::chain_apis::read_only::get_table_rows_params, (json)(code)(scope)(table)(table_key)(lower_bound)(upper_bound)(limit)(key_type)(index_position)(encode_type)(reverse)(show_payer)(cursor)(keys_only) )
+FC_REFLECT( eosio::chain_apis::read_only::get_kv_table_rows_params, (json)(code)(table)(index_name)(encode_type)(index_value)(lower_bound)(upper_bound)(limit)(reverse)(show_payer)(keys_only)(fields) )
+FC_REFLECT( eosio::chain_apis::read_only::get_table_rows_result, (rows)(more)(next_key)(next_key_bytes)(next_cursor) );
 
 FC_REFLECT( eosio::chain_apis::read_only::get_table_by_scope_params, (code)(table)(lower_bound)(upper_bound)(limit)(reverse) )
 FC_REFLECT( eosio::chain_apis::read_only::get_table_by_scope_result_row, (code)(scope)(table)(payer)(count));
@@ -1110,6 +1292,8 @@ FC_REFLECT( eosio::chain_apis::read_only::get_producers_result, (rows)(total_pro
 
 FC_REFLECT_EMPTY( eosio::chain_apis::read_only::get_producer_schedule_params )
 FC_REFLECT( eosio::chain_apis::read_only::get_producer_schedule_result, (active)(pending)(proposed) );
+FC_REFLECT_EMPTY( eosio::chain_apis::read_only::get_block_apply_metrics_params )
+FC_REFLECT( eosio::chain_apis::read_only::get_block_apply_metrics_result, (stages)(slots) );
 
 FC_REFLECT( eosio::chain_apis::read_only::get_scheduled_transactions_params, (json)(lower_bound)(limit) )
 FC_REFLECT( eosio::chain_apis::read_only::get_scheduled_transactions_result, (transactions)(more) );
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace eosio::chain_apis {
+   /**
+    * Writes the dirty pages of a shared file mapping, the chainbase database in "mapped" mode, back to its file on a
+    * thread of its own, so that neither the kernel writeback under memory pressure nor the sync at shutdown has to
+    * write all of them at once. A pass syncs the mapping in chunks, in order, syncing at most bytes_per_second of the
+    * mapping per second, which bounds the bandwidth the pass writes with. Passes are requested by flush, a request
+    * during a pass starts another one after it.
+    */
+   class database_flusher {
+   public:
+      database_flusher( char* base, size_t size, uint64_t bytes_per_second );
+      ~database_flusher();
+
+      database_flusher( const database_flusher& ) = delete;
+      database_flusher& operator=( const database_flusher& ) = delete;
+
+      /// request a pass
+      void flush();
+
+      /// abandons the current pass and stops the flusher thread
+      void stop();
+
+      /// number of passes completed
+      uint64_t passes() const { return completed.load(); }
+
+   private:
+      void run();
+      bool sync_chunk( size_t offset );
+
+      char*                   base;
+      size_t                  size;
+      const uint64_t          bytes_per_second;
+      size_t                  chunk_size;
+      std::mutex              mtx;
+      std::condition_variable cv;
+      bool                    requested = false; ///< protected by mtx
+      bool                    done = false;      ///< protected by mtx
+      std::atomic<uint64_t>   completed{0};
+      std::thread             thread;
+   };
+}
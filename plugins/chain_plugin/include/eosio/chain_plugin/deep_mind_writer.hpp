@@ -0,0 +1,75 @@
+#pragma once
+#include <fc/log/appender.hpp>
+#include <fc/log/log_message.hpp>
+
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace eosio::chain_apis {
+   /**
+    * Appender of the deep-mind logger which queues its messages on a lock free ring buffer and formats and writes them
+    * to a file descriptor, stdout by default, on a thread of its own, so the main thread only pays for building the
+    * messages. When the buffer is full the main thread waits for the writer, deep-mind output is never dropped.
+    *
+    * Messages are only queued from the main thread, which is the only thread producing deep-mind output.
+    *
+    * With text framing the output is the same as that of the dmlog appender, a "DMLOG <message>" line per message.
+    * With binary framing each message is a record of a 32 bit little endian size followed by that many bytes: the
+    * message without the "DMLOG " prefix and the line feed and, for messages queued with log_payload, a 0 byte and the
+    * raw payload, which text framing prints as a last hex field.
+    */
+   class deep_mind_writer : public fc::appender {
+   public:
+      enum class framing { text, binary };
+
+      deep_mind_writer( framing f, size_t queue_size, int fd = STDOUT_FILENO );
+      ~deep_mind_writer();
+
+      deep_mind_writer( const deep_mind_writer& ) = delete;
+      deep_mind_writer& operator=( const deep_mind_writer& ) = delete;
+
+      /// called when a write fails for another reason than an interruption, on the writer thread; later output is dropped
+      void set_on_error( std::function<void()> f ) { on_error = std::move( f ); }
+
+      void initialize( boost::asio::io_service& ) override {}
+
+      /// queues m, formatted on the writer thread
+      void log( const fc::log_message& m ) override;
+
+      /// queues "<text> <payload>", payload is called on the writer thread and must only read immutable data
+      void log_payload( std::string text, std::function<std::vector<char>()> payload );
+
+      /// writes what is queued and stops the writer thread, later messages are written by the caller
+      void stop();
+
+   private:
+      struct record {
+         std::optional<fc::log_message>      message;
+         std::string                         text;
+         std::function<std::vector<char>()>  payload;
+      };
+
+      void push( record&& r );
+      void run();
+      void append( const record& r );
+      void flush();
+
+      const framing                       frame;
+      const int                           fd;
+      boost::lockfree::spsc_queue<record> queue;
+      std::atomic<bool>                   done{false};
+      std::atomic<bool>                   failed{false};
+      std::function<void()>               on_error;
+      std::string                         buffer; // output of the records consumed, written in batches
+      std::thread                         thread;
+   };
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <eosio/chain/types.hpp>
+#include <eosio/chain/block_state.hpp>
+#include <eosio/chain/trace.hpp>
+
+#include <fc/reflect/reflect.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace eosio::chain_apis {
+   /**
+    * The stages of a transaction submitted through submit_transaction, in the order they are reached.  failed and
+    * expired are final, like irreversible.
+    */
+   enum class trx_stage : uint8_t {
+      unknown,       ///< not tracked, or not anymore
+      accepted,      ///< handed to the producer, not executed yet
+      executed,      ///< executed speculatively, its trace is available
+      in_block,      ///< in a block which is not irreversible yet
+      irreversible,
+      failed,
+      expired        ///< expired before it was in an irreversible block
+   };
+
+   struct trx_status {
+      chain::transaction_id_type    id;
+      trx_stage                     stage = trx_stage::unknown;
+      uint32_t                      block_num = 0;
+      chain::block_id_type          block_id;
+      fc::time_point_sec            expiration;
+      chain::transaction_trace_ptr  trace;      ///< of its last execution
+      std::optional<std::string>    error;
+   };
+
+   /**
+    * This class tracks the stages of the transactions submitted through the API and the long polls waiting for the
+    * next stage of one of them, so that clients are told when a transaction is executed, included in a block and
+    * irreversible without polling get_transaction.  An entry is removed once the last irreversible block is past the
+    * expiration of its transaction.  A transaction in a block which is forked out keeps the stage in_block until it is
+    * included in another block or expires.  A waiter is answered at its deadline by a timer on the io_context given
+    * to the constructor, the blocks may be far apart.  Not thread safe, used on the thread running that io_context.
+    */
+   class trx_status_registry {
+   public:
+      using callback = std::function<void(const trx_status&)>;
+
+      /// @param max_tracked - the maximum number of tracked transactions
+      /// @param ctx - runs the timer answering the waiters at their deadline
+      trx_status_registry( size_t max_tracked, boost::asio::io_context& ctx );
+
+      /// track a submitted transaction from the accepted stage
+      /// @return false if max_tracked transactions are tracked already
+      bool track( const chain::transaction_id_type& id, fc::time_point_sec expiration );
+
+      void failed( const chain::transaction_id_type& id, const std::string& error );
+      void applied( const chain::transaction_trace_ptr& trace );
+      void accepted_block( const chain::block_state_ptr& bsp );
+      void irreversible_block( const chain::block_state_ptr& bsp );
+
+      /// call cb with the status of id once its stage is past after, or with its current status at deadline
+      void wait( const chain::transaction_id_type& id, trx_stage after, fc::time_point deadline, callback cb );
+
+      /// answer the waiters past their deadline, expire the transactions the last irreversible block is past the
+      /// expiration of and remove the entries which ended, called for each block
+      void expire( fc::time_point now );
+
+      size_t size() const { return entries.size(); }
+
+   private:
+      struct waiter {
+         trx_stage       after;
+         fc::time_point  deadline;
+         callback        cb;
+      };
+
+      struct entry {
+         trx_status           status;
+         std::vector<waiter>  waiters;
+      };
+
+      /// answer the waiters of e whose stage has been passed
+      static void notify( entry& e );
+
+      /// answer the waiters of e past their deadline
+      static void expire_waiters( entry& e, fc::time_point now );
+
+      /// arm the timer for deadline unless it is armed for an earlier one
+      void arm_timer( fc::time_point deadline );
+
+      template<typename F>
+      void for_each_tracked( const chain::block_state_ptr& bsp, F&& f );
+
+      const size_t                                            max_tracked;
+      std::unordered_map<chain::transaction_id_type, entry>   entries;
+      fc::time_point_sec                                      lib_time;
+      boost::asio::steady_timer                               deadline_timer;
+      fc::time_point                                          timer_deadline = fc::time_point::maximum();
+   };
+}
+
+FC_REFLECT_ENUM( eosio::chain_apis::trx_stage, (unknown)(accepted)(executed)(in_block)(irreversible)(failed)(expired) )
@@ -5,6 +5,7 @@
 #include <eosio/chain/types.hpp>
 #include <eosio/chain/block_state.hpp>
 #include <eosio/chain_plugin/account_query_db.hpp>
+#include <fc/filesystem.hpp>
 
 #ifdef NON_VALIDATING_TEST
 #define TESTER tester
@@ -97,6 +98,82 @@ BOOST_FIXTURE_TEST_CASE(updateauth_test, TESTER) { try {
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_FIXTURE_TEST_CASE(store_test, TESTER) { try {
+   fc::temp_directory tempdir;
+   const boost::filesystem::path store_dir = tempdir.path();
+   const auto& tester_account = "tester"_n;
+   const string role = "first";
+
+   params pars;
+   pars.keys.emplace_back(get_public_key(tester_account, role));
+   pars.accounts.emplace_back(permission_level{"alice"_n, {}});
+
+   {
+      auto aq_db = account_query_db(*control, store_dir);
+      auto c = control->accepted_block.connect([&](const block_state_ptr& blk) {
+         aq_db.commit_block( blk);
+      });
+
+      produce_blocks(10);
+      create_account(tester_account);
+      create_account("alice"_n);
+
+      auto trace_ptr = push_action(config::system_account_name, updateauth::get_name(), tester_account, fc::mutable_variant_object()
+            ("account", tester_account)
+            ("permission", "role"_n)
+            ("parent", "active")
+            ("auth",  authority(get_public_key(tester_account, role), 5))
+      );
+      aq_db.cache_transaction_trace(trace_ptr);
+      trace_ptr = push_action(config::system_account_name, updateauth::get_name(), tester_account, fc::mutable_variant_object()
+            ("account", tester_account)
+            ("permission", "other"_n)
+            ("parent", "active")
+            ("auth",  authority(2, {}, {permission_level_weight{{"alice"_n, config::active_name}, 3}}))
+      );
+      aq_db.cache_transaction_trace(trace_ptr);
+      produce_block();
+
+      const auto results = aq_db.get_accounts_by_authorizers(pars);
+      BOOST_TEST_REQUIRE(results.accounts.size() == 2u);
+      BOOST_TEST_REQUIRE(find_account_auth(results, tester_account, "role"_n) == true);
+      BOOST_TEST_REQUIRE(find_account_auth(results, tester_account, "other"_n) == true);
+      c.disconnect();
+   }
+
+   // reopened at the same head the store is reused without a rebuild
+   auto aq_db = account_query_db(*control, store_dir);
+   auto c = control->accepted_block.connect([&](const block_state_ptr& blk) {
+      aq_db.commit_block( blk);
+   });
+
+   auto results = aq_db.get_accounts_by_authorizers(pars);
+   BOOST_TEST_REQUIRE(results.accounts.size() == 2u);
+   for (const auto& acc : results.accounts) {
+      if (acc.permission_name == "other"_n) {
+         BOOST_TEST_REQUIRE(acc.authorizing_account.has_value());
+         BOOST_TEST(acc.weight == 3);
+         BOOST_TEST(acc.threshold == 2u);
+      } else {
+         BOOST_TEST_REQUIRE(acc.authorizing_key.has_value());
+         BOOST_TEST(acc.weight == 1);
+         BOOST_TEST(acc.threshold == 5u);
+      }
+   }
+
+   const auto trace_ptr = push_action(config::system_account_name, deleteauth::get_name(), tester_account, fc::mutable_variant_object()
+         ("account", tester_account)
+         ("permission", "role"_n)
+   );
+   aq_db.cache_transaction_trace(trace_ptr);
+   produce_block();
+
+   results = aq_db.get_accounts_by_authorizers(pars);
+   BOOST_TEST_REQUIRE(find_account_auth(results, tester_account, "role"_n) == false);
+   BOOST_TEST_REQUIRE(find_account_auth(results, tester_account, "other"_n) == true);
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE(future_fork_test) { try {
    tester node_a(setup_policy::none);
    tester node_b(setup_policy::none);
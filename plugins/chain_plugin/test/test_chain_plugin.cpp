@@ -11,6 +11,7 @@
 #include <eosio/chain/resource_limits.hpp>
 #include <eosio/chain/wast_to_wasm.hpp>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <fc/log/logger.hpp>
@@ -351,7 +352,7 @@ public:
         }
         produce_blocks( 250 );
 
-        auto producer_keys = control->head_block_state()->active_schedule.producers;
+        auto producer_keys = control->head_block_state()->active_schedule->producers;
         BOOST_CHECK_EQUAL( 21, producer_keys.size() );
         BOOST_CHECK_EQUAL( name("defproducera"), producer_keys[0].producer_name );
 
@@ -508,4 +509,38 @@ BOOST_FIXTURE_TEST_CASE(account_results_rex_info_test, chain_plugin_tester) { tr
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE(newest_state_checkpoint_test) { try {
+   fc::temp_directory tempdir;
+   BOOST_CHECK(!chain_plugin::newest_state_checkpoint(tempdir.path() / "missing"));
+   BOOST_CHECK(!chain_plugin::newest_state_checkpoint(tempdir.path()));
+
+   auto checkpoint_id = [](uint32_t block_num) {
+      block_id_type id = fc::sha256::hash(std::to_string(block_num));
+      id._hash[0] &= 0xffffffff00000000;
+      id._hash[0] += fc::endian_reverse_u32(block_num);
+      return id;
+   };
+   auto touch = [&](const std::string& name) {
+      std::ofstream(( tempdir.path() / name ).generic_string()) << name;
+   };
+   touch("snapshot-" + checkpoint_id(200).str() + ".bin");
+   touch("snapshot-" + checkpoint_id(1000).str() + ".bin");
+   touch("snapshot-" + checkpoint_id(300).str() + ".bin");
+   // not final yet
+   touch(".pending-snapshot-" + checkpoint_id(2000).str() + ".bin");
+   touch(".incomplete-snapshot-" + checkpoint_id(3000).str() + ".bin");
+   touch("snapshot-unrelated.bin");
+
+   auto newest = chain_plugin::newest_state_checkpoint(tempdir.path());
+   BOOST_REQUIRE(newest);
+   BOOST_CHECK_EQUAL(newest->filename().generic_string(), "snapshot-" + checkpoint_id(1000).str() + ".bin");
+
+   // compressed checkpoints count as well
+   touch("snapshot-" + checkpoint_id(1500).str() + ".bin.gz");
+   touch(".pending-snapshot-" + checkpoint_id(2500).str() + ".bin.gz");
+   newest = chain_plugin::newest_state_checkpoint(tempdir.path());
+   BOOST_REQUIRE(newest);
+   BOOST_CHECK_EQUAL(newest->filename().generic_string(), "snapshot-" + checkpoint_id(1500).str() + ".bin.gz");
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
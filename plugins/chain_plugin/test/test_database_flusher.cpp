@@ -0,0 +1,85 @@
+#define BOOST_TEST_MODULE database_flusher
+#include <boost/test/included/unit_test.hpp>
+#include <eosio/chain_plugin/database_flusher.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace eosio::chain_apis;
+
+namespace {
+   // shared mapping of a temporary file
+   struct mapped_file {
+      FILE*  file = tmpfile();
+      size_t size;
+      char*  data;
+
+      explicit mapped_file( size_t size ) : size( size ) {
+         BOOST_REQUIRE( ftruncate( fileno( file ), size ) == 0 );
+         data = static_cast<char*>( mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileno( file ), 0 ) );
+         BOOST_REQUIRE( data != MAP_FAILED );
+      }
+      ~mapped_file() {
+         munmap( data, size );
+         fclose( file );
+      }
+   };
+
+   void wait_for_passes( const database_flusher& f, uint64_t passes ) {
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 30 );
+      while( f.passes() < passes && std::chrono::steady_clock::now() < deadline )
+         std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+      BOOST_REQUIRE_GE( f.passes(), passes );
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(database_flusher_tests)
+
+BOOST_AUTO_TEST_CASE(flushes_on_request) {
+   mapped_file m( 1024 * 1024 );
+   database_flusher f( m.data, m.size, 100 * 1024 * 1024 );
+   BOOST_TEST( f.passes() == 0u );
+
+   std::memset( m.data, 'x', m.size );
+   f.flush();
+   wait_for_passes( f, 1 );
+
+   std::vector<char> content( m.size );
+   BOOST_REQUIRE( pread( fileno( m.file ), content.data(), content.size(), 0 ) == ssize_t( content.size() ) );
+   BOOST_TEST( std::all_of( content.begin(), content.end(), []( char c ) { return c == 'x'; } ) );
+
+   f.flush();
+   wait_for_passes( f, 2 );
+}
+
+BOOST_AUTO_TEST_CASE(paces_passes) {
+   // an unaligned start is rounded down to the page of the mapping
+   mapped_file m( 1024 * 1024 );
+   const auto start = std::chrono::steady_clock::now();
+   database_flusher f( m.data + 100, m.size - 100, 4 * 1024 * 1024 );
+   f.flush();
+   wait_for_passes( f, 1 );
+   // a MiB at 4 MiB/s
+   BOOST_TEST( std::chrono::steady_clock::now() - start >= std::chrono::milliseconds( 200 ) );
+}
+
+BOOST_AUTO_TEST_CASE(stop_abandons_pass) {
+   mapped_file m( 16 * 1024 * 1024 );
+   database_flusher f( m.data, m.size, 1024 * 1024 );
+   f.flush();
+   const auto start = std::chrono::steady_clock::now();
+   f.stop();
+   // the pass would take 16 seconds
+   BOOST_TEST( std::chrono::steady_clock::now() - start < std::chrono::seconds( 5 ) );
+   BOOST_TEST( f.passes() == 0u );
+   f.stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
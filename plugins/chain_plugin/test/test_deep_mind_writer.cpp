@@ -0,0 +1,75 @@
+#define BOOST_TEST_MODULE deep_mind_writer
+#include <boost/test/included/unit_test.hpp>
+#include <eosio/chain_plugin/deep_mind_writer.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/variant_object.hpp>
+
+#include <cstdio>
+
+using namespace eosio::chain_apis;
+
+namespace {
+   // output of a writer to a temporary file, after stopping it
+   struct captured_output {
+      FILE* file = tmpfile();
+      ~captured_output() { fclose( file ); }
+
+      std::string read() {
+         std::string result;
+         rewind( file );
+         char buf[4096];
+         size_t n;
+         while( (n = fread( buf, 1, sizeof(buf), file )) > 0 )
+            result.append( buf, n );
+         return result;
+      }
+   };
+
+   void log_test_messages( deep_mind_writer& w ) {
+      w.log( FC_LOG_MESSAGE( debug, "START_BLOCK ${num}", ("num", 7) ) );
+      w.log_payload( "ACCEPTED_BLOCK 7", []() { return std::vector<char>{ '\x01', '\xab' }; } );
+      w.log_payload( "EMPTY 0", []() { return std::vector<char>{}; } );
+   }
+
+   std::string record( const std::string& body ) {
+      std::string r;
+      for( size_t i = 0; i < sizeof(uint32_t); ++i )
+         r += static_cast<char>( (body.size() >> (8 * i)) & 0xff );
+      return r + body;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(deep_mind_writer_tests)
+
+BOOST_AUTO_TEST_CASE(text_framing) {
+   captured_output out;
+   deep_mind_writer w( deep_mind_writer::framing::text, 2, fileno( out.file ) );
+   log_test_messages( w );
+   w.stop();
+   BOOST_CHECK_EQUAL( out.read(), "DMLOG START_BLOCK 7\nDMLOG ACCEPTED_BLOCK 7 01ab\nDMLOG EMPTY 0 \n" );
+}
+
+BOOST_AUTO_TEST_CASE(binary_framing) {
+   captured_output out;
+   deep_mind_writer w( deep_mind_writer::framing::binary, 2, fileno( out.file ) );
+   log_test_messages( w );
+   w.stop();
+   BOOST_CHECK_EQUAL( out.read(), record( "START_BLOCK 7" ) + record( std::string( "ACCEPTED_BLOCK 7\0\x01\xab", 19 ) ) + record( std::string( "EMPTY 0\0", 8 ) ) );
+}
+
+BOOST_AUTO_TEST_CASE(keeps_order_when_full) {
+   captured_output out;
+   deep_mind_writer w( deep_mind_writer::framing::text, 1, fileno( out.file ) );
+   std::string expected;
+   for( int i = 0; i < 1000; ++i ) {
+      w.log( FC_LOG_MESSAGE( debug, "MSG ${i}", ("i", i) ) );
+      expected += "DMLOG MSG " + std::to_string( i ) + "\n";
+   }
+   w.stop();
+   // written by the caller after stop
+   w.log( FC_LOG_MESSAGE( debug, "AFTER" ) );
+   BOOST_CHECK_EQUAL( out.read(), expected + "DMLOG AFTER\n" );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
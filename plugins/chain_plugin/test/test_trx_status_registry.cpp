@@ -0,0 +1,118 @@
+#define BOOST_TEST_MODULE trx_status_registry
+#include <boost/test/included/unit_test.hpp>
+#include <eosio/testing/tester.hpp>
+#include <eosio/chain/block_state.hpp>
+#include <eosio/chain_plugin/trx_status_registry.hpp>
+
+#include <vector>
+
+using namespace eosio;
+using namespace eosio::chain;
+using namespace eosio::testing;
+using namespace eosio::chain_apis;
+
+BOOST_AUTO_TEST_SUITE(trx_status_registry_tests)
+
+BOOST_FIXTURE_TEST_CASE(stages_test, tester) { try {
+   boost::asio::io_context ctx;
+   trx_status_registry registry( 10, ctx );
+   auto c1 = control->applied_transaction.connect( [&]( std::tuple<const transaction_trace_ptr&, const packed_transaction_ptr&> t ) {
+      registry.applied( std::get<0>( t ) );
+   } );
+   auto c2 = control->accepted_block.connect( [&]( const block_state_ptr& blk ) { registry.accepted_block( blk ); } );
+   auto c3 = control->irreversible_block.connect( [&]( const block_state_ptr& blk ) { registry.irreversible_block( blk ); } );
+
+   produce_blocks( 2 );
+
+   signed_transaction trx;
+   trx.actions.emplace_back( vector<permission_level>{{config::system_account_name, config::active_name}},
+                             newaccount{ config::system_account_name, "alice"_n,
+                                         authority( get_public_key( "alice"_n, "owner" ) ),
+                                         authority( get_public_key( "alice"_n, "active" ) ) } );
+   set_transaction_headers( trx );
+   trx.sign( get_private_key( config::system_account_name, "active" ), control->get_chain_id() );
+   const auto id = trx.id();
+   BOOST_REQUIRE( registry.track( id, trx.expiration ) );
+
+   std::vector<trx_stage> seen;
+   auto wait_next = [&]( trx_stage after ) {
+      registry.wait( id, after, fc::time_point::now() + fc::seconds( 60 ), [&]( const trx_status& s ) { seen.push_back( s.stage ); } );
+   };
+
+   wait_next( trx_stage::accepted );
+   BOOST_CHECK( seen.empty() );
+   push_transaction( trx );
+   BOOST_REQUIRE_EQUAL( seen.size(), 1u );
+   BOOST_CHECK( seen.back() == trx_stage::executed );
+
+   wait_next( trx_stage::executed );
+   produce_block();
+   BOOST_REQUIRE_EQUAL( seen.size(), 2u );
+   BOOST_CHECK( seen.back() == trx_stage::in_block );
+
+   // a stage which is already past is answered at once
+   wait_next( trx_stage::accepted );
+   BOOST_REQUIRE_EQUAL( seen.size(), 3u );
+   BOOST_CHECK( seen.back() == trx_stage::in_block );
+
+   wait_next( trx_stage::in_block );
+   produce_blocks( 3 );
+   BOOST_REQUIRE_EQUAL( seen.size(), 4u );
+   BOOST_CHECK( seen.back() == trx_stage::irreversible );
+
+   // untracked transactions are unknown
+   registry.wait( transaction_id_type(), trx_stage::unknown, fc::time_point::now() + fc::seconds( 60 ),
+                  [&]( const trx_status& s ) { seen.push_back( s.stage ); } );
+   BOOST_REQUIRE_EQUAL( seen.size(), 5u );
+   BOOST_CHECK( seen.back() == trx_stage::unknown );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(limits_and_deadlines_test) { try {
+   boost::asio::io_context ctx;
+   trx_status_registry registry( 1, ctx );
+   const auto a = fc::sha256::hash( std::string( "a" ) );
+   const auto b = fc::sha256::hash( std::string( "b" ) );
+   const auto expiration = fc::time_point_sec( fc::time_point::now() ) + 60;
+   BOOST_CHECK( registry.track( a, expiration ) );
+   BOOST_CHECK( registry.track( a, expiration ) );
+   BOOST_CHECK( !registry.track( b, expiration ) );
+
+   std::vector<trx_stage> seen;
+   const auto now = fc::time_point::now();
+   registry.wait( a, trx_stage::accepted, now + fc::milliseconds( 100 ), [&]( const trx_status& s ) { seen.push_back( s.stage ); } );
+   registry.expire( now );
+   BOOST_CHECK( seen.empty() );
+   registry.expire( now + fc::milliseconds( 100 ) );
+   BOOST_REQUIRE_EQUAL( seen.size(), 1u );
+   BOOST_CHECK( seen.back() == trx_stage::accepted );
+
+   registry.wait( a, trx_stage::accepted, now + fc::seconds( 60 ), [&]( const trx_status& s ) { seen.push_back( s.stage ); } );
+   registry.failed( a, "rejected" );
+   BOOST_REQUIRE_EQUAL( seen.size(), 2u );
+   BOOST_CHECK( seen.back() == trx_stage::failed );
+   BOOST_CHECK_EQUAL( registry.size(), 1u );
+} FC_LOG_AND_RETHROW() }
+
+// waiters are answered at their deadline without a block calling expire
+BOOST_AUTO_TEST_CASE(deadline_timer_test) { try {
+   boost::asio::io_context ctx;
+   trx_status_registry registry( 10, ctx );
+   const auto a = fc::sha256::hash( std::string( "a" ) );
+   BOOST_REQUIRE( registry.track( a, fc::time_point_sec( fc::time_point::now() ) + 60 ) );
+
+   std::vector<std::pair<trx_stage, fc::time_point>> seen;
+   auto record = [&]( const trx_status& s ) { seen.emplace_back( s.stage, fc::time_point::now() ); };
+   const auto start = fc::time_point::now();
+   registry.wait( a, trx_stage::accepted, start + fc::milliseconds( 200 ), record );
+   // an earlier deadline re-arms the timer
+   registry.wait( a, trx_stage::accepted, start + fc::milliseconds( 50 ), record );
+   ctx.run();
+
+   BOOST_REQUIRE_EQUAL( seen.size(), 2u );
+   BOOST_CHECK( seen[0].first == trx_stage::accepted );
+   BOOST_CHECK_GE( ( seen[0].second - start ).count(), fc::milliseconds( 50 ).count() );
+   BOOST_CHECK_LT( ( seen[0].second - start ).count(), fc::milliseconds( 200 ).count() );
+   BOOST_CHECK_GE( ( seen[1].second - start ).count(), fc::milliseconds( 200 ).count() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
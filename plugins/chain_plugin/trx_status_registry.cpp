@@ -0,0 +1,165 @@
+#include <eosio/chain_plugin/trx_status_registry.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+namespace eosio::chain_apis {
+
+   trx_status_registry::trx_status_registry( size_t max_tracked, boost::asio::io_context& ctx )
+   : max_tracked( max_tracked )
+   , deadline_timer( ctx )
+   {}
+
+   bool trx_status_registry::track( const chain::transaction_id_type& id, fc::time_point_sec expiration ) {
+      auto itr = entries.find( id );
+      if( itr != entries.end() )
+         return true;
+      if( entries.size() >= max_tracked )
+         return false;
+      auto& e = entries[id];
+      e.status.id = id;
+      e.status.stage = trx_stage::accepted;
+      e.status.expiration = expiration;
+      return true;
+   }
+
+   void trx_status_registry::failed( const chain::transaction_id_type& id, const std::string& error ) {
+      auto itr = entries.find( id );
+      if( itr == entries.end() || itr->second.status.stage >= trx_stage::in_block )
+         return;
+      itr->second.status.stage = trx_stage::failed;
+      itr->second.status.error = error;
+      notify( itr->second );
+   }
+
+   void trx_status_registry::applied( const chain::transaction_trace_ptr& trace ) {
+      if( !trace || !trace->receipt || trace->except )
+         return;
+      auto itr = entries.find( trace->id );
+      if( itr == entries.end() )
+         return;
+      auto& status = itr->second.status;
+      status.trace = trace;
+      if( status.stage < trx_stage::executed ) {
+         status.stage = trx_stage::executed;
+         notify( itr->second );
+      }
+   }
+
+   template<typename F>
+   void trx_status_registry::for_each_tracked( const chain::block_state_ptr& bsp, F&& f ) {
+      if( entries.empty() )
+         return;
+      for( const auto& receipt : bsp->block->transactions ) {
+         const auto& id = std::holds_alternative<chain::transaction_id_type>( receipt.trx )
+                             ? std::get<chain::transaction_id_type>( receipt.trx )
+                             : std::get<chain::packed_transaction>( receipt.trx ).id();
+         auto itr = entries.find( id );
+         if( itr != entries.end() )
+            f( itr->second );
+      }
+   }
+
+   void trx_status_registry::accepted_block( const chain::block_state_ptr& bsp ) {
+      for_each_tracked( bsp, [&]( entry& e ) {
+         if( e.status.stage == trx_stage::irreversible )
+            return;
+         e.status.stage = trx_stage::in_block;
+         e.status.block_num = bsp->block_num;
+         e.status.block_id = bsp->id;
+         e.status.error.reset();
+         notify( e );
+      } );
+   }
+
+   void trx_status_registry::irreversible_block( const chain::block_state_ptr& bsp ) {
+      lib_time = bsp->block->timestamp;
+      for_each_tracked( bsp, [&]( entry& e ) {
+         e.status.stage = trx_stage::irreversible;
+         e.status.block_num = bsp->block_num;
+         e.status.block_id = bsp->id;
+         e.status.error.reset();
+         notify( e );
+      } );
+   }
+
+   void trx_status_registry::wait( const chain::transaction_id_type& id, trx_stage after, fc::time_point deadline, callback cb ) {
+      auto itr = entries.find( id );
+      if( itr == entries.end() ) {
+         trx_status status;
+         status.id = id;
+         cb( status );
+         return;
+      }
+      if( itr->second.status.stage > after || deadline <= fc::time_point::now() ) {
+         cb( itr->second.status );
+         return;
+      }
+      itr->second.waiters.push_back( waiter{ after, deadline, std::move( cb ) } );
+      arm_timer( deadline );
+   }
+
+   void trx_status_registry::arm_timer( fc::time_point deadline ) {
+      if( deadline >= timer_deadline )
+         return;
+      timer_deadline = deadline;
+      const auto delay = std::max<int64_t>( ( deadline - fc::time_point::now() ).count(), 0 );
+      deadline_timer.expires_after( std::chrono::microseconds( delay ) );
+      deadline_timer.async_wait( [this]( const boost::system::error_code& ec ) {
+         // aborted when re-armed for an earlier deadline or when the registry is destroyed
+         if( ec == boost::asio::error::operation_aborted )
+            return;
+         timer_deadline = fc::time_point::maximum();
+         const auto now = fc::time_point::now();
+         auto next = fc::time_point::maximum();
+         for( auto& [id, e] : entries ) {
+            expire_waiters( e, now );
+            for( const auto& w : e.waiters )
+               next = std::min( next, w.deadline );
+         }
+         if( next != fc::time_point::maximum() )
+            arm_timer( std::max( next, now ) );
+      } );
+   }
+
+   void trx_status_registry::expire_waiters( entry& e, fc::time_point now ) {
+      for( auto& w : e.waiters ) {
+         if( w.deadline <= now ) {
+            w.cb( e.status );
+            w.cb = nullptr;
+         }
+      }
+      e.waiters.erase( std::remove_if( e.waiters.begin(), e.waiters.end(), []( const waiter& w ) { return !w.cb; } ),
+                       e.waiters.end() );
+   }
+
+   void trx_status_registry::expire( fc::time_point now ) {
+      for( auto itr = entries.begin(); itr != entries.end(); ) {
+         auto& e = itr->second;
+         const bool past_expiration = e.status.expiration < lib_time;
+         if( past_expiration && e.status.stage < trx_stage::irreversible ) {
+            e.status.stage = trx_stage::expired;
+            e.status.trace.reset();
+            notify( e );
+         }
+         expire_waiters( e, now );
+
+         if( past_expiration && e.waiters.empty() )
+            itr = entries.erase( itr );
+         else
+            ++itr;
+      }
+   }
+
+   void trx_status_registry::notify( entry& e ) {
+      auto waiters = std::move( e.waiters );
+      e.waiters.clear();
+      for( auto& w : waiters ) {
+         if( e.status.stage > w.after )
+            w.cb( e.status );
+         else
+            e.waiters.push_back( std::move( w ) );
+      }
+   }
+
+}
@@ -2,6 +2,7 @@
 #include <fc/io/json.hpp>
 #include <eosio/db_size_api_plugin/db_size_api_plugin.hpp>
 #include <eosio/http_plugin/http_plugin.hpp>
+#include <eosio/chain/signal_slots.hpp>
 
 namespace eosio {
 
@@ -25,11 +26,49 @@ using namespace eosio;
      auto result = api_handle->call_name();
 
 
+void db_size_api_plugin::set_program_options(options_description& cli, options_description& cfg) {
+   cfg.add_options()
+         ("db-size-refresh-interval-ms", boost::program_options::value<uint32_t>()->default_value(1000),
+          "Minimum time between two refreshes of the database statistics, which are taken on the main thread after a block; the requests are answered from the last refresh on the http threads")
+         ;
+}
+
+void db_size_api_plugin::plugin_initialize(const variables_map& vm) {
+   refresh_interval = fc::milliseconds( vm.at("db-size-refresh-interval-ms").as<uint32_t>() );
+}
+
 void db_size_api_plugin::plugin_startup() {
-   app().get_plugin<http_plugin>().add_api({
+   auto& chain = app().get_plugin<chain_plugin>().chain();
+   last_refresh = fc::time_point::now();
+   refresh();
+   accepted_block_connection.emplace(
+      chain.accepted_block.connect(chain::timed_slot("db_size.accepted_block", [this](const chain::block_state_ptr&) {
+         if( fc::time_point::now() - last_refresh >= refresh_interval )
+            refresh();
+      })));
+
+   // the handlers only read the statistics of the last refresh, under stats_mtx
+   http_plugin::api_description api = {
        CALL_WITH_400(db_size, this, get,  INVOKE_R_V(this, get), 200),
        CALL_WITH_400(db_size, this, get_reversible, INVOKE_R_V(this, get_reversible), 200),
-   });
+   };
+   auto& http = app().get_plugin<http_plugin>();
+   for( const auto& call : api )
+      http.add_async_handler( call.first, call.second );
+}
+
+void db_size_api_plugin::plugin_shutdown() {
+   accepted_block_connection.reset();
+}
+
+void db_size_api_plugin::refresh() {
+   const auto& chain = app().get_plugin<chain_plugin>().chain();
+   auto stats = get_db_stats( chain.db() );
+   auto rev_stats = get_db_stats( chain.reversible_db() );
+   last_refresh = fc::time_point::now();
+   std::lock_guard<std::mutex> g( stats_mtx );
+   db_stats = std::move( stats );
+   reversible_stats = std::move( rev_stats );
 }
 
 db_size_stats db_size_api_plugin::get_db_stats(const chainbase::database& db) {
@@ -47,11 +86,13 @@ db_size_stats db_size_api_plugin::get_db_stats(const chainbase::database& db) {
 }
 
 db_size_stats db_size_api_plugin::get() {
-   return get_db_stats(app().get_plugin<chain_plugin>().chain().db());
+   std::lock_guard<std::mutex> g( stats_mtx );
+   return db_stats;
 }
 
 db_size_stats db_size_api_plugin::get_reversible() {
-   return get_db_stats(app().get_plugin<chain_plugin>().chain().reversible_db());
+   std::lock_guard<std::mutex> g( stats_mtx );
+   return reversible_stats;
 }
 
 #undef INVOKE_R_V
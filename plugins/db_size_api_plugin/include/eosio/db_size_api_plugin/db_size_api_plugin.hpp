@@ -5,6 +5,9 @@
 
 #include <appbase/application.hpp>
 
+#include <mutex>
+#include <optional>
+
 namespace eosio {
 
 using namespace appbase;
@@ -32,16 +35,27 @@ public:
    db_size_api_plugin& operator=(db_size_api_plugin&&) = delete;
    virtual ~db_size_api_plugin() override = default;
 
-   virtual void set_program_options(options_description& cli, options_description& cfg) override {}
-   void plugin_initialize(const variables_map& vm) {}
+   virtual void set_program_options(options_description& cli, options_description& cfg) override;
+   void plugin_initialize(const variables_map& vm);
    void plugin_startup();
-   void plugin_shutdown() {}
+   void plugin_shutdown();
 
+   /// the statistics of the last refresh, thread safe
    db_size_stats get();
    db_size_stats get_reversible();
 
 private:
    db_size_stats get_db_stats(const chainbase::database& );
+
+   /// on the main thread, after a block once refresh_interval has passed since the last refresh
+   void refresh();
+
+   fc::microseconds                                  refresh_interval;
+   fc::time_point                                    last_refresh;
+   std::mutex                                        stats_mtx;
+   db_size_stats                                     db_stats;            ///< guarded by stats_mtx
+   db_size_stats                                     reversible_stats;    ///< guarded by stats_mtx
+   std::optional<boost::signals2::scoped_connection> accepted_block_connection;
 };
 
 }
@@ -2,6 +2,7 @@
 #include <eosio/chain/exceptions.hpp>
 
 #include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
 
 namespace eosio {
 
@@ -27,7 +28,20 @@ void history_api_plugin::plugin_initialize(const variables_map&) {}
           } \
        }}
 
+// responds with the result packed in the binary format of its ABI type, the fields in the order of the JSON response
+#define CALL_BINARY_WITH_400(api_name, api_handle, api_namespace, call_name, params_type) \
+{std::string("/v1/" #api_name "/" #call_name), \
+   [api_handle](string, string body, url_response_callback cb, url_binary_response_callback binary_cb) mutable { \
+          try { \
+             auto params = parse_params<api_namespace::call_name ## _params, params_type>(body);\
+             binary_cb(200, fc::raw::pack( api_handle.call_name( std::move(params) ) )); \
+          } catch (...) { \
+             http_plugin::handle_exception(#api_name, #call_name, body, cb); \
+          } \
+       }}
+
 #define CHAIN_RO_CALL(call_name, params_type) CALL_WITH_400(history, ro_api, history_apis::read_only, call_name, params_type)
+#define CHAIN_RO_BINARY_CALL(call_name, params_type) CALL_BINARY_WITH_400(history, ro_api, history_apis::read_only, call_name, params_type)
 //#define CHAIN_RW_CALL(call_name) CALL(history, rw_api, history_apis::read_write, call_name)
 
 void history_api_plugin::plugin_startup() {
@@ -42,6 +56,12 @@ void history_api_plugin::plugin_startup() {
       CHAIN_RO_CALL(get_key_accounts, http_params_types::params_required),
       CHAIN_RO_CALL(get_controlled_accounts, http_params_types::params_required)
    });
+
+   // binary responses for the calls whose results do not hold JSON
+   app().get_plugin<http_plugin>().add_binary_api({
+      CHAIN_RO_BINARY_CALL(get_key_accounts, http_params_types::params_required),
+      CHAIN_RO_BINARY_CALL(get_controlled_accounts, http_params_types::params_required)
+   });
 }
 
 void history_api_plugin::plugin_shutdown() {}
@@ -1,18 +1,24 @@
 #include <eosio/history_plugin/history_plugin.hpp>
 #include <eosio/history_plugin/account_control_history_object.hpp>
 #include <eosio/history_plugin/public_key_history_object.hpp>
+#include <eosio/history_plugin/history_store.hpp>
 #include <eosio/chain/controller.hpp>
 #include <eosio/chain/trace.hpp>
+#include <eosio/chain/signal_slots.hpp>
 #include <eosio/chain_plugin/chain_plugin.hpp>
 
 #include <fc/io/json.hpp>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/signals2/connection.hpp>
 
+#include <cctype>
+
 namespace eosio {
    using namespace chain;
    using boost::signals2::scoped_connection;
+   namespace bfs = boost::filesystem;
 
    static appbase::abstract_plugin& _history_plugin = app().register_plugin<history_plugin>();
 
@@ -142,6 +148,15 @@ namespace eosio {
          std::set<filter_entry> filter_out;
          chain_plugin*          chain_plug = nullptr;
          std::optional<scoped_connection> applied_transaction_connection;
+         std::optional<scoped_connection> block_start_connection;
+         std::optional<scoped_connection> accepted_block_connection;
+         std::optional<scoped_connection> irreversible_block_connection;
+
+         /// when set, the action history is kept in the store instead of chainbase
+         std::unique_ptr<history_store>                       store;
+         std::optional<boost::filesystem::path>               store_dir;
+         std::vector<stored_action_history>                   pending_actions;    ///< of the block being applied
+         std::multimap<uint32_t, reversible_action_history>   reversible_actions; ///< by block_num
 
           bool filter(const action_trace& act) {
             bool pass_on = false;
@@ -250,8 +265,23 @@ namespace eosio {
             }
          }
 
+         void record_stored_action( const action_trace& at ) {
+            auto& chain = chain_plug->chain();
+            auto aset = account_set( at );
+            pending_actions.push_back( stored_action_history{
+                  at.receipt->global_sequence,
+                  chain.head_block_num() + 1,
+                  chain.pending_block_time(),
+                  at.trx_id,
+                  fc::raw::pack( at ),
+                  std::vector<account_name>( aset.begin(), aset.end() ) } );
+         }
+
          void on_action_trace( const action_trace& at ) {
-            if( filter( at ) ) {
+            if( store ) {
+               if( filter( at ) )
+                  record_stored_action( at );
+            } else if( filter( at ) ) {
                //idump((fc::json::to_pretty_string(at)));
                auto& chain = chain_plug->chain();
                chainbase::database& db = const_cast<chainbase::database&>( chain.db() ); // Override read-only access to state DB (highly unrecommended practice!)
@@ -277,6 +307,28 @@ namespace eosio {
                on_system_action( at );
          }
 
+         void on_block_start( uint32_t ) {
+            // actions applied since the last block belonged to a pending block which was aborted
+            pending_actions.clear();
+         }
+
+         void on_accepted_block( const block_state_ptr& bsp ) {
+            reversible_actions.emplace( bsp->block_num, reversible_action_history{ bsp->id, bsp->block_num, std::move( pending_actions ) } );
+            pending_actions.clear();
+         }
+
+         void on_irreversible_block( const block_state_ptr& bsp ) {
+            auto range = reversible_actions.equal_range( bsp->block_num );
+            for( auto itr = range.first; itr != range.second; ++itr ) {
+               if( itr->second.id == bsp->id ) {
+                  store->append( bsp->block_num, std::move( itr->second.actions ) );
+                  break;
+               }
+            }
+            // blocks of other forks at or below the irreversible block will never become irreversible
+            reversible_actions.erase( reversible_actions.begin(), range.second );
+         }
+
          void on_applied_transaction( const transaction_trace_ptr& trace ) {
             if( !trace->receipt || (trace->receipt->status != transaction_receipt_header::executed &&
                   trace->receipt->status != transaction_receipt_header::soft_fail) )
@@ -306,6 +358,10 @@ namespace eosio {
             ("filter-out,F", bpo::value<vector<string>>()->composing(),
              "Do not track actions which match receiver:action:actor. Action and Actor both blank excludes all from Reciever. Actor blank excludes all from reciever:action. Receiver may not be blank.")
             ;
+      cfg.add_options()
+            ("history-dir", bpo::value<bfs::path>(),
+             "the location of a RocksDB database keeping the action history of irreversible blocks instead of the chain state database (absolute path or relative to application data dir)")
+            ;
    }
 
    void history_plugin::plugin_initialize(const variables_map& options) {
@@ -340,9 +396,19 @@ namespace eosio {
             }
          }
 
+         if( options.count( "history-dir" )) {
+            auto hd = options.at( "history-dir" ).as<bfs::path>();
+            if( hd.is_relative())
+               my->store_dir = app().data_dir() / hd;
+            else
+               my->store_dir = hd;
+         }
+
          my->chain_plug = app().find_plugin<chain_plugin>();
          EOS_ASSERT( my->chain_plug, chain::missing_chain_plugin_exception, ""  );
          auto& chain = my->chain_plug->chain();
+         EOS_ASSERT( !chain.get_config().minimal_validation_traces, chain::plugin_config_exception,
+                     "history_plugin requires full traces, it cannot be used with minimal-validation-traces" );
 
          chainbase::database& db = const_cast<chainbase::database&>( chain.db() ); // Override read-only access to state DB (highly unrecommended practice!)
          // TODO: Use separate chainbase database for managing the state of the history_plugin (or remove deprecated history_plugin entirely)
@@ -352,9 +418,34 @@ namespace eosio {
          db.add_index<public_key_history_multi_index>();
 
          my->applied_transaction_connection.emplace(
-               chain.applied_transaction.connect( [&]( std::tuple<const transaction_trace_ptr&, const packed_transaction_ptr&> t ) {
+               chain.applied_transaction.connect( timed_slot( "history.applied_transaction",
+                     [&]( std::tuple<const transaction_trace_ptr&, const packed_transaction_ptr&> t ) {
                   my->on_applied_transaction( std::get<0>(t) );
-               } ));
+               } ) ));
+
+         if( my->store_dir ) {
+            bfs::create_directories( *my->store_dir );
+            my->store = std::make_unique<history_store>( *my->store_dir, chain.get_chain_id() );
+            for( auto& r : my->store->take_reversible() ) {
+               const auto block_num = r.block_num;
+               my->reversible_actions.emplace( block_num, std::move( r ) );
+            }
+            ilog( "history store ${dir} holds the history up to block ${n}, ${r} reversible blocks",
+                  ("dir", my->store_dir->string())("n", my->store->last_block_num())("r", my->reversible_actions.size()) );
+
+            my->block_start_connection.emplace(
+                  chain.block_start.connect( timed_slot( "history.block_start", [&]( uint32_t block_num ) {
+                     my->on_block_start( block_num );
+                  } ) ));
+            my->accepted_block_connection.emplace(
+                  chain.accepted_block.connect( timed_slot( "history.accepted_block", [&]( const block_state_ptr& bsp ) {
+                     my->on_accepted_block( bsp );
+                  } ) ));
+            my->irreversible_block_connection.emplace(
+                  chain.irreversible_block.connect( timed_slot( "history.irreversible_block", [&]( const block_state_ptr& bsp ) {
+                     my->on_irreversible_block( bsp );
+                  } ) ));
+         }
       } FC_LOG_AND_RETHROW()
    }
 
@@ -363,17 +454,53 @@ namespace eosio {
 
    void history_plugin::plugin_shutdown() {
       my->applied_transaction_connection.reset();
+      my->block_start_connection.reset();
+      my->accepted_block_connection.reset();
+      my->irreversible_block_connection.reset();
+      if( my->store ) {
+         // the reversible blocks are restored from the fork database at the next start, keep their actions until then
+         std::vector<reversible_action_history> reversible;
+         for( auto& r : my->reversible_actions )
+            reversible.push_back( std::move( r.second ) );
+         my->store->save_reversible( reversible );
+         my->store.reset();
+      }
    }
 
 
 
 
    namespace history_apis {
+      /// a get_actions cursor holds the account and the position of the next page
+      static string make_actions_cursor( account_name account, int32_t pos ) {
+         char data[sizeof(uint64_t) + sizeof(int32_t)];
+         const auto a = account.to_uint64_t();
+         memcpy( data, &a, sizeof(a) );
+         memcpy( data + sizeof(a), &pos, sizeof(pos) );
+         return fc::to_hex( data, sizeof(data) );
+      }
+
+      static int32_t parse_actions_cursor( const string& cursor, account_name account ) {
+         char data[sizeof(uint64_t) + sizeof(int32_t)];
+         EOS_ASSERT( cursor.size() == 2 * sizeof(data) &&
+                     std::all_of( cursor.begin(), cursor.end(), [](char c) { return std::isxdigit( static_cast<unsigned char>( c ) ); } ),
+                     chain::plugin_exception, "Invalid cursor ${c}", ("c", cursor) );
+         fc::from_hex( cursor, data, sizeof(data) );
+         uint64_t a = 0;
+         int32_t  pos = 0;
+         memcpy( &a, data, sizeof(a) );
+         memcpy( &pos, data + sizeof(a), sizeof(pos) );
+         EOS_ASSERT( a == account.to_uint64_t(), chain::plugin_exception, "Cursor ${c} was not returned for account ${a}",
+                     ("c", cursor)("a", account) );
+         return pos;
+      }
+
       read_only::get_actions_result read_only::get_actions( const read_only::get_actions_params& params )const {
          edump((params));
         auto& chain = history->chain_plug->chain();
         const auto& db = chain.db();
         const auto abi_serializer_max_time = history->chain_plug->get_abi_serializer_max_time();
+        const auto* store = history->store.get();
 
         const auto& idx = db.get_index<account_history_index, by_account_action_seq>();
 
@@ -382,16 +509,21 @@ namespace eosio {
         int32_t end = 0;
         int32_t offset = params.offset ? *params.offset : -20;
         auto n = params.account_name;
-        idump((pos));
-        if( pos == -1 ) {
-            auto itr = idx.lower_bound( boost::make_tuple( name(n.to_uint64_t()+1), 0 ) );
-            if( itr == idx.begin() ) {
-               if( itr->account == n )
-                  pos = itr->account_sequence_num+1;
-            } else if( itr != idx.begin() ) --itr;
 
-            if( itr->account == n )
-               pos = itr->account_sequence_num + 1;
+        if( params.cursor ) {
+           pos = parse_actions_cursor( *params.cursor, n );
+        } else if( pos == -1 ) {
+           if( store ) {
+              if( auto last = store->last_account_sequence_num( n ) )
+                 pos = *last + 1;
+           } else {
+              auto itr = idx.lower_bound( boost::make_tuple( name(n.to_uint64_t()+1), 0 ) );
+              if( itr != idx.begin() ) {
+                 --itr;
+                 if( itr->account == n )
+                    pos = itr->account_sequence_num + 1;
+              }
+           }
         }
 
         if( pos== -1 ) pos = 0xfffffff;
@@ -406,39 +538,70 @@ namespace eosio {
         }
         EOS_ASSERT( end >= start, chain::plugin_exception, "end position is earlier than start position" );
 
-        idump((start)(end));
-
-        auto start_itr = idx.lower_bound( boost::make_tuple( n, start ) );
-        auto end_itr = idx.upper_bound( boost::make_tuple( n, end) );
+        // negative offsets page backwards from the latest actions, walk them from the end so that a page cut short
+        // by the time limit holds the latest ones and the cursor continues below them
+        const bool descending = offset <= 0;
+        const bool raw = params.raw && *params.raw;
 
         auto start_time = fc::time_point::now();
-        auto end_time = start_time;
 
         get_actions_result result;
         result.last_irreversible_block = chain.last_irreversible_block_num();
-        while( start_itr != end_itr ) {
-           const auto& a = db.get<action_history_object, by_action_sequence_num>( start_itr->action_sequence_num );
-           fc::datastream<const char*> ds( a.packed_action_trace.data(), a.packed_action_trace.size() );
-           action_trace t;
-           fc::raw::unpack( ds, t );
-           result.actions.emplace_back( ordered_action_result{
-                                 start_itr->action_sequence_num,
-                                 start_itr->account_sequence_num,
-                                 a.block_num, a.block_time,
-                                 chain.to_variant_with_abi(t, abi_serializer::create_yield_function( abi_serializer_max_time ))
-                                 });
-
-           end_time = fc::time_point::now();
-           if( end_time - start_time > fc::microseconds(100000) ) {
+        auto add_action = [&]( uint64_t global_seq, int32_t account_seq, uint32_t block_num, block_timestamp_type block_time,
+                               const char* packed_action_trace, size_t size ) {
+           ordered_action_result r{ global_seq, account_seq, block_num, block_time };
+           if( raw ) {
+              r.packed_action_trace.emplace( packed_action_trace, packed_action_trace + size );
+           } else {
+              fc::datastream<const char*> ds( packed_action_trace, size );
+              action_trace t;
+              fc::raw::unpack( ds, t );
+              r.action_trace = chain.to_variant_with_abi(t, abi_serializer::create_yield_function( abi_serializer_max_time ));
+           }
+           result.actions.emplace_back( std::move( r ) );
+
+           if( fc::time_point::now() - start_time > fc::microseconds(100000) ) {
               result.time_limit_exceeded_error = true;
-              break;
+              return false;
+           }
+           return true;
+        };
+
+        if( store ) {
+           store->for_each_account_action( n, start, end, descending, [&]( int32_t account_sequence_num, const stored_action_history& a ) {
+              return add_action( a.action_sequence_num, account_sequence_num, a.block_num, a.block_time,
+                                 a.packed_action_trace.data(), a.packed_action_trace.size() );
+           } );
+        } else {
+           auto visit = [&]( const account_history_object& aho ) {
+              const auto& a = db.get<action_history_object, by_action_sequence_num>( aho.action_sequence_num );
+              return add_action( aho.action_sequence_num, aho.account_sequence_num, a.block_num, a.block_time,
+                                 a.packed_action_trace.data(), a.packed_action_trace.size() );
+           };
+           auto start_itr = idx.lower_bound( boost::make_tuple( n, start ) );
+           auto end_itr = idx.upper_bound( boost::make_tuple( n, end) );
+           if( descending ) {
+              for( auto itr = end_itr; itr != start_itr && visit( *--itr ); ) {}
+           } else {
+              for( auto itr = start_itr; itr != end_itr && visit( *itr ); ++itr ) {}
+           }
+        }
+
+        if( descending )
+           std::reverse( result.actions.begin(), result.actions.end() );
+
+        // the next page continues past the last action returned, there is none below account sequence 0
+        if( !result.actions.empty() ) {
+           if( descending ) {
+              if( result.actions.front().account_action_seq > 0 )
+                 result.next_cursor = make_actions_cursor( n, result.actions.front().account_action_seq - 1 );
+           } else if( result.time_limit_exceeded_error || result.actions.back().account_action_seq == end ) {
+              result.next_cursor = make_actions_cursor( n, result.actions.back().account_action_seq + 1 );
            }
-           ++start_itr;
         }
         return result;
       }
 
-
       read_only::get_transaction_result read_only::get_transaction( const read_only::get_transaction_params& p )const {
          auto& chain = history->chain_plug->chain();
          const auto abi_serializer_max_time = history->chain_plug->get_abi_serializer_max_time();
@@ -462,33 +625,54 @@ namespace eosio {
             return (*(input_id.data() + input_id_size) & 0xF0) == (*(id.data() + input_id_size) & 0xF0);
          };
 
-         const auto& db = chain.db();
-         const auto& idx = db.get_index<action_history_index, by_trx_id_act_seq>();
-         auto itr = idx.lower_bound( boost::make_tuple( input_id ) );
+         get_transaction_result result;
+         bool in_history = false;
+         auto add_trace = [&]( const auto& packed_action_trace ) {
+            fc::datastream<const char*> ds( packed_action_trace.data(), packed_action_trace.size() );
+            action_trace t;
+            fc::raw::unpack( ds, t );
+            result.traces.emplace_back( chain.to_variant_with_abi(t, abi_serializer::create_yield_function( abi_serializer_max_time )) );
+         };
 
-         bool in_history = (itr != idx.end() && txn_id_matched(itr->trx_id) );
+         if( history->store ) {
+            history->store->for_each_transaction_action( input_id, [&]( const stored_action_history& a ) {
+               if( !in_history ) {
+                  if( !txn_id_matched( a.trx_id ) )
+                     return false;
+                  in_history        = true;
+                  result.id         = a.trx_id;
+                  result.block_num  = a.block_num;
+                  result.block_time = a.block_time;
+               } else if( a.trx_id != result.id ) {
+                  return false;
+               }
+               add_trace( a.packed_action_trace );
+               return true;
+            } );
+         } else {
+            const auto& db = chain.db();
+            const auto& idx = db.get_index<action_history_index, by_trx_id_act_seq>();
+            auto itr = idx.lower_bound( boost::make_tuple( input_id ) );
+
+            in_history = (itr != idx.end() && txn_id_matched(itr->trx_id) );
+            if( in_history ) {
+               result.id         = itr->trx_id;
+               result.block_num  = itr->block_num;
+               result.block_time = itr->block_time;
+
+               while( itr != idx.end() && itr->trx_id == result.id ) {
+                  add_trace( itr->packed_action_trace );
+                  ++itr;
+               }
+            }
+         }
 
          if( !in_history && !p.block_num_hint ) {
             EOS_THROW(tx_not_found, "Transaction ${id} not found in history and no block hint was given", ("id",p.id));
          }
 
-         get_transaction_result result;
-
          if( in_history ) {
-            result.id         = itr->trx_id;
             result.last_irreversible_block = chain.last_irreversible_block_num();
-            result.block_num  = itr->block_num;
-            result.block_time = itr->block_time;
-
-            while( itr != idx.end() && itr->trx_id == result.id ) {
-
-              fc::datastream<const char*> ds( itr->packed_action_trace.data(), itr->packed_action_trace.size() );
-              action_trace t;
-              fc::raw::unpack( ds, t );
-              result.traces.emplace_back( chain.to_variant_with_abi(t, abi_serializer::create_yield_function( abi_serializer_max_time )) );
-
-              ++itr;
-            }
 
             auto blk = chain.fetch_block_by_number( result.block_num );
             if( blk || chain.is_building_block() ) {
@@ -0,0 +1,223 @@
+#include <eosio/history_plugin/history_store.hpp>
+#include <eosio/chain/exceptions.hpp>
+
+#include <fc/io/raw.hpp>
+
+#include <rocksdb/db.h>
+#include <rocksdb/write_batch.h>
+
+namespace eosio {
+   namespace {
+      /// value of the meta entry of the history_store
+      struct stored_history_meta {
+         fc::sha256  chain_id;
+         uint32_t    last_block_num = 0;
+      };
+   }
+}
+
+FC_REFLECT( eosio::stored_history_meta, (chain_id)(last_block_num) )
+
+namespace eosio {
+   namespace {
+      void check( const boost::filesystem::path& dir, const rocksdb::Status& status, const char* what ) {
+         EOS_ASSERT( status.ok(), chain::plugin_exception, "history store ${dir} ${what} failed: ${status}",
+                     ("dir", dir.string())("what", what)("status", status.ToString()) );
+      }
+
+      template<typename T>
+      void append( std::string& key, T v ) {
+         static_assert( std::is_unsigned_v<T> );
+         for( int i = sizeof(T) - 1; i >= 0; --i )
+            key.push_back( static_cast<char>( v >> (i * 8) ) );
+      }
+
+      template<typename T>
+      T read( const char*& pos ) {
+         static_assert( std::is_unsigned_v<T> );
+         T v = 0;
+         for( size_t i = 0; i < sizeof(T); ++i )
+            v = static_cast<T>( (v << 8) | static_cast<uint8_t>( *pos++ ) );
+         return v;
+      }
+
+      std::string account_entry( chain::account_name account, uint32_t account_sequence_num ) {
+         std::string key(1, 'a');
+         append( key, account.to_uint64_t() );
+         append( key, account_sequence_num );
+         return key;
+      }
+
+      std::string action_entry( uint64_t action_sequence_num ) {
+         std::string key(1, 'g');
+         append( key, action_sequence_num );
+         return key;
+      }
+
+      std::string transaction_entry( const chain::transaction_id_type& trx_id, uint64_t action_sequence_num ) {
+         std::string key(1, 't');
+         key.append( trx_id.data(), trx_id.data_size() );
+         append( key, action_sequence_num );
+         return key;
+      }
+
+      rocksdb::WriteOptions write_options() {
+         // the worker writes each block with its meta entry in a single batch, the WAL keeps them across a crash
+         return rocksdb::WriteOptions();
+      }
+   }
+
+   history_store::history_store( const boost::filesystem::path& dir, const chain::chain_id_type& chain_id )
+   : dir(dir)
+   , chain_id(chain_id)
+   , worker( "hist", 1 )
+   {
+      rocksdb::Options options;
+      options.create_if_missing = true;
+      options.OptimizeLevelStyleCompaction();
+      rocksdb::DB* p = nullptr;
+      check( dir, rocksdb::DB::Open( options, dir.string(), &p ), "open" );
+      db.reset( p );
+
+      rocksdb::PinnableSlice value;
+      const auto status = db->Get( rocksdb::ReadOptions(), db->DefaultColumnFamily(), std::string(1, 'm'), &value );
+      if( !status.IsNotFound() ) {
+         check( dir, status, "read" );
+         const auto meta = fc::raw::unpack<stored_history_meta>( value.data(), value.size() );
+         EOS_ASSERT( meta.chain_id == chain_id, chain::plugin_config_exception,
+                     "history store ${dir} holds the history of chain ${id}, not of this chain",
+                     ("dir", dir.string())("id", meta.chain_id) );
+         last_block = meta.last_block_num;
+      }
+   }
+
+   history_store::~history_store() {
+      worker.stop();
+   }
+
+   void history_store::append( uint32_t block_num, std::vector<stored_action_history> actions ) {
+      auto done = chain::async_thread_pool( worker.get_executor(), [this, block_num, actions=std::move(actions)]() {
+         try {
+            write_block( block_num, actions );
+         } FC_LOG_AND_DROP(("history store write ERROR"));
+      } ).share();
+      std::lock_guard g( mtx );
+      last_write = std::move( done );
+   }
+
+   void history_store::wait() const {
+      std::shared_future<void> done;
+      {
+         std::lock_guard g( mtx );
+         done = last_write;
+      }
+      if( done.valid() )
+         done.wait();
+   }
+
+   uint32_t history_store::last_block_num() const {
+      return last_block;
+   }
+
+   void history_store::write_block( uint32_t block_num, const std::vector<stored_action_history>& actions ) {
+      if( block_num <= last_block )
+         return;
+
+      rocksdb::WriteBatch batch;
+      for( const auto& a : actions ) {
+         const auto value = fc::raw::pack( a );
+         batch.Put( action_entry( a.action_sequence_num ), rocksdb::Slice( value.data(), value.size() ) );
+         batch.Put( transaction_entry( a.trx_id, a.action_sequence_num ), rocksdb::Slice() );
+
+         std::string global_seq;
+         append( global_seq, a.action_sequence_num );
+         for( const auto& account : a.accounts ) {
+            auto itr = next_account_sequence_num.find( account.to_uint64_t() );
+            if( itr == next_account_sequence_num.end() ) {
+               const auto last = last_account_sequence_num( account );
+               itr = next_account_sequence_num.emplace( account.to_uint64_t(), last ? *last + 1 : 0 ).first;
+            }
+            batch.Put( account_entry( account, itr->second++ ), global_seq );
+         }
+      }
+
+      const auto meta = fc::raw::pack( stored_history_meta{ chain_id, block_num } );
+      batch.Put( std::string(1, 'm'), rocksdb::Slice( meta.data(), meta.size() ) );
+      check( dir, db->Write( write_options(), &batch ), "write" );
+      last_block = block_num;
+   }
+
+   void history_store::save_reversible( const std::vector<reversible_action_history>& reversible ) {
+      wait();
+      const auto value = fc::raw::pack( reversible );
+      check( dir, db->Put( write_options(), std::string(1, 'r'), rocksdb::Slice( value.data(), value.size() ) ), "write" );
+   }
+
+   std::vector<reversible_action_history> history_store::take_reversible() {
+      rocksdb::PinnableSlice value;
+      const auto status = db->Get( rocksdb::ReadOptions(), db->DefaultColumnFamily(), std::string(1, 'r'), &value );
+      if( status.IsNotFound() )
+         return {};
+      check( dir, status, "read" );
+      auto result = fc::raw::unpack<std::vector<reversible_action_history>>( value.data(), value.size() );
+      check( dir, db->Delete( write_options(), std::string(1, 'r') ), "write" );
+      return result;
+   }
+
+   std::optional<int32_t> history_store::last_account_sequence_num( chain::account_name account ) const {
+      std::unique_ptr<rocksdb::Iterator> itr( db->NewIterator( rocksdb::ReadOptions() ) );
+      itr->SeekForPrev( account_entry( account, std::numeric_limits<uint32_t>::max() ) );
+      std::string prefix(1, 'a');
+      append( prefix, account.to_uint64_t() );
+      if( !itr->Valid() || !itr->key().starts_with( prefix ) ) {
+         check( dir, itr->status(), "iterate" );
+         return {};
+      }
+      const char* pos = itr->key().data() + prefix.size();
+      return static_cast<int32_t>( read<uint32_t>( pos ) );
+   }
+
+   std::optional<stored_action_history> history_store::get_action( uint64_t action_sequence_num ) const {
+      rocksdb::PinnableSlice value;
+      const auto status = db->Get( rocksdb::ReadOptions(), db->DefaultColumnFamily(), action_entry( action_sequence_num ), &value );
+      if( status.IsNotFound() )
+         return {};
+      check( dir, status, "read" );
+      return fc::raw::unpack<stored_action_history>( value.data(), value.size() );
+   }
+
+   void history_store::for_each_account_action( chain::account_name account, int32_t start, int32_t end, bool descending,
+                                                const std::function<bool(int32_t, const stored_action_history&)>& f ) const {
+      if( end < 0 || end < start )
+         return;
+      const auto first = account_entry( account, static_cast<uint32_t>( std::max( start, 0 ) ) );
+      const auto last = account_entry( account, static_cast<uint32_t>( end ) );
+      std::unique_ptr<rocksdb::Iterator> itr( db->NewIterator( rocksdb::ReadOptions() ) );
+      auto visit = [&]() {
+         const char* pos = itr->key().data() + 1 + sizeof(uint64_t);
+         const auto account_sequence_num = static_cast<int32_t>( read<uint32_t>( pos ) );
+         const char* value = itr->value().data();
+         const auto action = get_action( read<uint64_t>( value ) );
+         return !action || f( account_sequence_num, *action );
+      };
+      if( descending ) {
+         for( itr->SeekForPrev( last ); itr->Valid() && itr->key().compare( first ) >= 0 && visit(); itr->Prev() ) {}
+      } else {
+         for( itr->Seek( first ); itr->Valid() && itr->key().compare( last ) <= 0 && visit(); itr->Next() ) {}
+      }
+      check( dir, itr->status(), "iterate" );
+   }
+
+   void history_store::for_each_transaction_action( const chain::transaction_id_type& trx_id,
+                                                    const std::function<bool(const stored_action_history&)>& f ) const {
+      std::unique_ptr<rocksdb::Iterator> itr( db->NewIterator( rocksdb::ReadOptions() ) );
+      for( itr->Seek( transaction_entry( trx_id, 0 ) ); itr->Valid() && itr->key()[0] == 't'; itr->Next() ) {
+         const char* pos = itr->key().data() + 1 + trx_id.data_size();
+         const auto action = get_action( read<uint64_t>( pos ) );
+         if( action && !f( *action ) )
+            return;
+      }
+      check( dir, itr->status(), "iterate" );
+   }
+
+} /// namespace eosio
@@ -29,6 +29,8 @@ class read_only {
          chain::account_name     account_name;
          std::optional<int32_t>  pos; /// a absolute sequence positon -1 is the end/last action
          std::optional<int32_t>  offset; ///< the number of actions relative to pos, negative numbers return [pos-offset,pos), positive numbers return [pos,pos+offset)
+         std::optional<string>   cursor; ///< the next_cursor of the previous page, replaces pos
+         std::optional<bool>     raw;    ///< return the packed action traces instead of decoding them with the ABIs
       };
 
       struct ordered_action_result {
@@ -37,12 +39,14 @@ class read_only {
          uint32_t                     block_num;
          chain::block_timestamp_type  block_time;
          fc::variant                  action_trace;
+         std::optional<chain::bytes>  packed_action_trace;
       };
 
       struct get_actions_result {
          vector<ordered_action_result> actions;
          uint32_t                      last_irreversible_block;
          std::optional<bool>           time_limit_exceeded_error;
+         std::optional<string>         next_cursor;
       };
 
 
@@ -132,9 +136,9 @@ class history_plugin : public plugin<history_plugin> {
 
 } /// namespace eosio
 
-FC_REFLECT( eosio::history_apis::read_only::get_actions_params, (account_name)(pos)(offset) )
-FC_REFLECT( eosio::history_apis::read_only::get_actions_result, (actions)(last_irreversible_block)(time_limit_exceeded_error) )
-FC_REFLECT( eosio::history_apis::read_only::ordered_action_result, (global_action_seq)(account_action_seq)(block_num)(block_time)(action_trace) )
+FC_REFLECT( eosio::history_apis::read_only::get_actions_params, (account_name)(pos)(offset)(cursor)(raw) )
+FC_REFLECT( eosio::history_apis::read_only::get_actions_result, (actions)(last_irreversible_block)(time_limit_exceeded_error)(next_cursor) )
+FC_REFLECT( eosio::history_apis::read_only::ordered_action_result, (global_action_seq)(account_action_seq)(block_num)(block_time)(action_trace)(packed_action_trace) )
 
 FC_REFLECT( eosio::history_apis::read_only::get_transaction_params, (id)(block_num_hint) )
 FC_REFLECT( eosio::history_apis::read_only::get_transaction_result, (id)(trx)(block_time)(block_num)(last_irreversible_block)(traces) )
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <eosio/chain/block_timestamp.hpp>
+#include <eosio/chain/chain_id_type.hpp>
+#include <eosio/chain/thread_utils.hpp>
+#include <eosio/chain/types.hpp>
+
+#include <boost/filesystem/path.hpp>
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace rocksdb { class DB; }
+
+namespace eosio {
+
+   /// an action of the history, with the accounts it is in the history of
+   struct stored_action_history {
+      uint64_t                          action_sequence_num = 0;
+      uint32_t                          block_num = 0;
+      chain::block_timestamp_type       block_time;
+      chain::transaction_id_type        trx_id;
+      std::vector<char>                 packed_action_trace;
+      std::vector<chain::account_name>  accounts;
+   };
+
+   /// the actions of a block which is not irreversible yet
+   struct reversible_action_history {
+      chain::block_id_type                id;
+      uint32_t                            block_num = 0;
+      std::vector<stored_action_history>  actions;
+   };
+
+   /**
+    * RocksDB storage of the action history, written after the blocks become irreversible so that it pays neither
+    * undo sessions nor chain state database space.  Integers in entry keys are big endian so that RocksDB orders
+    * the entries like the chainbase indices:
+    *   'a' account account_sequence_num       -> action_sequence_num         account history
+    *   'g' action_sequence_num                -> stored_action_history       actions
+    *   't' trx_id action_sequence_num         -> ''                          actions by transaction
+    *   'm'                                    -> chain id, last block written
+    *   'r'                                    -> reversible actions kept over a clean shutdown
+    *
+    * Blocks are written in order by a worker thread, blocks at or below the last block written are skipped so a
+    * replay does not record their actions twice.  Reads do not wait for the queued blocks.
+    */
+   class history_store {
+   public:
+      history_store( const boost::filesystem::path& dir, const chain::chain_id_type& chain_id );
+      ~history_store();
+
+      /// queue the actions of an irreversible block to be written
+      void append( uint32_t block_num, std::vector<stored_action_history> actions );
+
+      /// wait for the queued blocks
+      void wait() const;
+
+      /// @return the last block written, 0 if none
+      uint32_t last_block_num() const;
+
+      /// keep the actions of the reversible blocks until the next start, they are removed from the store by take_reversible
+      void save_reversible( const std::vector<reversible_action_history>& reversible );
+      std::vector<reversible_action_history> take_reversible();
+
+      /// @return the sequence number of the last action in the history of account, if any
+      std::optional<int32_t> last_account_sequence_num( chain::account_name account ) const;
+
+      /// call f(account_sequence_num, action) for the actions in the history of account from start to end, inclusive, until it returns false
+      void for_each_account_action( chain::account_name account, int32_t start, int32_t end, bool descending,
+                                    const std::function<bool(int32_t, const stored_action_history&)>& f ) const;
+
+      /// call f(action) for the actions from the first transaction id at or after trx_id, in transaction id order, until it returns false
+      void for_each_transaction_action( const chain::transaction_id_type& trx_id,
+                                        const std::function<bool(const stored_action_history&)>& f ) const;
+
+   private:
+      void write_block( uint32_t block_num, const std::vector<stored_action_history>& actions );
+      std::optional<stored_action_history> get_action( uint64_t action_sequence_num ) const;
+
+      const boost::filesystem::path                  dir;
+      const chain::chain_id_type                     chain_id;
+      std::unique_ptr<rocksdb::DB>                   db;
+      std::atomic<uint32_t>                          last_block{0};
+      std::unordered_map<uint64_t, int32_t>          next_account_sequence_num; ///< cache of the worker thread
+      chain::named_thread_pool                       worker;
+      mutable std::mutex                             mtx;         ///< protects last_write
+      std::shared_future<void>                       last_write;
+   };
+
+} /// namespace eosio
+
+FC_REFLECT( eosio::stored_action_history, (action_sequence_num)(block_num)(block_time)(trx_id)(packed_action_trace)(accounts) )
+FC_REFLECT( eosio::reversible_action_history, (id)(block_num)(actions) )
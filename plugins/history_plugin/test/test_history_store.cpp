@@ -0,0 +1,228 @@
+#define BOOST_TEST_MODULE history_store
+#include <boost/test/included/unit_test.hpp>
+#include <eosio/history_plugin/history_store.hpp>
+#include <eosio/chain/exceptions.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/io/raw.hpp>
+
+#include <utility>
+#include <vector>
+
+using namespace eosio;
+using namespace eosio::chain;
+
+namespace {
+   using history_entries = std::vector<std::pair<int32_t, uint64_t>>;
+
+   const chain_id_type test_chain_id( fc::sha256::hash( std::string( "history_store" ) ).str() );
+
+   stored_action_history make_action( uint64_t action_sequence_num, uint32_t block_num, std::vector<account_name> accounts,
+                                      const transaction_id_type& trx_id = transaction_id_type() ) {
+      stored_action_history a;
+      a.action_sequence_num = action_sequence_num;
+      a.block_num = block_num;
+      a.trx_id = trx_id;
+      a.packed_action_trace = fc::raw::pack( action_sequence_num );
+      a.accounts = std::move( accounts );
+      return a;
+   }
+
+   /// (account_sequence_num, action_sequence_num) of the actions in the history of account from start to end
+   history_entries account_actions( const history_store& store, account_name account,
+                                    int32_t start, int32_t end, bool descending = false ) {
+      history_entries result;
+      store.for_each_account_action( account, start, end, descending, [&]( int32_t seq, const stored_action_history& a ) {
+         BOOST_CHECK( fc::raw::unpack<uint64_t>( a.packed_action_trace ) == a.action_sequence_num );
+         result.emplace_back( seq, a.action_sequence_num );
+         return true;
+      } );
+      return result;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(history_store_tests)
+
+// the keys are big endian, account sequences past a byte boundary are still visited in order
+BOOST_AUTO_TEST_CASE(account_history_order) { try {
+   fc::temp_directory tempdir;
+   const boost::filesystem::path dir = tempdir.path();
+   history_store store( dir, test_chain_id );
+
+   uint64_t global_seq = 1;
+   for( uint32_t block_num = 1; block_num <= 3; ++block_num ) {
+      std::vector<stored_action_history> actions;
+      for( int i = 0; i < 100; ++i )
+         actions.push_back( make_action( global_seq++, block_num, { "alice"_n } ) );
+      store.append( block_num, std::move( actions ) );
+   }
+   store.wait();
+
+   BOOST_CHECK_EQUAL( store.last_block_num(), 3u );
+   BOOST_REQUIRE( store.last_account_sequence_num( "alice"_n ) );
+   BOOST_CHECK_EQUAL( *store.last_account_sequence_num( "alice"_n ), 299 );
+
+   const auto all = account_actions( store, "alice"_n, 0, 299 );
+   BOOST_REQUIRE_EQUAL( all.size(), 300u );
+   for( int32_t i = 0; i < 300; ++i ) {
+      BOOST_CHECK_EQUAL( all[i].first, i );
+      BOOST_CHECK_EQUAL( all[i].second, static_cast<uint64_t>( i + 1 ) );
+   }
+
+   const auto asc = account_actions( store, "alice"_n, 250, 260 );
+   const auto desc = account_actions( store, "alice"_n, 250, 260, true );
+   BOOST_REQUIRE_EQUAL( asc.size(), 11u );
+   BOOST_CHECK( history_entries( asc.rbegin(), asc.rend() ) == desc );
+   BOOST_CHECK_EQUAL( asc.front().first, 250 );
+   BOOST_CHECK_EQUAL( desc.front().first, 260 );
+
+   // the range is clamped to the history, a false return stops the walk
+   BOOST_CHECK_EQUAL( account_actions( store, "alice"_n, -10, 1000 ).size(), 300u );
+   BOOST_CHECK( account_actions( store, "alice"_n, 10, 5 ).empty() );
+   int visited = 0;
+   store.for_each_account_action( "alice"_n, 0, 299, false, [&]( int32_t, const stored_action_history& ) { return ++visited < 3; } );
+   BOOST_CHECK_EQUAL( visited, 3 );
+} FC_LOG_AND_RETHROW() }
+
+// each account has its own sequence, which does not run into the next account of the key order
+BOOST_AUTO_TEST_CASE(accounts_kept_apart) { try {
+   fc::temp_directory tempdir;
+   const boost::filesystem::path dir = tempdir.path();
+   history_store store( dir, test_chain_id );
+   const account_name next_to_alice( "alice"_n.to_uint64_t() + 1 );
+
+   store.append( 1, { make_action( 1, 1, { "alice"_n, "bob"_n } ), make_action( 2, 1, { "bob"_n } ),
+                      make_action( 3, 1, { next_to_alice } ) } );
+   store.append( 2, { make_action( 4, 2, { "alice"_n } ), make_action( 5, 2, { next_to_alice, "bob"_n } ) } );
+   store.wait();
+
+   BOOST_CHECK( account_actions( store, "alice"_n, 0, 100 ) == (history_entries{ {0, 1}, {1, 4} }) );
+   BOOST_CHECK( account_actions( store, "bob"_n, 0, 100 ) == (history_entries{ {0, 1}, {1, 2}, {2, 5} }) );
+   BOOST_CHECK( account_actions( store, next_to_alice, 0, 100 ) == (history_entries{ {0, 3}, {1, 5} }) );
+   BOOST_CHECK_EQUAL( *store.last_account_sequence_num( "alice"_n ), 1 );
+   BOOST_CHECK_EQUAL( *store.last_account_sequence_num( "bob"_n ), 2 );
+
+   BOOST_CHECK( !store.last_account_sequence_num( "carol"_n ) );
+   BOOST_CHECK( account_actions( store, "carol"_n, 0, 100 ).empty() );
+} FC_LOG_AND_RETHROW() }
+
+// a new store continues the account sequences and the last block of the previous one
+BOOST_AUTO_TEST_CASE(sequences_continue_after_restart) { try {
+   fc::temp_directory tempdir;
+   const boost::filesystem::path dir = tempdir.path();
+   {
+      history_store store( dir, test_chain_id );
+      store.append( 1, { make_action( 1, 1, { "alice"_n } ), make_action( 2, 1, { "alice"_n } ) } );
+      store.wait();
+   }
+
+   history_store store( dir, test_chain_id );
+   BOOST_CHECK_EQUAL( store.last_block_num(), 1u );
+   store.append( 2, { make_action( 3, 2, { "alice"_n } ) } );
+   store.wait();
+
+   BOOST_CHECK( account_actions( store, "alice"_n, 0, 100 ) == (history_entries{ {0, 1}, {1, 2}, {2, 3} }) );
+   BOOST_CHECK_EQUAL( store.last_block_num(), 2u );
+} FC_LOG_AND_RETHROW() }
+
+// blocks at or below the last block written are replays, their actions are not recorded twice
+BOOST_AUTO_TEST_CASE(replayed_blocks_skipped) { try {
+   fc::temp_directory tempdir;
+   const boost::filesystem::path dir = tempdir.path();
+   {
+      history_store store( dir, test_chain_id );
+      store.append( 1, { make_action( 1, 1, { "alice"_n } ) } );
+      store.append( 2, { make_action( 2, 2, { "alice"_n } ) } );
+      store.append( 2, { make_action( 20, 2, { "alice"_n } ) } );
+      store.wait();
+   }
+
+   history_store store( dir, test_chain_id );
+   store.append( 1, { make_action( 1, 1, { "alice"_n } ) } );
+   store.append( 2, { make_action( 2, 2, { "alice"_n } ) } );
+   store.append( 3, { make_action( 3, 3, { "alice"_n } ) } );
+   store.wait();
+
+   BOOST_CHECK( account_actions( store, "alice"_n, 0, 100 ) == (history_entries{ {0, 1}, {1, 2}, {2, 3} }) );
+   BOOST_CHECK_EQUAL( store.last_block_num(), 3u );
+} FC_LOG_AND_RETHROW() }
+
+// the reversible actions saved on shutdown are returned once by the next store
+BOOST_AUTO_TEST_CASE(reversible_kept_over_restart) { try {
+   fc::temp_directory tempdir;
+   const boost::filesystem::path dir = tempdir.path();
+   const block_id_type id4 = fc::sha256::hash( std::string( "block 4" ) );
+   const block_id_type id5 = fc::sha256::hash( std::string( "block 5" ) );
+   {
+      history_store store( dir, test_chain_id );
+      store.append( 3, { make_action( 1, 3, { "alice"_n } ) } );
+      store.save_reversible( { reversible_action_history{ id4, 4, { make_action( 2, 4, { "alice"_n } ) } },
+                               reversible_action_history{ id5, 5, { make_action( 3, 5, { "bob"_n } ), make_action( 4, 5, { "bob"_n } ) } } } );
+   }
+   {
+      history_store store( dir, test_chain_id );
+      BOOST_CHECK_EQUAL( store.last_block_num(), 3u );
+      const auto reversible = store.take_reversible();
+      BOOST_REQUIRE_EQUAL( reversible.size(), 2u );
+      BOOST_CHECK( reversible[0].id == id4 );
+      BOOST_CHECK_EQUAL( reversible[0].block_num, 4u );
+      BOOST_REQUIRE_EQUAL( reversible[0].actions.size(), 1u );
+      BOOST_CHECK_EQUAL( reversible[0].actions[0].action_sequence_num, 2u );
+      BOOST_CHECK( reversible[1].id == id5 );
+      BOOST_REQUIRE_EQUAL( reversible[1].actions.size(), 2u );
+      BOOST_CHECK( reversible[1].actions[1].accounts == std::vector<account_name>{ "bob"_n } );
+
+      // not written to the history until they become irreversible
+      BOOST_CHECK( !store.last_account_sequence_num( "bob"_n ) );
+      BOOST_CHECK( store.take_reversible().empty() );
+   }
+
+   history_store store( dir, test_chain_id );
+   BOOST_CHECK( store.take_reversible().empty() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(other_chain_refused) { try {
+   fc::temp_directory tempdir;
+   const boost::filesystem::path dir = tempdir.path();
+   {
+      history_store store( dir, test_chain_id );
+      store.append( 1, { make_action( 1, 1, { "alice"_n } ) } );
+      store.wait();
+   }
+
+   const chain_id_type other_chain_id( fc::sha256::hash( std::string( "other" ) ).str() );
+   BOOST_CHECK_THROW( (history_store( dir, other_chain_id )), plugin_config_exception );
+
+   history_store store( dir, test_chain_id );
+   BOOST_CHECK_EQUAL( store.last_block_num(), 1u );
+} FC_LOG_AND_RETHROW() }
+
+// the actions of a transaction are visited in global sequence order, followed by those of the next transaction ids
+BOOST_AUTO_TEST_CASE(transaction_actions) { try {
+   fc::temp_directory tempdir;
+   const boost::filesystem::path dir = tempdir.path();
+   history_store store( dir, test_chain_id );
+   const transaction_id_type trx1 = fc::sha256::hash( std::string( "trx1" ) );
+   const transaction_id_type trx2 = fc::sha256::hash( std::string( "trx2" ) );
+
+   store.append( 1, { make_action( 1, 1, { "alice"_n }, trx1 ), make_action( 2, 1, { "bob"_n }, trx2 ) } );
+   store.append( 2, { make_action( 3, 2, { "alice"_n }, trx1 ), make_action( 300, 2, { "alice"_n }, trx1 ) } );
+   store.wait();
+
+   for( const auto& trx_id : { trx1, trx2 } ) {
+      std::vector<uint64_t> seqs;
+      store.for_each_transaction_action( trx_id, [&]( const stored_action_history& a ) {
+         if( a.trx_id != trx_id )
+            return false;
+         seqs.push_back( a.action_sequence_num );
+         return true;
+      } );
+      BOOST_CHECK( seqs == (trx_id == trx1 ? std::vector<uint64_t>{ 1, 3, 300 } : std::vector<uint64_t>{ 2 }) );
+   }
+
+   // the lookup starts at the first transaction id at or after the one requested
+   size_t visited = 0;
+   store.for_each_transaction_action( transaction_id_type(), [&]( const stored_action_history& ) { ++visited; return true; } );
+   BOOST_CHECK_EQUAL( visited, 4u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
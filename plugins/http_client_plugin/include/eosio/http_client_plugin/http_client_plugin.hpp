@@ -23,8 +23,14 @@ namespace eosio {
            return *my;
         }
 
+        /// a client with the certificates and peer validation of get_client(), for users which need their own
+        /// connections, e.g. to use it from another thread; call after plugin_initialize
+        std::unique_ptr<http_client> create_client() const;
+
       private:
         std::unique_ptr<http_client> my;
+        std::vector<std::string>     root_certs;
+        bool                         verify_peers = true;
    };
 
 }
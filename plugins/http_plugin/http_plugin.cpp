@@ -2,15 +2,19 @@
 #ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
 #include <eosio/http_plugin/local_endpoint.hpp>
 #endif
+#include <eosio/http_plugin/beast_http_session.hpp>
 #include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/non_consensus_executor.hpp>
 #include <eosio/chain/thread_utils.hpp>
 
 #include <fc/network/ip.hpp>
 #include <fc/log/logger_config.hpp>
 #include <fc/reflect/variant.hpp>
+#include <fc/variant_object.hpp>
 #include <fc/io/json.hpp>
 #include <fc/io/raw.hpp>
 #include <fc/crypto/openssl.hpp>
+#include <fc/crypto/sha256.hpp>
 
 #include <boost/asio.hpp>
 #include <boost/optional.hpp>
@@ -22,9 +26,15 @@
 #include <websocketpp/client.hpp>
 #include <websocketpp/logger/stub.hpp>
 
+#include <algorithm>
+#include <array>
 #include <thread>
+#include <fstream>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <regex>
+#include <unordered_map>
 
 const fc::string logger_name("http_plugin");
 fc::logger logger;
@@ -127,6 +137,42 @@ namespace eosio {
           static const long timeout_open_handshake = 0;
       };
 #endif
+      /**
+       * Latency histograms of the stages of the requests of one endpoint, see http_stage_latency
+       */
+      struct endpoint_latency {
+         enum stage_t { queue, handler, serialize, send, stage_count };
+         static constexpr std::array<const char*, stage_count> stage_names = { "queue", "handler", "serialize", "send" };
+         static constexpr std::array<uint64_t, 16> bounds_us = { 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+                                                                 100000, 250000, 500000, 1000000, 2500000, 5000000 };
+
+         struct histogram {
+            std::array<std::atomic<uint64_t>, bounds_us.size() + 1> counts{};
+            std::atomic<uint64_t>                                   total_us{0};
+         };
+
+         void record( stage_t stage, fc::microseconds d ) {
+            const uint64_t us = d.count() > 0 ? d.count() : 0;
+            auto& h = stages[stage];
+            const auto bucket = std::lower_bound( bounds_us.begin(), bounds_us.end(), us ) - bounds_us.begin();
+            h.counts[bucket].fetch_add( 1, std::memory_order_relaxed );
+            h.total_us.fetch_add( us, std::memory_order_relaxed );
+         }
+
+         void snapshot( const string& endpoint, vector<http_stage_latency>& result ) const {
+            for( size_t s = 0; s < stage_count; ++s ) {
+               http_stage_latency l{ endpoint, stage_names[s], { bounds_us.begin(), bounds_us.end() } };
+               l.counts.reserve( stages[s].counts.size() );
+               for( const auto& c : stages[s].counts )
+                  l.counts.push_back( c.load( std::memory_order_relaxed ) );
+               l.total_us = stages[s].total_us.load( std::memory_order_relaxed );
+               result.push_back( std::move( l ) );
+            }
+         }
+
+         std::array<histogram, stage_count> stages;
+      };
+
       /**
        * virtualized wrapper for the various underlying connection functions needed in req/resp processng
        */
@@ -137,17 +183,65 @@ namespace eosio {
          virtual void handle_exception() = 0;
 
          virtual void send_response(std::optional<std::string> body, int code) = 0;
+         virtual void send_binary_response(std::string body, int code) = 0;
+         /// send a response other than JSON with its content type
+         virtual void send_typed_response(std::string body, const std::string& content_type, int code) = 0;
+
+         /// called when the handler of the call starts, on the thread it runs on
+         void start_handler() {
+            if( latency ) {
+               handler_started = fc::time_point::now();
+               latency->record( endpoint_latency::queue, handler_started - received );
+            }
+         }
+
+         /// called when the handler of the call has given its response
+         void response_ready() {
+            if( latency && handler_started != fc::time_point() && responded == fc::time_point() ) {
+               responded = fc::time_point::now();
+               latency->record( endpoint_latency::handler, responded - handler_started );
+            }
+         }
+
+         /// called when the response has been handed to the connection
+         void response_sent() {
+            if( latency && responded != fc::time_point() )
+               latency->record( endpoint_latency::send, fc::time_point::now() - responded );
+         }
+
+         endpoint_latency* latency = nullptr;  ///< of the endpoint of the request, null when the request is not timed
+         fc::time_point    received;           ///< when the request was read from the connection
+         fc::time_point    handler_started;
+         fc::time_point    responded;
       };
 
       using abstract_conn_ptr = std::shared_ptr<abstract_conn>;
 
+      /**
+       * Tag of the connections of the beast server, in place of the websocketpp config of the other servers
+       */
+      struct beast_config {
+         using request_type = beast_http_connection::request;
+      };
+
+      template<typename T>
+      struct connection_ptr_of {
+         using type = typename websocketpp::server<T>::connection_ptr;
+      };
+
+      template<>
+      struct connection_ptr_of<beast_config> {
+         using type = std::shared_ptr<beast_http_connection>;
+      };
+
       template<typename T>
-      using connection_ptr = typename websocketpp::server<T>::connection_ptr;
+      using connection_ptr = typename connection_ptr_of<T>::type;
 
       /**
        * internal url handler that contains more parameters than the handlers provided by external systems
        */
       using internal_url_handler = std::function<void(abstract_conn_ptr, string, string, url_response_callback)>;
+      using internal_binary_url_handler = std::function<void(abstract_conn_ptr, string, string, url_response_callback, url_binary_response_callback)>;
 
       /**
        * Helper method to calculate the "in flight" size of a string
@@ -186,6 +280,105 @@ namespace eosio {
          }
          return 0;
       }
+
+      /**
+       * A cached JSON response and its ETag
+       */
+      struct cached_response {
+         std::string body;
+         std::string etag;
+      };
+
+      /**
+       * @return the ETag of a response body
+       */
+      static std::string make_etag( const std::string& body ) {
+         return "\"" + fc::sha256::hash( body ).str() + "\"";
+      }
+
+      /**
+       * A request whose response is to be cached once it is sent
+       */
+      struct cache_request {
+         std::string       key;            ///< url and request body
+         http_cache_policy policy;
+         uint64_t          generation;     ///< head generation when the request arrived
+         std::string       if_none_match;  ///< If-None-Match header of the request
+      };
+
+      /**
+       * Least recently used cache of the JSON responses of the calls with a cache policy, keyed by url and request
+       * body.  Responses with the head policy are only served while the head generation they were computed in is
+       * current, invalidate_head moves to the next generation.
+       */
+      class response_cache {
+      public:
+         explicit response_cache( size_t max_bytes )
+         : max_bytes( max_bytes ) {}
+
+         uint64_t generation() const {
+            return head_generation.load();
+         }
+
+         void invalidate_head() {
+            ++head_generation;
+         }
+
+         std::shared_ptr<const cached_response> get( const std::string& key ) {
+            std::lock_guard g( mtx );
+            auto itr = entries.find( key );
+            if( itr == entries.end() )
+               return {};
+            if( itr->second.policy == http_cache_policy::head && itr->second.generation != head_generation ) {
+               erase( itr );
+               return {};
+            }
+            lru.splice( lru.begin(), lru, itr->second.lru_pos );
+            return itr->second.response;
+         }
+
+         void put( const cache_request& req, std::shared_ptr<const cached_response> response ) {
+            const size_t size = req.key.size() + response->body.size();
+            if( size > max_bytes )
+               return;
+            std::lock_guard g( mtx );
+            // computed from the state of a previous head block
+            if( req.policy == http_cache_policy::head && req.generation != head_generation )
+               return;
+            auto itr = entries.find( req.key );
+            if( itr != entries.end() )
+               erase( itr );
+            lru.push_front( req.key );
+            entries.emplace( req.key, entry{ std::move( response ), req.policy, req.generation, lru.begin(), size } );
+            bytes += size;
+            while( bytes > max_bytes )
+               erase( entries.find( lru.back() ) );
+         }
+
+      private:
+         struct entry {
+            std::shared_ptr<const cached_response> response;
+            http_cache_policy                      policy;
+            uint64_t                               generation;
+            std::list<std::string>::iterator       lru_pos;
+            size_t                                 size;
+         };
+
+         using entries_t = std::unordered_map<std::string, entry>;
+
+         void erase( entries_t::iterator itr ) {
+            bytes -= itr->second.size;
+            lru.erase( itr->second.lru_pos );
+            entries.erase( itr );
+         }
+
+         const size_t           max_bytes;
+         std::atomic<uint64_t>  head_generation{0};
+         std::mutex             mtx;               ///< protects the members below
+         entries_t              entries;
+         std::list<std::string> lru;               ///< keys, most recently used first
+         size_t                 bytes = 0;
+      };
    }
 
    using websocket_server_type = websocketpp::server<detail::asio_with_stub_log<websocketpp::transport::asio::basic_socket::endpoint>>;
@@ -210,6 +403,15 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
 
          // key -> priority, url_handler
          map<string,detail::internal_url_handler>  url_handlers;
+         map<string,detail::internal_binary_url_handler>  url_binary_handlers;
+         map<string,detail::internal_url_handler>  url_binary_request_handlers;
+         map<string,cache_policy_function>  cache_policies;
+         std::optional<detail::response_cache>  response_cache;
+         map<string,std::unique_ptr<detail::endpoint_latency>>  endpoint_latencies;
+         std::optional<std::ofstream>   request_log;
+         std::mutex                     request_log_mtx;          ///< serializes the writes to request_log
+         size_t                         request_log_bytes = 0;
+         size_t                         max_request_log_bytes = 0;
          std::optional<tcp::endpoint>  listen_endpoint;
          string                         access_control_allow_origin;
          string                         access_control_allow_headers;
@@ -218,14 +420,20 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
          size_t                         max_body_size{1024*1024};
 
          websocket_server_type    server;
+         bool                     beast_backend = false;     ///< serve listen_endpoint with beast_http_listener instead of server
+         size_t                   http_pipeline_limit = 16;
+         std::chrono::milliseconds  http_keep_alive_timeout{60*1000};
+         std::shared_ptr<detail::beast_http_listener>  beast_server;
 
          uint16_t                                       thread_pool_size = 2;
+         std::vector<uint16_t>                          thread_pool_cpus;
          std::optional<eosio::chain::named_thread_pool> thread_pool;
          std::atomic<size_t>                            bytes_in_flight{0};
          std::atomic<int32_t>                           requests_in_flight{0};
          size_t                                         max_bytes_in_flight = 0;
          int32_t                                        max_requests_in_flight = -1;
          fc::microseconds                               max_response_time{30*1000};
+         fc::microseconds                               resumable_step_time{10*1000};
 
          std::optional<tcp::endpoint>  https_listen_endpoint;
          string                        https_cert_chain;
@@ -399,9 +607,10 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
           */
          template<typename T>
          struct abstract_conn_impl : public detail::abstract_conn {
-            abstract_conn_impl(detail::connection_ptr<T> conn, http_plugin_impl_ptr impl)
+            abstract_conn_impl(detail::connection_ptr<T> conn, http_plugin_impl_ptr impl, std::optional<detail::cache_request> cache_req)
             :_conn(std::move(conn))
             ,_impl(std::move(impl))
+            ,_cache_req(std::move(cache_req))
             {
                 _impl->requests_in_flight += 1;
             }
@@ -430,15 +639,42 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
             }
 
             void send_response(std::optional<std::string> body, int code) override {
+               if( body && _cache_req && code == websocketpp::http::status_code::ok ) {
+                  auto response = std::make_shared<detail::cached_response>();
+                  response->etag = detail::make_etag( *body );
+                  _conn->append_header( "ETag", response->etag );
+                  if( response->etag == _cache_req->if_none_match ) {
+                     code = websocketpp::http::status_code::not_modified;
+                  } else {
+                     _conn->set_body( *body );
+                  }
+                  response->body = std::move( *body );
+                  _impl->response_cache->put( *_cache_req, std::move( response ) );
+                  body.reset();
+               }
                if( body ) {
                   _conn->set_body( std::move( *body ) );
                }
                _conn->set_status( websocketpp::http::status_code::value( code ) );
                _conn->send_http_response();
+               response_sent();
+            }
+
+            void send_binary_response(std::string body, int code) override {
+               send_typed_response( std::move( body ), "application/octet-stream", code );
+            }
+
+            void send_typed_response(std::string body, const std::string& content_type, int code) override {
+               _conn->replace_header( "Content-type", content_type );
+               _conn->set_body( std::move( body ) );
+               _conn->set_status( websocketpp::http::status_code::value( code ) );
+               _conn->send_http_response();
+               response_sent();
             }
 
             detail::connection_ptr<T> _conn;
             http_plugin_impl_ptr _impl;
+            std::optional<detail::cache_request> _cache_req;
          };
 
          /**
@@ -446,11 +682,13 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
           * @tparam T - The downstream parameter for the connection_ptr
           * @param conn - existing connection_ptr<T>
           * @param impl - the owning http_plugin_impl
+          * @param cache_req - the request to cache the response of, if any
           * @return abstract_conn_ptr backed by type specific implementations of the methods
           */
          template<typename T>
-         static detail::abstract_conn_ptr make_abstract_conn_ptr( detail::connection_ptr<T> conn, http_plugin_impl_ptr impl ) {
-            return std::make_shared<abstract_conn_impl<T>>(std::move(conn), std::move(impl));
+         static detail::abstract_conn_ptr make_abstract_conn_ptr( detail::connection_ptr<T> conn, http_plugin_impl_ptr impl,
+                                                                  std::optional<detail::cache_request> cache_req = {} ) {
+            return std::make_shared<abstract_conn_impl<T>>(std::move(conn), std::move(impl), std::move(cache_req));
          }
 
          /**
@@ -524,18 +762,21 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
          }
 
          /**
-          * Make an internal_url_handler that will run the url_handler on the app() thread and then
-          * return to the http thread pool for response processing
+          * Make an internal_url_handler that will run the url_handler on the app() thread, or on the non-consensus
+          * executor when non_consensus and the executor is running, and then return to the http thread pool for
+          * response processing
           *
           * @pre b.size() has been added to bytes_in_flight by caller
           * @param priority - priority to post to the app thread at
           * @param next - the next handler for responses
           * @param my - the http_plugin_impl
+          * @param non_consensus - the handler neither reads nor writes the chain state
           * @return the constructed internal_url_handler
           */
-         static detail::internal_url_handler make_app_thread_url_handler( int priority, url_handler next, http_plugin_impl_ptr my ) {
+         static detail::internal_url_handler make_app_thread_url_handler( int priority, url_handler next, http_plugin_impl_ptr my,
+                                                                          bool non_consensus = false ) {
             auto next_ptr = std::make_shared<url_handler>(std::move(next));
-            return [my=std::move(my), priority, next_ptr=std::move(next_ptr)]
+            return [my=std::move(my), priority, next_ptr=std::move(next_ptr), non_consensus]
                        ( detail::abstract_conn_ptr conn, string r, string b, url_response_callback then ) {
                auto tracked_b = make_in_flight<string>(std::move(b), my);
                if (!conn->verify_max_bytes_in_flight()) {
@@ -548,17 +789,200 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
 
                // post to the app thread taking shared ownership of next (via std::shared_ptr),
                // sole ownership of the tracked body and the passed in parameters
-               app().post( priority, [next_ptr, conn=std::move(conn), r=std::move(r), tracked_b, wrapped_then=std::move(wrapped_then)]() mutable {
+               auto handle = [next_ptr, conn=std::move(conn), r=std::move(r), tracked_b, wrapped_then=std::move(wrapped_then)]() mutable {
                   try {
+                     conn->start_handler();
                      // call the `next` url_handler and wrap the response handler
                      (*next_ptr)( std::move( r ), std::move(tracked_b->obj()), std::move(wrapped_then)) ;
                   } catch( ... ) {
                      conn->handle_exception();
                   }
+               };
+               auto& executor = chain::non_consensus_executor::shared();
+               if( non_consensus && executor.running() )
+                  executor.post( priority, std::move( handle ) );
+               else
+                  app().post( priority, std::move( handle ) );
+            };
+         }
+
+         /// a resumable call between its steps
+         struct resumable_call {
+            url_step          step;
+            fc::microseconds  used{0}; ///< running time of the steps so far
+         };
+
+         /// run the next step of call and post the one after it where it asks to resume
+         static void run_step( const http_plugin_impl_ptr& my, int priority, const detail::abstract_conn_ptr& conn,
+                               const std::shared_ptr<resumable_call>& call ) {
+            try {
+               const auto start     = fc::time_point::now();
+               const auto remaining = my->max_response_time - call->used;
+               const bool last      = remaining <= my->resumable_step_time;
+               const auto next      = call->step( start + std::min( remaining, my->resumable_step_time ), last );
+               call->used += fc::time_point::now() - start;
+               if( next == resume_on::done )
+                  return;
+               if( last )
+                  FC_THROW_EXCEPTION( fc::timeout_exception, "call exceeded http-max-response-time-ms of ${t}us",
+                                      ("t", my->max_response_time.count()) );
+               auto resume = [my, priority, conn, call]() { run_step( my, priority, conn, call ); };
+               if( next == resume_on::http_thread )
+                  boost::asio::post( my->thread_pool->get_executor(), std::move( resume ) );
+               else
+                  app().post( priority, std::move( resume ) );
+            } catch( ... ) {
+               conn->handle_exception();
+            }
+         }
+
+         /**
+          * Make an internal_url_handler that will start the url_resumable_handler on the app() thread and run its
+          * steps where they ask to resume, the response returns to the http thread pool for processing
+          *
+          * @pre b.size() has been added to bytes_in_flight by caller
+          * @param priority - priority to post to the app thread at
+          * @param next - the handler starting the call
+          * @param my - the http_plugin_impl
+          * @return the constructed internal_url_handler
+          */
+         static detail::internal_url_handler make_app_thread_resumable_url_handler( int priority, url_resumable_handler next, http_plugin_impl_ptr my ) {
+            auto next_ptr = std::make_shared<url_resumable_handler>(std::move(next));
+            return [my=std::move(my), priority, next_ptr=std::move(next_ptr)]
+                       ( detail::abstract_conn_ptr conn, string r, string b, url_response_callback then ) {
+               auto tracked_b = make_in_flight<string>(std::move(b), my);
+               if (!conn->verify_max_bytes_in_flight()) {
+                  return;
+               }
+
+               url_response_callback wrapped_then = [tracked_b, then=std::move(then)](int code, std::optional<fc::variant> resp) {
+                  then(code, std::move(resp));
+               };
+
+               app().post( priority, [my, priority, next_ptr, conn=std::move(conn), r=std::move(r), tracked_b, wrapped_then=std::move(wrapped_then)]() mutable {
+                  try {
+                     conn->start_handler();
+                     auto step = (*next_ptr)( std::move( r ), std::move(tracked_b->obj()), std::move(wrapped_then) );
+                     if( step )
+                        run_step( my, priority, conn, std::make_shared<resumable_call>( resumable_call{ std::move( step ) } ) );
+                  } catch( ... ) {
+                     conn->handle_exception();
+                  }
+               } );
+            };
+         }
+
+         /**
+          * Make an internal_binary_url_handler that will run the url_binary_handler on the app() thread and then
+          * return to the http thread pool for response processing
+          *
+          * @pre b.size() has been added to bytes_in_flight by caller
+          * @param priority - priority to post to the app thread at
+          * @param next - the next handler for responses
+          * @param my - the http_plugin_impl
+          * @return the constructed internal_binary_url_handler
+          */
+         static detail::internal_binary_url_handler make_app_thread_binary_url_handler( int priority, url_binary_handler next, http_plugin_impl_ptr my ) {
+            auto next_ptr = std::make_shared<url_binary_handler>(std::move(next));
+            return [my=std::move(my), priority, next_ptr=std::move(next_ptr)]
+                       ( detail::abstract_conn_ptr conn, string r, string b, url_response_callback then, url_binary_response_callback binary_then ) {
+               auto tracked_b = make_in_flight<string>(std::move(b), my);
+               if (!conn->verify_max_bytes_in_flight()) {
+                  return;
+               }
+
+               // post to the app thread taking shared ownership of next (via std::shared_ptr),
+               // sole ownership of the tracked body and the passed in parameters
+               app().post( priority, [next_ptr, conn=std::move(conn), r=std::move(r), tracked_b, then=std::move(then), binary_then=std::move(binary_then)]() mutable {
+                  try {
+                     conn->start_handler();
+                     url_response_callback wrapped_then = [tracked_b, then=std::move(then)](int code, std::optional<fc::variant> resp) {
+                        then(code, std::move(resp));
+                     };
+                     (*next_ptr)( std::move( r ), std::move(tracked_b->obj()), std::move(wrapped_then), std::move(binary_then) );
+                  } catch( ... ) {
+                     conn->handle_exception();
+                  }
                } );
             };
          }
 
+         /**
+          * Make an internal_binary_url_handler that will run the url_binary_handler directly
+          *
+          * @pre b.size() has been added to bytes_in_flight by caller
+          * @param next - the next handler for responses
+          * @return the constructed internal_binary_url_handler
+          */
+         static detail::internal_binary_url_handler make_http_thread_binary_url_handler(url_binary_handler next) {
+            return [next=std::move(next)]( const detail::abstract_conn_ptr& conn, string r, string b, url_response_callback then, url_binary_response_callback binary_then ) {
+               try {
+                  conn->start_handler();
+                  next(std::move(r), std::move(b), std::move(then), std::move(binary_then));
+               } catch( ... ) {
+                  conn->handle_exception();
+               }
+             };
+         }
+
+         /**
+          * Make an internal_url_handler that will run the url_json_handler on the app() thread and then
+          * return to the http thread pool to send the JSON it has written
+          *
+          * @pre b.size() has been added to bytes_in_flight by caller
+          * @param priority - priority to post to the app thread at
+          * @param next - the next handler for responses
+          * @param my - the http_plugin_impl
+          * @param content_type - of the responses when they are not JSON
+          * @return the constructed internal_url_handler
+          */
+         static detail::internal_url_handler make_app_thread_json_url_handler( int priority, url_json_handler next, http_plugin_impl_ptr my,
+                                                                               std::string content_type = {} ) {
+            auto next_ptr = std::make_shared<url_json_handler>(std::move(next));
+            return [my=std::move(my), priority, next_ptr=std::move(next_ptr), content_type=std::move(content_type)]
+                       ( detail::abstract_conn_ptr conn, string r, string b, url_response_callback then ) {
+               auto tracked_b = make_in_flight<string>(std::move(b), my);
+               if (!conn->verify_max_bytes_in_flight()) {
+                  return;
+               }
+
+               url_json_response_callback json_then = make_http_json_response_handler(conn, my, content_type);
+
+               // post to the app thread taking shared ownership of next (via std::shared_ptr),
+               // sole ownership of the tracked body and the passed in parameters
+               app().post( priority, [next_ptr, conn=std::move(conn), r=std::move(r), tracked_b, then=std::move(then), json_then=std::move(json_then)]() mutable {
+                  try {
+                     conn->start_handler();
+                     url_response_callback wrapped_then = [tracked_b, then=std::move(then)](int code, std::optional<fc::variant> resp) {
+                        then(code, std::move(resp));
+                     };
+                     (*next_ptr)( std::move( r ), std::move(tracked_b->obj()), std::move(wrapped_then), std::move(json_then) );
+                  } catch( ... ) {
+                     conn->handle_exception();
+                  }
+               } );
+            };
+         }
+
+         /**
+          * Make an internal_url_handler that will run the url_json_handler directly
+          *
+          * @pre b.size() has been added to bytes_in_flight by caller
+          * @param next - the next handler for responses
+          * @param my - the http_plugin_impl
+          * @return the constructed internal_url_handler
+          */
+         static detail::internal_url_handler make_http_thread_json_url_handler( url_json_handler next, http_plugin_impl_ptr my ) {
+            return [next=std::move(next), my=std::move(my)]( const detail::abstract_conn_ptr& conn, string r, string b, url_response_callback then ) {
+               try {
+                  conn->start_handler();
+                  next(std::move(r), std::move(b), std::move(then), make_http_json_response_handler(conn, my));
+               } catch( ... ) {
+                  conn->handle_exception();
+               }
+             };
+         }
+
          /**
           * Make an internal_url_handler that will run the url_handler directly
           *
@@ -569,6 +993,7 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
          static detail::internal_url_handler make_http_thread_url_handler(url_handler next) {
             return [next=std::move(next)]( const detail::abstract_conn_ptr& conn, string r, string b, url_response_callback then ) {
                try {
+                  conn->start_handler();
                   next(std::move(r), std::move(b), std::move(then));
                } catch( ... ) {
                   conn->handle_exception();
@@ -586,6 +1011,7 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
          template<typename T>
          auto make_http_response_handler( const detail::abstract_conn_ptr& abstract_conn_ptr) {
             return [my=shared_from_this(), abstract_conn_ptr]( int code, std::optional<fc::variant> response ) {
+               abstract_conn_ptr->response_ready();
                auto tracked_response = make_in_flight(std::move(response), my);
                if (!abstract_conn_ptr->verify_max_bytes_in_flight()) {
                   return;
@@ -596,7 +1022,10 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
                                   [my, abstract_conn_ptr, code, tracked_response=std::move(tracked_response)]() {
                   try {
                      if( tracked_response->obj().has_value() ) {
-                        std::string json = fc::json::to_string( *tracked_response->obj(), fc::time_point::now() + my->max_response_time );
+                        const auto start = fc::time_point::now();
+                        std::string json = fc::json::to_string( *tracked_response->obj(), start + my->max_response_time );
+                        if( abstract_conn_ptr->latency )
+                           abstract_conn_ptr->latency->record( detail::endpoint_latency::serialize, fc::time_point::now() - start );
                         auto tracked_json = make_in_flight( std::move( json ), my );
                         abstract_conn_ptr->send_response( std::move( tracked_json->obj() ), code );
                      } else {
@@ -609,9 +1038,144 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
             };
          }
 
+         /**
+          * Construct a lambda appropriate for url_binary_response_callback that will send the provided
+          * response as is
+          *
+          * @param con - pointer for the connection this response should be sent to
+          * @return lambda suitable for url_binary_response_callback
+          */
+         template<typename T>
+         auto make_http_binary_response_handler( const detail::abstract_conn_ptr& abstract_conn_ptr) {
+            return [my=shared_from_this(), abstract_conn_ptr]( int code, std::vector<char> response ) {
+               abstract_conn_ptr->response_ready();
+               auto tracked_response = make_in_flight(std::string(response.begin(), response.end()), my);
+               response = {};
+               if (!abstract_conn_ptr->verify_max_bytes_in_flight()) {
+                  return;
+               }
+
+               // post  back to an HTTP thread to to allow the response handler to be called from any thread
+               boost::asio::post( my->thread_pool->get_executor(),
+                                  [abstract_conn_ptr, code, tracked_response=std::move(tracked_response)]() {
+                  try {
+                     abstract_conn_ptr->send_binary_response( std::move( tracked_response->obj() ), code );
+                  } catch( ... ) {
+                     abstract_conn_ptr->handle_exception();
+                  }
+               });
+            };
+         }
+
+         /**
+          * Construct a lambda appropriate for url_json_response_callback that will send the provided
+          * JSON as is
+          *
+          * @param con - pointer for the connection this response should be sent to
+          * @param my - the http_plugin_impl
+          * @param content_type - of the response when it is not JSON
+          * @return lambda suitable for url_json_response_callback
+          */
+         static url_json_response_callback make_http_json_response_handler( const detail::abstract_conn_ptr& abstract_conn_ptr, const http_plugin_impl_ptr& my,
+                                                                            const std::string& content_type = {} ) {
+            return [my, abstract_conn_ptr, content_type]( int code, std::string json ) {
+               abstract_conn_ptr->response_ready();
+               auto tracked_json = make_in_flight(std::move(json), my);
+               if (!abstract_conn_ptr->verify_max_bytes_in_flight()) {
+                  return;
+               }
+
+               // post  back to an HTTP thread to to allow the response handler to be called from any thread
+               boost::asio::post( my->thread_pool->get_executor(),
+                                  [abstract_conn_ptr, code, tracked_json=std::move(tracked_json), content_type]() {
+                  try {
+                     if( content_type.empty() )
+                        abstract_conn_ptr->send_response( std::move( tracked_json->obj() ), code );
+                     else
+                        abstract_conn_ptr->send_typed_response( std::move( tracked_json->obj() ), content_type, code );
+                  } catch( ... ) {
+                     abstract_conn_ptr->handle_exception();
+                  }
+               });
+            };
+         }
+
+         /// @return true if the request asks for a binary response
+         template<typename T>
+         static bool accepts_binary( const T& req ) {
+            return req.get_header("Accept").find("application/octet-stream") != std::string::npos;
+         }
+
+         /// @return true if the body of the request is binary
+         template<typename T>
+         static bool sends_binary( const T& req ) {
+            return req.get_header("Content-Type").find("application/octet-stream") != std::string::npos;
+         }
+
+         /**
+          * Send the cached response of the request if there is one, otherwise decide if its response is to be cached
+          * @return true if the response has been sent
+          */
+         template<class T>
+         bool handle_cached_request(const detail::connection_ptr<T>& con, const std::string& resource, std::optional<detail::cache_request>& cache_req) {
+            if( !response_cache )
+               return false;
+            auto& req = con->get_request();
+            auto policy_itr = cache_policies.find( resource );
+            if( policy_itr == cache_policies.end() || accepts_binary( req ) )
+               return false;
+
+            const auto& body = con->get_request_body();
+            const auto policy = policy_itr->second( body );
+            if( policy == http_cache_policy::none )
+               return false;
+
+            detail::cache_request creq{ resource + '\n' + body, policy, response_cache->generation(), req.get_header( "If-None-Match" ) };
+            const auto cached = response_cache->get( creq.key );
+            if( !cached ) {
+               cache_req = std::move( creq );
+               return false;
+            }
+            con->append_header( "ETag", cached->etag );
+            if( cached->etag == creq.if_none_match ) {
+               con->set_status( websocketpp::http::status_code::not_modified );
+            } else {
+               con->set_body( cached->body );
+               con->set_status( websocketpp::http::status_code::ok );
+            }
+            con->send_http_response();
+            return true;
+         }
+
+         /// time the requests of url, called when a handler is added for it
+         void add_endpoint_latency( const string& url ) {
+            auto& latency = endpoint_latencies[url];
+            if( !latency )
+               latency = std::make_unique<detail::endpoint_latency>();
+         }
+
+         /// append the request to the http-request-log-file as a line of JSON, until http-request-log-max-mb is reached
+         void log_request( fc::time_point received, const string& resource, const string& body ) {
+            const auto line = fc::json::to_string( fc::mutable_variant_object()
+                                                      ( "time_us", received.time_since_epoch().count() )
+                                                      ( "endpoint", resource )
+                                                      ( "body", body ), fc::time_point::maximum() );
+            std::lock_guard g( request_log_mtx );
+            if( !request_log )
+               return;
+            if( request_log_bytes + line.size() + 1 > max_request_log_bytes ) {
+               fc_wlog( logger, "http-request-log-max-mb reached, no longer logging requests" );
+               request_log.reset();
+               return;
+            }
+            *request_log << line << '\n';
+            request_log_bytes += line.size() + 1;
+         }
+
          template<class T>
          void handle_http_request(detail::connection_ptr<T> con) {
             try {
+               const auto received = fc::time_point::now();
                auto& req = con->get_request();
 
                if(!allow_host<T>(req, con))
@@ -638,10 +1202,38 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
                con->append_header( "Content-type", "application/json" );
                con->defer_http_response();
 
-               auto abstract_conn_ptr = make_abstract_conn_ptr<T>(con, shared_from_this());
+               std::string resource = con->get_uri()->get_resource();
+               if( request_log && !sends_binary( req ) )
+                  log_request( received, resource, con->get_request_body() );
+
+               std::optional<detail::cache_request> cache_req;
+               if( handle_cached_request<T>( con, resource, cache_req ) ) return;
+
+               auto abstract_conn_ptr = make_abstract_conn_ptr<T>(con, shared_from_this(), std::move(cache_req));
                if( !verify_max_bytes_in_flight( con ) || !verify_max_requests_in_flight( con ) ) return;
 
-               std::string resource = con->get_uri()->get_resource();
+               if( auto latency_itr = endpoint_latencies.find( resource ); latency_itr != endpoint_latencies.end() ) {
+                  abstract_conn_ptr->latency = latency_itr->second.get();
+                  abstract_conn_ptr->received = received;
+               }
+
+               if( sends_binary( req ) ) {
+                  auto itr = url_binary_request_handlers.find( resource );
+                  if( itr != url_binary_request_handlers.end() ) {
+                     std::string body = con->get_request_body();
+                     itr->second( abstract_conn_ptr, std::move( resource ), std::move( body ), make_http_response_handler<T>(abstract_conn_ptr) );
+                     return;
+                  }
+               }
+
+               auto binary_handler_itr = url_binary_handlers.find( resource );
+               if( binary_handler_itr != url_binary_handlers.end() && accepts_binary( req ) ) {
+                  std::string body = con->get_request_body();
+                  binary_handler_itr->second( abstract_conn_ptr, std::move( resource ), std::move( body ),
+                                              make_http_response_handler<T>(abstract_conn_ptr), make_http_binary_response_handler<T>(abstract_conn_ptr) );
+                  return;
+               }
+
                auto handler_itr = url_handlers.find( resource );
                if( handler_itr != url_handlers.end()) {
                   std::string body = con->get_request_body();
@@ -720,6 +1312,15 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
              "The local IP and port to listen for incoming http connections; leave blank to disable.");
 
       cfg.add_options()
+            ("http-server-backend", bpo::value<string>()->default_value("websocketpp"),
+             "Server of the http-server-address connections: \"websocketpp\", or \"beast\" which keeps the connections alive "
+             "and runs the requests pipelined by a client concurrently, answering them in order.")
+            ("http-pipeline-limit", bpo::value<uint32_t>()->default_value(16),
+             "Maximum number of pipelined requests of a connection processed at once by the beast server, the next requests "
+             "are read once a response has been sent.")
+            ("http-keep-alive-timeout-ms", bpo::value<uint32_t>()->default_value(60*1000),
+             "Milliseconds an idle connection is kept open by the beast server.")
+
             ("https-server-address", bpo::value<string>(),
              "The local IP and port to listen for incoming https connections; leave blank to disable.")
 
@@ -769,6 +1370,9 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
              "Maximum number of requests http_plugin should use for processing http requests. 429 error response when exceeded." )
             ("http-max-response-time-ms", bpo::value<uint32_t>()->default_value(30),
              "Maximum time for processing a request.")
+            ("http-resumable-step-ms", bpo::value<uint32_t>()->default_value(10),
+             "Maximum time a step of a resumable call, such as get_table_by_scope, runs before yielding to the other tasks of the main thread. "
+             "The steps of a call run for at most http-max-response-time-ms in total.")
             ("verbose-http-errors", bpo::bool_switch()->default_value(false),
              "Append the error log to HTTP responses")
             ("http-validate-host", boost::program_options::value<bool>()->default_value(true),
@@ -777,6 +1381,16 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
              "Additionaly acceptable values for the \"Host\" header of incoming HTTP requests, can be specified multiple times.  Includes http/s_server_address by default.")
             ("http-threads", bpo::value<uint16_t>()->default_value( my->thread_pool_size ),
              "Number of worker threads in http thread pool")
+            ("http-threads-cpus", bpo::value<string>(),
+             "CPUs the http thread pool is pinned to, e.g. \"2-5,8\". By default the threads inherit the affinity of the main thread.")
+            ("http-cache-size-mb", bpo::value<uint32_t>()->default_value(0),
+             "Maximum size in megabytes of the cache of the responses of calls that do not change until the next block, such as get_abi, "
+             "or at all, such as get_block of an irreversible block. Cached responses carry an ETag. 0 disables the cache.")
+            ("http-request-log-file", bpo::value<string>(),
+             "Append the endpoint, body and arrival time of each JSON request as a line of JSON to this file (relative to data-dir), "
+             "to replay them with eosio-http-bench. Leave blank to not log requests.")
+            ("http-request-log-max-mb", bpo::value<uint32_t>()->default_value(1024),
+             "Stop logging requests to http-request-log-file when it has grown by this many megabytes.")
             ;
    }
 
@@ -848,16 +1462,44 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
             }
          }
 
+         const auto& backend = options.at( "http-server-backend" ).as<string>();
+         EOS_ASSERT( backend == "websocketpp" || backend == "beast", chain::plugin_config_exception,
+                     "http-server-backend must be \"websocketpp\" or \"beast\", not \"${b}\"", ("b", backend) );
+         my->beast_backend = backend == "beast";
+         my->http_pipeline_limit = options.at( "http-pipeline-limit" ).as<uint32_t>();
+         EOS_ASSERT( my->http_pipeline_limit > 0, chain::plugin_config_exception, "http-pipeline-limit must be greater than 0" );
+         my->http_keep_alive_timeout = std::chrono::milliseconds( options.at( "http-keep-alive-timeout-ms" ).as<uint32_t>() );
+
          my->max_body_size = options.at( "max-body-size" ).as<uint32_t>();
          verbose_http_errors = options.at( "verbose-http-errors" ).as<bool>();
 
          my->thread_pool_size = options.at( "http-threads" ).as<uint16_t>();
          EOS_ASSERT( my->thread_pool_size > 0, chain::plugin_config_exception,
                      "http-threads ${num} must be greater than 0", ("num", my->thread_pool_size));
+         if( options.count( "http-threads-cpus" ))
+            my->thread_pool_cpus = chain::parse_cpu_list( options.at( "http-threads-cpus" ).as<string>() );
 
          my->max_bytes_in_flight = options.at( "http-max-bytes-in-flight-mb" ).as<uint32_t>() * 1024 * 1024;
          my->max_requests_in_flight = options.at( "http-max-in-flight-requests" ).as<int32_t>();
          my->max_response_time = fc::microseconds( options.at("http-max-response-time-ms").as<uint32_t>() * 1000 );
+         my->resumable_step_time = fc::microseconds( options.at("http-resumable-step-ms").as<uint32_t>() * 1000 );
+         EOS_ASSERT( my->resumable_step_time.count() > 0, chain::plugin_config_exception,
+                     "http-resumable-step-ms must be greater than 0" );
+
+         if( const auto cache_size_mb = options.at( "http-cache-size-mb" ).as<uint32_t>() ) {
+            my->response_cache.emplace( size_t(cache_size_mb) * 1024 * 1024 );
+         }
+
+         if( options.count( "http-request-log-file" ) && !options.at( "http-request-log-file" ).as<string>().empty() ) {
+            boost::filesystem::path log_path = options.at( "http-request-log-file" ).as<string>();
+            if( log_path.is_relative() )
+               log_path = app().data_dir() / log_path;
+            my->request_log.emplace( log_path.string(), std::ios::out | std::ios::app );
+            EOS_ASSERT( my->request_log->good(), chain::plugin_config_exception,
+                        "unable to open http-request-log-file ${f}", ("f", log_path.string()) );
+            my->max_request_log_bytes = size_t( options.at( "http-request-log-max-mb" ).as<uint32_t>() ) * 1024 * 1024;
+            fc_ilog( logger, "logging http requests to ${f}", ("f", log_path.string()) );
+         }
 
          //watch out for the returns above when adding new code here
       } FC_LOG_AND_RETHROW()
@@ -869,8 +1511,30 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
       app().post(appbase::priority::high, [this] ()
       {
          try {
-            my->thread_pool.emplace( "http", my->thread_pool_size );
-            if(my->listen_endpoint) {
+            my->thread_pool.emplace( "http", my->thread_pool_size, my->thread_pool_cpus );
+            if(my->listen_endpoint && my->beast_backend) {
+               try {
+                  // captures `this`, my needs to live as long as beast_server is handling requests
+                  my->beast_server = std::make_shared<detail::beast_http_listener>(
+                        my->thread_pool->get_executor(), *my->listen_endpoint,
+                        [this]( std::shared_ptr<detail::beast_http_connection> con ) {
+                           my->handle_http_request<detail::beast_config>( std::move( con ) );
+                        },
+                        my->max_body_size, my->http_pipeline_limit, my->http_keep_alive_timeout );
+
+                  fc_ilog( logger, "start listening for http requests (beast)" );
+                  my->beast_server->start_accept();
+               } catch ( const fc::exception& e ){
+                  fc_elog( logger, "http service failed to start: ${e}", ("e", e.to_detail_string()) );
+                  throw;
+               } catch ( const std::exception& e ){
+                  fc_elog( logger, "http service failed to start: ${e}", ("e", e.what()) );
+                  throw;
+               } catch (...) {
+                  fc_elog( logger, "error thrown from http io service" );
+                  throw;
+               }
+            } else if(my->listen_endpoint) {
                try {
                   my->create_server_for_endpoint(*my->listen_endpoint, my->server);
 
@@ -961,6 +1625,10 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
    void http_plugin::plugin_shutdown() {
       if(my->server.is_listening())
          my->server.stop_listening();
+      if(my->beast_server) {
+         my->beast_server->stop_listening();
+         my->beast_server.reset();
+      }
       if(my->https_server.is_listening())
          my->https_server.stop_listening();
 #ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
@@ -975,6 +1643,9 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
 
       // release http_plugin_impl_ptr shared_ptrs captured in url handlers
       my->url_handlers.clear();
+      my->url_binary_handlers.clear();
+      my->url_binary_request_handlers.clear();
+      my->cache_policies.clear();
 
       app().post( 0, [me = my](){} ); // keep my pointer alive until queue is drained
    }
@@ -982,11 +1653,71 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
    void http_plugin::add_handler(const string& url, const url_handler& handler, int priority) {
       fc_ilog( logger, "add api url: ${c}", ("c", url) );
       my->url_handlers[url] = my->make_app_thread_url_handler(priority, handler, my);
+      my->add_endpoint_latency(url);
+   }
+
+   void http_plugin::add_non_consensus_handler(const string& url, const url_handler& handler, int priority) {
+      fc_ilog( logger, "add api url: ${c}", ("c", url) );
+      my->url_handlers[url] = my->make_app_thread_url_handler(priority, handler, my, true);
+      my->add_endpoint_latency(url);
+   }
+
+   void http_plugin::add_resumable_handler(const string& url, const url_resumable_handler& handler, int priority) {
+      fc_ilog( logger, "add api url: ${c}", ("c", url) );
+      my->url_handlers[url] = my->make_app_thread_resumable_url_handler(priority, handler, my);
+      my->add_endpoint_latency(url);
    }
 
    void http_plugin::add_async_handler(const string& url, const url_handler& handler) {
       fc_ilog( logger, "add api url: ${c}", ("c", url) );
       my->url_handlers[url] = my->make_http_thread_url_handler(handler);
+      my->add_endpoint_latency(url);
+   }
+
+   void http_plugin::add_json_handler(const string& url, const url_json_handler& handler, int priority) {
+      fc_ilog( logger, "add api url: ${c}", ("c", url) );
+      my->url_handlers[url] = my->make_app_thread_json_url_handler(priority, handler, my);
+      my->add_endpoint_latency(url);
+   }
+
+   void http_plugin::add_text_handler(const string& url, const string& content_type, const url_json_handler& handler, int priority) {
+      fc_ilog( logger, "add api url: ${c}", ("c", url) );
+      my->url_handlers[url] = my->make_app_thread_json_url_handler(priority, handler, my, content_type);
+      my->add_endpoint_latency(url);
+   }
+
+   void http_plugin::add_async_json_handler(const string& url, const url_json_handler& handler) {
+      fc_ilog( logger, "add api url: ${c}", ("c", url) );
+      my->url_handlers[url] = my->make_http_thread_json_url_handler(handler, my);
+      my->add_endpoint_latency(url);
+   }
+
+   void http_plugin::add_binary_handler(const string& url, const url_binary_handler& handler, int priority) {
+      fc_ilog( logger, "add binary api url: ${c}", ("c", url) );
+      my->url_binary_handlers[url] = my->make_app_thread_binary_url_handler(priority, handler, my);
+      my->add_endpoint_latency(url);
+   }
+
+   void http_plugin::add_async_binary_handler(const string& url, const url_binary_handler& handler) {
+      fc_ilog( logger, "add binary api url: ${c}", ("c", url) );
+      my->url_binary_handlers[url] = my->make_http_thread_binary_url_handler(handler);
+      my->add_endpoint_latency(url);
+   }
+
+   void http_plugin::add_binary_request_handler(const string& url, const url_handler& handler, int priority) {
+      fc_ilog( logger, "add binary request api url: ${c}", ("c", url) );
+      my->url_binary_request_handlers[url] = my->make_app_thread_url_handler(priority, handler, my);
+      my->add_endpoint_latency(url);
+   }
+
+   void http_plugin::add_cache_policy(const string& url, cache_policy_function policy) {
+      my->cache_policies[url] = std::move(policy);
+   }
+
+   void http_plugin::invalidate_head_cache() {
+      if( my->response_cache ) {
+         my->response_cache->invalidate_head();
+      }
    }
 
    void http_plugin::handle_exception( const char *api_name, const char *call_name, const string& body, url_response_callback cb ) {
@@ -1056,10 +1787,27 @@ class http_plugin_impl : public std::enable_shared_from_this<http_plugin_impl> {
       return result;
    }
 
+   vector<http_stage_latency> http_plugin::get_endpoint_latency()const {
+      vector<http_stage_latency> result;
+      result.reserve( my->endpoint_latencies.size() * detail::endpoint_latency::stage_count );
+      for( const auto& [endpoint, latency] : my->endpoint_latencies )
+         latency->snapshot( endpoint, result );
+      return result;
+   }
+
    fc::microseconds http_plugin::get_max_response_time()const {
       return my->max_response_time;
    }
 
+   uint16_t http_plugin::get_thread_pool_size()const {
+      return my->thread_pool_size;
+   }
+
+   void http_plugin::post_http_thread_pool(std::function<void()> f) {
+      if( my->thread_pool )
+         boost::asio::post( my->thread_pool->get_executor(), std::move(f) );
+   }
+
    std::istream& operator>>(std::istream& in, https_ecdh_curve_t& curve) {
       std::string s;
       in >> s;
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace eosio { namespace detail {
+
+   namespace beast = boost::beast;
+
+   class beast_http_session;
+
+   /**
+    * A request read by a beast_http_session and its response, with the subset of the interface of a websocketpp
+    * connection used by http_plugin so that the request handling is shared by both servers.
+    */
+   class beast_http_connection : public std::enable_shared_from_this<beast_http_connection> {
+   public:
+      using request_type  = beast::http::request<beast::http::string_body>;
+      using response_type = beast::http::response<beast::http::string_body>;
+
+      /// accessors of the websocketpp request
+      class request {
+      public:
+         explicit request( request_type&& req ) : req( std::move( req ) ) {}
+
+         std::string get_header( const std::string& name ) const {
+            auto itr = req.find( name );
+            return itr == req.end() ? std::string() : std::string( itr->value().data(), itr->value().size() );
+         }
+
+         std::string get_method() const {
+            return std::string( req.method_string().data(), req.method_string().size() );
+         }
+
+         request_type req;
+      };
+
+      /// accessors of the websocketpp uri, plain connections only
+      class uri {
+      public:
+         explicit uri( std::string resource ) : resource( std::move( resource ) ) {}
+
+         bool get_secure() const { return false; }
+         const std::string& get_resource() const { return resource; }
+
+      private:
+         std::string resource;
+      };
+
+      beast_http_connection( std::shared_ptr<beast_http_session> session, request_type&& req )
+      : session( std::move( session ) )
+      , req( std::move( req ) )
+      , resource( std::string( this->req.req.target().data(), this->req.req.target().size() ) )
+      {
+         response.version( this->req.req.version() );
+         response.keep_alive( this->req.req.keep_alive() );
+         response.result( beast::http::status::ok );
+      }
+
+      const request& get_request() const { return req; }
+      const uri* get_uri() const { return &resource; }
+      const std::string& get_request_body() const { return req.req.body(); }
+      inline boost::asio::ip::tcp::socket& get_socket();
+
+      void append_header( const std::string& key, const std::string& value ) { response.insert( key, value ); }
+      void replace_header( const std::string& key, const std::string& value ) { response.set( key, value ); }
+      void set_status( int code ) { response.result( static_cast<unsigned>( code ) ); }
+      void set_body( std::string body ) { response.body() = std::move( body ); }
+
+      /// the response is sent by send_http_response instead of when the handler returns
+      void defer_http_response() { deferred = true; }
+      bool is_deferred() const { return deferred; }
+
+      /// hand the response to the session, which writes the responses of its requests in the order of the requests;
+      /// may be called from any thread, only the first call sends
+      inline void send_http_response();
+
+   private:
+      friend class beast_http_session;
+
+      std::shared_ptr<beast_http_session> session;
+      request                             req;
+      uri                                 resource;
+      response_type                       response;
+      bool                                deferred = false;
+      std::atomic<bool>                   sent{false};
+      bool                                ready = false;    ///< the response can be written, accessed on the session strand
+   };
+
+   /**
+    * HTTP/1.1 connection served with Boost.Beast.  The connection is kept alive between requests, and the requests
+    * pipelined by the client are read while the responses of the previous ones are pending, up to max_queued
+    * requests, so that their handlers run concurrently.  The responses are written in the order of the requests.
+    */
+   class beast_http_session : public std::enable_shared_from_this<beast_http_session> {
+   public:
+      using handler_type = std::function<void(std::shared_ptr<beast_http_connection>)>;
+
+      beast_http_session( boost::asio::ip::tcp::socket&& socket, handler_type handler, size_t max_body_size,
+                          size_t max_queued, std::chrono::milliseconds idle_timeout )
+      : stream( std::move( socket ) )
+      , idle_timer( stream.get_executor() )
+      , handler( std::move( handler ) )
+      , max_body_size( max_body_size )
+      , max_queued( std::max<size_t>( max_queued, 1 ) )
+      , idle_timeout( idle_timeout )
+      {}
+
+      void run() {
+         boost::asio::dispatch( stream.get_executor(), [self = shared_from_this()]() {
+            self->refresh_idle_timer();
+            self->do_read();
+         } );
+      }
+
+      boost::asio::ip::tcp::socket& socket() { return stream.socket(); }
+
+   private:
+      friend class beast_http_connection;
+
+      void do_read() {
+         parser.emplace();
+         parser->body_limit( max_body_size );
+         reading = true;
+         beast::http::async_read( stream, buffer, *parser,
+                                  beast::bind_front_handler( &beast_http_session::on_read, shared_from_this() ) );
+      }
+
+      void on_read( beast::error_code ec, std::size_t ) {
+         reading = false;
+         if( !open )
+            return;
+         if( ec ) {
+            // end of stream, timeout or malformed request: answer the pending requests, then close
+            closing = true;
+            if( ec == beast::http::error::body_limit )
+               queue_error_response( beast::http::status::payload_too_large );
+            else if( ec.category() == beast::http::make_error_code( beast::http::error::bad_method ).category() &&
+                     ec != beast::http::error::end_of_stream && ec != beast::http::error::partial_message )
+               queue_error_response( beast::http::status::bad_request );
+            else if( !writing && pending.empty() )
+               do_close();
+            return;
+         }
+
+         auto con = std::make_shared<beast_http_connection>( shared_from_this(), parser->release() );
+         pending.push_back( con );
+         handler( con );
+         if( !con->is_deferred() )
+            con->send_http_response();
+         refresh_idle_timer();
+
+         if( open && !closing && pending.size() < max_queued )
+            do_read();
+      }
+
+      /// answer a request which could not be read after the pending ones, the connection is closed once it is written
+      void queue_error_response( beast::http::status status ) {
+         beast_http_connection::request_type req;
+         req.keep_alive( false );
+         auto con = std::make_shared<beast_http_connection>( shared_from_this(), std::move( req ) );
+         con->response.result( status );
+         con->response.set( beast::http::field::content_type, "text/plain" );
+         con->response.body() = std::string( beast::http::obsolete_reason( status ) );
+         con->sent = true;
+         con->ready = true;
+         pending.push_back( con );
+         write_next();
+      }
+
+      /// on the strand, after con has its response
+      void on_response_ready( const std::shared_ptr<beast_http_connection>& con ) {
+         if( !open )
+            return;
+         con->ready = true;
+         write_next();
+      }
+
+      void write_next() {
+         if( writing || pending.empty() || !pending.front()->ready )
+            return;
+         writing = true;
+         auto& res = pending.front()->response;
+         res.prepare_payload();
+         refresh_idle_timer();
+         beast::http::async_write( stream, res, beast::bind_front_handler( &beast_http_session::on_write, shared_from_this() ) );
+      }
+
+      void on_write( beast::error_code ec, std::size_t ) {
+         writing = false;
+         if( !open )
+            return;
+         const bool close = ec || pending.front()->response.need_eof();
+         pending.pop_front();
+         if( close || ( closing && pending.empty() ) )
+            return do_close();
+
+         write_next();
+         refresh_idle_timer();
+         // resume reading the pipelined requests once there is room again
+         if( !reading && !closing && pending.size() < max_queued )
+            do_read();
+      }
+
+      /**
+       * The connection is closed once nothing happens for idle_timeout: no request is read and no response is
+       * written.  Waiting for the handler of a pending request is not idle.  The timeout of the tcp_stream is not
+       * used, setting it for a write cancels the timeout of the read in progress.
+       */
+      void refresh_idle_timer() {
+         if( !open )
+            return;
+         if( !writing && !pending.empty() ) {
+            idle_timer.cancel();
+            return;
+         }
+         idle_timer.expires_after( idle_timeout );
+         idle_timer.async_wait( [self = shared_from_this()]( const beast::error_code& ec ) {
+            if( ec == boost::asio::error::operation_aborted || !self->open )
+               return;
+            self->do_close();
+            // cancels the read waiting for the next request
+            beast::error_code close_ec;
+            self->stream.socket().close( close_ec );
+         } );
+      }
+
+      void do_close() {
+         open = false;
+         pending.clear();
+         idle_timer.cancel();
+         beast::error_code ec;
+         stream.socket().shutdown( boost::asio::ip::tcp::socket::shutdown_send, ec );
+      }
+
+      beast::tcp_stream                                              stream;
+      boost::asio::steady_timer                                      idle_timer;
+      beast::flat_buffer                                             buffer;
+      boost::optional<beast::http::request_parser<beast::http::string_body>> parser;
+      handler_type                                                   handler;
+      const size_t                                                   max_body_size;
+      const size_t                                                   max_queued;
+      const std::chrono::milliseconds                                idle_timeout;
+      std::deque<std::shared_ptr<beast_http_connection>>             pending;    ///< requests in arrival order
+      bool                                                           reading = false;
+      bool                                                           writing = false;
+      bool                                                           closing = false;  ///< no more requests are read
+      bool                                                           open = true;
+   };
+
+   boost::asio::ip::tcp::socket& beast_http_connection::get_socket() {
+      return session->socket();
+   }
+
+   void beast_http_connection::send_http_response() {
+      if( sent.exchange( true ) )
+         return;
+      auto s = session;
+      boost::asio::post( s->stream.get_executor(), [s, self = shared_from_this()]() { s->on_response_ready( self ); } );
+   }
+
+   /**
+    * Accepts the connections of an endpoint, each served by a beast_http_session on its own strand of the executor
+    */
+   class beast_http_listener : public std::enable_shared_from_this<beast_http_listener> {
+   public:
+      using handler_type = beast_http_session::handler_type;
+
+      beast_http_listener( boost::asio::io_context& ioc, const boost::asio::ip::tcp::endpoint& endpoint, handler_type handler,
+                           size_t max_body_size, size_t max_queued, std::chrono::milliseconds idle_timeout )
+      : ioc( ioc )
+      , acceptor( boost::asio::make_strand( ioc ) )
+      , handler( std::move( handler ) )
+      , max_body_size( max_body_size )
+      , max_queued( max_queued )
+      , idle_timeout( idle_timeout )
+      {
+         acceptor.open( endpoint.protocol() );
+         acceptor.set_option( boost::asio::socket_base::reuse_address( true ) );
+         acceptor.bind( endpoint );
+         acceptor.listen( boost::asio::socket_base::max_listen_connections );
+      }
+
+      void start_accept() { do_accept(); }
+
+      bool is_listening() const { return acceptor.is_open(); }
+
+      boost::asio::ip::tcp::endpoint local_endpoint() const { return acceptor.local_endpoint(); }
+
+      void stop_listening() {
+         boost::asio::post( acceptor.get_executor(), [self = shared_from_this()]() {
+            beast::error_code ec;
+            self->acceptor.close( ec );
+         } );
+      }
+
+   private:
+      void do_accept() {
+         acceptor.async_accept( boost::asio::make_strand( ioc ),
+                                beast::bind_front_handler( &beast_http_listener::on_accept, shared_from_this() ) );
+      }
+
+      void on_accept( beast::error_code ec, boost::asio::ip::tcp::socket socket ) {
+         if( ec == boost::asio::error::operation_aborted || !acceptor.is_open() )
+            return;
+         if( !ec ) {
+            socket.set_option( boost::asio::ip::tcp::no_delay( true ), ec );
+            std::make_shared<beast_http_session>( std::move( socket ), handler, max_body_size, max_queued, idle_timeout )->run();
+         }
+         do_accept();
+      }
+
+      boost::asio::io_context&        ioc;
+      boost::asio::ip::tcp::acceptor  acceptor;
+      handler_type                    handler;
+      const size_t                    max_body_size;
+      const size_t                    max_queued;
+      const std::chrono::milliseconds idle_timeout;
+   };
+
+} } // namespace eosio::detail
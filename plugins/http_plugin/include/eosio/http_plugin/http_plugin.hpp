@@ -37,6 +37,106 @@ namespace eosio {
     */
    using api_description = std::map<string, url_handler>;
 
+   /**
+    * @brief A callback function provided to a binary URL handler to send a successful response
+    *
+    * The response body is sent as is with the content type application/octet-stream
+    *
+    * Arguments: response_code, response_body
+    */
+   using url_binary_response_callback = std::function<void(int,std::vector<char>)>;
+
+   /**
+    * @brief Callback type for the binary URL handler of a call
+    *
+    * A request selects the binary handler of a call with an "Accept: application/octet-stream" header,
+    * other requests are handled by the url_handler of the call.  The binary handler responds through
+    * the url_binary_response_callback, errors are still reported in JSON through the url_response_callback.
+    *
+    * Arguments: url, request_body, response_callback, binary_response_callback
+    **/
+   using url_binary_handler = std::function<void(string,string,url_response_callback,url_binary_response_callback)>;
+
+   using binary_api_description = std::map<string, url_binary_handler>;
+
+   /**
+    * @brief A callback function provided to a JSON URL handler to send a successful response
+    *
+    * The response body is JSON the handler has written itself, it is sent as is
+    *
+    * Arguments: response_code, response_json
+    */
+   using url_json_response_callback = std::function<void(int,std::string)>;
+
+   /**
+    * @brief Callback type for a URL handler that writes the JSON of its responses itself
+    *
+    * Used by calls whose responses are too large to build as an fc::variant first.  Errors are
+    * still reported through the url_response_callback.
+    *
+    * Arguments: url, request_body, response_callback, json_response_callback
+    **/
+   using url_json_handler = std::function<void(string,string,url_response_callback,url_json_response_callback)>;
+
+   /// where the next step of a resumable call runs, done once the step has called the url_response_callback
+   enum class resume_on { done, app_thread, http_thread };
+
+   /**
+    * @brief A step of a resumable call
+    *
+    * A step works until deadline and then returns where the call resumes, so that long calls yield to the other
+    * tasks of the main thread between their steps. When last is set the call has used its http-max-response-time-ms,
+    * the step must respond, e.g. with a partial result, a call which does not is answered with a timeout error.
+    *
+    * Arguments: deadline, last
+    **/
+   using url_step = std::function<resume_on(const fc::time_point&,bool)>;
+
+   /**
+    * @brief Callback type for the URL handler of a resumable call
+    *
+    * Called on the app thread, returns the first step of the call, which runs right away, or an empty step if it
+    * has already responded.
+    *
+    * Arguments: url, request_body, response_callback
+    **/
+   using url_resumable_handler = std::function<url_step(string,string,url_response_callback)>;
+
+   using json_api_description = std::map<string, url_json_handler>;
+
+   /**
+    * @brief How long the JSON response of a request may be served from the response cache
+    */
+   enum class http_cache_policy {
+      none,      ///< not cached
+      head,      ///< until the next http_plugin::invalidate_head_cache(), for responses that depend on the head block
+      immutable  ///< until evicted, for responses that cannot change such as those about irreversible blocks
+   };
+
+   /**
+    * @brief Decides the cache policy of a request of a call from its body
+    *
+    * Called on an http thread, must not throw.
+    *
+    * Arguments: request_body
+    **/
+   using cache_policy_function = std::function<http_cache_policy(const string&)>;
+
+   /**
+    * @brief Latency histogram of one stage of the requests of an endpoint
+    *
+    * The stages are `queue`, waiting for the app thread, `handler`, running the handler of the call up to its
+    * response callback, `serialize`, writing the JSON of the response, and `send`, from the response callback to the
+    * response being handed to the connection.  The last bucket counts the requests longer than the last bound.
+    */
+   struct http_stage_latency {
+      string           endpoint;
+      string           stage;
+      vector<uint64_t> bucket_bounds_us;
+      vector<uint64_t> counts;
+      uint64_t         total_us = 0;
+   };
+
    struct http_plugin_defaults {
       //If empty, unix socket support will be completely disabled. If not empty,
       // unix socket support is enabled with the given default path (treated relative
@@ -84,12 +184,59 @@ namespace eosio {
               add_handler(call.first, call.second, priority);
         }
 
+        /// add a handler which neither reads nor writes the chain state, it runs on the non-consensus executor when
+        /// nodeos has non-consensus-threads, on the main thread otherwise
+        void add_non_consensus_handler(const string& url, const url_handler&, int priority = appbase::priority::medium_low);
+        void add_non_consensus_api(const api_description& api, int priority = appbase::priority::medium_low) {
+           for (const auto& call : api)
+              add_non_consensus_handler(call.first, call.second, priority);
+        }
+
+        /// add a handler for a call which runs in steps of http-resumable-step-ms, see url_step
+        void add_resumable_handler(const string& url, const url_resumable_handler&, int priority = appbase::priority::medium_low);
+
         void add_async_handler(const string& url, const url_handler& handler);
         void add_async_api(const api_description& api) {
            for (const auto& call : api)
               add_handler(call.first, call.second);
         }
 
+        /// add a handler for a call that writes the JSON of its responses itself
+        void add_json_handler(const string& url, const url_json_handler&, int priority = appbase::priority::medium_low);
+        void add_json_api(const json_api_description& api, int priority = appbase::priority::medium_low) {
+           for (const auto& call : api)
+              add_json_handler(call.first, call.second, priority);
+        }
+
+        void add_async_json_handler(const string& url, const url_json_handler& handler);
+
+        /// add a handler for a call whose responses are not JSON, they are sent with content_type
+        void add_text_handler(const string& url, const string& content_type, const url_json_handler&,
+                              int priority = appbase::priority::medium_low);
+
+        /// add a binary handler for a call that has a handler added with add_handler/add_async_handler
+        void add_binary_handler(const string& url, const url_binary_handler&, int priority = appbase::priority::medium_low);
+        void add_binary_api(const binary_api_description& api, int priority = appbase::priority::medium_low) {
+           for (const auto& call : api)
+              add_binary_handler(call.first, call.second, priority);
+        }
+
+        void add_async_binary_handler(const string& url, const url_binary_handler& handler);
+
+        /// add a handler for the requests of a call whose body is the params in their binary format, selected by a
+        /// "Content-Type: application/octet-stream" header; other requests are handled by the handler of the call
+        void add_binary_request_handler(const string& url, const url_handler&, int priority = appbase::priority::medium_low);
+        void add_binary_request_api(const api_description& api, int priority = appbase::priority::medium_low) {
+           for (const auto& call : api)
+              add_binary_request_handler(call.first, call.second, priority);
+        }
+
+        /// cache the successful JSON responses of the call at url as decided by policy, see http-cache-size-mb
+        void add_cache_policy(const string& url, cache_policy_function policy);
+
+        /// drop the cached responses with the head policy, can be called from any thread
+        void invalidate_head_cache();
+
         // standard exception handling for api handlers
         static void handle_exception( const char *api_name, const char *call_name, const string& body, url_response_callback cb );
 
@@ -104,9 +251,18 @@ namespace eosio {
 
         get_supported_apis_result get_supported_apis()const;
 
+        /// @return the latency of each stage of the requests of each endpoint since startup, can be called from any thread
+        vector<http_stage_latency> get_endpoint_latency()const;
+
         /// @return the configured http-max-response-time-ms
         fc::microseconds get_max_response_time()const;
 
+        /// @return the configured http-threads
+        uint16_t get_thread_pool_size()const;
+
+        /// run f on one of the http threads, f is dropped before plugin_startup and after plugin_shutdown
+        void post_http_thread_pool(std::function<void()> f);
+
    private:
         std::shared_ptr<class http_plugin_impl> my;
    };
@@ -251,3 +407,4 @@ FC_REFLECT(eosio::error_results::error_info::error_detail, (message)(file)(line_
 FC_REFLECT(eosio::error_results::error_info, (code)(name)(what)(details))
 FC_REFLECT(eosio::error_results, (code)(message)(error))
 FC_REFLECT(eosio::http_plugin::get_supported_apis_result, (apis))
+FC_REFLECT(eosio::http_stage_latency, (endpoint)(stage)(bucket_bounds_us)(counts)(total_us))
@@ -0,0 +1,201 @@
+#define BOOST_TEST_MODULE beast_http_session
+#include <boost/test/included/unit_test.hpp>
+
+#include <eosio/http_plugin/beast_http_session.hpp>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/write.hpp>
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace eosio::detail;
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+   /**
+    * Serves 127.0.0.1 with a beast_http_listener on its own thread.  The response body is the request target, the
+    * requests of /slow are answered when release_slow is called.
+    */
+   struct server_fixture {
+      explicit server_fixture( size_t max_queued, std::chrono::milliseconds idle_timeout = std::chrono::seconds( 30 ),
+                               size_t max_body_size = 1024 )
+      : work( boost::asio::make_work_guard( ioc ) )
+      {
+         listener = std::make_shared<beast_http_listener>(
+               ioc, tcp::endpoint( boost::asio::ip::make_address( "127.0.0.1" ), 0 ),
+               [this]( std::shared_ptr<beast_http_connection> con ) {
+                  std::lock_guard g( mtx );
+                  ++handled;
+                  con->set_body( con->get_uri()->get_resource() );
+                  if( con->get_uri()->get_resource() == "/slow" ) {
+                     con->defer_http_response();
+                     slow.push_back( con );
+                  }
+               },
+               max_body_size, max_queued, idle_timeout );
+         listener->start_accept();
+         thread = std::thread( [this]() { ioc.run(); } );
+      }
+
+      ~server_fixture() {
+         listener->stop_listening();
+         work.reset();
+         ioc.stop();
+         thread.join();
+      }
+
+      void release_slow() {
+         std::lock_guard g( mtx );
+         for( auto& con : slow )
+            con->send_http_response();
+         slow.clear();
+      }
+
+      size_t handled_count() {
+         std::lock_guard g( mtx );
+         return handled;
+      }
+
+      tcp::socket connect() {
+         tcp::socket s( client_ioc );
+         s.connect( listener->local_endpoint() );
+         return s;
+      }
+
+      boost::asio::io_context                                              ioc;
+      boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work;
+      std::shared_ptr<beast_http_listener>                                listener;
+      std::thread                                                         thread;
+      std::mutex                                                          mtx;
+      size_t                                                              handled = 0;
+      std::vector<std::shared_ptr<beast_http_connection>>                 slow;
+      boost::asio::io_context                                             client_ioc;
+   };
+
+   std::string get_request( const std::string& target ) {
+      return "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+   }
+
+   http::response<http::string_body> read_response( tcp::socket& s, boost::beast::flat_buffer& buffer ) {
+      http::response<http::string_body> res;
+      http::read( s, buffer, res );
+      return res;
+   }
+
+   /// true if the server closed s
+   bool closed_by_server( tcp::socket& s, boost::beast::flat_buffer& buffer ) {
+      http::response<http::string_body> res;
+      boost::beast::error_code ec;
+      http::read( s, buffer, res, ec );
+      return ec == http::error::end_of_stream || ec == boost::asio::error::eof || ec == boost::asio::error::connection_reset;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(beast_http_session_tests)
+
+// the responses of pipelined requests are written in the order of the requests, even if a later one is answered first
+BOOST_AUTO_TEST_CASE(pipelined_responses_in_order) {
+   server_fixture server( 16 );
+   auto s = server.connect();
+   boost::asio::write( s, boost::asio::buffer( get_request( "/slow" ) + get_request( "/a" ) + get_request( "/b" ) ) );
+
+   // the later requests are handled while the first one is pending
+   for( int i = 0; i < 200 && server.handled_count() < 3; ++i )
+      std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+   BOOST_REQUIRE_EQUAL( server.handled_count(), 3u );
+   server.release_slow();
+
+   boost::beast::flat_buffer buffer;
+   for( const auto& target : { "/slow", "/a", "/b" } ) {
+      auto res = read_response( s, buffer );
+      BOOST_CHECK_EQUAL( res.result_int(), 200u );
+      BOOST_CHECK_EQUAL( res.body(), target );
+      BOOST_CHECK( res.keep_alive() );
+   }
+
+   // the connection is closed once the client is done
+   s.shutdown( tcp::socket::shutdown_send );
+   BOOST_CHECK( closed_by_server( s, buffer ) );
+}
+
+// no more than the pipeline limit of requests of a connection are handled at once
+BOOST_AUTO_TEST_CASE(pipeline_limit) {
+   server_fixture server( 2 );
+   auto s = server.connect();
+   boost::asio::write( s, boost::asio::buffer( get_request( "/slow" ) + get_request( "/a" ) + get_request( "/b" ) ) );
+
+   for( int i = 0; i < 200 && server.handled_count() < 2; ++i )
+      std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+   std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+   BOOST_CHECK_EQUAL( server.handled_count(), 2u );
+
+   server.release_slow();
+   boost::beast::flat_buffer buffer;
+   for( const auto& target : { "/slow", "/a", "/b" } )
+      BOOST_CHECK_EQUAL( read_response( s, buffer ).body(), target );
+   BOOST_CHECK_EQUAL( server.handled_count(), 3u );
+   s.shutdown( tcp::socket::shutdown_send );
+   BOOST_CHECK( closed_by_server( s, buffer ) );
+}
+
+// the connection is kept open between requests until it is idle for the timeout
+BOOST_AUTO_TEST_CASE(keep_alive_and_idle_timeout) {
+   server_fixture server( 16, std::chrono::milliseconds( 200 ) );
+   auto s = server.connect();
+   boost::beast::flat_buffer buffer;
+
+   boost::asio::write( s, boost::asio::buffer( get_request( "/a" ) ) );
+   BOOST_CHECK_EQUAL( read_response( s, buffer ).body(), "/a" );
+   std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+   boost::asio::write( s, boost::asio::buffer( get_request( "/b" ) ) );
+   BOOST_CHECK_EQUAL( read_response( s, buffer ).body(), "/b" );
+
+   const auto start = std::chrono::steady_clock::now();
+   BOOST_CHECK( closed_by_server( s, buffer ) );
+   BOOST_CHECK( std::chrono::steady_clock::now() - start >= std::chrono::milliseconds( 150 ) );
+}
+
+// a client asking to close gets its response, then the connection is closed
+BOOST_AUTO_TEST_CASE(connection_close) {
+   server_fixture server( 16 );
+   auto s = server.connect();
+   boost::asio::write( s, boost::asio::buffer( std::string( "GET /a HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n" ) ) );
+   boost::beast::flat_buffer buffer;
+   auto res = read_response( s, buffer );
+   BOOST_CHECK_EQUAL( res.body(), "/a" );
+   BOOST_CHECK( !res.keep_alive() );
+   BOOST_CHECK( closed_by_server( s, buffer ) );
+}
+
+// a body over the limit is answered with 413 after the pending responses, then the connection is closed
+BOOST_AUTO_TEST_CASE(body_too_large) {
+   server_fixture server( 16, std::chrono::seconds( 30 ), 16 );
+   auto s = server.connect();
+   const std::string body( 100, 'x' );
+   boost::asio::write( s, boost::asio::buffer( get_request( "/a" ) + "POST /b HTTP/1.1\r\nHost: localhost\r\nContent-Length: " +
+                                               std::to_string( body.size() ) + "\r\n\r\n" + body ) );
+   boost::beast::flat_buffer buffer;
+   BOOST_CHECK_EQUAL( read_response( s, buffer ).body(), "/a" );
+   auto res = read_response( s, buffer );
+   BOOST_CHECK_EQUAL( res.result_int(), 413u );
+   BOOST_CHECK( !res.keep_alive() );
+   BOOST_CHECK( closed_by_server( s, buffer ) );
+   BOOST_CHECK_EQUAL( server.handled_count(), 1u );
+}
+
+// a malformed request is answered with 400, then the connection is closed
+BOOST_AUTO_TEST_CASE(malformed_request) {
+   server_fixture server( 16 );
+   auto s = server.connect();
+   boost::asio::write( s, boost::asio::buffer( std::string( "NOT HTTP\r\n\r\n" ) ) );
+   boost::beast::flat_buffer buffer;
+   auto res = read_response( s, buffer );
+   BOOST_CHECK_EQUAL( res.result_int(), 400u );
+   BOOST_CHECK( closed_by_server( s, buffer ) );
+   BOOST_CHECK_EQUAL( server.handled_count(), 0u );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
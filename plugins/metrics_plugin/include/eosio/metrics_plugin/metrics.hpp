@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace eosio { namespace metrics {
+
+   using labels = std::vector<std::pair<std::string, std::string>>;
+
+   /**
+    * Writes metrics in the Prometheus text exposition format.
+    *
+    * The samples of one metric name, e.g. the same counter with different labels, must be written one after the other;
+    * the HELP and TYPE lines are written before the first of them.
+    */
+   class writer {
+    public:
+      /// @param scale multiplies value, e.g. 1e-3 to report milliseconds in seconds
+      void counter( const std::string& name, const std::string& help, uint64_t value, const labels& l = {}, double scale = 1 );
+      void gauge( const std::string& name, const std::string& help, double value, const labels& l = {} );
+
+      /// @param bounds inclusive upper bound of each bucket but the last, which is unbounded
+      /// @param counts number of observations in each bucket, one more than bounds
+      /// @param scale multiplies bounds and sum, e.g. 1e-6 to report microseconds in seconds
+      void histogram( const std::string& name, const std::string& help, const std::vector<uint64_t>& bounds,
+                      const std::vector<uint64_t>& counts, uint64_t sum, const labels& l = {}, double scale = 1 );
+
+      const std::string& str() const { return out; }
+
+    private:
+      void describe( const std::string& name, const std::string& help, const char* type );
+      void sample( const std::string& name, const labels& l, const std::string& value,
+                   const std::pair<std::string, std::string>* extra_label = nullptr );
+
+      std::string           out;
+      std::set<std::string> described;
+   };
+
+   /**
+    * A counter incremented from any thread without contention: every thread adds to one of a few cache line sized
+    * shards, which are only summed when the counter is read.
+    */
+   class counter {
+    public:
+      void add( uint64_t n = 1 ) { shards[shard_index()].value.fetch_add( n, std::memory_order_relaxed ); }
+
+      uint64_t value() const {
+         uint64_t result = 0;
+         for( const auto& s : shards )
+            result += s.value.load( std::memory_order_relaxed );
+         return result;
+      }
+
+    private:
+      static constexpr size_t num_shards = 16;
+      struct alignas(64) shard {
+         std::atomic<uint64_t> value{0};
+      };
+
+      static size_t shard_index();
+
+      std::array<shard, num_shards> shards;
+   };
+
+} } // eosio::metrics
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <eosio/metrics_plugin/metrics.hpp>
+#include <eosio/http_plugin/http_plugin.hpp>
+#include <eosio/chain_plugin/chain_plugin.hpp>
+
+#include <appbase/application.hpp>
+
+#include <functional>
+
+namespace eosio {
+
+using namespace appbase;
+
+/**
+ * Serves the metrics of nodeos in the Prometheus text format on /v1/metrics/prometheus.
+ *
+ * Other plugins add a collector which writes their metrics; collectors are called on the main thread for every request,
+ * so they may read the chain state, and should only read values kept up to date elsewhere, e.g. metrics::counter.
+ */
+class metrics_plugin : public plugin<metrics_plugin> {
+public:
+   APPBASE_PLUGIN_REQUIRES((http_plugin)(chain_plugin))
+
+   using collector = std::function<void(metrics::writer&)>;
+
+   metrics_plugin();
+   metrics_plugin(const metrics_plugin&) = delete;
+   metrics_plugin(metrics_plugin&&) = delete;
+   metrics_plugin& operator=(const metrics_plugin&) = delete;
+   metrics_plugin& operator=(metrics_plugin&&) = delete;
+   virtual ~metrics_plugin() override;
+
+   virtual void set_program_options(options_description& cli, options_description& cfg) override {}
+   void plugin_initialize(const variables_map& vm);
+   void plugin_startup();
+   void plugin_shutdown() {}
+
+   /// add a collector, before plugin_startup of metrics_plugin or on the main thread
+   void add_collector( collector c );
+
+   /// @return the metrics of all collectors
+   std::string collect() const;
+
+private:
+   std::vector<collector> collectors;
+};
+
+}
@@ -0,0 +1,93 @@
+#include <eosio/metrics_plugin/metrics.hpp>
+
+#include <cmath>
+#include <functional>
+#include <sstream>
+#include <thread>
+
+namespace eosio { namespace metrics {
+
+   namespace {
+      std::string format_value( double v ) {
+         if( std::isinf( v ) )
+            return v > 0 ? "+Inf" : "-Inf";
+         std::ostringstream ss;
+         ss.precision( 15 );
+         ss << v;
+         return ss.str();
+      }
+
+      void append_escaped( std::string& out, const std::string& s ) {
+         for( char c : s ) {
+            if( c == '\\' || c == '"' ) {
+               out += '\\';
+               out += c;
+            } else if( c == '\n' ) {
+               out += "\\n";
+            } else {
+               out += c;
+            }
+         }
+      }
+   }
+
+   void writer::describe( const std::string& name, const std::string& help, const char* type ) {
+      if( !described.insert( name ).second )
+         return;
+      out += "# HELP " + name + ' ' + help + '\n';
+      out += "# TYPE " + name + ' ' + type + '\n';
+   }
+
+   void writer::sample( const std::string& name, const labels& l, const std::string& value,
+                        const std::pair<std::string, std::string>* extra_label ) {
+      out += name;
+      if( !l.empty() || extra_label ) {
+         out += '{';
+         bool first = true;
+         auto add_label = [&]( const std::pair<std::string, std::string>& label ) {
+            if( !first )
+               out += ',';
+            first = false;
+            out += label.first + "=\"";
+            append_escaped( out, label.second );
+            out += '"';
+         };
+         for( const auto& label : l )
+            add_label( label );
+         if( extra_label )
+            add_label( *extra_label );
+         out += '}';
+      }
+      out += ' ' + value + '\n';
+   }
+
+   void writer::counter( const std::string& name, const std::string& help, uint64_t value, const labels& l, double scale ) {
+      describe( name, help, "counter" );
+      sample( name, l, scale == 1 ? std::to_string( value ) : format_value( value * scale ) );
+   }
+
+   void writer::gauge( const std::string& name, const std::string& help, double value, const labels& l ) {
+      describe( name, help, "gauge" );
+      sample( name, l, format_value( value ) );
+   }
+
+   void writer::histogram( const std::string& name, const std::string& help, const std::vector<uint64_t>& bounds,
+                           const std::vector<uint64_t>& counts, uint64_t sum, const labels& l, double scale ) {
+      describe( name, help, "histogram" );
+      // prometheus buckets are cumulative
+      uint64_t total = 0;
+      for( size_t i = 0; i < counts.size(); ++i ) {
+         total += counts[i];
+         const std::pair<std::string, std::string> le{ "le", i < bounds.size() ? format_value( bounds[i] * scale ) : "+Inf" };
+         sample( name + "_bucket", l, std::to_string( total ), &le );
+      }
+      sample( name + "_sum", l, format_value( sum * scale ) );
+      sample( name + "_count", l, std::to_string( total ) );
+   }
+
+   size_t counter::shard_index() {
+      static thread_local const size_t index = std::hash<std::thread::id>{}( std::this_thread::get_id() ) % num_shards;
+      return index;
+   }
+
+} } // eosio::metrics
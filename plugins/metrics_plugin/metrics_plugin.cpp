@@ -0,0 +1,166 @@
+#include <eosio/metrics_plugin/metrics_plugin.hpp>
+#include <eosio/net_plugin/net_plugin.hpp>
+#include <eosio/producer_plugin/producer_plugin.hpp>
+#include <eosio/resource_monitor_plugin/resource_monitor_plugin.hpp>
+#include <eosio/chain/signature_cache.hpp>
+#include <eosio/chain/signal_slots.hpp>
+#include <eosio/chain/startup_metrics.hpp>
+
+namespace eosio {
+
+static appbase::abstract_plugin& _metrics_plugin = app().register_plugin<metrics_plugin>();
+
+namespace {
+   void collect_chain( const chain::controller& chain, metrics::writer& w ) {
+      w.gauge( "nodeos_head_block_num", "Number of the head block", chain.head_block_num() );
+      w.gauge( "nodeos_fork_db_head_block_num", "Number of the head block of the fork database", chain.fork_db_pending_head_block_num() );
+      w.gauge( "nodeos_last_irreversible_block_num", "Number of the last irreversible block", chain.last_irreversible_block_num() );
+
+      const auto* segment = chain.db().get_segment_manager();
+      w.gauge( "nodeos_chain_db_size_bytes", "Size of the chain state database", segment->get_size() );
+      w.gauge( "nodeos_chain_db_free_bytes", "Free bytes of the chain state database", segment->get_free_memory() );
+
+      w.gauge( "nodeos_abi_cache_entries", "Parsed ABIs in the cache of the controller", chain.get_abi_serializer_cache().size() );
+      w.gauge( "nodeos_signature_cache_entries", "Recovered signatures in the process wide cache", chain::signature_cache::shared().size() );
+
+      for( const auto& s : chain.get_block_apply_metrics().snapshot() ) {
+         w.histogram( "nodeos_block_stage_seconds", "Time spent in each stage of pushing, applying and committing blocks",
+                      s.bucket_bounds_us, s.counts, s.total_us, { { "stage", s.stage } }, 1e-6 );
+      }
+
+      for( const auto& p : chain::startup_metrics::shared().snapshot() )
+         w.gauge( "nodeos_startup_phase_seconds", "Time spent in each phase of starting the node", p.us * 1e-6, { { "phase", p.phase } } );
+
+      const auto slots = chain::signal_slot_metrics::shared().snapshot();
+      for( const auto& s : slots )
+         w.counter( "nodeos_signal_slot_calls_total", "Calls of the handlers of plugins to the signals of the controller", s.calls, { { "slot", s.slot } } );
+      for( const auto& s : slots )
+         w.counter( "nodeos_signal_slot_seconds_total", "Time spent in the handlers of plugins to the signals of the controller", s.total_us, { { "slot", s.slot } }, 1e-6 );
+      for( const auto& s : slots )
+         w.gauge( "nodeos_signal_slot_max_seconds", "Longest call of the handlers of plugins to the signals of the controller", s.max_us * 1e-6, { { "slot", s.slot } } );
+   }
+
+   void collect_memory( const std::vector<chain::subsystem_memory>& usage, metrics::writer& w ) {
+      for( const auto& m : usage )
+         w.gauge( "nodeos_memory_bytes", "Memory held by each subsystem outside of the chain state database, 0 where only entries are known", m.bytes, { { "subsystem", m.subsystem } } );
+      for( const auto& m : usage )
+         w.gauge( "nodeos_memory_entries", "Entries held by each subsystem outside of the chain state database", m.entries, { { "subsystem", m.subsystem } } );
+   }
+
+   void collect_net( const net_plugin& net, metrics::writer& w ) {
+      const auto m = net.metrics();
+      for( const auto& c : m.messages )
+         w.counter( "nodeos_net_messages_received_total", "Messages received from peers", c.messages_received, { { "type", c.type } } );
+      for( const auto& c : m.messages )
+         w.counter( "nodeos_net_received_bytes_total", "Bytes of messages received from peers", c.bytes_received, { { "type", c.type } } );
+      for( const auto& c : m.messages )
+         w.counter( "nodeos_net_messages_sent_total", "Messages sent to peers", c.messages_sent, { { "type", c.type } } );
+      for( const auto& c : m.messages )
+         w.counter( "nodeos_net_sent_bytes_total", "Bytes of messages sent to peers", c.bytes_sent, { { "type", c.type } } );
+      for( const auto& c : m.messages )
+         w.counter( "nodeos_net_messages_dropped_total", "Messages received from peers over their rate limits and dropped", c.messages_dropped, { { "type", c.type } } );
+      w.gauge( "nodeos_net_connections", "Connections to peers", m.connections.size() );
+      w.histogram( "nodeos_net_block_decode_seconds", "Time spent deserializing received blocks",
+                   m.block_decode_latency.bucket_bounds_us, m.block_decode_latency.counts, m.block_decode_latency.total_us, {}, 1e-6 );
+      w.histogram( "nodeos_net_block_apply_seconds", "Time spent validating and applying received blocks",
+                   m.block_apply_latency.bucket_bounds_us, m.block_apply_latency.counts, m.block_apply_latency.total_us, {}, 1e-6 );
+   }
+
+   void collect_disks( const std::vector<resource_monitor::filesystem_metrics>& disks, metrics::writer& w ) {
+      for( const auto& d : disks )
+         w.gauge( "nodeos_disk_capacity_bytes", "Capacity of the file systems of the monitored directories", d.capacity, { { "path", d.path_name } } );
+      for( const auto& d : disks )
+         w.gauge( "nodeos_disk_available_bytes", "Available bytes of the file systems of the monitored directories at their last check", d.available, { { "path", d.path_name } } );
+
+      std::vector<std::pair<const std::string*, resource_monitor::io_stats>> io;
+      for( const auto& d : disks ) {
+         if( d.io )
+            io.emplace_back( &d.path_name, *d.io );
+      }
+      for( const auto& [path, s] : io )
+         w.counter( "nodeos_disk_reads_total", "Reads completed by the devices of the monitored directories", s.reads, { { "path", *path } } );
+      for( const auto& [path, s] : io )
+         w.counter( "nodeos_disk_read_bytes_total", "Bytes read by the devices of the monitored directories", s.read_bytes, { { "path", *path } } );
+      for( const auto& [path, s] : io )
+         w.counter( "nodeos_disk_read_seconds_total", "Time spent on the reads of the devices of the monitored directories", s.read_time_ms, { { "path", *path } }, 1e-3 );
+      for( const auto& [path, s] : io )
+         w.counter( "nodeos_disk_writes_total", "Writes completed by the devices of the monitored directories", s.writes, { { "path", *path } } );
+      for( const auto& [path, s] : io )
+         w.counter( "nodeos_disk_written_bytes_total", "Bytes written by the devices of the monitored directories", s.write_bytes, { { "path", *path } } );
+      for( const auto& [path, s] : io )
+         w.counter( "nodeos_disk_write_seconds_total", "Time spent on the writes of the devices of the monitored directories", s.write_time_ms, { { "path", *path } }, 1e-3 );
+      for( const auto& [path, s] : io )
+         w.counter( "nodeos_disk_io_seconds_total", "Time the devices of the monitored directories had I/O in flight", s.io_time_ms, { { "path", *path } }, 1e-3 );
+   }
+
+   void collect_http( const http_plugin& http, metrics::writer& w ) {
+      for( const auto& l : http.get_endpoint_latency() ) {
+         w.histogram( "nodeos_http_request_stage_seconds", "Time spent in each stage of handling the requests of each http endpoint",
+                      l.bucket_bounds_us, l.counts, l.total_us, { { "endpoint", l.endpoint }, { "stage", l.stage } }, 1e-6 );
+      }
+   }
+}
+
+metrics_plugin::metrics_plugin() = default;
+metrics_plugin::~metrics_plugin() = default;
+
+void metrics_plugin::plugin_initialize(const variables_map& vm) {
+   add_collector( []( metrics::writer& w ) {
+      collect_chain( app().get_plugin<chain_plugin>().chain(), w );
+   } );
+   add_collector( []( metrics::writer& w ) {
+      const auto* net = app().find_plugin<net_plugin>();
+      if( net && net->get_state() == abstract_plugin::started )
+         collect_net( *net, w );
+   } );
+   add_collector( []( metrics::writer& w ) {
+      const auto* resmon = app().find_plugin<resource_monitor_plugin>();
+      if( resmon && resmon->get_state() == abstract_plugin::started )
+         collect_disks( resmon->get_filesystem_metrics(), w );
+   } );
+   add_collector( []( metrics::writer& w ) {
+      collect_http( app().get_plugin<http_plugin>(), w );
+   } );
+   add_collector( []( metrics::writer& w ) {
+      auto usage = app().get_plugin<chain_plugin>().chain().get_memory_usage();
+      const auto* producer = app().find_plugin<producer_plugin>();
+      if( producer && producer->get_state() == abstract_plugin::started ) {
+         auto p = producer->get_memory_usage();
+         usage.insert( usage.end(), p.begin(), p.end() );
+      }
+      const auto* net = app().find_plugin<net_plugin>();
+      if( net && net->get_state() == abstract_plugin::started ) {
+         chain::subsystem_memory queues{ "net_plugin.write_queues" };
+         for( const auto& c : net->metrics().connections ) {
+            queues.bytes += c.write_queue_bytes;
+            ++queues.entries;
+         }
+         usage.push_back( std::move( queues ) );
+      }
+      collect_memory( usage, w );
+   } );
+}
+
+void metrics_plugin::plugin_startup() {
+   app().get_plugin<http_plugin>().add_text_handler( "/v1/metrics/prometheus", "text/plain; version=0.0.4; charset=utf-8",
+         [this]( string, string body, url_response_callback cb, url_json_response_callback text_cb ) {
+            try {
+               text_cb( 200, collect() );
+            } catch( ... ) {
+               http_plugin::handle_exception( "metrics", "prometheus", body, cb );
+            }
+         } );
+}
+
+void metrics_plugin::add_collector( collector c ) {
+   collectors.emplace_back( std::move( c ) );
+}
+
+std::string metrics_plugin::collect() const {
+   metrics::writer w;
+   for( const auto& c : collectors )
+      c( w );
+   return w.str();
+}
+
+}
@@ -0,0 +1,67 @@
+#define BOOST_TEST_MODULE metrics
+#include <boost/test/included/unit_test.hpp>
+
+#include <eosio/metrics_plugin/metrics.hpp>
+
+#include <thread>
+
+using namespace eosio;
+
+BOOST_AUTO_TEST_SUITE(metrics_tests)
+
+BOOST_AUTO_TEST_CASE(counter_and_gauge) {
+   metrics::writer w;
+   w.counter( "requests_total", "Requests", 3, { { "type", "a" } } );
+   w.counter( "requests_total", "Requests", 4, { { "type", "b\"c" } } );
+   w.gauge( "size", "Size", 1.5 );
+
+   BOOST_CHECK_EQUAL( w.str(),
+                      "# HELP requests_total Requests\n"
+                      "# TYPE requests_total counter\n"
+                      "requests_total{type=\"a\"} 3\n"
+                      "requests_total{type=\"b\\\"c\"} 4\n"
+                      "# HELP size Size\n"
+                      "# TYPE size gauge\n"
+                      "size 1.5\n" );
+}
+
+BOOST_AUTO_TEST_CASE(scaled_counter) {
+   metrics::writer w;
+   w.counter( "io_seconds_total", "I/O time", 1500, {}, 1e-3 );
+
+   BOOST_CHECK_EQUAL( w.str(),
+                      "# HELP io_seconds_total I/O time\n"
+                      "# TYPE io_seconds_total counter\n"
+                      "io_seconds_total 1.5\n" );
+}
+
+BOOST_AUTO_TEST_CASE(histogram_buckets_are_cumulative) {
+   metrics::writer w;
+   w.histogram( "latency_seconds", "Latency", { 100, 1000 }, { 1, 2, 3 }, 5000, { { "stage", "x" } }, 1e-6 );
+
+   BOOST_CHECK_EQUAL( w.str(),
+                      "# HELP latency_seconds Latency\n"
+                      "# TYPE latency_seconds histogram\n"
+                      "latency_seconds_bucket{stage=\"x\",le=\"0.0001\"} 1\n"
+                      "latency_seconds_bucket{stage=\"x\",le=\"0.001\"} 3\n"
+                      "latency_seconds_bucket{stage=\"x\",le=\"+Inf\"} 6\n"
+                      "latency_seconds_sum{stage=\"x\"} 0.005\n"
+                      "latency_seconds_count{stage=\"x\"} 6\n" );
+}
+
+BOOST_AUTO_TEST_CASE(sharded_counter) {
+   metrics::counter c;
+   std::vector<std::thread> threads;
+   for( int t = 0; t < 4; ++t ) {
+      threads.emplace_back( [&c]() {
+         for( int i = 0; i < 1000; ++i )
+            c.add();
+      } );
+   }
+   for( auto& t : threads )
+      t.join();
+   c.add( 10 );
+   BOOST_CHECK_EQUAL( c.value(), 4010u );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -62,12 +62,17 @@ void net_api_plugin::plugin_startup() {
             INVOKE_R_R(net_mgr, connect, std::string), 201),
        CALL_WITH_400(net, net_mgr, disconnect,
             INVOKE_R_R(net_mgr, disconnect, std::string), 201),
+    //   CALL(net, net_mgr, open,
+    //        INVOKE_V_R(net_mgr, open, std::string), 200),
+   }, appbase::priority::medium_high);
+   // the state of the connections is read under the locks of net_plugin, not from the main thread
+   app().get_plugin<http_plugin>().add_non_consensus_api({
        CALL_WITH_400(net, net_mgr, status,
             INVOKE_R_R(net_mgr, status, std::string), 201),
        CALL_WITH_400(net, net_mgr, connections,
             INVOKE_R_V(net_mgr, connections), 201),
-    //   CALL(net, net_mgr, open,
-    //        INVOKE_V_R(net_mgr, open, std::string), 200),
+       CALL_WITH_400(net, net_mgr, metrics,
+            INVOKE_R_V(net_mgr, metrics), 201),
    }, appbase::priority::medium_high);
 }
 
@@ -13,6 +13,36 @@ namespace eosio {
       handshake_message last_handshake;
    };
 
+   struct net_message_counters {
+      string     type;
+      uint64_t   messages_received = 0;
+      uint64_t   bytes_received = 0;
+      uint64_t   messages_sent = 0;
+      uint64_t   bytes_sent = 0;
+      uint64_t   messages_dropped = 0;   ///< received over the rate limits, not deserialized
+   };
+
+   struct latency_histogram {
+      vector<uint64_t>  bucket_bounds_us; ///< inclusive upper bound of each bucket except the last which is unbounded
+      vector<uint64_t>  counts;           ///< one more than bucket_bounds_us
+      uint64_t          total_us = 0;
+   };
+
+   struct connection_metrics {
+      string                         peer;
+      uint32_t                       write_queue_bytes = 0;
+      vector<net_message_counters>   messages;
+      latency_histogram              block_decode_latency;  ///< deserialization of received blocks
+      latency_histogram              block_apply_latency;   ///< validation and application of received blocks
+   };
+
+   struct net_metrics {
+      vector<net_message_counters>   messages;              ///< since startup, including closed connections
+      latency_histogram              block_decode_latency;
+      latency_histogram              block_apply_latency;
+      vector<connection_metrics>     connections;
+   };
+
    class net_plugin : public appbase::plugin<net_plugin>
    {
       public:
@@ -31,6 +61,7 @@ namespace eosio {
         string                            disconnect( const string& endpoint );
         std::optional<connection_status>  status( const string& endpoint )const;
         vector<connection_status>         connections()const;
+        net_metrics                       metrics()const;
 
       private:
         std::shared_ptr<class net_plugin_impl> my;
@@ -39,3 +70,7 @@ namespace eosio {
 }
 
 FC_REFLECT( eosio::connection_status, (peer)(connecting)(syncing)(last_handshake) )
+FC_REFLECT( eosio::net_message_counters, (type)(messages_received)(bytes_received)(messages_sent)(bytes_sent)(messages_dropped) )
+FC_REFLECT( eosio::latency_histogram, (bucket_bounds_us)(counts)(total_us) )
+FC_REFLECT( eosio::connection_metrics, (peer)(write_queue_bytes)(messages)(block_decode_latency)(block_apply_latency) )
+FC_REFLECT( eosio::net_metrics, (messages)(block_decode_latency)(block_apply_latency)(connections) )
@@ -140,6 +140,18 @@ namespace eosio {
       std::shared_ptr<packed_transaction> trx;
    };
 
+   /// block sent with the packed_transaction of each receipt listed in omitted replaced by its transaction id,
+   /// the receiver restores them from transactions it already has
+   struct compact_block_message {
+      std::shared_ptr<signed_block> block;
+      vector<uint32_t>              omitted; ///< ascending indices into block->transactions
+   };
+
+   /// block message compressed with zlib
+   struct compressed_block_message {
+      bytes data; ///< compressed serialization of a signed_block or signed_block_v0 net_message, including its which
+   };
+
    using net_message = std::variant<handshake_message,
                                     chain_size_message,
                                     go_away_message,
@@ -150,7 +162,9 @@ namespace eosio {
                                     signed_block_v0,         // which = 7
                                     packed_transaction_v0,   // which = 8
                                     signed_block,            // which = 9
-                                    trx_message_v1>;         // which = 10
+                                    trx_message_v1,          // which = 10
+                                    compact_block_message,   // which = 11
+                                    compressed_block_message>; // which = 12
 
 } // namespace eosio
 
@@ -170,6 +184,8 @@ FC_REFLECT( eosio::notice_message, (known_trx)(known_blocks) )
 FC_REFLECT( eosio::request_message, (req_trx)(req_blocks) )
 FC_REFLECT( eosio::sync_request_message, (start_block)(end_block) )
 FC_REFLECT( eosio::trx_message_v1, (trx_id)(trx) )
+FC_REFLECT( eosio::compact_block_message, (block)(omitted) )
+FC_REFLECT( eosio::compressed_block_message, (data) )
 
 
 /**
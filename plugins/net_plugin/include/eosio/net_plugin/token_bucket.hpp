@@ -0,0 +1,60 @@
+#pragma once
+#include <fc/time.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+
+namespace eosio {
+
+   /// limits the rate of the messages of one type received from a peer, not thread safe
+   class token_bucket {
+   public:
+      /// @param rate_per_sec - 0 for unlimited
+      /// @param burst - messages accepted at once after an idle period, at least 1
+      void configure( uint32_t rate_per_sec, uint32_t burst, fc::time_point now = fc::time_point::now() ) {
+         rate = rate_per_sec;
+         capacity = std::max<double>( burst, 1 );
+         tokens = capacity;
+         last = now;
+      }
+
+      bool unlimited() const { return rate == 0; }
+
+      /// @return true and take cost tokens if available, false otherwise
+      bool consume( fc::time_point now, double cost = 1 ) {
+         if( unlimited() )
+            return true;
+         tokens = std::min( capacity, tokens + (now - last).count() * rate / 1'000'000 );
+         last = now;
+         cost = std::min( cost, capacity );
+         if( tokens < cost )
+            return false;
+         tokens -= cost;
+         return true;
+      }
+
+   private:
+      double          rate = 0;    ///< tokens per second
+      double          capacity = 1;
+      double          tokens = 1;
+      fc::time_point  last;
+   };
+
+   /**
+    * The tokens a transaction from a peer takes when queued transactions from peers wait for the main thread: 1 up to
+    * half of queue_depth, then proportionally more so that the rate allowed to each peer decreases as the main thread
+    * falls behind.
+    * @param queue_depth - 0 for unlimited
+    * @return nullopt if the transaction is dropped, queued reached queue_depth
+    */
+   inline std::optional<double> trx_admission_cost( uint32_t queued, uint32_t queue_depth ) {
+      if( queue_depth == 0 )
+         return 1.0;
+      if( queued >= queue_depth )
+         return {};
+      const double half = queue_depth / 2.0;
+      return queued > half ? queued / half : 1.0;
+   }
+
+}
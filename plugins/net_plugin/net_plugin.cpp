@@ -2,9 +2,11 @@
 
 #include <eosio/net_plugin/net_plugin.hpp>
 #include <eosio/net_plugin/protocol.hpp>
+#include <eosio/net_plugin/token_bucket.hpp>
 #include <eosio/chain/controller.hpp>
 #include <eosio/chain/exceptions.hpp>
 #include <eosio/chain/block.hpp>
+#include <eosio/chain/merkle.hpp>
 #include <eosio/chain/plugin_interface.hpp>
 #include <eosio/chain/thread_utils.hpp>
 #include <eosio/producer_plugin/producer_plugin.hpp>
@@ -24,7 +26,11 @@
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ip/host_name.hpp>
 #include <boost/asio/steady_timer.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
 
+#include <array>
 #include <atomic>
 #include <shared_mutex>
 
@@ -91,6 +97,21 @@ namespace eosio {
       >
    node_transaction_index;
 
+   /// transaction announced to or requested from peers with a transaction inventory capable protocol
+   struct gossip_trx_state {
+      transaction_id_type     id;
+      time_point_sec          expires;  /// time after which this may be purged.
+      packed_transaction_ptr  trx;      /// set when relayed so the trx can be served to peers and restore compact blocks
+   };
+
+   typedef multi_index_container<
+      gossip_trx_state,
+      indexed_by<
+         ordered_unique< tag<by_id>, member<gossip_trx_state, transaction_id_type, &gossip_trx_state::id>, sha256_less >,
+         ordered_non_unique< tag<by_expiry>, member<gossip_trx_state, fc::time_point_sec, &gossip_trx_state::expires> >
+      >
+   > gossip_trx_index;
+
    struct peer_block_state {
       block_id_type id;
       uint32_t      block_num = 0;
@@ -172,6 +193,9 @@ namespace eosio {
       peer_block_state_index  blk_state;
       mutable std::mutex      local_txns_mtx;
       node_transaction_index  local_txns;
+      mutable std::mutex      gossip_txns_mtx;
+      gossip_trx_index        announced_txns; // trxs accepted and relayed by this node
+      gossip_trx_index        requested_txns;
 
    public:
       boost::asio::io_context::strand  strand;
@@ -201,6 +225,80 @@ namespace eosio {
       bool peer_has_txn( const transaction_id_type& tid, uint32_t connection_id ) const;
       bool have_txn( const transaction_id_type& tid ) const;
       void expire_txns( uint32_t lib_num );
+
+      void add_announced_txn( const packed_transaction_ptr& trx );
+      packed_transaction_ptr get_announced_txn( const transaction_id_type& tid ) const;
+      bool add_requested_txn( const transaction_id_type& tid );
+   };
+
+   /// serialization of a block message sent to a peer
+   enum class block_wire_format : uint8_t {
+      v0,         ///< signed_block_v0 for peers before proto_pruned_types
+      current,    ///< signed_block
+      compressed  ///< compressed_block_message of a signed_block
+   };
+
+   /// serialized irreversible blocks recently sent to syncing peers, shared by all connections so a block served
+   /// to several peers is read from the block log and packed only once per wire format
+   class sync_buffer_cache {
+   public:
+      using buffer_ptr = std::shared_ptr<std::vector<char>>;
+
+      buffer_ptr get( uint32_t block_num, block_wire_format format ) const;
+      void add( uint32_t block_num, block_wire_format format, const buffer_ptr& buffer );
+
+   private:
+      using key_type = std::pair<uint32_t, block_wire_format>;
+      static constexpr size_t max_cached_bytes = 64*1024*1024;
+
+      mutable std::mutex                   buffers_mtx;
+      std::map<key_type, buffer_ptr>       buffers;
+      deque<key_type>                      insertion_order; // oldest first, evicted first
+      size_t                                            cached_bytes = 0;
+   };
+
+   /// per message type counters and block latency histograms reported by net_plugin::metrics()
+   /// thread safe
+   class net_metrics_tracker {
+   public:
+      static constexpr size_t num_message_types = std::variant_size_v<net_message>;
+
+      void message_received( uint32_t which, size_t bytes ) { if( which < num_message_types ) received[which].add( bytes ); }
+      void message_sent( uint32_t which, size_t bytes )     { if( which < num_message_types ) sent[which].add( bytes ); }
+      void message_dropped( uint32_t which ) { if( which < num_message_types ) dropped[which].fetch_add( 1, std::memory_order_relaxed ); }
+      void block_decoded( fc::microseconds d ) { decode.record( d ); }
+      void block_applied( fc::microseconds d ) { apply.record( d ); }
+
+      vector<net_message_counters> message_counters() const;
+      latency_histogram decode_latency() const { return decode.snapshot(); }
+      latency_histogram apply_latency() const  { return apply.snapshot(); }
+
+   private:
+      struct counter {
+         std::atomic<uint64_t> messages{0};
+         std::atomic<uint64_t> bytes{0};
+         void add( size_t b ) {
+            messages.fetch_add( 1, std::memory_order_relaxed );
+            bytes.fetch_add( b, std::memory_order_relaxed );
+         }
+      };
+
+      class histogram {
+      public:
+         void record( fc::microseconds d );
+         latency_histogram snapshot() const;
+      private:
+         static constexpr std::array<uint64_t, 12> bounds_us = { 100, 250, 500, 1'000, 2'500, 5'000, 10'000,
+                                                                 25'000, 50'000, 100'000, 250'000, 1'000'000 };
+         std::array<std::atomic<uint64_t>, bounds_us.size() + 1> counts{};
+         std::atomic<uint64_t>                                   total_us{0};
+      };
+
+      std::array<counter, num_message_types> received;
+      std::array<counter, num_message_types> sent;
+      std::array<std::atomic<uint64_t>, num_message_types> dropped{};
+      histogram                              decode;
+      histogram                              apply;
    };
 
    class net_plugin_impl : public std::enable_shared_from_this<net_plugin_impl> {
@@ -241,6 +339,12 @@ namespace eosio {
       uint32_t                              max_nodes_per_host = 1;
       bool                                  p2p_accept_transactions = true;
       bool                                  p2p_reject_incomplete_blocks = true;
+      uint32_t                              max_trx_per_sec_per_peer = def_max_trx_per_sec_per_peer;
+      uint32_t                              max_trx_burst_per_peer = 0;
+      uint32_t                              max_blocks_per_sec_per_peer = def_max_blocks_per_sec_per_peer;
+      uint32_t                              max_blocks_burst_per_peer = 0;
+      uint32_t                              trx_admission_queue_depth = def_trx_admission_queue_depth;
+      std::atomic<uint32_t>                 trxs_in_progress{0}; ///< received from peers and posted to the main thread
 
       /// Peer clock may be no more than 1 second skewed from our clock, including network latency.
       const std::chrono::system_clock::duration peer_authentication_interval{std::chrono::seconds{1}};
@@ -252,10 +356,14 @@ namespace eosio {
       chain_plugin*                         chain_plug = nullptr;
       producer_plugin*                      producer_plug = nullptr;
       bool                                  use_socket_read_watermark = false;
+      bool                                  p2p_compress_blocks = false;
       /** @} */
 
       mutable std::shared_mutex             connections_mtx;
       std::set< connection_ptr >            connections;     // todo: switch to a thread safe container to avoid big mutex over complete collection
+      /// immutable copy of connections for the broadcast paths, replaced whenever connections changes,
+      /// only access through std::atomic_load/std::atomic_store
+      std::shared_ptr<const vector<connection_ptr>> connections_snapshot = std::make_shared<const vector<connection_ptr>>();
 
       std::mutex                            connector_check_timer_mtx;
       unique_ptr<boost::asio::steady_timer> connector_check_timer;
@@ -272,7 +380,18 @@ namespace eosio {
       compat::channels::transaction_ack::channel_type::handle  incoming_transaction_ack_subscription;
 
       uint16_t                                       thread_pool_size = 2;
+      std::vector<uint16_t>                          thread_pool_cpus;
       std::optional<eosio::chain::named_thread_pool> thread_pool;
+      uint16_t                                       decode_thread_pool_size = 2;
+      std::optional<eosio::chain::named_thread_pool> decode_thread_pool; ///< unset when blocks are decoded on the connection strand
+
+      sync_buffer_cache                              sync_buffers;
+
+      net_metrics_tracker                            metrics; ///< totals of all connections
+
+      /// tokens a trx message takes from the rate limit of its peer, more than 1 once the trxs waiting for the main
+      /// thread are past half of trx_admission_queue_depth; nullopt if trxs are not admitted at all
+      std::optional<double> trx_admission_cost() const;
 
    private:
       mutable std::mutex            chain_info_mtx; // protects chain_*
@@ -336,6 +455,7 @@ namespace eosio {
       constexpr static uint16_t to_protocol_version(uint16_t v);
 
       connection_ptr find_connection(const string& host)const; // must call with held mutex
+      void update_connections_snapshot(); // must call with connections_mtx held exclusively
    };
 
    const fc::string logger_name("net_plugin_impl");
@@ -384,12 +504,17 @@ namespace eosio {
    constexpr auto     def_max_write_queue_size = def_send_buffer_size*10;
    constexpr auto     def_max_trx_in_progress_size = 100*1024*1024; // 100 MB
    constexpr auto     def_max_consecutive_immediate_connection_close = 9; // back off if client keeps closing
+   constexpr uint32_t def_max_trx_per_sec_per_peer = 0; // 0 for unlimited
+   constexpr uint32_t def_max_blocks_per_sec_per_peer = 0; // 0 for unlimited
+   constexpr uint32_t def_trx_admission_queue_depth = 0; // p2p trxs waiting for the main thread, 0 for unlimited
    constexpr auto     def_max_clients = 25; // 0 for unlimited clients
    constexpr auto     def_max_nodes_per_host = 1;
    constexpr auto     def_conn_retry_wait = 30;
    constexpr auto     def_txn_expire_wait = std::chrono::seconds(3);
+   constexpr uint32_t def_txn_gossip_window = 30; // seconds an announced trx is served to, or awaited from, peers
    constexpr auto     def_resp_expected_wait = std::chrono::seconds(5);
    constexpr auto     def_sync_fetch_span = 100;
+   constexpr uint32_t def_sync_send_batch = 16; // blocks fetched and written together when serving a sync request
    constexpr auto     def_keepalive_interval = 32000;
 
    constexpr auto     message_header_size = 4;
@@ -397,6 +522,8 @@ namespace eosio {
    constexpr uint32_t packed_transaction_v0_which = fc::get_index<net_message, packed_transaction_v0>(); // see protocol net_message
    constexpr uint32_t signed_block_which          = fc::get_index<net_message, signed_block>();          // see protocol net_message
    constexpr uint32_t trx_message_v1_which        = fc::get_index<net_message, trx_message_v1>();        // see protocol net_message
+   constexpr uint32_t compressed_block_which      = fc::get_index<net_message, compressed_block_message>(); // see protocol net_message
+   constexpr uint32_t compact_block_which         = fc::get_index<net_message, compact_block_message>();    // see protocol net_message
 
    /**
     *  For a while, network version was a 16 bit value equal to the second set of 16 bits
@@ -422,8 +549,13 @@ namespace eosio {
    constexpr uint16_t proto_pruned_types = 3;        // supports new signed_block & packed_transaction types
    constexpr uint16_t heartbeat_interval = 4;        // supports configurable heartbeat interval
    constexpr uint16_t dup_goaway_resolution = 5;     // support peer address based duplicate connection resolution
+   constexpr uint16_t proto_trx_inventory = 6;       // supports trx announcement via notice_message and fetch via request_message
+
+   constexpr uint16_t proto_compact_blocks = 7;      // supports compact_block_message
+
+   constexpr uint16_t proto_compressed_blocks = 8;   // supports compressed_block_message
 
-   constexpr uint16_t net_version = dup_goaway_resolution;
+   constexpr uint16_t net_version = proto_compressed_blocks;
 
    /**
     * Index by start_block_num
@@ -439,13 +571,24 @@ namespace eosio {
       time_point   start_time; ///< time request made or received
    };
 
+   /// send priority classes of queued_buffer, lower values are sent first
+   enum class send_priority : uint8_t {
+      control,     ///< handshake, time, notice, request and go away messages
+      live_block,  ///< blocks broadcast or requested outside of sync
+      transaction,
+      sync,        ///< blocks sent to a syncing peer
+      count
+   };
+
    // thread safe
    class queued_buffer : boost::noncopyable {
    public:
       void clear_write_queue() {
          std::lock_guard<std::mutex> g( _mtx );
-         _write_queue.clear();
-         _sync_write_queue.clear();
+         for( auto& q : _write_queues ) {
+            q.queue.clear();
+            q.deficit = 0;
+         }
          _write_queue_size = 0;
       }
 
@@ -466,22 +609,23 @@ namespace eosio {
          return _out_queue.empty();
       }
 
+      bool is_write_queue_empty( send_priority priority ) const {
+         std::lock_guard<std::mutex> g( _mtx );
+         return _write_queues[static_cast<size_t>(priority)].queue.empty();
+      }
+
       bool ready_to_send() const {
          std::lock_guard<std::mutex> g( _mtx );
          // if out_queue is not empty then async_write is in progress
-         return ((!_sync_write_queue.empty() || !_write_queue.empty()) && _out_queue.empty());
+         return _write_queue_size > 0 && _out_queue.empty();
       }
 
       // @param callback must not callback into queued_buffer
       bool add_write_queue( const std::shared_ptr<vector<char>>& buff,
                             std::function<void( boost::system::error_code, std::size_t )> callback,
-                            bool to_sync_queue ) {
+                            send_priority priority ) {
          std::lock_guard<std::mutex> g( _mtx );
-         if( to_sync_queue ) {
-            _sync_write_queue.push_back( {buff, callback} );
-         } else {
-            _write_queue.push_back( {buff, callback} );
-         }
+         _write_queues[static_cast<size_t>(priority)].queue.push_back( {buff, callback} );
          _write_queue_size += buff->size();
          if( _write_queue_size > 2 * def_max_write_queue_size ) {
             return false;
@@ -489,13 +633,25 @@ namespace eosio {
          return true;
       }
 
+      /// deficit round robin over the priority classes: control and live blocks are always sent in full,
+      /// transactions and sync blocks each get a byte quantum per write so neither starves the other
       void fill_out_buffer( std::vector<boost::asio::const_buffer>& bufs ) {
          std::lock_guard<std::mutex> g( _mtx );
-         if( _sync_write_queue.size() > 0 ) { // always send msgs from sync_write_queue first
-            fill_out_buffer( bufs, _sync_write_queue );
-         } else { // postpone real_time write_queue if sync queue is not empty
-            fill_out_buffer( bufs, _write_queue );
-            EOS_ASSERT( _write_queue_size == 0, plugin_exception, "write queue size expected to be zero" );
+         for( size_t p = 0; p < _write_queues.size(); ++p ) {
+            auto& wq = _write_queues[p];
+            if( wq.queue.empty() ) continue;
+            const size_t quantum = quantums[p];
+            wq.deficit = (quantum == unlimited || wq.deficit >= unlimited - quantum) ? unlimited : wq.deficit + quantum;
+            // always send at least one message so a message larger than the quantum still makes progress
+            while( !wq.queue.empty() && (bufs.empty() || wq.queue.front().buff->size() <= wq.deficit) ) {
+               auto& m = wq.queue.front();
+               wq.deficit -= std::min( wq.deficit, m.buff->size() );
+               bufs.push_back( boost::asio::buffer( *m.buff ));
+               _write_queue_size -= m.buff->size();
+               _out_queue.emplace_back( m );
+               wq.queue.pop_front();
+            }
+            if( wq.queue.empty() ) wq.deficit = 0;
          }
       }
 
@@ -506,29 +662,24 @@ namespace eosio {
          }
       }
 
-   private:
-      struct queued_write;
-      void fill_out_buffer( std::vector<boost::asio::const_buffer>& bufs,
-                            deque<queued_write>& w_queue ) {
-         while ( w_queue.size() > 0 ) {
-            auto& m = w_queue.front();
-            bufs.push_back( boost::asio::buffer( *m.buff ));
-            _write_queue_size -= m.buff->size();
-            _out_queue.emplace_back( m );
-            w_queue.pop_front();
-         }
-      }
-
    private:
       struct queued_write {
          std::shared_ptr<vector<char>> buff;
          std::function<void( boost::system::error_code, std::size_t )> callback;
       };
+      struct write_queue {
+         deque<queued_write> queue;
+         size_t              deficit = 0; ///< bytes this class may still send before yielding to lower classes
+      };
+
+      static constexpr size_t unlimited = std::numeric_limits<size_t>::max();
+      static constexpr std::array<size_t, static_cast<size_t>(send_priority::count)> quantums = {
+         unlimited, unlimited, def_send_buffer_size / 2, def_send_buffer_size / 2
+      };
 
       mutable std::mutex  _mtx;
       uint32_t            _write_queue_size{0};
-      deque<queued_write> _write_queue;
-      deque<queued_write> _sync_write_queue; // sync_write_queue will be sent first
+      std::array<write_queue, static_cast<size_t>(send_priority::count)> _write_queues;
       deque<queued_write> _out_queue;
 
    }; // queued_buffer
@@ -573,6 +724,35 @@ namespace eosio {
       block_status_monitor& operator=( block_status_monitor&& ) = delete;
    };
 
+   /// rolling measurements of a peer as a sync source, used by sync_manager to pick the source of the next chunk
+   /// thread safe
+   class peer_sync_stats {
+   public:
+      /// called when a chunk of blocks start to end is requested from the peer
+      void chunk_requested( uint32_t start, uint32_t end );
+      /// called when a sync block is received and accepted from the peer
+      void block_received( uint32_t blk_num );
+      /// called when the peer did not deliver a requested chunk in time
+      void chunk_timed_out();
+      /// called when a block from the peer is rejected
+      void block_rejected();
+      /// called with the round trip measured from a time_message exchange
+      void round_trip( fc::microseconds rtt );
+      /// higher is better, a peer not yet measured scores highest so it is tried
+      double score() const;
+
+   private:
+      static constexpr double ewma_weight = 0.3; ///< weight of the newest measurement
+
+      mutable std::mutex  mtx;
+      uint32_t            chunk_start = 0;
+      uint32_t            chunk_end = 0;
+      fc::time_point      chunk_requested_time;
+      double              blocks_per_sec = 0;    ///< ewma of chunk delivery rate, 0 if not measured
+      double              rtt_us = 0;            ///< ewma of time_message round trip
+      double              rejected_blocks = 0;   ///< recent rejected blocks, halved on every delivered chunk
+   };
+
    class connection : public std::enable_shared_from_this<connection> {
    public:
       explicit connection( string endpoint );
@@ -599,6 +779,7 @@ namespace eosio {
       void update_endpoints();
 
       std::optional<peer_sync_state> peer_requested;  // this peer is requesting info from us
+      bool                           sync_batch_pending = false; // a sync batch is being fetched, strand only
 
       std::atomic<bool>                         socket_open{false};
 
@@ -629,6 +810,10 @@ namespace eosio {
       std::atomic<uint16_t>   protocol_version = 0;
       uint16_t                consecutive_rejected_blocks = 0;
       block_status_monitor    block_status_monitor_;
+      peer_sync_stats         sync_stats;
+      net_metrics_tracker     metrics;
+      token_bucket            trx_bucket;   ///< accessed only from strand
+      token_bucket            block_bucket; ///< accessed only from strand
       std::atomic<uint16_t>   consecutive_immediate_connection_close = 0;
 
       std::mutex                            response_expected_timer_mtx;
@@ -676,6 +861,23 @@ namespace eosio {
 
       bool process_next_block_message(uint32_t message_length);
       bool process_next_trx_message(uint32_t message_length);
+
+      /// a block being deserialized on the decode thread pool, delivered in the order it was received
+      struct pending_block_decode {
+         block_id_type                id;
+         signed_block_ptr             block;
+         bool                         has_webauthn_sig = false;
+         std::optional<std::string>   error;
+         std::atomic<bool>            ready{false};
+      };
+      deque<std::shared_ptr<pending_block_decode>> pending_block_decodes; // accessed only from strand threads
+
+      vector<transaction_id_type> pending_trx_announcements; // accessed only from strand threads
+
+      template<typename Stream>
+      static signed_block_ptr unpack_block( uint32_t which, Stream& ds );
+      static bool has_webauthn_sig( const signed_block& b );
+      void deliver_decoded_blocks();
    public:
 
       bool populate_handshake( handshake_message& hello, bool force );
@@ -693,6 +895,8 @@ namespace eosio {
        * encountered unpacking or processing the message.
        */
       bool process_next_message(uint32_t message_length);
+      /// @return false if the message of type which exceeds the rate limits of this connection and is to be dropped
+      bool admit_message( uint32_t which );
 
       void send_handshake( bool force = false );
 
@@ -728,10 +932,21 @@ namespace eosio {
       void stop_send();
 
       void enqueue( const net_message &msg );
-      void enqueue_block( const signed_block_ptr& sb, bool to_sync_queue = false);
+      void enqueue_block( const signed_block_ptr& sb, send_priority priority = send_priority::live_block );
+      /// block to serve a sync request, buffer is set when taken from sync_buffer_cache, otherwise block is set
+      struct sync_block {
+         uint32_t                           block_num = 0;
+         signed_block_ptr                   block;
+         std::shared_ptr<std::vector<char>> buffer;
+      };
+      void enqueue_sync_blocks( const std::vector<sync_block>& blocks, uint32_t lib_num );
+      void announce_trx( const transaction_id_type& id );
+      block_wire_format block_format() const;
+      std::shared_ptr<std::vector<char>> create_compact_block_buffer( const signed_block_ptr& b ) const;
+      void send_requested_trxs( const vector<transaction_id_type>& ids );
       void enqueue_buffer( const std::shared_ptr<std::vector<char>>& send_buffer,
                            go_away_reason close_after_send,
-                           bool to_sync_queue = false);
+                           send_priority priority = send_priority::control);
       void cancel_sync(go_away_reason);
       void flush_queues();
       bool enqueue_sync_block();
@@ -745,7 +960,7 @@ namespace eosio {
 
       void queue_write(const std::shared_ptr<vector<char>>& buff,
                        std::function<void(boost::system::error_code, std::size_t)> callback,
-                       bool to_sync_queue = false);
+                       send_priority priority = send_priority::control);
       void do_queue_write();
 
       static bool is_valid( const handshake_message& msg );
@@ -771,6 +986,9 @@ namespace eosio {
       void handle_message( const notice_message& msg );
       void handle_message( const request_message& msg );
       void handle_message( const sync_request_message& msg );
+      void handle_message( const compact_block_message& msg );
+      void handle_message( const compressed_block_message& msg );
+      void handle_unpacked_block( const block_id_type& id, signed_block_ptr ptr );
       void handle_message( const signed_block& msg ) = delete; // signed_block_ptr overload used instead
       void handle_message( const block_id_type& id, signed_block_ptr msg );
       void handle_message( const packed_transaction& msg ) = delete; // packed_transaction_ptr overload used instead
@@ -845,20 +1063,33 @@ namespace eosio {
          fc_dlog( logger, "handle sync_request_message" );
          c->handle_message( msg );
       }
+
+      void operator()( const compact_block_message& msg ) const {
+         // continue call to handle_message on connection strand
+         fc_dlog( logger, "handle compact_block_message" );
+         c->handle_message( msg );
+      }
+
+      void operator()( const compressed_block_message& msg ) const {
+         // continue call to handle_message on connection strand
+         fc_dlog( logger, "handle compressed_block_message" );
+         c->handle_message( msg );
+      }
    };
 
+   // lock free, iterates the connections snapshot so connections added or removed during the call may or may not be visited
    template<typename Function>
    void for_each_connection( Function f ) {
-      std::shared_lock<std::shared_mutex> g( my_impl->connections_mtx );
-      for( auto& c : my_impl->connections ) {
+      const auto connections = std::atomic_load( &my_impl->connections_snapshot );
+      for( auto& c : *connections ) {
          if( !f( c ) ) return;
       }
    }
 
    template<typename Function>
    void for_each_block_connection( Function f ) {
-      std::shared_lock<std::shared_mutex> g( my_impl->connections_mtx );
-      for( auto& c : my_impl->connections ) {
+      const auto connections = std::atomic_load( &my_impl->connections_snapshot );
+      for( auto& c : *connections ) {
          if( c->is_transactions_only_connection() ) continue;
          if( !f( c ) ) return;
       }
@@ -875,6 +1106,8 @@ namespace eosio {
         last_handshake_recv(),
         last_handshake_sent()
    {
+      trx_bucket.configure( my_impl->max_trx_per_sec_per_peer, my_impl->max_trx_burst_per_peer );
+      block_bucket.configure( my_impl->max_blocks_per_sec_per_peer, my_impl->max_blocks_burst_per_peer );
       fc_ilog( logger, "creating connection to ${n}", ("n", endpoint) );
    }
 
@@ -887,6 +1120,8 @@ namespace eosio {
         last_handshake_recv(),
         last_handshake_sent()
    {
+      trx_bucket.configure( my_impl->max_trx_per_sec_per_peer, my_impl->max_trx_burst_per_peer );
+      block_bucket.configure( my_impl->max_blocks_per_sec_per_peer, my_impl->max_blocks_burst_per_peer );
       fc_dlog( logger, "new connection object created" );
    }
 
@@ -983,6 +1218,7 @@ namespace eosio {
       }
       self->socket.reset( new tcp::socket( my_impl->thread_pool->get_executor() ) );
       self->flush_queues();
+      self->pending_block_decodes.clear();
       self->connecting = false;
       self->syncing = false;
       self->block_status_monitor_.reset();
@@ -1176,8 +1412,17 @@ namespace eosio {
 
    void connection::queue_write(const std::shared_ptr<vector<char>>& buff,
                                 std::function<void(boost::system::error_code, std::size_t)> callback,
-                                bool to_sync_queue) {
-      if( !buffer_queue.add_write_queue( buff, callback, to_sync_queue )) {
+                                send_priority priority) {
+      // a buffer may hold several messages, each with its own header, see enqueue_sync_blocks
+      for( size_t pos = 0; pos + message_header_size < buff->size(); ) {
+         uint32_t payload_size = 0;
+         memcpy( &payload_size, buff->data() + pos, message_header_size );
+         const uint32_t which = static_cast<uint8_t>( (*buff)[pos + message_header_size] ); // which < 128 is a single byte varint
+         metrics.message_sent( which, payload_size + message_header_size );
+         my_impl->metrics.message_sent( which, payload_size + message_header_size );
+         pos += message_header_size + payload_size;
+      }
+      if( !buffer_queue.add_write_queue( buff, callback, priority )) {
          fc_wlog( logger, "write_queue full ${s} bytes, giving up on connection ${p}",
                   ("s", buffer_queue.write_queue_size())("p", peer_name()) );
          close();
@@ -1257,33 +1502,48 @@ namespace eosio {
    bool connection::enqueue_sync_block() {
       if( !peer_requested ) {
          return false;
-      } else {
-         fc_dlog( logger, "enqueue sync block ${num}", ("num", peer_requested->last + 1) );
       }
-      uint32_t num = ++peer_requested->last;
-      if(num == peer_requested->end_block) {
+      // only fetch the next batch once the previous one has been handed to the socket, called after every write
+      if( sync_batch_pending || !buffer_queue.is_write_queue_empty( send_priority::sync ) ) {
+         return false;
+      }
+      sync_batch_pending = true;
+      // fetch a run of blocks in one main thread task and send them in one write instead of a round trip per block
+      const uint32_t first = peer_requested->last + 1;
+      const uint32_t last = std::min( peer_requested->end_block, peer_requested->last + def_sync_send_batch );
+      fc_dlog( logger, "enqueue sync blocks ${f} - ${l}", ("f", first)("l", last) );
+      peer_requested->last = last;
+      if( last == peer_requested->end_block ) {
          peer_requested.reset();
-         fc_ilog( logger, "completing enqueue_sync_block ${num} to ${p}", ("num", num)("p", peer_name()) );
+         fc_ilog( logger, "completing enqueue_sync_block ${num} to ${p}", ("num", last)("p", peer_name()) );
       }
       connection_wptr weak = shared_from_this();
-      app().post( priority::medium, [num, weak{std::move(weak)}]() {
+      app().post( priority::medium, [first, last, weak{std::move(weak)}]() {
          connection_ptr c = weak.lock();
          if( !c ) return;
          controller& cc = my_impl->chain_plug->chain();
-         signed_block_ptr sb;
-         try {
-            sb = cc.fetch_block_by_number( num );
-         } FC_LOG_AND_DROP();
-         if( sb ) {
-            c->strand.post( [c, sb{std::move(sb)}]() {
-               c->enqueue_block( sb, true );
-            });
-         } else {
-            c->strand.post( [c, num]() {
+         const block_wire_format format = c->block_format();
+         std::vector<sync_block> blocks;
+         blocks.reserve( last - first + 1 );
+         uint32_t num = first;
+         for( ; num <= last; ++num ) {
+            sync_block b{ num, {}, my_impl->sync_buffers.get( num, format ) };
+            if( !b.buffer ) {
+               try {
+                  b.block = cc.fetch_block_by_number( num );
+               } FC_LOG_AND_DROP();
+               if( !b.block ) break;
+            }
+            blocks.emplace_back( std::move( b ) );
+         }
+         c->strand.post( [c, blocks{std::move(blocks)}, num, last, lib_num = cc.last_irreversible_block_num()]() {
+            c->sync_batch_pending = false;
+            c->enqueue_sync_blocks( blocks, lib_num );
+            if( num <= last ) {
                peer_ilog( c, "enqueue sync, unable to fetch block ${num}", ("num", num) );
                c->send_handshake();
-            });
-         }
+            }
+         });
       });
 
       return true;
@@ -1343,6 +1603,18 @@ namespace eosio {
          return send_buffer;
       }
 
+      /// wraps the message of a send buffer created above in a compressed_block_message
+      static send_buffer_type create_compressed_send_buffer( const send_buffer_type& sb ) {
+         namespace bio = boost::iostreams;
+         compressed_block_message m;
+         bio::filtering_ostream comp;
+         comp.push( bio::zlib_compressor( bio::zlib::default_compression ) );
+         comp.push( bio::back_inserter( m.data ) );
+         bio::write( comp, sb->data() + message_header_size, sb->size() - message_header_size );
+         bio::close( comp );
+         return create_send_buffer( compressed_block_which, m );
+      }
+
    };
 
    struct block_buffer_factory : public buffer_factory {
@@ -1365,8 +1637,18 @@ namespace eosio {
          }
       }
 
+      /// caches result for subsequent calls, only provide same signed_block_ptr instance for each invocation.
+      /// only for peers of at least proto_compressed_blocks
+      const send_buffer_type& get_compressed_send_buffer( const signed_block_ptr& sb ) {
+         if( !send_buffer_compressed ) {
+            send_buffer_compressed = create_compressed_send_buffer( get_send_buffer( sb, proto_compressed_blocks ) );
+         }
+         return send_buffer_compressed;
+      }
+
    private:
       send_buffer_type send_buffer_v0;
+      send_buffer_type send_buffer_compressed;
 
    private:
 
@@ -1446,12 +1728,13 @@ namespace eosio {
       enqueue_buffer( send_buffer, close_after_send );
    }
 
-   void connection::enqueue_block( const signed_block_ptr& b, bool to_sync_queue) {
+   void connection::enqueue_block( const signed_block_ptr& b, send_priority priority ) {
       fc_dlog( logger, "enqueue block ${num}", ("num", b->block_num()) );
       verify_strand_in_this_thread( strand, __func__, __LINE__ );
 
       block_buffer_factory buff_factory;
-      auto sb = buff_factory.get_send_buffer( b, protocol_version.load() );
+      auto sb = block_format() == block_wire_format::compressed ? buff_factory.get_compressed_send_buffer( b )
+                                                                : buff_factory.get_send_buffer( b, protocol_version.load() );
       if( !sb ) {
          peer_wlog( this, "Sending go away for incomplete block #${n} ${id}...",
                     ("n", b->block_num())("id", b->calculate_id().str().substr(8,16)) );
@@ -1459,12 +1742,134 @@ namespace eosio {
          enqueue( go_away_message( fatal_other ) );
          return;
       }
-      enqueue_buffer( sb, no_reason, to_sync_queue);
+      enqueue_buffer( sb, no_reason, priority );
+   }
+
+   // called from connection strand
+   void connection::enqueue_sync_blocks( const std::vector<sync_block>& blocks, uint32_t lib_num ) {
+      verify_strand_in_this_thread( strand, __func__, __LINE__ );
+      const uint16_t proto_version = protocol_version.load();
+      const block_wire_format format = block_format();
+
+      // each send buffer carries its own message header, so the concatenation is a valid stream of block messages
+      std::shared_ptr<std::vector<char>> batch;
+      auto append = [&batch]( const std::shared_ptr<std::vector<char>>& sb ) {
+         if( !batch ) {
+            batch = sb;
+         } else {
+            if( batch.use_count() > 1 ) batch = std::make_shared<std::vector<char>>( *batch ); // do not modify cached buffer
+            batch->insert( batch->end(), sb->begin(), sb->end() );
+         }
+      };
+      for( const auto& b : blocks ) {
+         if( b.buffer ) {
+            append( b.buffer );
+            continue;
+         }
+         block_buffer_factory buff_factory;
+         const auto& sb = format == block_wire_format::compressed ? buff_factory.get_compressed_send_buffer( b.block )
+                                                                  : buff_factory.get_send_buffer( b.block, proto_version );
+         if( !sb ) {
+            if( batch ) enqueue_buffer( batch, no_reason, send_priority::sync );
+            peer_wlog( this, "Sending go away for incomplete block #${n} ${id}...",
+                       ("n", b.block_num)("id", b.block->calculate_id().str().substr(8,16)) );
+            enqueue( go_away_message( fatal_other ) );
+            return;
+         }
+         // only irreversible blocks are cached as their block number alone identifies them
+         if( b.block_num <= lib_num ) my_impl->sync_buffers.add( b.block_num, format, sb );
+         append( sb );
+      }
+      if( batch ) enqueue_buffer( batch, no_reason, send_priority::sync );
+   }
+
+   // thread safe
+   block_wire_format connection::block_format() const {
+      const uint16_t proto_version = protocol_version.load();
+      if( proto_version < proto_pruned_types ) return block_wire_format::v0;
+      if( my_impl->p2p_compress_blocks && proto_version >= proto_compressed_blocks ) return block_wire_format::compressed;
+      return block_wire_format::current;
+   }
+
+   // called from connection strand
+   void connection::announce_trx( const transaction_id_type& id ) {
+      pending_trx_announcements.push_back( id );
+      if( pending_trx_announcements.size() > 1 ) return; // flush already posted
+      // announcements posted to the strand before the flush runs go out in the same notice_message
+      strand.post( [c = shared_from_this()]() {
+         notice_message note;
+         note.known_trx.mode = normal;
+         note.known_trx.ids = std::move( c->pending_trx_announcements );
+         c->pending_trx_announcements.clear();
+         fc_dlog( logger, "announcing ${n} trxs to ${p}", ("n", note.known_trx.ids.size())("p", c->peer_name()) );
+         c->enqueue( note );
+      });
+   }
+
+   // called from connection strand, returns null when the peer is not known to have any of the block's trxs
+   std::shared_ptr<std::vector<char>> connection::create_compact_block_buffer( const signed_block_ptr& b ) const {
+      compact_block_message cb;
+      for( uint32_t i = 0; i < b->transactions.size(); ++i ) {
+         const auto& receipt = b->transactions[i];
+         if( std::holds_alternative<packed_transaction>( receipt.trx ) &&
+             my_impl->dispatcher->peer_has_txn( std::get<packed_transaction>( receipt.trx ).id(), connection_id ) ) {
+            cb.omitted.push_back( i );
+         }
+      }
+      if( cb.omitted.empty() ) return {};
+
+      cb.block = std::make_shared<signed_block>( static_cast<const signed_block_header&>( *b ) );
+      cb.block->prune_state = b->prune_state;
+      cb.block->block_extensions = b->block_extensions;
+      auto omitted_itr = cb.omitted.cbegin();
+      for( uint32_t i = 0; i < b->transactions.size(); ++i ) {
+         const auto& receipt = b->transactions[i];
+         if( omitted_itr != cb.omitted.cend() && *omitted_itr == i ) {
+            ++omitted_itr;
+            cb.block->transactions.emplace_back( std::get<packed_transaction>( receipt.trx ).id() );
+            static_cast<transaction_receipt_header&>( cb.block->transactions.back() ) = receipt;
+         } else {
+            cb.block->transactions.push_back( receipt );
+         }
+      }
+
+      buffer_factory buff_factory;
+      return buff_factory.get_send_buffer( net_message( std::move( cb ) ) );
+   }
+
+   // called from connection strand
+   void connection::send_requested_trxs( const vector<transaction_id_type>& ids ) {
+      for( const auto& id : ids ) {
+         packed_transaction_ptr trx = my_impl->dispatcher->get_announced_txn( id );
+         if( !trx ) continue; // expired, peer will receive it from another peer or in a block
+         trx_buffer_factory buff_factory;
+         const auto& sb = buff_factory.get_send_buffer( trx, protocol_version.load() );
+         if( sb ) enqueue_buffer( sb, no_reason, send_priority::transaction );
+      }
+   }
+
+   sync_buffer_cache::buffer_ptr sync_buffer_cache::get( uint32_t block_num, block_wire_format format ) const {
+      std::lock_guard<std::mutex> g( buffers_mtx );
+      auto itr = buffers.find( std::make_pair( block_num, format ) );
+      return itr != buffers.end() ? itr->second : buffer_ptr{};
+   }
+
+   void sync_buffer_cache::add( uint32_t block_num, block_wire_format format, const buffer_ptr& buffer ) {
+      std::lock_guard<std::mutex> g( buffers_mtx );
+      if( !buffers.emplace( std::make_pair( block_num, format ), buffer ).second ) return;
+      insertion_order.emplace_back( block_num, format );
+      cached_bytes += buffer->size();
+      while( cached_bytes > max_cached_bytes ) {
+         auto itr = buffers.find( insertion_order.front() );
+         cached_bytes -= itr->second->size();
+         buffers.erase( itr );
+         insertion_order.pop_front();
+      }
    }
 
    void connection::enqueue_buffer( const std::shared_ptr<std::vector<char>>& send_buffer,
                                     go_away_reason close_after_send,
-                                    bool to_sync_queue)
+                                    send_priority priority)
    {
       connection_ptr self = shared_from_this();
       queue_write(send_buffer,
@@ -1477,7 +1882,7 @@ namespace eosio {
                            return;
                         }
                   },
-                  to_sync_queue);
+                  priority);
    }
 
    // thread safe
@@ -1511,6 +1916,7 @@ namespace eosio {
    // called from connection strand
    void connection::sync_timeout( boost::system::error_code ec ) {
       if( !ec ) {
+         sync_stats.chunk_timed_out();
          my_impl->sync_master->sync_reassign_fetch( shared_from_this(), benign_other );
       } else if( ec == boost::asio::error::operation_aborted ) {
       } else {
@@ -1548,9 +1954,92 @@ namespace eosio {
    void connection::request_sync_blocks(uint32_t start, uint32_t end) {
       sync_request_message srm = {start,end};
       enqueue( net_message(srm) );
+      sync_stats.chunk_requested( start, end );
       sync_wait();
    }
 
+   //-----------------------------------------------------------
+   vector<net_message_counters> net_metrics_tracker::message_counters() const {
+      // in net_message order
+      static constexpr std::array<const char*, num_message_types> type_names = {
+         "handshake_message", "chain_size_message", "go_away_message", "time_message", "notice_message",
+         "request_message", "sync_request_message", "signed_block_v0", "packed_transaction_v0", "signed_block",
+         "trx_message_v1", "compact_block_message", "compressed_block_message"
+      };
+      vector<net_message_counters> result;
+      result.reserve( num_message_types );
+      for( size_t i = 0; i < num_message_types; ++i ) {
+         result.push_back( net_message_counters{ type_names[i],
+                                                 received[i].messages.load( std::memory_order_relaxed ),
+                                                 received[i].bytes.load( std::memory_order_relaxed ),
+                                                 sent[i].messages.load( std::memory_order_relaxed ),
+                                                 sent[i].bytes.load( std::memory_order_relaxed ),
+                                                 dropped[i].load( std::memory_order_relaxed ) } );
+      }
+      return result;
+   }
+
+   void net_metrics_tracker::histogram::record( fc::microseconds d ) {
+      const uint64_t us = std::max<int64_t>( d.count(), 0 );
+      const auto bucket = std::lower_bound( bounds_us.begin(), bounds_us.end(), us ) - bounds_us.begin();
+      counts[bucket].fetch_add( 1, std::memory_order_relaxed );
+      total_us.fetch_add( us, std::memory_order_relaxed );
+   }
+
+   latency_histogram net_metrics_tracker::histogram::snapshot() const {
+      latency_histogram result;
+      result.bucket_bounds_us.assign( bounds_us.begin(), bounds_us.end() );
+      result.counts.reserve( counts.size() );
+      for( const auto& c : counts ) {
+         result.counts.push_back( c.load( std::memory_order_relaxed ) );
+      }
+      result.total_us = total_us.load( std::memory_order_relaxed );
+      return result;
+   }
+
+   //-----------------------------------------------------------
+   void peer_sync_stats::chunk_requested( uint32_t start, uint32_t end ) {
+      std::lock_guard<std::mutex> g( mtx );
+      chunk_start = start;
+      chunk_end = end;
+      chunk_requested_time = fc::time_point::now();
+   }
+
+   void peer_sync_stats::block_received( uint32_t blk_num ) {
+      std::lock_guard<std::mutex> g( mtx );
+      if( chunk_end == 0 || blk_num != chunk_end ) return;
+      const auto elapsed = fc::time_point::now() - chunk_requested_time;
+      const double rate = (chunk_end - chunk_start + 1) * 1'000'000.0 / std::max<int64_t>( elapsed.count(), 1 );
+      blocks_per_sec = blocks_per_sec > 0 ? ewma_weight * rate + (1 - ewma_weight) * blocks_per_sec : rate;
+      rejected_blocks /= 2;
+      chunk_end = 0;
+   }
+
+   void peer_sync_stats::chunk_timed_out() {
+      std::lock_guard<std::mutex> g( mtx );
+      // a peer that never delivered a chunk gets a minimal rate so it is no longer preferred over measured peers
+      blocks_per_sec = blocks_per_sec > 0 ? blocks_per_sec / 2 : std::numeric_limits<double>::min();
+      chunk_end = 0;
+   }
+
+   void peer_sync_stats::block_rejected() {
+      std::lock_guard<std::mutex> g( mtx );
+      ++rejected_blocks;
+   }
+
+   void peer_sync_stats::round_trip( fc::microseconds rtt ) {
+      std::lock_guard<std::mutex> g( mtx );
+      if( rtt.count() <= 0 ) return;
+      rtt_us = rtt_us > 0 ? ewma_weight * rtt.count() + (1 - ewma_weight) * rtt_us : rtt.count();
+   }
+
+   double peer_sync_stats::score() const {
+      std::lock_guard<std::mutex> g( mtx );
+      if( blocks_per_sec == 0 ) return std::numeric_limits<double>::max();
+      // every 100ms of round trip or recently rejected block counts as much as halving the delivery rate
+      return blocks_per_sec / (1 + rtt_us / 100'000) / (1 + rejected_blocks);
+   }
+
    //-----------------------------------------------------------
    void block_status_monitor::reset() {
       in_accepted_state_ = true;
@@ -1642,7 +2131,8 @@ namespace eosio {
       /* ----------
        * next chunk provider selection criteria
        * a provider is supplied and able to be used, use it.
-       * otherwise select the next available from the list, round-robin style.
+       * otherwise select the best scoring available from the list, scanning round-robin style
+       * so that ties, including peers not yet measured, are spread across peers.
        */
 
       if (conn && conn->current() ) {
@@ -1676,20 +2166,23 @@ namespace eosio {
                }
             }
 
-            //scan the list of peers looking for another able to provide sync blocks.
+            //scan the list of peers looking for the best able to provide sync blocks.
             if( cptr != my_impl->connections.end() ) {
                auto cstart_it = cptr;
+               double best_score = -1;
                do {
-                  //select the first one which is current and break out.
                   if( !(*cptr)->is_transactions_only_connection() && (*cptr)->current() ) {
-                     sync_source = *cptr;
-                     break;
+                     const double score = (*cptr)->sync_stats.score();
+                     if( score > best_score ) {
+                        best_score = score;
+                        sync_source = *cptr;
+                     }
                   }
                   if( ++cptr == my_impl->connections.end() )
                      cptr = my_impl->connections.begin();
                } while( cptr != cstart_it );
             }
-            // no need to check the result, either source advanced or the whole list was checked and the old source is reused.
+            // no need to check the result, either the best source was selected or the whole list was checked and the old source is reused.
          }
       }
 
@@ -1965,6 +2458,7 @@ namespace eosio {
    // called from connection strand
    void sync_manager::rejected_block( const connection_ptr& c, uint32_t blk_num ) {
       c->block_status_monitor_.rejected();
+      c->sync_stats.block_rejected();
       if( c->block_status_monitor_.max_events_violated()) {
          fc_wlog( logger, "block ${bn} not accepted from ${p}, closing connection", ("bn", blk_num)("p", c->peer_name()) );
          std::unique_lock<std::mutex> g( sync_mtx );
@@ -2002,6 +2496,7 @@ namespace eosio {
          return;
       }
       c->block_status_monitor_.accepted();
+      c->sync_stats.block_received( blk_num );
       sync_update_expected( c, blk_id, blk_num, blk_applied );
       std::unique_lock<std::mutex> g_sync( sync_mtx );
       stages state = sync_state;
@@ -2167,6 +2662,30 @@ namespace eosio {
       g.unlock();
 
       fc_dlog( logger, "expire_local_txns size ${s} removed ${r}", ("s", start_size)( "r", start_size - end_size ) );
+
+      std::lock_guard<std::mutex> g_gossip( gossip_txns_mtx );
+      auto& announced = announced_txns.get<by_expiry>();
+      announced.erase( announced.begin(), announced.upper_bound( time_point::now() ) );
+      auto& requested = requested_txns.get<by_expiry>();
+      requested.erase( requested.begin(), requested.upper_bound( time_point::now() ) );
+   }
+
+   void dispatch_manager::add_announced_txn( const packed_transaction_ptr& trx ) {
+      const time_point_sec expires = std::min( trx->expiration(), time_point_sec( time_point::now() ) + def_txn_gossip_window );
+      std::lock_guard<std::mutex> g( gossip_txns_mtx );
+      announced_txns.insert( gossip_trx_state{ trx->id(), expires, trx } );
+   }
+
+   packed_transaction_ptr dispatch_manager::get_announced_txn( const transaction_id_type& tid ) const {
+      std::lock_guard<std::mutex> g( gossip_txns_mtx );
+      auto itr = announced_txns.find( tid );
+      return itr != announced_txns.end() ? itr->trx : packed_transaction_ptr{};
+   }
+
+   // returns true if tid was not already requested from a peer
+   bool dispatch_manager::add_requested_txn( const transaction_id_type& tid ) {
+      std::lock_guard<std::mutex> g( gossip_txns_mtx );
+      return requested_txns.insert( gossip_trx_state{ tid, time_point_sec( time_point::now() ) + def_txn_gossip_window, {} } ).second;
    }
 
    void dispatch_manager::expire_blocks( uint32_t lib_num ) {
@@ -2187,7 +2706,8 @@ namespace eosio {
          peer_dlog( cp, "socket_is_open ${s}, connecting ${c}, syncing ${ss}",
                     ("s", cp->socket_is_open())("c", cp->connecting.load())("ss", cp->syncing.load()) );
          if( !cp->current() ) return true;
-         send_buffer_type sb = buff_factory.get_send_buffer( b, cp->protocol_version.load() );
+         send_buffer_type sb = cp->block_format() == block_wire_format::compressed ? buff_factory.get_compressed_send_buffer( b )
+                                                                                   : buff_factory.get_send_buffer( b, cp->protocol_version.load() );
          if( !sb ) {
             peer_wlog( cp, "Sending go away for incomplete block #${n} ${id}...",
                        ("n", b->block_num())("id", b->calculate_id().str().substr(8,16)) );
@@ -2196,7 +2716,7 @@ namespace eosio {
             return true;
          }
 
-         cp->strand.post( [this, cp, id, bnum, sb{std::move(sb)}]() {
+         cp->strand.post( [this, cp, id, bnum, b, sb{std::move(sb)}]() {
             std::unique_lock<std::mutex> g_conn( cp->conn_mtx );
             bool has_block = cp->last_handshake_recv.last_irreversible_block_num >= bnum;
             g_conn.unlock();
@@ -2205,8 +2725,15 @@ namespace eosio {
                   fc_dlog( logger, "not bcast block ${b} to ${p}", ("b", bnum)("p", cp->peer_name()) );
                   return;
                }
+               if( cp->protocol_version >= proto_compact_blocks ) {
+                  if( auto csb = cp->create_compact_block_buffer( b ) ) {
+                     fc_dlog( logger, "bcast compact block ${b} to ${p}", ("b", bnum)("p", cp->peer_name()) );
+                     cp->enqueue_buffer( csb, no_reason, send_priority::live_block );
+                     return;
+                  }
+               }
                fc_dlog( logger, "bcast block ${b} to ${p}", ("b", bnum)("p", cp->peer_name()) );
-               cp->enqueue_buffer( sb, no_reason );
+               cp->enqueue_buffer( sb, no_reason, send_priority::live_block );
             }
          });
          return true;
@@ -2240,6 +2767,7 @@ namespace eosio {
       node_transaction_state nts = {id, trx_expiration, 0, 0};
 
       trx_buffer_factory buff_factory;
+      add_announced_txn( trx );
       for_each_connection( [this, &trx, &nts, &buff_factory]( auto& cp ) {
          if( cp->is_blocks_only_connection() || !cp->current() ) {
             return true;
@@ -2249,11 +2777,18 @@ namespace eosio {
             return true;
          }
 
+         if( cp->protocol_version >= proto_trx_inventory ) {
+            cp->strand.post( [cp, id = nts.id]() {
+               cp->announce_trx( id );
+            } );
+            return true;
+         }
+
          send_buffer_type sb = buff_factory.get_send_buffer( trx, cp->protocol_version.load() );
          if( !sb ) return true;
          cp->strand.post( [cp, sb{std::move(sb)}]() {
             fc_dlog( logger, "sending trx to ${n}", ("n", cp->peer_name()) );
-            cp->enqueue_buffer( sb, no_reason );
+            cp->enqueue_buffer( sb, no_reason, send_priority::transaction );
          } );
          return true;
       } );
@@ -2271,6 +2806,24 @@ namespace eosio {
    // called from connection strand
    void dispatch_manager::recv_notice(const connection_ptr& c, const notice_message& msg, bool generated) {
       if (msg.known_trx.mode == normal) {
+         if( c->protocol_version < proto_trx_inventory ) {
+            // a peer without trx inventory support does not announce trxs and would not understand the request
+            fc_dlog( logger, "ignoring known_trx of ${p}, protocol version ${v} does not support trx inventory",
+                     ("p", c->peer_name())("v", c->protocol_version.load()) );
+         } else {
+            // request the announced trxs we have neither received nor already requested from another peer
+            request_message req;
+            req.req_trx.mode = normal;
+            for( const auto& id : msg.known_trx.ids ) {
+               if( add_peer_txn( id, c->connection_id ) ) continue;
+               if( !add_requested_txn( id ) ) continue;
+               req.req_trx.ids.push_back( id );
+            }
+            if( !req.req_trx.ids.empty() ) {
+               fc_dlog( logger, "requesting ${n} announced trxs from ${p}", ("n", req.req_trx.ids.size())("p", c->peer_name()) );
+               c->enqueue( req );
+            }
+         }
       } else if (msg.known_trx.mode != none) {
          fc_elog( logger, "passed a notice_message with something other than a normal on none known_trx" );
          return;
@@ -2456,6 +3009,7 @@ namespace eosio {
                      if( new_connection->start_session()) {
                         std::lock_guard<std::shared_mutex> g_unique( connections_mtx );
                         connections.insert( new_connection );
+                        update_connections_snapshot();
                      }
 
                   } else {
@@ -2629,6 +3183,15 @@ namespace eosio {
          auto peek_ds = pending_message_buffer.create_peek_datastream();
          unsigned_int which{};
          fc::raw::unpack( peek_ds, which );
+         metrics.message_received( which, message_length + message_header_size );
+         my_impl->metrics.message_received( which, message_length + message_header_size );
+         if( !admit_message( which ) ) {
+            // dropped before it is decoded
+            metrics.message_dropped( which );
+            my_impl->metrics.message_dropped( which );
+            pending_message_buffer.advance_read_ptr( message_length );
+            return true;
+         }
          if( which == signed_block_which || which == signed_block_v0_which ) {
             return process_next_block_message( message_length );
 
@@ -2652,6 +3215,33 @@ namespace eosio {
       return true;
    }
 
+   // called from connection strand
+   bool connection::admit_message( uint32_t which ) {
+      if( which == trx_message_v1_which || which == packed_transaction_v0_which ) {
+         if( !my_impl->p2p_accept_transactions )
+            return true; // dropped by process_next_trx_message
+         const auto cost = my_impl->trx_admission_cost();
+         if( !cost ) {
+            fc_dlog( logger, "dropping trx from ${p}, ${n} trxs waiting for the main thread",
+                     ("p", peer_name())("n", my_impl->trxs_in_progress.load()) );
+            return false;
+         }
+         if( !trx_bucket.consume( fc::time_point::now(), *cost ) ) {
+            fc_dlog( logger, "dropping trx from ${p}, rate limit exceeded", ("p", peer_name()) );
+            return false;
+         }
+      } else if( which == signed_block_which || which == signed_block_v0_which ||
+                 which == compact_block_which || which == compressed_block_which ) {
+         // a peer building our chain during catch up sends blocks as fast as we can take them
+         if( !block_bucket.unlimited() && !my_impl->sync_master->syncing_with_peer() &&
+             !block_bucket.consume( fc::time_point::now() ) ) {
+            fc_dlog( logger, "dropping block from ${p}, rate limit exceeded", ("p", peer_name()) );
+            return false;
+         }
+      }
+      return true;
+   }
+
    // called from connection strand
    bool connection::process_next_block_message(uint32_t message_length) {
       auto peek_ds = pending_message_buffer.create_peek_datastream();
@@ -2696,8 +3286,62 @@ namespace eosio {
          }
       }
 
+      const auto buff_size_start = pending_message_buffer.bytes_to_read();
       auto ds = pending_message_buffer.create_datastream();
       fc::raw::unpack( ds, which );
+
+      if( !my_impl->decode_thread_pool ) {
+         const auto decode_start = fc::time_point::now();
+         signed_block_ptr ptr = unpack_block( which, ds );
+         const bool webauthn = has_webauthn_sig( *ptr );
+         const auto decode_time = fc::time_point::now() - decode_start;
+         metrics.block_decoded( decode_time );
+         my_impl->metrics.block_decoded( decode_time );
+         if( webauthn ) {
+            fc_dlog( logger, "WebAuthn signed block received from ${p}, closing connection", ("p", peer_name()));
+            close();
+            return false;
+         }
+         handle_message( blk_id, std::move( ptr ) );
+         return true;
+      }
+
+      // copy the block out of the read buffer so reading can continue while it is decoded on the decode thread pool,
+      // block ids and transaction ids (computed on unpack) are then ready to apply when delivered back on the strand
+      const auto buff_size_current = pending_message_buffer.bytes_to_read();
+      auto raw = std::make_shared<std::vector<char>>( message_length - (buff_size_start - buff_size_current) );
+      ds.read( raw->data(), raw->size() );
+
+      auto decode = std::make_shared<pending_block_decode>();
+      decode->id = blk_id;
+      pending_block_decodes.push_back( decode );
+      boost::asio::post( my_impl->decode_thread_pool->get_executor(),
+                         [c = shared_from_this(), decode, raw{std::move(raw)}, which{which.value}]() {
+         try {
+            const auto decode_start = fc::time_point::now();
+            fc::datastream<const char*> ds( raw->data(), raw->size() );
+            decode->block = unpack_block( which, ds );
+            decode->has_webauthn_sig = has_webauthn_sig( *decode->block );
+            const auto decode_time = fc::time_point::now() - decode_start;
+            c->metrics.block_decoded( decode_time );
+            my_impl->metrics.block_decoded( decode_time );
+         } catch( const fc::exception& e ) {
+            decode->error = e.to_detail_string();
+         } catch( const std::exception& e ) {
+            decode->error = e.what();
+         } catch( ... ) {
+            decode->error = "unknown exception";
+         }
+         decode->ready = true;
+         c->strand.post( [c]() {
+            c->deliver_decoded_blocks();
+         });
+      });
+      return true;
+   }
+
+   template<typename Stream>
+   signed_block_ptr connection::unpack_block( uint32_t which, Stream& ds ) {
       shared_ptr<signed_block> ptr;
       if( which == signed_block_which ) {
          ptr = std::make_shared<signed_block>();
@@ -2707,27 +3351,45 @@ namespace eosio {
          fc::raw::unpack( ds, sb_v0 );
          ptr = std::make_shared<signed_block>( std::move( sb_v0 ), true );
       }
+      return ptr;
+   }
 
+   bool connection::has_webauthn_sig( const signed_block& b ) {
       auto is_webauthn_sig = []( const fc::crypto::signature& s ) {
          return s.which() == fc::get_index<fc::crypto::signature::storage_type, fc::crypto::webauthn::signature>();
       };
-      bool has_webauthn_sig = is_webauthn_sig( ptr->producer_signature );
+      bool has_webauthn_sig = is_webauthn_sig( b.producer_signature );
 
       constexpr auto additional_sigs_eid = additional_block_signatures_extension::extension_id();
-      auto exts = ptr->validate_and_extract_extensions();
+      auto exts = b.validate_and_extract_extensions();
       if( exts.count( additional_sigs_eid ) ) {
          const auto &additional_sigs = std::get<additional_block_signatures_extension>(exts.lower_bound( additional_sigs_eid )->second).signatures;
          has_webauthn_sig |= std::any_of( additional_sigs.begin(), additional_sigs.end(), is_webauthn_sig );
       }
+      return has_webauthn_sig;
+   }
 
-      if( has_webauthn_sig ) {
-         fc_dlog( logger, "WebAuthn signed block received from ${p}, closing connection", ("p", peer_name()));
-         close();
-         return false;
+   // called from connection strand
+   void connection::deliver_decoded_blocks() {
+      // only the front is delivered so blocks from this peer reach the main thread in the order they were received
+      while( !pending_block_decodes.empty() && pending_block_decodes.front()->ready ) {
+         auto decode = std::move( pending_block_decodes.front() );
+         pending_block_decodes.pop_front();
+
+         if( decode->error ) {
+            fc_elog( logger, "Exception in handling message from ${p}: ${s}", ("p", peer_name())("s", *decode->error) );
+            pending_block_decodes.clear();
+            close();
+            return;
+         }
+         if( decode->has_webauthn_sig ) {
+            fc_dlog( logger, "WebAuthn signed block received from ${p}, closing connection", ("p", peer_name()));
+            pending_block_decodes.clear();
+            close();
+            return;
+         }
+         handle_message( decode->id, std::move( decode->block ) );
       }
-
-      handle_message( blk_id, std::move( ptr ) );
-      return true;
    }
 
    // called from connection strand
@@ -2799,7 +3461,7 @@ namespace eosio {
          node_transaction_state nts = {pt_v0.id(), pt_v0.expiration(), 0, connection_id};
          my_impl->dispatcher->add_peer_txn( nts );
          if ( !have_trx ) {
-            ptr = std::make_shared<packed_transaction>( pt_v0, true );
+            ptr = std::make_shared<packed_transaction>( std::move( pt_v0 ), true );
          }
       }
 
@@ -2812,6 +3474,11 @@ namespace eosio {
       return true;
    }
 
+   // thread safe
+   std::optional<double> net_plugin_impl::trx_admission_cost() const {
+      return eosio::trx_admission_cost( trxs_in_progress.load( std::memory_order_relaxed ), trx_admission_queue_depth );
+   }
+
    // call only from main application thread
    void net_plugin_impl::update_chain_info() {
       controller& cc = chain_plug->chain();
@@ -3056,6 +3723,7 @@ namespace eosio {
 
       double offset = (double(rec - org) + double(msg.xmt - dst)) / 2;
       double NsecPerUsec{1000};
+      sync_stats.round_trip( fc::microseconds( ((dst - org) - (msg.xmt - rec)) / 1000 ) );
 
       if( logger.is_enabled( fc::log_level::all ) )
          logger.log( FC_LOG_MESSAGE( all, "Clock offset is ${o}ns (${us}us)",
@@ -3161,14 +3829,22 @@ namespace eosio {
          if( msg.req_blocks.mode == none ) {
             stop_send();
          }
-         // no break
-      case normal :
          if( !msg.req_trx.ids.empty() ) {
             fc_elog( logger, "Invalid request_message, req_trx.ids.size ${s}", ("s", msg.req_trx.ids.size()) );
             close();
             return;
          }
          break;
+      case normal :
+         if( !msg.req_trx.ids.empty() ) {
+            if( protocol_version < proto_trx_inventory ) {
+               fc_elog( logger, "Invalid request_message, req_trx.ids.size ${s}", ("s", msg.req_trx.ids.size()) );
+               close();
+               return;
+            }
+            send_requested_trxs( msg.req_trx.ids );
+         }
+         break;
       default:;
       }
    }
@@ -3192,18 +3868,163 @@ namespace eosio {
       }
    }
 
+   // called from connection strand
+   void connection::handle_message( const compact_block_message& msg ) {
+      EOS_ASSERT( msg.block, plugin_exception, "compact_block_message without block" );
+      signed_block_ptr ptr = msg.block;
+      const block_id_type blk_id = ptr->calculate_id();
+      const uint32_t blk_num = ptr->block_num();
+      peer_dlog( this, "received compact block ${num}, omitted ${o} of ${t} trxs",
+                 ("num", blk_num)("o", msg.omitted.size())("t", ptr->transactions.size()) );
+      if( my_impl->dispatcher->have_block( blk_id ) ) {
+         my_impl->sync_master->sync_recv_block( shared_from_this(), blk_id, blk_num, false );
+         cancel_wait();
+         return;
+      }
+
+      auto request_block = [&]() {
+         request_message req;
+         req.req_blocks.mode = normal;
+         req.req_blocks.ids.push_back( blk_id );
+         {
+            std::lock_guard<std::mutex> g_conn( conn_mtx );
+            last_req = req;
+         }
+         enqueue( req );
+      };
+
+      for( uint32_t i : msg.omitted ) {
+         EOS_ASSERT( i < ptr->transactions.size() && std::holds_alternative<transaction_id_type>( ptr->transactions[i].trx ),
+                     plugin_exception, "invalid compact block omitted receipt ${i}", ("i", i) );
+         auto& receipt = ptr->transactions[i];
+         packed_transaction_ptr trx = my_impl->dispatcher->get_announced_txn( std::get<transaction_id_type>( receipt.trx ) );
+         if( !trx ) {
+            // missing a trx of the block, fetch the complete block instead
+            peer_dlog( this, "missing trx ${id} of compact block ${num}, requesting block",
+                       ("id", std::get<transaction_id_type>( receipt.trx ))("num", blk_num) );
+            request_block();
+            return;
+         }
+         receipt.trx.emplace<packed_transaction>( *trx );
+      }
+
+      if( !msg.omitted.empty() ) {
+         // a local trx with the id of an omitted one may differ in signatures, context free data or compression
+         deque<digest_type> trx_digests;
+         for( const auto& receipt : ptr->transactions )
+            trx_digests.emplace_back( receipt.digest() );
+         if( merkle( std::move( trx_digests ) ) != ptr->transaction_mroot ) {
+            peer_dlog( this, "rebuilt compact block ${num} does not match its transaction_mroot, requesting block", ("num", blk_num) );
+            request_block();
+            return;
+         }
+      }
+
+      handle_unpacked_block( blk_id, std::move( ptr ) );
+   }
+
+   /// limits decompressed size to the largest message accepted from a peer
+   struct decompress_limiter {
+      using char_type = char;
+      using category = boost::iostreams::multichar_output_filter_tag;
+
+      template<typename Sink>
+      std::streamsize write( Sink& sink, const char* s, std::streamsize count ) {
+         EOS_ASSERT( total + count <= def_send_buffer_size*2, plugin_exception, "Exceeded maximum decompressed message size" );
+         total += count;
+         return boost::iostreams::write( sink, s, count );
+      }
+
+      std::streamsize total = 0;
+   };
+
+   // called from connection strand
+   void connection::handle_message( const compressed_block_message& msg ) {
+      namespace bio = boost::iostreams;
+      bytes data;
+      try {
+         bio::filtering_ostream decomp;
+         decomp.push( bio::zlib_decompressor() );
+         decomp.push( decompress_limiter() );
+         decomp.push( bio::back_inserter( data ) );
+         bio::write( decomp, msg.data.data(), msg.data.size() );
+         bio::close( decomp );
+      } catch( const fc::exception& ) {
+         throw;
+      } catch( ... ) {
+         EOS_THROW( plugin_exception, "unable to decompress compressed_block_message" );
+      }
+
+      fc::datastream<const char*> ds( data.data(), data.size() );
+      unsigned_int which{};
+      fc::raw::unpack( ds, which );
+      EOS_ASSERT( which == signed_block_which || which == signed_block_v0_which, plugin_exception,
+                  "compressed_block_message holds message ${w} rather than a block", ("w", which.value) );
+      signed_block_ptr ptr = unpack_block( which, ds );
+      const block_id_type blk_id = ptr->calculate_id();
+      const uint32_t blk_num = ptr->block_num();
+      peer_dlog( this, "received compressed block ${num}, ${c} of ${s} bytes",
+                 ("num", blk_num)("c", msg.data.size())("s", data.size()) );
+      if( my_impl->dispatcher->have_block( blk_id ) ) {
+         my_impl->sync_master->sync_recv_block( shared_from_this(), blk_id, blk_num, false );
+         cancel_wait();
+         return;
+      }
+      handle_unpacked_block( blk_id, std::move( ptr ) );
+   }
+
+   // called from connection strand
+   void connection::handle_unpacked_block( const block_id_type& id, signed_block_ptr ptr ) {
+      if( has_webauthn_sig( *ptr ) ) {
+         fc_dlog( logger, "WebAuthn signed block received from ${p}, closing connection", ("p", peer_name()));
+         close();
+         return;
+      }
+      handle_message( id, std::move( ptr ) );
+   }
+
    size_t calc_trx_size( const packed_transaction_ptr& trx ) {
       return trx->get_estimated_size();
    }
 
+   /**
+    * Counts a transaction received from a connection as in progress until the callback of accept_transaction holding
+    * it is destroyed.  The callback is not always called: the unapplied transaction queue replaces the callback of a
+    * transaction received again while it is queued.
+    */
+   class trx_in_progress_tracker {
+   public:
+      trx_in_progress_tracker( const connection_ptr& c, size_t trx_size )
+      : impl( my_impl->shared_from_this() ), conn( c ), trx_size( trx_size ) {
+         c->trx_in_progress_size += trx_size;
+         ++my_impl->trxs_in_progress;
+      }
+
+      ~trx_in_progress_tracker() {
+         // the plugin may be gone when the unapplied transaction queue is destroyed
+         if( auto i = impl.lock() )
+            --i->trxs_in_progress;
+         if( auto c = conn.lock() )
+            c->trx_in_progress_size -= trx_size;
+      }
+
+      trx_in_progress_tracker( const trx_in_progress_tracker& ) = delete;
+      trx_in_progress_tracker& operator=( const trx_in_progress_tracker& ) = delete;
+
+   private:
+      std::weak_ptr<net_plugin_impl>  impl;
+      std::weak_ptr<connection>       conn;
+      const size_t                    trx_size;
+   };
+
    void connection::handle_message( packed_transaction_ptr trx ) {
       const auto& tid = trx->id();
       peer_dlog( this, "received packed_transaction ${id}", ("id", tid) );
 
-      trx_in_progress_size += calc_trx_size( trx );
-      app().post( priority::low, [trx{std::move(trx)}, weak = weak_from_this()]() {
+      auto in_progress = std::make_shared<trx_in_progress_tracker>( shared_from_this(), calc_trx_size( trx ) );
+      app().post( priority::low, [trx{std::move(trx)}, in_progress{std::move(in_progress)}]() mutable {
          my_impl->chain_plug->accept_transaction( trx,
-            [weak, trx](const std::variant<fc::exception_ptr, transaction_trace_ptr>& result) mutable {
+            [in_progress{std::move(in_progress)}](const std::variant<fc::exception_ptr, transaction_trace_ptr>& result) mutable {
          // next (this lambda) called from application thread
          if (std::holds_alternative<fc::exception_ptr>(result)) {
             fc_dlog( logger, "bad packed_transaction : ${m}", ("m", std::get<fc::exception_ptr>(result)->what()) );
@@ -3215,10 +4036,7 @@ namespace eosio {
                fc_elog( logger, "bad packed_transaction : ${m}", ("m", trace->except->what()));
             }
          }
-         connection_ptr conn = weak.lock();
-         if( conn ) {
-            conn->trx_in_progress_size -= calc_trx_size( trx );
-         }
+         in_progress.reset();
         });
       });
    }
@@ -3234,6 +4052,8 @@ namespace eosio {
             return;
          }
       }
+      // overlap signature recovery with the application of the blocks queued ahead of this one
+      my_impl->chain_plug->chain().prepare_block( id, ptr );
       app().post(priority::medium, [ptr{std::move(ptr)}, id, c = shared_from_this()]() mutable {
          c->process_signed_block( id, std::move( ptr ) );
       });
@@ -3270,7 +4090,11 @@ namespace eosio {
 
       go_away_reason reason = fatal_other;
       try {
+         const auto apply_start = fc::time_point::now();
          bool accepted = my_impl->chain_plug->accept_block(msg, blk_id);
+         const auto apply_time = fc::time_point::now() - apply_start;
+         c->metrics.block_applied( apply_time );
+         my_impl->metrics.block_applied( apply_time );
          my_impl->update_chain_info();
          if( !accepted ) return;
          reason = no_reason;
@@ -3404,6 +4228,7 @@ namespace eosio {
       while (it != connections.end()) {
          if (fc::time_point::now() >= max_time) {
             connection_wptr wit = *it;
+            if( num_rm > 0 ) update_connections_snapshot();
             g.unlock();
             fc_dlog( logger, "Exiting connection monitor early, ran out of time: ${t}", ("t", max_time - fc::time_point::now()) );
             if( reschedule ) {
@@ -3427,6 +4252,7 @@ namespace eosio {
          }
          ++it;
       }
+      if( num_rm > 0 ) update_connections_snapshot();
       g.unlock();
       if( num_clients > 0 || num_peers > 0 )
          fc_ilog( logger, "p2p client connections: ${num}/${max}, peer connections: ${pnum}/${pmax}",
@@ -3639,6 +4465,16 @@ namespace eosio {
          ( "p2p-max-nodes-per-host", bpo::value<int>()->default_value(def_max_nodes_per_host), "Maximum number of client nodes from any single IP address")
          ( "p2p-accept-transactions", bpo::value<bool>()->default_value(true), "Allow transactions received over p2p network to be evaluated and relayed if valid.")
          ( "p2p-reject-incomplete-blocks", bpo::value<bool>()->default_value(true), "Reject pruned signed_blocks even in light validation")
+         ( "p2p-max-trx-per-sec-per-peer", bpo::value<uint32_t>()->default_value(def_max_trx_per_sec_per_peer),
+           "Maximum rate of transactions accepted from each peer, the transactions over it are dropped before they are deserialized. 0 for unlimited.")
+         ( "p2p-max-trx-burst-per-peer", bpo::value<uint32_t>(),
+           "Transactions accepted at once from a peer which has been idle. Defaults to twice p2p-max-trx-per-sec-per-peer.")
+         ( "p2p-max-blocks-per-sec-per-peer", bpo::value<uint32_t>()->default_value(def_max_blocks_per_sec_per_peer),
+           "Maximum rate of blocks accepted from each peer while not syncing, the blocks over it are dropped before they are deserialized. 0 for unlimited.")
+         ( "p2p-max-blocks-burst-per-peer", bpo::value<uint32_t>(),
+           "Blocks accepted at once from a peer which has been idle. Defaults to twice p2p-max-blocks-per-sec-per-peer.")
+         ( "p2p-trx-admission-queue-depth", bpo::value<uint32_t>()->default_value(def_trx_admission_queue_depth),
+           "Transactions from peers waiting for the main thread at which new ones are dropped. Past half of it the rate allowed to each peer is reduced in proportion. 0 for unlimited.")
          ( "agent-name", bpo::value<string>()->default_value("EOS Test Agent"), "The name supplied to identify this node amongst the peers.")
          ( "allowed-connection", bpo::value<vector<string>>()->multitoken()->default_value({"any"}, "any"), "Can be 'any' or 'producers' or 'specified' or 'none'. If 'specified', peer-key must be specified at least once. If only 'producers', peer-key is not required. 'producers' and 'specified' may be combined.")
          ( "peer-key", bpo::value<vector<string>>()->composing()->multitoken(), "Optional public key of peer allowed to connect.  May be used multiple times.")
@@ -3649,8 +4485,13 @@ namespace eosio {
          ( "max-cleanup-time-msec", bpo::value<int>()->default_value(10), "max connection cleanup time per cleanup call in millisec")
          ( "net-threads", bpo::value<uint16_t>()->default_value(my->thread_pool_size),
            "Number of worker threads in net_plugin thread pool" )
+         ( "net-threads-cpus", bpo::value<string>(),
+           "CPUs the net_plugin thread pools are pinned to, e.g. \"2-5,8\". By default the threads inherit the affinity of the main thread." )
+         ( "net-decode-threads", bpo::value<uint16_t>()->default_value(my->decode_thread_pool_size),
+           "Number of worker threads in net_plugin thread pool used to deserialize received blocks, 0 to deserialize on the connection's net thread" )
          ( "sync-fetch-span", bpo::value<uint32_t>()->default_value(def_sync_fetch_span), "number of blocks to retrieve in a chunk from any individual peer during synchronization")
          ( "use-socket-read-watermark", bpo::value<bool>()->default_value(false), "Enable experimental socket read watermark optimization")
+         ( "p2p-compress-blocks", bpo::value<bool>()->default_value(false), "Compress blocks sent to peers that support compressed block messages")
          ( "peer-log-format", bpo::value<string>()->default_value( "[\"${_name}\" ${_ip}:${_port}]" ),
            "The string used to format peers when logging messages about them.  Variables are escaped with ${<variable name>}.\n"
            "Available Variables:\n"
@@ -3686,8 +4527,16 @@ namespace eosio {
          my->max_nodes_per_host = options.at( "p2p-max-nodes-per-host" ).as<int>();
          my->p2p_accept_transactions = options.at( "p2p-accept-transactions" ).as<bool>();
          my->p2p_reject_incomplete_blocks = options.at("p2p-reject-incomplete-blocks").as<bool>();
+         my->max_trx_per_sec_per_peer = options.at( "p2p-max-trx-per-sec-per-peer" ).as<uint32_t>();
+         my->max_trx_burst_per_peer = options.count( "p2p-max-trx-burst-per-peer" ) ?
+                                        options.at( "p2p-max-trx-burst-per-peer" ).as<uint32_t>() : 2 * my->max_trx_per_sec_per_peer;
+         my->max_blocks_per_sec_per_peer = options.at( "p2p-max-blocks-per-sec-per-peer" ).as<uint32_t>();
+         my->max_blocks_burst_per_peer = options.count( "p2p-max-blocks-burst-per-peer" ) ?
+                                           options.at( "p2p-max-blocks-burst-per-peer" ).as<uint32_t>() : 2 * my->max_blocks_per_sec_per_peer;
+         my->trx_admission_queue_depth = options.at( "p2p-trx-admission-queue-depth" ).as<uint32_t>();
 
          my->use_socket_read_watermark = options.at( "use-socket-read-watermark" ).as<bool>();
+         my->p2p_compress_blocks = options.at( "p2p-compress-blocks" ).as<bool>();
          my->keepalive_interval = std::chrono::milliseconds( options.at( "p2p-keepalive-interval-ms" ).as<int>() );
          EOS_ASSERT( my->keepalive_interval.count() > 0, chain::plugin_config_exception,
                      "p2p-keepalive_interval-ms must be greater than 0" );
@@ -3710,6 +4559,9 @@ namespace eosio {
          my->thread_pool_size = options.at( "net-threads" ).as<uint16_t>();
          EOS_ASSERT( my->thread_pool_size > 0, chain::plugin_config_exception,
                      "net-threads ${num} must be greater than 0", ("num", my->thread_pool_size) );
+         my->decode_thread_pool_size = options.at( "net-decode-threads" ).as<uint16_t>();
+         if( options.count( "net-threads-cpus" ))
+            my->thread_pool_cpus = chain::parse_cpu_list( options.at( "net-threads-cpus" ).as<string>() );
 
          if( options.count( "p2p-peer-address" )) {
             my->supplied_peers = options.at( "p2p-peer-address" ).as<vector<string> >();
@@ -3783,7 +4635,10 @@ namespace eosio {
 
       my->producer_plug = app().find_plugin<producer_plugin>();
 
-      my->thread_pool.emplace( "net", my->thread_pool_size );
+      my->thread_pool.emplace( "net", my->thread_pool_size, my->thread_pool_cpus );
+      if( my->decode_thread_pool_size > 0 ) {
+         my->decode_thread_pool.emplace( "netd", my->decode_thread_pool_size, my->thread_pool_cpus );
+      }
 
       my->dispatcher.reset( new dispatch_manager( my_impl->thread_pool->get_executor() ) );
 
@@ -3903,8 +4758,12 @@ namespace eosio {
                con->close( false, true );
             }
             my->connections.clear();
+            my->update_connections_snapshot();
          }
 
+         if( my->decode_thread_pool ) {
+            my->decode_thread_pool->stop();
+         }
          if( my->thread_pool ) {
             my->thread_pool->stop();
          }
@@ -3935,6 +4794,7 @@ namespace eosio {
          fc_dlog( logger, "adding new connection to the list: ${c}", ("c", c->peer_name()) );
          c->set_heartbeat_timeout( my->heartbeat_timeout );
          my->connections.insert( c );
+         my->update_connections_snapshot();
       }
       return "added connection";
    }
@@ -3946,6 +4806,7 @@ namespace eosio {
             fc_ilog( logger, "disconnecting: ${p}", ("p", (*itr)->peer_name()) );
             (*itr)->close();
             my->connections.erase(itr);
+            my->update_connections_snapshot();
             return "connection removed";
          }
       }
@@ -3970,6 +4831,31 @@ namespace eosio {
       return result;
    }
 
+   net_metrics net_plugin::metrics()const {
+      net_metrics result;
+      result.messages = my->metrics.message_counters();
+      result.block_decode_latency = my->metrics.decode_latency();
+      result.block_apply_latency = my->metrics.apply_latency();
+      const auto connections = std::atomic_load( &my->connections_snapshot );
+      result.connections.reserve( connections->size() );
+      for( const auto& c : *connections ) {
+         connection_metrics cm;
+         cm.peer = c->peer_name();
+         cm.write_queue_bytes = c->buffer_queue.write_queue_size();
+         cm.messages = c->metrics.message_counters();
+         cm.block_decode_latency = c->metrics.decode_latency();
+         cm.block_apply_latency = c->metrics.apply_latency();
+         result.connections.emplace_back( std::move( cm ) );
+      }
+      return result;
+   }
+
+   // call with connections_mtx held exclusively
+   void net_plugin_impl::update_connections_snapshot() {
+      std::atomic_store( &connections_snapshot,
+                         std::shared_ptr<const vector<connection_ptr>>( std::make_shared<const vector<connection_ptr>>( connections.begin(), connections.end() ) ) );
+   }
+
    // call with connections_mtx
    connection_ptr net_plugin_impl::find_connection( const string& host )const {
       for( const auto& c : connections )
@@ -0,0 +1,106 @@
+#define BOOST_TEST_MODULE token_bucket
+#include <boost/test/included/unit_test.hpp>
+
+#include <eosio/net_plugin/token_bucket.hpp>
+
+using namespace eosio;
+
+BOOST_AUTO_TEST_SUITE(token_bucket_tests)
+
+BOOST_AUTO_TEST_CASE(unlimited) {
+   token_bucket b;
+   const auto now = fc::time_point::now();
+   b.configure( 0, 1, now );
+   BOOST_CHECK( b.unlimited() );
+   for( int i = 0; i < 1000; ++i )
+      BOOST_CHECK( b.consume( now, 100 ) );
+}
+
+BOOST_AUTO_TEST_CASE(burst_then_refill) {
+   token_bucket b;
+   const auto start = fc::time_point::now();
+   b.configure( 10, 5, start );
+
+   // a burst is accepted at once, then the messages over it are dropped
+   for( int i = 0; i < 5; ++i )
+      BOOST_CHECK( b.consume( start ) );
+   BOOST_CHECK( !b.consume( start ) );
+
+   // 10 per second: one token every 100ms
+   BOOST_CHECK( !b.consume( start + fc::milliseconds( 50 ) ) );
+   BOOST_CHECK( b.consume( start + fc::milliseconds( 100 ) ) );
+   BOOST_CHECK( !b.consume( start + fc::milliseconds( 100 ) ) );
+
+   // the tokens of an idle period are capped at the burst
+   const auto later = start + fc::seconds( 60 );
+   for( int i = 0; i < 5; ++i )
+      BOOST_CHECK( b.consume( later ) );
+   BOOST_CHECK( !b.consume( later ) );
+}
+
+BOOST_AUTO_TEST_CASE(burst_of_at_least_one) {
+   token_bucket b;
+   const auto now = fc::time_point::now();
+   b.configure( 1, 0, now );
+   BOOST_CHECK( b.consume( now ) );
+   BOOST_CHECK( !b.consume( now ) );
+}
+
+BOOST_AUTO_TEST_CASE(cost) {
+   token_bucket b;
+   const auto now = fc::time_point::now();
+   b.configure( 10, 4, now );
+   BOOST_CHECK( b.consume( now, 3 ) );
+   BOOST_CHECK( !b.consume( now, 2 ) );
+   BOOST_CHECK( b.consume( now, 1 ) );
+
+   // a cost over the burst takes the whole burst instead of never being accepted
+   b.configure( 10, 4, now );
+   BOOST_CHECK( b.consume( now, 10 ) );
+   BOOST_CHECK( !b.consume( now ) );
+}
+
+BOOST_AUTO_TEST_CASE(admission_cost) {
+   // 0 depth admits everything at the normal cost
+   BOOST_REQUIRE( trx_admission_cost( 1'000'000, 0 ) );
+   BOOST_CHECK_EQUAL( *trx_admission_cost( 1'000'000, 0 ), 1.0 );
+
+   // admitted at the normal cost up to half of the depth
+   BOOST_REQUIRE( trx_admission_cost( 0, 100 ) );
+   BOOST_CHECK_EQUAL( *trx_admission_cost( 0, 100 ), 1.0 );
+   BOOST_REQUIRE( trx_admission_cost( 50, 100 ) );
+   BOOST_CHECK_EQUAL( *trx_admission_cost( 50, 100 ), 1.0 );
+
+   // scaled past half of it
+   BOOST_REQUIRE( trx_admission_cost( 75, 100 ) );
+   BOOST_CHECK_EQUAL( *trx_admission_cost( 75, 100 ), 1.5 );
+   BOOST_REQUIRE( trx_admission_cost( 99, 100 ) );
+   BOOST_CHECK_CLOSE( *trx_admission_cost( 99, 100 ), 1.98, 0.001 );
+
+   // dropped at the depth
+   BOOST_CHECK( !trx_admission_cost( 100, 100 ) );
+   BOOST_CHECK( !trx_admission_cost( 150, 100 ) );
+}
+
+// a scaled cost lowers the rate a peer is allowed
+BOOST_AUTO_TEST_CASE(scaled_rate) {
+   token_bucket b;
+   const auto start = fc::time_point::now();
+   b.configure( 10, 10, start );
+   const auto cost = trx_admission_cost( 100, 200 );   // half of the depth: not scaled
+   BOOST_REQUIRE( cost );
+   int admitted = 0;
+   while( b.consume( start, *cost ) )
+      ++admitted;
+   BOOST_CHECK_EQUAL( admitted, 10 );
+
+   b.configure( 10, 10, start );
+   const auto scaled = trx_admission_cost( 150, 200 );   // 1.5 tokens each
+   BOOST_REQUIRE( scaled );
+   admitted = 0;
+   while( b.consume( start, *scaled ) )
+      ++admitted;
+   BOOST_CHECK_EQUAL( admitted, 6 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
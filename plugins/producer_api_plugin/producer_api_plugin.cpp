@@ -95,6 +95,12 @@ void producer_api_plugin::plugin_startup() {
             INVOKE_V_V(producer, resume), 201),
        CALL_WITH_400(producer, producer, paused,
             INVOKE_R_V(producer, paused), 201),
+       CALL_WITH_400(producer, producer, standby,
+            INVOKE_V_V(producer, standby), 201),
+       CALL_WITH_400(producer, producer, promote,
+            INVOKE_V_V(producer, promote), 201),
+       CALL_WITH_400(producer, producer, is_standby,
+            INVOKE_R_V(producer, is_standby), 201),
        CALL_WITH_400(producer, producer, get_runtime_options,
             INVOKE_R_V(producer, get_runtime_options), 201),
        CALL_WITH_400(producer, producer, update_runtime_options,
@@ -122,6 +128,8 @@ void producer_api_plugin::plugin_startup() {
                                  producer_plugin::get_supported_protocol_features_params), 201),
        CALL_WITH_400(producer, producer, get_account_ram_corrections,
             INVOKE_R_R(producer, get_account_ram_corrections, producer_plugin::get_account_ram_corrections_params), 201),
+       CALL_WITH_400(producer, producer, get_action_profile,
+            INVOKE_R_R_II(producer, get_action_profile, producer_plugin::get_action_profile_params), 201),
    }, appbase::priority::medium_high);
 }
 
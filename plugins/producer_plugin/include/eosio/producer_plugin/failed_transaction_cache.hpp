@@ -0,0 +1,109 @@
+#pragma once
+
+#include <eosio/chain/types.hpp>
+
+#include <fc/exception/exception.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+
+namespace eosio {
+
+namespace bmi = boost::multi_index;
+using chain::transaction_id_type;
+using chain::block_id_type;
+
+/**
+ * State a transaction was executed against. The pending block only changes when a transaction is applied to it,
+ * so a deterministic failure repeats as long as the head block, the pending block time and the number of
+ * transactions in the pending block are unchanged.
+ */
+struct trx_state_version {
+   block_id_type    head_id;
+   fc::time_point   pending_block_time;
+   size_t           pending_trx_count = 0;
+
+   friend bool operator==( const trx_state_version& a, const trx_state_version& b ) {
+      return a.pending_trx_count == b.pending_trx_count && a.pending_block_time == b.pending_block_time && a.head_id == b.head_id;
+   }
+   friend bool operator!=( const trx_state_version& a, const trx_state_version& b ) { return !(a == b); }
+};
+
+/**
+ * Remembers transactions that failed deterministically so the same transaction received again, from another peer
+ * or resubmitted through the API, is rejected without being executed again until the state it ran against changes.
+ */
+class failed_transaction_cache {
+private:
+
+   struct failed_trx {
+      transaction_id_type     trx_id;
+      fc::time_point          expiry;
+      trx_state_version       version;
+      fc::exception_ptr       except;
+   };
+   struct by_id;
+   struct by_expiry;
+
+   using failed_trx_index = bmi::multi_index_container<
+         failed_trx,
+         bmi::indexed_by<
+               bmi::hashed_unique<bmi::tag<by_id>, BOOST_MULTI_INDEX_MEMBER( failed_trx, transaction_id_type, trx_id ) >,
+               bmi::ordered_non_unique<bmi::tag<by_expiry>, BOOST_MULTI_INDEX_MEMBER( failed_trx, fc::time_point, expiry ) >
+         >
+   >;
+
+   failed_trx_index   _failed_trxs;
+   size_t             _max_size = 10'000;
+
+public:
+   /// 0 disables the cache
+   void set_max_size( size_t v ) { _max_size = v; }
+   bool is_disabled() const { return _max_size == 0; }
+
+   size_t size() const { return _failed_trxs.size(); }
+   void clear() { _failed_trxs.clear(); }
+
+   void add( const transaction_id_type& id, const fc::time_point& expiry, const trx_state_version& version,
+             const fc::exception_ptr& except ) {
+      if( is_disabled() ) return;
+      auto& idx = _failed_trxs.get<by_id>();
+      auto itr = idx.find( id );
+      if( itr != idx.end() ) {
+         idx.modify( itr, [&]( auto& f ) {
+            f.version = version;
+            f.except = except;
+         } );
+         return;
+      }
+      if( _failed_trxs.size() >= _max_size ) {
+         auto& exp_idx = _failed_trxs.get<by_expiry>();
+         exp_idx.erase( exp_idx.begin() );
+      }
+      _failed_trxs.insert( failed_trx{ id, expiry, version, except } );
+   }
+
+   /// @return failure of trx if it failed against the same state version, otherwise nullptr
+   fc::exception_ptr get( const transaction_id_type& id, const trx_state_version& version ) {
+      auto& idx = _failed_trxs.get<by_id>();
+      auto itr = idx.find( id );
+      if( itr == idx.end() ) return {};
+      if( itr->version != version ) {
+         // state changed since, trx might succeed now
+         idx.erase( itr );
+         return {};
+      }
+      return itr->except;
+   }
+
+   void remove_expired( const fc::time_point& pending_block_time ) {
+      auto& idx = _failed_trxs.get<by_expiry>();
+      while( !idx.empty() && idx.begin()->expiry <= pending_block_time ) {
+         idx.erase( idx.begin() );
+      }
+   }
+};
+
+} //eosio
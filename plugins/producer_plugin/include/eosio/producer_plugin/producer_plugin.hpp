@@ -71,6 +71,25 @@ public:
       std::optional<account_name>  more;
    };
 
+   struct get_action_profile_params {
+      uint32_t limit = 50;
+      bool     reset = false; ///< start a new profile after returning this one
+   };
+
+   struct action_profile_entry {
+      account_name receiver;
+      account_name account;
+      action_name  action;
+      uint64_t     count = 0;
+      int64_t      total_us = 0;
+      int64_t      max_us = 0;
+   };
+
+   struct get_action_profile_result {
+      fc::time_point                     since;
+      std::vector<action_profile_entry>  actions; ///< ordered by total_us, highest first
+   };
+
    template<typename T>
    using next_function = std::function<void(const std::variant<fc::exception_ptr, T>&)>;
 
@@ -93,6 +112,10 @@ public:
    void pause();
    void resume();
    bool paused() const;
+   /// keep executing transactions as a producer would, without producing, until promote()
+   void standby();
+   void promote();
+   bool is_standby() const;
    void update_runtime_options(const runtime_options& options);
    runtime_options get_runtime_options() const;
 
@@ -113,6 +136,12 @@ public:
 
    get_account_ram_corrections_result  get_account_ram_corrections( const get_account_ram_corrections_params& params ) const;
 
+   /// time spent executing actions since the profile was started, requires action-profile
+   get_action_profile_result get_action_profile( const get_action_profile_params& params );
+
+   /// memory of the queue of unapplied transactions and of the caches of transactions, call on the main thread
+   std::vector<chain::subsystem_memory> get_memory_usage() const;
+
    void log_failed_transaction(const transaction_id_type& trx_id, const char* reason) const;
 
  private:
@@ -130,3 +159,6 @@ FC_REFLECT(eosio::producer_plugin::scheduled_protocol_feature_activations, (prot
 FC_REFLECT(eosio::producer_plugin::get_supported_protocol_features_params, (exclude_disabled)(exclude_unactivatable))
 FC_REFLECT(eosio::producer_plugin::get_account_ram_corrections_params, (lower_bound)(upper_bound)(limit)(reverse))
 FC_REFLECT(eosio::producer_plugin::get_account_ram_corrections_result, (rows)(more))
+FC_REFLECT(eosio::producer_plugin::get_action_profile_params, (limit)(reset))
+FC_REFLECT(eosio::producer_plugin::action_profile_entry, (receiver)(account)(action)(count)(total_us)(max_us))
+FC_REFLECT(eosio::producer_plugin::get_action_profile_result, (since)(actions))
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <eosio/chain/types.hpp>
+#include <eosio/chain/config.hpp>
+#include <eosio/chain/block_timestamp.hpp>
+
+#include <algorithm>
+
+namespace eosio {
+
+using chain::block_id_type;
+using chain::block_timestamp_type;
+
+/**
+ * Adapts how early before its block time a block is produced.
+ *
+ * Blocks that are not the last of a round only need to leave time to finalize and sign, measured from our own
+ * produced blocks. The last block of a round must also reach and be applied by the next producer before it starts
+ * its first block. Its margin starts at the configured offset and is adjusted additive-increase/multiplicative-
+ * decrease style from what the next producer does: building on our last block shrinks the margin by a step,
+ * dropping it doubles the margin. The margin never goes below the measured produce plus apply time.
+ */
+class production_window {
+public:
+   static constexpr uint32_t min_samples = 12;
+   static constexpr int64_t  safety_margin_us = 10'000;
+   static constexpr int64_t  margin_step_us = 10'000;
+   static constexpr int64_t  max_margin_us = chain::config::block_interval_us / 2;
+
+   /// last block margin starts from the configured offset
+   void set_configured_last_block_offset_us( int32_t offset_us ) {
+      last_block_margin_us = std::clamp<int64_t>( -int64_t(offset_us), safety_margin_us, max_margin_us );
+   }
+
+   /// @param produce_time time to finalize, sign and commit a block we produced
+   /// @param last_in_round true if block is the last of our round
+   void block_produced( const block_id_type& id, block_timestamp_type timestamp, bool last_in_round,
+                        const fc::microseconds& produce_time ) {
+      produce_us.add( produce_time.count() );
+      if( last_in_round ) {
+         last_block_id = id;
+         last_block_timestamp = timestamp;
+         awaiting_next_producer = true;
+      }
+   }
+
+   /// @param apply_time time to apply a block received from another producer
+   void block_applied( const fc::microseconds& apply_time ) {
+      apply_us.add( apply_time.count() );
+   }
+
+   /// called for each block received from another producer
+   void block_received( const block_id_type& previous, block_timestamp_type timestamp ) {
+      if( !awaiting_next_producer || timestamp <= last_block_timestamp ) return;
+      awaiting_next_producer = false;
+      if( previous == last_block_id ) {
+         last_block_margin_us -= margin_step_us;
+      } else {
+         ++dropped_blocks;
+         last_block_margin_us *= 2;
+      }
+      last_block_margin_us = std::clamp( last_block_margin_us, last_block_floor_us(), max_margin_us );
+   }
+
+   /// @return offset from block time to produce a block that is not the last in the round, configured_offset_us
+   ///         until enough blocks have been measured
+   int32_t produce_time_offset_us( int32_t configured_offset_us ) const {
+      if( produce_us.samples < min_samples ) return configured_offset_us;
+      return -static_cast<int32_t>( std::min( produce_floor_us(), max_margin_us ) );
+   }
+
+   /// @return offset from block time to produce last block of the round
+   int32_t last_block_time_offset_us( int32_t configured_offset_us ) const {
+      if( produce_us.samples < min_samples || apply_us.samples < min_samples ) return configured_offset_us;
+      // measured costs may have grown since last adjustment
+      const int64_t margin = std::clamp( last_block_margin_us, last_block_floor_us(), max_margin_us );
+      return -static_cast<int32_t>( margin );
+   }
+
+   uint32_t get_dropped_blocks() const { return dropped_blocks; }
+
+private:
+   struct moving_average {
+      double   value = 0;
+      uint32_t samples = 0;
+
+      void add( double v ) {
+         value = samples == 0 ? v : value + (v - value) / 8;
+         ++samples;
+      }
+   };
+
+   int64_t produce_floor_us() const { return static_cast<int64_t>( produce_us.value ) + safety_margin_us; }
+   int64_t last_block_floor_us() const {
+      return std::min( static_cast<int64_t>( produce_us.value + apply_us.value ) + safety_margin_us, max_margin_us );
+   }
+
+   moving_average         produce_us;
+   moving_average         apply_us;
+   int64_t                last_block_margin_us = max_margin_us;
+   block_id_type          last_block_id;
+   block_timestamp_type   last_block_timestamp;
+   bool                   awaiting_next_producer = false;
+   uint32_t               dropped_blocks = 0;
+};
+
+} //eosio
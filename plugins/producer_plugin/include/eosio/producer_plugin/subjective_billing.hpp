@@ -13,7 +13,10 @@
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 
+#include <array>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace eosio {
 
@@ -24,6 +27,13 @@ using chain::block_state_ptr;
 using chain::packed_transaction;
 namespace config = chain::config;
 
+/**
+ * Tracks subjective CPU billed to accounts for transactions that are not yet in a block.
+ *
+ * Account state is split over shards, each with its own lock, so get_subjective_bill() may be called from any
+ * thread while the main thread bills. The trx cache has a separate lock which is always taken before a shard lock.
+ * disable() and disable_account() must be called before concurrent use.
+ */
 class subjective_billing {
 private:
 
@@ -49,6 +59,11 @@ private:
    struct subjective_billing_info {
       uint64_t              pending_cpu_us;        // tracked cpu us for transactions that may still succeed in a block
       decaying_accumulator  expired_accumulator;   // accumulator used to account for transactions that have expired
+      uint32_t              trx_cpu_estimate_us = 0; // moving average of cpu us per transaction
+
+      void add_trx_cpu( uint32_t bill ) {
+         trx_cpu_estimate_us = trx_cpu_estimate_us == 0 ? bill : (uint64_t(trx_cpu_estimate_us) * 7 + bill) / 8;
+      }
 
       bool empty(uint32_t time_ordinal) {
          return pending_cpu_us == 0 && expired_accumulator.value_at(time_ordinal, expired_accumulator_average_window) == 0;
@@ -58,46 +73,89 @@ private:
    using account_subjective_bill_cache = std::unordered_map<account_name, subjective_billing_info>;
    using block_subjective_bill_cache = std::unordered_map<account_name, uint64_t>;
 
+   struct account_shard {
+      mutable std::mutex                     mtx;
+      account_subjective_bill_cache          account_bills;
+      block_subjective_bill_cache            block_bills;
+   };
+
+   static constexpr uint32_t shard_bits = 4;
+   using account_shards = std::array<account_shard, 1u << shard_bits>;
+
    bool                                      _disabled = false;
+   std::mutex                                _trx_cache_mtx;
    trx_cache_index                           _trx_cache_index;
-   account_subjective_bill_cache             _account_subjective_bill_cache;
-   block_subjective_bill_cache               _block_subjective_bill_cache;
+   account_shards                            _shards;
    std::set<chain::account_name>             _disabled_accounts;
 
 private:
+   static size_t shard_index( const account_name& a ) {
+      // name values have low entropy in their low bits, fibonacci hash picks the high bits
+      return (a.to_uint64_t() * 11400714819323198485ull) >> (64 - shard_bits);
+   }
+
+   account_shard& shard_for( const account_name& a ) { return _shards[shard_index( a )]; }
+   const account_shard& shard_for( const account_name& a ) const { return _shards[shard_index( a )]; }
+
    uint32_t time_ordinal_for( const fc::time_point& t ) const {
       auto ordinal = t.time_since_epoch().count() / (1000U * (uint64_t)subjective_time_interval_ms);
       EOS_ASSERT(ordinal <= std::numeric_limits<uint32_t>::max(), chain::tx_resource_exhaustion, "overflow of quantized time in subjective billing");
       return ordinal;
    }
 
-   void remove_subjective_billing( const trx_cache_entry& entry, uint32_t time_ordinal ) {
-      auto aitr = _account_subjective_bill_cache.find( entry.account );
-      if( aitr != _account_subjective_bill_cache.end() ) {
-         aitr->second.pending_cpu_us -= entry.subjective_cpu_bill;
+   // account_bills of shard locked by caller
+   static void remove_subjective_billing( account_subjective_bill_cache& account_bills, const account_name& account,
+                                          uint32_t bill, uint32_t time_ordinal ) {
+      auto aitr = account_bills.find( account );
+      if( aitr != account_bills.end() ) {
+         aitr->second.pending_cpu_us -= bill;
          EOS_ASSERT( aitr->second.pending_cpu_us >= 0, chain::tx_resource_exhaustion,
-                     "Logic error in subjective account billing ${a}", ("a", entry.account) );
-         if( aitr->second.empty(time_ordinal) ) _account_subjective_bill_cache.erase( aitr );
+                     "Logic error in subjective account billing ${a}", ("a", account) );
+         if( aitr->second.empty(time_ordinal) ) account_bills.erase( aitr );
       }
    }
 
+   void remove_subjective_billing( const trx_cache_entry& entry, uint32_t time_ordinal ) {
+      auto& shard = shard_for( entry.account );
+      std::lock_guard<std::mutex> g( shard.mtx );
+      remove_subjective_billing( shard.account_bills, entry.account, entry.subjective_cpu_bill, time_ordinal );
+   }
+
    void transition_to_expired( const trx_cache_entry& entry, uint32_t time_ordinal ) {
-      auto aitr = _account_subjective_bill_cache.find( entry.account );
-      if( aitr != _account_subjective_bill_cache.end() ) {
+      auto& shard = shard_for( entry.account );
+      std::lock_guard<std::mutex> g( shard.mtx );
+      auto aitr = shard.account_bills.find( entry.account );
+      if( aitr != shard.account_bills.end() ) {
          aitr->second.pending_cpu_us -= entry.subjective_cpu_bill;
          aitr->second.expired_accumulator.add(entry.subjective_cpu_bill, time_ordinal, expired_accumulator_average_window);
       }
    }
 
    void remove_subjective_billing( const block_state_ptr& bsp, uint32_t time_ordinal ) {
-      if( !_trx_cache_index.empty() ) {
+      std::array<std::vector<std::pair<account_name, uint32_t>>, std::tuple_size<account_shards>::value> removed;
+      {
+         std::lock_guard<std::mutex> g( _trx_cache_mtx );
+         if( _trx_cache_index.empty() ) return;
+         auto& idx = _trx_cache_index.get<by_id>();
          for( const auto& receipt : bsp->block->transactions ) {
             if( std::holds_alternative<packed_transaction>(receipt.trx) ) {
                const auto& pt = std::get<packed_transaction>(receipt.trx);
-               remove_subjective_billing( pt.id(), time_ordinal );
+               auto itr = idx.find( pt.id() );
+               if( itr != idx.end() ) {
+                  removed[shard_index( itr->account )].emplace_back( itr->account, itr->subjective_cpu_bill );
+                  idx.erase( itr );
+               }
             }
          }
       }
+      // each shard locked once per block
+      for( size_t i = 0; i < removed.size(); ++i ) {
+         if( removed[i].empty() ) continue;
+         std::lock_guard<std::mutex> g( _shards[i].mtx );
+         for( const auto& r : removed[i] ) {
+            remove_subjective_billing( _shards[i].account_bills, r.first, r.second, time_ordinal );
+         }
+      }
    }
 
 public: // public for tests
@@ -105,6 +163,7 @@ public: // public for tests
    static constexpr uint32_t expired_accumulator_average_window = config::account_cpu_usage_average_window_ms / subjective_time_interval_ms;
 
    void remove_subjective_billing( const transaction_id_type& trx_id, uint32_t time_ordinal ) {
+      std::lock_guard<std::mutex> g( _trx_cache_mtx );
       auto& idx = _trx_cache_index.get<by_id>();
       auto itr = idx.find( trx_id );
       if( itr != idx.end() ) {
@@ -124,15 +183,20 @@ public:
    {
       if( !_disabled && !_disabled_accounts.count( first_auth ) ) {
          uint32_t bill = std::max<int64_t>( 0, elapsed.count() );
+         std::lock_guard<std::mutex> g( _trx_cache_mtx );
          auto p = _trx_cache_index.emplace(
                trx_cache_entry{id,
                                first_auth,
                                bill,
                                expire} );
          if( p.second ) {
-            _account_subjective_bill_cache[first_auth].pending_cpu_us += bill;
+            auto& shard = shard_for( first_auth );
+            std::lock_guard<std::mutex> gs( shard.mtx );
+            auto& info = shard.account_bills[first_auth];
+            info.pending_cpu_us += bill;
+            info.add_trx_cpu( bill );
             if( in_pending_block ) {
-               _block_subjective_bill_cache[first_auth] += bill;
+               shard.block_bills[first_auth] += bill;
             }
          }
       }
@@ -143,21 +207,37 @@ public:
       if( !_disabled && !_disabled_accounts.count( first_auth ) ) {
          uint32_t bill = std::max<int64_t>( 0, elapsed.count() );
          const auto time_ordinal = time_ordinal_for(now);
-         _account_subjective_bill_cache[first_auth].expired_accumulator.add(bill, time_ordinal, expired_accumulator_average_window);
+         auto& shard = shard_for( first_auth );
+         std::lock_guard<std::mutex> g( shard.mtx );
+         auto& info = shard.account_bills[first_auth];
+         info.expired_accumulator.add(bill, time_ordinal, expired_accumulator_average_window);
+         info.add_trx_cpu( bill );
       }
    }
 
+   /// thread safe
+   /// @return recent average cpu us of a transaction of first_auth, 0 if not known
+   uint32_t get_expected_trx_cpu_us( const account_name& first_auth ) const {
+      const auto& shard = shard_for( first_auth );
+      std::lock_guard<std::mutex> g( shard.mtx );
+      auto aitr = shard.account_bills.find( first_auth );
+      return aitr != shard.account_bills.end() ? aitr->second.trx_cpu_estimate_us : 0;
+   }
+
+   /// thread safe
    uint32_t get_subjective_bill( const account_name& first_auth, const fc::time_point& now ) const {
       if( _disabled || _disabled_accounts.count( first_auth ) ) return 0;
       const auto time_ordinal = time_ordinal_for(now);
+      const auto& shard = shard_for( first_auth );
+      std::lock_guard<std::mutex> g( shard.mtx );
       const subjective_billing_info* sub_bill_info = nullptr;
-      auto aitr = _account_subjective_bill_cache.find( first_auth );
-      if( aitr != _account_subjective_bill_cache.end() ) {
+      auto aitr = shard.account_bills.find( first_auth );
+      if( aitr != shard.account_bills.end() ) {
          sub_bill_info = &aitr->second;
       }
       uint64_t in_block_pending_cpu_us = 0;
-      auto bitr = _block_subjective_bill_cache.find( first_auth );
-      if( bitr != _block_subjective_bill_cache.end() ) {
+      auto bitr = shard.block_bills.find( first_auth );
+      if( bitr != shard.block_bills.end() ) {
          in_block_pending_cpu_us = bitr->second;
       }
 
@@ -171,7 +251,10 @@ public:
    }
 
    void abort_block() {
-      _block_subjective_bill_cache.clear();
+      for( auto& shard : _shards ) {
+         std::lock_guard<std::mutex> g( shard.mtx );
+         shard.block_bills.clear();
+      }
    }
 
    void on_block( const block_state_ptr& bsp, const fc::time_point& now ) {
@@ -182,6 +265,7 @@ public:
 
    bool remove_expired( fc::logger& log, const fc::time_point& pending_block_time, const fc::time_point& now, const fc::time_point& deadline ) {
       bool exhausted = false;
+      std::lock_guard<std::mutex> g( _trx_cache_mtx );
       auto& idx = _trx_cache_index.get<by_expiry>();
       if( !idx.empty() ) {
          const auto time_ordinal = time_ordinal_for(now);
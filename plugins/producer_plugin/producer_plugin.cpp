@@ -1,10 +1,13 @@
 #include <eosio/producer_plugin/producer_plugin.hpp>
 #include <eosio/producer_plugin/pending_snapshot.hpp>
 #include <eosio/producer_plugin/subjective_billing.hpp>
+#include <eosio/producer_plugin/failed_transaction_cache.hpp>
+#include <eosio/producer_plugin/production_window.hpp>
 #include <eosio/chain/plugin_interface.hpp>
 #include <eosio/chain/global_property_object.hpp>
 #include <eosio/chain/generated_transaction_object.hpp>
 #include <eosio/chain/snapshot.hpp>
+#include <eosio/chain/snapshot_delta.hpp>
 #include <eosio/chain/transaction_object.hpp>
 #include <eosio/chain/thread_utils.hpp>
 #include <eosio/chain/unapplied_transaction_queue.hpp>
@@ -19,6 +22,7 @@
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 #include <iostream>
+#include <sstream>
 #include <algorithm>
 #include <boost/range/adaptor/map.hpp>
 #include <boost/function_output_iterator.hpp>
@@ -88,6 +92,19 @@ namespace {
              (code == block_net_usage_exceeded::code_value) ||
              (code == deadline_exception::code_value && deadline_is_subjective);
    }
+
+   // failures that depend only on the transaction and the state it executed against, not on time or load
+   bool exception_is_deterministic(const fc::exception& e) {
+      auto code = e.code();
+      return (code != block_cpu_usage_exceeded::code_value) &&
+             (code != block_net_usage_exceeded::code_value) &&
+             (code != deadline_exception::code_value) &&
+             (code != leeway_deadline_exception::code_value) &&
+             (code != tx_cpu_usage_exceeded::code_value) &&
+             (code != greylist_cpu_usage_exceeded::code_value) &&
+             (code != tx_resource_exhaustion::code_value) &&
+             (code != tx_duplicate::code_value);
+   }
 }
 
 struct transaction_id_with_expiry {
@@ -152,16 +169,22 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
       void schedule_maybe_produce_block( bool exhausted );
       void produce_block();
       bool maybe_produce_block();
+      void create_snapshot(const bfs::path& snapshots_dir, producer_plugin::next_function<producer_plugin::snapshot_information> next,
+                           const std::optional<bfs::path>& delta_base = {});
       bool remove_expired_trxs( const fc::time_point& deadline );
       bool block_is_exhausted() const;
       bool remove_expired_blacklisted_trxs( const fc::time_point& deadline );
       bool process_unapplied_trxs( const fc::time_point& deadline );
       void process_scheduled_and_incoming_trxs( const fc::time_point& deadline, size_t& pending_incoming_process_limit );
       bool process_incoming_trxs( const fc::time_point& deadline, size_t& pending_incoming_process_limit );
+      uint32_t expected_cpu_us( const transaction_metadata_ptr& trx ) const;
+      bool exceeds_block_budget( const transaction_metadata_ptr& trx, const fc::time_point& deadline ) const;
+      trx_state_version pending_trx_state_version() const;
 
       boost::program_options::variables_map _options;
       bool     _production_enabled                 = false;
       bool     _pause_production                   = false;
+      bool     _standby                            = false;
 
       using signature_provider_type = signature_provider_plugin::signature_provider_type;
       std::map<chain::public_key_type, signature_provider_type> _signature_providers;
@@ -178,8 +201,11 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
       fc::microseconds                                          _max_irreversible_block_age_us;
       int32_t                                                   _produce_time_offset_us = 0;
       int32_t                                                   _last_block_time_offset_us = 0;
+      bool                                                      _adaptive_cpu_effort = false;
+      production_window                                         _production_window;
       uint32_t                                                  _max_block_cpu_usage_threshold_us = 0;
       uint32_t                                                  _max_block_net_usage_threshold_bytes = 0;
+      bool                                                      _block_packing = false;
       int32_t                                                   _max_scheduled_transaction_time_per_block_ms = 0;
       bool                                                      _disable_persist_until_expired = false;
       bool                                                      _disable_subjective_p2p_billing = true;
@@ -201,15 +227,49 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
       incoming::methods::block_sync::method_type::handle        _incoming_block_sync_provider;
       incoming::methods::blockvault_sync::method_type::handle   _incoming_blockvault_sync_provider;
       incoming::methods::transaction_async::method_type::handle _incoming_transaction_async_provider;
+      incoming::methods::transaction_batch_async::method_type::handle _incoming_transaction_batch_async_provider;
 
       transaction_id_with_expiry_index                          _blacklisted_transactions;
       pending_snapshot_index                                    _pending_snapshot_index;
+      // snapshots serialized but not yet written to disk, by head block id
+      std::map<block_id_type, pending_snapshot::next_t>         _snapshots_in_flight;
+      std::optional<named_thread_pool>                          _snapshot_thread_pool;
       subjective_billing                                        _subjective_billing;
+      failed_transaction_cache                                  _failed_trx_cache;
+
+      /// chain state used to reject invalid transactions on the producer thread pool before they reach the main thread
+      struct prevalidation_limits {
+         fc::time_point head_block_time;
+         uint32_t       max_transaction_lifetime = 0;  // seconds, 0 until known
+         uint32_t       max_transaction_net_usage = 0; // bytes
+      };
+      mutable std::mutex                                        _prevalidation_mtx;
+      prevalidation_limits                                      _prevalidation_limits;
 
       std::optional<scoped_connection>                          _accepted_block_connection;
       std::optional<scoped_connection>                          _accepted_block_header_connection;
       std::optional<scoped_connection>                          _irreversible_block_connection;
 
+      /// time spent in every action executed, speculatively or in a block, keyed by receiver, contract and action
+      struct action_profile_stats {
+         uint64_t count = 0;
+         int64_t  total_us = 0;
+         int64_t  max_us = 0;
+      };
+      using action_profile_key = std::tuple<account_name, account_name, action_name>;
+      std::optional<scoped_connection>                          _applied_transaction_connection;
+      std::map<action_profile_key, action_profile_stats>       _action_profile;
+      fc::time_point                                            _action_profile_since;
+
+      void on_applied_transaction( const chain::transaction_trace_ptr& trace ) {
+         for( const auto& at : trace->action_traces ) {
+            auto& stats = _action_profile[{at.receiver, at.act.account, at.act.name}];
+            ++stats.count;
+            stats.total_us += at.elapsed.count();
+            stats.max_us = std::max( stats.max_us, at.elapsed.count() );
+         }
+      }
+
       /*
        * HACK ALERT
        * Boost timers can be in a state where a handler has not yet executed but is not abortable.
@@ -228,6 +288,15 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
       // path to write the snapshots to
       bfs::path _snapshots_dir;
 
+      // write gzip compressed snapshots
+      bool _snapshot_compression = false;
+
+      // write the snapshots as deltas against this binary snapshot
+      std::optional<bfs::path> _snapshot_delta_base;
+
+      // lib block number at which the next state checkpoint is taken
+      uint32_t _next_state_checkpoint = 0;
+
       void consider_new_watermark( account_name producer, uint32_t block_num, block_timestamp_type timestamp) {
          auto itr = _producer_watermarks.find( producer );
          if( itr != _producer_watermarks.end() ) {
@@ -250,6 +319,7 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
          auto before = _unapplied_transactions.size();
          _unapplied_transactions.clear_applied( bsp );
          _subjective_billing.on_block( bsp, fc::time_point::now() );
+         update_prevalidation_limits();
          fc_dlog( _log, "Removed applied transactions before: ${before}, after: ${after}",
                   ("before", before)("after", _unapplied_transactions.size()) );
       }
@@ -260,11 +330,63 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
 
       void on_irreversible_block( const signed_block_ptr& lib ) {
          _irreversible_block_time = lib->timestamp.to_time_point();
-         const chain::controller& chain = chain_plug->chain();
 
          // promote any pending snapshots
+         promote_pending_snapshots( lib->block_num() );
+
+         schedule_state_checkpoint( lib->block_num() );
+      }
+
+      void schedule_state_checkpoint( uint32_t lib_height ) {
+         const auto& checkpoints = chain_plug->state_checkpoints();
+         if( checkpoints.interval == 0 || lib_height < _next_state_checkpoint )
+            return;
+         _next_state_checkpoint = (lib_height / checkpoints.interval + 1) * checkpoints.interval;
+
+         // taking a snapshot aborts the pending block, which cannot be done from within a controller signal
+         app().post( priority::low, [this]() {
+            const auto head_id = chain_plug->chain().head_block_id();
+            // a snapshot of this block is already on its way
+            if( _pending_snapshot_index.get<by_id>().count( head_id ) || _snapshots_in_flight.count( head_id ) )
+               return;
+            create_snapshot( chain_plug->state_checkpoints().dir,
+                             [this]( const std::variant<fc::exception_ptr, producer_plugin::snapshot_information>& result ) {
+               if( std::holds_alternative<fc::exception_ptr>( result ) ) {
+                  wlog( "Unable to write state checkpoint: ${e}", ("e", std::get<fc::exception_ptr>( result )->to_string()) );
+                  return;
+               }
+               ilog( "Wrote state checkpoint ${path}", ("path", std::get<producer_plugin::snapshot_information>( result ).snapshot_name) );
+               prune_state_checkpoints();
+            } );
+         } );
+      }
+
+      /// remove all but the newest max-state-checkpoints checkpoints
+      void prune_state_checkpoints() {
+         const auto& checkpoints = chain_plug->state_checkpoints();
+         std::map<uint32_t, bfs::path> finalized;
+         for( bfs::directory_iterator itr( checkpoints.dir ), end; itr != end; ++itr ) {
+            const auto name = itr->path().filename().string();
+            const auto base = itr->path().extension() == ".gz" ? itr->path().stem() : itr->path();
+            if( name.find( "snapshot-" ) != 0 || base.extension() != ".bin" )
+               continue;
+            try {
+               finalized[block_header::num_from_id( block_id_type( base.stem().string().substr( 9 ) ) )] = itr->path();
+            } catch( const fc::exception& ) {
+            }
+         }
+         while( finalized.size() > checkpoints.max_retained ) {
+            boost::system::error_code ec;
+            bfs::remove( finalized.begin()->second, ec );
+            if( ec )
+               wlog( "Unable to remove state checkpoint ${path}: ${m}", ("path", finalized.begin()->second.generic_string())("m", ec.message()) );
+            finalized.erase( finalized.begin() );
+         }
+      }
+
+      void promote_pending_snapshots( uint32_t lib_height ) {
+         const chain::controller& chain = chain_plug->chain();
          auto& snapshots_by_height = _pending_snapshot_index.get<by_height>();
-         uint32_t lib_height = lib->block_num();
 
          while (!snapshots_by_height.empty() && snapshots_by_height.begin()->get_height() <= lib_height) {
             const auto& pending = snapshots_by_height.begin();
@@ -380,12 +502,21 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
          };
 
          try {
+            const auto apply_start = fc::time_point::now();
             block_state_ptr blk_state = chain.push_block( bsf, [this]( const branch_type& forked_branch ) {
                _unapplied_transactions.add_forked( forked_branch );
             }, [this]( const transaction_id_type& id ) {
                return _unapplied_transactions.get_trx( id );
             } );
 
+            // live blocks of other producers tell how long the next producer needs for our last block
+            const auto apply_end = fc::time_point::now();
+            if( _producers.count( block->producer ) == 0 &&
+                apply_end - block->timestamp.to_time_point() < fc::milliseconds( config::block_interval_ms * config::producer_repetitions ) ) {
+               _production_window.block_applied( apply_end - apply_start );
+               _production_window.block_received( block->previous, block->timestamp );
+            }
+
             if ( blockvault != nullptr ) {
                if (_block_vault_resync.is_pending() && _producers.count( block->producer ) > 0 ) {
                   // Cancel any pending resync from blockvault if we received any blocks from the same logical producer
@@ -438,37 +569,186 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
          schedule_production_loop();
       }
 
+      // called from main thread
+      void update_prevalidation_limits() {
+         const chain::controller& chain = chain_plug->chain();
+         const auto& cfg = chain.get_global_properties().configuration;
+         std::lock_guard<std::mutex> g( _prevalidation_mtx );
+         _prevalidation_limits.head_block_time = chain.head_block_time();
+         _prevalidation_limits.max_transaction_lifetime = cfg.max_transaction_lifetime;
+         _prevalidation_limits.max_transaction_net_usage = cfg.max_transaction_net_usage;
+      }
+
+      // thread safe, context free checks that push_transaction would otherwise fail on the main thread
+      void prevalidate_transaction( const packed_transaction& trx ) const {
+         prevalidation_limits limits;
+         {
+            std::lock_guard<std::mutex> g( _prevalidation_mtx );
+            limits = _prevalidation_limits;
+         }
+         if( limits.max_transaction_lifetime == 0 ) return;
+
+         const transaction& t = trx.get_transaction();
+         const fc::time_point expiration = t.expiration;
+         // pending block time is always after head block time
+         EOS_ASSERT( expiration >= limits.head_block_time, expired_tx_exception,
+                     "transaction has expired, expiration is ${e} and head block time is ${h}",
+                     ("e", expiration)("h", limits.head_block_time) );
+         // allow for the pending block time being up to two blocks ahead of now
+         const fc::time_point reference_time = std::max( limits.head_block_time, fc::time_point::now() ) +
+                                               fc::milliseconds( 2 * config::block_interval_ms );
+         EOS_ASSERT( expiration <= reference_time + fc::seconds( limits.max_transaction_lifetime ), tx_exp_too_far_exception,
+                     "Transaction expiration is too far in the future relative to the reference time of ${reference_time}, "
+                     "expiration is ${e} and the maximum transaction lifetime is ${max_til_exp} seconds",
+                     ("reference_time", reference_time)("e", expiration)("max_til_exp", limits.max_transaction_lifetime) );
+
+         const uint64_t size = uint64_t(trx.get_unprunable_size()) + trx.get_prunable_size();
+         EOS_ASSERT( size <= limits.max_transaction_net_usage, tx_net_usage_exceeded,
+                     "transaction size ${s} bytes exceeds the maximum transaction net usage of ${m} bytes",
+                     ("s", size)("m", limits.max_transaction_net_usage) );
+
+         for( const auto& a : t.context_free_actions ) {
+            EOS_ASSERT( a.authorization.empty(), transaction_exception, "context-free actions cannot have authorizations" );
+         }
+         bool one_auth = std::any_of( t.actions.begin(), t.actions.end(), []( const auto& a ) { return !a.authorization.empty(); } );
+         EOS_ASSERT( one_auth, tx_no_auths, "transaction must have at least one authorization" );
+      }
+
       void on_incoming_transaction_async(const packed_transaction_ptr& trx, bool persist_until_expired, next_function<transaction_trace_ptr> next) {
          chain::controller& chain = chain_plug->chain();
          const auto max_trx_time_ms = _max_transaction_time_ms.load();
          fc::microseconds max_trx_cpu_usage = max_trx_time_ms < 0 ? fc::microseconds::maximum() : fc::milliseconds( max_trx_time_ms );
+         const chain_id_type chain_id = chain.get_chain_id();
+         const uint32_t sig_length_limit = chain.configured_subjective_signature_length_limit();
+
+         // stage 1: context free checks, so invalid transactions do not cost key recovery or main thread execution
+         boost::asio::post(_thread_pool->get_executor(), [self = this, persist_until_expired, next{std::move(next)}, trx,
+                                                          chain_id, max_trx_cpu_usage, sig_length_limit]() mutable {
+            auto reject = [&next, &trx](fc::exception_ptr ex) {
+               fc_dlog(_trx_failed_trace_log, "[TRX_TRACE] Prevalidation is REJECTING tx: ${txid}, auth: ${a} : ${why} ",
+                       ("txid", trx->id())("a",trx->get_transaction().first_authorizer())("why",ex->what()));
+               // next is called from the application thread
+               app().post( priority::low, [next{std::move(next)}, ex{std::move(ex)}]() {
+                  next(ex);
+               } );
+            };
+            bool valid = false;
+            try {
+               self->prevalidate_transaction( *trx );
+               valid = true;
+            } CATCH_AND_CALL(reject);
+            if( !valid ) return;
+
+            // stage 2: key recovery
+            auto future = transaction_metadata::start_recover_keys( trx, self->_thread_pool->get_executor(),
+                   chain_id, fc::microseconds( max_trx_cpu_usage ), sig_length_limit );
+            // wait on a separate task so a single producer thread does not wait on its own queued recovery
+            boost::asio::post(self->_thread_pool->get_executor(), [self, future{std::move(future)}, persist_until_expired,
+                                                                   next{std::move(next)}, trx]() mutable {
+               if( future.valid() ) {
+                  future.wait();
+                  // stage 3: execution on the main thread
+                  app().post( priority::low, [self, future{std::move(future)}, persist_until_expired, next{std::move( next )}, trx{std::move(trx)}]() mutable {
+                     auto exception_handler = [&next, trx{std::move(trx)}](fc::exception_ptr ex) {
+                        fc_dlog(_trx_failed_trace_log, "[TRX_TRACE] Speculative execution is REJECTING tx: ${txid}, auth: ${a} : ${why} ",
+                               ("txid", trx->id())("a",trx->get_transaction().first_authorizer())("why",ex->what()));
+                        next(ex);
+                     };
+                     try {
+                        auto result = future.get();
+                        if( !self->process_incoming_transaction_async( result, persist_until_expired, next ) ) {
+                           if( self->_pending_block_mode == pending_block_mode::producing ) {
+                              self->schedule_maybe_produce_block( true );
+                           } else {
+                              self->restart_speculative_block();
+                           }
+                        }
+                     } CATCH_AND_CALL(exception_handler);
+                  } );
+               }
+            });
+         });
+      }
 
-         auto future = transaction_metadata::start_recover_keys( trx, _thread_pool->get_executor(),
-                chain.get_chain_id(), fc::microseconds( max_trx_cpu_usage ), chain.configured_subjective_signature_length_limit() );
-
-         boost::asio::post(_thread_pool->get_executor(), [self = this, future{std::move(future)}, persist_until_expired,
-                                                          next{std::move(next)}, trx]() mutable {
-            if( future.valid() ) {
-               future.wait();
-               app().post( priority::low, [self, future{std::move(future)}, persist_until_expired, next{std::move( next )}, trx{std::move(trx)}]() mutable {
-                  auto exception_handler = [&next, trx{std::move(trx)}](fc::exception_ptr ex) {
-                     fc_dlog(_trx_failed_trace_log, "[TRX_TRACE] Speculative execution is REJECTING tx: ${txid}, auth: ${a} : ${why} ",
-                            ("txid", trx->id())("a",trx->get_transaction().first_authorizer())("why",ex->what()));
-                     next(ex);
-                  };
-                  try {
-                     auto result = future.get();
-                     if( !self->process_incoming_transaction_async( result, persist_until_expired, next ) ) {
-                        if( self->_pending_block_mode == pending_block_mode::producing ) {
-                           self->schedule_maybe_produce_block( true );
+      /// the batch counterpart of on_incoming_transaction_async: the context free checks and the key recovery of the
+      /// transactions run in parallel on the thread pool, then all of them are processed by a single main thread task
+      void on_incoming_transaction_batch_async(const std::vector<packed_transaction_ptr>& trxs, bool persist_until_expired,
+                                               std::vector<next_function<transaction_trace_ptr>> nexts) {
+         EOS_ASSERT( trxs.size() == nexts.size(), chain::plugin_exception, "a batch needs one next function per transaction" );
+         if( trxs.empty() ) return;
+         chain::controller& chain = chain_plug->chain();
+         const auto max_trx_time_ms = _max_transaction_time_ms.load();
+
+         struct batch_state {
+            explicit batch_state( const chain_id_type& chain_id ) : chain_id( chain_id ) {}
+
+            std::vector<packed_transaction_ptr>                trxs;
+            std::vector<next_function<transaction_trace_ptr>>  nexts;
+            std::vector<transaction_metadata_ptr>              results;
+            std::vector<fc::exception_ptr>                     errors;
+            std::atomic<size_t>                                remaining{0};
+            chain_id_type                                      chain_id;
+            fc::microseconds                                   max_trx_cpu_usage;
+            uint32_t                                           sig_length_limit = 0;
+         };
+         auto batch = std::make_shared<batch_state>( chain.get_chain_id() );
+         batch->trxs = trxs;
+         batch->nexts = std::move( nexts );
+         batch->results.resize( trxs.size() );
+         batch->errors.resize( trxs.size() );
+         batch->max_trx_cpu_usage = max_trx_time_ms < 0 ? fc::microseconds::maximum() : fc::milliseconds( max_trx_time_ms );
+         batch->sig_length_limit = chain.configured_subjective_signature_length_limit();
+         batch->remaining = trxs.size();
+
+         for( size_t i = 0; i < trxs.size(); ++i ) {
+            boost::asio::post( _thread_pool->get_executor(), [self = this, batch, i, persist_until_expired]() {
+               auto& trx = batch->trxs[i];
+               auto reject = [&](fc::exception_ptr ex) {
+                  fc_dlog(_trx_failed_trace_log, "[TRX_TRACE] Prevalidation is REJECTING tx: ${txid}, auth: ${a} : ${why} ",
+                          ("txid", trx->id())("a",trx->get_transaction().first_authorizer())("why",ex->what()));
+                  batch->errors[i] = std::move( ex );
+               };
+               try {
+                  self->prevalidate_transaction( *trx );
+                  batch->results[i] = transaction_metadata::recover_keys( trx, batch->chain_id, batch->max_trx_cpu_usage,
+                                                                          batch->sig_length_limit );
+               } CATCH_AND_CALL(reject);
+
+               if( batch->remaining.fetch_sub( 1 ) != 1 ) return;
+               // the last transaction recovered, process the whole batch on the main thread
+               app().post( priority::low, [self, batch, persist_until_expired]() {
+                  bool exhausted = false;
+                  for( size_t j = 0; j < batch->trxs.size(); ++j ) {
+                     auto& next = batch->nexts[j];
+                     if( batch->errors[j] ) {
+                        next( batch->errors[j] );
+                        continue;
+                     }
+                     auto& trx = batch->results[j];
+                     auto exception_handler = [&next, &trx](fc::exception_ptr ex) {
+                        fc_dlog(_trx_failed_trace_log, "[TRX_TRACE] Speculative execution is REJECTING tx: ${txid}, auth: ${a} : ${why} ",
+                                ("txid", trx->id())("a",trx->packed_trx()->get_transaction().first_authorizer())("why",ex->what()));
+                        next(ex);
+                     };
+                     try {
+                        if( exhausted ) {
+                           // the rest of the batch waits for the next block in the unapplied queue
+                           self->_unapplied_transactions.add_incoming( trx, persist_until_expired, next, self->expected_cpu_us( trx ) );
                         } else {
-                           self->restart_speculative_block();
+                           exhausted = !self->process_incoming_transaction_async( trx, persist_until_expired, next );
                         }
+                     } CATCH_AND_CALL(exception_handler);
+                  }
+                  if( exhausted ) {
+                     if( self->_pending_block_mode == pending_block_mode::producing ) {
+                        self->schedule_maybe_produce_block( true );
+                     } else {
+                        self->restart_speculative_block();
                      }
-                  } CATCH_AND_CALL(exception_handler);
+                  }
                } );
-            }
-         });
+            } );
+         }
       }
 
       bool process_incoming_transaction_async(const transaction_metadata_ptr& trx, bool persist_until_expired, next_function<transaction_trace_ptr> next) {
@@ -528,7 +808,21 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
             }
 
             if( !chain.is_building_block()) {
-               _unapplied_transactions.add_incoming( trx, persist_until_expired, next );
+               _unapplied_transactions.add_incoming( trx, persist_until_expired, next, expected_cpu_us( trx ) );
+               return true;
+            }
+
+            if( exceeds_block_budget( trx, calculate_block_deadline( chain.pending_block_time() ) ) ) {
+               // leave room in this block for transactions that fit
+               _unapplied_transactions.add_incoming( trx, persist_until_expired, next, expected_cpu_us( trx ) );
+               return true;
+            }
+
+            const trx_state_version state_version = pending_trx_state_version();
+            if( auto e_ptr = _failed_trx_cache.get( id, state_version ) ) {
+               fc_dlog( _trx_failed_trace_log, "[TRX_TRACE] Not re-executing tx: ${txid} which failed against unchanged state",
+                        ("txid", id) );
+               send_response( e_ptr );
                return true;
             }
 
@@ -554,7 +848,7 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
             fc_dlog( _trx_failed_trace_log, "Subjective bill for ${a}: ${b} elapsed ${t}us", ("a",first_auth)("b",sub_bill)("t",trace->elapsed));
             if( trace->except ) {
                if( exception_is_exhausted( *trace->except, deadline_is_subjective )) {
-                  _unapplied_transactions.add_incoming( trx, persist_until_expired, next );
+                  _unapplied_transactions.add_incoming( trx, persist_until_expired, next, expected_cpu_us( trx ) );
                   if( _pending_block_mode == pending_block_mode::producing ) {
                      fc_dlog(_log, "[TRX_TRACE] Block ${block_num} for producer ${prod} COULD NOT FIT, tx: ${txid} RETRYING, ec: ${c} ",
                               ("block_num", chain.head_block_num() + 1)
@@ -568,6 +862,8 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
                } else {
                   _subjective_billing.subjective_bill_failure( first_auth, trace->elapsed, fc::time_point::now() );
                   auto e_ptr = trace->except->dynamic_copy_exception();
+                  if( exception_is_deterministic( *trace->except ) )
+                     _failed_trx_cache.add( id, expire, state_version, e_ptr );
                   send_response( e_ptr );
                }
             } else {
@@ -615,7 +911,7 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
       }
 
       bool production_disabled_by_policy() {
-         return !_production_enabled || _pause_production || (_max_irreversible_block_age_us.count() >= 0 && get_irreversible_block_age() >= _max_irreversible_block_age_us);
+         return !_production_enabled || _pause_production || _standby || (_max_irreversible_block_age_us.count() >= 0 && get_irreversible_block_age() >= _max_irreversible_block_age_us);
       }
 
       enum class start_block_result {
@@ -675,6 +971,8 @@ void producer_plugin::set_program_options(
    producer_options.add_options()
          ("enable-stale-production,e", boost::program_options::bool_switch()->notifier([this](bool e){my->_production_enabled = e;}), "Enable block production, even if the chain is stale.")
          ("pause-on-startup,x", boost::program_options::bool_switch()->notifier([this](bool p){my->_pause_production = p;}), "Start this node in a state where production is paused")
+         ("standby", boost::program_options::bool_switch()->notifier([this](bool s){my->_standby = s;}),
+          "Start this node as a hot standby that applies unapplied transactions to its speculative blocks as a producer would, but does not produce until promoted")
          ("max-transaction-time", bpo::value<int32_t>()->default_value(30),
           "Limits the maximum time (in milliseconds) that is allowed a pushed transaction's code to execute before being considered invalid")
          ("max-irreversible-block-age", bpo::value<int32_t>()->default_value( -1 ),
@@ -699,18 +997,30 @@ void producer_plugin::set_program_options(
           "Percentage of cpu block production time used to produce block. Whole number percentages, e.g. 80 for 80%")
          ("last-block-cpu-effort-percent", bpo::value<uint32_t>()->default_value(config::default_block_cpu_effort_pct / config::percent_1),
           "Percentage of cpu block production time used to produce last block. Whole number percentages, e.g. 80 for 80%")
+         ("adaptive-cpu-effort", bpo::value<bool>()->default_value(false),
+          "Adjust block production time from measured block produce and apply times, and the last block of the round from whether the next producer builds on it. Configured offsets are used until enough blocks are measured")
          ("max-block-cpu-usage-threshold-us", bpo::value<uint32_t>()->default_value( 5000 ),
           "Threshold of CPU block production to consider block full; when within threshold of max-block-cpu-usage block can be produced immediately")
          ("max-block-net-usage-threshold-bytes", bpo::value<uint32_t>()->default_value( 1024 ),
           "Threshold of NET block production to consider block full; when within threshold of max-block-net-usage block can be produced immediately")
          ("max-scheduled-transaction-time-per-block-ms", boost::program_options::value<int32_t>()->default_value(100),
-          "Maximum wall-clock time, in milliseconds, spent retiring scheduled transactions in any block before returning to normal transaction processing.")
+          "Maximum wall-clock time, in milliseconds, spent retiring scheduled transactions in any block before returning to normal transaction processing. Time spent on incoming transactions interleaved by incoming-defer-ratio is not counted.")
          ("subjective-cpu-leeway-us", boost::program_options::value<int32_t>()->default_value( config::default_subjective_cpu_leeway_us ),
           "Time in microseconds allowed for a transaction that starts with insufficient CPU quota to complete and cover its CPU usage.")
          ("incoming-defer-ratio", bpo::value<double>()->default_value(1.0),
           "ratio between incoming transactions and deferred transactions when both are queued for execution")
          ("incoming-transaction-queue-size-mb", bpo::value<uint16_t>()->default_value( 1024 ),
           "Maximum size (in MiB) of the incoming transaction queue. Exceeding this value will subjectively drop transaction with resource exhaustion.")
+         ("incoming-transaction-queue-account-size-mb", bpo::value<uint16_t>()->default_value( 0 ),
+          "Maximum size (in MiB) of the incoming transaction queue for a single first authorizer, 0 for no per account limit. Exceeding this value will subjectively drop transaction of that account with resource exhaustion.")
+         ("block-packing", bpo::value<bool>()->default_value(false),
+          "When producing, leave queued transactions whose estimated CPU exceeds the remaining block CPU or time for a later block so smaller transactions can fill the block")
+         ("failed-transaction-cache-size", bpo::value<uint32_t>()->default_value( 10'000 ),
+          "Maximum number of deterministically failed transactions remembered so they are rejected without re-execution until the pending block state changes, 0 to disable")
+         ("incoming-transaction-fair-scheduling", bpo::value<bool>()->default_value(false),
+          "Process queued incoming transactions ordered by the subjective CPU of their first authorizer and round robin by account instead of in arrival order")
+         ("action-profile", bpo::bool_switch()->default_value(false),
+          "Aggregate the time spent in every executed action by receiver, contract and action, returned by producer/get_action_profile")
          ("disable-api-persisted-trx", bpo::bool_switch()->default_value(false),
           "Disable the re-apply of API transactions.")
          ("disable-subjective-billing", bpo::value<bool>()->default_value(true),
@@ -725,6 +1035,11 @@ void producer_plugin::set_program_options(
           "Number of worker threads in producer thread pool")
          ("snapshots-dir", bpo::value<bfs::path>()->default_value("snapshots"),
           "the location of the snapshots directory (absolute path or relative to application data dir)")
+         ("snapshot-compression", bpo::bool_switch()->default_value(false),
+          "Write gzip compressed snapshots, named snapshot-<block id>.bin.gz, which nodeos can load directly with --snapshot")
+         ("snapshot-delta-base", bpo::value<bfs::path>(),
+          "Binary snapshot, which may be gzip compressed, to write the snapshots requested through the API as deltas against, named snapshot-<block id>.delta, "
+          "which nodeos loads with --snapshot-delta on top of this snapshot. State checkpoints are always full snapshots")
          ;
    config_file_options.add(producer_options);
 }
@@ -830,12 +1145,17 @@ void producer_plugin::plugin_initialize(const boost::program_options::variables_
    my->_produce_time_offset_us = std::min( my->_produce_time_offset_us, cpu_effort_offset_us );
    my->_last_block_time_offset_us = std::min( my->_last_block_time_offset_us, last_block_cpu_effort_offset_us );
 
+   my->_adaptive_cpu_effort = options.at( "adaptive-cpu-effort" ).as<bool>();
+   my->_production_window.set_configured_last_block_offset_us( my->_last_block_time_offset_us );
+
    my->_max_block_cpu_usage_threshold_us = options.at( "max-block-cpu-usage-threshold-us" ).as<uint32_t>();
    EOS_ASSERT( my->_max_block_cpu_usage_threshold_us < config::block_interval_us, plugin_config_exception,
                "max-block-cpu-usage-threshold-us ${t} must be 0 .. ${bi}", ("bi", config::block_interval_us)("t", my->_max_block_cpu_usage_threshold_us) );
 
    my->_max_block_net_usage_threshold_bytes = options.at( "max-block-net-usage-threshold-bytes" ).as<uint32_t>();
 
+   my->_block_packing = options.at( "block-packing" ).as<bool>();
+
    my->_max_scheduled_transaction_time_per_block_ms = options.at("max-scheduled-transaction-time-per-block-ms").as<int32_t>();
 
    if( options.at( "subjective-cpu-leeway-us" ).as<int32_t>() != config::default_subjective_cpu_leeway_us ) {
@@ -853,9 +1173,22 @@ void producer_plugin::plugin_initialize(const boost::program_options::variables_
 
    my->_unapplied_transactions.set_max_transaction_queue_size( max_incoming_transaction_queue_size );
 
+   uint64_t max_account_queue_size = uint64_t(options.at("incoming-transaction-queue-account-size-mb").as<uint16_t>()) * 1024*1024;
+   my->_unapplied_transactions.set_max_account_queue_size( max_account_queue_size );
+   my->_failed_trx_cache.set_max_size( options.at("failed-transaction-cache-size").as<uint32_t>() );
+   my->_unapplied_transactions.set_fair_incoming_scheduling( options.at("incoming-transaction-fair-scheduling").as<bool>() );
+
    my->_incoming_defer_ratio = options.at("incoming-defer-ratio").as<double>();
 
    my->_disable_persist_until_expired = options.at("disable-api-persisted-trx").as<bool>();
+
+   if( options.at("action-profile").as<bool>() ) {
+      my->_action_profile_since = fc::time_point::now();
+      my->_applied_transaction_connection.emplace( my->chain_plug->chain().applied_transaction.connect(
+            [this]( std::tuple<const transaction_trace_ptr&, const packed_transaction_ptr&> t ) {
+               my->on_applied_transaction( std::get<0>( t ) );
+            } ) );
+   }
    bool disable_subjective_billing = options.at("disable-subjective-billing").as<bool>();
    my->_disable_subjective_p2p_billing = options.at("disable-subjective-p2p-billing").as<bool>();
    my->_disable_subjective_api_billing = options.at("disable-subjective-api-billing").as<bool>();
@@ -880,6 +1213,7 @@ void producer_plugin::plugin_initialize(const boost::program_options::variables_
    EOS_ASSERT( thread_pool_size > 0, plugin_config_exception,
                "producer-threads ${num} must be greater than 0", ("num", thread_pool_size));
    my->_thread_pool.emplace( "prod", thread_pool_size );
+   my->_snapshot_thread_pool.emplace( "snap", 1 );
 
    if( options.count( "snapshots-dir" )) {
       auto sd = options.at( "snapshots-dir" ).as<bfs::path>();
@@ -900,6 +1234,23 @@ void producer_plugin::plugin_initialize(const boost::program_options::variables_
       }
    }
 
+   my->_snapshot_compression = options.at( "snapshot-compression" ).as<bool>();
+   if( options.count( "snapshot-delta-base" ) ) {
+      my->_snapshot_delta_base = options.at( "snapshot-delta-base" ).as<bfs::path>();
+      EOS_ASSERT( fc::is_regular_file( *my->_snapshot_delta_base ), plugin_config_exception,
+                  "snapshot-delta-base ${path} does not exist", ("path", my->_snapshot_delta_base->generic_string()) );
+   }
+
+   if( my->chain_plug->state_checkpoints().interval > 0 ) {
+      const auto& checkpoints_dir = my->chain_plug->state_checkpoints().dir;
+      if (!fc::exists(checkpoints_dir)) {
+         fc::create_directories(checkpoints_dir);
+      }
+      if (auto resmon_plugin = app().find_plugin<resource_monitor_plugin>()) {
+         resmon_plugin->monitor_directory(checkpoints_dir);
+      }
+   }
+
    my->_incoming_block_subscription = app().get_channel<incoming::channels::block>().subscribe(
          [this](const signed_block_ptr& block) {
       try {
@@ -929,6 +1280,12 @@ void producer_plugin::plugin_initialize(const boost::program_options::variables_
       return my->on_incoming_transaction_async(trx, persist_until_expired, next );
    });
 
+   my->_incoming_transaction_batch_async_provider = app().get_method<incoming::methods::transaction_batch_async>().register_provider(
+         [this](const std::vector<packed_transaction_ptr>& trxs, bool persist_until_expired,
+                std::vector<next_function<transaction_trace_ptr>> nexts) -> void {
+      return my->on_incoming_transaction_batch_async(trxs, persist_until_expired, std::move(nexts) );
+   });
+
    if (options.count("greylist-account")) {
       std::vector<std::string> greylist = options["greylist-account"].as<std::vector<std::string>>();
       greylist_params param;
@@ -969,6 +1326,7 @@ void producer_plugin::plugin_startup()
    EOS_ASSERT( my->_producers.empty() || my->chain_plug->accept_transactions(), plugin_config_exception,
               "node cannot have any producer-name configured because no block production is possible with no [api|p2p]-accepted-transactions" );
 
+   my->update_prevalidation_limits();
    my->_accepted_block_connection.emplace(chain.accepted_block.connect( [this]( const auto& bsp ){ my->on_block( bsp ); } ));
    my->_accepted_block_header_connection.emplace(chain.accepted_block_header.connect( [this]( const auto& bsp ){ my->on_block_header( bsp ); } ));
    my->_irreversible_block_connection.emplace(chain.irreversible_block.connect( [this]( const auto& bsp ){ my->on_irreversible_block( bsp->block ); } ));
@@ -1018,6 +1376,9 @@ void producer_plugin::plugin_shutdown() {
    if( my->_thread_pool ) {
       my->_thread_pool->stop();
    }
+   if( my->_snapshot_thread_pool ) {
+      my->_snapshot_thread_pool->stop();
+   }
 
    app().post( 0, [me = my](){} ); // keep my pointer alive until queue is drained
 }
@@ -1051,6 +1412,27 @@ bool producer_plugin::paused() const {
    return my->_pause_production;
 }
 
+void producer_plugin::standby() {
+   fc_ilog(_log, "Producer standby.");
+   my->_standby = true;
+}
+
+void producer_plugin::promote() {
+   my->_standby = false;
+   // start producing in the current slot if it is ours, the speculative block already has the unapplied trxs applied
+   if (my->_pending_block_mode == pending_block_mode::speculating) {
+      my->abort_block();
+      fc_ilog(_log, "Producer promoted from standby. Scheduling production.");
+      my->schedule_production_loop();
+   } else {
+      fc_ilog(_log, "Producer promoted from standby.");
+   }
+}
+
+bool producer_plugin::is_standby() const {
+   return my->_standby;
+}
+
 void producer_plugin::update_runtime_options(const runtime_options& options) {
    chain::controller& chain = my->chain_plug->chain();
    bool check_speculating = false;
@@ -1070,6 +1452,7 @@ void producer_plugin::update_runtime_options(const runtime_options& options) {
 
    if (options.last_block_time_offset_us) {
       my->_last_block_time_offset_us = *options.last_block_time_offset_us;
+      my->_production_window.set_configured_last_block_offset_us( my->_last_block_time_offset_us );
    }
 
    if (options.max_scheduled_transaction_time_per_block_ms) {
@@ -1174,13 +1557,22 @@ producer_plugin::integrity_hash_information producer_plugin::get_integrity_hash(
 }
 
 void producer_plugin::create_snapshot(producer_plugin::next_function<producer_plugin::snapshot_information> next) {
-   chain::controller& chain = my->chain_plug->chain();
+   my->create_snapshot(my->_snapshots_dir, std::move(next), my->_snapshot_delta_base);
+}
+
+void producer_plugin_impl::create_snapshot(const bfs::path& snapshots_dir, producer_plugin::next_function<producer_plugin::snapshot_information> next,
+                                           const std::optional<bfs::path>& delta_base) {
+   chain::controller& chain = chain_plug->chain();
 
    auto head_id = chain.head_block_id();
    const auto head_block_num = chain.head_block_num();
    const auto head_block_time = chain.head_block_time();
-   const auto& snapshot_path = pending_snapshot::get_final_path(head_id, my->_snapshots_dir);
-   const auto& temp_path     = pending_snapshot::get_temp_path(head_id, my->_snapshots_dir);
+   const bool  compress      = _snapshot_compression;
+   const auto  extension     = std::string(delta_base ? ".delta" : ".bin") + (compress ? ".gz" : "");
+   const auto& snapshot_path = pending_snapshot::get_final_path(head_id, snapshots_dir, extension);
+   const auto& temp_path     = pending_snapshot::get_temp_path(head_id, snapshots_dir, extension);
+   // the block vault takes full snapshots only
+   auto* const snapshot_blockvault = delta_base || compress ? nullptr : blockvault;
 
    // maintain legacy exception if the snapshot exists
    if( fc::is_regular_file(snapshot_path) ) {
@@ -1189,80 +1581,121 @@ void producer_plugin::create_snapshot(producer_plugin::next_function<producer_pl
       return;
    }
 
-   auto write_snapshot = [&]( const bfs::path& p ) -> void {
+   // if a snapshot at this block is already pending or being written, attach this requests handler to it
+   auto attach_next = [&next]( pending_snapshot::next_t& entry_next ) {
+      entry_next = [prev = entry_next, next](const std::variant<fc::exception_ptr, producer_plugin::snapshot_information>& res){
+         prev(res);
+         next(res);
+      };
+   };
+   auto& pending_by_id = _pending_snapshot_index.get<by_id>();
+   auto existing = pending_by_id.find(head_id);
+   if( existing != pending_by_id.end() ) {
+      pending_by_id.modify(existing, [&]( auto& entry ){ attach_next( entry.next ); });
+      return;
+   }
+   auto in_flight = _snapshots_in_flight.find(head_id);
+   if( in_flight != _snapshots_in_flight.end() ) {
+      attach_next( in_flight->second );
+      return;
+   }
+
+   // State is serialized to memory on the main thread, which only has to hold off block production for as long as
+   // iterating the state takes. Writing the snapshot to disk is done on the snapshot thread.
+   std::shared_ptr<std::stringstream> snap_buf;
+   try {
       auto reschedule = fc::make_scoped_exit([this](){
-         my->schedule_production_loop();
+         schedule_production_loop();
       });
 
       if (chain.is_building_block()) {
          // abort the pending block
-         my->abort_block();
+         abort_block();
       } else {
          reschedule.cancel();
       }
 
-      bfs::create_directory( p.parent_path() );
-
-      // create the snapshot
-      auto snap_out = std::ofstream(p.generic_string(), (std::ios::out | std::ios::binary));
-      auto writer = std::make_shared<ostream_snapshot_writer>(snap_out);
+      auto buf = std::make_shared<std::stringstream>(std::ios::in | std::ios::out | std::ios::binary);
+      auto writer = std::make_shared<ostream_snapshot_writer>(*buf);
       chain.write_snapshot(writer);
       writer->finalize();
-      snap_out.flush();
-      snap_out.close();
-   };
-
-   // If in irreversible mode, create snapshot and return path to snapshot immediately.
-   if( chain.get_read_mode() == db_read_mode::IRREVERSIBLE ) {
-      try {
-         write_snapshot( temp_path );
-
-         boost::system::error_code ec;
-         bfs::rename(temp_path, snapshot_path, ec);
-         EOS_ASSERT(!ec, snapshot_finalization_exception,
-               "Unable to finalize valid snapshot of block number ${bn}: [code: ${ec}] ${message}",
-               ("bn", head_block_num)
-               ("ec", ec.value())
-               ("message", ec.message()));
-
-         next( producer_plugin::snapshot_information{head_id, head_block_num, head_block_time, chain_snapshot_header::current_version, snapshot_path.generic_string()} );
-         if ( my->blockvault != nullptr ) {
-            my->blockvault->propose_snapshot( blockvault::watermark_t{head_block_num, head_block_time}, snapshot_path.generic_string().c_str() );
-         }
-      } CATCH_AND_CALL (next);
-      return;
-   }
+      snap_buf = std::move(buf);
+   } CATCH_AND_CALL (next);
+   if( !snap_buf ) return;
 
+   // If in irreversible mode, the snapshot is final once written to disk.
    // Otherwise, the result will be returned when the snapshot becomes irreversible.
-
-   // determine if this snapshot is already in-flight
-   auto& pending_by_id = my->_pending_snapshot_index.get<by_id>();
-   auto existing = pending_by_id.find(head_id);
-   if( existing != pending_by_id.end() ) {
-      // if a snapshot at this block is already pending, attach this requests handler to it
-      pending_by_id.modify(existing, [&next]( auto& entry ){
-         entry.next = [prev = entry.next, next](const std::variant<fc::exception_ptr, producer_plugin::snapshot_information>& res){
-            prev(res);
-            next(res);
-         };
-      });
-   } else {
-      const auto& pending_path = pending_snapshot::get_pending_path(head_id, my->_snapshots_dir);
-
+   const bool irreversible = chain.get_read_mode() == db_read_mode::IRREVERSIBLE;
+   const auto pending_path = pending_snapshot::get_pending_path(head_id, snapshots_dir, extension);
+   const auto dest_path = irreversible ? snapshot_path : pending_path;
+   _snapshots_in_flight.emplace(head_id, next);
+
+   boost::asio::post(_snapshot_thread_pool->get_executor(),
+                     [self = this, snap_buf{std::move(snap_buf)}, temp_path, dest_path, snapshot_path, pending_path,
+                      irreversible, compress, delta_base, snapshot_blockvault, head_id, head_block_num, head_block_time]() {
+      fc::exception_ptr except;
+      auto set_except = [&except]( const fc::exception_ptr& e ) { except = e; };
       try {
-         write_snapshot( temp_path ); // create a new pending snapshot
+         bfs::create_directory( temp_path.parent_path() );
+
+         auto snap_out = std::ofstream(temp_path.generic_string(), (std::ios::out | std::ios::binary));
+         if( delta_base ) {
+            auto base_file = std::ifstream(delta_base->generic_string(), (std::ios::in | std::ios::binary));
+            EOS_ASSERT(base_file.is_open(), snapshot_finalization_exception,
+                  "Unable to open delta snapshot base ${path}", ("path", delta_base->generic_string()));
+            // a delta is applied to the decompressed base, so it is computed against the decompressed base too
+            auto decompressed_base = std::stringstream(std::ios::in | std::ios::out | std::ios::binary);
+            const bool base_compressed = is_compressed_snapshot(base_file);
+            if( base_compressed )
+               decompress_snapshot(base_file, decompressed_base);
+            std::istream& base = base_compressed ? static_cast<std::istream&>(decompressed_base) : base_file;
+            auto delta = std::stringstream(std::ios::in | std::ios::out | std::ios::binary);
+            snapshot_delta::write(base, *snap_buf, compress ? static_cast<std::ostream&>(delta) : snap_out);
+            if( compress )
+               compress_snapshot(delta, snap_out);
+         } else if( compress ) {
+            compress_snapshot(*snap_buf, snap_out);
+         } else {
+            snap_out << snap_buf->rdbuf();
+         }
+         snap_out.flush();
+         EOS_ASSERT(snap_out.good(), snapshot_finalization_exception,
+               "Unable to write snapshot of block number ${bn} to ${path}",
+               ("bn", head_block_num)("path", temp_path.generic_string()));
+         snap_out.close();
 
          boost::system::error_code ec;
-         bfs::rename(temp_path, pending_path, ec);
+         bfs::rename(temp_path, dest_path, ec);
          EOS_ASSERT(!ec, snapshot_finalization_exception,
-               "Unable to promote temp snapshot to pending for block number ${bn}: [code: ${ec}] ${message}",
+               "Unable to finalize snapshot of block number ${bn}: [code: ${ec}] ${message}",
                ("bn", head_block_num)
                ("ec", ec.value())
                ("message", ec.message()));
-
-         my->_pending_snapshot_index.emplace(head_id, next, pending_path.generic_string(), snapshot_path.generic_string(), my->blockvault);
-      } CATCH_AND_CALL (next);
-   }
+      } CATCH_AND_CALL (set_except);
+
+      app().post( priority::medium, [self, except, snapshot_path, pending_path, irreversible, snapshot_blockvault,
+                                     head_id, head_block_num, head_block_time]() {
+         auto itr = self->_snapshots_in_flight.find( head_id );
+         if( itr == self->_snapshots_in_flight.end() ) return;
+         auto next = std::move( itr->second );
+         self->_snapshots_in_flight.erase( itr );
+
+         if( except ) {
+            next( except );
+            return;
+         }
+         if( irreversible ) {
+            next( producer_plugin::snapshot_information{head_id, head_block_num, head_block_time, chain_snapshot_header::current_version, snapshot_path.generic_string()} );
+            if ( snapshot_blockvault != nullptr ) {
+               snapshot_blockvault->propose_snapshot( blockvault::watermark_t{head_block_num, head_block_time}, snapshot_path.generic_string().c_str() );
+            }
+         } else {
+            self->_pending_snapshot_index.emplace(head_id, next, pending_path.generic_string(), snapshot_path.generic_string(), snapshot_blockvault);
+            // block may have become irreversible while the snapshot was being written
+            self->promote_pending_snapshots( self->chain_plug->chain().last_irreversible_block_num() );
+         }
+      } );
+   });
 }
 
 producer_plugin::scheduled_protocol_feature_activations
@@ -1326,6 +1759,11 @@ fc::variants producer_plugin::get_supported_protocol_features( const get_support
    return results;
 }
 
+std::vector<chain::subsystem_memory> producer_plugin::get_memory_usage() const {
+   return { { "unapplied_transaction_queue", my->_unapplied_transactions.bytes_size(), my->_unapplied_transactions.size() },
+            { "failed_transaction_cache", 0, my->_failed_trx_cache.size() } };
+}
+
 producer_plugin::get_account_ram_corrections_result
 producer_plugin::get_account_ram_corrections( const get_account_ram_corrections_params& params ) const {
    get_account_ram_corrections_result result;
@@ -1370,10 +1808,32 @@ producer_plugin::get_account_ram_corrections( const get_account_ram_corrections_
    return result;
 }
 
+producer_plugin::get_action_profile_result
+producer_plugin::get_action_profile( const get_action_profile_params& params ) {
+   EOS_ASSERT( my->_applied_transaction_connection, plugin_config_exception, "action-profile is not enabled" );
+
+   get_action_profile_result result;
+   result.since = my->_action_profile_since;
+   result.actions.reserve( my->_action_profile.size() );
+   for( const auto& [key, stats] : my->_action_profile ) {
+      result.actions.push_back( { std::get<0>(key), std::get<1>(key), std::get<2>(key), stats.count, stats.total_us, stats.max_us } );
+   }
+   const auto n = std::min<size_t>( params.limit, result.actions.size() );
+   std::partial_sort( result.actions.begin(), result.actions.begin() + n, result.actions.end(),
+                      []( const auto& a, const auto& b ) { return a.total_us > b.total_us; } );
+   result.actions.resize( n );
+
+   if( params.reset ) {
+      my->_action_profile.clear();
+      my->_action_profile_since = fc::time_point::now();
+   }
+   return result;
+}
+
 std::optional<fc::time_point> producer_plugin_impl::calculate_next_block_time(const account_name& producer_name, const block_timestamp_type& current_block_time) const {
    chain::controller& chain = chain_plug->chain();
    const auto& hbs = chain.head_block_state();
-   const auto& active_schedule = hbs->active_schedule.producers;
+   const auto& active_schedule = hbs->active_schedule->producers;
 
    // determine if this producer is in the active schedule and if so, where
    auto itr = std::find_if(active_schedule.begin(), active_schedule.end(), [&](const auto& asp){ return asp.producer_name == producer_name; });
@@ -1442,6 +1902,11 @@ fc::time_point producer_plugin_impl::calculate_pending_block_time() const {
 fc::time_point producer_plugin_impl::calculate_block_deadline( const fc::time_point& block_time ) const {
    if( _pending_block_mode == pending_block_mode::producing ) {
       bool last_block = ((block_timestamp_type( block_time ).slot % config::producer_repetitions) == config::producer_repetitions - 1);
+      if( _adaptive_cpu_effort ) {
+         const int32_t offset_us = last_block ? _production_window.last_block_time_offset_us( _last_block_time_offset_us )
+                                              : _production_window.produce_time_offset_us( _produce_time_offset_us );
+         return block_time + fc::microseconds( offset_us );
+      }
       return block_time + fc::microseconds(last_block ? _last_block_time_offset_us : _produce_time_offset_us);
    } else {
       return block_time + fc::microseconds(_produce_time_offset_us);
@@ -1494,6 +1959,9 @@ producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
    } else if ( _pause_production ) {
       elog("Not producing block because production is explicitly paused");
       _pending_block_mode = pending_block_mode::speculating;
+   } else if ( _standby ) {
+      fc_dlog(_log, "Not producing block because node is a standby");
+      _pending_block_mode = pending_block_mode::speculating;
    } else if ( _max_irreversible_block_age_us.count() >= 0 && irreversible_block_age >= _max_irreversible_block_age_us ) {
       elog("Not producing block because the irreversible block is too old [age:${age}s, max:${max}s]", ("age", irreversible_block_age.count() / 1'000'000)( "max", _max_irreversible_block_age_us.count() / 1'000'000 ));
       _pending_block_mode = pending_block_mode::speculating;
@@ -1632,23 +2100,18 @@ producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
             return start_block_result::exhausted;
          if( !_subjective_billing.remove_expired( _log, chain.pending_block_time(), fc::time_point::now(), preprocess_deadline ) )
             return start_block_result::exhausted;
+         _failed_trx_cache.remove_expired( chain.pending_block_time() );
 
          // limit execution of pending incoming to once per block
          size_t pending_incoming_process_limit = _unapplied_transactions.incoming_size();
+         _unapplied_transactions.restore_skipped_incoming();
 
          if( !process_unapplied_trxs( preprocess_deadline ) )
             return start_block_result::exhausted;
 
          if (_pending_block_mode == pending_block_mode::producing) {
-            auto scheduled_trx_deadline = preprocess_deadline;
-            if (_max_scheduled_transaction_time_per_block_ms >= 0) {
-               scheduled_trx_deadline = std::min<fc::time_point>(
-                     scheduled_trx_deadline,
-                     fc::time_point::now() + fc::milliseconds(_max_scheduled_transaction_time_per_block_ms)
-               );
-            }
-            // may exhaust scheduled_trx_deadline but not preprocess_deadline, exhausted preprocess_deadline checked below
-            process_scheduled_and_incoming_trxs( scheduled_trx_deadline, pending_incoming_process_limit );
+            // may exhaust scheduled trx time budget but not preprocess_deadline, exhausted preprocess_deadline checked below
+            process_scheduled_and_incoming_trxs( preprocess_deadline, pending_incoming_process_limit );
          }
 
          if( app().is_quiting() ) // db guard exception above in LOG_AND_DROP could have called app().quit()
@@ -1843,10 +2306,10 @@ bool producer_plugin_impl::process_unapplied_trxs( const fc::time_point& deadlin
       int num_applied = 0, num_failed = 0, num_processed = 0;
       auto unapplied_trxs_size = _unapplied_transactions.size();
       // unapplied and persisted do not have a next method to call
-      auto itr     = (_pending_block_mode == pending_block_mode::producing) ?
-                     _unapplied_transactions.unapplied_begin() : _unapplied_transactions.persisted_begin();
-      auto end_itr = (_pending_block_mode == pending_block_mode::producing) ?
-                     _unapplied_transactions.unapplied_end()   : _unapplied_transactions.persisted_end();
+      // a standby applies the same transactions a producer would to keep its state and caches warm
+      const bool apply_all = _pending_block_mode == pending_block_mode::producing || _standby;
+      auto itr     = apply_all ? _unapplied_transactions.unapplied_begin() : _unapplied_transactions.persisted_begin();
+      auto end_itr = apply_all ? _unapplied_transactions.unapplied_end()   : _unapplied_transactions.persisted_end();
       while( itr != end_itr ) {
          if( deadline <= fc::time_point::now() ) {
             exhausted = true;
@@ -1865,6 +2328,10 @@ bool producer_plugin_impl::process_unapplied_trxs( const fc::time_point& deadlin
                itr = _unapplied_transactions.erase( itr );
                continue;
             }
+            if( exceeds_block_budget( trx, deadline ) ) {
+               ++itr;
+               continue;
+            }
 
             auto prev_billed_cpu_time_us = trx->billed_cpu_time_us;
             if(!_subjective_billing.is_disabled() && prev_billed_cpu_time_us > 0 && !rl.is_unlimited_cpu( first_auth )) {
@@ -1881,6 +2348,7 @@ bool producer_plugin_impl::process_unapplied_trxs( const fc::time_point& deadlin
             // no subjective billing since we are producing or processing persisted trxs
             const uint32_t sub_bill = 0;
 
+            const trx_state_version state_version = pending_trx_state_version();
             auto trace = chain.push_transaction( trx, trx_deadline, prev_billed_cpu_time_us, false, sub_bill );
             fc_dlog( _trx_failed_trace_log, "Subjective unapplied bill for ${a}: ${b} prev ${t}us", ("a",first_auth)("b",prev_billed_cpu_time_us)("t",trace->elapsed));
             if( trace->except ) {
@@ -1901,6 +2369,9 @@ bool producer_plugin_impl::process_unapplied_trxs( const fc::time_point& deadlin
                               ("r", fc::time_point::now() - start)("id", trx->id()) );
                      account_fails.add( first_auth, failure_code );
                      _subjective_billing.subjective_bill_failure( first_auth, trace->elapsed, fc::time_point::now() );
+                     if( exception_is_deterministic( *trace->except ) )
+                        _failed_trx_cache.add( trx->id(), trx->packed_trx()->expiration(), state_version,
+                                               trace->except->dynamic_copy_exception() );
                   }
                   ++num_failed;
                   if( itr->next ) itr->next( trace );
@@ -1932,6 +2403,9 @@ bool producer_plugin_impl::process_unapplied_trxs( const fc::time_point& deadlin
 
 void producer_plugin_impl::process_scheduled_and_incoming_trxs( const fc::time_point& deadline, size_t& pending_incoming_process_limit )
 {
+   // number of due scheduled transactions collected per walk of the by_delay index
+   constexpr size_t scheduled_trx_batch_size = 64;
+
    // scheduled transactions
    int num_applied = 0;
    int num_failed = 0;
@@ -1939,101 +2413,130 @@ void producer_plugin_impl::process_scheduled_and_incoming_trxs( const fc::time_p
    bool exhausted = false;
    double incoming_trx_weight = 0.0;
 
+   // only time spent retiring scheduled transactions counts against the budget, not interleaved incoming transactions
+   const bool scheduled_time_limited = _max_scheduled_transaction_time_per_block_ms >= 0;
+   const fc::microseconds scheduled_time_budget = fc::milliseconds( std::max( _max_scheduled_transaction_time_per_block_ms, 0 ) );
+   fc::microseconds scheduled_time{0};
+
    auto& blacklist_by_id = _blacklisted_transactions.get<by_id>();
    chain::controller& chain = chain_plug->chain();
    time_point pending_block_time = chain.pending_block_time();
-   auto itr = _unapplied_transactions.incoming_begin();
+   auto itr = _unapplied_transactions.next_incoming();
    auto end = _unapplied_transactions.incoming_end();
    const auto& sch_idx = chain.db().get_index<generated_transaction_multi_index,by_delay>();
+   const auto& sch_by_trx_id = chain.db().get_index<generated_transaction_multi_index,by_trx_id>();
    const auto scheduled_trxs_size = sch_idx.size();
-   auto sch_itr = sch_idx.begin();
-   while( sch_itr != sch_idx.end() ) {
-      if( sch_itr->delay_until > pending_block_time) break;    // not scheduled yet
-      if( exhausted || deadline <= fc::time_point::now() ) {
-         exhausted = true;
-         break;
-      }
-      if( sch_itr->published >= pending_block_time ) {
-         ++sch_itr;
-         continue; // do not allow schedule and execute in same block
-      }
 
-      if (blacklist_by_id.find(sch_itr->trx_id) != blacklist_by_id.end()) {
+   struct scheduled_trx {
+      transaction_id_type trx_id;
+      time_point          expiration;
+   };
+   std::vector<scheduled_trx> batch;
+   batch.reserve( scheduled_trx_batch_size );
+
+   auto sch_itr = sch_idx.begin();
+   while( !exhausted ) {
+      batch.clear();
+      while( sch_itr != sch_idx.end() && batch.size() < scheduled_trx_batch_size ) {
+         if( sch_itr->delay_until > pending_block_time ) {
+            sch_itr = sch_idx.end(); // not scheduled yet
+            break;
+         }
+         // do not allow schedule and execute in same block
+         if( sch_itr->published < pending_block_time && blacklist_by_id.find( sch_itr->trx_id ) == blacklist_by_id.end() ) {
+            batch.push_back( scheduled_trx{ sch_itr->trx_id, sch_itr->expiration } );
+         }
          ++sch_itr;
-         continue;
       }
+      if( batch.empty() ) break;
 
-      const transaction_id_type trx_id = sch_itr->trx_id; // make copy since reference could be invalidated
-      const auto sch_expiration = sch_itr->expiration;
-      auto sch_itr_next = sch_itr; // save off next since sch_itr may be invalidated by loop
-      ++sch_itr_next;
-      const auto next_delay_until = sch_itr_next != sch_idx.end() ? sch_itr_next->delay_until : sch_itr->delay_until;
-      const auto next_id = sch_itr_next != sch_idx.end() ? sch_itr_next->id : sch_itr->id;
-
-      num_processed++;
+      // index is modified by processing the batch, save off key to resume from
+      const bool more = sch_itr != sch_idx.end();
+      const auto next_delay_until = more ? sch_itr->delay_until : time_point{};
+      const auto next_id = more ? sch_itr->id : generated_transaction_object::id_type{};
 
-      // configurable ratio of incoming txns vs deferred txns
-      while (incoming_trx_weight >= 1.0 && pending_incoming_process_limit && itr != end ) {
-         if (deadline <= fc::time_point::now()) {
+      for( const auto& sch : batch ) {
+         if( deadline <= fc::time_point::now() || (scheduled_time_limited && scheduled_time >= scheduled_time_budget) ) {
             exhausted = true;
             break;
          }
 
-         --pending_incoming_process_limit;
-         incoming_trx_weight -= 1.0;
+         // configurable ratio of incoming txns vs deferred txns
+         while (incoming_trx_weight >= 1.0 && pending_incoming_process_limit && itr != end ) {
+            if (deadline <= fc::time_point::now()) {
+               exhausted = true;
+               break;
+            }
 
-         auto trx_meta = itr->trx_meta;
-         auto next = itr->next;
-         bool persist_until_expired = itr->trx_type == trx_enum_type::incoming_persisted;
-         itr = _unapplied_transactions.erase( itr );
-         if( !process_incoming_transaction_async( trx_meta, persist_until_expired, next ) ) {
+            --pending_incoming_process_limit;
+            incoming_trx_weight -= 1.0;
+
+            auto trx_meta = itr->trx_meta;
+            auto next = itr->next;
+            bool persist_until_expired = itr->trx_type == trx_enum_type::incoming_persisted;
+            _unapplied_transactions.erase( itr );
+            if( !process_incoming_transaction_async( trx_meta, persist_until_expired, next ) ) {
+               exhausted = true;
+               break;
+            }
+            itr = _unapplied_transactions.next_incoming();
+         }
+
+         if (exhausted || deadline <= fc::time_point::now()) {
             exhausted = true;
             break;
          }
-      }
 
-      if (exhausted || deadline <= fc::time_point::now()) {
-         exhausted = true;
-         break;
-      }
+         // may have been canceled by a transaction applied since the batch was collected
+         if( sch_by_trx_id.find( sch.trx_id ) == sch_by_trx_id.end() ) continue;
 
-      try {
-         auto trx_deadline = fc::time_point::now() + fc::milliseconds(_max_transaction_time_ms);
-         bool deadline_is_subjective = false;
-         if (_max_transaction_time_ms < 0 || (_pending_block_mode == pending_block_mode::producing && deadline < trx_deadline)) {
-            deadline_is_subjective = true;
-            trx_deadline = deadline;
-         }
+         num_processed++;
 
-         auto trace = chain.push_scheduled_transaction(trx_id, trx_deadline, 0, false);
-         if (trace->except) {
-            if (exception_is_exhausted(*trace->except, deadline_is_subjective)) {
-               if( block_is_exhausted() ) {
-                  exhausted = true;
-                  break;
+         const auto start = fc::time_point::now();
+         try {
+            auto sch_deadline = deadline;
+            if( scheduled_time_limited ) {
+               sch_deadline = std::min( sch_deadline, start + (scheduled_time_budget - scheduled_time) );
+            }
+            auto trx_deadline = start + fc::milliseconds(_max_transaction_time_ms);
+            bool deadline_is_subjective = false;
+            if (_max_transaction_time_ms < 0 || (_pending_block_mode == pending_block_mode::producing && sch_deadline < trx_deadline)) {
+               deadline_is_subjective = true;
+               trx_deadline = sch_deadline;
+            }
+
+            auto trace = chain.push_scheduled_transaction(sch.trx_id, trx_deadline, 0, false);
+            if (trace->except) {
+               if (exception_is_exhausted(*trace->except, deadline_is_subjective)) {
+                  if( block_is_exhausted() ) {
+                     exhausted = true;
+                  }
+                  // do not blacklist
+               } else {
+                  // this failed our configured maximum transaction time, we don't want to replay it add it to a blacklist
+                  _blacklisted_transactions.insert(transaction_id_with_expiry{sch.trx_id, sch.expiration});
+                  num_failed++;
                }
-               // do not blacklist
             } else {
-               // this failed our configured maximum transaction time, we don't want to replay it add it to a blacklist
-               _blacklisted_transactions.insert(transaction_id_with_expiry{trx_id, sch_expiration});
-               num_failed++;
+               num_applied++;
             }
-         } else {
-            num_applied++;
-         }
-      } LOG_AND_DROP();
+         } LOG_AND_DROP();
+         scheduled_time += fc::time_point::now() - start;
+         if( exhausted ) break;
 
-      incoming_trx_weight += _incoming_defer_ratio;
-      if (!pending_incoming_process_limit) incoming_trx_weight = 0.0;
+         incoming_trx_weight += _incoming_defer_ratio;
+         if (!pending_incoming_process_limit) incoming_trx_weight = 0.0;
+      }
 
-      if( sch_itr_next == sch_idx.end() ) break;
+      if( !more ) break;
       sch_itr = sch_idx.lower_bound( boost::make_tuple( next_delay_until, next_id ) );
    }
 
    if( scheduled_trxs_size > 0 ) {
       fc_dlog( _log,
-               "Processed ${m} of ${n} scheduled transactions, Applied ${applied}, Failed/Dropped ${failed}",
-               ( "m", num_processed )( "n", scheduled_trxs_size )( "applied", num_applied )( "failed", num_failed ) );
+               "Processed ${m} of ${n} scheduled transactions, Applied ${applied}, Failed/Dropped ${failed}, in ${t}us",
+               ( "m", num_processed )( "n", scheduled_trxs_size )( "applied", num_applied )( "failed", num_failed )
+               ( "t", scheduled_time.count() ) );
    }
 }
 
@@ -2043,7 +2546,7 @@ bool producer_plugin_impl::process_incoming_trxs( const fc::time_point& deadline
    if( pending_incoming_process_limit ) {
       size_t processed = 0;
       fc_dlog( _log, "Processing ${n} pending transactions", ("n", pending_incoming_process_limit) );
-      auto itr = _unapplied_transactions.incoming_begin();
+      auto itr = _unapplied_transactions.next_incoming();
       auto end = _unapplied_transactions.incoming_end();
       while( pending_incoming_process_limit && itr != end ) {
          if (deadline <= fc::time_point::now()) {
@@ -2051,21 +2554,54 @@ bool producer_plugin_impl::process_incoming_trxs( const fc::time_point& deadline
             break;
          }
          --pending_incoming_process_limit;
+         if( exceeds_block_budget( itr->trx_meta, deadline ) ) {
+            // try smaller trxs behind it, retried next block
+            _unapplied_transactions.skip_incoming( itr );
+            itr = _unapplied_transactions.next_incoming();
+            continue;
+         }
          auto trx_meta = itr->trx_meta;
          auto next = itr->next;
          bool persist_until_expired = itr->trx_type == trx_enum_type::incoming_persisted;
-         itr = _unapplied_transactions.erase( itr );
+         _unapplied_transactions.erase( itr );
          ++processed;
          if( !process_incoming_transaction_async( trx_meta, persist_until_expired, next ) ) {
             exhausted = true;
             break;
          }
+         itr = _unapplied_transactions.next_incoming();
       }
       fc_dlog( _log, "Processed ${n} pending transactions, ${p} left", ("n", processed)("p", _unapplied_transactions.incoming_size()) );
    }
    return !exhausted;
 }
 
+uint32_t producer_plugin_impl::expected_cpu_us( const transaction_metadata_ptr& trx ) const {
+   if( !_unapplied_transactions.is_fair_incoming_scheduling() ) return 0;
+   // recent subjective cpu of the first authorizer, 0 when subjective billing is disabled
+   const auto first_auth = trx->packed_trx()->get_transaction().first_authorizer();
+   return _subjective_billing.get_subjective_bill( first_auth, fc::time_point::now() );
+}
+
+bool producer_plugin_impl::exceeds_block_budget( const transaction_metadata_ptr& trx, const fc::time_point& deadline ) const {
+   if( !_block_packing || _pending_block_mode != pending_block_mode::producing ) return false;
+   uint64_t estimate = trx->billed_cpu_time_us;
+   if( estimate == 0 )
+      estimate = _subjective_billing.get_expected_trx_cpu_us( trx->packed_trx()->get_transaction().first_authorizer() );
+   if( estimate == 0 ) return false; // unknown, try it
+
+   const chain::controller& chain = chain_plug->chain();
+   uint64_t remaining = chain.get_resource_limits_manager().get_block_cpu_limit();
+   const auto now = fc::time_point::now();
+   remaining = deadline > now ? std::min<uint64_t>( remaining, (deadline - now).count() ) : 0;
+   return estimate > remaining;
+}
+
+trx_state_version producer_plugin_impl::pending_trx_state_version() const {
+   const chain::controller& chain = chain_plug->chain();
+   return { chain.head_block_id(), chain.pending_block_time(), chain.get_pending_trx_receipts().size() };
+}
+
 bool producer_plugin_impl::block_is_exhausted() const {
    const chain::controller& chain = chain_plug->chain();
    const auto& rl = chain.get_resource_limits_manager();
@@ -2276,6 +2812,7 @@ void block_only_sync::on_block(eosio::chain::signed_block_ptr block) {
 
 void producer_plugin_impl::produce_block() {
    //ilog("produce_block ${t}", ("t", fc::time_point::now())); // for testing _produce_time_offset_us
+   const auto produce_start = fc::time_point::now();
    EOS_ASSERT(_pending_block_mode == pending_block_mode::producing, producer_exception, "called produce_block while not actually producing");
    chain::controller& chain = chain_plug->chain();
    EOS_ASSERT(chain.is_building_block(), missing_pending_block_state, "pending_block_state does not exist but it should, another plugin may have corrupted it");
@@ -2327,6 +2864,8 @@ void producer_plugin_impl::produce_block() {
 
    chain.commit_block();
    block_state_ptr new_bs = chain.head_block_state();
+   const bool last_block = (new_bs->header.timestamp.slot % config::producer_repetitions) == config::producer_repetitions - 1;
+   _production_window.block_produced( new_bs->id, new_bs->header.timestamp, last_block, fc::time_point::now() - produce_start );
    ilog("Produced block ${id}... #${n} @ ${t} signed by ${p} [trxs: ${count}, lib: ${lib}, confirmed: ${confs}]",
         ("p",new_bs->header.producer)("id",new_bs->id.str().substr(8,16))
         ("n",new_bs->block_num)("t",new_bs->header.timestamp)
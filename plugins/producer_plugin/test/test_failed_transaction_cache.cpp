@@ -0,0 +1,71 @@
+#define BOOST_TEST_MODULE failed_transaction_cache
+#include <boost/test/included/unit_test.hpp>
+
+#include <eosio/producer_plugin/failed_transaction_cache.hpp>
+
+#include <eosio/testing/tester.hpp>
+
+namespace {
+
+using namespace eosio;
+using namespace eosio::chain;
+
+BOOST_AUTO_TEST_SUITE( failed_transaction_cache_test )
+
+BOOST_AUTO_TEST_CASE( failed_trx_cache_test ) {
+
+   transaction_id_type id1 = sha256::hash( "1" );
+   transaction_id_type id2 = sha256::hash( "2" );
+   transaction_id_type id3 = sha256::hash( "3" );
+
+   const auto now = fc::time_point::now();
+   const trx_state_version v1{ sha256::hash( "head1" ), now, 0 };
+   trx_state_version v1_applied = v1;
+   ++v1_applied.pending_trx_count;
+   const trx_state_version v2{ sha256::hash( "head2" ), now + fc::milliseconds( 500 ), 0 };
+
+   auto except = std::make_shared<eosio_assert_message_exception>(
+         FC_LOG_MESSAGE( error, "assertion failure with message: overdrawn balance" ) );
+
+   {  // failure is only remembered against the state it executed against
+      failed_transaction_cache cache;
+      cache.add( id1, now + fc::seconds( 10 ), v1, except );
+      BOOST_CHECK_EQUAL( cache.size(), 1u );
+      BOOST_CHECK( cache.get( id1, v1 ) == except );
+      BOOST_CHECK( cache.get( id1, v1 ) == except );
+      BOOST_CHECK( !cache.get( id2, v1 ) );
+
+      // a trx applied to the pending block changes state
+      BOOST_CHECK( !cache.get( id1, v1_applied ) );
+      BOOST_CHECK_EQUAL( cache.size(), 0u );
+
+      cache.add( id1, now + fc::seconds( 10 ), v1, except );
+      BOOST_CHECK( !cache.get( id1, v2 ) );
+      BOOST_CHECK( !cache.get( id1, v1 ) );
+   }
+   {  // expiry and size limit
+      failed_transaction_cache cache;
+      cache.set_max_size( 2 );
+      cache.add( id1, now + fc::seconds( 10 ), v1, except );
+      cache.add( id2, now + fc::seconds( 5 ), v1, except );
+      cache.add( id3, now + fc::seconds( 20 ), v1, except );
+      BOOST_CHECK_EQUAL( cache.size(), 2u );
+      BOOST_CHECK( !cache.get( id2, v1 ) ); // earliest expiry evicted
+
+      cache.remove_expired( now + fc::seconds( 10 ) );
+      BOOST_CHECK_EQUAL( cache.size(), 1u );
+      BOOST_CHECK( !cache.get( id1, v1 ) );
+      BOOST_CHECK( cache.get( id3, v1 ) == except );
+   }
+   {  // disabled
+      failed_transaction_cache cache;
+      cache.set_max_size( 0 );
+      cache.add( id1, now + fc::seconds( 10 ), v1, except );
+      BOOST_CHECK_EQUAL( cache.size(), 0u );
+      BOOST_CHECK( !cache.get( id1, v1 ) );
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
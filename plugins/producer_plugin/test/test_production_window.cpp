@@ -0,0 +1,74 @@
+#define BOOST_TEST_MODULE production_window
+#include <boost/test/included/unit_test.hpp>
+
+#include <eosio/producer_plugin/production_window.hpp>
+
+#include <eosio/testing/tester.hpp>
+
+namespace {
+
+using namespace eosio;
+using namespace eosio::chain;
+
+BOOST_AUTO_TEST_SUITE( production_window_test )
+
+BOOST_AUTO_TEST_CASE( production_window_offsets_test ) {
+
+   const int32_t configured_offset_us = -100'000;
+   const int32_t configured_last_offset_us = -200'000;
+   const auto produce_time = fc::microseconds( 20'000 );
+   const auto apply_time = fc::microseconds( 30'000 );
+
+   production_window pw;
+   pw.set_configured_last_block_offset_us( configured_last_offset_us );
+
+   const block_id_type our_last = sha256::hash( "ours" );
+   const block_id_type other = sha256::hash( "other" );
+   block_timestamp_type ts( 12 * 100 + config::producer_repetitions - 1 );
+
+   // configured offsets until enough samples
+   for( uint32_t i = 0; i < production_window::min_samples - 1; ++i ) {
+      pw.block_produced( sha256::hash( std::to_string( i ) ), block_timestamp_type( i ), false, produce_time );
+      pw.block_applied( apply_time );
+   }
+   BOOST_CHECK_EQUAL( pw.produce_time_offset_us( configured_offset_us ), configured_offset_us );
+   BOOST_CHECK_EQUAL( pw.last_block_time_offset_us( configured_last_offset_us ), configured_last_offset_us );
+
+   pw.block_produced( our_last, ts, true, produce_time );
+   pw.block_applied( apply_time );
+   const int32_t produce_offset = -( produce_time.count() + production_window::safety_margin_us );
+   BOOST_CHECK_EQUAL( pw.produce_time_offset_us( configured_offset_us ), produce_offset );
+   BOOST_CHECK_EQUAL( pw.last_block_time_offset_us( configured_last_offset_us ), configured_last_offset_us );
+
+   // next producer built on our last block, margin shrinks by a step
+   pw.block_received( our_last, ts.next() );
+   BOOST_CHECK_EQUAL( pw.last_block_time_offset_us( configured_last_offset_us ),
+                      configured_last_offset_us + production_window::margin_step_us );
+   // only the first block after ours counts
+   pw.block_received( our_last, ts.next().next() );
+   BOOST_CHECK_EQUAL( pw.last_block_time_offset_us( configured_last_offset_us ),
+                      configured_last_offset_us + production_window::margin_step_us );
+   BOOST_CHECK_EQUAL( pw.get_dropped_blocks(), 0u );
+
+   // next producer dropped our last block, margin doubles up to max
+   ts = block_timestamp_type( ts.slot + config::producer_repetitions * 21 );
+   pw.block_produced( our_last, ts, true, produce_time );
+   pw.block_received( other, ts.next() );
+   BOOST_CHECK_EQUAL( pw.get_dropped_blocks(), 1u );
+   BOOST_CHECK_EQUAL( pw.last_block_time_offset_us( configured_last_offset_us ),
+                      -std::min<int64_t>( 2 * ( -configured_last_offset_us - production_window::margin_step_us ),
+                                          production_window::max_margin_us ) );
+
+   // margin never shrinks below measured produce plus apply time
+   for( uint32_t i = 0; i < 100; ++i ) {
+      ts = block_timestamp_type( ts.slot + config::producer_repetitions * 21 );
+      pw.block_produced( our_last, ts, true, produce_time );
+      pw.block_received( our_last, ts.next() );
+   }
+   BOOST_CHECK_EQUAL( pw.last_block_time_offset_us( configured_last_offset_us ),
+                      -( produce_time.count() + apply_time.count() + production_window::safety_margin_us ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -5,6 +5,9 @@
 
 #include <eosio/testing/tester.hpp>
 
+#include <atomic>
+#include <thread>
+
 namespace {
 
 using namespace eosio;
@@ -160,6 +163,66 @@ BOOST_AUTO_TEST_CASE( subjective_bill_test ) {
 
 }
 
+BOOST_AUTO_TEST_CASE( expected_trx_cpu_test ) {
+
+   transaction_id_type id1 = sha256::hash( "1" );
+   transaction_id_type id2 = sha256::hash( "2" );
+   account_name a = "a"_n;
+   account_name b = "b"_n;
+
+   const auto now = time_point::now();
+
+   subjective_billing sub_bill;
+   BOOST_CHECK_EQUAL( 0, sub_bill.get_expected_trx_cpu_us( a ) );
+
+   sub_bill.subjective_bill( id1, now, a, fc::microseconds( 800 ), false );
+   BOOST_CHECK_EQUAL( 800, sub_bill.get_expected_trx_cpu_us( a ) );
+
+   // moving average of successful and failed transactions
+   sub_bill.subjective_bill( id2, now, a, fc::microseconds( 0 ), false );
+   BOOST_CHECK_EQUAL( 700, sub_bill.get_expected_trx_cpu_us( a ) );
+   sub_bill.subjective_bill_failure( a, fc::microseconds( 1500 ), now );
+   BOOST_CHECK_EQUAL( 800, sub_bill.get_expected_trx_cpu_us( a ) );
+
+   // same trx is only counted once
+   sub_bill.subjective_bill( id1, now, a, fc::microseconds( 100 ), false );
+   BOOST_CHECK_EQUAL( 800, sub_bill.get_expected_trx_cpu_us( a ) );
+
+   BOOST_CHECK_EQUAL( 0, sub_bill.get_expected_trx_cpu_us( b ) );
+}
+
+BOOST_AUTO_TEST_CASE( concurrent_read_test ) {
+
+   const auto now = time_point::now();
+   const std::vector<account_name> accounts{ "a"_n, "b"_n, "c"_n, "d"_n, "eeeeeeeeeeeee"_n, "alice"_n, "bob"_n };
+   constexpr uint32_t num_bills = 2000;
+
+   subjective_billing sub_bill;
+   std::atomic<bool> done{false};
+   std::vector<std::thread> readers;
+   for( size_t i = 0; i < 4; ++i ) {
+      readers.emplace_back( [&]() {
+         while( !done ) {
+            for( const auto& a : accounts ) {
+               sub_bill.get_subjective_bill( a, now );
+               sub_bill.get_expected_trx_cpu_us( a );
+            }
+         }
+      } );
+   }
+
+   for( uint32_t i = 0; i < num_bills; ++i ) {
+      sub_bill.subjective_bill( sha256::hash( std::to_string( i ) ), now, accounts[i % accounts.size()],
+                                fc::microseconds( 1 ), false );
+   }
+   done = true;
+   for( auto& t : readers ) t.join();
+
+   uint64_t total = 0;
+   for( const auto& a : accounts ) total += sub_bill.get_subjective_bill( a, now );
+   BOOST_CHECK_EQUAL( num_bills, total );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
@@ -5,6 +5,10 @@
 
 #include <appbase/application.hpp>
 #include <eosio/chain/exceptions.hpp>
+#include <eosio/resource_monitor_plugin/io_stats.hpp>
+
+#include <chrono>
+#include <mutex>
 
 namespace bfs = boost::filesystem;
 
@@ -40,7 +44,57 @@ namespace eosio::resource_monitor {
          warning_interval = new_warning_interval;
       }
 
+      // percentage of the time a device is busy over a check above which a warning is generated
+      void set_io_utilization_threshold(uint32_t new_threshold) {
+         io_utilization_threshold = new_threshold;
+      }
+
+      // Check interval to use until the next check. Close to a threshold, i.e. once the
+      // warning threshold is hit or if the shutdown threshold would be hit within two
+      // intervals at the current rate, space is checked every fast_sleep_time_in_secs.
+      uint32_t next_sleep_time() const {
+         return approaching_threshold ? std::min(fast_sleep_time_in_secs, sleep_time_in_secs) : sleep_time_in_secs;
+      }
+
+      // Sample the I/O counters of the devices of the monitored file systems
+      void update_io_stats() {
+         const auto now = std::chrono::steady_clock::now();
+         for (auto& fs: filesystems) {
+            io_stats stats;
+            if (!space_provider.get_io_stats(fs.st_dev, stats))
+               continue;
+
+            if (fs.io && fs.io_sampled < now) {
+               const auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - fs.io_sampled).count();
+               const auto busy_ms = stats.io_time_ms - fs.io->io_time_ms;
+               fs.io_utilization = std::min(100.0, 100.0 * busy_ms / std::max<int64_t>(elapsed_ms, 1));
+               if (fs.io_utilization >= io_utilization_threshold && output_threshold_warning) {
+                  const auto ios = (stats.reads - fs.io->reads) + (stats.writes - fs.io->writes);
+                  const auto io_ms = (stats.read_time_ms - fs.io->read_time_ms) + (stats.write_time_ms - fs.io->write_time_ms);
+                  wlog("I/O saturation warning: ${path}'s device was busy ${u}% of the last ${s} ms, average latency ${l} ms, written ${w} bytes",
+                       ("path", fs.path_name.string())("u", static_cast<uint32_t>(fs.io_utilization))("s", elapsed_ms)
+                       ("l", ios ? double(io_ms) / ios : 0.0)("w", stats.write_bytes - fs.io->write_bytes));
+               }
+            }
+            std::lock_guard<std::mutex> g(metrics_mtx);
+            fs.io = stats;
+            fs.io_sampled = now;
+         }
+      }
+
+      // Snapshot of the last check of each monitored file system, safe to call from any thread
+      std::vector<filesystem_metrics> get_filesystem_metrics() const {
+         std::vector<filesystem_metrics> result;
+         std::lock_guard<std::mutex> g(metrics_mtx);
+         for (const auto& fs: filesystems)
+            result.push_back({fs.path_name.string(), fs.capacity, fs.available, fs.io, fs.io_utilization});
+         return result;
+      }
+
       bool is_threshold_exceeded() {
+         const auto now = std::chrono::steady_clock::now();
+         approaching_threshold = false;
+
          // Go over each monitored file system
          for (auto& fs: filesystems) {
             boost::system::error_code ec;
@@ -57,6 +111,8 @@ namespace eosio::resource_monitor {
                continue;
             }
 
+            update_space(fs, info, now);
+
             if ( info.available < fs.shutdown_available ) {
                if (output_threshold_warning) {
                   wlog("Space usage warning: ${path}'s file system exceeded threshold ${threshold}%, available: ${available}, Capacity: ${capacity}, shutdown_available: ${shutdown_available}", ("path", fs.path_name.string()) ("threshold", shutdown_threshold) ("available", info.available) ("capacity", info.capacity) ("shutdown_available", fs.shutdown_available));
@@ -107,7 +163,11 @@ namespace eosio::resource_monitor {
          auto warning_available = (100 - warning_threshold) * (info.capacity / 100);
 
          // Add to the list
+         std::lock_guard<std::mutex> g(metrics_mtx);
          filesystems.emplace_back(statbuf.st_dev, shutdown_available, path_name, warning_available);
+         filesystems.back().capacity = info.capacity;
+         filesystems.back().available = info.available;
+         filesystems.back().space_sampled = std::chrono::steady_clock::now();
          
          ilog("${path_name}'s file system monitored. shutdown_available: ${shutdown_available}, capacity: ${capacity}, threshold: ${threshold}", ("path_name", path_name.string()) ("shutdown_available", shutdown_available) ("capacity", info.capacity) ("threshold", shutdown_threshold) );
       }
@@ -118,9 +178,19 @@ namespace eosio::resource_monitor {
          appbase::app().quit(); // This will gracefully stop Nodeos
          return;
       }
-      update_warning_interval_counter();
+      update_io_stats();
+
+      // warnings are counted in regular intervals, also while checking more often
+      const auto sleep_time = next_sleep_time();
+      secs_since_interval += sleep_time;
+      if ( secs_since_interval >= sleep_time_in_secs ) {
+         update_warning_interval_counter();
+         secs_since_interval = 0;
+      } else {
+         output_threshold_warning = false;
+      }
 
-      timer.expires_from_now( boost::posix_time::seconds( sleep_time_in_secs ));
+      timer.expires_from_now( boost::posix_time::seconds( sleep_time ));
 
       timer.async_wait([this](auto& ec) {
          if ( ec ) {
@@ -141,6 +211,10 @@ namespace eosio::resource_monitor {
       boost::asio::deadline_timer timer;
    
       uint32_t sleep_time_in_secs {2};
+      uint32_t fast_sleep_time_in_secs {1};
+      uint32_t secs_since_interval {0};
+      bool     approaching_threshold {false};
+      uint32_t io_utilization_threshold {90};
       uint32_t shutdown_threshold {90};
       uint32_t warning_threshold {85};
       bool     shutdown_on_exceeded {true};
@@ -151,6 +225,14 @@ namespace eosio::resource_monitor {
          bfs::path  path_name;
          uintmax_t  warning_available {0};  // warning is issued when availabla number of bytese drops below warning_available
 
+         // last check
+         uintmax_t                              capacity {0};
+         uintmax_t                              available {0};
+         std::chrono::steady_clock::time_point  space_sampled;
+         std::optional<io_stats>                io;
+         std::chrono::steady_clock::time_point  io_sampled;
+         double                                 io_utilization {0};
+
          filesystem_info(dev_t dev, uintmax_t available, const bfs::path& path, uintmax_t warning)
          : st_dev(dev),
          shutdown_available(available),
@@ -163,6 +245,26 @@ namespace eosio::resource_monitor {
       // Stores file systems to be monitored. Duplicate
       // file systems are not stored.
       std::vector<filesystem_info> filesystems;
+      mutable std::mutex           metrics_mtx; // protects the last check of filesystems against get_filesystem_metrics
+
+      void update_space(filesystem_info& fs, const bfs::space_info& info, std::chrono::steady_clock::time_point now) {
+         if ( info.available < fs.warning_available ) {
+            approaching_threshold = true;
+         } else if ( info.available > fs.shutdown_available && info.available < fs.available ) {
+            // bytes per second consumed since the last check
+            const auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - fs.space_sampled).count();
+            if ( elapsed_ms > 0 ) {
+               const double rate = double(fs.available - info.available) * 1000 / elapsed_ms;
+               if ( (info.available - fs.shutdown_available) / rate < 2.0 * sleep_time_in_secs )
+                  approaching_threshold = true;
+            }
+         }
+
+         std::lock_guard<std::mutex> g(metrics_mtx);
+         fs.capacity = info.capacity;
+         fs.available = info.available;
+         fs.space_sampled = now;
+      }
       
       uint32_t warning_interval {1};
       uint32_t warning_interval_counter {1};
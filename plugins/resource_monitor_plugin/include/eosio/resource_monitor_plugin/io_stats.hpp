@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace eosio::resource_monitor {
+   // Cumulative I/O counters of a block device since boot
+   struct io_stats {
+      uint64_t reads {0};
+      uint64_t read_bytes {0};
+      uint64_t read_time_ms {0};
+      uint64_t writes {0};
+      uint64_t write_bytes {0};
+      uint64_t write_time_ms {0};
+      uint64_t io_time_ms {0};    // time the device had I/O in flight
+   };
+
+   // Last check of a monitored file system
+   struct filesystem_metrics {
+      std::string              path_name;
+      uintmax_t                capacity {0};
+      uintmax_t                available {0};
+      std::optional<io_stats>  io;                  // empty when the device counters are not available
+      double                   io_utilization {0};  // percentage of the last I/O sampling interval the device was busy
+   };
+}
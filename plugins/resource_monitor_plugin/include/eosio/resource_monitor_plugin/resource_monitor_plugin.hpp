@@ -1,6 +1,7 @@
 #pragma once
 #include <appbase/application.hpp>
 #include <eosio/chain_plugin/chain_plugin.hpp>
+#include <eosio/resource_monitor_plugin/io_stats.hpp>
 
 namespace eosio {
 
@@ -22,6 +23,9 @@ public:
    // directory monitoring
    void monitor_directory(const bfs::path& path);
 
+   // Space and I/O counters of the monitored file systems at their last check
+   std::vector<resource_monitor::filesystem_metrics> get_filesystem_metrics() const;
+
 private:
    std::unique_ptr<class resource_monitor_plugin_impl> my;
 };
@@ -2,6 +2,7 @@
 
 #include <sys/stat.h>
 #include <boost/filesystem.hpp>
+#include <eosio/resource_monitor_plugin/io_stats.hpp>
 
 namespace bfs = boost::filesystem;
 
@@ -17,5 +18,9 @@ namespace eosio::resource_monitor {
 
       // Wrapper for boost file system space
       bfs::space_info get_space(const bfs::path& p, boost::system::error_code& ec) const;
+
+      // Reads the counters of a block device from /sys/dev/block/<major>:<minor>/stat.
+      // Returns false if they are not available, e.g. not on Linux or for a virtual file system.
+      bool get_io_stats(dev_t dev, io_stats& stats) const;
    };
 }
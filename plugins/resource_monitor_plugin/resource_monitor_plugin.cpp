@@ -54,6 +54,8 @@ public:
            "Used to indicate nodeos will not shutdown when threshold is exceeded." )
          ( "resource-monitor-warning-interval", bpo::value<uint32_t>()->default_value(def_monitor_warning_interval),
            "Number of resource monitor intervals between two consecutive warnings when the threshold is hit. Should be between 1 and 450" )
+         ( "resource-monitor-io-utilization-threshold", bpo::value<uint32_t>()->default_value(def_io_utilization_threshold),
+           "Percentage of a check interval the device of a monitored directory can be busy with I/O before a warning is generated. Should be between 1 and 100" )
          ;
    }
    
@@ -87,6 +89,11 @@ public:
          "\"resource-monitor-warning-interval\" must be between ${warning_interval_min} and ${warning_interval_max}", ("warning_interval_min", warning_interval_min) ("warning_interval_max", warning_interval_max));
       space_handler.set_warning_interval(warning_interval);
       ilog("Warning interval set to ${warning_interval}", ("warning_interval", warning_interval));
+
+      auto io_utilization_threshold = options.at("resource-monitor-io-utilization-threshold").as<uint32_t>();
+      EOS_ASSERT(io_utilization_threshold >= 1 && io_utilization_threshold <= 100, chain::plugin_config_exception,
+         "\"resource-monitor-io-utilization-threshold\" must be between 1 and 100");
+      space_handler.set_io_utilization_threshold(io_utilization_threshold);
    }
    
    // Start main thread
@@ -134,6 +141,10 @@ public:
       directories_registered.push_back(path);
    }
 
+   std::vector<resource_monitor::filesystem_metrics> get_filesystem_metrics() const {
+      return space_handler.get_filesystem_metrics();
+   }
+
 private:
    std::thread               monitor_thread;
    std::vector<bfs::path>    directories_registered;
@@ -151,6 +162,8 @@ private:
    static constexpr uint32_t warning_interval_min = 1;
    static constexpr uint32_t warning_interval_max = 450; // e.g. if the monitor interval is 2 sec, the warning interval is at most 15 minutes
 
+   static constexpr uint32_t def_io_utilization_threshold = 90; // in percentage
+
    boost::asio::io_context   ctx;
 
    using file_space_handler_t = file_space_handler<system_file_space_provider>;
@@ -181,4 +194,8 @@ void resource_monitor_plugin::monitor_directory(const bfs::path& path) {
    my->monitor_directory( path );
 }
 
+std::vector<resource_monitor::filesystem_metrics> resource_monitor_plugin::get_filesystem_metrics() const {
+   return my->get_filesystem_metrics();
+}
+
 } // namespace
@@ -1,5 +1,8 @@
 #include <eosio/resource_monitor_plugin/system_file_space_provider.hpp>
 
+#include <fstream>
+#include <sys/sysmacros.h>
+
 namespace bfs = boost::filesystem;
 
 namespace eosio::resource_monitor {
@@ -11,5 +14,20 @@ namespace eosio::resource_monitor {
       return bfs::space(p, ec);
    }
 
+   bool system_file_space_provider::get_io_stats(dev_t dev, io_stats& stats) const {
+      // the statistics of a partition are in the stat file of its directory as well
+      std::ifstream in("/sys/dev/block/" + std::to_string(major(dev)) + ":" + std::to_string(minor(dev)) + "/stat");
+      // see Documentation/block/stat.rst of the Linux kernel, sectors are 512 bytes
+      uint64_t read_merges, read_sectors, write_merges, write_sectors, in_flight;
+      in >> stats.reads >> read_merges >> read_sectors >> stats.read_time_ms
+         >> stats.writes >> write_merges >> write_sectors >> stats.write_time_ms
+         >> in_flight >> stats.io_time_ms;
+      if (!in)
+         return false;
+      stats.read_bytes = read_sectors * 512;
+      stats.write_bytes = write_sectors * 512;
+      return true;
+   }
+
    using bfs::directory_iterator;
 }
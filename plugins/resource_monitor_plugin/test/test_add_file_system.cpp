@@ -23,6 +23,10 @@ struct add_file_system_fixture {
          return fixture.mock_get_space(p, ec);
       }
 
+      bool get_io_stats(dev_t dev, io_stats& stats) const {
+         return false;
+      }
+
       add_file_system_fixture& fixture;
    };
 
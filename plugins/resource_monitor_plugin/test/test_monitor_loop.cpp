@@ -23,6 +23,10 @@ struct space_handler_fixture {
          return fixture.mock_get_space(p, ec);
       }
 
+      bool get_io_stats(dev_t dev, io_stats& stats) const {
+         return false;
+      }
+
       space_handler_fixture& fixture;
    };
 
@@ -23,6 +23,10 @@ struct threshold_fixture {
          return fixture.mock_get_space(p, ec);
       }
 
+      bool get_io_stats(dev_t dev, io_stats& stats) const {
+         return fixture.mock_get_io_stats(dev, stats);
+      }
+
       threshold_fixture& fixture;
    };
 
@@ -82,6 +86,7 @@ struct threshold_fixture {
    // fixture data and methods
    std::function<bfs::space_info(const bfs::path& p, boost::system::error_code& ec)> mock_get_space;
    std::function<int(const char *path, struct stat *buf)> mock_get_stat;
+   std::function<bool(dev_t dev, io_stats& stats)> mock_get_io_stats = [](dev_t, io_stats&) { return false; };
 
    file_space_handler_t space_handler;
 };
@@ -298,4 +303,54 @@ BOOST_AUTO_TEST_SUITE(threshol_tests)
       BOOST_TEST(expected_response == actual_response_5);
    }
 
+   BOOST_FIXTURE_TEST_CASE(fast_sampling_within_warning, threshold_fixture)
+   {
+      std::map<bfs::path, uintmax_t> availables {{"/test0", 249999}};
+      std::map<bfs::path, int>       devs       {{"/test0", 0}};
+
+      space_handler.set_sleep_time(5);
+      BOOST_TEST( !test_threshold_common(availables, devs) );
+      BOOST_TEST( space_handler.next_sleep_time() == 1U );
+   }
+
+   BOOST_FIXTURE_TEST_CASE(regular_sampling_not_yet_warning, threshold_fixture)
+   {
+      std::map<bfs::path, uintmax_t> availables {{"/test0", 250001}};
+      std::map<bfs::path, int>       devs       {{"/test0", 0}};
+
+      space_handler.set_sleep_time(5);
+      BOOST_TEST( !test_threshold_common(availables, devs) );
+      BOOST_TEST( space_handler.next_sleep_time() == 5U );
+   }
+
+   BOOST_FIXTURE_TEST_CASE(io_stats_in_metrics, threshold_fixture)
+   {
+      std::map<bfs::path, uintmax_t> availables {{"/test0", 300000}, {"/test1", 400000}};
+      std::map<bfs::path, int>       devs       {{"/test0", 0}, {"/test1", 1}};
+
+      mock_get_io_stats = [ i = 0 ]( dev_t dev, io_stats& stats ) mutable -> bool {
+         if ( dev != 0 )
+            return false;
+         ++i;
+         stats.writes      = 10 * i;
+         stats.write_bytes = 4096 * i;
+         return true;
+      };
+
+      BOOST_TEST( !test_threshold_common(availables, devs) );
+      space_handler.update_io_stats();
+      space_handler.update_io_stats();
+
+      auto metrics = space_handler.get_filesystem_metrics();
+      BOOST_REQUIRE( metrics.size() == 2U );
+      BOOST_TEST( metrics[0].path_name == "/test0" );
+      BOOST_TEST( metrics[0].capacity == 1000000U );
+      BOOST_TEST( metrics[0].available == 300000U );
+      BOOST_REQUIRE( metrics[0].io.has_value() );
+      BOOST_TEST( metrics[0].io->writes == 20U );
+      BOOST_TEST( metrics[0].io->write_bytes == 8192U );
+      BOOST_TEST( metrics[1].available == 400000U );
+      BOOST_TEST( !metrics[1].io.has_value() );
+   }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,70 @@
+#pragma once
+#include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/types.hpp>
+
+#include <fc/time.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace eosio { namespace detail {
+
+   /// signs with one signer before the deadline, or throws
+   using signer_function = std::function<chain::signature_type(const fc::time_point& deadline)>;
+
+   /**
+    * Runs every signer at once on ioc and returns the first signature.  It throws the exception of the last signer
+    * if they all fail, a timeout_exception at deadline, and a plugin_exception once stopped is set: the requests
+    * queued on ioc when it is stopped are never run.
+    * @param deadline - fc::time_point::maximum() to wait until a signer answers or stopped is set
+    */
+   inline chain::signature_type hedged_sign( boost::asio::io_context& ioc, const std::vector<signer_function>& signers,
+                                             const fc::time_point& deadline, const std::atomic<bool>& stopped ) {
+      struct hedged_request {
+         std::promise<chain::signature_type>  result;
+         std::atomic<size_t>                  pending_failures{0};
+         std::atomic<bool>                    done{false};
+      };
+
+      EOS_ASSERT( !stopped, chain::plugin_exception, "Signature provider is shut down" );
+      auto req = std::make_shared<hedged_request>();
+      req->pending_failures = signers.size();
+      auto fut = req->result.get_future();
+      for( const auto& signer : signers ) {
+         boost::asio::post( ioc, [req, signer, deadline]() {
+            try {
+               auto sig = signer( deadline );
+               if( !req->done.exchange( true ) )
+                  req->result.set_value( sig );
+            } catch( ... ) {
+               if( --req->pending_failures == 0 && !req->done.exchange( true ) )
+                  req->result.set_exception( std::current_exception() );
+            }
+         } );
+      }
+
+      // waits in slices so that a shutdown is noticed even without a deadline
+      constexpr auto stop_check_interval = std::chrono::milliseconds( 50 );
+      for( ;; ) {
+         auto wait = std::chrono::microseconds( stop_check_interval );
+         if( deadline != fc::time_point::maximum() ) {
+            const auto now = fc::time_point::now();
+            EOS_ASSERT( deadline > now, fc::timeout_exception, "No signer answered before the deadline" );
+            wait = std::min( wait, std::chrono::microseconds( ( deadline - now ).count() ) );
+         }
+         if( fut.wait_for( wait ) == std::future_status::ready )
+            break;
+         EOS_ASSERT( !stopped, chain::plugin_exception, "Signature provider shut down while signing" );
+      }
+      return fut.get();
+   }
+
+} } // namespace eosio::detail
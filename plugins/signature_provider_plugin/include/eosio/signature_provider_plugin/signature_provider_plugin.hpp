@@ -17,7 +17,7 @@ public:
 
    void plugin_initialize(const variables_map& options);
    void plugin_startup() {}
-   void plugin_shutdown() {}
+   void plugin_shutdown();
 
    const char* const signature_provider_help_text() const;
 
@@ -1,11 +1,16 @@
 #include <eosio/signature_provider_plugin/signature_provider_plugin.hpp>
+#include <eosio/signature_provider_plugin/hedged_sign.hpp>
 #include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/thread_utils.hpp>
 
 #include <fc/time.hpp>
 #include <fc/network/url.hpp>
 
 #include <boost/algorithm/string.hpp>
 
+#include <atomic>
+#include <mutex>
+
 #ifdef __APPLE__
 #include <eosio/se-helpers/se-helpers.hpp>
 #endif
@@ -13,9 +18,42 @@
 namespace eosio {
    static appbase::abstract_plugin& _signature_provider_plugin = app().register_plugin<signature_provider_plugin>();
 
+/**
+ * A keosd, or another server with its signing endpoint, with its own client so that the connection to it is kept
+ * open between signatures.  The client is not thread safe, the requests to a signer are serialized.
+ */
+struct remote_signer {
+   explicit remote_signer( fc::url url )
+   : url( std::move( url ) )
+   , client( app().get_plugin<http_client_plugin>().create_client() )
+   {}
+
+   chain::signature_type sign( const fc::variant& params, const fc::time_point& deadline ) {
+      std::lock_guard<std::mutex> g( mtx );
+      return client->post_sync( url, params, deadline ).as<chain::signature_type>();
+   }
+
+   const fc::url                 url;
+   std::unique_ptr<http_client>  client;
+   std::mutex                    mtx;
+};
+
 class signature_provider_plugin_impl {
    public:
       fc::microseconds  _keosd_provider_timeout_us;
+      uint16_t          _keosd_provider_threads = 0;
+      /// sends a request to each signer of a spec with several urls, created by the first one
+      std::optional<chain::named_thread_pool>  _keosd_thread_pool;
+      /// set by plugin_shutdown, the signatures in progress with several urls fail instead of waiting for the pool
+      std::atomic<bool>                        _stopped{false};
+
+      static fc::url parse_keosd_url(const string& url_str) {
+         if(boost::algorithm::starts_with(url_str, "unix://"))
+            //send the entire string after unix:// to http_plugin. It'll auto-detect which part
+            // is the unix socket path, and which part is the url to hit on the server
+            return fc::url("unix", url_str.substr(7), fc::ostring(), fc::ostring(), fc::ostring(), fc::ostring(), fc::ovariant_object(), std::optional<uint16_t>());
+         return fc::url(url_str);
+      }
 
       signature_provider_plugin::signature_provider_type
       make_key_signature_provider(const chain::private_key_type& key) const {
@@ -42,20 +80,38 @@ class signature_provider_plugin_impl {
 #endif
 
       signature_provider_plugin::signature_provider_type
-      make_keosd_signature_provider(const string& url_str, const chain::public_key_type pubkey) const {
-         fc::url keosd_url;
-         if(boost::algorithm::starts_with(url_str, "unix://"))
-            //send the entire string after unix:// to http_plugin. It'll auto-detect which part
-            // is the unix socket path, and which part is the url to hit on the server
-            keosd_url = fc::url("unix", url_str.substr(7), fc::ostring(), fc::ostring(), fc::ostring(), fc::ostring(), fc::ovariant_object(), std::optional<uint16_t>());
-         else
-            keosd_url = fc::url(url_str);
-
-         return [to=_keosd_provider_timeout_us, keosd_url, pubkey](const chain::digest_type& digest) {
+      make_keosd_signature_provider(const string& urls_str, const chain::public_key_type pubkey) {
+         std::vector<string> url_strs;
+         boost::algorithm::split(url_strs, urls_str, boost::is_any_of("|"));
+         std::vector<std::shared_ptr<remote_signer>> signers;
+         for(const auto& url_str : url_strs) {
+            EOS_ASSERT(!url_str.empty(), chain::plugin_config_exception, "Empty KEOSD url in \"${s}\"", ("s", urls_str));
+            signers.emplace_back(std::make_shared<remote_signer>(parse_keosd_url(url_str)));
+         }
+
+         if(signers.size() == 1) {
+            return [to=_keosd_provider_timeout_us, signer=signers.front(), pubkey](const chain::digest_type& digest) {
+               fc::variant params;
+               fc::to_variant(std::make_pair(digest, pubkey), params);
+               auto deadline = to.count() >= 0 ? fc::time_point::now() + to : fc::time_point::maximum();
+               return signer->sign(params, deadline);
+            };
+         }
+
+         EOS_ASSERT(_keosd_provider_threads > 0, chain::plugin_config_exception,
+                    "keosd-provider-threads must be greater than 0 to sign with several KEOSD urls");
+         if(!_keosd_thread_pool)
+            _keosd_thread_pool.emplace("sigprov", _keosd_provider_threads);
+
+         // the request is sent to every signer at once, the first signature is used; it fails if they all fail
+         return [this, to=_keosd_provider_timeout_us, signers=std::move(signers), pubkey](const chain::digest_type& digest) {
             fc::variant params;
             fc::to_variant(std::make_pair(digest, pubkey), params);
             auto deadline = to.count() >= 0 ? fc::time_point::now() + to : fc::time_point::maximum();
-            return app().get_plugin<http_client_plugin>().get_client().post_sync(keosd_url, params, deadline).as<chain::signature_type>();
+            std::vector<detail::signer_function> sign_fns;
+            for(const auto& signer : signers)
+               sign_fns.emplace_back([signer, params](const fc::time_point& deadline) { return signer->sign(params, deadline); });
+            return detail::hedged_sign(_keosd_thread_pool->get_executor(), sign_fns, deadline, _stopped);
          };
       }
 };
@@ -67,6 +123,8 @@ void signature_provider_plugin::set_program_options(options_description&, option
    cfg.add_options()
          ("keosd-provider-timeout", boost::program_options::value<int32_t>()->default_value(5),
           "Limits the maximum time (in milliseconds) that is allowed for sending requests to a keosd provider for signing")
+         ("keosd-provider-threads", boost::program_options::value<uint16_t>()->default_value(2),
+          "Number of threads sending the requests of the KEOSD providers with several urls, each url is sent the request at once")
          ;
 }
 
@@ -77,7 +135,8 @@ const char* const signature_provider_plugin::signature_provider_help_text() cons
           "   <provider-spec> \tis a string in the form <provider-type>:<data>\n\n"
           "   <provider-type> \tis KEY, KEOSD, or SE\n\n"
           "   KEY:<data>      \tis a string form of a valid EOSIO private key which maps to the provided public key\n\n"
-          "   KEOSD:<data>    \tis the URL where keosd is available and the approptiate wallet(s) are unlocked\n\n"
+          "   KEOSD:<data>    \tis the URL where keosd is available and the approptiate wallet(s) are unlocked,\n"
+          "                   \tor several URLs separated by '|' which are all sent each request, the first signature is used\n\n"
 #ifdef __APPLE__
           "   SE:             \tindicates the key resides in Secure Enclave"
 #endif
@@ -87,6 +146,13 @@ const char* const signature_provider_plugin::signature_provider_help_text() cons
 
 void signature_provider_plugin::plugin_initialize(const variables_map& options) {
    my->_keosd_provider_timeout_us = fc::milliseconds( options.at("keosd-provider-timeout").as<int32_t>() );
+   my->_keosd_provider_threads = options.at("keosd-provider-threads").as<uint16_t>();
+}
+
+void signature_provider_plugin::plugin_shutdown() {
+   my->_stopped = true;
+   if( my->_keosd_thread_pool )
+      my->_keosd_thread_pool->stop();
 }
 
 std::pair<chain::public_key_type,signature_provider_plugin::signature_provider_type>
@@ -0,0 +1,91 @@
+#define BOOST_TEST_MODULE hedged_sign
+#include <boost/test/included/unit_test.hpp>
+
+#include <eosio/signature_provider_plugin/hedged_sign.hpp>
+#include <eosio/chain/thread_utils.hpp>
+
+#include <thread>
+
+using namespace eosio;
+using namespace eosio::chain;
+using eosio::detail::hedged_sign;
+using eosio::detail::signer_function;
+
+namespace {
+   const auto digest = fc::sha256::hash( std::string( "digest" ) );
+
+   signature_type sign_with( const std::string& key_name ) {
+      return private_key_type::regenerate<fc::ecc::private_key_shim>( fc::sha256::hash( key_name ) ).sign( digest );
+   }
+
+   /// a signer answering with the signature of key_name after delay
+   signer_function signer( const std::string& key_name, std::chrono::milliseconds delay ) {
+      return [sig = sign_with( key_name ), delay]( const fc::time_point& ) {
+         std::this_thread::sleep_for( delay );
+         return sig;
+      };
+   }
+
+   /// a signer failing after delay
+   signer_function failing_signer( std::chrono::milliseconds delay ) {
+      return [delay]( const fc::time_point& ) -> signature_type {
+         std::this_thread::sleep_for( delay );
+         EOS_THROW( chain::plugin_exception, "signer failed" );
+      };
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(hedged_sign_tests)
+
+// the first signature is used, a failing signer does not fail the request
+BOOST_AUTO_TEST_CASE(first_response_wins) { try {
+   named_thread_pool pool( "sigtest", 3 );
+   std::atomic<bool> stopped{false};
+   const std::vector<signer_function> signers{ failing_signer( std::chrono::milliseconds( 0 ) ),
+                                               signer( "slow", std::chrono::milliseconds( 300 ) ),
+                                               signer( "fast", std::chrono::milliseconds( 20 ) ) };
+   const auto start = fc::time_point::now();
+   const auto sig = hedged_sign( pool.get_executor(), signers, start + fc::seconds( 5 ), stopped );
+   BOOST_CHECK( sig == sign_with( "fast" ) );
+   BOOST_CHECK_LT( ( fc::time_point::now() - start ).count(), fc::milliseconds( 300 ).count() );
+} FC_LOG_AND_RETHROW() }
+
+// the request fails only once every signer failed
+BOOST_AUTO_TEST_CASE(all_failed) { try {
+   named_thread_pool pool( "sigtest", 2 );
+   std::atomic<bool> stopped{false};
+   const std::vector<signer_function> signers{ failing_signer( std::chrono::milliseconds( 0 ) ),
+                                               failing_signer( std::chrono::milliseconds( 20 ) ) };
+   BOOST_CHECK_THROW( hedged_sign( pool.get_executor(), signers, fc::time_point::now() + fc::seconds( 5 ), stopped ),
+                      chain::plugin_exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(deadline) { try {
+   named_thread_pool pool( "sigtest", 2 );
+   std::atomic<bool> stopped{false};
+   const std::vector<signer_function> signers{ failing_signer( std::chrono::milliseconds( 0 ) ),
+                                               signer( "slow", std::chrono::milliseconds( 500 ) ) };
+   BOOST_CHECK_THROW( hedged_sign( pool.get_executor(), signers, fc::time_point::now() + fc::milliseconds( 50 ), stopped ),
+                      fc::timeout_exception );
+} FC_LOG_AND_RETHROW() }
+
+// without a deadline, a request fails once the plugin is shut down instead of waiting for requests never run
+BOOST_AUTO_TEST_CASE(stopped_without_deadline) { try {
+   named_thread_pool pool( "sigtest", 1 );
+   std::atomic<bool> stopped{false};
+   const std::vector<signer_function> signers{ signer( "slow", std::chrono::milliseconds( 500 ) ),
+                                               signer( "queued", std::chrono::milliseconds( 0 ) ) };
+   std::thread shutdown( [&]() {
+      std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+      stopped = true;
+   } );
+   const auto start = fc::time_point::now();
+   BOOST_CHECK_THROW( hedged_sign( pool.get_executor(), signers, fc::time_point::maximum(), stopped ), chain::plugin_exception );
+   BOOST_CHECK_LT( ( fc::time_point::now() - start ).count(), fc::milliseconds( 400 ).count() );
+   shutdown.join();
+
+   // and fails at once after it
+   BOOST_CHECK_THROW( hedged_sign( pool.get_executor(), signers, fc::time_point::maximum(), stopped ), chain::plugin_exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -29,6 +29,12 @@ class state_history_plugin : public plugin<state_history_plugin> {
 
    void handle_sighup() override;
 
+   /// Receives the packed state_result (a get_blocks_result_v1 with the block, traces and deltas) of every accepted
+   /// block, in order, on a state history thread. Lets an in-process reader such as embedded rodeos follow the chain
+   /// without a websocket connection. Call from the main thread, after this plugin is initialized.
+   using block_consumer = std::function<void(const std::shared_ptr<const std::vector<char>>& result)>;
+   void add_block_consumer(block_consumer consumer);
+
  private:
    state_history_ptr my;
 };
@@ -1,5 +1,9 @@
 #include <eosio/chain/config.hpp>
+#include <eosio/chain/signal_slots.hpp>
+#include <eosio/chain/thread_utils.hpp>
 #include <eosio/resource_monitor_plugin/resource_monitor_plugin.hpp>
+#include <eosio/state_history/create_deltas.hpp>
+#include <eosio/state_history/filter.hpp>
 #include <eosio/state_history/log.hpp>
 #include <eosio/state_history/serialization.hpp>
 #include <eosio/state_history_plugin/state_history_plugin.hpp>
@@ -14,6 +18,12 @@
 #include <boost/beast/websocket.hpp>
 #include <boost/signals2/connection.hpp>
 
+#include <array>
+#include <atomic>
+#include <future>
+#include <list>
+#include <mutex>
+
 using tcp    = boost::asio::ip::tcp;
 namespace ws = boost::beast::websocket;
 
@@ -46,15 +56,47 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
    chain_plugin*                                              chain_plug = nullptr;
    std::optional<state_history_traces_log>                    trace_log;
    std::optional<state_history_chain_state_log>               chain_state_log;
-   bool                                                       stopping = false;
+   std::atomic<bool>                                          stopping = false;
    std::optional<scoped_connection>                           applied_transaction_connection;
    std::optional<scoped_connection>                           block_start_connection;
    std::optional<scoped_connection>                           accepted_block_connection;
    string                                                     endpoint_address = "0.0.0.0";
    uint16_t                                                   endpoint_port    = 8080;
+   uint16_t                                                   thread_pool_size = 2;
+   std::optional<named_thread_pool>                           thread_pool;
    std::unique_ptr<tcp::acceptor>                             acceptor;
 
-   std::optional<chain::block_id_type> get_block_id(uint32_t block_num) {
+   struct block_consumer_entry {
+      state_history_plugin::block_consumer consumer;
+      boost::asio::io_context::strand      strand; // keeps the results in order
+   };
+   std::list<block_consumer_entry>                            block_consumers;
+
+   // head and last irreversible block of the chain, updated on the main thread and read by the sessions
+   mutable std::mutex                                         chain_head_mtx;
+   block_state_ptr                                            head_block_state;
+   block_position                                             last_irreversible;
+
+   block_state_ptr get_head_block_state() const {
+      std::lock_guard g(chain_head_mtx);
+      return head_block_state;
+   }
+
+   block_position get_last_irreversible() const {
+      std::lock_guard g(chain_head_mtx);
+      return last_irreversible;
+   }
+
+   // called on the main thread
+   void update_chain_head(const block_state_ptr& block_state) {
+      auto&           chain = chain_plug->chain();
+      std::lock_guard g(chain_head_mtx);
+      head_block_state  = block_state;
+      last_irreversible = {chain.last_irreversible_block_num(), chain.last_irreversible_block_id()};
+   }
+
+   // thread safe, only looks in the state history logs
+   std::optional<chain::block_id_type> get_log_block_id(uint32_t block_num) {
       std::optional<chain::block_id_type> result;
 
       if (trace_log)
@@ -63,6 +105,12 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
       if (!result && chain_state_log)
          result = chain_state_log->get_block_id(block_num);
 
+      return result;
+   }
+
+   // called on the main thread, the block log and the fork database are not thread safe
+   std::optional<chain::block_id_type> get_block_id(uint32_t block_num) {
+      auto result = get_log_block_id(block_num);
       if (result)
          return result;
 
@@ -73,19 +121,42 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
       }
    }
 
-   using get_blocks_request = std::variant<get_blocks_request_v0, get_blocks_request_v1>;
+   // called on the main thread
+   signed_block_ptr fetch_block(uint32_t block_num) {
+      try {
+         return chain_plug->chain().fetch_block_by_number(block_num);
+      } catch (...) {
+         return {};
+      }
+   }
+
+   using get_blocks_request =
+       std::variant<get_blocks_request_v0, get_blocks_request_v1, get_blocks_request_v2, get_blocks_request_v3,
+                    get_blocks_request_v4, get_blocks_request_v5>;
 
+   struct send_buffer {
+      std::vector<char> data;
+      std::vector<char> payload; ///< sent after data in the same message without being copied into it
+   };
+
+   // a session runs on its strand of the state history thread pool; the lookups that need the block log or the fork
+   // database are posted to the main thread, which posts the results back to the strand
    struct session : std::enable_shared_from_this<session> {
       std::shared_ptr<state_history_plugin_impl> plugin;
+      boost::asio::io_context::strand            strand;
       std::unique_ptr<ws::stream<tcp::socket>>   socket_stream;
       bool                                       sending  = false;
       bool                                       sent_abi = false;
-      std::vector<std::vector<char>>             send_queue;
+      std::vector<send_buffer>                   send_queue;
       std::optional<get_blocks_request>          current_request;
       bool                                       need_to_send_update = false;
+      bool                                       fetching_block      = false; ///< waiting for the main thread
+      std::vector<char>                          batch; ///< the packed results of the batch being built
+      uint32_t                                   batch_results = 0;
 
-      session(std::shared_ptr<state_history_plugin_impl> plugin)
-          : plugin(std::move(plugin)) {}
+      session(std::shared_ptr<state_history_plugin_impl> plugin, boost::asio::io_context& ioc)
+          : plugin(std::move(plugin))
+          , strand(ioc) {}
 
       void start(tcp::socket socket) {
          fc_ilog(_log, "incoming connection");
@@ -94,18 +165,20 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
          socket_stream->next_layer().set_option(boost::asio::ip::tcp::no_delay(true));
          socket_stream->next_layer().set_option(boost::asio::socket_base::send_buffer_size(1024 * 1024));
          socket_stream->next_layer().set_option(boost::asio::socket_base::receive_buffer_size(1024 * 1024));
-         socket_stream->async_accept([self = shared_from_this()](boost::system::error_code ec) {
-            self->callback(ec, "async_accept", [self] {
-               self->start_read();
-               self->send(state_history_plugin_abi);
-            });
-         });
+         socket_stream->async_accept(
+             boost::asio::bind_executor(strand, [self = shared_from_this()](boost::system::error_code ec) {
+                self->callback(ec, "async_accept", [self] {
+                   self->start_read();
+                   self->send(state_history_plugin_abi);
+                });
+             }));
       }
 
       void start_read() {
          auto in_buffer = std::make_shared<boost::beast::flat_buffer>();
          socket_stream->async_read(
-             *in_buffer, [self = shared_from_this(), in_buffer](boost::system::error_code ec, size_t) {
+             *in_buffer, boost::asio::bind_executor(strand, [self = shared_from_this(), in_buffer](
+                                                                boost::system::error_code ec, size_t) {
                 self->callback(ec, "async_read", [self, in_buffer] {
                    auto d = boost::asio::buffer_cast<char const*>(boost::beast::buffers_front(in_buffer->data()));
                    auto s = boost::asio::buffer_size(in_buffer->data());
@@ -115,20 +188,73 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
                    std::visit(*self, req);
                    self->start_read();
                 });
-             });
+             }));
       }
 
       void send(const char* s) {
-         send_queue.push_back({s, s + strlen(s)});
+         send_queue.push_back({{s, s + strlen(s)}});
          send();
       }
 
       template <typename T>
       void send(T obj) {
-         send_queue.push_back(fc::raw::pack(state_result{std::move(obj)}));
+         send_queue.push_back({fc::raw::pack(state_result{std::move(obj)})});
+         send();
+      }
+
+      // replaces the size of the empty field or vector packed last in data
+      static void replace_last_size(std::vector<char>& data, uint64_t size) {
+         data.pop_back();
+         std::array<char, 10>  size_buf;
+         fc::datastream<char*> ds(size_buf.data(), size_buf.size());
+         pack_varuint64(ds, size);
+         data.insert(data.end(), size_buf.data(), size_buf.data() + ds.tellp());
+      }
+
+      // payload holds the bytes of the last field of obj, which is left empty
+      template <typename T>
+      void send(T obj, std::vector<char> payload) {
+         if (payload.empty())
+            return send(std::move(obj));
+         auto data = fc::raw::pack(state_result{std::move(obj)});
+         replace_last_size(data, payload.size());
+         send_queue.push_back({std::move(data), std::move(payload)});
+         send();
+      }
+
+      template <typename T>
+      void add_to_batch(T obj, const std::vector<char>& payload) {
+         auto data = fc::raw::pack(obj);
+         if (!payload.empty()) {
+            replace_last_size(data, payload.size());
+            data.insert(data.end(), payload.begin(), payload.end());
+         }
+         batch.insert(batch.end(), data.begin(), data.end());
+         ++batch_results;
+      }
+
+      void send_batch() {
+         if (!batch_results)
+            return;
+         auto data = fc::raw::pack(state_result{get_blocks_batch_result_v0{}});
+         replace_last_size(data, batch_results);
+         send_queue.push_back({std::move(data), std::move(batch)});
+         batch         = {};
+         batch_results = 0;
+         if (current_request)
+            --current_block_request().max_messages_in_flight;
          send();
       }
 
+      // adds the next result to the batch, the batch is sent when no result can be added to it for now
+      template <typename F>
+      void continue_batch(F f) {
+         const auto results = batch_results;
+         f();
+         if (batch_results == results && !fetching_block)
+            send_batch();
+      }
+
       void send() {
          if (sending)
             return;
@@ -137,25 +263,26 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
          sending = true;
          socket_stream->binary(sent_abi);
          sent_abi = true;
+         const auto& front = send_queue[0];
          socket_stream->async_write( //
-             boost::asio::buffer(send_queue[0]),
-             [self = shared_from_this()](boost::system::error_code ec, size_t) {
+             std::array<boost::asio::const_buffer, 2>{boost::asio::buffer(front.data), boost::asio::buffer(front.payload)},
+             boost::asio::bind_executor(strand, [self = shared_from_this()](boost::system::error_code ec, size_t) {
                 self->callback(ec, "async_write", [self] {
                    self->send_queue.erase(self->send_queue.begin());
                    self->sending = false;
                    self->send();
                 });
-             });
+             }));
       }
 
       using result_type = void;
       void operator()(get_status_request_v0&) {
          fc_ilog(_log, "got get_status_request_v0");
-         auto&                chain = plugin->chain_plug->chain();
+         auto                 head_block_state = plugin->get_head_block_state();
          get_status_result_v0 result;
-         result.head              = {chain.head_block_num(), chain.head_block_id()};
-         result.last_irreversible = {chain.last_irreversible_block_num(), chain.last_irreversible_block_id()};
-         result.chain_id          = chain.get_chain_id();
+         result.head              = {head_block_state->block_num, head_block_state->id};
+         result.last_irreversible = plugin->get_last_irreversible();
+         result.chain_id          = plugin->chain_plug->get_chain_id();
          if (plugin->trace_log) {
             result.trace_begin_block = plugin->trace_log->begin_block();
             result.trace_end_block   = plugin->trace_log->end_block();
@@ -172,25 +299,46 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
       std::enable_if_t<std::is_base_of_v<get_blocks_request_v0,T>>
       operator()(T& req) {
          fc_ilog(_log, "received get_blocks_request = ${req}", ("req",req) );
-         for (auto& cp : req.have_positions) {
-            if (req.start_block_num <= cp.block_num)
-               continue;
-            auto id = plugin->get_block_id(cp.block_num);
-            if (!id || *id != cp.block_id)
-               req.start_block_num = std::min(req.start_block_num, cp.block_num);
-
-            if (!id) {
-               fc_dlog(_log, "block ${block_num} is not available", ("block_num", cp.block_num));
-            } else if (*id != cp.block_id) {
-               fc_dlog(_log, "the id for block ${block_num} in block request have_positions does not match the existing", ("block_num", cp.block_num));
-            }         
+         if constexpr (std::is_base_of_v<get_blocks_request_v3, T>) {
+            EOS_ASSERT(!req.compressed_deltas || req.table_filters.empty(), plugin_exception,
+                       "compressed_deltas cannot be combined with table_filters");
          }
-         req.have_positions.clear();
-         fc_dlog(_log, "  get_blocks_request start_block_num set to ${num}", ("num", req.start_block_num));
-
-         current_request = req;
-         
-         send_update(true);
+         // the have_positions may be in the block log or the fork database
+         app().post(priority::medium, [self = shared_from_this(), req]() mutable {
+            if (self->plugin->stopping)
+               return;
+            for (auto& cp : req.have_positions) {
+               if (req.start_block_num <= cp.block_num)
+                  continue;
+               auto id = self->plugin->get_block_id(cp.block_num);
+               if (!id || *id != cp.block_id)
+                  req.start_block_num = std::min(req.start_block_num, cp.block_num);
+
+               if (!id) {
+                  fc_dlog(_log, "block ${block_num} is not available", ("block_num", cp.block_num));
+               } else if (*id != cp.block_id) {
+                  fc_dlog(_log, "the id for block ${block_num} in block request have_positions does not match the existing", ("block_num", cp.block_num));
+               }
+            }
+            req.have_positions.clear();
+            if constexpr (std::is_base_of_v<get_blocks_request_v5, T>) {
+               if (req.fetch_state_snapshot) {
+                  // the state is captured when the next block is accepted, then the session continues from there
+                  fc_dlog(_log, "  get_blocks_request waits for a state snapshot");
+                  self->plugin->pending_snapshots.emplace_back(self, std::move(req));
+                  return;
+               }
+            }
+            fc_dlog(_log, "  get_blocks_request start_block_num set to ${num}", ("num", req.start_block_num));
+
+            boost::asio::post(self->strand, [self, req = std::move(req)]() mutable {
+               self->callback({}, "get_blocks_request", [self, &req] {
+                  self->send_batch();
+                  self->current_request = std::move(req);
+                  self->send_update(true);
+               });
+            });
+         });
       }
 
       void operator()(get_blocks_ack_request_v0& ack_req) {
@@ -205,10 +353,74 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
          send_update();
       }
 
+      bool fetch_block_header() const {
+         return std::visit(
+             [](const auto& req) -> bool {
+                if constexpr (std::is_base_of_v<get_blocks_request_v1, std::decay_t<decltype(req)>>)
+                   return req.fetch_block_header;
+                return false;
+             },
+             *current_request);
+      }
+
+      bool compressed_deltas() const {
+         return std::visit(
+             [](const auto& req) -> bool {
+                if constexpr (std::is_base_of_v<get_blocks_request_v2, std::decay_t<decltype(req)>>)
+                   return req.compressed_deltas;
+                return false;
+             },
+             *current_request);
+      }
+
+      uint32_t max_batch_bytes() const {
+         return std::visit(
+             [](const auto& req) -> uint32_t {
+                if constexpr (std::is_base_of_v<get_blocks_request_v4, std::decay_t<decltype(req)>>)
+                   return req.max_batch_bytes;
+                return 0;
+             },
+             *current_request);
+      }
+
+      const get_blocks_request_v3* filtered_request() const {
+         return std::visit(
+             [](const auto& req) -> const get_blocks_request_v3* {
+                if constexpr (std::is_base_of_v<get_blocks_request_v3, std::decay_t<decltype(req)>>)
+                   return &req;
+                return nullptr;
+             },
+             *current_request);
+      }
+
+      // sends the full state at block_state, then continues req from the following block
+      void send_state_snapshot(get_blocks_request_v5 req, const block_state_ptr& block_state,
+                               const std::vector<char>& deltas) {
+         state_snapshot_result_v0 result;
+         result.head              = {block_state->block_num, block_state->id};
+         result.last_irreversible = plugin->get_last_irreversible();
+         result.this_block        = {block_state->block_num, block_state->id};
+         std::vector<char> payload;
+         if (req.compressed_deltas)
+            payload = zlib_compress(deltas);
+         else if (!req.table_filters.empty())
+            payload = filter_deltas(deltas, req.table_filters);
+         else
+            payload = deltas;
+         fc_ilog(_log, "pushing state_snapshot_result_v0 for block ${b} to send queue", ("b", block_state->block_num));
+
+         send_batch();
+         req.start_block_num = block_state->block_num + 1;
+         if (req.max_messages_in_flight)
+            --req.max_messages_in_flight;
+         current_request     = std::move(req);
+         need_to_send_update = true;
+         send(std::move(result), std::move(payload));
+      }
+
       void set_result_block_header(get_blocks_result_v1&, const signed_block_ptr& block) {}
       void set_result_block_header(get_blocks_result_v2& result, const signed_block_ptr& block) {
-         bool fetch_block_header = std::get<get_blocks_request_v1>(*current_request).fetch_block_header;
-         if (fetch_block_header && block) {
+         if (fetch_block_header() && block) {
             result.block_header = static_cast<const signed_block_header&>(*block); 
          }
       }
@@ -219,53 +431,100 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
          return 0;
       }
 
+      get_blocks_request_v0& current_block_request() {
+         return std::visit([](auto& x) -> get_blocks_request_v0& { return x; }, *current_request);
+      }
+
       template <typename T>
       std::enable_if_t<std::is_same_v<get_blocks_result_v1,T> || std::is_same_v<get_blocks_result_v2,T>>
       send_update(const block_state_ptr& head_block_state, T&& result) {
          need_to_send_update = true;
-         if (!send_queue.empty() || !max_messages_in_flight() )
+         if (fetching_block || !send_queue.empty() || !max_messages_in_flight() )
             return;
-         get_blocks_request_v0& block_req = std::visit([](auto& x) ->get_blocks_request_v0&{  return x; }, *current_request);
-         
-         auto& chain              = plugin->chain_plug->chain();
-         result.last_irreversible = {chain.last_irreversible_block_num(), chain.last_irreversible_block_id()};
+         get_blocks_request_v0& block_req = current_block_request();
+
+         result.last_irreversible = plugin->get_last_irreversible();
          uint32_t current =
                block_req.irreversible_only ? result.last_irreversible.block_num : result.head.block_num;
-         if (block_req.start_block_num <= current &&
-             block_req.start_block_num < block_req.end_block_num) {
-
-            auto& block_num = block_req.start_block_num;
-            auto block_id  = plugin->get_block_id(block_num);
-
-            auto get_block = [&chain, block_num, head_block_state]() -> signed_block_ptr {
-               try {
-                  if (head_block_state->block_num == block_num)
-                     return head_block_state->block;
-                  return chain.fetch_block_by_number(block_num);
-               } catch (...) {
-                  return {};
-               }
-            };
-
-            if (block_id) {
-               result.this_block  = block_position{block_num, *block_id};
-               auto prev_block_id = plugin->get_block_id(block_num - 1);
-               if (prev_block_id) 
-                  result.prev_block = block_position{block_num - 1, *prev_block_id};
-               if (block_req.fetch_block) {
-                  result.block = signed_block_ptr_variant{get_block()};
-               }
-               if (block_req.fetch_traces && plugin->trace_log) {
-                  result.traces = plugin->trace_log->get_log_entry(block_num);
-               }
-               if (block_req.fetch_deltas && plugin->chain_state_log) {
-                  result.deltas = plugin->chain_state_log->get_log_entry(block_num);
+         if (block_req.start_block_num > current || block_req.start_block_num >= block_req.end_block_num)
+            return;
+
+         uint32_t         block_num     = block_req.start_block_num;
+         auto             block_id      = plugin->get_log_block_id(block_num);
+         auto             prev_block_id = plugin->get_log_block_id(block_num - 1);
+         signed_block_ptr block;
+         if (head_block_state->block_num == block_num) {
+            block_id = head_block_state->id;
+            block    = head_block_state->block;
+         }
+
+         const bool need_block = block_req.fetch_block || fetch_block_header();
+         if (block_id && prev_block_id && (block || !need_block))
+            return send_block_result(block_num, block_id, prev_block_id, block, current, std::move(result));
+
+         fetching_block = true;
+         app().post(priority::medium, [self = shared_from_this(), block_num, block_id, prev_block_id, block, need_block,
+                                       current, request_index = current_request->index(),
+                                       result = std::move(result)]() mutable {
+            if (self->plugin->stopping)
+               return;
+            if (!block_id)
+               block_id = self->plugin->get_block_id(block_num);
+            if (!prev_block_id)
+               prev_block_id = self->plugin->get_block_id(block_num - 1);
+            if (need_block && !block)
+               block = self->plugin->fetch_block(block_num);
+
+            boost::asio::post(self->strand, [self, block_num, block_id, prev_block_id, block, current, request_index,
+                                             result = std::move(result)]() mutable {
+               self->fetching_block = false;
+               self->callback({}, "fetch_block", [&] {
+                  self->continue_batch([&] {
+                     // the request may have been replaced or rewound by a fork while the block was fetched
+                     if (!self->current_request || self->current_request->index() != request_index ||
+                         self->current_block_request().start_block_num != block_num)
+                        return self->send_update();
+                     self->send_block_result(block_num, block_id, prev_block_id, block, current, std::move(result));
+                  });
+               });
+            });
+         });
+      }
+
+      template <typename T>
+      void send_block_result(uint32_t block_num, const std::optional<block_id_type>& block_id,
+                             const std::optional<block_id_type>& prev_block_id, const signed_block_ptr& block,
+                             uint32_t current, T&& result) {
+         get_blocks_request_v0& block_req = current_block_request();
+         std::vector<char>      deltas;
+         if (block_id) {
+            result.this_block = block_position{block_num, *block_id};
+            if (prev_block_id)
+               result.prev_block = block_position{block_num - 1, *prev_block_id};
+            if (block_req.fetch_block) {
+               result.block = signed_block_ptr_variant{block};
+            }
+            const auto* filters = filtered_request();
+            if (block_req.fetch_traces && plugin->trace_log) {
+               auto traces = plugin->trace_log->get_log_entry(block_num);
+               if (filters && !filters->action_filters.empty() && !traces.empty())
+                  traces = filter_traces(traces, filters->action_filters);
+               result.traces = std::move(traces);
+            }
+            if (block_req.fetch_deltas && plugin->chain_state_log) {
+               if (compressed_deltas()) {
+                  deltas = plugin->chain_state_log->get_compressed_log_entry(block_num);
+               } else {
+                  auto entry = plugin->chain_state_log->get_log_entry(block_num);
+                  if (filters && !filters->table_filters.empty() && !entry.empty())
+                     entry = filter_deltas(entry, filters->table_filters);
+                  result.deltas = std::move(entry);
                }
-               set_result_block_header(result, get_block());
             }
-            ++block_num;
+            set_result_block_header(result, block);
          }
-         if (!result.has_value())
+         ++block_req.start_block_num;
+         if (!result.has_value() && deltas.empty())
             return;
          fc_ilog(_log,
                  "pushing result "
@@ -273,10 +532,22 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
                  "\"block_num\":${this_block}}} to send queue",
                  ("head", result.head.block_num)("last_irr", result.last_irreversible.block_num)(
                      "this_block", result.this_block ? result.this_block->block_num : fc::variant()));
-         send(std::move(result));
-         --block_req.max_messages_in_flight;
          need_to_send_update = block_req.start_block_num <= current &&
                                block_req.start_block_num < block_req.end_block_num;
+         if (const auto limit = max_batch_bytes()) {
+            add_to_batch(std::move(result), deltas);
+            if (batch.size() >= limit || !need_to_send_update) {
+               send_batch();
+            } else {
+               // continue on the strand rather than recursing for every block of the batch
+               boost::asio::post(strand, [self = shared_from_this()]() {
+                  self->callback({}, "batch", [self] { self->continue_batch([self] { self->send_update(); }); });
+               });
+            }
+         } else {
+            send(std::move(result), std::move(deltas));
+            --block_req.max_messages_in_flight;
+         }
 
          std::visit( []( auto&& ptr ) {
             if( ptr ) {
@@ -296,7 +567,7 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
          std::visit(
              [&head_block_state, this](const auto& req) {
                 // send get_blocks_result_v1 when the request is get_blocks_request_v0 and
-                // send send_block_result_v2 when the request is get_blocks_request_v1. 
+                // send send_block_result_v2 when the request is get_blocks_request_v1 or get_blocks_request_v2.
                 if (head_block_state->block) {
                   typename std::decay_t<decltype(req)>::response_type result;
                   result.head = { head_block_state->block_num, head_block_state->id };
@@ -320,8 +591,7 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
          if (!send_queue.empty() || !need_to_send_update || 
              !max_messages_in_flight())
             return;
-         auto& chain = plugin->chain_plug->chain();
-         send_update_for_block(chain.head_block_state());
+         send_update_for_block(plugin->get_head_block_state());
       }
 
       template <typename F>
@@ -340,15 +610,14 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
          }
       }
 
+      // called on the strand
       template <typename F>
       void callback(boost::system::error_code ec, const char* what, F f) {
-         app().post( priority::medium, [=]() {
-            if( plugin->stopping )
-               return;
-            if( ec )
-               return on_fail( ec, what );
-            catch_and_close( f );
-         } );
+         if( plugin->stopping )
+            return;
+         if( ec )
+            return on_fail( ec, what );
+         catch_and_close( f );
       }
 
       void on_fail(boost::system::error_code ec, const char* what) {
@@ -361,18 +630,23 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
       }
 
       void close() {
-         socket_stream->next_layer().close();
+         if (socket_stream)
+            socket_stream->next_layer().close();
+         std::lock_guard g(plugin->sessions_mtx);
          plugin->sessions.erase(this);
       }
    };
+   std::mutex                                   sessions_mtx;
    std::map<session*, std::shared_ptr<session>> sessions;
+   /// the sessions waiting for a state snapshot, main thread only
+   std::vector<std::pair<std::shared_ptr<session>, get_blocks_request_v5>> pending_snapshots;
 
    void listen() {
       boost::system::error_code ec;
 
       auto address  = boost::asio::ip::make_address(endpoint_address);
       auto endpoint = tcp::endpoint{address, endpoint_port};
-      acceptor      = std::make_unique<tcp::acceptor>(app().get_io_service());
+      acceptor      = std::make_unique<tcp::acceptor>(thread_pool->get_executor());
 
       auto check_ec = [&](const char* what) {
          if (!ec)
@@ -392,7 +666,7 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
    }
 
    void do_accept() {
-      auto socket = std::make_shared<tcp::socket>(app().get_io_service());
+      auto socket = std::make_shared<tcp::socket>(thread_pool->get_executor());
       acceptor->async_accept(*socket, [self = shared_from_this(), socket, this](const boost::system::error_code& ec) {
          if (stopping)
             return;
@@ -402,9 +676,15 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
             return;
          }
          catch_and_log([&] {
-            auto s            = std::make_shared<session>(self);
-            sessions[s.get()] = s;
-            s->start(std::move(*socket));
+            auto s = std::make_shared<session>(self, thread_pool->get_executor());
+            {
+               std::lock_guard g(sessions_mtx);
+               sessions[s.get()] = s;
+            }
+            boost::asio::post(s->strand, [s, socket]() {
+               if (!s->plugin->stopping)
+                  catch_and_log([&] { s->start(std::move(*socket)); });
+            });
          });
          catch_and_log([&] { do_accept(); });
       });
@@ -412,15 +692,29 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
 
    void on_applied_transaction(const transaction_trace_ptr& p, const packed_transaction_ptr& t) {
       if (trace_log)
-         trace_log->add_transaction(p, t);
+         trace_log->add_transaction(chain_plug->chain().db(), p, t);
    }
 
    void store(const block_state_ptr& block_state) {
       try {
-         if (trace_log)
-            trace_log->store(chain_plug->chain().db(), block_state);
+         // the deltas are created and compressed on a state history thread while the traces are stored, the main
+         // thread does not modify the state until both are done
+         std::future<void> chain_state_stored;
          if (chain_state_log)
-            chain_state_log->store(chain_plug->chain().kv_db(), block_state);
+            chain_state_stored = async_thread_pool(thread_pool->get_executor(), [this, &block_state]() {
+               chain_state_log->store(chain_plug->chain().kv_db(), block_state);
+            });
+         std::exception_ptr trace_error;
+         try {
+            if (trace_log)
+               trace_log->store(chain_plug->chain().db(), block_state);
+         } catch (...) {
+            trace_error = std::current_exception();
+         }
+         if (chain_state_stored.valid())
+            chain_state_stored.get();
+         if (trace_error)
+            std::rethrow_exception(trace_error);
          return;
       }
       FC_LOG_AND_DROP()
@@ -442,19 +736,75 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
       fc_add_tag(blk_span, "block_num", block_state->block_num);
       fc_add_tag(blk_span, "block_time", block_state->block->timestamp.to_time_point());
       this->store(block_state);
-      for (auto& s : sessions) {
-         auto& p = s.second;
-         if (p) {
-            if (p->current_request) {
-               uint32_t& req_start_block_num =
-                   std::visit([](auto& req) -> uint32_t& { return req.start_block_num; }, *p->current_request);
-               if (block_state->block_num < req_start_block_num) {
-                  req_start_block_num = block_state->block_num;
+      update_chain_head(block_state);
+      feed_block_consumers(block_state);
+
+      std::vector<std::shared_ptr<session>> current_sessions;
+      {
+         std::lock_guard g(sessions_mtx);
+         for (auto& s : sessions)
+            current_sessions.push_back(s.second);
+      }
+      for (auto& p : current_sessions) {
+         boost::asio::post(p->strand, [p, block_state]() {
+            p->callback({}, "accepted_block", [&] {
+               if (p->current_request) {
+                  uint32_t& req_start_block_num = p->current_block_request().start_block_num;
+                  if (block_state->block_num < req_start_block_num) {
+                     req_start_block_num = block_state->block_num;
+                  }
                }
-            }
-            p->send_update(block_state);
+               p->send_update(block_state);
+            });
+         });
+      }
+      send_state_snapshots(block_state);
+   }
+
+   // called on the main thread after block_state is stored in the logs
+   void feed_block_consumers(const block_state_ptr& block_state) {
+      if (block_consumers.empty())
+         return;
+      get_blocks_result_v1 result;
+      result.head              = {block_state->block_num, block_state->id};
+      result.last_irreversible = get_last_irreversible();
+      result.this_block        = result.head;
+      result.prev_block        = block_position{block_state->block_num - 1, block_state->block->previous};
+      result.block             = signed_block_ptr_variant{block_state->block};
+      if (trace_log)
+         result.traces = trace_log->get_log_entry(block_state->block_num);
+      if (chain_state_log)
+         result.deltas = chain_state_log->get_log_entry(block_state->block_num);
+      auto data = std::make_shared<const std::vector<char>>(fc::raw::pack(state_result{std::move(result)}));
+      for (auto& c : block_consumers)
+         boost::asio::post(c.strand, [&c, data]() { catch_and_log([&] { c.consumer(data); }); });
+   }
+
+   // called on the main thread when block_state is accepted, the state matches it until the next block starts
+   void send_state_snapshots(const block_state_ptr& block_state) {
+      std::vector<std::pair<std::shared_ptr<session>, get_blocks_request_v5>> waiting;
+      {
+         std::lock_guard g(sessions_mtx);
+         for (auto& p : pending_snapshots) {
+            if (sessions.count(p.first.get()))
+               waiting.push_back(std::move(p));
          }
       }
+      pending_snapshots.clear();
+      if (waiting.empty())
+         return;
+
+      auto& chain = chain_plug->chain();
+      fc_ilog(_log, "creating a state snapshot at block ${b}", ("b", block_state->block_num));
+      auto deltas = std::make_shared<const std::vector<char>>(
+          fc::raw::pack(state_history::create_deltas(chain.kv_db(), true, &chain.get_thread_pool())));
+      // posted after the accepted_block updates, which would otherwise rewind the requests to this block
+      for (auto& [p, req] : waiting) {
+         boost::asio::post(p->strand, [p = p, req = std::move(req), block_state, deltas]() mutable {
+            p->callback({}, "state_snapshot",
+                        [&] { p->send_state_snapshot(std::move(req), block_state, *deltas); });
+         });
+      }
    }
 
    void on_block_start(uint32_t block_num) {
@@ -480,6 +830,16 @@ void state_history_plugin::set_program_options(options_description& cli, options
            "the location of the state history archive directory (absolute path or relative to state-history dir).\n"
            "If the value is empty, blocks files beyond the retained limit will be deleted.\n"
            "All files in the archive directory are completely under user's control, i.e. they won't be accessed by nodeos anymore.");
+   options("state-history-archive-store-command", bpo::value<std::string>()->default_value(""),
+          "command that stores a history file leaving the retained dir in a remote store such as an S3 compatible object store,\n"
+          "%p is replaced by the local path and %f by the file name, both without the .log/.index extension and quoted for the shell.\n"
+          "Requires state-history-archive-fetch-command. The archive dir, or the retained dir if it is empty, then caches the most\n"
+          "recently stored or fetched files and the blocks in archived files can be queried.");
+   options("state-history-archive-fetch-command", bpo::value<std::string>()->default_value(""),
+          "command that fetches %f.log and %f.index from the remote store to %p.log and %p.index. It runs in the background,\n"
+          "the blocks of an archived file which is not cached are unavailable until it is fetched.");
+   options("max-cached-archive-history-files", bpo::value<uint32_t>()->default_value(4),
+          "the maximum number of archived history files cached locally when a remote store is used");
    options("state-history-stride", bpo::value<uint32_t>()->default_value(UINT32_MAX),
          "split the state history log files when the block number is the multiple of the stride\n"
          "When the stride is reached, the current history log and index will be renamed '*-history-<start num>-<end num>.log/index'\n"
@@ -499,6 +859,11 @@ void state_history_plugin::set_program_options(options_description& cli, options
            "enable debug mode for trace history");
    options("context-free-data-compression", bpo::value<string>()->default_value("zlib"), 
            "compression mode for context free data in transaction traces. Supported options are \"zlib\" and \"none\"");
+   options("state-history-threads", bpo::value<uint16_t>()->default_value(my->thread_pool_size),
+           "number of worker threads that serve the state history sessions and compress the chain state history");
+   options("state-history-compression-level", bpo::value<int>()->default_value(-1),
+           "zlib compression level of the state history logs, from 0 (no compression) to 9 (best compression), "
+           "-1 for the zlib default");
 }
 
 void state_history_plugin::plugin_initialize(const variables_map& options) {
@@ -509,14 +874,17 @@ void state_history_plugin::plugin_initialize(const variables_map& options) {
       my->chain_plug = app().find_plugin<chain_plugin>();
       EOS_ASSERT(my->chain_plug, chain::missing_chain_plugin_exception, "");
       auto& chain = my->chain_plug->chain();
+      EOS_ASSERT(!chain.get_config().minimal_validation_traces, plugin_exception,
+                 "state_history_plugin requires full traces, it cannot be used with minimal-validation-traces");
       my->applied_transaction_connection.emplace(
-          chain.applied_transaction.connect([&](std::tuple<const transaction_trace_ptr&, const packed_transaction_ptr&> t) {
-             my->on_applied_transaction(std::get<0>(t), std::get<1>(t));
-          }));
-      my->accepted_block_connection.emplace(
-          chain.accepted_block.connect([&](const block_state_ptr& p) { my->on_accepted_block(p); }));
-      my->block_start_connection.emplace(
-          chain.block_start.connect([&](uint32_t block_num) { my->on_block_start(block_num); }));
+          chain.applied_transaction.connect(timed_slot("state_history.applied_transaction",
+              [&](std::tuple<const transaction_trace_ptr&, const packed_transaction_ptr&> t) {
+                 my->on_applied_transaction(std::get<0>(t), std::get<1>(t));
+              })));
+      my->accepted_block_connection.emplace(chain.accepted_block.connect(
+          timed_slot("state_history.accepted_block", [&](const block_state_ptr& p) { my->on_accepted_block(p); })));
+      my->block_start_connection.emplace(chain.block_start.connect(
+          timed_slot("state_history.block_start", [&](uint32_t block_num) { my->on_block_start(block_num); })));
 
       auto  dir_option = options.at("state-history-dir").as<bfs::path>();
 
@@ -533,6 +901,16 @@ void state_history_plugin::plugin_initialize(const variables_map& options) {
       config.archive_dir        = options.at("state-history-archive-dir").as<bfs::path>();
       config.stride             = options.at("state-history-stride").as<uint32_t>();
       config.max_retained_files = options.at("max-retained-history-files").as<uint32_t>();
+      config.compression_level  = options.at("state-history-compression-level").as<int>();
+      EOS_ASSERT(config.compression_level >= -1 && config.compression_level <= 9, plugin_config_exception,
+                 "state-history-compression-level ${level} must be between -1 and 9",
+                 ("level", config.compression_level));
+      config.remote_archive.store_command    = options.at("state-history-archive-store-command").as<std::string>();
+      config.remote_archive.fetch_command    = options.at("state-history-archive-fetch-command").as<std::string>();
+      config.remote_archive.max_cached_files = options.at("max-cached-archive-history-files").as<uint32_t>();
+      EOS_ASSERT(config.remote_archive.store_command.empty() == config.remote_archive.fetch_command.empty(),
+                 plugin_config_exception,
+                 "state-history-archive-store-command and state-history-archive-fetch-command must be set together");
 
       auto ip_port         = options.at("state-history-endpoint").as<string>();
       auto port            = ip_port.substr(ip_port.find(':') + 1, ip_port.size());
@@ -541,6 +919,12 @@ void state_history_plugin::plugin_initialize(const variables_map& options) {
       my->endpoint_port    = std::stoi(port);
       idump((ip_port)(host)(port));
 
+      my->thread_pool_size = options.at("state-history-threads").as<uint16_t>();
+      EOS_ASSERT(my->thread_pool_size > 0, plugin_config_exception,
+                 "state-history-threads ${num} must be greater than 0", ("num", my->thread_pool_size));
+      // blocks can be accepted, e.g. during a replay, before the plugin starts up
+      my->thread_pool.emplace("ship", my->thread_pool_size);
+
       if (options.at("delete-state-history").as<bool>()) {
          fc_ilog(_log, "Deleting state history");
          boost::filesystem::remove_all(config.log_dir);
@@ -549,6 +933,7 @@ void state_history_plugin::plugin_initialize(const variables_map& options) {
 
       if (options.at("trace-history").as<bool>()) {
          my->trace_log.emplace(config);
+         my->trace_log->set_thread_pool(my->thread_pool->get_executor());
          if (options.at("trace-history-debug-mode").as<bool>()) 
             my->trace_log->trace_debug_mode = true;  
 
@@ -562,14 +947,22 @@ void state_history_plugin::plugin_initialize(const variables_map& options) {
          }
       }
 
-      if (options.at("chain-state-history").as<bool>())
+      if (options.at("chain-state-history").as<bool>()) {
          my->chain_state_log.emplace(config);
+         my->chain_state_log->thread_pool = &chain.get_thread_pool();
+      }
    }
    FC_LOG_AND_RETHROW()
 } // state_history_plugin::plugin_initialize
 
+void state_history_plugin::add_block_consumer(block_consumer consumer) {
+   EOS_ASSERT(my->thread_pool, plugin_config_exception, "state_history_plugin is not initialized");
+   my->block_consumers.push_back({std::move(consumer), boost::asio::io_context::strand{my->thread_pool->get_executor()}});
+}
+
 void state_history_plugin::plugin_startup() { 
    handle_sighup(); // setup logging
+   my->update_chain_head(my->chain_plug->chain().head_block_state());
    my->listen(); 
 }
 
@@ -577,9 +970,13 @@ void state_history_plugin::plugin_shutdown() {
    my->applied_transaction_connection.reset();
    my->accepted_block_connection.reset();
    my->block_start_connection.reset();
+   my->stopping = true;
+   if (my->thread_pool)
+      my->thread_pool->stop();
+   // the sessions are not accessed by the state history threads anymore
+   my->acceptor.reset();
    while (!my->sessions.empty())
       my->sessions.begin()->second->close();
-   my->stopping = true;
 }
 
 void state_history_plugin::handle_sighup() {
@@ -2,6 +2,10 @@
 
 #include <zlib.h>
 
+#include <algorithm>
+#include <future>
+#include <optional>
+
 namespace {
    using seek_point_entry = std::tuple<uint64_t, uint64_t>;
    constexpr size_t expected_seek_point_entry_size = 16;
@@ -15,6 +19,56 @@ namespace {
    //
    static_assert(sizeof(seek_point_entry) == expected_seek_point_entry_size, "unexpected size for seek point");
    static_assert(sizeof(seek_point_count_type) == expected_seek_point_count_size, "Unexpected size for seek point count");
+
+   /**
+    * Compress the data between two seek points with a compressor of its own.  Unless it is the last stride of the file
+    * the output ends with a full flush instead of the end of the stream, so the compressed strides concatenate into
+    * a single raw zlib stream where a decompressor can start at the beginning of every stride.
+    *
+    * @return the compressed data, or an empty optional if the compressor could not be initialized
+    */
+   std::optional<std::vector<uint8_t>> compress_stride( const std::vector<uint8_t>& input, bool last ) {
+      z_stream strm;
+      strm.zalloc = Z_NULL;
+      strm.zfree = Z_NULL;
+      strm.opaque = Z_NULL;
+
+      if (deflateInit2(&strm, Z_BEST_COMPRESSION, Z_DEFLATED, raw_zlib_window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+         return {};
+      }
+
+      // the bound does not cover the marker of a full flush, leave room for it
+      constexpr size_t flush_marker_size = 16;
+      std::vector<uint8_t> output(deflateBound(&strm, input.size()) + flush_marker_size);
+      strm.avail_in = input.size();
+      strm.next_in = const_cast<uint8_t*>(input.data());
+      strm.avail_out = output.size();
+      strm.next_out = output.data();
+
+      const int mode = last ? Z_FINISH : Z_FULL_FLUSH;
+      while (true) {
+         const auto ret = deflate(&strm, mode);
+         const bool success = ret == Z_OK || ret == Z_BUF_ERROR || (last && ret == Z_STREAM_END);
+         if (!success) {
+            deflateEnd(&strm);
+            throw eosio::trace_api::compressed_file_error(std::string("deflate failed: ") + std::to_string(ret));
+         }
+
+         if (last ? ret == Z_STREAM_END : strm.avail_out != 0) {
+            break;
+         }
+
+         // out of output space, keep going in a larger buffer
+         const size_t used = output.size() - strm.avail_out;
+         output.resize(output.size() * 2);
+         strm.avail_out = output.size() - used;
+         strm.next_out = output.data() + used;
+      }
+
+      output.resize(output.size() - strm.avail_out);
+      deflateEnd(&strm);
+      return output;
+   }
 }
 
 namespace eosio::trace_api {
@@ -194,7 +248,7 @@ compressed_file::compressed_file( compressed_file&& ) = default;
 compressed_file& compressed_file::operator= ( compressed_file&& ) = default;
 
 
-bool compressed_file::process( const fc::path& input_path, const fc::path& output_path, size_t seek_point_stride  ) {
+bool compressed_file::process( const fc::path& input_path, const fc::path& output_path, size_t seek_point_stride, size_t thread_count ) {
    if (!fc::exists(input_path)) {
       throw std::ios_base::failure(std::string("Attempting to create compressed_file from file that does not exist: ") + input_path.generic_string());
    }
@@ -209,7 +263,8 @@ bool compressed_file::process( const fc::path& input_path, const fc::path& outpu
    // point for the last byte as will XN + 1 which will create X seek points (the last of which is for the last byte)
    // of the file
    const auto seek_point_count = (input_size - 1) / seek_point_stride;
-   std::vector<seek_point_entry> seek_point_map(seek_point_count);
+   std::vector<seek_point_entry> seek_point_map;
+   seek_point_map.reserve(seek_point_count);
 
    fc::cfile input_file;
    input_file.set_file_path(input_path);
@@ -219,85 +274,43 @@ bool compressed_file::process( const fc::path& input_path, const fc::path& outpu
    output_file.set_file_path(output_path);
    output_file.open("wb");
 
-   z_stream strm;
-   strm.zalloc = Z_NULL;
-   strm.zfree = Z_NULL;
-   strm.opaque = Z_NULL;
-
-   if (deflateInit2(&strm, Z_BEST_COMPRESSION, Z_DEFLATED, raw_zlib_window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
-      return false;
-   }
-
-   constexpr size_t buffer_size = 64*1024;
-   auto input_buffer = std::vector<uint8_t>(buffer_size);
-   auto output_buffer = std::vector<uint8_t>(buffer_size);
-
-   auto bytes_remaining_before_sync = seek_point_stride;
-   unsigned int next_sync_point = 0;
-
-   // process a single chunk of input completely,
-   // this may sometime loop multiple times if the compressor state combined with input data creates more than a
-   // single buffer's worth of data
-   //
-   auto process_chunk = [&]( size_t input_size, int mode ) {
-      strm.avail_in = input_size;
-      strm.next_in = input_buffer.data();
-
-      do {
-         strm.avail_out = output_buffer.size();
-         strm.next_out = output_buffer.data();
-         auto ret = deflate(&strm, mode);
-
-         const bool success = ret == Z_OK || (mode == Z_FINISH && ret == Z_STREAM_END);
-         if (!success) {
-            return ret;
-         }
-
-         output_file.write(reinterpret_cast<const char*>(output_buffer.data()), output_buffer.size() - strm.avail_out);
-      } while (strm.avail_out == 0);
-
-      return Z_OK;
-   };
+   // the strides between seek points do not depend on each other, so a batch of thread_count strides is compressed
+   // in parallel and the results are written in order
+   thread_count = std::max<size_t>(thread_count, 1);
+   const size_t stride_count = seek_point_count + 1;
+   std::vector<std::vector<uint8_t>> input_buffers(std::min(thread_count, stride_count));
 
    size_t read_offset = 0;
-   while (read_offset < input_size) {
-      const auto bytes_remaining = input_size - read_offset;
-      const auto read_size = std::min({ buffer_size, bytes_remaining, bytes_remaining_before_sync });
-      input_file.read(reinterpret_cast<char*>(input_buffer.data()), read_size);
-
-      auto ret = process_chunk(read_size, Z_NO_FLUSH);
-      if (ret != Z_OK) {
-         throw compressed_file_error(std::string("deflate failed: ") + std::to_string(ret));
+   for (size_t first_stride = 0; first_stride < stride_count; first_stride += input_buffers.size()) {
+      const size_t batch_size = std::min(input_buffers.size(), stride_count - first_stride);
+      const auto launch_policy = batch_size > 1 ? std::launch::async : std::launch::deferred;
+
+      std::vector<std::future<std::optional<std::vector<uint8_t>>>> compressed;
+      compressed.reserve(batch_size);
+      for (size_t i = 0; i < batch_size; ++i) {
+         auto& input = input_buffers[i];
+         input.resize(std::min(seek_point_stride, input_size - read_offset));
+         input_file.read(reinterpret_cast<char*>(input.data()), input.size());
+         read_offset += input.size();
+
+         const bool last = first_stride + i + 1 == stride_count;
+         compressed.emplace_back(std::async(launch_policy, [&input, last]() { return compress_stride(input, last); }));
       }
-      read_offset += read_size;
 
-      if (read_size == bytes_remaining ) {
-         // finish the file out by draining remaining output
-         ret = process_chunk(0, Z_FINISH);
-         if (ret != Z_OK) {
-            throw compressed_file_error(std::string("failed to finalize file compression: ") + std::to_string(ret));
+      for (size_t i = 0; i < batch_size; ++i) {
+         const auto output = compressed[i].get();
+         if (!output) {
+            return false;
          }
-      } else if ( read_size == bytes_remaining_before_sync ) {
-         // create a sync point by flushing the compressor so a decompressor can start at this offset
-         ret = process_chunk(0, Z_FULL_FLUSH);
-         if (ret != Z_OK) {
-            throw compressed_file_error(std::string("failed to create sync point: ") + std::to_string(ret));
-         }
-
-         seek_point_map.at(next_sync_point++) = {read_offset, output_file.tellp()};
+         output_file.write(reinterpret_cast<const char*>(output->data()), output->size());
 
-         if (next_sync_point == seek_point_count) {
-            // if we are out of sync points, set this value one past the end (disabling it)
-            bytes_remaining_before_sync = input_size - read_offset + 1;
-         } else {
-            bytes_remaining_before_sync = seek_point_stride;
+         const size_t stride = first_stride + i;
+         if (stride < seek_point_count) {
+            seek_point_map.emplace_back((stride + 1) * seek_point_stride, output_file.tellp());
          }
-      } else {
-         bytes_remaining_before_sync -= read_size;
       }
    }
 
-   deflateEnd(&strm);
    input_file.close();
 
    // write out the seek point table
@@ -312,4 +325,4 @@ bool compressed_file::process( const fc::path& input_path, const fc::path& outpu
    return true;
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+namespace eosio::trace_api {
+
+   /**
+    * Read-only memory mappings of the most recently read slice files, shared by concurrent readers so that reading a
+    * slice does not reopen the file and seek in it.
+    *
+    * A mapping covers the file as it was when it was mapped.  Slice files are only appended to, so when a file has
+    * grown past its mapping the mapping is replaced; readers that hold the previous mapping keep reading it, and a
+    * reader never sees the new mapping before it is complete.  The lookups share a lock which is only held
+    * exclusively while a mapping is replaced, the reads themselves do not lock.
+    */
+   class mapped_slice_cache {
+   public:
+      using mapping_ptr = std::shared_ptr<const boost::iostreams::mapped_file_source>;
+
+      /**
+       * @param max_files : the number of files kept mapped, the files of the lowest slices are unmapped first
+       */
+      explicit mapped_slice_cache( size_t max_files )
+      :_max_files(max_files)
+      {}
+
+      /**
+       * Get a mapping of the whole slice file
+       *
+       * @param slice_number : the slice number of the file
+       * @param slice_path : the path of the slice file
+       * @return the mapping of the file, or nullptr if the file does not exist or is empty
+       */
+      mapping_ptr get( uint32_t slice_number, const boost::filesystem::path& slice_path );
+
+      /**
+       * Drop the mapping of a slice file which has been removed or replaced
+       *
+       * @param slice_number : the slice number of the file
+       * @param slice_path : the path of the slice file
+       */
+      void erase( uint32_t slice_number, const boost::filesystem::path& slice_path );
+
+   private:
+      const size_t                                            _max_files;
+      std::shared_mutex                                       _mtx;
+      std::map<std::pair<uint32_t, std::string>, mapping_ptr> _mappings;
+   };
+}
@@ -20,7 +20,17 @@ namespace eosio { namespace trace_api {
       lib_entry_v0
    >;
 
+   /**
+    * an entry of a transaction index slice, the entries have a fixed size so the slice can be scanned without
+    * unpacking them
+    */
+   struct transaction_index_entry_v0 {
+      chain::transaction_id_type id;
+      uint32_t                   block_num;
+   };
+
 }}
 
 FC_REFLECT(eosio::trace_api::block_entry_v0, (id)(number)(offset));
 FC_REFLECT(eosio::trace_api::lib_entry_v0, (lib));
+FC_REFLECT(eosio::trace_api::transaction_index_entry_v0, (id)(block_num));
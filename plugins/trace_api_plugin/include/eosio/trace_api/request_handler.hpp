@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <fc/variant.hpp>
 #include <eosio/trace_api/metadata_log.hpp>
 #include <eosio/trace_api/data_log.hpp>
@@ -8,19 +9,40 @@
 namespace eosio::trace_api {
    using data_handler_function = std::function<std::tuple<fc::variant, std::optional<fc::variant>>( const std::variant<action_trace_v0, action_trace_v1> & action_trace_t, const yield_function&)>;
 
+   /**
+    * A function that calls `f` for every index in [0, count) and returns once all of the calls have returned, the calls
+    * may be made in parallel.  An exception thrown by a call is rethrown after all of the calls have returned.
+    */
+   using parallel_for_function = std::function<void(size_t count, const std::function<void(size_t)>& f)>;
+
    namespace detail {
       class response_formatter {
       public:
-         static fc::variant process_block( const data_log_entry& trace, bool irreversible, const data_handler_function& data_handler, const yield_function& yield );
+         /**
+          * @param parallel_for - if provided, the data of the actions of a large block is decoded in parallel with it
+          *                       before the block is formatted
+          */
+         static fc::variant process_block( const data_log_entry& trace, bool irreversible, const data_handler_function& data_handler, const yield_function& yield, const parallel_for_function& parallel_for = {} );
+
+         /**
+          * @return the variant of the transaction with the given id in the block trace together with the number, id
+          *         and status of the block, or an empty variant if the block trace does not contain the transaction
+          */
+         static fc::variant process_transaction( const data_log_entry& trace, const chain::transaction_id_type& trx_id, bool irreversible, const data_handler_function& data_handler, const yield_function& yield );
       };
    }
 
    template<typename LogfileProvider, typename DataHandlerProvider>
    class request_handler {
    public:
-      request_handler(LogfileProvider&& logfile_provider, DataHandlerProvider&& data_handler_provider)
+      /**
+       * @param parallel_for - if provided, used to decode the data of the actions of large blocks in parallel, the
+       *                       data_handler_provider must then allow concurrent calls
+       */
+      request_handler(LogfileProvider&& logfile_provider, DataHandlerProvider&& data_handler_provider, parallel_for_function parallel_for = {})
       :logfile_provider(std::move(logfile_provider))
       ,data_handler_provider(std::move(data_handler_provider))
+      ,parallel_for(std::move(parallel_for))
       {
       }
 
@@ -43,18 +65,50 @@ namespace eosio::trace_api {
 
          yield();
 
-         auto data_handler = [this](const auto& action, const yield_function& yield) -> std::tuple<fc::variant, std::optional<fc::variant>> {
+         return detail::response_formatter::process_block(std::get<0>(*data), std::get<1>(*data), make_data_handler(), yield, parallel_for);
+      }
+
+      /**
+       * Fetch the trace of a transaction using the transaction index of the logfile provider and convert it to a
+       * fc::variant for conversion to a final format (eg JSON)
+       *
+       * @param trx_id - the id of the transaction whose trace is requested
+       * @param yield - a yield function to allow cooperation during long running tasks
+       * @return a properly formatted variant representing the trace of the transaction, including the number, id and
+       * status of its block, if it exists, an empty variant otherwise.
+       * @throws yield_exception if a call to `yield` throws.
+       * @throws bad_data_exception when there are issues with the underlying data preventing processing.
+       */
+      fc::variant get_transaction_trace( const chain::transaction_id_type& trx_id, const yield_function& yield = {}) {
+         // the index may reference blocks which were forked out and replaced by a block without the transaction
+         for (const uint32_t block_height : logfile_provider.get_trx_block_nums(trx_id, yield)) {
+            auto data = logfile_provider.get_block(block_height, yield);
+            if (!data) {
+               continue;
+            }
+
+            yield();
+
+            auto result = detail::response_formatter::process_transaction(std::get<0>(*data), trx_id, std::get<1>(*data), make_data_handler(), yield);
+            if (!result.is_null()) {
+               return result;
+            }
+         }
+         return {};
+      }
+
+   private:
+      data_handler_function make_data_handler() {
+         return [this](const auto& action, const yield_function& yield) -> std::tuple<fc::variant, std::optional<fc::variant>> {
             return std::visit([&](const auto& action_trace_t) {
                return data_handler_provider.serialize_to_variant(action_trace_t, yield);
             }, action);
          };
-
-         return detail::response_formatter::process_block(std::get<0>(*data), std::get<1>(*data), data_handler, yield);
       }
 
-   private:
       LogfileProvider logfile_provider;
       DataHandlerProvider data_handler_provider;
+      parallel_for_function parallel_for;
    };
 
 
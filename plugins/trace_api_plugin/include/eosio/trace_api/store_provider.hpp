@@ -4,6 +4,7 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <set>
 #include <fc/io/cfile.hpp>
 #include <boost/filesystem.hpp>
 #include <fc/variant.hpp>
@@ -11,6 +12,7 @@
 #include <eosio/trace_api/metadata_log.hpp>
 #include <eosio/trace_api/data_log.hpp>
 #include <eosio/trace_api/compressed_file.hpp>
+#include <eosio/trace_api/mapped_slice_cache.hpp>
 
 namespace eosio::trace_api {
    using namespace boost::filesystem;
@@ -101,7 +103,8 @@ namespace eosio::trace_api {
 
       enum class open_state { read /*read from front to back*/, write /*write to end of file*/ };
       slice_directory(const boost::filesystem::path& slice_dir, uint32_t width, std::optional<uint32_t> minimum_irreversible_history_blocks,
-                      std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride);
+                      std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride,
+                      size_t compression_threads = 1, uint64_t maintenance_max_bytes_per_sec = 0);
 
       /**
        * Return the slice number that would include the passed in block_height
@@ -161,6 +164,36 @@ namespace eosio::trace_api {
        */
       bool find_trace_slice(uint32_t slice_number, open_state state, fc::cfile& trace_file, bool open_file = true) const;
 
+      /**
+       * Find or create the transaction index file associated with the indicated slice_number
+       *
+       * @param slice_number : slice number of the requested slice file
+       * @param state : indicate if the file is going to be written to (appended) or read
+       * @param trx_index_file : the cfile that will be set to the appropriate slice filename
+       *                         and opened to that file
+       * @return the true if file was found (i.e. already existed)
+       */
+      bool find_or_create_trx_index_slice(uint32_t slice_number, open_state state, fc::cfile& trx_index_file) const;
+
+      /**
+       * Find the transaction index file associated with the indicated slice_number
+       *
+       * @param slice_number : slice number of the requested slice file
+       * @param state : indicate if the file is going to be written to (appended) or read
+       * @param trx_index_file : the cfile that will be set to the appropriate slice filename (always)
+       *                         and opened to that file (if it was found)
+       * @param open_file : indicate if the file should be opened (if found) or not
+       * @return the true if file was found (i.e. already existed), if not found trx_index_file
+       *         is set to the appropriate file, but not open
+       */
+      bool find_trx_index_slice(uint32_t slice_number, open_state state, fc::cfile& trx_index_file, bool open_file = true) const;
+
+      /**
+       * @return the slice numbers of the transaction index files in the directory, highest first; they are
+       *         cataloged in memory when the slice_directory is created and as they are created and removed
+       */
+      std::vector<uint32_t> trx_index_slice_numbers() const;
+
       /**
        * Find the read-only compressed trace file associated with the indicated slice_number
        *
@@ -201,11 +234,23 @@ namespace eosio::trace_api {
       /**
        * Cleans up all slices that are no longer needed to maintain the minimum number of blocks past lib
        * Compresses up all slices that can be compressed
+       * When maintenance_max_bytes_per_sec is set, pauses after each slice for the time its bytes take at that rate
        *
        * @param lib : block number of the current lib
        */
       void run_maintenance_tasks(uint32_t lib, const log_handler& log);
 
+      /**
+       * Verify the header at the start of an index slice read through a datastream
+       * @param ds : datastream positioned at the start of the index slice, it is positioned after the header on return
+       */
+      template<typename DataStream>
+      void validate_index_header(DataStream& ds) const {
+         index_header header;
+         fc::raw::unpack(ds, header);
+         validate_index_header(header);
+      }
+
    private:
       // returns true if slice is found, slice_file will always be set to the appropriate path for
       // the slice_prefix and slice_number, but will only be opened if found
@@ -214,6 +259,9 @@ namespace eosio::trace_api {
       // take an index file that is initialized to a file and open it and write its header
       void create_new_index_slice_file(fc::cfile& index_file) const;
 
+      // throws if the header of an index slice is not of the current version
+      void validate_index_header(const index_header& header) const;
+
       // take an open index slice file and verify its header is valid and prepare the file to be appended to (or read from)
       void validate_existing_index_slice_file(fc::cfile& index_file, open_state state) const;
 
@@ -221,6 +269,9 @@ namespace eosio::trace_api {
       template<typename F>
       void process_irreversible_slice_range(uint32_t lib, uint32_t upper_bound_block, std::optional<uint32_t>& lower_bound_slice, F&& f);
 
+      // wait for the time bytes of maintenance I/O take at _maintenance_max_bytes_per_sec, or until shutdown
+      void throttle_maintenance(uint64_t bytes);
+
       const boost::filesystem::path _slice_dir;
       const uint32_t _width;
       const std::optional<uint32_t> _minimum_irreversible_history_blocks;
@@ -228,6 +279,12 @@ namespace eosio::trace_api {
       const std::optional<uint32_t> _minimum_uncompressed_irreversible_history_blocks;
       std::optional<uint32_t> _last_compressed_slice;
       const size_t _compression_seek_point_stride;
+      const size_t _compression_threads;
+      const uint64_t _maintenance_max_bytes_per_sec;
+
+      // slice numbers of the transaction index files, written by the appending thread and the maintenance thread
+      mutable std::mutex _catalog_mtx;
+      mutable std::set<uint32_t> _trx_index_slices;
 
       std::atomic<uint32_t> _best_known_lib{0};
       std::mutex _maintenance_mtx;
@@ -243,8 +300,12 @@ namespace eosio::trace_api {
    public:
       using open_state = slice_directory::open_state;
 
+      /// the number of slice files the readers keep memory mapped
+      static constexpr size_t max_mapped_slice_files = 8;
+
       store_provider(const boost::filesystem::path& slice_dir, uint32_t stride_width, std::optional<uint32_t> minimum_irreversible_history_blocks,
-            std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride);
+            std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride,
+            bool transaction_index = false, size_t compression_threads = 1, uint64_t maintenance_max_bytes_per_sec = 0);
 
       template<typename BlockTrace>
       void append(const BlockTrace& bt);
@@ -258,6 +319,15 @@ namespace eosio::trace_api {
        */
       get_block_t get_block(uint32_t block_height, const yield_function& yield= {});
 
+      /**
+       * Look a transaction up in the transaction index, which is only written when the store_provider is created
+       * with transaction_index set
+       * @param trx_id : the id of the transaction
+       * @return the heights of the blocks the transaction was appended with, the most recent first; a block of a
+       *         fork which did not become part of the chain may be among them
+       */
+      std::vector<uint32_t> get_trx_block_nums(const chain::transaction_id_type& trx_id, const yield_function& yield = {});
+
       void start_maintenance_thread( log_handler log ) {
          _slice_directory.start_maintenance_thread( std::move(log) );
       }
@@ -282,21 +352,29 @@ namespace eosio::trace_api {
          offset = 0;
          fc::cfile index;
          const uint32_t slice_number = _slice_directory.slice_number(block_height);
-         const bool found = _slice_directory.find_index_slice(slice_number, open_state::read, index);
+         const bool found = _slice_directory.find_index_slice(slice_number, open_state::read, index, false);
          if( !found ) {
+            _mapped_slices.erase(slice_number, index.get_file_path());
+            return 0;
+         }
+         const auto mapping = _mapped_slices.get(slice_number, index.get_file_path());
+         if( !mapping ) {
             return 0;
          }
-         const uint64_t end = file_size(index.get_file_path());
-         offset = index.tellp();
+         fc::datastream<const char*> ds(mapping->data(), mapping->size());
+         _slice_directory.validate_index_header(ds);
+         const uint64_t end = mapping->size();
+         offset = ds.tellp();
          uint64_t last_read_offset = offset;
          while (offset < end) {
             yield();
-            const auto metadata = extract_store<metadata_log_entry>(index);
+            metadata_log_entry metadata;
+            fc::raw::unpack(ds, metadata);
             if(! fn(metadata)) {
                break;
             }
             last_read_offset = offset;
-            offset = index.tellp();
+            offset = ds.tellp();
          }
          return last_read_offset;
       }
@@ -313,7 +391,8 @@ namespace eosio::trace_api {
          const uint32_t slice_number = _slice_directory.slice_number(block_height);
 
          fc::cfile trace;
-         if( !_slice_directory.find_trace_slice(slice_number, open_state::read, trace) ) {
+         if( !_slice_directory.find_trace_slice(slice_number, open_state::read, trace, false) ) {
+            _mapped_slices.erase(slice_number, trace.get_file_path());
             // attempt to read a compressed trace if one exists
             std::optional<compressed_file> ctrace = _slice_directory.find_compressed_trace_slice(slice_number);
             if (ctrace) {
@@ -325,15 +404,18 @@ namespace eosio::trace_api {
             const std::string bh_str = boost::lexical_cast<std::string>(block_height);
             throw malformed_slice_file("Requested offset: " + offset_str + " to retrieve block number: " + bh_str + " but this trace file is new, so there are no traces present.");
          }
-         const uint64_t end = file_size(trace.get_file_path());
+         const auto mapping = _mapped_slices.get(slice_number, trace.get_file_path());
+         const uint64_t end = mapping ? mapping->size() : 0;
          if( offset >= end ) {
             const std::string offset_str = boost::lexical_cast<std::string>(offset);
             const std::string bh_str = boost::lexical_cast<std::string>(block_height);
             const std::string end_str = boost::lexical_cast<std::string>(end);
             throw malformed_slice_file("Requested offset: " + offset_str + " to retrieve block number: " + bh_str + " but this trace file only goes to offset: " + end_str);
          }
-         trace.seek(offset);
-         return extract_store<data_log_entry>(trace);
+         fc::datastream<const char*> ds(mapping->data() + offset, end - offset);
+         data_log_entry entry;
+         fc::raw::unpack(ds, entry);
+         return entry;
       }
 
       /**
@@ -352,6 +434,8 @@ namespace eosio::trace_api {
       void validate_existing_index_slice_file(fc::cfile& index, open_state state);
 
       slice_directory _slice_directory;
+      mapped_slice_cache _mapped_slices;
+      const bool _transaction_index;
    };
 
 }
@@ -0,0 +1,46 @@
+#include <eosio/trace_api/mapped_slice_cache.hpp>
+
+#include <mutex>
+
+namespace eosio::trace_api {
+   namespace bfs = boost::filesystem;
+
+   mapped_slice_cache::mapping_ptr mapped_slice_cache::get( uint32_t slice_number, const bfs::path& slice_path ) {
+      boost::system::error_code ec;
+      const auto size = bfs::file_size(slice_path, ec);
+      const auto key = std::make_pair(slice_number, slice_path.string());
+      if( ec || size == 0 ) {
+         if( ec ) {
+            erase(slice_number, slice_path);
+         }
+         return {};
+      }
+
+      {
+         std::shared_lock g(_mtx);
+         auto itr = _mappings.find(key);
+         if( itr != _mappings.end() && itr->second->size() >= size ) {
+            return itr->second;
+         }
+      }
+
+      // map the file outside of the lock, another reader may be doing the same
+      auto mapping = std::make_shared<const boost::iostreams::mapped_file_source>(key.second, size);
+
+      std::unique_lock g(_mtx);
+      auto& entry = _mappings[key];
+      if( !entry || entry->size() < mapping->size() ) {
+         entry = mapping;
+      }
+      auto result = entry;
+      while( _mappings.size() > _max_files ) {
+         _mappings.erase(_mappings.begin());
+      }
+      return result;
+   }
+
+   void mapped_slice_cache::erase( uint32_t slice_number, const bfs::path& slice_path ) {
+      std::unique_lock g(_mtx);
+      _mappings.erase(std::make_pair(slice_number, slice_path.string()));
+   }
+}
@@ -1,6 +1,7 @@
 #include <eosio/trace_api/request_handler.hpp>
 
 #include <algorithm>
+#include <unordered_map>
 
 #include <fc/variant_object.hpp>
 
@@ -117,10 +118,73 @@ namespace {
       }
       return result;
    }
+
+   /// the smallest number of actions in a block for which the action data is decoded in parallel
+   constexpr size_t min_parallel_decode_actions = 16;
+
+   using decoded_action_data = std::tuple<fc::variant, std::optional<fc::variant>>;
+   using decoded_actions = std::unordered_map<uint64_t, decoded_action_data>;
+
+   /**
+    * Decode the data of all the actions of a block in parallel before the block is formatted
+    *
+    * @param decoded - receives the decoded data by global sequence, must outlive the returned data handler
+    * @return a data handler handing out the decoded data, or the given data handler if the data was not decoded
+    */
+   template<typename TransactionTrace>
+   data_handler_function predecode_actions(const std::vector<TransactionTrace>& transactions, const data_handler_function& data_handler, const yield_function& yield, const parallel_for_function& parallel_for, decoded_actions& decoded ) {
+      if (!parallel_for) {
+         return data_handler;
+      }
+
+      using action_trace_t = std::conditional_t<std::is_same_v<TransactionTrace, transaction_trace_v2>, action_trace_v1, action_trace_v0>;
+      std::vector<const action_trace_t*> actions;
+      for (const auto& t : transactions) {
+         if constexpr(std::is_same_v<TransactionTrace, transaction_trace_v2>) {
+            for (const auto& a : std::get<std::vector<action_trace_v1>>(t.actions)) {
+               actions.push_back(&a);
+            }
+         } else {
+            for (const auto& a : t.actions) {
+               actions.push_back(&a);
+            }
+         }
+      }
+      if (actions.size() < min_parallel_decode_actions) {
+         return data_handler;
+      }
+
+      std::vector<decoded_action_data> results(actions.size());
+      parallel_for(actions.size(), [&](size_t i) {
+         results[i] = data_handler(*actions[i], yield);
+      });
+
+      decoded.reserve(actions.size());
+      for (size_t i = 0; i < actions.size(); ++i) {
+         if (!decoded.emplace(actions[i]->global_sequence, std::move(results[i])).second) {
+            // the global sequence does not identify the action, decode while formatting instead
+            decoded.clear();
+            return data_handler;
+         }
+      }
+
+      return [&decoded](const std::variant<action_trace_v0, action_trace_v1>& action, const yield_function&) -> decoded_action_data {
+         return decoded.at(std::visit([](const auto& a) { return a.global_sequence; }, action));
+      };
+   }
+
+   template<typename TransactionTrace>
+   fc::variant process_transaction(const std::vector<TransactionTrace>& transactions, const eosio::chain::transaction_id_type& trx_id, const data_handler_function & data_handler,  const yield_function& yield ) {
+      const auto itr = std::find_if(transactions.begin(), transactions.end(), [&trx_id](const auto& t) { return t.id == trx_id; });
+      if (itr == transactions.end()) {
+         return {};
+      }
+      return process_transactions(std::vector<TransactionTrace>{*itr}, data_handler, yield).at(0);
+   }
 }
 
 namespace eosio::trace_api::detail {
-    fc::variant response_formatter::process_block( const data_log_entry& trace, bool irreversible, const data_handler_function& data_handler, const yield_function& yield ) {
+    fc::variant response_formatter::process_block( const data_log_entry& trace, bool irreversible, const data_handler_function& data_handler, const yield_function& yield, const parallel_for_function& parallel_for ) {
        auto common_mvo  = std::visit([&](auto&& arg) -> fc::mutable_variant_object {
           return fc::mutable_variant_object()
              ("id", arg.id.str())
@@ -130,29 +194,54 @@ namespace eosio::trace_api::detail {
              ("timestamp", to_iso8601_datetime(arg.timestamp))
              ("producer", arg.producer.to_string());}, trace);
 
+       decoded_actions decoded;
        if  (std::holds_alternative<block_trace_v0> (trace)){
           auto& block_trace = std::get<block_trace_v0>(trace);
+          const auto block_data_handler = predecode_actions(block_trace.transactions, data_handler, yield, parallel_for, decoded);
           return  fc::mutable_variant_object()
                      (std::move(common_mvo))
-                     ("transactions", process_transactions<transaction_trace_v0>(block_trace.transactions, data_handler, yield ));
+                     ("transactions", process_transactions<transaction_trace_v0>(block_trace.transactions, block_data_handler, yield ));
        }else if(std::holds_alternative<block_trace_v1>(trace)){
           auto& block_trace = std::get<block_trace_v1>(trace);
+          const auto block_data_handler = predecode_actions(block_trace.transactions_v1, data_handler, yield, parallel_for, decoded);
           return	fc::mutable_variant_object()
                 (std::move(common_mvo))
                 ("transaction_mroot", block_trace.transaction_mroot)
                 ("action_mroot", block_trace.action_mroot)
                 ("schedule_version", block_trace.schedule_version)
-                ("transactions", process_transactions<transaction_trace_v1>( block_trace.transactions_v1, data_handler, yield )) ;
+                ("transactions", process_transactions<transaction_trace_v1>( block_trace.transactions_v1, block_data_handler, yield )) ;
        }else if(std::holds_alternative<block_trace_v2>(trace)){
           auto& block_trace = std::get<block_trace_v2>(trace);
+          const auto& transactions = std::get<std::vector<transaction_trace_v2>>(block_trace.transactions);
+          const auto block_data_handler = predecode_actions(transactions, data_handler, yield, parallel_for, decoded);
           return	fc::mutable_variant_object()
                 (std::move(common_mvo))
                 ("transaction_mroot", block_trace.transaction_mroot)
                 ("action_mroot", block_trace.action_mroot)
                 ("schedule_version", block_trace.schedule_version)
-                ("transactions", process_transactions( std::get<std::vector<transaction_trace_v2>>(block_trace.transactions), data_handler, yield )) ;
+                ("transactions", process_transactions( transactions, block_data_handler, yield )) ;
        }else{
           return fc::mutable_variant_object();
        }
     }
+
+    fc::variant response_formatter::process_transaction( const data_log_entry& trace, const chain::transaction_id_type& trx_id, bool irreversible, const data_handler_function& data_handler, const yield_function& yield ) {
+       fc::variant result;
+       if  (std::holds_alternative<block_trace_v0> (trace)){
+          result = ::process_transaction<transaction_trace_v0>(std::get<block_trace_v0>(trace).transactions, trx_id, data_handler, yield);
+       }else if(std::holds_alternative<block_trace_v1>(trace)){
+          result = ::process_transaction<transaction_trace_v1>(std::get<block_trace_v1>(trace).transactions_v1, trx_id, data_handler, yield);
+       }else if(std::holds_alternative<block_trace_v2>(trace)){
+          result = ::process_transaction(std::get<std::vector<transaction_trace_v2>>(std::get<block_trace_v2>(trace).transactions), trx_id, data_handler, yield);
+       }
+       if (result.is_null()) {
+          return {};
+       }
+
+       return std::visit([&](auto&& arg) -> fc::variant {
+          return fc::mutable_variant_object(result.get_object())
+             ("block_num", arg.number)
+             ("block_id", arg.id.str())
+             ("block_status", irreversible ? "irreversible" : "pending");}, trace);
+    }
 }
@@ -3,10 +3,15 @@
 #include <fc/variant_object.hpp>
 #include <fc/log/logger_config.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
 namespace {
       static constexpr uint32_t _current_version = 1;
       static constexpr const char* _trace_prefix = "trace_";
       static constexpr const char* _trace_index_prefix = "trace_index_";
+      static constexpr const char* _trace_trx_index_prefix = "trace_trx_";
       static constexpr const char* _trace_ext = ".log";
       static constexpr const char* _compressed_trace_ext = ".clog";
       static constexpr uint _max_filename_size = std::char_traits<char>::length(_trace_index_prefix) + 10 + 1 + 10 + std::char_traits<char>::length(_compressed_trace_ext) + 1; // "trace_index_" + 10-digits + '-' + 10-digits + ".clog" + null-char
@@ -26,12 +31,34 @@ namespace {
 
          return std::string(filename);
       }
+
+      static constexpr size_t _trx_index_entry_size = sizeof(eosio::chain::transaction_id_type) + sizeof(uint32_t);
+
+      template<typename Transactions>
+      std::vector<char> pack_trx_index_entries(const Transactions& transactions, uint32_t block_num) {
+         std::vector<char> data(transactions.size() * _trx_index_entry_size);
+         fc::datastream<char*> ds(data.data(), data.size());
+         for (const auto& t : transactions) {
+            fc::raw::pack(ds, eosio::trace_api::transaction_index_entry_v0{ .id = t.id, .block_num = block_num });
+         }
+         return data;
+      }
+
+      std::vector<char> pack_trx_index_entries(const eosio::trace_api::block_trace_v1& bt) {
+         return pack_trx_index_entries(bt.transactions_v1, bt.number);
+      }
+
+      std::vector<char> pack_trx_index_entries(const eosio::trace_api::block_trace_v2& bt) {
+         return std::visit([&bt](const auto& transactions) { return pack_trx_index_entries(transactions, bt.number); }, bt.transactions);
+      }
 }
 
 namespace eosio::trace_api {
    namespace bfs = boost::filesystem;
-   store_provider::store_provider(const bfs::path& slice_dir, uint32_t stride_width, std::optional<uint32_t> minimum_irreversible_history_blocks, std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride)
-   : _slice_directory(slice_dir, stride_width, minimum_irreversible_history_blocks, minimum_uncompressed_irreversible_history_blocks, compression_seek_point_stride) {
+   store_provider::store_provider(const bfs::path& slice_dir, uint32_t stride_width, std::optional<uint32_t> minimum_irreversible_history_blocks, std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride, bool transaction_index, size_t compression_threads, uint64_t maintenance_max_bytes_per_sec)
+   : _slice_directory(slice_dir, stride_width, minimum_irreversible_history_blocks, minimum_uncompressed_irreversible_history_blocks, compression_seek_point_stride, compression_threads, maintenance_max_bytes_per_sec)
+   , _mapped_slices(max_mapped_slice_files)
+   , _transaction_index(transaction_index) {
    }
 
    template<typename BlockTrace>
@@ -45,6 +72,17 @@ namespace eosio::trace_api {
 
       auto be = metadata_log_entry { block_entry_v0 { .id = bt.id, .number = bt.number, .offset = offset }};
       append_store(be, index);
+
+      if (_transaction_index) {
+         const auto entries = pack_trx_index_entries(bt);
+         if (!entries.empty()) {
+            fc::cfile trx_index;
+            _slice_directory.find_or_create_trx_index_slice(slice_number, open_state::write, trx_index);
+            trx_index.write(entries.data(), entries.size());
+            trx_index.flush();
+            trx_index.sync();
+         }
+      }
    }
 
    template void store_provider::append<block_trace_v1>(const block_trace_v1& bt);
@@ -87,16 +125,69 @@ namespace eosio::trace_api {
       return std::make_tuple( entry.value(), irreversible );
    }
 
-   slice_directory::slice_directory(const bfs::path& slice_dir, uint32_t width, std::optional<uint32_t> minimum_irreversible_history_blocks, std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride)
+   std::vector<uint32_t> store_provider::get_trx_block_nums(const chain::transaction_id_type& trx_id, const yield_function& yield) {
+      std::vector<uint32_t> block_nums;
+      for (const uint32_t slice_number : _slice_directory.trx_index_slice_numbers()) {
+         fc::cfile trx_index;
+         if (!_slice_directory.find_trx_index_slice(slice_number, open_state::read, trx_index, false)) {
+            _mapped_slices.erase(slice_number, trx_index.get_file_path());
+            continue;
+         }
+         const auto mapping = _mapped_slices.get(slice_number, trx_index.get_file_path());
+         if (!mapping) {
+            continue;
+         }
+         fc::datastream<const char*> ds(mapping->data(), mapping->size());
+         _slice_directory.validate_index_header(ds);
+         const char* const entries = mapping->data() + ds.tellp();
+         // a partially written entry at the end of the slice is ignored
+         const size_t num_entries = (mapping->size() - ds.tellp()) / _trx_index_entry_size;
+         // entries are appended in block order, read them back to front to find the most recent block first
+         for (size_t i = num_entries; i > 0; --i) {
+            yield();
+            const char* const entry = entries + (i - 1) * _trx_index_entry_size;
+            if (memcmp(entry, trx_id.data(), sizeof(trx_id)) != 0) {
+               continue;
+            }
+            transaction_index_entry_v0 e;
+            fc::datastream<const char*> eds(entry, _trx_index_entry_size);
+            fc::raw::unpack(eds, e);
+            if (std::find(block_nums.begin(), block_nums.end(), e.block_num) == block_nums.end()) {
+               block_nums.push_back(e.block_num);
+            }
+         }
+      }
+      return block_nums;
+   }
+
+   slice_directory::slice_directory(const bfs::path& slice_dir, uint32_t width, std::optional<uint32_t> minimum_irreversible_history_blocks, std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride, size_t compression_threads, uint64_t maintenance_max_bytes_per_sec)
    : _slice_dir(slice_dir)
    , _width(width)
    , _minimum_irreversible_history_blocks(minimum_irreversible_history_blocks)
    , _minimum_uncompressed_irreversible_history_blocks(minimum_uncompressed_irreversible_history_blocks)
    , _compression_seek_point_stride(compression_seek_point_stride)
+   , _compression_threads(compression_threads)
+   , _maintenance_max_bytes_per_sec(maintenance_max_bytes_per_sec)
    , _best_known_lib(0) {
       if (!exists(_slice_dir)) {
          bfs::create_directories(slice_dir);
       }
+
+      // the only scan of the directory, the catalog is kept up to date as slices are created and removed
+      const std::string prefix = _trace_trx_index_prefix;
+      for (bfs::directory_iterator it(_slice_dir), end; it != end; ++it) {
+         const std::string filename = it->path().filename().string();
+         if (filename.compare(0, prefix.size(), prefix) != 0 || it->path().extension() != _trace_ext) {
+            continue;
+         }
+         char* slice_start_end = nullptr;
+         const char* const slice_start_str = filename.c_str() + prefix.size();
+         const auto slice_start = std::strtoul(slice_start_str, &slice_start_end, 10);
+         if (slice_start_end == slice_start_str || *slice_start_end != '-') {
+            continue;
+         }
+         _trx_index_slices.insert(slice_number(slice_start));
+      }
    }
 
    bool slice_directory::find_or_create_index_slice(uint32_t slice_number, open_state state, fc::cfile& index_file) const {
@@ -123,18 +214,46 @@ namespace eosio::trace_api {
       append_store(h, index_file);
    }
 
-   void slice_directory::validate_existing_index_slice_file(fc::cfile& index_file, open_state state) const {
-      const auto header = extract_store<index_header>(index_file);
+   void slice_directory::validate_index_header(const index_header& header) const {
       if (header.version != _current_version) {
          throw old_slice_version("Old slice file with version: " + std::to_string(header.version) +
                                  " is in directory, only supporting version: " + std::to_string(_current_version));
       }
+   }
+
+   void slice_directory::validate_existing_index_slice_file(fc::cfile& index_file, open_state state) const {
+      validate_index_header(extract_store<index_header>(index_file));
 
       if( state == open_state::write ) {
          index_file.seek_end(0);
       }
    }
 
+   bool slice_directory::find_or_create_trx_index_slice(uint32_t slice_number, open_state state, fc::cfile& trx_index_file) const {
+      const bool found = find_trx_index_slice(slice_number, state, trx_index_file);
+      if( !found ) {
+         create_new_index_slice_file(trx_index_file);
+         std::lock_guard<std::mutex> g(_catalog_mtx);
+         _trx_index_slices.insert(slice_number);
+      }
+      return found;
+   }
+
+   bool slice_directory::find_trx_index_slice(uint32_t slice_number, open_state state, fc::cfile& trx_index_file, bool open_file) const {
+      const bool found = find_slice(_trace_trx_index_prefix, slice_number, trx_index_file, open_file);
+      if( !found || !open_file ) {
+         return found;
+      }
+
+      validate_existing_index_slice_file(trx_index_file, state);
+      return true;
+   }
+
+   std::vector<uint32_t> slice_directory::trx_index_slice_numbers() const {
+      std::lock_guard<std::mutex> g(_catalog_mtx);
+      return std::vector<uint32_t>(_trx_index_slices.rbegin(), _trx_index_slices.rend());
+   }
+
    bool slice_directory::find_or_create_trace_slice(uint32_t slice_number, open_state state, fc::cfile& trace_file) const {
       const bool found = find_trace_slice(slice_number, state, trace_file);
 
@@ -224,6 +343,8 @@ namespace eosio::trace_api {
 
             uint32_t best_known_lib = _best_known_lib;
             bool shutdown = _maintenance_shutdown;
+            // the tasks wait on the condition to throttle their I/O
+            lock.unlock();
 
             log(std::string("Waking up to handle lib: ") + std::to_string(best_known_lib));
 
@@ -264,6 +385,14 @@ namespace eosio::trace_api {
       }
    }
 
+   void slice_directory::throttle_maintenance(uint64_t bytes) {
+      if (_maintenance_max_bytes_per_sec == 0 || bytes == 0)
+         return;
+      const auto pause = std::chrono::microseconds(bytes * 1'000'000 / _maintenance_max_bytes_per_sec);
+      std::unique_lock<std::mutex> lock(_maintenance_mtx);
+      _maintenance_condition.wait_for(lock, pause, [this]() { return _maintenance_shutdown.load(); });
+   }
+
    void slice_directory::run_maintenance_tasks(uint32_t lib, const log_handler& log) {
       if (_minimum_irreversible_history_blocks) {
          process_irreversible_slice_range(lib, *_minimum_irreversible_history_blocks, _last_cleaned_up_slice, [this, &log](uint32_t slice_to_clean){
@@ -272,24 +401,41 @@ namespace eosio::trace_api {
 
             log(std::string("Attempting Prune of slice: ") + std::to_string(slice_to_clean));
 
+            uint64_t removed_bytes = 0;
+            const auto remove = [&log, &removed_bytes](const bfs::path& p) {
+               log(std::string("Removing: ") + p.generic_string());
+               boost::system::error_code ec;
+               const auto size = bfs::file_size(p, ec);
+               if (!ec)
+                  removed_bytes += size;
+               bfs::remove(p);
+            };
+
             // cleanup index first to reduce the likelihood of reader finding index, but not finding trace
             const bool dont_open_file = false;
             const bool index_found = find_index_slice(slice_to_clean, open_state::read, index, dont_open_file);
             if (index_found) {
-               log(std::string("Removing: ") + index.get_file_path().generic_string());
-               bfs::remove(index.get_file_path());
+               remove(index.get_file_path());
+            }
+            fc::cfile trx_index;
+            const bool trx_index_found = find_trx_index_slice(slice_to_clean, open_state::read, trx_index, dont_open_file);
+            {
+               std::lock_guard<std::mutex> g(_catalog_mtx);
+               _trx_index_slices.erase(slice_to_clean);
+            }
+            if (trx_index_found) {
+               remove(trx_index.get_file_path());
             }
             const bool trace_found = find_trace_slice(slice_to_clean, open_state::read, trace, dont_open_file);
             if (trace_found) {
-               log(std::string("Removing: ") + trace.get_file_path().generic_string());
-               bfs::remove(trace.get_file_path());
+               remove(trace.get_file_path());
             }
 
             auto ctrace = find_compressed_trace_slice(slice_to_clean, dont_open_file);
             if (ctrace) {
-               log(std::string("Removing: ") + ctrace->get_file_path().generic_string());
-               bfs::remove(ctrace->get_file_path());
+               remove(ctrace->get_file_path());
             }
+            throttle_maintenance(removed_bytes);
          });
       }
 
@@ -310,11 +456,13 @@ namespace eosio::trace_api {
                compressed_path.replace_extension(_compressed_trace_ext);
 
                log(std::string("Compressing: ") + trace.get_file_path().generic_string());
-               compressed_file::process(trace.get_file_path(), compressed_path.generic_string(), _compression_seek_point_stride);
+               const uint64_t trace_bytes = bfs::file_size(trace.get_file_path());
+               compressed_file::process(trace.get_file_path(), compressed_path.generic_string(), _compression_seek_point_stride, _compression_threads);
 
                // after compression is complete, delete the old uncompressed file
                log(std::string("Removing: ") + trace.get_file_path().generic_string());
                bfs::remove(trace.get_file_path());
+               throttle_maintenance(trace_bytes);
             }
          });
       }
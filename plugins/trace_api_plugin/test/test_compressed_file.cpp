@@ -212,5 +212,39 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(blob_access_no_seek_points, T, test_types, temp
    }
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(parallel_compression, T, test_types, temp_file_fixture) {
+   auto data = std::vector<T>(128);
+   std::generate(data.begin(), data.end(), []() {
+      return make_random<T>();
+   });
+
+   auto uncompressed_filename = create_temp_file(data.data(), data.size() * sizeof(T));
+   auto serial_filename = create_temp_file(nullptr, 0);
+   auto parallel_filename = create_temp_file(nullptr, 0);
+
+   // the thread count does not divide the number of strides, so the last batch is partial
+   BOOST_TEST(compressed_file::process(uncompressed_filename, serial_filename, 512));
+   BOOST_TEST(compressed_file::process(uncompressed_filename, parallel_filename, 512, 3));
+
+   // the strides are compressed independently, so the output does not depend on the number of threads
+   const auto read_file = [](const std::string& filename) {
+      auto is = bfs::ifstream(filename, std::ios_base::in|std::ios_base::binary);
+      return std::vector<char>(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+   };
+   const auto serial = read_file(serial_filename);
+   const auto parallel = read_file(parallel_filename);
+   BOOST_REQUIRE_EQUAL_COLLECTIONS(serial.begin(), serial.end(), parallel.begin(), parallel.end());
+
+   for (std::size_t i = 0; i < data.size(); i++) {
+      auto compf = compressed_file(parallel_filename);
+      compf.open();
+      T value;
+      compf.seek((long)i * sizeof(T));
+      compf.read(reinterpret_cast<char*>(&value), sizeof(T));
+      BOOST_TEST(value == data.at(i));
+      compf.close();
+   }
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -1070,4 +1070,64 @@ BOOST_AUTO_TEST_SUITE(trace_responses)
       BOOST_REQUIRE_THROW(get_block_trace( 1, yield ), yield_exception);
    }
 
+   BOOST_FIXTURE_TEST_CASE(parallel_decode_block_response_v2, response_test_fixture)
+   {
+      std::vector<transaction_trace_v2> transactions;
+      for (uint64_t i = 0; i < 20; ++i) {
+         transactions.emplace_back(transaction_trace_v2 {
+            "0000000000000000000000000000000000000000000000000000000000000001"_h,
+            std::vector<action_trace_v1> {
+               action_trace_v1 {
+                  {
+                     i,
+                     "receiver"_n, "contract"_n, "action"_n,
+                     {{ "alice"_n, "active"_n }},
+                     { static_cast<char>(i) }
+                  },
+                  { static_cast<char>(i + 1) }
+               }
+            },
+            fc::enum_type<uint8_t, chain::transaction_receipt_header::status_enum>{chain::transaction_receipt_header::status_enum::executed},
+            10,
+            5,
+            std::vector<chain::signature_type>{ chain::signature_type() },
+            { chain::time_point(), 1, 0, 100, 50, 0 }
+         });
+      }
+
+      auto block_trace = block_trace_v2 {
+         "b000000000000000000000000000000000000000000000000000000000000001"_h,
+         1,
+         "0000000000000000000000000000000000000000000000000000000000000000"_h,
+         chain::block_timestamp_type(0),
+         "bp.one"_n,
+         "0000000000000000000000000000000000000000000000000000000000000000"_h,
+         "0000000000000000000000000000000000000000000000000000000000000000"_h,
+         0,
+         std::move(transactions)
+      };
+
+      mock_get_block = [&block_trace]( uint32_t height, const yield_function& ) -> get_block_t {
+         BOOST_TEST(height == 1);
+         return std::make_tuple(data_log_entry(block_trace), false);
+      };
+
+      // decode in reverse order to make sure the decoded data is matched to the actions by their global sequence
+      size_t parallel_count = 0;
+      response_impl_type parallel_impl(mock_logfile_provider(*this), mock_data_handler_provider(*this),
+            [&parallel_count](size_t count, const std::function<void(size_t)>& f) {
+               parallel_count = count;
+               for (size_t i = count; i > 0; --i) {
+                  f(i - 1);
+               }
+            });
+
+      fc::variant expected_response = get_block_trace( 1 );
+      fc::variant actual_response = parallel_impl.get_block_trace( 1 );
+
+      BOOST_TEST(parallel_count == 20);
+      BOOST_TEST(to_kv(expected_response) == to_kv(actual_response), boost::test_tools::per_element());
+   }
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1071,4 +1071,98 @@ BOOST_AUTO_TEST_SUITE(slice_tests)
    }
 
 
+   BOOST_FIXTURE_TEST_CASE(test_get_block_after_append, test_fixture)
+   {
+      fc::temp_directory tempdir;
+      store_provider sp(tempdir.path(), 100, std::optional<uint32_t>(), std::optional<uint32_t>(), 0);
+      sp.append(block_trace1_v2);
+      get_block_t block1 = sp.get_block(1);
+      BOOST_REQUIRE(block1);
+      BOOST_REQUIRE(!std::get<1>(*block1));
+      BOOST_REQUIRE(!sp.get_block(5));
+
+      // the slice files have grown past the mappings used by the first reads
+      sp.append_lib(1);
+      sp.append(block_trace2_v2);
+      block1 = sp.get_block(1);
+      BOOST_REQUIRE(block1);
+      BOOST_REQUIRE(std::get<1>(*block1));
+      BOOST_REQUIRE_EQUAL(std::get<block_trace_v2>(std::get<0>(*block1)), block_trace1_v2);
+
+      get_block_t block2 = sp.get_block(5);
+      BOOST_REQUIRE(block2);
+      BOOST_REQUIRE_EQUAL(std::get<block_trace_v2>(std::get<0>(*block2)), block_trace2_v2);
+   }
+
+   BOOST_FIXTURE_TEST_CASE(test_get_trx_block_nums, test_fixture)
+   {
+      fc::temp_directory tempdir;
+      store_provider sp(tempdir.path(), 2, std::optional<uint32_t>(), std::optional<uint32_t>(), 0, true);
+      BOOST_REQUIRE(sp.get_trx_block_nums(transaction_trace.id).empty());
+
+      sp.append(block_trace1_v2);
+      sp.append(block_trace2_v2);
+      // the blocks are in different slices, the most recent block is returned first
+      BOOST_REQUIRE(sp.get_trx_block_nums(transaction_trace.id) == (std::vector<uint32_t>{5, 1}));
+      BOOST_REQUIRE(sp.get_trx_block_nums("0000000000000000000000000000000000000000000000000000000000000002"_h).empty());
+
+      // a fork which appends the block again does not duplicate the block number
+      sp.append(block_trace2_v2);
+      BOOST_REQUIRE(sp.get_trx_block_nums(transaction_trace.id) == (std::vector<uint32_t>{5, 1}));
+
+      store_provider unindexed(tempdir.path() / "unindexed", 2, std::optional<uint32_t>(), std::optional<uint32_t>(), 0);
+      unindexed.append(block_trace1_v2);
+      BOOST_REQUIRE(unindexed.get_trx_block_nums(transaction_trace.id).empty());
+   }
+
+   BOOST_FIXTURE_TEST_CASE(trx_index_slice_catalog, test_fixture)
+   {
+      fc::temp_directory tempdir;
+      const uint32_t width = 10;
+      const uint32_t min_saved_blocks = 5;
+      {
+         slice_directory sd(tempdir.path(), width, std::optional<uint32_t>(min_saved_blocks), std::optional<uint32_t>(), 0);
+         fc::cfile file;
+         for (uint32_t i = 0; i < 3; ++i) {
+            BOOST_REQUIRE(!sd.find_or_create_trx_index_slice(i, open_state::write, file));
+         }
+         BOOST_REQUIRE(sd.find_or_create_trx_index_slice(1, open_state::write, file));
+         BOOST_REQUIRE(sd.trx_index_slice_numbers() == (std::vector<uint32_t>{2, 1, 0}));
+      }
+
+      // the slices already in the directory are cataloged when it is opened again
+      slice_directory sd(tempdir.path(), width, std::optional<uint32_t>(min_saved_blocks), std::optional<uint32_t>(), 0);
+      BOOST_REQUIRE(sd.trx_index_slice_numbers() == (std::vector<uint32_t>{2, 1, 0}));
+
+      // the pruned slices are removed from the catalog
+      sd.run_maintenance_tasks(2 * width + min_saved_blocks, {});
+      BOOST_REQUIRE(sd.trx_index_slice_numbers() == (std::vector<uint32_t>{2}));
+   }
+
+   BOOST_FIXTURE_TEST_CASE(mapped_slice_cache_bounds, test_fixture)
+   {
+      fc::temp_directory tempdir;
+      mapped_slice_cache cache(2);
+      std::vector<bfs::path> paths;
+      for (uint32_t i = 0; i < 3; ++i) {
+         paths.push_back(tempdir.path() / ("slice_" + std::to_string(i)));
+         fc::cfile file;
+         file.set_file_path(paths.back());
+         file.open(fc::cfile::create_or_update_rw_mode);
+         file.write("abc", 3);
+      }
+
+      auto first = cache.get(0, paths[0]);
+      BOOST_REQUIRE(first);
+      BOOST_REQUIRE_EQUAL(first->size(), 3);
+      BOOST_REQUIRE(cache.get(0, paths[0]) == first);
+      BOOST_REQUIRE(cache.get(1, paths[1]));
+      BOOST_REQUIRE(cache.get(2, paths[2]));
+      // the lowest slice has been unmapped, its previous mapping is still readable
+      BOOST_REQUIRE(cache.get(0, paths[0]) != first);
+      BOOST_REQUIRE_EQUAL(std::string(first->data(), first->size()), "abc");
+
+      BOOST_REQUIRE(!cache.get(3, tempdir.path() / "missing"));
+   }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -9,6 +9,9 @@
 
 #include <eosio/resource_monitor_plugin/resource_monitor_plugin.hpp>
 
+#include <eosio/chain/signal_slots.hpp>
+#include <eosio/chain/thread_utils.hpp>
+
 #include <boost/signals2/connection.hpp>
 
 using namespace eosio::trace_api;
@@ -87,10 +90,41 @@ namespace {
          return store->get_block(height, yield);
       }
 
+      std::vector<uint32_t> get_trx_block_nums(const chain::transaction_id_type& trx_id, const yield_function& yield) {
+         return store->get_trx_block_nums(trx_id, yield);
+      }
+
       std::shared_ptr<Store> store;
    };
+
+   /**
+    * The binary response of get_block, the block trace as it is stored in the trace log
+    */
+   struct binary_block_trace {
+      bool           irreversible = false;
+      data_log_entry trace;
+   };
+
+   std::optional<uint32_t> parse_block_num(const std::string& body) {
+      if (body.empty()) {
+         return {};
+      }
+
+      try {
+         auto input = fc::json::from_string(body);
+         auto block_num = input.get_object()["block_num"].as_uint64();
+         if (block_num > std::numeric_limits<uint32_t>::max()) {
+            return {};
+         }
+         return block_num;
+      } catch (...) {
+         return {};
+      }
+   }
 }
 
+FC_REFLECT(binary_block_trace, (irreversible)(trace))
+
 namespace eosio {
 
 /**
@@ -109,6 +143,13 @@ struct trace_api_common_impl {
       cfg_options("trace-minimum-uncompressed-irreversible-history-blocks", boost::program_options::value<int32_t>()->default_value(-1),
                   "Number of blocks to ensure are uncompressed past LIB. Compressed \"slice\" files are still accessible but may carry a performance loss on retrieval\n"
                   "A value of -1 indicates that automatic compression of \"slice\" files will be turned off.");
+      cfg_options("trace-compression-threads", bpo::value<uint16_t>()->default_value(1),
+                  "Number of threads used to compress a \"slice\" file, each compresses the data between two seek points of the file");
+      cfg_options("trace-maintenance-max-bytes-per-sec", bpo::value<uint64_t>()->default_value(0),
+                  "Limit of the rate, in bytes per second of \"slice\" files, at which the background thread compresses and removes \"slice\" files, so that it does not slow down the reads.\n"
+                  "A value of 0 indicates no limit.");
+      cfg_options("trace-transaction-index", bpo::bool_switch()->default_value(false),
+                  "Write an index of the transaction ids of every \"slice\" so that transaction traces can be retrieved by id with /v1/trace_api/get_transaction_trace");
    }
 
    void plugin_initialize(const appbase::variables_map& options) {
@@ -137,12 +178,22 @@ struct trace_api_common_impl {
          minimum_uncompressed_irreversible_history_blocks = uncompressed_blocks;
       }
 
+      compression_threads = options.at("trace-compression-threads").as<uint16_t>();
+      EOS_ASSERT(compression_threads > 0, chain::plugin_config_exception,
+                 "\"trace-compression-threads\" must be greater than 0.");
+
+      transaction_index = options.at("trace-transaction-index").as<bool>();
+      maintenance_max_bytes_per_sec = options.at("trace-maintenance-max-bytes-per-sec").as<uint64_t>();
+
       store = std::make_shared<store_provider>(
          trace_dir,
          slice_stride,
          minimum_irreversible_history_blocks,
          minimum_uncompressed_irreversible_history_blocks,
-         compression_seek_point_stride
+         compression_seek_point_stride,
+         transaction_index,
+         compression_threads,
+         maintenance_max_bytes_per_sec
       );
    }
 
@@ -162,6 +213,9 @@ struct trace_api_common_impl {
 
    std::optional<uint32_t> minimum_irreversible_history_blocks;
    std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks;
+   uint16_t compression_threads = 1;
+   bool transaction_index = false;
+   uint64_t maintenance_max_bytes_per_sec = 0;
 
    static constexpr int32_t manual_slice_file_value = -1;
    static constexpr uint32_t compression_seek_point_stride = 6 * 1024 * 1024; // 6 MiB strides for clog seek points
@@ -192,6 +246,9 @@ struct trace_api_rpc_plugin_impl : public std::enable_shared_from_this<trace_api
             "Failure to specify this option when there are no trace-rpc-abi configuations will result in an Error.\n"
             "This option is mutually exclusive with trace-rpc-api"
       );
+      cfg_options("trace-rpc-decode-threads", bpo::value<uint16_t>()->default_value(0),
+                  "Number of threads used to decode the action data of large blocks in parallel while responding to trace RPC requests.\n"
+                  "A value of 0 decodes the action data on the thread of the request.");
    }
 
    void plugin_initialize(const appbase::variables_map& options) {
@@ -220,9 +277,45 @@ struct trace_api_rpc_plugin_impl : public std::enable_shared_from_this<trace_api
       }
 
 
+      const auto decode_threads = options.at("trace-rpc-decode-threads").as<uint16_t>();
+      parallel_for_function parallel_for;
+      if (decode_threads > 0) {
+         decode_thread_pool.emplace("trcdec", decode_threads);
+         parallel_for = [&pool=decode_thread_pool->get_executor(), decode_threads](size_t count, const std::function<void(size_t)>& f) {
+            const size_t chunk_size = (count + decode_threads) / (decode_threads + 1);
+            const auto run_chunk = [&f, count, chunk_size](size_t begin) {
+               for (size_t i = begin; i < std::min(count, begin + chunk_size); ++i) {
+                  f(i);
+               }
+            };
+
+            // the thread of the request decodes the first chunk while it waits for the others
+            std::vector<std::future<void>> chunks;
+            for (size_t begin = chunk_size; begin < count; begin += chunk_size) {
+               chunks.emplace_back(chain::async_thread_pool(pool, [&run_chunk, begin]() { run_chunk(begin); }));
+            }
+            std::exception_ptr error;
+            try {
+               run_chunk(0);
+            } catch (...) {
+               error = std::current_exception();
+            }
+            for (auto& chunk : chunks) {
+               chunk.wait();
+            }
+            if (error) {
+               std::rethrow_exception(error);
+            }
+            for (auto& chunk : chunks) {
+               chunk.get();
+            }
+         };
+      }
+
       req_handler = std::make_shared<request_handler_t>(
          shared_store_provider<store_provider>(common->store),
-         abi_data_handler::shared_provider(data_handler)
+         abi_data_handler::shared_provider(data_handler),
+         std::move(parallel_for)
       );
    }
 
@@ -248,25 +341,86 @@ struct trace_api_rpc_plugin_impl : public std::enable_shared_from_this<trace_api
             return;
          }
 
-         auto block_number = ([&body]() -> std::optional<uint32_t> {
+         auto block_number = parse_block_num(body);
+         if (!block_number) {
+            error_results results{400, "Bad or missing block_num"};
+            cb( 400, fc::variant( results ));
+            return;
+         }
+
+         try {
+
+            const auto deadline = that->calc_deadline( max_response_time );
+            auto resp = that->req_handler->get_block_trace(*block_number, [deadline]() { FC_CHECK_DEADLINE(deadline); });
+            if (resp.is_null()) {
+               error_results results{404, "Block trace missing"};
+               cb( 404, fc::variant( results ));
+            } else {
+               cb( 200, std::move(resp) );
+            }
+         } catch (...) {
+            http_plugin::handle_exception("trace_api", "get_block", body, cb);
+         }
+      });
+
+      // the binary response skips the formatting and the decoding of the action data with the ABIs
+      http.add_async_binary_handler("/v1/trace_api/get_block",
+            [wthis=weak_from_this(), max_response_time](std::string, std::string body, url_response_callback cb, url_binary_response_callback binary_cb)
+      {
+         auto that = wthis.lock();
+         if (!that) {
+            return;
+         }
+
+         auto block_number = parse_block_num(body);
+         if (!block_number) {
+            error_results results{400, "Bad or missing block_num"};
+            cb( 400, fc::variant( results ));
+            return;
+         }
+
+         try {
+
+            const auto deadline = that->calc_deadline( max_response_time );
+            auto data = that->common->store->get_block(*block_number, [deadline]() { FC_CHECK_DEADLINE(deadline); });
+            if (!data) {
+               error_results results{404, "Block trace missing"};
+               cb( 404, fc::variant( results ));
+            } else {
+               binary_cb( 200, fc::raw::pack(binary_block_trace{ std::get<1>(*data), std::move(std::get<0>(*data)) }) );
+            }
+         } catch (...) {
+            http_plugin::handle_exception("trace_api", "get_block", body, cb);
+         }
+      });
+
+      if (!common->transaction_index) {
+         return;
+      }
+
+      http.add_async_handler("/v1/trace_api/get_transaction_trace",
+            [wthis=weak_from_this(), max_response_time](std::string, std::string body, url_response_callback cb)
+      {
+         auto that = wthis.lock();
+         if (!that) {
+            return;
+         }
+
+         auto trx_id = ([&body]() -> std::optional<chain::transaction_id_type> {
             if (body.empty()) {
                return {};
             }
 
             try {
                auto input = fc::json::from_string(body);
-               auto block_num = input.get_object()["block_num"].as_uint64();
-               if (block_num > std::numeric_limits<uint32_t>::max()) {
-                  return {};
-               }
-               return block_num;
+               return input.get_object()["id"].as<chain::transaction_id_type>();
             } catch (...) {
                return {};
             }
          })();
 
-         if (!block_number) {
-            error_results results{400, "Bad or missing block_num"};
+         if (!trx_id) {
+            error_results results{400, "Bad or missing id"};
             cb( 400, fc::variant( results ));
             return;
          }
@@ -274,23 +428,27 @@ struct trace_api_rpc_plugin_impl : public std::enable_shared_from_this<trace_api
          try {
 
             const auto deadline = that->calc_deadline( max_response_time );
-            auto resp = that->req_handler->get_block_trace(*block_number, [deadline]() { FC_CHECK_DEADLINE(deadline); });
+            auto resp = that->req_handler->get_transaction_trace(*trx_id, [deadline]() { FC_CHECK_DEADLINE(deadline); });
             if (resp.is_null()) {
-               error_results results{404, "Block trace missing"};
+               error_results results{404, "Transaction trace missing"};
                cb( 404, fc::variant( results ));
             } else {
                cb( 200, std::move(resp) );
             }
          } catch (...) {
-            http_plugin::handle_exception("trace_api", "get_block", body, cb);
+            http_plugin::handle_exception("trace_api", "get_transaction_trace", body, cb);
          }
       });
    }
 
    void plugin_shutdown() {
+      if (decode_thread_pool) {
+         decode_thread_pool->stop();
+      }
    }
 
    std::shared_ptr<trace_api_common_impl> common;
+   std::optional<chain::named_thread_pool> decode_thread_pool;
 
    using request_handler_t = request_handler<shared_store_provider<store_provider>, abi_data_handler::shared_provider>;
    std::shared_ptr<request_handler_t> req_handler;
@@ -302,9 +460,17 @@ struct trace_api_plugin_impl {
 
    static void set_program_options(appbase::options_description& cli, appbase::options_description& cfg) {
       auto cfg_options = cfg.add_options();
+      cfg_options("trace-async-queue-size", bpo::value<uint32_t>()->default_value(0),
+                  "Extract traces on a thread of their own, with up to this many signals of the chain queued for it; the main thread waits when the queue is full.\n"
+                  "0 extracts traces on the main thread while the chain emits its signals.");
    }
 
    void plugin_initialize(const appbase::variables_map& options) {
+      const auto async_queue_size = options.at("trace-async-queue-size").as<uint32_t>();
+      if (async_queue_size > 0) {
+         async_queue.emplace("trace-sig", async_queue_size);
+      }
+
       auto log_exceptions_and_shutdown = [](const exception_with_context& e) {
          log_exception(e, fc::log_level::error);
          app().quit();
@@ -313,34 +479,37 @@ struct trace_api_plugin_impl {
       extraction = std::make_shared<chain_extraction_t>(shared_store_provider<store_provider>(common->store), log_exceptions_and_shutdown);
 
       auto& chain = app().find_plugin<chain_plugin>()->chain();
+      EOS_ASSERT(!chain.get_config().minimal_validation_traces, chain::plugin_config_exception,
+                 "trace_api_plugin requires full traces, it cannot be used with minimal-validation-traces");
 
       applied_transaction_connection.emplace(
-         chain.applied_transaction.connect([this](std::tuple<const chain::transaction_trace_ptr&, const chain::packed_transaction_ptr&> t) {
-            emit_killer([&](){
-               extraction->signal_applied_transaction(std::get<0>(t), std::get<1>(t));
+         chain.applied_transaction.connect(chain::timed_slot("trace_api.applied_transaction",
+               [this](std::tuple<const chain::transaction_trace_ptr&, const chain::packed_transaction_ptr&> t) {
+            dispatch([this, trace=std::get<0>(t), ptrx=std::get<1>(t)](){
+               extraction->signal_applied_transaction(trace, ptrx);
             });
-         }));
+         })));
 
       block_start_connection.emplace(
-            chain.block_start.connect([this](uint32_t block_num) {
-               emit_killer([&](){
+            chain.block_start.connect(chain::timed_slot("trace_api.block_start", [this](uint32_t block_num) {
+               dispatch([this, block_num](){
                   extraction->signal_block_start(block_num);
                });
-            }));
+            })));
 
       accepted_block_connection.emplace(
-         chain.accepted_block.connect([this](const chain::block_state_ptr& p) {
-            emit_killer([&](){
+         chain.accepted_block.connect(chain::timed_slot("trace_api.accepted_block", [this](const chain::block_state_ptr& p) {
+            dispatch([this, p](){
                extraction->signal_accepted_block(p);
             });
-         }));
+         })));
 
       irreversible_block_connection.emplace(
-         chain.irreversible_block.connect([this](const chain::block_state_ptr& p) {
-            emit_killer([&](){
+         chain.irreversible_block.connect(chain::timed_slot("trace_api.irreversible_block", [this](const chain::block_state_ptr& p) {
+            dispatch([this, p](){
                extraction->signal_irreversible_block(p);
             });
-         }));
+         })));
 
    }
 
@@ -349,13 +518,37 @@ struct trace_api_plugin_impl {
    }
 
    void plugin_shutdown() {
+      // extract what is still queued before the store goes away
+      if (async_queue) {
+         async_queue->stop();
+      }
       common->plugin_shutdown();
    }
 
+   /**
+    * Extract on the main thread, or in the order of the signals on the thread of the queue. Extraction only uses the
+    * traces and block states of the signals, never the state of the chain, so it does not have to keep up with it.
+    */
+   template<typename F>
+   void dispatch(F&& f) {
+      if (!async_queue) {
+         emit_killer(f);
+         return;
+      }
+      async_queue->post([f = std::forward<F>(f)]() {
+         try {
+            f();
+         } catch (const yield_exception&) {
+            // the error was logged and the application asked to quit by the exception handler of the extraction
+         }
+      });
+   }
+
    std::shared_ptr<trace_api_common_impl> common;
 
    using chain_extraction_t = chain_extraction_impl_type<shared_store_provider<store_provider>>;
    std::shared_ptr<chain_extraction_t> extraction;
+   std::optional<chain::async_signal_queue>                    async_queue;
 
    std::optional<scoped_connection>                            applied_transaction_connection;
    std::optional<scoped_connection>                            block_start_connection;
@@ -80,6 +80,8 @@ namespace {
       opts("seek-point-stride,s", bpo::value<uint32_t>()->default_value(512),
            "the number of bytes between seek points in a compressed trace.  "
            "A smaller stride may degrade compression efficiency but increase read efficiency");
+      opts("threads,t", bpo::value<uint16_t>()->default_value(1),
+           "the number of threads compressing the data between seek points in parallel");
 
       if (global_args.count("help")) {
          print_help_text(std::cout, vis_desc);
@@ -106,8 +108,9 @@ namespace {
             auto input_path = validate_input_path(vmap);
             auto output_path = validate_output_path(vmap, input_path);
             auto seek_point_stride = vmap.at("seek-point-stride").as<uint32_t>();
+            auto threads = vmap.at("threads").as<uint16_t>();
 
-            if (!compressed_file::process(input_path, output_path, seek_point_stride)) {
+            if (!compressed_file::process(input_path, output_path, seek_point_stride, threads)) {
                throw std::runtime_error("Unexpected compression failure");
             }
          } else {
@@ -1,7 +1,9 @@
 #include <eosio/txn_test_gen_plugin/txn_test_gen_plugin.hpp>
 #include <eosio/chain_plugin/chain_plugin.hpp>
+#include <eosio/chain/asset.hpp>
 #include <eosio/chain/wast_to_wasm.hpp>
 #include <eosio/chain/thread_utils.hpp>
+#include <eosio/chain/signal_slots.hpp>
 
 #include <fc/variant.hpp>
 #include <fc/io/json.hpp>
@@ -11,6 +13,7 @@
 
 #include <boost/asio/high_resolution_timer.hpp>
 #include <boost/algorithm/clamp.hpp>
+#include <boost/signals2/connection.hpp>
 
 #include <Inline/BasicTypes.h>
 #include <IR/Module.h>
@@ -21,6 +24,13 @@
 
 #include <contracts.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+
 using namespace eosio::testing;
 
 namespace eosio { namespace detail {
@@ -28,10 +38,85 @@ namespace eosio { namespace detail {
   struct txn_test_gen_status {
      string status;
   };
+
+  /// what start_workload generates; the weights choose the contract of each action
+  struct workload_profile {
+     string   salt;
+     uint32_t rate = 1000;            ///< transactions per second offered, whether or not the node keeps up
+     uint32_t duration_s = 0;         ///< seconds to run, 0 until stop_generation
+     uint32_t actions_per_trx = 1;
+     uint32_t accounts = 0;           ///< workload accounts used, 0 for all of those create_workload_accounts created
+     double   skew = 0;               ///< zipf exponent of choosing accounts, 0 for uniform, around 1 for a few hot accounts
+     uint32_t transfer_weight = 1;    ///< eosio.token transfers between workload accounts
+     uint32_t noop_weight = 0;        ///< actions of the noop contract, the cost of a transaction without state
+     uint32_t kv_weight = 0;          ///< upserts of the account's row of the kv_addr_book contract
+     uint32_t kv_value_size = 64;     ///< bytes written in each upsert
+     uint32_t expiration_s = 30;
+  };
+
+  struct workload_stats {
+     bool     running = false;
+     double   seconds = 0;
+     uint64_t offered = 0;            ///< transactions generated on schedule
+     uint64_t lagged = 0;             ///< transactions skipped because generating them fell more than a second behind
+     uint64_t submitted = 0;          ///< transactions given to the chain_plugin
+     uint64_t accepted = 0;
+     uint64_t failed = 0;
+     uint64_t included = 0;           ///< transactions seen in an accepted block
+     uint64_t expired = 0;            ///< accepted transactions not included before they expired
+     uint64_t pending = 0;            ///< submitted transactions neither failed, included nor expired
+     double   offered_per_second = 0;
+     double   included_per_second = 0;
+     /// from the time a transaction was due to the block including it being accepted by this node
+     uint64_t inclusion_samples = 0;
+     double   inclusion_mean_ms = 0;
+     double   inclusion_p50_ms = 0;
+     double   inclusion_p90_ms = 0;
+     double   inclusion_p99_ms = 0;
+     double   inclusion_max_ms = 0;
+  };
+
+  // action data of the workload contracts
+  struct token_issue {
+     chain::name  to;
+     chain::asset quantity;
+     string       memo;
+  };
+  struct token_transfer {
+     chain::name  from;
+     chain::name  to;
+     chain::asset quantity;
+     string       memo;
+  };
+  struct noop_anyaction {
+     chain::name from;
+     string      type;
+     string      data;
+  };
+  struct kv_upsert {
+     chain::name account_name;
+     string      first_name;
+     string      last_name;
+     string      street;
+     string      city;
+     string      state;
+     string      country;
+     string      personal_id;
+  };
 }}
 
 FC_REFLECT(eosio::detail::txn_test_gen_empty, );
 FC_REFLECT(eosio::detail::txn_test_gen_status, (status));
+FC_REFLECT(eosio::detail::workload_profile, (salt)(rate)(duration_s)(actions_per_trx)(accounts)(skew)
+                                            (transfer_weight)(noop_weight)(kv_weight)(kv_value_size)(expiration_s));
+FC_REFLECT(eosio::detail::workload_stats, (running)(seconds)(offered)(lagged)(submitted)(accepted)(failed)(included)
+                                          (expired)(pending)(offered_per_second)(included_per_second)(inclusion_samples)
+                                          (inclusion_mean_ms)(inclusion_p50_ms)(inclusion_p90_ms)(inclusion_p99_ms)
+                                          (inclusion_max_ms));
+FC_REFLECT(eosio::detail::token_issue, (to)(quantity)(memo));
+FC_REFLECT(eosio::detail::token_transfer, (from)(to)(quantity)(memo));
+FC_REFLECT(eosio::detail::noop_anyaction, (from)(type)(data));
+FC_REFLECT(eosio::detail::kv_upsert, (account_name)(first_name)(last_name)(street)(city)(state)(country)(personal_id));
 
 namespace eosio {
 
@@ -56,6 +141,14 @@ using namespace eosio::chain;
      auto status = api_handle->call_name(vs.at(0).as<in_param0>(), vs.at(1).as<in_param1>(), vs.at(2).as<in_param2>()); \
      eosio::detail::txn_test_gen_status result = { status };
 
+#define INVOKE_V_R(api_handle, call_name, in_param0) \
+     const auto& vs = fc::json::json::from_string(body).as<fc::variants>(); \
+     auto status = api_handle->call_name(vs.at(0).as<in_param0>()); \
+     eosio::detail::txn_test_gen_status result = { status };
+
+#define INVOKE_R_V(api_handle, call_name) \
+     auto result = api_handle->call_name();
+
 #define INVOKE_V_R_R(api_handle, call_name, in_param0, in_param1) \
      const auto& vs = fc::json::json::from_string(body).as<fc::variants>(); \
      api_handle->call_name(vs.at(0).as<in_param0>(), vs.at(1).as<in_param1>()); \
@@ -91,6 +184,11 @@ using namespace eosio::chain;
    const auto& vs = fc::json::json::from_string(body).as<fc::variants>(); \
    api_handle->call_name(vs.at(0).as<in_param0>(), vs.at(1).as<in_param1>(), result_handler);
 
+#define INVOKE_ASYNC_R_R_R_R(api_handle, call_name, in_param0, in_param1, in_param2, in_param3) \
+   const auto& vs = fc::json::json::from_string(body).as<fc::variants>(); \
+   api_handle->call_name(vs.at(0).as<in_param0>(), vs.at(1).as<in_param1>(), vs.at(2).as<in_param2>(), \
+                         vs.at(3).as<in_param3>(), result_handler);
+
 struct txn_test_gen_plugin_impl {
 
    uint64_t _total_us = 0;
@@ -351,17 +449,7 @@ struct txn_test_gen_plugin_impl {
 
          static uint64_t nonce = static_cast<uint64_t>(fc::time_point::now().sec_since_epoch()) << 32;
 
-         uint32_t reference_block_num = cc.last_irreversible_block_num();
-         if (txn_reference_block_lag >= 0) {
-            reference_block_num = cc.head_block_num();
-            if (reference_block_num <= (uint32_t)txn_reference_block_lag) {
-               reference_block_num = 0;
-            } else {
-               reference_block_num -= (uint32_t)txn_reference_block_lag;
-            }
-         }
-
-         block_id_type reference_block_id = cc.get_block_id_for_num(reference_block_num);
+         block_id_type reference_block_id = get_reference_block_id(cc);
 
          for(unsigned int i = 0; i < batch; ++i) {
          {
@@ -399,6 +487,401 @@ struct txn_test_gen_plugin_impl {
       push_transactions(std::move(trxs), next);
    }
 
+   block_id_type get_reference_block_id(const controller& cc) const {
+      uint32_t reference_block_num = cc.last_irreversible_block_num();
+      if (txn_reference_block_lag >= 0) {
+         reference_block_num = cc.head_block_num();
+         if (reference_block_num <= (uint32_t)txn_reference_block_lag) {
+            reference_block_num = 0;
+         } else {
+            reference_block_num -= (uint32_t)txn_reference_block_lag;
+         }
+      }
+      return cc.get_block_id_for_num(reference_block_num);
+   }
+
+   static const fc::crypto::private_key& workload_priv_key() {
+      static const fc::crypto::private_key key = fc::crypto::private_key::regenerate(fc::sha256(std::string(64, 'd')));
+      return key;
+   }
+
+   /// the workload accounts are the prefix followed by three characters
+   name workload_account(uint32_t i) const {
+      static constexpr char chars[] = "abcdefghijklmnopqrstuvwxyz12345";
+      constexpr uint32_t base = sizeof(chars) - 1;
+      std::string n = account_prefix;
+      n += chars[i / (base * base) % base];
+      n += chars[i / base % base];
+      n += chars[i % base];
+      return name(n);
+   }
+
+   void create_workload_accounts(const std::string& init_name, const std::string& init_priv_key, const uint32_t& count,
+                                 const bool& with_kv, const std::function<void(const fc::exception_ptr&)>& next) {
+      ilog("create_workload_accounts");
+      std::vector<signed_transaction> trxs;
+
+      try {
+         EOS_ASSERT( account_prefix.size() + 3 <= 12, chain::plugin_exception,
+                     "txn-test-gen-account-prefix ${p} leaves no room for workload account names", ("p", account_prefix) );
+         EOS_ASSERT( count >= 2 && count <= max_workload_accounts, chain::plugin_exception,
+                     "count must be between 2 and ${m}", ("m", max_workload_accounts) );
+
+         name creator(init_name);
+         controller& cc = app().get_plugin<chain_plugin>().chain();
+         auto chainid = app().get_plugin<chain_plugin>().get_chain_id();
+
+         fc::crypto::private_key creator_priv_key = fc::crypto::private_key(init_priv_key);
+         fc::crypto::private_key txn_test_receiver_C_priv_key = fc::crypto::private_key::regenerate(fc::sha256(std::string(64, 'c')));
+         const fc::crypto::public_key workload_pub_key = workload_priv_key().get_public_key();
+         const symbol cur(4, "CUR");
+
+         auto add_transaction = [&](signed_transaction& trx, const fc::crypto::private_key& key) {
+            trx.expiration = cc.head_block_time() + fc::seconds(180);
+            trx.set_reference_block(cc.head_block_id());
+            trx.sign(key, chainid);
+            trxs.emplace_back(std::move(trx));
+         };
+         auto add_newaccount = [&](signed_transaction& trx, name n) {
+            auto auth = eosio::chain::authority{1, {{workload_pub_key, 1}}, {}};
+            trx.actions.emplace_back(vector<chain::permission_level>{{creator,name("active")}}, newaccount{creator, n, auth, auth});
+         };
+         auto add_contract = [&](signed_transaction& trx, name n, const vector<uint8_t>& wasm, const std::vector<char>& abi) {
+            setcode code_handler;
+            code_handler.account = n;
+            code_handler.code.assign(wasm.begin(), wasm.end());
+            trx.actions.emplace_back( vector<chain::permission_level>{{n,name("active")}}, code_handler);
+
+            setabi abi_handler;
+            abi_handler.account = n;
+            abi_handler.abi = fc::raw::pack(json::from_string(abi.data()).as<abi_def>());
+            trx.actions.emplace_back( vector<chain::permission_level>{{n,name("active")}}, abi_handler);
+         };
+
+         //create the contract accounts and the workload accounts, which all share one key
+         {
+            signed_transaction trx;
+            add_newaccount(trx, newaccountN);
+            if (with_kv)
+               add_newaccount(trx, newaccountK);
+            add_transaction(trx, creator_priv_key);
+         }
+         for (uint32_t i = 0; i < count; i += workload_actions_per_setup_trx) {
+            signed_transaction trx;
+            for (uint32_t j = i; j < std::min(count, i + workload_actions_per_setup_trx); ++j)
+               add_newaccount(trx, workload_account(j));
+            add_transaction(trx, creator_priv_key);
+         }
+
+         //fund the workload accounts from the token of newaccountT, see create_test_accounts
+         {
+            signed_transaction trx;
+            trx.actions.emplace_back(vector<permission_level>{{newaccountT,config::active_name}}, newaccountT, "issue"_n,
+                                     fc::raw::pack(eosio::detail::token_issue{newaccountT, asset(int64_t(count) * 1000'0000, cur), ""}));
+            add_transaction(trx, txn_test_receiver_C_priv_key);
+         }
+         for (uint32_t i = 0; i < count; i += workload_actions_per_setup_trx) {
+            signed_transaction trx;
+            for (uint32_t j = i; j < std::min(count, i + workload_actions_per_setup_trx); ++j) {
+               trx.actions.emplace_back(vector<permission_level>{{newaccountT,config::active_name}}, newaccountT, "transfer"_n,
+                                        fc::raw::pack(eosio::detail::token_transfer{newaccountT, workload_account(j), asset(1000'0000, cur), ""}));
+            }
+            add_transaction(trx, txn_test_receiver_C_priv_key);
+         }
+
+         //set the contracts of the other actions of the workload
+         {
+            signed_transaction trx;
+            add_contract(trx, newaccountN, contracts::noop_wasm(), contracts::noop_abi());
+            add_transaction(trx, workload_priv_key());
+         }
+         if (with_kv) {
+            signed_transaction trx;
+            add_contract(trx, newaccountK, contracts::kv_addr_book_wasm(), contracts::kv_addr_book_abi());
+            add_transaction(trx, workload_priv_key());
+         }
+         workload_accounts_created = count;
+      } catch ( const std::bad_alloc& ) {
+        throw;
+      } catch ( const boost::interprocess::bad_alloc& ) {
+        throw;
+      } catch (const fc::exception& e) {
+         next(e.dynamic_copy_exception());
+         return;
+      } catch (const std::exception& e) {
+         next(fc::std_exception_wrapper::from_current_exception(e).dynamic_copy_exception());
+         return;
+      }
+
+      push_transactions(std::move(trxs), next);
+   }
+
+   string start_workload(const eosio::detail::workload_profile& profile) {
+      ilog("Starting transaction test workload");
+      if(running)
+         return "start_generation already running";
+      const uint32_t accounts = profile.accounts ? profile.accounts : workload_accounts_created;
+      if(accounts < 2 || accounts > max_workload_accounts)
+         return "accounts must be between 2 and " + std::to_string(max_workload_accounts) + ", call create_workload_accounts first";
+      if(profile.rate < 1 || profile.rate > 100'000)
+         return "rate must be between 1 and 100000";
+      if(profile.actions_per_trx < 1 || profile.actions_per_trx > 50)
+         return "actions_per_trx must be between 1 and 50";
+      if(profile.skew < 0 || profile.skew > 5)
+         return "skew must be between 0 and 5";
+      if(uint64_t(profile.transfer_weight) + profile.noop_weight + profile.kv_weight == 0)
+         return "at least one of transfer_weight, noop_weight and kv_weight must be greater than 0";
+      if(profile.kv_value_size > 4096)
+         return "kv_value_size must be at most 4096";
+      if(profile.expiration_s < 1 || profile.expiration_s > 3600)
+         return "expiration_s must be between 1 and 3600";
+
+      // zipf: account i is chosen with a weight of 1 / (i+1)^skew
+      workload_cdf.resize(accounts);
+      double total = 0;
+      for (uint32_t i = 0; i < accounts; ++i)
+         workload_cdf[i] = total += 1 / std::pow(double(i + 1), profile.skew);
+      for (auto& c : workload_cdf)
+         c /= total;
+
+      running = true;
+      workload = profile;
+      workload->accounts = accounts;
+      workload_offered = 0;
+      workload_lagged = 0;
+      workload_end_time = fc::time_point();
+      {
+         std::lock_guard<std::mutex> g(workload_mtx);
+         workload_pending.clear();
+         workload_submitted = workload_accepted = workload_failed = workload_included = workload_expired = 0;
+         workload_latency_count = 0;
+         workload_latency_us.clear();
+         workload_last_expire_check = fc::time_point::now();
+      }
+
+      controller& cc = app().get_plugin<chain_plugin>().chain();
+      accepted_block_connection.emplace(cc.accepted_block.connect( timed_slot( "txn_test_gen.accepted_block",
+            [this]( const block_state_ptr& bsp ) {
+         on_workload_block( bsp );
+      } ) ));
+
+      thread_pool.emplace( "txntest", thread_pool_size );
+      timer = std::make_shared<boost::asio::high_resolution_timer>(thread_pool->get_executor());
+      workload_start = boost::asio::high_resolution_timer::clock_type::now();
+      workload_start_time = fc::time_point::now();
+
+      ilog("Started transaction test workload; offering ${r} transactions per second of ${a} actions over ${n} accounts by ${t} load generation threads",
+           ("r", profile.rate)("a", profile.actions_per_trx)("n", accounts)("t", thread_pool_size));
+
+      boost::asio::post( thread_pool->get_executor(), [this, s = workload_start]() {
+         arm_workload_timer(s);
+      });
+      return "success";
+   }
+
+   // open loop: the transactions due by now are generated whatever happened to the previous ones
+   void arm_workload_timer(boost::asio::high_resolution_timer::time_point s) {
+      timer->expires_at(s + workload_tick);
+      boost::asio::post( thread_pool->get_executor(), [this]() {
+         generate_workload();
+      });
+      timer->async_wait([this](const boost::system::error_code& ec) {
+         if(!running || ec)
+            return;
+         arm_workload_timer(timer->expires_at());
+      });
+   }
+
+   void generate_workload() {
+      std::unique_lock<std::mutex> g(workload_generate_mtx);
+      const double elapsed = std::chrono::duration<double>(boost::asio::high_resolution_timer::clock_type::now() - workload_start).count();
+      if (workload->duration_s && elapsed >= workload->duration_s) {
+         app().post(priority::low, [this]() {
+            if (running && workload)
+               stop_generation();
+         });
+         return;
+      }
+      uint64_t due = uint64_t(elapsed * workload->rate) - workload_offered - workload_lagged;
+      if (due > workload->rate) {
+         // more than a second behind, generating the backlog would only burst
+         workload_lagged += due - workload->rate;
+         due = workload->rate;
+      }
+      workload_offered += due;
+      g.unlock();
+
+      const fc::time_point due_time = fc::time_point::now();
+      for (uint64_t i = 0; i < due; i += workload_trxs_per_task) {
+         const uint32_t n = std::min<uint64_t>(workload_trxs_per_task, due - i);
+         boost::asio::post( thread_pool->get_executor(), [this, n, due_time]() {
+            generate_workload_transactions(n, due_time);
+         });
+      }
+   }
+
+   uint32_t pick_workload_account(std::mt19937_64& rng) const {
+      const double u = std::uniform_real_distribution<double>(0, 1)(rng);
+      const auto itr = std::lower_bound(workload_cdf.begin(), workload_cdf.end(), u);
+      return std::min<uint32_t>(itr - workload_cdf.begin(), workload_cdf.size() - 1);
+   }
+
+   action make_workload_action(std::mt19937_64& rng) const {
+      const auto& p = *workload;
+      const uint32_t from_index = pick_workload_account(rng);
+      const name from = workload_account(from_index);
+      const vector<permission_level> auth{{from, config::active_name}};
+
+      uint64_t pick = std::uniform_int_distribution<uint64_t>(0, uint64_t(p.transfer_weight) + p.noop_weight + p.kv_weight - 1)(rng);
+      if (pick < p.transfer_weight) {
+         uint32_t to_index = pick_workload_account(rng);
+         if (to_index == from_index)
+            to_index = (to_index + 1) % p.accounts;
+         return action(auth, newaccountT, "transfer"_n,
+                       fc::raw::pack(eosio::detail::token_transfer{from, workload_account(to_index), asset(1, symbol(4, "CUR")), p.salt}));
+      }
+      pick -= p.transfer_weight;
+      if (pick < p.noop_weight)
+         return action(auth, newaccountN, "anyaction"_n, fc::raw::pack(eosio::detail::noop_anyaction{from, "workload", p.salt}));
+
+      // the row of the account is rewritten, so hot accounts are hot keys
+      std::string street(p.kv_value_size, 'a');
+      for (auto& c : street)
+         c = 'a' + rng() % 26;
+      return action(auth, newaccountK, "upsert"_n,
+                    fc::raw::pack(eosio::detail::kv_upsert{from, "first", "last", std::move(street), "city", "state", "country", from.to_string()}));
+   }
+
+   void generate_workload_transactions(uint32_t n, fc::time_point due_time) {
+      std::vector<signed_transaction> trxs;
+      trxs.reserve(n);
+      try {
+         static thread_local std::mt19937_64 rng(std::random_device{}());
+         controller& cc = app().get_plugin<chain_plugin>().chain();
+         auto chainid = app().get_plugin<chain_plugin>().get_chain_id();
+         const block_id_type reference_block_id = get_reference_block_id(cc);
+         const auto expiration = cc.head_block_time() + fc::seconds(workload->expiration_s);
+
+         for (uint32_t i = 0; i < n; ++i) {
+            signed_transaction trx;
+            for (uint32_t a = 0; a < workload->actions_per_trx; ++a)
+               trx.actions.push_back(make_workload_action(rng));
+            trx.context_free_actions.emplace_back(action({}, config::null_account_name, name("nonce"),
+                                                         fc::raw::pack( workload->salt + std::to_string(workload_nonce++) )));
+            trx.set_reference_block(reference_block_id);
+            trx.expiration = expiration;
+            trx.sign(workload_priv_key(), chainid);
+            trxs.emplace_back(std::move(trx));
+         }
+      } catch ( const std::bad_alloc& ) {
+        throw;
+      } catch ( const boost::interprocess::bad_alloc& ) {
+        throw;
+      } catch ( const fc::exception& e ) {
+         elog("generating workload transactions failed: ${e}", ("e", e.to_detail_string()));
+      } catch (const std::exception& e) {
+         elog("generating workload transactions failed: ${e}", ("e", e.what()));
+      }
+
+      app().post(priority::low, [this, trxs = std::make_shared<std::vector<signed_transaction>>(std::move(trxs)), due_time]() {
+         chain_plugin& cp = app().get_plugin<chain_plugin>();
+         for (auto& trx : *trxs) {
+            auto ptrx = std::make_shared<packed_transaction>(std::move(trx), true);
+            const transaction_id_type id = ptrx->id();
+            {
+               std::lock_guard<std::mutex> g(workload_mtx);
+               workload_pending.emplace(id, due_time);
+               ++workload_submitted;
+            }
+            cp.accept_transaction( ptrx, [this, id](const std::variant<fc::exception_ptr, transaction_trace_ptr>& result) {
+               std::lock_guard<std::mutex> g(workload_mtx);
+               if (std::holds_alternative<fc::exception_ptr>(result) || std::get<transaction_trace_ptr>(result)->except) {
+                  ++workload_failed;
+                  workload_pending.erase(id);
+               } else {
+                  ++workload_accepted;
+               }
+            });
+         }
+      });
+   }
+
+   void on_workload_block(const block_state_ptr& bsp) {
+      const auto now = fc::time_point::now();
+      std::lock_guard<std::mutex> g(workload_mtx);
+      for (const auto& receipt : bsp->block->transactions) {
+         if (!std::holds_alternative<packed_transaction>(receipt.trx))
+            continue;
+         auto itr = workload_pending.find(std::get<packed_transaction>(receipt.trx).id());
+         if (itr == workload_pending.end())
+            continue;
+         ++workload_included;
+         record_inclusion_latency((now - itr->second).count());
+         workload_pending.erase(itr);
+      }
+
+      if (workload && now - workload_last_expire_check > fc::seconds(1)) {
+         workload_last_expire_check = now;
+         // the due time is before the expiration was set, so this leaves a margin
+         const auto expired_before = now - fc::seconds(workload->expiration_s + 1);
+         for (auto itr = workload_pending.begin(); itr != workload_pending.end();) {
+            if (itr->second < expired_before) {
+               ++workload_expired;
+               itr = workload_pending.erase(itr);
+            } else {
+               ++itr;
+            }
+         }
+      }
+   }
+
+   // keeps a uniform sample of the latencies, see reservoir sampling
+   void record_inclusion_latency(int64_t us) {
+      ++workload_latency_count;
+      if (workload_latency_us.size() < max_workload_latency_samples) {
+         workload_latency_us.push_back(us);
+      } else {
+         const uint64_t i = workload_latency_rng() % workload_latency_count;
+         if (i < max_workload_latency_samples)
+            workload_latency_us[i] = us;
+      }
+   }
+
+   eosio::detail::workload_stats get_workload_stats() {
+      eosio::detail::workload_stats s;
+      s.running = running && workload.has_value();
+      s.offered = workload_offered;
+      s.lagged  = workload_lagged;
+      if (workload_start_time != fc::time_point())
+         s.seconds = ((workload_end_time != fc::time_point() ? workload_end_time : fc::time_point::now()) - workload_start_time).count() / 1e6;
+      std::vector<int64_t> latencies;
+      {
+         std::lock_guard<std::mutex> g(workload_mtx);
+         s.submitted = workload_submitted;
+         s.accepted  = workload_accepted;
+         s.failed    = workload_failed;
+         s.included  = workload_included;
+         s.expired   = workload_expired;
+         s.pending   = workload_pending.size();
+         s.inclusion_samples = workload_latency_count;
+         latencies = workload_latency_us;
+      }
+      if (s.seconds > 0) {
+         s.offered_per_second  = s.offered / s.seconds;
+         s.included_per_second = s.included / s.seconds;
+      }
+      if (!latencies.empty()) {
+         std::sort(latencies.begin(), latencies.end());
+         auto quantile = [&](double q) { return latencies[std::min<size_t>(latencies.size() - 1, q * latencies.size())] / 1000.0; };
+         s.inclusion_mean_ms = std::accumulate(latencies.begin(), latencies.end(), 0.0) / latencies.size() / 1000.0;
+         s.inclusion_p50_ms  = quantile(0.5);
+         s.inclusion_p90_ms  = quantile(0.9);
+         s.inclusion_p99_ms  = quantile(0.99);
+         s.inclusion_max_ms  = latencies.back() / 1000.0;
+      }
+      return s;
+   }
+
    void stop_generation() {
       if(!running)
          throw fc::exception(fc::invalid_operation_exception_code);
@@ -413,6 +896,17 @@ struct txn_test_gen_plugin_impl {
          ilog("${d} transactions executed, ${t}us / transaction", ("d", _txcount)("t", _total_us / (double)_txcount));
          _txcount = _total_us = 0;
       }
+
+      if (workload) {
+         // transactions still pending are no longer followed into blocks
+         accepted_block_connection.reset();
+         workload_end_time = fc::time_point::now();
+         workload.reset();
+         const auto s = get_workload_stats();
+         ilog("Workload offered ${o} transactions, ${i} included, ${f} failed, ${e} expired, ${l} lagged; inclusion p50 ${p50}ms p99 ${p99}ms",
+              ("o", s.offered)("i", s.included)("f", s.failed)("e", s.expired)("l", s.lagged)
+              ("p50", s.inclusion_p50_ms)("p99", s.inclusion_p99_ms));
+      }
    }
 
    bool running{false};
@@ -425,6 +919,41 @@ struct txn_test_gen_plugin_impl {
    action act_b_to_a;
 
    int32_t txn_reference_block_lag;
+
+   static constexpr uint32_t max_workload_accounts = 31 * 31 * 31;
+   static constexpr uint32_t workload_actions_per_setup_trx = 50;
+   static constexpr uint32_t workload_trxs_per_task = 64;
+   static constexpr size_t   max_workload_latency_samples = 1'000'000;
+   static constexpr auto     workload_tick = std::chrono::milliseconds(10);
+
+   std::string                                             account_prefix;
+   name                                                    newaccountN; ///< noop contract of the workload
+   name                                                    newaccountK; ///< kv_addr_book contract of the workload
+   uint32_t                                                workload_accounts_created = 0;
+
+   // state of start_workload, read by the load generation threads while running
+   std::optional<eosio::detail::workload_profile>          workload;
+   std::vector<double>                                     workload_cdf; ///< cumulative probability of choosing each account
+   boost::asio::high_resolution_timer::time_point          workload_start;
+   fc::time_point                                          workload_start_time;
+   fc::time_point                                          workload_end_time;
+   std::mutex                                              workload_generate_mtx;
+   std::atomic<uint64_t>                                   workload_offered{0};
+   std::atomic<uint64_t>                                   workload_lagged{0};
+   std::atomic<uint64_t>                                   workload_nonce{static_cast<uint64_t>(fc::time_point::now().sec_since_epoch()) << 32};
+   std::optional<boost::signals2::scoped_connection>       accepted_block_connection;
+
+   std::mutex                                              workload_mtx; ///< guards the following
+   std::unordered_map<transaction_id_type, fc::time_point> workload_pending; ///< submitted transactions by the time they were due
+   uint64_t                                                workload_submitted = 0;
+   uint64_t                                                workload_accepted = 0;
+   uint64_t                                                workload_failed = 0;
+   uint64_t                                                workload_included = 0;
+   uint64_t                                                workload_expired = 0;
+   uint64_t                                                workload_latency_count = 0;
+   std::vector<int64_t>                                    workload_latency_us;
+   std::mt19937_64                                         workload_latency_rng;
+   fc::time_point                                          workload_last_expire_check;
 };
 
 txn_test_gen_plugin::txn_test_gen_plugin() {}
@@ -447,6 +976,9 @@ void txn_test_gen_plugin::plugin_initialize(const variables_map& options) {
       my->newaccountA = eosio::chain::name(thread_pool_account_prefix + "a");
       my->newaccountB = eosio::chain::name(thread_pool_account_prefix + "b");
       my->newaccountT = eosio::chain::name(thread_pool_account_prefix + "t");
+      my->newaccountN = eosio::chain::name(thread_pool_account_prefix + "n");
+      my->newaccountK = eosio::chain::name(thread_pool_account_prefix + "k");
+      my->account_prefix = thread_pool_account_prefix;
       EOS_ASSERT( my->thread_pool_size > 0, chain::plugin_config_exception,
                   "txn-test-gen-threads ${num} must be greater than 0", ("num", my->thread_pool_size) );
    } FC_LOG_AND_RETHROW()
@@ -456,7 +988,10 @@ void txn_test_gen_plugin::plugin_startup() {
    app().get_plugin<http_plugin>().add_api({
       CALL_ASYNC(txn_test_gen, my, create_test_accounts, INVOKE_ASYNC_R_R(my, create_test_accounts, std::string, std::string), 200),
       CALL(txn_test_gen, my, stop_generation, INVOKE_V_V(my, stop_generation), 200),
-      CALL(txn_test_gen, my, start_generation, INVOKE_V_R_R_R(my, start_generation, std::string, uint64_t, uint64_t), 200)
+      CALL(txn_test_gen, my, start_generation, INVOKE_V_R_R_R(my, start_generation, std::string, uint64_t, uint64_t), 200),
+      CALL_ASYNC(txn_test_gen, my, create_workload_accounts, INVOKE_ASYNC_R_R_R_R(my, create_workload_accounts, std::string, std::string, uint32_t, bool), 200),
+      CALL(txn_test_gen, my, start_workload, INVOKE_V_R(my, start_workload, eosio::detail::workload_profile), 200),
+      CALL(txn_test_gen, my, get_workload_stats, INVOKE_R_V(my, get_workload_stats), 200)
    });
 }
 
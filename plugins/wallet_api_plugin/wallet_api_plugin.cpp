@@ -91,6 +91,8 @@ void wallet_api_plugin::plugin_startup() {
        //  chain::chain_id_type has an inaccessible default constructor
        CALL_WITH_400(wallet, wallet_mgr, sign_transaction,
             INVOKE_R_R_R_R(wallet_mgr, sign_transaction, chain::signed_transaction, chain::flat_set<public_key_type>, chain::chain_id_type), 201),
+       CALL_WITH_400(wallet, wallet_mgr, sign_transactions,
+            INVOKE_R_R_R_R(wallet_mgr, sign_transactions, std::vector<chain::signed_transaction>, std::vector<chain::flat_set<public_key_type>>, chain::chain_id_type), 201),
        CALL_WITH_400(wallet, wallet_mgr, sign_digest,
             INVOKE_R_R_R(wallet_mgr, sign_digest, chain::digest_type, public_key_type), 201),
        CALL_WITH_400(wallet, wallet_mgr, create,
@@ -178,6 +178,7 @@ class soft_wallet final : public wallet_api
       /* Attempts to sign a digest via the given public_key
       */
       std::optional<signature_type> try_sign_digest( const digest_type digest, const public_key_type public_key ) override;
+      bool supports_concurrent_signing() const override { return true; }
 
       std::shared_ptr<detail::soft_wallet_impl> my;
       void encrypt_keys();
@@ -1,4 +1,5 @@
 #pragma once
+#include <eosio/chain/thread_utils.hpp>
 #include <eosio/chain/transaction.hpp>
 #include <eosio/wallet_plugin/wallet_api.hpp>
 #include <boost/asio/deadline_timer.hpp>
@@ -39,6 +40,10 @@ public:
    /// @see wallet_manager::set_timeout(const std::chrono::seconds& t)
    /// @param secs The timeout in seconds.
    void set_timeout(int64_t secs) { set_timeout(std::chrono::seconds(secs)); }
+
+   /// Set the number of threads signing with the keys of wallets which support concurrent signing.
+   /// @param num_threads 0 to sign on the calling thread.
+   void set_signing_threads(uint16_t num_threads);
       
    /// Sign transaction with the private keys specified via their public keys.
    /// Use chain_controller::get_required_keys to determine which keys are needed for txn.
@@ -50,6 +55,17 @@ public:
    chain::signed_transaction sign_transaction(const chain::signed_transaction& txn, const flat_set<public_key_type>& keys,
                                              const chain::chain_id_type& id);
 
+   /// Sign several transactions, each with the private keys specified via its public keys, see sign_transaction.
+   /// The signatures of all the transactions are computed concurrently on the signing threads.
+   /// @param txns the transactions to sign.
+   /// @param keys for each transaction, the public keys of the corresponding private keys to sign it with
+   /// @param id the chain_id to sign transactions with.
+   /// @return txns signed, in the same order
+   /// @throws fc::exception if corresponding private keys not found in unlocked wallets, no transaction is signed then
+   std::vector<chain::signed_transaction> sign_transactions(const std::vector<chain::signed_transaction>& txns,
+                                                            const std::vector<flat_set<public_key_type>>& keys,
+                                                            const chain::chain_id_type& id);
+
 
    /// Sign digest with the private keys specified via their public keys.
    /// @param digest the digest to sign.
@@ -130,6 +146,13 @@ private:
    /// Calls lock_all() if timeout has passed.
    void check_timeout();
 
+   /// @return the unlocked wallet holding key, nullptr if none
+   wallet_api* find_wallet(const public_key_type& key);
+
+   /// Add the signatures of keys to each of txns.
+   void sign(std::vector<chain::signed_transaction>& txns, const std::vector<flat_set<public_key_type>>& keys,
+             const chain::chain_id_type& id);
+
 private:
    using timepoint_t = std::chrono::time_point<std::chrono::system_clock>;
    std::map<std::string, std::unique_ptr<wallet_api>> wallets;
@@ -138,6 +161,10 @@ private:
    boost::filesystem::path dir = ".";
    boost::filesystem::path lock_path = dir / "wallet.lock";
    std::unique_ptr<boost::interprocess::file_lock> wallet_dir_lock;
+   /// owning wallet of each public key of the unlocked wallets, rebuilt on the next signature after wallets or keys change
+   std::map<public_key_type, wallet_api*> key_index;
+   bool key_index_valid = false;
+   std::optional<eosio::chain::named_thread_pool> signing_thread_pool;
 
    void start_lock_watch(std::shared_ptr<boost::asio::deadline_timer> t);
    void initialize_lock();
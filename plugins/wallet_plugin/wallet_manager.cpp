@@ -44,6 +44,12 @@ void wallet_manager::set_timeout(const std::chrono::seconds& t) {
              ("t", t.count())("now", now.time_since_epoch().count())("timeout_time", timeout_time.time_since_epoch().count()));
 }
 
+void wallet_manager::set_signing_threads(uint16_t num_threads) {
+   signing_thread_pool.reset();
+   if (num_threads > 0)
+      signing_thread_pool.emplace("sign", num_threads);
+}
+
 void wallet_manager::check_timeout() {
    if (timeout_time != timepoint_t::max()) {
       const auto& now = std::chrono::system_clock::now();
@@ -84,6 +90,7 @@ std::string wallet_manager::create(const std::string& name) {
       wallets.erase(it);
    }
    wallets.emplace(name, std::move(wallet));
+   key_index_valid = false;
 
    return password;
 }
@@ -108,6 +115,7 @@ void wallet_manager::open(const std::string& name) {
       wallets.erase(it);
    }
    wallets.emplace(name, std::move(wallet));
+   key_index_valid = false;
 }
 
 std::vector<std::string> wallet_manager::list_wallets() {
@@ -153,6 +161,7 @@ flat_set<public_key_type> wallet_manager::get_public_keys() {
 
 void wallet_manager::lock_all() {
    // no call to check_timeout since we are locking all anyway
+   key_index_valid = false;
    for (auto& i : wallets) {
       if (!i.second->is_locked()) {
          i.second->lock();
@@ -169,6 +178,7 @@ void wallet_manager::lock(const std::string& name) {
    if (w->is_locked()) {
       return;
    }
+   key_index_valid = false;
    w->lock();
 }
 
@@ -182,6 +192,7 @@ void wallet_manager::unlock(const std::string& name, const std::string& password
       EOS_THROW(chain::wallet_unlocked_exception, "Wallet is already unlocked: ${w}", ("w", name));
       return;
    }
+   key_index_valid = false;
    w->unlock(password);
 }
 
@@ -194,6 +205,7 @@ void wallet_manager::import_key(const std::string& name, const std::string& wif_
    if (w->is_locked()) {
       EOS_THROW(chain::wallet_locked_exception, "Wallet is locked: ${w}", ("w", name));
    }
+   key_index_valid = false;
    w->import_key(wif_key);
 }
 
@@ -207,6 +219,7 @@ void wallet_manager::remove_key(const std::string& name, const std::string& pass
       EOS_THROW(chain::wallet_locked_exception, "Wallet is locked: ${w}", ("w", name));
    }
    w->check_password(password); //throws if bad password
+   key_index_valid = false;
    w->remove_key(key);
 }
 
@@ -220,33 +233,95 @@ string wallet_manager::create_key(const std::string& name, const std::string& ke
       EOS_THROW(chain::wallet_locked_exception, "Wallet is locked: ${w}", ("w", name));
    }
 
+   key_index_valid = false;
    string upper_key_type = boost::to_upper_copy<std::string>(key_type);
    return w->create_key(upper_key_type);
 }
 
-chain::signed_transaction
-wallet_manager::sign_transaction(const chain::signed_transaction& txn, const flat_set<public_key_type>& keys, const chain::chain_id_type& id) {
-   check_timeout();
-   chain::signed_transaction stxn(txn);
-
-   for (const auto& pk : keys) {
-      bool found = false;
+wallet_api* wallet_manager::find_wallet(const public_key_type& key) {
+   if (!key_index_valid) {
+      key_index.clear();
       for (const auto& i : wallets) {
          if (!i.second->is_locked()) {
-            std::optional<signature_type> sig = i.second->try_sign_digest(stxn.sig_digest(id, stxn.context_free_data), pk);
-            if (sig) {
-               stxn.signatures.push_back(*sig);
-               found = true;
-               break; // inner for
-            }
+            for (const auto& k : i.second->list_public_keys())
+               key_index.emplace(k, i.second.get()); // first wallet in name order holding the key signs, as before the index
+         }
+      }
+      key_index_valid = true;
+   }
+   auto it = key_index.find(key);
+   return it == key_index.end() ? nullptr : it->second;
+}
+
+void wallet_manager::sign(std::vector<chain::signed_transaction>& txns, const std::vector<flat_set<public_key_type>>& keys,
+                          const chain::chain_id_type& id) {
+   struct signature_job {
+      size_t            trx = 0;
+      digest_type       digest;
+      public_key_type   key;
+      wallet_api*       wallet = nullptr;
+      std::optional<signature_type>                sig;
+      std::future<std::optional<signature_type>>   result;
+   };
+
+   // find all the keys before signing so that nothing is signed if one is missing
+   std::vector<signature_job> jobs;
+   for (size_t t = 0; t < txns.size(); ++t) {
+      const auto digest = txns[t].sig_digest(id, txns[t].context_free_data);
+      for (const auto& pk : keys[t]) {
+         auto* w = find_wallet(pk);
+         if (!w) {
+            EOS_THROW(chain::wallet_missing_pub_key_exception, "Public key not found in unlocked wallets ${k}", ("k", pk));
          }
+         jobs.push_back({t, digest, pk, w});
+      }
+   }
+
+   // a single signature is not worth the hand-off to the signing threads
+   const bool concurrent = signing_thread_pool && jobs.size() > 1;
+   for (auto& j : jobs) {
+      if (concurrent && j.wallet->supports_concurrent_signing()) {
+         j.result = eosio::chain::async_thread_pool(signing_thread_pool->get_executor(), [w = j.wallet, digest = j.digest, key = j.key]() {
+            return w->try_sign_digest(digest, key);
+         });
+      } else {
+         j.sig = j.wallet->try_sign_digest(j.digest, j.key);
       }
-      if (!found) {
-         EOS_THROW(chain::wallet_missing_pub_key_exception, "Public key not found in unlocked wallets ${k}", ("k", pk));
+   }
+
+   // the wallets are used by the signing threads until all their signatures are done
+   for (auto& j : jobs) {
+      if (j.result.valid())
+         j.result.wait();
+   }
+   for (auto& j : jobs) {
+      if (j.result.valid())
+         j.sig = j.result.get();
+      if (!j.sig) {
+         EOS_THROW(chain::wallet_missing_pub_key_exception, "Public key not found in unlocked wallets ${k}", ("k", j.key));
       }
    }
+   for (auto& j : jobs)
+      txns[j.trx].signatures.push_back(*j.sig);
+}
+
+chain::signed_transaction
+wallet_manager::sign_transaction(const chain::signed_transaction& txn, const flat_set<public_key_type>& keys, const chain::chain_id_type& id) {
+   check_timeout();
+   std::vector<chain::signed_transaction> stxns{txn};
+   sign(stxns, {keys}, id);
+   return std::move(stxns.front());
+}
 
-   return stxn;
+std::vector<chain::signed_transaction>
+wallet_manager::sign_transactions(const std::vector<chain::signed_transaction>& txns, const std::vector<flat_set<public_key_type>>& keys,
+                                  const chain::chain_id_type& id) {
+   check_timeout();
+   EOS_ASSERT(txns.size() == keys.size(), wallet_exception, "${t} transactions to sign with ${k} sets of public keys",
+              ("t", txns.size())("k", keys.size()));
+   std::vector<chain::signed_transaction> stxns(txns);
+   sign(stxns, keys, id);
+   return stxns;
 }
 
 chain::signature_type
@@ -254,12 +329,10 @@ wallet_manager::sign_digest(const chain::digest_type& digest, const public_key_t
    check_timeout();
 
    try {
-      for (const auto& i : wallets) {
-         if (!i.second->is_locked()) {
-            std::optional<signature_type> sig = i.second->try_sign_digest(digest, key);
-            if (sig)
-               return *sig;
-         }
+      if (auto* w = find_wallet(key)) {
+         std::optional<signature_type> sig = w->try_sign_digest(digest, key);
+         if (sig)
+            return *sig;
       }
    } FC_LOG_AND_RETHROW();
 
@@ -270,6 +343,7 @@ void wallet_manager::own_and_use_wallet(const string& name, std::unique_ptr<wall
    if(wallets.find(name) != wallets.end())
       EOS_THROW(wallet_exception, "Tried to use wallet name that already exists.");
    wallets.emplace(name, std::move(wallet));
+   key_index_valid = false;
 }
 
 void wallet_manager::start_lock_watch(std::shared_ptr<boost::asio::deadline_timer> t)
@@ -10,7 +10,9 @@
 
 #include <iostream>
 #include <istream>
+#include <map>
 #include <ostream>
+#include <sstream>
 #include <string>
 #include <regex>
 #include <boost/algorithm/string.hpp>
@@ -30,9 +32,24 @@ using namespace eosio::chain;
 namespace eosio { namespace client { namespace http {
 
    namespace detail {
+      /// a connected socket which requests are sent over
+      class http_connection {
+         public:
+            virtual ~http_connection() = default;
+            virtual std::string txrx(const std::string& request, unsigned int& status_code, bool& server_closes) = 0;
+      };
+
       class http_context_impl {
          public:
             boost::asio::io_service ios;
+            bool keep_alive = false;
+            /// open connections by scheme, server, port and certificate verification, when keep_alive
+            std::map<std::string, std::unique_ptr<http_connection>> connections;
+
+            ~http_context_impl() {
+               // the sockets use ios
+               connections.clear();
+            }
       };
 
       void http_context_deleter::operator()(http_context_impl* p) const {
@@ -44,6 +61,12 @@ namespace eosio { namespace client { namespace http {
       return http_context(new detail::http_context_impl, detail::http_context_deleter());
    }
 
+   void set_keep_alive(const http_context& context, bool keep_alive) {
+      context->keep_alive = keep_alive;
+      if (!keep_alive)
+         context->connections.clear();
+   }
+
    void do_connect(tcp::socket& sock, const resolved_url& url) {
       // Get a list of endpoints corresponding to the server name.
       vector<tcp::endpoint> endpoints;
@@ -55,9 +78,9 @@ namespace eosio { namespace client { namespace http {
    }
 
    template<class T>
-   std::string do_txrx(T& socket, boost::asio::streambuf& request_buff, unsigned int& status_code) {
+   std::string do_txrx(T& socket, const std::string& request, unsigned int& status_code, bool& server_closes) {
       // Send the request.
-      boost::asio::write(socket, request_buff);
+      boost::asio::write(socket, boost::asio::buffer(request));
 
       // Read the response status line. The response streambuf will automatically
       // grow to accommodate the entire line. The growth may be limited by passing
@@ -82,10 +105,14 @@ namespace eosio { namespace client { namespace http {
       std::string header;
       int response_content_length = -1;
       std::regex clregex(R"xx(^content-length:\s+(\d+))xx", std::regex_constants::icase);
+      std::regex closeregex(R"xx(^connection:\s*close)xx", std::regex_constants::icase);
+      server_closes = false;
       while (std::getline(response_stream, header) && header != "\r") {
          std::smatch match;
          if(std::regex_search(header, match, clregex))
             response_content_length = std::stoi(match[1]);
+         else if(std::regex_search(header, closeregex))
+            server_closes = true;
       }
 
       // Attempt to read the response body using the length indicated by the
@@ -95,6 +122,8 @@ namespace eosio { namespace client { namespace http {
          if( response_content_length > 0 )
             boost::asio::read(socket, response, boost::asio::transfer_exactly(response_content_length));
       } else {
+         // the end of the body is the end of the connection
+         server_closes = true;
          boost::system::error_code ec;
          boost::asio::read(socket, response, boost::asio::transfer_all(), ec);
          EOS_ASSERT(!ec || ec == boost::asio::ssl::error::stream_truncated, http_exception, "Unable to read http response: ${err}", ("err",ec.message()));
@@ -105,6 +134,68 @@ namespace eosio { namespace client { namespace http {
       return re.str();
    }
 
+   template<class Socket>
+   class socket_connection : public detail::http_connection {
+      public:
+         template<typename... Args>
+         explicit socket_connection(Args&&... args) : socket(std::forward<Args>(args)...) {}
+
+         std::string txrx(const std::string& request, unsigned int& status_code, bool& server_closes) override {
+            return do_txrx(socket, request, status_code, server_closes);
+         }
+
+         Socket socket;
+   };
+
+   class ssl_connection : public detail::http_connection {
+      public:
+         explicit ssl_connection(boost::asio::io_service& ios)
+         : ssl_context(boost::asio::ssl::context::sslv23_client)
+         , socket(ios, with_root_cas(ssl_context)) {}
+
+         ~ssl_connection() {
+            //try and do a clean shutdown; but swallow if this fails (other side could have already gave TCP the ax)
+            try {socket.shutdown();} catch(...) {}
+         }
+
+         std::string txrx(const std::string& request, unsigned int& status_code, bool& server_closes) override {
+            return do_txrx(socket, request, status_code, server_closes);
+         }
+
+         static boost::asio::ssl::context& with_root_cas(boost::asio::ssl::context& c) {
+            fc::add_platform_root_cas_to_context(c);
+            return c;
+         }
+
+         boost::asio::ssl::context                                ssl_context;
+         boost::asio::ssl::stream<boost::asio::ip::tcp::socket>   socket;
+   };
+
+   std::unique_ptr<detail::http_connection> open_connection(const connection_param& cp) {
+      const auto& url = cp.url;
+      if(url.scheme == "unix") {
+         auto c = std::make_unique<socket_connection<boost::asio::local::stream_protocol::socket>>(cp.context->ios);
+         c->socket.connect(boost::asio::local::stream_protocol::endpoint(url.server));
+         return c;
+      }
+      else if(url.scheme == "http") {
+         auto c = std::make_unique<socket_connection<tcp::socket>>(cp.context->ios);
+         do_connect(c->socket, url);
+         return c;
+      }
+      else { //https
+         auto c = std::make_unique<ssl_connection>(cp.context->ios);
+         SSL_set_tlsext_host_name(c->socket.native_handle(), url.server.c_str());
+         if(cp.verify_cert) {
+            c->socket.set_verify_mode(boost::asio::ssl::verify_peer);
+            c->socket.set_verify_callback(boost::asio::ssl::rfc2818_verification(url.server));
+         }
+         do_connect(c->socket.next_layer(), url);
+         c->socket.handshake(boost::asio::ssl::stream_base::client);
+         return c;
+      }
+   }
+
    parsed_url parse_url( const string& server_url ) {
       parsed_url res;
 
@@ -192,14 +283,13 @@ namespace eosio { namespace client { namespace http {
 
    const auto& url = cp.url;
 
-   boost::asio::streambuf request;
-   std::ostream request_stream(&request);
+   std::ostringstream request_stream;
    auto host_header_value = format_host_header(url);
    request_stream << "POST " << url.path << " HTTP/1.1\r\n";
    request_stream << "Host: " << host_header_value << "\r\n";
    request_stream << "content-length: " << postjson.size() << "\r\n";
    request_stream << "Accept: */*\r\n";
-   request_stream << "Connection: close\r\n";
+   request_stream << (cp.context->keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
    // append more customized headers
    std::vector<string>::iterator itr;
    for (itr = cp.headers.begin(); itr != cp.headers.end(); itr++) {
@@ -207,13 +297,12 @@ namespace eosio { namespace client { namespace http {
    }
    request_stream << "\r\n";
    request_stream << postjson;
+   const auto request = request_stream.str();
 
    if ( print_request ) {
-      string s(request.size(), '\0');
-      buffer_copy(boost::asio::buffer(s), request.data());
       std::cerr << "REQUEST:" << std::endl
                 << "---------------------" << std::endl
-                << s << std::endl
+                << request << std::endl
                 << "---------------------" << std::endl;
    }
 
@@ -221,31 +310,29 @@ namespace eosio { namespace client { namespace http {
    std::string re;
 
    try {
-      if(url.scheme == "unix") {
-         boost::asio::local::stream_protocol::socket unix_socket(cp.context->ios);
-         unix_socket.connect(boost::asio::local::stream_protocol::endpoint(url.server));
-         re = do_txrx(unix_socket, request, status_code);
-      }
-      else if(url.scheme == "http") {
-         tcp::socket socket(cp.context->ios);
-         do_connect(socket, url);
-         re = do_txrx(socket, request, status_code);
-      }
-      else { //https
-         boost::asio::ssl::context ssl_context(boost::asio::ssl::context::sslv23_client);
-         fc::add_platform_root_cas_to_context(ssl_context);
-
-         boost::asio::ssl::stream<boost::asio::ip::tcp::socket> socket(cp.context->ios, ssl_context);
-         SSL_set_tlsext_host_name(socket.native_handle(), url.server.c_str());
-         if(cp.verify_cert) {
-            socket.set_verify_mode(boost::asio::ssl::verify_peer);
-            socket.set_verify_callback(boost::asio::ssl::rfc2818_verification(url.server));
+      bool server_closes = false;
+      if(!cp.context->keep_alive) {
+         re = open_connection(cp)->txrx(request, status_code, server_closes);
+      } else {
+         auto& connections = cp.context->connections;
+         const auto key = url.scheme + "://" + url.server + ":" + url.port + (cp.verify_cert ? "" : " no-verify");
+         for(;;) {
+            auto it = connections.find(key);
+            const bool reused = it != connections.end();
+            if(!reused)
+               it = connections.emplace(key, open_connection(cp)).first;
+            try {
+               re = it->second->txrx(request, status_code, server_closes);
+               if(server_closes)
+                  connections.erase(it);
+               break;
+            } catch(const boost::system::system_error&) {
+               connections.erase(it);
+               // the server may have closed an idle connection before reading the request, retry once on a new one
+               if(!reused)
+                  throw;
+            }
          }
-         do_connect(socket.next_layer(), url);
-         socket.handshake(boost::asio::ssl::stream_base::client);
-         re = do_txrx(socket, request, status_code);
-         //try and do a clean shutdown; but swallow if this fails (other side could have already gave TCP the ax)
-         try {socket.shutdown();} catch(...) {}
       }
    } catch ( invalid_http_request& e ) {
       e.append_log( FC_LOG_MESSAGE( info, "Please verify this url is valid: ${url}", ("url", url.scheme + "://" + url.server + ":" + url.port + url.path) ) );
@@ -16,6 +16,9 @@ namespace eosio { namespace client { namespace http {
 
    http_context create_http_context();
 
+   /// keep the connections of the context open between calls (HTTP keep-alive), until it is destroyed
+   void set_keep_alive(const http_context& context, bool keep_alive);
+
    struct parsed_url {
       string scheme;
       string server;
@@ -103,6 +103,8 @@ Options:
 #include <boost/algorithm/string/split.hpp>
 #include <boost/range/algorithm/copy.hpp>
 #include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/program_options/parsers.hpp>
 
 #pragma pop_macro("N")
 
@@ -194,6 +196,10 @@ vector<string> tx_permission;
 
 eosio::client::http::http_context context;
 
+bool     batch_mode = false;
+bool     batch_stop_on_error = false;
+uint32_t batch_info_ttl_ms = 500;
+
 enum class tx_compression_type {
    none,
    zlib,
@@ -335,7 +341,18 @@ fc::variant call( const std::string& url,
                   const std::string& path) { return call( url, path, fc::variant() ); }
 
 eosio::chain_apis::read_only::get_info_results get_info() {
-   return call(url, get_info_func).as<eosio::chain_apis::read_only::get_info_results>();
+   if (!batch_mode)
+      return call(url, get_info_func).as<eosio::chain_apis::read_only::get_info_results>();
+
+   // in batch mode, the commands of a script reuse the info of the node for batch_info_ttl_ms
+   static std::map<string, std::pair<fc::time_point, eosio::chain_apis::read_only::get_info_results>> info_cache;
+   auto now = fc::time_point::now();
+   auto it = info_cache.find(url);
+   if (it == info_cache.end() || now - it->second.first > fc::milliseconds(batch_info_ttl_ms)) {
+      auto info = call(url, get_info_func).as<eosio::chain_apis::read_only::get_info_results>();
+      it = info_cache.insert_or_assign(url, std::make_pair(now, std::move(info))).first;
+   }
+   return it->second.second;
 }
 
 string generate_nonce_string() {
@@ -346,9 +363,10 @@ chain::action generate_nonce_action() {
    return chain::action( {}, config::null_account_name, name("nonce"), fc::raw::pack(fc::time_point::now().time_since_epoch().count()));
 }
 
+unordered_map<account_name, std::optional<abi_serializer> > abi_cache;
+
 //resolver for ABI serializer to decode actions in proposed transaction in multisig contract
 auto abi_serializer_resolver = [](const name& account) -> std::optional<abi_serializer> {
-  static unordered_map<account_name, std::optional<abi_serializer> > abi_cache;
   auto it = abi_cache.find( account );
   if ( it == abi_cache.end() ) {
     const auto raw_abi_result = call(get_raw_abi_func, fc::mutable_variant_object("account_name", account));
@@ -729,6 +747,8 @@ chain::action create_transfer(const string& contract, const name& sender, const
 }
 
 chain::action create_setabi(const name& account, const bytes& abi) {
+   // later commands of a batch use the new abi
+   abi_cache.erase(account);
    return action {
       get_account_permissions(tx_permission, {account,config::active_name}),
       setabi{
@@ -1015,7 +1035,7 @@ void ensure_keosd_running(CLI::App* app) {
     if (no_auto_keosd)
         return;
     // get, version, net, convert do not require keosd
-    if (tx_skip_sign || app->got_subcommand("get") || app->got_subcommand("version") || app->got_subcommand("net") || app->got_subcommand("convert"))
+    if (tx_skip_sign || app->got_subcommand("batch") || app->got_subcommand("get") || app->got_subcommand("version") || app->got_subcommand("net") || app->got_subcommand("convert"))
         return;
     if (app->get_subcommand("create")->got_subcommand("key")) // create key does not require wallet
        return;
@@ -2495,11 +2515,7 @@ CLI::callback_t header_opt_callback = [](CLI::results_t res) {
 };
 
 
-int main( int argc, char** argv ) {
-
-   fc::logger::get(DEFAULT_LOGGER).set_log_level(fc::log_level::debug);
-   context = eosio::client::http::create_http_context();
-   wallet_url = default_wallet_url;
+int run_command( int argc, const char* const* argv ) {
 
    CLI::App app{"Command Line Interface to EOSIO Client"};
    app.require_subcommand();
@@ -2521,6 +2537,14 @@ int main( int argc, char** argv ) {
    app.add_flag("--print-request", print_request, localized("Print HTTP request to STDERR"));
    app.add_flag("--print-response", print_response, localized("Print HTTP response to STDERR"));
 
+   auto batch = app.add_subcommand("batch", localized("Run the commands read from stdin, one per line, reusing the connections and caches between them"));
+   batch->add_option("--info-ttl-ms", batch_info_ttl_ms, localized("How long in milliseconds the commands reuse the chain info retrieved by an earlier command"), true);
+   batch->add_flag("--stop-on-error", batch_stop_on_error, localized("Stop at the first command which fails"));
+   batch->callback([] {
+      EOSC_ASSERT( !batch_mode, "batch cannot be used within a batch" );
+      batch_mode = true;
+   });
+
    auto version = app.add_subcommand("version", localized("Retrieve version information"));
    version->require_subcommand();
 
@@ -4397,3 +4421,63 @@ int main( int argc, char** argv ) {
 
    return 0;
 }
+
+int main( int argc, char** argv ) {
+   fc::logger::get(DEFAULT_LOGGER).set_log_level(fc::log_level::debug);
+   context = eosio::client::http::create_http_context();
+   wallet_url = default_wallet_url;
+
+   // the options of each command of a batch start from the defaults
+   const auto defaults = std::make_tuple(url, wallet_url, no_verify, headers, tx_expiration, tx_ref_block_num_or_id, tx_force_unique,
+                                         tx_dont_broadcast, tx_return_packed, tx_skip_sign, tx_print_json, tx_use_old_rpc,
+                                         tx_json_save_file, print_request, print_response, no_auto_keosd, verbose,
+                                         tx_max_cpu_usage, tx_max_net_usage, delaysec, tx_permission, tx_compression, signing_keys_opt);
+   auto restore_defaults = [&defaults]() {
+      std::tie(url, wallet_url, no_verify, headers, tx_expiration, tx_ref_block_num_or_id, tx_force_unique,
+               tx_dont_broadcast, tx_return_packed, tx_skip_sign, tx_print_json, tx_use_old_rpc,
+               tx_json_save_file, print_request, print_response, no_auto_keosd, verbose,
+               tx_max_cpu_usage, tx_max_net_usage, delaysec, tx_permission, tx_compression, signing_keys_opt) = defaults;
+   };
+
+   int result = run_command( argc, argv );
+   if( !batch_mode || result != 0 )
+      return result;
+
+   // each line runs as a command with the options given before batch, e.g. cleos -u URL batch
+   vector<string> options;
+   for( int i = 1; i < argc && string(argv[i]) != "batch"; ++i )
+      options.emplace_back( argv[i] );
+
+   eosio::client::http::set_keep_alive( context, true );
+   string line;
+   while( std::getline( std::cin, line ) ) {
+      boost::trim( line );
+      if( line.empty() || line[0] == '#' )
+         continue;
+
+      vector<string> args{ argv[0] };
+      args.insert( args.end(), options.begin(), options.end() );
+      try {
+         auto words = boost::program_options::split_unix( line );
+         args.insert( args.end(), words.begin(), words.end() );
+      } catch( const std::exception& e ) {
+         std::cerr << localized("Invalid command \"${c}\": ${e}", ("c", line)("e", e.what())) << std::endl;
+         result = 1;
+         if( batch_stop_on_error )
+            break;
+         continue;
+      }
+
+      vector<const char*> cargs;
+      for( const auto& a : args )
+         cargs.push_back( a.c_str() );
+
+      restore_defaults();
+      if( run_command( static_cast<int>( cargs.size() ), cargs.data() ) != 0 ) {
+         result = 1;
+         if( batch_stop_on_error )
+            break;
+      }
+   }
+   return result;
+}
@@ -3,6 +3,7 @@
 #include <eosio/chain/block_log.hpp>
 #include <eosio/chain/config.hpp>
 #include <eosio/chain/reversible_block_object.hpp>
+#include <eosio/chain/thread_utils.hpp>
 
 #include <eosio/state_history/log.hpp>
 
@@ -17,6 +18,8 @@
 #include <boost/filesystem/path.hpp>
 
 #include <chrono>
+#include <deque>
+#include <thread>
 
 #ifndef _WIN32
 #define FOPEN(p, m) fopen(p, m)
@@ -46,10 +49,13 @@ struct blocklog {
    uint32_t                         last_block = std::numeric_limits<uint32_t>::max();
    bool                             no_pretty_print = false;
    bool                             as_json_array = false;
+   std::string                      output_format = "json";
+   uint32_t                         threads = std::max(std::thread::hardware_concurrency(), 1u);
    bool                             make_index = false;
    bool                             trim_log = false;
    bool                             fix_irreversible_blocks = false;
    bool                             smoke_test = false;
+   bool                             verify = false;
    bool                             prune_transactions = false;
    bool                             help               = false;
 };
@@ -109,7 +115,7 @@ void blocklog::read_log() {
    std::ofstream output_blocks;
    std::ostream* out;
    if (!output_file.empty()) {
-      output_blocks.open(output_file.generic_string().c_str());
+      output_blocks.open(output_file.generic_string().c_str(), std::ios::out | std::ios::binary);
       if (output_blocks.fail()) {
          std::ostringstream ss;
          ss << "Unable to open file '" << output_file.string() << "'";
@@ -120,53 +126,106 @@ void blocklog::read_log() {
    else
       out = &std::cout;
 
-   if (as_json_array)
-      *out << "[";
-   uint32_t block_num = (first_block < 1) ? 1 : first_block;
-   fc::variant pretty_output;
+   const bool binary = output_format == "binary";
+   const bool ndjson = output_format == "ndjson";
+   const char* separator = as_json_array ? "," : "";
+
+   // blocks are read in order on this thread, converted on the pool in chunks and written in order
+   const size_t chunk_size = 64;
+   const size_t max_pending_chunks = 2 * threads;
    const fc::microseconds deadline = fc::seconds(10);
-   auto print_block = [&](auto& next) {
-      abi_serializer::to_variant(*next,
-                                 pretty_output,
-                                 []( account_name n ) { return std::optional<abi_serializer>(); },
-                                 abi_serializer::create_yield_function( deadline ));
-      const auto block_id = next->calculate_id();
-      const uint32_t ref_block_prefix = block_id._hash[1];
-      const auto enhanced_object = fc::mutable_variant_object
-                 ("block_num",next->block_num())
-                 ("id", block_id)
-                 ("ref_block_prefix", ref_block_prefix)
-                 (pretty_output.get_object());
-      fc::variant v(std::move(enhanced_object));
-      if (no_pretty_print)
-         *out << fc::json::to_string(v, fc::time_point::maximum());
-      else
-         *out << fc::json::to_pretty_string(v) << "\n";
+   auto convert_chunk = [&](const std::vector<signed_block_ptr>& blocks) {
+      std::string result;
+      fc::variant pretty_output;
+      for (const auto& next : blocks) {
+         if (binary) {
+            const auto packed = fc::raw::pack(*next);
+            result.append(packed.data(), packed.size());
+            continue;
+         }
+         if (!result.empty())
+            result += separator;
+         abi_serializer::to_variant(*next,
+                                    pretty_output,
+                                    []( account_name n ) { return std::optional<abi_serializer>(); },
+                                    abi_serializer::create_yield_function( deadline ));
+         const auto block_id = next->calculate_id();
+         const uint32_t ref_block_prefix = block_id._hash[1];
+         const auto enhanced_object = fc::mutable_variant_object
+                    ("block_num",next->block_num())
+                    ("id", block_id)
+                    ("ref_block_prefix", ref_block_prefix)
+                    (pretty_output.get_object());
+         fc::variant v(std::move(enhanced_object));
+         if (ndjson)
+            result += fc::json::to_string(v, fc::time_point::maximum()) + "\n";
+         else if (no_pretty_print)
+            result += fc::json::to_string(v, fc::time_point::maximum());
+         else
+            result += fc::json::to_pretty_string(v) + "\n";
+      }
+      return result;
    };
+
+   std::optional<named_thread_pool> thread_pool;
+   if (threads > 1)
+      thread_pool.emplace("blklog", threads);
+   std::deque<std::future<std::string>> pending;
    bool contains_obj = false;
+   auto write_chunk = [&](const std::string& chunk) {
+      if (chunk.empty())
+         return;
+      if (contains_obj && !binary)
+         *out << separator;
+      *out << chunk;
+      contains_obj = true;
+   };
+   std::vector<signed_block_ptr> chunk;
+   auto flush_chunk = [&]() {
+      if (chunk.empty())
+         return;
+      if (!thread_pool) {
+         write_chunk(convert_chunk(chunk));
+      } else {
+         if (pending.size() >= max_pending_chunks) {
+            write_chunk(pending.front().get());
+            pending.pop_front();
+         }
+         pending.push_back(async_thread_pool(thread_pool->get_executor(), [&convert_chunk, blocks = std::move(chunk)]() {
+            return convert_chunk(blocks);
+         }));
+      }
+      chunk.clear();
+   };
+   auto print_block = [&](signed_block_ptr next) {
+      chunk.push_back(std::move(next));
+      if (chunk.size() == chunk_size)
+         flush_chunk();
+   };
+
+   if (as_json_array && !binary)
+      *out << "[";
+   uint32_t block_num = (first_block < 1) ? 1 : first_block;
    while( block_num <= last_block ) {
       auto sb = block_logger.read_signed_block_by_num( block_num );
       if( !sb ) break;
-      if (as_json_array && contains_obj)
-         *out << ",";
-      print_block(sb);
+      print_block(std::move(sb));
       ++block_num;
-      contains_obj = true;
    }
 
    if (reversible_blocks) {
       const reversible_block_object* obj = nullptr;
       while( (block_num <= last_block) && (obj = reversible_blocks->find<reversible_block_object,by_num>(block_num)) ) {
-         if (as_json_array && contains_obj)
-            *out << ",";
-         auto next = obj->get_block();
-         print_block(next);
+         print_block(obj->get_block());
          ++block_num;
-         contains_obj = true;
       }
    }
 
-   if (as_json_array)
+   flush_chunk();
+   for (auto& f : pending)
+      write_chunk(f.get());
+
+   if (as_json_array && !binary)
       *out << "]";
    rt.report();
 }
@@ -188,6 +247,10 @@ void blocklog::set_program_options(options_description& cli)
           "Do not pretty print the output.  Useful if piping to jq to improve performance.")
          ("as-json-array", bpo::bool_switch(&as_json_array)->default_value(false),
           "Print out json blocks wrapped in json array (otherwise the output is free-standing json objects).")
+         ("output-format", bpo::value<std::string>(&output_format)->default_value("json"),
+          "Format of the blocks printed: 'json', 'ndjson' (one unformatted json block per line) or 'binary' (the packed blocks one after the other).")
+         ("threads", bpo::value<uint32_t>(&threads)->default_value(threads),
+          "Number of threads converting the blocks, which are still printed in order.")
          ("make-index", bpo::bool_switch(&make_index)->default_value(false),
           "Create blocks.index from blocks.log. Must give 'blocks-dir'. Give 'output-file' relative to current directory or absolute path (default is <blocks-dir>/blocks.index).")
          ("trim-blocklog", bpo::bool_switch(&trim_log)->default_value(false),
@@ -197,6 +260,8 @@ void blocklog::set_program_options(options_description& cli)
           "it will take the highest indexed block if it is valid; otherwise it will repair the block log and reconstruct the index.")
          ("smoke-test", bpo::bool_switch(&smoke_test)->default_value(false),
           "Quick test that blocks.log and blocks.index are well formed and agree with each other.")
+         ("verify", bpo::bool_switch(&verify)->default_value(false),
+          "Fully validate every block of blocks.log against blocks.index, ranges of blocks are validated on several threads.")
          ("block-num", bpo::value<uint32_t>()->default_value(0), "The block number which contains the transactions to be pruned")
          ("transaction,t", bpo::value<std::vector<std::string> >()->multitoken(), "The transaction id to be pruned")
          ("prune-transactions", bpo::bool_switch(&prune_transactions)->default_value(false),
@@ -220,6 +285,10 @@ void blocklog::initialize(const variables_map& options) {
          else
             output_file = bld;
       }
+      EOS_ASSERT( output_format == "json" || output_format == "ndjson" || output_format == "binary", fc::invalid_arg_exception,
+                  "Unknown output-format '${f}', expected 'json', 'ndjson' or 'binary'", ("f", output_format) );
+      EOS_ASSERT( !as_json_array || output_format == "json", fc::invalid_arg_exception, "as-json-array requires the json output-format" );
+      EOS_ASSERT( threads > 0, fc::invalid_arg_exception, "threads must be at least 1" );
    } FC_LOG_AND_RETHROW()
 
 }
@@ -256,6 +325,15 @@ void smoke_test(bfs::path block_dir) {
    cout << "\nno problems found\n"; // if get here there were no exceptions
 }
 
+void verify(bfs::path block_dir) {
+   using namespace std;
+   cout << "\nVerifying blocks.log and blocks.index in directory " << block_dir << '\n';
+   report_time rt("verifying blocklog");
+   block_log::verify(block_dir);
+   rt.report();
+   cout << "\nno problems found\n"; // if get here there were no exceptions
+}
+
 template <typename Log>
 int prune_transactions(const char* type, bfs::path dir, uint32_t block_num,
                        std::vector<transaction_id_type> unpruned_ids) {
@@ -304,6 +382,10 @@ int main(int argc, char** argv) {
          smoke_test(vmap.at("blocks-dir").as<bfs::path>());
          return 0;
       }
+      if (blog.verify) {
+         verify(vmap.at("blocks-dir").as<bfs::path>());
+         return 0;
+      }
       if (blog.fix_irreversible_blocks) {
           fix_irreversible_blocks(vmap.at("blocks-dir").as<bfs::path>());
           return 0;
@@ -0,0 +1,366 @@
+#include <eosio/chain/exceptions.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/variant_object.hpp>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/exception/diagnostic_information.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <thread>
+
+using namespace eosio;
+namespace bpo = boost::program_options;
+namespace beast = boost::beast;
+namespace http = boost::beast::http;
+using boost::asio::ip::tcp;
+using bpo::options_description;
+using bpo::variables_map;
+
+namespace {
+   std::atomic<bool> interrupted{false};
+
+   using clock_type = std::chrono::steady_clock;
+}
+
+struct latency_summary {
+   uint64_t count   = 0;
+   double   mean_us = 0;
+   int64_t  p50_us  = 0;
+   int64_t  p90_us  = 0;
+   int64_t  p99_us  = 0;
+   int64_t  max_us  = 0;
+};
+
+struct status_count {
+   std::string status; ///< http status code, or "error" when no response was received
+   uint64_t    count = 0;
+};
+
+struct endpoint_summary {
+   std::string               endpoint;
+   uint64_t                  requests = 0;
+   double                    requests_per_second = 0;
+   std::vector<status_count> statuses;
+   latency_summary           latency;
+};
+
+struct http_bench_result {
+   std::string                   url;
+   uint32_t                      connections = 0;
+   double                        speed = 0;
+   uint64_t                      logged_requests = 0;
+   uint64_t                      requests = 0;
+   uint64_t                      errors = 0;
+   double                        seconds = 0;
+   double                        requests_per_second = 0;
+   latency_summary               latency;
+   std::vector<endpoint_summary> endpoints;
+};
+
+FC_REFLECT( latency_summary, (count)(mean_us)(p50_us)(p90_us)(p99_us)(max_us) )
+FC_REFLECT( status_count, (status)(count) )
+FC_REFLECT( endpoint_summary, (endpoint)(requests)(requests_per_second)(statuses)(latency) )
+FC_REFLECT( http_bench_result, (url)(connections)(speed)(logged_requests)(requests)(errors)(seconds)(requests_per_second)
+                               (latency)(endpoints) )
+
+latency_summary summarize( std::vector<int64_t> v ) {
+   latency_summary s;
+   if( v.empty() )
+      return s;
+   std::sort( v.begin(), v.end() );
+   const auto percentile = [&]( double p ) { return v[std::min<size_t>( v.size() - 1, std::ceil( p * v.size() ) - 1 )]; };
+   s.count   = v.size();
+   s.mean_us = std::accumulate( v.begin(), v.end(), 0.0 ) / v.size();
+   s.p50_us  = v[(v.size() - 1) / 2];
+   s.p90_us  = percentile( 0.90 );
+   s.p99_us  = percentile( 0.99 );
+   s.max_us  = v.back();
+   return s;
+}
+
+/// a request of the http-request-log-file of nodeos
+struct logged_request {
+   int64_t     time_us = 0;
+   std::string endpoint;
+   std::string body;
+};
+
+struct bench_config {
+   std::string host;
+   std::string port;
+   uint32_t    connections = 8;
+   double      speed = 0;
+   uint32_t    duration_s = 0;
+};
+
+/// what one connection measured, merged once every connection stopped
+struct connection_stats {
+   std::map<std::string, std::vector<int64_t>>               latency_us; ///< by endpoint
+   std::map<std::string, std::map<std::string, uint64_t>>    statuses;   ///< by endpoint
+};
+
+/**
+ * Sends the logged requests to the node over one keep-alive connection, one at a time, taking the next request of
+ * the log when its response has been read.
+ */
+class connection {
+ public:
+   connection( const bench_config& cfg, const std::vector<logged_request>& requests, std::atomic<uint64_t>& next,
+               clock_type::time_point start, clock_type::time_point deadline )
+   : cfg( cfg ), requests( requests ), next( next ), start( start ), deadline( deadline ), stream( ctx ) {}
+
+   void run() {
+      const int64_t first_us = requests.front().time_us;
+      const int64_t span_us = requests.back().time_us - first_us + 1;
+      while( !interrupted ) {
+         const uint64_t i = next.fetch_add( 1 );
+         if( cfg.duration_s == 0 && i >= requests.size() )
+            break;
+         const auto& req = requests[i % requests.size()];
+
+         // with a speed the request is due at its logged time, latency then includes the time it waited for the
+         // connection, as clients of the node would
+         auto sent = clock_type::now();
+         if( cfg.speed > 0 ) {
+            const int64_t offset_us = int64_t( i / requests.size() ) * span_us + ( req.time_us - first_us );
+            const auto due = start + std::chrono::microseconds( int64_t( offset_us / cfg.speed ) );
+            if( due > deadline )
+               break;
+            std::this_thread::sleep_until( due );
+            sent = due;
+         }
+         if( clock_type::now() >= deadline )
+            break;
+
+         const auto status = send( req );
+         const auto us = std::chrono::duration_cast<std::chrono::microseconds>( clock_type::now() - sent ).count();
+         ++stats.statuses[req.endpoint][status];
+         if( status != "error" )
+            stats.latency_us[req.endpoint].push_back( us );
+      }
+      close();
+   }
+
+   connection_stats stats;
+
+ private:
+   std::string send( const logged_request& req ) {
+      try {
+         if( !connected ) {
+            tcp::resolver resolver( ctx );
+            stream.connect( resolver.resolve( cfg.host, cfg.port ) );
+            stream.socket().set_option( tcp::no_delay( true ) );
+            connected = true;
+         }
+         http::request<http::string_body> request{ http::verb::post, req.endpoint, 11 };
+         request.set( http::field::host, cfg.host + ":" + cfg.port );
+         request.set( http::field::content_type, "application/json" );
+         request.keep_alive( true );
+         request.body() = req.body;
+         request.prepare_payload();
+         http::write( stream, request );
+
+         http::response<http::string_body> response;
+         http::read( stream, buffer, response );
+         if( !response.keep_alive() )
+            close();
+         return std::to_string( response.result_int() );
+      } catch( const boost::system::system_error& e ) {
+         if( !failed_once ) {
+            elog( "request to ${e} failed: ${m}", ("e", req.endpoint)("m", e.what()) );
+            failed_once = true;
+         }
+         close();
+         return "error";
+      }
+   }
+
+   void close() {
+      if( !connected )
+         return;
+      boost::system::error_code ec;
+      stream.socket().shutdown( tcp::socket::shutdown_both, ec );
+      stream.close();
+      buffer.clear();
+      connected = false;
+   }
+
+   const bench_config&                cfg;
+   const std::vector<logged_request>& requests;
+   std::atomic<uint64_t>&             next;
+   const clock_type::time_point       start;
+   const clock_type::time_point       deadline;
+   boost::asio::io_context            ctx;
+   beast::tcp_stream                  stream;
+   beast::flat_buffer                 buffer;
+   bool                               connected = false;
+   bool                               failed_once = false;
+};
+
+struct http_bench {
+   void set_program_options(options_description& cli);
+   void initialize(const variables_map& options);
+   http_bench_result run();
+
+   bench_config                cfg;
+   std::vector<logged_request> requests;
+   std::string                 output_file;
+   bool                        help = false;
+};
+
+void http_bench::set_program_options(options_description& cli) {
+   cli.add_options()
+         ("http-address", bpo::value<std::string>()->default_value("127.0.0.1:8888"),
+          "host:port of the http-server-address of the node to benchmark")
+         ("request-log", bpo::value<std::string>(),
+          "the requests to send, a file written by the http-request-log-file option of nodeos")
+         ("connections,c", bpo::value<uint32_t>(&cfg.connections)->default_value(cfg.connections),
+          "number of keep-alive connections sending requests, each has one request in flight")
+         ("speed", bpo::value<double>(&cfg.speed)->default_value(cfg.speed),
+          "send each request at its logged time divided by this factor, e.g. 2 replays twice as fast as logged; "
+          "0 sends the next request as soon as a connection is free")
+         ("duration", bpo::value<uint32_t>(&cfg.duration_s)->default_value(cfg.duration_s),
+          "seconds to run, replaying the log again from its start when it runs out; 0 replays the log once")
+         ("output-file,o", bpo::value<std::string>(&output_file),
+          "also write the result as JSON to this file, for comparing runs")
+         ("help,h", bpo::bool_switch(&help)->default_value(false), "Print this help message and exit.")
+         ;
+}
+
+void http_bench::initialize(const variables_map& options) {
+   const auto& address = options.at("http-address").as<std::string>();
+   const auto colon = address.rfind(':');
+   EOS_ASSERT( colon != std::string::npos, chain::plugin_config_exception, "http-address ${a} is not host:port", ("a", address) );
+   cfg.host = address.substr(0, colon);
+   cfg.port = address.substr(colon + 1);
+   EOS_ASSERT( cfg.connections > 0, chain::plugin_config_exception, "connections must be greater than 0" );
+   EOS_ASSERT( cfg.speed >= 0, chain::plugin_config_exception, "speed must not be negative" );
+
+   EOS_ASSERT( options.count("request-log"), chain::plugin_config_exception, "request-log is required" );
+   const auto& log_file = options.at("request-log").as<std::string>();
+   std::ifstream in(log_file);
+   EOS_ASSERT( in.good(), chain::plugin_config_exception, "Unable to open ${f}", ("f", log_file) );
+   std::string line;
+   while( std::getline(in, line) ) {
+      if( line.empty() )
+         continue;
+      const auto obj = fc::json::from_string(line).get_object();
+      requests.push_back( { obj["time_us"].as_int64(), obj["endpoint"].as_string(), obj["body"].as_string() } );
+   }
+   EOS_ASSERT( !requests.empty(), chain::plugin_config_exception, "${f} holds no requests", ("f", log_file) );
+   std::stable_sort( requests.begin(), requests.end(), []( const auto& a, const auto& b ) { return a.time_us < b.time_us; } );
+   ilog( "loaded ${n} requests of ${e} seconds", ("n", requests.size())("e", (requests.back().time_us - requests.front().time_us) / 1e6) );
+}
+
+http_bench_result http_bench::run() {
+   std::atomic<uint64_t> next{0};
+   const auto start = clock_type::now();
+   const auto deadline = cfg.duration_s ? start + std::chrono::seconds( cfg.duration_s ) : clock_type::time_point::max();
+
+   std::vector<std::unique_ptr<connection>> connections;
+   std::vector<std::thread> threads;
+   for( uint32_t i = 0; i < cfg.connections; ++i ) {
+      connections.push_back( std::make_unique<connection>( cfg, requests, next, start, deadline ) );
+      threads.emplace_back( [c = connections.back().get()]() { c->run(); } );
+   }
+   for( auto& t : threads )
+      t.join();
+   const double seconds = std::chrono::duration<double>( clock_type::now() - start ).count();
+
+   http_bench_result result;
+   result.url = "http://" + cfg.host + ":" + cfg.port;
+   result.connections = cfg.connections;
+   result.speed = cfg.speed;
+   result.logged_requests = requests.size();
+   result.seconds = seconds;
+
+   connection_stats all;
+   for( auto& c : connections ) {
+      for( auto& [endpoint, v] : c->stats.latency_us ) {
+         auto& to = all.latency_us[endpoint];
+         to.insert( to.end(), v.begin(), v.end() );
+      }
+      for( const auto& [endpoint, statuses] : c->stats.statuses )
+         for( const auto& [status, count] : statuses )
+            all.statuses[endpoint][status] += count;
+   }
+
+   std::vector<int64_t> latency_us;
+   for( const auto& [endpoint, statuses] : all.statuses ) {
+      endpoint_summary s;
+      s.endpoint = endpoint;
+      for( const auto& [status, count] : statuses ) {
+         s.statuses.push_back( { status, count } );
+         s.requests += count;
+         if( status == "error" )
+            result.errors += count;
+      }
+      s.requests_per_second = seconds > 0 ? s.requests / seconds : 0;
+      const auto& v = all.latency_us[endpoint];
+      latency_us.insert( latency_us.end(), v.begin(), v.end() );
+      s.latency = summarize( v );
+      result.requests += s.requests;
+      result.endpoints.push_back( std::move( s ) );
+   }
+   result.requests_per_second = seconds > 0 ? result.requests / seconds : 0;
+   result.latency = summarize( std::move( latency_us ) );
+   return result;
+}
+
+int main(int argc, char** argv) {
+   options_description cli ("eosio-http-bench command line options");
+   try {
+      http_bench bench;
+      bench.set_program_options(cli);
+      variables_map vmap;
+      bpo::store(bpo::parse_command_line(argc, argv, cli), vmap);
+      bpo::notify(vmap);
+      if (bench.help) {
+         cli.print(std::cerr);
+         return 0;
+      }
+      bench.initialize(vmap);
+
+      // stop and report what was measured so far
+      std::signal(SIGINT, [](int) { interrupted = true; });
+      std::signal(SIGTERM, [](int) { interrupted = true; });
+
+      const auto result = bench.run();
+      std::cout << fc::json::to_pretty_string(result) << std::endl;
+      if (!bench.output_file.empty()) {
+         std::ofstream out(bench.output_file);
+         out << fc::json::to_pretty_string(result) << std::endl;
+         EOS_ASSERT(out.good(), chain::misc_exception, "Unable to write ${f}", ("f", bench.output_file));
+      }
+   } catch( const fc::exception& e ) {
+      elog( "${e}", ("e", e.to_detail_string()));
+      return -1;
+   } catch( const boost::exception& e ) {
+      elog("${e}", ("e",boost::diagnostic_information(e)));
+      return -1;
+   } catch( const std::exception& e ) {
+      elog("${e}", ("e",e.what()));
+      return -1;
+   } catch( ... ) {
+      elog("unknown exception");
+      return -1;
+   }
+
+   return 0;
+}
@@ -20,6 +20,7 @@
 #include <boost/filesystem/path.hpp>
 #include <fc/crypto/private_key.hpp>
 #include <fc/crypto/public_key.hpp>
+#include <fc/crypto/sha256.hpp>
 #include <fc/io/json.hpp>
 #include <fc/network/ip.hpp>
 #include <fc/reflect/variant.hpp>
@@ -232,6 +233,18 @@ private:
   string dot_label_str;
 };
 
+// network impairment of the p2p traffic to and from the p2p port of a node, applied with tc netem
+struct link_impairment_def {
+  uint32_t delay_ms = 0;
+  uint32_t jitter_ms = 0;
+  string   rate;       // netem rate, e.g. "10mbit", empty for no limit
+  string   loss;       // netem loss, e.g. "1%", empty for no loss
+
+  bool empty() const {
+    return delay_ms == 0 && jitter_ms == 0 && rate.empty() && loss.empty();
+  }
+};
+
 class tn_node_def {
 public:
   string          name;
@@ -241,6 +254,7 @@ public:
   eosd_def*       instance;
   string          gelf_endpoint;
   bool            dont_start = false;
+  link_impairment_def impairment;
 };
 
 void
@@ -425,6 +439,10 @@ struct launcher_def {
    std::optional<uint32_t> max_block_cpu_usage;
    std::optional<uint32_t> max_transaction_cpu_usage;
    eosio::chain::genesis_state genesis_from_file;
+   string key_seed;
+   link_impairment_def link_impairment;
+   string impair_dev;
+   string impair_script;
 
    void assign_name (eosd_def &node, bool is_bios);
 
@@ -445,6 +463,7 @@ struct launcher_def {
    void write_genesis_file (tn_node_def &node);
    void write_setprods_file ();
    void write_bios_boot ();
+   void write_impair_script ();
 
    bool   is_bios_ndx (size_t ndx);
    size_t start_ndx();
@@ -454,6 +473,7 @@ struct launcher_def {
    void make_ring ();
    void make_star ();
    void make_mesh ();
+   void make_relay ();
    void make_custom ();
    void write_dot_file ();
    void format_ssh (const string &cmd, const string &host_name, string &ssh_cmd_line);
@@ -482,7 +502,7 @@ launcher_def::set_options (bpo::options_description &cfg) {
     ("producers",bpo::value<size_t>(&producers)->default_value(21),"total number of non-bios and non-shared producer instances in this network")
     ("shared-producers",bpo::value<size_t>(&shared_producers)->default_value(0),"total number of shared producers on each non-bios nodes")
     ("mode,m",bpo::value<vector<string>>()->multitoken()->default_value({"any"}, "any"),"connection mode, combination of \"any\", \"producers\", \"specified\", \"none\"")
-    ("shape,s",bpo::value<string>(&shape)->default_value("star"),"network topology, use \"star\" \"mesh\" or give a filename for custom")
+    ("shape,s",bpo::value<string>(&shape)->default_value("star"),"network topology, use \"star\" \"mesh\" \"relay\" or give a filename for custom")
     ("genesis,g",bpo::value<string>()->default_value("./genesis.json"),"set the path to genesis.json")
     ("skip-signature", bpo::bool_switch(&skip_transaction_signatures)->default_value(false), (string(node_executable_name) + " does not require transaction signatures.").c_str())
     (node_executable_name, bpo::value<string>(&eosd_extra_args), ("forward " + string(node_executable_name) + " command line argument(s) to each instance of " + string(node_executable_name) + ", enclose arg(s) in quotes").c_str())
@@ -503,6 +523,13 @@ launcher_def::set_options (bpo::options_description &cfg) {
     ("script",bpo::value<string>(&start_script)->default_value("bios_boot.sh"),"the generated startup script name")
     ("max-block-cpu-usage",bpo::value<uint32_t>(),"Provide the \"max-block-cpu-usage\" value to use in the genesis.json file")
     ("max-transaction-cpu-usage",bpo::value<uint32_t>(),"Provide the \"max-transaction-cpu-usage\" value to use in the genesis.json file")
+    ("key-seed",bpo::value<string>(&key_seed)->default_value(""),"derive the keys of the nodes from this seed and their names instead of generating random keys, so that the generated configuration is reproducible")
+    ("link-delay-ms",bpo::value<uint32_t>(&link_impairment.delay_ms)->default_value(0),"delay added to the p2p traffic of each node, for nodes of a custom shape without their own impairment")
+    ("link-jitter-ms",bpo::value<uint32_t>(&link_impairment.jitter_ms)->default_value(0),"random variation of the delay added to the p2p traffic of each node")
+    ("link-rate",bpo::value<string>(&link_impairment.rate)->default_value(""),"bandwidth of the p2p traffic of each node, in tc units, e.g. \"10mbit\"")
+    ("link-loss",bpo::value<string>(&link_impairment.loss)->default_value(""),"ratio of the p2p packets of each node which are dropped, e.g. \"1%\"")
+    ("impair-dev",bpo::value<string>(&impair_dev)->default_value("lo"),"network device carrying the p2p traffic which is impaired")
+    ("impair-script",bpo::value<string>(&impair_script)->default_value("impair_network.sh"),"the generated script applying the network impairment, run it with \"reset\" to remove the impairment")
         ;
 }
 
@@ -585,7 +612,8 @@ launcher_def::initialize (const variables_map &vmap) {
   if ( ! (shape.empty() ||
           boost::iequals( shape, "ring" ) ||
           boost::iequals( shape, "star" ) ||
-          boost::iequals( shape, "mesh" )) &&
+          boost::iequals( shape, "mesh" ) ||
+          boost::iequals( shape, "relay" )) &&
        host_map_file.empty()) {
     bfs::path src = shape;
     host_map_file = src.stem().string() + "_hosts.json";
@@ -723,13 +751,22 @@ launcher_def::generate () {
   else if (boost::iequals (shape, "mesh")) {
     make_mesh ();
   }
+  else if (boost::iequals (shape, "relay")) {
+    make_relay ();
+  }
   else {
     make_custom ();
   }
 
+  for (auto &node : network.nodes) {
+     if (node.second.impairment.empty())
+        node.second.impairment = link_impairment;
+  }
+
   if( !nogen ) {
      write_setprods_file();
      write_bios_boot();
+     write_impair_script();
      init_genesis();
      for (auto &node : network.nodes) {
         write_config_file(node.second);
@@ -870,7 +907,9 @@ launcher_def::bind_nodes () {
          node.instance = &inst;
          auto kp = is_bios ?
             private_key_type(string("5KQwrPbwdL6PhXujxW37FSSQZ1JiwsST4cqQzDeyXtP79zkvFD3")) :
-            private_key_type::generate();
+            key_seed.empty() ?
+            private_key_type::generate() :
+            private_key_type::regenerate<fc::ecc::private_key_shim>(fc::sha256::hash(key_seed + inst.name));
          auto pubkey = kp.get_public_key();
          node.keys.emplace_back (move(kp));
          if (is_bios) {
@@ -1279,6 +1318,56 @@ launcher_def::write_bios_boot () {
    brb.close();
 }
 
+// the traffic to and from the p2p port of each impaired node goes through its own netem qdisc
+void
+launcher_def::write_impair_script () {
+   bfs::path filename = bfs::current_path() / impair_script;
+   bool impaired = false;
+   for (const auto &node : network.nodes) {
+      impaired = impaired || !node.second.impairment.empty();
+   }
+   if (!impaired) {
+      bfs::remove(filename);
+      return;
+   }
+   bfs::ofstream script (filename);
+   if(!script.good()) {
+      cerr << "unable to open " << filename << " " << strerror(errno) << "\n";
+      exit (9);
+   }
+   script << "#!/bin/bash\n"
+          << "# generated by eosio-launcher, run with \"reset\" to remove the impairment\n"
+          << "tc qdisc del dev " << impair_dev << " root 2>/dev/null\n"
+          << "[ \"$1\" == \"reset\" ] && exit 0\n"
+          << "set -e\n"
+          << "tc qdisc add dev " << impair_dev << " root handle 1: htb\n";
+   unsigned int band = 0x10;
+   for (const auto &node : network.nodes) {
+      const auto &impairment = node.second.impairment;
+      if (impairment.empty() || node.second.instance == nullptr)
+         continue;
+      std::stringstream classid;
+      classid << std::hex << band++;
+      const auto port = std::to_string(node.second.instance->p2p_port);
+      script << "# " << node.first << "\n"
+             << "tc class add dev " << impair_dev << " parent 1: classid 1:" << classid.str() << " htb rate 10gbit\n"
+             << "tc qdisc add dev " << impair_dev << " parent 1:" << classid.str() << " handle " << classid.str() << ": netem";
+      if (impairment.delay_ms || impairment.jitter_ms)
+         script << " delay " << impairment.delay_ms << "ms " << impairment.jitter_ms << "ms";
+      if (!impairment.rate.empty())
+         script << " rate " << impairment.rate;
+      if (!impairment.loss.empty())
+         script << " loss " << impairment.loss;
+      script << "\n";
+      for (const char* match : {"dport", "sport"}) {
+         script << "tc filter add dev " << impair_dev << " parent 1: protocol ip prio 1 u32 match ip " << match << " "
+                << port << " 0xffff flowid 1:" << classid.str() << "\n";
+      }
+   }
+   script.close();
+   bfs::permissions(filename, bfs::add_perms | bfs::owner_exe | bfs::group_exe | bfs::others_exe);
+}
+
 bool launcher_def::is_bios_ndx (size_t ndx) {
    return aliases[ndx] == "bios";
 }
@@ -1408,6 +1497,31 @@ launcher_def::make_mesh () {
   }
 }
 
+// producer nodes only connect to the relay nodes, which are the nodes without producers, the relays form a mesh
+void
+launcher_def::make_relay () {
+  if (total_nodes == prod_nodes) {
+    make_mesh ();
+    return;
+  }
+  bind_nodes();
+  vector<string> relays;
+  vector<string> producer_nodes;
+  bool loop = false;
+  for (size_t i = start_ndx(); !loop; loop = next_ndx(i)) {
+    const auto& node = network.nodes.find(aliases[i])->second;
+    (node.producers.empty() ? relays : producer_nodes).push_back(aliases[i]);
+  }
+  for (const auto& p : producer_nodes) {
+    auto &current = network.nodes.find(p)->second;
+    current.peers.insert(current.peers.end(), relays.begin(), relays.end());
+  }
+  for (size_t i = 0; i < relays.size(); ++i) {
+    auto &current = network.nodes.find(relays[i])->second;
+    current.peers.insert(current.peers.end(), relays.begin() + i + 1, relays.end());
+  }
+}
+
 void
 launcher_def::make_custom () {
   bfs::path source = shape;
@@ -2060,8 +2174,10 @@ FC_REFLECT( eosd_def,
             (http_port)(file_size)(name)(host)
             (p2p_endpoint) )
 
+FC_REFLECT( link_impairment_def, (delay_ms)(jitter_ms)(rate)(loss) )
+
 // @ignore instance, gelf_endpoint
-FC_REFLECT( tn_node_def, (name)(keys)(peers)(producers)(dont_start) )
+FC_REFLECT( tn_node_def, (name)(keys)(peers)(producers)(dont_start)(impairment) )
 
 FC_REFLECT( testnet_def, (name)(ssh_helper)(nodes) )
 
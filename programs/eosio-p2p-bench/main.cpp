@@ -0,0 +1,603 @@
+#include <eosio/net_plugin/protocol.hpp>
+#include <eosio/chain/exceptions.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/variant.hpp>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/exception/diagnostic_information.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <thread>
+
+using namespace eosio;
+namespace bpo = boost::program_options;
+namespace bio = boost::iostreams;
+using boost::asio::ip::tcp;
+using bpo::options_description;
+using bpo::variables_map;
+
+namespace {
+   std::atomic<bool> interrupted{false};
+
+   // as the net_plugin, see net_version_base there
+   constexpr uint16_t net_version_base = 0x04b5;
+   constexpr uint16_t default_protocol_version = 8; // proto_compressed_blocks
+   constexpr uint32_t max_message_size = 64 * 1024 * 1024;
+
+   constexpr const char* message_names[] = {
+      "handshake", "chain_size", "go_away", "time", "notice", "request", "sync_request", "signed_block_v0",
+      "packed_transaction_v0", "signed_block", "trx_message_v1", "compact_block", "compressed_block"
+   };
+   static_assert( std::size( message_names ) == std::variant_size_v<net_message> );
+
+   int64_t now_ns() {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+   }
+}
+
+struct latency_summary {
+   uint64_t count   = 0;
+   double   mean_us = 0;
+   int64_t  p50_us  = 0;
+   int64_t  p99_us  = 0;
+   int64_t  max_us  = 0;
+};
+
+struct message_summary {
+   std::string type;
+   uint64_t    count = 0;
+   uint64_t    bytes = 0;
+   double      decode_ns_per_message   = 0;
+   double      decode_mbytes_per_second = 0; ///< of decoding alone, on one thread
+};
+
+struct sync_summary {
+   uint32_t        start_block = 0;
+   uint32_t        end_block   = 0;
+   uint32_t        peers_completed = 0;
+   uint64_t        blocks = 0;
+   uint64_t        bytes  = 0;
+   double          blocks_per_second = 0; ///< of all peers together
+   double          mbytes_per_second = 0;
+   latency_summary first_block;           ///< from the sync request to the first block, per peer
+   latency_summary last_block;            ///< from the sync request to the last block, per peer
+};
+
+struct fanout_summary {
+   uint64_t        blocks       = 0; ///< blocks received by every peer
+   uint64_t        transactions = 0; ///< transaction messages received by all peers
+   latency_summary spread;           ///< from the first peer receiving a block to the last one
+   latency_summary block_latency;    ///< from the timestamp of a block to a peer receiving it
+};
+
+struct p2p_bench_result {
+   std::string                  mode;
+   uint32_t                     peers = 0;
+   uint32_t                     peers_connected = 0;
+   double                       seconds = 0;
+   std::vector<message_summary> messages;
+   latency_summary              round_trip; ///< of time_message probes, including the time they wait in the write queue of the node
+   std::optional<sync_summary>   sync;
+   std::optional<fanout_summary> fanout;
+};
+
+FC_REFLECT( latency_summary, (count)(mean_us)(p50_us)(p99_us)(max_us) )
+FC_REFLECT( message_summary, (type)(count)(bytes)(decode_ns_per_message)(decode_mbytes_per_second) )
+FC_REFLECT( sync_summary, (start_block)(end_block)(peers_completed)(blocks)(bytes)(blocks_per_second)(mbytes_per_second)
+                          (first_block)(last_block) )
+FC_REFLECT( fanout_summary, (blocks)(transactions)(spread)(block_latency) )
+FC_REFLECT( p2p_bench_result, (mode)(peers)(peers_connected)(seconds)(messages)(round_trip)(sync)(fanout) )
+
+latency_summary summarize( std::vector<int64_t> v ) {
+   latency_summary s;
+   if( v.empty() )
+      return s;
+   std::sort( v.begin(), v.end() );
+   s.count   = v.size();
+   s.mean_us = std::accumulate( v.begin(), v.end(), 0.0 ) / v.size();
+   s.p50_us  = v[(v.size() - 1) / 2];
+   s.p99_us  = v[std::min<size_t>( v.size() - 1, std::ceil( 0.99 * v.size() ) - 1 )];
+   s.max_us  = v.back();
+   return s;
+}
+
+struct bench_config {
+   enum class mode_t { sync, listen };
+
+   std::string          host;
+   std::string          port;
+   std::optional<chain_id_type> chain_id;
+   mode_t               mode = mode_t::sync;
+   uint32_t             peers = 1;
+   uint32_t             threads = 1;
+   uint32_t             start_block = 1;
+   uint32_t             end_block = 0;
+   uint32_t             duration_s = 60;
+   uint32_t             probe_interval_ms = 100;
+   uint16_t             protocol_version = default_protocol_version;
+};
+
+/**
+ * One synthetic peer: a connection to the node speaking its protocol, which decodes every message it receives
+ * and records when. Everything of a peer runs on its strand.
+ */
+class peer : public std::enable_shared_from_this<peer> {
+ public:
+   struct message_stats {
+      uint64_t count = 0;
+      uint64_t bytes = 0;
+      uint64_t decode_ns = 0;
+   };
+
+   peer( boost::asio::io_context& ctx, const bench_config& cfg, uint32_t index )
+   : cfg( cfg ), index( index ), strand( boost::asio::make_strand( ctx ) ), socket( strand ), resolver( strand ), probe_timer( strand ) {}
+
+   void start() {
+      resolver.async_resolve( cfg.host, cfg.port, [self = shared_from_this()]( const boost::system::error_code& ec, tcp::resolver::results_type endpoints ) {
+         if( self->failed( ec, "resolve" ) ) return;
+         boost::asio::async_connect( self->socket, endpoints, [self]( const boost::system::error_code& ec, const tcp::endpoint& ) {
+            if( self->failed( ec, "connect" ) ) return;
+            self->connected = true;
+            self->socket.set_option( tcp::no_delay( true ) );
+            self->send( self->make_handshake( 1, 0, {}, 0, {} ) );
+            self->read_header();
+            self->probe();
+         } );
+      } );
+   }
+
+   bool finished() const { return done.load(); }
+
+   const bench_config&                    cfg;
+   const uint32_t                         index;
+   std::atomic<bool>                      done{false};
+   bool                                   connected = false;
+   bool                                   completed = false; ///< received the whole sync range
+   std::array<message_stats, std::variant_size_v<net_message>> messages{};
+   std::vector<int64_t>                   round_trip_us;
+   std::vector<std::pair<block_id_type, int64_t>> block_arrivals; ///< time in ns of every block received
+   std::vector<int64_t>                   block_latency_us;
+   uint64_t                               transactions = 0;
+   uint64_t                               sync_blocks = 0;
+   uint64_t                               sync_bytes = 0;
+   int64_t                                sync_request_ns = 0;
+   int64_t                                first_block_ns = 0;
+   int64_t                                last_block_ns = 0;
+   uint32_t                               end_block = 0;
+
+ private:
+   bool failed( const boost::system::error_code& ec, const char* what ) {
+      if( !ec )
+         return false;
+      if( !done )
+         elog( "peer ${i} ${w} failed: ${e}", ("i", index)("w", what)("e", ec.message()) );
+      done = true;
+      return true;
+   }
+
+   handshake_message make_handshake( int16_t generation, uint32_t lib, const block_id_type& lib_id, uint32_t head, const block_id_type& head_id ) {
+      handshake_message hello;
+      hello.network_version = net_version_base + cfg.protocol_version;
+      hello.chain_id = *cfg.chain_id;
+      hello.node_id = fc::sha256::hash( "eosio-p2p-bench " + std::to_string( index ) + " " + std::to_string( now_ns() ) );
+      hello.time = now_ns();
+      hello.p2p_address = "p2p-bench-" + std::to_string( index ) + ":9876";
+      hello.last_irreversible_block_num = lib;
+      hello.last_irreversible_block_id = lib_id;
+      hello.head_num = head;
+      hello.head_id = head_id;
+      hello.os = "linux";
+      hello.agent = "\"eosio-p2p-bench\"";
+      hello.generation = generation;
+      return hello;
+   }
+
+   void send( const net_message& m ) {
+      const uint32_t payload_size = fc::raw::pack_size( m );
+      auto buf = std::make_shared<std::vector<char>>( payload_size + sizeof( payload_size ) );
+      memcpy( buf->data(), &payload_size, sizeof( payload_size ) );
+      fc::datastream<char*> ds( buf->data() + sizeof( payload_size ), payload_size );
+      fc::raw::pack( ds, m );
+      write_queue.push_back( std::move( buf ) );
+      if( write_queue.size() == 1 )
+         write_next();
+   }
+
+   void write_next() {
+      boost::asio::async_write( socket, boost::asio::buffer( *write_queue.front() ),
+                                [self = shared_from_this()]( const boost::system::error_code& ec, std::size_t ) {
+         if( self->failed( ec, "write" ) ) return;
+         self->write_queue.pop_front();
+         if( !self->write_queue.empty() )
+            self->write_next();
+      } );
+   }
+
+   // the round trip of a time_message includes the time the reply waits behind the other messages queued to the peer
+   void probe() {
+      if( done ) return;
+      time_message t;
+      t.xmt = now_ns();
+      send( t );
+      probe_timer.expires_after( std::chrono::milliseconds( cfg.probe_interval_ms ) );
+      probe_timer.async_wait( [self = shared_from_this()]( const boost::system::error_code& ec ) {
+         if( !ec ) self->probe();
+      } );
+   }
+
+   void read_header() {
+      boost::asio::async_read( socket, boost::asio::buffer( &payload_size, sizeof( payload_size ) ),
+                               [self = shared_from_this()]( const boost::system::error_code& ec, std::size_t ) {
+         if( self->failed( ec, "read" ) ) return;
+         if( self->payload_size == 0 || self->payload_size > max_message_size ) {
+            elog( "peer ${i} received a message of ${s} bytes", ("i", self->index)("s", self->payload_size) );
+            self->done = true;
+            return;
+         }
+         self->payload.resize( self->payload_size );
+         boost::asio::async_read( self->socket, boost::asio::buffer( self->payload ),
+                                  [self]( const boost::system::error_code& ec, std::size_t ) {
+            if( self->failed( ec, "read" ) ) return;
+            try {
+               self->handle_payload();
+            } catch( const fc::exception& e ) {
+               elog( "peer ${i} failed to handle a message: ${e}", ("i", self->index)("e", e.to_detail_string()) );
+               self->done = true;
+               return;
+            }
+            if( !self->done )
+               self->read_header();
+         } );
+      } );
+   }
+
+   net_message decode( const char* data, size_t size, message_stats*& stats ) {
+      net_message msg;
+      const auto start = std::chrono::steady_clock::now();
+      fc::datastream<const char*> ds( data, size );
+      fc::raw::unpack( ds, msg );
+      const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+      stats = &messages[msg.index()];
+      ++stats->count;
+      stats->bytes += size + sizeof( payload_size );
+      stats->decode_ns += ns;
+      return msg;
+   }
+
+   void handle_payload() {
+      const int64_t received_ns = now_ns();
+      message_stats* stats = nullptr;
+      net_message msg = decode( payload.data(), payload.size(), stats );
+
+      if( auto* c = std::get_if<compressed_block_message>( &msg ) ) {
+         // decompressing counts as decoding the compressed message, the block inside is counted as received too
+         const auto start = std::chrono::steady_clock::now();
+         std::vector<char> data;
+         bio::filtering_ostream decomp;
+         decomp.push( bio::zlib_decompressor() );
+         decomp.push( bio::back_inserter( data ) );
+         bio::write( decomp, c->data.data(), c->data.size() );
+         bio::close( decomp );
+         stats->decode_ns += std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+         message_stats* inner = nullptr;
+         msg = decode( data.data(), data.size(), inner );
+      }
+
+      std::visit( [&]( auto& m ) { handle( m, received_ns ); }, msg );
+   }
+
+   void handle( const handshake_message& m, int64_t ) {
+      if( cfg.mode == bench_config::mode_t::listen ) {
+         // claim the head of the node, so it broadcasts new blocks and transactions instead of syncing either way
+         send( make_handshake( 2, m.last_irreversible_block_num, m.last_irreversible_block_id, m.head_num, m.head_id ) );
+      } else if( sync_request_ns == 0 ) {
+         end_block = cfg.end_block ? cfg.end_block : m.head_num;
+         if( end_block < cfg.start_block ) {
+            elog( "peer ${i}: node head ${h} is before start-block ${s}", ("i", index)("h", m.head_num)("s", cfg.start_block) );
+            done = true;
+            return;
+         }
+         sync_request_ns = now_ns();
+         send( sync_request_message{ cfg.start_block, end_block } );
+      }
+   }
+
+   void handle( const go_away_message& m, int64_t ) {
+      elog( "peer ${i} received go_away: ${r}", ("i", index)("r", reason_str( m.reason )) );
+      done = true;
+   }
+
+   void handle( const time_message& m, int64_t received_ns ) {
+      if( m.org == 0 ) {
+         // a heartbeat of the node, answered like the net_plugin does
+         time_message reply;
+         reply.org = m.xmt;
+         reply.rec = received_ns;
+         reply.xmt = now_ns();
+         send( reply );
+      } else {
+         round_trip_us.push_back( (received_ns - m.org) / 1000 );
+      }
+   }
+
+   void handle( const signed_block_ptr& b, int64_t received_ns ) {
+      received_block( b->calculate_id(), b->block_num(), b->timestamp, received_ns );
+   }
+
+   void handle( const signed_block& b, int64_t received_ns ) {
+      received_block( b.calculate_id(), b.block_num(), b.timestamp, received_ns );
+   }
+
+   void handle( const signed_block_v0& b, int64_t received_ns ) {
+      received_block( b.calculate_id(), b.block_num(), b.timestamp, received_ns );
+   }
+
+   void handle( const compact_block_message& m, int64_t received_ns ) {
+      if( m.block )
+         handle( m.block, received_ns );
+   }
+
+   void handle( const packed_transaction_v0&, int64_t ) { ++transactions; }
+   void handle( const trx_message_v1&, int64_t ) { ++transactions; }
+
+   template<typename T>
+   void handle( const T&, int64_t ) {}
+
+   void received_block( const block_id_type& id, uint32_t num, block_timestamp_type timestamp, int64_t received_ns ) {
+      if( cfg.mode == bench_config::mode_t::listen ) {
+         block_arrivals.emplace_back( id, received_ns );
+         block_latency_us.push_back( received_ns / 1000 - timestamp.to_time_point().time_since_epoch().count() );
+         return;
+      }
+      if( num < cfg.start_block || num > end_block )
+         return;
+      if( first_block_ns == 0 )
+         first_block_ns = received_ns;
+      last_block_ns = received_ns;
+      ++sync_blocks;
+      sync_bytes += payload_size + sizeof( payload_size );
+      if( num == end_block ) {
+         completed = true;
+         done = true;
+      }
+   }
+
+   boost::asio::strand<boost::asio::io_context::executor_type> strand;
+   tcp::socket                                                  socket;
+   tcp::resolver                                                resolver;
+   boost::asio::steady_timer                                    probe_timer;
+   std::deque<std::shared_ptr<std::vector<char>>>               write_queue;
+   uint32_t                                                     payload_size = 0;
+   std::vector<char>                                            payload;
+};
+
+struct p2p_bench {
+   void set_program_options(options_description& cli);
+   void initialize(const variables_map& options);
+   p2p_bench_result run();
+
+   bench_config   cfg;
+   std::string    output_file;
+   bool           help = false;
+};
+
+void p2p_bench::set_program_options(options_description& cli) {
+   cli.add_options()
+         ("p2p-address", bpo::value<std::string>()->default_value("127.0.0.1:9876"),
+          "host:port of the p2p-listen-endpoint of the node to benchmark")
+         ("chain-id", bpo::value<std::string>(),
+          "chain id of the node, as reported by get_info; the node closes connections of other chains")
+         ("mode", bpo::value<std::string>()->default_value("sync"),
+          "\"sync\": every peer requests the blocks from start-block to end-block and the serving throughput is measured; "
+          "\"listen\": peers claim the head of the node and record the blocks and transactions it broadcasts to them")
+         ("peers,n", bpo::value<uint32_t>(&cfg.peers)->default_value(cfg.peers),
+          "number of synthetic peers connecting to the node; max-clients of the node should allow them")
+         ("threads", bpo::value<uint32_t>(&cfg.threads)->default_value(cfg.threads),
+          "threads running the peers, so decoding on the benchmark side does not limit what is measured")
+         ("start-block", bpo::value<uint32_t>(&cfg.start_block)->default_value(cfg.start_block),
+          "first block requested in sync mode")
+         ("end-block", bpo::value<uint32_t>(&cfg.end_block)->default_value(cfg.end_block),
+          "last block requested in sync mode, 0 for the head of the node when the peer connects")
+         ("duration", bpo::value<uint32_t>(&cfg.duration_s)->default_value(cfg.duration_s),
+          "seconds to run; sync mode stops earlier once every peer received its range")
+         ("probe-interval-ms", bpo::value<uint32_t>(&cfg.probe_interval_ms)->default_value(cfg.probe_interval_ms),
+          "interval between the time_message probes each peer sends to measure round trips")
+         ("protocol-version", bpo::value<uint16_t>(&cfg.protocol_version)->default_value(cfg.protocol_version),
+          "net protocol version advertised by the peers, which decides the block messages the node sends them")
+         ("output-file,o", bpo::value<std::string>(&output_file),
+          "also write the result as JSON to this file, for comparing runs")
+         ("help,h", bpo::bool_switch(&help)->default_value(false), "Print this help message and exit.")
+         ;
+}
+
+void p2p_bench::initialize(const variables_map& options) {
+   const auto& address = options.at("p2p-address").as<std::string>();
+   const auto colon = address.rfind(':');
+   EOS_ASSERT( colon != std::string::npos && colon > 0 && colon + 1 < address.size(), chain::plugin_config_exception,
+               "p2p-address ${a} is not host:port", ("a", address) );
+   cfg.host = address.substr(0, colon);
+   cfg.port = address.substr(colon + 1);
+
+   EOS_ASSERT( options.count("chain-id"), chain::plugin_config_exception, "chain-id is required" );
+   cfg.chain_id.emplace( options.at("chain-id").as<std::string>() );
+
+   const auto& mode = options.at("mode").as<std::string>();
+   if( mode == "sync" ) {
+      cfg.mode = bench_config::mode_t::sync;
+   } else {
+      EOS_ASSERT( mode == "listen", chain::plugin_config_exception, "Unknown mode ${m}", ("m", mode) );
+      cfg.mode = bench_config::mode_t::listen;
+   }
+   EOS_ASSERT( cfg.peers > 0 && cfg.threads > 0 && cfg.probe_interval_ms > 0, chain::plugin_config_exception,
+               "peers, threads and probe-interval-ms must be greater than 0" );
+   EOS_ASSERT( cfg.start_block > 0 && (cfg.end_block == 0 || cfg.start_block <= cfg.end_block), chain::plugin_config_exception,
+               "start-block must be greater than 0 and not after end-block" );
+}
+
+p2p_bench_result p2p_bench::run() {
+   boost::asio::io_context ctx;
+   auto work = boost::asio::make_work_guard( ctx );
+   std::vector<std::shared_ptr<peer>> peers;
+   for( uint32_t i = 0; i < cfg.peers; ++i ) {
+      peers.push_back( std::make_shared<peer>( ctx, cfg, i ) );
+      peers.back()->start();
+   }
+
+   const auto start = std::chrono::steady_clock::now();
+   std::vector<std::thread> threads;
+   for( uint32_t i = 0; i < cfg.threads; ++i )
+      threads.emplace_back( [&ctx]() { ctx.run(); } );
+
+   const auto deadline = start + std::chrono::seconds( cfg.duration_s );
+   while( !interrupted && std::chrono::steady_clock::now() < deadline ) {
+      if( cfg.mode == bench_config::mode_t::sync &&
+          std::all_of( peers.begin(), peers.end(), []( const auto& p ) { return p->finished(); } ) )
+         break;
+      std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+   }
+   // the state of the peers is only read once no handler runs anymore
+   ctx.stop();
+   for( auto& t : threads )
+      t.join();
+
+   p2p_bench_result result;
+   result.mode = cfg.mode == bench_config::mode_t::sync ? "sync" : "listen";
+   result.peers = cfg.peers;
+   result.seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+   std::array<peer::message_stats, std::variant_size_v<net_message>> messages{};
+   std::vector<int64_t> round_trip_us;
+   for( const auto& p : peers ) {
+      result.peers_connected += p->connected;
+      for( size_t i = 0; i < messages.size(); ++i ) {
+         messages[i].count     += p->messages[i].count;
+         messages[i].bytes     += p->messages[i].bytes;
+         messages[i].decode_ns += p->messages[i].decode_ns;
+      }
+      round_trip_us.insert( round_trip_us.end(), p->round_trip_us.begin(), p->round_trip_us.end() );
+   }
+   for( size_t i = 0; i < messages.size(); ++i ) {
+      const auto& m = messages[i];
+      if( m.count == 0 )
+         continue;
+      message_summary s{ message_names[i], m.count, m.bytes };
+      s.decode_ns_per_message = double( m.decode_ns ) / m.count;
+      if( m.decode_ns > 0 )
+         s.decode_mbytes_per_second = m.bytes / ( m.decode_ns / 1e9 ) / ( 1024 * 1024 );
+      result.messages.push_back( s );
+   }
+   result.round_trip = summarize( std::move( round_trip_us ) );
+
+   if( cfg.mode == bench_config::mode_t::sync ) {
+      sync_summary s{ cfg.start_block, cfg.end_block };
+      std::vector<int64_t> first_block_us, last_block_us;
+      int64_t first_request = std::numeric_limits<int64_t>::max(), last_block = 0;
+      for( const auto& p : peers ) {
+         s.end_block = std::max( s.end_block, p->end_block );
+         s.peers_completed += p->completed;
+         s.blocks += p->sync_blocks;
+         s.bytes  += p->sync_bytes;
+         if( p->sync_request_ns == 0 || p->first_block_ns == 0 )
+            continue;
+         first_request = std::min( first_request, p->sync_request_ns );
+         last_block    = std::max( last_block, p->last_block_ns );
+         first_block_us.push_back( (p->first_block_ns - p->sync_request_ns) / 1000 );
+         last_block_us.push_back( (p->last_block_ns - p->sync_request_ns) / 1000 );
+      }
+      if( last_block > first_request ) {
+         const double seconds = (last_block - first_request) / 1e9;
+         s.blocks_per_second = s.blocks / seconds;
+         s.mbytes_per_second = s.bytes / seconds / ( 1024 * 1024 );
+      }
+      s.first_block  = summarize( std::move( first_block_us ) );
+      s.last_block   = summarize( std::move( last_block_us ) );
+      result.sync = s;
+   } else {
+      fanout_summary f;
+      std::map<block_id_type, std::vector<int64_t>> arrivals;
+      std::vector<int64_t> block_latency_us;
+      for( const auto& p : peers ) {
+         f.transactions += p->transactions;
+         for( const auto& [id, ns] : p->block_arrivals )
+            arrivals[id].push_back( ns );
+         block_latency_us.insert( block_latency_us.end(), p->block_latency_us.begin(), p->block_latency_us.end() );
+      }
+      std::vector<int64_t> spread_us;
+      for( const auto& [id, times] : arrivals ) {
+         if( times.size() < result.peers_connected || times.empty() )
+            continue;
+         const auto [min, max] = std::minmax_element( times.begin(), times.end() );
+         spread_us.push_back( (*max - *min) / 1000 );
+      }
+      f.blocks        = spread_us.size();
+      f.spread        = summarize( std::move( spread_us ) );
+      f.block_latency = summarize( std::move( block_latency_us ) );
+      result.fanout = f;
+   }
+   return result;
+}
+
+int main(int argc, char** argv) {
+   options_description cli ("eosio-p2p-bench command line options");
+   try {
+      p2p_bench bench;
+      bench.set_program_options(cli);
+      variables_map vmap;
+      bpo::store(bpo::parse_command_line(argc, argv, cli), vmap);
+      bpo::notify(vmap);
+      if (bench.help) {
+         cli.print(std::cerr);
+         return 0;
+      }
+      bench.initialize(vmap);
+
+      // stop and report what was measured so far
+      std::signal(SIGINT, [](int) { interrupted = true; });
+      std::signal(SIGTERM, [](int) { interrupted = true; });
+
+      const auto result = bench.run();
+      std::cout << fc::json::to_pretty_string(result) << std::endl;
+      if (!bench.output_file.empty()) {
+         std::ofstream out(bench.output_file);
+         out << fc::json::to_pretty_string(result) << std::endl;
+         EOS_ASSERT(out.good(), chain::misc_exception, "Unable to write ${f}", ("f", bench.output_file));
+      }
+   } catch( const fc::exception& e ) {
+      elog( "${e}", ("e", e.to_detail_string()));
+      return -1;
+   } catch( const boost::exception& e ) {
+      elog("${e}", ("e",boost::diagnostic_information(e)));
+      return -1;
+   } catch( const std::exception& e ) {
+      elog("${e}", ("e",e.what()));
+      return -1;
+   } catch( ... ) {
+      elog("unknown exception");
+      return -1;
+   }
+
+   return 0;
+}
@@ -0,0 +1,341 @@
+#include <eosio/chain/block_log.hpp>
+#include <eosio/chain/block_apply_metrics.hpp>
+#include <eosio/chain/config.hpp>
+#include <eosio/chain/controller.hpp>
+#include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/genesis_state.hpp>
+#include <eosio/chain/protocol_feature_manager.hpp>
+#include <eosio/chain/snapshot.hpp>
+#include <eosio/chain/startup_metrics.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/variant.hpp>
+
+#include <boost/exception/diagnostic_information.hpp>
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <csignal>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <thread>
+
+using namespace eosio::chain;
+namespace bfs = boost::filesystem;
+namespace bpo = boost::program_options;
+using bpo::options_description;
+using bpo::variables_map;
+
+namespace {
+   std::atomic<bool> interrupted{false};
+}
+
+struct stage_summary {
+   std::string stage;
+   uint64_t    count   = 0;
+   double      mean_us = 0;
+   uint64_t    p50_us  = 0; ///< upper bound of the bucket of the median, 0 when in the unbounded bucket
+   uint64_t    p99_us  = 0;
+   uint64_t    total_us = 0;
+};
+
+struct replay_result {
+   uint32_t                   first_block  = 0;
+   uint32_t                   last_block   = 0;
+   uint64_t                   blocks       = 0;
+   uint64_t                   transactions = 0;
+   double                     seconds      = 0;
+   double                     blocks_per_second       = 0;
+   double                     transactions_per_second = 0;
+   std::vector<stage_summary> stages;
+   std::vector<startup_phase> startup; ///< phases of starting the controller from the snapshot or genesis state
+};
+
+FC_REFLECT( stage_summary, (stage)(count)(mean_us)(p50_us)(p99_us)(total_us) )
+FC_REFLECT( replay_result, (first_block)(last_block)(blocks)(transactions)(seconds)(blocks_per_second)
+                           (transactions_per_second)(stages)(startup) )
+
+struct replay_bench {
+   void set_program_options(options_description& cli);
+   void initialize(const variables_map& options);
+   replay_result run();
+
+   bfs::path                        blocks_dir;
+   std::optional<bfs::path>         snapshot;
+   bfs::path                        work_dir;
+   bfs::path                        output_file;
+   uint32_t                         first_block = 0;
+   uint32_t                         last_block = std::numeric_limits<uint32_t>::max();
+   uint32_t                         report_interval = 10'000;
+   bool                             startup_only = false;
+   controller::config               cfg;
+   bool                             help = false;
+};
+
+void replay_bench::set_program_options(options_description& cli) {
+   cli.add_options()
+         ("blocks-dir", bpo::value<bfs::path>()->default_value("blocks"),
+          "the location of the blocks directory holding the blocks.log to replay, which is only read")
+         ("snapshot", bpo::value<bfs::path>(),
+          "snapshot to start from; without it the replay starts from the genesis state of the block log")
+         ("work-dir", bpo::value<bfs::path>()->default_value("replay-bench"),
+          "directory of the state and the blocks written by the replay; its content is removed before starting")
+         ("first-block,f", bpo::value<uint32_t>(&first_block)->default_value(0),
+          "the first block to time; the blocks between the start point and it are applied without timing them. 0 starts right after the start point")
+         ("last-block,l", bpo::value<uint32_t>(&last_block)->default_value(std::numeric_limits<uint32_t>::max()),
+          "the last block to apply, by default the last block of the log")
+         ("report-interval", bpo::value<uint32_t>(&report_interval)->default_value(10'000),
+          "log the throughput every this many blocks, 0 to only report at the end")
+         ("startup-only", bpo::bool_switch(&startup_only)->default_value(false),
+          "only start the controller and report the time of each phase of its startup, without applying blocks")
+         ("output-file,o", bpo::value<bfs::path>(),
+          "also write the result as JSON to this file, for comparing runs")
+         ("wasm-runtime", bpo::value<wasm_interface::vm_type>()->value_name("runtime"),
+          "Override default WASM runtime (\"eos-vm-jit\", \"eos-vm\")")
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+         ("eos-vm-oc-enable", bpo::bool_switch(), "Enable EOS VM OC tier-up runtime")
+#endif
+         ("backing-store", bpo::value<std::string>()->default_value("chainbase"),
+          "The storage for the state, \"chainbase\" or \"rocksdb\"")
+         ("chain-threads", bpo::value<uint16_t>()->default_value(config::default_controller_thread_pool_size),
+          "Number of worker threads in the controller thread pool")
+         ("persistent-storage-num-threads", bpo::value<uint16_t>()->default_value(0),
+          "Number of rocksdb threads for flush and compaction, 0 to use the number of cores")
+         ("chain-state-db-size-mb", bpo::value<uint64_t>()->default_value(config::default_state_size / (1024 * 1024)),
+          "Maximum size (in MiB) of the chain state database")
+         ("help,h", bpo::bool_switch(&help)->default_value(false), "Print this help message and exit.")
+         ;
+}
+
+void replay_bench::initialize(const variables_map& options) {
+   blocks_dir = options.at("blocks-dir").as<bfs::path>();
+   EOS_ASSERT( block_log::exists( blocks_dir ), block_log_exception, "No block log in ${dir}", ("dir", blocks_dir.generic_string()) );
+   if( options.count("snapshot") )
+      snapshot = options.at("snapshot").as<bfs::path>();
+   work_dir = options.at("work-dir").as<bfs::path>();
+   if( options.count("output-file") )
+      output_file = options.at("output-file").as<bfs::path>();
+   EOS_ASSERT( first_block <= last_block, block_log_exception, "first-block ${f} is after last-block ${l}",
+               ("f", first_block)("l", last_block) );
+
+   cfg.blog.log_dir = work_dir / config::default_blocks_dir_name;
+   cfg.state_dir    = work_dir / config::default_state_dir_name;
+   cfg.state_size   = options.at("chain-state-db-size-mb").as<uint64_t>() * 1024 * 1024;
+   cfg.thread_pool_size = options.at("chain-threads").as<uint16_t>();
+   EOS_ASSERT( cfg.thread_pool_size > 0, plugin_config_exception, "chain-threads must be greater than 0" );
+   cfg.persistent_storage_num_threads = options.at("persistent-storage-num-threads").as<uint16_t>();
+   if( cfg.persistent_storage_num_threads == 0 )
+      cfg.persistent_storage_num_threads = std::thread::hardware_concurrency();
+
+   const auto& store = options.at("backing-store").as<std::string>();
+   if( store == "chainbase" ) {
+      cfg.backing_store = backing_store_type::CHAINBASE;
+   } else {
+      EOS_ASSERT( store == "rocksdb", plugin_config_exception, "Unknown backing-store ${s}", ("s", store) );
+      cfg.backing_store = backing_store_type::ROCKSDB;
+   }
+
+   if( options.count("wasm-runtime") )
+      cfg.wasm_runtime = options.at("wasm-runtime").as<wasm_interface::vm_type>();
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+   cfg.eosvmoc_tierup = options.at("eos-vm-oc-enable").as<bool>();
+#endif
+}
+
+/// every builtin protocol feature, so blocks can activate any of them
+protocol_feature_set make_protocol_feature_set() {
+   protocol_feature_set pfs;
+   std::map<builtin_protocol_feature_t, std::optional<digest_type>> visited;
+   std::function<digest_type(builtin_protocol_feature_t)> add_builtin = [&](builtin_protocol_feature_t codename) -> digest_type {
+      auto res = visited.emplace( codename, std::optional<digest_type>() );
+      if( !res.second ) {
+         EOS_ASSERT( res.first->second, protocol_feature_exception,
+                     "invariant failure: cycle found in builtin protocol feature dependencies" );
+         return *res.first->second;
+      }
+      auto f = protocol_feature_set::make_default_builtin_protocol_feature( codename, add_builtin );
+      res.first->second = pfs.add_feature( f ).feature_digest;
+      return *res.first->second;
+   };
+   for( const auto& p : builtin_protocol_feature_codenames )
+      add_builtin( p.first );
+   return pfs;
+}
+
+std::vector<stage_summary> summarize( const std::vector<block_stage_latency>& stages ) {
+   std::vector<stage_summary> result;
+   for( const auto& s : stages ) {
+      stage_summary sum{ s.stage };
+      sum.count    = std::accumulate( s.counts.begin(), s.counts.end(), uint64_t(0) );
+      sum.total_us = s.total_us;
+      if( sum.count == 0 ) {
+         result.push_back( sum );
+         continue;
+      }
+      sum.mean_us = double(s.total_us) / sum.count;
+      auto quantile = [&]( double q ) -> uint64_t {
+         const uint64_t rank = std::max<uint64_t>( 1, std::ceil( q * sum.count ) );
+         uint64_t       seen = 0;
+         for( size_t i = 0; i < s.bucket_bounds_us.size(); ++i ) {
+            seen += s.counts[i];
+            if( seen >= rank )
+               return s.bucket_bounds_us[i];
+         }
+         return 0;
+      };
+      sum.p50_us = quantile( 0.5 );
+      sum.p99_us = quantile( 0.99 );
+      result.push_back( sum );
+   }
+   return result;
+}
+
+replay_result replay_bench::run() {
+   bfs::remove_all( work_dir );
+   bfs::create_directories( cfg.blog.log_dir );
+
+   block_log source( { .log_dir = blocks_dir } );
+   EOS_ASSERT( source.head(), block_log_exception, "No blocks found in block log" );
+   last_block = std::min( last_block, source.head()->block_num() );
+
+   std::unique_ptr<controller> chain;
+   if( snapshot ) {
+      std::ifstream infile( snapshot->generic_string(), (std::ios::in | std::ios::binary) );
+      EOS_ASSERT( infile.is_open(), snapshot_exception, "Cannot open snapshot ${s}", ("s", snapshot->generic_string()) );
+      auto reader = std::make_shared<istream_snapshot_reader>( infile );
+      reader->validate();
+      const auto chain_id = controller::extract_chain_id( *reader );
+      EOS_ASSERT( chain_id == block_log::extract_chain_id( blocks_dir ), snapshot_exception,
+                  "The snapshot is of another chain than the block log" );
+      reader->return_to_header();
+      chain = std::make_unique<controller>( cfg, make_protocol_feature_set(), chain_id );
+      chain->add_indices();
+      chain->startup( [](){}, [](){ return interrupted.load(); }, reader );
+   } else {
+      const auto genesis = block_log::extract_genesis_state( blocks_dir );
+      EOS_ASSERT( genesis, block_log_exception, "The block log has no genesis state, start from a --snapshot" );
+      chain = std::make_unique<controller>( cfg, make_protocol_feature_set(), genesis->compute_chain_id() );
+      chain->add_indices();
+      chain->startup( [](){}, [](){ return interrupted.load(); }, *genesis );
+   }
+
+   if( startup_only ) {
+      replay_result result;
+      result.startup = chain->get_startup_metrics().snapshot();
+      return result;
+   }
+
+   const uint32_t start = chain->head_block_num() + 1;
+   EOS_ASSERT( start >= source.first_block_num(), block_log_exception,
+               "The block log starts at block ${b}, after the start point ${s}", ("b", source.first_block_num())("s", start - 1) );
+   first_block = std::max( first_block, start );
+   ilog( "Replaying blocks ${s} to ${l}, timing blocks ${f} to ${l}", ("s", start)("f", first_block)("l", last_block) );
+
+   // keep the next blocks prepared, as the net_plugin does, so their keys are recovered while the head is applied
+   std::deque<signed_block_ptr> read_ahead;
+   uint32_t next_to_read = start;
+   auto read_next = [&]() {
+      while( read_ahead.size() < std::max<uint16_t>( cfg.block_prepare_depth, 1 ) && next_to_read <= last_block ) {
+         signed_block_ptr b = source.read_signed_block_by_num( next_to_read++ );
+         EOS_ASSERT( b, block_log_exception, "Block ${n} is missing from the block log", ("n", next_to_read - 1) );
+         chain->prepare_block( b->calculate_id(), b );
+         read_ahead.push_back( std::move( b ) );
+      }
+   };
+
+   replay_result result{ first_block, last_block };
+   fc::time_point timing_start = fc::time_point::now();
+   fc::time_point interval_start = timing_start;
+   uint64_t interval_trxs = 0;
+   std::vector<block_stage_latency> untimed;
+
+   for( uint32_t n = start; n <= last_block && !interrupted; ++n ) {
+      read_next();
+      auto b = std::move( read_ahead.front() );
+      read_ahead.pop_front();
+      if( n == first_block ) {
+         // the stages are cumulative since startup, so remember what the untimed blocks added
+         untimed = chain->get_block_apply_metrics().snapshot();
+         timing_start = interval_start = fc::time_point::now();
+      }
+
+      auto bsf = chain->create_block_state_future( b->calculate_id(), b );
+      chain->push_block( bsf, forked_branch_callback{}, trx_meta_cache_lookup{} );
+
+      if( n < first_block )
+         continue;
+      ++result.blocks;
+      result.transactions += b->transactions.size();
+      interval_trxs += b->transactions.size();
+      if( report_interval && result.blocks % report_interval == 0 ) {
+         const auto now = fc::time_point::now();
+         const double s = (now - interval_start).count() / 1e6;
+         ilog( "Block ${n}: ${bps} blocks/s, ${tps} transactions/s",
+               ("n", n)("bps", uint64_t(report_interval / s))("tps", uint64_t(interval_trxs / s)) );
+         interval_start = now;
+         interval_trxs = 0;
+      }
+   }
+
+   result.seconds = (fc::time_point::now() - timing_start).count() / 1e6;
+   if( result.seconds > 0 ) {
+      result.blocks_per_second       = result.blocks / result.seconds;
+      result.transactions_per_second = result.transactions / result.seconds;
+   }
+   auto stages = chain->get_block_apply_metrics().snapshot();
+   for( size_t i = 0; i < untimed.size() && i < stages.size(); ++i ) {
+      for( size_t j = 0; j < stages[i].counts.size(); ++j )
+         stages[i].counts[j] -= untimed[i].counts[j];
+      stages[i].total_us -= untimed[i].total_us;
+   }
+   result.stages = summarize( stages );
+   result.startup = chain->get_startup_metrics().snapshot();
+   return result;
+}
+
+int main(int argc, char** argv) {
+   options_description cli ("eosio-replay-bench command line options");
+   try {
+      replay_bench bench;
+      bench.set_program_options(cli);
+      variables_map vmap;
+      bpo::store(bpo::parse_command_line(argc, argv, cli), vmap);
+      bpo::notify(vmap);
+      if (bench.help) {
+         cli.print(std::cerr);
+         return 0;
+      }
+      bench.initialize(vmap);
+
+      // stop at the next block and report what was replayed so far
+      std::signal(SIGINT, [](int) { interrupted = true; });
+      std::signal(SIGTERM, [](int) { interrupted = true; });
+
+      const auto result = bench.run();
+      std::cout << fc::json::to_pretty_string(result) << std::endl;
+      if (!bench.output_file.empty()) {
+         std::ofstream out(bench.output_file.generic_string());
+         out << fc::json::to_pretty_string(result) << std::endl;
+         EOS_ASSERT(out.good(), misc_exception, "Unable to write ${f}", ("f", bench.output_file.generic_string()));
+      }
+   } catch( const fc::exception& e ) {
+      elog( "${e}", ("e", e.to_detail_string()));
+      return -1;
+   } catch( const boost::exception& e ) {
+      elog("${e}", ("e",boost::diagnostic_information(e)));
+      return -1;
+   } catch( const std::exception& e ) {
+      elog("${e}", ("e",e.what()));
+      return -1;
+   } catch( ... ) {
+      elog("unknown exception");
+      return -1;
+   }
+
+   return 0;
+}
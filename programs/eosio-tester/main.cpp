@@ -20,6 +20,7 @@
 #include <eosio/vm/backend.hpp>
 
 #include <chrono>
+#include <sstream>
 #include <stdio.h>
 
 using namespace eosio::literals;
@@ -193,14 +194,8 @@ struct test_chain {
    test_chain(const char* snapshot) {
       eosio::chain::genesis_state genesis;
       genesis.initial_timestamp = fc::time_point::from_iso_string("2020-01-01T00:00:00.000");
-      cfg                       = std::make_unique<eosio::chain::controller::config>();
-      cfg->blog.log_dir         = dir.path() / "blocks";
-      cfg->state_dir            = dir.path() / "state";
-      cfg->contracts_console    = true;
-      cfg->wasm_runtime         = eosio::chain::wasm_interface::vm_type::eos_vm_jit;
-
-      std::optional<std::ifstream>                           snapshot_file;
-      std::shared_ptr<eosio::chain::istream_snapshot_reader> snapshot_reader;
+      configure();
+
       if (snapshot && *snapshot) {
          std::optional<eosio::chain::chain_id_type> chain_id;
          {
@@ -211,14 +206,43 @@ struct test_chain {
             tmp_reader.validate();
             chain_id = eosio::chain::controller::extract_chain_id(tmp_reader);
          }
-         snapshot_file.emplace(snapshot, std::ios::in | std::ios::binary);
-         snapshot_reader = std::make_shared<eosio::chain::istream_snapshot_reader>(*snapshot_file);
-         control         = std::make_unique<eosio::chain::controller>(*cfg, make_protocol_feature_set(), *chain_id);
+         std::ifstream snapshot_file(snapshot, std::ios::in | std::ios::binary);
+         open(std::make_shared<eosio::chain::istream_snapshot_reader>(snapshot_file), *chain_id, genesis);
       } else {
-         control = std::make_unique<eosio::chain::controller>(*cfg, make_protocol_feature_set(),
-                                                              genesis.compute_chain_id());
+         open(nullptr, genesis.compute_chain_id(), genesis);
       }
+   }
 
+   // Starts from the state of source at its head block, after finishing the pending block of source. The state is
+   // copied through an in-memory snapshot into a heap mode database, so branching a scenario from a prepared chain
+   // costs neither a replay nor a copy of its database file.
+   explicit test_chain(test_chain& source) {
+      source.finish_block();
+      std::ostringstream snapshot;
+      auto writer = std::make_shared<eosio::chain::ostream_snapshot_writer>(snapshot);
+      source.control->write_snapshot(writer);
+      writer->finalize();
+
+      configure();
+      cfg->db_map_mode = chainbase::pinnable_mapped_file::map_mode::heap;
+      std::istringstream in(snapshot.str());
+      open(std::make_shared<eosio::chain::istream_snapshot_reader>(in), source.control->get_chain_id(), {});
+      prev_block = source.prev_block;
+      history    = source.history;
+   }
+
+   void configure() {
+      cfg                    = std::make_unique<eosio::chain::controller::config>();
+      cfg->blog.log_dir      = dir.path() / "blocks";
+      cfg->state_dir         = dir.path() / "state";
+      cfg->contracts_console = true;
+      cfg->wasm_runtime      = eosio::chain::wasm_interface::vm_type::eos_vm_jit;
+   }
+
+   // starts from snapshot_reader if set, from genesis otherwise
+   void open(const std::shared_ptr<eosio::chain::istream_snapshot_reader>& snapshot_reader,
+             const eosio::chain::chain_id_type& chain_id, const eosio::chain::genesis_state& genesis) {
+      control = std::make_unique<eosio::chain::controller>(*cfg, make_protocol_feature_set(), chain_id);
       control->add_indices();
 
       applied_transaction_connection.emplace(control->applied_transaction.connect(
@@ -738,6 +762,12 @@ struct callbacks {
       return state.chains.size() - 1;
    }
 
+   uint32_t clone_chain(uint32_t chain) {
+      auto& source = assert_chain(chain);
+      state.chains.push_back(std::make_unique<test_chain>(source));
+      return state.chains.size() - 1;
+   }
+
    void destroy_chain(uint32_t chain) {
       assert_chain(chain, false);
       if (state.selected_chain_index && *state.selected_chain_index == chain)
@@ -1174,6 +1204,7 @@ void register_callbacks() {
    rhf_t::add<&callbacks::read_whole_file>("env", "read_whole_file");
    rhf_t::add<&callbacks::execute>("env", "execute");
    rhf_t::add<&callbacks::create_chain>("env", "create_chain");
+   rhf_t::add<&callbacks::clone_chain>("env", "clone_chain");
    rhf_t::add<&callbacks::destroy_chain>("env", "destroy_chain");
    rhf_t::add<&callbacks::shutdown_chain>("env", "shutdown_chain");
    rhf_t::add<&callbacks::get_chain_path>("env", "get_chain_path");
@@ -6,6 +6,7 @@
 #include <eosio/producer_plugin/producer_plugin.hpp>
 #include <eosio/resource_monitor_plugin/resource_monitor_plugin.hpp>
 #include <eosio/version/version.hpp>
+#include <eosio/chain/startup_metrics.hpp>
 
 #include <fc/log/logger.hpp>
 #include <fc/log/logger_config.hpp>
@@ -119,6 +120,7 @@ int main(int argc, char** argv)
          .default_unix_socket_path = "",
          .default_http_port = 8888
       });
+      const auto initialize_start = fc::time_point::now();
       if(!app().initialize<chain_plugin, net_plugin, producer_plugin, resource_monitor_plugin>(argc, argv)) {
          const auto& opts = app().get_options();
          if( opts.count("help") || opts.count("version") || opts.count("full-version") || opts.count("print-default-config") ) {
@@ -132,13 +134,18 @@ int main(int argc, char** argv)
          elog("resource_monitor_plugin failed to initialize");
          return INITIALIZE_FAIL;
       }
+      chain::startup_metrics::shared().record( "nodeos.initialize", fc::time_point::now() - initialize_start );
       initialize_logging();
       ilog( "${name} version ${ver} ${fv}",
             ("name", nodeos::config::node_executable_name)("ver", app().version_string())
             ("fv", app().version_string() == app().full_version_string() ? "" : app().full_version_string()) );
       ilog("${name} using configuration file ${c}", ("name", nodeos::config::node_executable_name)("c", app().full_config_file_path().string()));
       ilog("${name} data directory is ${d}", ("name", nodeos::config::node_executable_name)("d", app().data_dir().string()));
-      app().startup();
+      {
+         chain::startup_metrics::scoped_timer t( "nodeos.startup" );
+         app().startup();
+      }
+      chain::startup_metrics::shared().log();
       app().set_thread_priority_max();
       app().exec();
    } catch( const extract_genesis_state_exception& e ) {
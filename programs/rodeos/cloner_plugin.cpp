@@ -9,10 +9,14 @@
 #include <fc/log/trace.hpp>
 
 #include <boost/asio/connect.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 
+#include <condition_variable>
+#include <mutex>
+
 namespace b1 {
 
 using namespace appbase;
@@ -37,11 +41,58 @@ struct cloner_session;
 struct cloner_config : ship_client::connection_config {
    uint32_t    skip_to     = 0;
    uint32_t    stop_before = 0;
+   uint32_t    decode_threads = 1;
+   bool        bulk_load      = false;
+   uint32_t    publish_queue  = 0;
    bool        exit_on_filter_wasm_error = false;
    eosio::name filter_name = {}; // todo: remove
    std::string filter_wasm = {}; // todo: remove
 };
 
+// Passes the filter output to the streamer on its own thread, in the order the filter produced it, so a slow
+// streamer doesn't hold up the filter of the next block. push() blocks while max_pending messages are queued.
+class filter_publisher {
+ public:
+   filter_publisher(std::function<void(const char* data, uint64_t data_size)> streamer, uint32_t max_pending)
+       : streamer(std::move(streamer)), max_pending(max_pending) {}
+
+   ~filter_publisher() {
+      std::unique_lock<std::mutex> lock{ mutex };
+      cv.wait(lock, [&] { return pending == 0; });
+      lock.unlock();
+      pool.stop();
+   }
+
+   void push(const char* data, uint64_t data_size) {
+      std::unique_lock<std::mutex> lock{ mutex };
+      cv.wait(lock, [&] { return pending < max_pending; });
+      if (error)
+         std::rethrow_exception(error);
+      ++pending;
+      lock.unlock();
+      asio::post(pool.get_executor(), [this, msg = std::vector<char>(data, data + data_size)] {
+         std::exception_ptr e;
+         try {
+            streamer(msg.data(), msg.size());
+         } catch (...) { e = std::current_exception(); }
+         std::lock_guard<std::mutex> lock{ mutex };
+         if (e && !error)
+            error = e;
+         --pending;
+         cv.notify_all();
+      });
+   }
+
+ private:
+   std::function<void(const char* data, uint64_t data_size)> streamer;
+   const uint32_t                                            max_pending;
+   std::mutex                                                mutex;
+   std::condition_variable                                   cv;
+   uint32_t                                                  pending = 0;
+   std::exception_ptr                                        error;  // first streamer failure, rethrown by push()
+   eosio::chain::named_thread_pool                           pool{ "publish", 1 };
+};
+
 struct cloner_plugin_impl : std::enable_shared_from_this<cloner_plugin_impl> {
    std::shared_ptr<cloner_config>                                           config = std::make_shared<cloner_config>();
    std::shared_ptr<cloner_session>                                          session;
@@ -74,15 +125,26 @@ struct cloner_session : ship_client::connection_callbacks, std::enable_shared_fr
    std::shared_ptr<ship_client::connection> connection;
    bool                                     reported_block = false;
    std::unique_ptr<rodeos_filter>           filter         = {}; // todo: remove
+   std::unique_ptr<filter_publisher>        publisher      = {}; // only if config->publish_queue > 0
 
    cloner_session(cloner_plugin_impl* my) : my(my), config(my->config) {
       // todo: remove
       if (!config->filter_wasm.empty())
          filter = std::make_unique<rodeos_filter>(config->filter_name, config->filter_wasm);
+      if (filter && my->streamer && config->publish_queue)
+         publisher = std::make_unique<filter_publisher>(my->streamer, config->publish_queue);
    }
 
    void connect(asio::io_context& ioc) {
+      if (db->is_secondary())
+         throw std::runtime_error("cloner_plugin can not write to a secondary database (rdb-secondary)");
       rodeos_snapshot.emplace(partition, true);
+      rodeos_snapshot->set_decode_threads(config->decode_threads);
+      if (config->bulk_load) {
+         auto dir = app().data_dir() / "rodeos-ingest";
+         boost::filesystem::create_directories(dir);
+         rodeos_snapshot->bulk_load_dir = dir.string();
+      }
 
       ilog("cloner database status:");
       ilog("    revisions:    ${f} - ${r}",
@@ -168,7 +230,9 @@ struct cloner_session : ship_client::connection_callbacks, std::enable_shared_fr
 
       if (filter) {
          filter->process(*rodeos_snapshot, result, bin, [&](const char* data, uint64_t data_size) {
-            if (my->streamer) {
+            if (publisher) {
+               publisher->push(data, data_size);
+            } else if (my->streamer) {
                my->streamer(data, data_size);
             }
          });
@@ -223,6 +287,15 @@ void cloner_plugin::set_program_options(options_description& cli, options_descri
       "State-history endpoint to connect to (nodeos)");
    clop("clone-skip-to,k", bpo::value<uint32_t>(), "Skip blocks before [arg]");
    clop("clone-stop,x", bpo::value<uint32_t>(), "Stop before block [arg]");
+   op("clone-decode-threads", bpo::value<uint32_t>()->default_value(1),
+      "Number of threads decoding the rows of the table deltas. The rows are still written in order on the cloner "
+      "thread. Recommend 4 or more for the initial sync of large chains.");
+   op("clone-bulk-load", bpo::bool_switch()->default_value(false),
+      "Write the changes of irreversible blocks to sorted SST files which RocksDB ingests directly, instead of through "
+      "its memtable. Speeds up the initial sync; reversible blocks are written as usual.");
+   op("clone-filter-publish-queue", bpo::value<uint32_t>()->default_value(0),
+      "Maximum number of filter messages queued for the streamer, which then publishes them on its own thread in "
+      "order while the filter moves on to the next block. 0 publishes on the cloner thread.");
    op("clone-exit-on-filter-wasm-error", bpo::bool_switch()->default_value(false),
       "Shutdown application if filter wasm throws an exception");
    op("telemetry-url", bpo::value<std::string>(),
@@ -249,6 +322,11 @@ void cloner_plugin::plugin_initialize(const variables_map& options) {
       my->config->skip_to     = options.count("clone-skip-to") ? options["clone-skip-to"].as<uint32_t>() : 0;
       my->config->stop_before = options.count("clone-stop") ? options["clone-stop"].as<uint32_t>() : 0;
       my->config->exit_on_filter_wasm_error = options["clone-exit-on-filter-wasm-error"].as<bool>();
+      my->config->decode_threads = options["clone-decode-threads"].as<uint32_t>();
+      my->config->bulk_load      = options["clone-bulk-load"].as<bool>();
+      my->config->publish_queue  = options["clone-filter-publish-queue"].as<uint32_t>();
+      if (my->config->decode_threads == 0)
+         throw std::runtime_error("clone-decode-threads must be at least 1");
       if (options.count("filter-name") && options.count("filter-wasm")) {
          my->config->filter_name = eosio::name{ options["filter-name"].as<std::string>() };
          my->config->filter_wasm = options["filter-wasm"].as<std::string>();
@@ -1,5 +1,6 @@
 #include "rocksdb_plugin.hpp"
 
+#include <boost/asio/steady_timer.hpp>
 #include <boost/filesystem.hpp>
 #include <fc/exception/exception.hpp>
 
@@ -12,8 +13,25 @@ struct rocksdb_plugin_impl {
    boost::filesystem::path             db_path        = {};
    std::optional<uint32_t>             threads        = {};
    std::optional<uint32_t>             max_open_files = {};
+   std::optional<uint32_t>             prefix_bloom   = {};
+   boost::filesystem::path             secondary_path = {}; // empty unless a secondary instance was requested
+   uint32_t                            catch_up_ms    = 0;
    std::shared_ptr<chain_kv::database> database       = {};
    std::mutex                          mutex          = {};
+   std::optional<boost::asio::steady_timer> catch_up_timer = {};
+
+   void schedule_catch_up() {
+      catch_up_timer->expires_after(std::chrono::milliseconds(catch_up_ms));
+      catch_up_timer->async_wait([this](const boost::system::error_code& ec) {
+         if (ec)
+            return;
+         try {
+            database->catch_up();
+         }
+         FC_LOG_AND_DROP()
+         schedule_catch_up();
+      });
+   }
 };
 
 static abstract_plugin& _rocksdb_plugin = app().register_plugin<rocksdb_plugin>();
@@ -32,6 +50,16 @@ void rocksdb_plugin::set_program_options(options_description& cli, options_descr
    op("rdb-max-files", bpo::value<uint32_t>(),
       "RocksDB limit max number of open files (default unlimited). This should be smaller than 'ulimit -n #'. "
       "# should be a very large number for full-history nodes.");
+   op("rdb-prefix-bloom", bpo::value<uint32_t>(),
+      "Length of the key prefix kept in RocksDB bloom filters in the SST files and the memtable, so lookups skip the "
+      "blocks which can't have their key. Recommend 16, which covers the database id and the contract of the "
+      "rodeos keys. Only applies to SST files written after it is set (default disabled).");
+   op("rdb-secondary", bpo::value<bfs::path>(),
+      "Open rdb-database as a read only secondary instance which follows the rodeos process that writes to it, so "
+      "several wasm_ql processes can serve queries from one cloner. [arg] is the directory for the secondary's own "
+      "files (absolute path or relative to application data dir). Can not be used with cloner_plugin.");
+   op("rdb-catch-up-ms", bpo::value<uint32_t>()->default_value(500),
+      "How often a secondary instance applies the changes of the primary (ms)");
 }
 
 void rocksdb_plugin::plugin_initialize(const variables_map& options) {
@@ -45,21 +73,51 @@ void rocksdb_plugin::plugin_initialize(const variables_map& options) {
          my->threads = options["rdb-threads"].as<uint32_t>();
       if (!options["rdb-max-files"].empty())
          my->max_open_files = options["rdb-max-files"].as<uint32_t>();
+      if (!options["rdb-prefix-bloom"].empty()) {
+         my->prefix_bloom = options["rdb-prefix-bloom"].as<uint32_t>();
+         if (!*my->prefix_bloom)
+            throw std::runtime_error("rdb-prefix-bloom must be at least 1");
+      }
+      if (!options["rdb-secondary"].empty()) {
+         auto secondary_path = options["rdb-secondary"].as<bfs::path>();
+         my->secondary_path  = secondary_path.is_relative() ? app().data_dir() / secondary_path : secondary_path;
+         my->catch_up_ms     = options["rdb-catch-up-ms"].as<uint32_t>();
+         if (!my->catch_up_ms)
+            throw std::runtime_error("rdb-catch-up-ms must be at least 1");
+      }
    }
    FC_LOG_AND_RETHROW()
 }
 
-void rocksdb_plugin::plugin_startup() {}
+void rocksdb_plugin::plugin_startup() {
+   if (my->secondary_path.empty())
+      return;
+   get_db();
+   my->catch_up_timer.emplace(app().get_io_service());
+   my->schedule_catch_up();
+}
 
-void rocksdb_plugin::plugin_shutdown() {}
+void rocksdb_plugin::plugin_shutdown() {
+   if (my->catch_up_timer)
+      my->catch_up_timer->cancel();
+}
 
 std::shared_ptr<chain_kv::database> rocksdb_plugin::get_db() {
    std::lock_guard<std::mutex> lock(my->mutex);
    if (!my->database) {
+      if (!my->secondary_path.empty()) {
+         ilog("rodeos database is ${d}, opened as a secondary in ${s}",
+              ("d", my->db_path.string())("s", my->secondary_path.string()));
+         bfs::create_directories(my->secondary_path);
+         my->database =
+               std::make_shared<chain_kv::database>(my->db_path.c_str(), my->secondary_path.c_str(), my->prefix_bloom);
+         return my->database;
+      }
       ilog("rodeos database is ${d}", ("d", my->db_path.string()));
       if (!bfs::exists(my->db_path.parent_path()))
          bfs::create_directories(my->db_path.parent_path());
-      my->database = std::make_shared<chain_kv::database>(my->db_path.c_str(), true, my->threads, my->max_open_files);
+      my->database = std::make_shared<chain_kv::database>(my->db_path.c_str(), true, my->threads, my->max_open_files,
+                                                          my->prefix_bloom);
    }
    return my->database;
 }
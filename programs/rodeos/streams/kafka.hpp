@@ -0,0 +1,121 @@
+#pragma once
+
+#include "stream.hpp"
+#include <fc/log/logger.hpp>
+#include <librdkafka/rdkafka.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace b1 {
+
+// Produces the stream messages to a Kafka topic. The routing key is the message key, so the messages of one route
+// land in one partition and keep their order there. Delivery is idempotent; librdkafka batches the messages in the
+// background for up to linger.ms.
+class kafka : public stream_handler {
+   std::vector<eosio::name> routes_;
+   std::string              topic_name_;
+   rd_kafka_t*              producer_ = nullptr;
+   rd_kafka_topic_t*        topic_    = nullptr;
+   std::atomic<bool>        done_{ false };
+   std::thread              poll_thread_; // serves the delivery reports
+
+ public:
+   kafka(std::vector<eosio::name> routes, const std::string& brokers, std::string topic_name, uint32_t linger_ms)
+       : routes_(std::move(routes)), topic_name_(std::move(topic_name)) {
+      ilog("Connecting to Kafka brokers ${b} - Topic: ${t}...", ("b", brokers)("t", topic_name_));
+
+      rd_kafka_conf_t* conf = rd_kafka_conf_new();
+      set(conf, "bootstrap.servers", brokers);
+      set(conf, "enable.idempotence", "true");
+      set(conf, "linger.ms", std::to_string(linger_ms));
+      rd_kafka_conf_set_dr_msg_cb(conf, &on_delivery);
+
+      char errstr[512];
+      producer_ = rd_kafka_new(RD_KAFKA_PRODUCER, conf, errstr, sizeof(errstr));
+      if (!producer_) {
+         rd_kafka_conf_destroy(conf);
+         throw std::runtime_error("Kafka producer creation failed: " + std::string(errstr));
+      }
+      topic_ = rd_kafka_topic_new(producer_, topic_name_.c_str(), nullptr);
+      if (!topic_) {
+         rd_kafka_destroy(producer_);
+         throw std::runtime_error("Kafka topic " + topic_name_ +
+                                  " creation failed: " + rd_kafka_err2str(rd_kafka_last_error()));
+      }
+      poll_thread_ = std::thread([this] {
+         while (!done_) rd_kafka_poll(producer_, 100);
+      });
+   }
+
+   kafka(const kafka&) = delete;
+   kafka& operator=(const kafka&) = delete;
+
+   ~kafka() override {
+      done_ = true;
+      poll_thread_.join();
+      if (rd_kafka_flush(producer_, 10000) != RD_KAFKA_RESP_ERR_NO_ERROR)
+         wlog("Kafka topic ${t}: ${n} messages were not delivered", ("t", topic_name_)("n", rd_kafka_outq_len(producer_)));
+      rd_kafka_topic_destroy(topic_);
+      rd_kafka_destroy(producer_);
+   }
+
+   const std::vector<eosio::name>& get_routes() const override { return routes_; }
+
+   void publish(const char* data, uint64_t data_size, const eosio::name& routing_key) override {
+      auto key = routing_key.to_string();
+      while (rd_kafka_produce(topic_, RD_KAFKA_PARTITION_UA, RD_KAFKA_MSG_F_COPY, const_cast<char*>(data), data_size,
+                              key.data(), key.size(), nullptr) == -1) {
+         auto err = rd_kafka_last_error();
+         if (err != RD_KAFKA_RESP_ERR__QUEUE_FULL)
+            throw std::runtime_error("Kafka produce to " + topic_name_ + " failed: " + rd_kafka_err2str(err));
+         // the local queue is full; wait for deliveries
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+   }
+
+ private:
+   static void set(rd_kafka_conf_t* conf, const char* name, const std::string& value) {
+      char errstr[512];
+      if (rd_kafka_conf_set(conf, name, value.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
+         rd_kafka_conf_destroy(conf);
+         throw std::runtime_error("Kafka configuration " + std::string(name) + " failed: " + errstr);
+      }
+   }
+
+   static void on_delivery(rd_kafka_t*, const rd_kafka_message_t* message, void*) {
+      if (message->err)
+         elog("Kafka delivery to ${t} failed: ${e}",
+              ("t", rd_kafka_topic_name(message->rkt))("e", rd_kafka_err2str(message->err)));
+   }
+};
+
+// Parse the argument of a '--stream-kafka' option, BROKERS[/TOPIC[/ROUTES]],
+// where BROKERS is a comma separated list of host:port. The topic defaults
+// to 'stream.default'.
+inline void initialize_kafkas(std::vector<std::unique_ptr<stream_handler>>& streams,
+                              const std::vector<std::string>& kafkas, uint32_t linger_ms) {
+   for (const std::string& arg : kafkas) {
+      std::string              brokers = arg;
+      std::string              topic;
+      std::vector<eosio::name> routes;
+
+      const auto first_slash_pos = arg.find('/');
+      if (first_slash_pos != std::string::npos) {
+         brokers                     = arg.substr(0, first_slash_pos);
+         const auto second_slash_pos = arg.find('/', first_slash_pos + 1);
+         topic                       = arg.substr(first_slash_pos + 1, second_slash_pos == std::string::npos
+                                                                       ? std::string::npos
+                                                                       : second_slash_pos - (first_slash_pos + 1));
+         if (second_slash_pos != std::string::npos)
+            routes = extract_routes(arg.substr(second_slash_pos + 1));
+      }
+      if (topic.empty())
+         topic = "stream.default";
+
+      streams.emplace_back(std::make_unique<kafka>(std::move(routes), brokers, std::move(topic), linger_ms));
+   }
+}
+
+} // namespace b1
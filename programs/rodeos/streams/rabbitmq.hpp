@@ -5,60 +5,178 @@
 #include "amqpcpp/linux_tcp.h"
 #include "stream.hpp"
 #include <fc/log/logger.hpp>
+#include <fc/log/logger_config.hpp>
+#include <condition_variable>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
 
 namespace b1 {
 
 class rabbitmq_handler;
 
 class rabbitmq : public stream_handler {
+   // the connection runs on its own thread: publish() may block waiting for confirms on any other thread,
+   // including the main thread the cloner runs on
+   using work_guard = boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+   boost::asio::io_context              io_context_;
+   std::optional<work_guard>            work_;
+   std::thread                          thread_;
    std::shared_ptr<rabbitmq_handler>    handler_;
    std::shared_ptr<AMQP::TcpConnection> connection_;
    std::shared_ptr<AMQP::TcpChannel>    channel_;
    std::string                          exchangeName_;
    std::string                          queueName_;
    std::vector<eosio::name>             routes_;
+   const uint32_t                       max_in_flight_; // 0 disables publisher confirms
+
+   struct message {
+      std::string       routing_key;
+      std::vector<char> data;
+   };
+
+   std::mutex                  mutex_;
+   std::condition_variable     cv_;
+   std::vector<message>        queued_;           // waiting to be sent on the connection thread
+   size_t                      in_flight_   = 0;  // queued or not yet confirmed
+   std::exception_ptr          error_;            // first failure of the connection, rethrown by publish()
+   std::map<uint64_t, message> unconfirmed_ = {}; // by delivery tag; connection thread only
+   uint64_t                    next_tag_    = 1;  // connection thread only
 
  public:
-   rabbitmq(boost::asio::io_service& io_service, std::vector<eosio::name> routes, const AMQP::Address& address,
-            std::string queue_name)
-       : queueName_(std::move(queue_name)), routes_(std::move(routes)) {
+   rabbitmq(std::vector<eosio::name> routes, const AMQP::Address& address, std::string queue_name,
+            uint32_t max_in_flight)
+       : queueName_(std::move(queue_name)), routes_(std::move(routes)), max_in_flight_(max_in_flight) {
       ilog("Connecting to RabbitMQ address ${a} - Queue: ${q}...", ("a", std::string(address))("q", queueName_));
 
-      init(io_service, address);
+      init(address);
 
       exchangeName_ = DEFAULT_EXCHANGE;
 
       declare_queue();
+      start();
    }
 
-   rabbitmq(boost::asio::io_service& io_service, std::vector<eosio::name> routes, const AMQP::Address& address,
-            std::string exchange_name, std::string exchange_type)
-       : exchangeName_(std::move(exchange_name)), routes_(std::move(routes)) {
+   rabbitmq(std::vector<eosio::name> routes, const AMQP::Address& address, std::string exchange_name,
+            std::string exchange_type, uint32_t max_in_flight)
+       : exchangeName_(std::move(exchange_name)), routes_(std::move(routes)), max_in_flight_(max_in_flight) {
       ilog("Connecting to RabbitMQ address ${a} - Exchange: ${e}...", ("a", std::string(address))("e", exchangeName_));
 
-      init(io_service, address);
+      init(address);
 
       declare_exchange(exchange_type);
+      start();
+   }
+
+   ~rabbitmq() override {
+      work_.reset();
+      io_context_.stop();
+      if (thread_.joinable())
+         thread_.join();
    }
 
    const std::vector<eosio::name>& get_routes() const override { return routes_; }
 
+   // May be called from any thread. The messages are sent in order, in batches, on the connection thread. With
+   // publisher confirms this blocks while max_in_flight messages are unconfirmed. A failure of the connection is
+   // rethrown.
    void publish(const char* data, uint64_t data_size, const eosio::name& routing_key) override {
-      if (DEFAULT_EXCHANGE == exchangeName_) {
-         channel_->publish(exchangeName_, queueName_, data, data_size, 0);
-      } else {
-         channel_->publish(exchangeName_, routing_key.to_string(), data, data_size, 0);
-      }
+      message msg{ DEFAULT_EXCHANGE == exchangeName_ ? queueName_ : routing_key.to_string(),
+                   std::vector<char>(data, data + data_size) };
+
+      std::unique_lock<std::mutex> lock{ mutex_ };
+      if (max_in_flight_ && !io_context_.get_executor().running_in_this_thread())
+         cv_.wait(lock, [&] { return in_flight_ < max_in_flight_ || error_; });
+      if (error_)
+         std::rethrow_exception(error_);
+      ++in_flight_;
+      bool schedule = queued_.empty();
+      queued_.push_back(std::move(msg));
+      lock.unlock();
+      if (schedule)
+         boost::asio::post(io_context_, [this] { send_queued(); });
    }
 
  private:
    inline static const std::string DEFAULT_EXCHANGE = "";
 
-   void init(boost::asio::io_service& io_service, const AMQP::Address& address) {
-      handler_    = std::make_shared<rabbitmq_handler>(io_service);
+   // the connection is set up before its thread starts, afterwards it is only used on that thread
+   void start() {
+      work_.emplace(boost::asio::make_work_guard(io_context_));
+      thread_ = std::thread([this] {
+         fc::set_os_thread_name("amqp");
+         for (;;) {
+            try {
+               io_context_.run();
+               return;
+            } catch (...) {
+               // the connection and channel errors are thrown by their callbacks
+               std::lock_guard<std::mutex> lock{ mutex_ };
+               if (!error_) {
+                  error_ = std::current_exception();
+                  elog("RabbitMQ stream failed, no further messages are published to it");
+               }
+               cv_.notify_all();
+            }
+         }
+      });
+   }
+
+   void init(const AMQP::Address& address) {
+      handler_    = std::make_shared<rabbitmq_handler>(io_context_);
       connection_ = std::make_shared<AMQP::TcpConnection>(handler_.get(), address);
       channel_    = std::make_shared<AMQP::TcpChannel>(connection_.get());
+      if (max_in_flight_) {
+         channel_->confirmSelect()
+               .onAck([this](uint64_t tag, bool multiple) { confirmed(tag, multiple, false); })
+               .onNack([this](uint64_t tag, bool multiple, bool) { confirmed(tag, multiple, true); });
+      }
+   }
+
+   void send_queued() {
+      std::vector<message> batch;
+      {
+         std::lock_guard<std::mutex> lock{ mutex_ };
+         batch.swap(queued_);
+      }
+      for (auto& msg : batch) send(std::move(msg));
+      if (!max_in_flight_)
+         release(batch.size());
+   }
+
+   void send(message&& msg) {
+      channel_->publish(exchangeName_, msg.routing_key, msg.data.data(), msg.data.size(), 0);
+      if (max_in_flight_)
+         unconfirmed_.emplace(next_tag_++, std::move(msg));
+   }
+
+   void release(size_t count) {
+      std::lock_guard<std::mutex> lock{ mutex_ };
+      in_flight_ -= count;
+      cv_.notify_all();
+   }
+
+   // The broker acked or nacked tag, or every tag up to it if multiple. Nacked messages are sent again so each
+   // message is delivered at least once.
+   void confirmed(uint64_t tag, bool multiple, bool nacked) {
+      auto first = multiple ? unconfirmed_.begin() : unconfirmed_.find(tag);
+      auto last  = multiple ? unconfirmed_.upper_bound(tag)
+                            : (first == unconfirmed_.end() ? first : std::next(first));
+      std::vector<message> rejected;
+      size_t               acked = 0;
+      for (auto it = first; it != last; it = unconfirmed_.erase(it)) {
+         if (nacked)
+            rejected.push_back(std::move(it->second));
+         else
+            ++acked;
+      }
+      if (!rejected.empty())
+         wlog("RabbitMQ rejected ${n} messages, publishing them again", ("n", rejected.size()));
+      for (auto& msg : rejected) send(std::move(msg));
+      if (acked)
+         release(acked);
    }
 
    void declare_queue() {
@@ -91,7 +209,7 @@ class rabbitmq : public stream_handler {
 
 class rabbitmq_handler : public AMQP::LibBoostAsioHandler {
  public:
-   explicit rabbitmq_handler(boost::asio::io_service& io_service) : AMQP::LibBoostAsioHandler(io_service) {}
+   explicit rabbitmq_handler(boost::asio::io_context& io_context) : AMQP::LibBoostAsioHandler(io_context) {}
 
    void onError(AMQP::TcpConnection* connection, const char* message) {
       throw std::runtime_error("rabbitmq connection failed: " + std::string(message));
@@ -158,9 +276,8 @@ inline AMQP::Address parse_rabbitmq_address(const std::string& cmdline_arg, std:
    return AMQP::Address(cmdline_arg.substr(0, second_slash_pos));
 }
 
-inline void initialize_rabbits_queue(boost::asio::io_service&                      io_service,
-                                     std::vector<std::unique_ptr<stream_handler>>& streams,
-                                     const std::vector<std::string>&               rabbits) {
+inline void initialize_rabbits_queue(std::vector<std::unique_ptr<stream_handler>>& streams,
+                                     const std::vector<std::string>& rabbits, uint32_t max_in_flight) {
    for (const std::string& rabbit : rabbits) {
       std::string              queue_name;
       std::vector<eosio::name> routes;
@@ -171,13 +288,13 @@ inline void initialize_rabbits_queue(boost::asio::io_service&
          queue_name = "stream.default";
       }
 
-      streams.emplace_back(std::make_unique<rabbitmq>(io_service, std::move(routes), address, std::move(queue_name)));
+      streams.emplace_back(
+            std::make_unique<rabbitmq>(std::move(routes), address, std::move(queue_name), max_in_flight));
    }
 }
 
-inline void initialize_rabbits_exchange(boost::asio::io_service&                      io_service,
-                                        std::vector<std::unique_ptr<stream_handler>>& streams,
-                                        const std::vector<std::string>&               rabbits) {
+inline void initialize_rabbits_exchange(std::vector<std::unique_ptr<stream_handler>>& streams,
+                                        const std::vector<std::string>& rabbits, uint32_t max_in_flight) {
    for (std::string rabbit : rabbits) {
       std::string              exchange;
       std::vector<eosio::name> routes;
@@ -192,8 +309,8 @@ inline void initialize_rabbits_exchange(boost::asio::io_service&
          exchange.erase(double_column_pos);
       }
 
-      streams.emplace_back(std::make_unique<rabbitmq>(io_service, std::move(routes), address, std::move(exchange),
-                                                      std::move(exchange_type)));
+      streams.emplace_back(std::make_unique<rabbitmq>(std::move(routes), address, std::move(exchange),
+                                                      std::move(exchange_type), max_in_flight));
    }
 }
 
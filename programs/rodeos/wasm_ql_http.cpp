@@ -28,9 +28,12 @@
 #include <cstdlib>
 #include <functional>
 #include <iostream>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 static const std::vector<char> temp_contract_kv_prefix{ 0x02 }; // todo: replace
@@ -143,14 +146,75 @@ std::string path_cat(beast::string_view base, beast::string_view path) {
    return result;
 }
 
+// Least recently used cache of the query results answered from the current head block, keyed by target and request
+// body. The whole cache is dropped when the head block changes.
+class query_cache {
+ public:
+   explicit query_cache(uint64_t max_bytes) : max_bytes(max_bytes) {}
+
+   std::shared_ptr<const std::vector<char>> get(const eosio::checksum256& head_id, const std::string& key) {
+      std::lock_guard<std::mutex> lock{ mutex };
+      advance(head_id);
+      auto it = entries.find(key);
+      if (it == entries.end())
+         return {};
+      lru.splice(lru.begin(), lru, it->second.lru_pos);
+      return it->second.result;
+   }
+
+   void put(const eosio::checksum256& head_id, const std::string& key, std::vector<char> result) {
+      const uint64_t size = key.size() + result.size();
+      if (size > max_bytes)
+         return;
+      std::lock_guard<std::mutex> lock{ mutex };
+      // answered from a block which is no longer the head
+      if (head_id != this->head_id)
+         return;
+      if (entries.count(key))
+         return;
+      lru.push_front(key);
+      entries.emplace(key, entry{ std::make_shared<const std::vector<char>>(std::move(result)), lru.begin(), size });
+      bytes += size;
+      while (bytes > max_bytes) {
+         auto it = entries.find(lru.back());
+         bytes -= it->second.size;
+         entries.erase(it);
+         lru.pop_back();
+      }
+   }
+
+ private:
+   struct entry {
+      std::shared_ptr<const std::vector<char>> result;
+      std::list<std::string>::iterator         lru_pos;
+      uint64_t                                 size;
+   };
+
+   void advance(const eosio::checksum256& head_id) {
+      if (head_id == this->head_id)
+         return;
+      this->head_id = head_id;
+      entries.clear();
+      lru.clear();
+      bytes = 0;
+   }
+
+   const uint64_t                         max_bytes;
+   std::mutex                             mutex;
+   eosio::checksum256                     head_id = {};
+   std::unordered_map<std::string, entry> entries;
+   std::list<std::string>                 lru; // most recently used first
+   uint64_t                               bytes = 0;
+};
+
 // This function produces an HTTP response for the given
 // request. The type of the response object depends on the
 // contents of the request, so the interface requires the
 // caller to pass a generic lambda for receiving the response.
 template <class Body, class Allocator, class Send>
 void handle_request(const wasm_ql::http_config& http_config, const wasm_ql::shared_state& shared_state,
-                    thread_state_cache& state_cache, http::request<Body, http::basic_fields<Allocator>>&& req,
-                    Send&& send) {
+                    thread_state_cache& state_cache, query_cache* query_cache,
+                    http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
    // Returns a bad request response
    const auto bad_request = [&http_config, &req](beast::string_view why) {
       http::response<http::string_body> res{ http::status::bad_request, req.version() };
@@ -203,6 +267,29 @@ void handle_request(const wasm_ql::http_config& http_config, const wasm_ql::shar
       return res;
    };
 
+   // Runs query, or answers from query_cache if the same request was answered from the current head block
+   const auto run_query = [&](auto query) {
+      auto               thread_state = state_cache.get_state();
+      eosio::checksum256 head_id      = {};
+      std::string        key;
+      if (query_cache) {
+         head_id = query_head_id(*thread_state, temp_contract_kv_prefix);
+         key     = req.target().to_string() + '\n' + std::string{ req.body().data(), req.body().size() };
+         if (head_id != eosio::checksum256{}) {
+            if (auto cached = query_cache->get(head_id, key)) {
+               send(ok(*cached, "application/json"));
+               state_cache.store_state(std::move(thread_state));
+               return;
+            }
+         }
+      }
+      std::vector<char> result = query(*thread_state);
+      if (query_cache && head_id != eosio::checksum256{})
+         query_cache->put(head_id, key, result);
+      send(ok(std::move(result), "application/json"));
+      state_cache.store_state(std::move(thread_state));
+   };
+
    // todo: pack error messages in json
    // todo: replace "query failed"
    try {
@@ -216,21 +303,19 @@ void handle_request(const wasm_ql::http_config& http_config, const wasm_ql::shar
          if (req.method() != http::verb::post)
             return send(
                   error(http::status::bad_request, "Unsupported HTTP-method for " + req.target().to_string() + "\n"));
-         auto thread_state = state_cache.get_state();
-         send(ok(query_get_block(*thread_state, temp_contract_kv_prefix,
-                                 std::string_view{ req.body().data(), req.body().size() }),
-                 "application/json"));
-         state_cache.store_state(std::move(thread_state));
+         run_query([&](wasm_ql::thread_state& state) {
+            return query_get_block(state, temp_contract_kv_prefix,
+                                   std::string_view{ req.body().data(), req.body().size() });
+         });
          return;
       } else if (req.target() == "/v1/chain/get_abi") { // todo: get_raw_abi. upgrade cleos to use get_raw_abi.
          if (req.method() != http::verb::post)
             return send(
                   error(http::status::bad_request, "Unsupported HTTP-method for " + req.target().to_string() + "\n"));
-         auto thread_state = state_cache.get_state();
-         send(ok(query_get_abi(*thread_state, temp_contract_kv_prefix,
-                               std::string_view{ req.body().data(), req.body().size() }),
-                 "application/json"));
-         state_cache.store_state(std::move(thread_state));
+         run_query([&](wasm_ql::thread_state& state) {
+            return query_get_abi(state, temp_contract_kv_prefix,
+                                 std::string_view{ req.body().data(), req.body().size() });
+         });
          return;
       } else if (req.target() == "/v1/chain/get_required_keys") { // todo: replace with a binary endpoint?
          if (req.method() != http::verb::post)
@@ -247,13 +332,12 @@ void handle_request(const wasm_ql::http_config& http_config, const wasm_ql::shar
          if (req.method() != http::verb::post)
             return send(
                   error(http::status::bad_request, "Unsupported HTTP-method for " + req.target().to_string() + "\n"));
-         auto thread_state = state_cache.get_state();
-         send(ok(query_send_transaction(*thread_state, temp_contract_kv_prefix,
-                                        std::string_view{ req.body().data(), req.body().size() },
-                                        false // todo: switch to true when /v1/chain/send_transaction2
-                                        ),
-                 "application/json"));
-         state_cache.store_state(std::move(thread_state));
+         run_query([&](wasm_ql::thread_state& state) {
+            return query_send_transaction(state, temp_contract_kv_prefix,
+                                          std::string_view{ req.body().data(), req.body().size() },
+                                          false // todo: switch to true when /v1/chain/send_transaction2
+            );
+         });
          return;
       } else if (req.target().starts_with("/v1/") || http_config.static_dir.empty()) {
          // todo: redirect if /v1/?
@@ -401,6 +485,7 @@ class http_session : public std::enable_shared_from_this<http_session> {
    std::shared_ptr<const wasm_ql::http_config>  http_config;
    std::shared_ptr<const wasm_ql::shared_state> shared_state;
    std::shared_ptr<thread_state_cache>          state_cache;
+   std::shared_ptr<query_cache>                 query_cache_;
    queue                                        queue_;
 
    // The parser is stored in an optional container so we can
@@ -411,9 +496,10 @@ class http_session : public std::enable_shared_from_this<http_session> {
    // Take ownership of the socket
    http_session(const std::shared_ptr<const wasm_ql::http_config>&  http_config,
                 const std::shared_ptr<const wasm_ql::shared_state>& shared_state,
-                const std::shared_ptr<thread_state_cache>& state_cache, tcp::socket&& socket)
+                const std::shared_ptr<thread_state_cache>& state_cache,
+                const std::shared_ptr<query_cache>& query_cache_, tcp::socket&& socket)
        : stream(std::move(socket)), http_config(http_config), shared_state(shared_state), state_cache(state_cache),
-         queue_(*this) {}
+         query_cache_(query_cache_), queue_(*this) {}
 
    // Start the session
    void run() { do_read(); }
@@ -446,7 +532,7 @@ class http_session : public std::enable_shared_from_this<http_session> {
          return fail(ec, "read");
 
       // Send the response
-      handle_request(*http_config, *shared_state, *state_cache, parser->release(), queue_);
+      handle_request(*http_config, *shared_state, *state_cache, query_cache_.get(), parser->release(), queue_);
 
       // If we aren't at the queue limit, try to pipeline another request
       if (!queue_.is_full())
@@ -489,6 +575,7 @@ class listener : public std::enable_shared_from_this<listener> {
    tcp::acceptor                                acceptor;
    bool                                         acceptor_ready = false;
    std::shared_ptr<thread_state_cache>          state_cache;
+   std::shared_ptr<query_cache>                 query_cache_;
 
  public:
    listener(const std::shared_ptr<const wasm_ql::http_config>&  http_config,
@@ -497,6 +584,9 @@ class listener : public std::enable_shared_from_this<listener> {
        : http_config{ http_config }, shared_state{ shared_state }, ioc(ioc), acceptor(net::make_strand(ioc)),
          state_cache(std::make_shared<thread_state_cache>(shared_state)) {
 
+      if (http_config->query_cache_size)
+         query_cache_ = std::make_shared<query_cache>(http_config->query_cache_size);
+
       beast::error_code ec;
 
       // Open the acceptor
@@ -540,7 +630,7 @@ class listener : public std::enable_shared_from_this<listener> {
          fail(ec, "accept");
       } else {
          // Create the http session and run it
-         std::make_shared<http_session>(http_config, shared_state, state_cache, std::move(socket))->run();
+         std::make_shared<http_session>(http_config, shared_state, state_cache, query_cache_, std::move(socket))->run();
       }
 
       // Accept another connection
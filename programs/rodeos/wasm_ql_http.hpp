@@ -11,6 +11,7 @@ struct http_config {
    std::string static_dir       = {};
    std::string address          = {};
    std::string port             = {};
+   uint64_t    query_cache_size = {}; // bytes of query results cached for the current head block, 0 disables
 };
 
 struct http_server {
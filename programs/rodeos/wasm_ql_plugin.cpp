@@ -46,11 +46,15 @@ void wasm_ql_plugin::set_program_options(options_description& cli, options_descr
    op("wql-allow-origin", bpo::value<std::string>(), "Access-Control-Allow-Origin header. Use \"*\" to allow any.");
    op("wql-contract-dir", bpo::value<std::string>(),
       "Directory to fetch contracts from. These override contracts on the chain. (default: disabled)");
+   op("wql-preload-contracts", bpo::bool_switch()->default_value(false),
+      "Compile one backend per thread for each contract in wql-contract-dir at startup and never evict them");
    op("wql-static-dir", bpo::value<std::string>(), "Directory to serve static files from (default: disabled)");
    op("wql-console-size", bpo::value<uint32_t>()->default_value(0), "Maximum size of console data");
    op("wql-wasm-cache-size", bpo::value<uint32_t>()->default_value(100), "Maximum number of compiled wasms to cache");
    op("wql-max-request-size", bpo::value<uint32_t>()->default_value(10000), "HTTP maximum request body size (bytes)");
    op("wql-idle-timeout", bpo::value<uint64_t>()->default_value(30000), "HTTP idle connection timeout (ms)");
+   op("wql-query-cache-size", bpo::value<uint64_t>()->default_value(0),
+      "Maximum size of the query results cached for the current head block (MiB), 0 disables the cache");
    op("wql-exec-time", bpo::value<uint64_t>()->default_value(200), "Max query execution time (ms)");
    op("wql-max-action-return-value", bpo::value<uint32_t>()->default_value(MAX_SIZE_OF_BYTE_ARRAYS), "Max action return value size (bytes)");
 }
@@ -73,10 +77,13 @@ void wasm_ql_plugin::plugin_initialize(const variables_map& options) {
       shared_state->wasm_cache_size  = options.at("wql-wasm-cache-size").as<uint32_t>();
       http_config->max_request_size  = options.at("wql-max-request-size").as<uint32_t>();
       http_config->idle_timeout_ms   = options.at("wql-idle-timeout").as<uint64_t>();
+      http_config->query_cache_size  = options.at("wql-query-cache-size").as<uint64_t>() * 1024 * 1024;
       shared_state->max_exec_time_ms = options.at("wql-exec-time").as<uint64_t>();
       shared_state->max_action_return_value_size = options.at("wql-max-action-return-value").as<uint32_t>();
       if (options.count("wql-contract-dir"))
          shared_state->contract_dir = options.at("wql-contract-dir").as<std::string>();
+      if (options.at("wql-preload-contracts").as<bool>())
+         wasm_ql::preload_contracts(*shared_state, http_config->num_threads);
       if (options.count("wql-allow-origin"))
          http_config->allow_origin = options.at("wql-allow-origin").as<std::string>();
       if (options.count("wql-static-dir"))
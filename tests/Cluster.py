@@ -166,7 +166,8 @@ class Cluster(object):
     # pylint: disable=too-many-statements
     def launch(self, pnodes=1, unstartedNodes=0, totalNodes=1, prodCount=1, topo="mesh", delay=1, onlyBios=False, dontBootstrap=False,
                totalProducers=None, sharedProducers=0, extraNodeosArgs="", useBiosBootFile=True, specificExtraNodeosArgs=None, onlySetProds=False,
-               pfSetupPolicy=PFSetupPolicy.FULL, alternateVersionLabelsFile=None, associatedNodeLabels=None, loadSystemContract=True, manualProducerNodeConf={}):
+               pfSetupPolicy=PFSetupPolicy.FULL, alternateVersionLabelsFile=None, associatedNodeLabels=None, loadSystemContract=True, manualProducerNodeConf={},
+               extraLauncherArgs=None):
         """Launch cluster.
         pnodes: producer nodes count
         unstartedNodes: non-producer nodes that are configured into the launch, but not started.  Should be included in totalNodes.
@@ -189,6 +190,7 @@ class Cluster(object):
         associatedNodeLabels: Supply a dictionary of node numbers to use an alternate label for a specific node.
         loadSystemContract: indicate whether the eosio.system contract should be loaded (setting this to False causes useBiosBootFile to be treated as False)
         manualProducerNodeConf: additional producer public keys which is not automatically generated by launcher
+        extraLauncherArgs: list of additional arguments of the launcher, example: [ "--link-delay-ms", "50", "--key-seed", "perf" ]
         """
         assert(isinstance(topo, str))
         assert PFSetupPolicy.isValid(pfSetupPolicy)
@@ -292,6 +294,10 @@ class Cluster(object):
         cmdArr.append("--max-transaction-cpu-usage")
         cmdArr.append(str(150000000))
 
+        if extraLauncherArgs is not None:
+            assert(isinstance(extraLauncherArgs, list))
+            cmdArr.extend(extraLauncherArgs)
+
         if associatedNodeLabels is not None:
             for nodeNum,label in associatedNodeLabels.items():
                 assert(isinstance(nodeNum, (str,int)))
@@ -740,6 +746,21 @@ class Cluster(object):
         nodes += self.getNodes()
         return nodes
 
+    def collectMetrics(self):
+        """Return the metrics of each started node, the node's metrics_plugin must be enabled.
+        The result maps the node number to the metrics returned by Node.getMetrics, None for a node which did not respond."""
+        metrics={}
+        for nodeNum,node in enumerate(self.getNodes()):
+            metrics[nodeNum]=node.getMetrics()
+        return metrics
+
+    def impairNetwork(self, script="impair_network.sh", reset=False):
+        """Apply, or remove when reset is True, the network impairment of the script generated by the launcher when given
+        --link-delay-ms, --link-rate or --link-loss. Changing the qdisc of the network device requires root privileges."""
+        cmd="%s %s" % (os.path.join(os.getcwd(), script), "reset" if reset else "")
+        if Utils.Debug: Utils.Print("cmd: %s" % (cmd))
+        return 0 == subprocess.call(cmd.split())
+
     def launchUnstarted(self, numToLaunch=1, cachePopen=False):
         assert(isinstance(numToLaunch, int))
         assert(numToLaunch>0)
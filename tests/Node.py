@@ -1040,6 +1040,29 @@ class Node(object):
 
         return rtn
 
+    @staticmethod
+    def parsePrometheus(text):
+        """Parse the prometheus text format into a dictionary of each sample, keyed by its name and labels as printed, e.g. 'nodeos_net_connections' or
+        'nodeos_net_sent_bytes_total{type="signed_block"}'."""
+        samples={}
+        for line in text.splitlines():
+            line=line.strip()
+            if len(line) == 0 or line.startswith("#"):
+                continue
+            key,_,value=line.rpartition(" ")
+            try:
+                samples[key]=float(value)
+            except ValueError:
+                Utils.Print("WARNING: unexpected prometheus sample \"%s\"" % (line))
+        return samples
+
+    def getMetrics(self, silentErrors=True):
+        """Return the samples of /v1/metrics/prometheus as parsed by parsePrometheus, None if the node does not respond."""
+        text=self.processCurlCmd("metrics", "prometheus", "{}", silentErrors=silentErrors, returnType=ReturnType.raw)
+        if text is None:
+            return None
+        return Node.parsePrometheus(text)
+
     def txnGenCreateTestAccounts(self, genAccount, genKey, silentErrors=True, exitOnError=False, exitMsg=None, returnType=ReturnType.json):
         assert(isinstance(genAccount, str))
         assert(isinstance(genKey, str))
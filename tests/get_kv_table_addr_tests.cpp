@@ -204,6 +204,40 @@ BOOST_FIXTURE_TEST_CASE( get_kv_table_addr_test, TESTER ) try {
    BOOST_REQUIRE_EQUAL(2u, result.rows.size());
    chk_result(0, 2);
    chk_result(1, 1);
+
+   // only the requested fields of the rows
+   p.index_name = "accname"_n;
+   p.index_value = "john";
+   p.encode_type = "name";
+   p.upper_bound = "";
+   p.reverse = false;
+   p.fields = { "account_name", "personal_id" };
+   result = plugin.read_only::get_kv_table_rows(p);
+   BOOST_REQUIRE_EQUAL(1u, result.rows.size());
+   BOOST_REQUIRE_EQUAL(2u, result.rows[0].get_object().size());
+   BOOST_REQUIRE_EQUAL("john", result.rows[0]["account_name"].as_string());
+   BOOST_REQUIRE_EQUAL("jsmith", result.rows[0]["personal_id"]["field_1"].as_string());
+   p.fields.clear();
+
+   // only the keys of the rows
+   p.keys_only = true;
+   p.index_value = "";
+   p.lower_bound = "john";
+   result = plugin.read_only::get_kv_table_rows(p);
+   BOOST_REQUIRE_EQUAL(3u, result.rows.size());
+   BOOST_REQUIRE_EQUAL("john", result.rows[0]["key"].as_string());
+   BOOST_REQUIRE_EQUAL("steve", result.rows[2]["key"].as_string());
+   BOOST_REQUIRE(!result.rows[0].get_object().contains("account_name"));
+
+   // the keys of a secondary index hold the primary key of their row
+   p.index_name = "persid"_n;
+   p.encode_type = "";
+   p.lower_bound = "";
+   result = plugin.read_only::get_kv_table_rows(p);
+   BOOST_REQUIRE_EQUAL(4u, result.rows.size());
+   BOOST_REQUIRE_EQUAL("jane", result.rows[0]["primary_key"].as_string());
+   BOOST_REQUIRE_EQUAL("steve", result.rows[3]["primary_key"].as_string());
+   BOOST_REQUIRE(result.rows[0].get_object().contains("key_bytes"));
 }
 FC_LOG_AND_RETHROW()
 
@@ -168,4 +168,79 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( get_table_next_key_reverse_test, TESTER_T, backin
 
 } FC_LOG_AND_RETHROW() } /// get_scope_test
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( get_table_cursor_test, TESTER_T, backing_store_ts) { try {
+   TESTER_T t;
+   t.create_account("test"_n);
+
+   t.set_code( "test"_n, contracts::get_table_seckey_test_wasm() );
+   t.set_abi( "test"_n, contracts::get_table_seckey_test_abi().data() );
+   t.produce_block();
+
+   // rows sharing the secondary key "a"
+   t.push_action("test"_n, "addnumobj"_n, "test"_n, mutable_variant_object()("input", 2)("nm", "a"));
+   t.push_action("test"_n, "addnumobj"_n, "test"_n, mutable_variant_object()("input", 5)("nm", "a"));
+   t.push_action("test"_n, "addnumobj"_n, "test"_n, mutable_variant_object()("input", 7)("nm", "a"));
+   t.push_action("test"_n, "addnumobj"_n, "test"_n, mutable_variant_object()("input", 8)("nm", "b"));
+   t.produce_block();
+
+   chain_apis::read_only plugin(*(t.control), {}, fc::microseconds::maximum());
+   chain_apis::read_only::get_table_rows_params params{};
+   params.json = true;
+   params.code = "test"_n;
+   params.scope = "test";
+   params.table = "numobjs"_n;
+   params.key_type = "name";
+   params.index_position = "6";
+   params.limit = 1;
+
+   for( bool reverse : { false, true } ) {
+      params.reverse = reverse;
+      params.cursor.clear();
+      std::vector<std::string> names;
+      for( int page = 0; page < 10; ++page ) {
+         auto res = plugin.get_table_rows(params);
+         BOOST_REQUIRE_EQUAL(res.rows.size(), 1u);
+         names.push_back(res.rows[0]["nm"].as_string());
+         if( !res.more ) {
+            BOOST_REQUIRE(res.next_cursor.empty());
+            break;
+         }
+         params.cursor = res.next_cursor;
+      }
+      // next_key would return the first "a" row again, the cursor goes through every row once
+      if( reverse )
+         BOOST_REQUIRE(names == std::vector<std::string>({"b", "a", "a", "a"}));
+      else
+         BOOST_REQUIRE(names == std::vector<std::string>({"a", "a", "a", "b"}));
+   }
+
+   // cursor and bounds together
+   params.reverse = false;
+   params.upper_bound = "a";
+   params.limit = 2;
+   params.cursor.clear();
+   auto res = plugin.get_table_rows(params);
+   BOOST_REQUIRE_EQUAL(res.rows.size(), 2u);
+   BOOST_REQUIRE(res.more);
+   params.cursor = res.next_cursor;
+   res = plugin.get_table_rows(params);
+   BOOST_REQUIRE_EQUAL(res.rows.size(), 1u);
+   BOOST_REQUIRE(!res.more);
+
+   // keys only
+   params.upper_bound.clear();
+   params.cursor.clear();
+   params.limit = 10;
+   params.keys_only = true;
+   res = plugin.get_table_rows(params);
+   BOOST_REQUIRE_EQUAL(res.rows.size(), 4u);
+   BOOST_REQUIRE_EQUAL(res.rows[0].get_object().size(), 2u);
+   BOOST_REQUIRE_EQUAL(res.rows[0]["secondary_key"].as_string(), "a");
+   BOOST_REQUIRE_EQUAL(res.rows[3]["secondary_key"].as_string(), "b");
+
+   params.cursor = "00";
+   BOOST_CHECK_THROW(plugin.get_table_rows(params), chain::contract_table_query_exception);
+
+} FC_LOG_AND_RETHROW() } /// get_table_cursor_test
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+import json
+import signal
+import time
+import unittest
+
+from testUtils import Utils
+from Cluster import Cluster
+from TestHelper import TestHelper
+from Node import Node
+from WalletMgr import WalletMgr
+from core_symbol import CORE_SYMBOL
+
+###############################################################
+# history_store_test
+#
+# Runs the history_plugin with --history-dir and checks that get_actions and get_transaction answer from the
+# RocksDB store once the blocks are irreversible, and that the history and the account sequences survive a restart.
+#
+###############################################################
+
+class HistoryStoreTest(unittest.TestCase):
+    sleep_s = 1
+    cluster=Cluster(walletd=True, defproduceraPrvtKey=None)
+    walletMgr=WalletMgr(True)
+    accounts = []
+    cluster.setWalletMgr(walletMgr)
+
+    # kill nodeos and keosd and clean up dir
+    def cleanEnv(self, shouldCleanup: bool) :
+        self.cluster.killall(allInstances=True)
+        if shouldCleanup:
+            self.cluster.cleanup()
+        self.walletMgr.killall(allInstances=True)
+        if shouldCleanup:
+            self.walletMgr.cleanup()
+
+    # start keosd and nodeos
+    def startEnv(self) :
+        account_names = ["alice", "bob"]
+        self.cluster.launch(totalNodes=1, extraNodeosArgs=" --history-dir=history")
+        self.walletMgr.launch()
+        testWalletName="testwallet"
+        testWallet=self.walletMgr.create(testWalletName, [self.cluster.eosioAccount, self.cluster.defproduceraAccount])
+        self.cluster.validateAccounts(None)
+        self.accounts=Cluster.createAccountKeys(len(account_names))
+        node = self.cluster.getNode(0)
+        for idx in range(len(account_names)):
+            self.accounts[idx].name =  account_names[idx]
+            self.walletMgr.importKey(self.accounts[idx], testWallet)
+        for account in self.accounts:
+            node.createInitializeAccount(account, self.cluster.eosioAccount, buyRAM=1000000, stakedDeposit=5000000, waitForTransBlock=True, exitOnError=True)
+        time.sleep(self.sleep_s)
+
+    # transfer from alice to bob, returns the transaction id once it is irreversible
+    def transfer(self, node: Node) -> str:
+        xferAmount = Node.currencyIntToStr(1000, CORE_SYMBOL)
+        trans = node.transferFunds(self.accounts[0], self.accounts[1], xferAmount, "history store", waitForTransBlock=True)
+        transId = Node.getTransId(trans)
+        self.assertTrue(node.waitForTransFinalization(transId), "transfer %s did not become irreversible" % (transId))
+        return transId
+
+    # the store is written after irreversibility by a worker thread, get_transaction retries until it is there
+    def checkHistory(self, node: Node, transIds: list):
+        for transId in transIds:
+            trans = node.getTransaction(transId, exitOnError=True)
+            self.assertEqual(trans["id"], transId)
+
+        for account in self.accounts:
+            actions = node.getActions(account, 0, 10000, exitOnError=True)["actions"]
+            self.assertGreater(len(actions), 0)
+            for i in range(len(actions)):
+                self.assertEqual(actions[i]["account_action_seq"], i)
+                if i > 0:
+                    self.assertGreater(actions[i]["global_action_seq"], actions[i - 1]["global_action_seq"])
+            trxIds = set(a["action_trace"]["trx_id"] for a in actions)
+            for transId in transIds:
+                self.assertIn(transId, trxIds)
+
+            # the default query returns the newest action of the account
+            last = node.getActions(account, -1, -1, exitOnError=True)["actions"]
+            self.assertEqual(len(last), 1)
+            self.assertEqual(last[0]["account_action_seq"], len(actions) - 1)
+
+    def get_actions(self, node: Node, params: dict) -> json:
+        base_cmd_str = ("curl http://%s:%s/v1/") % (TestHelper.LOCAL_HOST, node.port)
+        cmd_str = base_cmd_str + "history/get_actions -X POST -d " + ("'%s'") % json.dumps(params)
+        return Utils.runCmdReturnJson(cmd_str)
+
+    # follow next_cursor from the first page until there is none, returns the pages
+    def get_pages(self, node: Node, params: dict) -> list:
+        pages = []
+        page = self.get_actions(node, params)
+        while True:
+            self.assertIn("actions", page)
+            pages.append(page["actions"])
+            if not page.get("next_cursor"):
+                return pages
+            page = self.get_actions(node, {"account_name": params["account_name"], "offset": params["offset"], "cursor": page["next_cursor"]})
+
+    def test_ActionsCursor(self) :
+        node = self.cluster.getNode(0)
+        node.getTransaction(self.transfer(node), exitOnError=True)
+        account = self.accounts[0].name
+        actions = self.get_actions(node, {"account_name": account, "pos": 0, "offset": 10000})["actions"]
+        seqs = [a["account_action_seq"] for a in actions]
+        self.assertEqual(seqs, list(range(len(seqs))))
+
+        # each page is in ascending order, the pages of a negative offset walk back from the newest action
+        older = self.get_pages(node, {"account_name": account, "offset": -3})
+        for page in older:
+            self.assertGreater(len(page), 0)
+        self.assertEqual([a["account_action_seq"] for page in reversed(older) for a in page], seqs)
+
+        newer = self.get_pages(node, {"account_name": account, "pos": 0, "offset": 2})
+        self.assertEqual([a["account_action_seq"] for page in newer for a in page], seqs)
+
+        # raw results hold the packed trace instead of the decoded one
+        raw = self.get_actions(node, {"account_name": account, "pos": 0, "offset": 0, "raw": True})["actions"]
+        self.assertEqual(len(raw), 1)
+        self.assertTrue(raw[0]["packed_action_trace"])
+        self.assertIsNone(raw[0]["action_trace"])
+        self.assertEqual(raw[0]["global_action_seq"], actions[0]["global_action_seq"])
+        self.assertFalse(actions[0].get("packed_action_trace"))
+
+        # a cursor is only accepted for the account it was returned for
+        cursor = self.get_actions(node, {"account_name": account, "offset": -1})["next_cursor"]
+        ret = self.get_actions(node, {"account_name": self.accounts[1].name, "offset": -1, "cursor": cursor})
+        self.assertIn("error", ret)
+        ret = self.get_actions(node, {"account_name": account, "offset": -1, "cursor": "z" * len(cursor)})
+        self.assertIn("error", ret)
+
+    def test_HistoryStore(self) :
+        node = self.cluster.getNode(0)
+        transIds = [self.transfer(node) for _ in range(3)]
+        self.checkHistory(node, transIds)
+
+        node.kill(signal.SIGTERM)
+        self.assertTrue(node.relaunch(cachePopen=True), "Failed to relaunch nodeos")
+        self.checkHistory(node, transIds)
+
+        # actions after the restart continue the account sequences
+        transIds.append(self.transfer(node))
+        self.checkHistory(node, transIds)
+
+    @classmethod
+    def setUpClass(self):
+        self.cleanEnv(self, shouldCleanup=True)
+        self.startEnv(self)
+
+    @classmethod
+    def tearDownClass(self):
+        self.cleanEnv(self, shouldCleanup=False)   # not cleanup to save log in case for further investigation
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+
+from testUtils import Utils
+from Node import BlockType
+from Cluster import Cluster
+from WalletMgr import WalletMgr
+from TestHelper import TestHelper
+from TestHelper import AppArgs
+
+import json
+import time
+
+###############################################################
+# performance_cluster_test
+#
+# Sets up a reproducible performance topology: <-p> producer nodes which only connect to <-n - -p> relay nodes, the
+#  relays forming a mesh.  The launcher derives the keys of the nodes from --key-seed, and when given --link-delay-ms,
+#  --link-rate or --link-loss generates a script adding that impairment to the p2p traffic of every node with tc netem,
+#  the same way as the impaired and lossy network tests (requires root privileges).
+#
+# The relays generate transfers with the txn_test_gen_plugin for --duration seconds.  The metrics of every node are
+#  collected before and after, and a summary report with the throughput of the cluster and the traffic, block apply
+#  latency and lag of each node is printed and written to --report-file.
+#
+###############################################################
+
+Print=Utils.Print
+errorExit=Utils.errorExit
+
+appArgs=AppArgs()
+extraArgs = appArgs.add(flag="--duration", type=int, help="How many seconds the transfers are generated", default=60)
+extraArgs = appArgs.add(flag="--txn-gen-period", type=int, help="Milliseconds between the batches of transfers of each relay", default=1000)
+extraArgs = appArgs.add(flag="--txn-gen-batch-size", type=int, help="Transfers in each batch of each relay, must be even", default=100)
+extraArgs = appArgs.add(flag="--key-seed", type=str, help="Seed of the keys of the nodes", default="performance_cluster")
+extraArgs = appArgs.add(flag="--link-delay-ms", type=int, help="Delay added to the p2p traffic of each node", default=0)
+extraArgs = appArgs.add(flag="--link-jitter-ms", type=int, help="Random variation of the delay of the p2p traffic", default=0)
+extraArgs = appArgs.add(flag="--link-rate", type=str, help="Bandwidth of the p2p traffic of each node, in tc units, e.g. 10mbit", default="")
+extraArgs = appArgs.add(flag="--link-loss", type=str, help="Ratio of the dropped p2p packets of each node, e.g. 1%%", default="")
+extraArgs = appArgs.add(flag="--report-file", type=str, help="File of the summary report", default="performance_cluster_report.json")
+args = TestHelper.parse_args({"-p","-n","--dump-error-details","--keep-logs","-v","--leave-running","--clean-run","--wallet-port"},
+                             applicationSpecificArgs=appArgs)
+
+Utils.Debug=args.v
+pnodes=args.p if args.p > 0 else 1
+totalNodes=args.n if args.n > pnodes else pnodes+1
+relayNodes=totalNodes-pnodes
+cluster=Cluster(walletd=True)
+dumpErrorDetails=args.dump_error_details
+keepLogs=args.keep_logs
+dontKill=args.leave_running
+killAll=args.clean_run
+walletPort=args.wallet_port
+impaired=args.link_delay_ms > 0 or args.link_jitter_ms > 0 or len(args.link_rate) > 0 or len(args.link_loss) > 0
+
+walletMgr=WalletMgr(True, port=walletPort)
+testSuccessful=False
+killEosInstances=not dontKill
+killWallet=not dontKill
+networkImpaired=False
+
+def total(metrics, name):
+    """sum of the samples of name over all its labels"""
+    if metrics is None:
+        return 0
+    return sum(value for key,value in metrics.items() if key == name or key.startswith(name + "{"))
+
+def delta(before, after, name):
+    return total(after, name) - total(before, name)
+
+try:
+    TestHelper.printSystemInfo("BEGIN")
+    cluster.setWalletMgr(walletMgr)
+
+    cluster.killall(allInstances=killAll)
+    cluster.cleanup()
+
+    launcherArgs=["--key-seed", args.key_seed,
+                  "--link-delay-ms", str(args.link_delay_ms), "--link-jitter-ms", str(args.link_jitter_ms)]
+    if len(args.link_rate) > 0:
+        launcherArgs += ["--link-rate", args.link_rate]
+    if len(args.link_loss) > 0:
+        launcherArgs += ["--link-loss", args.link_loss]
+
+    specificExtraNodeosArgs={}
+    for nodeNum in range(pnodes, totalNodes):
+        specificExtraNodeosArgs[nodeNum]="--plugin eosio::txn_test_gen_plugin --txn-test-gen-account-prefix txntestacct"
+
+    Print("Stand up cluster of %d producer nodes and %d relay nodes" % (pnodes, relayNodes))
+    if cluster.launch(pnodes=pnodes, totalNodes=totalNodes, totalProducers=pnodes, topo="relay", useBiosBootFile=False,
+                      loadSystemContract=False, extraNodeosArgs=" --plugin eosio::metrics_plugin",
+                      specificExtraNodeosArgs=specificExtraNodeosArgs, extraLauncherArgs=launcherArgs) is False:
+        errorExit("Failed to stand up eos cluster.")
+
+    if impaired:
+        Print("Impair the p2p traffic")
+        if not cluster.impairNetwork():
+            errorExit("Failed to impair the network, tc requires root privileges")
+        networkImpaired=True
+
+    node0=cluster.getNode(0)
+    relays=[cluster.getNode(nodeNum) for nodeNum in range(pnodes, totalNodes)]
+
+    Print("Create accounts for generated txns")
+    relays[0].txnGenCreateTestAccounts(cluster.eosioAccount.name, cluster.eosioAccount.activePrivateKey)
+    if not node0.waitForBlock(node0.getHeadBlockNum(), blockType=BlockType.lib, timeout=120):
+        errorExit("Account creation did not become irreversible")
+
+    before=cluster.collectMetrics()
+    startBlockNum=node0.getHeadBlockNum()
+    startTime=time.time()
+
+    Print("Generate transfers for %d seconds" % (args.duration))
+    for genNum,relay in enumerate(relays):
+        relay.txnGenStart("%d" % (genNum), args.txn_gen_period, args.txn_gen_batch_size)
+    time.sleep(args.duration)
+
+    after=cluster.collectMetrics()
+    elapsed=time.time()-startTime
+    endBlockNum=node0.getHeadBlockNum()
+
+    transactions=0
+    for blockNum in range(startBlockNum+1, endBlockNum+1):
+        block=node0.getBlock(blockNum, exitOnError=True)
+        transactions+=len(block["transactions"])
+
+    heads={nodeNum: total(metrics, "nodeos_head_block_num") for nodeNum,metrics in after.items()}
+    maxHead=max(heads.values())
+    nodes=[]
+    for nodeNum,metrics in after.items():
+        applied=delta(before[nodeNum], metrics, "nodeos_net_block_apply_seconds_count")
+        nodes.append({
+            "node": nodeNum,
+            "role": "producer" if nodeNum < pnodes else "relay",
+            "responded": metrics is not None,
+            "head_block_num": heads[nodeNum],
+            "head_lag_blocks": maxHead - heads[nodeNum],
+            "lib_lag_blocks": heads[nodeNum] - total(metrics, "nodeos_last_irreversible_block_num"),
+            "connections": total(metrics, "nodeos_net_connections"),
+            "sent_bytes_per_second": delta(before[nodeNum], metrics, "nodeos_net_sent_bytes_total") / elapsed,
+            "received_bytes_per_second": delta(before[nodeNum], metrics, "nodeos_net_received_bytes_total") / elapsed,
+            "blocks_received": applied,
+            "avg_block_apply_ms": delta(before[nodeNum], metrics, "nodeos_net_block_apply_seconds_sum") * 1000 / applied if applied > 0 else 0,
+        })
+
+    report={
+        "producer_nodes": pnodes,
+        "relay_nodes": relayNodes,
+        "key_seed": args.key_seed,
+        "link_impairment": { "delay_ms": args.link_delay_ms, "jitter_ms": args.link_jitter_ms, "rate": args.link_rate, "loss": args.link_loss },
+        "offered_transactions_per_second": relayNodes * args.txn_gen_batch_size * 1000 / args.txn_gen_period,
+        "seconds": elapsed,
+        "blocks": endBlockNum - startBlockNum,
+        "transactions": transactions,
+        "transactions_per_second": transactions / elapsed,
+        "nodes": nodes,
+    }
+    reportStr=json.dumps(report, indent=4)
+    Print("Performance report:\n%s" % (reportStr))
+    with open(args.report_file, "w") as f:
+        f.write(reportStr)
+
+    assert endBlockNum > startBlockNum, "Expected the producers to produce blocks during the run"
+    assert transactions > 0, "Expected the generated transfers to be included in blocks"
+    assert all(n["responded"] for n in nodes), "Expected every node to return its metrics"
+
+    testSuccessful=True
+
+finally:
+    if networkImpaired:
+        cluster.impairNetwork(reset=True)
+    TestHelper.shutdown(cluster, walletMgr, testSuccessful=testSuccessful, killEosInstances=killEosInstances, killWallet=killWallet, keepLogs=keepLogs, cleanRun=killAll, dumpErrorDetails=dumpErrorDetails)
+
+exit(0)
@@ -400,6 +400,11 @@ class PluginHttpTest(unittest.TestCase):
                                                       "\"upper_bound\":\"0xFFFFFFFFFFFFFFFFD0F2A472A8EB6A57\"")
         ret_json = Utils.runCmdReturnJson(valid_cmd)
         self.assertEqual(ret_json["code"], 500)
+        # get_table_by_scope resumed over several steps returns the rows of all of them
+        scan_cmd = default_cmd + self.http_post_str + " '{\"code\":\"eosio\",\"limit\":1000}'"
+        ret_json = Utils.runCmdReturnJson(scan_cmd)
+        self.assertIn("rows", ret_json)
+        self.assertIn("more", ret_json)
 
         # get_currency_balance with empty parameter
         default_cmd = cmd_base + "get_currency_balance"
@@ -678,6 +683,32 @@ class PluginHttpTest(unittest.TestCase):
         ret_json = Utils.runCmdReturnJson(valid_cmd)
         self.assertIn("transaction_id", ret_json[0])
 
+        # push_transaction_batch with empty parameter
+        default_cmd = cmd_base + "push_transaction_batch"
+        ret_json = Utils.runCmdReturnJson(default_cmd)
+        self.assertEqual(ret_json["code"], 400)
+        self.assertEqual(ret_json["error"]["code"], 3200006)
+        # push_transaction_batch with invalid parameter
+        invalid_cmd = default_cmd + self.http_post_str + self.http_post_invalid_param
+        ret_json = Utils.runCmdReturnJson(invalid_cmd)
+        self.assertEqual(ret_json["code"], 400)
+        self.assertEqual(ret_json["error"]["code"], 3200006)
+        # push_transaction_batch with valid parameter, the results are in the order of the transactions
+        valid_cmd = ("%s%s '[{%s, %s, %s, %s}, {%s, %s, %s, %s}]'") % (default_cmd,
+                                                   self.http_post_str,
+                                                   "\"signatures\":[\"SIG_K1_KeqfqiZu1GwUxQb7jzK9Fdks6HFaVBQ9AJtCZZj56eG9qGgvVMVtx8EerBdnzrhFoX437sgwtojf2gfz6S516Ty7c22oEp\"]",
+                                                   "\"compression\": true",
+                                                   "\"packed_context_free_data\": \"context_free_data\"",
+                                                   "\"packed_trx\": \"packed_trx\"",
+                                                   "\"signatures\":[\"SIG_K1_KeqfqiZu1GwUxQb7jzK9Fdks6HFaVBQ9AJtCZZj56eG9qGgvVMVtx8EerBdnzrhFoX437sgwtojf2gfz6S516Ty7c22oEp\"]",
+                                                   "\"compression\": true",
+                                                   "\"packed_context_free_data\": \"context_free_data\"",
+                                                   "\"packed_trx\": \"packed_trx\"")
+        ret_json = Utils.runCmdReturnJson(valid_cmd)
+        self.assertEqual(len(ret_json), 2)
+        self.assertIn("transaction_id", ret_json[0])
+        self.assertIn("transaction_id", ret_json[1])
+
         # send_transaction with empty parameter
         default_cmd = cmd_base + "send_transaction"
         ret_json = Utils.runCmdReturnJson(default_cmd)
@@ -175,6 +175,20 @@ BOOST_AUTO_TEST_CASE(wallet_manager_test)
    BOOST_CHECK(find(pks.cbegin(), pks.cend(), pkey1.get_public_key()) != pks.cend());
    BOOST_CHECK(find(pks.cbegin(), pks.cend(), pkey2.get_public_key()) != pks.cend());
 
+   wm.set_signing_threads(2);
+   chain::signed_transaction trx2;
+   trx2.expiration = fc::time_point_sec(1);
+   auto trxs = wm.sign_transactions({chain::signed_transaction(), trx2}, {pubkeys, {pkey2.get_public_key()}}, chain_id);
+   BOOST_REQUIRE_EQUAL(2u, trxs.size());
+   BOOST_CHECK(trxs[0].signatures == trx.signatures);
+   pks.clear();
+   trxs[1].get_signature_keys(chain_id, fc::time_point::maximum(), pks);
+   BOOST_REQUIRE_EQUAL(1u, pks.size());
+   BOOST_CHECK(*pks.begin() == pkey2.get_public_key());
+   BOOST_CHECK_THROW(wm.sign_transactions({trx2}, {pubkeys, pubkeys}, chain_id), chain::wallet_exception);
+   BOOST_CHECK_THROW(wm.sign_transactions({trx2, trx2}, {pubkeys, {private_key_type::generate().get_public_key()}}, chain_id),
+                     chain::wallet_missing_pub_key_exception);
+
    BOOST_CHECK_EQUAL(3u, wm.get_public_keys().size());
    wm.set_timeout(chrono::seconds(0));
    BOOST_CHECK_THROW(wm.get_public_keys(), wallet_locked_exception);
@@ -51,6 +51,8 @@ fc::variant verify_byte_round_trip_conversion( const abi_serializer& abis, const
 
    std::string r = fc::json::to_string(var2, fc::time_point::now() + max_serialization_time);
 
+   BOOST_TEST( abis.binary_to_json(type, bytes, abi_serializer::create_yield_function( max_serialization_time )) == r );
+
    auto bytes2 = abis.variant_to_binary(type, var2, abi_serializer::create_yield_function( max_serialization_time ));
 
    BOOST_TEST( fc::to_hex(bytes) == fc::to_hex(bytes2) );
@@ -65,6 +67,7 @@ void verify_round_trip_conversion( const abi_serializer& abis, const type_name&
    BOOST_REQUIRE_EQUAL(fc::to_hex(bytes), hex);
    auto var2 = abis.binary_to_variant(type, bytes, abi_serializer::create_yield_function( max_serialization_time ));
    BOOST_REQUIRE_EQUAL(fc::json::to_string(var2, fc::time_point::now() + max_serialization_time), expected_json);
+   BOOST_REQUIRE_EQUAL(abis.binary_to_json(type, bytes, abi_serializer::create_yield_function( max_serialization_time )), expected_json);
    auto bytes2 = abis.variant_to_binary(type, var2, abi_serializer::create_yield_function( max_serialization_time ));
    BOOST_REQUIRE_EQUAL(fc::to_hex(bytes2), hex);
 }
@@ -2277,6 +2280,53 @@ BOOST_AUTO_TEST_CASE(abi_type_def)
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE(abi_copy_outlives_original)
+{ try {
+   // the resolved types of a copy must refer to the copy's own definitions
+   const char* abi = R"=====(
+   {
+     "version": "eosio::abi/1.0",
+     "types": [{
+         "new_type_name": "account_name",
+         "type": "name"
+       }
+     ],
+     "structs": [{
+         "name": "transfer",
+         "base": "",
+         "fields": [{
+            "name": "from",
+            "type": "account_name"
+         },{
+            "name": "to",
+            "type": "account_name[]"
+         },{
+            "name": "memo",
+            "type": "string?"
+         }]
+       }
+     ],
+     "actions": [],
+     "tables": []
+   }
+   )=====";
+
+   auto original = std::make_unique<abi_serializer>(fc::json::from_string(abi).as<abi_def>(), abi_serializer::create_yield_function( max_serialization_time ));
+   abi_serializer copied(*original);
+   abi_serializer assigned;
+   assigned = *original;
+   abi_serializer moved(std::move(*original));
+   original.reset();
+
+   auto var = fc::json::from_string(R"=====({"from":"kevin","to":["dan","alice"],"memo":null})=====");
+   verify_byte_round_trip_conversion(copied, "transfer", var);
+   verify_byte_round_trip_conversion(assigned, "transfer", var);
+   verify_byte_round_trip_conversion(moved, "transfer", var);
+
+   // types which are not part of the abi still resolve
+   verify_byte_round_trip_conversion(copied, "account_name?", fc::json::from_string(R"=====("dan")====="));
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE(abi_type_loop)
 { try {
    // inifinite loop in types
@@ -3670,4 +3720,104 @@ BOOST_AUTO_TEST_CASE(signed_transaction_extensions_tests)
                           fc_exception_message_starts_with("Transaction contained deferred_transaction_generation and transaction_extensions that did not match") );
 }
 
+BOOST_AUTO_TEST_CASE(binary_to_json_errors)
+{
+   auto abi = R"({
+      "version": "eosio::abi/1.1",
+      "structs": [
+         {"name": "s", "base": "", "fields": [
+            {"name": "a", "type": "int8?[]"},
+         ]}
+      ],
+   })";
+
+   abi_serializer abis(fc::json::from_string(abi).as<abi_def>(), abi_serializer::create_yield_function( max_serialization_time ));
+
+   // same restrictions as binary_to_variant
+   const bytes present = fc::raw::pack( std::vector<std::optional<int8_t>>{ 1, 2 } );
+   BOOST_REQUIRE_EQUAL( abis.binary_to_json("s", present, abi_serializer::create_yield_function( max_serialization_time )), R"({"a":[1,2]})" );
+   const bytes missing = fc::raw::pack( std::vector<std::optional<int8_t>>{ 1, {} } );
+   BOOST_CHECK_THROW( abis.binary_to_variant("s", missing, abi_serializer::create_yield_function( max_serialization_time )), unpack_exception );
+   BOOST_CHECK_THROW( abis.binary_to_json("s", missing, abi_serializer::create_yield_function( max_serialization_time )), unpack_exception );
+   BOOST_CHECK_THROW( abis.binary_to_json("s", bytes(), abi_serializer::create_yield_function( max_serialization_time )), unpack_exception );
+}
+
+BOOST_AUTO_TEST_CASE(binary_to_json_built_in_types)
+{
+   auto abi = R"({
+      "version": "eosio::abi/1.1",
+      "structs": [
+         {"name": "s", "base": "", "fields": [
+            {"name": "a", "type": "uint64"},
+            {"name": "b", "type": "int64"},
+            {"name": "c", "type": "uint32"},
+            {"name": "d", "type": "int16"},
+            {"name": "e", "type": "name[]"},
+            {"name": "f", "type": "checksum256?"},
+            {"name": "g", "type": "checksum256?"},
+         ]}
+      ],
+   })";
+
+   abi_serializer abis(fc::json::from_string(abi).as<abi_def>(), abi_serializer::create_yield_function( max_serialization_time ));
+
+   // the json written straight from the binary must be the one fc::json writes for the variant
+   fc::datastream<size_t> ps;
+   const auto pack = [](auto& ds) {
+      fc::raw::pack( ds, uint64_t(0x100000000ull) );
+      fc::raw::pack( ds, int64_t(-5) );
+      fc::raw::pack( ds, uint32_t(0xffffffff) );
+      fc::raw::pack( ds, int16_t(-300) );
+      fc::raw::pack( ds, std::vector<name>{ "alice"_n, "bob"_n } );
+      fc::raw::pack( ds, std::optional<fc::sha256>{ fc::sha256::hash(std::string("x")) } );
+      fc::raw::pack( ds, std::optional<fc::sha256>{} );
+   };
+   pack(ps);
+   bytes bin(ps.tellp());
+   fc::datastream<char*> ds(bin.data(), bin.size());
+   pack(ds);
+
+   const auto var = abis.binary_to_variant("s", bin, abi_serializer::create_yield_function( max_serialization_time ));
+   BOOST_REQUIRE_EQUAL( abis.binary_to_json("s", bin, abi_serializer::create_yield_function( max_serialization_time )), fc::json::to_string(var, fc::time_point::now() + max_serialization_time) );
+   BOOST_CHECK_EQUAL( var["a"].as_string(), "4294967296" );
+   BOOST_CHECK_EQUAL( var["e"].get_array().size(), 2u );
+   BOOST_CHECK( var["g"].is_null() );
+}
+
+BOOST_AUTO_TEST_CASE(binary_to_json_derived_field_overrides_base)
+{
+   auto abi = R"({
+      "version": "eosio::abi/1.1",
+      "structs": [
+         {"name": "b", "base": "", "fields": [
+            {"name": "a", "type": "uint8"},
+            {"name": "c", "type": "string"},
+         ]},
+         {"name": "d", "base": "b", "fields": [
+            {"name": "a", "type": "string"},
+            {"name": "e", "type": "uint8"},
+         ]}
+      ],
+   })";
+
+   abi_serializer abis(fc::json::from_string(abi).as<abi_def>(), abi_serializer::create_yield_function( max_serialization_time ));
+
+   fc::datastream<size_t> ps;
+   const auto pack = [](auto& ds) {
+      fc::raw::pack( ds, uint8_t(1) );
+      fc::raw::pack( ds, std::string("base") );
+      fc::raw::pack( ds, std::string("derived") );
+      fc::raw::pack( ds, uint8_t(2) );
+   };
+   pack(ps);
+   bytes bin(ps.tellp());
+   fc::datastream<char*> ds(bin.data(), bin.size());
+   pack(ds);
+
+   // the field of the derived struct keeps the position of the base struct field, as in the variant
+   const auto var = abis.binary_to_variant("d", bin, abi_serializer::create_yield_function( max_serialization_time ));
+   BOOST_REQUIRE_EQUAL( fc::json::to_string(var, fc::time_point::now() + max_serialization_time), R"({"a":"derived","c":"base","e":2})" );
+   BOOST_REQUIRE_EQUAL( abis.binary_to_json("d", bin, abi_serializer::create_yield_function( max_serialization_time )), R"({"a":"derived","c":"base","e":2})" );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -294,6 +294,26 @@ BOOST_AUTO_TEST_CASE(link_then_update_auth) { try {
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE(link_within_block) { try {
+   TESTER chain;
+
+   chain.create_account(name("alice"));
+   chain.produce_block();
+
+   const auto first_priv_key = chain.get_private_key(name("alice"), "first");
+   chain.set_authority(name("alice"), name("first"), first_priv_key.get_public_key(), name("active"));
+   chain.produce_block();
+
+   // Without a link the minimum permission is active; the failed lookup must not be reused once the link exists
+   BOOST_CHECK_THROW(chain.push_reqauth(name("alice"), { permission_level{"alice"_n, name("first")} }, { first_priv_key }), irrelevant_auth_exception);
+
+   chain.link_authority(name("alice"), name("eosio"), name("first"), name("reqauth"));
+   chain.push_reqauth(name("alice"), { permission_level{"alice"_n, name("first")} }, { first_priv_key });
+
+   chain.produce_block();
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE(create_account) {
 try {
    TESTER chain;
@@ -0,0 +1,307 @@
+#define BOOST_TEST_NO_MAIN
+#include <boost/test/included/unit_test.hpp>
+
+#include <eosio/testing/tester.hpp>
+#include <eosio/chain/exceptions.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/exception/diagnostic_information.hpp>
+#include <boost/program_options.hpp>
+
+#include <contracts.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+using namespace eosio::chain;
+using namespace eosio::testing;
+namespace bpo = boost::program_options;
+
+namespace {
+
+struct run_args {
+   uint32_t count = 0;
+   uint64_t nonce = 0; ///< makes every transaction unique
+};
+
+} // namespace
+
+FC_REFLECT( run_args, (count)(nonce) )
+
+namespace {
+
+// Runs BODY count times, count being the first field of the action data.
+// The locals $x and $i and the receiver $r are available to BODY
+const char* kernel_wast = R"=====(
+(module
+ (import "env" "read_action_data" (func $read_action_data (param i32 i32) (result i32)))
+ (import "env" "current_time" (func $current_time (result i64)))
+ (import "env" "is_account" (func $is_account (param i64) (result i32)))
+ (import "env" "require_auth" (func $require_auth (param i64)))
+ (import "env" "memcpy" (func $memcpy (param i32 i32 i32) (result i32)))
+ (import "env" "sha256" (func $sha256 (param i32 i32 i32)))
+ (import "env" "db_find_i64" (func $db_find_i64 (param i64 i64 i64 i64) (result i32)))
+ (table 0 anyfunc)
+ (memory $0 PAGES)
+ (data (i32.const 4096) "TAG")
+ (export "apply" (func $apply))
+ (func $apply (param $r i64) (param $account i64) (param $action i64)
+  (local $i i32)
+  (local $x i64)
+  (drop (call $read_action_data (i32.const 0) (i32.const 16)))
+  (set_local $i (i32.load (i32.const 0)))
+  (block $done
+   (loop $next
+    (br_if $done (i32.eqz (get_local $i)))
+    BODY
+    (set_local $i (i32.sub (get_local $i) (i32.const 1)))
+    (br $next)))
+ )
+)
+)=====";
+
+struct kernel {
+   const char* name;
+   const char* body;
+};
+
+// loop is the baseline the other kernels are compared to
+const std::vector<kernel> kernels = {
+   { "loop",             "" },
+   { "compute",          "(set_local $x (i64.add (i64.mul (get_local $x) (i64.const 6364136223846793005)) (i64.const 1442695040888963407)))" },
+   { "memory",           "(i64.store (i32.and (i32.mul (get_local $i) (i32.const 4099)) (i32.const 65528)) (i64.extend_u/i32 (get_local $i)))" },
+   { "current_time",     "(drop (call $current_time))" },
+   { "is_account",       "(drop (call $is_account (get_local $r)))" },
+   { "require_auth",     "(call $require_auth (get_local $r))" },
+   { "read_action_data", "(drop (call $read_action_data (i32.const 64) (i32.const 12)))" },
+   { "memcpy",           "(drop (call $memcpy (i32.const 1024) (i32.const 0) (i32.const 256)))" },
+   { "sha256",           "(call $sha256 (i32.const 0) (i32.const 64) (i32.const 128))" },
+   { "db_find_i64",      "(drop (call $db_find_i64 (get_local $r) (get_local $r) (get_local $r) (i64.const 0)))" },
+};
+
+std::string make_wast( const kernel& k, uint32_t pages, const std::string& tag ) {
+   std::string wast = kernel_wast;
+   boost::replace_first( wast, "PAGES", std::to_string( pages ) );
+   boost::replace_first( wast, "TAG", tag );
+   boost::replace_first( wast, "BODY", k.body );
+   return wast;
+}
+
+struct options {
+   std::vector<std::string> runtimes;
+   uint32_t                 iterations     = 20;
+   uint32_t                 calls          = 10'000;
+   uint32_t                 instantiations = 5;
+   uint32_t                 transfers      = 1'000;
+   std::string              output_file;
+};
+
+std::optional<wasm_interface::vm_type> parse_runtime( const std::string& r ) {
+#ifdef EOSIO_EOS_VM_RUNTIME_ENABLED
+   if( r == "eos-vm" ) return wasm_interface::vm_type::eos_vm;
+#endif
+#ifdef EOSIO_EOS_VM_JIT_RUNTIME_ENABLED
+   if( r == "eos-vm-jit" ) return wasm_interface::vm_type::eos_vm_jit;
+#endif
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+   if( r == "eos-vm-oc" ) return wasm_interface::vm_type::eos_vm_oc;
+#endif
+   return {};
+}
+
+double median( std::vector<fc::microseconds> v ) {
+   EOS_ASSERT( !v.empty(), misc_exception, "no samples" );
+   std::sort( v.begin(), v.end() );
+   return v[v.size() / 2].count();
+}
+
+/// a chain on one runtime, pushing actions without an ABI and timing them by the elapsed time of their trace
+class bench_chain {
+ public:
+   bench_chain( wasm_interface::vm_type runtime )
+   : chain( tempdir, [runtime]( controller::config& cfg ) {
+        cfg.wasm_runtime = runtime;
+        cfg.contracts_console = false;
+        cfg.state_size = 1024 * 1024 * 256;
+        cfg.eosvmoc_config.cache_size = 1024 * 1024 * 64;
+     }, true ) {
+      chain.execute_setup_policy( setup_policy::full );
+   }
+
+   void deploy( account_name a, const std::string& wast ) {
+      if( !chain.control->db().find<account_object, by_name>( a ) )
+         chain.create_account( a );
+      chain.set_code( a, wast.c_str() );
+      chain.produce_block();
+   }
+
+   /// @return elapsed time of the action, which includes instantiating or resetting the module but not the transaction
+   fc::microseconds run( account_name a, uint32_t count ) {
+      signed_transaction trx;
+      trx.actions.emplace_back( vector<permission_level>{{a, config::active_name}}, a, "run"_n,
+                                fc::raw::pack( run_args{ count, ++nonce } ) );
+      chain.set_transaction_headers( trx );
+      trx.sign( chain.get_private_key( a, "active" ), chain.control->get_chain_id() );
+      auto trace = chain.push_transaction( trx );
+      if( ++pushed % 50 == 0 )
+         chain.produce_block();
+      return trace->action_traces.at( 0 ).elapsed;
+   }
+
+   double median_run( account_name a, uint32_t count, uint32_t iterations ) {
+      std::vector<fc::microseconds> samples;
+      run( a, count ); // warm up
+      for( uint32_t i = 0; i < iterations; ++i )
+         samples.push_back( run( a, count ) );
+      return median( std::move( samples ) );
+   }
+
+   fc::temp_directory tempdir;
+   tester             chain;
+   uint64_t           nonce  = 0;
+   uint64_t           pushed = 0;
+};
+
+fc::mutable_variant_object bench_runtime( const std::string& runtime_name, wasm_interface::vm_type runtime, const options& opts ) {
+   bench_chain b( runtime );
+   fc::mutable_variant_object result;
+   result( "runtime", runtime_name );
+
+   // cost of one iteration of each kernel over the empty loop, which also cancels the cost of the action
+   const auto& loop = kernels.front();
+   b.deploy( "bench.loop"_n, make_wast( loop, 1, "loop" ) );
+   const double loop_us     = b.median_run( "bench.loop"_n, opts.calls, opts.iterations );
+   const double dispatch_us = b.median_run( "bench.loop"_n, 0, opts.iterations );
+   result( "action_us", dispatch_us );
+   result( "loop_ns", (loop_us - dispatch_us) * 1000 / opts.calls );
+
+   fc::mutable_variant_object per_call_ns;
+   for( const auto& k : kernels ) {
+      if( &k == &loop )
+         continue;
+      // names only allow a-z, 1-5 and '.'
+      const account_name a( "bench.k" + std::string( 1, char( 'a' + ( &k - &kernels.front() ) ) ) );
+      b.deploy( a, make_wast( k, 1, k.name ) );
+      const double us = b.median_run( a, opts.calls, opts.iterations );
+      per_call_ns( k.name, (us - loop_us) * 1000 / opts.calls );
+   }
+   result( "per_call_ns", std::move( per_call_ns ) );
+
+   // the cost of the initial memory, which every action starts from
+   fc::mutable_variant_object memory_reset_us;
+   char suffix = 'a';
+   for( uint32_t pages : { 1, 16, 64, 256 } ) {
+      const account_name a( "bench.mem" + std::string( 1, suffix++ ) );
+      b.deploy( a, make_wast( loop, pages, "pages" ) );
+      memory_reset_us( std::to_string( pages * 64 ) + "KiB", b.median_run( a, 0, opts.iterations ) );
+   }
+   result( "memory_reset_us", std::move( memory_reset_us ) );
+
+   // the first action of a new code over the next ones; every code is new since its data segment differs
+   std::vector<fc::microseconds> instantiation;
+   const auto& compute = kernels[1];
+   for( uint32_t i = 0; i < opts.instantiations; ++i ) {
+      b.deploy( "bench.inst"_n, make_wast( compute, 1, "instance" + std::to_string( i ) ) );
+      const auto first = b.run( "bench.inst"_n, 0 );
+      const double steady = b.median_run( "bench.inst"_n, 0, opts.iterations );
+      instantiation.push_back( fc::microseconds( first.count() - int64_t( steady ) ) );
+   }
+   result( "instantiation_us", median( std::move( instantiation ) ) );
+
+   // a contract workload: transfers of eosio.token, timed as whole transactions
+   auto& t = b.chain;
+   t.create_accounts( { "eosio.token"_n, "alice"_n, "bob"_n } );
+   t.set_code( "eosio.token"_n, contracts::eosio_token_wasm() );
+   t.set_abi( "eosio.token"_n, contracts::eosio_token_abi().data() );
+   t.push_action( "eosio.token"_n, "create"_n, "eosio.token"_n,
+                  fc::mutable_variant_object()( "issuer", "eosio.token" )( "maximum_supply", "1000000000.0000 BEN" ) );
+   t.push_action( "eosio.token"_n, "issue"_n, "eosio.token"_n,
+                  fc::mutable_variant_object()( "to", "eosio.token" )( "quantity", "1000000000.0000 BEN" )( "memo", "" ) );
+   t.push_action( "eosio.token"_n, "transfer"_n, "eosio.token"_n,
+                  fc::mutable_variant_object()( "from", "eosio.token" )( "to", "alice" )( "quantity", "1000000000.0000 BEN" )( "memo", "" ) );
+   t.produce_block();
+   std::vector<fc::microseconds> transfer_action;
+   const auto start = std::chrono::steady_clock::now();
+   for( uint32_t i = 0; i < opts.transfers; ++i ) {
+      auto trace = t.push_action( "eosio.token"_n, "transfer"_n, "alice"_n,
+                                  fc::mutable_variant_object()( "from", "alice" )( "to", "bob" )
+                                     ( "quantity", "0.0001 BEN" )( "memo", std::to_string( i ) ) );
+      transfer_action.push_back( trace->action_traces.at( 0 ).elapsed );
+      if( i % 50 == 49 )
+         t.produce_block();
+   }
+   const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+   result( "token_transfer_action_us", median( std::move( transfer_action ) ) );
+   result( "token_transfers_per_second", opts.transfers / seconds );
+
+   return result;
+}
+
+} // namespace
+
+int main( int argc, char** argv ) {
+   options opts;
+   bpo::options_description cli( "wasm_benchmark command line options" );
+   cli.add_options()
+      ( "runtime,r", bpo::value<std::vector<std::string>>( &opts.runtimes )->composing(),
+        "runtime to benchmark: eos-vm, eos-vm-jit or eos-vm-oc, may be specified multiple times; all runtimes of the build by default" )
+      ( "iterations,i", bpo::value<uint32_t>( &opts.iterations )->default_value( opts.iterations ),
+        "actions timed for each measurement, of which the median is reported" )
+      ( "calls,c", bpo::value<uint32_t>( &opts.calls )->default_value( opts.calls ),
+        "iterations of the kernel within one action" )
+      ( "instantiations", bpo::value<uint32_t>( &opts.instantiations )->default_value( opts.instantiations ),
+        "new codes deployed to measure the first action of a code" )
+      ( "transfers", bpo::value<uint32_t>( &opts.transfers )->default_value( opts.transfers ),
+        "eosio.token transfers pushed" )
+      ( "output-file,o", bpo::value<std::string>( &opts.output_file ),
+        "also write the results as JSON to this file" )
+      ( "help,h", "print this help message and exit" );
+
+   try {
+      bpo::variables_map vmap;
+      bpo::store( bpo::parse_command_line( argc, argv, cli ), vmap );
+      bpo::notify( vmap );
+      if( vmap.count( "help" ) ) {
+         cli.print( std::cerr );
+         return 0;
+      }
+      if( opts.runtimes.empty() ) {
+         for( const char* r : { "eos-vm", "eos-vm-jit", "eos-vm-oc" } )
+            if( parse_runtime( r ) )
+               opts.runtimes.push_back( r );
+      }
+      EOS_ASSERT( opts.iterations > 0 && opts.calls > 0 && opts.instantiations > 0 && opts.transfers > 0, misc_exception,
+                  "iterations, calls, instantiations and transfers must be greater than 0" );
+
+      fc::logger::get( DEFAULT_LOGGER ).set_log_level( fc::log_level::off );
+
+      fc::variants results;
+      for( const auto& r : opts.runtimes ) {
+         const auto runtime = parse_runtime( r );
+         EOS_ASSERT( runtime, misc_exception, "runtime ${r} is unknown or not part of this build", ("r", r) );
+         results.emplace_back( bench_runtime( r, *runtime, opts ) );
+         std::cout << fc::json::to_pretty_string( results.back() ) << std::endl;
+      }
+      if( !opts.output_file.empty() ) {
+         std::ofstream out( opts.output_file );
+         out << fc::json::to_pretty_string( results ) << std::endl;
+         EOS_ASSERT( out.good(), misc_exception, "Unable to write ${f}", ("f", opts.output_file) );
+      }
+   } catch( const fc::exception& e ) {
+      std::cerr << e.to_detail_string() << std::endl;
+      return 1;
+   } catch( const boost::exception& e ) {
+      std::cerr << boost::diagnostic_information( e ) << std::endl;
+      return 1;
+   } catch( const std::exception& e ) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+   }
+   return 0;
+}
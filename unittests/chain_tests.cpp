@@ -1,4 +1,6 @@
+#include <eosio/chain/account_object.hpp>
 #include <eosio/chain/controller.hpp>
+#include <eosio/chain/contract_types.hpp>
 #include <eosio/chain/global_property_object.hpp>
 #include <eosio/chain/permission_object.hpp>
 #include <eosio/chain/resource_limits.hpp>
@@ -22,15 +24,15 @@ BOOST_AUTO_TEST_CASE( replace_producer_keys ) try {
    const auto new_key = get_public_key(name("newkey"), config::active_name.to_string());
 
    // make sure new keys is not used
-   for(const auto& prod : head_ptr->active_schedule.producers) {
+   for(const auto& prod : head_ptr->active_schedule->producers) {
       for(const auto& key : std::get<block_signing_authority_v0>(prod.authority).keys){  
          BOOST_REQUIRE(key.key != new_key);
       }
    }
 
-   const auto old_version = head_ptr->pending_schedule.schedule.version;
+   const auto old_version = head_ptr->pending_schedule.schedule->version;
    BOOST_REQUIRE_NO_THROW(tester.control->replace_producer_keys(new_key));
-   const auto new_version = head_ptr->pending_schedule.schedule.version;
+   const auto new_version = head_ptr->pending_schedule.schedule->version;
    // make sure version not been changed
    BOOST_REQUIRE(old_version == new_version);
 
@@ -41,7 +43,7 @@ BOOST_AUTO_TEST_CASE( replace_producer_keys ) try {
 
    const uint32_t expected_threshold = 1;
    const weight_type expected_key_weight = 1;
-   for(const auto& prod : head_ptr->active_schedule.producers) {
+   for(const auto& prod : head_ptr->active_schedule->producers) {
       BOOST_REQUIRE_EQUAL(std::get<block_signing_authority_v0>(prod.authority).threshold, expected_threshold);
       for(const auto& key : std::get<block_signing_authority_v0>(prod.authority).keys){
          BOOST_REQUIRE_EQUAL(key.key, new_key);
@@ -74,4 +76,103 @@ BOOST_AUTO_TEST_CASE( replace_account_keys ) try {
 
 } FC_LOG_AND_RETHROW()
 
+BOOST_AUTO_TEST_CASE( dry_run_transaction ) try {
+   tester chain;
+   chain.create_account( "alice"_n );
+   chain.produce_block();
+
+   signed_transaction trx;
+   chain.set_transaction_headers( trx );
+   trx.actions.emplace_back( vector<permission_level>{{"alice"_n, config::active_name}},
+                             newaccount{
+                                .creator  = "alice"_n,
+                                .name     = "bob"_n,
+                                .owner    = authority( chain.get_public_key( "bob"_n, "owner" ) ),
+                                .active   = authority( chain.get_public_key( "bob"_n, "active" ) ),
+                             });
+   // deliberately unsigned: dry-run transactions skip the authorization check
+   auto ptrx = std::make_shared<packed_transaction>( signed_transaction(trx), true );
+
+   const auto receipts_before = chain.control->get_pending_trx_receipts().size();
+   auto trace = chain.control->push_transaction( transaction_metadata::create_no_recover_keys( ptrx, transaction_metadata::trx_type::dry_run ),
+                                                 fc::time_point::maximum(), 0, false, 0 );
+   BOOST_REQUIRE( !trace->except );
+   BOOST_REQUIRE_EQUAL( trace->action_traces.size(), 1u );
+   BOOST_CHECK( !trace->receipt );
+   BOOST_CHECK_EQUAL( chain.control->get_pending_trx_receipts().size(), receipts_before );
+   BOOST_CHECK( chain.control->db().find<account_object, by_name>( "bob"_n ) == nullptr );
+   BOOST_CHECK( !chain.control->is_known_unexpired_transaction( ptrx->id() ) );
+
+   // the same transaction can still be pushed for real once signed
+   trx.sign( chain.get_private_key( "alice"_n, "active" ), chain.control->get_chain_id() );
+   chain.push_transaction( trx );
+   chain.produce_block();
+   BOOST_CHECK( chain.control->db().find<account_object, by_name>( "bob"_n ) != nullptr );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE( fast_tester_batches ) try {
+   fast_tester chain;
+
+   // the state after the full setup policy comes from the snapshot
+   BOOST_REQUIRE( chain.control->is_builtin_activated( builtin_protocol_feature_t::preactivate_feature ) );
+   const auto start_block_num = chain.control->head_block_num();
+
+   vector<signed_transaction> trxs;
+   for( const auto n : { "alice"_n, "bob"_n, "carol"_n, "dave"_n } ) {
+      signed_transaction trx;
+      trx.actions.emplace_back( vector<permission_level>{{config::system_account_name, config::active_name}},
+                                newaccount{ .creator = config::system_account_name, .name = n,
+                                            .owner = authority( base_tester::get_public_key( n, "owner" ) ),
+                                            .active = authority( base_tester::get_public_key( n, "active" ) ) } );
+      chain.set_transaction_headers( trx );
+      trx.sign( base_tester::get_private_key( config::system_account_name, "active" ), chain.control->get_chain_id() );
+      trxs.push_back( std::move( trx ) );
+   }
+   const auto traces = chain.push_transactions( trxs );
+   BOOST_REQUIRE_EQUAL( traces.size(), trxs.size() );
+   const auto block = chain.produce_block();
+   BOOST_CHECK_EQUAL( block->block_num(), start_block_num + 1 );
+   BOOST_CHECK_EQUAL( block->transactions.size(), trxs.size() );
+   BOOST_CHECK( chain.control->db().find<account_object, by_name>( "dave"_n ) );
+
+   // a duplicate fails unless asked not to throw
+   BOOST_CHECK_THROW( chain.push_transactions( { trxs[0] } ), fc::exception );
+   BOOST_CHECK( chain.push_transactions( { trxs[0] }, true )[0]->except );
+
+   // each fast_tester starts from the same state
+   fast_tester other;
+   BOOST_CHECK_EQUAL( other.control->head_block_num(), start_block_num );
+   BOOST_CHECK( !other.control->db().find<account_object, by_name>( "dave"_n ) );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE( clone_chain_state ) try {
+   validating_tester chain;
+   chain.create_account( "alice"_n );
+   chain.produce_block();
+
+   // scenarios branched from the prepared state do not see each other
+   validating_tester branch( chain );
+   fast_tester fast( chain );
+   BOOST_CHECK_EQUAL( branch.control->head_block_id(), chain.control->head_block_id() );
+   BOOST_CHECK_EQUAL( fast.control->head_block_id(), chain.control->head_block_id() );
+
+   branch.set_async_validation( true );
+   branch.create_account( "bob"_n, "alice"_n );
+   branch.produce_blocks( 3 );
+   fast.create_account( "carol"_n, "alice"_n );
+   fast.produce_block();
+
+   BOOST_CHECK( branch.control->db().find<account_object, by_name>( "bob"_n ) );
+   BOOST_CHECK( !branch.control->db().find<account_object, by_name>( "carol"_n ) );
+   BOOST_CHECK( fast.control->db().find<account_object, by_name>( "carol"_n ) );
+   BOOST_CHECK( !chain.control->db().find<account_object, by_name>( "bob"_n ) );
+   BOOST_CHECK( !chain.control->db().find<account_object, by_name>( "carol"_n ) );
+
+   // the blocks validated on the worker thread reach the validating node of the branch
+   branch.wait_for_validation();
+   BOOST_CHECK_EQUAL( branch.validating_node->head_block_id(), branch.control->head_block_id() );
+   BOOST_CHECK( branch.validate() );
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()
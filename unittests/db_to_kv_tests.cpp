@@ -846,6 +846,57 @@ BOOST_AUTO_TEST_CASE(prefix_key_conversions_test) {
    BOOST_CHECK_EQUAL(table.to_string(), decomposed_table.to_string());
 }
 
+template<typename Key>
+void verify_full_secondary_keys(const Key& sec_key) {
+   namespace kv_format = eosio::chain::backing_store::db_key_value_format;
+   const name code = "mycontract"_n;
+   const name scope = "myscope"_n;
+   const name table = "thisscope"_n;
+   const uint64_t primary_key = 0x0123456789abcdef;
+   BOOST_CHECK(kv_format::create_full_secondary_key(code, scope, table, sec_key, primary_key) ==
+               kv_format::create_full_key(kv_format::create_secondary_key(scope, table, sec_key, primary_key), code));
+   BOOST_CHECK(kv_format::create_full_prefix_secondary_key(code, scope, table, sec_key) ==
+               kv_format::create_full_key(kv_format::create_prefix_secondary_key(scope, table, sec_key), code));
+
+   // decoded in place from the full key
+   const auto full_key = kv_format::create_full_secondary_key(code, scope, table, sec_key, primary_key);
+   const auto type_prefix = kv_format::create_full_prefix_key(code, scope, table, kv_format::derive_secondary_key_type<Key>());
+   Key decomposed_sec_key;
+   uint64_t decomposed_primary_key = 0;
+   BOOST_REQUIRE(kv_format::get_trailing_sec_prim_keys(full_key, type_prefix, decomposed_sec_key, decomposed_primary_key));
+   BOOST_CHECK(kv_format::create_full_secondary_key(code, scope, table, decomposed_sec_key, decomposed_primary_key) == full_key);
+   BOOST_CHECK_EQUAL(primary_key, decomposed_primary_key);
+}
+
+BOOST_AUTO_TEST_CASE(full_key_builder_test) {
+   namespace kv_format = eosio::chain::backing_store::db_key_value_format;
+   const name code = "mycontract"_n;
+   const name scope = "myscope"_n;
+   const name table = "thisscope"_n;
+   const uint64_t key = 0xdead87654321beef;
+   const auto full_primary_key = kv_format::create_full_primary_key(code, scope, table, key);
+   BOOST_CHECK(full_primary_key == kv_format::create_full_key(kv_format::create_primary_key(scope, table, key), code));
+   BOOST_CHECK(kv_format::create_full_prefix_key(code, scope, table) ==
+               kv_format::create_full_key(kv_format::create_prefix_key(scope, table), code));
+   BOOST_CHECK(kv_format::create_full_prefix_key(code, scope, table, key_type::table) ==
+               kv_format::create_full_key(kv_format::create_table_key(scope, table), code));
+
+   const auto primary_prefix = kv_format::create_full_prefix_key(code, scope, table, key_type::primary);
+   uint64_t decomposed_key = 0;
+   BOOST_REQUIRE(kv_format::get_primary_key(full_primary_key, primary_prefix, decomposed_key));
+   BOOST_CHECK_EQUAL(key, decomposed_key);
+   const auto parsed = kv_format::parse_full_key(full_primary_key);
+   BOOST_REQUIRE(parsed.contract);
+   BOOST_CHECK_EQUAL(code.to_string(), parsed.contract->to_string());
+
+   verify_full_secondary_keys<uint64_t>(key);
+   verify_full_secondary_keys<eosio::chain::uint128_t>(create_uint128(0xdead12345678beef, 0x0123456789abcdef));
+   verify_full_secondary_keys<eosio::chain::key256_t>(create_key256(create_uint128(0xdead12345678beef, 0x0123456789abcdef),
+                                                                    create_uint128(0x0123456789abcdef, 0xdead12345678beef)));
+   verify_full_secondary_keys<float64_t>(to_softfloat64(-3.25));
+   verify_full_secondary_keys<float128_t>(to_softfloat128(1234.5));
+}
+
 BOOST_AUTO_TEST_CASE(compare_key_type_order_test) {
    std::vector<b1::chain_kv::bytes> composite_keys;
    // enforce the order for the different key types with the same scope and table
@@ -338,6 +338,31 @@ BOOST_AUTO_TEST_CASE( prune_remove_branch ) try {
 } FC_LOG_AND_RETHROW()
 
 
+BOOST_AUTO_TEST_CASE( fork_database_memory_usage ) try {
+   tester c;
+   c.create_accounts( {"dan"_n,"sam"_n,"pam"_n,"scott"_n} );
+   c.set_producers( {"dan"_n,"sam"_n,"pam"_n,"scott"_n} );
+   c.produce_blocks(50);
+
+   auto find = [&]( const std::string& subsystem ) {
+      auto usage = c.control->get_memory_usage();
+      auto it = std::find_if( usage.begin(), usage.end(), [&]( const auto& m ) { return m.subsystem == subsystem; } );
+      BOOST_REQUIRE( it != usage.end() );
+      return *it;
+   };
+
+   // the fork database holds the blocks after the last irreversible block
+   auto fork_db = find( "fork_database" );
+   BOOST_REQUIRE_GT( c.control->head_block_num(), c.control->last_irreversible_block_num() );
+   BOOST_CHECK_EQUAL( fork_db.entries, c.control->head_block_num() - c.control->last_irreversible_block_num() );
+   BOOST_CHECK_GE( fork_db.bytes, fork_db.entries * sizeof(block_state) );
+
+   c.produce_block();
+   BOOST_CHECK_EQUAL( find( "fork_database" ).entries, c.control->head_block_num() - c.control->last_irreversible_block_num() );
+
+   BOOST_CHECK_GT( find( "wasm_instantiation_cache" ).entries, 0u );
+} FC_LOG_AND_RETHROW()
+
 /**
  *  Tests that a validating node does not accept a block which is considered invalid by another node.
  */
@@ -779,4 +804,49 @@ BOOST_AUTO_TEST_CASE( push_block_returns_forked_transactions ) try {
 } FC_LOG_AND_RETHROW()
 
 
+BOOST_AUTO_TEST_CASE( fork_switch_reuses_forked_trx_metadata ) try {
+   tester c;
+   c.produce_blocks(2);
+   tester c2(setup_policy::none);
+   push_blocks(c, c2);
+
+   signed_transaction trx;
+   authority active_auth( get_public_key( "test1"_n, "active" ) );
+   authority owner_auth( get_public_key( "test1"_n, "owner" ) );
+   trx.actions.emplace_back( vector<permission_level>{{config::system_account_name,config::active_name}},
+                             newaccount{
+                                   .creator  = config::system_account_name,
+                                   .name     = "test1"_n,
+                                   .owner    = owner_auth,
+                                   .active   = active_auth,
+                             });
+   trx.expiration = c.control->head_block_time() + fc::seconds( 60 );
+   trx.set_reference_block( c.control->head_block_id() );
+   trx.sign( get_private_key( config::system_account_name, "active" ), c.control->get_chain_id()  );
+
+   // the same transaction in a block of each fork, c2's fork is longer
+   c.push_transaction( trx );
+   auto a1 = c.produce_block();
+   c2.push_transaction( trx );
+   auto b1 = c2.produce_block( fc::milliseconds(config::block_interval_ms) );
+   auto b2 = c2.produce_block();
+
+   const auto forked_metas = c.control->fetch_block_state_by_id( a1->calculate_id() )->trxs_metas();
+   BOOST_REQUIRE_EQUAL( forked_metas.size(), 1u );
+
+   // without any lookup of the caller, the metadata of the popped block is used
+   c.control->abort_block();
+   for( const auto& b : { b1, b2 } ) {
+      auto bsf = c.control->create_block_state_future( b->calculate_id(), b );
+      c.control->push_block( bsf, forked_branch_callback{}, trx_meta_cache_lookup{} );
+   }
+   BOOST_REQUIRE_EQUAL( c.control->head_block_id(), b2->calculate_id() );
+
+   const auto b1_bsp = c.control->fetch_block_state_by_id( b1->calculate_id() );
+   BOOST_REQUIRE_EQUAL( b1_bsp->trxs_metas().size(), 1u );
+   BOOST_CHECK( b1_bsp->trxs_metas().front() == forked_metas.front() );
+   BOOST_CHECK( b1_bsp->is_pub_keys_recovered() );
+
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -3,7 +3,12 @@
 #include <eosio/chain/authority_checker.hpp>
 #include <eosio/chain/types.hpp>
 #include <eosio/chain/thread_utils.hpp>
+#include <eosio/chain/non_consensus_executor.hpp>
 #include <eosio/chain/block_log.hpp>
+#include <eosio/chain/transaction_id_filter.hpp>
+#include <eosio/chain/signature_cache.hpp>
+#include <eosio/chain/block_apply_metrics.hpp>
+#include <eosio/chain/signal_slots.hpp>
 #include <eosio/testing/tester.hpp>
 
 #include <fc/io/json.hpp>
@@ -11,6 +16,8 @@
 #include <appbase/execution_priority_queue.hpp>
 #include <fc/bitutil.hpp>
 
+#include <future>
+#include <numeric>
 #include <thread>
 
 #include <boost/test/unit_test.hpp>
@@ -342,6 +349,27 @@ BOOST_AUTO_TEST_CASE(asset_from_string_overflow)
    });
 }
 
+BOOST_AUTO_TEST_CASE(asset_to_string)
+{
+   BOOST_CHECK_EQUAL( asset::from_string("0 CUR").to_string(), "0 CUR" );
+   BOOST_CHECK_EQUAL( asset::from_string("-5 CUR").to_string(), "-5 CUR" );
+   BOOST_CHECK_EQUAL( asset::from_string("0.0000 CUR").to_string(), "0.0000 CUR" );
+   BOOST_CHECK_EQUAL( asset::from_string("1.0001 CUR").to_string(), "1.0001 CUR" );
+   BOOST_CHECK_EQUAL( asset::from_string("-0.0001 CUR").to_string(), "-0.0001 CUR" );
+   BOOST_CHECK_EQUAL( asset::from_string("0.000000000000000001 ABCDEFG").to_string(), "0.000000000000000001 ABCDEFG" );
+   BOOST_CHECK_EQUAL( asset( asset::max_amount, symbol(0, "CUR") ).to_string(), "4611686018427387903 CUR" );
+   BOOST_CHECK_EQUAL( asset( -asset::max_amount, symbol(18, "CUR") ).to_string(), "-4.611686018427387903 CUR" );
+
+   char buf[asset::max_string_size];
+   const asset a = asset::from_string("12.5 SYS");
+   BOOST_CHECK_EQUAL( std::string(buf, a.write_as_string(buf)), "12.5 SYS" );
+   BOOST_CHECK_EQUAL( a.symbol_name(), "SYS" );
+
+   // a zero byte before the last char of the name
+   BOOST_CHECK_THROW( symbol(SY(4,CUR) & ~uint64_t(0xFF00)), symbol_type_exception );
+   BOOST_CHECK( symbol(SY(4,CUR)).valid() );
+}
+
 struct permission_visitor {
    std::vector<permission_level> permissions;
    std::vector<size_t> size_stack;
@@ -985,6 +1013,18 @@ BOOST_AUTO_TEST_CASE(transaction_metadata_test) { try {
       BOOST_CHECK_EQUAL(1u, keys3.size());
       BOOST_CHECK_EQUAL(public_key, *keys3.begin());
 
+      // the keys of several transactions recovered in fewer tasks, one future per transaction in order
+      std::vector<packed_transaction_ptr> ptrxs{ ptrx, ptrx2, ptrx, ptrx2, ptrx };
+      auto futs = transaction_metadata::start_recover_keys( ptrxs, thread_pool.get_executor(), test.control->get_chain_id(), fc::microseconds::maximum(), 2 );
+      BOOST_REQUIRE_EQUAL(ptrxs.size(), futs.size());
+      for( size_t i = 0; i < futs.size(); ++i ) {
+         auto m = futs[i].get();
+         BOOST_CHECK(m->packed_trx() == ptrxs[i]);
+         BOOST_CHECK_EQUAL(1u, m->recovered_keys().size());
+         BOOST_CHECK_EQUAL(public_key, *m->recovered_keys().begin());
+      }
+      BOOST_CHECK(transaction_metadata::start_recover_keys( std::vector<packed_transaction_ptr>{}, thread_pool.get_executor(), test.control->get_chain_id(), fc::microseconds::maximum(), 2 ).empty());
+
       thread_pool.stop();
 
 } FC_LOG_AND_RETHROW() }
@@ -1398,6 +1438,258 @@ BOOST_AUTO_TEST_CASE(bad_alloc_test) {
    BOOST_CHECK( ptr == nullptr );
 }
 
+BOOST_AUTO_TEST_CASE(merkle_canonical_pairs) { try {
+   // reference implementation hashing each canonical pair through the datastream encoder
+   auto reference_merkle = []( deque<digest_type> ids ) {
+      if( ids.empty() ) return digest_type();
+      while( ids.size() > 1 ) {
+         if( ids.size() % 2 )
+            ids.push_back( ids.back() );
+         for( size_t i = 0; i < ids.size() / 2; ++i )
+            ids[i] = digest_type::hash( make_canonical_pair( ids[2 * i], ids[(2 * i) + 1] ) );
+         ids.resize( ids.size() / 2 );
+      }
+      return ids.front();
+   };
+
+   deque<digest_type> ids;
+   BOOST_TEST( merkle( ids ) == digest_type() );
+   for( uint32_t n = 1; n <= 33; ++n ) {
+      ids.emplace_back( digest_type::hash( n ) );
+      BOOST_TEST( merkle( ids ) == reference_merkle( ids ) );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(transaction_id_filter_buckets) { try {
+   transaction_id_filter filter( 10, 1024 );
+
+   const auto id1 = transaction_id_type::hash( std::string("one") );
+   const auto id2 = transaction_id_type::hash( std::string("two") );
+   BOOST_TEST( !filter.may_contain( id1 ) );
+
+   filter.insert( id1, fc::time_point_sec( 105 ) );
+   filter.insert( id2, fc::time_point_sec( 125 ) );
+   BOOST_TEST( filter.may_contain( id1 ) );
+   BOOST_TEST( filter.may_contain( id2 ) );
+   BOOST_TEST( filter.bucket_count() == 2u );
+
+   // the bucket of id1 spans [100,110) and must survive until everything in it has expired
+   filter.prune( fc::time_point_sec( 109 ) );
+   BOOST_TEST( filter.may_contain( id1 ) );
+   filter.prune( fc::time_point_sec( 110 ) );
+   BOOST_TEST( !filter.may_contain( id1 ) );
+   BOOST_TEST( filter.may_contain( id2 ) );
+   BOOST_TEST( filter.bucket_count() == 1u );
+
+   BOOST_CHECK_THROW( transaction_id_filter( 10, 100 ), misc_exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(abi_serializer_cache_test) { try {
+   static const char* abi_v1 = R"({
+      "version": "eosio::abi/1.0",
+      "structs": [{"name": "hi", "base": "", "fields": [{"name": "user", "type": "name"}]}],
+      "actions": [{"name": "hi", "type": "hi", "ricardian_contract": ""}]
+   })";
+   static const char* abi_v2 = R"({
+      "version": "eosio::abi/1.0",
+      "structs": [{"name": "bye", "base": "", "fields": [{"name": "user", "type": "name"}]}],
+      "actions": [{"name": "bye", "type": "bye", "ricardian_contract": ""}]
+   })";
+
+   tester chain;
+   chain.create_accounts( {"alice"_n} );
+   auto& cache = chain.control->get_abi_serializer_cache();
+   const auto yield = abi_serializer::create_yield_function( tester::abi_serializer_max_time );
+   const auto get = [&]( account_name n ) { return cache.get( chain.control->db(), n, yield ); };
+
+   BOOST_TEST( !get( "alice"_n ) );
+   BOOST_TEST( !get( "nobody"_n ) );
+
+   chain.set_abi( "alice"_n, abi_v1 );
+   const auto v1 = get( "alice"_n );
+   BOOST_REQUIRE( v1 );
+   BOOST_TEST( v1 == get( "alice"_n ) );
+   BOOST_TEST( v1 == chain.control->get_abi_serializer( "alice"_n, yield ) );
+   BOOST_TEST( v1->get_action_type( "hi"_n ) == "hi" );
+
+   // setabi replaces the entry, while serializers handed out before stay usable
+   chain.set_abi( "alice"_n, abi_v2 );
+   const auto v2 = get( "alice"_n );
+   BOOST_REQUIRE( v2 );
+   BOOST_TEST( v2 != v1 );
+   BOOST_TEST( v2->get_action_type( "hi"_n ).empty() );
+   BOOST_TEST( v2->get_action_type( "bye"_n ) == "bye" );
+   BOOST_TEST( v1->get_action_type( "hi"_n ) == "hi" );
+
+   cache.clear();
+   BOOST_TEST( cache.size() == 0u );
+   BOOST_TEST( get( "alice"_n ) != v2 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(block_apply_metrics_test) { try {
+   block_apply_metrics metrics;
+   metrics.record( block_apply_metrics::stage::transactions, fc::microseconds( 50 ) );
+   metrics.record( block_apply_metrics::stage::transactions, fc::microseconds( 51 ) );
+   metrics.record( block_apply_metrics::stage::transactions, fc::seconds( 2 ) );
+   metrics.record( block_apply_metrics::stage::finalize_block, fc::microseconds( -1 ) );
+
+   const auto stages = metrics.snapshot();
+   BOOST_REQUIRE_EQUAL( stages.size(), static_cast<size_t>(block_apply_metrics::stage::num_stages) );
+   const auto& trxs = stages[static_cast<size_t>(block_apply_metrics::stage::transactions)];
+   BOOST_TEST( trxs.stage == "transactions" );
+   BOOST_REQUIRE_EQUAL( trxs.counts.size(), trxs.bucket_bounds_us.size() + 1 );
+   BOOST_TEST( trxs.counts[0] == 1u );
+   BOOST_TEST( trxs.counts[1] == 1u );
+   BOOST_TEST( trxs.counts.back() == 1u );
+   BOOST_TEST( trxs.total_us == 2'000'101u );
+   // negative durations, from a clock going backwards, count as 0
+   const auto& finalize = stages[static_cast<size_t>(block_apply_metrics::stage::finalize_block)];
+   BOOST_TEST( finalize.counts[0] == 1u );
+   BOOST_TEST( finalize.total_us == 0u );
+
+   {
+      block_apply_metrics::scoped_timer t( metrics, block_apply_metrics::stage::signals );
+   }
+   const auto& signals = metrics.snapshot()[static_cast<size_t>(block_apply_metrics::stage::signals)];
+   BOOST_TEST( std::accumulate( signals.counts.begin(), signals.counts.end(), uint64_t(0) ) == 1u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(signal_slots_test) { try {
+   auto slot = timed_slot( "misc_tests.slot", []( int a, int b ) {
+      if( a < 0 ) throw std::runtime_error( "negative" );
+      return a + b;
+   } );
+   BOOST_TEST( slot( 1, 2 ) == 3 );
+   BOOST_CHECK_THROW( slot( -1, 2 ), std::runtime_error );
+
+   const auto slots = signal_slot_metrics::shared().snapshot();
+   auto itr = std::find_if( slots.begin(), slots.end(), []( const auto& s ) { return s.slot == "misc_tests.slot"; } );
+   BOOST_REQUIRE( itr != slots.end() );
+   // calls which throw are counted too
+   BOOST_TEST( itr->calls == 2u );
+   BOOST_TEST( itr->max_us <= itr->total_us );
+
+   // handlers run in order, including those queued while the queue was full, and stop runs what is queued
+   std::vector<int> ran;
+   size_t errors = 0;
+   {
+      async_signal_queue queue( "misc-sig", 2, [&]( std::exception_ptr ) { ++errors; } );
+      for( int i = 0; i < 100; ++i ) {
+         queue.post( [&ran, i]() {
+            if( i == 50 ) throw std::runtime_error( "fifty" );
+            ran.push_back( i );
+         } );
+      }
+      queue.stop();
+      BOOST_TEST( queue.size() == 0u );
+      queue.post( [&ran]() { ran.push_back( -1 ); } );
+   }
+   std::vector<int> expected( 100 );
+   std::iota( expected.begin(), expected.end(), 0 );
+   expected.erase( expected.begin() + 50 );
+   BOOST_TEST( ran == expected );
+   BOOST_TEST( errors == 1u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(signature_cache_test) { try {
+   const auto key = private_key_type::regenerate<fc::ecc::private_key_shim>( fc::sha256::hash( std::string("sigcache") ) );
+   const auto digest1 = digest_type::hash( std::string("one") );
+   const auto digest2 = digest_type::hash( std::string("two") );
+   const auto sig1 = key.sign( digest1 );
+   const auto sig2 = key.sign( digest2 );
+
+   signature_cache disabled;
+   BOOST_TEST( disabled.recover( sig1, digest1 ) == key.get_public_key() );
+   BOOST_TEST( disabled.size() == 0u );
+
+   signature_cache cache( 1 );
+   BOOST_TEST( cache.recover( sig1, digest1 ) == key.get_public_key() );
+   BOOST_TEST( cache.recover( sig1, digest1 ) == key.get_public_key() );
+   BOOST_TEST( cache.size() == 1u );
+   // the same signature over another digest is another entry and recovers another key
+   BOOST_TEST( cache.recover( sig1, digest2 ) != key.get_public_key() );
+   BOOST_TEST( cache.size() == 1u );
+   BOOST_TEST( cache.recover( sig2, digest2 ) == key.get_public_key() );
+
+   cache.set_max_entries( 4 );
+   cache.recover( sig1, digest1 );
+   BOOST_TEST( cache.size() == 2u );
+   // recovering without the canonical check, as the crypto intrinsics do, is kept apart
+   BOOST_TEST( cache.recover( sig1, digest1, false ) == key.get_public_key() );
+   BOOST_TEST( cache.size() == 3u );
+   cache.set_max_entries( 0 );
+   BOOST_TEST( cache.size() == 0u );
+   BOOST_TEST( cache.recover( sig1, digest1 ) == key.get_public_key() );
+   BOOST_TEST( cache.size() == 0u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(non_consensus_executor_test) { try {
+   non_consensus_executor executor;
+   BOOST_TEST( !executor.running() );
+   BOOST_CHECK_THROW( executor.post( 0, [](){} ), misc_exception );
+
+   // one thread runs the tasks by priority, in posting order within a priority
+   executor.start( 1 );
+   BOOST_TEST( executor.running() );
+   std::promise<void> release;
+   std::mutex mtx;
+   std::vector<int> order;
+   executor.post( 10, [f = release.get_future().share()]() { f.wait(); } ); // taken first, holds the others back
+   for( int i = 0; i < 6; ++i ) {
+      executor.post( i % 3, [&, i]() {
+         std::lock_guard g( mtx );
+         order.push_back( i );
+      } );
+   }
+   executor.post( 1, []() { throw std::runtime_error( "logged" ); } );
+   release.set_value();
+   executor.stop();
+   BOOST_TEST( !executor.running() );
+   BOOST_TEST( order == (std::vector<int>{ 2, 5, 1, 4, 0, 3 }) );
+
+   // the threads take the tasks concurrently
+   executor.start( 4 );
+   std::atomic<int> started = 0;
+   std::atomic<int> overlapped = 0;
+   for( int i = 0; i < 4; ++i ) {
+      executor.post( 0, [&]() {
+         ++started;
+         const auto deadline = fc::time_point::now() + fc::seconds( 10 );
+         while( started < 4 && fc::time_point::now() < deadline )
+            std::this_thread::yield();
+         if( started == 4 )
+            ++overlapped;
+      } );
+   }
+   executor.stop();
+   BOOST_TEST( overlapped == 4 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(cpu_list_test) { try {
+   BOOST_TEST( parse_cpu_list( "3" ) == std::vector<uint16_t>{ 3 } );
+   BOOST_TEST( parse_cpu_list( "0-3,8" ) == (std::vector<uint16_t>{ 0, 1, 2, 3, 8 }) );
+   BOOST_TEST( parse_cpu_list( " 1-2, 6-7\n" ) == (std::vector<uint16_t>{ 1, 2, 6, 7 }) );
+   BOOST_CHECK_THROW( parse_cpu_list( "" ), misc_exception );
+   BOOST_CHECK_THROW( parse_cpu_list( "4-2" ), misc_exception );
+   BOOST_CHECK_THROW( parse_cpu_list( "a-b" ), misc_exception );
+   BOOST_CHECK_THROW( parse_cpu_list( "1-2-3" ), misc_exception );
+   BOOST_CHECK_THROW( parse_cpu_list( "3abc" ), misc_exception );
+   BOOST_CHECK_THROW( parse_cpu_list( "1-2x" ), misc_exception );
+   BOOST_CHECK_THROW( parse_cpu_list( "+1" ), misc_exception );
+
+#ifdef __linux__
+   // a pool pinned to the cpus of the calling thread runs as usual
+   cpu_set_t set;
+   BOOST_REQUIRE( pthread_getaffinity_np( pthread_self(), sizeof( set ), &set ) == 0 );
+   std::vector<uint16_t> cpus;
+   for( uint16_t cpu = 0; cpu < CPU_SETSIZE; ++cpu )
+      if( CPU_ISSET( cpu, &set ) )
+         cpus.push_back( cpu );
+   named_thread_pool thread_pool( "pinned", 2, cpus );
+   BOOST_TEST( async_thread_pool( thread_pool.get_executor(), []() { return 42; } ).get() == 42 );
+#endif
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace eosio
@@ -128,6 +128,16 @@ try {
    BOOST_TEST( name{"eosioaccount"}.to_string() == "eosioaccount" );
    BOOST_TEST( name{"eosioaccountj"}.to_string() == "eosioaccountj" );
 
+   // -------------------------------
+   // size_t write_as_string(char*)const
+   char buf[name::max_string_size];
+   BOOST_TEST( name{}.write_as_string(buf) == 0u );
+   BOOST_TEST( std::string(buf, name{u64max}.write_as_string(buf)) == "zzzzzzzzzzzzj" );
+   BOOST_TEST( std::string(buf, name{1ULL}.write_as_string(buf)) == "............1" );
+   BOOST_TEST( std::string(buf, name{16ULL}.write_as_string(buf)) == "...........1" );
+   BOOST_TEST( std::string(buf, name{512ULL}.write_as_string(buf)) == "..........1" );
+   BOOST_TEST( std::string(buf, name{"a.b"}.write_as_string(buf)) == "a.b" );
+
 } FC_LOG_AND_RETHROW() }
 
 BOOST_AUTO_TEST_CASE(operators_test) {
@@ -0,0 +1,75 @@
+#include <eosio/chain/platform_timer.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace eosio::chain;
+
+namespace {
+   /// wait until the timer expires or timeout passes, returns the time waited
+   fc::microseconds wait_for_expired( const platform_timer& t, fc::microseconds timeout ) {
+      const auto start = fc::time_point::now();
+      while( !t.expired && fc::time_point::now() - start < timeout )
+         std::this_thread::sleep_for( std::chrono::microseconds( 200 ) );
+      return fc::time_point::now() - start;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(platform_timer_tests)
+
+   // stopped with a later deadline armed, started again with an earlier one: the timer is re-armed for it
+   BOOST_AUTO_TEST_CASE(earlier_deadline_after_stop) {
+      platform_timer t;
+      t.start( fc::time_point::now() + fc::milliseconds( 500 ) );
+      t.stop();
+      BOOST_REQUIRE( t.expired );
+
+      t.start( fc::time_point::now() + fc::milliseconds( 20 ) );
+      BOOST_REQUIRE( !t.expired );
+      const auto waited = wait_for_expired( t, fc::milliseconds( 400 ) );
+      BOOST_REQUIRE( t.expired );
+      BOOST_CHECK_GE( waited.count(), fc::milliseconds( 15 ).count() );
+      BOOST_CHECK_LT( waited.count(), fc::milliseconds( 400 ).count() );
+   }
+
+   // stopped with an earlier deadline armed, started again with a later one: the signal of the earlier deadline
+   // arrives late for the stopped deadline and early for the new one, which it re-arms the timer for
+   BOOST_AUTO_TEST_CASE(late_signal_rearms_for_current_deadline) {
+      platform_timer t;
+      t.start( fc::time_point::now() + fc::milliseconds( 10 ) );
+      t.stop();
+
+      t.start( fc::time_point::now() + fc::milliseconds( 150 ) );
+      std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+      // the first signal has been handled and ignored
+      BOOST_REQUIRE( !t.expired );
+
+      const auto waited = wait_for_expired( t, fc::milliseconds( 1000 ) );
+      BOOST_REQUIRE( t.expired );
+      BOOST_CHECK_GE( waited.count(), fc::milliseconds( 50 ).count() );
+      BOOST_CHECK_LT( waited.count(), fc::milliseconds( 1000 ).count() );
+   }
+
+   // the signal of a stopped deadline does not call the expiration callback
+   BOOST_AUTO_TEST_CASE(stopped_deadline_does_not_call_back) {
+      static std::atomic<int> calls;
+      calls = 0;
+      platform_timer t;
+      t.set_expiration_callback( []( void* ) { ++calls; }, nullptr );
+
+      t.start( fc::time_point::now() + fc::milliseconds( 10 ) );
+      t.stop();
+      std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+      BOOST_CHECK_EQUAL( calls.load(), 0 );
+
+      t.start( fc::time_point::now() + fc::milliseconds( 10 ) );
+      wait_for_expired( t, fc::milliseconds( 1000 ) );
+      BOOST_REQUIRE( t.expired );
+      BOOST_CHECK_EQUAL( calls.load(), 1 );
+      t.set_expiration_callback( nullptr, nullptr );
+   }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1587,7 +1587,7 @@ BOOST_AUTO_TEST_CASE( producer_schedule_change_extension_test ) { try {
       emplace_extension(
               bad_block->header_extensions,
               producer_schedule_change_extension::extension_id(),
-              fc::raw::pack(std::make_pair(hbs->active_schedule.version + 1, std::vector<char>{}))
+              fc::raw::pack(std::make_pair(hbs->active_schedule->version + 1, std::vector<char>{}))
       );
 
       // re-sign the bad block
@@ -1607,7 +1607,7 @@ BOOST_AUTO_TEST_CASE( producer_schedule_change_extension_test ) { try {
 
       // create a bad block that has the producer schedule change extension before the feature upgrade
       auto bad_block = std::make_shared<signed_block>(last_legacy_block->clone());
-      bad_block->new_producers = legacy::producer_schedule_type{hbs->active_schedule.version + 1, {}};
+      bad_block->new_producers = legacy::producer_schedule_type{hbs->active_schedule->version + 1, {}};
 
       // re-sign the bad block
       auto header_bmroot = digest_type::hash( std::make_pair( bad_block->digest(), remote.control->head_block_state()->blockroot_merkle ) );
@@ -1634,7 +1634,7 @@ BOOST_AUTO_TEST_CASE( producer_schedule_change_extension_test ) { try {
       emplace_extension(
               bad_block->header_extensions,
               producer_schedule_change_extension::extension_id(),
-              fc::raw::pack(std::make_pair(hbs->active_schedule.version + 1, std::vector<char>{}))
+              fc::raw::pack(std::make_pair(hbs->active_schedule->version + 1, std::vector<char>{}))
       );
 
       // re-sign the bad block
@@ -1654,7 +1654,7 @@ BOOST_AUTO_TEST_CASE( producer_schedule_change_extension_test ) { try {
 
       // create a bad block that has the producer schedule change extension before the feature upgrade
       auto bad_block = std::make_shared<signed_block>(first_new_block->clone());
-      bad_block->new_producers = legacy::producer_schedule_type{hbs->active_schedule.version + 1, {}};
+      bad_block->new_producers = legacy::producer_schedule_type{hbs->active_schedule->version + 1, {}};
 
       // re-sign the bad block
       auto header_bmroot = digest_type::hash( std::make_pair( bad_block->digest(), remote.control->head_block_state()->blockroot_merkle ) );
@@ -1908,4 +1908,59 @@ BOOST_AUTO_TEST_CASE( set_parameters_packed_test ) { try {
                        c.error("alice does not have permission to call this API"));
 } FC_LOG_AND_RETHROW() }
 
+static const char import_db_get_batch_i64_wast[] = R"=====(
+(module
+ (import "env" "db_store_i64" (func $db_store_i64 (param i64 i64 i64 i64 i32 i32) (result i32)))
+ (import "env" "db_lowerbound_i64" (func $db_lowerbound_i64 (param i64 i64 i64 i64) (result i32)))
+ (import "env" "db_end_i64" (func $db_end_i64 (param i64 i64 i64) (result i32)))
+ (import "env" "db_get_batch_i64" (func $db_get_batch_i64 (param i32 i32 i32 i32 i32) (result i32)))
+ (import "env" "eosio_assert" (func $eosio_assert (param i32 i32)))
+ (memory $0 1)
+ (export "apply" (func $apply))
+ (func $apply (param $0 i64) (param $1 i64) (param $2 i64)
+   (local $itr i32)
+   (drop (call $db_store_i64 (get_local $0) (get_local $0) (get_local $0) (i64.const 1) (i32.const 0) (i32.const 8)))
+   (drop (call $db_store_i64 (get_local $0) (get_local $0) (get_local $0) (i64.const 2) (i32.const 0) (i32.const 8)))
+   (drop (call $db_store_i64 (get_local $0) (get_local $0) (get_local $0) (i64.const 3) (i32.const 0) (i32.const 8)))
+   ;; buffer only large enough for the first record
+   (set_local $itr (call $db_get_batch_i64 (call $db_lowerbound_i64 (get_local $0) (get_local $0) (get_local $0) (i64.const 0))
+                                           (i32.const 5) (i32.const 64) (i32.const 20) (i32.const 32)))
+   (call $eosio_assert (i32.eq (i32.load (i32.const 32)) (i32.const 1)) (i32.const 16))
+   (call $eosio_assert (i32.eq (i32.load (i32.const 64)) (i32.const 8)) (i32.const 16))
+   ;; remaining records
+   (set_local $itr (call $db_get_batch_i64 (get_local $itr) (i32.const 5) (i32.const 64) (i32.const 256) (i32.const 32)))
+   (call $eosio_assert (i32.eq (i32.load (i32.const 32)) (i32.const 2)) (i32.const 16))
+   (call $eosio_assert (i32.eq (i32.load (i32.const 76)) (i32.const 8)) (i32.const 16))
+   (call $eosio_assert (i32.eq (get_local $itr) (call $db_end_i64 (get_local $0) (get_local $0) (get_local $0))) (i32.const 16))
+ )
+ (data (i32.const 0) "ABCDEFGH")
+ (data (i32.const 16) "batch failed")
+)
+)=====";
+
+BOOST_AUTO_TEST_CASE( db_get_batch_i64_test ) { try {
+   tester c( setup_policy::preactivate_feature_and_new_bios );
+
+   const auto& pfm = c.control->get_protocol_feature_manager();
+   const auto& d = pfm.get_builtin_digest(builtin_protocol_feature_t::batched_db_reads);
+   BOOST_REQUIRE(d);
+
+   const auto alice_account = account_name("alice");
+   c.create_accounts( {alice_account} );
+   c.produce_block();
+
+   BOOST_CHECK_EXCEPTION(  c.set_code( alice_account, import_db_get_batch_i64_wast ),
+                           wasm_exception,
+                           fc_exception_message_is( "env.db_get_batch_i64 unresolveable" ) );
+
+   c.preactivate_protocol_features( {*d} );
+   c.produce_block();
+
+   c.set_code( alice_account, import_db_get_batch_i64_wast );
+   c.produce_block();
+
+   auto act = action( { { alice_account, permission_name("active") } }, alice_account, action_name(), {} );
+   BOOST_REQUIRE_EQUAL(c.push_action(std::move(act), alice_account.to_uint64_t()), c.success());
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
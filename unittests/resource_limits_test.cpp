@@ -419,6 +419,41 @@ BOOST_AUTO_TEST_SUITE(resource_limits_test)
 
    } FC_LOG_AND_RETHROW()
 
+   /**
+    * Test that get_account_billing_limits returns the same limits as get_account_net_limit and get_account_cpu_limit
+    */
+   BOOST_FIXTURE_TEST_CASE(get_account_billing_limits_matches_net_and_cpu_limits, resource_limits_fixture) try {
+      const account_name account("billacc");
+      const account_name other("otheracc");
+      initialize_account(account);
+      initialize_account(other);
+
+      auto check_limits = [&]( uint32_t greylist_limit ) {
+         const auto limits = get_account_billing_limits(account, greylist_limit);
+         const auto [net_limit, net_greylisted] = get_account_net_limit(account, greylist_limit);
+         const auto [cpu_limit, cpu_greylisted] = get_account_cpu_limit(account, greylist_limit);
+         BOOST_CHECK_EQUAL(limits.net_available, net_limit);
+         BOOST_CHECK_EQUAL(limits.net_greylisted, net_greylisted);
+         BOOST_CHECK_EQUAL(limits.cpu_available, cpu_limit);
+         BOOST_CHECK_EQUAL(limits.cpu_greylisted, cpu_greylisted);
+      };
+
+      // unlimited
+      check_limits(config::maximum_elastic_resource_multiplier);
+      BOOST_CHECK_EQUAL(get_account_billing_limits(account).net_available, -1);
+      BOOST_CHECK_EQUAL(get_account_billing_limits(account).cpu_available, -1);
+
+      set_account_limits(account, -1, 100, 300);
+      set_account_limits(other, -1, 300, 100);
+      process_account_limit_updates();
+      check_limits(config::maximum_elastic_resource_multiplier);
+      check_limits(1);
+
+      add_transaction_usage({account}, 1000, 2000, 1);
+      check_limits(config::maximum_elastic_resource_multiplier);
+      check_limits(1);
+   } FC_LOG_AND_RETHROW()
+
    BOOST_AUTO_TEST_CASE(light_net_validation) try {
       tester main( setup_policy::preactivate_feature_and_new_bios );
       tester validator( setup_policy::none );
@@ -1,4 +1,6 @@
+#include <fstream>
 #include <sstream>
+#include <thread>
 
 #include <eosio/chain/block_log.hpp>
 #include <eosio/chain/global_property_object.hpp>
@@ -12,6 +14,7 @@
 #include <snapshots.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <fc/io/cfile.hpp>
+#include <fc/io/fstream.hpp>
 #include "test_cfd_transaction.hpp"
 
 using namespace eosio;
@@ -542,6 +545,7 @@ void trim_blocklog_front(uint32_t version) {
    bfs::copy(blocks_dir / "blocks.index", temp1.path / "blocks.index");
    BOOST_REQUIRE_NO_THROW(block_log::trim_blocklog_front(temp1.path, temp2.path, 10));
    BOOST_REQUIRE_NO_THROW(block_log::smoke_test(temp1.path, 1));
+   BOOST_REQUIRE_NO_THROW(block_log::verify(temp1.path));
 
    block_log old_log(chain.get_config().blog);
    block_log new_log({ .log_dir = temp1.path});
@@ -570,4 +574,247 @@ BOOST_AUTO_TEST_CASE(test_trim_blocklog_front_v3) {
    trim_blocklog_front(3);
 }
 
+BOOST_AUTO_TEST_CASE(test_compressed_block_log) {
+   fc::temp_directory temp_dir;
+   tester chain(
+         temp_dir,
+         [](controller::config& config) {
+            config.blog.compress_blocks = true;
+         },
+         true);
+   chain.produce_blocks(30);
+   chain.close();
+
+   block_log blog(chain.get_config().blog);
+   BOOST_CHECK(blog.version() == block_log::max_supported_version);
+   for (uint32_t block_num = 1; block_num <= blog.head()->block_num(); ++block_num) {
+      auto block = blog.read_signed_block_by_num(block_num);
+      BOOST_REQUIRE(block);
+      BOOST_CHECK(block->calculate_id() == blog.read_block_id_by_num(block_num));
+   }
+   BOOST_REQUIRE_NO_THROW(block_log::smoke_test(chain.get_config().blog.log_dir, 1));
+}
+
+BOOST_AUTO_TEST_CASE(test_uncompressed_block_log_version) {
+   fc::temp_directory temp_dir;
+   tester chain(temp_dir, [](controller::config& config) {}, true);
+   chain.produce_blocks(5);
+   chain.close();
+
+   // version 5 is only written when compression is enabled so older nodes can still read the log
+   block_log blog(chain.get_config().blog);
+   BOOST_CHECK_EQUAL(blog.version(), 4u);
+}
+
+BOOST_AUTO_TEST_CASE(test_background_split_of_retained_files) {
+   namespace bfs = boost::filesystem;
+   fc::temp_directory temp_dir;
+
+   tester chain(
+         temp_dir,
+         [](controller::config& config) {
+            config.blog.stride = 50;
+         },
+         true);
+   chain.produce_blocks(120);
+   chain.close();
+
+   auto config             = chain.get_config().blog;
+   config.stride           = 20;
+   config.background_split = true;
+   // each open splits one of the retained files spanning several strides
+   for (int i = 0; i < 2; ++i) {
+      block_log blog(config);
+   }
+
+   const auto& blocks_dir = config.log_dir;
+   for (auto name : {"blocks-1-20", "blocks-21-40", "blocks-41-50", "blocks-51-60", "blocks-61-80", "blocks-81-100"}) {
+      BOOST_CHECK(bfs::exists(blocks_dir / (std::string(name) + ".log")));
+      BOOST_CHECK(bfs::exists(blocks_dir / (std::string(name) + ".index")));
+   }
+   BOOST_CHECK(!bfs::exists(blocks_dir / "blocks-1-50.log"));
+   BOOST_CHECK(!bfs::exists(blocks_dir / "blocks-51-100.log"));
+
+   block_log blog(config);
+   for (uint32_t block_num = 1; block_num <= 120; ++block_num) {
+      auto block = blog.read_signed_block_by_num(block_num);
+      BOOST_REQUIRE(block);
+      BOOST_CHECK_EQUAL(block->block_num(), block_num);
+      BOOST_CHECK(block->calculate_id() == blog.read_block_id_by_num(block_num));
+   }
+}
+
+void background_prune(bool compress_blocks) {
+   fc::temp_directory temp_dir;
+   auto [config, gen] = tester::default_config(temp_dir);
+   config.blog.stride          = 20;
+   config.blog.compress_blocks = compress_blocks;
+   tester chain(config, gen);
+   chain.execute_setup_policy(setup_policy::full);
+
+   deploy_test_api(chain);
+   chain.produce_blocks(10);
+   auto old_trace = push_test_cfd_transaction(chain);
+   chain.produce_blocks(40);
+   auto recent_trace = push_test_cfd_transaction(chain);
+   chain.produce_blocks(5);
+   chain.close();
+
+   auto find_trx = [](const signed_block_ptr& block, const transaction_id_type& id) -> const packed_transaction* {
+      for (const auto& receipt : block->transactions) {
+         if (std::holds_alternative<packed_transaction>(receipt.trx) &&
+             std::get<packed_transaction>(receipt.trx).id() == id)
+            return &std::get<packed_transaction>(receipt.trx);
+      }
+      return nullptr;
+   };
+   auto is_pruned = [](const packed_transaction& ptx) {
+      return std::holds_alternative<packed_transaction::prunable_data_type::none>(ptx.get_prunable_data().prunable_data);
+   };
+
+   auto blog_config                    = chain.get_config().blog;
+   blog_config.prune_blocks_older_than = 20;
+   // each open prunes the blocks of at most one file
+   for (int i = 0; i < 6; ++i) {
+      block_log blog(blog_config);
+   }
+
+   block_log blog(blog_config);
+   signed_block_ptr old_block = blog.read_signed_block_by_num(old_trace->block_num);
+   BOOST_REQUIRE(old_block);
+   auto old_trx = find_trx(old_block, old_trace->id);
+   BOOST_REQUIRE(old_trx);
+   BOOST_CHECK(is_pruned(*old_trx));
+   BOOST_CHECK(old_block->prune_state == signed_block::prune_state_type::incomplete);
+   BOOST_CHECK(old_block->calculate_id() == blog.read_block_id_by_num(old_trace->block_num));
+
+   signed_block_ptr recent_block = blog.read_signed_block_by_num(recent_trace->block_num);
+   BOOST_REQUIRE(recent_block);
+   auto recent_trx = find_trx(recent_block, recent_trace->id);
+   BOOST_REQUIRE(recent_trx);
+   BOOST_CHECK(!is_pruned(*recent_trx));
+
+   for (uint32_t block_num = 1; block_num <= blog.head()->block_num(); ++block_num)
+      BOOST_REQUIRE(blog.read_signed_block_by_num(block_num));
+}
+
+BOOST_AUTO_TEST_CASE(test_background_prune) {
+   background_prune(false);
+}
+
+// compressed entries are padded so their pruned block fits in place
+BOOST_AUTO_TEST_CASE(test_background_prune_compressed) {
+   background_prune(true);
+}
+
+BOOST_AUTO_TEST_CASE(test_remote_archive) {
+   namespace bfs = boost::filesystem;
+   fc::temp_directory temp_dir;
+   const auto         remote_dir = temp_dir.path() / "remote";
+   bfs::create_directories(remote_dir);
+
+   tester chain(
+         temp_dir,
+         [&remote_dir](controller::config& config) {
+            // %p is quoted for the shell
+            config.blog.archive_dir                    = "archive dir";
+            config.blog.stride                         = 10;
+            config.blog.max_retained_files             = 2;
+            config.blog.remote_archive.store_command   = "cp %p.log %p.index " + remote_dir.string();
+            config.blog.remote_archive.fetch_command   = "cp " + remote_dir.string() + "/%f.log %p.log && cp " +
+                                                         remote_dir.string() + "/%f.index %p.index";
+            config.blog.remote_archive.max_cached_files = 1;
+         },
+         true);
+   chain.produce_blocks(60);
+   // waits for the files being stored
+   chain.close();
+
+   for (auto name : {"blocks-1-10", "blocks-11-20", "blocks-21-30", "blocks-31-40"}) {
+      BOOST_CHECK(bfs::exists(remote_dir / (std::string(name) + ".log")));
+      BOOST_CHECK(bfs::exists(remote_dir / (std::string(name) + ".index")));
+   }
+
+   const auto blocks_archive_dir = chain.get_config().blog.log_dir / "archive dir";
+   block_log blog(chain.get_config().blog);
+   // the archived files are fetched in the background, their blocks are unavailable until then
+   BOOST_CHECK(!blog.read_signed_block_by_num(1));
+   for (uint32_t block_num = 1; block_num <= 60; ++block_num) {
+      auto block = blog.read_signed_block_by_num(block_num);
+      for (int i = 0; i < 500 && !block; ++i) {
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+         block = blog.read_signed_block_by_num(block_num);
+      }
+      BOOST_REQUIRE(block);
+      BOOST_CHECK_EQUAL(block->block_num(), block_num);
+   }
+   // only the most recently fetched archived file is kept locally
+   BOOST_CHECK(bfs::exists(blocks_archive_dir / "blocks-31-40.log"));
+   BOOST_CHECK(!bfs::exists(blocks_archive_dir / "blocks-21-30.log"));
+}
+
+struct parallel_scan_threshold_setter {
+   parallel_scan_threshold_setter(uint64_t bytes) { block_log::set_parallel_scan_threshold(bytes); }
+   ~parallel_scan_threshold_setter() { block_log::set_parallel_scan_threshold(256 * 1024 * 1024); }
+};
+
+std::string read_file(const fc::path& path) {
+   std::string content;
+   fc::read_file_contents(path, content);
+   return content;
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_index_and_repair) {
+   parallel_scan_threshold_setter scan_all_logs(0);
+
+   fc::temp_directory temp_dir;
+   tester chain(temp_dir, [](controller::config&) {}, true);
+   chain.produce_blocks(100);
+   chain.close();
+
+   const auto& blocks_dir     = chain.get_config().blog.log_dir;
+   const auto  original_log   = read_file(blocks_dir / "blocks.log");
+   const auto  original_index = read_file(blocks_dir / "blocks.index");
+
+   block_log::construct_index(blocks_dir / "blocks.log", temp_dir.path() / "parallel.index");
+   BOOST_CHECK(read_file(temp_dir.path() / "parallel.index") == original_index);
+
+   auto backup_dir = block_log::repair_log(blocks_dir);
+   BOOST_CHECK(read_file(blocks_dir / "blocks.log") == original_log);
+   fc::remove_all(backup_dir);
+
+   block_log::repair_log(blocks_dir, 50);
+   block_log blog(chain.get_config().blog);
+   BOOST_CHECK_EQUAL(blog.head()->block_num(), 50u);
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_verify_and_trim) {
+   parallel_scan_threshold_setter scan_all_logs(0);
+
+   fc::temp_directory temp_dir;
+   tester chain(temp_dir, [](controller::config&) {}, true);
+   chain.produce_blocks(100);
+   chain.close();
+
+   const auto& blocks_dir = chain.get_config().blog.log_dir;
+   BOOST_REQUIRE_NO_THROW(block_log::verify(blocks_dir));
+
+   // a trimmed log is verified in ranges, including the links between them
+   scoped_temp_path trimmed, old;
+   boost::filesystem::create_directory(trimmed.path);
+   boost::filesystem::copy(blocks_dir / "blocks.log", trimmed.path / "blocks.log");
+   boost::filesystem::copy(blocks_dir / "blocks.index", trimmed.path / "blocks.index");
+   BOOST_REQUIRE(block_log::trim_blocklog_front(trimmed.path, old.path, 20));
+   BOOST_REQUIRE_NO_THROW(block_log::verify(trimmed.path));
+   block_log trimmed_log({ .log_dir = trimmed.path });
+   BOOST_CHECK_EQUAL(trimmed_log.first_block_num(), 20u);
+   BOOST_CHECK(trimmed_log.read_block_id_by_num(60) == block_log(chain.get_config().blog).read_block_id_by_num(60));
+
+   // an index pointing at the wrong entry fails
+   auto index = read_file(blocks_dir / "blocks.index");
+   std::swap_ranges(index.begin() + 40 * sizeof(uint64_t), index.begin() + 41 * sizeof(uint64_t), index.begin() + 41 * sizeof(uint64_t));
+   std::ofstream(blocks_dir.string() + "/blocks.index", std::ios::binary | std::ios::trunc).write(index.data(), index.size());
+   BOOST_CHECK_THROW(block_log::verify(blocks_dir), block_log_exception);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1,9 +1,11 @@
+#include <set>
 #include <sstream>
 
 #include <eosio/chain/block_log.hpp>
 #include <eosio/chain/global_property_object.hpp>
 #include <eosio/chain/kv_chainbase_objects.hpp>
 #include <eosio/chain/snapshot.hpp>
+#include <eosio/chain/snapshot_delta.hpp>
 #include <eosio/testing/tester.hpp>
 #include <eosio/testing/snapshot_suites.hpp>
 
@@ -389,6 +391,97 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(test_chain_id_in_snapshot, SNAPSHOT_SUITE, snapsho
    verify_integrity_hash<SNAPSHOT_SUITE>(*chain.control, *snap_chain.control);
 }
 
+BOOST_AUTO_TEST_CASE(test_startup_phases_from_snapshot)
+{
+   tester chain;
+   chain.create_account("snapshot"_n);
+   chain.produce_blocks(1);
+   chain.control->abort_block();
+
+   auto writer = buffered_snapshot_suite::get_writer();
+   chain.control->write_snapshot(writer);
+   auto snapshot = buffered_snapshot_suite::finalize(writer);
+
+   snapshotted_tester snap_chain(chain.get_config(), buffered_snapshot_suite::get_reader(snapshot), 0);
+   std::set<std::string> phases;
+   for( const auto& p : snap_chain.control->get_startup_metrics().snapshot() )
+      BOOST_REQUIRE(phases.insert(p.phase).second);
+   for( const char* phase : { "controller.chainbase_open", "controller.block_log_open", "controller.wasm_interface_open",
+                              "controller.fork_database_open", "snapshot.validate", "snapshot.section.eosio::chain::chain_snapshot_header",
+                              "snapshot.section.contract_tables", "snapshot.integrity_hash", "controller.startup" } )
+      BOOST_TEST(phases.count(phase) == 1, phase);
+}
+
+BOOST_AUTO_TEST_CASE(test_compressed_snapshot)
+{
+   tester chain;
+   chain.create_account("snapshot"_n);
+   chain.produce_blocks(1);
+   chain.control->abort_block();
+
+   std::stringstream snapshot(std::ios::in | std::ios::out | std::ios::binary);
+   auto writer = std::make_shared<ostream_snapshot_writer>(snapshot);
+   chain.control->write_snapshot(writer);
+   writer->finalize();
+   BOOST_REQUIRE(!is_compressed_snapshot(snapshot));
+
+   std::stringstream compressed(std::ios::in | std::ios::out | std::ios::binary);
+   compress_snapshot(snapshot, compressed);
+   BOOST_REQUIRE(is_compressed_snapshot(compressed));
+   BOOST_REQUIRE_LT(compressed.str().size(), snapshot.str().size());
+
+   std::stringstream decompressed(std::ios::in | std::ios::out | std::ios::binary);
+   decompress_snapshot(compressed, decompressed);
+   BOOST_REQUIRE(decompressed.str() == snapshot.str());
+
+   snapshotted_tester snap_chain(chain.get_config(), std::make_shared<istream_snapshot_reader>(decompressed), 0);
+   verify_integrity_hash<buffered_snapshot_suite>(*chain.control, *snap_chain.control);
+}
+
+BOOST_AUTO_TEST_CASE(test_delta_snapshot)
+{
+   tester chain;
+   chain.create_account("snapshot"_n);
+   chain.produce_blocks(1);
+   chain.control->abort_block();
+
+   auto write_snapshot = [&chain]() {
+      std::stringstream snapshot(std::ios::in | std::ios::out | std::ios::binary);
+      auto writer = std::make_shared<ostream_snapshot_writer>(snapshot);
+      chain.control->write_snapshot(writer);
+      writer->finalize();
+      return snapshot.str();
+   };
+   const auto base = write_snapshot();
+
+   chain.create_account("snapshot1"_n);
+   chain.set_code("snapshot"_n, contracts::snapshot_test_wasm());
+   chain.produce_blocks(1);
+   chain.control->abort_block();
+   const auto latest = write_snapshot();
+
+   std::stringstream base_in(base, std::ios::in | std::ios::binary);
+   std::stringstream latest_in(latest, std::ios::in | std::ios::binary);
+   std::stringstream delta(std::ios::in | std::ios::out | std::ios::binary);
+   snapshot_delta::write(base_in, latest_in, delta);
+   BOOST_REQUIRE(snapshot_delta::is_delta(delta));
+   BOOST_REQUIRE(!snapshot_delta::is_delta(base_in));
+   BOOST_REQUIRE_LT(delta.str().size(), latest.size());
+
+   std::stringstream rebuilt(std::ios::in | std::ios::out | std::ios::binary);
+   snapshot_delta::apply(base_in, delta, rebuilt);
+   BOOST_REQUIRE(rebuilt.str() == latest);
+
+   // a delta only applies to its own base
+   std::stringstream other_base(latest, std::ios::in | std::ios::binary);
+   std::stringstream ignored(std::ios::out | std::ios::binary);
+   delta.seekg(0);
+   BOOST_REQUIRE_THROW(snapshot_delta::apply(other_base, delta, ignored), snapshot_exception);
+
+   snapshotted_tester snap_chain(chain.get_config(), std::make_shared<istream_snapshot_reader>(rebuilt), 0);
+   verify_integrity_hash<buffered_snapshot_suite>(*chain.control, *snap_chain.control);
+}
+
 static auto get_extra_args() {
    bool save_snapshot = false;
    bool generate_log = false;
@@ -1,7 +1,9 @@
 #include <boost/test/unit_test.hpp>
 #include <contracts.hpp>
 #include <eosio/chain/authorization_manager.hpp>
+#include <eosio/chain/thread_utils.hpp>
 #include <eosio/state_history/create_deltas.hpp>
+#include <eosio/state_history/filter.hpp>
 #include <eosio/state_history/log.hpp>
 #include <eosio/state_history/trace_converter.hpp>
 #include <utilities.hpp>
@@ -143,6 +145,50 @@ BOOST_AUTO_TEST_CASE(test_trace_converter) {
    BOOST_CHECK(std::holds_alternative<prunable_data_type::none>(get_prunable_data_from_traces_bin(cfd_entry, cfd_trace->id)));
 }
 
+BOOST_AUTO_TEST_CASE(test_packed_trace_cache) {
+
+   tester chain;
+   using namespace eosio::state_history;
+
+   transaction_trace_cache         cache;
+   packed_trace_cache              packed_cache;
+   eosio::chain::named_thread_pool thread_pool("ship", 2);
+   packed_cache.set_thread_pool(thread_pool.get_executor());
+   std::map<uint32_t, eosio::chain::bytes> expected_entries;
+   std::map<uint32_t, eosio::chain::bytes> packed_entries;
+
+   chain.control->applied_transaction.connect(
+       [&](std::tuple<const transaction_trace_ptr&, const packed_transaction_ptr&> t) {
+          cache.add_transaction(std::get<0>(t), std::get<1>(t));
+          packed_cache.add_transaction(chain.control->db(), std::get<0>(t), std::get<1>(t), true,
+                                       compression_type::zlib);
+       });
+
+   chain.control->accepted_block.connect([&](const block_state_ptr& bs) {
+      fc::datastream<std::vector<char>> strm;
+      trace_converter::pack(strm, chain.control->db(), true, cache.prepare_traces(bs), compression_type::zlib);
+      expected_entries[bs->block_num] = strm.storage();
+
+      fc::datastream<std::vector<char>> packed_strm;
+      packed_cache.pack(packed_strm, bs, compression_type::zlib);
+      packed_entries[bs->block_num] = packed_strm.storage();
+   });
+
+   chain.control->block_start.connect([&](uint32_t block_num) {
+      cache.clear();
+      packed_cache.clear();
+   });
+
+   deploy_test_api(chain);
+   auto cfd_trace = push_test_cfd_transaction(chain);
+   chain.produce_blocks(1);
+
+   BOOST_REQUIRE(expected_entries.size());
+   BOOST_CHECK(expected_entries == packed_entries);
+   BOOST_CHECK(!std::holds_alternative<prunable_data_type::none>(
+       get_prunable_data_from_traces_bin(packed_entries.at(cfd_trace->block_num), cfd_trace->id)));
+}
+
 BOOST_AUTO_TEST_CASE(test_trace_log) {
    namespace bfs = boost::filesystem;
    tester chain;
@@ -153,7 +199,7 @@ BOOST_AUTO_TEST_CASE(test_trace_log) {
 
    chain.control->applied_transaction.connect(
        [&](std::tuple<const transaction_trace_ptr&, const packed_transaction_ptr&> t) {
-          log.add_transaction(std::get<0>(t), std::get<1>(t));
+          log.add_transaction(chain.control->db(), std::get<0>(t), std::get<1>(t));
        });
 
    chain.control->accepted_block.connect([&](const block_state_ptr& bs) { log.store(chain.control->db(), bs); });
@@ -192,7 +238,7 @@ BOOST_AUTO_TEST_CASE(test_trace_log_with_transaction_extensions) {
 
    c.control->applied_transaction.connect(
        [&](std::tuple<const transaction_trace_ptr&, const packed_transaction_ptr&> t) {
-          log.add_transaction(std::get<0>(t), std::get<1>(t));
+          log.add_transaction(c.control->db(), std::get<0>(t), std::get<1>(t));
        });
 
    c.control->accepted_block.connect([&](const block_state_ptr& bs) { log.store(c.control->db(), bs); });
@@ -260,6 +306,14 @@ BOOST_AUTO_TEST_CASE(test_chain_state_log) {
    std::vector<eosio::ship_protocol::table_delta>        deltas;
    eosio::input_stream                                   deltas_bin{entry.data(), entry.data() + entry.size()};
    BOOST_CHECK_NO_THROW(from_bin(deltas, deltas_bin));
+
+   // the compressed entry is the zlib stream of the same deltas
+   eosio::chain::bytes compressed = log.get_compressed_log_entry(last_accepted_block_num);
+   BOOST_REQUIRE(!compressed.empty());
+   eosio::chain::bytes framed = fc::raw::pack(uint32_t(compressed.size()));
+   framed.insert(framed.end(), compressed.begin(), compressed.end());
+   fc::datastream<const char*> framed_strm(framed.data(), framed.size());
+   BOOST_CHECK(eosio::state_history::zlib_decompress(framed_strm) == entry);
 }
 
 
@@ -276,7 +330,7 @@ struct state_history_tester : state_history_tester_logs, tester {
    : state_history_tester_logs(config), tester ([&](eosio::chain::controller& control) {
       control.applied_transaction.connect(
        [&](std::tuple<const transaction_trace_ptr&, const packed_transaction_ptr&> t) {
-          traces_log.add_transaction(std::get<0>(t), std::get<1>(t));
+          traces_log.add_transaction(control.db(), std::get<0>(t), std::get<1>(t));
        });
 
       control.accepted_block.connect([&](const block_state_ptr& bs) { 
@@ -488,6 +542,43 @@ BOOST_AUTO_TEST_CASE(test_corrupted_log_recovery) {
    BOOST_CHECK(new_chain.chain_state_log.get_log_entry(10).size());
 }
 
+BOOST_AUTO_TEST_CASE(test_corrupted_log_recovery_partial_index) {
+  namespace bfs = boost::filesystem;
+
+   scoped_temp_path state_history_dir;
+   fc::create_directories(state_history_dir.path);
+
+   eosio::state_history_config config{
+      .log_dir = state_history_dir.path,
+      .archive_dir = "archive",
+      .stride  = 100,
+      .max_retained_files = 5
+   };
+
+   state_history_tester chain(config);
+   chain.produce_blocks(50);
+   chain.close();
+
+   // leave the last block entry incomplete and drop the tail of the index, only the blocks after the remaining
+   // index entries are scanned during recovery
+   fc::cfile logfile;
+   logfile.set_file_path(state_history_dir.path / "trace_history.log");
+   logfile.open("ab");
+   const char random_data[] = "12345678901231876983271649837";
+   logfile.write(random_data, sizeof(random_data));
+   logfile.close();
+   bfs::resize_file(state_history_dir.path / "trace_history.index", 20 * sizeof(uint64_t));
+
+   bfs::remove_all(chain.get_config().blog.log_dir/"reversible");
+
+   state_history_tester new_chain(config);
+   new_chain.produce_blocks(50);
+
+   BOOST_CHECK(get_traces(new_chain.traces_log, 10).size());
+   BOOST_CHECK(get_traces(new_chain.traces_log, 40).size());
+   BOOST_CHECK(new_chain.chain_state_log.get_log_entry(40).size());
+}
+
 
 BOOST_AUTO_TEST_CASE(test_state_result_abi) {
    using namespace eosio::state_history;
@@ -568,6 +659,48 @@ BOOST_AUTO_TEST_CASE(test_state_result_abi) {
    }
 }
 
+BOOST_AUTO_TEST_CASE(test_batch_result_abi) {
+   using namespace eosio::state_history;
+
+   tester chain;
+   chain.produce_blocks(2);
+
+   get_blocks_batch_result_v0 batch;
+   for (uint32_t block_num = 2; block_num <= 3; ++block_num) {
+      get_blocks_result_v2 result;
+      result.head       = block_position{chain.control->head_block_num(), chain.control->head_block_id()};
+      result.this_block = block_position{block_num, chain.control->get_block_id_for_num(block_num)};
+      result.block      = chain.control->fetch_block_by_number(block_num);
+      batch.results.push_back(std::move(result));
+   }
+
+   state_history_abi_serializer serializer(chain);
+   auto                         result = serializer.deserialize(fc::raw::pack(state_result{batch}), "result");
+   auto&                        result_variant = result.get_array();
+   BOOST_CHECK(result_variant[0].as_string() == "get_blocks_batch_result_v0");
+   BOOST_CHECK_EQUAL(result_variant[1].get_object()["results"].get_array().size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_state_snapshot_result_abi) {
+   using namespace eosio::state_history;
+
+   tester chain;
+   chain.produce_blocks(2);
+
+   state_snapshot_result_v0 snapshot;
+   snapshot.head       = block_position{chain.control->head_block_num(), chain.control->head_block_id()};
+   snapshot.this_block = snapshot.head;
+   snapshot.deltas     = create_deltas(chain.control->kv_db(), true);
+   BOOST_REQUIRE(snapshot.deltas.has_value());
+
+   state_history_abi_serializer serializer(chain);
+   auto                         result = serializer.deserialize(fc::raw::pack(state_result{snapshot}), "result");
+   auto&                        result_variant = result.get_array();
+   BOOST_CHECK(result_variant[0].as_string() == "state_snapshot_result_v0");
+   BOOST_CHECK_EQUAL(result_variant[1].get_object()["this_block"].get_object()["block_num"].as_uint64(),
+                     chain.control->head_block_num());
+}
+
 BOOST_AUTO_TEST_CASE(test_traces_present)
 {
    namespace bfs = boost::filesystem;
@@ -586,7 +719,7 @@ BOOST_AUTO_TEST_CASE(test_traces_present)
       [&](std::tuple<const transaction_trace_ptr&, const packed_transaction_ptr&> t) {
          const transaction_trace_ptr &trace_ptr = std::get<0>(t);
          const eosio::chain::packed_transaction_ptr &transaction = std::get<1>(t);
-         log.add_transaction(trace_ptr, transaction);
+         log.add_transaction(chain.control->db(), trace_ptr, transaction);
 
          // see issue #9159
          if (!trace_ptr->action_traces.empty() && trace_ptr->action_traces[0].act.name == "onblock"_n) {
@@ -669,6 +802,67 @@ BOOST_AUTO_TEST_CASE(test_deltas_not_empty) {
    }
 }
 
+BOOST_AUTO_TEST_CASE(test_deltas_parallel) {
+   table_deltas_tester chain { backing_store_type::CHAINBASE };
+   chain.create_account("newacc"_n);
+
+   eosio::chain::named_thread_pool thread_pool("deltas", 2);
+   for (bool full_snapshot : { false, true }) {
+      auto deltas          = eosio::state_history::create_deltas(chain.control->kv_db(), full_snapshot);
+      auto parallel_deltas = eosio::state_history::create_deltas(chain.control->kv_db(), full_snapshot,
+                                                                 &thread_pool.get_executor());
+      BOOST_REQUIRE(!deltas.empty());
+      BOOST_CHECK(fc::raw::pack(deltas) == fc::raw::pack(parallel_deltas));
+   }
+}
+
+BOOST_AUTO_TEST_CASE(test_filters) {
+   table_deltas_tester chain { backing_store_type::CHAINBASE };
+
+   scoped_temp_path state_history_dir;
+   fc::create_directories(state_history_dir.path);
+   eosio::state_history_traces_log log({ .log_dir = state_history_dir.path });
+
+   chain.control->applied_transaction.connect(
+       [&](std::tuple<const transaction_trace_ptr&, const packed_transaction_ptr&> t) {
+          log.add_transaction(chain.control->db(), std::get<0>(t), std::get<1>(t));
+       });
+   chain.control->accepted_block.connect([&](const block_state_ptr& bs) { log.store(chain.control->db(), bs); });
+   chain.control->block_start.connect([&](uint32_t block_num) { log.block_start(block_num); });
+
+   chain.create_account("tester"_n);
+   chain.set_code("tester"_n, contracts::get_table_test_wasm());
+   chain.set_abi("tester"_n, contracts::get_table_test_abi().data());
+   chain.produce_blocks(2);
+
+   chain.push_action("tester"_n, "addhashobj"_n, "tester"_n, mutable_variant_object()("hashinput", "hello"));
+   auto trace = chain.push_action("tester"_n, "addnumobj"_n, "tester"_n, mutable_variant_object()("input", 2));
+
+   // only the rows of the numobjs table are kept
+   auto deltas_bin = eosio::state_history::filter_deltas(
+       fc::raw::pack(eosio::state_history::create_deltas(chain.control->kv_db(), false)), {{"tester"_n, "numobjs"_n}});
+   std::vector<eosio::ship_protocol::table_delta> deltas;
+   eosio::input_stream                            deltas_strm{deltas_bin.data(), deltas_bin.data() + deltas_bin.size()};
+   BOOST_REQUIRE_NO_THROW(from_bin(deltas, deltas_strm));
+   BOOST_REQUIRE(!deltas.empty());
+   for (auto& delta : deltas) {
+      auto& name = std::get<eosio::ship_protocol::table_delta_v0>(delta).name;
+      BOOST_CHECK(name.rfind("contract_", 0) == 0);
+      if (name == "contract_row")
+         BOOST_CHECK_EQUAL(std::get<eosio::ship_protocol::table_delta_v0>(delta).rows.size(), 1);
+   }
+
+   // only the transaction of the addnumobj action is kept
+   chain.produce_block();
+   auto traces_bin = eosio::state_history::filter_traces(log.get_log_entry(trace->block_num),
+                                                         {{"tester"_n, "addnumobj"_n}});
+   std::vector<eosio::ship_protocol::transaction_trace> traces;
+   eosio::input_stream traces_strm{traces_bin.data(), traces_bin.data() + traces_bin.size()};
+   BOOST_REQUIRE_NO_THROW(from_bin(traces, traces_strm));
+   BOOST_REQUIRE_EQUAL(traces.size(), 1);
+   BOOST_CHECK(std::get<eosio::ship_protocol::transaction_trace_v0>(traces[0]).id == trace->id);
+}
+
 BOOST_AUTO_TEST_CASE(test_deltas_account_creation) {
    for (backing_store_type backing_store : { backing_store_type::CHAINBASE, backing_store_type::ROCKSDB }) {
       table_deltas_tester chain { backing_store };
@@ -0,0 +1,56 @@
+#include <eosio/chain/transaction_access_set.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace eosio::chain;
+
+namespace {
+   transaction_access_set make_set( std::initializer_list<name> reads, std::initializer_list<name> writes ) {
+      transaction_access_set s;
+      for( auto n : reads ) s.add_read( n );
+      for( auto n : writes ) s.add_write( n );
+      return s;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(transaction_access_set_tests)
+
+BOOST_AUTO_TEST_CASE(conflicts) {
+   auto a = make_set( {"eosio.token"_n}, {"alice"_n, "eosio.token"_n} );
+   auto b = make_set( {"eosio.token"_n}, {"bob"_n, "eosio.token"_n} );
+   auto c = make_set( {"eosio.token"_n}, {"carol"_n} );
+   auto d = make_set( {"dice"_n}, {"dave"_n} );
+
+   BOOST_TEST( a.conflicts_with( b ) );  // write/write
+   BOOST_TEST( a.conflicts_with( c ) );  // write/read
+   BOOST_TEST( c.conflicts_with( a ) );  // read/write
+   BOOST_TEST( !a.conflicts_with( d ) );
+   BOOST_TEST( !c.conflicts_with( make_set( {"eosio.token"_n}, {} ) ) ); // read/read
+
+   transaction_access_set opaque;
+   opaque.opaque = true;
+   BOOST_TEST( opaque.conflicts_with( d ) );
+   BOOST_TEST( d.conflicts_with( opaque ) );
+}
+
+BOOST_AUTO_TEST_CASE(schedule) {
+   vector<transaction_access_set> sets;
+   sets.push_back( make_set( {"token"_n}, {"alice"_n} ) );  // 0
+   sets.push_back( make_set( {"token"_n}, {"bob"_n} ) );    // 0, reads do not conflict
+   sets.push_back( make_set( {"alice"_n}, {"carol"_n} ) );  // 1, reads alice written in batch 0
+   sets.push_back( make_set( {}, {"token"_n} ) );           // 1, writes token read in batch 0
+   sets.push_back( make_set( {"token"_n}, {"dave"_n} ) );   // 2, reads token written in batch 1
+   sets.push_back( make_set( {}, {"erin"_n} ) );            // 0, independent
+
+   BOOST_TEST( schedule_conflict_free_batches( sets ) == (vector<uint32_t>{0, 0, 1, 1, 2, 0}), boost::test_tools::per_element() );
+
+   transaction_access_set opaque;
+   opaque.opaque = true;
+   sets.push_back( opaque );                                 // 3, after everything
+   sets.push_back( make_set( {}, {"frank"_n} ) );            // 4, after the opaque set
+
+   BOOST_TEST( schedule_conflict_free_batches( sets ) == (vector<uint32_t>{0, 0, 1, 1, 2, 0, 3, 4}), boost::test_tools::per_element() );
+   BOOST_TEST( schedule_conflict_free_batches( {} ).empty() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
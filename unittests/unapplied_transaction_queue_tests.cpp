@@ -8,13 +8,13 @@ using namespace eosio::chain;
 
 BOOST_AUTO_TEST_SUITE(unapplied_transaction_queue_tests)
 
-auto unique_trx_meta_data( fc::time_point expire = fc::time_point::now() + fc::seconds( 120 ) ) {
+auto unique_trx_meta_data( fc::time_point expire = fc::time_point::now() + fc::seconds( 120 ),
+                           account_name creator = config::system_account_name ) {
 
    static uint64_t nextid = 0;
    ++nextid;
 
    signed_transaction trx;
-   account_name creator = config::system_account_name;
    trx.expiration = expire;
    trx.actions.emplace_back( vector<permission_level>{{creator,config::active_name}},
                              onerror{ nextid, "test", 4 });
@@ -496,4 +496,126 @@ BOOST_AUTO_TEST_CASE( unapplied_transaction_queue_incoming_count ) try {
 
 } FC_LOG_AND_RETHROW() /// unapplied_transaction_queue_incoming_count
 
+auto next_incoming( unapplied_transaction_queue& q ) {
+   transaction_metadata_ptr trx;
+   auto itr = q.next_incoming();
+   if( itr != q.incoming_end() ) {
+      trx = itr->trx_meta;
+      q.erase( itr );
+   }
+   return trx;
+}
+
+BOOST_AUTO_TEST_CASE( unapplied_transaction_queue_fair_incoming ) try {
+
+   unapplied_transaction_queue q;
+   q.set_fair_incoming_scheduling( true );
+   BOOST_CHECK( q.next_incoming() == q.incoming_end() );
+
+   const auto expire = fc::time_point::now() + fc::seconds( 120 );
+   auto heavy1 = unique_trx_meta_data( expire, "heavy"_n );
+   auto heavy2 = unique_trx_meta_data( expire, "heavy"_n );
+   auto heavy3 = unique_trx_meta_data( expire, "heavy"_n );
+   auto alice1 = unique_trx_meta_data( expire, "alice"_n );
+   auto alice2 = unique_trx_meta_data( expire, "alice"_n );
+   auto bob1 = unique_trx_meta_data( expire, "bob"_n );
+   auto api1 = unique_trx_meta_data( expire, "heavy"_n );
+
+   // burst from a heavy account arrives first
+   q.add_incoming( heavy1, false, [](auto){}, 1000 );
+   q.add_incoming( heavy2, false, [](auto){}, 1000 );
+   q.add_incoming( heavy3, false, [](auto){}, 1000 );
+   q.add_incoming( alice1, false, [](auto){}, 10 );
+   q.add_incoming( alice2, false, [](auto){}, 10 );
+   q.add_incoming( bob1, false, [](auto){}, 10 );
+   q.add_incoming( api1, true, [](auto){}, 1000 );
+   BOOST_CHECK_EQUAL( q.incoming_size(), 7u );
+
+   // incoming_persisted first, then cheapest finish time, round robin between accounts of equal cost
+   BOOST_CHECK( next_incoming( q ) == api1 );
+   BOOST_CHECK( next_incoming( q ) == alice1 );
+   BOOST_CHECK( next_incoming( q ) == bob1 );
+   BOOST_CHECK( next_incoming( q ) == alice2 );
+   BOOST_CHECK( next_incoming( q ) == heavy1 );
+
+   // trxs removed by other paths are skipped
+   q.add_persisted( heavy2 );
+   BOOST_CHECK( next_incoming( q ) == heavy3 );
+   BOOST_CHECK( next_incoming( q ) == nullptr );
+   BOOST_CHECK_EQUAL( q.incoming_size(), 0u );
+   BOOST_CHECK_EQUAL( q.size(), 1u );
+
+   // without fair scheduling incoming are in order of arrival
+   unapplied_transaction_queue fifo;
+   fifo.add_incoming( heavy1, false, [](auto){}, 1000 );
+   fifo.add_incoming( alice1, false, [](auto){}, 10 );
+   BOOST_CHECK( next_incoming( fifo ) == heavy1 );
+   BOOST_CHECK( next_incoming( fifo ) == alice1 );
+   BOOST_CHECK( next_incoming( fifo ) == nullptr );
+
+} FC_LOG_AND_RETHROW() /// unapplied_transaction_queue_fair_incoming
+
+BOOST_AUTO_TEST_CASE( unapplied_transaction_queue_account_limit ) try {
+
+   const auto expire = fc::time_point::now() + fc::seconds( 120 );
+   auto spam1 = unique_trx_meta_data( expire, "spam"_n );
+   auto spam2 = unique_trx_meta_data( expire, "spam"_n );
+   auto spam3 = unique_trx_meta_data( expire, "spam"_n );
+   auto alice1 = unique_trx_meta_data( expire, "alice"_n );
+
+   // room for two trxs of an account
+   const uint64_t trx_size = sizeof(unapplied_transaction) + spam1->get_estimated_size();
+   unapplied_transaction_queue q;
+   q.set_max_account_queue_size( trx_size * 2 + trx_size / 2 );
+
+   q.add_incoming( spam1, false, [](auto){} );
+   q.add_incoming( spam2, false, [](auto){} );
+   BOOST_CHECK_THROW( q.add_incoming( spam3, false, [](auto){} ), tx_resource_exhaustion );
+   BOOST_CHECK( !q.get_trx( spam3->id() ) );
+   BOOST_CHECK_EQUAL( q.incoming_size(), 2u );
+
+   // other accounts are unaffected
+   q.add_incoming( alice1, false, [](auto){} );
+   BOOST_CHECK_EQUAL( q.incoming_size(), 3u );
+
+   // budget returns as trxs leave the incoming queue
+   q.add_persisted( spam1 );
+   q.add_incoming( spam3, false, [](auto){} );
+   BOOST_CHECK_EQUAL( q.incoming_size(), 3u );
+   BOOST_CHECK_EQUAL( q.size(), 4u );
+
+} FC_LOG_AND_RETHROW() /// unapplied_transaction_queue_account_limit
+
+BOOST_AUTO_TEST_CASE( unapplied_transaction_queue_skip_incoming ) try {
+
+   for( bool fair : { false, true } ) {
+      unapplied_transaction_queue q;
+      q.set_fair_incoming_scheduling( fair );
+
+      auto trx1 = unique_trx_meta_data();
+      auto trx2 = unique_trx_meta_data();
+      auto trx3 = unique_trx_meta_data();
+      q.add_incoming( trx1, false, [](auto){} );
+      q.add_incoming( trx2, false, [](auto){} );
+      q.add_incoming( trx3, false, [](auto){} );
+
+      auto itr = q.next_incoming();
+      BOOST_REQUIRE( itr != q.incoming_end() );
+      BOOST_CHECK( itr->trx_meta == trx1 );
+      q.skip_incoming( itr );
+      BOOST_CHECK_EQUAL( q.incoming_size(), 3u );
+      BOOST_CHECK( next_incoming( q ) == trx2 );
+      BOOST_CHECK( next_incoming( q ) == trx3 );
+      if( fair ) {
+         // skipped until restored
+         BOOST_CHECK( next_incoming( q ) == nullptr );
+         q.restore_skipped_incoming();
+      }
+      BOOST_CHECK( next_incoming( q ) == trx1 );
+      BOOST_CHECK( next_incoming( q ) == nullptr );
+      BOOST_CHECK_EQUAL( q.incoming_size(), 0u );
+   }
+
+} FC_LOG_AND_RETHROW() /// unapplied_transaction_queue_skip_incoming
+
 BOOST_AUTO_TEST_SUITE_END()